@@ -1,6 +1,8 @@
 #include <torch/library.h>
 #include <ATen/VmapTransforms.h>
 #include <ATen/ATen.h>
+#include <ATen/Utils.h>
+#include <ATen/core/Reduction.h>
 
 namespace at {
 
@@ -98,6 +100,413 @@ Tensor expand_batching_rule(const Tensor& self, IntArrayRef size, bool implicit)
   return self_physical.newLogicalFromPhysical(result);
 }
 
+Tensor sum_batching_rule_full(const Tensor& self, optional<ScalarType> dtype) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  const auto& self_physical_tensor = self_physical.tensor();
+  // NB: at::sum over an empty list of dims reduces over all dims, batch dims
+  // included, so a logical scalar is handled separately.
+  if (self.dim() == 0) {
+    return self_physical.newLogicalFromPhysical(
+        dtype.has_value() ? self_physical_tensor.to(*dtype) : self_physical_tensor.clone());
+  }
+  VmapDimVector dims_physical;
+  for (int64_t dim = self_physical.numBatchDims(); dim < self_physical_tensor.dim(); dim++) {
+    dims_physical.push_back(dim);
+  }
+  auto result = at::sum(self_physical_tensor, dims_physical, /*keepdim*/false, dtype);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+Tensor mean_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim, optional<ScalarType> dtype) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto dims_physical = self_physical.getPhysicalDims(dims);
+  auto result = at::mean(self_physical.tensor(), dims_physical, keepdim, dtype);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+Tensor mean_batching_rule_full(const Tensor& self, optional<ScalarType> dtype) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  const auto& self_physical_tensor = self_physical.tensor();
+  // See sum_batching_rule_full
+  if (self.dim() == 0) {
+    return self_physical.newLogicalFromPhysical(
+        dtype.has_value() ? self_physical_tensor.to(*dtype) : self_physical_tensor.clone());
+  }
+  VmapDimVector dims_physical;
+  for (int64_t dim = self_physical.numBatchDims(); dim < self_physical_tensor.dim(); dim++) {
+    dims_physical.push_back(dim);
+  }
+  auto result = at::mean(self_physical_tensor, dims_physical, /*keepdim*/false, dtype);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+// Pointwise operators don't care where the batch dims are, so these run on
+// the underlying tensor and return a BatchedTensor with the same batch dims,
+// without permuting them to the front first.
+template <Tensor (*Op)(const Tensor&)>
+Tensor unary_pointwise_batching_rule(const Tensor& self) {
+  auto* self_batched = unsafeGetBatched(self);
+  auto bdims = self_batched->bdims();
+  return makeBatched(Op(self_batched->value()), BatchDims(bdims.begin(), bdims.end()));
+}
+
+Tensor add_scalar_batching_rule(const Tensor& self, Scalar other, Scalar alpha) {
+  auto* self_batched = unsafeGetBatched(self);
+  auto bdims = self_batched->bdims();
+  auto result = at::add(self_batched->value(), other, alpha);
+  return makeBatched(result, BatchDims(bdims.begin(), bdims.end()));
+}
+
+Tensor mul_scalar_batching_rule(const Tensor& self, Scalar other) {
+  auto* self_batched = unsafeGetBatched(self);
+  auto bdims = self_batched->bdims();
+  auto result = at::mul(self_batched->value(), other);
+  return makeBatched(result, BatchDims(bdims.begin(), bdims.end()));
+}
+
+Tensor add_batching_rule(const Tensor& self, const Tensor& other, Scalar alpha) {
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, other});
+  auto result = at::add(physical_args[0].tensor(), physical_args[1].tensor(), alpha);
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
+Tensor sub_batching_rule(const Tensor& self, const Tensor& other, Scalar alpha) {
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, other});
+  auto result = at::sub(physical_args[0].tensor(), physical_args[1].tensor(), alpha);
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
+Tensor div_batching_rule(const Tensor& self, const Tensor& other) {
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, other});
+  auto result = at::div(physical_args[0].tensor(), physical_args[1].tensor());
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
+static std::bitset<kVmapNumLevels> getLevels(const Tensor& tensor) {
+  std::bitset<kVmapNumLevels> levels;
+  auto* batched = maybeGetBatched(tensor);
+  if (batched) {
+    for (const auto& bdim : batched->bdims()) {
+      levels.set(bdim.level());
+    }
+  }
+  return levels;
+}
+
+// Returns physical views on `self` and `other` for an in-place operation on
+// `self`. The view on `self` aliases it, so the operation can be applied
+// to it directly.
+static VmapPhysicalViewVec inplaceBroadcastingPhysicalArgs(
+    const char* name, const Tensor& self, const Tensor& other) {
+  const auto self_levels = getLevels(self);
+  TORCH_CHECK((self_levels | getLevels(other)) == self_levels,
+      "vmap: ", name, "(self, other): in-place operations are only supported "
+      "if self has all of the vmapped dimensions of other, since they can't "
+      "add dimensions to self");
+  return BroadcastingVmapTransform::logicalToPhysical({self, other});
+}
+
+Tensor& add__batching_rule(Tensor& self, const Tensor& other, Scalar alpha) {
+  auto physical_args = inplaceBroadcastingPhysicalArgs("add_", self, other);
+  physical_args[0].tensor().add_(physical_args[1].tensor(), alpha);
+  return self;
+}
+
+Tensor& sub__batching_rule(Tensor& self, const Tensor& other, Scalar alpha) {
+  auto physical_args = inplaceBroadcastingPhysicalArgs("sub_", self, other);
+  physical_args[0].tensor().sub_(physical_args[1].tensor(), alpha);
+  return self;
+}
+
+Tensor& mul__batching_rule(Tensor& self, const Tensor& other) {
+  auto physical_args = inplaceBroadcastingPhysicalArgs("mul_", self, other);
+  physical_args[0].tensor().mul_(physical_args[1].tensor());
+  return self;
+}
+
+Tensor& div__batching_rule(Tensor& self, const Tensor& other) {
+  auto physical_args = inplaceBroadcastingPhysicalArgs("div_", self, other);
+  physical_args[0].tensor().div_(physical_args[1].tensor());
+  return self;
+}
+
+Tensor transpose_batching_rule(const Tensor& self, int64_t dim0, int64_t dim1) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto dim0_physical = self_physical.getPhysicalDim(dim0);
+  auto dim1_physical = self_physical.getPhysicalDim(dim1);
+  auto result = self_physical.tensor().transpose(dim0_physical, dim1_physical);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+Tensor t_batching_rule(const Tensor& self) {
+  TORCH_CHECK(self.dim() <= 2,
+      "t() expects a tensor with <= 2 dimensions, but self is ", self.dim(), "D");
+  if (self.dim() < 2) {
+    auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+    return self_physical.newLogicalFromPhysical(self_physical.tensor());
+  }
+  return transpose_batching_rule(self, 0, 1);
+}
+
+Tensor unsqueeze_batching_rule(const Tensor& self, int64_t dim) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  // NB: unsqueeze accepts one more dim than the tensor has, so we can't use
+  // getPhysicalDim here.
+  auto dim_physical =
+      self_physical.numBatchDims() + maybe_wrap_dim(dim, /*logical_dim*/self.dim() + 1);
+  auto result = self_physical.tensor().unsqueeze(dim_physical);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+Tensor squeeze_dim_batching_rule(const Tensor& self, int64_t dim) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto dim_physical = self_physical.getPhysicalDim(dim);
+  auto result = self_physical.tensor().squeeze(dim_physical);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+// NOTE: [Batching rule for matmul]
+// A BroadcastingVmapTransform of the two operands aligns their batch dims and
+// pads their example dims to the same number, which is what the broadcasting
+// of the leading dims in at::matmul needs. The padding turns a 1-D operand
+// into a matrix with a single row, which is what matmul does to `self` and
+// the transpose of what it does to `other`. The batch dims of an unbatched
+// operand are size one though, and matmul materializes the expansion of the
+// operand to the batch size, so the common case of a batched `self` and an
+// unbatched matrix or vector `other`, like a weight, is handled separately by
+// letting matmul fold the batch dims of `self` into its rows.
+Tensor matmul_batching_rule(const Tensor& self, const Tensor& other) {
+  const auto self_dim = self.dim();
+  const auto other_dim = other.dim();
+  TORCH_CHECK(self_dim >= 1 && other_dim >= 1,
+      "both arguments to matmul need to be at least 1D, but they are ",
+      self_dim, "D and ", other_dim, "D");
+
+  if (!isBatched(other) && other_dim <= 2) {
+    auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+    auto result = at::matmul(self_physical.tensor(), other);
+    return self_physical.newLogicalFromPhysical(result);
+  }
+
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, other});
+  auto self_physical = physical_args[0].tensor();
+  auto other_physical = physical_args[1].tensor();
+  if (self_dim == 1 && other_dim == 1) {
+    auto result = at::matmul(self_physical.unsqueeze(-2), other_physical.unsqueeze(-1));
+    return physical_args[0].newLogicalFromPhysical(result.squeeze(-1).squeeze(-1));
+  }
+  if (other_dim == 1) {
+    other_physical = other_physical.transpose(-1, -2);
+  }
+  auto result = at::matmul(self_physical, other_physical);
+  if (self_dim == 1) {
+    result = result.squeeze(-2);
+  } else if (other_dim == 1) {
+    result = result.squeeze(-1);
+  }
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
+Tensor mm_batching_rule(const Tensor& self, const Tensor& other) {
+  TORCH_CHECK(self.dim() == 2 && other.dim() == 2,
+      "mm: expected 2D tensors, but got ", self.dim(), "D and ", other.dim(), "D");
+  return matmul_batching_rule(self, other);
+}
+
+Tensor bmm_batching_rule(const Tensor& self, const Tensor& other) {
+  TORCH_CHECK(self.dim() == 3 && other.dim() == 3,
+      "bmm: expected 3D tensors, but got ", self.dim(), "D and ", other.dim(), "D");
+  TORCH_CHECK(self.size(0) == other.size(0),
+      "bmm: expected tensors with the same batch size, but got ",
+      self.size(0), " and ", other.size(0));
+  return matmul_batching_rule(self, other);
+}
+
+Tensor mv_batching_rule(const Tensor& self, const Tensor& vec) {
+  TORCH_CHECK(self.dim() == 2 && vec.dim() == 1,
+      "mv: expected a 2D and a 1D tensor, but got ", self.dim(), "D and ", vec.dim(), "D");
+  return matmul_batching_rule(self, vec);
+}
+
+Tensor dot_batching_rule(const Tensor& self, const Tensor& other) {
+  TORCH_CHECK(self.dim() == 1 && other.dim() == 1,
+      "dot: expected 1D tensors, but got ", self.dim(), "D and ", other.dim(), "D");
+  TORCH_CHECK(self.size(0) == other.size(0),
+      "dot: expected tensors with the same number of elements, but got ",
+      self.size(0), " and ", other.size(0));
+  return matmul_batching_rule(self, other);
+}
+
+Tensor linear_batching_rule(const Tensor& input, const Tensor& weight, const Tensor& bias) {
+  if (!isBatched(weight) && (!bias.defined() || !isBatched(bias))) {
+    auto input_physical = MultiBatchVmapTransform::logicalToPhysical(input);
+    auto result = at::linear(input_physical.tensor(), weight, bias);
+    return input_physical.newLogicalFromPhysical(result);
+  }
+  // Per-example weights: goes through the batching rules of t, matmul and add.
+  auto result = at::matmul(input, weight.t());
+  return bias.defined() ? at::add(result, bias) : result;
+}
+
+// Returns the batch sizes the batch dims of `physical_args` broadcast to.
+static VmapDimVector broadcastBatchSizes(VmapPhysicalViewVec& physical_args) {
+  const auto num_batch_dims = physical_args[0].numBatchDims();
+  VmapDimVector result(num_batch_dims, 1);
+  for (auto& physical_arg : physical_args) {
+    for (int64_t dim = 0; dim < num_batch_dims; dim++) {
+      const auto size = physical_arg.tensor().size(dim);
+      if (size != 1) {
+        result[dim] = size;
+      }
+    }
+  }
+  return result;
+}
+
+// Expands the batch dims of a physical tensor to `batch_sizes`, and flattens
+// them into a single dim.
+static Tensor expandAndFlattenBatchDims(const Tensor& physical, IntArrayRef batch_sizes) {
+  VmapDimVector expanded_sizes(batch_sizes.begin(), batch_sizes.end());
+  auto sizes = physical.sizes();
+  expanded_sizes.insert(expanded_sizes.end(), sizes.begin() + batch_sizes.size(), sizes.end());
+  VmapDimVector flat_sizes = {prod_intlist(batch_sizes)};
+  flat_sizes.insert(flat_sizes.end(), sizes.begin() + batch_sizes.size(), sizes.end());
+  return physical.expand(expanded_sizes).reshape(flat_sizes);
+}
+
+// NOTE: [Batching rule for conv2d]
+// With an unbatched weight and bias, the batch dims of the input are folded
+// into its (logical) batch dim of size N. With per-example weights, the
+// examples are instead stacked along the channels and run as the groups of a
+// single grouped convolution: the input of size [B, N, C, H, W] becomes
+// [N, B * C, H, W], the weight of size [B, O, C / groups, kH, kW] becomes
+// [B * O, C / groups, kH, kW], and the convolution runs with B * groups groups.
+Tensor conv2d_batching_rule(
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups) {
+  TORCH_CHECK(input.dim() == 4 && weight.dim() == 4,
+      "conv2d: expected 4D input and weight, but got ",
+      input.dim(), "D and ", weight.dim(), "D");
+
+  if (!isBatched(weight) && (!bias.defined() || !isBatched(bias))) {
+    auto input_physical = MultiBatchVmapTransform::logicalToPhysical(input);
+    const auto& input_physical_tensor = input_physical.tensor();
+    const auto num_batch_dims = input_physical.numBatchDims();
+    auto sizes = input_physical_tensor.sizes();
+    VmapDimVector folded_sizes = {prod_intlist(sizes.slice(0, num_batch_dims + 1))};
+    folded_sizes.insert(folded_sizes.end(), sizes.begin() + num_batch_dims + 1, sizes.end());
+    auto result = at::conv2d(
+        input_physical_tensor.reshape(folded_sizes), weight, bias,
+        stride, padding, dilation, groups);
+    VmapDimVector result_sizes(sizes.begin(), sizes.begin() + num_batch_dims + 1);
+    result_sizes.insert(result_sizes.end(), result.sizes().begin() + 1, result.sizes().end());
+    return input_physical.newLogicalFromPhysical(result.view(result_sizes));
+  }
+
+  std::vector<Tensor> logical_args = {input, weight};
+  if (bias.defined()) {
+    logical_args.push_back(bias);
+  }
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical(logical_args);
+  const auto batch_sizes = broadcastBatchSizes(physical_args);
+  const auto num_examples = prod_intlist(batch_sizes);
+
+  // [B, N, C, H, W] -> [N, B * C, H, W]
+  auto input_flat = expandAndFlattenBatchDims(physical_args[0].tensor(), batch_sizes);
+  const auto n = input_flat.size(1);
+  input_flat = input_flat.transpose(0, 1).reshape(
+      {n, num_examples * input_flat.size(2), input_flat.size(3), input_flat.size(4)});
+  // [B, O, C / groups, kH, kW] -> [B * O, C / groups, kH, kW]
+  auto weight_flat = expandAndFlattenBatchDims(physical_args[1].tensor(), batch_sizes);
+  const auto out_channels = weight_flat.size(1);
+  weight_flat = weight_flat.flatten(0, 1);
+  Tensor bias_flat;
+  if (bias.defined()) {
+    // The bias was padded to [B, 1, 1, 1, O]
+    bias_flat = expandAndFlattenBatchDims(physical_args[2].tensor(), batch_sizes).reshape({-1});
+  }
+
+  auto result = at::conv2d(
+      input_flat, weight_flat, bias_flat, stride, padding, dilation, groups * num_examples);
+  // [N, B * O, H', W'] -> [B, N, O, H', W']
+  VmapDimVector result_sizes(batch_sizes.begin(), batch_sizes.end());
+  result_sizes.insert(result_sizes.end(), {n, out_channels, result.size(2), result.size(3)});
+  result = result.view({n, num_examples, out_channels, result.size(2), result.size(3)})
+      .transpose(0, 1)
+      .view(result_sizes);
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
+Tensor log_softmax_batching_rule(const Tensor& self, int64_t dim, optional<ScalarType> dtype) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto dim_physical = self_physical.getPhysicalDim(dim);
+  auto result = at::log_softmax(self_physical.tensor(), dim_physical, dtype);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+Tensor softmax_batching_rule(const Tensor& self, int64_t dim, optional<ScalarType> dtype) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto dim_physical = self_physical.getPhysicalDim(dim);
+  auto result = at::softmax(self_physical.tensor(), dim_physical, dtype);
+  return self_physical.newLogicalFromPhysical(result);
+}
+
+// The examples are flattened into the batch dim of a single unreduced
+// at::nll_loss, and the reduction is done per example.
+Tensor nll_loss_batching_rule(
+    const Tensor& self, const Tensor& target, const Tensor& weight,
+    int64_t reduction, int64_t ignore_index) {
+  TORCH_CHECK(self.dim() == 1 || self.dim() == 2,
+      "nll_loss: expected input of 1 or 2 dimensions, but got ", self.dim());
+  TORCH_CHECK(target.dim() == self.dim() - 1,
+      "nll_loss: expected target of ", self.dim() - 1, " dimensions, but got ", target.dim());
+  TORCH_CHECK(!weight.defined() || !isBatched(weight),
+      "vmap: nll_loss doesn't support a batched weight");
+
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, target});
+  const auto batch_sizes = broadcastBatchSizes(physical_args);
+  const auto num_batch_dims = batch_sizes.size();
+  const auto n = self.dim() == 2 ? self.size(0) : 1;
+  const auto c = self.size(-1);
+
+  // [B, (N,) C] -> [B * N, C]
+  const auto& self_physical = physical_args[0].tensor();
+  VmapDimVector self_sizes(
+      self_physical.sizes().begin(), self_physical.sizes().begin() + num_batch_dims);
+  self_sizes.insert(self_sizes.end(), {n, c});
+  auto input = expandAndFlattenBatchDims(self_physical.view(self_sizes), batch_sizes)
+      .reshape({-1, c});
+  // The target was padded to [B, 1, (N)], since it has one fewer dim than
+  // the input. [B, 1, (N)] -> [B * N]
+  const auto& target_physical = physical_args[1].tensor();
+  VmapDimVector target_sizes(
+      target_physical.sizes().begin(), target_physical.sizes().begin() + num_batch_dims);
+  target_sizes.push_back(n);
+  auto target_flat = expandAndFlattenBatchDims(target_physical.view(target_sizes), batch_sizes)
+      .reshape({-1});
+
+  VmapDimVector loss_sizes(batch_sizes.begin(), batch_sizes.end());
+  loss_sizes.push_back(n);
+  auto loss = at::nll_loss(input, target_flat, weight, Reduction::None, ignore_index)
+      .view(loss_sizes);
+  Tensor result;
+  if (reduction == Reduction::None) {
+    result = self.dim() == 2 ? loss : loss.squeeze(-1);
+  } else if (reduction == Reduction::Sum) {
+    result = loss.sum(-1);
+  } else {
+    // Like at::nll_loss, divides by the total weight of the targets that
+    // aren't ignored.
+    auto ignored = target_flat.eq(ignore_index);
+    auto target_weight = weight.defined()
+        ? weight.index_select(0, target_flat.masked_fill(ignored, 0))
+        : at::ones(target_flat.sizes(), loss.options());
+    target_weight = target_weight.masked_fill(ignored, 0).view(loss_sizes);
+    result = loss.sum(-1) / target_weight.sum(-1);
+  }
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
 void batchedTensorFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   TORCH_CHECK(false, "NYI: Calling ", op.schema().name(), " inside of vmap");
 }
@@ -114,8 +523,55 @@ TORCH_LIBRARY_IMPL(aten, Batched, m) {
   m.impl("size.int", static_cast<int64_t (*)(const Tensor&, int64_t)>(native::size));
 
   m.impl_UNBOXED("sum.dim_IntList", sum_batching_rule);
+  m.impl_UNBOXED("sum", sum_batching_rule_full);
+  m.impl_UNBOXED("mean.dim", mean_batching_rule);
+  m.impl_UNBOXED("mean", mean_batching_rule_full);
   m.impl_UNBOXED("mul.Tensor", mul_batching_rule);
   m.impl("expand", expand_batching_rule);
+
+  // view ops
+  m.impl("transpose.int", transpose_batching_rule);
+  m.impl("t", t_batching_rule);
+  m.impl("unsqueeze", unsqueeze_batching_rule);
+  m.impl("squeeze.dim", squeeze_dim_batching_rule);
+
+  // pointwise ops
+#define UNARY_POINTWISE(op) m.impl(#op, unary_pointwise_batching_rule<at::op>)
+  UNARY_POINTWISE(abs);
+  UNARY_POINTWISE(cos);
+  UNARY_POINTWISE(exp);
+  UNARY_POINTWISE(log);
+  UNARY_POINTWISE(neg);
+  UNARY_POINTWISE(relu);
+  UNARY_POINTWISE(rsqrt);
+  UNARY_POINTWISE(sigmoid);
+  UNARY_POINTWISE(sin);
+  UNARY_POINTWISE(sqrt);
+  UNARY_POINTWISE(tanh);
+#undef UNARY_POINTWISE
+  m.impl("add.Scalar", add_scalar_batching_rule);
+  m.impl("mul.Scalar", mul_scalar_batching_rule);
+  m.impl("add.Tensor", add_batching_rule);
+  m.impl("sub.Tensor", sub_batching_rule);
+  m.impl("div.Tensor", div_batching_rule);
+  m.impl_UNBOXED("add_.Tensor", add__batching_rule);
+  m.impl_UNBOXED("sub_.Tensor", sub__batching_rule);
+  m.impl_UNBOXED("mul_.Tensor", mul__batching_rule);
+  m.impl_UNBOXED("div_.Tensor", div__batching_rule);
+
+  // matrix multiplication
+  m.impl("matmul", matmul_batching_rule);
+  m.impl("mm", mm_batching_rule);
+  m.impl("bmm", bmm_batching_rule);
+  m.impl("mv", mv_batching_rule);
+  m.impl("dot", dot_batching_rule);
+  m.impl_UNBOXED("linear", linear_batching_rule);
+
+  // nn ops
+  m.impl_UNBOXED("conv2d", conv2d_batching_rule);
+  m.impl_UNBOXED("log_softmax.int", log_softmax_batching_rule);
+  m.impl_UNBOXED("softmax.int", softmax_batching_rule);
+  m.impl_UNBOXED("nll_loss", nll_loss_batching_rule);
 }
 
 } // namespace at
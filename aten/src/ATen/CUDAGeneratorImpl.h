@@ -7,6 +7,46 @@
 
 namespace at {
 
+/**
+ * Note [CUDA Graph-safe RNG states]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * A kernel captured by a CUDA graph keeps the arguments it was launched with,
+ * so a seed and offset passed by value would give the same random numbers on
+ * every replay. During capture, philox_cuda_state instead hands out pointers
+ * to a seed and an offset in device memory, owned by the graph, together with
+ * the offset of the kernel within the graph. Before each replay the graph
+ * writes the generator's current seed and offset there, and advances the
+ * generator's offset by the total increment of its kernels, like a single
+ * kernel would. Kernels read their seed and offset with
+ * at::cuda::philox::unpack (ATen/cuda/CUDAGraphsUtils.cuh).
+ */
+struct PhiloxCudaState {
+  PhiloxCudaState() = default;
+  // Outside of capture
+  PhiloxCudaState(uint64_t seed, uint64_t offset) {
+    seed_.val = seed;
+    offset_.val = offset;
+  }
+  // During capture
+  PhiloxCudaState(int64_t* seed, int64_t* offset_extragraph, uint32_t offset_intragraph) {
+    seed_.ptr = seed;
+    offset_.ptr = offset_extragraph;
+    offset_intragraph_ = offset_intragraph;
+    captured_ = true;
+  }
+
+  union Payload {
+    uint64_t val;
+    int64_t* ptr;
+  };
+
+  Payload seed_;
+  Payload offset_;
+  uint32_t offset_intragraph_ = 0;
+  bool captured_ = false;
+};
+
 struct TORCH_CUDA_API CUDAGeneratorImpl : public c10::GeneratorImpl {
   // Constructors
   CUDAGeneratorImpl(DeviceIndex device_index = -1);
@@ -19,6 +59,11 @@ struct TORCH_CUDA_API CUDAGeneratorImpl : public c10::GeneratorImpl {
   uint64_t seed() override;
   void set_philox_offset_per_thread(uint64_t offset);
   uint64_t philox_offset_per_thread();
+  void capture_prologue(int64_t* seed_extragraph, int64_t* offset_extragraph);
+  uint64_t capture_epilogue();
+  PhiloxCudaState philox_cuda_state(uint64_t increment);
+  // Not allowed during CUDA graph capture; kernels that may be captured use
+  // philox_cuda_state instead.
   std::pair<uint64_t, uint64_t> philox_engine_inputs(uint64_t increment);
   static DeviceType device_type();
 
@@ -26,6 +71,11 @@ private:
   CUDAGeneratorImpl* clone_impl() const override;
   uint64_t seed_ = default_rng_seed_val;
   uint64_t philox_offset_per_thread_ = 0;
+  // See Note [CUDA Graph-safe RNG states]
+  int64_t* seed_extragraph_ = nullptr;
+  int64_t* offset_extragraph_ = nullptr;
+  uint32_t offset_intragraph_ = 0;
+  bool graph_expects_this_gen_ = false;
 };
 
 namespace cuda {
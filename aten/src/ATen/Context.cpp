@@ -78,6 +78,14 @@ void Context::alertNotDeterministic(c10::string_view const& caller) {
   }
 }
 
+bool Context::parallelCPURNG() const {
+  return parallel_cpu_rng;
+}
+
+void Context::setParallelCPURNG(bool b) {
+  parallel_cpu_rng = b;
+}
+
 bool Context::benchmarkCuDNN() const {
   return benchmark_cudnn;
 }
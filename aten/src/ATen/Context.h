@@ -109,6 +109,11 @@ class CAFFE2_API Context {
   bool deterministic() const;
   void setDeterministic(bool);
   void alertNotDeterministic(c10::string_view const& caller);
+  // Whether the CPU uniform_, normal_ and bernoulli_ kernels draw from
+  // Philox streams in parallel instead of from the generator's mt19937.
+  // See Note [Parallel CPU random number generation]
+  bool parallelCPURNG() const;
+  void setParallelCPURNG(bool);
   at::QEngine qEngine() const;
   void setQEngine(at::QEngine e);
   const std::vector<at::QEngine>& supportedQEngines() const;
@@ -135,6 +140,7 @@ class CAFFE2_API Context {
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool _deterministic = false;
+  bool parallel_cpu_rng = false;
   bool benchmark_cudnn = false;
   bool enabled_mkldnn = true;
   #ifdef C10_MOBILE
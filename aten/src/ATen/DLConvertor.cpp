@@ -189,14 +189,17 @@ Tensor fromDLPack(const DLManagedTensor* src) {
   auto deleter = [src](void* self) {
     src->deleter(const_cast<DLManagedTensor*>(src));
   };
+  // Producers may point data at the start of an allocation and put the
+  // offset of the tensor in byte_offset.
+  void* data = static_cast<char*>(src->dl_tensor.data) + src->dl_tensor.byte_offset;
   if (!src->dl_tensor.strides) {
-    return at::from_blob(src->dl_tensor.data,
+    return at::from_blob(data,
         IntArrayRef(src->dl_tensor.shape, src->dl_tensor.ndim),
         deleter,
         at::device(device).dtype(stype));
   }
   return at::from_blob(
-      src->dl_tensor.data,
+      data,
       IntArrayRef(src->dl_tensor.shape, src->dl_tensor.ndim),
       IntArrayRef(src->dl_tensor.strides, src->dl_tensor.ndim),
       deleter,
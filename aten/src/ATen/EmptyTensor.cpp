@@ -0,0 +1,123 @@
+#include <ATen/EmptyTensor.h>
+
+#include <ATen/Context.h>
+#include <ATen/Utils.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+namespace at {
+namespace detail {
+
+namespace {
+
+c10::Allocator* cpu_allocator_maybe_pinned(bool pin_memory) {
+  if (pin_memory) {
+    return getCUDAHooks().getPinnedMemoryAllocator();
+  }
+  return getCPUAllocator();
+}
+
+void check_size_nonnegative(IntArrayRef size) {
+  for (auto x : size) {
+    TORCH_CHECK(
+        x >= 0,
+        "Trying to create tensor with negative dimension ",
+        x,
+        ": ",
+        size);
+  }
+}
+
+Tensor make_empty_tensor(
+    int64_t storage_numel,
+    c10::Allocator* allocator,
+    DispatchKey dispatch_key,
+    ScalarType dtype) {
+  const auto type_meta = scalarTypeToTypeMeta(dtype);
+  const int64_t size_bytes = storage_numel * type_meta.itemsize();
+  auto storage_impl = c10::make_intrusive<StorageImpl>(
+      c10::StorageImpl::use_byte_size_t(),
+      size_bytes,
+      allocator->allocate(size_bytes),
+      allocator,
+      /*resizeable=*/true);
+  return make_tensor<TensorImpl>(
+      std::move(storage_impl), dispatch_key, type_meta);
+}
+
+} // namespace
+
+Tensor empty_generic(
+    IntArrayRef size,
+    c10::Allocator* allocator,
+    DispatchKey dispatch_key,
+    ScalarType dtype,
+    MemoryFormat memory_format) {
+  check_size_nonnegative(size);
+  auto tensor = make_empty_tensor(
+      prod_intlist(size), allocator, dispatch_key, dtype);
+  // Also computes the contiguous strides, so that only other memory formats
+  // have to restride.
+  tensor.unsafeGetTensorImpl()->set_sizes_contiguous(size);
+  if (memory_format != MemoryFormat::Contiguous) {
+    tensor.unsafeGetTensorImpl()->empty_tensor_restride(memory_format);
+  }
+  return tensor;
+}
+
+Tensor empty_strided_generic(
+    IntArrayRef size,
+    IntArrayRef stride,
+    c10::Allocator* allocator,
+    DispatchKey dispatch_key,
+    ScalarType dtype) {
+  check_size_nonnegative(size);
+  TORCH_CHECK(
+      size.size() == stride.size(),
+      "dimensionality of sizes (",
+      size.size(),
+      ") must match dimensionality of strides (",
+      stride.size(),
+      ")");
+  // NB: storage size can be different from numel.
+  int64_t storage_numel = 1;
+  for (size_t dim = 0; dim < size.size(); ++dim) {
+    if (size[dim] == 0) {
+      storage_numel = 0;
+      break;
+    }
+    storage_numel += (size[dim] - 1) * stride[dim];
+  }
+  auto tensor =
+      make_empty_tensor(storage_numel, allocator, dispatch_key, dtype);
+  tensor.unsafeGetTensorImpl()->set_sizes_and_strides(size, stride);
+  return tensor;
+}
+
+Tensor empty_cpu_fast(
+    IntArrayRef size,
+    ScalarType dtype,
+    bool pin_memory,
+    MemoryFormat memory_format) {
+  return empty_generic(
+      size,
+      cpu_allocator_maybe_pinned(pin_memory),
+      DispatchKey::CPU,
+      dtype,
+      memory_format);
+}
+
+Tensor empty_strided_cpu_fast(
+    IntArrayRef size,
+    IntArrayRef stride,
+    ScalarType dtype,
+    bool pin_memory) {
+  return empty_strided_generic(
+      size,
+      stride,
+      cpu_allocator_maybe_pinned(pin_memory),
+      DispatchKey::CPU,
+      dtype);
+}
+
+} // namespace detail
+} // namespace at
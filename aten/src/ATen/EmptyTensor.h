@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+namespace at {
+namespace detail {
+
+// Creates uninitialized strided tensors without going through the
+// dispatcher. Kernels allocating their outputs already know the device and
+// the dtype, so the TensorOptions merging, the dispatch key computation and
+// the dispatch of at::empty are pure overhead for them, which shows on small
+// ops. Unlike at::empty, these don't go through the autograd, tracer or
+// profiler dispatch keys: the result never requires grad and no op is
+// recorded.
+//
+// The sizes must be non-negative. For the strided versions, the storage is
+// allocated to hold the elements reachable with the given strides.
+
+// Allocates the storage with `allocator`, and tags the tensor with
+// `dispatch_key`.
+CAFFE2_API Tensor empty_generic(
+    IntArrayRef size,
+    c10::Allocator* allocator,
+    DispatchKey dispatch_key,
+    ScalarType dtype,
+    MemoryFormat memory_format = MemoryFormat::Contiguous);
+
+CAFFE2_API Tensor empty_strided_generic(
+    IntArrayRef size,
+    IntArrayRef stride,
+    c10::Allocator* allocator,
+    DispatchKey dispatch_key,
+    ScalarType dtype);
+
+CAFFE2_API Tensor empty_cpu_fast(
+    IntArrayRef size,
+    ScalarType dtype,
+    bool pin_memory = false,
+    MemoryFormat memory_format = MemoryFormat::Contiguous);
+
+CAFFE2_API Tensor empty_strided_cpu_fast(
+    IntArrayRef size,
+    IntArrayRef stride,
+    ScalarType dtype,
+    bool pin_memory = false);
+
+} // namespace detail
+} // namespace at
@@ -163,6 +163,9 @@ TensorImpl* propagate_names(TensorImpl* result, DimnameList names, bool validate
 }
 
 void propagate_names_except(Tensor& result, const Tensor& src, IntArrayRef excluded_idxs) {
+  if (!NamedTensorMeta::any_alive()) {
+    return;
+  }
   if (!result.has_names() && !src.has_names()) {
     return;
   }
@@ -207,7 +210,7 @@ void propagate_names(Tensor& result, const Tensor& src) {
 }
 
 void propagate_names(TensorImpl* result, TensorImpl* src) {
-  if (result == src) {
+  if (result == src || !NamedTensorMeta::any_alive()) {
     return;
   }
   if (!impl::has_names(result) && !impl::has_names(src)) {
@@ -374,6 +377,9 @@ void propagate_names_for_addmv(
     const Tensor& mat,
     const Tensor& vec,
     const Tensor& bias) {
+  if (!NamedTensorMeta::any_alive()) {
+    return;
+  }
   if (!result.has_names() && !mat.has_names() &&
       !vec.has_names() && !bias.has_names()) {
     return;
@@ -388,6 +394,9 @@ void propagate_names_for_addmm(
     TensorImpl* m1,
     TensorImpl* m2,
     TensorImpl* bias) {
+  if (!NamedTensorMeta::any_alive()) {
+    return;
+  }
   if (!impl::has_names(m1) && !impl::has_names(m2) &&
       !impl::has_names(bias) && !impl::has_names(result)) {
     return;
@@ -430,6 +439,9 @@ void propagate_names_for_expand(Tensor& result, const Tensor& self) {
 std::vector<Dimname> compute_broadcast_outnames(
     const Tensor& self,
     const Tensor& other) {
+  if (!NamedTensorMeta::any_alive()) {
+    return {};
+  }
   if (!self.has_names() && !other.has_names()) {
     return {};
   }
@@ -11,6 +11,9 @@ namespace at {
 using NameVector = SmallVector<Dimname, kDimVectorStaticSize>;
 
 inline bool has_names(TensorList tensors) {
+  if (!NamedTensorMeta::any_alive()) {
+    return false;
+  }
   return std::any_of(
       tensors.begin(), tensors.end(), [](const Tensor& t) { return t.has_names(); });
 }
@@ -9,10 +9,14 @@ class CAFFE2_API PTThreadPool : public c10::ThreadPool {
 public:
   explicit PTThreadPool(
       int pool_size,
-      int numa_node_id = -1)
-    : c10::ThreadPool(pool_size, numa_node_id, [](){
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr)
+    : c10::ThreadPool(pool_size, numa_node_id, [init_thread](){
         c10::setThreadName("PTThreadPool");
         at::init_num_threads();
+        if (init_thread) {
+          init_thread();
+        }
       }) {}
 };
 
@@ -34,6 +34,16 @@ CAFFE2_API int get_thread_num();
 // Checks whether the code runs in parallel region
 CAFFE2_API bool in_parallel_region();
 
+// Sets the CPUs intra-op worker threads are pinned to, one CPU per worker in
+// list order, and that inter-op threads are kept off. Like set_num_threads,
+// it must be called before parallel work starts. Defaults to the list in the
+// PYTORCH_INTRAOP_CPUS environment variable (e.g. "0-3,8"), if set.
+// Only the native backend pins its intra-op workers.
+CAFFE2_API void set_intraop_cpu_affinity(std::vector<int> cpus);
+
+// Returns the CPUs set by set_intraop_cpu_affinity, empty if none
+CAFFE2_API std::vector<int> get_intraop_cpu_affinity();
+
 namespace internal {
 
 // Initialise num_threads lazily at first parallel call
@@ -45,6 +55,16 @@ inline CAFFE2_API void lazy_init_num_threads() {
   }
 }
 
+// Pins the calling thread to the CPU of the given intra-op worker
+CAFFE2_API void pin_intraop_worker(size_t worker_id);
+
+// Restricts the calling thread to the CPUs not used by intra-op workers
+CAFFE2_API void exclude_intraop_cpus();
+
+// Time idle intra-op workers spin before blocking, taken from the
+// PYTORCH_INTRAOP_SPIN_US environment variable (0 by default)
+CAFFE2_API int64_t intraop_spin_duration_us();
+
 }
 
 /*
@@ -151,4 +171,6 @@ CAFFE2_API int intraop_default_num_threads();
 #include <ATen/ParallelNative.h>
 #elif AT_PARALLEL_NATIVE_TBB
 #include <ATen/ParallelNativeTBB.h>
+#elif AT_PARALLEL_WORK_STEALING
+#include <ATen/ParallelWorkStealing.h>
 #endif
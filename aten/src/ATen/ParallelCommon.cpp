@@ -3,10 +3,19 @@
 #include <ATen/Config.h>
 #include <ATen/PTThreadPool.h>
 #include <ATen/Version.h>
+#include <c10/core/thread_pool.h>
+#include <caffe2/utils/threadpool/pthreadpool.h>
 
+#include <cerrno>
+#include <cstring>
+#include <mutex>
 #include <sstream>
 #include <thread>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #ifdef TH_BLAS_MKL
 #include <mkl.h>
 #endif
@@ -40,8 +49,136 @@ size_t get_env_num_threads(const char* var_name, size_t def_value = 0) {
   return def_value;
 }
 
+std::mutex intraop_cpus_mutex;
+// CPUs of the intra-op workers, read from PYTORCH_INTRAOP_CPUS on first use
+c10::optional<std::vector<int>> intraop_cpus;
+
+const std::vector<int>& get_intraop_cpus_locked() {
+  if (!intraop_cpus) {
+    intraop_cpus = std::vector<int>();
+    try {
+      if (auto* value = std::getenv("PYTORCH_INTRAOP_CPUS")) {
+        intraop_cpus = c10::parse_cpu_list(value);
+      }
+    } catch (const std::exception& e) {
+      std::ostringstream oss;
+      oss << "Invalid PYTORCH_INTRAOP_CPUS variable value, " << e.what();
+      TORCH_WARN(oss.str());
+    }
+  }
+  return *intraop_cpus;
+}
+
+#if defined(__linux__)
+void set_thread_affinity(const cpu_set_t& set) {
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    TORCH_WARN("Failed to set thread affinity: ", std::strerror(errno));
+  }
+}
+#endif
+
+// Runs the work of caffe2::ThreadPool and of the pthreadpool shims (QNNPACK,
+// XNNPACK) on the intra-op pool, so that they follow set_num_threads and the
+// affinity settings and do not oversubscribe the CPUs with their own threads.
+size_t executor_threads_count() {
+  return get_num_threads();
+}
+
+void executor_parallelize(
+    pthreadpool_executor_task_t task,
+    void* context,
+    size_t range) {
+  parallel_for(0, range, 1, [&](int64_t begin, int64_t end) {
+    task(context, get_thread_num(), begin, end);
+  });
+}
+
+const pthreadpool_executor intraop_executor = {
+    &executor_threads_count,
+    &executor_parallelize,
+};
+
+C10_UNUSED const bool intraop_executor_set =
+    (pthreadpool_set_executor(&intraop_executor), true);
+
 } // namespace
 
+void set_intraop_cpu_affinity(std::vector<int> cpus) {
+  for (int cpu : cpus) {
+    TORCH_CHECK(cpu >= 0, "Expected non-negative CPU ids, got ", cpu);
+  }
+  std::lock_guard<std::mutex> guard(intraop_cpus_mutex);
+  intraop_cpus = std::move(cpus);
+}
+
+std::vector<int> get_intraop_cpu_affinity() {
+  std::lock_guard<std::mutex> guard(intraop_cpus_mutex);
+  return get_intraop_cpus_locked();
+}
+
+namespace internal {
+
+void pin_intraop_worker(size_t worker_id) {
+  auto cpus = get_intraop_cpu_affinity();
+  if (cpus.empty()) {
+    return;
+  }
+#if defined(__linux__)
+  int cpu = cpus[worker_id % cpus.size()];
+  if (cpu >= CPU_SETSIZE) {
+    TORCH_WARN("Cannot pin intra-op worker to CPU ", cpu);
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  set_thread_affinity(set);
+#endif
+}
+
+void exclude_intraop_cpus() {
+  auto cpus = get_intraop_cpu_affinity();
+  if (cpus.empty()) {
+    return;
+  }
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return;
+  }
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_CLR(cpu, &set);
+    }
+  }
+  // leave the thread alone if the intra-op workers take all of its CPUs
+  if (CPU_COUNT(&set) > 0) {
+    set_thread_affinity(set);
+  }
+#endif
+}
+
+int64_t intraop_spin_duration_us() {
+  static const int64_t spin_us = []() -> int64_t {
+    try {
+      if (auto* value = std::getenv("PYTORCH_INTRAOP_SPIN_US")) {
+        int64_t us = c10::stoll(value);
+        TORCH_CHECK(us >= 0);
+        return us;
+      }
+    } catch (const std::exception& e) {
+      std::ostringstream oss;
+      oss << "Invalid PYTORCH_INTRAOP_SPIN_US variable value, " << e.what();
+      TORCH_WARN(oss.str());
+    }
+    return 0;
+  }();
+  return spin_us;
+}
+
+} // namespace internal
+
 std::string get_parallel_info() {
   std::ostringstream ss;
 
@@ -70,6 +207,10 @@ std::string get_parallel_info() {
      << get_env_var("OMP_NUM_THREADS", "[not set]") << std::endl;
   ss << "\tMKL_NUM_THREADS : "
      << get_env_var("MKL_NUM_THREADS", "[not set]") << std::endl;
+  ss << "\tPYTORCH_INTRAOP_CPUS : "
+     << get_env_var("PYTORCH_INTRAOP_CPUS", "[not set]") << std::endl;
+  ss << "\tPYTORCH_INTRAOP_SPIN_US : "
+     << get_env_var("PYTORCH_INTRAOP_SPIN_US", "[not set]") << std::endl;
 
   ss << "ATen parallel backend: ";
   #if AT_PARALLEL_OPENMP
@@ -78,6 +219,8 @@ std::string get_parallel_info() {
   ss << "native thread pool";
   #elif AT_PARALLEL_NATIVE_TBB
   ss << "native thread pool and TBB";
+  #elif AT_PARALLEL_WORK_STEALING
+  ss << "work-stealing thread pool";
   #endif
   #ifdef C10_MOBILE
   ss << " [mobile]";
@@ -11,6 +11,7 @@
 #endif // C10_MOBILE
 
 #include <atomic>
+#include <chrono>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -66,13 +67,30 @@ int _num_pool_threads(int nthreads) {
   return nthreads - 1;
 }
 
+// The intra-op pool is created directly rather than through
+// ThreadPoolRegistry, so that its workers can be pinned to the CPUs set with
+// set_intraop_cpu_affinity and spin before blocking.
+std::shared_ptr<PTThreadPool> _create_intraop_pool(int pool_size) {
+  std::shared_ptr<PTThreadPool> pool;
+  if (get_intraop_cpu_affinity().empty()) {
+    pool = std::make_shared<PTThreadPool>(pool_size);
+  } else {
+    auto next_worker_id = std::make_shared<std::atomic<size_t>>(0);
+    pool = std::make_shared<PTThreadPool>(
+        pool_size,
+        /* numa_node_id */ -1,
+        [next_worker_id]() {
+          internal::pin_intraop_worker(next_worker_id->fetch_add(1));
+        });
+  }
+  pool->setSpinDuration(
+      std::chrono::microseconds(internal::intraop_spin_duration_us()));
+  return pool;
+}
+
 TaskThreadPoolBase& _get_intraop_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
+  static std::shared_ptr<PTThreadPool> pool = _create_intraop_pool(
+      _num_pool_threads(num_intraop_threads.exchange(CONSUMED)));
   return *pool;
 }
 
@@ -1,5 +1,5 @@
 #include <ATen/Config.h>
-#if AT_PARALLEL_OPENMP || AT_PARALLEL_NATIVE || AT_PARALLEL_NATIVE_TBB
+#if AT_PARALLEL_OPENMP || AT_PARALLEL_NATIVE || AT_PARALLEL_NATIVE_TBB || AT_PARALLEL_WORK_STEALING
 #include <ATen/Parallel.h>
 #include <ATen/PTThreadPool.h>
 #include <ATen/ThreadLocalState.h>
@@ -40,7 +40,11 @@ std::shared_ptr<TaskThreadPoolBase> create_c10_threadpool(
   TORCH_CHECK(device_id == 0);
   // Create new thread pool
   TORCH_CHECK(create_new);
-  return std::make_shared<PTThreadPool>(pool_size);
+  // keep inter-op threads off the CPUs reserved for intra-op workers
+  return std::make_shared<PTThreadPool>(
+      pool_size,
+      /* numa_node_id */ -1,
+      []() { internal::exclude_intraop_cpus(); });
 }
 
 } // namespace
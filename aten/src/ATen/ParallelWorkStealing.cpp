@@ -0,0 +1,531 @@
+#include <ATen/Config.h>
+#if AT_PARALLEL_WORK_STEALING
+#include <ATen/Parallel.h>
+
+#include <c10/util/Logging.h>
+#include <c10/util/thread_name.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef TH_BLAS_MKL
+#include <mkl.h>
+#endif
+
+namespace at {
+namespace {
+// used with ParallelRegionGuard to mark a thread as in parallel region
+// while it executes the user function
+thread_local bool in_parallel_region_ = false;
+
+// set on the worker threads of the pool
+thread_local bool in_pool_ = false;
+
+// 0 on the calling thread, 1..N on the N pool workers
+thread_local size_t thread_num_ = 0;
+
+const int NOT_SET = -1;
+const int CONSUMED = -2;
+
+// Number of threads set by the user, same states as in ParallelNative.cpp:
+// NOT_SET -> positive value -> CONSUMED
+// or
+// NOT_SET -> CONSUMED
+std::atomic<int> num_intraop_threads{NOT_SET};
+
+// Range splitting aims for this many chunks per thread; a smaller grain_size
+// does not split the range any further.
+constexpr int64_t kChunksPerThread = 4;
+
+// Number of subranges a deque can hold. Since a range is only split while its
+// owner's deque is empty, this is never reached in practice; a full deque
+// simply stops splitting.
+constexpr int64_t kDequeCapacity = 64;
+
+// Number of threads that may run parallel_for at the same time with their own
+// deque; further concurrent callers run their range inline.
+constexpr size_t kMaxCallers = 16;
+
+// Number of times an idle thread polls for work before it blocks.
+constexpr int kSpinIterations = 1000;
+
+struct Job {
+  Job(const std::function<void(int64_t, int64_t)>& fn,
+      int64_t chunk_size,
+      int64_t numel)
+    : f(fn), min_chunk(chunk_size), remaining(numel) {}
+
+  const std::function<void(int64_t, int64_t)>& f;
+  const int64_t min_chunk;
+  // number of elements not processed yet, the job is complete at zero
+  std::atomic<int64_t> remaining;
+  std::atomic<bool> failed{false};
+  std::exception_ptr eptr;
+
+  // done is set under the mutex by the thread that completes the job; the
+  // caller must not destroy the job before it can lock the mutex again
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::atomic<bool> done{false};
+};
+
+struct Task {
+  Job* job;
+  int64_t begin;
+  int64_t end;
+};
+
+// Fixed-size Chase-Lev deque [1] of subranges, using the memory orders of
+// [2]. The owner pushes and pops at the bottom, other threads steal from the
+// top. Slots are atomics since a thief may read a slot that a push is
+// overwriting; its CAS on top fails in that case and the value is discarded.
+//
+// [1] D. Chase, Y. Lev. Dynamic Circular Work-Stealing Deque. SPAA 2005.
+// [2] N. M. Le et al. Correct and Efficient Work-Stealing for Weak Memory
+//     Models. PPoPP 2013.
+class TaskDeque {
+ public:
+  bool push(const Task& task) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t >= kDequeCapacity) {
+      return false;
+    }
+    Slot& slot = slots_[b % kDequeCapacity];
+    slot.job.store(task.job, std::memory_order_relaxed);
+    slot.begin.store(task.begin, std::memory_order_relaxed);
+    slot.end.store(task.end, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(Task& task) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    read(b, task);
+    if (t < b) {
+      return true;
+    }
+    // Last subrange in the deque, race thieves for it.
+    bool won = top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  // Steals the oldest subrange. If job is given, only a subrange of that job
+  // is taken.
+  bool steal(Task& task, const Job* job = nullptr) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return false;
+    }
+    read(t, task);
+    if (job && task.job != job) {
+      return false;
+    }
+    return top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    return bottom_.load(std::memory_order_seq_cst) <=
+        top_.load(std::memory_order_seq_cst);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<Job*> job{nullptr};
+    std::atomic<int64_t> begin{0};
+    std::atomic<int64_t> end{0};
+  };
+
+  void read(int64_t index, Task& task) const {
+    const Slot& slot = slots_[index % kDequeCapacity];
+    task.job = slot.job.load(std::memory_order_relaxed);
+    task.begin = slot.begin.load(std::memory_order_relaxed);
+    task.end = slot.end.load(std::memory_order_relaxed);
+  }
+
+  // top_ is written by thieves and bottom_ by the owner, keep them on
+  // separate cache lines
+  std::atomic<int64_t> top_{0};
+  char padding_[64];
+  std::atomic<int64_t> bottom_{0};
+  std::array<Slot, kDequeCapacity> slots_;
+};
+
+// RAII guard helps to support in_parallel_region() API.
+struct ParallelRegionGuard {
+  ParallelRegionGuard() {
+    in_parallel_region_ = true;
+  }
+
+  ~ParallelRegionGuard() {
+    in_parallel_region_ = false;
+  }
+};
+
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(size_t num_workers) {
+    for (auto& in_use : caller_in_use_) {
+      in_use = false;
+    }
+    for (size_t i = 0; i < kMaxCallers + num_workers; ++i) {
+      deques_.emplace_back(new TaskDeque());
+    }
+    for (size_t i = 0; i < num_workers; ++i) {
+      threads_.emplace_back([this, i]() { workerLoop(i); });
+    }
+  }
+
+  // number of worker threads, not counting calling threads
+  size_t size() const {
+    return threads_.size();
+  }
+
+  // Processes [begin, end) of the job on the calling thread, sharing it with
+  // the workers, and returns once the whole job is done.
+  void run(Job& job, int64_t begin, int64_t end) {
+    size_t caller = 0;
+    while (caller < kMaxCallers) {
+      bool expected = false;
+      if (caller_in_use_[caller].compare_exchange_strong(expected, true)) {
+        break;
+      }
+      ++caller;
+    }
+    if (caller == kMaxCallers) {
+      // too many concurrent callers, run without the pool
+      ParallelRegionGuard guard;
+      job.f(begin, end);
+      return;
+    }
+
+    TaskDeque& deque = *deques_[caller];
+    execute(deque, Task{&job, begin, end});
+
+    // Help with subranges of this job until it is done. The caller only takes
+    // subranges of its own job so that it returns as soon as possible.
+    int spins = 0;
+    while (!job.done.load(std::memory_order_acquire)) {
+      Task task;
+      if (deque.pop(task) || stealFrom(task, &job)) {
+        execute(deque, task);
+        spins = 0;
+      } else if (++spins < kSpinIterations) {
+        std::this_thread::yield();
+      } else {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.cv.wait(lock, [&job]() {
+          return job.done.load(std::memory_order_relaxed);
+        });
+      }
+    }
+    // wait for the completing thread to release the job
+    std::lock_guard<std::mutex> guard(job.mutex);
+    caller_in_use_[caller].store(false);
+  }
+
+  void launch(std::function<void()> fn) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      launched_.push_back(std::move(fn));
+      num_launched_.fetch_add(1);
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  // Processes a subrange in chunks of at least job->min_chunk elements.
+  // Whenever the local deque runs empty, i.e. its previous contents have been
+  // stolen or processed, the upper half of the remaining range is pushed for
+  // other threads to steal.
+  void execute(TaskDeque& deque, Task task) {
+    Job* job = task.job;
+    int64_t begin = task.begin;
+    int64_t end = task.end;
+    while (begin < end) {
+      if (end - begin >= 2 * job->min_chunk && deque.empty()) {
+        int64_t mid = begin + (end - begin) / 2;
+        if (deque.push(Task{job, mid, end})) {
+          end = mid;
+          notifyIdle();
+          continue;
+        }
+      }
+      int64_t chunk_end = std::min(end, begin + job->min_chunk);
+      if (!job->failed.load(std::memory_order_relaxed)) {
+        try {
+          ParallelRegionGuard guard;
+          job->f(begin, chunk_end);
+        } catch (...) {
+          if (!job->failed.exchange(true)) {
+            job->eptr = std::current_exception();
+          }
+        }
+      }
+      // the job may be destroyed once its last chunk is accounted for
+      int64_t numel = chunk_end - begin;
+      begin = chunk_end;
+      if (job->remaining.fetch_sub(numel, std::memory_order_acq_rel) == numel) {
+        std::lock_guard<std::mutex> guard(job->mutex);
+        job->done.store(true, std::memory_order_release);
+        job->cv.notify_one();
+      }
+    }
+  }
+
+  bool stealFrom(Task& task, const Job* job) {
+    thread_local uint32_t seed = static_cast<uint32_t>(
+        std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+    // xorshift32 to pick the first victim
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    size_t num_deques = deques_.size();
+    size_t start = seed % num_deques;
+    for (size_t i = 0; i < num_deques; ++i) {
+      if (deques_[(start + i) % num_deques]->steal(task, job)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool hasWork() {
+    if (num_launched_.load() > 0) {
+      return true;
+    }
+    for (auto& deque : deques_) {
+      if (!deque->empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void notifyIdle() {
+    // pairs with the increment of num_sleeping_ in sleep(): either the
+    // sleeping worker sees the new subrange or we see the sleeping worker
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_sleeping_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      cv_.notify_one();
+    }
+  }
+
+  void sleep() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    num_sleeping_.fetch_add(1);
+    if (!hasWork()) {
+      cv_.wait(lock);
+    }
+    num_sleeping_.fetch_sub(1);
+  }
+
+  bool runLaunched() {
+    std::function<void()> fn;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (launched_.empty()) {
+        return false;
+      }
+      fn = std::move(launched_.front());
+      launched_.pop_front();
+      num_launched_.fetch_sub(1);
+    }
+    try {
+      fn();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Exception in thread pool task: " << e.what();
+    } catch (...) {
+      LOG(ERROR) << "Exception in thread pool task: unknown";
+    }
+    return true;
+  }
+
+  void workerLoop(size_t worker) {
+    c10::setThreadName("PTWorkStealing");
+    at::init_num_threads();
+    in_pool_ = true;
+    thread_num_ = worker + 1;
+    TaskDeque& deque = *deques_[kMaxCallers + worker];
+    int spins = 0;
+    while (true) {
+      Task task;
+      if (deque.pop(task) || stealFrom(task, nullptr)) {
+        execute(deque, task);
+        spins = 0;
+      } else if (num_launched_.load(std::memory_order_relaxed) > 0 &&
+          runLaunched()) {
+        spins = 0;
+      } else if (++spins < kSpinIterations) {
+        std::this_thread::yield();
+      } else {
+        spins = 0;
+        sleep();
+      }
+    }
+  }
+
+  // deques of the calling threads first, then one per worker
+  std::vector<std::unique_ptr<TaskDeque>> deques_;
+  std::array<std::atomic<bool>, kMaxCallers> caller_in_use_;
+  std::vector<std::thread> threads_;
+
+  // guards launched_ and sleeping on cv_
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> launched_;
+  std::atomic<size_t> num_launched_{0};
+  std::atomic<int> num_sleeping_{0};
+};
+
+size_t _num_pool_threads(int nthreads) {
+  if (nthreads == NOT_SET) {
+    nthreads = intraop_default_num_threads();
+  } else {
+    TORCH_INTERNAL_ASSERT(nthreads > 0);
+  }
+  // minus one because of the calling thread
+  return nthreads - 1;
+}
+
+WorkStealingPool& _get_intraop_pool() {
+  // Leaked on purpose: the workers run until the process exits.
+  static WorkStealingPool* pool = new WorkStealingPool(
+      _num_pool_threads(num_intraop_threads.exchange(CONSUMED)));
+  return *pool;
+}
+
+} // namespace
+
+namespace internal {
+
+void _parallel_run(
+  const int64_t begin,
+  const int64_t end,
+  const int64_t grain_size,
+  const std::function<void(int64_t, int64_t)>& f) {
+  at::internal::lazy_init_num_threads();
+
+  int64_t nthreads = get_num_threads();
+  if (nthreads == 1) {
+    ParallelRegionGuard guard;
+    f(begin, end);
+    return;
+  }
+  int64_t min_chunk = std::max(
+      std::max(grain_size, (int64_t)1),
+      divup(end - begin, kChunksPerThread * nthreads));
+
+  Job job(f, min_chunk, end - begin);
+  _get_intraop_pool().run(job, begin, end);
+  if (job.eptr) {
+    std::rethrow_exception(job.eptr);
+  }
+}
+
+} // namespace internal
+
+void init_num_threads() {
+#ifdef _OPENMP
+  omp_set_num_threads(1);
+#endif
+
+#ifdef TH_BLAS_MKL
+  mkl_set_num_threads(1);
+#endif
+}
+
+void set_num_threads(int nthreads) {
+  TORCH_CHECK(nthreads > 0, "Expected positive number of threads");
+  int no_value = NOT_SET;
+  if (!num_intraop_threads.compare_exchange_strong(no_value, nthreads)) {
+    // num_intraop_threads either stores a positive integer or CONSUMED,
+    // check that requested size is the same as the current one
+    int stored_nthreads = num_intraop_threads.load();
+    if (stored_nthreads <= 0) {
+      // plus one because of the calling thread
+      stored_nthreads = _get_intraop_pool().size() + 1;
+    }
+    if (stored_nthreads != nthreads) {
+      TORCH_WARN(
+        "Cannot set number of intraop threads "
+        "after parallel work has started or after set_num_threads call "
+        "when using work-stealing parallel backend");
+    }
+  }
+}
+
+int get_num_threads() {
+  // not initializing pool unnecessarily,
+  // because pool cannot be resized after initialization
+  int nthreads = num_intraop_threads.load();
+  if (nthreads > 0) {
+    return nthreads;
+  } else if (nthreads == NOT_SET) {
+    return intraop_default_num_threads();
+  } else {
+    TORCH_INTERNAL_ASSERT(nthreads == CONSUMED);
+    return _get_intraop_pool().size() + 1;
+  }
+}
+
+int get_thread_num() {
+  return in_parallel_region_ ? thread_num_ : 0;
+}
+
+bool in_parallel_region() {
+  // in_pool_ is needed as intraop_launch() doesn't set in_parallel_region_
+  return in_parallel_region_ || in_pool_;
+}
+
+void intraop_launch(std::function<void()> func) {
+  if (!in_parallel_region() && get_num_threads() > 1) {
+    _get_intraop_pool().launch(std::move(func));
+  } else {
+    // execute inline if we're in parallel region
+    func();
+  }
+}
+
+std::shared_ptr<c10::ivalue::Future> intraop_launch_future(
+    std::function<void()> func) {
+  auto future = std::make_shared<c10::ivalue::Future>(c10::NoneType::get());
+  if (!in_parallel_region() && get_num_threads() > 1) {
+    _get_intraop_pool().launch(
+      [func, future]() {
+        func();
+        future->markCompleted();
+      }
+    );
+  } else {
+    func();
+    future->markCompleted();
+  }
+  return future;
+}
+
+} // namespace at
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define INTRA_OP_PARALLEL
+
+// Work-stealing intra-op backend (ATEN_THREADING=WORK_STEALING).
+//
+// Every pool worker owns a Chase-Lev deque; a thread calling parallel_for
+// claims a deque of its own for the duration of the call. The range is not cut
+// into get_num_threads() equal chunks up front. Instead, the owner of a range
+// processes it in chunks of at least grain_size elements and, whenever its
+// deque runs empty, splits off the upper half of what is left and pushes it
+// for idle workers to steal (lazy binary splitting). Uneven work is therefore
+// rebalanced while the op runs rather than waiting on the slowest chunk.
+//
+// Note that the user function may be called several times on the same thread
+// with adjacent subranges, and get_thread_num() identifies the worker rather
+// than the subrange.
+
+namespace at {
+namespace internal {
+
+CAFFE2_API void _parallel_run(
+  const int64_t begin,
+  const int64_t end,
+  const int64_t grain_size,
+  const std::function<void(int64_t, int64_t)>& f);
+
+} // namespace internal
+
+template <class F>
+inline void parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const F& f) {
+  TORCH_CHECK(grain_size >= 0);
+  if (begin >= end) {
+    return;
+  }
+  if ((end - begin) < grain_size || in_parallel_region()) {
+    f(begin, end);
+    return;
+  }
+  internal::_parallel_run(
+      begin,
+      end,
+      grain_size,
+      [&f](int64_t start, int64_t end) {
+        f(start, end);
+      }
+  );
+}
+
+template <class scalar_t, class F, class SF>
+inline scalar_t parallel_reduce(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const scalar_t ident,
+    const F& f,
+    const SF& sf) {
+  TORCH_CHECK(grain_size >= 0);
+  if (begin >= end) {
+    return ident;
+  }
+  if ((end - begin) < grain_size || in_parallel_region()) {
+    return f(begin, end, ident);
+  }
+  // Subranges are only known once they have been processed, so partial
+  // results are keyed by the start of their subrange and combined in order.
+  std::mutex mutex;
+  std::vector<std::pair<int64_t, scalar_t>> results;
+  internal::_parallel_run(
+      begin,
+      end,
+      grain_size,
+      [&f, &ident, &mutex, &results](int64_t start, int64_t end) {
+        scalar_t partial_result = f(start, end, ident);
+        std::lock_guard<std::mutex> guard(mutex);
+        results.emplace_back(start, std::move(partial_result));
+      }
+  );
+  std::sort(results.begin(), results.end(),
+      [](const std::pair<int64_t, scalar_t>& a,
+         const std::pair<int64_t, scalar_t>& b) {
+        return a.first < b.first;
+      });
+  scalar_t result = ident;
+  for (auto& partial_result : results) {
+    result = sf(result, partial_result.second);
+  }
+  return result;
+}
+
+} // namespace at
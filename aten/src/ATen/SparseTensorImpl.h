@@ -4,6 +4,8 @@
 #include <c10/core/TensorImpl.h>
 #include <c10/util/Exception.h>
 
+#include <mutex>
+
 namespace at {
 struct CAFFE2_API SparseTensorImpl : public TensorImpl {
   // Stored in COO format, indices + values.
@@ -29,6 +31,17 @@ struct CAFFE2_API SparseTensorImpl : public TensorImpl {
   // because many algorithms proceed by merging two sorted lists (of indices).
   bool coalesced_ = false;
 
+  // Row pointers of the CSR form of a coalesced matrix (sparse_dim == 2),
+  // cached by the sparse-dense matmuls, which set and check them through
+  // set_crow_indices / crow_indices. They are only valid for the indices_
+  // they were computed from, at the version and nnz they had then. The mutex
+  // lets products on the same tensor run from several threads.
+  mutable std::mutex crow_indices_mutex_;
+  Tensor crow_indices_;
+  const TensorImpl* crow_indices_source_ = nullptr;
+  uint32_t crow_indices_version_ = 0;
+  int64_t crow_indices_nnz_ = 0;
+
 public:
   // Public for now...
   explicit SparseTensorImpl(at::DispatchKeySet, const caffe2::TypeMeta&);
@@ -40,6 +53,31 @@ public:
   Tensor indices() const { return indices_; }
   Tensor values() const { return values_; }
 
+  // Returns the cached CSR row pointers if they are still valid for the
+  // current indices, and an undefined tensor otherwise.
+  Tensor crow_indices() const {
+    std::lock_guard<std::mutex> guard(crow_indices_mutex_);
+    if (!crow_indices_.defined() || !coalesced_ || sparse_dim_ != 2 ||
+        crow_indices_source_ != indices_.unsafeGetTensorImpl() ||
+        crow_indices_version_ != indices_.unsafeGetTensorImpl()->version_counter().current_version() ||
+        crow_indices_nnz_ != nnz() ||
+        crow_indices_.numel() != sizes_and_strides_.size_at_unchecked(0) + 1) {
+      return Tensor();
+    }
+    return crow_indices_;
+  }
+
+  // Caches the CSR row pointers computed from the current indices of a
+  // coalesced matrix, until the indices change.
+  void set_crow_indices(const Tensor& crow_indices) {
+    TORCH_INTERNAL_ASSERT(coalesced_ && sparse_dim_ == 2);
+    std::lock_guard<std::mutex> guard(crow_indices_mutex_);
+    crow_indices_ = crow_indices;
+    crow_indices_source_ = indices_.unsafeGetTensorImpl();
+    crow_indices_version_ = indices_.unsafeGetTensorImpl()->version_counter().current_version();
+    crow_indices_nnz_ = nnz();
+  }
+
   IntArrayRef strides() const override;
   bool is_contiguous(at::MemoryFormat memory_format=at::MemoryFormat::Contiguous) const override;
   int64_t stride(int64_t d) const override;
@@ -56,7 +94,7 @@ public:
   // respect to indices and values
   void raw_resize_(int64_t sparse_dim, int64_t dense_dim, IntArrayRef size) {
     TORCH_CHECK(allow_tensor_metadata_change(), "raw_resize_ ", err_msg_tensor_metadata_change_not_allowed);
-    sizes_ = size.vec();
+    sizes_and_strides_.set_sizes(size);
     sparse_dim_ = sparse_dim;
     dense_dim_ = dense_dim;
     refresh_numel();
@@ -126,7 +164,7 @@ public:
         "shrinking the size of dense dimensions (from ", dense_size_original, " to ", dense_size_new, ") on a non-empty sparse tensor is not supported.\n", alt_options_msg);
     }
 
-    if ((!size.equals(sizes_)) || (sparse_dim != sparse_dim_) || (dense_dim != dense_dim_)) {
+    if ((!size.equals(sizes_and_strides_.sizes_arrayref())) || (sparse_dim != sparse_dim_) || (dense_dim != dense_dim_)) {
       auto nnz = values().size(0);
       std::vector<int64_t> values_size = {nnz};
       auto dense_size = size.slice(sparse_dim);
@@ -135,9 +173,10 @@ public:
       indices_.resize_({sparse_dim, nnz});
     }
 
-    sizes_ = size.vec();
+    sizes_and_strides_.set_sizes(size);
     sparse_dim_ = sparse_dim;
     dense_dim_ = dense_dim;
+    crow_indices_.reset();
     refresh_numel();
   }
 
@@ -146,7 +185,7 @@ public:
     TORCH_CHECK(allow_tensor_metadata_change(), "resize_and_clear_ ", err_msg_tensor_metadata_change_not_allowed);
     TORCH_CHECK(sparse_dim + dense_dim == static_cast<int64_t>(size.size()), "number of dimensions must be sparse_dim (", sparse_dim, ") + dense_dim (", dense_dim, "), but got ", size.size());
 
-    sizes_ = size.vec();
+    sizes_and_strides_.set_sizes(size);
     sparse_dim_ = sparse_dim;
     dense_dim_ = dense_dim;
 
@@ -170,6 +209,7 @@ public:
     AT_ASSERT(new_nnz <= nnz());
     indices_ = indices_.narrow(1, 0, new_nnz);
     values_ = values_.narrow(0, 0, new_nnz);
+    crow_indices_.reset();
   }
 
   // Takes indices and values and directly puts them into the sparse tensor, no copy.
@@ -238,6 +278,11 @@ private:
     dest_sparse_impl->indices_ = src_sparse_impl->indices();
     dest_sparse_impl->values_ = src_sparse_impl->values();
     dest_sparse_impl->coalesced_ = src_sparse_impl->coalesced();
+    std::lock_guard<std::mutex> guard(src_sparse_impl->crow_indices_mutex_);
+    dest_sparse_impl->crow_indices_ = src_sparse_impl->crow_indices_;
+    dest_sparse_impl->crow_indices_source_ = src_sparse_impl->crow_indices_source_;
+    dest_sparse_impl->crow_indices_version_ = src_sparse_impl->crow_indices_version_;
+    dest_sparse_impl->crow_indices_nnz_ = src_sparse_impl->crow_indices_nnz_;
   }
 };
 
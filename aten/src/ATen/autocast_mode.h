@@ -1,11 +1,49 @@
 #pragma once
 
+#include <c10/macros/Export.h>
+
+#include <cstdint>
+
 namespace at {
 namespace autocast {
 
 TORCH_API bool is_enabled();
 TORCH_API void set_enabled(bool enabled);
+TORCH_API bool is_cpu_enabled();
+TORCH_API void set_cpu_enabled(bool enabled);
+// Drops the cached casts of the calling thread. With a persistent cache, only
+// the casts that have autograd history or whose source was freed are dropped.
 TORCH_API void clear_cache();
+
+// Statistics of the cast cache of the calling thread.
+struct CacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  // Misses because the source was modified in place since it was cast.
+  int64_t invalidations = 0;
+  int64_t evictions = 0;
+  int64_t entries = 0;
+  int64_t bytes = 0;
+};
+
+// A persistent cache keeps the casts made with grad disabled across autocast
+// regions, so that inference doesn't cast the weights again every iteration.
+// A cast is reused as long as the version of its source is unchanged, and the
+// source still points to the same data (p.data = t is detected).
+//
+// In-place updates through p.data, e.g. p.data.copy_(w), bump the version of
+// the p.data tensor and not the one of p, so they are NOT detected and the
+// stale cast keeps being used. Update the parameters in place under no_grad
+// instead (with torch.no_grad(): p.copy_(w)), or turn the persistent cache
+// off and on again, which drops the casts of the calling thread.
+TORCH_API void set_cache_persistent(bool persistent);
+TORCH_API bool is_cache_persistent();
+// Bytes of casts a thread may cache, the least recently used ones are
+// evicted beyond. 0 means no limit.
+TORCH_API void set_cache_max_bytes(int64_t max_bytes);
+TORCH_API int64_t get_cache_max_bytes();
+TORCH_API CacheStats get_cache_stats();
+TORCH_API void reset_cache_stats();
 TORCH_API int increment_nesting();
 TORCH_API int decrement_nesting();
 
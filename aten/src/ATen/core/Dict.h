@@ -6,6 +6,7 @@
 #include <c10/util/intrusive_ptr.h>
 #include <c10/util/order_preserving_flat_hash_map.h>
 #include <c10/util/Optional.h>
+#include <c10/util/string_view.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 #include <ATen/core/TensorBody.h>
 
@@ -30,6 +31,8 @@ namespace detail {
 
 struct DictKeyHash {
   size_t operator()(const IValue& ivalue) const;
+  // Hash of a string key, equal to the hash of the IValue holding it.
+  static size_t hashString(c10::string_view str);
 };
 
 struct DictKeyEqualTo {
@@ -51,6 +54,8 @@ struct DictImpl final : public c10::intrusive_ptr_target {
   DictElementTypes elementTypes;
 
   intrusive_ptr<DictImpl> copy() const;
+  // Looks up a string key without creating an IValue for it.
+  dict_map_type::iterator findString(c10::string_view key);
   friend TORCH_API bool operator==(const DictImpl& lhs, const DictImpl& rhs);
 };
 
@@ -316,6 +321,15 @@ public:
    */
   Value at(const Key& key) const;
 
+  /**
+   * Returns the mapped value of the element with key equal to key, in a dict
+   * with string keys. Unlike at(const Key&), this doesn't need to create a
+   * string.
+   * If no such element exists, an exception of type std::out_of_range is thrown.
+   */
+  template<class Key_ = Key>
+  std::enable_if_t<std::is_same<Key_, std::string>::value, Value> at(c10::string_view key) const;
+
   /**
    * Finds an element with key equivalent to key.
    *
@@ -324,6 +338,13 @@ public:
    */
   iterator find(const Key& key) const;
 
+  /**
+   * Finds an element with key equal to key, in a dict with string keys.
+   * Unlike find(const Key&), this doesn't need to create a string.
+   */
+  template<class Key_ = Key>
+  std::enable_if_t<std::is_same<Key_, std::string>::value, iterator> find(c10::string_view key) const;
+
   /**
    * Checks if there is an element with key equivalent to key in the container.
    *
@@ -331,6 +352,14 @@ public:
    */
   bool contains(const Key& key) const;
 
+  /**
+   * Checks if there is an element with key equal to key, in a dict with
+   * string keys. Unlike contains(const Key&), this doesn't need to create a
+   * string.
+   */
+  template<class Key_ = Key>
+  std::enable_if_t<std::is_same<Key_, std::string>::value, bool> contains(c10::string_view key) const;
+
   /**
    * Increase the capacity so that at least count elements can be stored without
    * having to reallocate or rehash.
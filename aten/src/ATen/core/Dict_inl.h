@@ -36,17 +36,29 @@ GenericDict toGenericDict(Dict<Key, Value> dict) {
 
 namespace detail {
 
+inline size_t DictKeyHash::hashString(c10::string_view str) {
+  // FNV-1a. std::hash<std::string> would force the lookups by string_view to
+  // create a std::string.
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : str) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
 inline size_t DictKeyHash::operator()(const IValue& ivalue) const {
   if (ivalue.isInt()) {
-    return std::hash<int>()(ivalue.toInt());
+    return std::hash<int64_t>()(ivalue.toInt());
   } else if (ivalue.isString()) {
-    return std::hash<std::string>()(ivalue.toStringRef());
+    return hashString(ivalue.toStringRef());
   } else if (ivalue.isDouble()) {
     return std::hash<double>()(ivalue.toDouble());
   } else if (ivalue.isBool()) {
     return std::hash<bool>()(ivalue.toBool());
   } else if (ivalue.isTensor()) {
-    return std::hash<TensorImpl*>()(ivalue.toTensor().unsafeGetTensorImpl());
+    // Unlike toTensor(), doesn't increment the refcount of the tensor.
+    return std::hash<TensorImpl*>()(ivalue.unsafeToTensorImpl());
   } else {
     throw std::runtime_error(
         "Can't hash IValues with tag '" + ivalue.tagKind() + "'");
@@ -57,6 +69,26 @@ inline intrusive_ptr<DictImpl> DictImpl::copy() const {
   return make_intrusive<DictImpl>(dict, elementTypes);
 }
 
+inline DictImpl::dict_map_type::iterator DictImpl::findString(c10::string_view key) {
+  return dict.find_with(
+      key,
+      [](c10::string_view key) { return DictKeyHash::hashString(key); },
+      [](c10::string_view key, const dict_map_type::value_type& entry) {
+        return entry.first.isString() &&
+            c10::string_view(entry.first.toStringRef()) == key;
+      });
+}
+
+template<class Key>
+DictImpl::dict_map_type::iterator findKey(DictImpl& impl, const Key& key) {
+  return impl.dict.find(key);
+}
+
+// Doesn't copy the key into an IValue.
+inline DictImpl::dict_map_type::iterator findKey(DictImpl& impl, const std::string& key) {
+  return impl.findString(key);
+}
+
 }
 
 template<class Key, class Value>
@@ -156,12 +188,32 @@ C10_NODISCARD size_t Dict<Key, Value>::erase(const Key& key) const {
 
 template<class Key, class Value>
 Value Dict<Key, Value>::at(const Key& key) const {
-  return impl_->dict.at(key).template to<Value>();
+  auto found = detail::findKey(*impl_, key);
+  if (found == impl_->dict.end()) {
+    throw std::out_of_range("Argument passed to at() was not in the map.");
+  }
+  return found->second.template to<Value>();
+}
+
+template<class Key, class Value>
+template<class Key_>
+std::enable_if_t<std::is_same<Key_, std::string>::value, Value> Dict<Key, Value>::at(c10::string_view key) const {
+  auto found = impl_->findString(key);
+  if (found == impl_->dict.end()) {
+    throw std::out_of_range("Argument passed to at() was not in the map.");
+  }
+  return found->second.template to<Value>();
 }
 
 template<class Key, class Value>
 typename Dict<Key, Value>::iterator Dict<Key, Value>::find(const Key& key) const {
-  return iterator{impl_->dict.find(key)};
+  return iterator{detail::findKey(*impl_, key)};
+}
+
+template<class Key, class Value>
+template<class Key_>
+std::enable_if_t<std::is_same<Key_, std::string>::value, typename Dict<Key, Value>::iterator> Dict<Key, Value>::find(c10::string_view key) const {
+  return iterator{impl_->findString(key)};
 }
 
 template<class Key, class Value>
@@ -169,6 +221,12 @@ bool Dict<Key, Value>::contains(const Key& key) const {
   return end() != find(key);
 }
 
+template<class Key, class Value>
+template<class Key_>
+std::enable_if_t<std::is_same<Key_, std::string>::value, bool> Dict<Key, Value>::contains(c10::string_view key) const {
+  return end() != find(key);
+}
+
 template<class Key, class Value>
 void Dict<Key, Value>::reserve(size_type count) const {
   impl_->dict.reserve(count);
@@ -0,0 +1,50 @@
+#include <ATen/core/InferenceMode.h>
+
+#include <c10/core/impl/InferenceModeState.h>
+#include <c10/core/impl/LocalDispatchKeySet.h>
+
+#include <stdexcept>
+
+namespace at {
+
+/// Like `at::GradMode`, `at::InferenceMode` is only provided when thread_local
+/// is available.
+#if !defined(C10_MOBILE) || defined(FEATURE_TORCH_MOBILE)
+
+// Whether Autograd was already excluded, e.g. by an AutoNonVariableTypeMode,
+// when inference mode was enabled, in which case disabling it leaves Autograd
+// excluded.
+thread_local bool InferenceMode_autograd_was_excluded = false;
+
+bool InferenceMode::is_enabled() {
+  return c10::impl::tls_is_inference_mode_enabled();
+}
+
+void InferenceMode::set_enabled(bool enabled) {
+  if (enabled == c10::impl::tls_is_inference_mode_enabled()) {
+    return;
+  }
+  c10::impl::tls_set_inference_mode_enabled(enabled);
+  if (enabled) {
+    InferenceMode_autograd_was_excluded =
+        c10::impl::tls_is_dispatch_key_excluded(DispatchKey::Autograd);
+    c10::impl::tls_set_dispatch_key_excluded(DispatchKey::Autograd, true);
+    GradMode::set_enabled(false);
+  } else if (!InferenceMode_autograd_was_excluded) {
+    c10::impl::tls_set_dispatch_key_excluded(DispatchKey::Autograd, false);
+  }
+}
+
+#else
+
+bool InferenceMode::is_enabled() {
+  return false;
+}
+
+void InferenceMode::set_enabled(bool enabled) {
+  throw std::runtime_error("InferenceMode is not supported on mobile");
+}
+
+#endif
+
+} // namespace at
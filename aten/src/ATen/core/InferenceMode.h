@@ -0,0 +1,56 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+#include <ATen/core/grad_mode.h>
+
+namespace at {
+
+// Inference mode is a stricter no_grad mode for code that never runs
+// backward through the tensors it computes.  On top of disabling grad mode,
+// it excludes DispatchKey::Autograd from the thread local dispatch key set,
+// so operators go straight to their backend kernels instead of through the
+// VariableType kernels: no autograd metadata is looked up or created for
+// their inputs and outputs, and in-place operations don't bump the version
+// counters of the tensors they modify.
+//
+// The tensors created in inference mode, views included, are inference
+// tensors (see TensorImpl::is_inference()), and so are the views of inference
+// tensors created outside of it.  As their version counters can't be
+// trusted, outside of inference mode autograd refuses to save them for
+// backward, to let them require grad, or to update them in-place.  Use a
+// clone instead.
+//
+// Normal tensors can still be updated in-place in inference mode, without
+// bumping their version counters, so such modifications to tensors saved for
+// backward outside of it are not detected.  Only use inference mode on
+// tensors that don't take part in a graph that is later backpropagated
+// through.
+//
+// The Tracer and Autocast keys don't need to be excluded: they are only
+// dispatched to when they are in the thread local included set, that is,
+// while tracing or autocasting.
+struct CAFFE2_API InferenceMode {
+  static bool is_enabled();
+  // Non-RAII API, for the Python context manager, which restores grad mode
+  // itself.  Enabling inference mode also disables grad mode.
+  static void set_enabled(bool enabled);
+};
+
+// A RAII, thread local (!) guard that enables or disables inference mode
+// upon construction, and restores inference mode and grad mode upon
+// destruction.
+struct CAFFE2_API AutoInferenceMode {
+  AutoInferenceMode(bool enabled = true)
+      : prev_mode(InferenceMode::is_enabled()),
+        prev_grad_mode(GradMode::is_enabled()) {
+    InferenceMode::set_enabled(enabled);
+  }
+  ~AutoInferenceMode() {
+    InferenceMode::set_enabled(prev_mode);
+    GradMode::set_enabled(prev_grad_mode);
+  }
+  bool prev_mode;
+  bool prev_grad_mode;
+};
+
+}
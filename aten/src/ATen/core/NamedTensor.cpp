@@ -7,6 +7,8 @@ namespace at {
 
 thread_local bool NamesMode_enabled = true;
 
+std::atomic<int64_t> NamedTensorMeta::num_alive_{0};
+
 bool NamesMode::is_enabled() {
   return NamesMode_enabled;
 }
@@ -67,17 +69,21 @@ void check_names_valid_for(size_t tensor_dim, DimnameList names) {
 namespace impl {
 
 static NamedTensorMeta* get_named_tensor_meta(TensorImpl* impl) {
-  if (!NamesMode::is_enabled()) {
+  // Unnamed tensors don't need the thread local NamesMode.
+  auto* meta = impl->named_tensor_meta();
+  if (meta == nullptr || !NamesMode::is_enabled()) {
     return nullptr;
   }
-  return static_cast<NamedTensorMeta*>(impl->named_tensor_meta());
+  return static_cast<NamedTensorMeta*>(meta);
 }
 
 static const NamedTensorMeta* get_named_tensor_meta(const TensorImpl* impl) {
-  if (!NamesMode::is_enabled()) {
+  // Unnamed tensors don't need the thread local NamesMode.
+  auto* meta = impl->named_tensor_meta();
+  if (meta == nullptr || !NamesMode::is_enabled()) {
     return nullptr;
   }
-  return static_cast<const NamedTensorMeta*>(impl->named_tensor_meta());
+  return static_cast<const NamedTensorMeta*>(meta);
 }
 
 void check_names_valid_for(TensorImpl* impl, DimnameList names) {
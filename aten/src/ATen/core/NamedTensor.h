@@ -4,6 +4,8 @@
 #include <c10/core/TensorImpl.h>
 #include <c10/util/C++17.h>
 
+#include <atomic>
+
 namespace at {
 
 // XXX: This file exists because TensorImpl is in c10, but Dimname is in ATen.
@@ -29,10 +31,22 @@ struct CAFFE2_API NamedTensorMeta final : public c10::NamedTensorMetaInterface {
   explicit NamedTensorMeta(HAS_NON_WILDCARD, DimnameList names)
     : names_(names.vec()) {
     check_invariants();
+    num_alive_.fetch_add(1, std::memory_order_relaxed);
   }
   explicit NamedTensorMeta(HAS_NON_WILDCARD, std::vector<Dimname>&& names)
     : names_(std::move(names)) {
     check_invariants();
+    num_alive_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ~NamedTensorMeta() override {
+    num_alive_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Returns false if no tensor of the process has names. Name inference can
+  // then be skipped without looking at the tensors or at NamesMode.
+  static bool any_alive() {
+    return num_alive_.load(std::memory_order_relaxed) != 0;
   }
 
   std::unique_ptr<c10::NamedTensorMetaInterface> clone() const override {
@@ -65,6 +79,10 @@ struct CAFFE2_API NamedTensorMeta final : public c10::NamedTensorMetaInterface {
 
   // INVARIANT: at least one Dimname is non-WILDCARD
   std::vector<Dimname> names_;
+
+ private:
+  // Number of NamedTensorMeta that exist, i.e. of tensors with names.
+  static std::atomic<int64_t> num_alive_;
 };
 
 // When NamesMode is disabled, then all operations ignore tensors' names fields.
@@ -37,8 +37,8 @@ typedef at::detail::Array<float, 2> FLOAT2;
  * Refer to: http://www.thesalmons.org/john/random123/papers/random123sc11.pdf
  * for details regarding the engine.
  *
- * Note that currently this implementation of the philox engine is not used
- * anywhere except for tests in cpu_generator_test.cpp. However, this engine
+ * On CPU, this engine backs the parallel uniform_, normal_ and bernoulli_
+ * kernels (see Note [Parallel CPU random number generation]). On CUDA, it
  * will replace curandStatePhilox4_32_10_t in the future.
  * 
  * The philox engine takes a seed value, a subsequeunce
@@ -286,6 +286,7 @@ _(aten, cumprod) \
 _(aten, cumsum) \
 _(aten, data_ptr) \
 _(aten, deg2rad) \
+_(aten, dequantize) \
 _(aten, det) \
 _(aten, detach) \
 _(aten, diag) \
@@ -368,6 +369,7 @@ _(aten, hardshrink) \
 _(aten, hardshrink_backward) \
 _(aten, hardsigmoid) \
 _(aten, hardsigmoid_backward) \
+_(aten, hardswish) \
 _(aten, hardtanh) \
 _(aten, hardtanh_backward) \
 _(aten, hardtanh_forward) \
@@ -550,6 +552,7 @@ _(aten, prelu_backward) \
 _(aten, prod) \
 _(aten, put) \
 _(aten, qr) \
+_(aten, quantize_per_tensor) \
 _(aten, rad2deg) \
 _(aten, rand) \
 _(aten, rand_like) \
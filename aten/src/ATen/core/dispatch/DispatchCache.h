@@ -0,0 +1,91 @@
+#pragma once
+
+#include <ATen/core/boxing/KernelFunction.h>
+#include <c10/core/DispatchKeySet.h>
+#include <c10/core/impl/LocalDispatchKeySet.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace c10 {
+namespace impl {
+
+/**
+ * A single-entry cache of a dispatch decision, i.e. of the kernel that
+ * Dispatcher::call/callBoxed chose for a given set of argument dispatch keys.
+ *
+ * The kernel chosen for an operator call only depends on
+ *  - the DispatchKeySet of the arguments,
+ *  - the thread-local included/excluded DispatchKeySets, and
+ *  - the registrations with the dispatcher,
+ * so the cache stores the first two as they were when the kernel was looked
+ * up, and the dispatcher epoch, which is bumped whenever a registration
+ * changes. A call site that sees the same inputs over and over (e.g. a node of
+ * a TorchScript graph) can then skip computing the dispatch key and walking
+ * the dispatch tables.
+ *
+ * Lookups and updates are thread-safe: the entry is protected by a seqlock, so
+ * concurrent readers never block and never see a torn entry. If two threads
+ * update the entry at the same time, one of the updates is dropped.
+ */
+class DispatchCache final {
+public:
+  DispatchCache()
+  : seq_(0)
+  , epoch_(0)
+  , keySet_(0)
+  , included_(0)
+  , excluded_(0)
+  , kernel_(nullptr) {}
+
+  // A copy starts out empty, so that copied call sites don't share an entry.
+  DispatchCache(const DispatchCache&) : DispatchCache() {}
+  DispatchCache& operator=(const DispatchCache&) {
+    return *this;
+  }
+
+  // Returns the cached kernel if the entry matches, nullptr otherwise.
+  const KernelFunction* lookup(uint64_t epoch, DispatchKeySet ks, const LocalDispatchKeySet& local) const {
+    const uint64_t seq = seq_.load(std::memory_order_acquire);
+    if (C10_UNLIKELY(seq & 1)) {
+      return nullptr;
+    }
+    const KernelFunction* kernel = kernel_.load(std::memory_order_relaxed);
+    const bool hit = epoch_.load(std::memory_order_relaxed) == epoch &&
+        keySet_.load(std::memory_order_relaxed) == ks.raw_repr() &&
+        included_.load(std::memory_order_relaxed) == local.included_.raw_repr() &&
+        excluded_.load(std::memory_order_relaxed) == local.excluded_.raw_repr();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (C10_UNLIKELY(seq_.load(std::memory_order_relaxed) != seq)) {
+      return nullptr;
+    }
+    return hit ? kernel : nullptr;
+  }
+
+  void update(uint64_t epoch, DispatchKeySet ks, const LocalDispatchKeySet& local, const KernelFunction* kernel) {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    if ((seq & 1) || !seq_.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+      // Another thread is updating the entry.
+      return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    epoch_.store(epoch, std::memory_order_relaxed);
+    keySet_.store(ks.raw_repr(), std::memory_order_relaxed);
+    included_.store(local.included_.raw_repr(), std::memory_order_relaxed);
+    excluded_.store(local.excluded_.raw_repr(), std::memory_order_relaxed);
+    kernel_.store(kernel, std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+private:
+  // Odd while an update is in progress.
+  std::atomic<uint64_t> seq_;
+  std::atomic<uint64_t> epoch_;
+  std::atomic<uint64_t> keySet_;
+  std::atomic<uint64_t> included_;
+  std::atomic<uint64_t> excluded_;
+  std::atomic<const KernelFunction*> kernel_;
+};
+
+} // namespace impl
+} // namespace c10
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <ATen/core/boxing/impl/test_helpers.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+using c10::CachedOperatorHandle;
+using c10::Dispatcher;
+using c10::DispatchKey;
+using c10::OperatorKernel;
+using c10::TypedCachedOperatorHandle;
+using at::Tensor;
+
+namespace {
+
+struct CountingKernel final : OperatorKernel {
+  explicit CountingKernel(int* count): count_(count) {}
+
+  int64_t operator()(Tensor) {
+    return ++*count_;
+  }
+private:
+  int* count_;
+};
+
+TEST(DispatchCacheTest, givenCachedHandle_whenCalledRepeatedly_thenCallsSameKernelAsDispatcher) {
+  int cpu_count = 0;
+  int xla_count = 0;
+  auto registrar = c10::RegisterOperators().op("_test::cached(Tensor dummy) -> int", c10::RegisterOperators::options()
+      .kernel<CountingKernel>(DispatchKey::CPU, &cpu_count)
+      .kernel<CountingKernel>(DispatchKey::XLA, &xla_count));
+  auto op = Dispatcher::singleton().findSchema({"_test::cached", ""});
+  ASSERT_TRUE(op.has_value());
+
+  TypedCachedOperatorHandle<int64_t (Tensor)> typed(op->typed<int64_t (Tensor)>());
+  CachedOperatorHandle boxed(*op);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(2 * i + 1, typed.call(dummyTensor(DispatchKey::CPU)));
+    auto stack = makeStack(dummyTensor(DispatchKey::CPU));
+    boxed.callBoxed(&stack);
+    EXPECT_EQ(2 * i + 2, stack[0].toInt());
+  }
+  EXPECT_EQ(0, xla_count);
+
+  // A different dispatch key misses the cache.
+  EXPECT_EQ(1, typed.call(dummyTensor(DispatchKey::XLA)));
+  EXPECT_EQ(2, typed.call(dummyTensor(DispatchKey::XLA)));
+  EXPECT_EQ(7, typed.call(dummyTensor(DispatchKey::CPU)));
+}
+
+TEST(DispatchCacheTest, givenCachedHandle_whenKernelIsRegisteredAndDeregistered_thenCallsCurrentKernel) {
+  int count1 = 0;
+  int count2 = 0;
+  auto registrar1 = c10::RegisterOperators().op("_test::cached(Tensor dummy) -> int", c10::RegisterOperators::options().kernel<CountingKernel>(DispatchKey::CPU, &count1));
+  auto op = Dispatcher::singleton().findSchema({"_test::cached", ""});
+  ASSERT_TRUE(op.has_value());
+
+  TypedCachedOperatorHandle<int64_t (Tensor)> cached(op->typed<int64_t (Tensor)>());
+  cached.call(dummyTensor(DispatchKey::CPU));
+  EXPECT_EQ(1, count1);
+
+  {
+    auto registrar2 = c10::RegisterOperators().op("_test::cached(Tensor dummy) -> int", c10::RegisterOperators::options().kernel<CountingKernel>(DispatchKey::CPU, &count2));
+    cached.call(dummyTensor(DispatchKey::CPU));
+    EXPECT_EQ(1, count1);
+    EXPECT_EQ(1, count2);
+  }
+
+  cached.call(dummyTensor(DispatchKey::CPU));
+  EXPECT_EQ(2, count1);
+  EXPECT_EQ(1, count2);
+}
+
+TEST(DispatchCacheTest, givenCachedHandle_whenTLSIncludesKey_thenCallsKernelForIncludedKey) {
+  int cpu_count = 0;
+  int mode_count = 0;
+  auto registrar = c10::RegisterOperators().op("_test::cached(Tensor dummy) -> int", c10::RegisterOperators::options()
+      .kernel<CountingKernel>(DispatchKey::CPU, &cpu_count)
+      .kernel<CountingKernel>(DispatchKey::TESTING_ONLY_GenericMode, &mode_count));
+  auto op = Dispatcher::singleton().findSchema({"_test::cached", ""});
+  ASSERT_TRUE(op.has_value());
+
+  CachedOperatorHandle cached(*op);
+  auto stack = makeStack(dummyTensor(DispatchKey::CPU));
+  cached.callBoxed(&stack);
+  EXPECT_EQ(1, cpu_count);
+  {
+    c10::impl::IncludeDispatchKeyGuard guard(DispatchKey::TESTING_ONLY_GenericMode);
+    stack = makeStack(dummyTensor(DispatchKey::CPU));
+    cached.callBoxed(&stack);
+    EXPECT_EQ(1, cpu_count);
+    EXPECT_EQ(1, mode_count);
+  }
+  stack = makeStack(dummyTensor(DispatchKey::CPU));
+  cached.callBoxed(&stack);
+  EXPECT_EQ(2, cpu_count);
+  EXPECT_EQ(1, mode_count);
+}
+
+}
@@ -120,6 +120,18 @@ public:
   }
 
   DispatchKey getDispatchKeyBoxed(DispatchKeySet backendsWithoutFallthrough, const torch::jit::Stack* stack) const {
+    return dispatchKeySetToDispatchKey_(backendsWithoutFallthrough, DispatchKeySet::FULL, getDispatchKeySetBoxed(stack));
+  }
+
+  template<class... Args>
+  DispatchKey getDispatchKeyUnboxed(DispatchKeySet backendsWithoutFallthrough, DispatchKeySet eligibleKeys, const Args&... args) const {
+    auto ks = detail::multi_dispatch_key_set(args...);
+    return dispatchKeySetToDispatchKey_(backendsWithoutFallthrough, eligibleKeys, ks);
+  }
+
+  // The DispatchKeySet of the arguments, before TLS and fallthrough are taken
+  // into account; getDispatchKey() turns it into the DispatchKey.
+  DispatchKeySet getDispatchKeySetBoxed(const torch::jit::Stack* stack) const {
     DispatchKeySet ks;
     dispatch_arg_indices_reverse_.for_each_set_bit([&] (size_t reverse_arg_index) {
       const auto& ivalue = torch::jit::peek(*stack, 0, reverse_arg_index + 1);
@@ -133,12 +145,15 @@ public:
         }
       }
     });
-    return dispatchKeySetToDispatchKey_(backendsWithoutFallthrough, DispatchKeySet::FULL, ks);
+    return ks;
   }
 
   template<class... Args>
-  DispatchKey getDispatchKeyUnboxed(DispatchKeySet backendsWithoutFallthrough, DispatchKeySet eligibleKeys, const Args&... args) const {
-    auto ks = detail::multi_dispatch_key_set(args...);
+  DispatchKeySet getDispatchKeySetUnboxed(const Args&... args) const {
+    return detail::multi_dispatch_key_set(args...);
+  }
+
+  DispatchKey getDispatchKey(DispatchKeySet backendsWithoutFallthrough, DispatchKeySet eligibleKeys, DispatchKeySet ks) const {
     return dispatchKeySetToDispatchKey_(backendsWithoutFallthrough, eligibleKeys, ks);
   }
 
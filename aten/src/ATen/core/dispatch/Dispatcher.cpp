@@ -40,7 +40,8 @@ Dispatcher::Dispatcher()
 , backendFallbackKernels_()
 , backendsWithoutFallthrough_(DispatchKeySet::FULL)
 , listeners_(std::make_unique<detail::RegistrationListenerList>())
-, mutex_() {}
+, mutex_()
+, epoch_(1) {}
 
 Dispatcher::~Dispatcher() {}
 
@@ -138,6 +139,7 @@ RegistrationHandleRAII Dispatcher::registerDef(FunctionSchema schema, std::strin
   if (op.operatorIterator_->def_count == 0) {
     // NB: registerSchema is not idempotent! Only do it once!
     op.operatorIterator_->op.registerSchema(std::move(schema), std::move(debug));
+    bumpEpoch_();
     listeners_->callOnOperatorRegistered(op);
   } else {
     checkSchemaCompatibility(op, schema, debug);
@@ -189,6 +191,7 @@ void Dispatcher::deregisterDef_(const OperatorHandle& op, const OperatorName& op
     // invariant
     listeners_->callOnOperatorDeregistered(op);
     op.operatorIterator_->op.deregisterSchema();
+    bumpEpoch_();
   }
 
   cleanup(op, op_name);
@@ -207,6 +210,7 @@ RegistrationHandleRAII Dispatcher::registerImpl(
   auto op = findOrRegisterName_(op_name);
 
   auto handle = op.operatorIterator_->op.registerKernel(dispatch_key, std::move(kernel), std::move(cpp_signature), std::move(inferred_function_schema), std::move(debug));
+  bumpEpoch_();
 
   ++op.operatorIterator_->def_and_impl_count;
 
@@ -219,6 +223,7 @@ void Dispatcher::deregisterImpl_(const OperatorHandle& op, const OperatorName& o
   std::lock_guard<std::mutex> lock(mutex_);
 
   op.operatorIterator_->op.deregisterKernel_(dispatch_key, handle);
+  bumpEpoch_();
 
   TORCH_INTERNAL_ASSERT(op.operator_name() == op_name);
 
@@ -267,6 +272,7 @@ RegistrationHandleRAII Dispatcher::registerFallback(DispatchKey dispatchKey, Ker
   if (kernel.isFallthrough()) {
     backendsWithoutFallthrough_ = backendsWithoutFallthrough_.remove(dispatchKey);
   }
+  bumpEpoch_();
 
   return RegistrationHandleRAII([this, dispatchKey] {
     deregisterFallback_(dispatchKey);
@@ -278,6 +284,7 @@ void Dispatcher::deregisterFallback_(DispatchKey dispatchKey) {
 
   backendFallbackKernels_.removeKernelIfExists(dispatchKey);
   backendsWithoutFallthrough_ = backendsWithoutFallthrough_.add(dispatchKey);
+  bumpEpoch_();
 }
 
 
@@ -2,9 +2,11 @@
 
 #include <ATen/core/dispatch/OperatorEntry.h>
 #include <ATen/core/dispatch/CppSignature.h>
+#include <ATen/core/dispatch/DispatchCache.h>
 #include <ATen/core/dispatch/RegistrationHandleRAII.h>
 #include <c10/util/Exception.h>
 #include <c10/util/LeftRight.h>
+#include <atomic>
 #include <mutex>
 #include <list>
 
@@ -128,6 +130,20 @@ public:
   // Invoke an operator via the boxed calling convention using an IValue stack
   void callBoxed(const OperatorHandle& op, Stack* stack) const;
 
+  // Like call and callBoxed, but reuse the kernel that the last call through
+  // `cache` dispatched to, if its inputs have the same dispatch keys and no
+  // registration or TLS change happened since; see impl::DispatchCache.
+  // Use these through (Typed)CachedOperatorHandle.
+  template<class Return, class... Args>
+  Return callCached(const TypedOperatorHandle<Return (Args...)>& op, impl::DispatchCache& cache, Args... args) const;
+  void callBoxedCached(const OperatorHandle& op, impl::DispatchCache& cache, Stack* stack) const;
+
+  // Bumped whenever a registration that may change the outcome of dispatch
+  // is added or removed.
+  uint64_t epoch() const {
+    return epoch_.load(std::memory_order_acquire);
+  }
+
   // ------------------------------------------------------------------------
   //
   // Performing registrations (NON user public; use op_registration)
@@ -217,6 +233,13 @@ private:
 
   const KernelFunction& dispatch_(const DispatchTable& dispatchTable, DispatchKey dispatch_key) const;
 
+  const KernelFunction& dispatchCached_(const DispatchTable& dispatchTable, impl::DispatchCache& cache, DispatchKeySet ks) const;
+
+  // Must be called with mutex_ held.
+  void bumpEpoch_() {
+    epoch_.fetch_add(1, std::memory_order_release);
+  }
+
   std::list<OperatorDef> operators_;
   LeftRight<ska::flat_hash_map<OperatorName, OperatorHandle>> operatorLookupTable_;
   // Map from namespace to debug string (saying, e.g., where the library was defined)
@@ -228,6 +251,8 @@ private:
   DispatchKeySet backendsWithoutFallthrough_;
   std::unique_ptr<detail::RegistrationListenerList> listeners_;
   std::mutex mutex_;
+  // Starts at 1, so that an empty DispatchCache never matches.
+  std::atomic<uint64_t> epoch_;
 };
 
 /**
@@ -317,6 +342,52 @@ private:
   friend class OperatorHandle;
 };
 
+/**
+ * An OperatorHandle with a DispatchCache, for call sites that call the same
+ * operator over and over, e.g. the nodes of a TorchScript graph. Each copy
+ * has its own cache, which starts out empty.
+ */
+class CachedOperatorHandle final {
+public:
+  explicit CachedOperatorHandle(OperatorHandle op)
+  : op_(std::move(op)), cache_() {}
+
+  const OperatorHandle& handle() const {
+    return op_;
+  }
+
+  void callBoxed(Stack* stack) const {
+    c10::Dispatcher::singleton().callBoxedCached(op_, cache_, stack);
+  }
+
+private:
+  OperatorHandle op_;
+  mutable impl::DispatchCache cache_;
+};
+
+template<class FuncType>
+class TypedCachedOperatorHandle final {
+  static_assert(guts::false_t<FuncType>(), "FuncType in TypedCachedOperatorHandle<FuncType> was not a valid function type");
+};
+template<class Return, class... Args>
+class TypedCachedOperatorHandle<Return (Args...)> final {
+public:
+  explicit TypedCachedOperatorHandle(TypedOperatorHandle<Return (Args...)> op)
+  : op_(std::move(op)), cache_() {}
+
+  const TypedOperatorHandle<Return (Args...)>& handle() const {
+    return op_;
+  }
+
+  Return call(Args... args) const {
+    return c10::Dispatcher::singleton().callCached<Return, Args...>(op_, cache_, std::forward<Args>(args)...);
+  }
+
+private:
+  TypedOperatorHandle<Return (Args...)> op_;
+  mutable impl::DispatchCache cache_;
+};
+
 namespace detail {
 template<class... Args> inline void unused_arg_(const Args&...) {}
 }
@@ -357,6 +428,37 @@ inline void Dispatcher::callBoxed(const OperatorHandle& op, Stack* stack) const
   kernel.callBoxed(op, stack);
 }
 
+template<class Return, class... Args>
+inline Return Dispatcher::callCached(const TypedOperatorHandle<Return(Args...)>& op, impl::DispatchCache& cache, Args... args) const {
+  detail::unused_arg_(args...);  // workaround for a false-positive warning about unused parameters in gcc 5
+  const auto& dispatchTable = op.operatorIterator_->op.dispatch_table();
+  auto ks = dispatchTable.dispatchKeyExtractor().template getDispatchKeySetUnboxed<Args...>(args...);
+  const KernelFunction& kernel = dispatchCached_(dispatchTable, cache, ks);
+  return kernel.template call<Return, Args...>(op, std::forward<Args>(args)...);
+}
+
+inline void Dispatcher::callBoxedCached(const OperatorHandle& op, impl::DispatchCache& cache, Stack* stack) const {
+  const auto& dispatchTable = op.operatorIterator_->op.dispatch_table();
+  auto ks = dispatchTable.dispatchKeyExtractor().getDispatchKeySetBoxed(stack);
+  const KernelFunction& kernel = dispatchCached_(dispatchTable, cache, ks);
+  kernel.callBoxed(op, stack);
+}
+
+inline const KernelFunction& Dispatcher::dispatchCached_(const DispatchTable& dispatchTable, impl::DispatchCache& cache, DispatchKeySet ks) const {
+  // Read the epoch before dispatching, so that a registration that races with
+  // this lookup leaves an entry that is already stale.
+  const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+  const auto local = c10::impl::tls_local_dispatch_key_set();
+  const KernelFunction* cached = cache.lookup(epoch, ks, local);
+  if (C10_LIKELY(cached != nullptr)) {
+    return *cached;
+  }
+  auto dispatchKey = dispatchTable.dispatchKeyExtractor().getDispatchKey(backendsWithoutFallthrough_, DispatchKeySet::FULL, ks);
+  const KernelFunction& kernel = dispatch_(dispatchTable, dispatchKey);
+  cache.update(epoch, ks, local, &kernel);
+  return kernel;
+}
+
 inline const KernelFunction& Dispatcher::dispatch_(const DispatchTable& dispatchTable, DispatchKey dispatchKey) const {
   const KernelFunction* backendKernel = dispatchTable.lookup(dispatchKey);
 
@@ -96,6 +96,7 @@ namespace c10 {
   _(prim, ConstantChunk)             \
   _(prim, MMTreeReduce)              \
   _(prim, MMBatchSide)               \
+  _(prim, LinearBatchSide)           \
   _(prim, min)                       \
   _(prim, max)                       \
   _(prim, abs)                       \
@@ -5,6 +5,7 @@
 
 #include <ATen/core/functional.h>
 #include <ATen/core/interned_strings.h>
+#include <c10/core/Event.h>
 #include <c10/core/Scalar.h>
 #include <c10/core/TensorImpl.h>
 #include <c10/core/UndefinedTensorImpl.h>
@@ -182,8 +183,13 @@ struct CAFFE2_API Tuple : c10::intrusive_ptr_target {
   }
 
   template <typename... Args>
-  static c10::intrusive_ptr<Tuple> create(Args... elements_) {
-    return c10::make_intrusive<Tuple>(std::vector<IValue>{IValue(elements_)...});
+  static c10::intrusive_ptr<Tuple> create(Args&&... elements_) {
+    // Not an initializer list, whose elements could only be copied.
+    std::vector<IValue> elements;
+    elements.reserve(sizeof...(Args));
+    (void)std::initializer_list<int>{
+        (elements.emplace_back(std::forward<Args>(elements_)), 0)...};
+    return c10::make_intrusive<Tuple>(std::move(elements));
   }
 
  const std::vector<IValue>& elements() const & {
@@ -390,6 +396,23 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
     return type_;
   }
 
+  /**
+   * Sets the events recorded on the streams the value was computed on, which
+   * users of the value have to make their own streams wait for. Must be
+   * called before the future is marked completed.
+   */
+  void setCompletionEvents(std::vector<c10::Event> events) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    TORCH_INTERNAL_ASSERT(!completed());
+    completion_events_ = std::move(events);
+  }
+
+  // The events are not modified anymore once the future completed.
+  const std::vector<c10::Event>& completionEvents() const {
+    AT_ASSERT(completed());
+    return completion_events_;
+  }
+
  private:
   void setErrorInternal(
       FutureError error,
@@ -416,6 +439,7 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
   TypePtr type_;
   std::vector<std::function<void(void)>> callbacks_;
   c10::optional<FutureError> error_;
+  std::vector<c10::Event> completion_events_;
 };
 
 // Input is a list of Futures with the same target type.
@@ -856,7 +880,7 @@ template <
         std::nullptr_t>>
 inline IValue::IValue(const std::tuple<Args...>& t)
     : IValue(
-          std::move(c10::guts::apply(c10::ivalue::Tuple::create<Args...>, t))) {
+          std::move(c10::guts::apply(c10::ivalue::Tuple::create<const Args&...>, t))) {
 }
 
 inline IValue::IValue(c10::intrusive_ptr<ivalue::ConstantString> v)
@@ -0,0 +1,462 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec256/intrinsics.h>
+#include <ATen/cpu/vec256/vec256_base.h>
+
+namespace at {
+namespace vec256 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+// NEON is part of the aarch64 baseline, so unlike AVX it needs no CPU
+// capability of its own: the DEFAULT kernels are built with it. Only built
+// with USE_VEC256_NEON until it has been tested on aarch64 hardware.
+#if defined(__aarch64__) && !defined(_MSC_VER) && defined(USE_VEC256_NEON)
+
+// Eight floats, held in a pair of 128-bit registers.
+template <> class Vec256<float> {
+private:
+  float32x4x2_t values;
+public:
+  using value_type = float;
+  static constexpr int size() {
+    return 8;
+  }
+  Vec256() {}
+  Vec256(float32x4x2_t v) : values(v) {}
+  Vec256(float32x4_t low, float32x4_t high) {
+    values.val[0] = low;
+    values.val[1] = high;
+  }
+  Vec256(float val) {
+    values.val[0] = vdupq_n_f32(val);
+    values.val[1] = values.val[0];
+  }
+  Vec256(float val1, float val2, float val3, float val4,
+         float val5, float val6, float val7, float val8) {
+    __at_align32__ float tmp[size()] = {val1, val2, val3, val4,
+                                        val5, val6, val7, val8};
+    values.val[0] = vld1q_f32(tmp);
+    values.val[1] = vld1q_f32(tmp + 4);
+  }
+  operator float32x4x2_t() const {
+    return values;
+  }
+  float32x4_t get_low() const {
+    return values.val[0];
+  }
+  float32x4_t get_high() const {
+    return values.val[1];
+  }
+  template <int64_t mask>
+  static Vec256<float> blend(const Vec256<float>& a, const Vec256<float>& b) {
+    const uint32x4_t mask_low = {
+      (mask & 0x01) ? 0xFFFFFFFF : 0, (mask & 0x02) ? 0xFFFFFFFF : 0,
+      (mask & 0x04) ? 0xFFFFFFFF : 0, (mask & 0x08) ? 0xFFFFFFFF : 0};
+    const uint32x4_t mask_high = {
+      (mask & 0x10) ? 0xFFFFFFFF : 0, (mask & 0x20) ? 0xFFFFFFFF : 0,
+      (mask & 0x40) ? 0xFFFFFFFF : 0, (mask & 0x80) ? 0xFFFFFFFF : 0};
+    return Vec256<float>(
+      vbslq_f32(mask_low, b.values.val[0], a.values.val[0]),
+      vbslq_f32(mask_high, b.values.val[1], a.values.val[1]));
+  }
+  static Vec256<float> blendv(const Vec256<float>& a, const Vec256<float>& b,
+                              const Vec256<float>& mask) {
+    return Vec256<float>(
+      vbslq_f32(vreinterpretq_u32_f32(mask.values.val[0]), b.values.val[0], a.values.val[0]),
+      vbslq_f32(vreinterpretq_u32_f32(mask.values.val[1]), b.values.val[1], a.values.val[1]));
+  }
+  template<typename step_t>
+  static Vec256<float> arange(float base = 0.f, step_t step = static_cast<step_t>(1)) {
+    return Vec256<float>(
+      base,            base +     step, base + 2 * step, base + 3 * step,
+      base + 4 * step, base + 5 * step, base + 6 * step, base + 7 * step);
+  }
+  static Vec256<float> set(const Vec256<float>& a, const Vec256<float>& b,
+                           int64_t count = size()) {
+    switch (count) {
+      case 0:
+        return a;
+      case 1:
+        return blend<1>(a, b);
+      case 2:
+        return blend<3>(a, b);
+      case 3:
+        return blend<7>(a, b);
+      case 4:
+        return blend<15>(a, b);
+      case 5:
+        return blend<31>(a, b);
+      case 6:
+        return blend<63>(a, b);
+      case 7:
+        return blend<127>(a, b);
+    }
+    return b;
+  }
+  static Vec256<float> loadu(const void* ptr, int64_t count = size()) {
+    if (count == size()) {
+      const float* data = reinterpret_cast<const float*>(ptr);
+      return Vec256<float>(vld1q_f32(data), vld1q_f32(data + 4));
+    }
+    __at_align32__ float tmp_values[size()];
+    // Ensure uninitialized memory does not change the output value See https://github.com/pytorch/pytorch/issues/32502
+    // for more details.
+    for (auto i = 0; i < size(); ++i) {
+      tmp_values[i] = 0.0;
+    }
+    std::memcpy(
+        tmp_values, reinterpret_cast<const float*>(ptr), count * sizeof(float));
+    return Vec256<float>(vld1q_f32(tmp_values), vld1q_f32(tmp_values + 4));
+  }
+  void store(void* ptr, int64_t count = size()) const {
+    if (count == size()) {
+      float* data = reinterpret_cast<float*>(ptr);
+      vst1q_f32(data, values.val[0]);
+      vst1q_f32(data + 4, values.val[1]);
+    } else if (count > 0) {
+      __at_align32__ float tmp_values[size()];
+      vst1q_f32(tmp_values, values.val[0]);
+      vst1q_f32(tmp_values + 4, values.val[1]);
+      std::memcpy(ptr, tmp_values, count * sizeof(float));
+    }
+  }
+  const float& operator[](int idx) const  = delete;
+  float& operator[](int idx) = delete;
+  int zero_mask() const {
+    // returns an integer mask where all zero elements are translated to 1-bit and others are translated to 0-bit
+    __at_align32__ uint32_t cmp[size()];
+    vst1q_u32(cmp, vceqzq_f32(values.val[0]));
+    vst1q_u32(cmp + 4, vceqzq_f32(values.val[1]));
+    int mask = 0;
+    for (int i = 0; i < size(); ++i) {
+      if (cmp[i]) {
+        mask |= (1 << i);
+      }
+    }
+    return mask;
+  }
+  Vec256<float> map(float (*f)(float)) const {
+    __at_align32__ float tmp[size()];
+    store(tmp);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec256<float> abs() const {
+    return Vec256<float>(vabsq_f32(values.val[0]), vabsq_f32(values.val[1]));
+  }
+  Vec256<float> angle() const {
+    return Vec256<float>(0.f);
+  }
+  Vec256<float> real() const {
+    return *this;
+  }
+  Vec256<float> imag() const {
+    return Vec256<float>(0.f);
+  }
+  Vec256<float> conj() const {
+    return *this;
+  }
+  // There is no vectorized libm to call into on aarch64, the transcendental
+  // functions are computed one element at a time as in vec256_base.h.
+  Vec256<float> acos() const {
+    return map(std::acos);
+  }
+  Vec256<float> asin() const {
+    return map(std::asin);
+  }
+  Vec256<float> atan() const {
+    return map(std::atan);
+  }
+  Vec256<float> atan2(const Vec256<float> &b) const {
+    __at_align32__ float tmp[size()];
+    __at_align32__ float tmp_b[size()];
+    store(tmp);
+    b.store(tmp_b);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = std::atan2(tmp[i], tmp_b[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec256<float> erf() const {
+    return map(std::erf);
+  }
+  Vec256<float> erfc() const {
+    return map(std::erfc);
+  }
+  Vec256<float> erfinv() const {
+    return map(calc_erfinv);
+  }
+  Vec256<float> exp() const {
+    return map(std::exp);
+  }
+  Vec256<float> expm1() const {
+    return map(std::expm1);
+  }
+  Vec256<float> fmod(const Vec256<float>& q) const {
+    __at_align32__ float tmp[size()];
+    __at_align32__ float tmp_q[size()];
+    store(tmp);
+    q.store(tmp_q);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = std::fmod(tmp[i], tmp_q[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec256<float> log() const {
+    return map(std::log);
+  }
+  Vec256<float> log2() const {
+    return map(std::log2);
+  }
+  Vec256<float> log10() const {
+    return map(std::log10);
+  }
+  Vec256<float> log1p() const {
+    return map(std::log1p);
+  }
+  Vec256<float> frac() const;
+  Vec256<float> sin() const {
+    return map(std::sin);
+  }
+  Vec256<float> sinh() const {
+    return map(std::sinh);
+  }
+  Vec256<float> cos() const {
+    return map(std::cos);
+  }
+  Vec256<float> cosh() const {
+    return map(std::cosh);
+  }
+  Vec256<float> ceil() const {
+    return Vec256<float>(vrndpq_f32(values.val[0]), vrndpq_f32(values.val[1]));
+  }
+  Vec256<float> floor() const {
+    return Vec256<float>(vrndmq_f32(values.val[0]), vrndmq_f32(values.val[1]));
+  }
+  Vec256<float> neg() const {
+    return Vec256<float>(vnegq_f32(values.val[0]), vnegq_f32(values.val[1]));
+  }
+  Vec256<float> round() const {
+    // Rounds midway numbers to the nearest even integer.
+    return Vec256<float>(vrndnq_f32(values.val[0]), vrndnq_f32(values.val[1]));
+  }
+  Vec256<float> tan() const {
+    return map(std::tan);
+  }
+  Vec256<float> tanh() const {
+    return map(std::tanh);
+  }
+  Vec256<float> trunc() const {
+    return Vec256<float>(vrndq_f32(values.val[0]), vrndq_f32(values.val[1]));
+  }
+  Vec256<float> lgamma() const {
+    return map(std::lgamma);
+  }
+  Vec256<float> sqrt() const {
+    return Vec256<float>(vsqrtq_f32(values.val[0]), vsqrtq_f32(values.val[1]));
+  }
+  Vec256<float> reciprocal() const {
+    const float32x4_t one = vdupq_n_f32(1.f);
+    return Vec256<float>(
+      vdivq_f32(one, values.val[0]), vdivq_f32(one, values.val[1]));
+  }
+  Vec256<float> rsqrt() const {
+    return sqrt().reciprocal();
+  }
+  Vec256<float> pow(const Vec256<float> &b) const {
+    __at_align32__ float tmp[size()];
+    __at_align32__ float tmp_b[size()];
+    store(tmp);
+    b.store(tmp_b);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = std::pow(tmp[i], tmp_b[i]);
+    }
+    return loadu(tmp);
+  }
+  // All bits are set to 1 if the predicate is true, otherwise 0. As in
+  // vec256_base.h comparisons with NaN are false, except for !=.
+  Vec256<float> operator==(const Vec256<float>& other) const {
+    return Vec256<float>(
+      vreinterpretq_f32_u32(vceqq_f32(values.val[0], other.values.val[0])),
+      vreinterpretq_f32_u32(vceqq_f32(values.val[1], other.values.val[1])));
+  }
+
+  Vec256<float> operator!=(const Vec256<float>& other) const {
+    return Vec256<float>(
+      vreinterpretq_f32_u32(vmvnq_u32(vceqq_f32(values.val[0], other.values.val[0]))),
+      vreinterpretq_f32_u32(vmvnq_u32(vceqq_f32(values.val[1], other.values.val[1]))));
+  }
+
+  Vec256<float> operator<(const Vec256<float>& other) const {
+    return Vec256<float>(
+      vreinterpretq_f32_u32(vcltq_f32(values.val[0], other.values.val[0])),
+      vreinterpretq_f32_u32(vcltq_f32(values.val[1], other.values.val[1])));
+  }
+
+  Vec256<float> operator<=(const Vec256<float>& other) const {
+    return Vec256<float>(
+      vreinterpretq_f32_u32(vcleq_f32(values.val[0], other.values.val[0])),
+      vreinterpretq_f32_u32(vcleq_f32(values.val[1], other.values.val[1])));
+  }
+
+  Vec256<float> operator>(const Vec256<float>& other) const {
+    return Vec256<float>(
+      vreinterpretq_f32_u32(vcgtq_f32(values.val[0], other.values.val[0])),
+      vreinterpretq_f32_u32(vcgtq_f32(values.val[1], other.values.val[1])));
+  }
+
+  Vec256<float> operator>=(const Vec256<float>& other) const {
+    return Vec256<float>(
+      vreinterpretq_f32_u32(vcgeq_f32(values.val[0], other.values.val[0])),
+      vreinterpretq_f32_u32(vcgeq_f32(values.val[1], other.values.val[1])));
+  }
+
+  Vec256<float> eq(const Vec256<float>& other) const;
+  Vec256<float> ne(const Vec256<float>& other) const;
+  Vec256<float> gt(const Vec256<float>& other) const;
+  Vec256<float> ge(const Vec256<float>& other) const;
+  Vec256<float> lt(const Vec256<float>& other) const;
+  Vec256<float> le(const Vec256<float>& other) const;
+};
+
+template <>
+Vec256<float> inline operator+(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vaddq_f32(a.get_low(), b.get_low()), vaddq_f32(a.get_high(), b.get_high()));
+}
+
+template <>
+Vec256<float> inline operator-(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vsubq_f32(a.get_low(), b.get_low()), vsubq_f32(a.get_high(), b.get_high()));
+}
+
+template <>
+Vec256<float> inline operator*(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vmulq_f32(a.get_low(), b.get_low()), vmulq_f32(a.get_high(), b.get_high()));
+}
+
+template <>
+Vec256<float> inline operator/(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vdivq_f32(a.get_low(), b.get_low()), vdivq_f32(a.get_high(), b.get_high()));
+}
+
+// frac. Implement this here so we can use subtraction
+Vec256<float> Vec256<float>::frac() const {
+  return *this - this->trunc();
+}
+
+// Implements the IEEE 754 201X `maximum` operation, which propagates NaN if
+// either input is a NaN. vmaxq_f32 already does.
+template <>
+Vec256<float> inline maximum(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vmaxq_f32(a.get_low(), b.get_low()), vmaxq_f32(a.get_high(), b.get_high()));
+}
+
+// Implements the IEEE 754 201X `minimum` operation, which propagates NaN if
+// either input is a NaN. vminq_f32 already does.
+template <>
+Vec256<float> inline minimum(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vminq_f32(a.get_low(), b.get_low()), vminq_f32(a.get_high(), b.get_high()));
+}
+
+template <>
+Vec256<float> inline clamp(const Vec256<float>& a, const Vec256<float>& min, const Vec256<float>& max) {
+  return minimum(max, maximum(min, a));
+}
+
+template <>
+Vec256<float> inline clamp_max(const Vec256<float>& a, const Vec256<float>& max) {
+  return minimum(max, a);
+}
+
+template <>
+Vec256<float> inline clamp_min(const Vec256<float>& a, const Vec256<float>& min) {
+  return maximum(min, a);
+}
+
+template <>
+Vec256<float> inline operator&(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vreinterpretq_f32_u32(vandq_u32(
+      vreinterpretq_u32_f32(a.get_low()), vreinterpretq_u32_f32(b.get_low()))),
+    vreinterpretq_f32_u32(vandq_u32(
+      vreinterpretq_u32_f32(a.get_high()), vreinterpretq_u32_f32(b.get_high()))));
+}
+
+template <>
+Vec256<float> inline operator|(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vreinterpretq_f32_u32(vorrq_u32(
+      vreinterpretq_u32_f32(a.get_low()), vreinterpretq_u32_f32(b.get_low()))),
+    vreinterpretq_f32_u32(vorrq_u32(
+      vreinterpretq_u32_f32(a.get_high()), vreinterpretq_u32_f32(b.get_high()))));
+}
+
+template <>
+Vec256<float> inline operator^(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+    vreinterpretq_f32_u32(veorq_u32(
+      vreinterpretq_u32_f32(a.get_low()), vreinterpretq_u32_f32(b.get_low()))),
+    vreinterpretq_f32_u32(veorq_u32(
+      vreinterpretq_u32_f32(a.get_high()), vreinterpretq_u32_f32(b.get_high()))));
+}
+
+Vec256<float> Vec256<float>::eq(const Vec256<float>& other) const {
+  return (*this == other) & Vec256<float>(1.0f);
+}
+
+Vec256<float> Vec256<float>::ne(const Vec256<float>& other) const {
+  return (*this != other) & Vec256<float>(1.0f);
+}
+
+Vec256<float> Vec256<float>::gt(const Vec256<float>& other) const {
+  return (*this > other) & Vec256<float>(1.0f);
+}
+
+Vec256<float> Vec256<float>::ge(const Vec256<float>& other) const {
+  return (*this >= other) & Vec256<float>(1.0f);
+}
+
+Vec256<float> Vec256<float>::lt(const Vec256<float>& other) const {
+  return (*this < other) & Vec256<float>(1.0f);
+}
+
+Vec256<float> Vec256<float>::le(const Vec256<float>& other) const {
+  return (*this <= other) & Vec256<float>(1.0f);
+}
+
+template <>
+inline void convert(const float* src, float* dst, int64_t n) {
+  int64_t i;
+#pragma unroll
+  for (i = 0; i <= (n - Vec256<float>::size()); i += Vec256<float>::size()) {
+    vst1q_f32(dst + i, vld1q_f32(src + i));
+    vst1q_f32(dst + i + 4, vld1q_f32(src + i + 4));
+  }
+#pragma unroll
+  for (; i < n; i++) {
+    dst[i] = src[i];
+  }
+}
+
+template <>
+Vec256<float> inline fmadd(const Vec256<float>& a, const Vec256<float>& b, const Vec256<float>& c) {
+  return Vec256<float>(
+    vfmaq_f32(c.get_low(), a.get_low(), b.get_low()),
+    vfmaq_f32(c.get_high(), a.get_high(), b.get_high()));
+}
+
+#endif // defined(__aarch64__) && !defined(_MSC_VER) && defined(USE_VEC256_NEON)
+
+}}}
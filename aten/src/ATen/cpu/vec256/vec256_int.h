@@ -306,6 +306,25 @@ inline void convert(const int32_t *src, float *dst, int64_t n) {
   }
 }
 
+template <>
+inline void convert(const uint8_t *src, float *dst, int64_t n) {
+  int64_t i;
+#ifndef _MSC_VER
+# pragma unroll
+#endif
+  for (i = 0; i <= (n - Vec256<float>::size()); i += Vec256<float>::size()) {
+    auto input_vec = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+    auto output_vec = _mm256_cvtepi32_ps(input_vec);
+    _mm256_storeu_ps(reinterpret_cast<float*>(dst + i), output_vec);
+  }
+#ifndef _MSC_VER
+# pragma unroll
+#endif
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
 template <>
 inline void convert(const int32_t *src, double *dst, int64_t n) {
   int64_t i;
@@ -1091,12 +1091,19 @@ struct Vec256QuantizedConverter {
       Vec256<float> scale,
       Vec256<float> zero_point,
       Vec256<float> scale_zp_premul) const {
+    // Vec256<float> may be a vector register type without operator[].
+    float scale_vals[8];
+    float zero_point_vals[8];
+    scale.store(scale_vals);
+    zero_point.store(zero_point_vals);
     float_vec_return_type rv;
     for (int i = 0; i < float_num_vecs(); ++i) {
+      float tmp_vals[8];
       for (int j = 0; j < 8; ++j) {
-        rv[i][j] = at::native::dequantize_val<T>(
-            scale[j], zero_point[j], T(vals[8 * i + j]));
+        tmp_vals[j] = at::native::dequantize_val<T>(
+            scale_vals[j], zero_point_vals[j], T(vals[8 * i + j]));
       }
+      rv[i] = Vec256<float>::loadu(tmp_vals);
     }
     return rv;
   }
@@ -0,0 +1,207 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+// Vec512 is the 512-bit counterpart of Vec256 (see vec256.h), with the same
+// API. Its intrinsic specializations are only enabled in kernels compiled for
+// CPUCapability::AVX512 (see cmake/Codegen.cmake), i.e. with AVX512F, BW, VL
+// and DQ; other kernels can use the generic implementation in vec512_base.h,
+// but would be better off with Vec256.
+
+#include <ATen/cpu/vec256/intrinsics.h>
+
+#include <ATen/cpu/vec512/vec512_base.h>
+#include <ATen/cpu/vec512/vec512_float.h>
+#include <ATen/cpu/vec512/vec512_bfloat16.h>
+#include <ATen/cpu/vec512/vec512_double.h>
+#include <ATen/cpu/vec512/vec512_int.h>
+#include <ATen/cpu/vec512/vec512_qint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace at {
+namespace vec512 {
+
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+template <typename T>
+std::ostream& operator<<(std::ostream& stream, const Vec512<T>& vec) {
+  T buf[Vec512<T>::size()];
+  vec.store(buf);
+  stream << "vec[";
+  for (int i = 0; i != Vec512<T>::size(); i++) {
+    if (i != 0) {
+      stream << ", ";
+    }
+    stream << buf[i];
+  }
+  stream << "]";
+  return stream;
+}
+
+
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ CAST (AVX512) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+template<>
+inline Vec512<float> cast<float, double>(const Vec512<double>& src) {
+  return _mm512_castpd_ps(src);
+}
+
+template<>
+inline Vec512<double> cast<double, float>(const Vec512<float>& src) {
+  return _mm512_castps_pd(src);
+}
+
+#define DEFINE_FLOAT_INT_CAST(int_t, float_t, float_ch)            \
+template<>                                                         \
+inline  Vec512<int_t> cast<int_t, float_t>(const Vec512<float_t>& src) {   \
+  return _mm512_castp ## float_ch ## _si512(src);                  \
+}                                                                  \
+template<>                                                         \
+inline Vec512<float_t> cast<float_t, int_t>(const Vec512<int_t>& src) {   \
+  return _mm512_castsi512_p ## float_ch (src);                     \
+}
+
+DEFINE_FLOAT_INT_CAST(int64_t, double, d)
+DEFINE_FLOAT_INT_CAST(int32_t, double, d)
+DEFINE_FLOAT_INT_CAST(int16_t, double, d)
+DEFINE_FLOAT_INT_CAST(int64_t, float, s)
+DEFINE_FLOAT_INT_CAST(int32_t, float, s)
+DEFINE_FLOAT_INT_CAST(int16_t, float, s)
+
+#undef DEFINE_FLOAT_INT_CAST
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ GATHER ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+template<int64_t scale = 1>
+std::enable_if_t<scale == 1 || scale == 2 || scale == 4 || scale == 8, Vec512<double>>
+inline gather(const double* base_addr, const Vec512<int64_t>& vindex) {
+  return _mm512_i64gather_pd(vindex, base_addr, scale);
+}
+
+template<int64_t scale = 1>
+std::enable_if_t<scale == 1 || scale == 2 || scale == 4 || scale == 8, Vec512<float>>
+inline gather(const float* base_addr, const Vec512<int32_t>& vindex) {
+  return _mm512_i32gather_ps(vindex, base_addr, scale);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ MASK GATHER ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// As for Vec256, elements are gathered where the sign bit of mask is set, and
+// mask is zeroed out.
+template<int64_t scale = 1>
+std::enable_if_t<scale == 1 || scale == 2 || scale == 4 || scale == 8, Vec512<double>>
+inline mask_gather(const Vec512<double>& src, const double* base_addr,
+                   const Vec512<int64_t>& vindex, Vec512<double>& mask) {
+  auto mmask = _mm512_movepi64_mask(_mm512_castpd_si512(mask));
+  mask = _mm512_setzero_pd();
+  return _mm512_mask_i64gather_pd(src, mmask, vindex, base_addr, scale);
+}
+
+template<int64_t scale = 1>
+std::enable_if_t<scale == 1 || scale == 2 || scale == 4 || scale == 8, Vec512<float>>
+inline mask_gather(const Vec512<float>& src, const float* base_addr,
+                   const Vec512<int32_t>& vindex, Vec512<float>& mask) {
+  auto mmask = _mm512_movepi32_mask(_mm512_castps_si512(mask));
+  mask = _mm512_setzero_ps();
+  return _mm512_mask_i32gather_ps(src, mmask, vindex, base_addr, scale);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ CONVERT ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Unlike with AVX2, AVX512DQ converts double to int64 natively, so there is
+// no restriction on the range of the inputs.
+template<>
+Vec512<int64_t>
+inline convert_to_int_of_same_size<double>(const Vec512<double> &src) {
+  return _mm512_cvttpd_epi64(src);
+}
+
+template<>
+Vec512<int32_t>
+inline convert_to_int_of_same_size<float>(const Vec512<float> &src) {
+  return _mm512_cvttps_epi32(src);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ INTERLEAVE ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// _mm512_permutex2var_* selects elements of the concatenation {a, b}, so,
+// unlike with AVX2, no lane swapping is needed.
+
+template <>
+std::pair<Vec512<double>, Vec512<double>>
+inline interleave2<double>(const Vec512<double>& a, const Vec512<double>& b) {
+  // inputs:
+  //   a = {a0, a1, a2, a3, a4, a5, a6, a7}
+  //   b = {b0, b1, b2, b3, b4, b5, b6, b7}
+  //
+  // return {a0, b0, a1, b1, a2, b2, a3, b3}
+  //        {a4, b4, a5, b5, a6, b6, a7, b7}
+  const __m512i idx_lo = _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11);
+  const __m512i idx_hi = _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15);
+  return std::make_pair(_mm512_permutex2var_pd(a, idx_lo, b),
+                        _mm512_permutex2var_pd(a, idx_hi, b));
+}
+
+template <>
+std::pair<Vec512<float>, Vec512<float>>
+inline interleave2<float>(const Vec512<float>& a, const Vec512<float>& b) {
+  // inputs:
+  //   a = {a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15}
+  //   b = {b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15}
+  //
+  // return {a0, b0, a1, b1, a2, b2, a3, b3, a4, b4, a5, b5, a6, b6, a7, b7}
+  //        {a8, b8, a9, b9, a10, b10, a11, b11, a12, b12, a13, b13, a14, b14, a15, b15}
+  const __m512i idx_lo = _mm512_setr_epi32(
+      0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+  const __m512i idx_hi = _mm512_setr_epi32(
+      8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+  return std::make_pair(_mm512_permutex2var_ps(a, idx_lo, b),
+                        _mm512_permutex2var_ps(a, idx_hi, b));
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ DEINTERLEAVE ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+template <>
+std::pair<Vec512<double>, Vec512<double>>
+inline deinterleave2<double>(const Vec512<double>& a, const Vec512<double>& b) {
+  // inputs:
+  //   a = {a0, b0, a1, b1, a2, b2, a3, b3}
+  //   b = {a4, b4, a5, b5, a6, b6, a7, b7}
+  //
+  // return {a0, a1, a2, a3, a4, a5, a6, a7}
+  //        {b0, b1, b2, b3, b4, b5, b6, b7}
+  const __m512i idx_a = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+  const __m512i idx_b = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+  return std::make_pair(_mm512_permutex2var_pd(a, idx_a, b),
+                        _mm512_permutex2var_pd(a, idx_b, b));
+}
+
+template <>
+std::pair<Vec512<float>, Vec512<float>>
+inline deinterleave2<float>(const Vec512<float>& a, const Vec512<float>& b) {
+  // inputs:
+  //   a = {a0, b0, a1, b1, a2, b2, a3, b3, a4, b4, a5, b5, a6, b6, a7, b7}
+  //   b = {a8, b8, a9, b9, a10, b10, a11, b11, a12, b12, a13, b13, a14, b14, a15, b15}
+  //
+  // return {a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15}
+  //        {b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15}
+  const __m512i idx_a = _mm512_setr_epi32(
+      0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+  const __m512i idx_b = _mm512_setr_epi32(
+      1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+  return std::make_pair(_mm512_permutex2var_ps(a, idx_a, b),
+                        _mm512_permutex2var_ps(a, idx_b, b));
+}
+
+#endif // defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+}}}
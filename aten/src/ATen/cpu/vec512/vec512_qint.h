@@ -0,0 +1,995 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec256/intrinsics.h>
+#include <ATen/cpu/vec512/vec512_base.h>
+#include <ATen/native/quantized/affine_quantizer.h>
+#include <c10/util/qint32.h>
+#include <c10/util/qint8.h>
+#include <c10/util/quint8.h>
+
+#include <array>
+
+// This file defines Vec512<> for the quantized types.
+//
+//
+// As with Vec256<> (see vec256_qint.h), these classes are efficient
+// converters between the quantized types and Vec512<float>, usually in
+// bandwidth-bound cases where doing the arithmetic in full-precision is
+// acceptable (e.g. elementwise operators).
+//
+//
+// Conversions are as follows:
+//  Vec512<qint8> -> 4x Vec512<float>
+//  Vec512<quint8> -> 4x Vec512<float>
+//  Vec512<qint32> -> 1x Vec512<float>
+//
+// The size of the returned float vector is specified by the special
+// constexpr function float_num_vecs. The type of the value returned
+// from dequantize (and expected as an argument to quantize) is
+// specified by float_vec_return_type.
+//
+// When writing kernels with these vectors, it is expected that floating-
+// point operations will be carried out in a loop over Vec512<T>::float_num_vecs
+// iterations.
+
+namespace at {
+namespace vec512 {
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+struct Vec512qi {
+ protected:
+  __m512i vals __attribute__((aligned(64)));
+
+ public:
+  Vec512qi() {}
+  Vec512qi(__m512i v) : vals(v) {}
+  operator __m512i() const {
+    return vals;
+  }
+};
+
+// Clamps int32 values to the range of T and narrows them to T. AVX-512 can
+// narrow with _mm512_cvtepi32_epi8 directly, which, unlike the AVX2 packs,
+// keeps the elements in order.
+template <typename T>
+inline __m128i clamp_and_narrow_epi32(__m512i v) {
+  constexpr auto min_val = std::numeric_limits<T>::min();
+  constexpr auto max_val = std::numeric_limits<T>::max();
+  v = _mm512_max_epi32(_mm512_set1_epi32(min_val),
+                       _mm512_min_epi32(v, _mm512_set1_epi32(max_val)));
+  return _mm512_cvtepi32_epi8(v);
+}
+
+template <typename T>
+inline void __attribute__((always_inline)) QuantizeAvx512(
+    const float* src,
+    typename T::underlying* dst,
+    int len,
+    float inverse_scale,
+    int64_t zero_point) {
+  constexpr int VLEN = 16;
+  constexpr auto min_val = std::numeric_limits<typename T::underlying>::min();
+  constexpr auto max_val = std::numeric_limits<typename T::underlying>::max();
+  // This is the largest int32 value < int32_max exactly representable in float
+  constexpr int32_t int32_float_max_val =
+      std::numeric_limits<int32_t>::max() - 127;
+  int i = 0;
+  __m512 inverse_scale_v = _mm512_set1_ps(inverse_scale);
+  __m512i zero_point_v = _mm512_set1_epi32(zero_point);
+  for (; i < len / VLEN * VLEN; i += VLEN) {
+    __m512 x_vals = _mm512_loadu_ps(src + i);
+    __m512 x_transformed_v = _mm512_mul_ps(x_vals, inverse_scale_v);
+    // If the floating point value is greater than int32_max,
+    // _mm512_cvtps_epi32 converts them to -ve. Clip at int32_float_max_val to
+    // avoid this.
+    x_transformed_v =
+        _mm512_min_ps(x_transformed_v, _mm512_set1_ps(int32_float_max_val));
+    __m512i x_rounded_v = _mm512_cvtps_epi32(x_transformed_v);
+    x_rounded_v = _mm512_add_epi32(x_rounded_v, zero_point_v);
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        clamp_and_narrow_epi32<typename T::underlying>(x_rounded_v));
+  }
+
+  for (; i < len; ++i) {
+    float transformed = src[i] * inverse_scale;
+    // See the note on rounding in QuantizeAvx2 (vec256_qint.h).
+    transformed = zero_point + nearbyint(transformed);
+    float clipped =
+        std::min(std::max(transformed, float(min_val)), float(max_val));
+    dst[i] = clipped;
+  }
+}
+
+template<>
+struct Vec512<c10::qint32> : public Vec512qi {
+    static constexpr int size() {
+        return 16;
+    }
+
+    static constexpr int float_num_vecs() {
+        return 1;
+    }
+
+    static constexpr int int_num_vecs() {
+        return 1;
+    }
+
+    using float_vec_return_type = std::array<Vec512<float>, 1>;
+    using int_vec_return_type = std::array<Vec512<c10::qint32>, 1>;
+    using value_type = c10::qint32::underlying;
+
+ public:
+    using Vec512qi::Vec512qi;
+    Vec512() {}
+
+    Vec512(__m512i vals_) { vals = vals_;}
+
+    // Broadcast constructor
+    Vec512(const c10::qint32& val) {
+        value_type uw = val.val_;
+        vals = _mm512_set1_epi32(uw);
+    }
+
+    void store(void* ptr, int count = size()) const {
+      if (count != size()) {
+        memcpy(ptr, &vals, count * sizeof(value_type));
+      } else {
+        _mm512_storeu_si512(ptr, vals);
+      }
+    }
+
+    static Vec512<c10::qint32> loadu(const void* ptr) {
+        return Vec512<c10::qint32>(ptr);
+    }
+
+    float_vec_return_type dequantize(
+        Vec512<float> scale,
+        Vec512<float> zero_point,
+        Vec512<float> scale_zp_premul) const {
+      __m512 float_vals = _mm512_cvtepi32_ps(vals);
+      return {vec512::fmadd(scale, Vec512<float>(float_vals), scale_zp_premul)};
+    }
+
+    static Vec512<c10::qint32> quantize(
+        const float_vec_return_type& rhs,
+        float scale,
+        int32_t zero_point,
+        float inverse_scale) {
+      Vec512<c10::qint32> retval;
+      auto rhs_data = (__m512)rhs[0];
+      at::native::quantize_vec<c10::qint32, /*precision=*/32>(
+          scale, zero_point, (float*)&rhs_data, (c10::qint32*)&retval.vals, 16);
+      return retval;
+    }
+
+    Vec512<c10::qint32> maximum(Vec512<c10::qint32> b) const {
+      return _mm512_max_epi32(vals, b.vals);
+    }
+
+    Vec512<c10::qint32> minimum(Vec512<c10::qint32> b) const {
+      return _mm512_min_epi32(vals, b.vals);
+    }
+
+    Vec512<c10::qint32> relu(Vec512<c10::qint32> zero_point) const {
+        return maximum(zero_point);
+    }
+
+    Vec512<c10::qint32> relu6(
+        Vec512<c10::qint32> zero_point,
+        Vec512<c10::qint32> q_six) {
+      return _mm512_min_epi32(
+          _mm512_max_epi32(vals, zero_point.vals), q_six.vals);
+    }
+
+    int_vec_return_type widening_subtract(Vec512<c10::qint32> b) const {
+      return {_mm512_sub_epi32(vals, b)};
+    }
+
+    static Vec512<c10::qint32> requantize_from_int(
+        const int_vec_return_type& inp,
+        float multiplier,
+        int32_t zero_point) {
+      __m512 multiplier_v = _mm512_set1_ps(multiplier);
+      __m512i zero_point_v = _mm512_set1_epi32(zero_point);
+
+      __m512 scaled = _mm512_mul_ps(_mm512_cvtepi32_ps(inp[0]), multiplier_v);
+      __m512i rounded = _mm512_cvtps_epi32(scaled);
+      return _mm512_add_epi32(rounded, zero_point_v);
+    }
+
+    void dump() const {
+        for (size_t i = 0; i < size(); ++i) {
+          std::cout << ((int32_t*)&vals)[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+ private:
+    // Load from memory constructor
+    Vec512(const void* ptr) {
+      vals = _mm512_loadu_si512(ptr);
+    }
+};
+
+template <>
+Vec512<c10::qint32> inline maximum(const Vec512<c10::qint32>& a, const Vec512<c10::qint32>& b) {
+  return a.maximum(b);
+}
+
+template <>
+Vec512<c10::qint32> inline operator*(
+    const Vec512<c10::qint32>& a,
+    const Vec512<c10::qint32>& b) {
+  return _mm512_mullo_epi32(a, b);
+}
+
+template <>
+Vec512<c10::qint32> inline operator+(
+    const Vec512<c10::qint32>& a,
+    const Vec512<c10::qint32>& b) {
+  return _mm512_add_epi32(a, b);
+}
+
+/*
+ * Convert values from int32 back to int8/uint8
+ */
+template <typename T>
+__m512i RequantizeAvx512(
+    const std::array<Vec512<c10::qint32>, 4>& inp,
+    __m512 multiplier,
+    __m512i zp) {
+  static_assert(
+      std::is_same<T, int8_t>::value || std::is_same<T, uint8_t>::value,
+      "Only int8_t/uint8_t are supported");
+  __m128i narrowed[4];
+  for (int i = 0; i < 4; ++i) {
+    __m512 scaled_v = _mm512_mul_ps(_mm512_cvtepi32_ps(inp[i]), multiplier);
+    __m512i rounded_v = _mm512_cvtps_epi32(scaled_v);
+    /* Add zero point, clamp and narrow */
+    narrowed[i] = clamp_and_narrow_epi32<T>(_mm512_add_epi32(rounded_v, zp));
+  }
+  __m512i result = _mm512_castsi128_si512(narrowed[0]);
+  result = _mm512_inserti32x4(result, narrowed[1], 1);
+  result = _mm512_inserti32x4(result, narrowed[2], 2);
+  return _mm512_inserti32x4(result, narrowed[3], 3);
+}
+
+template<>
+struct Vec512<c10::qint8> : public Vec512qi {
+    static constexpr int size() {
+        return 64;
+    }
+
+    static constexpr int float_num_vecs() {
+        return 4;
+    }
+
+    static constexpr int int_num_vecs() {
+        return 4;
+    }
+
+    using float_vec_return_type = std::array<Vec512<float>, 4>;
+    using int_vec_return_type = std::array<Vec512<c10::qint32>, 4>;
+    using value_type = typename c10::qint8::underlying;
+
+ public:
+    using Vec512qi::Vec512qi;
+
+    Vec512() {}
+    Vec512(__m512i vals_) { vals = vals_;}
+
+    // Broadcast constructor
+    Vec512(const c10::qint8& val) {
+        value_type uw = val.val_;
+        vals = _mm512_set1_epi8(uw);
+    }
+
+    // This is needed because the compiler emits awful code for the default
+    // constructor for moving the enum
+    Vec512(const Vec512<c10::qint8>& other) : Vec512qi(other.vals) { }
+
+    void store(void* ptr, int count = size()) const {
+        if (count != size()) {
+            memcpy(ptr, &vals, count * sizeof(value_type));
+        } else {
+            _mm512_storeu_si512(ptr, vals);
+        }
+    }
+
+    static Vec512<c10::qint8> loadu(const void* ptr) {
+        return Vec512<c10::qint8>(ptr);
+    }
+
+ private:
+    // Widens the i-th group of 16 elements to int32.
+    template <int i>
+    __m512i cvtepi8_epi32(__m512i v) const {
+        return _mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(v, i));
+    }
+
+ public:
+  float_vec_return_type dequantize(
+      Vec512<float> scale,
+      Vec512<float> zero_point,
+      Vec512<float> scale_neg_zp_premul) const {
+    __m512 float_val0 = _mm512_cvtepi32_ps(cvtepi8_epi32<0>(vals));
+    __m512 float_val1 = _mm512_cvtepi32_ps(cvtepi8_epi32<1>(vals));
+    __m512 float_val2 = _mm512_cvtepi32_ps(cvtepi8_epi32<2>(vals));
+    __m512 float_val3 = _mm512_cvtepi32_ps(cvtepi8_epi32<3>(vals));
+
+    auto val0 =
+        vec512::fmadd(scale, Vec512<float>(float_val0), scale_neg_zp_premul);
+    auto val1 =
+        vec512::fmadd(scale, Vec512<float>(float_val1), scale_neg_zp_premul);
+    auto val2 =
+        vec512::fmadd(scale, Vec512<float>(float_val2), scale_neg_zp_premul);
+    auto val3 =
+        vec512::fmadd(scale, Vec512<float>(float_val3), scale_neg_zp_premul);
+    return {val0, val1, val2, val3};
+  }
+
+  static Vec512<c10::qint8> quantize(
+      const float_vec_return_type& rhs,
+      float scale,
+      int32_t zero_point,
+      float inverse_scale) {
+    auto* rhs_data = (float*)rhs.data();
+    int8_t quantized_values[64];
+    QuantizeAvx512<c10::qint8>(
+        rhs_data, quantized_values, 64, inverse_scale, zero_point);
+    return Vec512<c10::qint8>::loadu(quantized_values);
+  }
+
+  Vec512<c10::qint8> maximum(Vec512<c10::qint8> b) const {
+      return _mm512_max_epi8(vals, b.vals);
+    }
+
+  Vec512<c10::qint8> minimum(Vec512<c10::qint8> b) const {
+      return _mm512_min_epi8(vals, b.vals);
+    }
+
+    Vec512<c10::qint8> relu(Vec512<c10::qint8> zero_point) const {
+        return maximum(zero_point);
+    }
+
+    Vec512<c10::qint8> relu6(
+        Vec512<c10::qint8> zero_point,
+        Vec512<c10::qint8> q_six) {
+      return _mm512_min_epi8(
+          _mm512_max_epi8(vals, zero_point.vals), q_six.vals);
+    }
+
+    int_vec_return_type widening_subtract(Vec512<c10::qint8> b) const {
+      __m512i res_0 = _mm512_sub_epi32(cvtepi8_epi32<0>(vals), cvtepi8_epi32<0>(b));
+      __m512i res_1 = _mm512_sub_epi32(cvtepi8_epi32<1>(vals), cvtepi8_epi32<1>(b));
+      __m512i res_2 = _mm512_sub_epi32(cvtepi8_epi32<2>(vals), cvtepi8_epi32<2>(b));
+      __m512i res_3 = _mm512_sub_epi32(cvtepi8_epi32<3>(vals), cvtepi8_epi32<3>(b));
+
+      return {Vec512<c10::qint32>(res_0),
+              Vec512<c10::qint32>(res_1),
+              Vec512<c10::qint32>(res_2),
+              Vec512<c10::qint32>(res_3)};
+    }
+
+    static Vec512<c10::qint8> requantize_from_int(
+        const int_vec_return_type& inp,
+        float multiplier,
+        int32_t zero_point) {
+      __m512 multiplier_v = _mm512_set1_ps(multiplier);
+      __m512i zero_point_v = _mm512_set1_epi32(zero_point);
+      return RequantizeAvx512<value_type>(inp, multiplier_v, zero_point_v);
+    }
+
+    void dump() const {
+        for (size_t i = 0; i < size(); ++i) {
+            std::cout << (int)((value_type*)&vals)[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+ private:
+    // Load from memory constructor
+    Vec512(const void* ptr) {
+        vals = _mm512_loadu_si512(ptr);
+    }
+};
+
+template <>
+Vec512<c10::qint8> inline maximum(const Vec512<c10::qint8>& a, const Vec512<c10::qint8>& b) {
+  return a.maximum(b);
+}
+
+template<>
+struct Vec512<c10::quint8> : public Vec512qi {
+    static constexpr int size() {
+        return 64;
+    }
+
+    static constexpr int float_num_vecs() {
+        return 4;
+    }
+
+    static constexpr int int_num_vecs() {
+        return 4;
+    }
+
+    using float_vec_return_type = std::array<Vec512<float>, 4>;
+    using int_vec_return_type = std::array<Vec512<c10::qint32>, 4>;
+    using value_type = typename c10::quint8::underlying;
+
+ public:
+    using Vec512qi::Vec512qi;
+
+    Vec512() {}
+    Vec512(__m512i vals_) { vals = vals_;}
+
+    // Broadcast constructor
+    Vec512(const c10::quint8& val) {
+        value_type uw = val.val_;
+        vals = _mm512_set1_epi8(uw);
+    }
+
+    // This is needed because the compiler emits awful code for the default
+    // constructor for moving the enum
+    Vec512(const Vec512<c10::quint8>& other) : Vec512qi(other.vals) { }
+
+    void store(void* ptr, int count = size()) const {
+        if (count != size()) {
+            memcpy(ptr, &vals, count * sizeof(value_type));
+        } else {
+            _mm512_storeu_si512(ptr, vals);
+        }
+    }
+
+    static Vec512<c10::quint8> loadu(const void* ptr) {
+        return Vec512<c10::quint8>(ptr);
+    }
+
+ private:
+    // Widens the i-th group of 16 elements to int32.
+    template <int i>
+    __m512i cvtepu8_epi32(__m512i v) const {
+        return _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(v, i));
+    }
+
+ public:
+  float_vec_return_type dequantize(
+      Vec512<float> scale,
+      Vec512<float> zero_point,
+      Vec512<float> scale_neg_zp_premul) const {
+    __m512 float_val0 = _mm512_cvtepi32_ps(cvtepu8_epi32<0>(vals));
+    __m512 float_val1 = _mm512_cvtepi32_ps(cvtepu8_epi32<1>(vals));
+    __m512 float_val2 = _mm512_cvtepi32_ps(cvtepu8_epi32<2>(vals));
+    __m512 float_val3 = _mm512_cvtepi32_ps(cvtepu8_epi32<3>(vals));
+
+    auto val0 =
+        vec512::fmadd(scale, Vec512<float>(float_val0), scale_neg_zp_premul);
+    auto val1 =
+        vec512::fmadd(scale, Vec512<float>(float_val1), scale_neg_zp_premul);
+    auto val2 =
+        vec512::fmadd(scale, Vec512<float>(float_val2), scale_neg_zp_premul);
+    auto val3 =
+        vec512::fmadd(scale, Vec512<float>(float_val3), scale_neg_zp_premul);
+    return {val0, val1, val2, val3};
+  }
+
+  static Vec512<c10::quint8> quantize(
+      const float_vec_return_type& rhs,
+      float scale,
+      int32_t zero_point,
+      float inverse_scale) {
+    auto* rhs_data = (float*)rhs.data();
+    uint8_t quantized_values[64];
+    QuantizeAvx512<c10::quint8>(
+        rhs_data, quantized_values, 64, inverse_scale, zero_point);
+    return Vec512<c10::quint8>::loadu(quantized_values);
+  }
+
+  Vec512<c10::quint8> maximum(Vec512<c10::quint8> b) const {
+      return _mm512_max_epu8(vals, b.vals);
+    }
+
+  Vec512<c10::quint8> minimum(Vec512<c10::quint8> b) const {
+      return _mm512_min_epu8(vals, b.vals);
+    }
+
+    Vec512<c10::quint8> relu(Vec512<c10::quint8> zero_point) const {
+        return maximum(zero_point);
+    }
+
+    Vec512<c10::quint8> relu6(
+        Vec512<c10::quint8> zero_point,
+        Vec512<c10::quint8> q_six) {
+      return _mm512_min_epu8(
+          _mm512_max_epu8(vals, zero_point.vals), q_six.vals);
+    }
+
+    int_vec_return_type widening_subtract(Vec512<c10::quint8> b) const {
+      __m512i res_0 = _mm512_sub_epi32(cvtepu8_epi32<0>(vals), cvtepu8_epi32<0>(b));
+      __m512i res_1 = _mm512_sub_epi32(cvtepu8_epi32<1>(vals), cvtepu8_epi32<1>(b));
+      __m512i res_2 = _mm512_sub_epi32(cvtepu8_epi32<2>(vals), cvtepu8_epi32<2>(b));
+      __m512i res_3 = _mm512_sub_epi32(cvtepu8_epi32<3>(vals), cvtepu8_epi32<3>(b));
+
+      return {Vec512<c10::qint32>(res_0),
+              Vec512<c10::qint32>(res_1),
+              Vec512<c10::qint32>(res_2),
+              Vec512<c10::qint32>(res_3)};
+    }
+
+    static Vec512<c10::quint8> requantize_from_int(
+        const int_vec_return_type& inp,
+        float multiplier,
+        int32_t zero_point) {
+      __m512 multiplier_v = _mm512_set1_ps(multiplier);
+      __m512i zero_point_v = _mm512_set1_epi32(zero_point);
+      return RequantizeAvx512<value_type>(inp, multiplier_v, zero_point_v);
+    }
+
+    void dump() const {
+        for (size_t i = 0; i < size(); ++i) {
+            std::cout << (int)((value_type*)&vals)[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+ private:
+    // Load from memory constructor
+    Vec512(const void* ptr) {
+        vals = _mm512_loadu_si512(ptr);
+    }
+};
+
+template <>
+Vec512<c10::quint8> inline maximum(const Vec512<c10::quint8>& a, const Vec512<c10::quint8>& b) {
+  return a.maximum(b);
+}
+
+#else
+
+// NOTE: These are low-performance implementations that we fall back on
+// if we are not building with AVX512. Kernels built for the lower
+// capabilities are expected to use Vec256 instead, so these only act as a
+// reference implementation.
+
+template <
+    typename T,
+    typename float_vec_return_type_,
+    typename int_vec_return_type_,
+    int size_>
+struct Vec512QuantizedConverter {
+  static constexpr int size() {
+    return size_;
+  }
+
+  static constexpr int float_num_vecs() {
+    return size() / 16;
+  }
+
+  static constexpr int int_num_vecs() {
+    return size() / 16;
+  }
+
+  using float_vec_return_type = float_vec_return_type_;
+  using int_vec_return_type = int_vec_return_type_;
+
+  using value_type = typename T::underlying;
+  std::array<value_type, size_> vals;
+
+  Vec512QuantizedConverter(T val) {
+    for (size_t i = 0; i < size(); ++i) {
+      vals[i] = val.val_;
+    }
+  }
+
+  Vec512QuantizedConverter(const void* ptr) {
+    memcpy(vals.data(), ptr, sizeof(value_type) * size());
+  }
+
+  void store(void* ptr, int count = size()) const {
+    memcpy(ptr, vals.data(), count * sizeof(value_type));
+  }
+
+  float_vec_return_type dequantize(
+      Vec512<float> scale,
+      Vec512<float> zero_point,
+      Vec512<float> scale_zp_premul) const {
+    float_vec_return_type rv;
+    for (int i = 0; i < float_num_vecs(); ++i) {
+      for (int j = 0; j < 16; ++j) {
+        rv[i][j] = at::native::dequantize_val<T>(
+            scale[j], zero_point[j], T(vals[16 * i + j]));
+      }
+    }
+    return rv;
+  }
+
+  void dump() const {
+      for (int i = 0; i < size(); ++i) {
+          std::cout << vals[i] << " ";
+      }
+      std::cout << std::endl;
+  }
+
+ protected:
+  Vec512QuantizedConverter() {}
+};
+
+template <>
+struct Vec512<c10::qint32> : public Vec512QuantizedConverter<
+                                 c10::qint32,
+                                 std::array<Vec512<float>, 1>,
+                                 std::array<Vec512<c10::qint32>, 1>,
+                                 16> {
+  Vec512()
+      : Vec512QuantizedConverter<
+            c10::qint32,
+            std::array<Vec512<float>, 1>,
+            std::array<Vec512<c10::qint32>, 1>,
+            16>() {}
+  Vec512(c10::qint32 val)
+      : Vec512QuantizedConverter<
+            c10::qint32,
+            std::array<Vec512<float>, 1>,
+            std::array<Vec512<c10::qint32>, 1>,
+            16>(val) {}
+  Vec512(const void* ptr)
+      : Vec512QuantizedConverter<
+            c10::qint32,
+            std::array<Vec512<float>, 1>,
+            std::array<Vec512<c10::qint32>, 1>,
+            16>(ptr) {}
+
+  static Vec512<c10::qint32> loadu(const void* ptr) {
+    return Vec512<c10::qint32>(ptr);
+  }
+
+  static Vec512<c10::qint32> quantize(
+      const float_vec_return_type& rhs,
+      float scale,
+      int32_t zero_point,
+      float inverse_scale) {
+    std::array<value_type, size()> qvals;
+    std::array<float, float_num_vecs() * 16> float_vals;
+
+    for (int i = 0; i < float_num_vecs(); ++i) {
+      rhs[i].store(&float_vals[i * 16], 16);
+    }
+
+    at::native::quantize_vec<c10::qint32, /*precision=*/32>(
+        scale,
+        zero_point,
+        float_vals.data(),
+        (c10::qint32*)qvals.data(),
+        16 * float_num_vecs());
+
+    return Vec512<c10::qint32>::loadu(qvals.data());
+  }
+
+  Vec512<c10::qint32> maximum(Vec512<c10::qint32> b) const {
+    Vec512<c10::qint32> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::max<value_type>(vals[i], b.vals[i]);
+    }
+    return retval;
+  }
+
+  Vec512<c10::qint32> minimum(Vec512<c10::qint32> b) const {
+    Vec512<c10::qint32> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::min<value_type>(vals[i], b.vals[i]);
+    }
+    return retval;
+  }
+
+  Vec512<c10::qint32> relu(Vec512<c10::qint32> zero_point) const  {
+    return maximum(zero_point);
+  }
+
+
+  Vec512<c10::qint32> relu6(
+      Vec512<c10::qint32> zero_point,
+      Vec512<c10::qint32> q_six) {
+    Vec512<c10::qint32> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::min<value_type>(
+          std::max<value_type>(vals[i], zero_point.vals[i]), q_six.vals[i]);
+    }
+    return retval;
+  }
+
+  int_vec_return_type widening_subtract(Vec512<c10::qint32> b) const {
+    int_vec_return_type retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval[0].vals[i] = vals[i] - b.vals[i];
+    }
+    return retval;
+  }
+
+  static Vec512<c10::qint32> requantize_from_int(
+      const int_vec_return_type& inp,
+      float multiplier,
+      int32_t zero_point) {
+    Vec512<c10::qint32> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] =
+          nearbyint(static_cast<float>(inp[0].vals[i]) * multiplier) +
+          zero_point;
+    }
+    return retval;
+  }
+};
+
+template <>
+Vec512<c10::qint32> inline maximum(const Vec512<c10::qint32>& a, const Vec512<c10::qint32>& b) {
+  return a.maximum(b);
+}
+
+template <>
+Vec512<c10::qint32> inline operator*(
+    const Vec512<c10::qint32>& a,
+    const Vec512<c10::qint32>& b) {
+  Vec512<c10::qint32> retval;
+  for (size_t i = 0; i < std::decay_t<decltype(a)>::size(); ++i) {
+    retval.vals[i] = a.vals[i] * b.vals[i];
+  }
+  return retval;
+}
+
+template <>
+Vec512<c10::qint32> inline operator+(
+    const Vec512<c10::qint32>& a,
+    const Vec512<c10::qint32>& b) {
+  Vec512<c10::qint32> retval;
+  for (size_t i = 0; i < std::decay_t<decltype(a)>::size(); ++i) {
+    retval.vals[i] = a.vals[i] + b.vals[i];
+  }
+  return retval;
+}
+
+template <>
+struct Vec512<c10::qint8> : public Vec512QuantizedConverter<
+                                c10::qint8,
+                                std::array<Vec512<float>, 4>,
+                                std::array<Vec512<c10::qint32>, 4>,
+                                64> {
+  Vec512()
+      : Vec512QuantizedConverter<
+            c10::qint8,
+            std::array<Vec512<float>, 4>,
+            std::array<Vec512<c10::qint32>, 4>,
+            64>() {}
+  Vec512(c10::qint8 val)
+      : Vec512QuantizedConverter<
+            c10::qint8,
+            std::array<Vec512<float>, 4>,
+            std::array<Vec512<c10::qint32>, 4>,
+            64>(val) {}
+  Vec512(const void* ptr)
+      : Vec512QuantizedConverter<
+            c10::qint8,
+            std::array<Vec512<float>, 4>,
+            std::array<Vec512<c10::qint32>, 4>,
+            64>(ptr) {}
+
+  static Vec512<c10::qint8> loadu(const void* ptr) {
+    return Vec512<c10::qint8>(ptr);
+  }
+
+  static Vec512<c10::qint8> quantize(
+      const float_vec_return_type& rhs,
+      float scale,
+      int32_t zero_point,
+      float inverse_scale) {
+    std::array<value_type, size()> qvals;
+    std::array<float, float_num_vecs() * 16> float_vals;
+
+    for (int i = 0; i < float_num_vecs(); ++i) {
+      rhs[i].store(&float_vals[i * 16], 16);
+    }
+
+    at::native::quantize_vec<c10::qint8>(
+        scale,
+        zero_point,
+        float_vals.data(),
+        (c10::qint8*)qvals.data(),
+        16 * float_num_vecs());
+
+    return Vec512<c10::qint8>::loadu(qvals.data());
+  }
+
+  Vec512<c10::qint8> maximum(Vec512<c10::qint8> b) const {
+    Vec512<c10::qint8> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::max<value_type>(vals[i], b.vals[i]);
+    }
+    return retval;
+  }
+
+  Vec512<c10::qint8> minimum(Vec512<c10::qint8> b) const {
+    Vec512<c10::qint8> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::min<value_type>(vals[i], b.vals[i]);
+    }
+    return retval;
+  }
+
+  Vec512<c10::qint8> relu(Vec512<c10::qint8> zero_point) const {
+    return maximum(zero_point);
+  }
+
+  Vec512<c10::qint8> relu6(
+      Vec512<c10::qint8> zero_point,
+      Vec512<c10::qint8> q_six) {
+    Vec512<c10::qint8> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::min<value_type>(
+          std::max<value_type>(vals[i], zero_point.vals[i]), q_six.vals[i]);
+    }
+    return retval;
+  }
+
+  int_vec_return_type widening_subtract(Vec512<c10::qint8> b) const {
+    int_vec_return_type retval;
+    constexpr int elem_per_int_vec = size() / int_num_vecs();
+    for (size_t i = 0; i < int_num_vecs(); ++i) {
+      for (size_t j = 0; j < elem_per_int_vec; ++j) {
+        retval[i].vals[j] =
+            static_cast<int32_t>(vals[i * elem_per_int_vec + j]) -
+            static_cast<int32_t>(b.vals[i * elem_per_int_vec + j]);
+      }
+    }
+    return retval;
+  }
+  static Vec512<c10::qint8> requantize_from_int(
+      const int_vec_return_type& inp,
+      float multiplier,
+      int32_t zero_point) {
+    constexpr int elem_per_int_vec = size() / int_num_vecs();
+    constexpr auto min_val = std::numeric_limits<value_type>::min();
+    constexpr auto max_val = std::numeric_limits<value_type>::max();
+    Vec512<c10::qint8> retval;
+    for (size_t i = 0; i < int_num_vecs(); ++i) {
+      for (size_t j = 0; j < elem_per_int_vec; ++j) {
+        int32_t rounded =
+            nearbyint(static_cast<float>(inp[i].vals[j]) * multiplier) +
+            zero_point;
+        retval.vals[i * elem_per_int_vec + j] =
+            std::min<int32_t>(std::max<int32_t>(rounded, min_val), max_val);
+      }
+    }
+    return retval;
+  }
+};
+
+template <>
+Vec512<c10::qint8> inline maximum(const Vec512<c10::qint8>& a, const Vec512<c10::qint8>& b) {
+  return a.maximum(b);
+}
+
+template <>
+struct Vec512<c10::quint8> : public Vec512QuantizedConverter<
+                                 c10::quint8,
+                                 std::array<Vec512<float>, 4>,
+                                 std::array<Vec512<c10::qint32>, 4>,
+                                 64> {
+  Vec512()
+      : Vec512QuantizedConverter<
+            c10::quint8,
+            std::array<Vec512<float>, 4>,
+            std::array<Vec512<c10::qint32>, 4>,
+            64>() {}
+  Vec512(c10::quint8 val)
+      : Vec512QuantizedConverter<
+            c10::quint8,
+            std::array<Vec512<float>, 4>,
+            std::array<Vec512<c10::qint32>, 4>,
+            64>(val) {}
+  Vec512(const void* ptr)
+      : Vec512QuantizedConverter<
+            c10::quint8,
+            std::array<Vec512<float>, 4>,
+            std::array<Vec512<c10::qint32>, 4>,
+            64>(ptr) {}
+
+  static Vec512<c10::quint8> loadu(const void* ptr) {
+    return Vec512<c10::quint8>(ptr);
+  }
+
+  static Vec512<c10::quint8> quantize(
+      const float_vec_return_type& rhs,
+      float scale,
+      int32_t zero_point,
+      float inverse_scale) {
+    std::array<value_type, size()> qvals;
+    std::array<float, float_num_vecs() * 16> float_vals;
+
+    for (int i = 0; i < float_num_vecs(); ++i) {
+      rhs[i].store(&float_vals[i * 16], 16);
+    }
+
+    at::native::quantize_vec<c10::quint8>(
+        scale,
+        zero_point,
+        float_vals.data(),
+        (c10::quint8*)qvals.data(),
+        16 * float_num_vecs());
+
+    return Vec512<c10::quint8>::loadu(qvals.data());
+  }
+
+  Vec512<c10::quint8> maximum(Vec512<c10::quint8> b) const {
+    Vec512<c10::quint8> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::max<value_type>(vals[i], b.vals[i]);
+    }
+    return retval;
+  }
+
+  Vec512<c10::quint8> minimum(Vec512<c10::quint8> b) const {
+    Vec512<c10::quint8> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::min<value_type>(vals[i], b.vals[i]);
+    }
+    return retval;
+  }
+
+  Vec512<c10::quint8> relu(Vec512<c10::quint8> zero_point) const {
+    return maximum(zero_point);
+  }
+
+
+  Vec512<c10::quint8> relu6(
+      Vec512<c10::quint8> zero_point,
+      Vec512<c10::quint8> q_six) {
+    Vec512<c10::quint8> retval;
+    for (size_t i = 0; i < size(); ++i) {
+      retval.vals[i] = std::min<value_type>(
+          std::max<value_type>(vals[i], zero_point.vals[i]), q_six.vals[i]);
+    }
+    return retval;
+  }
+
+  int_vec_return_type widening_subtract(Vec512<c10::quint8> b) const {
+    int_vec_return_type retval;
+    constexpr int elem_per_int_vec = size() / int_num_vecs();
+    for (size_t i = 0; i < int_num_vecs(); ++i) {
+      for (size_t j = 0; j < elem_per_int_vec; ++j) {
+        retval[i].vals[j] =
+            static_cast<int32_t>(vals[i * elem_per_int_vec + j]) -
+            static_cast<int32_t>(b.vals[i * elem_per_int_vec + j]);
+      }
+    }
+    return retval;
+  }
+  static Vec512<c10::quint8> requantize_from_int(
+      const int_vec_return_type& inp,
+      float multiplier,
+      int32_t zero_point) {
+    constexpr int elem_per_int_vec = size() / int_num_vecs();
+    constexpr auto min_val = std::numeric_limits<value_type>::min();
+    constexpr auto max_val = std::numeric_limits<value_type>::max();
+    Vec512<c10::quint8> retval;
+    for (size_t i = 0; i < int_num_vecs(); ++i) {
+      for (size_t j = 0; j < elem_per_int_vec; ++j) {
+        int32_t rounded =
+            nearbyint(static_cast<float>(inp[i].vals[j]) * multiplier) +
+            zero_point;
+        retval.vals[i * elem_per_int_vec + j] =
+            std::min<int32_t>(std::max<int32_t>(rounded, min_val), max_val);
+      }
+    }
+    return retval;
+  }
+};
+
+template <>
+Vec512<c10::quint8> inline maximum(const Vec512<c10::quint8>& a, const Vec512<c10::quint8>& b) {
+  return a.maximum(b);
+}
+
+#endif // defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+}}}
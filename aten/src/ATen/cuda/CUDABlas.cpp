@@ -364,6 +364,56 @@ void gemv<at::BFloat16>(CUDABLAS_GEMV_ARGTYPES(at::BFloat16)) {
 }
 #endif
 
+#ifndef __HIP_PLATFORM_HCC__
+
+/* BATCHED LU FUNCTIONS */
+
+template <>
+void getrfBatched<double>(CUDABLAS_GETRF_BATCHED_ARGTYPES(double)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasDgetrfBatched(
+      handle, n, dA_array, ldda, ipiv_array, info_array, batchsize));
+}
+
+template <>
+void getrfBatched<float>(CUDABLAS_GETRF_BATCHED_ARGTYPES(float)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasSgetrfBatched(
+      handle, n, dA_array, ldda, ipiv_array, info_array, batchsize));
+}
+
+template <>
+void getrsBatched<double>(CUDABLAS_GETRS_BATCHED_ARGTYPES(double)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  cublasOperation_t op = _cublasOpFromChar(trans);
+  TORCH_CUDABLAS_CHECK(cublasDgetrsBatched(
+      handle, op, n, nrhs, dA_array, ldda, ipiv_array, dB_array, lddb, info, batchsize));
+}
+
+template <>
+void getrsBatched<float>(CUDABLAS_GETRS_BATCHED_ARGTYPES(float)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  cublasOperation_t op = _cublasOpFromChar(trans);
+  TORCH_CUDABLAS_CHECK(cublasSgetrsBatched(
+      handle, op, n, nrhs, dA_array, ldda, ipiv_array, dB_array, lddb, info, batchsize));
+}
+
+template <>
+void getriBatched<double>(CUDABLAS_GETRI_BATCHED_ARGTYPES(double)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasDgetriBatched(
+      handle, n, dA_array, ldda, ipiv_array, dC_array, lddc, info_array, batchsize));
+}
+
+template <>
+void getriBatched<float>(CUDABLAS_GETRI_BATCHED_ARGTYPES(float)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasSgetriBatched(
+      handle, n, dA_array, ldda, ipiv_array, dC_array, lddc, info_array, batchsize));
+}
+
+#endif // __HIP_PLATFORM_HCC__
+
 } // namespace blas
 } // namespace cuda
 } // namespace at
@@ -7,8 +7,19 @@
 
     gemv<Dtype>(transa, m, n, alpha, a, lda, x, incx, beta, y, incy)
 
-  where Dtype is double, float, at::Half or at::BFloat16(ROCm). The functions are
-  available in at::cuda::blas namespace.
+  where Dtype is double, float, at::Half or at::BFloat16(ROCm), and the batched
+  LU routines of cuBLAS (CUDA only)
+
+    getrfBatched<Dtype>(n, dA_array, ldda, ipiv_array, info_array, batchsize)
+
+    getrsBatched<Dtype>(trans, n, nrhs, dA_array, ldda, ipiv_array, dB_array,
+  lddb, info, batchsize)
+
+    getriBatched<Dtype>(n, dA_array, ldda, ipiv_array, dC_array, lddc,
+  info_array, batchsize)
+
+  where Dtype is double or float. The functions are available in
+  at::cuda::blas namespace.
  */
 
 #include <ATen/cuda/CUDAContext.h>
@@ -63,6 +74,59 @@ template <>
 void gemv<at::BFloat16>(CUDABLAS_GEMV_ARGTYPES(at::BFloat16));
 #endif
 
+#ifndef __HIP_PLATFORM_HCC__
+
+/* BATCHED LU FUNCTIONS */
+
+// The arrays of matrices are device arrays of device pointers and ipiv_array
+// holds n pivots per matrix, one after the other. info_array is a device
+// array, except for getrsBatched whose info is a single host integer that only
+// reports invalid arguments.
+
+#define CUDABLAS_GETRF_BATCHED_ARGTYPES(Dtype)                \
+      int n, Dtype** dA_array, int ldda, int* ipiv_array,     \
+      int* info_array, int batchsize
+
+template <typename Dtype>
+inline void getrfBatched(CUDABLAS_GETRF_BATCHED_ARGTYPES(Dtype)) {
+  AT_ERROR("at::cuda::blas::getrfBatched: not implemented for ", typeid(Dtype).name());
+}
+
+template <>
+void getrfBatched<double>(CUDABLAS_GETRF_BATCHED_ARGTYPES(double));
+template <>
+void getrfBatched<float>(CUDABLAS_GETRF_BATCHED_ARGTYPES(float));
+
+#define CUDABLAS_GETRS_BATCHED_ARGTYPES(Dtype)                           \
+      char trans, int n, int nrhs, Dtype** dA_array, int ldda,           \
+      int* ipiv_array, Dtype** dB_array, int lddb, int* info, int batchsize
+
+template <typename Dtype>
+inline void getrsBatched(CUDABLAS_GETRS_BATCHED_ARGTYPES(Dtype)) {
+  AT_ERROR("at::cuda::blas::getrsBatched: not implemented for ", typeid(Dtype).name());
+}
+
+template <>
+void getrsBatched<double>(CUDABLAS_GETRS_BATCHED_ARGTYPES(double));
+template <>
+void getrsBatched<float>(CUDABLAS_GETRS_BATCHED_ARGTYPES(float));
+
+#define CUDABLAS_GETRI_BATCHED_ARGTYPES(Dtype)                          \
+      int n, Dtype** dA_array, int ldda, int* ipiv_array,               \
+      Dtype** dC_array, int lddc, int* info_array, int batchsize
+
+template <typename Dtype>
+inline void getriBatched(CUDABLAS_GETRI_BATCHED_ARGTYPES(Dtype)) {
+  AT_ERROR("at::cuda::blas::getriBatched: not implemented for ", typeid(Dtype).name());
+}
+
+template <>
+void getriBatched<double>(CUDABLAS_GETRI_BATCHED_ARGTYPES(double));
+template <>
+void getriBatched<float>(CUDABLAS_GETRI_BATCHED_ARGTYPES(float));
+
+#endif // __HIP_PLATFORM_HCC__
+
 } // namespace blas
 } // namespace cuda
 } // namespace at
@@ -1,7 +1,10 @@
 #include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
 #include <c10/cuda/CUDAFunctions.h>
 #include <ATen/Utils.h>
 
+#include <limits>
+
 namespace at {
 
 namespace cuda { namespace detail {
@@ -144,11 +147,67 @@ uint64_t CUDAGeneratorImpl::philox_offset_per_thread() {
  * See Note [Acquire lock when using random generators]
  */
 std::pair<uint64_t, uint64_t> CUDAGeneratorImpl::philox_engine_inputs(uint64_t increment) {
+  at::cuda::assertNotCapturing("Calling philox_engine_inputs (use philox_cuda_state instead)");
   uint64_t offset = this->philox_offset_per_thread_;
   this->philox_offset_per_thread_ += increment;
   return std::make_pair(this->seed_, offset);
 }
 
+/**
+ * Called by CUDAGraph to prepare this generator for a capture: the kernels
+ * captured until capture_epilogue read their seed and offset from
+ * seed_extragraph and offset_extragraph, which the graph fills before each
+ * replay. See Note [CUDA Graph-safe RNG states]
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CUDAGeneratorImpl::capture_prologue(int64_t* seed_extragraph, int64_t* offset_extragraph) {
+  this->seed_extragraph_ = seed_extragraph;
+  this->offset_extragraph_ = offset_extragraph;
+  this->offset_intragraph_ = 0;
+  this->graph_expects_this_gen_ = true;
+}
+
+/**
+ * Called by CUDAGraph at the end of a capture. Returns the total philox
+ * offset increment of the captured kernels, by which each replay advances
+ * the offset of this generator.
+ */
+uint64_t CUDAGeneratorImpl::capture_epilogue() {
+  this->graph_expects_this_gen_ = false;
+  return this->offset_intragraph_;
+}
+
+/**
+ * Same as philox_engine_inputs, for kernels that may be captured by a CUDA
+ * graph. Outside of capture the state holds the seed and offset; during
+ * capture it points to the values the graph sets before each replay.
+ *
+ * See Note [CUDA Graph-safe RNG states]
+ * See Note [Acquire lock when using random generators]
+ */
+PhiloxCudaState CUDAGeneratorImpl::philox_cuda_state(uint64_t increment) {
+  if (at::cuda::currentStreamCaptureStatus() != at::cuda::CaptureStatus::None) {
+    TORCH_CHECK(graph_expects_this_gen_,
+                "philox_cuda_state for an unexpected CUDA generator used during capture. "
+                "In regions captured by CUDA graphs, you may only use the default CUDA RNG "
+                "generator on the device that's current when capture begins.");
+    TORCH_INTERNAL_ASSERT(
+        this->offset_intragraph_ <= std::numeric_limits<uint32_t>::max() - increment,
+        "philox offset of the kernels of a CUDA graph overflows");
+    uint32_t offset = this->offset_intragraph_;
+    this->offset_intragraph_ += increment;
+    return PhiloxCudaState(this->seed_extragraph_, this->offset_extragraph_, offset);
+  } else {
+    TORCH_CHECK(!graph_expects_this_gen_,
+                "CUDA generator expects graph capture to be underway, "
+                "but the current stream is not capturing.");
+    uint64_t offset = this->philox_offset_per_thread_;
+    this->philox_offset_per_thread_ += increment;
+    return PhiloxCudaState(this->seed_, offset);
+  }
+}
+
 /*
  * Gets the DeviceType of CUDAGeneratorImpl.
  * Used for type checking during run time.
@@ -0,0 +1,163 @@
+#include <ATen/cuda/CUDAGraph.h>
+
+#include <ATen/ATen.h>
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/Utils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
+#include <ATen/cuda/Exceptions.h>
+#include <c10/cuda/CUDAFunctions.h>
+#include <c10/cuda/CUDAGuard.h>
+
+#include <atomic>
+
+namespace at {
+namespace cuda {
+
+namespace {
+
+c10::cuda::CUDACachingAllocator::MempoolId_t new_mempool_id() {
+  static std::atomic<c10::cuda::CUDACachingAllocator::MempoolId_t> next_id{1};
+  return next_id++;
+}
+
+CUDAGeneratorImpl* default_generator() {
+  return get_generator_or_default<CUDAGeneratorImpl>(
+      c10::nullopt, cuda::detail::getDefaultCUDAGenerator());
+}
+
+} // namespace
+
+CUDAGraph::CUDAGraph() {
+#if !defined(CUDA_VERSION) || CUDA_VERSION < 11000
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::capture_begin(c10::cuda::CUDACachingAllocator::MempoolId_t pool) {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  TORCH_CHECK(!has_graph_exec_ && !capturing_,
+              "This CUDAGraph instance already owns a captured graph. "
+              "To capture a new graph, create a new instance or reset() this one.");
+
+  auto stream = getCurrentCUDAStream();
+  TORCH_CHECK(stream != getDefaultCUDAStream(),
+              "CUDA graphs must be captured on a non-default stream. "
+              "(However, after capture, it's ok to replay them on the default stream.)");
+
+  // The seed and offset of the captured RNG kernels are read from device
+  // memory, see Note [CUDA Graph-safe RNG states]
+  seed_extragraph_ = at::empty({1}, TensorOptions().dtype(kLong).device(kCUDA));
+  offset_extragraph_ = at::empty({1}, TensorOptions().dtype(kLong).device(kCUDA));
+  auto* gen = default_generator();
+  {
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    gen->capture_prologue(seed_extragraph_.data_ptr<int64_t>(),
+                          offset_extragraph_.data_ptr<int64_t>());
+  }
+
+  capture_stream_ = stream;
+  capture_dev_ = c10::cuda::current_device();
+  mempool_id_ = pool != 0 ? pool : new_mempool_id();
+
+  // Allocations on the capturing stream come from the private pool from now
+  // on, including those of cudaStreamBeginCapture's caller that follow.
+  c10::cuda::CUDACachingAllocator::notifyCaptureBegin(capture_dev_, stream, mempool_id_);
+  cudaError_t err = cudaStreamBeginCapture(stream, cudaStreamCaptureModeGlobal);
+  if (err != cudaSuccess) {
+    c10::cuda::CUDACachingAllocator::notifyCaptureEnd(capture_dev_, stream);
+    c10::cuda::CUDACachingAllocator::notifyCaptureDestroy(capture_dev_, mempool_id_);
+    AT_CUDA_CHECK(err);
+  }
+  capturing_ = true;
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::capture_end() {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  TORCH_CHECK(capturing_, "Called CUDAGraph::capture_end without a preceding capture_begin.");
+  auto stream = getCurrentCUDAStream();
+  TORCH_CHECK(stream == *capture_stream_,
+              "Capture must end on the same stream it began on.");
+
+  cudaError_t err = cudaStreamEndCapture(stream, &graph_);
+  c10::cuda::CUDACachingAllocator::notifyCaptureEnd(capture_dev_, stream);
+  capturing_ = false;
+  auto* gen = default_generator();
+  {
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    wholegraph_increment_ = gen->capture_epilogue();
+  }
+  if (err != cudaSuccess || graph_ == NULL) {
+    c10::cuda::CUDACachingAllocator::notifyCaptureDestroy(capture_dev_, mempool_id_);
+    AT_CUDA_CHECK(err);
+    TORCH_CHECK(false, "Invalid capture.");
+  }
+
+  // The executable graph is all replay needs
+  err = cudaGraphInstantiate(&graph_exec_, graph_, NULL, NULL, 0);
+  AT_CUDA_CHECK(cudaGraphDestroy(graph_));
+  graph_ = NULL;
+  if (err != cudaSuccess) {
+    c10::cuda::CUDACachingAllocator::notifyCaptureDestroy(capture_dev_, mempool_id_);
+    AT_CUDA_CHECK(err);
+  }
+  has_graph_exec_ = true;
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::replay() {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  TORCH_CHECK(has_graph_exec_,
+              "Called CUDAGraph::replay without a preceding successful capture.");
+
+  c10::OptionalDeviceGuard device_guard{capture_stream_->device()};
+
+  // Like any RNG kernel, a replay advances the offset of the generator by
+  // the increment of its kernels
+  if (wholegraph_increment_ > 0) {
+    auto* gen = default_generator();
+    PhiloxCudaState rng_engine_inputs;
+    {
+      std::lock_guard<std::mutex> lock(gen->mutex_);
+      rng_engine_inputs = gen->philox_cuda_state(wholegraph_increment_);
+    }
+    seed_extragraph_.fill_(int64_t(rng_engine_inputs.seed_.val));
+    offset_extragraph_.fill_(int64_t(rng_engine_inputs.offset_.val));
+  }
+
+  AT_CUDA_CHECK(cudaGraphLaunch(graph_exec_, getCurrentCUDAStream()));
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in PyTorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::reset() {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  // Also called by the destructor, so errors are reported with
+  // C10_CUDA_CHECK_WARN rather than thrown
+  if (has_graph_exec_) {
+    C10_CUDA_CHECK_WARN(cudaGraphExecDestroy(graph_exec_));
+    graph_exec_ = NULL;
+    has_graph_exec_ = false;
+    c10::cuda::CUDACachingAllocator::notifyCaptureDestroy(capture_dev_, mempool_id_);
+  }
+#endif
+}
+
+c10::cuda::CUDACachingAllocator::MempoolId_t CUDAGraph::pool() const {
+  TORCH_CHECK(has_graph_exec_,
+              "Called CUDAGraph::pool without a preceding successful capture.");
+  return mempool_id_;
+}
+
+CUDAGraph::~CUDAGraph() {
+  reset();
+}
+
+} // namespace cuda
+} // namespace at
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <ATen/cuda/ATenCUDAGeneral.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAStream.h>
+
+#include <cuda_runtime_api.h>
+
+namespace at {
+namespace cuda {
+
+/*
+* CUDAGraph captures the work launched on the current stream between
+* capture_begin() and capture_end(), and replays it with replay(), at the
+* cost of a single launch.
+*
+* Replays run the captured kernels with the arguments they were captured
+* with, so the tensors they use keep their addresses across replays: inputs
+* are refreshed by copying into the tensors used during capture, and the
+* memory allocated during capture comes from a private pool of the caching
+* allocator that is kept until the graph is reset (see notifyCaptureBegin).
+* Graphs captured one after the other may share a pool by passing the pool()
+* of an earlier graph to capture_begin, as long as they are replayed in the
+* order they were captured.
+*
+* RNG kernels captured with the default CUDA generator of the capturing
+* device draw new numbers on each replay, see
+* Note [CUDA Graph-safe RNG states].
+*
+* Capture has to happen on a stream other than the default stream, and
+* requires CUDA 11.0 or newer.
+*/
+struct TORCH_CUDA_API CUDAGraph {
+  CUDAGraph();
+  ~CUDAGraph();
+
+  CUDAGraph(const CUDAGraph&) = delete;
+  CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+  // pool is the pool() of another graph to share its memory, or 0 for a new
+  // private pool
+  void capture_begin(c10::cuda::CUDACachingAllocator::MempoolId_t pool = 0);
+  void capture_end();
+  void replay();
+  // Frees the graph and releases its private pool
+  void reset();
+  c10::cuda::CUDACachingAllocator::MempoolId_t pool() const;
+
+ protected:
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  cudaGraph_t graph_ = NULL;
+  cudaGraphExec_t graph_exec_ = NULL;
+#endif
+  bool has_graph_exec_ = false;
+  bool capturing_ = false;
+
+  // Private pool of the allocations made during capture
+  c10::cuda::CUDACachingAllocator::MempoolId_t mempool_id_ = 0;
+
+  // Stream and device of the capture
+  c10::optional<CUDAStream> capture_stream_;
+  int capture_dev_ = -1;
+
+  // Seed and philox offset the captured RNG kernels read, set before each
+  // replay, and the offset increment of a replay
+  Tensor seed_extragraph_;
+  Tensor offset_extragraph_;
+  uint64_t wholegraph_increment_ = 0;
+};
+
+} // namespace cuda
+} // namespace at
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/Exceptions.h>
+
+#include <string>
+
+namespace at {
+namespace cuda {
+
+// Capture status of the current stream. Without CUDA graphs (CUDA < 11.0 or
+// ROCm) nothing is ever captured.
+enum class CaptureStatus : int {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  None = int(cudaStreamCaptureStatusNone),
+  Active = int(cudaStreamCaptureStatusActive),
+  Invalidated = int(cudaStreamCaptureStatusInvalidated)
+#else
+  None = 0
+#endif
+};
+
+inline CaptureStatus currentStreamCaptureStatus() {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  cudaStreamCaptureStatus status;
+  AT_CUDA_CHECK(cudaStreamIsCapturing(getCurrentCUDAStream(), &status));
+  return CaptureStatus(status);
+#else
+  return CaptureStatus::None;
+#endif
+}
+
+inline void assertNotCapturing(const std::string& attempt) {
+  TORCH_CHECK(currentStreamCaptureStatus() == CaptureStatus::None,
+              attempt,
+              " during CUDA graph capture is not allowed.");
+}
+
+namespace philox {
+
+// Seed and offset of a kernel's curand_init, see
+// Note [CUDA Graph-safe RNG states]
+__device__ __forceinline__ void unpack(at::PhiloxCudaState arg, uint64_t& seed, uint64_t& offset) {
+  if (arg.captured_) {
+    seed = static_cast<uint64_t>(*arg.seed_.ptr);
+    offset = static_cast<uint64_t>(*arg.offset_.ptr) + arg.offset_intragraph_;
+  } else {
+    seed = arg.seed_.val;
+    offset = arg.offset_.val;
+  }
+}
+
+} // namespace philox
+} // namespace cuda
+} // namespace at
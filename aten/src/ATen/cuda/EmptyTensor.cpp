@@ -0,0 +1,38 @@
+#include <ATen/cuda/EmptyTensor.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+
+namespace at {
+namespace detail {
+
+Tensor empty_cuda_fast(
+    IntArrayRef size,
+    ScalarType dtype,
+    c10::optional<DeviceIndex> device_index,
+    MemoryFormat memory_format) {
+  c10::cuda::OptionalCUDAGuard guard(device_index);
+  return empty_generic(
+      size,
+      at::cuda::getCUDADeviceAllocator(),
+      DispatchKey::CUDA,
+      dtype,
+      memory_format);
+}
+
+Tensor empty_strided_cuda_fast(
+    IntArrayRef size,
+    IntArrayRef stride,
+    ScalarType dtype,
+    c10::optional<DeviceIndex> device_index) {
+  c10::cuda::OptionalCUDAGuard guard(device_index);
+  return empty_strided_generic(
+      size,
+      stride,
+      at::cuda::getCUDADeviceAllocator(),
+      DispatchKey::CUDA,
+      dtype);
+}
+
+} // namespace detail
+} // namespace at
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ATen/EmptyTensor.h>
+
+namespace at {
+namespace detail {
+
+// CUDA versions of empty_cpu_fast and empty_strided_cpu_fast. The tensor is
+// allocated on `device_index`, or on the current device if it is not given,
+// e.g. in kernels which already hold a device guard.
+TORCH_CUDA_API Tensor empty_cuda_fast(
+    IntArrayRef size,
+    ScalarType dtype,
+    c10::optional<DeviceIndex> device_index = c10::nullopt,
+    MemoryFormat memory_format = MemoryFormat::Contiguous);
+
+TORCH_CUDA_API Tensor empty_strided_cuda_fast(
+    IntArrayRef size,
+    IntArrayRef stride,
+    ScalarType dtype,
+    c10::optional<DeviceIndex> device_index = c10::nullopt);
+
+} // namespace detail
+} // namespace at
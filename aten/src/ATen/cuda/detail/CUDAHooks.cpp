@@ -61,6 +61,16 @@ const Generator& CUDAHooks::getDefaultCUDAGenerator(DeviceIndex device_index) co
   return at::cuda::detail::getDefaultCUDAGenerator(device_index);
 }
 
+void CUDAHooks::setCUDAGeneratorState(const Generator& generator, const Generator& state) const {
+  Generator gen = generator;
+  auto* src = state.get<CUDAGeneratorImpl>();
+  auto* dst = gen.get<CUDAGeneratorImpl>();
+  std::lock_guard<std::mutex> lock(gen.mutex());
+  // set_current_seed resets the offset, so it goes first.
+  dst->set_current_seed(src->current_seed());
+  dst->set_philox_offset_per_thread(src->philox_offset_per_thread());
+}
+
 Device CUDAHooks::getDeviceFromPtr(void* data) const {
   return at::cuda::getDeviceFromPtr(data);
 }
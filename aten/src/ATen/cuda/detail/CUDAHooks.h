@@ -15,6 +15,7 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   Device getDeviceFromPtr(void* data) const override;
   bool isPinnedPtr(void* data) const override;
   const Generator& getDefaultCUDAGenerator(DeviceIndex device_index = -1) const override;
+  void setCUDAGeneratorState(const Generator& generator, const Generator& state) const override;
   bool hasCUDA() const override;
   bool hasMAGMA() const override;
   bool hasCuDNN() const override;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ATen/cuda/ATenCUDAGeneral.h>
+
+#include <string>
+
+namespace at { namespace native {
+
+// The cuDNN convolution algorithms selected by benchmark=True, which are
+// cached per process, can be saved and loaded to spare new processes the
+// benchmarking of the shapes seen before.
+//
+// The serialized cache holds the algorithm, math type and workspace size
+// selected for each convolution, keyed by its parameters and the name and
+// compute capability of its device. It is only loaded by the cuDNN version
+// that saved it.
+
+// Serializes the algorithms cached for the forward and backward
+// convolutions on all devices.
+TORCH_CUDA_API std::string serializeCudnnBenchmarkCache();
+
+// Adds the algorithms of a serialized cache to the cache of each device of
+// the same name and compute capability, without replacing the algorithms
+// already cached. Returns the number of entries added.
+TORCH_CUDA_API size_t loadCudnnBenchmarkCache(const std::string& data);
+
+}} // namespace at::native
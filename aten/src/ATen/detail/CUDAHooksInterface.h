@@ -81,6 +81,12 @@ struct CAFFE2_API CUDAHooksInterface {
     TORCH_CHECK(false, "Cannot get default CUDA generator without ATen_cuda library. ", CUDA_HELP);
   }
 
+  // Sets the state of the CUDA generator `generator` to the state of `state`,
+  // a clone of a CUDA generator.
+  virtual void setCUDAGeneratorState(const Generator& generator, const Generator& state) const {
+    TORCH_CHECK(false, "Cannot set the state of a CUDA generator without ATen_cuda library. ", CUDA_HELP);
+  }
+
   virtual Device getDeviceFromPtr(void* data) const {
     TORCH_CHECK(false, "Cannot get device of pointer on CUDA without ATen_cuda library. ", CUDA_HELP);
   }
@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
+#include <ATen/native/AdaptivePooling.h>
 #include <tuple>
 
 
@@ -9,14 +10,6 @@ namespace native {
 
 namespace {
 
-  inline int start_index(int a, int b, int c) {
-    return (int)std::floor((float)(a * c) / b);
-  }
-
-  inline int end_index(int a, int b, int c) {
-    return (int)std::ceil((float)((a + 1) * c) / b);
-  }
-
   template <typename scalar_t>
   static void adaptive_avg_pool2d_single_out_frame(
             scalar_t *input_p,
@@ -128,6 +121,14 @@ namespace {
     auto osizeH = output_size[0];
     auto osizeW = output_size[1];
 
+    if (input.ndimension() == 4 &&
+        input.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+        input.scalar_type() != at::kHalf) {
+      output.resize_({input.size(0), sizeD, osizeH, osizeW}, at::MemoryFormat::ChannelsLast);
+      adaptive_avg_pool2d_channels_last_kernel(kCPU, output, input, output_size);
+      return;
+    }
+
     /* resize output */
     if (input.ndimension() == 3 || input.size(-4) == 1)
     {
@@ -259,6 +260,15 @@ namespace {
     int osizeH = gradOutput_.size(-2);
     int osizeW = gradOutput_.size(-1);
 
+    if (input.ndimension() == 4 &&
+        input.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+        input.scalar_type() != at::kHalf) {
+      gradInput.resize_(input.sizes(), at::MemoryFormat::ChannelsLast);
+      gradInput.zero_();
+      adaptive_avg_pool2d_backward_channels_last_kernel(kCPU, gradInput, gradOutput_);
+      return gradInput;
+    }
+
     /* get contiguous gradOutput */
     auto gradOutput = gradOutput_.contiguous();
 
@@ -326,7 +336,8 @@ namespace {
       return at::mkldnn_adaptive_avg_pool2d(input, output_size);
     }
 
-    // TODO: fastpath for Channels_last should be explored later;
+    // Channels last inputs go to _adaptive_avg_pool2d, whose CPU kernel is
+    // vectorized over the channels.
     if (input.suggest_memory_format() == at::MemoryFormat::Contiguous && !input.is_quantized() && output_size[0] == 1 && output_size[1] == 1) {
       // in this case, adaptive pooling is just computing mean over hw
       // dimensions, which can be done more efficiently
@@ -354,11 +365,14 @@ namespace {
     const Tensor& gradOutput,
     const Tensor& input)
   {
-    auto gradInput = at::zeros_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    auto gradInput = at::zeros_like(input, input.suggest_memory_format());
     adaptive_avg_pool2d_backward_out_cpu_template(
       gradInput, gradOutput, input);
     return gradInput;
   }
 
+  DEFINE_DISPATCH(adaptive_avg_pool2d_channels_last_kernel);
+  DEFINE_DISPATCH(adaptive_avg_pool2d_backward_channels_last_kernel);
+
 } // at::native
 } // at
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+#include <cmath>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// The window of output index a out of b, over an input of size c.
+inline int start_index(int a, int b, int c) {
+  return (int)std::floor((float)(a * c) / b);
+}
+
+inline int end_index(int a, int b, int c) {
+  return (int)std::ceil((float)((a + 1) * c) / b);
+}
+
+} // namespace
+
+// Channels last adaptive_avg_pool2d kernels, vectorized over the channels.
+using adaptive_avg_pool2d_fn = void(*)(Tensor& output, const Tensor& input, IntArrayRef output_size);
+using adaptive_avg_pool2d_backward_fn = void(*)(Tensor& grad_input, const Tensor& grad_output);
+
+DECLARE_DISPATCH(adaptive_avg_pool2d_fn, adaptive_avg_pool2d_channels_last_kernel);
+DECLARE_DISPATCH(adaptive_avg_pool2d_backward_fn, adaptive_avg_pool2d_backward_channels_last_kernel);
+
+} // namespace native
+} // namespace at
@@ -305,6 +305,20 @@ template<> void lapackLuSolve<float>(char trans, int n, int nrhs, float *a, int
 // Below of the definitions of the functions operating on a batch that are going to be dispatched
 // in the main helper functions for the linear algebra operations
 
+#ifdef USE_LAPACK
+// The LAPACK calls on small matrices are dominated by their fixed overhead, so
+// the batches of small matrices are split across threads, each thread making
+// the calls for a contiguous range of matrices. Larger matrices are run one
+// after the other, leaving the parallelism to the LAPACK library itself.
+static int64_t lapack_batch_grain_size(int64_t batch_size, int64_t n) {
+  constexpr int64_t max_parallel_matrix_size = 64;
+  if (n > max_parallel_matrix_size) {
+    return batch_size;
+  }
+  return std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, n * n * n));
+}
+#endif
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ solve ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 template<typename scalar_t>
@@ -320,19 +334,16 @@ static void apply_solve(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
   auto n = A.size(-2);
   auto nrhs = b.size(-1);
 
-  auto ipiv = at::empty({n}, b.options().dtype(kInt));
-  auto ipiv_data = ipiv.data_ptr<int>();
-
-  int info;
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
-    scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
-    lapackSolve<scalar_t>(n, nrhs, A_working_ptr, n, ipiv_data, b_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  at::parallel_for(0, batch_size, lapack_batch_grain_size(batch_size, n), [&](int64_t start, int64_t end) {
+    std::vector<int> ipiv(n);
+    int info;
+    for (int64_t i = start; i < end; i++) {
+      scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
+      scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
+      lapackSolve<scalar_t>(n, nrhs, A_working_ptr, n, ipiv.data(), b_working_ptr, n, &info);
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -383,36 +394,34 @@ static void apply_inverse(Tensor& self, std::vector<int64_t>& infos) {
   auto batch_size = batchCount(self);
   auto n = self.size(-2);
 
-  auto ipiv = at::empty({n}, self.options().dtype(kInt));
-  auto ipiv_data = ipiv.data_ptr<int>();
-
-  int info;
   // Run once, first to get the optimum work size
   // Since we deal with batches of matrices with the same dimensions, doing this outside
   // the loop saves (batch_size - 1) workspace queries which would provide the same result
-  // and (batch_size - 1) calls to allocate and deallocate workspace using at::empty()
+  // and (batch_size - 1) allocations of the workspace
   int lwork = -1;
+  int query_info;
   scalar_t wkopt;
-  lapackGetri<scalar_t>(n, self_data, n, ipiv_data, &wkopt, lwork, &info);
-  lwork = static_cast<int>(real_impl<scalar_t, value_t>(wkopt));
-  Tensor work = at::empty({lwork}, self.options());
-  auto work_data = work.data_ptr<scalar_t>();
-
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
-    lapackLu<scalar_t>(n, n, self_working_ptr, n, ipiv_data, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
-    }
+  std::vector<int> ipiv_query(n);
+  lapackGetri<scalar_t>(n, self_data, n, ipiv_query.data(), &wkopt, lwork, &query_info);
+  lwork = std::max<int>(1, static_cast<int>(real_impl<scalar_t, value_t>(wkopt)));
+
+  at::parallel_for(0, batch_size, lapack_batch_grain_size(batch_size, n), [&](int64_t start, int64_t end) {
+    std::vector<int> ipiv(n);
+    std::vector<scalar_t> work(lwork);
+    int info;
+    for (int64_t i = start; i < end; i++) {
+      scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
+      lapackLu<scalar_t>(n, n, self_working_ptr, n, ipiv.data(), &info);
+      infos[i] = info;
+      if (info != 0) {
+        continue;
+      }
 
-    // now compute the actual inverse
-    lapackGetri<scalar_t>(n, self_working_ptr, n, ipiv_data, work_data, lwork, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+      // now compute the actual inverse
+      lapackGetri<scalar_t>(n, self_working_ptr, n, ipiv.data(), work.data(), lwork, &info);
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -463,16 +472,15 @@ static void apply_cholesky_solve(Tensor& b, Tensor& A, bool upper, std::vector<i
   auto n = A.size(-2);
   auto nrhs = b.size(-1);
 
-  int info;
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
-    scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
-    lapackCholeskySolve<scalar_t>(uplo, n, nrhs, A_working_ptr, n, b_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  at::parallel_for(0, batch_size, lapack_batch_grain_size(batch_size, n), [&](int64_t start, int64_t end) {
+    int info;
+    for (int64_t i = start; i < end; i++) {
+      scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
+      scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
+      lapackCholeskySolve<scalar_t>(uplo, n, nrhs, A_working_ptr, n, b_working_ptr, n, &info);
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -523,15 +531,14 @@ static void apply_cholesky(Tensor& self, bool upper, std::vector<int64_t>& infos
   auto batch_size = batchCount(self);
   auto n = self.size(-2);
 
-  int info;
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
-    lapackCholesky<scalar_t>(uplo, n, self_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  at::parallel_for(0, batch_size, lapack_batch_grain_size(batch_size, n), [&](int64_t start, int64_t end) {
+    int info;
+    for (int64_t i = start; i < end; i++) {
+      scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
+      lapackCholesky<scalar_t>(uplo, n, self_working_ptr, n, &info);
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -587,12 +594,14 @@ static void apply_lu(Tensor& self, Tensor& pivots, Tensor& infos) {
   auto m = self.size(-2);
   auto n = self.size(-1);
 
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
-    int* pivots_working_ptr = &pivots_data[i * pivots_matrix_stride];
-    int* infos_working_ptr = &infos_data[i];
-    lapackLu<scalar_t>(m, n, self_working_ptr, m, pivots_working_ptr, infos_working_ptr);
-  }
+  at::parallel_for(0, batch_size, lapack_batch_grain_size(batch_size, std::max(m, n)), [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; i++) {
+      scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
+      int* pivots_working_ptr = &pivots_data[i * pivots_matrix_stride];
+      int* infos_working_ptr = &infos_data[i];
+      lapackLu<scalar_t>(m, n, self_working_ptr, m, pivots_working_ptr, infos_working_ptr);
+    }
+  });
 #endif
 }
 
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <ATen/ATen.h>
 #include <ATen/Config.h>
+#include <ATen/native/CPUBlas.h>
 
 #if AT_BUILD_WITH_BLAS()
 extern "C" void dscal_(int *n, double *a, double *x, int *incx);
@@ -12,6 +13,8 @@ extern "C" void sgemv_(char *trans, int *m, int *n, float *alpha, float *a, int
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(gemm_stub);
+
 namespace blas_impl {
 
 template <typename scalar_t>
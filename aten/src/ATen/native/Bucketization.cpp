@@ -2,6 +2,8 @@
 #include <ATen/Parallel.h>
 #include <ATen/native/BucketizationUtils.h>
 
+#include <algorithm>
+
 /* Implement a TF like searchsorted and a bucketize function running on cpu
  *
  * - torch.searchsorted(sorted_sequence, values, right=False, out_int32=False)
@@ -27,24 +29,21 @@ namespace {
 // minimal size for searchsorted_cpu_contiguous to run parallel (multithread)
 constexpr int64_t SEARCHSORTED_GRAIN_SIZE = 200;
 
-// customized lower_bound func to ensure the low bound of 'nan', 'inf' etc. be the end of boundary
-// std::lower_bound can not be used here since its customized comparator need strict weak ordering
-template<typename input_t>
-const input_t* cus_lower_bound(const input_t* start, const input_t* end, input_t val) {
-  while (start < end) {
-    const input_t* mid = start + ((end - start) >> 1);
-    if (!(*mid >= val)) {
-      start = mid + 1;
-    }
-    else {
-      end = mid;
-    }
-  }
-  return start;
+// number of searches run in lockstep by searchsorted_cpu_contiguous
+constexpr int64_t SEARCHSORTED_BATCH_SIZE = 8;
+
+// true if the searched position is after 'bd'. The lower bound test is written as !(bd >= val) so that the low bound
+// of 'nan', 'inf' etc. is the end of boundary, since std::lower_bound's comparator needs strict weak ordering
+template<typename input_t, bool right>
+inline bool search_goes_right(input_t bd, input_t val) {
+  return right ? !(val < bd) : !(bd >= val);
 }
 
-template<typename input_t, typename output_t>
-void searchsorted_cpu_contiguous(Tensor& result, const Tensor& input, const Tensor& boundaries, const bool& right) {
+// Branchless binary search of SEARCHSORTED_BATCH_SIZE values at a time: every search of a batch runs the same
+// number of steps over sequences of the same length, so the steps have no data dependent branches and the loads
+// of the searches overlap instead of each waiting for the previous one.
+template<typename input_t, typename output_t, bool right>
+void searchsorted_cpu_contiguous(Tensor& result, const Tensor& input, const Tensor& boundaries) {
   int64_t numel_in = input.numel();
   bool is_scalar_input = input.dim() == 0 && numel_in == 1;
   // inner most dim size of input and boundaries
@@ -55,19 +54,36 @@ void searchsorted_cpu_contiguous(Tensor& result, const Tensor& input, const Tens
   const input_t *data_bd = boundaries.data_ptr<input_t>();
   output_t *data_out = result.data_ptr<output_t>();
 
+  if (idim_bd == 0) {
+    std::fill(data_out, data_out + numel_in, output_t(0));
+    return;
+  }
+
   bool is_1d_boundaries = boundaries.dim() == 1;
   at::parallel_for(0, numel_in, SEARCHSORTED_GRAIN_SIZE, [&](int64_t start, int64_t end) {
-    for (int64_t i = start; i < end; ++i) {
-      // If boundaries tensor is 1d, we always search the entire boundary tensor
-      int64_t start_bd = is_1d_boundaries ? 0 : i / idim_in * idim_bd;
-      const input_t *data_bd_start = &data_bd[start_bd];
-
-      int64_t pos = !right ?
-        cus_lower_bound(data_bd_start, data_bd_start + idim_bd, data_in[i]) - data_bd_start :
-        std::upper_bound(data_bd_start, data_bd_start + idim_bd, data_in[i]) - data_bd_start;
-
-      // type conversion might happen here
-      data_out[i] = pos;
+    const input_t *data_bd_start[SEARCHSORTED_BATCH_SIZE];
+    int64_t pos[SEARCHSORTED_BATCH_SIZE];
+    for (int64_t i = start; i < end; i += SEARCHSORTED_BATCH_SIZE) {
+      const int64_t batch_size = std::min(SEARCHSORTED_BATCH_SIZE, end - i);
+      const input_t *val = &data_in[i];
+      for (int64_t k = 0; k < batch_size; ++k) {
+        // If boundaries tensor is 1d, we always search the entire boundary tensor
+        data_bd_start[k] = is_1d_boundaries ? data_bd : &data_bd[(i + k) / idim_in * idim_bd];
+        pos[k] = 0;
+      }
+
+      // the searched position of each value stays in [pos, pos + len]
+      for (int64_t len = idim_bd; len > 1; len -= len >> 1) {
+        const int64_t half = len >> 1;
+        for (int64_t k = 0; k < batch_size; ++k) {
+          pos[k] += search_goes_right<input_t, right>(data_bd_start[k][pos[k] + half], val[k]) ? half : 0;
+        }
+      }
+
+      for (int64_t k = 0; k < batch_size; ++k) {
+        // type conversion might happen here
+        data_out[i + k] = pos[k] + search_goes_right<input_t, right>(data_bd_start[k][pos[k]], val[k]);
+      }
     }
   });
 }
@@ -75,12 +91,20 @@ void searchsorted_cpu_contiguous(Tensor& result, const Tensor& input, const Tens
 void dispatch(Tensor& result, const Tensor& input, const Tensor& boundaries, bool out_int32, bool right) {
   if (!out_int32) {
     AT_DISPATCH_ALL_TYPES(input.scalar_type(), "searchsorted_out_cpu", [&] {
-      searchsorted_cpu_contiguous<scalar_t, int64_t>(result, input, boundaries, right);
+      if (right) {
+        searchsorted_cpu_contiguous<scalar_t, int64_t, true>(result, input, boundaries);
+      } else {
+        searchsorted_cpu_contiguous<scalar_t, int64_t, false>(result, input, boundaries);
+      }
     });
   }
   else {
     AT_DISPATCH_ALL_TYPES(input.scalar_type(), "searchsorted_out_cpu", [&] {
-      searchsorted_cpu_contiguous<scalar_t, int>(result, input, boundaries, right);
+      if (right) {
+        searchsorted_cpu_contiguous<scalar_t, int, true>(result, input, boundaries);
+      } else {
+        searchsorted_cpu_contiguous<scalar_t, int, false>(result, input, boundaries);
+      }
     });
   }
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+// Column-major gemm with the semantics of BLAS:
+//   C = alpha * op(A) * op(B) + beta * C
+// where op(X) is X or its transpose according to transa and transb ('n' or
+// 't'), C is m x n, op(A) is m x k and op(B) is k x n. Used for float and
+// double in builds without BLAS.
+using gemm_fn = void (*)(
+    ScalarType type,
+    char transa,
+    char transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    Scalar alpha,
+    const void* a,
+    int64_t lda,
+    const void* b,
+    int64_t ldb,
+    Scalar beta,
+    void* c,
+    int64_t ldc);
+
+DECLARE_DISPATCH(gemm_fn, gemm_stub);
+
+} // namespace native
+} // namespace at
@@ -1,10 +1,12 @@
 #include <limits>
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/native/cpu/ConvolutionKernel.h>
 #include <ATen/native/cpu/DepthwiseConvKernel.h>
 #include <ATen/native/utils/ParamUtils.h>
 #include <ATen/native/ConvUtils.h>
 #include <ATen/native/xnnpack/Engine.h>
+#include <ATen/core/grad_mode.h>
 
 #include <ATen/Config.h>
 #include <c10/macros/Macros.h>
@@ -22,6 +24,17 @@ constexpr int MIOPEN_DIM_MAX = 5;
 namespace at { namespace native {
 
 DEFINE_DISPATCH(convolution_depthwise3x3_winograd_stub);
+DEFINE_DISPATCH(convolution_winograd4x3_stub);
+DEFINE_DISPATCH(convolution_channels_last_stub);
+DEFINE_DISPATCH(convolution_transpose_channels_last_stub);
+
+// Algorithms for float convolutions of CPU tensors that neither MKLDNN nor
+// NNPACK take, see ConvParams::cpu_conv_algorithm().
+enum class CPUConvAlgorithm {
+  Default, // thnn_conv2d, im2col followed by gemm
+  Winograd4x3,
+  DirectChannelsLast,
+};
 
 struct ConvParams {
   std::vector<int64_t> stride;
@@ -43,17 +56,28 @@ struct ConvParams {
   bool is_stride_nonpos() const;
   void view1d_as_2d();
   bool use_cpu_depthwise3x3_winograd(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  CPUConvAlgorithm cpu_conv_algorithm(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
   bool needs_64bit_indexing_no_split(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_cudnn(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_cudnn_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_miopen(const at::Tensor& input, const at::Tensor& weight, bool bias_defined) const;
   bool use_mkldnn(const at::Tensor& input) const;
+  bool use_mkldnn_transposed(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_cpu_conv_transpose_channels_last(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
   bool use_nnpack(const at::Tensor& input) const;
   bool use_xnnpack(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
   bool use_vulkan(const at::Tensor& input, const at::Tensor& weight) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
+// Whether autograd records the convolution. The kernels without derivatives
+// are only used when it does not.
+static bool conv_requires_grad(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) {
+  return GradMode::is_enabled() &&
+      (input.requires_grad() || weight.requires_grad() ||
+       (bias.defined() && bias.requires_grad()));
+}
+
 std::ostream& operator<<(std::ostream & out, const ConvParams& params) {
   out << "ConvParams {"
       << "  stride = " << IntArrayRef{params.stride}
@@ -163,6 +187,77 @@ auto ConvParams::use_cpu_depthwise3x3_winograd(
 #endif
 }
 
+// Picks the cheapest of im2col + gemm, Winograd F(4x4, 3x3) and direct
+// convolution for a float convolution of CPU tensors, from rough estimates of
+// their cost in flops. Winograd does a quarter of the multiplications of the
+// others for 3x3 filters, but transforms every tile of input and output and
+// wastes part of the last tiles of a row or column. im2col unfolds the input
+// into a temporary buffer kernel size times larger than it, which is written
+// and read again from memory. The direct kernel needs no buffer but uses the
+// vector units less efficiently than gemm. These kernels have no derivatives,
+// so they are only used when no gradient is required.
+auto ConvParams::cpu_conv_algorithm(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) const -> CPUConvAlgorithm {
+  if (input.device().type() != c10::DeviceType::CPU ||
+      weight.device().type() != c10::DeviceType::CPU ||
+      (bias.defined() && bias.device().type() != c10::DeviceType::CPU) ||
+      input.scalar_type() != at::kFloat ||
+      weight.scalar_type() != at::kFloat ||
+      (bias.defined() && bias.scalar_type() != at::kFloat) ||
+      input.ndimension() != 4 ||
+      weight.ndimension() != 4 ||
+      groups != 1 ||
+      transposed ||
+      use_mkldnn(input) ||
+      use_nnpack(input) ||
+      conv_requires_grad(input, weight, bias)) {
+    return CPUConvAlgorithm::Default;
+  }
+  // Flops of arithmetic a byte of memory traffic costs as much as
+  constexpr double kFlopsPerByte = 16;
+  // Efficiency of the direct kernel relative to gemm
+  constexpr double kDirectEfficiency = 0.6;
+  // Flops of the transform of a tile of input or output of Winograd
+  constexpr double kInputTransformFlops = 12 * 12;
+  constexpr double kOutputTransformFlops = 12 * 10;
+
+  const double in_channels = input.size(1);
+  const double out_channels = weight.size(0);
+  const int64_t kernel_rows = weight.size(2);
+  const int64_t kernel_cols = weight.size(3);
+  const std::vector<int64_t> output_size = conv_output_size(input.sizes(), weight.sizes(), padding, stride, dilation);
+  const double out_pixels = output_size[2] * output_size[3];
+  const double patch = in_channels * kernel_rows * kernel_cols;
+
+  // Costs per image
+  const double gemm_flops = 2 * out_channels * patch * out_pixels;
+  const bool needs_im2col = kernel_rows != 1 || kernel_cols != 1 || is_strided() || is_padded();
+  const double im2col_cost = gemm_flops +
+      (needs_im2col ? kFlopsPerByte * 2 * patch * out_pixels * sizeof(float) : 0);
+
+  const bool channels_last = input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+  double best_cost = im2col_cost;
+  CPUConvAlgorithm best = CPUConvAlgorithm::Default;
+  if (channels_last) {
+    const double direct_cost = gemm_flops / kDirectEfficiency;
+    if (direct_cost < best_cost) {
+      best_cost = direct_cost;
+      best = CPUConvAlgorithm::DirectChannelsLast;
+    }
+  } else if (kernel_rows == 3 && kernel_cols == 3 && !is_strided() && !is_dilated()) {
+    const double tiles = ((output_size[2] + 3) / 4) * ((output_size[3] + 3) / 4);
+    const double winograd_cost = 2 * out_channels * in_channels * 36 * tiles +
+        in_channels * tiles * kInputTransformFlops +
+        out_channels * tiles * kOutputTransformFlops;
+    if (winograd_cost < best_cost) {
+      best = CPUConvAlgorithm::Winograd4x3;
+    }
+  }
+  return best;
+}
+
 auto ConvParams::needs_64bit_indexing_no_split(const at::Tensor& input, const at::Tensor& weight) const -> bool {
   constexpr int64_t int_max = std::numeric_limits<int>::max();
   int64_t numel_input = input.numel();
@@ -240,6 +335,60 @@ auto ConvParams::use_mkldnn(const at::Tensor& input) const -> bool {
   return false;
 }
 
+// oneDNN deconvolution for transposed convolutions of float CPU tensors. The
+// output padding is taken off the padding at the end of each dimension, which
+// must not become negative.
+auto ConvParams::use_mkldnn_transposed(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) const -> bool {
+#if AT_MKLDNN_ENABLED()
+  if (!at::globalContext().userEnabledMkldnn() || !transposed || groups != 1) {
+    return false;
+  }
+  for (size_t i = 0; i < output_padding.size(); ++i) {
+    if (output_padding[i] > padding[i]) {
+      return false;
+    }
+  }
+  return (input.is_mkldnn() ||
+          (input.options().backend() == at::Backend::CPU &&
+           input.scalar_type() == kFloat)) &&
+         weight.options().backend() == at::Backend::CPU &&
+         weight.scalar_type() == kFloat &&
+         (!bias.defined() ||
+            (bias.options().backend() == at::Backend::CPU &&
+             bias.scalar_type() == kFloat)) &&
+         (input.ndimension() == 4 || input.ndimension() == 5) &&
+         !conv_requires_grad(input, weight, bias);
+#endif
+  return false;
+}
+
+// Direct kernel for transposed 2d convolutions of float CPU tensors that
+// MKLDNN does not take, mostly the upsampling ones of stride 2, whose gemm
+// and col2im go through a column buffer kernel size times larger than the
+// input. Contiguous inputs are converted to channels last for it.
+auto ConvParams::use_cpu_conv_transpose_channels_last(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) const -> bool {
+  return transposed &&
+         groups == 1 &&
+         input.device().type() == c10::DeviceType::CPU &&
+         !input.is_mkldnn() &&
+         input.scalar_type() == at::kFloat &&
+         input.ndimension() == 4 &&
+         weight.device().type() == c10::DeviceType::CPU &&
+         weight.scalar_type() == at::kFloat &&
+         (!bias.defined() ||
+            ((bias.device().type() == c10::DeviceType::CPU) &&
+             (bias.scalar_type() == at::kFloat))) &&
+         (is_strided() || input.suggest_memory_format() == at::MemoryFormat::ChannelsLast) &&
+         !use_mkldnn_transposed(input, weight, bias) &&
+         !conv_requires_grad(input, weight, bias);
+}
+
 auto ConvParams::use_nnpack(const at::Tensor& input) const -> bool {
 #if AT_NNPACK_ENABLED()
   return at::_nnpack_available() &&
@@ -667,6 +816,8 @@ at::Tensor _convolution(
   at::MemoryFormat cudnn_memory_format = cudnn_conv_use_channels_last(input, weight) ?
       at::MemoryFormat::ChannelsLast : at::MemoryFormat::Contiguous;
 
+  const CPUConvAlgorithm cpu_algorithm = params.cpu_conv_algorithm(input, weight, bias);
+
   Tensor output;
   if (params.is_depthwise(input, weight)) {
       /* output.resize_(output_size(input, weight)); */
@@ -694,7 +845,10 @@ at::Tensor _convolution(
             params.padding, params.stride, params.dilation, params.groups);
 #endif
       } else {
-          output = at::thnn_conv_depthwise2d(input.contiguous(), weight, kernel_size, bias, stride, padding, dilation);
+          // thnn_conv_depthwise2d has channels-last kernels, so channels-last
+          // inputs are not converted to NCHW.
+          output = at::thnn_conv_depthwise2d(
+              input.contiguous(input.suggest_memory_format()), weight, kernel_size, bias, stride, padding, dilation);
       }
   } else if (params.use_cudnn(input, weight)) {
     TORCH_CHECK(input.options().type_equal(weight.options()),
@@ -736,6 +890,25 @@ at::Tensor _convolution(
           input.contiguous(), weight, bias,
           params.padding, params.stride, params.dilation, params.groups, params.benchmark, params.deterministic);
     }
+  } else if (params.use_mkldnn_transposed(input, weight, bias)) {
+    TORCH_CHECK(input.options().type_equal(weight.options()) || input_is_mkldnn,
+             "Input type (", input.toString(), ") and weight type (", weight.toString(),
+             ") should be the same");
+    output = at::mkldnn_convolution_transpose(
+        input_is_mkldnn ? input : input.contiguous(),
+        weight,
+        bias.defined() ? bias.contiguous() : bias,
+        params.padding, params.output_padding, params.stride, params.dilation, params.groups);
+  } else if (params.use_cpu_conv_transpose_channels_last(input, weight, bias)) {
+    output = convolution_transpose_channels_last_stub(
+        input.device().type(),
+        input.contiguous(at::MemoryFormat::ChannelsLast),
+        weight.contiguous(),
+        bias.defined() ? bias.contiguous() : bias,
+        params.stride,
+        params.padding,
+        params.output_padding,
+        params.dilation).contiguous(input.suggest_memory_format());
   } else if (params.use_mkldnn(input)) {
 #if AT_MKLDNN_ENABLED()
     TORCH_CHECK(input.options().type_equal(weight.options()),
@@ -773,6 +946,22 @@ at::Tensor _convolution(
         params.stride,
         params.padding,
         params.groups);
+  } else if (cpu_algorithm == CPUConvAlgorithm::Winograd4x3) {
+    output = convolution_winograd4x3_stub(
+        input.device().type(),
+        input.contiguous(),
+        weight.contiguous(),
+        bias.defined() ? bias.contiguous() : bias,
+        params.padding);
+  } else if (cpu_algorithm == CPUConvAlgorithm::DirectChannelsLast) {
+    output = convolution_channels_last_stub(
+        input.device().type(),
+        input.contiguous(at::MemoryFormat::ChannelsLast),
+        weight.contiguous(),
+        bias.defined() ? bias.contiguous() : bias,
+        params.stride,
+        params.padding,
+        params.dilation);
   } else if (
         !params.transposed && (input.ndimension() == 5) &&
         (input.device().type() == c10::DeviceType::CPU) &&
@@ -793,8 +982,13 @@ at::Tensor _convolution(
 #endif
   } else if (input.device().type() == c10::DeviceType::CPU || input.device().type() == c10::DeviceType::CUDA) {
     if (params.groups == 1) {
+      // thnn_conv2d convolves channels last CPU inputs without copying them to contiguous.
+      const bool thnn_conv2d_channels_last = input.device().type() == c10::DeviceType::CPU &&
+          input.dim() == 4 && !params.transposed && !params.is_dilated() && !params.use_nnpack(input) &&
+          input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
       output = at::_convolution_nogroup(
-          input.contiguous(), weight, bias, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
+          input.contiguous(thnn_conv2d_channels_last ? at::MemoryFormat::ChannelsLast : at::MemoryFormat::Contiguous),
+          weight, bias, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
     } else {
       std::vector<Tensor> outputs(params.groups);
       input = input.contiguous();
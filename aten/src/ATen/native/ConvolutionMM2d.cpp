@@ -124,7 +124,26 @@ static inline void slow_conv2d_shape_check(
   }
 }
 
-static Tensor view_weight_2d(const Tensor& weight_) {
+// A channels last input is convolved in channels last, without a copy to
+// contiguous: its patches are unfolded as rows of kH * kW * n_input_plane
+// elements (see Unfold2d.h), which multiply a weight viewed in the same
+// order, and the output is produced in channels last.
+static inline bool slow_conv2d_use_channels_last(
+    const Tensor& input,
+    const Tensor& weight) {
+  return input.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+      weight.dim() == 4;
+}
+
+static Tensor view_weight_2d(
+    const Tensor& weight_,
+    bool is_channels_last = false) {
+  if (is_channels_last) {
+    // [n_output_plane, kH * kW * n_input_plane]
+    return weight_.permute({0, 2, 3, 1})
+        .contiguous()
+        .view({weight_.size(0), -1});
+  }
   Tensor weight = weight_.contiguous();
   if (weight.dim() == 4) {
     const int64_t s1 = weight.size(0);
@@ -135,6 +154,12 @@ static Tensor view_weight_2d(const Tensor& weight_) {
   }
 }
 
+// Views the (n_planes, height, width) frame of a channels last tensor as a
+// [height * width, n_planes] matrix.
+static Tensor view_channels_last_frame_2d(const Tensor& frame) {
+  return frame.permute({1, 2, 0}).view({frame.size(1) * frame.size(2), frame.size(0)});
+}
+
 static void slow_conv2d_update_output_frame(
     Tensor& input,
     Tensor& output,
@@ -152,7 +177,8 @@ static void slow_conv2d_update_output_frame(
     int64_t input_width,
     int64_t n_output_plane,
     int64_t output_height,
-    int64_t output_width) {
+    int64_t output_width,
+    bool is_channels_last) {
   unfolded2d_copy_stub(
       kCPU,
       finput,
@@ -167,7 +193,19 @@ static void slow_conv2d_update_output_frame(
       input_height,
       input_width,
       output_height,
-      output_width);
+      output_width,
+      is_channels_last);
+
+  if (is_channels_last) {
+    auto output2d = view_channels_last_frame_2d(output);
+    if (bias.defined()) {
+      output2d.copy_(bias.unsqueeze(0).expand_as(output2d));
+      output2d.addmm_(finput, weight.t(), 1, 1);
+    } else {
+      at::mm_out(output2d, finput, weight.t());
+    }
+    return;
+  }
 
   auto output2d =
       output.reshape({n_output_plane, output_height * output_width});
@@ -192,10 +230,17 @@ void slow_conv2d_backward_update_grad_input_frame(
     int64_t stride_height,
     int64_t stride_width,
     int64_t pad_height,
-    int64_t pad_width) {
-  auto grad_output_2d = grad_output.reshape(
-      {grad_output.size(0), grad_output.size(1) * grad_output.size(2)});
-  fgrad_input.addmm_(weight, grad_output_2d, 0, 1);
+    int64_t pad_width,
+    bool is_channels_last) {
+  if (is_channels_last) {
+    // weight is [n_output_plane, kH * kW * n_input_plane]
+    at::mm_out(fgrad_input, view_channels_last_frame_2d(grad_output), weight);
+  } else {
+    // weight is [n_input_plane * kH * kW, n_output_plane]
+    auto grad_output_2d = grad_output.reshape(
+        {grad_output.size(0), grad_output.size(1) * grad_output.size(2)});
+    fgrad_input.addmm_(weight, grad_output_2d, 0, 1);
+  }
 
   grad_input.zero_();
   unfolded2d_acc_stub(
@@ -212,7 +257,8 @@ void slow_conv2d_backward_update_grad_input_frame(
       grad_input.size(1),
       grad_input.size(2),
       grad_output.size(1),
-      grad_output.size(2));
+      grad_output.size(2),
+      is_channels_last);
 }
 
 void slow_conv2d_backward_out_cpu_template(
@@ -232,11 +278,12 @@ void slow_conv2d_backward_out_cpu_template(
   const int64_t stride_height = stride[0];
   const int64_t stride_width = stride[1];
 
-  const Tensor weight = view_weight_2d(weight_);
+  const bool is_channels_last = slow_conv2d_use_channels_last(input_, weight_);
+  const Tensor weight = view_weight_2d(weight_, is_channels_last);
   slow_conv2d_shape_check(
       input_,
       grad_output_,
-      weight,
+      weight_,
       Tensor(),
       kernel_height,
       kernel_width,
@@ -246,12 +293,15 @@ void slow_conv2d_backward_out_cpu_template(
       pad_width,
       false);
 
-  const Tensor input = input_.contiguous();
-  const Tensor grad_output = grad_output_.contiguous();
-  grad_input.resize_as_(input);
+  const auto memory_format = is_channels_last
+      ? at::MemoryFormat::ChannelsLast
+      : at::MemoryFormat::Contiguous;
+  const Tensor input = input_.contiguous(memory_format);
+  const Tensor grad_output = grad_output_.contiguous(memory_format);
+  grad_input.resize_(input.sizes(), memory_format);
   fgrad_input.resize_as_(finput);
   fgrad_input.zero_();
-  const Tensor tweight = weight.transpose(0, 1);
+  const Tensor tweight = is_channels_last ? weight : weight.transpose(0, 1);
   const int64_t batch_size = input.size(0);
   at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
     NoGradGuard no_grad;
@@ -270,7 +320,8 @@ void slow_conv2d_backward_out_cpu_template(
           stride_height,
           stride_width,
           pad_height,
-          pad_width);
+          pad_width,
+          is_channels_last);
     }
   });
 }
@@ -279,7 +330,20 @@ void slow_conv2d_backward_parameters_frame(
     Tensor& grad_weight,
     Tensor& grad_bias,
     Tensor& grad_output,
-    const Tensor& finput) {
+    const Tensor& finput,
+    bool is_channels_last) {
+  if (is_channels_last) {
+    // [output_height * output_width, n_output_plane]
+    auto grad_output_2d = view_channels_last_frame_2d(grad_output);
+    if (grad_weight.defined()) {
+      grad_weight.addmm_(grad_output_2d.t(), finput);
+    }
+    if (grad_bias.defined()) {
+      grad_bias.add_(grad_output_2d.sum(0));
+    }
+    return;
+  }
+
   auto grad_output_2d = grad_output.view(
       {grad_output.size(0), grad_output.size(1) * grad_output.size(2)});
   if (grad_weight.defined()) {
@@ -316,7 +380,8 @@ static void slow_conv2d_backward_parameters_out_cpu_template(
     Tensor fgrad_input,
     IntArrayRef kernel_size,
     IntArrayRef stride,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    bool is_channels_last) {
   CheckedFrom c = "slow_conv2d_backward_parameters_cpu";
   auto grad_weight_arg = TensorArg(grad_weight, "grad_weight_arg", 0);
   auto grad_bias_arg = TensorArg(grad_bias, "grad_bias_arg", 0);
@@ -330,8 +395,14 @@ static void slow_conv2d_backward_parameters_out_cpu_template(
 
   Tensor grad_weight_2d;
   if (grad_weight.defined()) {
-    checkContiguous(c, grad_weight_arg);
-    grad_weight_2d = view_weight_2d(grad_weight);
+    if (is_channels_last) {
+      // grad_weight is channels last, so its [n_output_plane, kH, kW,
+      // n_input_plane] permutation is contiguous, and the 2d view updates it.
+      grad_weight_2d = grad_weight.permute({0, 2, 3, 1}).view({grad_weight.size(0), -1});
+    } else {
+      checkContiguous(c, grad_weight_arg);
+      grad_weight_2d = view_weight_2d(grad_weight);
+    }
   }
 
   if (grad_bias.defined()) {
@@ -341,7 +412,7 @@ static void slow_conv2d_backward_parameters_out_cpu_template(
   slow_conv2d_shape_check(
       input_,
       grad_output_,
-      grad_weight_2d,
+      grad_weight,
       grad_bias,
       kernel_height,
       kernel_width,
@@ -351,8 +422,11 @@ static void slow_conv2d_backward_parameters_out_cpu_template(
       pad_width,
       true);
 
-  auto input = input_.contiguous();
-  auto grad_output = grad_output_.contiguous();
+  const auto memory_format = is_channels_last
+      ? at::MemoryFormat::ChannelsLast
+      : at::MemoryFormat::Contiguous;
+  auto input = input_.contiguous(memory_format);
+  auto grad_output = grad_output_.contiguous(memory_format);
 
   const int64_t batch_size = input.size(0);
   for (int64_t t = 0; t < batch_size; t++) {
@@ -363,7 +437,7 @@ static void slow_conv2d_backward_parameters_out_cpu_template(
     }
 
     slow_conv2d_backward_parameters_frame(
-        grad_weight_2d, grad_bias, grad_output_t, finput_t);
+        grad_weight_2d, grad_bias, grad_output_t, finput_t, is_channels_last);
   }
 }
 
@@ -386,12 +460,13 @@ std::tuple<Tensor&, Tensor&, Tensor&> slow_conv2d_forward_out_cpu(
   const int64_t stride_height = stride[0];
   const int64_t stride_width = stride[1];
 
-  const Tensor weight_2d = view_weight_2d(weight_);
+  const bool is_channels_last = slow_conv2d_use_channels_last(self, weight_);
+  const Tensor weight_2d = view_weight_2d(weight_, is_channels_last);
 
   slow_conv2d_shape_check(
       self,
       Tensor(),
-      weight_2d,
+      weight_,
       bias,
       kernel_height,
       kernel_width,
@@ -401,7 +476,10 @@ std::tuple<Tensor&, Tensor&, Tensor&> slow_conv2d_forward_out_cpu(
       pad_width,
       false);
 
-  const Tensor input = self.contiguous();
+  const auto memory_format = is_channels_last
+      ? at::MemoryFormat::ChannelsLast
+      : at::MemoryFormat::Contiguous;
+  const Tensor input = self.contiguous(memory_format);
   const int64_t ndim = input.dim();
   const int64_t dim_planes = 1;
   const int64_t dim_height = 2;
@@ -418,10 +496,16 @@ std::tuple<Tensor&, Tensor&, Tensor&> slow_conv2d_forward_out_cpu(
 
   const int64_t batch_size = input.size(0);
 
-  finput.resize_({batch_size,
-                  n_input_plane * kernel_height * kernel_width,
-                  output_height * output_width});
-  output.resize_({batch_size, n_output_plane, output_height, output_width});
+  if (is_channels_last) {
+    finput.resize_({batch_size,
+                    output_height * output_width,
+                    kernel_height * kernel_width * n_input_plane});
+  } else {
+    finput.resize_({batch_size,
+                    n_input_plane * kernel_height * kernel_width,
+                    output_height * output_width});
+  }
+  output.resize_({batch_size, n_output_plane, output_height, output_width}, memory_format);
 
   at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
     NoGradGuard no_grad;
@@ -447,7 +531,8 @@ std::tuple<Tensor&, Tensor&, Tensor&> slow_conv2d_forward_out_cpu(
           input_width,
           n_output_plane,
           output_height,
-          output_width);
+          output_width,
+          is_channels_last);
     }
   });
 
@@ -502,8 +587,13 @@ std::tuple<Tensor&, Tensor&, Tensor&> slow_conv2d_backward_out_cpu(
         padding);
   }
 
+  // finput was unfolded for channels last by the forward
+  const bool is_channels_last = slow_conv2d_use_channels_last(self, weight);
   if (grad_weight.defined()) {
-    grad_weight.resize_(weight.sizes());
+    grad_weight.resize_(
+        weight.sizes(),
+        is_channels_last ? at::MemoryFormat::ChannelsLast
+                         : at::MemoryFormat::Contiguous);
     grad_weight.zero_();
   }
 
@@ -522,7 +612,8 @@ std::tuple<Tensor&, Tensor&, Tensor&> slow_conv2d_backward_out_cpu(
         fgrad_input,
         kernel_size,
         stride,
-        padding);
+        padding,
+        is_channels_last);
   }
 
   return std::tuple<Tensor&, Tensor&, Tensor&>(
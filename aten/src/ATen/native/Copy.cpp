@@ -10,6 +10,8 @@
 #include <ATen/NamedTensorUtils.h>
 #include <torch/library.h>
 
+#include <algorithm>
+
 #ifdef USE_VULKAN
 #include <ATen/native/vulkan/VulkanAten.h>
 #endif
@@ -17,64 +19,60 @@ namespace {
 
 using namespace at;
 
-bool copy_transpose_valid(const Tensor& self, const Tensor& src) {
+// Returns whether copying src into self is a batch of transposes (see
+// TransposeCopyParams), and fills `params` if so. self may be any dense
+// permutation of a contiguous tensor, e.g. channels last: its dimensions are
+// walked in memory order, and the dimensions that are contiguous in both
+// tensors are merged first. For example, NCHW to NHWC, by
+// permute(0, 2, 3, 1).contiguous() or by contiguous(channels_last), is a
+// batch of N transposes of (H * W) x C matrices.
+bool copy_transpose_valid(const Tensor& self, const Tensor& src, native::TransposeCopyParams& params) {
   const int MIN_SZ = 60 * 60;
-  return self.is_contiguous() && src.numel() != 0 && src.dim() == 2 &&
-      src.stride(0) == 1 && src.stride(1) == src.size(0) &&
-      self.scalar_type() == src.scalar_type() &&
-      self.numel() >= MIN_SZ;
-}
+  if (!self.is_non_overlapping_and_dense() || src.numel() < MIN_SZ ||
+      self.scalar_type() != src.scalar_type() || self.sizes() != src.sizes()) {
+    return false;
+  }
+  const int64_t element_size = self.element_size();
+  if (element_size != 1 && element_size != 2 && element_size != 4 && element_size != 8) {
+    return false;
+  }
 
-// special case copy where tensor is contiguous and src is a transposed matrix
-// This can be generalized to most copies, but it's trickier
-void copy_same_type_transpose_(Tensor& self, const Tensor& src) {
-  int64_t BLOCK_SZ;
-  if (self.scalar_type() == kByte) {
-    BLOCK_SZ = 120;
-  } else {
-    BLOCK_SZ = 60;
-  }
-  Tensor buf = empty({BLOCK_SZ, BLOCK_SZ}, self.options());
-
-  AT_DISPATCH_ALL_TYPES_AND3(kHalf, kBool, kBFloat16, self.scalar_type(), "copy_", [&] {
-    scalar_t* sp = src.data_ptr<scalar_t>();
-    scalar_t* rp = self.data_ptr<scalar_t>();
-    scalar_t* bp = buf.data_ptr<scalar_t>();
-
-    int64_t NR = src.size(0);
-    int64_t NC = src.size(1);
-    for (int64_t R = 0; R < NR; R += BLOCK_SZ) {
-      for (int64_t C = 0; C < NC; C += BLOCK_SZ) {
-        scalar_t* spo = sp + R + C * NR;
-        scalar_t* rpo = rp + C + R * NC;
-
-        int nr = std::min(NR - R, BLOCK_SZ);
-        int nc = std::min(NC - C, BLOCK_SZ);
-
-        // 1. copy columns from src to buf
-        for (int c = 0; c < nc; c++) {
-          memcpy(bp + c * BLOCK_SZ, spo + c * NR, nr * sizeof(scalar_t));
-        }
-
-        // 2. transpose buf in place
-        int rc_max = std::max(nr, nc);
-        int rc_min = std::min(nr, nc);
-        for (int r = 0; r < rc_max; r++) {
-          int end = std::min(r, rc_min);
-          for (int c = 0; c < end; c++) {
-            scalar_t tmp = bp[r + BLOCK_SZ * c];
-            bp[r + BLOCK_SZ * c] = bp[r * BLOCK_SZ + c];
-            bp[r * BLOCK_SZ + c] = tmp;
-          }
-        }
-
-        // 3. copy rows from buf to dst
-        for (int r = 0; r < nr; r++) {
-          memcpy(rpo + r * NC, bp + r * BLOCK_SZ, nc * sizeof(scalar_t));
-        }
-      }
+  // Dimensions of self in memory order, innermost first. Those of size 1
+  // are skipped, so the strides are distinct.
+  std::vector<int64_t> dims;
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (self.size(d) != 1) {
+      dims.push_back(d);
     }
+  }
+  std::sort(dims.begin(), dims.end(), [&](int64_t a, int64_t b) {
+    return self.stride(a) < self.stride(b);
   });
+
+  // Merged dimensions of self, innermost first, with their strides in src.
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> src_strides;
+  for (auto d : dims) {
+    if (!sizes.empty() && src.stride(d) == src_strides.back() * sizes.back()) {
+      sizes.back() *= self.size(d);
+    } else {
+      sizes.push_back(self.size(d));
+      src_strides.push_back(src.stride(d));
+    }
+  }
+  if (sizes.size() < 2 || src_strides[0] == 1 || src_strides[1] != 1) {
+    return false;
+  }
+
+  params.dst = static_cast<char*>(self.data_ptr());
+  params.src = static_cast<const char*>(src.data_ptr());
+  params.element_size = element_size;
+  params.cols = sizes[0];
+  params.col_stride = src_strides[0];
+  params.rows = sizes[1];
+  params.batch_sizes.assign(sizes.begin() + 2, sizes.end());
+  params.batch_strides.assign(src_strides.begin() + 2, src_strides.end());
+  return true;
 }
 
 // Devices directly supported by this copy implementation. Other device types
@@ -156,8 +154,10 @@ static Tensor & copy_impl(Tensor & self, const Tensor & src, bool non_blocking)
   }
 
   // TODO: if we need to, we can also enable this path for quantized tensor
-  if (device_type == kCPU && copy_transpose_valid(self, src) && !self.is_quantized()) {
-    copy_same_type_transpose_(self, src);
+  TransposeCopyParams transpose_params;
+  if (device_type == kCPU && !self.is_quantized() &&
+      copy_transpose_valid(self, src, transpose_params)) {
+    transpose_copy_stub(kCPU, transpose_params);
     return self;
   }
 
@@ -177,6 +177,7 @@ Tensor& copy_(Tensor& self, const Tensor& src, bool non_blocking) {
 
 TORCH_LIBRARY_IMPL(aten, CatchAll, m) { m.impl_UNBOXED("copy_", copy_); }
 DEFINE_DISPATCH(copy_stub);
+DEFINE_DISPATCH(transpose_copy_stub);
 
 } // namespace native
 } // namespace at
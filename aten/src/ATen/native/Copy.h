@@ -13,5 +13,27 @@ using copy_fn = void (*)(TensorIterator&, bool non_blocking);
 
 DECLARE_DISPATCH(copy_fn, copy_stub);
 
+// A copy into a dense tensor that reads its source by columns, as in
+// t.t().contiguous() or in the conversions between NCHW and NHWC. The
+// destination memory is a batch of row major rows x cols matrices. The matching
+// source matrices are column major, with columns col_stride elements apart.
+// Strides are in elements.
+struct TransposeCopyParams {
+  char* dst;
+  const char* src;
+  int64_t element_size;
+  int64_t rows;
+  int64_t cols;
+  int64_t col_stride;
+  // Sizes and source strides of the batch dimensions, innermost first. The
+  // destination matrices are contiguous.
+  std::vector<int64_t> batch_sizes;
+  std::vector<int64_t> batch_strides;
+};
+
+using transpose_copy_fn = void (*)(const TransposeCopyParams&);
+
+DECLARE_DISPATCH(transpose_copy_fn, transpose_copy_stub);
+
 } // namespace native
 } // namespace at
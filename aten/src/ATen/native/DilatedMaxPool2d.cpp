@@ -171,6 +171,16 @@ void max_pool2d_with_indices_out_cpu_template(
     inputHeight, inputWidth,
     outputHeight, outputWidth);
 
+  if (input_.ndimension() == 4 &&
+      input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    output.resize_({nbatch, nInputPlane, outputHeight, outputWidth}, at::MemoryFormat::ChannelsLast);
+    indices.resize_({nbatch, nInputPlane, outputHeight, outputWidth}, at::MemoryFormat::ChannelsLast);
+    max_pool2d_channels_last_kernel(
+        kCPU, output, indices, input_,
+        kW, kH, dW, dH, padW, padH, dilationW, dilationH);
+    return;
+  }
+
   /* get contiguous input */
   Tensor input = input_.contiguous();
 
@@ -333,11 +343,17 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
   TORCH_CHECK((input.ndimension() == 3 || input.ndimension() == 4),
     "non-empty 3D or 4D (batch mode) tensor expected for input");
 
+  // The indices of a channels last input are channels last (see
+  // max_pool2d_with_indices_out_cpu_template).
+  const bool channels_last = input.ndimension() == 4 &&
+      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+  const auto memory_format = channels_last ? at::MemoryFormat::ChannelsLast : at::MemoryFormat::Contiguous;
+
   /* get contiguous gradOutput */
-  const Tensor gradOutput = gradOutput_.contiguous();
+  const Tensor gradOutput = gradOutput_.contiguous(memory_format);
 
   /* resize */
-  gradInput.resize_as_(input);
+  gradInput.resize_(input.sizes(), memory_format);
   gradInput.zero_();
 
   /* sizes */
@@ -363,7 +379,11 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
     outputHeight_for_shape_check, outputWidth_for_shape_check);
 
   /* backprop */
-  if (input.ndimension() == 3)
+  if (channels_last)
+  {
+    max_pool2d_backward_channels_last_kernel(kCPU, gradInput, gradOutput, indices);
+  }
+  else if (input.ndimension() == 3)
   {
     AT_DISPATCH_FLOATING_TYPES(input.scalar_type(),
       "max_pool2d_with_indices_backward",
@@ -509,5 +529,8 @@ Tensor max_pool2d_with_indices_backward_cpu(
   return gradInput;
 }
 
+DEFINE_DISPATCH(max_pool2d_channels_last_kernel);
+DEFINE_DISPATCH(max_pool2d_backward_channels_last_kernel);
+
 } // at::native
 } // at
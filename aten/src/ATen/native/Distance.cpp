@@ -4,6 +4,7 @@
 #include <ATen/NamedTensorUtils.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/native/Distance.h>
+#include <ATen/core/grad_mode.h>
 
 namespace at { namespace native {
 
@@ -11,6 +12,8 @@ DEFINE_DISPATCH(pdist_forward_stub);
 DEFINE_DISPATCH(pdist_backward_stub);
 DEFINE_DISPATCH(cdist_stub);
 DEFINE_DISPATCH(cdist_backward_stub);
+DEFINE_DISPATCH(euclidean_dist_stub);
+DEFINE_DISPATCH(cdist_topk_stub);
 
 Tensor pairwise_distance(const Tensor& x1, const Tensor& x2, double p, double eps, bool keepdim) {
   return at::norm(x1 - x2 + eps, p, 1, keepdim);
@@ -40,6 +43,13 @@ Tensor _euclidean_dist(const Tensor& x1, const Tensor& x2) {
   return result;
 }
 
+static bool use_fused_euclidean_dist(const Tensor& x1, const Tensor& x2) {
+  return x1.device().type() == kCPU &&
+      (x1.scalar_type() == kFloat || x1.scalar_type() == kDouble) &&
+      x2.scalar_type() == x1.scalar_type() &&
+      !(GradMode::is_enabled() && (x1.requires_grad() || x2.requires_grad()));
+}
+
 static Tensor cdist_impl(const Tensor& x1, const Tensor& x2, const double p, c10::optional<int64_t> compute_mode) {
   TORCH_CHECK(at::isFloatingType(x1.scalar_type()), "cdist only supports floating-point dtypes, X1 got: ", x1.scalar_type());
   auto device1 = x1.device().type();
@@ -89,6 +99,12 @@ static Tensor cdist_impl(const Tensor& x1, const Tensor& x2, const double p, c10
     result = at::empty(output_shape, x1.options());
   } else if (c1 == 0) {
     result = at::zeros(output_shape, x1.options());
+  } else if (p == 2 && (mode == 1 || (mode == 0 && (r1 > 25 || r2 > 25))) &&
+             use_fused_euclidean_dist(x1, x2)) {
+    // The fused kernel has no derivative, it is only used when no gradient is needed.
+    result = at::empty(output_shape, x1.options());
+    Tensor result_view = result.view({expand_batch_product, r1, r2});
+    euclidean_dist_stub(device1, result_view, tensor1_expanded, tensor2_expanded);
   } else if (p == 2 && (mode == 1 || (mode == 0 && (r1 > 25 || r2 > 25)))) {
     Tensor dist = (expand_batch_product == 1) ? at::_euclidean_dist(x1, x2) :
                   at::_euclidean_dist(tensor1_expanded, tensor2_expanded);
@@ -135,6 +151,54 @@ Tensor _cdist_forward(const Tensor& x1, const Tensor& x2, const double p, c10::o
   return result;
 }
 
+std::tuple<Tensor, Tensor> _cdist_topk(const Tensor& x1, const Tensor& x2, int64_t k) {
+  TORCH_CHECK(x1.dim() >= 2, "_cdist_topk only supports at least 2D tensors, X1 got: ", x1.dim(), "D");
+  TORCH_CHECK(x2.dim() >= 2, "_cdist_topk only supports at least 2D tensors, X2 got: ", x2.dim(), "D");
+  TORCH_CHECK(x1.size(-1) == x2.size(-1), "X1 and X2 must have the same number of columns. X1: ", x1.size(-1), " X2: ", x2.size(-1));
+  TORCH_CHECK(k >= 0 && k <= x2.size(-2), "k (", k, ") must be between 0 and the number of rows of X2 (", x2.size(-2), ")");
+  const int64_t r1 = x1.size(-2);
+  const int64_t r2 = x2.size(-2);
+  const int64_t c = x1.size(-1);
+  IntArrayRef batch_tensor1(x1.sizes().data(), x1.dim() - 2);
+  IntArrayRef batch_tensor2(x2.sizes().data(), x2.dim() - 2);
+  std::vector<int64_t> expand_batch_portion = infer_size(batch_tensor1, batch_tensor2);
+  std::vector<int64_t> output_shape(expand_batch_portion);
+  output_shape.insert(output_shape.end(), {r1, k});
+
+  if (use_fused_euclidean_dist(x1, x2) && r1 > 0 && k > 0 && c > 0) {
+    std::vector<int64_t> tensor1_expand_size(expand_batch_portion);
+    tensor1_expand_size.insert(tensor1_expand_size.end(), {r1, c});
+    std::vector<int64_t> tensor2_expand_size(expand_batch_portion);
+    tensor2_expand_size.insert(tensor2_expand_size.end(), {r2, c});
+    int64_t expand_batch_product = std::accumulate(expand_batch_portion.begin(), expand_batch_portion.end(), 1, std::multiplies<int64_t>());
+    Tensor tensor1_expanded = x1.expand(tensor1_expand_size).contiguous().view({expand_batch_product, r1, c});
+    Tensor tensor2_expanded = x2.expand(tensor2_expand_size).contiguous().view({expand_batch_product, r2, c});
+    Tensor values = at::empty(output_shape, x1.options());
+    Tensor indices = at::empty(output_shape, x1.options().dtype(kLong));
+    Tensor values_view = values.view({expand_batch_product, r1, k});
+    Tensor indices_view = indices.view({expand_batch_product, r1, k});
+    cdist_topk_stub(kCPU, values_view, indices_view, tensor1_expanded, tensor2_expanded, k);
+    return std::make_tuple(values, indices);
+  }
+
+  // Otherwise compute the distances of chunks of rows of X1 at a time, so
+  // that only about 2^24 of them exist at any time.
+  const int64_t chunk = std::max<int64_t>(1, (int64_t(1) << 24) / std::max<int64_t>(r2, 1));
+  if (r1 <= chunk) {
+    return at::cdist(x1, x2).topk(k, -1, /*largest=*/false);
+  }
+  std::vector<Tensor> values;
+  std::vector<Tensor> indices;
+  for (int64_t i = 0; i < r1; i += chunk) {
+    Tensor chunk_values, chunk_indices;
+    std::tie(chunk_values, chunk_indices) =
+        at::cdist(x1.narrow(-2, i, std::min(chunk, r1 - i)), x2).topk(k, -1, /*largest=*/false);
+    values.push_back(chunk_values);
+    indices.push_back(chunk_indices);
+  }
+  return std::make_tuple(at::cat(values, -2), at::cat(indices, -2));
+}
+
 Tensor _cdist_backward(const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& cdist) {
   TORCH_CHECK(x1.is_contiguous(), "_cdist_backward requires X1 to be contiguous");
   TORCH_CHECK(x2.is_contiguous(), "_cdist_backward requires X2 to be contiguous");
@@ -9,10 +9,16 @@ using pdist_forward_fn = void(*)(Tensor&, const Tensor&, const double p);
 using pdist_backward_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const double p, const Tensor&);
 using cdist_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const double p);
 using cdist_backward_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const Tensor&, const double p, const Tensor&);
+// (result, x1, x2) for contiguous 3D x1, x2 and result
+using euclidean_dist_fn = void(*)(Tensor&, const Tensor&, const Tensor&);
+// (values, indices, x1, x2, k) for contiguous 3D tensors
+using cdist_topk_fn = void(*)(Tensor&, Tensor&, const Tensor&, const Tensor&, int64_t k);
 
 DECLARE_DISPATCH(pdist_forward_fn, pdist_forward_stub);
 DECLARE_DISPATCH(pdist_backward_fn, pdist_backward_stub);
 DECLARE_DISPATCH(cdist_fn, cdist_stub);
 DECLARE_DISPATCH(cdist_backward_fn, cdist_backward_stub);
+DECLARE_DISPATCH(euclidean_dist_fn, euclidean_dist_stub);
+DECLARE_DISPATCH(cdist_topk_fn, cdist_topk_stub);
 
 }} // namespace at::native
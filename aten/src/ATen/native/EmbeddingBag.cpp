@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/cpu/vec256/vec256.h>
 
 #include <TH/THBlasUtils.h>
 
@@ -15,6 +16,7 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <tuple>
 #include <vector>
 #include <algorithm>
 
@@ -45,252 +47,249 @@ bool isFastPathIndexSelectScale(const Tensor& src, const Tensor& scale, Tensor&
   return src.scalar_type() == kFloat && src.stride(1) == 1 && output.stride(1) == 1 && scale.stride(0) == 1;
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& /*offsets*/,
-                             bool /*include_last_offset*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto* add_indices_data = add_indices.data_ptr<int64_t>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* src_data = src.data_ptr<T>();
-  auto* output_data = output.data_ptr<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
+// Bounds of the bags in indices, such that bag i is
+// indices[bounds[i]:bounds[i + 1]]. Without include_last_offset, the end of the
+// last bag is the end of indices.
+std::vector<int64_t> make_bag_bounds(
+    const Tensor& offsets,
+    const Tensor& indices,
+    bool include_last_offset) {
+  const auto* offsets_data = offsets.data_ptr<int64_t>();
+  std::vector<int64_t> bounds(offsets_data, offsets_data + offsets.numel());
+  if (!include_last_offset) {
+    bounds.push_back(indices.numel());
   }
+  return bounds;
 }
 
-template<>
-void index_select_add<float>(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& offsets,
-                             bool include_last_offset) {
-  int64_t ddim = src.size(1);
-  auto* src_data = src.data_ptr<float>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* output_data = output.data_ptr<float>();
+// Number of bags handed to each thread, aiming at GRAIN_SIZE elements of
+// weight read per thread.
+int64_t bag_grain_size(int64_t num_indices, int64_t num_bags, int64_t ddim) {
+  const int64_t avg_bag_size = num_indices / std::max<int64_t>(num_bags, 1);
+  return std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(avg_bag_size * ddim, 1));
+}
 
-  if (isFastPathIndexSelect(src, output)) {
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<int64_t>();
-    std::vector<int64_t> offsets_include_last;
+void check_bag(int64_t bag, int64_t begin, int64_t end, int64_t num_indices) {
+  TORCH_CHECK(
+      begin <= end && end <= num_indices,
+      "embedding_bag: offsets have to be non-decreasing and at most the ",
+      "length of input ", num_indices, ", but bag ", bag, " goes from ",
+      begin, " to ", end);
+}
 
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<int64_t>(),
-          sizeof(int64_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
+void check_index(int64_t index, int64_t num_weights) {
+  TORCH_CHECK(
+      index >= 0 && index < num_weights,
+      "embedding_bag: index ", index, " is out of range for weight with ",
+      num_weights, " rows");
+}
 
-#ifdef USE_FBGEMM
-    auto kernel_fp32_i64 =
-      fbgemm::GenerateEmbeddingSpMDM<float, int64_t, int64_t>(
-        /* block_size */ddim,
-        /* has_weight */false,
-        /* normalize_by_lengths */false,
-        /* prefetch */16,
-        /* is_weight_positional */false,
-        /* use_offsets */true
-      );
-#endif
-    at::parallel_for(
-        0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
-#ifdef USE_FBGEMM
-          kernel_fp32_i64(
-            /* output_size */end_idx - start_idx,
-            /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
-            /* data_size */src.size(0),
-            /* input */src_data,
-            /* indices */select_indices_data + offsets_data[start_idx],
-            /* offsets_or_lengths */offsets_data + start_idx,
-            /* weights */nullptr,
-            /* output */output_data + start_idx * ddim);
-#else
-          caffe2::EmbeddingLookupIdx(
-              /*block_size=*/ddim,
-              /*output_size=*/end_idx - start_idx,
-              /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
-              /*data_size=*/src.size(0),
-              /*input=*/src_data,
-              /*indices=*/select_indices_data + offsets_data[start_idx],
-              /*offsets=*/offsets_data + start_idx,
-              /*weights=*/nullptr,
-              /*scale_bias=*/nullptr,
-              /*normalize_by_lengths=*/false,
-              /*out=*/output_data + start_idx * ddim);
-#endif
-        });
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto* add_indices_data = add_indices.data_ptr<int64_t>();
-    auto src_stride0 = src.stride(0);
-    auto src_stride1 = src.stride(1);
-    auto output_stride0 = output.stride(0);
-    auto output_stride1 = output.stride(1);
-    auto numel = add_indices.numel();
-    for (int64_t i = 0; i < numel; i++) {
-      THBlas_axpy<float>(
-          ddim,
-          1,
-          src_data + src_stride0 * select_indices_data[i],
-          src_stride1,
-          output_data + output_stride0 * add_indices_data[i],
-          output_stride1);
-    }
+// y += a * x on contiguous rows of n elements.
+template <typename scalar_t>
+inline void axpy_row(int64_t n, scalar_t a, const scalar_t* x, scalar_t* y) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const Vec a_vec(a);
+  int64_t d = 0;
+  for (; d < n - (n % Vec::size()); d += Vec::size()) {
+    vec256::fmadd(a_vec, Vec::loadu(x + d), Vec::loadu(y + d)).store(y + d);
+  }
+  for (; d < n; d++) {
+    y[d] += a * x[d];
   }
 }
 
-// This function fuses the following three fns:
-// index_select (using select_indices as the index)
-// mul (scaling by per_sample_weights)
-// index_add (using add_indices as the index)
-template<typename T>
-static void index_select_scale_add(const Tensor &select_indices,
-                                   const Tensor &add_indices,
-                                   const Tensor &scale,
-                                   const Tensor &src,
-                                   Tensor &output,
-                                   const Tensor& /*offsets*/,
-                                   bool /*include_last_offset*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto* add_indices_data = add_indices.data_ptr<int64_t>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* src_data = src.data_ptr<T>();
-  auto* output_data = output.data_ptr<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-
-  auto* scale_data = scale.data_ptr<T>();
-  auto scale_stride = scale.stride(0);
+// Sums, or averages for MODE_MEAN, the rows of src selected by each bag into
+// the rows of output, scaling them by per_sample_weights if defined. Bags are
+// split across threads, so each row of output is written by a single thread.
+template <typename scalar_t>
+void embedding_bag_cpu_sum_mean(
+    const Tensor& src,
+    const Tensor& indices,
+    const std::vector<int64_t>& bounds,
+    const Tensor& per_sample_weights,
+    int64_t mode,
+    Tensor& output) {
+  const int64_t num_bags = bounds.size() - 1;
+  const int64_t num_indices = indices.numel();
+  const int64_t num_weights = src.size(0);
+  const int64_t ddim = src.size(1);
+  const auto* indices_data = indices.data_ptr<int64_t>();
+  const auto* src_data = src.data_ptr<scalar_t>();
+  auto* output_data = output.data_ptr<scalar_t>();
+  const auto src_stride0 = src.stride(0);
+  const auto src_stride1 = src.stride(1);
+  const auto output_stride0 = output.stride(0);
+  const auto output_stride1 = output.stride(1);
+  const bool contiguous_rows = src_stride1 == 1 && output_stride1 == 1;
+
+  const scalar_t* scale_data = nullptr;
+  int64_t scale_stride = 0;
+  if (per_sample_weights.defined()) {
+    scale_data = per_sample_weights.data_ptr<scalar_t>();
+    scale_stride = per_sample_weights.stride(0);
+  }
 
-  for (int64_t i = 0; i < numel; i++) {
-    auto* src_base = src_data + src_stride0 * select_indices_data[i];
-    auto* output_base = output_data + output_stride0 * add_indices_data[i];
-    auto scale = scale_data[i * scale_stride];
-    for (int64_t j = 0; j < ddim; j++) {
-      output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
+  at::parallel_for(
+      0, num_bags, bag_grain_size(num_indices, num_bags, ddim),
+      [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t bag_begin = bounds[bag];
+      const int64_t bag_end = bounds[bag + 1];
+      check_bag(bag, bag_begin, bag_end, num_indices);
+      scalar_t* output_row = output_data + output_stride0 * bag;
+      for (int64_t j = 0; j < ddim; j++) {
+        output_row[j * output_stride1] = 0;
+      }
+      for (int64_t i = bag_begin; i < bag_end; i++) {
+        const int64_t index = indices_data[i];
+        check_index(index, num_weights);
+        const scalar_t scale =
+            scale_data ? scale_data[i * scale_stride] : scalar_t(1);
+        const scalar_t* src_row = src_data + src_stride0 * index;
+        if (contiguous_rows) {
+          axpy_row<scalar_t>(ddim, scale, src_row, output_row);
+        } else {
+          THBlas_axpy<scalar_t>(
+              ddim, scale, const_cast<scalar_t*>(src_row), src_stride1,
+              output_row, output_stride1);
+        }
+      }
+      // Empty bags are left as all 0s
+      if (mode == MODE_MEAN && bag_end > bag_begin) {
+        const scalar_t inv_bag_size = scalar_t(1) / (bag_end - bag_begin);
+        for (int64_t j = 0; j < ddim; j++) {
+          output_row[j * output_stride1] *= inv_bag_size;
+        }
+      }
     }
-  }
+  });
 }
 
-template<>
-void index_select_scale_add<float>(const Tensor &select_indices,
-                                          const Tensor &add_indices,
-                                          const Tensor &scale,
-                                          const Tensor &src,
-                                          Tensor &output,
-                                          const Tensor& offsets,
-                                          bool include_last_offset) {
-  int64_t ddim = src.size(1);
-  auto* scale_data = scale.data_ptr<float>();
-  auto* select_indices_data = select_indices.data_ptr<int64_t>();
-  auto* src_data = src.data_ptr<float>();
+// Float version of embedding_bag_cpu_sum_mean on contiguous rows, which runs
+// the fbgemm or perfkernels embedding lookup on the bags of each thread.
+void embedding_bag_cpu_sum_mean_fast(
+    const Tensor& src,
+    const Tensor& indices,
+    const std::vector<int64_t>& bounds,
+    const Tensor& per_sample_weights,
+    int64_t mode,
+    Tensor& output) {
+  const int64_t num_bags = bounds.size() - 1;
+  const int64_t ddim = src.size(1);
+  const auto* src_data = src.data_ptr<float>();
+  const auto* indices_data = indices.data_ptr<int64_t>();
+  const auto* offsets_data = bounds.data();
   auto* output_data = output.data_ptr<float>();
-
-  if (isFastPathIndexSelectScale(src, scale, output)) {
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<int64_t>();
-    std::vector<int64_t> offsets_include_last;
-
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<int64_t>(),
-          sizeof(int64_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
+  const float* scale_data = per_sample_weights.defined()
+      ? per_sample_weights.data_ptr<float>()
+      : nullptr;
+  const bool normalize_by_lengths = mode == MODE_MEAN;
 
 #ifdef USE_FBGEMM
-    auto kernel_fp32_i64 =
-      fbgemm::GenerateEmbeddingSpMDM<float, int64_t, int64_t>(
-        /* block_size */ddim,
-        /* has_weight */true,
-        /* normalize_by_lengths */false,
-        /* prefetch */16,
-        /* is_weight_positional */false,
-        /* use_offsets */true
-      );
+  auto kernel_fp32_i64 =
+    fbgemm::GenerateEmbeddingSpMDM<float, int64_t, int64_t>(
+      /* block_size */ddim,
+      /* has_weight */scale_data != nullptr,
+      /* normalize_by_lengths */normalize_by_lengths,
+      /* prefetch */16,
+      /* is_weight_positional */false,
+      /* use_offsets */true
+    );
 #endif
-    at::parallel_for(
-        0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+  at::parallel_for(
+      0, num_bags, bag_grain_size(indices.numel(), num_bags, ddim),
+      [&](int64_t start_idx, int64_t end_idx) {
 #ifdef USE_FBGEMM
-          kernel_fp32_i64(
-            /* output_size */end_idx - start_idx,
-            /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
-            /* data_size */src.size(0),
-            /* input */src_data,
-            /* indices */select_indices_data + offsets_data[start_idx],
-            /* offsets_or_lengths */offsets_data + start_idx,
-            /* weights */scale_data + offsets_data[start_idx],
-            /* output */output_data + start_idx * ddim);
+        bool success = kernel_fp32_i64(
+          /* output_size */end_idx - start_idx,
+          /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
+          /* data_size */src.size(0),
+          /* input */src_data,
+          /* indices */indices_data + offsets_data[start_idx],
+          /* offsets_or_lengths */offsets_data + start_idx,
+          /* weights */scale_data ? scale_data + offsets_data[start_idx] : nullptr,
+          /* output */output_data + start_idx * ddim);
+        TORCH_CHECK(
+            success,
+            "embedding_bag: offsets have to be non-decreasing and indices ",
+            "have to be in the range of the rows of weight");
 #else
-          caffe2::EmbeddingLookupIdx(
-              /*block_size=*/ddim,
-              /*output_size=*/end_idx - start_idx,
-              /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
-              /*data_size=*/src.size(0),
-              /*input=*/src_data,
-              /*indices=*/select_indices_data + offsets_data[start_idx],
-              /*offsets=*/offsets_data + start_idx,
-              /*weights=*/scale_data + offsets_data[start_idx],
-              /*scale_bias=*/nullptr,
-              /*normalize_by_lengths=*/false,
-              /*out=*/output_data + start_idx * ddim);
+        caffe2::EmbeddingLookupIdx(
+            /*block_size=*/ddim,
+            /*output_size=*/end_idx - start_idx,
+            /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
+            /*data_size=*/src.size(0),
+            /*input=*/src_data,
+            /*indices=*/indices_data + offsets_data[start_idx],
+            /*offsets=*/offsets_data + start_idx,
+            /*weights=*/scale_data ? scale_data + offsets_data[start_idx] : nullptr,
+            /*scale_bias=*/nullptr,
+            /*normalize_by_lengths=*/normalize_by_lengths,
+            /*out=*/output_data + start_idx * ddim);
 #endif
-        });
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto* add_indices_data = add_indices.data_ptr<int64_t>();
-    auto src_stride0 = src.stride(0);
-    auto src_stride1 = src.stride(1);
-    auto output_stride0 = output.stride(0);
-    auto output_stride1 = output.stride(1);
-    auto scale_stride = scale.stride(0);
-    auto numel = add_indices.numel();
-
-
-    for (int64_t i = 0; i < numel; i++) {
-      auto* src_base = src_data + src_stride0 * select_indices_data[i];
-      auto* output_base = output_data + output_stride0 * add_indices_data[i];
-      auto scale = scale_data[i * scale_stride];
-      for (int64_t j = 0; j < ddim; j++) {
-        output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
+      });
+}
+
+// Takes the maximum of the rows of src selected by each bag into the rows of
+// output, along with the index of the row each maximum comes from, in
+// parallel over bags. Empty bags are left as all 0s.
+template <typename scalar_t>
+void embedding_bag_cpu_max(
+    const Tensor& src,
+    const Tensor& indices,
+    const std::vector<int64_t>& bounds,
+    Tensor& output,
+    Tensor& max_indices) {
+  const int64_t num_bags = bounds.size() - 1;
+  const int64_t num_indices = indices.numel();
+  const int64_t num_weights = src.size(0);
+  const int64_t ddim = src.size(1);
+  const auto* indices_data = indices.data_ptr<int64_t>();
+  const auto* src_data = src.data_ptr<scalar_t>();
+  auto* output_data = output.data_ptr<scalar_t>();
+  auto* max_indices_data = max_indices.data_ptr<int64_t>();
+  const auto src_stride0 = src.stride(0);
+  const auto src_stride1 = src.stride(1);
+  const auto output_stride = output.stride(0);
+  const auto max_indices_stride = max_indices.stride(0);
+
+  at::parallel_for(
+      0, num_bags, bag_grain_size(num_indices, num_bags, ddim),
+      [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t bag_begin = bounds[bag];
+      const int64_t bag_end = bounds[bag + 1];
+      check_bag(bag, bag_begin, bag_end, num_indices);
+      scalar_t* output_row = output_data + output_stride * bag;
+      int64_t* max_indices_row = max_indices_data + max_indices_stride * bag;
+      if (bag_begin == bag_end) {
+        std::fill(output_row, output_row + ddim, scalar_t(0));
+        std::fill(max_indices_row, max_indices_row + ddim, 0);
+        continue;
+      }
+      for (int64_t i = bag_begin; i < bag_end; i++) {
+        const int64_t index = indices_data[i];
+        check_index(index, num_weights);
+        const scalar_t* src_row = src_data + src_stride0 * index;
+        if (i == bag_begin) {
+          for (int64_t dim = 0; dim < ddim; dim++) {
+            output_row[dim] = src_row[dim * src_stride1];
+            max_indices_row[dim] = index;
+          }
+          continue;
+        }
+        for (int64_t dim = 0; dim < ddim; dim++) {
+          const scalar_t item = src_row[dim * src_stride1];
+          if (item > output_row[dim]) {
+            output_row[dim] = item;
+            max_indices_row[dim] = index;
+          }
+        }
       }
     }
-  }
+  });
 }
-
 }  // namespace
 
 static at::Tensor make_bag_size(
@@ -315,26 +314,6 @@ static at::Tensor make_bag_size(
   return bag_size;
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    // Avoid dividing by 0 for empty bags.
-    // Instead we want empty bags to return all 0s
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = std::max(indices.size(0), static_cast<int64_t>(1));
-      output /= bag_size_;
-    } else {
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size, LEGACY_CONTIGUOUS_MEMORY_FORMAT))
-                           .to(output.options())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -354,50 +333,6 @@ static Tensor apply_bag_size_backward(const Tensor &offsets,
 }
 
 
-template <typename scalar_t>
-std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
-    const Tensor& weight,
-    const Tensor& indices,
-    const Tensor& offset2bag,
-    const Tensor& output,
-    const Tensor& bag_size,
-    const Tensor& offsets) {
-
-    auto max_indices = at::zeros({offsets.size(0), weight.size(1)}, indices.options());
-
-    int64_t numel = indices.numel();
-    int64_t dims = weight.size(1);
-    auto* indices_data = indices.data_ptr<int64_t>();
-    auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
-
-    auto* max_indices_data = max_indices.data_ptr<int64_t>();
-    auto max_indices_stride = max_indices.stride(0);
-
-    auto* weight_data = weight.data_ptr<scalar_t>();
-    auto* output_data = output.data_ptr<scalar_t>();
-    auto weight_stride0 = weight.stride(0);
-    auto weight_stride1 = weight.stride(1);
-    auto output_stride = output.stride(0);
-
-    for (int i = 0; i < numel; i++) {
-      auto bag = offset2bag_data[i];
-      auto word_idx = indices_data[i];
-
-      for (int dim = 0; dim < dims; dim++) {
-        auto& current_item = output_data[output_stride * bag + dim];
-        auto weight_item = weight_data[weight_stride0 * word_idx + dim * weight_stride1];
-        bool is_first_for_bag = (i == 0) || offset2bag_data[i - 1] != bag;
-
-        if (is_first_for_bag || weight_item > current_item) {
-          current_item = weight_item;
-          max_indices_data[max_indices_stride * bag + dim] = word_idx;
-        }
-      }
-    }
-
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
-}
-
 // embedding_bag wrapper to enforce contiguity in tensors other than `weight`.
 // This is created to save extra `.contiguous()` call in backward.
 // See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
@@ -456,59 +391,37 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
        weight.size(1)},
       weight.options());
 
-  // To save compute, if we are going to go down the fast path case for the 'sum'
-  // mode, we skip calculating offset2bag, since it is not going to be used.
-  auto fast_path_sum = [&weight, &per_sample_weights, &output]() {
-    if (per_sample_weights.defined()) {
-      return isFastPathIndexSelectScale(weight, per_sample_weights, output);
-    } else {
-      return isFastPathIndexSelect(weight, output);
-    }
-  };
-
+  // The bags are reduced straight from offsets, so offset2bag is not needed.
   // Use an empty 0-element tensor as a sentinel that we have skipped the
   // creation of offset2bag because autograd chokes when trying to use an
-  // undefined tensor as an input to a backward op.
+  // undefined tensor as an input to a backward op. The backward creates it
+  // when it needs it.
   Tensor offset2bag = at::empty({0}, offsets.options());
-  if (mode == MODE_MEAN || mode == MODE_MAX || !fast_path_sum()) {
-    // If the last entries are empty, that the last offsets are irrelevant as they
-    // won't change anything in the assignment of ID -> bag, but index_add would
-    // throw out of bounds error. So to keep it simple we just add one more
-    // entry to the end then get rid of it after make_offset2bag.
-    offset2bag = at::zeros(
-       {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-    make_offset2bag(offsets, indices, offset2bag);
-
-    offset2bag.resize_({indices.sizes()[0]});
-
-    // only initialize output in slow path
-    output.zero_();
-  }
+  const auto bounds = make_bag_bounds(offsets, indices, include_last_offset);
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_cpu", [&]() {
-      if (per_sample_weights.defined()) {
-        AT_ASSERT(mode == MODE_SUM);
-        index_select_scale_add<scalar_t>(
-            indices, offset2bag, per_sample_weights, weight, output, offsets, include_last_offset);
-      } else {
-        index_select_add<scalar_t>(indices, offset2bag, weight, output, offsets, include_last_offset);
-      }
-    });
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
-  } else { // MODE_MAX
-    at::optional<Tensor> maybe_per_sample_weights;
-    if (per_sample_weights.defined()) {
-      maybe_per_sample_weights = per_sample_weights;
+    const bool fast_path = per_sample_weights.defined()
+        ? isFastPathIndexSelectScale(weight, per_sample_weights, output)
+        : isFastPathIndexSelect(weight, output);
+    if (fast_path) {
+      embedding_bag_cpu_sum_mean_fast(
+          weight, indices, bounds, per_sample_weights, mode, output);
+    } else {
+      AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_cpu", [&]() {
+        embedding_bag_cpu_sum_mean<scalar_t>(
+            weight, indices, bounds, per_sample_weights, mode, output);
+      });
     }
-    return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
+  } else { // MODE_MAX
+    auto max_indices = at::zeros({offsets.size(0), weight.size(1)}, indices.options());
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.scalar_type(), "embedding_bag_cpu_max", [&]() {
-        return embedding_bag_cpu_max<scalar_t>(
-            weight, indices, offset2bag, output, bag_size, offsets);
+        embedding_bag_cpu_max<scalar_t>(
+            weight, indices, bounds, output, max_indices);
       }
     );
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
   }
 }
 
@@ -556,138 +469,133 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
   }
 }
 
-static Tensor _embedding_bag_dense_backward_cpu_max(
+template <typename scalar_t>
+static void _embedding_bag_dense_backward_cpu_max(
     const Tensor& grad,
-    const Tensor& bag_size,
-    const Tensor& max_indices,
-    int64_t num_weights) {
-  AT_ASSERT(max_indices.defined());
-  auto index_grad_weight =
-      at::zeros({num_weights, grad.size(1)}, grad.options());
-  auto nonempty_max_indices = max_indices.index_select(0, bag_size.nonzero().view(-1));
-  auto nonempty_grad = grad.index_select(0, bag_size.nonzero().view(-1));
-
-  for (int64_t dim = 0; dim < grad.size(1); dim++) {
-    index_grad_weight.select(1, dim).index_add_(
-      0, nonempty_max_indices.select(1, dim), nonempty_grad.select(1, dim));
-  }
-  return index_grad_weight;
-}
-
-static std::vector<int64_t> compute_counts(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length) {
-  std::vector<int64_t> counts(num_weights, 0);
-  for (int i = 0; i < indices_length; i++) {
-    counts[indices_data[i]]++;
-  }
-  return counts;
-}
-
-// counts_uniq stores the index of the NEXT unique element
-// of the (sorted) indices vector.
-//
-// For example:
-// indices: [0, 0, 0, 1, 3, 3, 4]
-// counts: [3, 1, 0, 2, 1, 0]
-// counts_uniq: [3, 4, 6, 7]
-//
-// The unique indices can be found at index 0, 3, 4, 6.
-static std::vector<int64_t> compute_counts_uniq(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length,
-    const std::vector<int64_t>& counts) {
-  std::vector<int64_t> counts_uniq;
-  counts_uniq.reserve(num_weights);
-  int64_t o = 0;
-  for (int64_t i = 0; i < indices_length; i += counts[indices_data[i]]) {
-    counts_uniq.push_back(counts[indices_data[i]]);
-    if (o > 0) {
-      counts_uniq[o] += counts_uniq[o - 1];
+    const Tensor& bag_size_,
+    const Tensor& max_indices_,
+    Tensor& index_grad_weight) {
+  AT_ASSERT(max_indices_.defined());
+  auto bag_size = bag_size_.contiguous();
+  auto max_indices = max_indices_.contiguous();
+  const int64_t num_bags = grad.size(0);
+  const int64_t ddim = grad.size(1);
+  const auto* bag_size_data = bag_size.data_ptr<int64_t>();
+  const auto* max_indices_data = max_indices.data_ptr<int64_t>();
+  const auto* grad_data = grad.data_ptr<scalar_t>();
+  auto* index_grad_weight_data = index_grad_weight.data_ptr<scalar_t>();
+
+  // Each thread owns a range of the columns of index_grad_weight, so that the
+  // rows the bags scatter into are updated without atomics.
+  at::parallel_for(
+      0, ddim,
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(num_bags, 1)),
+      [&](int64_t begin, int64_t end) {
+    for (int64_t bag = 0; bag < num_bags; bag++) {
+      if (bag_size_data[bag] == 0) {
+        continue;
+      }
+      const scalar_t* grad_row = grad_data + ddim * bag;
+      const int64_t* max_indices_row = max_indices_data + ddim * bag;
+      for (int64_t dim = begin; dim < end; dim++) {
+        index_grad_weight_data[ddim * max_indices_row[dim] + dim] += grad_row[dim];
+      }
     }
-    o++;
-  }
-  return counts_uniq;
+  });
 }
 
+// Sorting the indices groups the samples of each row of weight into a
+// segment, so that the gradient of a row is a reduction over its segment,
+// done by a single thread. The sort is a parallel radix sort on large inputs,
+// see SortingKernel.cpp.
 template <typename scalar_t>
 void _embedding_bag_dense_backward_cpu_sum_mean(
     const Tensor& grad,
     const Tensor& indices_,
     const Tensor& offsets_,
-    const Tensor& offset2bag__,
+    const Tensor& offset2bag_,
     int64_t num_weights,
     bool scale_grad_by_freq,
     int64_t mode,
     const Tensor& per_sample_weights_,
     Tensor& index_grad_weight) {
+  const int64_t numel = indices_.numel();
+  if (numel == 0) {
+    return;
+  }
 
-  Tensor &offset2bag_ = const_cast<Tensor &>(offset2bag__);
-
-  auto ind_sort_ = indices_.sort();
-  auto indices = std::get<0>(ind_sort_);
-  auto ind_sort = std::get<1>(ind_sort_);
-  auto offset2bag = offset2bag_.index_select(0, ind_sort);
+  Tensor indices, ind_sort;
+  std::tie(indices, ind_sort) = indices_.sort();
+  const auto* indices_data = indices.data_ptr<int64_t>();
+  const auto* ind_sort_data = ind_sort.data_ptr<int64_t>();
+  const auto* offsets_data = offsets_.data_ptr<int64_t>();
+  const auto* offset2bag_data = offset2bag_.data_ptr<int64_t>();
+  TORCH_CHECK(
+      indices_data[0] >= 0 && indices_data[numel - 1] < num_weights,
+      "embedding_bag: index ",
+      indices_data[0] < 0 ? indices_data[0] : indices_data[numel - 1],
+      " is out of range for weight with ", num_weights, " rows");
 
-  optional<Tensor> per_sample_weights;
-  scalar_t* per_sample_weights_data;
-  optional<int64_t> per_sample_weights_stride;
+  const scalar_t* per_sample_weights_data = nullptr;
+  int64_t per_sample_weights_stride = 0;
   if (per_sample_weights_.defined()) {
-    per_sample_weights = per_sample_weights_.index_select(0, ind_sort);
-    per_sample_weights_data = per_sample_weights->data_ptr<scalar_t>();
-    per_sample_weights_stride = per_sample_weights->stride(0);
+    AT_ASSERT(mode == MODE_SUM);
+    per_sample_weights_data = per_sample_weights_.data_ptr<scalar_t>();
+    per_sample_weights_stride = per_sample_weights_.stride(0);
   }
 
-  auto* indices_data = indices.data_ptr<int64_t>();
-  auto* offsets_data = offsets_.data_ptr<int64_t>();
-  auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
-  int64_t numel = indices.numel();
-
-  auto counts = compute_counts(num_weights, indices_data, numel);
-  auto next_unique_index_idx =
-      compute_counts_uniq(num_weights, indices_data, numel, counts);
-
-  auto loop = [&](int64_t start, int64_t end) {
-    for (int64_t i = start; i < end; i++) {
-      int64_t start = i == 0 ? 0 : next_unique_index_idx[i - 1];
-      int64_t index = indices_data[start];
-      for (int64_t j = start; j < next_unique_index_idx[i]; j++) {
-        int64_t source = offset2bag_data[j];
-        double scale = 1.0;
-        if (per_sample_weights) {
-          AT_ASSERT(mode == MODE_SUM);
-          scale = per_sample_weights_data[*per_sample_weights_stride * j];
+  // segment_starts[i] is the start of the segment of the i-th unique index,
+  // followed by the end of the last segment.
+  std::vector<int64_t> segment_starts;
+  for (int64_t i = 0; i < numel; i++) {
+    if (i == 0 || indices_data[i] != indices_data[i - 1]) {
+      segment_starts.push_back(i);
+    }
+  }
+  const int64_t num_segments = segment_starts.size();
+  segment_starts.push_back(numel);
+
+  std::vector<scalar_t> inv_bag_size;
+  if (mode == MODE_MEAN) {
+    const int64_t num_offsets = offsets_.numel();
+    inv_bag_size.resize(num_offsets);
+    for (int64_t bag = 0; bag < num_offsets; bag++) {
+      const int64_t bag_end =
+          bag + 1 < num_offsets ? offsets_data[bag + 1] : numel;
+      const int64_t bag_size = bag_end - offsets_data[bag];
+      inv_bag_size[bag] = bag_size > 0 ? scalar_t(1) / bag_size : scalar_t(0);
+    }
+  }
+
+  const int64_t ddim = grad.size(1);
+  const auto* grad_data = grad.data_ptr<scalar_t>();
+  auto* index_grad_weight_data = index_grad_weight.data_ptr<scalar_t>();
+  const int64_t avg_segment_size = numel / num_segments;
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(avg_segment_size * ddim, 1));
+  at::parallel_for(0, num_segments, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t segment = begin; segment < end; segment++) {
+      const int64_t start = segment_starts[segment];
+      const int64_t stop = segment_starts[segment + 1];
+      const int64_t index = indices_data[start];
+      scalar_t* index_grad_row = index_grad_weight_data + ddim * index;
+      for (int64_t j = start; j < stop; j++) {
+        const int64_t sample = ind_sort_data[j];
+        const int64_t source = offset2bag_data[sample];
+        scalar_t scale = 1;
+        if (per_sample_weights_data) {
+          scale = per_sample_weights_data[per_sample_weights_stride * sample];
         }
         if (scale_grad_by_freq) {
-          scale /= counts[indices_data[i]];
+          scale /= stop - start;
         }
-        if (mode == 1) { // MODE_MEAN
-          if (offsets_.size(0) == 1) {
-            auto bag_size = indices.size(0);
-            scale /= bag_size;
-          } else {
-            if (source == offsets_.size(0) - 1) {
-              scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-            } else {
-              scale /= offsets_data[source + 1] - offsets_data[source];
-            }
-          }
+        if (mode == MODE_MEAN) {
+          scale *= inv_bag_size[source];
         }
-        int64_t ddim = grad.size(1);
-        auto igwd = index_grad_weight.data_ptr<scalar_t>();
-        auto gd = grad.data_ptr<scalar_t>();
-        THBlas_axpy<scalar_t>(ddim, (scalar_t)scale, gd + ddim * source, 1,
-                    igwd + ddim * index, 1);
+        axpy_row<scalar_t>(ddim, scale, grad_data + ddim * source, index_grad_row);
       }
     }
-  };
-  if (numel > 1000) {
-    at::parallel_for(0, (int64_t)next_unique_index_idx.size(), 0, loop);
-  } else {
-    loop(0, (int64_t)next_unique_index_idx.size());
-  }
+  });
 }
 
 Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indices_,
@@ -705,15 +613,18 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   auto grad_arg = TensorArg(grad, "grad_", 1);
   checkScalarTypes("embedding_bag", grad_arg, {kFloat, kDouble});
 
+  auto index_grad_weight =
+      at::zeros({num_weights, grad.size(1)}, grad.options());
+
   if (mode == MODE_MAX) {
-    return _embedding_bag_dense_backward_cpu_max(
-        grad_, bag_size_, max_indices_, num_weights);
+    AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "embedding_bag_backward_max", [&] {
+        _embedding_bag_dense_backward_cpu_max<scalar_t>(
+            grad, bag_size_, max_indices_, index_grad_weight);
+    });
+    return index_grad_weight;
   }
   AT_ASSERT(mode == MODE_MEAN || mode == MODE_SUM);
 
-  auto index_grad_weight =
-      at::zeros({num_weights, grad.size(1)}, grad.options());
-
   AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "embedding_bag_backward", [&] {
       _embedding_bag_dense_backward_cpu_sum_mean<scalar_t>(
           grad, indices_, offsets_, offset2bag__, num_weights,
@@ -0,0 +1,100 @@
+#include <ATen/ATen.h>
+#include <ATen/native/ForeachUtils.h>
+
+namespace at { namespace native {
+
+// The slow route of the _foreach_* ops applies the corresponding op to each
+// tensor in turn, with the vectorized kernels of the op. It is used on CPU,
+// and on CUDA for the lists that the multi-tensor kernels don't handle.
+
+#define FOREACH_BINARY_OP_SCALAR(NAME, OP)                                              \
+std::vector<Tensor> foreach_tensor_##NAME##_scalar_kernel_slow(TensorList tensors, Scalar scalar) { \
+  check_foreach_api_restrictions(tensors);                                              \
+  std::vector<Tensor> result;                                                           \
+  result.reserve(tensors.size());                                                       \
+  for (const auto& t : tensors) {                                                       \
+    result.emplace_back(t.OP(scalar));                                                  \
+  }                                                                                     \
+  return result;                                                                        \
+}                                                                                       \
+                                                                                        \
+void foreach_tensor_##NAME##_scalar_kernel_slow_(TensorList tensors, Scalar scalar) {   \
+  check_foreach_api_restrictions(tensors);                                              \
+  for (auto& t : tensors) {                                                             \
+    t.OP##_(scalar);                                                                    \
+  }                                                                                     \
+}
+
+FOREACH_BINARY_OP_SCALAR(add, add)
+FOREACH_BINARY_OP_SCALAR(mul, mul)
+FOREACH_BINARY_OP_SCALAR(div, div)
+
+#undef FOREACH_BINARY_OP_SCALAR
+
+std::vector<Tensor> foreach_tensor_add_list_kernel_slow(TensorList tensors1, TensorList tensors2, Scalar alpha) {
+  check_foreach_api_restrictions(tensors1, tensors2);
+  std::vector<Tensor> result;
+  result.reserve(tensors1.size());
+  for (size_t i = 0; i < tensors1.size(); i++) {
+    result.emplace_back(tensors1[i].add(tensors2[i], alpha));
+  }
+  return result;
+}
+
+void foreach_tensor_add_list_kernel_slow_(TensorList self, TensorList other, Scalar alpha) {
+  check_foreach_api_restrictions(self, other);
+  for (size_t i = 0; i < self.size(); i++) {
+    self[i].add_(other[i], alpha);
+  }
+}
+
+std::vector<Tensor> foreach_tensor_sqrt_kernel_slow(TensorList tensors) {
+  check_foreach_api_restrictions(tensors);
+  std::vector<Tensor> result;
+  result.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    result.emplace_back(t.sqrt());
+  }
+  return result;
+}
+
+void foreach_tensor_sqrt_kernel_slow_(TensorList tensors) {
+  check_foreach_api_restrictions(tensors);
+  for (auto& t : tensors) {
+    t.sqrt_();
+  }
+}
+
+void foreach_tensor_addcmul_scalar_kernel_slow_(TensorList self, TensorList tensors1, TensorList tensors2, Scalar value) {
+  check_foreach_api_restrictions(self, tensors1, tensors2);
+  for (size_t i = 0; i < self.size(); i++) {
+    self[i].addcmul_(tensors1[i], tensors2[i], value);
+  }
+}
+
+void foreach_tensor_addcdiv_scalar_kernel_slow_(TensorList self, TensorList tensors1, TensorList tensors2, Scalar value) {
+  check_foreach_api_restrictions(self, tensors1, tensors2);
+  for (size_t i = 0; i < self.size(); i++) {
+    self[i].addcdiv_(tensors1[i], tensors2[i], value);
+  }
+}
+
+void foreach_tensor_mul_tensor_kernel_slow_(TensorList tensors, const Tensor& other) {
+  check_foreach_api_restrictions(tensors);
+  check_foreach_scalar_tensor(other);
+  for (auto& t : tensors) {
+    t.mul_(other.to(t.device()));
+  }
+}
+
+std::vector<Tensor> foreach_tensor_norm_slow(TensorList tensors, Scalar ord) {
+  check_foreach_api_restrictions(tensors);
+  std::vector<Tensor> result;
+  result.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    result.emplace_back(t.norm(ord));
+  }
+  return result;
+}
+
+}} // namespace at::native
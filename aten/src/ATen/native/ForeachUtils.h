@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at { namespace native {
+namespace {
+
+// Checks the preconditions of the _foreach_* ops, which hold for both the
+// slow (per-tensor) and the fast (multi-tensor) route.
+static inline void check_foreach_api_restrictions(TensorList tensors) {
+  TORCH_CHECK(tensors.size() > 0, "Tensor list must have at least one tensor.");
+}
+
+static inline void check_foreach_api_restrictions(TensorList tensors1, TensorList tensors2) {
+  check_foreach_api_restrictions(tensors1);
+  TORCH_CHECK(tensors1.size() == tensors2.size(),
+              "Tensor lists must have the same number of tensors, got ",
+              tensors1.size(), " and ", tensors2.size());
+  for (size_t i = 0; i < tensors1.size(); i++) {
+    TORCH_CHECK(tensors1[i].sizes() == tensors2[i].sizes(),
+                "Corresponding tensors in lists must have the same size, got ",
+                tensors1[i].sizes(), " and ", tensors2[i].sizes());
+  }
+}
+
+static inline void check_foreach_api_restrictions(TensorList tensors1, TensorList tensors2, TensorList tensors3) {
+  check_foreach_api_restrictions(tensors1, tensors2);
+  check_foreach_api_restrictions(tensors1, tensors3);
+}
+
+// The ops taking a scalar as a tensor, which can stay on the device, take a
+// single value.
+static inline void check_foreach_scalar_tensor(const Tensor& scalar) {
+  TORCH_CHECK(scalar.dim() == 0, "Expected a 0-dim tensor as the scalar, got a ",
+              scalar.dim(), "-dim tensor");
+}
+
+// Whether the tensors of all the lists can be processed by a single
+// multi-tensor kernel: they must be dense, contiguous, of the same floating
+// point dtype, and on the same CUDA device.
+static inline bool can_use_fast_route(std::initializer_list<TensorList> tensor_lists) {
+  const auto& first = tensor_lists.begin()->front();
+  if (!first.is_cuda() || !at::isFloatingType(first.scalar_type())) {
+    return false;
+  }
+  for (const auto& tensors : tensor_lists) {
+    for (const auto& t : tensors) {
+      if (t.layout() != at::kStrided ||
+          t.device() != first.device() ||
+          t.scalar_type() != first.scalar_type() ||
+          !t.is_contiguous()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// A Scalar can be applied on the fast route if it doesn't promote the dtype
+// of the tensors, i.e. if it isn't complex.
+static inline bool can_use_fast_route(std::initializer_list<TensorList> tensor_lists, Scalar scalar) {
+  return !scalar.isComplex() && can_use_fast_route(tensor_lists);
+}
+
+} // anonymous namespace
+}} // at::native
@@ -0,0 +1,306 @@
+#include <ATen/native/FusedCrossEntropy.h>
+
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/Reduction.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace at {
+namespace native {
+
+void check_fused_cross_entropy_inputs(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight /* optional */,
+    double label_smoothing) {
+  TORCH_CHECK(
+      self.dim() == 2,
+      "_fused_cross_entropy: expected self of size (N, C), but got ",
+      self.sizes());
+  TORCH_CHECK(
+      target.dim() == 1 && target.size(0) == self.size(0),
+      "_fused_cross_entropy: expected target of size (", self.size(0),
+      "), but got ", target.sizes());
+  TORCH_CHECK(
+      target.scalar_type() == kLong,
+      "_fused_cross_entropy: expected a Long target, but got ",
+      target.scalar_type());
+  TORCH_CHECK(
+      target.device() == self.device(),
+      "_fused_cross_entropy: expected target on ", self.device(),
+      ", but got ", target.device());
+  if (weight.defined()) {
+    TORCH_CHECK(
+        weight.dim() == 1 && weight.numel() == self.size(1),
+        "_fused_cross_entropy: expected weight of size (", self.size(1),
+        "), but got ", weight.sizes());
+    TORCH_CHECK(
+        weight.scalar_type() == self.scalar_type() &&
+            weight.device() == self.device(),
+        "_fused_cross_entropy: expected weight of the dtype and device of self");
+  }
+  TORCH_CHECK(
+      label_smoothing >= 0 && label_smoothing <= 1,
+      "_fused_cross_entropy: label_smoothing has to be between 0 and 1, but got ",
+      label_smoothing);
+}
+
+Tensor fused_cross_entropy_reduce(
+    const Tensor& losses,
+    const Tensor& row_weights,
+    int64_t reduction,
+    ScalarType dtype,
+    Tensor& total_weight) {
+  total_weight = row_weights.sum();
+  switch (reduction) {
+    case Reduction::None:
+      return losses.to(dtype);
+    case Reduction::Sum:
+      return losses.sum().to(dtype);
+    case Reduction::Mean:
+      return losses.sum().div_(total_weight).to(dtype);
+  }
+  TORCH_CHECK(false, "_fused_cross_entropy: invalid reduction ", reduction);
+}
+
+Tensor fused_cross_entropy_grad_scale(
+    const Tensor& grad_output,
+    const Tensor& total_weight,
+    int64_t reduction,
+    int64_t N,
+    ScalarType dtype) {
+  if (reduction == Reduction::None) {
+    TORCH_CHECK(
+        grad_output.dim() == 1 && grad_output.size(0) == N,
+        "_fused_cross_entropy_backward: expected grad_output of size (", N,
+        "), but got ", grad_output.sizes());
+    return grad_output.to(dtype).contiguous();
+  }
+  TORCH_CHECK(
+      grad_output.numel() == 1,
+      "_fused_cross_entropy_backward: expected a single element grad_output, but got ",
+      grad_output.sizes());
+  Tensor scale = grad_output.to(dtype).reshape({});
+  if (reduction == Reduction::Mean) {
+    scale = scale / total_weight.to(dtype);
+  }
+  return scale.expand({N}).contiguous();
+}
+
+namespace {
+
+template <typename scalar_t>
+void fused_cross_entropy_cpu_kernel(
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index,
+    double label_smoothing,
+    Tensor& losses,
+    Tensor& row_weights,
+    Tensor& lse) {
+  using acc_t = acc_type<scalar_t, false>;
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t* target_data = target.data_ptr<int64_t>();
+  const scalar_t* weight_data =
+      weight.defined() ? weight.data_ptr<scalar_t>() : nullptr;
+  acc_t* losses_data = losses.data_ptr<acc_t>();
+  acc_t* row_weights_data = row_weights.data_ptr<acc_t>();
+  acc_t* lse_data = lse.data_ptr<acc_t>();
+  const acc_t eps = static_cast<acc_t>(label_smoothing);
+  acc_t weight_sum = static_cast<acc_t>(C);
+  if (weight_data != nullptr) {
+    weight_sum = 0;
+    for (int64_t c = 0; c < C; ++c) {
+      weight_sum += static_cast<acc_t>(weight_data[c]);
+    }
+  }
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(C, 1));
+  at::parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const scalar_t* x = input_data + i * C;
+      acc_t max = -std::numeric_limits<acc_t>::infinity();
+      for (int64_t c = 0; c < C; ++c) {
+        max = std::max(max, static_cast<acc_t>(x[c]));
+      }
+      acc_t sum = 0;
+      acc_t weighted_x_sum = 0;
+      for (int64_t c = 0; c < C; ++c) {
+        const acc_t v = static_cast<acc_t>(x[c]);
+        sum += std::exp(v - max);
+        if (eps != 0) {
+          weighted_x_sum +=
+              weight_data == nullptr ? v : static_cast<acc_t>(weight_data[c]) * v;
+        }
+      }
+      const acc_t row_lse = max + std::log(sum);
+      lse_data[i] = row_lse;
+
+      const int64_t t = target_data[i];
+      if (t == ignore_index) {
+        losses_data[i] = 0;
+        row_weights_data[i] = 0;
+        continue;
+      }
+      TORCH_CHECK_INDEX(
+          t >= 0 && t < C,
+          "_fused_cross_entropy: target ", t, " is out of bounds");
+      const acc_t w_t =
+          weight_data == nullptr ? acc_t(1) : static_cast<acc_t>(weight_data[t]);
+      acc_t loss = -(1 - eps) * w_t * (static_cast<acc_t>(x[t]) - row_lse);
+      if (eps != 0) {
+        loss -= eps / C * (weighted_x_sum - row_lse * weight_sum);
+      }
+      losses_data[i] = loss;
+      row_weights_data[i] = w_t;
+    }
+  });
+}
+
+template <typename scalar_t>
+void fused_cross_entropy_backward_cpu_kernel(
+    const Tensor& grad_scale,
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index,
+    double label_smoothing,
+    const Tensor& lse,
+    Tensor& grad_input) {
+  using acc_t = acc_type<scalar_t, false>;
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  const acc_t* grad_scale_data = grad_scale.data_ptr<acc_t>();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t* target_data = target.data_ptr<int64_t>();
+  const scalar_t* weight_data =
+      weight.defined() ? weight.data_ptr<scalar_t>() : nullptr;
+  const acc_t* lse_data = lse.data_ptr<acc_t>();
+  scalar_t* grad_input_data = grad_input.data_ptr<scalar_t>();
+  const acc_t eps = static_cast<acc_t>(label_smoothing);
+  acc_t weight_sum = static_cast<acc_t>(C);
+  if (weight_data != nullptr) {
+    weight_sum = 0;
+    for (int64_t c = 0; c < C; ++c) {
+      weight_sum += static_cast<acc_t>(weight_data[c]);
+    }
+  }
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(C, 1));
+  at::parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const scalar_t* x = input_data + i * C;
+      scalar_t* dx = grad_input_data + i * C;
+      const int64_t t = target_data[i];
+      if (t == ignore_index) {
+        std::fill(dx, dx + C, scalar_t(0));
+        continue;
+      }
+      TORCH_CHECK_INDEX(
+          t >= 0 && t < C,
+          "_fused_cross_entropy_backward: target ", t, " is out of bounds");
+      const acc_t g = grad_scale_data[i];
+      const acc_t w_t =
+          weight_data == nullptr ? acc_t(1) : static_cast<acc_t>(weight_data[t]);
+      // Coefficient of the softmax in the gradient.
+      const acc_t softmax_coef = (1 - eps) * w_t + eps / C * weight_sum;
+      const acc_t row_lse = lse_data[i];
+      for (int64_t c = 0; c < C; ++c) {
+        acc_t d = softmax_coef * std::exp(static_cast<acc_t>(x[c]) - row_lse);
+        if (eps != 0) {
+          d -= eps / C *
+              (weight_data == nullptr ? acc_t(1)
+                                      : static_cast<acc_t>(weight_data[c]));
+        }
+        if (c == t) {
+          d -= (1 - eps) * w_t;
+        }
+        dx[c] = static_cast<scalar_t>(g * d);
+      }
+    }
+  });
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor, Tensor> fused_cross_entropy_cpu(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight /* optional */,
+    int64_t reduction,
+    int64_t ignore_index,
+    double label_smoothing) {
+  check_fused_cross_entropy_inputs(self, target, weight, label_smoothing);
+  const Tensor input = self.contiguous();
+  const Tensor target_ = target.contiguous();
+  const Tensor weight_ = weight.defined() ? weight.contiguous() : weight;
+  const int64_t N = input.size(0);
+  Tensor output, lse, total_weight;
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      self.scalar_type(),
+      "fused_cross_entropy_cpu",
+      [&] {
+        using acc_t = acc_type<scalar_t, false>;
+        const auto acc_options =
+            self.options().dtype(caffe2::TypeMeta::Make<acc_t>());
+        Tensor losses = at::empty({N}, acc_options);
+        Tensor row_weights = at::empty({N}, acc_options);
+        lse = at::empty({N}, acc_options);
+        if (N > 0) {
+          fused_cross_entropy_cpu_kernel<scalar_t>(
+              input, target_, weight_, ignore_index, label_smoothing,
+              losses, row_weights, lse);
+        }
+        output = fused_cross_entropy_reduce(
+            losses, row_weights, reduction, self.scalar_type(), total_weight);
+      });
+  return std::make_tuple(output, lse, total_weight);
+}
+
+Tensor fused_cross_entropy_backward_cpu(
+    const Tensor& grad_output,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight /* optional */,
+    int64_t reduction,
+    int64_t ignore_index,
+    double label_smoothing,
+    const Tensor& lse,
+    const Tensor& total_weight) {
+  check_fused_cross_entropy_inputs(self, target, weight, label_smoothing);
+  const Tensor input = self.contiguous();
+  const Tensor target_ = target.contiguous();
+  const Tensor weight_ = weight.defined() ? weight.contiguous() : weight;
+  const int64_t N = input.size(0);
+  Tensor grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      self.scalar_type(),
+      "fused_cross_entropy_backward_cpu",
+      [&] {
+        using acc_t = acc_type<scalar_t, false>;
+        const ScalarType acc_scalar_type =
+            typeMetaToScalarType(caffe2::TypeMeta::Make<acc_t>());
+        const Tensor grad_scale = fused_cross_entropy_grad_scale(
+            grad_output, total_weight, reduction, N, acc_scalar_type);
+        if (N > 0) {
+          fused_cross_entropy_backward_cpu_kernel<scalar_t>(
+              grad_scale, input, target_, weight_, ignore_index,
+              label_smoothing, lse.to(acc_scalar_type).contiguous(), grad_input);
+        }
+      });
+  return grad_input;
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// _fused_cross_entropy computes
+//   nll_loss(log_softmax(self, 1), target, weight, reduction, ignore_index)
+// for self of size (N, C), with label smoothing, in a single pass over each
+// row and without storing the log-probabilities. With label smoothing eps,
+// the loss of a row x with target t is
+//   -(1 - eps) * w[t] * logp[t] - eps / C * sum_c w[c] * logp[c]
+// where logp = x - lse(x) and w is all ones without weight. Rows whose target
+// is ignore_index have a loss of 0. The mean reduction divides by
+// total_weight, the sum of w[t] over the rows that are not ignored.
+//
+// The gradient of the loss of a row is
+//   (1 - eps) * w[t] * (softmax(x) - onehot(t)) + eps / C * (W * softmax(x) - w)
+// where W = sum_c w[c], so that the backward only needs the log-sum-exp lse
+// of each row, which the forward returns.
+
+void check_fused_cross_entropy_inputs(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight /* optional */,
+    double label_smoothing);
+
+// Reduces the losses of the rows, and sets total_weight from the weights
+// w[t] of the rows.
+Tensor fused_cross_entropy_reduce(
+    const Tensor& losses,
+    const Tensor& row_weights,
+    int64_t reduction,
+    ScalarType dtype,
+    Tensor& total_weight);
+
+// The factor of the gradient of the loss of each row: grad_output, divided by
+// total_weight for the mean reduction, as a tensor of N elements of dtype.
+Tensor fused_cross_entropy_grad_scale(
+    const Tensor& grad_output,
+    const Tensor& total_weight,
+    int64_t reduction,
+    int64_t N,
+    ScalarType dtype);
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,190 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+
+#include <caffe2/perfkernels/adagrad.h>
+#include <caffe2/perfkernels/adam.h>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+// Optimizer steps that update the rows of an embedding table in place from
+// the gradient of embedding / embedding_bag with sparse=True, given as its
+// row indices and values (grad._indices()[0] and grad._values()), without
+// coalescing it into a SparseTensor first.
+
+namespace at {
+namespace native {
+
+namespace {
+
+// Rows of the gradient grouped by the row of the table they update.
+struct SparseRows {
+  // Positions of the gradient rows, sorted by index
+  Tensor perm;
+  // Unique rows of the table to update, in increasing order
+  std::vector<int64_t> rows;
+  // The gradient rows of rows[i] are perm[starts[i]:starts[i + 1]]
+  std::vector<int64_t> starts;
+};
+
+void check_sparse_update(
+    const char* fn,
+    const Tensor& self,
+    const Tensor& state,
+    const char* state_name,
+    const Tensor& indices,
+    const Tensor& grad) {
+  TORCH_CHECK(
+      self.dim() == 2 && self.scalar_type() == kFloat && self.is_contiguous(),
+      fn, ": expected self to be a contiguous 2-D float tensor");
+  TORCH_CHECK(
+      state.sizes() == self.sizes() && state.scalar_type() == kFloat &&
+          state.is_contiguous(),
+      fn, ": expected ", state_name,
+      " to be a contiguous float tensor of the size of self");
+  TORCH_CHECK(
+      indices.dim() == 1 && isIntegralType(indices.scalar_type(), false),
+      fn, ": expected indices to be a 1-D integer tensor");
+  TORCH_CHECK(
+      grad.dim() == 2 && grad.scalar_type() == kFloat &&
+          grad.size(0) == indices.numel() && grad.size(1) == self.size(1),
+      fn, ": expected grad to be a float tensor of size (indices.numel(), ",
+      self.size(1), "), but got ", grad.sizes());
+}
+
+// The sort is a parallel radix sort on large inputs, see SortingKernel.cpp.
+SparseRows group_sparse_rows(const Tensor& indices, int64_t num_rows) {
+  SparseRows result;
+  Tensor sorted;
+  std::tie(sorted, result.perm) = indices.to(kLong).sort();
+  const int64_t n = sorted.numel();
+  const auto* sorted_data = sorted.data_ptr<int64_t>();
+  TORCH_CHECK(
+      sorted_data[0] >= 0 && sorted_data[n - 1] < num_rows,
+      "index out of range: rows of self go from 0 to ", num_rows - 1,
+      ", but got ", sorted_data[0] < 0 ? sorted_data[0] : sorted_data[n - 1]);
+  for (int64_t i = 0; i < n; i++) {
+    if (i == 0 || sorted_data[i] != sorted_data[i - 1]) {
+      result.rows.push_back(sorted_data[i]);
+      result.starts.push_back(i);
+    }
+  }
+  result.starts.push_back(n);
+  return result;
+}
+
+// Calls update(u, w, g, next_w) for each unique row u of the gradient, with
+// its row of the table, the sum of its gradient rows, and the row of the table
+// updated next by the same thread, for prefetching. Unique rows are split
+// across threads, so each row of the table is written by a single thread.
+template <typename update_t>
+void apply_sparse_rows(
+    const Tensor& self,
+    const SparseRows& sparse,
+    const Tensor& grad,
+    const update_t& update) {
+  const int64_t dim = self.size(1);
+  auto* self_data = self.data_ptr<float>();
+  const auto* grad_data = grad.data_ptr<float>();
+  const auto* perm_data = sparse.perm.data_ptr<int64_t>();
+  const int64_t num_unique = sparse.rows.size();
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(dim, 1));
+  at::parallel_for(0, num_unique, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> grad_sum;
+    for (int64_t u = begin; u < end; u++) {
+      const int64_t start = sparse.starts[u];
+      const int64_t count = sparse.starts[u + 1] - start;
+      const float* g = grad_data + perm_data[start] * dim;
+      if (count > 1) {
+        grad_sum.assign(g, g + dim);
+        for (int64_t k = 1; k < count; k++) {
+          const float* gk = grad_data + perm_data[start + k] * dim;
+          for (int64_t j = 0; j < dim; j++) {
+            grad_sum[j] += gk[j];
+          }
+        }
+        g = grad_sum.data();
+      }
+      const int64_t next = sparse.rows[u + 1 < end ? u + 1 : u];
+      update(
+          sparse.rows[u],
+          self_data + sparse.rows[u] * dim,
+          g,
+          self_data + next * dim);
+    }
+  });
+}
+
+} // namespace
+
+Tensor& fused_sparse_adagrad_cpu_(
+    Tensor& self,
+    Tensor& state_sum,
+    const Tensor& indices,
+    const Tensor& grad,
+    double lr,
+    double eps) {
+  check_sparse_update(
+      "_fused_sparse_adagrad_", self, state_sum, "state_sum", indices, grad);
+  if (indices.numel() == 0) {
+    return self;
+  }
+  const auto sparse = group_sparse_rows(indices, self.size(0));
+  const int64_t dim = self.size(1);
+  auto* self_data = self.data_ptr<float>();
+  auto* state_data = state_sum.data_ptr<float>();
+  apply_sparse_rows(
+      self, sparse, grad.contiguous(),
+      [&](int64_t row, float* w, const float* g, float* w_n) {
+        float* h = state_data + row * dim;
+        float* h_n = state_data + (w_n - self_data);
+        // perfkernels add lr times the normalized gradient
+        caffe2::adagrad_update_prefetch(
+            dim, w, w_n, g, h, h_n, w, w_n, h, h_n, eps, -lr);
+      });
+  return self;
+}
+
+Tensor& fused_sparse_adam_cpu_(
+    Tensor& self,
+    Tensor& exp_avg,
+    Tensor& exp_avg_sq,
+    const Tensor& indices,
+    const Tensor& grad,
+    int64_t step,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps) {
+  check_sparse_update(
+      "_fused_sparse_adam_", self, exp_avg, "exp_avg", indices, grad);
+  check_sparse_update(
+      "_fused_sparse_adam_", self, exp_avg_sq, "exp_avg_sq", indices, grad);
+  TORCH_CHECK(step >= 1, "_fused_sparse_adam_: expected step >= 1, got ", step);
+  if (indices.numel() == 0) {
+    return self;
+  }
+  const auto sparse = group_sparse_rows(indices, self.size(0));
+  const int64_t dim = self.size(1);
+  auto* m_data = exp_avg.data_ptr<float>();
+  auto* v_data = exp_avg_sq.data_ptr<float>();
+  // Same bias correction as optim.SparseAdam
+  const double step_size = lr * std::sqrt(1 - std::pow(beta2, step)) /
+      (1 - std::pow(beta1, step));
+  apply_sparse_rows(
+      self, sparse, grad.contiguous(),
+      [&](int64_t row, float* w, const float* g, float* /* w_n */) {
+        float* m = m_data + row * dim;
+        float* v = v_data + row * dim;
+        caffe2::adam_update(
+            dim, w, g, m, v, w, m, v, beta1, beta2, eps, -step_size);
+      });
+  return self;
+}
+
+} // namespace native
+} // namespace at
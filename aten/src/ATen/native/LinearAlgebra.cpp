@@ -7,6 +7,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/LegacyTHFunctionsCPU.h>
 #include <ATen/core/grad_mode.h>
+#include <TH/THBlasUtils.h>
 #include <functional>
 #include <numeric>
 #include <vector>
@@ -247,14 +248,57 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
     });
 }
 
+// Computes bmm/baddbmm with one single threaded gemm per matrix, the batch
+// being distributed over threads. Rows of the matrices of batch1, batch2 and
+// result must be contiguous or their columns must be, and rows of result must
+// be.
+template <typename scalar_t>
+static void baddbmm_parallel_over_batch(const Tensor& result, const Tensor& batch1, const Tensor& batch2, scalar_t beta, scalar_t alpha) {
+  // BLAS sees the row major matrices as their transposes, so it computes
+  // result^T = batch2^T * batch1^T.
+  auto blas_layout = [](const Tensor& t, char& trans, int64_t& ld) {
+    if (t.stride(2) == 1 && t.stride(1) >= t.size(2)) {
+      trans = 'n';
+      ld = t.stride(1);
+    } else {
+      trans = 't';
+      ld = t.stride(2);
+    }
+  };
+  char trans1, trans2;
+  int64_t ld1, ld2;
+  blas_layout(batch1, trans1, ld1);
+  blas_layout(batch2, trans2, ld2);
+
+  const int64_t m = result.size(1);
+  const int64_t n = result.size(2);
+  const int64_t k = batch1.size(2);
+  scalar_t* r = result.data_ptr<scalar_t>();
+  scalar_t* b1 = batch1.data_ptr<scalar_t>();
+  scalar_t* b2 = batch2.data_ptr<scalar_t>();
+  // Within a parallel region, gemm runs on the calling thread.
+  at::parallel_for(0, result.size(0), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      THBlas_gemm<scalar_t>(
+          trans2, trans1, n, m, k,
+          alpha, b2 + b * batch2.stride(0), ld2,
+          b1 + b * batch1.stride(0), ld1,
+          beta, r + b * result.stride(0), result.stride(1));
+    }
+  });
+}
+
 // This tries to apply some optimizations to bmm/baddbmm:
 // - When the operand size is small, computation are parallelized over the batch
 //   dimension using OMP and naive matrix multiplication is applied.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
-// - Otherwise, we use a series of matrix multiplications.
+// - Otherwise, when there are at least as many matrices as threads and they are
+//   small enough that a single gemm would hardly scale over the threads, the
+//   batch is distributed over threads with a single threaded gemm per matrix.
+// - Otherwise, we use a series of matrix multiplications, each one parallelized by gemm.
 // The threshold of 400 for the first has not been thoroughly benchmarked yet and may have room for further
 // optimization, it likely depends on the characteristics of the CPU, MKL will be different from non-MKL etc.,
-// but this seems to be a first starting point.
+// but this seems to be a first starting point. The same goes for the threshold of 128^3 of the third.
 
 static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor& batch1, const Tensor& batch2, Scalar beta, Scalar alpha, bool is_bmm_out) {
   // is_bmm_out: true for bmm_out, false for baddbmm_
@@ -298,7 +342,12 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
             || (t.stride(1) == 1 && t.stride(2) >= t.size(1));
   };
 
-  if (contraction_size * res_rows * res_cols < 400) {
+  // BFloat16 has neither an MKL batched gemm nor a small-size kernel that
+  // accumulates in float, so it is split along the batch dimension and each
+  // matrix goes through the float-accumulating gemm of addmm.
+  const bool is_bfloat16 = self_or_result.scalar_type() == at::kBFloat16;
+
+  if (contraction_size * res_rows * res_cols < 400 && !is_bfloat16) {
     if (is_bmm_out) {
       AT_DISPATCH_ALL_TYPES(batch1.scalar_type(), "bmm", [&] {
           baddbmm_cpu_kernel<scalar_t, true>(self_or_result, batch1, batch2, beta, alpha);
@@ -308,11 +357,24 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
           baddbmm_cpu_kernel<scalar_t, false>(self_or_result, batch1, batch2, beta, alpha);
         });
     }
-  } else if (at::hasMKL() && at::native::is_floating_point(self_or_result)
+  } else if (at::hasMKL() && at::native::is_floating_point(self_or_result) && !is_bfloat16
             && batch_items_contiguous_or_transposed(batch1)
             && batch_items_contiguous_or_transposed(batch2)
             && self_or_result.is_contiguous()) {
     at::native::_baddbmm_mkl_(self_or_result, batch1, batch2, beta, alpha);
+  } else if (at::native::is_floating_point(self_or_result) && !is_bfloat16
+            && bs >= at::get_num_threads()
+            && contraction_size * res_rows * res_cols <= 128 * 128 * 128
+            && batch_items_contiguous_or_transposed(batch1)
+            && batch_items_contiguous_or_transposed(batch2)
+            && self_or_result.stride(2) == 1 && self_or_result.stride(1) >= res_cols) {
+    AT_DISPATCH_FLOATING_TYPES(batch1.scalar_type(), "baddbmm_parallel_over_batch", [&] {
+      // As in BLAS, result is not read when beta is 0, which bmm relies on.
+      baddbmm_parallel_over_batch<scalar_t>(
+          self_or_result, batch1, batch2,
+          is_bmm_out ? scalar_t(0) : beta.to<scalar_t>(),
+          is_bmm_out ? scalar_t(1) : alpha.to<scalar_t>());
+    });
   } else { // split along batch dimension
     if (is_bmm_out) {
       for (int64_t b = 0; b < bs; b++) {
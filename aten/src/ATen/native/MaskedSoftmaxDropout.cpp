@@ -0,0 +1,252 @@
+#include <ATen/native/MaskedSoftmaxDropout.h>
+
+#include <ATen/AccumulateType.h>
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/WrapDimUtils.h>
+
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <tuple>
+
+namespace at {
+namespace native {
+
+MaskedSoftmaxRows masked_softmax_rows(
+    const Tensor& self,
+    const Tensor& mask /* optional */,
+    int64_t dim) {
+  TORCH_CHECK(
+      self.dim() > 0,
+      "_masked_softmax_dropout: expected a tensor with at least one dimension");
+  dim = maybe_wrap_dim(dim, self.dim());
+  MaskedSoftmaxRows rows;
+  const Tensor self_t = self.transpose(dim, -1);
+  rows.input = self_t.contiguous();
+  rows.sizes = self_t.sizes().vec();
+  rows.N = self.size(dim);
+  rows.M = 1;
+  for (int64_t d = 0; d < self.dim() - 1; ++d) {
+    rows.M *= rows.sizes[d];
+  }
+  if (mask.defined()) {
+    TORCH_CHECK(
+        mask.scalar_type() == kBool,
+        "_masked_softmax_dropout: expected a bool mask, but got ",
+        mask.scalar_type());
+    TORCH_CHECK(
+        mask.device() == self.device(),
+        "_masked_softmax_dropout: expected the mask on ", self.device(),
+        ", but got ", mask.device());
+    rows.mask = mask.expand(self.sizes()).transpose(dim, -1);
+    rows.mask_stride = rows.mask.stride(-1);
+    // Broadcast dims of the mask have stride 0, so the offsets of its rows
+    // are not a multiple of the row index in general.
+    const std::vector<int64_t> outer_sizes(
+        rows.sizes.begin(), rows.sizes.end() - 1);
+    Tensor offsets = at::zeros(outer_sizes, self.options().dtype(kLong));
+    for (int64_t d = 0; d < self.dim() - 1; ++d) {
+      std::vector<int64_t> shape(self.dim() - 1, 1);
+      shape[d] = rows.sizes[d];
+      offsets.add_(at::arange(rows.sizes[d], offsets.options())
+                       .mul_(rows.mask.stride(d))
+                       .view(shape));
+    }
+    rows.mask_offsets = offsets.view({rows.M});
+  }
+  return rows;
+}
+
+Tensor masked_softmax_unrows(
+    const Tensor& result,
+    const MaskedSoftmaxRows& rows,
+    int64_t dim) {
+  dim = maybe_wrap_dim(dim, static_cast<int64_t>(rows.sizes.size()));
+  return result.view(rows.sizes).transpose(dim, -1);
+}
+
+void check_masked_softmax_dropout_p(double p) {
+  TORCH_CHECK(
+      p >= 0 && p <= 1,
+      "dropout probability has to be between 0 and 1, but got ", p);
+}
+
+namespace {
+
+template <typename scalar_t>
+void masked_softmax_dropout_cpu_kernel(
+    const MaskedSoftmaxRows& rows,
+    double p,
+    uint64_t seed,
+    uint64_t offset,
+    Tensor& output,
+    Tensor& softmax) {
+  using acc_t = acc_type<scalar_t, false>;
+  const int64_t N = rows.N;
+  const scalar_t* input_data = rows.input.data_ptr<scalar_t>();
+  const bool* mask_data =
+      rows.mask.defined() ? rows.mask.data_ptr<bool>() : nullptr;
+  const int64_t* mask_offsets =
+      rows.mask.defined() ? rows.mask_offsets.data_ptr<int64_t>() : nullptr;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  scalar_t* softmax_data = softmax.data_ptr<scalar_t>();
+  const uint64_t threshold = masked_softmax_dropout_threshold(p);
+  const acc_t scale = p < 1 ? static_cast<acc_t>(1 / (1 - p)) : acc_t(0);
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(N, 1));
+  at::parallel_for(0, rows.M, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> buffer(N);
+    for (int64_t i = begin; i < end; ++i) {
+      const scalar_t* x = input_data + i * N;
+      const bool* m =
+          mask_data == nullptr ? nullptr : mask_data + mask_offsets[i];
+      acc_t max = -std::numeric_limits<acc_t>::infinity();
+      for (int64_t j = 0; j < N; ++j) {
+        buffer[j] = (m != nullptr && m[j * rows.mask_stride])
+            ? -std::numeric_limits<acc_t>::infinity()
+            : static_cast<acc_t>(x[j]);
+        max = std::max(max, buffer[j]);
+      }
+      acc_t sum = 0;
+      for (int64_t j = 0; j < N; ++j) {
+        buffer[j] = std::exp(buffer[j] - max);
+        sum += buffer[j];
+      }
+      for (int64_t j4 = 0; j4 * 4 < N; ++j4) {
+        bool keep[4];
+        masked_softmax_dropout_keep4(seed, offset, i, j4, threshold, keep);
+        for (int64_t k = 0; k < 4 && j4 * 4 + k < N; ++k) {
+          const int64_t j = j4 * 4 + k;
+          const acc_t s = buffer[j] / sum;
+          softmax_data[i * N + j] = static_cast<scalar_t>(s);
+          output_data[i * N + j] =
+              static_cast<scalar_t>(keep[k] ? s * scale : acc_t(0));
+        }
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void masked_softmax_dropout_backward_cpu_kernel(
+    const Tensor& grad_output,
+    const Tensor& softmax,
+    int64_t M,
+    int64_t N,
+    double p,
+    uint64_t seed,
+    uint64_t offset,
+    Tensor& grad_input) {
+  using acc_t = acc_type<scalar_t, false>;
+  const scalar_t* grad_data = grad_output.data_ptr<scalar_t>();
+  const scalar_t* softmax_data = softmax.data_ptr<scalar_t>();
+  scalar_t* grad_input_data = grad_input.data_ptr<scalar_t>();
+  const uint64_t threshold = masked_softmax_dropout_threshold(p);
+  const acc_t scale = p < 1 ? static_cast<acc_t>(1 / (1 - p)) : acc_t(0);
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(N, 1));
+  at::parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+    // Gradient of the softmax, i.e. grad_output through the dropout
+    std::vector<acc_t> buffer(N);
+    for (int64_t i = begin; i < end; ++i) {
+      const scalar_t* dy = grad_data + i * N;
+      const scalar_t* s = softmax_data + i * N;
+      acc_t dot = 0;
+      for (int64_t j4 = 0; j4 * 4 < N; ++j4) {
+        bool keep[4];
+        masked_softmax_dropout_keep4(seed, offset, i, j4, threshold, keep);
+        for (int64_t k = 0; k < 4 && j4 * 4 + k < N; ++k) {
+          const int64_t j = j4 * 4 + k;
+          buffer[j] = keep[k] ? static_cast<acc_t>(dy[j]) * scale : acc_t(0);
+          dot += buffer[j] * static_cast<acc_t>(s[j]);
+        }
+      }
+      for (int64_t j = 0; j < N; ++j) {
+        grad_input_data[i * N + j] = static_cast<scalar_t>(
+            static_cast<acc_t>(s[j]) * (buffer[j] - dot));
+      }
+    }
+  });
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor, Tensor> masked_softmax_dropout_cpu(
+    const Tensor& self,
+    const Tensor& mask /* optional */,
+    int64_t dim,
+    double p,
+    c10::optional<Generator> gen_) {
+  check_masked_softmax_dropout_p(p);
+  const MaskedSoftmaxRows rows = masked_softmax_rows(self, mask, dim);
+  Tensor output = at::empty_like(rows.input);
+  Tensor softmax = at::empty_like(rows.input);
+  uint64_t seed;
+  {
+    auto gen = get_generator_or_default<CPUGeneratorImpl>(
+        gen_, detail::getDefaultCPUGenerator());
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    seed = gen->random64();
+  }
+  Tensor rng_state = at::empty({2}, self.options().dtype(kLong));
+  rng_state.data_ptr<int64_t>()[0] = static_cast<int64_t>(seed);
+  rng_state.data_ptr<int64_t>()[1] = 0;
+  if (rows.M > 0 && rows.N > 0) {
+    AT_DISPATCH_FLOATING_TYPES_AND(
+        at::ScalarType::BFloat16,
+        self.scalar_type(),
+        "masked_softmax_dropout_cpu",
+        [&] {
+          masked_softmax_dropout_cpu_kernel<scalar_t>(
+              rows, p, seed, /*offset=*/0, output, softmax);
+        });
+  }
+  return std::make_tuple(
+      masked_softmax_unrows(output, rows, dim),
+      masked_softmax_unrows(softmax, rows, dim),
+      rng_state);
+}
+
+Tensor masked_softmax_dropout_backward_cpu(
+    const Tensor& grad_output,
+    const Tensor& softmax,
+    const Tensor& rng_state,
+    int64_t dim,
+    double p) {
+  check_masked_softmax_dropout_p(p);
+  TORCH_CHECK(
+      rng_state.numel() == 2 && rng_state.scalar_type() == kLong,
+      "_masked_softmax_dropout_backward: expected the rng_state returned by ",
+      "_masked_softmax_dropout");
+  TORCH_CHECK(
+      grad_output.sizes() == softmax.sizes(),
+      "_masked_softmax_dropout_backward: expected grad_output of size ",
+      softmax.sizes(), ", but got ", grad_output.sizes());
+  dim = maybe_wrap_dim(dim, grad_output.dim());
+  const Tensor grad_t = grad_output.transpose(dim, -1).contiguous();
+  const Tensor softmax_t = softmax.transpose(dim, -1).contiguous();
+  const int64_t N = grad_t.size(-1);
+  const int64_t M = N == 0 ? 0 : grad_t.numel() / N;
+  const Tensor state = rng_state.contiguous();
+  const auto seed = static_cast<uint64_t>(state.data_ptr<int64_t>()[0]);
+  const auto offset = static_cast<uint64_t>(state.data_ptr<int64_t>()[1]);
+  Tensor grad_input = at::empty_like(grad_t);
+  if (M > 0) {
+    AT_DISPATCH_FLOATING_TYPES_AND(
+        at::ScalarType::BFloat16,
+        grad_t.scalar_type(),
+        "masked_softmax_dropout_backward_cpu",
+        [&] {
+          masked_softmax_dropout_backward_cpu_kernel<scalar_t>(
+              grad_t, softmax_t, M, N, p, seed, offset, grad_input);
+        });
+  }
+  return grad_input.transpose(dim, -1);
+}
+
+} // namespace native
+} // namespace at
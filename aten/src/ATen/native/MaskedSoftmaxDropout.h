@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/core/PhiloxRNGEngine.h>
+
+#include <vector>
+
+namespace at {
+namespace native {
+
+// _masked_softmax_dropout computes
+//   dropout(softmax(self.masked_fill(mask, -inf), dim), p)
+// reading self and the mask once, without storing the dropout mask. The
+// random numbers come from a Philox engine with the seed and offset saved in
+// rng_state, so that the backward draws them again. The element of column j
+// of row i (along dim) is kept if the number j % 4 of the 4 numbers at offset
+// rng_state[1] / 4 + j / 4 of subsequence i is less than (1 - p) * 2^32,
+// which is the same on CPU and CUDA.
+
+// The rows along dim of self and of its (broadcast) mask.
+struct MaskedSoftmaxRows {
+  // self with dim moved last, contiguous
+  Tensor input;
+  // self.sizes() with dim moved last, to view the results of the rows
+  std::vector<int64_t> sizes;
+  // Mask expanded to self and with dim moved last, undefined without mask
+  Tensor mask;
+  // Offset in mask of each row, and stride of mask along the rows
+  Tensor mask_offsets;
+  int64_t mask_stride = 0;
+  int64_t M = 0;
+  int64_t N = 0;
+};
+
+MaskedSoftmaxRows masked_softmax_rows(
+    const Tensor& self,
+    const Tensor& mask /* optional */,
+    int64_t dim);
+
+// Moves the last dim of the result of a row-wise kernel back to dim.
+Tensor masked_softmax_unrows(
+    const Tensor& result,
+    const MaskedSoftmaxRows& rows,
+    int64_t dim);
+
+void check_masked_softmax_dropout_p(double p);
+
+// Threshold below which a 32 bit random number keeps its element, which is
+// 2^32 for p = 0 and 0 for p = 1.
+inline uint64_t masked_softmax_dropout_threshold(double p) {
+  return static_cast<uint64_t>((1.0 - p) * 4294967296.0);
+}
+
+// Keep flags of columns 4 * j4 to 4 * j4 + 3 of row i.
+C10_HOST_DEVICE inline void masked_softmax_dropout_keep4(
+    uint64_t seed,
+    uint64_t offset,
+    int64_t i,
+    int64_t j4,
+    uint64_t threshold,
+    bool keep[4]) {
+  at::philox_engine engine(seed, i, offset / 4 + j4);
+#pragma unroll
+  for (int k = 0; k < 4; ++k) {
+    keep[k] = static_cast<uint64_t>(engine()) < threshold;
+  }
+}
+
+} // namespace native
+} // namespace at
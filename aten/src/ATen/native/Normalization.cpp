@@ -4,6 +4,7 @@
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/Config.h>
+#include <ATen/core/grad_mode.h>
 
 #include <ATen/detail/CUDAHooksInterface.h>
 #include <ATen/native/TensorIterator.h>
@@ -17,6 +18,10 @@ static const int MIOPEN_DIM_MAX = 5;
 namespace at { namespace native {
 
 DEFINE_DISPATCH(batch_norm_cpu_inference_contiguous_stub);
+DEFINE_DISPATCH(batch_norm_relu_cpu_inference_stub);
+DEFINE_DISPATCH(batch_norm_cpu_channels_last_transform_stub);
+DEFINE_DISPATCH(batch_norm_cpu_channels_last_collect_stats_stub);
+DEFINE_DISPATCH(batch_norm_cpu_channels_last_backward_stub);
 
 namespace {
   void check_dims_match_num_input_features(const char* arg_name, int64_t expected, int64_t actual){
@@ -32,6 +37,14 @@ namespace {
   }
 }
 
+// Whether to use the kernels vectorized over the channels, which see the
+// input as a matrix of channels last rows.
+static inline bool batch_norm_use_channels_last_kernels(const Tensor& input) {
+  return input.dim() == 4
+      && input.suggest_memory_format() == at::MemoryFormat::ChannelsLast
+      && input.is_contiguous(at::MemoryFormat::ChannelsLast);
+}
+
 // TensorAccessor when it is defined to work around undefined...
 template <typename scalar_t>
 static TensorAccessor<scalar_t, 1> conditional_accessor_1d(const Tensor& t) {
@@ -175,6 +188,14 @@ std::tuple<Tensor,Tensor,Tensor> batch_norm_cpu_transform_input_template(
     return std::make_tuple(output, save_mean, save_invstd);
   }
 
+  // Vectorized path for channels last inputs in training mode
+  if (train && batch_norm_use_channels_last_kernels(input)) {
+    Tensor output = at::empty_like(input, at::MemoryFormat::ChannelsLast);
+    batch_norm_cpu_channels_last_transform_stub(kCPU, output, input, weight,
+        bias, save_mean, save_invstd);
+    return std::make_tuple(output, save_mean, save_invstd);
+  }
+
   Tensor output = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
 
   int64_t n_input = input.size(1);
@@ -230,6 +251,25 @@ std::tuple<Tensor,Tensor> batch_norm_cpu_update_stats_template(
   auto running_mean_a = conditional_accessor_1d<scalar_t>(running_mean);
   auto running_var_a = conditional_accessor_1d<scalar_t>(running_var);
 
+  if (batch_norm_use_channels_last_kernels(input)) {
+    Tensor var_sum = at::empty({n_input}, input.options());
+    batch_norm_cpu_channels_last_collect_stats_stub(kCPU, save_mean, var_sum, input);
+    auto var_sum_a = var_sum.accessor<scalar_t, 1>();
+    for (int64_t f = 0; f < n_input; ++f) {
+      save_var_transform_a[f] = VarTransform<accscalar_t>{}(var_sum_a[f] / n, eps);
+
+      // update running averages
+      if (running_mean.defined()) {
+        running_mean_a[f] = momentum * save_mean_a[f] + (1 - momentum) * running_mean_a[f];
+      }
+      if (running_var.defined()) {
+        accscalar_t unbiased_var = var_sum_a[f] / (n - 1);
+        running_var_a[f] = momentum * unbiased_var + (1 - momentum) * running_var_a[f];
+      }
+    }
+    return std::make_tuple(save_mean, save_var_transform);
+  }
+
   parallel_for(0, n_input, 1, [&](int64_t b_begin, int64_t b_end) {
     for (int64_t f = b_begin; f < b_end; ++f) {
       Tensor in = input.select(1, f);
@@ -279,8 +319,10 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cpu_template(const Tensor
   Tensor grad_input;
   Tensor grad_weight;
   Tensor grad_bias;
+  bool use_channels_last = batch_norm_use_channels_last_kernels(input);
   if (grad_input_mask[0]) {
-    grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    grad_input = at::empty_like(input, use_channels_last
+        ? at::MemoryFormat::ChannelsLast : LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
   if (grad_input_mask[1]) {
     grad_weight = at::empty_like(weight, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
@@ -289,6 +331,15 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cpu_template(const Tensor
     grad_bias = at::empty_like(weight, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
 
+  if (use_channels_last) {
+    Tensor mean = train ? save_mean : running_mean;
+    Tensor invstd = train ? save_invstd : running_var.add(eps).rsqrt();
+    batch_norm_cpu_channels_last_backward_stub(kCPU, grad_input, grad_weight, grad_bias,
+        grad_out_.contiguous(at::MemoryFormat::ChannelsLast), input, weight,
+        mean.contiguous(), invstd.contiguous(), train);
+    return std::make_tuple(grad_input, grad_weight, grad_bias);
+  }
+
   auto weight_a = conditional_accessor_1d<scalar_t>(weight);
   auto grad_weight_a = conditional_accessor_1d<scalar_t>(grad_weight);
   auto grad_bias_a = conditional_accessor_1d<scalar_t>(grad_bias);
@@ -503,6 +554,39 @@ Tensor batch_norm(
                                                 training, momentum, eps, cudnn_enabled));
 }
 
+// relu(batch_norm(input)) with the running statistics. CPU inputs that don't
+// require grad are normalized and rectified in a single pass.
+Tensor _batch_norm_relu(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    const Tensor& running_mean, const Tensor& running_var, double eps) {
+  auto is_cpu_param = [&](const Tensor& t) {
+    return !t.defined() ||
+        (t.device().type() == kCPU && t.scalar_type() == input.scalar_type() &&
+         t.dim() == 1 && t.size(0) == input.size(1));
+  };
+  // The fused kernel has no derivative
+  const bool needs_grad = GradMode::is_enabled() &&
+      (input.requires_grad() || (weight.defined() && weight.requires_grad()) ||
+       (bias.defined() && bias.requires_grad()));
+  if (input.device().type() == kCPU && !needs_grad && input.dim() >= 2 &&
+      input.numel() > 0 && (input.scalar_type() == kFloat || input.scalar_type() == kDouble) &&
+      (input.is_contiguous() || input.is_contiguous(at::MemoryFormat::ChannelsLast)) &&
+      running_mean.defined() && running_var.defined() &&
+      is_cpu_param(weight) && is_cpu_param(bias) &&
+      is_cpu_param(running_mean) && is_cpu_param(running_var)) {
+    Tensor output = at::empty_like(input, input.is_contiguous() ?
+        at::MemoryFormat::Contiguous : at::MemoryFormat::ChannelsLast);
+    batch_norm_relu_cpu_inference_stub(kCPU, output, input,
+        weight.defined() ? weight.contiguous() : weight,
+        bias.defined() ? bias.contiguous() : bias,
+        running_mean.contiguous(), running_var.contiguous(), eps);
+    return output;
+  }
+  return at::relu(at::batch_norm(input, weight, bias, running_mean, running_var,
+                                 /*training=*/false, /*momentum=*/0, eps,
+                                 at::globalContext().userEnabledCuDNN()));
+}
+
 Tensor instance_norm(
     const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
     const Tensor& running_mean /* optional */, const Tensor& running_var /* optional */,
@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/div_rtn.h>
+#include <ATen/native/DispatchStub.h>
 #include <tuple>
 
 #pragma once
@@ -249,5 +250,15 @@ avg_pool3d_backward_shape_check(
 
 } // namespace
 
+// Channels last max_pool2d kernels, vectorized over the channels. The
+// indices are channels last too, and index the input planes as for
+// contiguous inputs.
+using max_pool2d_fn = void(*)(Tensor& output, Tensor& indices, const Tensor& input,
+    int kW, int kH, int dW, int dH, int padW, int padH, int dilationW, int dilationH);
+using max_pool2d_backward_fn = void(*)(Tensor& grad_input, const Tensor& grad_output, const Tensor& indices);
+
+DECLARE_DISPATCH(max_pool2d_fn, max_pool2d_channels_last_kernel);
+DECLARE_DISPATCH(max_pool2d_backward_fn, max_pool2d_backward_channels_last_kernel);
+
 } // at::native
 } // at
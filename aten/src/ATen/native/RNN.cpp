@@ -2,6 +2,8 @@
 
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/grad_mode.h>
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/packed_params.h>
@@ -69,6 +71,11 @@ struct CellParamsBase : torch::CustomClassHolder {
   virtual Tensor matmul_hh(const Tensor& h) const = 0;
   virtual Tensor linear_ih(const Tensor& input_ih) const = 0;
   virtual Tensor linear_hh(const Tensor& input_hh) const = 0;
+  // Computes linear_hh into `output`, a contiguous tensor of the right size
+  // that the caller reuses across time steps.
+  virtual void linear_hh_out(const Tensor& input_hh, Tensor& output) const {
+    output.copy_(linear_hh(input_hh));
+  }
 
   virtual const Tensor& b_ih() const = 0;
   virtual const Tensor& b_hh() const = 0;
@@ -104,6 +111,13 @@ struct CellParams : public CellParamsBase {
   Tensor linear_hh(const Tensor& h) const override {
     return at::linear(h, w_hh, b_hh_);
   }
+  void linear_hh_out(const Tensor& h, Tensor& output) const override {
+    if (b_hh_.defined()) {
+      at::addmm_out(output, b_hh_, h, w_hh.t());
+    } else {
+      at::mm_out(output, h, w_hh.t());
+    }
+  }
   const Tensor& b_ih() const override {
     return b_ih_;
   }
@@ -323,6 +337,9 @@ struct QuantizedCellParamsDynamic : public CellParamsBase {
   Tensor linear_hh(const Tensor& input_hh) const override {
     return packed_w_hh->apply_dynamic(input_hh, reduce_range_);
   }
+  void linear_hh_out(const Tensor& input_hh, Tensor& output) const override {
+    packed_w_hh->apply_dynamic_out(input_hh, output, reduce_range_);
+  }
 
   const Tensor& b_ih() const override {
     return b_ih_;
@@ -473,6 +490,9 @@ struct QRNNCellParamsWrapper {
   Tensor linear_hh(const Tensor& h) const {
     return param_->linear_hh(h);
   }
+  void linear_hh_out(const Tensor& h, Tensor& output) const {
+    param_->linear_hh_out(h, output);
+  }
   const Tensor& b_ih() const {
     return param_->b_ih();
   }
@@ -874,6 +894,285 @@ struct FullBidirectionalLayer
   FullLayer<dir_hidden_type, cell_params> layer_;
 };
 
+// Fused quantized layers
+//
+// These run a quantized LSTM or GRU over a whole CPU sequence. The input
+// projections of all the steps are computed by a single linear_ih, which
+// quantizes the input once. Each step then only runs the hidden GEMM, into a
+// buffer reused by every step, and applies the gates in one vectorized pass
+// (lstm_pointwise_stub, gru_pointwise_stub) that writes the new hidden state
+// straight into the output of the layer. No tensor is allocated per step, and
+// there is no final stack of the step outputs.
+
+inline void check_fused_sequence(
+    const Tensor& inputs_w,
+    const Tensor& hx,
+    int64_t num_gates) {
+  TORCH_CHECK(
+      inputs_w.device().is_cpu() && inputs_w.scalar_type() == at::kFloat &&
+          hx.scalar_type() == at::kFloat,
+      "Fused quantized RNN layers expect float CPU inputs and hidden states");
+  TORCH_CHECK(
+      inputs_w.dim() == 3 && hx.dim() == 2 &&
+          inputs_w.size(1) == hx.size(0) &&
+          inputs_w.size(2) == num_gates * hx.size(1),
+      "Expected input projections of size [seq_len, ", hx.size(0), ", ",
+      num_gates * hx.size(1), "], got ", inputs_w.sizes());
+}
+
+// LSTM over `inputs_w`, the [seq_len, batch, 4 * hidden_size] input
+// projections of the sequence. Runs the steps backwards if `reverse`.
+template <typename cell_params>
+LayerOutput<Tensor, tpair_of<Tensor>> fused_qrnn_sequence(
+    const Tensor& inputs_w,
+    const tpair_of<Tensor>& input_hidden,
+    const cell_params& params,
+    bool reverse) {
+  const auto& hx = std::get<0>(input_hidden);
+  check_fused_sequence(inputs_w, hx, 4);
+  const int64_t seq_len = inputs_w.size(0);
+  const int64_t batch_size = hx.size(0);
+  const int64_t hidden_size = hx.size(1);
+  const int64_t gates_size = 4 * hidden_size;
+
+  const auto igates = inputs_w.contiguous();
+  auto output = at::empty({seq_len, batch_size, hidden_size}, hx.options());
+  auto hgates = at::empty({batch_size, gates_size}, hx.options());
+  auto cy = std::get<1>(input_hidden).clone(at::MemoryFormat::Contiguous);
+
+  const float* igates_data = igates.data_ptr<float>();
+  const float* hgates_data = hgates.data_ptr<float>();
+  float* cy_data = cy.data_ptr<float>();
+  Tensor hy = hx;
+  for (int64_t i = 0; i < seq_len; ++i) {
+    const int64_t t = reverse ? seq_len - 1 - i : i;
+    params.linear_hh_out(hy, hgates);
+    hy = output[t];
+    lstm_pointwise_stub(
+        kCPU, igates_data + t * batch_size * gates_size, hgates_data, cy_data,
+        hy.data_ptr<float>(), nullptr, batch_size, hidden_size);
+  }
+  return {output, std::make_tuple(std::move(hy), std::move(cy))};
+}
+
+// GRU over `inputs_w`, the [seq_len, batch, 3 * hidden_size] input
+// projections of the sequence. Runs the steps backwards if `reverse`.
+template <typename cell_params>
+LayerOutput<Tensor, Tensor> fused_qrnn_sequence(
+    const Tensor& inputs_w,
+    const Tensor& input_hidden,
+    const cell_params& params,
+    bool reverse) {
+  check_fused_sequence(inputs_w, input_hidden, 3);
+  const int64_t seq_len = inputs_w.size(0);
+  const int64_t batch_size = input_hidden.size(0);
+  const int64_t hidden_size = input_hidden.size(1);
+  const int64_t gates_size = 3 * hidden_size;
+
+  const auto igates = inputs_w.contiguous();
+  auto output =
+      at::empty({seq_len, batch_size, hidden_size}, input_hidden.options());
+  auto hgates = at::empty({batch_size, gates_size}, input_hidden.options());
+
+  const float* igates_data = igates.data_ptr<float>();
+  const float* hgates_data = hgates.data_ptr<float>();
+  Tensor hx = input_hidden.contiguous();
+  for (int64_t i = 0; i < seq_len; ++i) {
+    const int64_t t = reverse ? seq_len - 1 - i : i;
+    params.linear_hh_out(hx, hgates);
+    auto hy = output[t];
+    gru_pointwise_stub(
+        kCPU, igates_data + t * batch_size * gates_size, hgates_data,
+        hx.data_ptr<float>(), hy.data_ptr<float>(), nullptr, batch_size,
+        hidden_size);
+    hx = std::move(hy);
+  }
+  return {output, hx};
+}
+
+// The cell of these layers is implied by their hidden type: LSTM for a pair
+// of tensors, GRU for a single one.
+template <typename hidden_type, typename cell_params>
+struct FusedQRNNLayer : Layer<Tensor, hidden_type, cell_params> {
+  using output_type =
+      typename Layer<Tensor, hidden_type, cell_params>::output_type;
+
+  FusedQRNNLayer(Cell<hidden_type, cell_params>& /* unused */) {}
+
+  output_type operator()(
+      const Tensor& inputs,
+      const hidden_type& input_hidden,
+      const cell_params& params) const override {
+    return fused_qrnn_sequence(
+        params.linear_ih(inputs), input_hidden, params, /*reverse=*/false);
+  }
+};
+
+template <typename dir_hidden_type, typename cell_params>
+struct FusedQRNNBidirectionalLayer
+    : Layer<Tensor, pair_of<dir_hidden_type>, pair_of<cell_params>> {
+  using hidden_type = pair_of<dir_hidden_type>;
+  using param_type = pair_of<cell_params>;
+  using output_type = typename Layer<Tensor, hidden_type, param_type>::output_type;
+
+  FusedQRNNBidirectionalLayer(
+      Cell<dir_hidden_type, cell_params>& /* unused */) {}
+
+  output_type operator()(
+      const Tensor& input,
+      const hidden_type& input_hidden,
+      const param_type& params) const override {
+    auto fw_result = fused_qrnn_sequence(
+        params.first.linear_ih(input), input_hidden.first, params.first,
+        /*reverse=*/false);
+    auto rev_result = fused_qrnn_sequence(
+        params.second.linear_ih(input), input_hidden.second, params.second,
+        /*reverse=*/true);
+    return {at::cat({fw_result.outputs, rev_result.outputs},
+                    fw_result.outputs.dim() - 1),
+            std::make_pair(fw_result.final_hidden, rev_result.final_hidden)};
+  }
+};
+
+// Fused packed layers
+//
+// These run a float LSTM or GRU over a CPU packed sequence when no gradient
+// is needed, as the pointwise kernels have no derivative. As in the fused
+// quantized layers, the input projections of all the steps come from a single
+// linear_ih, and each step runs the hidden GEMM into a reused buffer and the
+// vectorized gates. The hidden states of all the sequences live in one
+// [batch, hidden_size] buffer, of which a step updates its first
+// batch_sizes[t] rows in place: the sequences are sorted by decreasing length,
+// so the other rows hold the final hidden states of the sequences that have
+// ended or, going backwards, the initial ones of those that have not started.
+
+template <typename cell_params>
+bool hh_requires_grad(const cell_params& /* unused */) {
+  return false;
+}
+
+inline bool hh_requires_grad(const CellParams& params) {
+  return params.w_hh.requires_grad() ||
+      (params.b_hh_.defined() && params.b_hh_.requires_grad());
+}
+
+inline bool hidden_requires_grad(const Tensor& hidden) {
+  return hidden.requires_grad();
+}
+
+inline bool hidden_requires_grad(const tpair_of<Tensor>& hidden) {
+  return std::get<0>(hidden).requires_grad() ||
+      std::get<1>(hidden).requires_grad();
+}
+
+// Only the LSTM and the GRU have fused kernels.
+template <typename cell_params>
+bool has_fused_packed_cell(const Cell<tpair_of<Tensor>, cell_params>& /* unused */) {
+  return true;
+}
+
+template <typename cell_params>
+bool has_fused_packed_cell(const Cell<Tensor, cell_params>& cell) {
+  return dynamic_cast<const GRUCell<cell_params>*>(&cell) != nullptr;
+}
+
+template <typename hidden_type, typename cell_params>
+bool use_fused_packed_layer(
+    const Cell<hidden_type, cell_params>& cell,
+    const Tensor& inputs_w,
+    const hidden_type& input_hidden,
+    const cell_params& params) {
+  return has_fused_packed_cell(cell) && inputs_w.device().is_cpu() &&
+      inputs_w.scalar_type() == at::kFloat &&
+      hidden_as_output(input_hidden).scalar_type() == at::kFloat &&
+      !(GradMode::is_enabled() &&
+        (inputs_w.requires_grad() || hidden_requires_grad(input_hidden) ||
+         hh_requires_grad(params)));
+}
+
+// Offset of every step in the packed data.
+inline std::vector<int64_t> packed_step_offsets(const Tensor& batch_sizes) {
+  const int64_t num_steps = batch_sizes.size(0);
+  const int64_t* batch_sizes_data = batch_sizes.data_ptr<int64_t>();
+  std::vector<int64_t> offsets(num_steps);
+  int64_t offset = 0;
+  for (int64_t t = 0; t < num_steps; ++t) {
+    offsets[t] = offset;
+    offset += batch_sizes_data[t];
+  }
+  return offsets;
+}
+
+// LSTM over `inputs_w`, the [total, 4 * hidden_size] input projections of a
+// packed sequence. Runs the steps backwards if `reverse`.
+template <typename cell_params>
+LayerOutput<Tensor, tpair_of<Tensor>> fused_packed_sequence(
+    const Tensor& inputs_w,
+    const Tensor& batch_sizes,
+    const tpair_of<Tensor>& input_hidden,
+    const cell_params& params,
+    bool reverse) {
+  const auto& hx = std::get<0>(input_hidden);
+  const int64_t hidden_size = hx.size(1);
+  const int64_t gates_size = 4 * hidden_size;
+  const int64_t num_steps = batch_sizes.size(0);
+  const int64_t* batch_sizes_data = batch_sizes.data_ptr<int64_t>();
+  const auto offsets = packed_step_offsets(batch_sizes);
+
+  const auto igates = inputs_w.contiguous();
+  auto output = at::empty({inputs_w.size(0), hidden_size}, hx.options());
+  auto hgates = at::empty({hx.size(0), gates_size}, hx.options());
+  auto hy = hx.clone(at::MemoryFormat::Contiguous);
+  auto cy = std::get<1>(input_hidden).clone(at::MemoryFormat::Contiguous);
+  for (int64_t i = 0; i < num_steps; ++i) {
+    const int64_t t = reverse ? num_steps - 1 - i : i;
+    const int64_t step_batch = batch_sizes_data[t];
+    auto step_hgates = hgates.narrow(0, 0, step_batch);
+    params.linear_hh_out(hy.narrow(0, 0, step_batch), step_hgates);
+    lstm_pointwise_stub(
+        kCPU, igates.data_ptr<float>() + offsets[t] * gates_size,
+        hgates.data_ptr<float>(), cy.data_ptr<float>(), hy.data_ptr<float>(),
+        output.data_ptr<float>() + offsets[t] * hidden_size, step_batch,
+        hidden_size);
+  }
+  return {output, std::make_tuple(std::move(hy), std::move(cy))};
+}
+
+// GRU over `inputs_w`, the [total, 3 * hidden_size] input projections of a
+// packed sequence. Runs the steps backwards if `reverse`.
+template <typename cell_params>
+LayerOutput<Tensor, Tensor> fused_packed_sequence(
+    const Tensor& inputs_w,
+    const Tensor& batch_sizes,
+    const Tensor& input_hidden,
+    const cell_params& params,
+    bool reverse) {
+  const int64_t hidden_size = input_hidden.size(1);
+  const int64_t gates_size = 3 * hidden_size;
+  const int64_t num_steps = batch_sizes.size(0);
+  const int64_t* batch_sizes_data = batch_sizes.data_ptr<int64_t>();
+  const auto offsets = packed_step_offsets(batch_sizes);
+
+  const auto igates = inputs_w.contiguous();
+  auto output =
+      at::empty({inputs_w.size(0), hidden_size}, input_hidden.options());
+  auto hgates =
+      at::empty({input_hidden.size(0), gates_size}, input_hidden.options());
+  auto hy = input_hidden.clone(at::MemoryFormat::Contiguous);
+  for (int64_t i = 0; i < num_steps; ++i) {
+    const int64_t t = reverse ? num_steps - 1 - i : i;
+    const int64_t step_batch = batch_sizes_data[t];
+    auto step_hgates = hgates.narrow(0, 0, step_batch);
+    params.linear_hh_out(hy.narrow(0, 0, step_batch), step_hgates);
+    gru_pointwise_stub(
+        kCPU, igates.data_ptr<float>() + offsets[t] * gates_size,
+        hgates.data_ptr<float>(), hy.data_ptr<float>(), hy.data_ptr<float>(),
+        output.data_ptr<float>() + offsets[t] * hidden_size, step_batch,
+        hidden_size);
+  }
+  return {output, hy};
+}
+
 template<typename hidden_type, typename cell_params>
 struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
   using output_type =
@@ -899,6 +1198,13 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     Tensor input_w;
     if (input.data.device().is_cpu()) {
       input_w = params.linear_ih(input.data);
+      if (use_fused_packed_layer(cell_, input_w, input_hidden, params)) {
+        auto result = fused_packed_sequence(
+            input_w, input.batch_sizes, input_hidden, params,
+            /*reverse=*/false);
+        return {PackedSequence{result.outputs, input.batch_sizes},
+                result.final_hidden};
+      }
       input_ptr = &input_w;
       pre_compute_input = true;
     }
@@ -958,6 +1264,13 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     Tensor input_w;
     if (input.data.device().is_cpu()) {
       input_w = params.linear_ih(input.data);
+      if (use_fused_packed_layer(cell_, input_w, input_hidden, params)) {
+        auto result = fused_packed_sequence(
+            input_w, input.batch_sizes, input_hidden, params,
+            /*reverse=*/true);
+        return {PackedSequence{result.outputs, input.batch_sizes},
+                result.final_hidden};
+      }
       input_ptr = &input_w;
       pre_compute_input = true;
     }
@@ -1276,7 +1589,8 @@ bool _use_cudnn_rnn_flatten_weight() {
     }                                                                       \
     auto input = batch_first ? _input.transpose(0, 1) : _input;             \
     auto results =                                                          \
-        _rnn_impl_with_concat<CELL, FullLayer, FullBidirectionalLayer>(     \
+        _rnn_impl_with_concat<                                              \
+            CELL, FusedQRNNLayer, FusedQRNNBidirectionalLayer>(             \
             input,                                                          \
             params,                                                         \
             hx.unbind(0),                                                   \
@@ -1387,6 +1701,8 @@ DEFINE_DISPATCH(lstm_cudnn_stub);
 DEFINE_DISPATCH(lstm_packed_cudnn_stub);
 DEFINE_DISPATCH(lstm_miopen_stub);
 DEFINE_DISPATCH(lstm_packed_miopen_stub);
+DEFINE_DISPATCH(lstm_pointwise_stub);
+DEFINE_DISPATCH(gru_pointwise_stub);
 REGISTER_NO_CPU_DISPATCH(lstm_cudnn_stub, lstm_fn);
 REGISTER_NO_CPU_DISPATCH(lstm_packed_cudnn_stub, lstm_packed_fn);
 REGISTER_NO_CPU_DISPATCH(lstm_miopen_stub, lstm_fn);
@@ -1602,7 +1918,7 @@ std::tuple<Tensor, Tensor, Tensor> quantized_lstm_input(
   std::tuple<Tensor, Tensor, Tensor> results;
   if (result_dtype == at::kChar || result_dtype == at::kQInt8) {
     if (use_dynamic) {
-      results = _lstm_impl<FullLayer, FullBidirectionalLayer>(
+      results = _lstm_impl<FusedQRNNLayer, FusedQRNNBidirectionalLayer>(
           input, params, hx[0], hx[1], num_layers,
           dropout_p, train, bidirectional);
     } else {
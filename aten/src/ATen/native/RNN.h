@@ -27,6 +27,17 @@ DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_miopen_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_miopen_stub);
 
+// Pointwise part of a step of the fused CPU LSTM and GRU layers, over
+// `batch_size` contiguous rows of float gates and hidden states. The sums of
+// the input and hidden gates go through the nonlinearities, and the new hidden
+// state is written to `hy` and, if not null, to `hy_copy`. The LSTM updates
+// the cell state `cx` in place, `hx` may be `hy` for the GRU.
+using lstm_pointwise_fn = void(*)(const float* igates, const float* hgates, float* cx, float* hy, float* hy_copy, int64_t batch_size, int64_t hidden_size);
+using gru_pointwise_fn = void(*)(const float* igates, const float* hgates, const float* hx, float* hy, float* hy_copy, int64_t batch_size, int64_t hidden_size);
+
+DECLARE_DISPATCH(lstm_pointwise_fn, lstm_pointwise_stub);
+DECLARE_DISPATCH(gru_pointwise_fn, gru_pointwise_stub);
+
 inline void check_device(const Tensor& input, const TensorList& params, const TensorList& hiddens) {
   auto input_device = input.device();
 
@@ -26,6 +26,10 @@ using reduce_std_var_function =
   void (*)(TensorIterator&, bool unbiased, bool take_sqrt);
 DECLARE_DISPATCH(reduce_std_var_function, std_var_stub);
 
+// Writes the sum, sum of squares, min, max and number of non-finite elements
+// to the five outputs of the iterator.
+DECLARE_DISPATCH(reduce_fn, reduce_stats_stub);
+
 using reduce_norm_fn =
     void (*)(Tensor&, const Tensor&, Scalar, c10::optional<int64_t>);
 DECLARE_DISPATCH(reduce_norm_fn, norm_kernel);
@@ -252,4 +252,30 @@ static TensorIterator make_reduction(
   return make_reduction(name, result1, result2, self, dim, keepdim, dtype, dtype);
 }
 
+// Reduction of self into one result per dtype in `dtypes`, all computed in the
+// same pass over self.
+static TensorIterator make_reduction(
+    const char* name, std::vector<Tensor>& results, const Tensor& self, IntArrayRef dim,
+    bool keepdim, ArrayRef<ScalarType> dtypes)
+{
+  TORCH_INTERNAL_ASSERT(results.size() == dtypes.size());
+  int64_t ndim = self.dim();
+  DimMask mask = make_dim_mask(dim, ndim);
+  std::vector<Tensor> viewed_results;
+  viewed_results.reserve(results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    TORCH_CHECK(
+      !results[i].defined() || results[i].scalar_type() == dtypes[i],
+      name, ": provided dtype must match dtype of result. Got ",
+      toString(results[i].scalar_type()),
+      " and ",
+      toString(dtypes[i]),
+      ".");
+    allocate_reduction_result(results[i], self, mask, keepdim, dtypes[i]);
+    viewed_results.push_back(review_reduce_result(results[i], ndim, mask, keepdim));
+    namedinference::propagate_names_for_reduction(results[i], self, dim, keepdim);
+  }
+  return TensorIterator::reduce_op(viewed_results, self);
+}
+
 }}  // at::native
@@ -14,8 +14,10 @@
 #endif
 #if defined(__CUDACC__) || defined(__HIPCC__)
 #include <thrust/pair.h>
+#include <thrust/tuple.h>
 #else
 #include <cmath>
+#include <tuple>
 #define device_sqrt std::sqrt
 #endif
 #if defined(__CUDACC__) || defined(__HIPCC__)
@@ -43,8 +45,10 @@ namespace detail {
 
 #if defined(__CUDACC__) || defined(__HIPCC__)
 template <typename T1, typename T2> using pair = thrust::pair<T1, T2>;
+template <typename... Ts> using tuple = thrust::tuple<Ts...>;
 #else
 template <typename T1, typename T2> using pair = std::pair<T1, T2>;
+template <typename... Ts> using tuple = std::tuple<Ts...>;
 #endif
 
 } // namespace detail
@@ -394,6 +398,67 @@ struct MaxOps :
   public detail::MinMaxReductionOps<detail::GreaterOrNan<scalar_t>> {
 };
 
+template <typename acc_scalar_t>
+struct ReduceStatsData {
+  acc_scalar_t sum;
+  acc_scalar_t sumsq;
+  acc_scalar_t min;
+  acc_scalar_t max;
+  int64_t nonfinite;
+  C10_HOST_DEVICE ReduceStatsData() : sum(0), sumsq(0), min(0), max(0), nonfinite(0) {}
+  C10_HOST_DEVICE ReduceStatsData(acc_scalar_t sum, acc_scalar_t sumsq, acc_scalar_t min, acc_scalar_t max, int64_t nonfinite)
+    : sum(sum), sumsq(sumsq), min(min), max(max), nonfinite(nonfinite) {}
+};
+
+// Computes the sum, the sum of squares, the min, the max and the number of
+// non-finite elements in one pass. min and max propagate NaN like MinOps and
+// MaxOps; the identity must start them at +inf and -inf.
+template <typename scalar_t, typename acc_scalar_t>
+struct ReduceStatsOps {
+  using acc_t = ReduceStatsData<acc_scalar_t>;
+  using res_t = detail::tuple<scalar_t, scalar_t, scalar_t, scalar_t, int64_t>;
+
+  inline C10_DEVICE acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    acc_scalar_t value = data;
+    return {
+      acc.sum + value,
+      acc.sumsq + value * value,
+      detail::LessOrNan<acc_scalar_t>{}(acc.min, value) ? acc.min : value,
+      detail::GreaterOrNan<acc_scalar_t>{}(acc.max, value) ? acc.max : value,
+      // x - x is NaN exactly when x is infinite or NaN
+      acc.nonfinite + (at::_isnan(value - value) ? 1 : 0),
+    };
+  }
+  inline C10_DEVICE acc_t combine(acc_t a, acc_t b) const {
+    return {
+      a.sum + b.sum,
+      a.sumsq + b.sumsq,
+      detail::LessOrNan<acc_scalar_t>{}(a.min, b.min) ? a.min : b.min,
+      detail::GreaterOrNan<acc_scalar_t>{}(a.max, b.max) ? a.max : b.max,
+      a.nonfinite + b.nonfinite,
+    };
+  }
+  inline C10_DEVICE res_t project(acc_t acc) const {
+    return res_t((scalar_t) acc.sum, (scalar_t) acc.sumsq, (scalar_t) acc.min, (scalar_t) acc.max, acc.nonfinite);
+  }
+
+  static C10_DEVICE acc_t translate_idx(acc_t acc, int64_t /*base_idx*/) {
+    return acc;
+  }
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+  inline __device__ acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return {
+      WARP_SHFL_DOWN(acc.sum, offset)
+      , WARP_SHFL_DOWN(acc.sumsq, offset)
+      , WARP_SHFL_DOWN(acc.min, offset)
+      , WARP_SHFL_DOWN(acc.max, offset)
+      , WARP_SHFL_DOWN(acc.nonfinite, offset)
+    };
+  }
+#endif
+};
+
 }} // namespace at::native
 
 #undef MAX
@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 
 #include <tuple>
 
@@ -10,6 +11,31 @@ namespace at { namespace native {
 ///////////////// bincount /////////////////
 namespace {
 
+// Calls accumulate(bins, begin, end) to add the elements [begin, end) of the
+// input to the histogram `bins`, which is zero initialized. Large inputs are
+// split between the threads, each filling its own histogram, which are then
+// summed, unless the histograms are larger than the input.
+template <typename output_t, typename func_t>
+void histogram(output_t* output_p, int64_t nbins, int64_t numel, const func_t& accumulate) {
+  const int num_threads = at::get_num_threads();
+  if (numel < at::internal::GRAIN_SIZE || num_threads == 1 || nbins * num_threads > numel) {
+    accumulate(output_p, 0, numel);
+    return;
+  }
+  std::vector<output_t> thread_bins(num_threads * nbins, 0);
+  at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    accumulate(thread_bins.data() + at::get_thread_num() * nbins, begin, end);
+  });
+  at::parallel_for(0, nbins, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int t = 0; t < num_threads; t++) {
+      const output_t* bins = thread_bins.data() + t * nbins;
+      for (int64_t i = begin; i < end; i++) {
+        output_p[i] += bins[i];
+      }
+    }
+  });
+}
+
 template <typename input_t, typename weights_t>
 Tensor _bincount_cpu_template(
     const Tensor& self,
@@ -38,17 +64,19 @@ Tensor _bincount_cpu_template(
   const input_t* self_p = self.data_ptr<input_t>();
   if (has_weights) {
     output = native::zeros({nbins}, weights.options());
-    weights_t* output_p = output.data_ptr<weights_t>();
     const weights_t* weights_p = weights.data_ptr<weights_t>();
-    for (int64_t i = 0; i < self_size; i++) {
-      output_p[self_p[i]] += weights_p[i];
-    }
+    histogram<weights_t>(output.data_ptr<weights_t>(), nbins, self_size, [&](weights_t* output_p, int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        output_p[self_p[i]] += weights_p[i];
+      }
+    });
   } else {
     output = native::zeros({nbins}, kLong);
-    int64_t* output_p = output.data_ptr<int64_t>();
-    for (int64_t i = 0; i < self_size; i++) {
-      output_p[self_p[i]] += 1L;
-    }
+    histogram<int64_t>(output.data_ptr<int64_t>(), nbins, self_size, [&](int64_t* output_p, int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        output_p[self_p[i]] += 1L;
+      }
+    });
   }
   return output;
 }
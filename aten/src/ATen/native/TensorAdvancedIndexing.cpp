@@ -370,6 +370,51 @@ Tensor& index_add_cpu_(Tensor & self, int64_t dim, const Tensor & index, const T
     auto self_stride_bytes = self.stride(dim) * elementSize(self.scalar_type());
     auto source_stride_bytes = source.stride(dim) * elementSize(source.scalar_type());
     auto self_dim_size = self.size(dim);
+    auto slice_size = sourceSlice.numel();
+
+    // Small contiguous slices, e.g. the rows of an embedding table: add them
+    // in a loop instead of going through add_stub for each of them, and in
+    // parallel. Each thread owns a range of slices of self and adds the
+    // slices of source indexed into it in index order, so there is no race
+    // on the indices that repeat and the result doesn't depend on the number
+    // of threads. Slices of different sizes go through add_stub, which
+    // broadcasts them or raises the size mismatch.
+    auto dtype = self.scalar_type();
+    if (slice_size < at::internal::GRAIN_SIZE &&
+        selfSlice.sizes().equals(sourceSlice.sizes()) &&
+        selfSlice.is_contiguous() && sourceSlice.is_contiguous() &&
+        self.stride(dim) >= slice_size &&
+        (dtype == ScalarType::Float || dtype == ScalarType::Double ||
+         at::isIntegralType(dtype, /*includeBool=*/false))) {
+      for (auto i = 0; i < numel; i++) {
+        auto self_i = index_data[i];
+        TORCH_CHECK_INDEX((self_i >= 0) && (self_i < self_dim_size), "index out of range in self");
+      }
+      // Every thread goes through all the indices, only parallelize when
+      // there are enough elements to add.
+      auto grain_size = numel * slice_size < at::internal::GRAIN_SIZE ? self_dim_size : 1;
+      AT_DISPATCH_ALL_TYPES(dtype, "index_add_cpu_", [&] {
+        auto self_data = static_cast<scalar_t*>(selfSlice.data_ptr());
+        auto source_data = static_cast<scalar_t*>(sourceSlice.data_ptr());
+        auto self_stride = self.stride(dim);
+        auto source_stride = source.stride(dim);
+        at::parallel_for(0, self_dim_size, grain_size, [&](int64_t start, int64_t end) {
+          for (int64_t i = 0; i < numel; i++) {
+            auto self_i = index_data[i];
+            if (self_i < start || self_i >= end) {
+              continue;
+            }
+            scalar_t* self_ip = self_data + self_i * self_stride;
+            const scalar_t* source_ip = source_data + i * source_stride;
+            for (int64_t j = 0; j < slice_size; j++) {
+              self_ip[j] += source_ip[j];
+            }
+          }
+        });
+      });
+      return self;
+    }
+
     auto iter = TensorIterator::binary_op(selfSlice, selfSlice, sourceSlice);
 
     for (auto i = 0; i < numel; i++) {
@@ -490,12 +535,14 @@ Tensor & index_select_out_cpu_(Tensor & result, const Tensor & self, int64_t dim
       auto self_data_ptr = self.data_ptr<scalar_t>();
       auto result_data_ptr = result.data_ptr<scalar_t>();
       auto self_numel = self.numel();
-      for (auto i = 0; i < numel; i++) {
-        auto self_i = index_data[i];
-        TORCH_CHECK_INDEX((self_i >= 0) && (self_i < self_numel), "index out of range in self");
-        scalar_t *self_ip = self_data_ptr + self_i * self_stride;
-        *(result_data_ptr + i * result_stride) = *self_ip;
-      }
+      at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t start, int64_t end) {
+        for (auto i = start; i < end; i++) {
+          auto self_i = index_data[i];
+          TORCH_CHECK_INDEX((self_i >= 0) && (self_i < self_numel), "index out of range in self");
+          scalar_t *self_ip = self_data_ptr + self_i * self_stride;
+          *(result_data_ptr + i * result_stride) = *self_ip;
+        }
+      });
     });
   }
 
@@ -36,4 +36,14 @@ DECLARE_DISPATCH(scatter_add_fn, scatter_add_stub);
 
 TORCH_API Tensor& index_out(Tensor& result, const Tensor & self, TensorList indices);
 
+// Whether the CUDA index_add_ and scatter_add_ accumulate with index_put_accum_stub, which sorts the
+// destinations and sums the values of each destination in order, instead of with atomics. This is done
+// in deterministic mode, and when there are many more indices than destinations so that the atomics on
+// the duplicated destinations would serialize.
+inline bool use_sorted_accumulate(int64_t num_indices, int64_t num_destinations) {
+  constexpr int64_t MIN_INDICES_PER_DESTINATION = 64;
+  return globalContext().deterministic() ||
+      num_indices >= MIN_INDICES_PER_DESTINATION * num_destinations;
+}
+
 }} // namespace at::native
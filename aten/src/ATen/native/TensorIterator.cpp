@@ -1,6 +1,7 @@
 #include <ATen/native/TensorIterator.h>
 
 #include <array>
+#include <ATen/EmptyTensor.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/native/TypeProperties.h>
@@ -13,6 +14,66 @@ using PtrVector = TensorIterator::PtrVector;
 using loop_t = TensorIterator::loop_t;
 using loop2d_t = TensorIterator::loop2d_t;
 using StrideVector = TensorIterator::StrideVector;
+using GeometryKey = TensorIterator::GeometryKey;
+
+namespace {
+
+// [TensorIterator geometry cache]
+// Elementwise ops that run in a loop on the same shapes, e.g. optimizer steps
+// or RNN cells, build TensorIterators with the same operand geometry on every
+// call. For small tensors, computing the broadcast strides, the order of the
+// dimensions and the coalesced shape costs about as much as the kernel, so
+// iterators built with cache_geometry(true) keep the result of that part of
+// build() in a small per-thread cache.
+//
+// The key holds everything it reads: the broadcast shape and, for each
+// operand, whether it is defined and an output, its element size, sizes and
+// strides. The entry holds everything it writes: perm_, the coalesced shape_
+// and stride_bytes, and the sizes and strides of the outputs it allocated.
+struct CachedGeometry {
+  GeometryKey key;
+  DimVector perm;
+  DimVector shape;
+  SmallVector<StrideVector, 4> stride_bytes;
+  SmallVector<std::pair<DimVector, DimVector>, 1> outputs;
+  bool has_coalesced_dimensions;
+};
+
+constexpr size_t kGeometryCacheSize = 8;
+
+struct GeometryCache {
+  std::array<CachedGeometry, kGeometryCacheSize> entries;
+  size_t size = 0;
+  // Entries are replaced in the order they were stored
+  size_t next = 0;
+};
+
+GeometryCache& geometry_cache() {
+  static thread_local GeometryCache cache;
+  return cache;
+}
+
+// Same as shape = infer_size(shape, other), without the temporary vector.
+void infer_size_inplace(DimVector& shape, IntArrayRef other) {
+  const int64_t dims_a = shape.size();
+  const int64_t dims_b = other.size();
+  const int64_t ndim = std::max(dims_a, dims_b);
+  shape.insert(shape.begin(), ndim - dims_a, 1);
+  for (int64_t i = ndim - 1; i >= 0; --i) {
+    const int64_t dim_b = i - (ndim - dims_b);
+    const int64_t size_a = shape[i];
+    const int64_t size_b = dim_b >= 0 ? other[dim_b] : 1;
+    TORCH_CHECK(
+        size_a == size_b || size_a == 1 || size_b == 1,
+        "The size of tensor a (", size_a,
+        ") must match the size of tensor b (", size_b,
+        ") at non-singleton dimension ", i);
+    // 1s map to the other size (even 0).
+    shape[i] = size_a == 1 ? size_b : size_a;
+  }
+}
+
+} // namespace
 
 void TensorIterator::reorder_dimensions(const TensorIteratorConfig& config) {
   // Sort the dimensions based on strides in ascending order with reduced dims
@@ -291,6 +352,29 @@ DimVector TensorIterator::apply_perm_and_mul(IntArrayRef input, int mul) const {
   return res;
 }
 
+// Allocates an output. Outputs on CPU are created directly rather than
+// through the dispatcher, see at::detail::empty_cpu_fast.
+static Tensor empty_output(
+    const OperandInfo& op,
+    IntArrayRef sizes,
+    MemoryFormat memory_format = MemoryFormat::Contiguous) {
+  if (op.device.type() == DeviceType::CPU) {
+    return at::detail::empty_cpu_fast(
+        sizes, op.target_dtype, /*pin_memory=*/false, memory_format);
+  }
+  return at::empty(sizes, op.options(), memory_format);
+}
+
+static Tensor empty_strided_output(
+    const OperandInfo& op,
+    IntArrayRef sizes,
+    IntArrayRef strides) {
+  if (op.device.type() == DeviceType::CPU) {
+    return at::detail::empty_strided_cpu_fast(sizes, strides, op.target_dtype);
+  }
+  return at::empty_strided(sizes, strides, op.options());
+}
+
 void TensorIterator::allocate_outputs() {
   for (int i = 0; i < num_outputs_; i++) {
     auto& op = operands_[i];
@@ -303,14 +387,11 @@ void TensorIterator::allocate_outputs() {
           ndim() == 5 && requires_channels_last_3d_output();
       if (requires_channels_last_2d_output_ || requires_channels_last_3d_output_) {
         auto tensor_shape = invert_perm(shape_);
-        op.tensor = at::empty(tensor_shape, op.options());
-        if (requires_channels_last_2d_output_) {
-          op.tensor.unsafeGetTensorImpl()->empty_tensor_restride(
-              MemoryFormat::ChannelsLast);
-        } else {
-          op.tensor.unsafeGetTensorImpl()->empty_tensor_restride(
-              MemoryFormat::ChannelsLast3d);
-        }
+        op.tensor = empty_output(
+            op,
+            tensor_shape,
+            requires_channels_last_2d_output_ ? MemoryFormat::ChannelsLast
+                                              : MemoryFormat::ChannelsLast3d);
         // As we are allocating output after permutations is done, we need to
         // make sure that operand's strides are matching element size and
         // dimensions permutations which are stored in _perm
@@ -330,14 +411,13 @@ void TensorIterator::allocate_outputs() {
           // can just return contiguous output
           // it is faster because it avoids allocating 0 size tensor and
           // resizing and restriding it
-          op.tensor = at::empty(tensor_shape, op.options());
+          op.tensor = empty_output(op, tensor_shape);
         } else {
           auto tensor_stride = invert_perm(op.stride_bytes);
           for (int dim = 0; dim < ndim(); dim++) {
             tensor_stride[dim] /= element_size;
           }
-          op.tensor =
-              at::empty_strided(tensor_shape, tensor_stride, op.options());
+          op.tensor = empty_strided_output(op, tensor_shape, tensor_stride);
         }
       }
       op.current_dtype = op.target_dtype;
@@ -346,6 +426,9 @@ void TensorIterator::allocate_outputs() {
 }
 
 void TensorIterator::compute_names(const TensorIteratorConfig& config) {
+  if (!NamedTensorMeta::any_alive()) {
+    return;
+  }
   bool should_infer_names = std::any_of(
       operands_.begin(),
       operands_.end(),
@@ -685,6 +768,7 @@ TensorIterator TensorIterator::binary_op(Tensor& out, const Tensor& a,
      .promote_inputs_to_common_dtype(true)
      .cast_common_dtype_to_outputs(true)
      .enforce_safe_casting_to_output(true)
+     .cache_geometry(true)
      .build();
 }
 
@@ -697,6 +781,7 @@ TensorIterator TensorIterator::comparison_op(Tensor& out, const Tensor& a,
     .add_input(b)
     .allow_cpu_scalars(true)
     .promote_inputs_to_common_dtype(true)
+    .cache_geometry(true)
     .build();
 }
 
@@ -708,6 +793,7 @@ TensorIterator TensorIterator::unary_op(Tensor& out, const Tensor& a,
     .add_input(a)
     .cast_common_dtype_to_outputs(true)
     .enforce_safe_casting_to_output(true)
+    .cache_geometry(true)
     .build();
 }
 
@@ -754,7 +840,31 @@ TensorIterator TensorIterator::reduce_op(Tensor& out1, Tensor& out2, const Tenso
     .build();
 }
 
+TensorIterator TensorIterator::reduce_op(TensorList outs, const Tensor& a) {
+  TORCH_INTERNAL_ASSERT(!outs.empty());
+  TensorIteratorConfig config;
+  for (size_t i = 0; i < outs.size(); i++) {
+    const auto& out = outs[i];
+    TORCH_INTERNAL_ASSERT(out.defined());
+    TORCH_CHECK((!a.is_cuda() && !out.is_cuda()) || a.device() == out.device(),
+        "reduce_op(): expected input and all outputs to be on same device, but input is on ", a.device(),
+        " and output", i, " is on ", out.device());
+    TORCH_CHECK(out.sizes() == outs[0].sizes(), "reduce_op(): expected all outputs to have same sizes, but output0 has ",
+        outs[0].sizes(), " and output", i, " has ", out.sizes());
+    TORCH_CHECK(out.strides() == outs[0].strides(), "reduce_op(): expected all outputs to have same strides, but output0 has ",
+        outs[0].strides(), " and output", i, " has ", out.strides());
+    config.add_output(out);
+  }
+  return config
+    .add_input(a)
+    .dont_resize_outputs()
+    .is_reduction(true)
+    .check_all_same_dtype(false)
+    .build();
+}
+
 void TensorIterator::populate_operands(TensorIteratorConfig& config) {
+  operands_.reserve(config.tensors_.size());
   for (int i = 0; i < config.tensors_.size(); i++) {
     operands_.emplace_back(std::move(config.tensors_[i]));
   }
@@ -824,7 +934,7 @@ void TensorIterator::compute_shape(const TensorIteratorConfig& config) {
       shape_ = shape;
     } else if (!shape.equals(shape_)) {
       all_ops_same_shape_ = false;
-      shape_ = DimVector(infer_size(shape_, shape));
+      infer_size_inplace(shape_, shape);
     }
   }
 }
@@ -1010,7 +1120,7 @@ bool TensorIterator::fast_set_up(const TensorIteratorConfig& config) {
           auto& op = operands_[i];
           if (!op.tensor.defined()) {
             TORCH_INTERNAL_ASSERT(op.is_type_defined(), "no type for operand", i);
-            op.tensor = at::empty(shape_, op.options(), MemoryFormat::Contiguous);
+            op.tensor = empty_output(op, shape_, MemoryFormat::Contiguous);
             op.current_dtype = op.target_dtype;
           }
         }
@@ -1022,7 +1132,7 @@ bool TensorIterator::fast_set_up(const TensorIteratorConfig& config) {
           auto& op = operands_[i];
           if (!op.tensor.defined()) {
             TORCH_INTERNAL_ASSERT(op.is_type_defined(), "no type for operand", i);
-            op.tensor = at::empty(shape_, op.options(), MemoryFormat::ChannelsLast);
+            op.tensor = empty_output(op, shape_, MemoryFormat::ChannelsLast);
             op.current_dtype = op.target_dtype;
           }
         }
@@ -1040,7 +1150,7 @@ bool TensorIterator::fast_set_up(const TensorIteratorConfig& config) {
           auto& op = operands_[i];
           if (!op.tensor.defined()) {
             TORCH_INTERNAL_ASSERT(op.is_type_defined(), "no type for operand", i);
-            op.tensor = at::empty_strided(shape_, operands_[i_defined].tensor.strides(), op.options());
+            op.tensor = empty_strided_output(op, shape_, operands_[i_defined].tensor.strides());
             op.current_dtype = op.target_dtype;
           }
           // defined tensors always have the same shape and strides here, no re-stride outputs happens.
@@ -1121,6 +1231,78 @@ FastSetupType TensorIterator::compute_fast_setup_type(const TensorIteratorConfig
   return FastSetupType::NONE;
 }
 
+GeometryKey TensorIterator::compute_geometry_key(const TensorIteratorConfig& config) const {
+  GeometryKey key;
+  key.push_back(is_reduction_);
+  key.push_back(config.static_shape_.has_value());
+  key.push_back(ntensors());
+  key.push_back(ndim());
+  key.append(shape_.begin(), shape_.end());
+  for (auto& op : operands_) {
+    if (!op.tensor.defined()) {
+      key.push_back(-1);
+      key.push_back(elementSize(op.target_dtype));
+      continue;
+    }
+    auto sizes = op.tensor.sizes();
+    auto strides = op.tensor.strides();
+    key.push_back(op.is_output);
+    key.push_back(op.tensor.element_size());
+    key.push_back(sizes.size());
+    key.append(sizes.begin(), sizes.end());
+    key.append(strides.begin(), strides.end());
+  }
+  return key;
+}
+
+bool TensorIterator::load_cached_geometry(const GeometryKey& key) {
+  const auto& cache = geometry_cache();
+  for (size_t i = 0; i < cache.size; i++) {
+    const auto& entry = cache.entries[i];
+    if (entry.key != key) {
+      continue;
+    }
+    for (int arg = 0; arg < num_outputs_; arg++) {
+      auto& op = operands_[arg];
+      if (!op.tensor.defined()) {
+        TORCH_INTERNAL_ASSERT(op.is_type_defined(), "no type for operand", arg);
+        op.tensor = empty_strided_output(
+            op, entry.outputs[arg].first, entry.outputs[arg].second);
+        op.current_dtype = op.target_dtype;
+      }
+    }
+    perm_ = entry.perm;
+    shape_ = entry.shape;
+    for (int arg = 0; arg < ntensors(); arg++) {
+      operands_[arg].stride_bytes = entry.stride_bytes[arg];
+    }
+    has_coalesced_dimensions_ = entry.has_coalesced_dimensions;
+    return true;
+  }
+  return false;
+}
+
+void TensorIterator::store_cached_geometry(GeometryKey&& key) const {
+  auto& cache = geometry_cache();
+  auto& entry = cache.entries[cache.next];
+  cache.next = (cache.next + 1) % kGeometryCacheSize;
+  cache.size = std::min(cache.size + 1, kGeometryCacheSize);
+
+  entry.key = std::move(key);
+  entry.perm = perm_;
+  entry.shape = shape_;
+  entry.stride_bytes.clear();
+  for (auto& op : operands_) {
+    entry.stride_bytes.push_back(op.stride_bytes);
+  }
+  entry.outputs.clear();
+  for (int arg = 0; arg < num_outputs_; arg++) {
+    const auto& output = operands_[arg].tensor;
+    entry.outputs.emplace_back(DimVector(output.sizes()), DimVector(output.strides()));
+  }
+  entry.has_coalesced_dimensions = has_coalesced_dimensions_;
+}
+
 TensorIterator::TensorIterator(TensorIteratorConfig& config) {
   build(config);
 }
@@ -1146,14 +1328,23 @@ void TensorIterator::build(TensorIteratorConfig& config) {
   compute_types(config);
   // try fast setup output tensor, if failed, fallback to normal setup
   if (!fast_set_up(config)) {
-    // compute each tensor's stride after broadcasting
-    compute_strides(config);
-    // re-order dimensions to improve coalescing
-    reorder_dimensions(config);
-    // allocate the output tensor if it's not provided
-    allocate_outputs();
-    // coalesce adjacent dimensions when possible
-    coalesce_dimensions();
+    GeometryKey geometry_key;
+    if (config.cache_geometry_) {
+      geometry_key = compute_geometry_key(config);
+    }
+    if (!config.cache_geometry_ || !load_cached_geometry(geometry_key)) {
+      // compute each tensor's stride after broadcasting
+      compute_strides(config);
+      // re-order dimensions to improve coalescing
+      reorder_dimensions(config);
+      // allocate the output tensor if it's not provided
+      allocate_outputs();
+      // coalesce adjacent dimensions when possible
+      coalesce_dimensions();
+      if (config.cache_geometry_) {
+        store_cached_geometry(std::move(geometry_key));
+      }
+    }
   }
   // perform name inference
   propagate_names_to_outputs();
@@ -134,6 +134,7 @@ struct CAFFE2_API TensorIterator {
   using DimMask = std::bitset<64>;
   using PtrVector = SmallVector<char*, 4>;
   using StrideVector = SmallVector<int64_t, 6>;
+  using GeometryKey = SmallVector<int64_t, 32>;
 
   TensorIterator(TensorIteratorConfig&);
 
@@ -163,6 +164,9 @@ struct CAFFE2_API TensorIterator {
   static TensorIterator nullary_op(Tensor& out);
   static TensorIterator reduce_op(Tensor& out, const Tensor& a);
   static TensorIterator reduce_op(Tensor& out1, Tensor& out2, const Tensor& a);
+  // Reduction writing several results of the same shape, possibly of different
+  // dtypes, in one pass over `a`.
+  static TensorIterator reduce_op(TensorList outs, const Tensor& a);
 
   int ndim() const { return shape_.size(); }
   IntArrayRef shape() const { return shape_; }
@@ -245,6 +249,10 @@ struct CAFFE2_API TensorIterator {
   void for_each(loop2d_t loop, int64_t grain_size = at::internal::GRAIN_SIZE);
 
   void parallel_reduce(loop2d_t loop);
+  /// Same as parallel_reduce(loop), for reductions whose partial results
+  /// have to be combined with a different loop than the one that reduces the
+  /// input, e.g. a sum of squares, whose partial sums are simply added.
+  void parallel_reduce(loop2d_t loop, loop2d_t combine_loop);
 
   void serial_for_each(loop_t loop, Range range) const;
   void serial_for_each(loop2d_t loop, Range range) const;
@@ -313,6 +321,11 @@ protected:
   FastSetupType compute_fast_setup_type(const TensorIteratorConfig&);
   void compute_names(const TensorIteratorConfig&);
   void resize_outputs(const TensorIteratorConfig&);
+
+  /// See [TensorIterator geometry cache]
+  GeometryKey compute_geometry_key(const TensorIteratorConfig&) const;
+  bool load_cached_geometry(const GeometryKey&);
+  void store_cached_geometry(GeometryKey&&) const;
   void propagate_names_to_outputs();
   void coalesce_dimensions();
 
@@ -500,6 +513,16 @@ public:
     return *this;
   }
 
+  // Sets the cache_geometry_ flag, which is false by default
+  // If true, the strides, dimension order and coalesced shape computed by
+  //   the general (non fast setup) path of build() are reused from an earlier
+  //   build on the same thread whose operands had the same sizes, strides
+  //   and element sizes. See the [TensorIterator geometry cache] note.
+  TensorIteratorConfig& cache_geometry(const bool _cache_geometry) {
+    cache_geometry_ = _cache_geometry;
+    return *this;
+  }
+
   TensorIteratorConfig& dont_resize_outputs() {
     resize_outputs_ = false;
     return *this;
@@ -552,6 +575,7 @@ private:
   bool enforce_safe_casting_to_output_ = false;
   bool promote_inputs_to_common_dtype_ = false;
   bool cast_common_dtype_to_outputs_ = false;
+  bool cache_geometry_ = false;
 };
 
 
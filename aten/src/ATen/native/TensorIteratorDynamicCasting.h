@@ -75,4 +75,27 @@ struct needs_dynamic_casting<func_t, 0> {
   }
 };
 
+// Same as needs_dynamic_casting, for the inputs only. Kernels with several
+// outputs check those separately, see cpu/Loops.h and cuda/CUDALoops.cuh.
+template<typename func_t, int nargs=function_traits<func_t>::arity>
+struct inputs_need_dynamic_casting {
+  static bool check(TensorIterator& iter) {
+    using traits = function_traits<func_t>;
+    using cpp_type = typename traits::template arg<nargs - 1>::type;
+    using cpp_map = cppmap::detail::CPPTypeToScalarType<cpp_type>;
+
+    if (iter.input_dtype(nargs-1) != cpp_map::value()) {
+      return true;
+    }
+    return inputs_need_dynamic_casting<func_t, nargs - 1>::check(iter);
+  }
+};
+
+template<typename func_t>
+struct inputs_need_dynamic_casting<func_t, 0> {
+  static bool check(TensorIterator& iter) {
+    return false;
+  }
+};
+
 }} //namespace at::native
@@ -10,27 +10,44 @@ namespace at {
 using loop2d_t = TensorIterator::loop2d_t;
 
 static bool use_two_pass_reduction(TensorIterator& iter);
-static void two_pass_reduction(TensorIterator& iter, loop2d_t loop);
+static void two_pass_reduction(TensorIterator& iter, loop2d_t loop, loop2d_t combine_loop);
 static void parallel_dim_reduction(TensorIterator& iter, loop2d_t loop);
 
 void TensorIterator::parallel_reduce(loop2d_t loop) {
+  parallel_reduce(loop, loop);
+}
+
+void TensorIterator::parallel_reduce(loop2d_t loop, loop2d_t combine_loop) {
   TORCH_CHECK(ntensors() == 2, "parallel_reduce only supports one input and one output");
   int64_t numel = this->numel();
   if (numel < at::internal::GRAIN_SIZE || at::get_num_threads() == 1 ||
       at::in_parallel_region()) {
     serial_for_each(loop, {0, numel});
   } else if (use_two_pass_reduction(*this)) {
-    two_pass_reduction(*this, loop);
+    two_pass_reduction(*this, loop, combine_loop);
   } else {
     parallel_dim_reduction(*this, loop);
   }
 }
 
+/// Splitting the output columns across threads leaves threads idle when
+/// there are fewer 128-byte groups of columns than threads (e.g. a sum over
+/// dim 0 of a tall and narrow matrix), so those reductions split the reduced
+/// elements instead, as long as the per-thread copies of the output stay small.
+/// The output has to be contiguous for the per-thread iterators, which write
+/// to contiguous copies of it, to visit the input in the same order as iter.
 static bool use_two_pass_reduction(TensorIterator& iter) {
-  return iter.output(0).numel() == 1;
+  const int64_t num_outputs = iter.output(0).numel();
+  if (num_outputs == 1) {
+    return true;
+  }
+  const int64_t output_bytes = num_outputs * iter.element_size(0);
+  return iter.output(0).is_contiguous() &&
+      output_bytes < 128 * at::get_num_threads() &&
+      num_outputs * at::get_num_threads() <= iter.numel();
 }
 
-static void two_pass_reduction(TensorIterator& iter, loop2d_t loop) {
+static void two_pass_reduction(TensorIterator& iter, loop2d_t loop, loop2d_t combine_loop) {
   int max_threads = at::get_num_threads();
 
   auto dst = iter.output(0);
@@ -60,7 +77,7 @@ static void two_pass_reduction(TensorIterator& iter, loop2d_t loop) {
 
   auto unsqueezed = dst.unsqueeze(0);
   auto final_reduce = TensorIterator::reduce_op(unsqueezed, buffer);
-  final_reduce.for_each(loop);
+  final_reduce.for_each(combine_loop);
 }
 
 /// Chooses a dimension over which to parallelize. Prefers the outer-most
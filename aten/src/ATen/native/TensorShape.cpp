@@ -21,7 +21,7 @@
 namespace at {
 namespace native {
 
-DEFINE_DISPATCH(cat_serial_stub);
+DEFINE_DISPATCH(cat_contig_stub);
 
 Tensor _reshape_from_tensor(const Tensor& self, const Tensor& shape_tensor) {
   TORCH_CHECK(shape_tensor.dim() == 1);
@@ -70,7 +70,7 @@ Tensor& set_cpu_(Tensor& result) {
   Storage storage(
       Storage::use_byte_size_t(),
       0,
-      c10::GetAllocator(kCPU),
+      at::getCPUAllocator(),
       true);
   result.set_(storage, 0, {0}, {});
   TORCH_INTERNAL_ASSERT(dtype == result.dtype());
@@ -136,6 +136,10 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   TORCH_CHECK(tensors.size() > 0, "expected a non-empty list of Tensors");
   TORCH_CHECK(dim <= notSkippedTensor.dim(), "dimension ", dim, "out of range");
 
+  // The result is in the memory format of the inputs, e.g. channels last, if
+  // they all have the same.
+  MemoryFormat memory_format = notSkippedTensor.suggest_memory_format();
+
   // when the input tensors are of the same size and strides,
   // reuse the same iterator for all input tensors
   bool reuse_iterator = true;
@@ -155,8 +159,8 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
     check_cat_shape_except_dim(notSkippedTensor, tensor, dim, i);
     cat_dim_size += tensor.size(dim);
 
-    if (!tensor.is_contiguous()) {
-      allContiguous = false;
+    if (tensor.suggest_memory_format() != memory_format) {
+      memory_format = MemoryFormat::Contiguous;
     }
 
     if (tensor.sizes() != notSkippedTensor.sizes() ||
@@ -170,14 +174,18 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   // compute the size of the result
   auto result_size = notSkippedTensor.sizes().vec();
   result_size[dim] = cat_dim_size;
-  result.resize_(result_size);
-
-  // fast path for single thread when both inputs and result are contiguous and not empty
-  bool use_serial_kernel = result.numel() < at::internal::GRAIN_SIZE || at::get_num_threads() == 1;
-  allContiguous = allContiguous && result.is_contiguous();
-  ScalarType dtype = notSkippedTensor.scalar_type();
-  if (use_serial_kernel && allContiguous && no_type_promotion && (dtype == ScalarType::Double || dtype == ScalarType::Float)) {
-    cat_serial_stub(kCPU, result, tensors, dim);
+  if (result.sizes() != result_size) {
+    result.resize_(result_size, memory_format);
+  }
+
+  // fast path when the inputs and the result are contiguous in the same
+  // memory format and none of them is empty
+  allContiguous = allContiguous && result.is_contiguous(memory_format);
+  for (auto const &tensor : tensors) {
+    allContiguous = allContiguous && tensor.is_contiguous(memory_format);
+  }
+  if (allContiguous && no_type_promotion) {
+    cat_contig_stub(kCPU, result, tensors, dim, memory_format);
     return result;
   }
 
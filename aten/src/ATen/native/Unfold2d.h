@@ -5,6 +5,11 @@
 
 namespace at { namespace native {
 
+// finput holds, for each output position, the input patch it is computed
+// from. It is [n_input_plane * kH * kW, output_height * output_width] for a
+// contiguous (CHW) input, and [output_height * output_width, kH * kW *
+// n_input_plane] for a channels last (HWC) input, so that the channels of a
+// patch are contiguous in both finput and input.
 using unfold2d_fn =
     void (*)(
     Tensor& finput,
@@ -19,7 +24,8 @@ using unfold2d_fn =
     int64_t input_height,
     int64_t input_width,
     int64_t output_height,
-    int64_t output_width
+    int64_t output_width,
+    bool is_channels_last
 );
 
 DECLARE_DISPATCH(unfold2d_fn, unfolded2d_copy_stub);
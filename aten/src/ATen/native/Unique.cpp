@@ -2,6 +2,8 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/NumericUtils.h>
 
 #include <set>
 #include <tuple>
@@ -13,6 +15,35 @@ namespace native{
 
 namespace {
 
+// Returns the distinct elements of input_data. Large inputs are split
+// between the threads, each building the set of its part, which are then
+// merged: for inputs with many duplicates, like ids, most of the hashing is
+// done in parallel.
+template <typename scalar_t>
+std::unordered_set<scalar_t> unique_set(const scalar_t* input_data, int64_t numel) {
+  const int num_threads = at::get_num_threads();
+  if (numel < at::internal::GRAIN_SIZE || num_threads == 1) {
+    return std::unordered_set<scalar_t>(input_data, input_data + numel);
+  }
+  std::vector<std::unordered_set<scalar_t>> thread_sets(num_threads);
+  at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    thread_sets[at::get_thread_num()].insert(input_data + begin, input_data + end);
+  });
+  int largest = 0;
+  for (int t = 1; t < num_threads; t++) {
+    if (thread_sets[t].size() > thread_sets[largest].size()) {
+      largest = t;
+    }
+  }
+  std::unordered_set<scalar_t> set = std::move(thread_sets[largest]);
+  for (int t = 0; t < num_threads; t++) {
+    if (t != largest) {
+      set.insert(thread_sets[t].begin(), thread_sets[t].end());
+    }
+  }
+  return set;
+}
+
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
     const Tensor& self,
@@ -26,7 +57,7 @@ std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
   Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
   Tensor counts = at::empty({0}, self.options().dtype(kLong));
 
-  std::unordered_set<scalar_t> set(input_data, input_data + numel);
+  std::unordered_set<scalar_t> set = unique_set(input_data, numel);
   output = at::empty({static_cast<int64_t>(set.size())}, input.options());
   scalar_t *output_data = output.data_ptr<scalar_t>();
 
@@ -39,30 +70,54 @@ std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
   }
 
   if (return_inverse || return_counts) {
+    const int64_t output_size = output.numel();
     inverse_indices.resize_(input.sizes());
     int64_t* inverse_indices_data = inverse_indices.data_ptr<int64_t>();
     std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int64_t i = 0; i < output.numel(); ++i) {
+    inverse_map.reserve(output_size);
+    for (int64_t i = 0; i < output_size; ++i) {
       inverse_map[output_data[i]] = i;
     }
-    for(int64_t i = 0; i < numel; ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
-    }
-    if (return_counts) {
-      std::unordered_map<scalar_t, int64_t> counts_map;
-      counts_map.reserve(output.numel());
-      for (int64_t i = 0; i < output.numel(); ++i) {
-        counts_map[output_data[i]] = 0;
-      }
-      for(int64_t i = 0; i < numel; i++) {
-        counts_map[input_data[i]] += 1;
+    // The map is only read from here on, so it can be shared by the threads.
+    // Elements that are not in the map, i.e. NaNs, get index 0 and are not
+    // counted.
+    at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        auto it = inverse_map.find(input_data[i]);
+        inverse_indices_data[i] = it == inverse_map.end() ? 0 : it->second;
       }
+    });
+    if (return_counts) {
       counts.resize_(output.sizes());
       counts.fill_(0);
       int64_t *counts_data = counts.data_ptr<int64_t>();
-      for(int64_t i = 0; i < output.numel(); i++) {
-        counts_data[i] = counts_map[output_data[i]];
+      const int num_threads = at::get_num_threads();
+      if (numel >= at::internal::GRAIN_SIZE && num_threads > 1 &&
+          output_size * num_threads <= numel) {
+        // One histogram of the inverse indices per thread.
+        std::vector<int64_t> thread_counts(num_threads * output_size, 0);
+        at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+          int64_t* local_counts = thread_counts.data() + at::get_thread_num() * output_size;
+          for (int64_t i = begin; i < end; i++) {
+            if (!_isnan(input_data[i])) {
+              local_counts[inverse_indices_data[i]] += 1;
+            }
+          }
+        });
+        at::parallel_for(0, output_size, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+          for (int t = 0; t < num_threads; t++) {
+            const int64_t* local_counts = thread_counts.data() + t * output_size;
+            for (int64_t i = begin; i < end; i++) {
+              counts_data[i] += local_counts[i];
+            }
+          }
+        });
+      } else {
+        for (int64_t i = 0; i < numel; i++) {
+          if (!_isnan(input_data[i])) {
+            counts_data[inverse_indices_data[i]] += 1;
+          }
+        }
       }
     }
   }
@@ -1,7 +1,10 @@
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/UpSample.h>
 
+#include <vector>
+
 namespace at {
 namespace native {
 namespace {
@@ -42,50 +45,64 @@ static void upsample_bicubic2d_out_frame(
   const scalar_t width_scale = area_pixel_compute_scale<scalar_t>(
       input_width, output_width, align_corners, scales_w);
 
-  for (int64_t output_y = 0; output_y < output_height; output_y++) {
-    for (int64_t output_x = 0; output_x < output_width; output_x++) {
-      scalar_t* in = idata;
-      scalar_t* out = odata;
-
-      const scalar_t real_x = area_pixel_compute_source_index(width_scale, output_x, align_corners, /*cubic=*/true);
-      int64_t input_x = floorf(real_x);
-      const scalar_t t_x = real_x - input_x;
+  // The 4 bounded source offsets and coefficients along an axis only depend
+  // on the output index along that axis: compute them once for all the
+  // batches and channels.
+  std::vector<int64_t> x_offsets(output_width * 4);
+  std::vector<scalar_t> x_coeffs(output_width * 4);
+  for (int64_t output_x = 0; output_x < output_width; output_x++) {
+    const scalar_t real_x = area_pixel_compute_source_index(width_scale, output_x, align_corners, /*cubic=*/true);
+    int64_t input_x = floorf(real_x);
+    const scalar_t t_x = real_x - input_x;
+    get_cubic_upsample_coefficients<scalar_t>(&x_coeffs[output_x * 4], t_x);
+    for (int64_t i = 0; i < 4; i++) {
+      x_offsets[output_x * 4 + i] = std::max(
+          std::min(input_x - 1 + i, input_width - 1), static_cast<int64_t>(0));
+    }
+  }
 
-      const scalar_t real_y = area_pixel_compute_source_index(height_scale, output_y, align_corners, /*cubic=*/true);
-      int64_t input_y = floorf(real_y);
-      const scalar_t t_y = real_y - input_y;
+  std::vector<int64_t> y_offsets(output_height * 4);
+  std::vector<scalar_t> y_coeffs(output_height * 4);
+  for (int64_t output_y = 0; output_y < output_height; output_y++) {
+    const scalar_t real_y = area_pixel_compute_source_index(height_scale, output_y, align_corners, /*cubic=*/true);
+    int64_t input_y = floorf(real_y);
+    const scalar_t t_y = real_y - input_y;
+    get_cubic_upsample_coefficients<scalar_t>(&y_coeffs[output_y * 4], t_y);
+    for (int64_t i = 0; i < 4; i++) {
+      y_offsets[output_y * 4 + i] = input_width * std::max(
+          std::min(input_y - 1 + i, input_height - 1), static_cast<int64_t>(0));
+    }
+  }
 
-      for (int64_t c = 0; c < channels * nbatch; c++) {
-        scalar_t coefficients[4];
+  const int64_t output_slice_size = output_height * output_width;
+  at::parallel_for(0, channels * nbatch, at::internal::GRAIN_SIZE / output_slice_size / 16, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const scalar_t* in = idata + c * input_height * input_width;
+      scalar_t* out = odata + c * output_slice_size;
+
+      for (int64_t output_y = 0; output_y < output_height; output_y++) {
+        const int64_t* yo = &y_offsets[output_y * 4];
+        const scalar_t* yc = &y_coeffs[output_y * 4];
+        for (int64_t output_x = 0; output_x < output_width; output_x++) {
+          const int64_t* xo = &x_offsets[output_x * 4];
+          const scalar_t* xc = &x_coeffs[output_x * 4];
+          scalar_t coefficients[4];
+
+          // Interpolate 4 times in the x direction
+          for (int64_t i = 0; i < 4; i++) {
+            const scalar_t* row = in + yo[i];
+            coefficients[i] = row[xo[0]] * xc[0] + row[xo[1]] * xc[1] +
+                row[xo[2]] * xc[2] + row[xo[3]] * xc[3];
+          }
 
-        // Interpolate 4 times in the x direction
-        for (int64_t i = 0; i < 4; i++) {
-          coefficients[i] = cubic_interp1d<scalar_t>(
-              upsample_get_value_bounded<scalar_t>(
-                  in, input_width, input_height, input_x - 1, input_y - 1 + i),
-              upsample_get_value_bounded<scalar_t>(
-                  in, input_width, input_height, input_x + 0, input_y - 1 + i),
-              upsample_get_value_bounded<scalar_t>(
-                  in, input_width, input_height, input_x + 1, input_y - 1 + i),
-              upsample_get_value_bounded<scalar_t>(
-                  in, input_width, input_height, input_x + 2, input_y - 1 + i),
-              t_x);
+          // Interpolate in the y direction using x interpolations
+          out[output_y * output_width + output_x] =
+              coefficients[0] * yc[0] + coefficients[1] * yc[1] +
+              coefficients[2] * yc[2] + coefficients[3] * yc[3];
         }
-
-        // Interpolate in the y direction using x interpolations
-        out[output_y * output_width + output_x] = cubic_interp1d<scalar_t>(
-            coefficients[0],
-            coefficients[1],
-            coefficients[2],
-            coefficients[3],
-            t_y);
-
-        // Move to next channel
-        in += input_width * input_height;
-        out += output_width * output_height;
       }
     }
-  }
+  });
 }
 
 template <typename scalar_t>
@@ -76,7 +76,7 @@ static void upsample_nearest2d_backward_out_cpu_template(
       output_height,
       output_width);
 
-  grad_input.resize_({nbatch, channels, input_height, input_width});
+  grad_input.resize_({nbatch, channels, input_height, input_width}, grad_output.suggest_memory_format());
   grad_input.zero_();
 
   upsample_nearest2d_backward_kernel(kCPU, grad_input, grad_output, scales_h, scales_w);
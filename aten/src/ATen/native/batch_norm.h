@@ -11,6 +11,31 @@ using batch_norm_fn = void (*)(Tensor&, const Tensor&, const Tensor&,
     const Tensor&, const Tensor&, const Tensor&, double);
 
 DECLARE_DISPATCH(batch_norm_fn, batch_norm_cpu_inference_contiguous_stub);
+// relu(batch_norm(input)) with the running statistics, for inputs contiguous
+// in either contiguous or channels last memory format
+DECLARE_DISPATCH(batch_norm_fn, batch_norm_relu_cpu_inference_stub);
+
+// Kernels for inputs contiguous in channels last memory format, which
+// vectorize over the channels, the innermost dim.
+
+// output = (input - mean) * invstd * weight + bias
+using batch_norm_channels_last_transform_fn = void (*)(Tensor& output,
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    const Tensor& mean, const Tensor& invstd);
+// Per channel mean and sum of the squared deviations from it
+using batch_norm_channels_last_collect_stats_fn = void (*)(Tensor& mean,
+    Tensor& var_sum, const Tensor& input);
+// Gradients for the given mean and invstd, grad_input, grad_weight and
+// grad_bias are undefined if not needed. In training mode grad_input also
+// flows through the batch statistics.
+using batch_norm_channels_last_backward_fn = void (*)(Tensor& grad_input,
+    Tensor& grad_weight, Tensor& grad_bias, const Tensor& grad_output,
+    const Tensor& input, const Tensor& weight, const Tensor& mean,
+    const Tensor& invstd, bool train);
+
+DECLARE_DISPATCH(batch_norm_channels_last_transform_fn, batch_norm_cpu_channels_last_transform_stub);
+DECLARE_DISPATCH(batch_norm_channels_last_collect_stats_fn, batch_norm_cpu_channels_last_collect_stats_stub);
+DECLARE_DISPATCH(batch_norm_channels_last_backward_fn, batch_norm_cpu_channels_last_backward_stub);
 
 } // namespace native
 
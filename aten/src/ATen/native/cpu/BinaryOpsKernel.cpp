@@ -1,9 +1,11 @@
 #include <cmath>
 #include <iostream>
+#include <type_traits>
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 #include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec512/vec512.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/BinaryOps.h>
 #include <ATen/native/cpu/Loops.h>
@@ -14,6 +16,22 @@ namespace {
 
 using namespace vec256;
 
+// The vector type of add, sub, mul and div, which are hot enough to make use
+// of AVX-512 on the machines that have it: Vec512 for float and double in the
+// AVX512 build of this file, Vec256 otherwise. Note that the AVX512 build also
+// defines CPU_CAPABILITY_AVX2, so that Vec256 keeps its AVX2 specializations.
+#ifdef CPU_CAPABILITY_AVX512
+template <typename scalar_t>
+using ArithVec = typename std::conditional<
+    std::is_same<scalar_t, float>::value ||
+        std::is_same<scalar_t, double>::value,
+    vec512::Vec512<scalar_t>,
+    Vec256<scalar_t>>::type;
+#else
+template <typename scalar_t>
+using ArithVec = Vec256<scalar_t>;
+#endif
+
 // Note: Undefined behavior when performing addition is intentionally
 // ignored.
 void add_kernel(TensorIterator& iter, Scalar alpha_scalar) {
@@ -25,11 +43,11 @@ void add_kernel(TensorIterator& iter, Scalar alpha_scalar) {
   } else {
     AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND2(kBFloat16, kHalf, iter.dtype(), "add_cpu/sub_cpu", [&]() {
       auto alpha = alpha_scalar.to<scalar_t>();
-      auto alpha_vec = Vec256<scalar_t>(alpha);
+      auto alpha_vec = ArithVec<scalar_t>(alpha);
       cpu_kernel_vec(iter,
         [=](scalar_t a, scalar_t b) __ubsan_ignore_undefined__ -> scalar_t { return a + alpha * b; },
-        [=](Vec256<scalar_t> a, Vec256<scalar_t> b) __ubsan_ignore_undefined__ {
-          return vec256::fmadd(b, alpha_vec, a);
+        [=](ArithVec<scalar_t> a, ArithVec<scalar_t> b) __ubsan_ignore_undefined__ {
+          return fmadd(b, alpha_vec, a);
         });
       });
   }
@@ -59,7 +77,7 @@ void mul_kernel(TensorIterator& iter) {
     AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND2(kBFloat16, kHalf, iter.dtype(), "mul_cpu", [&]() {
       cpu_kernel_vec(iter,
         [=](scalar_t a, scalar_t b) -> scalar_t { return a * b; },
-        [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
+        [=](ArithVec<scalar_t> a, ArithVec<scalar_t> b) {
           return a * b;
         });
     });
@@ -92,7 +110,7 @@ void div_kernel(TensorIterator& iter) {
           [=](scalar_t a, scalar_t b) __ubsan_ignore_float_divide_by_zero__ -> scalar_t {
             return a / b;
           },
-          [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
+          [=](ArithVec<scalar_t> a, ArithVec<scalar_t> b) {
             return a / b;
           });
       });
@@ -509,16 +527,35 @@ void smooth_l1_kernel(TensorIterator& iter) {
 }
 
 void sigmoid_backward_kernel(TensorIterator& iter) {
-  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "sigmoid_backward_cpu", [&]() {
-    auto one_vec = Vec256<scalar_t>((scalar_t)(1));
+  if (iter.dtype() == kBFloat16) {
+    // Computed in float, so that the result is rounded to BFloat16 only once.
+    auto one_vec = Vec256<float>((float)(1));
     cpu_kernel_vec(iter,
-      [=](scalar_t a, scalar_t b) -> scalar_t {
-        return a * (scalar_t(1) - b) * b;
+      [=](BFloat16 a, BFloat16 b) -> BFloat16 {
+        float a0 = static_cast<float>(a);
+        float b0 = static_cast<float>(b);
+        return a0 * (float(1) - b0) * b0;
       },
-      [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
-        return a * (one_vec - b) * b;
+      [=](Vec256<BFloat16> a, Vec256<BFloat16> b) {
+        Vec256<float> a0, a1, b0, b1;
+        std::tie(a0, a1) = convert_bfloat16_float(a);
+        std::tie(b0, b1) = convert_bfloat16_float(b);
+        a0 = a0 * (one_vec - b0) * b0;
+        a1 = a1 * (one_vec - b1) * b1;
+        return convert_float_bfloat16(a0, a1);
       });
-  });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "sigmoid_backward_cpu", [&]() {
+      auto one_vec = Vec256<scalar_t>((scalar_t)(1));
+      cpu_kernel_vec(iter,
+        [=](scalar_t a, scalar_t b) -> scalar_t {
+          return a * (scalar_t(1) - b) * b;
+        },
+        [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
+          return a * (one_vec - b) * b;
+        });
+    });
+  }
 }
 
 void tanh_backward_kernel(TensorIterator& iter) {
@@ -534,6 +571,24 @@ void tanh_backward_kernel(TensorIterator& iter) {
             return a * (one_vec - b * b);
           });
     });
+  } else if (iter.dtype() == kBFloat16) {
+    // Computed in float, so that the result is rounded to BFloat16 only once.
+    auto one_vec = Vec256<float>(float{1});
+    cpu_kernel_vec(
+        iter,
+        [=](BFloat16 a, BFloat16 b) -> BFloat16 {
+          float a0 = static_cast<float>(a);
+          float b0 = static_cast<float>(b);
+          return a0 * (float{1} - b0 * b0);
+        },
+        [=](Vec256<BFloat16> a, Vec256<BFloat16> b) {
+          Vec256<float> a0, a1, b0, b1;
+          std::tie(a0, a1) = convert_bfloat16_float(a);
+          std::tie(b0, b1) = convert_bfloat16_float(b);
+          a0 = a0 * (one_vec - b0 * b0);
+          a1 = a1 * (one_vec - b1 * b1);
+          return convert_float_bfloat16(a0, a1);
+        });
   } else {
     AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "tanh_backward_cpu", [&]() {
       auto one_vec = Vec256<scalar_t>(scalar_t{1});
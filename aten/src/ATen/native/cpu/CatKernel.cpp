@@ -1,75 +1,108 @@
 #include <ATen/ATen.h>
 
-#include <ATen/Dispatch.h>
 #include <ATen/native/cpu/CatKernel.h>
-#include <ATen/cpu/vec256/functional.h>
-#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/Parallel.h>
+
+#include <cstring>
+#include <numeric>
 
 namespace at { namespace native {
 
 namespace {
 
 struct InputMeta {
-  void* data_ptr;
-  int64_t inner_size;
-
-  InputMeta(const Tensor& t, int64_t dim, int64_t inner)
-    : data_ptr(t.data_ptr())
-    , inner_size(t.size(dim) * inner) {}
+  const char* data_ptr;
+  // Bytes of the input between two consecutive indices of the dimensions
+  // that come before dim in memory.
+  int64_t inner_bytes;
 };
 
-template <typename scalar_t>
-void cat_serial_kernel_impl(Tensor& result, TensorList tensors, int64_t dim) {
-  auto size = result.sizes().vec();
-  int64_t outer = 1, inner = 1;
-  for (int64_t i = 0; i < dim; i++) {
-    outer *= size[i];
+// Dimensions of a tensor of `ndim` dimensions, from the outermost to the
+// innermost in memory.
+std::vector<int64_t> memory_order(int64_t ndim, MemoryFormat memory_format) {
+  std::vector<int64_t> order(ndim);
+  std::iota(order.begin(), order.end(), 0);
+  if (memory_format == MemoryFormat::ChannelsLast ||
+      memory_format == MemoryFormat::ChannelsLast3d) {
+    // N, [D,] H, W, C
+    std::rotate(order.begin() + 1, order.begin() + 2, order.end());
   }
-  for (int64_t i = dim + 1; i < size.size(); i++) {
-    inner *= size[i];
+  return order;
+}
+
+void cat_contig_kernel(Tensor& result, TensorList tensors, int64_t dim, MemoryFormat memory_format) {
+  // The result is made of `outer` blocks, each made of one block of every
+  // input. A block is contiguous in memory, so each of them is one memcpy.
+  auto size = result.sizes();
+  const int64_t element_size = result.element_size();
+  int64_t outer = 1, inner = 1;
+  bool before_dim = true;
+  for (auto d : memory_order(result.dim(), memory_format)) {
+    if (d == dim) {
+      before_dim = false;
+    } else if (before_dim) {
+      outer *= size[d];
+    } else {
+      inner *= size[d];
+    }
   }
-  scalar_t* result_data = result.data_ptr<scalar_t>();
-  int64_t ninputs = tensors.size();
+
+  const int64_t ninputs = tensors.size();
   std::vector<InputMeta> inputs;
+  std::vector<int64_t> offsets;
   inputs.reserve(ninputs);
+  offsets.reserve(ninputs);
+  int64_t result_block_bytes = 0;
   for (auto const &tensor : tensors) {
-    inputs.emplace_back(tensor, dim, inner);
+    int64_t inner_bytes = tensor.size(dim) * inner * element_size;
+    inputs.push_back({static_cast<const char*>(tensor.data_ptr()), inner_bytes});
+    offsets.push_back(result_block_bytes);
+    result_block_bytes += inner_bytes;
   }
- 
-  using Vec = vec256::Vec256<scalar_t>;
-  int64_t offset = 0;
-  for (int64_t i = 0; i < outer; i++) {
-    for (int64_t j = 0; j < ninputs; j++) {
-      scalar_t* result_ptr = result_data + offset;
-      int64_t local_inner = inputs[j].inner_size;
-      scalar_t* input_ptr = (scalar_t*)(inputs[j].data_ptr) + i * local_inner;
-      if (local_inner < Vec::size()) {
-        #ifndef _MSC_VER
-        # pragma unroll
-        #endif
-        for (int64_t k = 0; k < local_inner; k++) {
-          result_ptr[k] = input_ptr[k];
-        }
-      } else {
-        vec256::map(
-            [](Vec x) { return x; },
-            result_ptr,
-            input_ptr,
-            local_inner);
-      }
-      offset += local_inner;
+  if (result_block_bytes == 0) {
+    return;
+  }
+  char* result_data = static_cast<char*>(result.data_ptr());
+
+  const int64_t nblocks = outer * ninputs;
+  const int64_t block_numel = std::max<int64_t>(result_block_bytes / element_size / ninputs, 1);
+  if (block_numel >= at::internal::GRAIN_SIZE) {
+    // Few large blocks: split each of them.
+    const int64_t grain_bytes = at::internal::GRAIN_SIZE * element_size;
+    for (int64_t b = 0; b < nblocks; b++) {
+      const int64_t i = b / ninputs;
+      const int64_t j = b % ninputs;
+      const auto& input = inputs[j];
+      char* dst = result_data + i * result_block_bytes + offsets[j];
+      const char* src = input.data_ptr + i * input.inner_bytes;
+      at::parallel_for(0, input.inner_bytes, grain_bytes, [&](int64_t begin, int64_t end) {
+        std::memcpy(dst + begin, src + begin, end - begin);
+      });
     }
+    return;
   }
-}
 
-void cat_serial_kernel(Tensor& result, TensorList tensors, int64_t dim) {
-  AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "cat_serial_kernel", [&]() {
-    cat_serial_kernel_impl<scalar_t>(result, tensors, dim);
+  // Many small blocks, e.g. the inputs of stack: copy several of them per
+  // task.
+  const int64_t grain_size = at::internal::GRAIN_SIZE / block_numel;
+  at::parallel_for(0, nblocks, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t i = b / ninputs;
+      const int64_t j = b % ninputs;
+      const auto& input = inputs[j];
+      if (input.inner_bytes == 0) {
+        continue;
+      }
+      std::memcpy(
+          result_data + i * result_block_bytes + offsets[j],
+          input.data_ptr + i * input.inner_bytes,
+          input.inner_bytes);
+    }
   });
 }
 
 } // anonymous namespace
 
-REGISTER_DISPATCH(cat_serial_stub, &cat_serial_kernel);
+REGISTER_DISPATCH(cat_contig_stub, &cat_contig_kernel);
 
 }} // at::native
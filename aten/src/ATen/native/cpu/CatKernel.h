@@ -5,7 +5,9 @@
 
 namespace at { namespace native {
 
-using cat_serial_fn = void(*)(Tensor &, TensorList, int64_t);
-DECLARE_DISPATCH(cat_serial_fn, cat_serial_stub);
+// Concatenates inputs that have the dtype of the result, and that are, like
+// the result, contiguous in memory_format.
+using cat_contig_fn = void(*)(Tensor &, TensorList, int64_t, MemoryFormat);
+DECLARE_DISPATCH(cat_contig_fn, cat_contig_stub);
 
 }}  // namespace at::native
@@ -0,0 +1,439 @@
+#include <ATen/native/cpu/ConvolutionKernel.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <TH/THBlasUtils.h>
+
+namespace at {
+namespace native {
+namespace {
+
+using namespace vec256;
+
+// Winograd F(4x4, 3x3), with the interpolation points 0, 1, -1, 2 and -2.
+// Every 4x4 tile of output is A^T [(G g G^T) . (B^T d B)] A, where g is the
+// 3x3 filter and d the 6x6 tile of input the output tile depends on. Summed
+// over input channels, the elementwise products become 36 matrix products of
+// the transformed filters by the transformed tiles.
+constexpr int64_t kOutTile = 4;
+constexpr int64_t kInTile = 6;
+constexpr int64_t kTileElems = kInTile * kInTile;
+// Number of tiles a thread transforms and multiplies at once
+constexpr int64_t kTileBlock = 32;
+
+// y = G x, for x of 3 elements and y of 6
+inline void weight_transform_1d(const float* x, int64_t xs, float* y, int64_t ys) {
+  const float x0 = x[0], x1 = x[xs], x2 = x[2 * xs];
+  y[0] = x0 / 4;
+  y[ys] = -(x0 + x1 + x2) / 6;
+  y[2 * ys] = -(x0 - x1 + x2) / 6;
+  y[3 * ys] = x0 / 24 + x1 / 12 + x2 / 6;
+  y[4 * ys] = x0 / 24 - x1 / 12 + x2 / 6;
+  y[5 * ys] = x2;
+}
+
+// y = B^T x, for x and y of 6 elements
+inline void input_transform_1d(const float* x, int64_t xs, float* y, int64_t ys) {
+  const float x0 = x[0], x1 = x[xs], x2 = x[2 * xs];
+  const float x3 = x[3 * xs], x4 = x[4 * xs], x5 = x[5 * xs];
+  y[0] = 4 * x0 - 5 * x2 + x4;
+  y[ys] = -4 * (x1 + x2) + x3 + x4;
+  y[2 * ys] = 4 * (x1 - x2) - x3 + x4;
+  y[3 * ys] = 2 * (x3 - x1) - x2 + x4;
+  y[4 * ys] = 2 * (x1 - x3) - x2 + x4;
+  y[5 * ys] = 4 * x1 - 5 * x3 + x5;
+}
+
+// y = A^T x, for x of 6 elements and y of 4
+inline void output_transform_1d(const float* x, int64_t xs, float* y, int64_t ys) {
+  const float x0 = x[0], x1 = x[xs], x2 = x[2 * xs];
+  const float x3 = x[3 * xs], x4 = x[4 * xs], x5 = x[5 * xs];
+  y[0] = x0 + x1 + x2 + x3 + x4;
+  y[ys] = x1 - x2 + 2 * (x3 - x4);
+  y[2 * ys] = x1 + x2 + 4 * (x3 + x4);
+  y[3 * ys] = x1 - x2 + 8 * (x3 - x4) + x5;
+}
+
+Tensor _convolution_winograd4x3(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef padding) {
+  const int64_t batch = input.size(0);
+  const int64_t in_channels = input.size(1);
+  const int64_t in_rows = input.size(2);
+  const int64_t in_cols = input.size(3);
+  const int64_t out_channels = weight.size(0);
+  const int64_t pad_rows = padding[0];
+  const int64_t pad_cols = padding[1];
+  const int64_t out_rows = in_rows + 2 * pad_rows - 2;
+  const int64_t out_cols = in_cols + 2 * pad_cols - 2;
+
+  Tensor output = at::empty({batch, out_channels, out_rows, out_cols}, input.options());
+
+  const int64_t tile_rows = divup(out_rows, kOutTile);
+  const int64_t tile_cols = divup(out_cols, kOutTile);
+  const int64_t image_tiles = tile_rows * tile_cols;
+  const int64_t num_tiles = batch * image_tiles;
+
+  // Transformed filters, as 36 out_channels x in_channels matrices
+  const int64_t filters = out_channels * in_channels;
+  std::vector<float> u(kTileElems * filters);
+  const float* w = weight.data_ptr<float>();
+  at::parallel_for(0, filters, 64, [&](int64_t begin, int64_t end) {
+    float tmp[kInTile * 3];
+    float tile[kTileElems];
+    for (int64_t f = begin; f < end; f++) {
+      const float* g = w + f * 9;
+      for (int64_t j = 0; j < 3; j++) {
+        weight_transform_1d(g + j, 3, tmp + j, 3);
+      }
+      for (int64_t i = 0; i < kInTile; i++) {
+        weight_transform_1d(tmp + i * 3, 1, tile + i * kInTile, 1);
+      }
+      for (int64_t e = 0; e < kTileElems; e++) {
+        u[e * filters + f] = tile[e];
+      }
+    }
+  });
+
+  const float* in = input.data_ptr<float>();
+  const float* b = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* out = output.data_ptr<float>();
+  at::parallel_for(0, divup(num_tiles, kTileBlock), 1, [&](int64_t begin, int64_t end) {
+    // Transformed tiles, as 36 in_channels x tiles matrices, and their
+    // products with the transformed filters, as 36 out_channels x tiles ones
+    std::vector<float> v(kTileElems * in_channels * kTileBlock);
+    std::vector<float> m(kTileElems * out_channels * kTileBlock);
+    float d[kTileElems];
+    float tmp[kTileElems];
+    float tile[kTileElems];
+    for (int64_t block = begin; block < end; block++) {
+      const int64_t t0 = block * kTileBlock;
+      const int64_t nt = std::min(kTileBlock, num_tiles - t0);
+
+      for (int64_t t = 0; t < nt; t++) {
+        const int64_t n = (t0 + t) / image_tiles;
+        const int64_t r = (t0 + t) % image_tiles;
+        const int64_t row0 = (r / tile_cols) * kOutTile - pad_rows;
+        const int64_t col0 = (r % tile_cols) * kOutTile - pad_cols;
+        for (int64_t c = 0; c < in_channels; c++) {
+          const float* plane = in + (n * in_channels + c) * in_rows * in_cols;
+          for (int64_t i = 0; i < kInTile; i++) {
+            const int64_t row = row0 + i;
+            for (int64_t j = 0; j < kInTile; j++) {
+              const int64_t col = col0 + j;
+              d[i * kInTile + j] = (row >= 0 && row < in_rows && col >= 0 && col < in_cols)
+                  ? plane[row * in_cols + col] : 0.0f;
+            }
+          }
+          for (int64_t j = 0; j < kInTile; j++) {
+            input_transform_1d(d + j, kInTile, tmp + j, kInTile);
+          }
+          for (int64_t i = 0; i < kInTile; i++) {
+            input_transform_1d(tmp + i * kInTile, 1, tile + i * kInTile, 1);
+          }
+          for (int64_t e = 0; e < kTileElems; e++) {
+            v[(e * in_channels + c) * nt + t] = tile[e];
+          }
+        }
+      }
+
+      // The matrices are row major, so BLAS computes their transposes.
+      for (int64_t e = 0; e < kTileElems; e++) {
+        THBlas_gemm<float>(
+            'n', 'n', nt, out_channels, in_channels,
+            1.0f, v.data() + e * in_channels * nt, nt,
+            u.data() + e * filters, in_channels,
+            0.0f, m.data() + e * out_channels * nt, nt);
+      }
+
+      for (int64_t t = 0; t < nt; t++) {
+        const int64_t n = (t0 + t) / image_tiles;
+        const int64_t r = (t0 + t) % image_tiles;
+        const int64_t row0 = (r / tile_cols) * kOutTile;
+        const int64_t col0 = (r % tile_cols) * kOutTile;
+        const int64_t rows = std::min(kOutTile, out_rows - row0);
+        const int64_t cols = std::min(kOutTile, out_cols - col0);
+        for (int64_t k = 0; k < out_channels; k++) {
+          for (int64_t e = 0; e < kTileElems; e++) {
+            d[e] = m[(e * out_channels + k) * nt + t];
+          }
+          for (int64_t j = 0; j < kInTile; j++) {
+            output_transform_1d(d + j, kInTile, tmp + j, kInTile);
+          }
+          for (int64_t i = 0; i < kOutTile; i++) {
+            output_transform_1d(tmp + i * kInTile, 1, tile + i * kOutTile, 1);
+          }
+          const float bias_k = b ? b[k] : 0.0f;
+          float* plane = out + (n * out_channels + k) * out_rows * out_cols;
+          for (int64_t i = 0; i < rows; i++) {
+            for (int64_t j = 0; j < cols; j++) {
+              plane[(row0 + i) * out_cols + col0 + j] = tile[i * kOutTile + j] + bias_k;
+            }
+          }
+        }
+      }
+    }
+  });
+
+  return output;
+}
+
+// Direct convolution of channels last tensors. The filters are rearranged as
+// a (kernel row, kernel column, input channel) x out_channels row major
+// matrix, so that every output pixel is a sum of rows of it scaled by input
+// elements, which are vectorized over output channels. A micro kernel
+// accumulates kPixels consecutive pixels of an output row by two vectors of
+// channels in registers.
+constexpr int64_t kPixels = 4;
+
+void direct_micro_kernel(
+    const float* const* pixels,
+    const float* w,
+    int64_t in_channels,
+    int64_t out_channels,
+    int64_t nk,
+    Vec256<float>* acc0,
+    Vec256<float>* acc1) {
+  using Vec = Vec256<float>;
+  const int64_t nk0 = std::min<int64_t>(nk, Vec::size());
+  const int64_t nk1 = nk - nk0;
+  for (int64_t c = 0; c < in_channels; c++) {
+    const float* w_c = w + c * out_channels;
+    Vec w0, w1;
+    if (nk == 2 * Vec::size()) {
+      w0 = Vec::loadu(w_c);
+      w1 = Vec::loadu(w_c + Vec::size());
+    } else {
+      w0 = Vec::loadu(w_c, nk0);
+      w1 = nk1 > 0 ? Vec::loadu(w_c + Vec::size(), nk1) : Vec(0.0f);
+    }
+    for (int64_t p = 0; p < kPixels; p++) {
+      const Vec x(pixels[p][c]);
+      acc0[p] = fmadd(x, w0, acc0[p]);
+      acc1[p] = fmadd(x, w1, acc1[p]);
+    }
+  }
+}
+
+Tensor _convolution_channels_last(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation) {
+  using Vec = Vec256<float>;
+  const int64_t batch = input.size(0);
+  const int64_t in_channels = input.size(1);
+  const int64_t in_rows = input.size(2);
+  const int64_t in_cols = input.size(3);
+  const int64_t out_channels = weight.size(0);
+  const int64_t kernel_rows = weight.size(2);
+  const int64_t kernel_cols = weight.size(3);
+  const int64_t out_rows =
+      (in_rows + 2 * padding[0] - dilation[0] * (kernel_rows - 1) - 1) / stride[0] + 1;
+  const int64_t out_cols =
+      (in_cols + 2 * padding[1] - dilation[1] * (kernel_cols - 1) - 1) / stride[1] + 1;
+
+  Tensor output = at::empty(
+      {batch, out_channels, out_rows, out_cols},
+      input.options().memory_format(at::MemoryFormat::ChannelsLast));
+
+  const Tensor w_packed = weight.permute({2, 3, 1, 0}).contiguous();
+  const float* w = w_packed.data_ptr<float>();
+  const float* in = input.data_ptr<float>();
+  const float* b = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* out = output.data_ptr<float>();
+  // Pixels in the padding, and the ones past the end of a row, read these
+  const std::vector<float> zeros(in_channels, 0.0f);
+
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(
+          1, out_cols * out_channels * in_channels * kernel_rows * kernel_cols));
+  at::parallel_for(0, batch * out_rows, grain_size, [&](int64_t begin, int64_t end) {
+    const float* pixels[kPixels];
+    Vec acc0[kPixels];
+    Vec acc1[kPixels];
+    for (int64_t nr = begin; nr < end; nr++) {
+      const int64_t n = nr / out_rows;
+      const int64_t oh = nr % out_rows;
+      float* out_row = out + nr * out_cols * out_channels;
+      for (int64_t ow0 = 0; ow0 < out_cols; ow0 += kPixels) {
+        const int64_t np = std::min(kPixels, out_cols - ow0);
+        for (int64_t k0 = 0; k0 < out_channels; k0 += 2 * Vec::size()) {
+          const int64_t nk = std::min<int64_t>(2 * Vec::size(), out_channels - k0);
+          for (int64_t p = 0; p < kPixels; p++) {
+            acc0[p] = Vec(0.0f);
+            acc1[p] = Vec(0.0f);
+          }
+          for (int64_t r = 0; r < kernel_rows; r++) {
+            const int64_t ih = oh * stride[0] - padding[0] + r * dilation[0];
+            if (ih < 0 || ih >= in_rows) {
+              continue;
+            }
+            const float* in_row = in + (n * in_rows + ih) * in_cols * in_channels;
+            for (int64_t s = 0; s < kernel_cols; s++) {
+              for (int64_t p = 0; p < kPixels; p++) {
+                const int64_t iw = (ow0 + p) * stride[1] - padding[1] + s * dilation[1];
+                pixels[p] = (p < np && iw >= 0 && iw < in_cols)
+                    ? in_row + iw * in_channels : zeros.data();
+              }
+              direct_micro_kernel(
+                  pixels,
+                  w + (r * kernel_cols + s) * in_channels * out_channels + k0,
+                  in_channels,
+                  out_channels,
+                  nk,
+                  acc0,
+                  acc1);
+            }
+          }
+          const int64_t nk0 = std::min<int64_t>(nk, Vec::size());
+          const int64_t nk1 = nk - nk0;
+          const Vec bias0 = b ? Vec::loadu(b + k0, nk0) : Vec(0.0f);
+          const Vec bias1 = b && nk1 > 0 ? Vec::loadu(b + k0 + Vec::size(), nk1) : Vec(0.0f);
+          for (int64_t p = 0; p < np; p++) {
+            float* y = out_row + (ow0 + p) * out_channels + k0;
+            (acc0[p] + bias0).store(y, nk0);
+            if (nk1 > 0) {
+              (acc1[p] + bias1).store(y + Vec::size(), nk1);
+            }
+          }
+        }
+      }
+    }
+  });
+
+  return output;
+}
+
+// Direct transposed convolution of channels last tensors, gathering every
+// output pixel from the input pixels it depends on instead of scattering
+// columns as col2im does. The input pixel of output column ow and kernel
+// column s is (ow + padding - s * dilation) / stride, when that divides
+// exactly, which only depends on ow modulo the stride. The output columns of
+// a row are thus split in stride phases, in which consecutive columns read
+// consecutive input pixels through the same filters, and are run through the
+// micro kernel of the direct convolution kPixels at a time.
+Tensor _convolution_transpose_channels_last(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef output_padding,
+    IntArrayRef dilation) {
+  using Vec = Vec256<float>;
+  const int64_t batch = input.size(0);
+  const int64_t in_channels = input.size(1);
+  const int64_t in_rows = input.size(2);
+  const int64_t in_cols = input.size(3);
+  const int64_t out_channels = weight.size(1);
+  const int64_t kernel_rows = weight.size(2);
+  const int64_t kernel_cols = weight.size(3);
+  const int64_t out_rows = (in_rows - 1) * stride[0] - 2 * padding[0] +
+      dilation[0] * (kernel_rows - 1) + output_padding[0] + 1;
+  const int64_t out_cols = (in_cols - 1) * stride[1] - 2 * padding[1] +
+      dilation[1] * (kernel_cols - 1) + output_padding[1] + 1;
+
+  Tensor output = at::empty(
+      {batch, out_channels, out_rows, out_cols},
+      input.options().memory_format(at::MemoryFormat::ChannelsLast));
+
+  // (in_channels, out_channels, kernel_rows, kernel_cols) to
+  // (kernel_rows, kernel_cols, in_channels, out_channels)
+  const Tensor w_packed = weight.permute({2, 3, 0, 1}).contiguous();
+  const float* w = w_packed.data_ptr<float>();
+  const float* in = input.data_ptr<float>();
+  const float* b = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* out = output.data_ptr<float>();
+  const std::vector<float> zeros(in_channels, 0.0f);
+
+  // Each output pixel reads about kernel size / stride^2 input pixels
+  const int64_t taps = std::max<int64_t>(
+      1, (kernel_rows * kernel_cols) / (stride[0] * stride[1]));
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(
+          1, out_cols * out_channels * in_channels * taps));
+  at::parallel_for(0, batch * out_rows, grain_size, [&](int64_t begin, int64_t end) {
+    const float* pixels[kPixels];
+    Vec acc0[kPixels];
+    Vec acc1[kPixels];
+    for (int64_t nr = begin; nr < end; nr++) {
+      const int64_t n = nr / out_rows;
+      const int64_t oh = nr % out_rows;
+      float* out_row = out + nr * out_cols * out_channels;
+      for (int64_t phase = 0; phase < std::min(stride[1], out_cols); phase++) {
+        const int64_t phase_cols = (out_cols - phase + stride[1] - 1) / stride[1];
+        for (int64_t j0 = 0; j0 < phase_cols; j0 += kPixels) {
+          const int64_t np = std::min(kPixels, phase_cols - j0);
+          for (int64_t k0 = 0; k0 < out_channels; k0 += 2 * Vec::size()) {
+            const int64_t nk = std::min<int64_t>(2 * Vec::size(), out_channels - k0);
+            for (int64_t p = 0; p < kPixels; p++) {
+              acc0[p] = Vec(0.0f);
+              acc1[p] = Vec(0.0f);
+            }
+            for (int64_t r = 0; r < kernel_rows; r++) {
+              const int64_t ih_scaled = oh + padding[0] - r * dilation[0];
+              if (ih_scaled < 0 || ih_scaled % stride[0] != 0 ||
+                  ih_scaled / stride[0] >= in_rows) {
+                continue;
+              }
+              const float* in_row =
+                  in + (n * in_rows + ih_scaled / stride[0]) * in_cols * in_channels;
+              for (int64_t s = 0; s < kernel_cols; s++) {
+                const int64_t iw0_scaled = phase + padding[1] - s * dilation[1];
+                if (((iw0_scaled % stride[1]) + stride[1]) % stride[1] != 0) {
+                  continue;
+                }
+                for (int64_t p = 0; p < kPixels; p++) {
+                  const int64_t iw_scaled = iw0_scaled + (j0 + p) * stride[1];
+                  const int64_t iw = iw_scaled / stride[1];
+                  pixels[p] = (p < np && iw_scaled >= 0 && iw < in_cols)
+                      ? in_row + iw * in_channels : zeros.data();
+                }
+                direct_micro_kernel(
+                    pixels,
+                    w + (r * kernel_cols + s) * in_channels * out_channels + k0,
+                    in_channels,
+                    out_channels,
+                    nk,
+                    acc0,
+                    acc1);
+              }
+            }
+            const int64_t nk0 = std::min<int64_t>(nk, Vec::size());
+            const int64_t nk1 = nk - nk0;
+            const Vec bias0 = b ? Vec::loadu(b + k0, nk0) : Vec(0.0f);
+            const Vec bias1 = b && nk1 > 0 ? Vec::loadu(b + k0 + Vec::size(), nk1) : Vec(0.0f);
+            for (int64_t p = 0; p < np; p++) {
+              const int64_t ow = phase + (j0 + p) * stride[1];
+              float* y = out_row + ow * out_channels + k0;
+              (acc0[p] + bias0).store(y, nk0);
+              if (nk1 > 0) {
+                (acc1[p] + bias1).store(y + Vec::size(), nk1);
+              }
+            }
+          }
+        }
+      }
+    }
+  });
+
+  return output;
+}
+
+}  // namespace
+
+REGISTER_DISPATCH(convolution_winograd4x3_stub, &_convolution_winograd4x3);
+REGISTER_DISPATCH(convolution_channels_last_stub, &_convolution_channels_last);
+REGISTER_DISPATCH(convolution_transpose_channels_last_stub, &_convolution_transpose_channels_last);
+
+}  // namespace native
+}  // namespace at
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+/*
+  Float convolutions of CPU tensors without MKLDNN:
+  - Winograd F(4x4, 3x3) for 3x3 convolutions of stride 1 of NCHW tensors
+  - Direct convolution of channels last tensors
+  - Direct transposed convolution of channels last tensors
+*/
+
+namespace at {
+namespace native {
+
+// (input, weight, bias, padding)
+using convolution_winograd4x3_fn =
+    Tensor (*)(const Tensor &, const Tensor &, const Tensor &, IntArrayRef);
+// (input, weight, bias, stride, padding, dilation)
+using convolution_channels_last_fn =
+    Tensor (*)(const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef);
+// (input, weight, bias, stride, padding, output_padding, dilation)
+using convolution_transpose_channels_last_fn =
+    Tensor (*)(const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef, IntArrayRef);
+
+DECLARE_DISPATCH(convolution_winograd4x3_fn, convolution_winograd4x3_stub);
+DECLARE_DISPATCH(convolution_channels_last_fn, convolution_channels_last_stub);
+DECLARE_DISPATCH(convolution_transpose_channels_last_fn, convolution_transpose_channels_last_stub);
+
+}  // namespace native
+}  // namespace at
@@ -4,6 +4,8 @@
 #include <ATen/native/Copy.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <c10/util/TypeCast.h>
 
 namespace at {
@@ -57,16 +59,193 @@ static void copy_kernel(TensorIterator& iter, bool non_blocking) {
         // If done correctly, the above command should have no output.
         //
         // See: https://github.com/pytorch/pytorch/issues/31271
-        cpu_kernel(iter, [](scalar_t src) -> dest_t {
-          return c10::static_cast_with_inter_type<dest_t, scalar_t>::apply(src); });
+        //
+        // Contiguous runs go through vec256::convert instead, which is
+        // vectorized for some pairs, like float and BFloat16 or uint8 and
+        // float.
+        iter.for_each([](char** data, const int64_t* strides, int64_t n) {
+          if (strides[0] == sizeof(dest_t) && strides[1] == sizeof(scalar_t)) {
+            vec256::convert(
+                reinterpret_cast<const scalar_t*>(data[1]),
+                reinterpret_cast<dest_t*>(data[0]),
+                n);
+            return;
+          }
+          char* dst = data[0];
+          const char* src = data[1];
+          for (int64_t i = 0; i < n; i++) {
+            *reinterpret_cast<dest_t*>(dst) =
+                c10::static_cast_with_inter_type<dest_t, scalar_t>::apply(
+                    *reinterpret_cast<const scalar_t*>(src));
+            dst += strides[0];
+            src += strides[1];
+          }
+        });
       });
     });
   }
 }
 
+// Transposes tiles of the source into the destination, see
+// TransposeCopyParams. scalar_t only needs to have the size of the elements.
+template <typename scalar_t>
+struct TransposeTile {
+  static void apply(
+      scalar_t* dst, int64_t dst_stride,
+      const scalar_t* src, int64_t src_stride,
+      int64_t nrows, int64_t ncols) {
+    for (int64_t r = 0; r < nrows; r++) {
+      for (int64_t c = 0; c < ncols; c++) {
+        dst[r * dst_stride + c] = src[c * src_stride + r];
+      }
+    }
+  }
+};
+
+#if (defined(CPU_CAPABILITY_AVX) || defined(CPU_CAPABILITY_AVX2)) && !defined(_MSC_VER)
+
+// Transposes the 8x8 matrix whose rows are r0 to r7.
+inline void transpose_8x8(
+    __m256& r0, __m256& r1, __m256& r2, __m256& r3,
+    __m256& r4, __m256& r5, __m256& r6, __m256& r7) {
+  __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+  __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+  r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+  r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+  r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+  r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+  r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+  r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+  r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// 4 byte elements are moved as floats, 8x8 at a time in registers.
+template <>
+struct TransposeTile<int32_t> {
+  static void apply(
+      int32_t* dst_, int64_t dst_stride,
+      const int32_t* src_, int64_t src_stride,
+      int64_t nrows, int64_t ncols) {
+    float* dst = reinterpret_cast<float*>(dst_);
+    const float* src = reinterpret_cast<const float*>(src_);
+    int64_t r = 0;
+    for (; r + 8 <= nrows; r += 8) {
+      int64_t c = 0;
+      for (; c + 8 <= ncols; c += 8) {
+        const float* s = src + c * src_stride + r;
+        __m256 r0 = _mm256_loadu_ps(s);
+        __m256 r1 = _mm256_loadu_ps(s + src_stride);
+        __m256 r2 = _mm256_loadu_ps(s + 2 * src_stride);
+        __m256 r3 = _mm256_loadu_ps(s + 3 * src_stride);
+        __m256 r4 = _mm256_loadu_ps(s + 4 * src_stride);
+        __m256 r5 = _mm256_loadu_ps(s + 5 * src_stride);
+        __m256 r6 = _mm256_loadu_ps(s + 6 * src_stride);
+        __m256 r7 = _mm256_loadu_ps(s + 7 * src_stride);
+        transpose_8x8(r0, r1, r2, r3, r4, r5, r6, r7);
+        float* d = dst + r * dst_stride + c;
+        _mm256_storeu_ps(d, r0);
+        _mm256_storeu_ps(d + dst_stride, r1);
+        _mm256_storeu_ps(d + 2 * dst_stride, r2);
+        _mm256_storeu_ps(d + 3 * dst_stride, r3);
+        _mm256_storeu_ps(d + 4 * dst_stride, r4);
+        _mm256_storeu_ps(d + 5 * dst_stride, r5);
+        _mm256_storeu_ps(d + 6 * dst_stride, r6);
+        _mm256_storeu_ps(d + 7 * dst_stride, r7);
+      }
+      TransposeTile<float>::apply(
+          dst + r * dst_stride + c, dst_stride,
+          src + c * src_stride + r, src_stride,
+          8, ncols - c);
+    }
+    TransposeTile<float>::apply(
+        dst + r * dst_stride, dst_stride,
+        src + r, src_stride,
+        nrows - r, ncols);
+  }
+};
+
+#endif
+
+template <typename scalar_t>
+void transpose_copy_impl(const TransposeCopyParams& params) {
+  // Tiles small enough for the source and destination rows they touch to
+  // stay in L1.
+  constexpr int64_t BLOCK_SZ = 128 / sizeof(scalar_t);
+  auto dst = reinterpret_cast<scalar_t*>(params.dst);
+  auto src = reinterpret_cast<const scalar_t*>(params.src);
+  const int64_t rows = params.rows;
+  const int64_t cols = params.cols;
+  const int64_t col_stride = params.col_stride;
+  int64_t batch = 1;
+  for (auto size : params.batch_sizes) {
+    batch *= size;
+  }
+  const int64_t row_blocks = (rows + BLOCK_SZ - 1) / BLOCK_SZ;
+  const int64_t grain_size =
+      std::max<int64_t>(at::internal::GRAIN_SIZE / (BLOCK_SZ * cols), 1);
+
+  at::parallel_for(0, batch * row_blocks, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; task++) {
+      const int64_t b = task / row_blocks;
+      const int64_t r = (task % row_blocks) * BLOCK_SZ;
+      int64_t src_offset = 0;
+      int64_t index = b;
+      for (size_t d = 0; d < params.batch_sizes.size(); d++) {
+        src_offset += (index % params.batch_sizes[d]) * params.batch_strides[d];
+        index /= params.batch_sizes[d];
+      }
+      const int64_t nrows = std::min(BLOCK_SZ, rows - r);
+      scalar_t* dst_block = dst + (b * rows + r) * cols;
+      const scalar_t* src_block = src + src_offset + r;
+      for (int64_t c = 0; c < cols; c += BLOCK_SZ) {
+        TransposeTile<scalar_t>::apply(
+            dst_block + c, cols,
+            src_block + c * col_stride, col_stride,
+            nrows, std::min(BLOCK_SZ, cols - c));
+      }
+    }
+  });
+}
+
+// Transposition only moves elements, so it is dispatched on their size.
+static void transpose_copy_kernel(const TransposeCopyParams& params) {
+  switch (params.element_size) {
+    case 1:
+      transpose_copy_impl<uint8_t>(params);
+      break;
+    case 2:
+      transpose_copy_impl<int16_t>(params);
+      break;
+    case 4:
+      transpose_copy_impl<int32_t>(params);
+      break;
+    case 8:
+      transpose_copy_impl<int64_t>(params);
+      break;
+    default:
+      TORCH_INTERNAL_ASSERT(false, "transpose_copy: unsupported element size ", params.element_size);
+  }
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(copy_stub, &copy_kernel);
+REGISTER_DISPATCH(transpose_copy_stub, &transpose_copy_kernel);
 
 } // namespace native
 } // namespace at
@@ -3,10 +3,14 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
 #include <ATen/cpu/vml.h>
+#include <TH/THBlasUtils.h>
 
 namespace at { namespace native { namespace {
 
@@ -408,6 +412,171 @@ struct Dist {
 
 };
 
+// Euclidean distances computed as sqrt(|a|^2 + |b|^2 - 2 a.b), one tile of
+// rows of x1 by rows of x2 at a time. The dot products of a tile come from a
+// gemm, and the row norms are added in the same pass that takes the square
+// root, while the tile is still in cache.
+template <typename scalar_t>
+struct EuclideanDist {
+  using Vec = vec256::Vec256<scalar_t>;
+
+  static constexpr int64_t kRowBlock = 64;
+  static constexpr int64_t kColBlock = 256;
+
+  static scalar_t squared_norm(const scalar_t* x, int64_t m) {
+    Vec acc(0);
+    int64_t i = 0;
+    for (; i + Vec::size() <= m; i += Vec::size()) {
+      const Vec v = Vec::loadu(x + i);
+      acc = acc + v * v;
+    }
+    if (i < m) {
+      const Vec v = Vec::loadu(x + i, m - i);
+      acc = acc + v * v;
+    }
+    __at_align32__ scalar_t buf[Vec::size()];
+    acc.store(buf);
+    return std::accumulate(buf, buf + Vec::size(), scalar_t(0));
+  }
+
+  static std::vector<scalar_t> squared_norms(const Tensor& x) {
+    const int64_t rows = x.numel() / x.size(-1);
+    const int64_t m = x.size(-1);
+    const scalar_t* data = x.data_ptr<scalar_t>();
+    std::vector<scalar_t> norms(rows);
+    parallel_for(0, rows, internal::GRAIN_SIZE / (16 * m), [&](int64_t start, int64_t end) {
+      for (int64_t i = start; i < end; i++) {
+        norms[i] = squared_norm(data + i * m, m);
+      }
+    });
+    return norms;
+  }
+
+  // Writes -2 times the dot products of the rows [i0, i0 + ib) of x1 with the
+  // rows [j0, j0 + jb) of x2 to the ib x jb row-major tile d of leading
+  // dimension ldd.
+  static void dot_tile(const scalar_t* x1, const scalar_t* x2, int64_t m, int64_t i0, int64_t ib, int64_t j0, int64_t jb, scalar_t* d, int64_t ldd) {
+    // In column-major order the tile is x2_block * x1_block^T.
+    THBlas_gemm<scalar_t>(
+        't', 'n', jb, ib, m,
+        scalar_t(-2),
+        const_cast<scalar_t*>(x2 + j0 * m), m,
+        const_cast<scalar_t*>(x1 + i0 * m), m,
+        scalar_t(0), d, ldd);
+  }
+
+  // Adds the squared norms to a row of a tile from dot_tile, clamped at 0.
+  static void add_norms(scalar_t* d, int64_t jb, scalar_t norm1, const scalar_t* norms2) {
+    const Vec n1(norm1);
+    const Vec zero(0);
+    int64_t j = 0;
+    for (; j + Vec::size() <= jb; j += Vec::size()) {
+      vec256::maximum(Vec::loadu(d + j) + n1 + Vec::loadu(norms2 + j), zero).store(d + j);
+    }
+    for (; j < jb; j++) {
+      d[j] = std::max(d[j] + norm1 + norms2[j], scalar_t(0));
+    }
+  }
+
+  // result[b][i][j] = |x1[b][i] - x2[b][j]| for contiguous x1, x2 and result
+  static void apply(Tensor& result, const Tensor& x1, const Tensor& x2) {
+    const int64_t batch = x1.size(0);
+    const int64_t r1 = x1.size(1);
+    const int64_t r2 = x2.size(1);
+    const int64_t m = x1.size(2);
+    const scalar_t* const x1_start = x1.data_ptr<scalar_t>();
+    const scalar_t* const x2_start = x2.data_ptr<scalar_t>();
+    scalar_t* const res_start = result.data_ptr<scalar_t>();
+    const std::vector<scalar_t> norms1 = squared_norms(x1);
+    const std::vector<scalar_t> norms2 = squared_norms(x2);
+
+    const int64_t row_blocks = divup(r1, kRowBlock);
+    const int64_t col_blocks = divup(r2, kColBlock);
+    parallel_for(0, batch * row_blocks * col_blocks, 1, [&](int64_t start, int64_t end) {
+      for (int64_t t = start; t < end; t++) {
+        const int64_t b = t / (row_blocks * col_blocks);
+        const int64_t i0 = (t / col_blocks) % row_blocks * kRowBlock;
+        const int64_t j0 = t % col_blocks * kColBlock;
+        const int64_t ib = std::min(kRowBlock, r1 - i0);
+        const int64_t jb = std::min(kColBlock, r2 - j0);
+        scalar_t* const res = res_start + (b * r1 + i0) * r2 + j0;
+        dot_tile(x1_start + b * r1 * m, x2_start + b * r2 * m, m, i0, ib, j0, jb, res, r2);
+        for (int64_t i = 0; i < ib; i++) {
+          scalar_t* const res_i = res + i * r2;
+          add_norms(res_i, jb, norms1[b * r1 + i0 + i], norms2.data() + b * r2 + j0);
+          vec256::map([](Vec x) { return x.sqrt(); }, res_i, res_i, jb);
+        }
+      }
+    });
+  }
+
+  // values[b][i] and indices[b][i] are the k smallest distances of x1[b][i]
+  // to the rows of x2[b], in increasing order, and the rows they are to. Each
+  // thread goes through all the tiles of a block of rows of x1, keeping the k
+  // nearest rows of x2 of every row in a heap, so that at most a tile of
+  // distances exists at any time.
+  static void apply_topk(Tensor& values, Tensor& indices, const Tensor& x1, const Tensor& x2, int64_t k) {
+    const int64_t batch = x1.size(0);
+    const int64_t r1 = x1.size(1);
+    const int64_t r2 = x2.size(1);
+    const int64_t m = x1.size(2);
+    const scalar_t* const x1_start = x1.data_ptr<scalar_t>();
+    const scalar_t* const x2_start = x2.data_ptr<scalar_t>();
+    scalar_t* const values_start = values.data_ptr<scalar_t>();
+    int64_t* const indices_start = indices.data_ptr<int64_t>();
+    const std::vector<scalar_t> norms1 = squared_norms(x1);
+    const std::vector<scalar_t> norms2 = squared_norms(x2);
+
+    using Entry = std::pair<scalar_t, int64_t>;
+    const int64_t row_blocks = divup(r1, kRowBlock);
+    parallel_for(0, batch * row_blocks, 1, [&](int64_t start, int64_t end) {
+      std::vector<scalar_t> tile(kRowBlock * kColBlock);
+      std::vector<std::vector<Entry>> heaps(kRowBlock);
+      for (auto& heap : heaps) {
+        heap.reserve(k);
+      }
+      for (int64_t t = start; t < end; t++) {
+        const int64_t b = t / row_blocks;
+        const int64_t i0 = t % row_blocks * kRowBlock;
+        const int64_t ib = std::min(kRowBlock, r1 - i0);
+        for (int64_t i = 0; i < ib; i++) {
+          heaps[i].clear();
+        }
+        for (int64_t j0 = 0; j0 < r2; j0 += kColBlock) {
+          const int64_t jb = std::min(kColBlock, r2 - j0);
+          dot_tile(x1_start + b * r1 * m, x2_start + b * r2 * m, m, i0, ib, j0, jb, tile.data(), jb);
+          for (int64_t i = 0; i < ib; i++) {
+            scalar_t* const d = tile.data() + i * jb;
+            add_norms(d, jb, norms1[b * r1 + i0 + i], norms2.data() + b * r2 + j0);
+            // Max-heap of the k smallest squared distances so far
+            auto& heap = heaps[i];
+            for (int64_t j = 0; j < jb; j++) {
+              if (static_cast<int64_t>(heap.size()) < k) {
+                heap.emplace_back(d[j], j0 + j);
+                std::push_heap(heap.begin(), heap.end());
+              } else if (d[j] < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = Entry(d[j], j0 + j);
+                std::push_heap(heap.begin(), heap.end());
+              }
+            }
+          }
+        }
+        for (int64_t i = 0; i < ib; i++) {
+          auto& heap = heaps[i];
+          std::sort_heap(heap.begin(), heap.end());
+          scalar_t* const values_i = values_start + (b * r1 + i0 + i) * k;
+          int64_t* const indices_i = indices_start + (b * r1 + i0 + i) * k;
+          for (int64_t j = 0; j < k; j++) {
+            values_i[j] = std::sqrt(heap[j].first);
+            indices_i[j] = heap[j].second;
+          }
+        }
+      }
+    });
+  }
+};
+
 void pdist_forward_kernel_impl(Tensor& result, const Tensor& self, const double p) {
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "pdist", [&] {
     Dist<scalar_t>::apply_pdist(result, self, p);
@@ -426,6 +595,18 @@ static void cdist_kernel_impl(Tensor& result, const Tensor& x1, const Tensor& x2
   });
 }
 
+static void euclidean_dist_kernel_impl(Tensor& result, const Tensor& x1, const Tensor& x2) {
+  AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "euclidean_dist", [&] {
+    EuclideanDist<scalar_t>::apply(result, x1, x2);
+  });
+}
+
+static void cdist_topk_kernel_impl(Tensor& values, Tensor& indices, const Tensor& x1, const Tensor& x2, int64_t k) {
+  AT_DISPATCH_FLOATING_TYPES(values.scalar_type(), "cdist_topk", [&] {
+    EuclideanDist<scalar_t>::apply_topk(values, indices, x1, x2, k);
+  });
+}
+
 static void cdist_backward_kernel_impl(Tensor& result, const Tensor& grad, const Tensor& x1, const Tensor& x2, const double p, const Tensor& dist) {
   AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "cdist_backward", [&] {
     Dist<scalar_t>::apply_backward_cdist(result, grad, x1, x2, p, dist);
@@ -439,5 +620,7 @@ REGISTER_DISPATCH(pdist_forward_stub, &pdist_forward_kernel_impl);
 REGISTER_DISPATCH(pdist_backward_stub, &pdist_backward_kernel_impl);
 REGISTER_DISPATCH(cdist_stub, &cdist_kernel_impl);
 REGISTER_DISPATCH(cdist_backward_stub, &cdist_backward_kernel_impl);
+REGISTER_DISPATCH(euclidean_dist_stub, &euclidean_dist_kernel_impl);
+REGISTER_DISPATCH(cdist_topk_stub, &cdist_topk_kernel_impl);
 
 }}  // namespace at::native
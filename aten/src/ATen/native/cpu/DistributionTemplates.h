@@ -2,9 +2,13 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/CPUApplyUtils.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/DistributionsHelper.h>
+#include <ATen/core/PhiloxRNGEngine.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <algorithm>
 #include <limits>
 #include <mutex>
 
@@ -360,4 +364,131 @@ struct BernoulliKernel {
   }
 };
 
+// ==================================================== Philox ========================================================
+
+/**
+ * Note [Parallel CPU random number generation]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * The kernels above draw every value from the generator while holding its
+ * mutex, so they run on a single thread. When at::globalContext().parallelCPURNG()
+ * is set, uniform_, normal_ and bernoulli_ instead take a single 64-bit key
+ * from the generator and fill the output from Philox4x32-10 streams
+ * (see Note [Philox Engine implementation]) in parallel.
+ *
+ * The output is split in blocks of kPhiloxBlockSize elements, and block b
+ * reads the Philox counters starting at b * counters_per_block. Every element
+ * therefore gets the same random bits whatever the number of threads, and
+ * the generator only advances by the key, so get_state/set_state and
+ * manual_seed reproduce the results as before.
+ */
+constexpr int64_t kPhiloxBlockSize = 16;
+
+// Generator-like view of a Philox stream, for the distributions of
+// DistributionsHelper.h.
+struct PhiloxStream {
+  PhiloxStream(uint64_t key, uint64_t offset) : engine_(key, 0, offset) {}
+
+  uint32_t random() {
+    return engine_();
+  }
+
+  uint64_t random64() {
+    uint32_t hi = engine_();
+    uint32_t lo = engine_();
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+  }
+
+ private:
+  at::Philox4_32_10 engine_;
+};
+
+// Fills `self` block by block in parallel. fill_block(block, stream) writes
+// kPhiloxBlockSize elements to `block` with at most words_per_element 32-bit
+// draws per element from `stream`.
+template <typename scalar_t, typename RNG, typename func_t>
+void philox_fill(Tensor& self, RNG generator, int64_t words_per_element, const func_t& fill_block) {
+  uint64_t key;
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    key = generator->random64();
+  }
+  Tensor out = self.is_contiguous() ? self : at::empty(self.sizes(), self.options());
+  scalar_t* data = out.data_ptr<scalar_t>();
+  const int64_t numel = out.numel();
+  const uint64_t counters_per_block = (kPhiloxBlockSize * words_per_element + 3) / 4;
+  const int64_t num_blocks = (numel + kPhiloxBlockSize - 1) / kPhiloxBlockSize;
+  at::parallel_for(0, num_blocks, /* grain_size= */ 128, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      PhiloxStream stream(key, b * counters_per_block);
+      const int64_t offset = b * kPhiloxBlockSize;
+      if (offset + kPhiloxBlockSize <= numel) {
+        fill_block(data + offset, stream);
+      } else {
+        scalar_t buffer[kPhiloxBlockSize];
+        fill_block(buffer, stream);
+        std::copy(buffer, buffer + (numel - offset), data + offset);
+      }
+    }
+  });
+  if (!out.is_same(self)) {
+    self.copy_(out);
+  }
+}
+
+template<typename RNG>
+void uniform_philox_kernel(Tensor& self, double from_, double to_, RNG generator) {
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "uniform_philox_cpu", [&] {
+    at::uniform_real_distribution<scalar_t> uniform(static_cast<scalar_t>(from_), static_cast<scalar_t>(to_));
+    philox_fill<scalar_t>(self, generator, sizeof(scalar_t) / sizeof(uint32_t),
+        [&uniform](scalar_t* block, PhiloxStream& stream) {
+      for (int64_t i = 0; i < kPhiloxBlockSize; i++) {
+        block[i] = static_cast<scalar_t>(uniform(&stream));
+      }
+    });
+  });
+}
+
+template<typename RNG>
+void normal_philox_kernel(Tensor& self, double mean_, double std_, RNG generator) {
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "normal_philox_cpu", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    constexpr int64_t half = kPhiloxBlockSize / 2;
+    const Vec mean(static_cast<scalar_t>(mean_));
+    const Vec std(static_cast<scalar_t>(std_));
+    const Vec one(1);
+    const Vec minus_two(-2);
+    const Vec two_pi(2.0 * M_PI);
+    at::uniform_real_distribution<scalar_t> uniform(0, 1);
+    philox_fill<scalar_t>(self, generator, sizeof(scalar_t) / sizeof(uint32_t),
+        [&](scalar_t* block, PhiloxStream& stream) {
+      for (int64_t i = 0; i < kPhiloxBlockSize; i++) {
+        block[i] = static_cast<scalar_t>(uniform(&stream));
+      }
+      // Box-Muller transform, as in normal_fill_16.
+      for (int64_t j = 0; j < half; j += Vec::size()) {
+        const Vec u1 = one - Vec::loadu(block + j); // [0, 1) -> (0, 1] for log.
+        const Vec u2 = Vec::loadu(block + j + half);
+        const Vec radius = (minus_two * u1.log()).sqrt();
+        const Vec theta = two_pi * u2;
+        vec256::fmadd(radius * theta.cos(), std, mean).store(block + j);
+        vec256::fmadd(radius * theta.sin(), std, mean).store(block + j + half);
+      }
+    });
+  });
+}
+
+template<typename RNG>
+void bernoulli_philox_kernel(Tensor& self, double p, RNG generator) {
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_philox_cpu", [&] {
+    at::bernoulli_distribution<double> bernoulli(p);
+    philox_fill<scalar_t>(self, generator, sizeof(double) / sizeof(uint32_t),
+        [&bernoulli](scalar_t* block, PhiloxStream& stream) {
+      for (int64_t i = 0; i < kPhiloxBlockSize; i++) {
+        block[i] = static_cast<scalar_t>(bernoulli(&stream));
+      }
+    });
+  });
+}
+
 }}}}}
@@ -0,0 +1,293 @@
+#include <ATen/native/CPUBlas.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at {
+namespace native {
+namespace {
+
+using namespace vec256;
+
+// Blocked gemm in the style of GotoBLAS. For every NC x KC block of op(B),
+// scaled by alpha and packed in slivers of NR columns, and every MC x KC block
+// of op(A), packed in slivers of MR rows, a micro kernel accumulates each
+// MR x NR tile of C in registers. The blocks of op(A) are distributed over
+// threads, each one writing to different rows of C.
+template <typename scalar_t>
+struct GemmBlocking {
+  // Two vectors of rows of C by NR columns, the accumulators plus the operands
+  // fit in the 16 vector registers of AVX2.
+  static constexpr int64_t MR = 2 * Vec256<scalar_t>::size();
+  static constexpr int64_t NR = 6;
+  static constexpr int64_t KC = 256;
+  static constexpr int64_t MC = MR * 8;
+  static constexpr int64_t NC = NR * 64;
+};
+
+template <typename scalar_t>
+inline scalar_t elem(
+    const scalar_t* x,
+    bool trans,
+    int64_t ld,
+    int64_t row,
+    int64_t col) {
+  return trans ? x[row * ld + col] : x[col * ld + row];
+}
+
+// Packs the mc x kc block of op(A) starting at (i0, p0) into slivers of MR
+// rows, each one column after column, zero padding the last one.
+template <typename scalar_t>
+void pack_a(
+    bool trans,
+    const scalar_t* a,
+    int64_t lda,
+    int64_t i0,
+    int64_t p0,
+    int64_t mc,
+    int64_t kc,
+    scalar_t* packed) {
+  constexpr int64_t MR = GemmBlocking<scalar_t>::MR;
+  for (int64_t ir = 0; ir < mc; ir += MR) {
+    const int64_t mr = std::min(MR, mc - ir);
+    for (int64_t p = 0; p < kc; p++) {
+      for (int64_t i = 0; i < mr; i++) {
+        packed[i] = elem(a, trans, lda, i0 + ir + i, p0 + p);
+      }
+      std::fill(packed + mr, packed + MR, scalar_t(0));
+      packed += MR;
+    }
+  }
+}
+
+// Packs alpha times the kc x nc block of op(B) starting at (p0, j0) into
+// slivers of NR columns, each one row after row, zero padding the last one.
+template <typename scalar_t>
+void pack_b(
+    bool trans,
+    scalar_t alpha,
+    const scalar_t* b,
+    int64_t ldb,
+    int64_t p0,
+    int64_t j0,
+    int64_t kc,
+    int64_t nc,
+    scalar_t* packed) {
+  constexpr int64_t NR = GemmBlocking<scalar_t>::NR;
+  for (int64_t jr = 0; jr < nc; jr += NR) {
+    const int64_t nr = std::min(NR, nc - jr);
+    for (int64_t p = 0; p < kc; p++) {
+      for (int64_t j = 0; j < nr; j++) {
+        packed[j] = alpha * elem(b, trans, ldb, p0 + p, j0 + jr + j);
+      }
+      std::fill(packed + nr, packed + NR, scalar_t(0));
+      packed += NR;
+    }
+  }
+}
+
+// Adds the product of a packed sliver of A and a packed sliver of B to the
+// mr x nr tile of C at c.
+template <typename scalar_t>
+void micro_kernel(
+    int64_t kc,
+    const scalar_t* a,
+    const scalar_t* b,
+    scalar_t* c,
+    int64_t ldc,
+    int64_t mr,
+    int64_t nr) {
+  using Vec = Vec256<scalar_t>;
+  constexpr int64_t MR = GemmBlocking<scalar_t>::MR;
+  constexpr int64_t NR = GemmBlocking<scalar_t>::NR;
+  Vec acc0[NR];
+  Vec acc1[NR];
+  for (int64_t j = 0; j < NR; j++) {
+    acc0[j] = Vec(scalar_t(0));
+    acc1[j] = Vec(scalar_t(0));
+  }
+  for (int64_t p = 0; p < kc; p++) {
+    const Vec a0 = Vec::loadu(a + p * MR);
+    const Vec a1 = Vec::loadu(a + p * MR + Vec::size());
+    for (int64_t j = 0; j < NR; j++) {
+      const Vec bj(b[p * NR + j]);
+      acc0[j] = fmadd(a0, bj, acc0[j]);
+      acc1[j] = fmadd(a1, bj, acc1[j]);
+    }
+  }
+  if (mr == MR && nr == NR) {
+    for (int64_t j = 0; j < NR; j++) {
+      scalar_t* c_j = c + j * ldc;
+      (Vec::loadu(c_j) + acc0[j]).store(c_j);
+      (Vec::loadu(c_j + Vec::size()) + acc1[j]).store(c_j + Vec::size());
+    }
+  } else {
+    // Edge tile of C
+    __at_align32__ scalar_t buf[MR * NR];
+    for (int64_t j = 0; j < NR; j++) {
+      acc0[j].store(buf + j * MR);
+      acc1[j].store(buf + j * MR + Vec::size());
+    }
+    for (int64_t j = 0; j < nr; j++) {
+      for (int64_t i = 0; i < mr; i++) {
+        c[j * ldc + i] += buf[j * MR + i];
+      }
+    }
+  }
+}
+
+// Square gemm of compile time size S, which the compiler fully unrolls. For
+// these the packing of the blocked path costs more than the product.
+template <typename scalar_t, int64_t S>
+void small_gemm(
+    bool transa,
+    bool transb,
+    scalar_t alpha,
+    const scalar_t* a,
+    int64_t lda,
+    const scalar_t* b,
+    int64_t ldb,
+    scalar_t* c,
+    int64_t ldc) {
+  for (int64_t j = 0; j < S; j++) {
+    for (int64_t i = 0; i < S; i++) {
+      scalar_t sum = 0;
+      for (int64_t p = 0; p < S; p++) {
+        sum += elem(a, transa, lda, i, p) * elem(b, transb, ldb, p, j);
+      }
+      c[j * ldc + i] += alpha * sum;
+    }
+  }
+}
+
+template <typename scalar_t>
+void gemm_impl(
+    bool transa,
+    bool transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    scalar_t alpha,
+    const scalar_t* a,
+    int64_t lda,
+    const scalar_t* b,
+    int64_t ldb,
+    scalar_t beta,
+    scalar_t* c,
+    int64_t ldc) {
+  using Blocking = GemmBlocking<scalar_t>;
+  constexpr int64_t MR = Blocking::MR;
+  constexpr int64_t NR = Blocking::NR;
+  constexpr int64_t KC = Blocking::KC;
+  constexpr int64_t MC = Blocking::MC;
+  constexpr int64_t NC = Blocking::NC;
+
+  // As in BLAS, C is not read when beta is 0.
+  if (beta != scalar_t(1)) {
+    for (int64_t j = 0; j < n; j++) {
+      scalar_t* c_j = c + j * ldc;
+      for (int64_t i = 0; i < m; i++) {
+        c_j[i] = beta == scalar_t(0) ? scalar_t(0) : beta * c_j[i];
+      }
+    }
+  }
+  if (m == 0 || n == 0 || k == 0 || alpha == scalar_t(0)) {
+    return;
+  }
+
+  if (m == n && n == k && m <= 4) {
+    switch (m) {
+      case 1:
+        c[0] += alpha * a[0] * b[0];
+        return;
+      case 2:
+        small_gemm<scalar_t, 2>(transa, transb, alpha, a, lda, b, ldb, c, ldc);
+        return;
+      case 3:
+        small_gemm<scalar_t, 3>(transa, transb, alpha, a, lda, b, ldb, c, ldc);
+        return;
+      case 4:
+        small_gemm<scalar_t, 4>(transa, transb, alpha, a, lda, b, ldb, c, ldc);
+        return;
+    }
+  }
+
+  const int64_t num_mc = divup(m, MC);
+  // Don't parallelize products that are too small to amortize it
+  const int64_t grain_size =
+      m * n * k < at::internal::GRAIN_SIZE * MR ? num_mc : 1;
+  std::vector<scalar_t> packed_b(KC * divup(std::min(NC, n), NR) * NR);
+  for (int64_t jc = 0; jc < n; jc += NC) {
+    const int64_t nc = std::min(NC, n - jc);
+    for (int64_t pc = 0; pc < k; pc += KC) {
+      const int64_t kc = std::min(KC, k - pc);
+      pack_b(transb, alpha, b, ldb, pc, jc, kc, nc, packed_b.data());
+      at::parallel_for(0, num_mc, grain_size, [&](int64_t begin, int64_t end) {
+        std::vector<scalar_t> packed_a(MC * kc);
+        for (int64_t blk = begin; blk < end; blk++) {
+          const int64_t ic = blk * MC;
+          const int64_t mc = std::min(MC, m - ic);
+          pack_a(transa, a, lda, ic, pc, mc, kc, packed_a.data());
+          for (int64_t jr = 0; jr < nc; jr += NR) {
+            for (int64_t ir = 0; ir < mc; ir += MR) {
+              micro_kernel(
+                  kc,
+                  packed_a.data() + ir * kc,
+                  packed_b.data() + jr * kc,
+                  c + (jc + jr) * ldc + ic + ir,
+                  ldc,
+                  std::min(MR, mc - ir),
+                  std::min(NR, nc - jr));
+            }
+          }
+        }
+      });
+    }
+  }
+}
+
+void gemm_kernel(
+    ScalarType type,
+    char transa,
+    char transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    Scalar alpha,
+    const void* a,
+    int64_t lda,
+    const void* b,
+    int64_t ldb,
+    Scalar beta,
+    void* c,
+    int64_t ldc) {
+  const bool transa_ = transa == 't' || transa == 'T';
+  const bool transb_ = transb == 't' || transb == 'T';
+  AT_DISPATCH_FLOATING_TYPES(type, "gemm", [&] {
+    gemm_impl<scalar_t>(
+        transa_,
+        transb_,
+        m,
+        n,
+        k,
+        alpha.to<scalar_t>(),
+        static_cast<const scalar_t*>(a),
+        lda,
+        static_cast<const scalar_t*>(b),
+        ldb,
+        beta.to<scalar_t>(),
+        static_cast<scalar_t*>(c),
+        ldc);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(gemm_stub, &gemm_kernel);
+
+} // namespace native
+} // namespace at
@@ -24,9 +24,22 @@
 //
 // See BinaryOpsKernel.cpp for the complete implementation
 //
+// Kernels with several outputs return them as a std::tuple, in the order the
+// outputs were added to the TensorIterator:
+//
+//   cpu_kernel_multiple_outputs(iter,
+//     [](float a, float b) { return std::make_tuple(a + b, a * b); });
+//
+//   cpu_kernel_multiple_outputs_vec(iter,
+//     [](float a, float b) { return std::make_tuple(a + b, a * b); },
+//     [](Vec256<float> a, Vec256<float> b) { return std::make_tuple(a + b, a * b); });
+//
+// so that fused ops write all of their outputs in a single pass over memory.
 //
 
 #include <stdint.h>
+#include <initializer_list>
+#include <tuple>
 #include <c10/util/C++17.h>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/cpu/IsContiguous.h>
@@ -136,7 +149,8 @@ static inline void
 vectorized_loop(char** C10_RESTRICT data_, int64_t n, int64_t S, func_t&& op, vec_func_t&& vop) {
   using traits = function_traits<vec_func_t>;
   using scalar_t = typename function_traits<func_t>::result_type;
-  using Vec = Vec256<scalar_t>;
+  // Vec256, or Vec512 in kernels that opt in to it.
+  using Vec = typename traits::result_type;
   constexpr int ntensors = traits::arity + 1;
 
   char* C10_RESTRICT data[ntensors];
@@ -235,6 +249,189 @@ void cpu_kernel_vec(TensorIterator& iter, func_t&& op, vec_func_t&& vop) {
   iter.cast_outputs();
 }
 
+template <typename tuple_t, std::size_t... INDEX>
+static inline void
+store_outputs_impl(char* C10_RESTRICT data[], const int64_t* strides, int64_t i,
+                   const tuple_t& outputs, std::index_sequence<INDEX...>) {
+  (void)std::initializer_list<int>{(
+      *(typename std::tuple_element<INDEX, tuple_t>::type*)
+        (data[INDEX] + i * strides[INDEX]) = std::get<INDEX>(outputs), 0)...};
+}
+
+template <typename tuple_t>
+static inline void
+store_outputs(char* C10_RESTRICT data[], const int64_t* strides, int64_t i, const tuple_t& outputs) {
+  using Indices = std::make_index_sequence<std::tuple_size<tuple_t>::value>;
+  store_outputs_impl(data, strides, i, outputs, Indices{});
+}
+
+template <typename tuple_t, std::size_t... INDEX>
+static inline void
+store_vec_outputs_impl(char* C10_RESTRICT data[], int64_t i, const tuple_t& outputs,
+                       std::index_sequence<INDEX...>) {
+  (void)std::initializer_list<int>{(
+      std::get<INDEX>(outputs).store(
+        data[INDEX] + i * sizeof(typename std::tuple_element<INDEX, tuple_t>::type::value_type)), 0)...};
+}
+
+template <typename tuple_t>
+static inline void
+store_vec_outputs(char* C10_RESTRICT data[], int64_t i, const tuple_t& outputs) {
+  using Indices = std::make_index_sequence<std::tuple_size<tuple_t>::value>;
+  store_vec_outputs_impl(data, i, outputs, Indices{});
+}
+
+template <typename traits, std::size_t... INDEX>
+typename traits::ArgsTuple
+dereference_vec_contiguous_impl(char* C10_RESTRICT data[], int64_t i, std::index_sequence<INDEX...>) {
+  return std::make_tuple(
+      traits::template arg<INDEX>::type::loadu(
+        data[INDEX] + i * sizeof(typename traits::template arg<INDEX>::type::value_type))...);
+}
+
+template <typename traits>
+typename traits::ArgsTuple
+dereference_vec_contiguous(char* C10_RESTRICT data[], int64_t i) {
+  using Indices = std::make_index_sequence<traits::arity>;
+  return dereference_vec_contiguous_impl<traits>(data, i, Indices{});
+}
+
+// Whether each output and input of a kernel with several outputs is
+// contiguous. Outputs come first in strides.
+template <typename traits, std::size_t... OUT, std::size_t... IN>
+static inline bool
+is_contiguous_multiple_outputs_impl(const int64_t* strides,
+                                    std::index_sequence<OUT...>, std::index_sequence<IN...>) {
+  using result_type = typename traits::result_type;
+  constexpr int num_outputs = std::tuple_size<result_type>::value;
+  bool contiguous = true;
+  (void)std::initializer_list<int>{(contiguous &=
+      strides[OUT] == sizeof(typename std::tuple_element<OUT, result_type>::type), 0)...};
+  (void)std::initializer_list<int>{(contiguous &=
+      strides[num_outputs + IN] == sizeof(typename traits::template arg<IN>::type), 0)...};
+  return contiguous;
+}
+
+template <typename traits>
+static inline bool is_contiguous_multiple_outputs(const int64_t* strides) {
+  using Outputs = std::make_index_sequence<std::tuple_size<typename traits::result_type>::value>;
+  using Inputs = std::make_index_sequence<traits::arity>;
+  return is_contiguous_multiple_outputs_impl<traits>(strides, Outputs{}, Inputs{});
+}
+
+// Compares the types of the outputs of a kernel with several outputs with the
+// dtypes of the outputs of the iterator, see needs_dynamic_casting.
+template <typename func_t, int nouts=std::tuple_size<typename function_traits<func_t>::result_type>::value>
+struct outputs_need_dynamic_casting {
+  static bool check(TensorIterator& iter) {
+    using cpp_type = typename std::tuple_element<nouts - 1, typename function_traits<func_t>::result_type>::type;
+    if (iter.dtype(nouts - 1) != cppmap::detail::CPPTypeToScalarType<cpp_type>::value()) {
+      return true;
+    }
+    return outputs_need_dynamic_casting<func_t, nouts - 1>::check(iter);
+  }
+};
+
+template <typename func_t>
+struct outputs_need_dynamic_casting<func_t, 0> {
+  static bool check(TensorIterator& iter) {
+    return inputs_need_dynamic_casting<func_t>::check(iter);
+  }
+};
+
+// Basic loop operation for kernels with several outputs and N inputs. May
+// be auto-vectorized by the compiler.
+template <typename func_t>
+static inline void
+multiple_outputs_loop(char* C10_RESTRICT data[], const int64_t* strides_, int64_t i, int64_t n, func_t&& op) {
+  using traits = function_traits<func_t>;
+  constexpr int num_outputs = std::tuple_size<typename traits::result_type>::value;
+  constexpr int ntensors = traits::arity + num_outputs;
+
+  // Copying strides to temporary array helps auto vectorization in older GCC
+  // versions.
+  int64_t strides[ntensors];
+  for (int arg = 0; arg < ntensors; arg++) {
+    strides[arg] = strides_[arg];
+  }
+
+  for (; i < n; i++) {
+    auto outputs = c10::guts::apply(std::forward<func_t>(op), dereference<traits>(
+        &data[num_outputs],
+        &strides[num_outputs],
+        i));
+    store_outputs(data, strides, i, outputs);
+  }
+}
+
+// Explicitly vectorized loop for kernels with several outputs. All inputs and
+// outputs must be contiguous, and their vectors must hold the same number of
+// elements.
+template <typename func_t, typename vec_func_t>
+static inline void
+multiple_outputs_vectorized_loop(char** C10_RESTRICT data_, int64_t n, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<vec_func_t>;
+  using result_type = typename traits::result_type;
+  using Vec = typename std::tuple_element<0, result_type>::type;
+  constexpr int num_outputs = std::tuple_size<result_type>::value;
+  constexpr int ntensors = traits::arity + num_outputs;
+
+  char* C10_RESTRICT data[ntensors];
+  for (int arg = 0; arg < ntensors; arg++) {
+    data[arg] = data_[arg];
+  }
+
+  int64_t i = 0;
+  for (; i <= n - 2 * Vec::size(); i += 2 * Vec::size()) {
+    auto out1 = c10::guts::apply(std::forward<vec_func_t>(vop),
+        dereference_vec_contiguous<traits>(&data[num_outputs], i));
+    auto out2 = c10::guts::apply(std::forward<vec_func_t>(vop),
+        dereference_vec_contiguous<traits>(&data[num_outputs], i + Vec::size()));
+    store_vec_outputs(data, i, out1);
+    store_vec_outputs(data, i + Vec::size(), out2);
+  }
+  if (i < n) {
+    // Vectors of the same size hold elements of the same size
+    int64_t strides[ntensors];
+    for (int arg = 0; arg < ntensors; arg++) {
+      strides[arg] = sizeof(typename Vec::value_type);
+    }
+    multiple_outputs_loop(data, strides, i, n, std::forward<func_t>(op));
+  }
+}
+
+template <typename func_t>
+void cpu_kernel_multiple_outputs(TensorIterator& iter, func_t&& op) {
+  using traits = function_traits<func_t>;
+  TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
+  TORCH_INTERNAL_ASSERT(iter.noutputs() == std::tuple_size<typename traits::result_type>::value);
+  // dynamic casting not currently supported on CPU
+  TORCH_INTERNAL_ASSERT(!outputs_need_dynamic_casting<func_t>::check(iter));
+
+  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+    multiple_outputs_loop(data, strides, 0, n, std::forward<func_t>(op));
+  });
+  iter.cast_outputs();
+}
+
+template <typename func_t, typename vec_func_t>
+void cpu_kernel_multiple_outputs_vec(TensorIterator& iter, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<func_t>;
+  TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
+  TORCH_INTERNAL_ASSERT(iter.noutputs() == std::tuple_size<typename traits::result_type>::value);
+  // dynamic casting not currently supported on CPU
+  TORCH_INTERNAL_ASSERT(!outputs_need_dynamic_casting<func_t>::check(iter));
+
+  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+    if (is_contiguous_multiple_outputs<traits>(strides)) {
+      multiple_outputs_vectorized_loop(data, n, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+    } else {
+      multiple_outputs_loop(data, strides, 0, n, std::forward<func_t>(op));
+    }
+  });
+  iter.cast_outputs();
+}
+
 template <typename func_t>
 void cpu_serial_kernel(TensorIterator& iter, func_t&& op, const Range& range) {
   using traits = function_traits<func_t>;
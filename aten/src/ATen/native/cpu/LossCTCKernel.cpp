@@ -0,0 +1,349 @@
+// Copyright (c) 2018 MathInf GmbH, Thomas Viehmann
+// Licensed under the BSD-3-Clause license
+// This is the CPU implementation of the Connectionist Temporal Loss.
+// We mostly follow Graves.
+// 1. Graves et al: http://www.cs.toronto.edu/~graves/icml_2006.pdf
+// We use the equations from above link, but note that [1] has 1-based indexing and we (of course) use 0-based.
+// Graves et al call the probabilities y, we use log_probs (also calling them inputs)
+
+#include <ATen/native/LossCTC.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+// this ad-hoc converts from targets (l in [1]) to augmented targets (l' in [1]) note that no bound-checking is done
+template<typename target_t>
+static inline int64_t get_target_prime(target_t* target, int64_t offset, int64_t stride, int64_t idx, int64_t BLANK) {
+  if (idx % 2 == 0) {
+    return BLANK;
+  } else {
+    return target[offset + stride * (idx / 2)];
+  }
+}
+
+// log(exp(a)+exp(b)+exp(c)), keeping track of the maximum for stability
+template <typename scalar_t>
+static inline scalar_t log_add3(scalar_t a, scalar_t b, scalar_t c) {
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  scalar_t m = std::max(std::max(a, b), c);
+  if (m == neginf) // cannot do neginf-neginf
+    m = 0;
+  return std::log(std::exp(a-m)+std::exp(b-m)+std::exp(c-m))+m;
+}
+
+// out[s] = log_add3(a[s], b[s], c[s] + c_bias[s]) + lp[s] for a row of n states, which is eq (6) for the alphas and
+// eq (10) for the betas. c_bias is 0 where the transition from c is allowed and neginf where it is not.
+template <typename scalar_t>
+static void log_add3_row(scalar_t* out, const scalar_t* a, const scalar_t* b, const scalar_t* c,
+                         const scalar_t* c_bias, const scalar_t* lp, int64_t n) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const Vec neginf_vec(-std::numeric_limits<scalar_t>::infinity());
+  const Vec zero_vec(0);
+  int64_t s = 0;
+  for (; s + Vec::size() <= n; s += Vec::size()) {
+    Vec la1 = Vec::loadu(a + s);
+    Vec la2 = Vec::loadu(b + s);
+    Vec la3 = Vec::loadu(c + s) + Vec::loadu(c_bias + s);
+    Vec lamax = vec256::maximum(vec256::maximum(la1, la2), la3);
+    lamax = Vec::blendv(lamax, zero_vec, lamax == neginf_vec);
+    Vec res = ((la1 - lamax).exp() + (la2 - lamax).exp() + (la3 - lamax).exp()).log() + lamax + Vec::loadu(lp + s);
+    res.store(out + s);
+  }
+  for (; s < n; s++) {
+    out[s] = log_add3(a[s], b[s], c[s] + c_bias[s]) + lp[s];
+  }
+}
+
+// Buffers for the batch elements a task goes through, reused from one element to the next.
+template <typename scalar_t>
+struct CTCWorkspace {
+  // l' of the element, 2*target_length+1 states
+  std::vector<int64_t> target_primes;
+  // 0 where state s can be reached from s-2 (eq (7)), neginf where it cannot
+  std::vector<scalar_t> skip_bias;
+  // log_probs[t][l'[s]] of the current t, gathered so that the rows can be vectorized
+  std::vector<scalar_t> log_probs_prime;
+  // the betas of t and t+1, all the backward needs
+  std::vector<scalar_t> log_beta;
+
+  template <typename target_t>
+  void prepare(target_t* targets_data, int64_t tg_batch_offset, int64_t tg_target_stride, int64_t target_length, int64_t BLANK) {
+    constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+    int64_t num_states = 2*target_length+1;
+    target_primes.resize(num_states);
+    skip_bias.resize(num_states);
+    log_probs_prime.resize(num_states);
+    log_beta.resize(2*num_states);
+    for (int64_t s = 0; s < num_states; s++) {
+      target_primes[s] = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+      skip_bias[s] = (s > 1 && target_primes[s-2] != target_primes[s]) ? 0 : neginf;
+    }
+  }
+
+  template <typename row_t>
+  void gather_log_probs(const row_t& log_probs_row) {
+    for (size_t s = 0; s < target_primes.size(); s++) {
+      log_probs_prime[s] = log_probs_row[target_primes[s]];
+    }
+  }
+};
+
+// The cost of a batch element grows with input_length * (2*target_length+1), so an even split of the batch
+// leaves threads idle when the lengths vary. This assigns the elements, longest first, to the least loaded
+// of one group per thread.
+static std::vector<std::vector<int64_t>> balanced_batch_groups(IntArrayRef input_lengths, IntArrayRef target_lengths) {
+  int64_t batch_size = input_lengths.size();
+  int64_t num_groups = std::min<int64_t>(batch_size, at::get_num_threads());
+  auto cost = [&](int64_t b) {
+    return std::max<int64_t>(input_lengths[b], 1) * (2*target_lengths[b]+1);
+  };
+  std::vector<int64_t> order(batch_size);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) { return cost(a) > cost(b); });
+  std::vector<std::vector<int64_t>> groups(num_groups);
+  std::vector<int64_t> load(num_groups, 0);
+  for (int64_t b : order) {
+    auto g = std::min_element(load.begin(), load.end()) - load.begin();
+    groups[g].push_back(b);
+    load[g] += cost(b);
+  }
+  return groups;
+}
+
+// This kernel is a relatively straightforward implementation of the alpha calculation in the forward backward algorithm (section 4.1).
+// A (minor) twist is that we are using log-calculations to enhance numerical stability (log_probs and log_alpha).
+// The rows of alpha are computed for all s at once, vectorized.
+template<typename scalar_t, typename target_t>
+void ctc_loss_kernel_impl(Tensor& neg_log_likelihood, Tensor& log_alpha, const Tensor& log_probs, const Tensor& targets,
+                          IntArrayRef input_lengths, IntArrayRef target_lengths, IntArrayRef tg_batch_offsets,
+                          int64_t tg_target_stride, int64_t BLANK) {
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  auto lpp  = log_probs.permute({1,0,2});
+  auto log_probs_a_global = lpp.accessor<scalar_t, 3>();
+  auto log_alpha_a_global = log_alpha.accessor<scalar_t, 3>();
+  auto targets_data = targets.data_ptr<target_t>();
+  auto neg_log_likelihood_a = neg_log_likelihood.accessor<scalar_t, 1>();
+
+  // alpha calculation for the first row, the three equations for alpha_1 above eq (6)
+  // first the default
+  log_alpha.narrow(1, 0, 1).fill_(neginf);
+  auto groups = balanced_batch_groups(input_lengths, target_lengths);
+  at::parallel_for(0, groups.size(), 1, [&](int64_t start, int64_t end) {
+    CTCWorkspace<scalar_t> ws;
+    for (int64_t g = start; g < end; g++) {
+      for (int64_t b : groups[g]) {
+        int64_t input_length = input_lengths[b];
+        int64_t target_length = target_lengths[b];
+        int64_t num_states = 2*target_length+1;
+        auto log_probs_a = log_probs_a_global[b];
+        auto log_alpha_a = log_alpha_a_global[b];
+        ws.prepare(targets_data, tg_batch_offsets[b], tg_target_stride, target_length, BLANK);
+        const scalar_t* lp_prime = ws.log_probs_prime.data();
+
+        // the first two items of alpha_t above eq (6)
+        log_alpha_a[0][0] = log_probs_a[0][BLANK];
+        if (target_length > 0)
+          log_alpha_a[0][1] = log_probs_a[0][ws.target_primes[1]];
+
+        // now the loop over the inputs
+        for (int64_t t=1; t<input_length; t++) {
+          ws.gather_log_probs(log_probs_a[t]);
+          const scalar_t* prev = log_alpha_a[t-1].data();
+          scalar_t* cur = log_alpha_a[t].data();
+          // This is eq (6) and (7). s=0 has neither an s-1 nor an s-2 to come from, s=1 has no s-2.
+          cur[0] = prev[0] + lp_prime[0];
+          if (num_states > 1)
+            cur[1] = log_add3(prev[1], prev[0], neginf) + lp_prime[1];
+          if (num_states > 2)
+            log_add3_row(cur+2, prev+2, prev+1, prev, ws.skip_bias.data()+2, lp_prime+2, num_states-2);
+        }
+        // the likelihood is the the sum of the last two alphas, eq (8), the loss is the negative log likelihood
+        if (target_length == 0) {
+          // if the target is empty then there is no preceding BLANK state and hence there is no path to merge
+          neg_log_likelihood_a[b] = -log_alpha_a[input_length-1][0];
+        } else {
+          scalar_t l1 = log_alpha_a[input_length-1][target_length*2];
+          scalar_t l2 = log_alpha_a[input_length-1][target_length*2-1];
+          scalar_t m = std::max(l1, l2);
+          m = ((m == neginf) ? 0 : m);
+          scalar_t log_likelihood = std::log(std::exp(l1-m)+std::exp(l2-m))+m;
+          neg_log_likelihood_a[b] = -log_likelihood;
+        }
+      }
+    }
+  });
+}
+
+// This is the backward. It consists of two phases:
+// a) computing the beta analogous to the alphas in the forward (backward half of the forward-backward algorithm) (eq (10) and (11))
+// b) collecting the per-activation characters for all s and wrapping the gradient (eq (16), the collection is the sum)
+template<typename scalar_t, typename target_t>
+void ctc_loss_backward_kernel_impl(Tensor& grad, const Tensor& grad_out, const Tensor& log_probs, const Tensor& targets,
+                                   IntArrayRef input_lengths, IntArrayRef target_lengths, IntArrayRef tg_batch_offsets,
+                                   int64_t tg_target_stride, const Tensor& neg_log_likelihood, const Tensor& log_alpha,
+                                   int64_t BLANK, bool zero_infinity) {
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  int64_t max_input_length = log_probs.size(0);
+  int64_t num_labels = log_probs.size(2);
+  const bool log_probs_rows_contiguous = log_probs.stride(2) == 1;
+
+  auto lpp  = log_probs.permute({1,0,2});
+  auto log_probs_a_global = lpp.accessor<scalar_t, 3>();
+  auto log_alpha_a_global = log_alpha.accessor<scalar_t, 3>();
+  auto gp = grad.permute({1,0,2});
+  auto grad_a_global = gp.accessor<scalar_t, 3>();
+  auto targets_data = targets.data_ptr<target_t>();
+  auto neg_log_likelihood_a = neg_log_likelihood.accessor<scalar_t, 1>();
+  auto grad_out_a = grad_out.accessor<scalar_t, 1>();
+
+  auto groups = balanced_batch_groups(input_lengths, target_lengths);
+  at::parallel_for(0, groups.size(), 1, [&](int64_t start, int64_t end) {
+    CTCWorkspace<scalar_t> ws;
+    for (int64_t g = start; g < end; g++) {
+      for (int64_t b : groups[g]) {
+        scalar_t nll = neg_log_likelihood_a[b];
+        if (zero_infinity &&  nll == std::numeric_limits<scalar_t>::infinity()) {
+          grad.narrow(1, b, 1).zero_();
+          continue;
+        }
+
+        auto log_probs_a = log_probs_a_global[b];
+        auto log_alpha_a = log_alpha_a_global[b];
+        auto grad_a = grad_a_global[b];
+        int64_t input_length = input_lengths[b];
+        int64_t target_length = target_lengths[b];
+        int64_t num_states = 2*target_length+1;
+        ws.prepare(targets_data, tg_batch_offsets[b], tg_target_stride, target_length, BLANK);
+        const scalar_t* lp_prime = ws.log_probs_prime.data();
+        // beta of t only depends on beta of t+1, so we keep two rows instead of all of log_beta
+        auto log_beta_row = [&](int64_t t) {
+          return ws.log_beta.data() + (t % 2) * num_states;
+        };
+
+        // the initialization of beta before eq (10)
+        if (input_length > 0) {
+          scalar_t* log_beta_last = log_beta_row(input_length-1);
+          std::fill(log_beta_last, log_beta_last + num_states, neginf);
+          log_beta_last[2*target_length] = log_probs_a[input_length-1][BLANK];
+          grad_a[input_length-1][BLANK] = log_alpha_a[input_length-1][2*target_length] + log_beta_last[2*target_length];
+
+          if (target_length > 0) {
+            auto current_target_prime = ws.target_primes[2*target_length-1];
+            log_beta_last[2*target_length-1] = log_probs_a[input_length-1][current_target_prime];
+
+            // the first two are a blank and a non-blank, so we know they are different and we don't need to do log+
+            grad_a[input_length-1][current_target_prime] = log_alpha_a[input_length-1][2*target_length-1] + log_beta_last[2*target_length-1];
+          }
+        }
+
+        // now loop applying eq (10) / (11)
+        for (int64_t t=input_length-2; t>=0; t--) {
+          ws.gather_log_probs(log_probs_a[t]);
+          const scalar_t* next = log_beta_row(t+1);
+          scalar_t* cur = log_beta_row(t);
+          // the last state has neither an s+1 nor an s+2 to come from, the one before it has no s+2.
+          // the skip from s+2 to s is allowed exactly when the one from s to s+2 is in the forward.
+          int64_t last = num_states-1;
+          cur[last] = next[last] + lp_prime[last];
+          if (num_states > 1)
+            cur[last-1] = log_add3(next[last-1], next[last], neginf) + lp_prime[last-1];
+          if (num_states > 2)
+            log_add3_row(cur, next, next+1, next+2, ws.skip_bias.data()+2, lp_prime, num_states-2);
+
+          // now that we have beta, we fill in the sum of alpha*beta in eq (16)
+          // in contrast to the cuda implementation, we only parallelize over the batch, so we don't have a concurrency
+          // issue (several s can map to the same target character)
+          // collected[b, t, target'[s]] "log+=" log_alpha[t, s]+log_beta[t, s]
+          auto grad_row = grad_a[t];
+          auto log_alpha_row = log_alpha_a[t];
+          for (int64_t s=last; s>=0; s--) {
+            scalar_t log_alpha_beta = log_alpha_row[s] + cur[s];
+            scalar_t &lcab = grad_row[ws.target_primes[s]];
+            if (lcab == neginf) {
+              lcab = log_alpha_beta;
+            } else {
+              scalar_t max = std::max(lcab, log_alpha_beta);
+              lcab = std::log(std::exp(lcab-max)+std::exp(log_alpha_beta-max))+max;
+            }
+          }
+        }
+
+        // now grad has the sum of eq (16)
+        // now we wrap up the calculation by adding in the remaining items of eq (16)
+        // grad is the output gradient, nll is the loss. Note that the likelihood -nll is the Z of eq (16)
+        scalar_t gr = grad_out_a[b];
+        for (int64_t t = 0; t < input_length; t++) { // or go for the full thing?
+          auto grad_row = grad_a[t];
+          auto log_probs_row = log_probs_a[t];
+          if (log_probs_rows_contiguous) {
+            vec256::map2(
+                [nll, gr](Vec res, Vec lp) {
+                  return (lp.exp() - (res + Vec(nll) - lp).exp()) * Vec(gr);
+                },
+                grad_row.data(), grad_row.data(), log_probs_row.data(), num_labels);
+          } else {
+            for (int64_t c = 0; c < num_labels; c++) {
+              scalar_t& res = grad_row[c];
+              scalar_t lp = log_probs_row[c];
+              res = (std::exp(lp)-std::exp(res + nll - lp)) * gr;
+            }
+          }
+        }
+        // zero the remainder
+        if (input_length < max_input_length) {
+          grad.narrow(0, input_length, max_input_length - input_length).narrow(1, b, 1).zero_();
+        }
+      }
+    }
+  });
+}
+
+static void ctc_loss_kernel(Tensor& neg_log_likelihood, Tensor& log_alpha, const Tensor& log_probs, const Tensor& targets,
+                            IntArrayRef input_lengths, IntArrayRef target_lengths, IntArrayRef tg_batch_offsets,
+                            int64_t tg_target_stride, int64_t BLANK) {
+  AT_DISPATCH_FLOATING_TYPES(log_probs.scalar_type(), "ctc_loss_cpu", [&] {
+    if (targets.scalar_type() == kLong) {
+      ctc_loss_kernel_impl<scalar_t, int64_t>(
+          neg_log_likelihood, log_alpha, log_probs, targets, input_lengths, target_lengths, tg_batch_offsets, tg_target_stride, BLANK);
+    } else {
+      ctc_loss_kernel_impl<scalar_t, int>(
+          neg_log_likelihood, log_alpha, log_probs, targets, input_lengths, target_lengths, tg_batch_offsets, tg_target_stride, BLANK);
+    }
+  });
+}
+
+static void ctc_loss_backward_kernel(Tensor& grad, const Tensor& grad_out, const Tensor& log_probs, const Tensor& targets,
+                                     IntArrayRef input_lengths, IntArrayRef target_lengths, IntArrayRef tg_batch_offsets,
+                                     int64_t tg_target_stride, const Tensor& neg_log_likelihood, const Tensor& log_alpha,
+                                     int64_t BLANK, bool zero_infinity) {
+  AT_DISPATCH_FLOATING_TYPES(log_probs.scalar_type(), "ctc_loss_backward_cpu", [&] {
+    if (targets.scalar_type() == kLong) {
+      ctc_loss_backward_kernel_impl<scalar_t, int64_t>(
+          grad, grad_out, log_probs, targets, input_lengths, target_lengths, tg_batch_offsets, tg_target_stride,
+          neg_log_likelihood, log_alpha, BLANK, zero_infinity);
+    } else {
+      ctc_loss_backward_kernel_impl<scalar_t, int>(
+          grad, grad_out, log_probs, targets, input_lengths, target_lengths, tg_batch_offsets, tg_target_stride,
+          neg_log_likelihood, log_alpha, BLANK, zero_infinity);
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(ctc_loss_stub, &ctc_loss_kernel);
+REGISTER_DISPATCH(ctc_loss_backward_stub, &ctc_loss_backward_kernel);
+
+}} // namespace at::native
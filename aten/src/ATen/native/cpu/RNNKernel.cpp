@@ -0,0 +1,113 @@
+#include <ATen/native/RNN.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+
+namespace {
+
+using Vec = vec256::Vec256<float>;
+
+// Number of batch rows updated by a task.
+inline int64_t pointwise_grain_size(int64_t gates_size) {
+  return std::max<int64_t>(1, at::internal::GRAIN_SIZE / gates_size);
+}
+
+inline Vec sigmoid(const Vec& x) {
+  const Vec one(1.f);
+  return one / (one + x.neg().exp());
+}
+
+// Calls f(j, count) for the vectors of a row of `size` elements, the last
+// one possibly partial.
+template <typename F>
+inline void for_each_vec(int64_t size, const F& f) {
+  int64_t j = 0;
+  for (; j + Vec::size() <= size; j += Vec::size()) {
+    f(j, Vec::size());
+  }
+  if (j < size) {
+    f(j, size - j);
+  }
+}
+
+void lstm_pointwise_kernel(
+    const float* igates,
+    const float* hgates,
+    float* cx,
+    float* hy,
+    float* hy_copy,
+    int64_t batch_size,
+    int64_t hidden_size) {
+  const int64_t gates_size = 4 * hidden_size;
+  at::parallel_for(0, batch_size, pointwise_grain_size(gates_size), [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; ++b) {
+      const float* ig = igates + b * gates_size;
+      const float* hg = hgates + b * gates_size;
+      float* c = cx + b * hidden_size;
+      float* h = hy + b * hidden_size;
+      float* h_copy = hy_copy ? hy_copy + b * hidden_size : nullptr;
+      for_each_vec(hidden_size, [&](int64_t j, int64_t count) {
+        auto gate = [&](int64_t g) {
+          return Vec::loadu(ig + g * hidden_size + j, count) +
+              Vec::loadu(hg + g * hidden_size + j, count);
+        };
+        const Vec ingate = sigmoid(gate(0));
+        const Vec forgetgate = sigmoid(gate(1));
+        const Vec cellgate = gate(2).tanh();
+        const Vec outgate = sigmoid(gate(3));
+        const Vec c_new = forgetgate * Vec::loadu(c + j, count) + ingate * cellgate;
+        const Vec h_new = outgate * c_new.tanh();
+        c_new.store(c + j, count);
+        h_new.store(h + j, count);
+        if (h_copy) {
+          h_new.store(h_copy + j, count);
+        }
+      });
+    }
+  });
+}
+
+void gru_pointwise_kernel(
+    const float* igates,
+    const float* hgates,
+    const float* hx,
+    float* hy,
+    float* hy_copy,
+    int64_t batch_size,
+    int64_t hidden_size) {
+  const int64_t gates_size = 3 * hidden_size;
+  at::parallel_for(0, batch_size, pointwise_grain_size(gates_size), [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; ++b) {
+      const float* ig = igates + b * gates_size;
+      const float* hg = hgates + b * gates_size;
+      const float* h = hx + b * hidden_size;
+      float* h_out = hy + b * hidden_size;
+      float* h_copy = hy_copy ? hy_copy + b * hidden_size : nullptr;
+      for_each_vec(hidden_size, [&](int64_t j, int64_t count) {
+        const Vec reset_gate = sigmoid(
+            Vec::loadu(ig + j, count) + Vec::loadu(hg + j, count));
+        const Vec input_gate = sigmoid(
+            Vec::loadu(ig + hidden_size + j, count) +
+            Vec::loadu(hg + hidden_size + j, count));
+        const Vec new_gate = (Vec::loadu(ig + 2 * hidden_size + j, count) +
+                              reset_gate * Vec::loadu(hg + 2 * hidden_size + j, count))
+                                 .tanh();
+        const Vec h_new =
+            (Vec::loadu(h + j, count) - new_gate) * input_gate + new_gate;
+        h_new.store(h_out + j, count);
+        if (h_copy) {
+          h_new.store(h_copy + j, count);
+        }
+      });
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_pointwise_stub, &lstm_pointwise_kernel);
+REGISTER_DISPATCH(gru_pointwise_stub, &gru_pointwise_kernel);
+
+}} // namespace at::native
@@ -3,7 +3,10 @@
 #include <ATen/native/cpu/Loops.h>
 #include <ATen/Parallel.h>
 #include <c10/util/TypeList.h>
+#include <c10/util/TypeTraits.h>
 
+#include <algorithm>
+#include <memory>
 #include <sstream>
 
 namespace at { namespace native { namespace {
@@ -64,6 +67,43 @@ static inline void reduction128(char** data, int64_t n, int64_t stride, func_t o
   }
 }
 
+// Same as reduction128, for reductions that accumulate the input with
+// ops.vreduce starting from ops.ident, and combine accumulators with
+// ops.vcombine and ops.combine.
+template <typename scalar_t, typename ops_t>
+static inline void reduction128_combine(char** data, int64_t n, int64_t stride, const ops_t& ops, bool reduce) {
+  using Vec = Vec256<scalar_t>;
+  char* out_ptr = data[0];
+  const char* in1_ptr = data[1];
+  Vec acc[4];
+  for (int j = 0; j < 4; j++) {
+    acc[j] = Vec(ops.ident);
+  }
+  for (int64_t i = 0; i < n; i++) {
+    const char* ptr = in1_ptr + stride * i;
+    acc[0] = ops.vreduce(acc[0], Vec::loadu(ptr + (0 * Vec::size() * sizeof(scalar_t))));
+    acc[1] = ops.vreduce(acc[1], Vec::loadu(ptr + (1 * Vec::size() * sizeof(scalar_t))));
+    acc[2] = ops.vreduce(acc[2], Vec::loadu(ptr + (2 * Vec::size() * sizeof(scalar_t))));
+    acc[3] = ops.vreduce(acc[3], Vec::loadu(ptr + (3 * Vec::size() * sizeof(scalar_t))));
+  }
+  if (reduce) {
+    scalar_t buffer[Vec::size()];
+    acc[0] = ops.vcombine(ops.vcombine(acc[0], acc[1]), ops.vcombine(acc[2], acc[3]));
+    acc[0].store(buffer);
+    for (int j = 1; j < Vec::size(); j++) {
+      buffer[0] = ops.combine(buffer[0], buffer[j]);
+    }
+    auto dst = (scalar_t*)out_ptr;
+    *dst = ops.combine(*dst, buffer[0]);
+  } else {
+    for (int j = 0; j < 4; j++) {
+      auto dst = out_ptr + j * Vec::size() * sizeof(scalar_t);
+      acc[j] = ops.vcombine(acc[j], Vec::loadu(dst));
+      acc[j].store(dst);
+    }
+  }
+}
+
 template <typename F>
 static inline void UNARY_OUTER_LOOP(char* data[2], const int64_t strides[2], int64_t n, F f) {
   for (int j = 0; j < n; j++) {
@@ -172,11 +212,116 @@ struct all_same : guts::conjunction<
 //
 // If there is more than one output element,
 // our parallelization strategy is to use one thread for each of them,
-// which means that `combine` will never be called.
+// which means that `combine` will never be called, except for reductions over
+// dim 0 of inputs that are contiguous over dim 1, see reduce_outer_columns.
 //
 // If, on the other hand, there is only one, then we split the input into
 // into several pieces, reduce each separately, and then combine them.
 
+// Reduces dim 0 of a reduction whose input and single output are contiguous
+// over dim 1, e.g. argmax over dim 0 of a contiguous matrix, by sweeping the
+// rows of a block of columns with one accumulator per column, instead of
+// reducing each column on its own with a large stride. Blocks of columns are
+// split across threads or, when there are too few of them to keep the threads
+// busy, the rows are split into one chunk per thread, whose accumulators are
+// then combined in order.
+//
+// Returns false, without doing anything, if iter does not have that layout.
+template <typename ops_t, typename init_t>
+static bool reduce_outer_columns(TensorIterator& iter, const ops_t& ops, init_t init) {
+  using acc_t = init_t;
+  using data_t = typename binary_function_traits<decltype(&ops_t::reduce)>::arg2_t;
+  using res_t = typename unary_function_traits<decltype(&ops_t::project)>::result_type;
+  constexpr int64_t kColumns = 64;
+
+  const int ndim = iter.ndim();
+  if (guts::is_instantiation_of<std::tuple, res_t>::value ||
+      iter.noutputs() != 1 || iter.num_reduce_dims() != 1 || ndim < 2 ||
+      iter.strides(0)[1] != sizeof(res_t) || iter.strides(1)[1] != sizeof(data_t)) {
+    return false;
+  }
+  auto shape = iter.shape();
+  const int64_t rows = shape[0];
+  const int64_t cols = shape[1];
+  int64_t outer = 1;
+  for (int dim = 2; dim < ndim; dim++) {
+    outer *= shape[dim];
+  }
+  const int64_t row_stride = iter.strides(1)[0];
+  char* out_data = (char*)iter.data_ptr(0);
+  const char* in_data = (char*)iter.data_ptr(1);
+  const int64_t base_idx = iter.view_offsets()[0];
+
+  // byte offset of the o-th index over dims 2.. in operand arg
+  auto outer_offset = [&](int64_t o, int arg) {
+    int64_t offset = 0;
+    for (int dim = 2; dim < ndim; dim++) {
+      offset += (o % shape[dim]) * iter.strides(arg)[dim];
+      o /= shape[dim];
+    }
+    return offset;
+  };
+  // accumulates rows [row_begin, row_end) of n columns starting at in
+  auto reduce_rows = [&](acc_t* acc, const char* in, int64_t n, int64_t row_begin, int64_t row_end) {
+    for (int64_t row = row_begin; row < row_end; row++) {
+      auto row_data = (const data_t*)(in + row * row_stride);
+      for (int64_t j = 0; j < n; j++) {
+        acc[j] = ops.reduce(acc[j], row_data[j], row);
+      }
+    }
+  };
+  auto store = [&](const acc_t* acc, char* out, int64_t n) {
+    for (int64_t j = 0; j < n; j++) {
+      ((res_t*)out)[j] = ops.project(ops.translate_idx(acc[j], base_idx));
+    }
+  };
+
+  const int64_t num_blocks = outer * divup(cols, kColumns);
+  const int num_threads = at::get_num_threads();
+  if (num_blocks >= num_threads || rows < 2 * num_threads ||
+      iter.numel() < at::internal::GRAIN_SIZE || at::in_parallel_region()) {
+    const int64_t blocks_per_row = divup(cols, kColumns);
+    const int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / (rows * kColumns));
+    at::parallel_for(0, num_blocks, grain_size, [&](int64_t begin, int64_t end) {
+      std::unique_ptr<acc_t[]> acc(new acc_t[kColumns]);
+      for (int64_t block = begin; block < end; block++) {
+        const int64_t o = block / blocks_per_row;
+        const int64_t col = (block % blocks_per_row) * kColumns;
+        const int64_t n = std::min(kColumns, cols - col);
+        std::fill(acc.get(), acc.get() + n, init);
+        reduce_rows(acc.get(), in_data + outer_offset(o, 1) + col * sizeof(data_t), n, 0, rows);
+        store(acc.get(), out_data + outer_offset(o, 0) + col * sizeof(res_t), n);
+      }
+    });
+  } else {
+    const int64_t chunk_rows = divup(rows, (int64_t)num_threads);
+    const int64_t chunk_size = outer * cols;
+    std::unique_ptr<acc_t[]> buffer(new acc_t[num_threads * chunk_size]);
+    std::fill(buffer.get(), buffer.get() + num_threads * chunk_size, init);
+    at::parallel_for(0, num_threads, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; chunk++) {
+        const int64_t row_begin = std::min(rows, chunk * chunk_rows);
+        const int64_t row_end = std::min(rows, row_begin + chunk_rows);
+        for (int64_t o = 0; o < outer; o++) {
+          acc_t* acc = buffer.get() + chunk * chunk_size + o * cols;
+          reduce_rows(acc, in_data + outer_offset(o, 1), cols, row_begin, row_end);
+        }
+      }
+    });
+    for (int64_t o = 0; o < outer; o++) {
+      acc_t* total = buffer.get() + o * cols;
+      for (int chunk = 1; chunk < num_threads; chunk++) {
+        const acc_t* acc = buffer.get() + chunk * chunk_size + o * cols;
+        for (int64_t j = 0; j < cols; j++) {
+          total[j] = ops.combine(total[j], acc[j]);
+        }
+      }
+      store(total, out_data + outer_offset(o, 0), cols);
+    }
+  }
+  return true;
+}
+
 template <typename ops_t, typename init_t>
 void binary_kernel_reduce(TensorIterator& iter, ops_t ops, init_t init) {
   using rf_t = decltype(&ops_t::reduce);
@@ -201,6 +346,9 @@ void binary_kernel_reduce(TensorIterator& iter, ops_t ops, init_t init) {
     std::is_default_constructible<acc_t>::value,
     "the accumulate type must be default-constructible"
   );
+  if (reduce_outer_columns(iter, ops, init)) {
+    return;
+  }
   const int num_outputs = iter.noutputs();
   iter.foreach_reduced_elt([&ops, &init, num_outputs](TensorIterator &sub_iter) {
     auto reduction_body = [&ops, &sub_iter, num_outputs](acc_t acc, int64_t begin, int64_t end) -> acc_t {
@@ -243,6 +391,30 @@ void binary_kernel_reduce(TensorIterator& iter, ops_t ops, init_t init) {
   });
 }
 
+// computes out = op(out, in) over a 2-d block of a reduction, with the
+// vectorized inner or outer loops when the strides allow it
+template <typename func_t, typename vec_func_t>
+static inline void vectorized_reduction_loop(char** data, const int64_t* strides, int64_t size0, int64_t size1, func_t op, vec_func_t vop) {
+  using traits = binary_function_traits<func_t>;
+  int64_t outer_strides[] = { strides[2], strides[3] };
+  if (is_contiguous_reduction<traits>(strides)) {
+    // input is contiguous in dim 0, output is reduced in dim 0
+    UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+      vectorized_inner_reduction(data, size0, op, vop);
+    });
+  } else if (is_outer_reduction<traits>(strides)) {
+    // input and output are contiguous in dim 1
+    int64_t inner_stride = strides[1]; // stride of input in dim 0
+    vectorized_outer_reduction(data, inner_stride, size0, size1, op, vop);
+  } else {
+    UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+      char* ptrs[3] = { data[0], data[0], data[1] };
+      int64_t inner_strides[3] = { strides[0], strides[0], strides[1] };
+      basic_loop(ptrs, inner_strides, 0, size0, op);
+    });
+  }
+}
+
 template <typename func_t, typename vec_func_t>
 void binary_kernel_reduce_vec(TensorIterator& iter, func_t op, vec_func_t vop, double ident = 0) {
   using traits = binary_function_traits<func_t>;
@@ -255,24 +427,107 @@ void binary_kernel_reduce_vec(TensorIterator& iter, func_t op, vec_func_t vop, d
 
   iter.output().fill_(ident);
   iter.parallel_reduce([&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
-    int64_t outer_strides[] = { strides[2], strides[3] };
-    if (is_contiguous_reduction<traits>(strides)) {
-      // input is contiguous in dim 0, output is reduced in dim 0
-      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
-        vectorized_inner_reduction(data, size0, op, vop);
-      });
-    } else if (is_outer_reduction<traits>(strides)) {
-      // input and output are contiguous in dim 1
-      int64_t inner_stride = strides[1]; // stride of input in dim 0
-      vectorized_outer_reduction(data, inner_stride, size0, size1, op, vop);
-    } else {
-      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
-        char* ptrs[3] = { data[0], data[0], data[1] };
-        int64_t inner_strides[3] = { strides[0], strides[0], strides[1] };
-        basic_loop(ptrs, inner_strides, 0, size0, op);
-      });
-    }
+    vectorized_reduction_loop(data, strides, size0, size1, op, vop);
   });
 }
 
+template <typename scalar_t, typename reduce_t, typename vec_reduce_t,
+          typename combine_t, typename vec_combine_t>
+struct CombineReduceOps {
+  reduce_t reduce;
+  vec_reduce_t vreduce;
+  combine_t combine;
+  vec_combine_t vcombine;
+  scalar_t ident;
+};
+
+// computes out = reduce(out, in) over a 2-d block of a reduction, where the
+// vectorized loops keep several accumulators that are merged with combine
+template <typename scalar_t, typename ops_t>
+static inline void vectorized_combine_reduction_loop(char** data, const int64_t* strides, int64_t size0, int64_t size1, const ops_t& ops) {
+  using Vec = Vec256<scalar_t>;
+  constexpr int64_t block = 4 * Vec::size();
+  int64_t outer_strides[] = { strides[2], strides[3] };
+  auto serial_reduce = [&](char* out_ptr, const char* in_ptr, int64_t out_stride, int64_t in_stride, int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      auto out = (scalar_t*)(out_ptr + i * out_stride);
+      *out = ops.reduce(*out, *(const scalar_t*)(in_ptr + i * in_stride));
+    }
+  };
+  if (strides[0] == 0 && strides[1] == sizeof(scalar_t)) {
+    // input is contiguous in dim 0, output is reduced in dim 0
+    UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+      int64_t count = size0 / block;
+      if (count > 0) {
+        reduction128_combine<scalar_t>(data, count, block * (int64_t)sizeof(scalar_t), ops, /*reduce=*/true);
+      }
+      serial_reduce(data[0], data[1], 0, sizeof(scalar_t), count * block, size0);
+    });
+  } else if (strides[0] == 0 && strides[2] == sizeof(scalar_t) && strides[3] == sizeof(scalar_t)) {
+    // input and output are contiguous in dim 1
+    int64_t column_strides[] = { 128, 128 };
+    UNARY_OUTER_LOOP(data, column_strides, size1 / block, [&] {
+      reduction128_combine<scalar_t>(data, size0, strides[1], ops, /*reduce=*/false);
+    });
+    int64_t step[] = { sizeof(scalar_t), sizeof(scalar_t) };
+    UNARY_OUTER_LOOP(data, step, size1 % block, [&] {
+      serial_reduce(data[0], data[1], 0, strides[1], 0, size0);
+    });
+  } else {
+    UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+      serial_reduce(data[0], data[1], strides[0], strides[1], 0, size0);
+    });
+  }
+}
+
+// Vectorized reduction out = reduce(out, in) for reductions whose
+// accumulators are merged with a different function than the one that
+// accumulates the input, e.g. a sum of squares, whose partial sums are added:
+//
+//   reduce: (scalar_t acc, scalar_t in) -> scalar_t
+//   combine: (scalar_t acc, scalar_t acc) -> scalar_t
+//
+// and vreduce and vcombine are the same on Vec256<scalar_t>. ident is the
+// identity of combine, and the value of the reduction of zero elements.
+// Input, output and accumulators all have type scalar_t.
+template <typename reduce_t, typename vec_reduce_t, typename combine_t, typename vec_combine_t>
+void binary_kernel_reduce_combine_vec(TensorIterator& iter, reduce_t reduce, vec_reduce_t vreduce,
+                                      combine_t combine, vec_combine_t vcombine, double ident = 0) {
+  using traits = binary_function_traits<combine_t>;
+  using scalar_t = typename traits::result_type;
+  static_assert(
+    all_same<
+      scalar_t,
+      typename traits::arg1_t,
+      typename traits::arg2_t,
+      typename binary_function_traits<reduce_t>::result_type,
+      typename binary_function_traits<reduce_t>::arg1_t,
+      typename binary_function_traits<reduce_t>::arg2_t>::value,
+    "all types must match");
+
+  CombineReduceOps<scalar_t, reduce_t, vec_reduce_t, combine_t, vec_combine_t> ops {
+    reduce, vreduce, combine, vcombine, scalar_t(ident)};
+  iter.output().fill_(ident);
+  iter.parallel_reduce(
+    [&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+      vectorized_combine_reduction_loop<scalar_t>(data, strides, size0, size1, ops);
+    },
+    [&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+      vectorized_reduction_loop(data, strides, size0, size1, combine, vcombine);
+    });
+}
+
+// Same as above, followed by out = project(out) on each output element, e.g.
+// the square root of a sum of squares.
+template <typename reduce_t, typename vec_reduce_t, typename combine_t, typename vec_combine_t,
+          typename project_t, typename vec_project_t>
+void binary_kernel_reduce_combine_vec(TensorIterator& iter, reduce_t reduce, vec_reduce_t vreduce,
+                                      combine_t combine, vec_combine_t vcombine,
+                                      project_t project, vec_project_t vproject, double ident = 0) {
+  binary_kernel_reduce_combine_vec(iter, reduce, vreduce, combine, vcombine, ident);
+  auto result = iter.output();
+  auto project_iter = TensorIterator::unary_op(result, result);
+  cpu_kernel_vec(project_iter, project, vproject);
+}
+
 }}}  // namespace at::native::<anonymous>
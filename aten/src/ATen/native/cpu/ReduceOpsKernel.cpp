@@ -1,6 +1,8 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include <ATen/Dispatch.h>
 #include <ATen/cpu/vec256/vec256.h>
@@ -134,6 +136,20 @@ static void sum_kernel_impl(TensorIterator& iter) {
 }
 
 static void mean_kernel_impl(TensorIterator& iter) {
+  if (isFloatingType(iter.dtype()) && iter.dtype() != kHalf &&
+      iter.dtype() != kBFloat16 && iter.dtype(0) == iter.dtype(1)) {
+    // vectorized sum, scaled by the number of reduced elements
+    AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "mean_cpu", [&] {
+      scalar_t factor = scalar_t(iter.num_output_elements()) / scalar_t(iter.numel());
+      auto add = [](scalar_t a, scalar_t b) -> scalar_t { return a + b; };
+      auto vadd = [](Vec256<scalar_t> a, Vec256<scalar_t> b) { return a + b; };
+      binary_kernel_reduce_combine_vec(
+        iter, add, vadd, add, vadd,
+        [=](scalar_t a) -> scalar_t { return a * factor; },
+        [=](Vec256<scalar_t> a) { return a * Vec256<scalar_t>(factor); });
+    });
+    return;
+  }
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX(iter.dtype(), "mean_cpu", [&] {
     scalar_t factor = scalar_t(iter.num_output_elements()) / scalar_t(iter.numel());
     binary_kernel_reduce(
@@ -154,6 +170,17 @@ static void std_var_kernel_impl(TensorIterator &iter, bool unbiased, bool take_s
   });
 }
 
+static void reduce_stats_kernel_impl(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.input_dtype(), "reduce_stats_cpu", [&] {
+    binary_kernel_reduce(
+      iter,
+      ReduceStatsOps<scalar_t, double> {},
+      ReduceStatsData<double>(
+        0, 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 0)
+    );
+  });
+}
+
 static void prod_kernel_impl(TensorIterator& iter) {
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX(iter.dtype(), "prod_cpu", [&] {
     binary_kernel_reduce_vec(
@@ -164,6 +191,40 @@ static void prod_kernel_impl(TensorIterator& iter) {
   });
 }
 
+// Finite, non-zero p-norms of float and double tensors, which accumulate
+// |x|^p with several vector accumulators and add them up.
+static void norm_kernel_vec(TensorIterator& iter, float val) {
+  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "norm_cpu", [&] {
+    using Vec = Vec256<scalar_t>;
+    auto add = [](scalar_t a, scalar_t b) -> scalar_t { return a + b; };
+    auto vadd = [](Vec a, Vec b) { return a + b; };
+    if (val == 1) {
+      binary_kernel_reduce_combine_vec(
+        iter,
+        [](scalar_t acc, scalar_t x) -> scalar_t { return acc + std::abs(x); },
+        [](Vec acc, Vec x) { return acc + x.abs(); },
+        add, vadd);
+    } else if (val == 2) {
+      binary_kernel_reduce_combine_vec(
+        iter,
+        [](scalar_t acc, scalar_t x) -> scalar_t { return acc + x * x; },
+        [](Vec acc, Vec x) { return acc + x * x; },
+        add, vadd,
+        [](scalar_t a) -> scalar_t { return std::sqrt(a); },
+        [](Vec a) { return a.sqrt(); });
+    } else {
+      const scalar_t p = val;
+      binary_kernel_reduce_combine_vec(
+        iter,
+        [=](scalar_t acc, scalar_t x) -> scalar_t { return acc + std::pow(std::abs(x), p); },
+        [=](Vec acc, Vec x) { return acc + x.abs().pow(Vec(p)); },
+        add, vadd,
+        [=](scalar_t a) -> scalar_t { return std::pow(a, scalar_t(1) / p); },
+        [=](Vec a) { return a.pow(Vec(scalar_t(1) / p)); });
+    }
+  });
+}
+
 static void norm_kernel_tensor_iterator_impl(
     TensorIterator& iter,
     Scalar p) {
@@ -176,6 +237,11 @@ static void norm_kernel_tensor_iterator_impl(
     AT_ERROR("norm_kernel_tensor_iterator_impl expects norm to be integer or float");
   }
 
+  if ((iter.dtype() == kFloat || iter.dtype() == kDouble) &&
+      iter.dtype(0) == iter.dtype(1) && val != 0 && std::isfinite(val)) {
+    norm_kernel_vec(iter, val);
+    return;
+  }
 
   if (val == 0) {
     AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kHalf, iter.dtype(), "norm_cpu", [&] {
@@ -306,6 +372,7 @@ static void argmin_kernel_impl(TensorIterator &iter) {
 
 REGISTER_DISPATCH(sum_stub, &sum_kernel_impl);
 REGISTER_DISPATCH(std_var_stub, &std_var_kernel_impl);
+REGISTER_DISPATCH(reduce_stats_stub, &reduce_stats_kernel_impl);
 REGISTER_DISPATCH(prod_stub, &prod_kernel_impl);
 REGISTER_DISPATCH(mean_stub, &mean_kernel_impl);
 REGISTER_DISPATCH(norm_stub, &norm_kernel_tensor_iterator_impl);
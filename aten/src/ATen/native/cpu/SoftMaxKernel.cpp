@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <vector>
 
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
@@ -184,6 +185,161 @@ inline void _vec_host_softmax_backward_lastdim(
       });
 }
 
+// The BFloat16 versions widen each row to float once, so that the max, the
+// sums and the normalization are computed in float and only the result is
+// rounded to BFloat16.
+template <bool log_softmax>
+inline void _vec_softmax_lastdim_bfloat16(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using fVec = vec256::Vec256<float>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        std::vector<float> buffer(dim_size);
+        float* buffer_data = buffer.data();
+        for (int64_t i = begin; i < end; i++) {
+          vec256::convert(input_data_base + i * dim_size, buffer_data, dim_size);
+          float max_input = vec256::reduce_all<float>(
+              [](fVec& x, fVec& y) { return vec256::maximum(x, y); },
+              buffer_data,
+              dim_size);
+          if (log_softmax) {
+            float tmp_sum = vec256::map_reduce_all<float>(
+                [max_input](fVec x) { return (x - fVec(max_input)).exp(); },
+                [](fVec x, fVec y) { return x + y; },
+                buffer_data,
+                dim_size);
+            // See [Note AVX-SSE transitions]
+            vec256::map([](fVec x) { return x.log(); }, &tmp_sum, &tmp_sum, 1);
+            vec256::map(
+                [tmp_sum, max_input](fVec x) { return x - fVec(max_input) - fVec(tmp_sum); },
+                buffer_data,
+                buffer_data,
+                dim_size);
+          } else {
+            vec256::map(
+                [max_input](fVec x) { return (x - fVec(max_input)).exp(); },
+                buffer_data,
+                buffer_data,
+                dim_size);
+            float tmp_sum = vec256::reduce_all<float>(
+                [](fVec x, fVec y) { return x + y; }, buffer_data, dim_size);
+            tmp_sum = 1 / tmp_sum;
+            vec256::map(
+                [tmp_sum](fVec x) { return x * fVec(tmp_sum); },
+                buffer_data,
+                buffer_data,
+                dim_size);
+          }
+          vec256::convert(buffer_data, output_data_base + i * dim_size, dim_size);
+        }
+      });
+}
+
+template <>
+inline void _vec_log_softmax_lastdim<BFloat16>(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  _vec_softmax_lastdim_bfloat16<true>(
+      input_data_base, output_data_base, outer_size, dim_size);
+}
+
+template <>
+inline void _vec_softmax_lastdim<BFloat16>(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  _vec_softmax_lastdim_bfloat16<false>(
+      input_data_base, output_data_base, outer_size, dim_size);
+}
+
+template <bool log_softmax>
+inline void _vec_softmax_backward_lastdim_bfloat16(
+    BFloat16* grad_input_data_base,
+    BFloat16* grad_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using fVec = vec256::Vec256<float>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        std::vector<float> grad_buffer(dim_size);
+        std::vector<float> output_buffer(dim_size);
+        float* grad_data = grad_buffer.data();
+        float* output_data = output_buffer.data();
+        for (int64_t i = begin; i < end; i++) {
+          vec256::convert(grad_data_base + i * dim_size, grad_data, dim_size);
+          vec256::convert(output_data_base + i * dim_size, output_data, dim_size);
+          float sum;
+          if (log_softmax) {
+            sum = vec256::reduce_all<float>(
+                [](fVec& x, fVec& y) { return x + y; }, grad_data, dim_size);
+            vec256::map2(
+                [sum](fVec x, fVec y) { return x - ((y.exp()) * fVec(sum)); },
+                grad_data,
+                grad_data,
+                output_data,
+                dim_size);
+          } else {
+            sum = vec256::map2_reduce_all<float>(
+                [](fVec x, fVec y) { return x * y; },
+                [](fVec x, fVec y) { return x + y; },
+                grad_data,
+                output_data,
+                dim_size);
+            vec256::map2(
+                [sum](fVec x, fVec y) { return (x - fVec(sum)) * y; },
+                grad_data,
+                grad_data,
+                output_data,
+                dim_size);
+          }
+          vec256::convert(grad_data, grad_input_data_base + i * dim_size, dim_size);
+        }
+      });
+}
+
+template <>
+inline void _vec_host_softmax_backward_lastdim<BFloat16, true>(
+    BFloat16* grad_input_data_base,
+    BFloat16* grad_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  _vec_softmax_backward_lastdim_bfloat16<true>(
+      grad_input_data_base, grad_data_base, output_data_base, outer_size, dim_size);
+}
+
+template <>
+inline void _vec_host_softmax_backward_lastdim<BFloat16, false>(
+    BFloat16* grad_input_data_base,
+    BFloat16* grad_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  _vec_softmax_backward_lastdim_bfloat16<false>(
+      grad_input_data_base, grad_data_base, output_data_base, outer_size, dim_size);
+}
+
 template <typename scalar_t, bool LogSoftMax>
 struct vec_host_softmax_lastdim {
   static void apply(Tensor& output, const Tensor& input) {
@@ -224,9 +380,10 @@ struct vec_host_softmax_backward_lastdim {
 };
 
 static void softmax_lastdim_kernel_impl(Tensor& result, const Tensor& self) {
-  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_lastdim_kernel_impl", [&] {
-    vec_host_softmax_lastdim<scalar_t, false>::apply(result, self);
-  });
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "softmax_lastdim_kernel_impl",
+      [&] { vec_host_softmax_lastdim<scalar_t, false>::apply(result, self); });
 }
 
 static void log_softmax_lastdim_kernel_impl(
@@ -242,8 +399,9 @@ static void softmax_backward_lastdim_kernel_impl(
     Tensor& grad_input,
     const Tensor& grad,
     const Tensor& output) {
-  AT_DISPATCH_FLOATING_TYPES(
-      grad.scalar_type(), "softmax_backward_lastdim_kernel_impl", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, grad.scalar_type(),
+      "softmax_backward_lastdim_kernel_impl", [&] {
         vec_host_softmax_backward_lastdim<scalar_t, false>::apply(
             grad_input, grad, output);
       });
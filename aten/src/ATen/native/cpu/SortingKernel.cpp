@@ -4,11 +4,369 @@
 #include <ATen/NumericUtils.h>
 #include <ATen/native/Sorting.h>
 #include <ATen/native/SortingUtils.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/ReduceOpsUtils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
 namespace at { namespace native {
 
 namespace {
 
+// Rows up to this size are sorted by insertion sort, which does less work
+// than std::sort's introsort on them.
+constexpr int64_t kInsertionSortMaxSize = 16;
+// 1-D inputs from this size on are sorted by a parallel radix sort, when
+// their dtype has a radix key.
+constexpr int64_t kRadixSortMinSize = 1 << 16;
+// Rows of topk from this size on are split across threads, when there are
+// fewer rows than threads.
+constexpr int64_t kParallelTopkMinSize = 1 << 15;
+
+// Calls f(values_data, values_dim_stride, indices_data, indices_dim_stride,
+// self_data, self_dim_stride) for each slice along `dim` of the tensors,
+// in parallel over the slices unless `serial`. The tensors must have the
+// same sizes except along dim.
+template <typename scalar_t, typename func_t>
+void _dim_apply(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    int64_t dim_size,
+    const func_t& f,
+    bool serial = false) {
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .dont_resize_outputs()
+    .declare_static_shape(values.sizes(), /*squash_dim=*/dim)
+    .add_output(values)
+    .add_output(indices)
+    .add_input(self)
+    .build();
+
+  auto values_dim_stride = ensure_nonempty_stride(values, dim);
+  auto indices_dim_stride = ensure_nonempty_stride(indices, dim);
+  auto self_dim_stride = ensure_nonempty_stride(self, dim);
+
+  auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+    auto* values_data_bytes = data[0];
+    auto* indices_data_bytes = data[1];
+    const auto* self_data_bytes = data[2];
+
+    for (int64_t i = 0; i < n; ++i) {
+      f(
+        reinterpret_cast<scalar_t*>(values_data_bytes), values_dim_stride,
+        reinterpret_cast<int64_t*>(indices_data_bytes), indices_dim_stride,
+        reinterpret_cast<const scalar_t*>(self_data_bytes), self_dim_stride
+      );
+      values_data_bytes += strides[0];
+      indices_data_bytes += strides[1];
+      self_data_bytes += strides[2];
+    }
+  };
+
+  if (serial) {
+    iter.serial_for_each(loop, {0, iter.numel()});
+  } else {
+    int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, dim_size));
+    iter.for_each(loop, grain_size);
+  }
+}
+
+// we want NaN to be sorted as top for numpy compatibility
+template <typename scalar_t>
+struct KeyValueCompAsc {
+  template <typename elem_t>
+  bool operator()(const elem_t& x, const elem_t& y) const {
+    return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
+  }
+};
+
+template <typename scalar_t>
+struct KeyValueCompDesc {
+  template <typename elem_t>
+  bool operator()(const elem_t& x, const elem_t& y) const {
+    return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
+  }
+};
+
+template <typename elem_t, typename comp_t>
+void insertion_sort(elem_t* begin, elem_t* end, const comp_t& comp) {
+  for (auto it = begin + 1; it < end; ++it) {
+    auto elem = *it;
+    auto hole = it;
+    for (; hole > begin && comp(elem, *(hole - 1)); --hole) {
+      *hole = *(hole - 1);
+    }
+    *hole = elem;
+  }
+}
+
+template <typename elem_t, typename comp_t>
+void sort_row(std::vector<elem_t>& row, const comp_t& comp) {
+  if (static_cast<int64_t>(row.size()) <= kInsertionSortMaxSize) {
+    insertion_sort(row.data(), row.data() + row.size(), comp);
+  } else {
+    std::sort(row.begin(), row.end(), comp);
+  }
+}
+
+// Maps the values of a dtype to unsigned integer keys with the same order,
+// for radix sort. NaNs are mapped above +inf, as in the comparison sort.
+template <typename scalar_t>
+struct RadixKey {
+  static constexpr bool supported = false;
+};
+
+template <>
+struct RadixKey<int32_t> {
+  static constexpr bool supported = true;
+  using key_t = uint32_t;
+  static key_t encode(int32_t v) { return static_cast<key_t>(v) ^ (key_t(1) << 31); }
+  static int32_t decode(key_t k) { return static_cast<int32_t>(k ^ (key_t(1) << 31)); }
+};
+
+template <>
+struct RadixKey<int64_t> {
+  static constexpr bool supported = true;
+  using key_t = uint64_t;
+  static key_t encode(int64_t v) { return static_cast<key_t>(v) ^ (key_t(1) << 63); }
+  static int64_t decode(key_t k) { return static_cast<int64_t>(k ^ (key_t(1) << 63)); }
+};
+
+// Floating point keys flip the sign bit of positive values, and all the bits
+// of negative ones.
+template <typename value_t, typename bits_t>
+struct FloatRadixKey {
+  static constexpr bool supported = true;
+  using key_t = bits_t;
+  static constexpr key_t kSignBit = key_t(1) << (sizeof(key_t) * 8 - 1);
+  static key_t encode(value_t v) {
+    if (_isnan<value_t>(v)) {
+      v = std::numeric_limits<value_t>::quiet_NaN();
+    }
+    key_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (bits & kSignBit) ? ~bits : (bits | kSignBit);
+  }
+  static value_t decode(key_t k) {
+    key_t bits = (k & kSignBit) ? (k & ~kSignBit) : ~k;
+    value_t v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+};
+
+template <>
+struct RadixKey<float> : FloatRadixKey<float, uint32_t> {};
+
+template <>
+struct RadixKey<double> : FloatRadixKey<double, uint64_t> {};
+
+// Stable LSD radix sort of keys and their indices, by bytes. The histogram
+// and scatter of each pass are split across threads, and the passes over
+// bytes that are the same for all keys are skipped.
+template <typename key_t>
+void radix_sort(std::vector<key_t>& keys, std::vector<int64_t>& idx) {
+  constexpr int kRadixBits = 8;
+  constexpr int kRadix = 1 << kRadixBits;
+  const int64_t n = keys.size();
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / at::internal::GRAIN_SIZE));
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+
+  std::vector<key_t> keys_tmp(n);
+  std::vector<int64_t> idx_tmp(n);
+  std::vector<int64_t> offsets(num_chunks * kRadix);
+
+  for (size_t pass = 0; pass < sizeof(key_t); pass++) {
+    const int shift = pass * kRadixBits;
+    std::fill(offsets.begin(), offsets.end(), 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        auto* counts = offsets.data() + c * kRadix;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          counts[(keys[i] >> shift) & (kRadix - 1)]++;
+        }
+      }
+    });
+
+    // Turn the counts into the offsets at which each chunk scatters each
+    // digit.
+    bool skip = false;
+    int64_t running = 0;
+    for (int d = 0; d < kRadix && !skip; d++) {
+      const int64_t digit_start = running;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        const auto count = offsets[c * kRadix + d];
+        offsets[c * kRadix + d] = running;
+        running += count;
+      }
+      skip = running - digit_start == n;
+    }
+    if (skip) {
+      continue;
+    }
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        auto* chunk_offsets = offsets.data() + c * kRadix;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          const auto pos = chunk_offsets[(keys[i] >> shift) & (kRadix - 1)]++;
+          keys_tmp[pos] = keys[i];
+          idx_tmp[pos] = idx[i];
+        }
+      }
+    });
+    std::swap(keys, keys_tmp);
+    std::swap(idx, idx_tmp);
+  }
+}
+
+template <typename scalar_t,
+          typename std::enable_if<RadixKey<scalar_t>::supported, int>::type = 0>
+void radix_sort_1d(Tensor& values, Tensor& indices, bool descending) {
+  using radix_key = RadixKey<scalar_t>;
+  using key_t = typename radix_key::key_t;
+  const int64_t n = values.numel();
+  auto* values_data = values.data_ptr<scalar_t>();
+  auto* indices_data = indices.data_ptr<int64_t>();
+  const auto values_stride = values.stride(0);
+  const auto indices_stride = indices.stride(0);
+
+  // Descending order sorts the complements of the keys, which keeps NaNs
+  // first.
+  std::vector<key_t> keys(n);
+  std::vector<int64_t> idx(n);
+  at::parallel_for(0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const auto key = radix_key::encode(values_data[i * values_stride]);
+      keys[i] = descending ? ~key : key;
+      idx[i] = i;
+    }
+  });
+
+  radix_sort(keys, idx);
+
+  at::parallel_for(0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      values_data[i * values_stride] = radix_key::decode(descending ? ~keys[i] : keys[i]);
+      indices_data[i * indices_stride] = idx[i];
+    }
+  });
+}
+
+template <typename scalar_t,
+          typename std::enable_if<!RadixKey<scalar_t>::supported, int>::type = 0>
+void radix_sort_1d(Tensor& values, Tensor& indices, bool descending) {
+  TORCH_INTERNAL_ASSERT(false, "radix sort is not supported for ", values.scalar_type());
+}
+
+static void sort_kernel(
+    Tensor& values,
+    Tensor& indices,
+    int64_t dim,
+    bool descending) {
+  dim = maybe_wrap_dim(dim, values.dim());
+  const auto dim_size = ensure_nonempty_size(values, dim);
+  if (values.numel() == 0) {
+    return;
+  }
+  AT_DISPATCH_ALL_TYPES_AND(ScalarType::Half, values.scalar_type(), "sort_cpu", [&] {
+    if (RadixKey<scalar_t>::supported && values.dim() == 1 && dim_size >= kRadixSortMinSize) {
+      radix_sort_1d<scalar_t>(values, indices, descending);
+      return;
+    }
+
+    // values holds a copy of self, and is sorted in place.
+    _dim_apply<scalar_t>(values, indices, values, dim, dim_size,
+      [&](scalar_t* values_data, int64_t values_dim_stride,
+          int64_t* indices_data, int64_t indices_dim_stride,
+          const scalar_t* /*unused*/, int64_t /*unused*/) {
+        using elem_t = std::pair<scalar_t, int64_t>;
+        std::vector<elem_t> row(dim_size);
+        for (int64_t j = 0; j < dim_size; j++) {
+          row[j].first = values_data[j * values_dim_stride];
+          row[j].second = j;
+        }
+        if (descending) {
+          sort_row(row, KeyValueCompDesc<scalar_t>());
+        } else {
+          sort_row(row, KeyValueCompAsc<scalar_t>());
+        }
+        for (int64_t j = 0; j < dim_size; j++) {
+          values_data[j * values_dim_stride] = row[j].first;
+          indices_data[j * indices_dim_stride] = row[j].second;
+        }
+      });
+  });
+}
+
+// Reorders queue so that its first k elements are the top k for comp,
+// sorted if `sorted`.
+template <typename elem_t, typename comp_t>
+void select_topk(std::vector<elem_t>& queue, int64_t k, bool sorted, const comp_t& comp) {
+  const int64_t n = queue.size();
+  if (k == 0) {
+    return;
+  }
+  if (k * 64 <= n) {
+    std::partial_sort(queue.begin(), queue.begin() + k, queue.end(), comp);
+  } else {
+    std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(), comp);
+    if (sorted) {
+      std::sort(queue.begin(), queue.begin() + k - 1, comp);
+    }
+  }
+}
+
+// Selects the top k of a single large row with all the threads: each thread
+// selects the top k of a chunk of the row, and the top k of these candidates
+// are selected at the end.
+template <typename scalar_t, typename comp_t>
+void parallel_topk_row(
+    std::vector<std::pair<scalar_t, int64_t>>& queue,
+    const scalar_t* self_data,
+    int64_t self_dim_stride,
+    int64_t n,
+    int64_t k,
+    bool sorted,
+    const comp_t& comp) {
+  using elem_t = std::pair<scalar_t, int64_t>;
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / kParallelTopkMinSize));
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+
+  std::vector<std::vector<elem_t>> candidates(num_chunks);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const int64_t chunk_begin = c * chunk_size;
+      const int64_t chunk_end = std::min(n, chunk_begin + chunk_size);
+      auto& chunk = candidates[c];
+      chunk.resize(std::max<int64_t>(0, chunk_end - chunk_begin));
+      for (int64_t j = chunk_begin; j < chunk_end; j++) {
+        chunk[j - chunk_begin].first = self_data[j * self_dim_stride];
+        chunk[j - chunk_begin].second = j;
+      }
+      const int64_t chunk_k = std::min<int64_t>(k, chunk.size());
+      if (chunk_k > 0) {
+        std::nth_element(chunk.begin(), chunk.begin() + chunk_k - 1, chunk.end(), comp);
+      }
+      chunk.resize(chunk_k);
+    }
+  });
+
+  queue.clear();
+  for (const auto& chunk : candidates) {
+    queue.insert(queue.end(), chunk.begin(), chunk.end());
+  }
+  select_topk(queue, k, sorted, comp);
+}
+
 static void topk_kernel(
     Tensor& values,
     Tensor& indices,
@@ -17,74 +375,59 @@ static void topk_kernel(
     int64_t dim,
     bool largest,
     bool sorted) {
+  const auto dim_size = ensure_nonempty_size(self, dim);
+  if (values.numel() == 0) {
+    return;
+  }
+  const int64_t num_rows = self.numel() / dim_size;
+  // A few large rows don't keep the threads busy when they are processed
+  // one per thread.
+  const bool parallel_rows = num_rows < at::get_num_threads() &&
+      dim_size >= kParallelTopkMinSize && k * 64 <= dim_size;
   AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
-    dim_apply(
-        {self, values, indices},
-        dim,
-        [&](int64_t i, TensorList tl) {
-          auto tmp_values = tl[0].accessor<scalar_t, 1>();
-          auto mode_values = tl[1].accessor<scalar_t, 1>();
-          auto mode_indices = tl[2].accessor<int64_t, 1>();
-
-          auto n = tmp_values.size(0);
-          auto use_partial_sort = k * 64 <= n;
-
-          using elem_t = std::pair<scalar_t, int64_t>;
-          std::vector<elem_t> queue(n);
-          for (int64_t j = 0; j < n; j++) {
-            queue[j].first = tmp_values[j];
-            queue[j].second = j;
-          }
-
-          // we want NaN to be sorted as top for numpy compatibility
-          if (use_partial_sort) {
-            if (largest) {
-              std::partial_sort(queue.begin(), queue.begin() + k, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                });
-            } else {
-              std::partial_sort(queue.begin(), queue.begin() + k, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                });
-            }
-          } else {
-            if (largest) {
-              std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                });
-              if (sorted) {
-                std::sort(queue.begin(), queue.begin() + k - 1,
-                  [](const elem_t& x, const elem_t& y) -> bool {
-                    return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                  });
-              }
-            } else {
-              std::nth_element(queue.begin(), queue.begin() + k -1, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                });
-              if (sorted) {
-                std::sort(queue.begin(), queue.begin() + k -1,
-                  [](const elem_t& x, const elem_t& y) -> bool {
-                    return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                  });
-              }
-            }
-          }
-
-          for (int64_t j = 0; j < k; j++) {
-            mode_values[j] = queue[j].first;
-            mode_indices[j] = queue[j].second;
-          }
-        });
+    using elem_t = std::pair<scalar_t, int64_t>;
+    auto topk_row = [&](scalar_t* values_data, int64_t values_dim_stride,
+                        int64_t* indices_data, int64_t indices_dim_stride,
+                        const scalar_t* self_data, int64_t self_dim_stride,
+                        auto comp) {
+      std::vector<elem_t> queue;
+      if (parallel_rows) {
+        parallel_topk_row(queue, self_data, self_dim_stride, dim_size, k, sorted, comp);
+      } else {
+        queue.resize(dim_size);
+        for (int64_t j = 0; j < dim_size; j++) {
+          queue[j].first = self_data[j * self_dim_stride];
+          queue[j].second = j;
+        }
+        select_topk(queue, k, sorted, comp);
+      }
+      for (int64_t j = 0; j < k; j++) {
+        values_data[j * values_dim_stride] = queue[j].first;
+        indices_data[j * indices_dim_stride] = queue[j].second;
+      }
+    };
+
+    auto row_fn = [&](scalar_t* values_data, int64_t values_dim_stride,
+                      int64_t* indices_data, int64_t indices_dim_stride,
+                      const scalar_t* self_data, int64_t self_dim_stride) {
+      if (largest) {
+        topk_row(values_data, values_dim_stride, indices_data, indices_dim_stride,
+                 self_data, self_dim_stride, KeyValueCompDesc<scalar_t>());
+      } else {
+        topk_row(values_data, values_dim_stride, indices_data, indices_dim_stride,
+                 self_data, self_dim_stride, KeyValueCompAsc<scalar_t>());
+      }
+    };
+
+    // Each large row is processed with all the threads, so the rows are
+    // processed one after the other.
+    _dim_apply<scalar_t>(values, indices, self, dim, dim_size, row_fn, /*serial=*/parallel_rows);
   });
 }
 
 } // anonymous namespace
 
+REGISTER_DISPATCH(sort_stub, &sort_kernel);
 REGISTER_DISPATCH(topk_stub, &topk_kernel);
 
 }} //at::native
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <type_traits>
 #include <ATen/Config.h>
+#include <ATen/Context.h>
 #include <ATen/Dispatch.h>
 #include <ATen/CPUGeneratorImpl.h>
 #include <ATen/Utils.h>
@@ -32,18 +33,35 @@ namespace {
 using namespace vec256;
 
 static void sigmoid_kernel(TensorIterator& iter) {
-  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kBFloat16, iter.dtype(), "sigmoid_cpu", [&]() {
+  if (iter.dtype() == kBFloat16) {
+    // Computed in float, so that the result is rounded to BFloat16 only once.
     cpu_kernel_vec(
         iter,
-        [=](scalar_t a) -> scalar_t { return (static_cast<scalar_t>(1) / (static_cast<scalar_t>(1) + std::exp((-a)))); },
-        [=](Vec256<scalar_t> a) {
-          a = Vec256<scalar_t>(static_cast<scalar_t>(0)) - a;
-          a = a.exp();
-          a = Vec256<scalar_t>(static_cast<scalar_t>(1)) + a;
-          a = a.reciprocal();
-          return a;
+        [=](BFloat16 a) -> BFloat16 {
+          float a0 = static_cast<float>(a);
+          return static_cast<float>(1) / (static_cast<float>(1) + std::exp((-a0)));
+        },
+        [=](Vec256<BFloat16> a) {
+          Vec256<float> a0, a1;
+          std::tie(a0, a1) = convert_bfloat16_float(a);
+          a0 = (Vec256<float>(static_cast<float>(1)) + (Vec256<float>(static_cast<float>(0)) - a0).exp()).reciprocal();
+          a1 = (Vec256<float>(static_cast<float>(1)) + (Vec256<float>(static_cast<float>(0)) - a1).exp()).reciprocal();
+          return convert_float_bfloat16(a0, a1);
         });
-  });
+  } else {
+    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "sigmoid_cpu", [&]() {
+      cpu_kernel_vec(
+          iter,
+          [=](scalar_t a) -> scalar_t { return (static_cast<scalar_t>(1) / (static_cast<scalar_t>(1) + std::exp((-a)))); },
+          [=](Vec256<scalar_t> a) {
+            a = Vec256<scalar_t>(static_cast<scalar_t>(0)) - a;
+            a = a.exp();
+            a = Vec256<scalar_t>(static_cast<scalar_t>(1)) + a;
+            a = a.reciprocal();
+            return a;
+          });
+    });
+  }
 }
 
 template<typename T>
@@ -293,6 +311,10 @@ void bernoulli_tensor_kernel(Tensor& self, const Tensor& p_, c10::optional<Gener
 
 void bernoulli_scalar_kernel_default(Tensor& self, double p, c10::optional<Generator> gen) {
   CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (at::globalContext().parallelCPURNG()) {
+    templates::cpu::bernoulli_philox_kernel(self, p, generator);
+    return;
+  }
   templates::cpu::bernoulli_kernel(self, p, generator);
 }
 
@@ -302,7 +324,8 @@ void bernoulli_scalar_kernel(Tensor& self, double p, c10::optional<Generator> ge
 }
 #else
 void bernoulli_scalar_kernel(Tensor &self, double p, c10::optional<Generator> gen) {
-  if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
+  if (!at::globalContext().parallelCPURNG() &&
+      cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
     int64_t seed;
     {
@@ -352,7 +375,7 @@ void bernoulli_scalar_kernel(Tensor &self, double p, c10::optional<Generator> ge
       }
     });
   } else {
-    // The situation of AMD, move to using the default version
+    // The situation of AMD or of parallelCPURNG, move to using the default version
     bernoulli_scalar_kernel_default(self, p, gen);
   }
 }
@@ -375,11 +398,20 @@ static void log_normal_kernel(TensorIterator& iter, double mean, double std, c10
 
 void uniform_kernel(TensorIterator& iter, double from, double to, c10::optional<Generator> gen) {
   CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (at::globalContext().parallelCPURNG() && (iter.dtype() == kFloat || iter.dtype() == kDouble)) {
+    Tensor self = iter.tensor(0);
+    templates::cpu::uniform_philox_kernel(self, from, to, generator);
+    return;
+  }
   templates::cpu::uniform_kernel(iter, from, to, generator);
 }
 
 void normal_kernel(Tensor& self, double mean, double std, c10::optional<Generator> gen) {
   CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (at::globalContext().parallelCPURNG() && (self.scalar_type() == kFloat || self.scalar_type() == kDouble)) {
+    templates::cpu::normal_philox_kernel(self, mean, std, generator);
+    return;
+  }
   templates::cpu::normal_kernel(self, mean, std, generator);
 }
 
@@ -402,7 +434,7 @@ static void random_full_64_bits_range_kernel(TensorIterator& iter, c10::optional
 }
 
 static void rsqrt_kernel(TensorIterator& iter) {
-  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "rsqrt_cpu", [&] {
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kBFloat16, iter.dtype(), "rsqrt_cpu", [&] {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t {
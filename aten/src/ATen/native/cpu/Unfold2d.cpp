@@ -109,6 +109,55 @@ static void unfolded2d_acc(
   });
 }
 
+// Each input position gathers the patch elements of the output positions it
+// contributes to, so the positions can be processed in parallel without
+// write conflicts, and the channels are accumulated with vector adds.
+template <typename scalar_t>
+static void unfolded2d_acc_channels_last(
+    scalar_t* finput_data,
+    scalar_t* input_data,
+    int64_t kH,
+    int64_t kW,
+    int64_t dH,
+    int64_t dW,
+    int64_t padH,
+    int64_t padW,
+    int64_t n_input_plane,
+    int64_t input_height,
+    int64_t input_width,
+    int64_t output_height,
+    int64_t output_width) {
+  const int64_t patch_size = kH * kW * n_input_plane;
+  at::parallel_for(
+      0, input_height * input_width, 0, [&](int64_t start, int64_t end) {
+        for (auto k = start; k < end; k++) {
+          const int64_t iy = k / input_width;
+          const int64_t ix = k % input_width;
+          scalar_t* dst = input_data + k * n_input_plane;
+          for (int64_t kh = 0; kh < kH; kh++) {
+            const int64_t y_scaled = iy + padH - kh;
+            if (y_scaled < 0 || y_scaled % dH != 0 ||
+                y_scaled / dH >= output_height) {
+              continue;
+            }
+            const int64_t y = y_scaled / dH;
+            for (int64_t kw = 0; kw < kW; kw++) {
+              const int64_t x_scaled = ix + padW - kw;
+              if (x_scaled < 0 || x_scaled % dW != 0 ||
+                  x_scaled / dW >= output_width) {
+                continue;
+              }
+              const int64_t x = x_scaled / dW;
+              const scalar_t* src = finput_data +
+                  (y * output_width + x) * patch_size +
+                  (kh * kW + kw) * n_input_plane;
+              cadd(dst, dst, src, n_input_plane);
+            }
+          }
+        }
+      });
+}
+
 /* note: due to write issues, this one cannot be parallelized as well as
  * unfolded2d_copy */
 void unfolded2d_acc_kernel(
@@ -124,7 +173,8 @@ void unfolded2d_acc_kernel(
     int64_t input_height,
     int64_t input_width,
     int64_t output_height,
-    int64_t output_width) {
+    int64_t output_width,
+    bool is_channels_last) {
   // This function assumes that
   // output_height*dH does not overflow a int64_t
   // output_width*dW does not overflow a int64_t
@@ -134,6 +184,23 @@ void unfolded2d_acc_kernel(
         scalar_t* finput_data = finput.data_ptr<scalar_t>();
         scalar_t* input_data = input.data_ptr<scalar_t>();
 
+        if (is_channels_last) {
+          unfolded2d_acc_channels_last(
+              finput_data,
+              input_data,
+              kH,
+              kW,
+              dH,
+              dW,
+              padH,
+              padW,
+              n_input_plane,
+              input_height,
+              input_width,
+              output_height,
+              output_width);
+          return;
+        }
         unfolded2d_acc(
             finput_data,
             input_data,
@@ -255,6 +322,49 @@ static void unfolded2d_copy(
       });
 }
 
+// Copies the patch of each output position, made of kH * kW rows of
+// n_input_plane contiguous channels, or zeros in the padding.
+template <typename scalar_t>
+static void unfolded2d_copy_channels_last(
+    scalar_t* input_data,
+    scalar_t* finput_data,
+    int64_t kH,
+    int64_t kW,
+    int64_t dH,
+    int64_t dW,
+    int64_t padH,
+    int64_t padW,
+    int64_t n_input_plane,
+    int64_t input_height,
+    int64_t input_width,
+    int64_t output_height,
+    int64_t output_width) {
+  const int64_t patch_size = kH * kW * n_input_plane;
+  at::parallel_for(
+      0, output_height * output_width, 0, [&](int64_t start, int64_t end) {
+        for (auto k = start; k < end; k++) {
+          const int64_t y = k / output_width;
+          const int64_t x = k % output_width;
+          scalar_t* dst = finput_data + k * patch_size;
+          for (int64_t kh = 0; kh < kH; kh++) {
+            const int64_t iy = y * dH - padH + kh;
+            for (int64_t kw = 0; kw < kW; kw++) {
+              const int64_t ix = x * dW - padW + kw;
+              scalar_t* dst_slice = dst + (kh * kW + kw) * n_input_plane;
+              if (iy < 0 || iy >= input_height || ix < 0 || ix >= input_width) {
+                memset(dst_slice, 0, sizeof(scalar_t) * n_input_plane);
+              } else {
+                memcpy(
+                    dst_slice,
+                    input_data + (iy * input_width + ix) * n_input_plane,
+                    sizeof(scalar_t) * n_input_plane);
+              }
+            }
+          }
+        }
+      });
+}
+
 void unfolded2d_copy_kernel(
     Tensor& finput,
     Tensor& input,
@@ -268,7 +378,8 @@ void unfolded2d_copy_kernel(
     int64_t input_height,
     int64_t input_width,
     int64_t output_height,
-    int64_t output_width) {
+    int64_t output_width,
+    bool is_channels_last) {
   // This function assumes that
   // kH*kW does not overflow an int
   // n_input_plane*kH*kW does not overflow a int64_t
@@ -280,6 +391,23 @@ void unfolded2d_copy_kernel(
         scalar_t* input_data = input.data_ptr<scalar_t>();
         scalar_t* finput_data = finput.data_ptr<scalar_t>();
 
+        if (is_channels_last) {
+          unfolded2d_copy_channels_last(
+              input_data,
+              finput_data,
+              kH,
+              kW,
+              dH,
+              dW,
+              padH,
+              padW,
+              n_input_plane,
+              input_height,
+              input_width,
+              output_height,
+              output_width);
+          return;
+        }
         unfolded2d_copy(
             input_data,
             finput_data,
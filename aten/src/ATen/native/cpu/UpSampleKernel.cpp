@@ -2,6 +2,7 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/native/UpSample.h>
+#include <ATen/native/cpu/utils.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 
@@ -9,31 +10,6 @@ namespace at {
 namespace native {
 namespace {
 
-template <typename T>
-inline T data_index_init(T offset) {
-  return offset;
-}
-
-template <typename T, typename... Args>
-inline T data_index_init(T offset, T &x, const T &X, Args &&... args) {
-  offset = data_index_init(offset, std::forward<Args>(args)...);
-  x = offset % X;
-  return offset / X;
-}
-
-inline bool data_index_step() {
-  return true;
-}
-
-template <typename T, typename... Args>
-inline bool data_index_step(T &x, const T &X, Args &&... args) {
-  if (data_index_step(std::forward<Args>(args)...)) {
-    x = ((x + 1) == X) ? 0 : (x + 1);
-    return x == 0;
-  }
-  return false;
-}
-
 static inline int64_t nearest_idx(
     int64_t output_index,
     int64_t input_size,
@@ -322,6 +298,62 @@ void cpu_upsample_nearest_backward(
   }
 }
 
+template <typename scalar_t, typename scale_type>
+void cpu_upsample_nearest2d_backward_channels_last(
+    Tensor& grad_input_,
+    const Tensor& grad_output_,
+    const scale_type& scales) {
+  TORCH_CHECK(grad_input_.dtype() == grad_output_.dtype(), "expected dtype ", grad_output_.dtype(),
+              " for `grad_input` but got dtype ", grad_input_.dtype());
+  TORCH_CHECK(grad_output_.ndimension() == 4,
+              "upsample nearest backward with channels last format supports tensors with 4 dims.");
+
+  auto memory_format = at::MemoryFormat::ChannelsLast;
+  auto grad_output = grad_output_.contiguous(memory_format);
+  auto grad_input = grad_input_.contiguous(memory_format);
+
+  auto grad_output_data = grad_output.data_ptr<scalar_t>();
+  auto grad_input_data = grad_input.data_ptr<scalar_t>();
+
+  int64_t nbatch = grad_input.size(0);
+  int64_t channels = grad_input.size(1);
+  int64_t input_height = grad_input.size(2);
+  int64_t input_width = grad_input.size(3);
+  int64_t output_height = grad_output.size(2);
+  int64_t output_width = grad_output.size(3);
+
+  using Vec = vec256::Vec256<scalar_t>;
+  int64_t size = channels;
+  int64_t len = size - (size % Vec::size());
+  // parallel on dim N only: several output positions map to one input position
+  at::parallel_for(0, nbatch, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end; n++) {
+      scalar_t* gin_n = grad_input_data + n * input_height * input_width * channels;
+      scalar_t* gout_n = grad_output_data + n * output_height * output_width * channels;
+      for (int64_t oh = 0; oh < output_height; oh++) {
+        int64_t ih = nearest_idx(oh, input_height, output_height, scales[0]);
+        for (int64_t ow = 0; ow < output_width; ow++) {
+          int64_t iw = nearest_idx(ow, input_width, output_width, scales[1]);
+          scalar_t* gin = gin_n + (ih * input_width + iw) * channels;
+          scalar_t* gout = gout_n + (oh * output_width + ow) * channels;
+          int64_t d = 0;
+          for (; d < len; d += Vec::size()) {
+            Vec gin_vec = Vec::loadu(gin + d) + Vec::loadu(gout + d);
+            gin_vec.store(gin + d);
+          }
+          for (; d < size; d++) {
+            gin[d] += gout[d];
+          }
+        }
+      }
+    }
+  });
+
+  if (!grad_input_.is_contiguous(memory_format)) {
+    grad_input_.copy_(grad_input);
+  }
+}
+
 using scale_t = std::vector<c10::optional<double>>;
 void upsample_nearest1d_kernel_impl(
     Tensor& output,
@@ -379,9 +411,15 @@ void upsample_nearest2d_backward_kernel_impl(
     const Tensor& grad_output,
     c10::optional<double> scales_h,
     c10::optional<double> scales_w) {
-  AT_DISPATCH_FLOATING_TYPES(grad_output.scalar_type(), "upsample_nearest2d_backward", [&] {
-    cpu_upsample_nearest_backward<scalar_t, scale_t>(grad_input, grad_output, {scales_h, scales_w});
-  });
+  if (grad_output.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+    AT_DISPATCH_FLOATING_TYPES(grad_output.scalar_type(), "upsample_nearest2d_backward_channels_last", [&] {
+      cpu_upsample_nearest2d_backward_channels_last<scalar_t, scale_t>(grad_input, grad_output, {scales_h, scales_w});
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES(grad_output.scalar_type(), "upsample_nearest2d_backward", [&] {
+      cpu_upsample_nearest_backward<scalar_t, scale_t>(grad_input, grad_output, {scales_h, scales_w});
+    });
+  }
 }
 
 void upsample_nearest3d_backward_kernel_impl(
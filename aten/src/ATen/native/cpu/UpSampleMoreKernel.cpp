@@ -2,9 +2,12 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/native/UpSample.h>
+#include <ATen/native/cpu/utils.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 
+#include <vector>
+
 namespace at {
 namespace native {
 namespace {
@@ -37,6 +40,34 @@ static inline void compute_source_index_and_lambda(
   }
 }
 
+// The source indices and lambdas along an axis only depend on the output
+// index along that axis: compute them once per axis, instead of once per
+// output element, and reuse them for all the batches and channels.
+template <typename scalar_t>
+struct IndexAndLambda {
+  int64_t index0;
+  int64_t index1;
+  scalar_t lambda0;
+  scalar_t lambda1;
+};
+
+template <typename scalar_t>
+static std::vector<IndexAndLambda<scalar_t>> compute_indices_and_lambdas(
+    int64_t input_size,
+    int64_t output_size,
+    bool align_corners,
+    const c10::optional<double>& scale) {
+  const scalar_t ratio = area_pixel_compute_scale<scalar_t>(
+      input_size, output_size, align_corners, scale);
+  std::vector<IndexAndLambda<scalar_t>> table(output_size);
+  for (int64_t o = 0; o < output_size; o++) {
+    auto& t = table[o];
+    compute_source_index_and_lambda(
+        t.index0, t.index1, t.lambda0, t.lambda1, ratio, o, input_size, output_size, align_corners);
+  }
+  return table;
+}
+
 template <typename scalar_t, typename scale_type>
 void cpu_upsample_linear(
     Tensor& output_,
@@ -67,63 +98,50 @@ void cpu_upsample_linear(
   int64_t output_slice_size = output_depth * output_height * output_width;
 
   auto loop1d = [&](int64_t begin, int64_t end) {
-    const scalar_t width_scale = area_pixel_compute_scale<scalar_t>(
+    const auto width_table = compute_indices_and_lambdas<scalar_t>(
         input_width, output_width, align_corners, scales[0]);
 
-    auto input_indexr = [=](int64_t c, int64_t w) {
-      return input_data[c * input_width + w];
-    };
-
-    int64_t iw0, iw1;
-    scalar_t w0lambda, w1lambda;
     for (int64_t c = begin; c < end; c++) {
+      const scalar_t* in = input_data + c * input_width;
+      scalar_t* out = output_data + c * output_slice_size;
       for (int64_t ow = 0; ow < output_width; ow++) {
-        compute_source_index_and_lambda(
-            iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
-        int64_t output_offset = c * output_slice_size + ow;
-        output_data[output_offset] =
-            w0lambda * input_indexr(c, iw0) + /* w0 * i0 */
-            w1lambda * input_indexr(c, iw1);  /* w1 * i1 */
+        const auto& w = width_table[ow];
+        out[ow] =
+            w.lambda0 * in[w.index0] + /* w0 * i0 */
+            w.lambda1 * in[w.index1];  /* w1 * i1 */
       }
     }
   };
 
   auto loop2d = [&](int64_t begin, int64_t end) {
-    const scalar_t height_scale = area_pixel_compute_scale<scalar_t>(
+    const auto height_table = compute_indices_and_lambdas<scalar_t>(
         input_height, output_height, align_corners, scales[0]);
-    const scalar_t width_scale = area_pixel_compute_scale<scalar_t>(
+    const auto width_table = compute_indices_and_lambdas<scalar_t>(
         input_width, output_width, align_corners, scales[1]);
 
-    auto input_indexr = [=](int64_t c, int64_t h, int64_t w) {
-      return input_data[c * input_height * input_width + h * input_width + w];
-    };
-
-    int64_t ih0, ih1, iw0, iw1;
-    scalar_t h0lambda, h1lambda, w0lambda, w1lambda;
     for (int64_t c = begin; c < end; c++) {
+      const scalar_t* in = input_data + c * input_height * input_width;
       for (int64_t oh = 0; oh < output_height; oh++) {
-        compute_source_index_and_lambda(
-            ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
+        const auto& h = height_table[oh];
+        const scalar_t* in0 = in + h.index0 * input_width;
+        const scalar_t* in1 = in + h.index1 * input_width;
+        scalar_t* out = output_data + c * output_slice_size + oh * output_width;
         for (int64_t ow = 0; ow < output_width; ow++) {
-          compute_source_index_and_lambda(
-              iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
-          int64_t output_offset = c * output_slice_size + oh * output_width + ow;
-          output_data[output_offset] =
-              h0lambda * w0lambda * input_indexr(c, ih0, iw0) + /* h0 * w0 * i00 */
-              h0lambda * w1lambda * input_indexr(c, ih0, iw1) + /* h0 * w1 * i01 */
-              h1lambda * w0lambda * input_indexr(c, ih1, iw0) + /* h1 * w0 * i10 */
-              h1lambda * w1lambda * input_indexr(c, ih1, iw1);  /* h1 * w1 * i11 */
+          const auto& w = width_table[ow];
+          out[ow] =
+              h.lambda0 * (w.lambda0 * in0[w.index0] + w.lambda1 * in0[w.index1]) + /* h0 * (w0 * i00 + w1 * i01) */
+              h.lambda1 * (w.lambda0 * in1[w.index0] + w.lambda1 * in1[w.index1]);  /* h1 * (w0 * i10 + w1 * i11) */
         }
       }
     }
   };
 
   auto loop3d = [&](int64_t begin, int64_t end) {
-    const scalar_t depth_scale = area_pixel_compute_scale<scalar_t>(
+    const auto depth_table = compute_indices_and_lambdas<scalar_t>(
         input_depth, output_depth, align_corners, scales[0]);
-    const scalar_t height_scale = area_pixel_compute_scale<scalar_t>(
+    const auto height_table = compute_indices_and_lambdas<scalar_t>(
         input_height, output_height, align_corners, scales[1]);
-    const scalar_t width_scale = area_pixel_compute_scale<scalar_t>(
+    const auto width_table = compute_indices_and_lambdas<scalar_t>(
         input_width, output_width, align_corners, scales[2]);
 
     auto input_indexr = [=](int64_t c, int64_t d, int64_t h, int64_t w) {
@@ -131,18 +149,22 @@ void cpu_upsample_linear(
           d * input_height * input_width + h * input_width + w];
     };
 
-    int64_t id0, id1, ih0, ih1, iw0, iw1;
-    scalar_t d0lambda, d1lambda, h0lambda, h1lambda, w0lambda, w1lambda;
     for (int64_t c = begin; c < end; c++) {
       for (int64_t od = 0; od < output_depth; od++) {
-        compute_source_index_and_lambda(
-            id0, id1, d0lambda, d1lambda, depth_scale, od, input_depth, output_depth, align_corners);
+        const int64_t id0 = depth_table[od].index0;
+        const int64_t id1 = depth_table[od].index1;
+        const scalar_t d0lambda = depth_table[od].lambda0;
+        const scalar_t d1lambda = depth_table[od].lambda1;
         for (int64_t oh = 0; oh < output_height; oh++) {
-          compute_source_index_and_lambda(
-              ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
+          const int64_t ih0 = height_table[oh].index0;
+          const int64_t ih1 = height_table[oh].index1;
+          const scalar_t h0lambda = height_table[oh].lambda0;
+          const scalar_t h1lambda = height_table[oh].lambda1;
           for (int64_t ow = 0; ow < output_width; ow++) {
-            compute_source_index_and_lambda(
-                iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
+            const int64_t iw0 = width_table[ow].index0;
+            const int64_t iw1 = width_table[ow].index1;
+            const scalar_t w0lambda = width_table[ow].lambda0;
+            const scalar_t w1lambda = width_table[ow].lambda1;
             int64_t output_offset = c * output_slice_size +
                 od * output_height * output_width + oh * output_width + ow;
             output_data[output_offset] =
@@ -210,13 +232,13 @@ void cpu_upsample_linear_channels_last(
   int64_t output_width = output_sizes[ndim - 1];
 
   TORCH_CHECK(channels > 0, "expected input and output channels greater than 0 but got ", channels);
-  int64_t output_slice_size = output_depth * output_height * output_width * channels;
+  int64_t numel = output.numel();
 
   using Vec = vec256::Vec256<scalar_t>;
   auto loop2d = [&](int64_t begin, int64_t end) {
-    const scalar_t height_scale = area_pixel_compute_scale<scalar_t>(
+    const auto height_table = compute_indices_and_lambdas<scalar_t>(
         input_height, output_height, align_corners, scales[0]);
-    const scalar_t width_scale = area_pixel_compute_scale<scalar_t>(
+    const auto width_table = compute_indices_and_lambdas<scalar_t>(
         input_width, output_width, align_corners, scales[1]);
 
     auto input_indexr = [=](int64_t n, int64_t h, int64_t w) {
@@ -224,51 +246,52 @@ void cpu_upsample_linear_channels_last(
           h * input_width * channels + w * channels;
     };
 
-    int64_t ih0, ih1, iw0, iw1;
-    scalar_t h0lambda, h1lambda, w0lambda, w1lambda;
-    for (int64_t n = begin; n < end; n++) {
-      for (int64_t oh = 0; oh < output_height; oh++) {
-        compute_source_index_and_lambda(
-            ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
-        for (int64_t ow = 0; ow < output_width; ow++) {
-          compute_source_index_and_lambda(
-              iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
-
-          scalar_t* out = output_data + n * output_slice_size +
-              oh * output_width * channels + ow * channels;
-          scalar_t* i00 = input_indexr(n, ih0, iw0);
-          scalar_t* i01 = input_indexr(n, ih0, iw1);
-          scalar_t* i10 = input_indexr(n, ih1, iw0);
-          scalar_t* i11 = input_indexr(n, ih1, iw1);
-
-          int64_t size = channels;
-          int64_t d = 0;
-          for (; d < size - (size % Vec::size()); d += Vec::size()) {
-            Vec out_vec =
-                Vec(h0lambda * w0lambda) * Vec::loadu(i00 + d) + /* h0 * w0 * i00 */
-                Vec(h0lambda * w1lambda) * Vec::loadu(i01 + d) + /* h0 * w1 * i01 */
-                Vec(h1lambda * w0lambda) * Vec::loadu(i10 + d) + /* h1 * w0 * i10 */
-                Vec(h1lambda * w1lambda) * Vec::loadu(i11 + d);  /* h1 * w1 * i11 */
-            out_vec.store(out + d);
-          }
-          for (; d < size; d++) {
-            out[d] =
-                h0lambda * w0lambda * i00[d] + /* h0 * w0 * i00 */
-                h0lambda * w1lambda * i01[d] + /* h0 * w1 * i01 */
-                h1lambda * w0lambda * i10[d] + /* h1 * w0 * i10 */
-                h1lambda * w1lambda * i11[d];  /* h1 * w1 * i11 */
-          }
-        }
+    int64_t n = 0;
+    int64_t oh = 0;
+    int64_t ow = 0;
+    data_index_init(begin, n, num_batches, oh, output_height, ow, output_width);
+
+    for (int64_t i = begin; i < end; i++) {
+      const auto& h = height_table[oh];
+      const auto& w = width_table[ow];
+      const scalar_t h0lambda = h.lambda0;
+      const scalar_t h1lambda = h.lambda1;
+      const scalar_t w0lambda = w.lambda0;
+      const scalar_t w1lambda = w.lambda1;
+
+      scalar_t* out = output_data + i * channels;
+      scalar_t* i00 = input_indexr(n, h.index0, w.index0);
+      scalar_t* i01 = input_indexr(n, h.index0, w.index1);
+      scalar_t* i10 = input_indexr(n, h.index1, w.index0);
+      scalar_t* i11 = input_indexr(n, h.index1, w.index1);
+
+      int64_t size = channels;
+      int64_t d = 0;
+      for (; d < size - (size % Vec::size()); d += Vec::size()) {
+        Vec out_vec =
+            Vec(h0lambda * w0lambda) * Vec::loadu(i00 + d) + /* h0 * w0 * i00 */
+            Vec(h0lambda * w1lambda) * Vec::loadu(i01 + d) + /* h0 * w1 * i01 */
+            Vec(h1lambda * w0lambda) * Vec::loadu(i10 + d) + /* h1 * w0 * i10 */
+            Vec(h1lambda * w1lambda) * Vec::loadu(i11 + d);  /* h1 * w1 * i11 */
+        out_vec.store(out + d);
+      }
+      for (; d < size; d++) {
+        out[d] =
+            h0lambda * w0lambda * i00[d] + /* h0 * w0 * i00 */
+            h0lambda * w1lambda * i01[d] + /* h0 * w1 * i01 */
+            h1lambda * w0lambda * i10[d] + /* h1 * w0 * i10 */
+            h1lambda * w1lambda * i11[d];  /* h1 * w1 * i11 */
       }
+      data_index_step(n, num_batches, oh, output_height, ow, output_width);
     }
   };
 
   auto loop3d = [&](int64_t begin, int64_t end) {
-    const scalar_t depth_scale = area_pixel_compute_scale<scalar_t>(
+    const auto depth_table = compute_indices_and_lambdas<scalar_t>(
         input_depth, output_depth, align_corners, scales[0]);
-    const scalar_t height_scale = area_pixel_compute_scale<scalar_t>(
+    const auto height_table = compute_indices_and_lambdas<scalar_t>(
         input_height, output_height, align_corners, scales[1]);
-    const scalar_t width_scale = area_pixel_compute_scale<scalar_t>(
+    const auto width_table = compute_indices_and_lambdas<scalar_t>(
         input_width, output_width, align_corners, scales[2]);
 
     auto input_indexr = [=](int64_t n, int64_t d, int64_t h, int64_t w) {
@@ -277,69 +300,74 @@ void cpu_upsample_linear_channels_last(
           h * input_width * channels + w * channels;
     };
 
-    int64_t id0, id1, ih0, ih1, iw0, iw1;
-    scalar_t d0lambda, d1lambda, h0lambda, h1lambda, w0lambda, w1lambda;
-    for (int64_t n = begin; n < end; n++) {
-      for (int64_t od = 0; od < output_depth; od++) {
-        compute_source_index_and_lambda(
-            id0, id1, d0lambda, d1lambda, depth_scale, od, input_depth, output_depth, align_corners);
-        for (int64_t oh = 0; oh < output_height; oh++) {
-          compute_source_index_and_lambda(
-              ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
-          for (int64_t ow = 0; ow < output_width; ow++) {
-            compute_source_index_and_lambda(
-                iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
-
-            scalar_t* out = output_data + n * output_slice_size +
-                od * output_height * output_width * channels +
-                oh * output_width * channels + ow * channels;
-            scalar_t* i000 = input_indexr(n, id0, ih0, iw0);
-            scalar_t* i001 = input_indexr(n, id0, ih0, iw1);
-            scalar_t* i010 = input_indexr(n, id0, ih1, iw0);
-            scalar_t* i011 = input_indexr(n, id0, ih1, iw1);
-            scalar_t* i100 = input_indexr(n, id1, ih0, iw0);
-            scalar_t* i101 = input_indexr(n, id1, ih0, iw1);
-            scalar_t* i110 = input_indexr(n, id1, ih1, iw0);
-            scalar_t* i111 = input_indexr(n, id1, ih1, iw1);
-
-            int64_t size = channels;
-            int64_t d = 0;
-            for (; d < size - (size % Vec::size()); d += Vec::size()) {
-              Vec out_vec =
-                  Vec(d0lambda * h0lambda * w0lambda) * Vec::loadu(i000 + d) + /* d0 * h0 * w0 * i000 */
-                  Vec(d0lambda * h0lambda * w1lambda) * Vec::loadu(i001 + d) + /* d0 * h0 * w1 * i001 */
-                  Vec(d0lambda * h1lambda * w0lambda) * Vec::loadu(i010 + d) + /* d0 * h1 * w0 * i010 */
-                  Vec(d0lambda * h1lambda * w1lambda) * Vec::loadu(i011 + d) + /* d0 * h1 * w1 * i011 */
-                  Vec(d1lambda * h0lambda * w0lambda) * Vec::loadu(i100 + d) + /* d1 * h0 * w0 * i100 */
-                  Vec(d1lambda * h0lambda * w1lambda) * Vec::loadu(i101 + d) + /* d1 * h0 * w1 * i101 */
-                  Vec(d1lambda * h1lambda * w0lambda) * Vec::loadu(i110 + d) + /* d1 * h1 * w0 * i110 */
-                  Vec(d1lambda * h1lambda * w1lambda) * Vec::loadu(i111 + d);  /* d1 * h1 * w1 * i111 */
-              out_vec.store(out + d);
-            }
-            for (; d < size; d++) {
-              out[d] =
-                  d0lambda * h0lambda * w0lambda * i000[d] + /* d0 * h0 * w0 * i000 */
-                  d0lambda * h0lambda * w1lambda * i001[d] + /* d0 * h0 * w1 * i001 */
-                  d0lambda * h1lambda * w0lambda * i010[d] + /* d0 * h1 * w0 * i010 */
-                  d0lambda * h1lambda * w1lambda * i011[d] + /* d0 * h1 * w1 * i011 */
-                  d1lambda * h0lambda * w0lambda * i100[d] + /* d1 * h0 * w0 * i100 */
-                  d1lambda * h0lambda * w1lambda * i101[d] + /* d1 * h0 * w1 * i101 */
-                  d1lambda * h1lambda * w0lambda * i110[d] + /* d1 * h1 * w0 * i110 */
-                  d1lambda * h1lambda * w1lambda * i111[d];  /* d1 * h1 * w1 * i111 */
-            }
-          }
-        }
+    int64_t n = 0;
+    int64_t od = 0;
+    int64_t oh = 0;
+    int64_t ow = 0;
+    data_index_init(begin, n, num_batches, od, output_depth, oh, output_height, ow, output_width);
+
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t id0 = depth_table[od].index0;
+      const int64_t id1 = depth_table[od].index1;
+      const scalar_t d0lambda = depth_table[od].lambda0;
+      const scalar_t d1lambda = depth_table[od].lambda1;
+      const int64_t ih0 = height_table[oh].index0;
+      const int64_t ih1 = height_table[oh].index1;
+      const scalar_t h0lambda = height_table[oh].lambda0;
+      const scalar_t h1lambda = height_table[oh].lambda1;
+      const int64_t iw0 = width_table[ow].index0;
+      const int64_t iw1 = width_table[ow].index1;
+      const scalar_t w0lambda = width_table[ow].lambda0;
+      const scalar_t w1lambda = width_table[ow].lambda1;
+
+      scalar_t* out = output_data + i * channels;
+      scalar_t* i000 = input_indexr(n, id0, ih0, iw0);
+      scalar_t* i001 = input_indexr(n, id0, ih0, iw1);
+      scalar_t* i010 = input_indexr(n, id0, ih1, iw0);
+      scalar_t* i011 = input_indexr(n, id0, ih1, iw1);
+      scalar_t* i100 = input_indexr(n, id1, ih0, iw0);
+      scalar_t* i101 = input_indexr(n, id1, ih0, iw1);
+      scalar_t* i110 = input_indexr(n, id1, ih1, iw0);
+      scalar_t* i111 = input_indexr(n, id1, ih1, iw1);
+
+      int64_t size = channels;
+      int64_t d = 0;
+      for (; d < size - (size % Vec::size()); d += Vec::size()) {
+        Vec out_vec =
+            Vec(d0lambda * h0lambda * w0lambda) * Vec::loadu(i000 + d) + /* d0 * h0 * w0 * i000 */
+            Vec(d0lambda * h0lambda * w1lambda) * Vec::loadu(i001 + d) + /* d0 * h0 * w1 * i001 */
+            Vec(d0lambda * h1lambda * w0lambda) * Vec::loadu(i010 + d) + /* d0 * h1 * w0 * i010 */
+            Vec(d0lambda * h1lambda * w1lambda) * Vec::loadu(i011 + d) + /* d0 * h1 * w1 * i011 */
+            Vec(d1lambda * h0lambda * w0lambda) * Vec::loadu(i100 + d) + /* d1 * h0 * w0 * i100 */
+            Vec(d1lambda * h0lambda * w1lambda) * Vec::loadu(i101 + d) + /* d1 * h0 * w1 * i101 */
+            Vec(d1lambda * h1lambda * w0lambda) * Vec::loadu(i110 + d) + /* d1 * h1 * w0 * i110 */
+            Vec(d1lambda * h1lambda * w1lambda) * Vec::loadu(i111 + d);  /* d1 * h1 * w1 * i111 */
+        out_vec.store(out + d);
+      }
+      for (; d < size; d++) {
+        out[d] =
+            d0lambda * h0lambda * w0lambda * i000[d] + /* d0 * h0 * w0 * i000 */
+            d0lambda * h0lambda * w1lambda * i001[d] + /* d0 * h0 * w1 * i001 */
+            d0lambda * h1lambda * w0lambda * i010[d] + /* d0 * h1 * w0 * i010 */
+            d0lambda * h1lambda * w1lambda * i011[d] + /* d0 * h1 * w1 * i011 */
+            d1lambda * h0lambda * w0lambda * i100[d] + /* d1 * h0 * w0 * i100 */
+            d1lambda * h0lambda * w1lambda * i101[d] + /* d1 * h0 * w1 * i101 */
+            d1lambda * h1lambda * w0lambda * i110[d] + /* d1 * h1 * w0 * i110 */
+            d1lambda * h1lambda * w1lambda * i111[d];  /* d1 * h1 * w1 * i111 */
       }
+      data_index_step(n, num_batches, od, output_depth, oh, output_height, ow, output_width);
     }
   };
 
+  // parallel on the output positions: with a small batch, like the batch of
+  // 1 of inference, parallelizing on dim N only would leave threads idle
   if (ndim == 4) {
-    // upsample nearest 2d
-    at::parallel_for(0, num_batches, at::internal::GRAIN_SIZE / output_slice_size / 4, loop2d);
+    // upsample bilinear 2d
+    at::parallel_for(0, numel / channels, at::internal::GRAIN_SIZE / channels / 4, loop2d);
   } else {
-    // upsample nearest 3d
+    // upsample trilinear 3d
     TORCH_INTERNAL_ASSERT(ndim == 5);
-    at::parallel_for(0, num_batches, at::internal::GRAIN_SIZE / output_slice_size / 8, loop3d);
+    at::parallel_for(0, numel / channels, at::internal::GRAIN_SIZE / channels / 8, loop3d);
   }
 
   if (!output_.is_contiguous(channels_last_memory_format)) {
@@ -484,6 +512,78 @@ void cpu_upsample_linear_backward(
   }
 }
 
+template <typename scalar_t, typename scale_type>
+void cpu_upsample_bilinear2d_backward_channels_last(
+    Tensor& grad_input_,
+    const Tensor& grad_output_,
+    bool align_corners,
+    const scale_type& scales) {
+  TORCH_CHECK(grad_input_.dtype() == grad_output_.dtype(), "expected dtype ", grad_output_.dtype(),
+              " for `grad_input` but got dtype ", grad_input_.dtype());
+  TORCH_CHECK(grad_output_.ndimension() == 4,
+              "upsample bilinear backward with channels last format supports tensors with 4 dims.");
+
+  auto memory_format = at::MemoryFormat::ChannelsLast;
+  auto grad_output = grad_output_.contiguous(memory_format);
+  auto grad_input = grad_input_.contiguous(memory_format);
+
+  auto grad_output_data = grad_output.data_ptr<scalar_t>();
+  auto grad_input_data = grad_input.data_ptr<scalar_t>();
+
+  int64_t nbatch = grad_input.size(0);
+  int64_t channels = grad_input.size(1);
+  int64_t input_height = grad_input.size(2);
+  int64_t input_width = grad_input.size(3);
+  int64_t output_height = grad_output.size(2);
+  int64_t output_width = grad_output.size(3);
+
+  const auto height_table = compute_indices_and_lambdas<scalar_t>(
+      input_height, output_height, align_corners, scales[0]);
+  const auto width_table = compute_indices_and_lambdas<scalar_t>(
+      input_width, output_width, align_corners, scales[1]);
+
+  using Vec = vec256::Vec256<scalar_t>;
+  int64_t size = channels;
+  int64_t len = size - (size % Vec::size());
+  // gin += w * gout over the channels
+  auto update = [&](scalar_t* gin, const scalar_t* gout, scalar_t w) {
+    int64_t d = 0;
+    for (; d < len; d += Vec::size()) {
+      Vec gin_vec = Vec::loadu(gin + d) + Vec(w) * Vec::loadu(gout + d);
+      gin_vec.store(gin + d);
+    }
+    for (; d < size; d++) {
+      gin[d] += w * gout[d];
+    }
+  };
+
+  // parallel on dim N only: neighbouring output positions share input positions
+  at::parallel_for(0, nbatch, 0, [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end; n++) {
+      scalar_t* gin_n = grad_input_data + n * input_height * input_width * channels;
+      scalar_t* gout_n = grad_output_data + n * output_height * output_width * channels;
+      auto input_indexr = [&](int64_t h, int64_t w) {
+        return gin_n + (h * input_width + w) * channels;
+      };
+      for (int64_t oh = 0; oh < output_height; oh++) {
+        const auto& h = height_table[oh];
+        for (int64_t ow = 0; ow < output_width; ow++) {
+          const auto& w = width_table[ow];
+          const scalar_t* gout = gout_n + (oh * output_width + ow) * channels;
+          update(input_indexr(h.index0, w.index0), gout, h.lambda0 * w.lambda0); /* i00 */
+          update(input_indexr(h.index0, w.index1), gout, h.lambda0 * w.lambda1); /* i01 */
+          update(input_indexr(h.index1, w.index0), gout, h.lambda1 * w.lambda0); /* i10 */
+          update(input_indexr(h.index1, w.index1), gout, h.lambda1 * w.lambda1); /* i11 */
+        }
+      }
+    }
+  });
+
+  if (!grad_input_.is_contiguous(memory_format)) {
+    grad_input_.copy_(grad_input);
+  }
+}
+
 using scale_t = std::vector<c10::optional<double>>;
 void upsample_linear1d_kernel_impl(
     Tensor& output,
@@ -546,9 +646,15 @@ void upsample_bilinear2d_backward_kernel_impl(
     bool align_corners,
     c10::optional<double> scales_h,
     c10::optional<double> scales_w) {
-  AT_DISPATCH_FLOATING_TYPES(grad_output.scalar_type(), "upsample_bilinear2d_backward", [&] {
-    cpu_upsample_linear_backward<scalar_t, scale_t>(grad_input, grad_output, align_corners, {scales_h, scales_w});
-  });
+  if (grad_output.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+    AT_DISPATCH_FLOATING_TYPES(grad_output.scalar_type(), "upsample_bilinear2d_backward_channels_last", [&] {
+      cpu_upsample_bilinear2d_backward_channels_last<scalar_t, scale_t>(grad_input, grad_output, align_corners, {scales_h, scales_w});
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES(grad_output.scalar_type(), "upsample_bilinear2d_backward", [&] {
+      cpu_upsample_linear_backward<scalar_t, scale_t>(grad_input, grad_output, align_corners, {scales_h, scales_w});
+    });
+  }
 }
 
 void upsample_trilinear3d_backward_kernel_impl(
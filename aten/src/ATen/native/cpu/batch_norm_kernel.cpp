@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
 
@@ -107,8 +108,325 @@ void batch_norm_cpu_inference_contiguous_kernel(Tensor& output, const Tensor& in
   });
 }
 
+/// BN inference followed by ReLU in a single pass, for inputs contiguous in
+/// either memory format.
+template<typename scalar_t>
+void batch_norm_relu_cpu_inference_impl(Tensor& output,
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    const Tensor& mean, const Tensor& variance, double eps) {
+
+  using Vec = Vec256<scalar_t>;
+  int64_t n_batch = input.size(0);
+  int64_t n_channel = input.size(1);
+  int64_t image_size = input.numel() / n_batch / n_channel;
+
+  Tensor alpha = at::empty_like(mean, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor beta = at::empty_like(mean, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  batch_norm_cpu_inference_collect_linear_and_constant_terms<scalar_t>(
+     alpha.accessor<scalar_t, 1>(), beta.accessor<scalar_t, 1>(), n_channel,
+     weight, bias, mean, variance, eps);
+  const scalar_t* alpha_data = alpha.data_ptr<scalar_t>();
+  const scalar_t* beta_data = beta.data_ptr<scalar_t>();
+
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const Vec zero_vec(0);
+
+  // output = max(input * alpha + beta, 0), vectorized over the image for
+  // contiguous inputs and over the channels for channels last ones
+  if (input.is_contiguous()) {
+    const int64_t loop_size = image_size - (image_size % Vec::size());
+    const int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / image_size);
+    at::parallel_for(0, n_batch * n_channel, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const int64_t c = i % n_channel;
+        const Vec alpha_vec(alpha_data[c]);
+        const Vec beta_vec(beta_data[c]);
+        const scalar_t* x = input_data + i * image_size;
+        scalar_t* y = output_data + i * image_size;
+        int64_t d = 0;
+        for (; d < loop_size; d += Vec::size()) {
+          Vec y_vec = maximum(Vec::loadu(x + d) * alpha_vec + beta_vec, zero_vec);
+          y_vec.store(y + d);
+        }
+        if (image_size - d > 0) {
+          Vec y_vec = maximum(Vec::loadu(x + d, image_size - d) * alpha_vec + beta_vec, zero_vec);
+          y_vec.store(y + d, image_size - d);
+        }
+      }
+    });
+  } else {
+    const int64_t n_rows = n_batch * image_size;
+    const int64_t loop_size = n_channel - (n_channel % Vec::size());
+    const int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / n_channel);
+    at::parallel_for(0, n_rows, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* x = input_data + i * n_channel;
+        scalar_t* y = output_data + i * n_channel;
+        int64_t d = 0;
+        for (; d < loop_size; d += Vec::size()) {
+          Vec y_vec = maximum(
+              Vec::loadu(x + d) * Vec::loadu(alpha_data + d) + Vec::loadu(beta_data + d), zero_vec);
+          y_vec.store(y + d);
+        }
+        if (n_channel - d > 0) {
+          Vec y_vec = maximum(
+              Vec::loadu(x + d, n_channel - d) * Vec::loadu(alpha_data + d, n_channel - d) +
+                  Vec::loadu(beta_data + d, n_channel - d),
+              zero_vec);
+          y_vec.store(y + d, n_channel - d);
+        }
+      }
+    });
+  }
+}
+
+void batch_norm_relu_cpu_inference_kernel(Tensor& output, const Tensor& input,
+    const Tensor& weight, const Tensor& bias, const Tensor& mean, const Tensor& variance, double eps) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_relu_cpu_inference", [&] {
+    batch_norm_relu_cpu_inference_impl<scalar_t>(output, input, weight, bias, mean, variance, eps);
+  });
+}
+
+// Rows of channels processed by each task of the channels last kernels.
+inline int64_t channels_last_grain_size(int64_t n_channel) {
+  return std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(n_channel, 1));
+}
+
+template<typename scalar_t>
+void batch_norm_cpu_channels_last_transform_impl(Tensor& output,
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    const Tensor& mean, const Tensor& invstd) {
+
+  using Vec = Vec256<scalar_t>;
+  int64_t n_channel = input.size(1);
+  int64_t n_rows = input.numel() / n_channel;
+
+  // output(n, h, w, c) = input(n, h, w, c) * alpha(c) + beta(c), where
+  // alpha(c) = invstd(c) * weight(c) and beta(c) = bias(c) - mean(c) * alpha(c)
+  Tensor alpha = at::empty({n_channel}, input.options());
+  Tensor beta = at::empty({n_channel}, input.options());
+  scalar_t* alpha_data = alpha.data_ptr<scalar_t>();
+  scalar_t* beta_data = beta.data_ptr<scalar_t>();
+  const scalar_t* mean_data = mean.data_ptr<scalar_t>();
+  const scalar_t* invstd_data = invstd.data_ptr<scalar_t>();
+  for (int64_t c = 0; c < n_channel; c++) {
+    scalar_t w = weight.defined() ? weight.data_ptr<scalar_t>()[c * weight.stride(0)] : 1;
+    scalar_t b = bias.defined() ? bias.data_ptr<scalar_t>()[c * bias.stride(0)] : 0;
+    alpha_data[c] = invstd_data[c] * w;
+    beta_data[c] = b - mean_data[c] * alpha_data[c];
+  }
+
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t loop_size = n_channel - (n_channel % Vec::size());
+  at::parallel_for(0, n_rows, channels_last_grain_size(n_channel), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* x = input_data + i * n_channel;
+      scalar_t* y = output_data + i * n_channel;
+      int64_t d = 0;
+      for (; d < loop_size; d += Vec::size()) {
+        Vec y_vec = Vec::loadu(x + d) * Vec::loadu(alpha_data + d) + Vec::loadu(beta_data + d);
+        y_vec.store(y + d);
+      }
+      for (; d < n_channel; d++) {
+        y[d] = x[d] * alpha_data[d] + beta_data[d];
+      }
+    }
+  });
+}
+
+template<typename scalar_t>
+void batch_norm_cpu_channels_last_collect_stats_impl(Tensor& mean, Tensor& var_sum,
+    const Tensor& input) {
+
+  using Vec = Vec256<scalar_t>;
+  int64_t n_channel = input.size(1);
+  int64_t n_rows = input.numel() / n_channel;
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* mean_data = mean.data_ptr<scalar_t>();
+  scalar_t* var_sum_data = var_sum.data_ptr<scalar_t>();
+  const int64_t loop_size = n_channel - (n_channel % Vec::size());
+
+  // Each thread accumulates its rows into its own row of the buffer, which
+  // are summed afterwards.
+  int num_threads = at::get_num_threads();
+  Tensor buffer = at::zeros({num_threads, n_channel}, input.options());
+  scalar_t* buffer_data = buffer.data_ptr<scalar_t>();
+  auto reduce_buffer = [&](scalar_t* out) {
+    for (int64_t c = 0; c < n_channel; c++) {
+      scalar_t sum = 0;
+      for (int t = 0; t < num_threads; t++) {
+        sum += buffer_data[t * n_channel + c];
+      }
+      out[c] = sum;
+    }
+  };
+
+  // Pass I: sum, for the mean
+  at::parallel_for(0, n_rows, channels_last_grain_size(n_channel), [&](int64_t begin, int64_t end) {
+    scalar_t* sum = buffer_data + at::get_thread_num() * n_channel;
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* x = input_data + i * n_channel;
+      int64_t d = 0;
+      for (; d < loop_size; d += Vec::size()) {
+        Vec sum_vec = Vec::loadu(sum + d) + Vec::loadu(x + d);
+        sum_vec.store(sum + d);
+      }
+      for (; d < n_channel; d++) {
+        sum[d] += x[d];
+      }
+    }
+  });
+  reduce_buffer(mean_data);
+  for (int64_t c = 0; c < n_channel; c++) {
+    mean_data[c] /= n_rows;
+  }
+
+  // Pass II: sum of the squared deviations, for the variance
+  buffer.zero_();
+  at::parallel_for(0, n_rows, channels_last_grain_size(n_channel), [&](int64_t begin, int64_t end) {
+    scalar_t* sum = buffer_data + at::get_thread_num() * n_channel;
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* x = input_data + i * n_channel;
+      int64_t d = 0;
+      for (; d < loop_size; d += Vec::size()) {
+        Vec dev_vec = Vec::loadu(x + d) - Vec::loadu(mean_data + d);
+        Vec sum_vec = Vec::loadu(sum + d) + dev_vec * dev_vec;
+        sum_vec.store(sum + d);
+      }
+      for (; d < n_channel; d++) {
+        scalar_t dev = x[d] - mean_data[d];
+        sum[d] += dev * dev;
+      }
+    }
+  });
+  reduce_buffer(var_sum_data);
+}
+
+template<typename scalar_t>
+void batch_norm_cpu_channels_last_backward_impl(Tensor& grad_input,
+    Tensor& grad_weight, Tensor& grad_bias, const Tensor& grad_output,
+    const Tensor& input, const Tensor& weight /* optional */,
+    const Tensor& mean, const Tensor& invstd, bool train) {
+
+  using Vec = Vec256<scalar_t>;
+  int64_t n_channel = input.size(1);
+  int64_t n_rows = input.numel() / n_channel;
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* grad_output_data = grad_output.data_ptr<scalar_t>();
+  const scalar_t* mean_data = mean.data_ptr<scalar_t>();
+  const scalar_t* invstd_data = invstd.data_ptr<scalar_t>();
+  const int64_t loop_size = n_channel - (n_channel % Vec::size());
+
+  // Per channel sum of grad_output and dot product of the centered input and
+  // grad_output, accumulated per thread as in collect_stats.
+  int num_threads = at::get_num_threads();
+  Tensor buffer = at::zeros({num_threads, 2, n_channel}, input.options());
+  scalar_t* buffer_data = buffer.data_ptr<scalar_t>();
+  at::parallel_for(0, n_rows, channels_last_grain_size(n_channel), [&](int64_t begin, int64_t end) {
+    scalar_t* sum = buffer_data + at::get_thread_num() * 2 * n_channel;
+    scalar_t* dotp = sum + n_channel;
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* x = input_data + i * n_channel;
+      const scalar_t* dy = grad_output_data + i * n_channel;
+      int64_t d = 0;
+      for (; d < loop_size; d += Vec::size()) {
+        Vec dy_vec = Vec::loadu(dy + d);
+        Vec sum_vec = Vec::loadu(sum + d) + dy_vec;
+        Vec dotp_vec = Vec::loadu(dotp + d) + (Vec::loadu(x + d) - Vec::loadu(mean_data + d)) * dy_vec;
+        sum_vec.store(sum + d);
+        dotp_vec.store(dotp + d);
+      }
+      for (; d < n_channel; d++) {
+        sum[d] += dy[d];
+        dotp[d] += (x[d] - mean_data[d]) * dy[d];
+      }
+    }
+  });
+  Tensor sum = buffer.select(1, 0).sum(0);
+  Tensor dotp = buffer.select(1, 1).sum(0);
+  const scalar_t* sum_data = sum.data_ptr<scalar_t>();
+  const scalar_t* dotp_data = dotp.data_ptr<scalar_t>();
+
+  if (grad_weight.defined()) {
+    scalar_t* grad_weight_data = grad_weight.data_ptr<scalar_t>();
+    for (int64_t c = 0; c < n_channel; c++) {
+      grad_weight_data[c] = dotp_data[c] * invstd_data[c];
+    }
+  }
+  if (grad_bias.defined()) {
+    grad_bias.copy_(sum);
+  }
+  if (!grad_input.defined()) {
+    return;
+  }
+
+  // grad_input(n, h, w, c)
+  //     = (grad_output - grad_mean(c) - (input - mean(c)) * k(c)) * invstd(c) * weight(c),
+  // where in training mode grad_mean(c) = sum(c) / N and
+  // k(c) = dotp(c) * invstd(c)^2 / N, and they are zero in evaluation mode.
+  Tensor coefs = at::empty({3, n_channel}, input.options());
+  scalar_t* grad_mean_data = coefs.data_ptr<scalar_t>();
+  scalar_t* k_data = grad_mean_data + n_channel;
+  scalar_t* w_invstd_data = k_data + n_channel;
+  for (int64_t c = 0; c < n_channel; c++) {
+    scalar_t w = weight.defined() ? weight.data_ptr<scalar_t>()[c * weight.stride(0)] : 1;
+    grad_mean_data[c] = train ? sum_data[c] / n_rows : 0;
+    k_data[c] = train ? dotp_data[c] * invstd_data[c] * invstd_data[c] / n_rows : 0;
+    w_invstd_data[c] = invstd_data[c] * w;
+  }
+
+  scalar_t* grad_input_data = grad_input.data_ptr<scalar_t>();
+  at::parallel_for(0, n_rows, channels_last_grain_size(n_channel), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* x = input_data + i * n_channel;
+      const scalar_t* dy = grad_output_data + i * n_channel;
+      scalar_t* dx = grad_input_data + i * n_channel;
+      int64_t d = 0;
+      for (; d < loop_size; d += Vec::size()) {
+        Vec x_hat_vec = (Vec::loadu(x + d) - Vec::loadu(mean_data + d)) * Vec::loadu(k_data + d);
+        Vec dx_vec = (Vec::loadu(dy + d) - Vec::loadu(grad_mean_data + d) - x_hat_vec)
+            * Vec::loadu(w_invstd_data + d);
+        dx_vec.store(dx + d);
+      }
+      for (; d < n_channel; d++) {
+        dx[d] = (dy[d] - grad_mean_data[d] - (x[d] - mean_data[d]) * k_data[d]) * w_invstd_data[d];
+      }
+    }
+  });
+}
+
+void batch_norm_cpu_channels_last_transform_kernel(Tensor& output, const Tensor& input,
+    const Tensor& weight, const Tensor& bias, const Tensor& mean, const Tensor& invstd) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_cpu_channels_last_transform", [&] {
+    batch_norm_cpu_channels_last_transform_impl<scalar_t>(output, input, weight, bias, mean, invstd);
+  });
+}
+
+void batch_norm_cpu_channels_last_collect_stats_kernel(Tensor& mean, Tensor& var_sum,
+    const Tensor& input) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_cpu_channels_last_collect_stats", [&] {
+    batch_norm_cpu_channels_last_collect_stats_impl<scalar_t>(mean, var_sum, input);
+  });
+}
+
+void batch_norm_cpu_channels_last_backward_kernel(Tensor& grad_input,
+    Tensor& grad_weight, Tensor& grad_bias, const Tensor& grad_output,
+    const Tensor& input, const Tensor& weight, const Tensor& mean,
+    const Tensor& invstd, bool train) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_cpu_channels_last_backward", [&] {
+    batch_norm_cpu_channels_last_backward_impl<scalar_t>(grad_input, grad_weight, grad_bias,
+        grad_output, input, weight, mean, invstd, train);
+  });
+}
+
 }// anonymous namespace
 
 REGISTER_DISPATCH(batch_norm_cpu_inference_contiguous_stub, &batch_norm_cpu_inference_contiguous_kernel);
+REGISTER_DISPATCH(batch_norm_relu_cpu_inference_stub, &batch_norm_relu_cpu_inference_kernel);
+REGISTER_DISPATCH(batch_norm_cpu_channels_last_transform_stub, &batch_norm_cpu_channels_last_transform_kernel);
+REGISTER_DISPATCH(batch_norm_cpu_channels_last_collect_stats_stub, &batch_norm_cpu_channels_last_collect_stats_kernel);
+REGISTER_DISPATCH(batch_norm_cpu_channels_last_backward_stub, &batch_norm_cpu_channels_last_backward_kernel);
 
 }} // namespace at::native
@@ -173,6 +173,7 @@ void GroupNormInputBackward(
   at::parallel_for(0, N * G, 1, [=](int64_t start, int64_t end) {
     constexpr int64_t K = vec256::Vec256<T>::size();
     const int64_t d = D / K * K;
+    const int64_t inner_size = HxW / K * K;
     std::array<T, K> ds_arr;
     std::array<T, K> db_arr;
     for (int64_t i = start; i < end; ++i) {
@@ -200,13 +201,22 @@ void GroupNormInputBackward(
       const T c2 =
           (db_val * mean[i] - ds_val) * rstd[i] * rstd[i] * rstd[i] * s;
       const T c3 = -c2 * mean[i] - db_val * rstd[i] * s;
+      const vec256::Vec256<T> c2_vec(c2);
+      const vec256::Vec256<T> c3_vec(c3);
       for (int64_t j = 0; j < D; ++j) {
         const int64_t c = g * D + j;
         const T* dY_ptr = dY + (i * D + j) * HxW;
         const T* X_ptr = X + (i * D + j) * HxW;
         T* dX_ptr = dX + (i * D + j) * HxW;
         const T c1 = rstd[i] * (gamma_null ? T(1) : gamma[c]);
-        for (int64_t k = 0; k < HxW; ++k) {
+        const vec256::Vec256<T> c1_vec(c1);
+        int64_t k = 0;
+        for (; k < inner_size; k += K) {
+          (c1_vec * vec256::Vec256<T>::loadu(dY_ptr + k) +
+           c2_vec * vec256::Vec256<T>::loadu(X_ptr + k) + c3_vec)
+              .store(dX_ptr + k);
+        }
+        for (; k < HxW; ++k) {
           dX_ptr[k] = c1 * dY_ptr[k] + c2 * X_ptr[k] + c3;
         }
       }
@@ -227,17 +237,16 @@ void GammaBackward(
   const int64_t G = group;
   const int64_t D = C / G;
   constexpr int64_t K = vec256::Vec256<T>::size();
-  at::parallel_for(0, D, K, [=](int64_t start, int64_t end) {
-    for (int64_t i = 0; i < G; ++i) {
-      std::memset(dgamma + i * D + start, 0, (end - start) * sizeof(T));
-    }
-    for (int64_t i = 0; i < N * G; ++i) {
-      const T* ds_ptr = ds + i * D;
-      const T* db_ptr = db + i * D;
-      const int64_t g = i % G;
-      for (int64_t j = start; j < end; ++j) {
-        const int64_t c = g * D + j;
-        dgamma[c] += (ds_ptr[j] - db_ptr[j] * mean[i]) * rstd[i];
+  // Parallel over all the channels rather than the D channels of a group, so
+  // that there is parallelism even when the groups have a single channel.
+  at::parallel_for(0, C, K, [=](int64_t start, int64_t end) {
+    std::memset(dgamma + start, 0, (end - start) * sizeof(T));
+    for (int64_t n = 0; n < N; ++n) {
+      const T* ds_ptr = ds + n * C;
+      const T* db_ptr = db + n * C;
+      for (int64_t c = start; c < end; ++c) {
+        const int64_t i = n * G + c / D;
+        dgamma[c] += (ds_ptr[c] - db_ptr[c] * mean[i]) * rstd[i];
       }
     }
   });
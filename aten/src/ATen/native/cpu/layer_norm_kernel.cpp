@@ -1,10 +1,15 @@
 #include <ATen/native/layer_norm.h>
 
+#include <array>
 #include <cmath>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/functional.h>
 #include <ATen/cpu/vec256/vec256.h>
 
@@ -20,7 +25,7 @@ void LayerNormKernelImplInternal(
     const Tensor& beta,
     int64_t M,
     int64_t N,
-    T eps,
+    double eps,
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
@@ -52,7 +57,7 @@ void LayerNormKernelImplInternal(
           N);
       mean_val *= c;
       rstd_val = std::max(rstd_val * c - mean_val * mean_val, T(0));
-      rstd_val = T(1) / std::sqrt(rstd_val + eps);
+      rstd_val = T(1) / std::sqrt(rstd_val + static_cast<T>(eps));
       const T scale = rstd_val;
       const T bias = -rstd_val * mean_val;
       for (int64_t j = 0; j < N; ++j) {
@@ -66,7 +71,10 @@ void LayerNormKernelImplInternal(
   });
 }
 
-void LayerNormKernelImpl(
+// BFloat16 rows are widened to float, so that the moments and the affine
+// transform are computed in float and only Y, mean and rstd are rounded.
+template <>
+void LayerNormKernelImplInternal<BFloat16>(
     const Tensor& X,
     const Tensor& gamma,
     const Tensor& beta,
@@ -76,13 +84,120 @@ void LayerNormKernelImpl(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  AT_DISPATCH_FLOATING_TYPES(X.scalar_type(), "LayerNormKernelImpl", [&]() {
-    LayerNormKernelImplInternal<scalar_t>(
-        X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
+  using fVec = vec256::Vec256<float>;
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  const BFloat16* X_data = X.data_ptr<BFloat16>();
+  BFloat16* Y_data = Y->data_ptr<BFloat16>();
+  BFloat16* mean_data = mean->data_ptr<BFloat16>();
+  BFloat16* rstd_data = rstd->data_ptr<BFloat16>();
+  std::vector<float> gamma_f;
+  std::vector<float> beta_f;
+  if (gamma.defined()) {
+    gamma_f.resize(N);
+    vec256::convert(gamma.data_ptr<BFloat16>(), gamma_f.data(), N);
+  }
+  if (beta.defined()) {
+    beta_f.resize(N);
+    vec256::convert(beta.data_ptr<BFloat16>(), beta_f.data(), N);
+  }
+  const float c = 1.0f / static_cast<float>(N);
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    std::vector<float> buffer(N);
+    float* X_ptr = buffer.data();
+    for (int64_t i = start; i < end; ++i) {
+      vec256::convert(X_data + i * N, X_ptr, N);
+      float mean_val = vec256::reduce_all<float>(
+          [](fVec& x, fVec& y) { return x + y; },
+          X_ptr,
+          N);
+      float rstd_val = vec256::map_reduce_all<float>(
+          [](fVec x) { return x * x; },
+          [](fVec x, fVec y) { return x + y; },
+          X_ptr,
+          N);
+      mean_val *= c;
+      rstd_val = std::max(rstd_val * c - mean_val * mean_val, 0.0f);
+      rstd_val = 1.0f / std::sqrt(rstd_val + static_cast<float>(eps));
+      const float scale = rstd_val;
+      const float bias = -rstd_val * mean_val;
+      vec256::map(
+          [scale, bias](fVec x) { return x * fVec(scale) + fVec(bias); },
+          X_ptr,
+          X_ptr,
+          N);
+      if (!gamma_f.empty()) {
+        vec256::map2(
+            [](fVec x, fVec g) { return x * g; }, X_ptr, X_ptr, gamma_f.data(), N);
+      }
+      if (!beta_f.empty()) {
+        vec256::map2(
+            [](fVec x, fVec b) { return x + b; }, X_ptr, X_ptr, beta_f.data(), N);
+      }
+      vec256::convert(X_ptr, Y_data + i * N, N);
+      mean_data[i] = static_cast<BFloat16>(mean_val);
+      rstd_data[i] = static_cast<BFloat16>(rstd_val);
+    }
   });
 }
 
-template <typename T>
+void LayerNormKernelImpl(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps,
+    Tensor* Y,
+    Tensor* mean,
+    Tensor* rstd) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, X.scalar_type(), "LayerNormKernelImpl", [&]() {
+        LayerNormKernelImplInternal<scalar_t>(
+            X, gamma, beta, M, N, eps, Y, mean, rstd);
+      });
+}
+
+// Rows of the backward are read and written as T_ACC, so BFloat16 rows are
+// converted to and from float buffers.
+inline const float* RowAsAcc(const float* row, int64_t /* N */, float* /* buffer */) {
+  return row;
+}
+
+inline const double* RowAsAcc(const double* row, int64_t /* N */, double* /* buffer */) {
+  return row;
+}
+
+inline const float* RowAsAcc(const BFloat16* row, int64_t N, float* buffer) {
+  vec256::convert(row, buffer, N);
+  return buffer;
+}
+
+inline float* AccRowFor(float* row, float* /* buffer */) {
+  return row;
+}
+
+inline double* AccRowFor(double* row, double* /* buffer */) {
+  return row;
+}
+
+inline float* AccRowFor(BFloat16* /* row */, float* buffer) {
+  return buffer;
+}
+
+inline void StoreAccRow(const float* /* acc_row */, float* /* row */, int64_t /* N */) {}
+
+inline void StoreAccRow(const double* /* acc_row */, double* /* row */, int64_t /* N */) {}
+
+inline void StoreAccRow(const float* acc_row, BFloat16* row, int64_t N) {
+  vec256::convert(acc_row, row, N);
+}
+
+// The rows are distributed over threads. Each one computes dX for its rows,
+// and accumulates their contributions to dgamma and dbeta in its own buffer,
+// which are summed in a second pass, also parallel, over the columns.
+template <typename T, typename T_ACC>
 void LayerNormBackwardKernelImplInternal(
     const Tensor& dY,
     const Tensor& X,
@@ -94,6 +209,7 @@ void LayerNormBackwardKernelImplInternal(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
+  using Vec = vec256::Vec256<T_ACC>;
   DCHECK_EQ(dY.numel(), M * N);
   DCHECK_EQ(X.numel(), M * N);
   DCHECK_EQ(mean.numel(), M);
@@ -103,52 +219,124 @@ void LayerNormBackwardKernelImplInternal(
   const T* X_data = X.template data_ptr<T>();
   const T* mean_data = mean.template data_ptr<T>();
   const T* rstd_data = rstd.template data_ptr<T>();
-  const T* gamma_data =
-      gamma.defined() ? gamma.template data_ptr<T>() : nullptr;
   T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
   T* dgamma_data = dgamma->defined() ? dgamma->template data_ptr<T>() : nullptr;
-  if (dgamma_data != nullptr) {
-    std::memset(dgamma_data, 0, N * sizeof(T));
-  }
   T* dbeta_data = dbeta->defined() ? dbeta->template data_ptr<T>() : nullptr;
-  if (dbeta_data != nullptr) {
-    std::memset(dbeta_data, 0, N * sizeof(T));
-  }
-  const T scale = T(1) / static_cast<T>(N);
-  const bool gamma_null = gamma_data == nullptr;
-  for (int64_t i = 0; i < M; ++i) {
-    const T* dY_ptr = dY_data + i * N;
-    const T* X_ptr = X_data + i * N;
-    if (dX_data != nullptr) {
-      T* dX_ptr = dX_data + i * N;
-      T ds = 0;
-      T db = 0;
-      for (int64_t j = 0; j < N; ++j) {
-        const T gamma_v = gamma_null ? T(1) : gamma_data[j];
-        ds += dY_ptr[j] * X_ptr[j] * gamma_v;
-        db += dY_ptr[j] * gamma_v;
+  std::vector<T_ACC> gamma_buffer(gamma.defined() ? N : 0);
+  const T_ACC* gamma_acc = gamma.defined()
+      ? RowAsAcc(gamma.template data_ptr<T>(), N, gamma_buffer.data())
+      : nullptr;
+  // dgamma and dbeta are summed over the M rows, so they are accumulated in
+  // T_ACC and only rounded to T once at the end.
+  const int num_threads = at::get_num_threads();
+  std::vector<T_ACC> dgamma_buffer(
+      dgamma_data != nullptr ? num_threads * N : 0, T_ACC(0));
+  std::vector<T_ACC> dbeta_buffer(
+      dbeta_data != nullptr ? num_threads * N : 0, T_ACC(0));
+  const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
+  const int64_t inner_size = N / Vec::size() * Vec::size();
+
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    const int tid = at::get_thread_num();
+    T_ACC* dgamma_acc =
+        dgamma_data != nullptr ? dgamma_buffer.data() + tid * N : nullptr;
+    T_ACC* dbeta_acc =
+        dbeta_data != nullptr ? dbeta_buffer.data() + tid * N : nullptr;
+    std::vector<T_ACC> dY_buffer(std::is_same<T, T_ACC>::value ? 0 : N);
+    std::vector<T_ACC> X_buffer(std::is_same<T, T_ACC>::value ? 0 : N);
+    std::vector<T_ACC> dX_buffer(std::is_same<T, T_ACC>::value ? 0 : N);
+    std::array<T_ACC, Vec::size()> ds_arr;
+    std::array<T_ACC, Vec::size()> db_arr;
+    for (int64_t i = start; i < end; ++i) {
+      const T_ACC* dY_ptr = RowAsAcc(dY_data + i * N, N, dY_buffer.data());
+      const T_ACC* X_ptr = RowAsAcc(X_data + i * N, N, X_buffer.data());
+      const T_ACC mean_v = static_cast<T_ACC>(mean_data[i]);
+      const T_ACC rstd_v = static_cast<T_ACC>(rstd_data[i]);
+      const Vec rstd_vec(rstd_v);
+      const Vec mean_vec(mean_v);
+      if (dX_data != nullptr) {
+        // ds = sum(dY * gamma * X), db = sum(dY * gamma)
+        Vec ds_vec(0);
+        Vec db_vec(0);
+        for (int64_t j = 0; j < N; j += Vec::size()) {
+          const int64_t n = std::min<int64_t>(Vec::size(), N - j);
+          const Vec dy_vec = Vec::loadu(dY_ptr + j, n);
+          const Vec dyg_vec = gamma_acc == nullptr
+              ? dy_vec : dy_vec * Vec::loadu(gamma_acc + j, n);
+          ds_vec = ds_vec + dyg_vec * Vec::loadu(X_ptr + j, n);
+          db_vec = db_vec + dyg_vec;
+        }
+        ds_vec.store(ds_arr.data());
+        db_vec.store(db_arr.data());
+        const T_ACC ds = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), T_ACC(0));
+        const T_ACC db = std::accumulate(db_arr.cbegin(), db_arr.cend(), T_ACC(0));
+        const T_ACC a = rstd_v;
+        const T_ACC b = (db * mean_v - ds) * a * a * a * scale;
+        const T_ACC c = -b * mean_v - db * a * scale;
+        const Vec a_vec(a);
+        const Vec b_vec(b);
+        const Vec c_vec(c);
+        T_ACC* dX_ptr = AccRowFor(dX_data + i * N, dX_buffer.data());
+        int64_t j = 0;
+        for (; j < inner_size; j += Vec::size()) {
+          const Vec dy_vec = Vec::loadu(dY_ptr + j);
+          const Vec dyg_vec = gamma_acc == nullptr
+              ? dy_vec : dy_vec * Vec::loadu(gamma_acc + j);
+          (a_vec * dyg_vec + b_vec * Vec::loadu(X_ptr + j) + c_vec).store(dX_ptr + j);
+        }
+        for (; j < N; ++j) {
+          const T_ACC gamma_v = gamma_acc == nullptr ? T_ACC(1) : gamma_acc[j];
+          dX_ptr[j] = a * dY_ptr[j] * gamma_v + b * X_ptr[j] + c;
+        }
+        StoreAccRow(dX_ptr, dX_data + i * N, N);
       }
-      const T a = rstd_data[i];
-      const T b = (db * mean_data[i] - ds) * a * a * a * scale;
-      const T c = -b * mean_data[i] - db * a * scale;
-      for (int64_t j = 0; j < N; ++j) {
-        const T gamma_v = gamma_null ? T(1) : gamma_data[j];
-        dX_ptr[j] = a * dY_ptr[j] * gamma_v + b * X_ptr[j] + c;
+      if (dgamma_acc != nullptr) {
+        // dgamma += dY * (X - mean) * rstd
+        int64_t j = 0;
+        for (; j < inner_size; j += Vec::size()) {
+          const Vec x_hat = (Vec::loadu(X_ptr + j) - mean_vec) * rstd_vec;
+          (Vec::loadu(dgamma_acc + j) + Vec::loadu(dY_ptr + j) * x_hat)
+              .store(dgamma_acc + j);
+        }
+        for (; j < N; ++j) {
+          dgamma_acc[j] += dY_ptr[j] * (X_ptr[j] - mean_v) * rstd_v;
+        }
       }
-    }
-    if (dgamma_data != nullptr) {
-      const T a = rstd_data[i];
-      const T b = -a * mean_data[i];
-      for (int64_t j = 0; j < N; ++j) {
-        dgamma_data[j] += dY_ptr[j] * (a * X_ptr[j] + b);
+      if (dbeta_acc != nullptr) {
+        int64_t j = 0;
+        for (; j < inner_size; j += Vec::size()) {
+          (Vec::loadu(dbeta_acc + j) + Vec::loadu(dY_ptr + j)).store(dbeta_acc + j);
+        }
+        for (; j < N; ++j) {
+          dbeta_acc[j] += dY_ptr[j];
+        }
       }
     }
-    if (dbeta_data != nullptr) {
-      for (int64_t j = 0; j < N; ++j) {
-        dbeta_data[j] += dY_ptr[j];
+  });
+
+  if (dgamma_data == nullptr && dbeta_data == nullptr) {
+    return;
+  }
+  at::parallel_for(0, N, Vec::size(), [&](int64_t start, int64_t end) {
+    for (int64_t j = start; j < end; ++j) {
+      T_ACC dgamma_v = 0;
+      T_ACC dbeta_v = 0;
+      for (int t = 0; t < num_threads; ++t) {
+        if (dgamma_data != nullptr) {
+          dgamma_v += dgamma_buffer[t * N + j];
+        }
+        if (dbeta_data != nullptr) {
+          dbeta_v += dbeta_buffer[t * N + j];
+        }
+      }
+      if (dgamma_data != nullptr) {
+        dgamma_data[j] = static_cast<T>(dgamma_v);
+      }
+      if (dbeta_data != nullptr) {
+        dbeta_data[j] = static_cast<T>(dbeta_v);
       }
     }
-  }
+  });
 }
 
 void LayerNormBackwardKernelImpl(
@@ -162,9 +350,13 @@ void LayerNormBackwardKernelImpl(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
-  AT_DISPATCH_FLOATING_TYPES(
-      X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
-        LayerNormBackwardKernelImplInternal<scalar_t>(
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, X.scalar_type(),
+      "LayerNormBackwardKernelImpl", [&]() {
+        // BFloat16 is accumulated in float, float and double in their own type.
+        using T_ACC = typename std::conditional<
+            std::is_same<scalar_t, BFloat16>::value, float, scalar_t>::type;
+        LayerNormBackwardKernelImplInternal<scalar_t, T_ACC>(
             dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
       });
 }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <utility>
+
+namespace at {
+namespace native {
+namespace {
+
+// Decomposes a flat index of a loop nest into the indices of its loops, given
+// from the outermost to the innermost with their sizes, and returns the index
+// left for the loops outside of them. E.g. for output positions of NHWC:
+//   data_index_init(begin, n, N, h, H, w, W);
+template <typename T>
+inline T data_index_init(T offset) {
+  return offset;
+}
+
+template <typename T, typename... Args>
+inline T data_index_init(T offset, T &x, const T &X, Args &&... args) {
+  offset = data_index_init(offset, std::forward<Args>(args)...);
+  x = offset % X;
+  return offset / X;
+}
+
+// Increments the indices set by data_index_init, and returns true when they
+// wrap around.
+inline bool data_index_step() {
+  return true;
+}
+
+template <typename T, typename... Args>
+inline bool data_index_step(T &x, const T &X, Args &&... args) {
+  if (data_index_step(std::forward<Args>(args)...)) {
+    x = ((x + 1) == X) ? 0 : (x + 1);
+    return x == 0;
+  }
+  return false;
+}
+
+} // namespace
+} // namespace native
+} // namespace at
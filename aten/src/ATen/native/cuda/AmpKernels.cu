@@ -3,9 +3,13 @@
 #include <math.h>
 
 #include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/ForeachUtils.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
 
 namespace {
 // Thin wrapper around https://docs.nvidia.com/cuda/cuda-math-api/group__CUDA__MATH__SINGLE.html#group__CUDA__MATH__SINGLE_1g57a3c8313f570282a1a7bcc78743b08e,
@@ -80,6 +84,92 @@ void _amp_non_finite_check_and_unscale_cuda_(Tensor& scaled_grad,
 }
 
 
+namespace {
+
+void check_found_inf_and_inv_scale(const Tensor& found_inf, const Tensor& inv_scale) {
+  TORCH_CHECK(inv_scale.is_cuda(), "inv_scale must be a CUDA tensor.");
+  TORCH_CHECK(found_inf.is_cuda(), "found_inf must be a CUDA tensor.");
+  TORCH_CHECK(inv_scale.numel() == 1, "inv_scale must be a 1-element tensor.");
+  TORCH_CHECK(found_inf.numel() == 1, "found_inf must be a 1-element tensor.");
+  TORCH_CHECK(inv_scale.scalar_type() == at::ScalarType::Float, "inv_scale must be a float tensor.");
+  TORCH_CHECK(found_inf.scalar_type() == at::ScalarType::Float, "found_inf must be a float tensor.");
+}
+
+// Unscales the chunks of a list of gradients in place, and sets found_inf to
+// 1.0 if one of their elements is inf or NaN.
+template <typename scalar_t>
+struct NonFiniteCheckAndUnscaleFunctor {
+  float* found_inf;
+  const float* inv_scale;
+
+  __device__ __forceinline__ void operator()(
+      int64_t chunk_size,
+      TensorListMetadata<1>& tl) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t offset = chunk_idx * chunk_size;
+    const int64_t remaining = tl.numel_for_tensor[tensor_loc] - offset;
+    const int64_t n = remaining < chunk_size ? remaining : chunk_size;
+
+    scalar_t* grad = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    const float inv_scale_val = *inv_scale;
+    bool found = false;
+    for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+      const float fval = static_cast<float>(grad[i]);
+      // See isfinite_ensure_cuda_math above.
+      found |= !isfinite_ensure_cuda_math(fval);
+      grad[i] = static_cast<scalar_t>(inv_scale_val == 1.f ? fval : fval * inv_scale_val);
+    }
+    // Threads only ever write 1.0, so the races between them are benign.
+    if (found) {
+      *found_inf = 1.f;
+    }
+  }
+};
+
+} // anonymous namespace
+
+// Multi-tensor version of _amp_non_finite_check_and_unscale_cuda_, which
+// unscales all the gradients of a list with a few kernel launches.
+//
+// Args:
+// scaled_grads:  A list of (scaled) gradient tensors.  May contain infs or NaNs.
+// found_inf:  A single-element float tensor to which 1.0 will be written if any gradients contain infs/nans.
+//             Pre-zeroing found_inf, if appropriate, is the responsibility of the caller.
+// inv_scale:  The inverse of the scale factor by which the scaled_grads are currently multiplied.
+void _amp_foreach_non_finite_check_and_unscale_cuda_(TensorList scaled_grads,
+                                                     Tensor& found_inf,
+                                                     const Tensor& inv_scale)
+{
+  if (scaled_grads.size() == 0) {
+    return;
+  }
+  check_found_inf_and_inv_scale(found_inf, inv_scale);
+
+  // The multi-tensor kernel requires dense grads of a single dtype on the
+  // device of found_inf. Other lists are unscaled one grad at a time.
+  if (!can_use_fast_route({scaled_grads}) ||
+      scaled_grads[0].device() != found_inf.device()) {
+    for (const auto& t : scaled_grads) {
+      auto scaled_grad = t;
+      _amp_non_finite_check_and_unscale_cuda_(scaled_grad, found_inf, inv_scale);
+    }
+    return;
+  }
+
+  std::vector<std::vector<Tensor>> tensor_lists{scaled_grads.vec()};
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+    scaled_grads[0].scalar_type(),
+    "_amp_foreach_non_finite_check_and_unscale_cuda",
+    [&tensor_lists, &found_inf, &inv_scale] {
+      multi_tensor_apply<1>(
+          tensor_lists,
+          NonFiniteCheckAndUnscaleFunctor<scalar_t>{
+              found_inf.data_ptr<float>(), inv_scale.data_ptr<float>()});
+    });
+}
+
+
 // amp_update_scale_cuda_kernel is launched with a single thread to compute the new scale.
 // The scale factor is maintained and updated on the GPU to avoid synchronization.
 __global__ void amp_update_scale_cuda_kernel(int* growth_tracker,
@@ -108,6 +198,39 @@ __global__ void amp_update_scale_cuda_kernel(int* growth_tracker,
 }
 
 
+namespace {
+
+void amp_update_scale_cuda_impl(Tensor& growth_tracker,
+                                const Tensor& current_scale,
+                                const Tensor& found_inf,
+                                Tensor& new_scale,
+                                double growth_factor,
+                                double backoff_factor,
+                                int64_t growth_interval)
+{
+  TORCH_CHECK(growth_tracker.is_cuda(), "growth_tracker must be a CUDA tensor.");
+  TORCH_CHECK(current_scale.is_cuda(), "current_scale must be a CUDA tensor.");
+  TORCH_CHECK(found_inf.is_cuda(), "found_inf must be a CUDA tensor.");
+  TORCH_CHECK(growth_tracker.numel() == 1, "growth_tracker must be a 1-element tensor.");
+  TORCH_CHECK(current_scale.numel() == 1, "current_scale must be a 1-element tensor.");
+  TORCH_CHECK(found_inf.numel() == 1, "found_inf must be a 1-element tensor.");
+  TORCH_CHECK(growth_tracker.scalar_type() == at::ScalarType::Int, "growth_tracker must be an int tensor.");
+  TORCH_CHECK(current_scale.scalar_type() == at::ScalarType::Float, "current_scale must be a float tensor.");
+  TORCH_CHECK(found_inf.scalar_type() == at::ScalarType::Float, "found_inf must be a float tensor.");
+
+  amp_update_scale_cuda_kernel<<<1, 1, 0, at::cuda::getCurrentCUDAStream()>>>(
+    growth_tracker.data_ptr<int>(),
+    current_scale.data_ptr<float>(),
+    found_inf.data_ptr<float>(),
+    new_scale.data_ptr<float>(),
+    growth_factor,
+    backoff_factor,
+    growth_interval);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+} // anonymous namespace
+
 // _amp_update_scale_cuda asynchronously updates the scale factor.
 //
 // Args:
@@ -129,28 +252,24 @@ Tensor _amp_update_scale_cuda(Tensor& growth_tracker,
                               double backoff_factor,
                               int64_t growth_interval)
 {
-  TORCH_CHECK(growth_tracker.is_cuda(), "growth_tracker must be a CUDA tensor.");
-  TORCH_CHECK(current_scale.is_cuda(), "current_scale must be a CUDA tensor.");
-  TORCH_CHECK(found_inf.is_cuda(), "found_inf must be a CUDA tensor.");
-  TORCH_CHECK(growth_tracker.numel() == 1, "growth_tracker must be a 1-element tensor.");
-  TORCH_CHECK(current_scale.numel() == 1, "current_scale must be a 1-element tensor.");
-  TORCH_CHECK(found_inf.numel() == 1, "found_inf must be a 1-element tensor.");
-  TORCH_CHECK(growth_tracker.scalar_type() == at::ScalarType::Int, "growth_tracker must be an int tensor.");
-  TORCH_CHECK(current_scale.scalar_type() == at::ScalarType::Float, "current_scale must be a float tensor.");
-  TORCH_CHECK(found_inf.scalar_type() == at::ScalarType::Float, "found_inf must be a float tensor.");
-
   auto new_scale = at::empty_like(current_scale);
-
-  amp_update_scale_cuda_kernel<<<1, 1, 0, at::cuda::getCurrentCUDAStream()>>>(
-    growth_tracker.data_ptr<int>(),
-    current_scale.data_ptr<float>(),
-    found_inf.data_ptr<float>(),
-    new_scale.data_ptr<float>(),
-    growth_factor,
-    backoff_factor,
-    growth_interval);
-
+  amp_update_scale_cuda_impl(growth_tracker, current_scale, found_inf, new_scale,
+                             growth_factor, backoff_factor, growth_interval);
   return new_scale;
 }
 
+// In-place version of _amp_update_scale_cuda, which writes the new scale to current_scale.  The scale tensor
+// keeps its identity across iterations, so the whole update stays on the device (and can be captured).
+Tensor& _amp_update_scale_cuda_(Tensor& current_scale,
+                                Tensor& growth_tracker,
+                                const Tensor& found_inf,
+                                double growth_factor,
+                                double backoff_factor,
+                                int64_t growth_interval)
+{
+  amp_update_scale_cuda_impl(growth_tracker, current_scale, found_inf, current_scale,
+                             growth_factor, backoff_factor, growth_interval);
+  return current_scale;
+}
+
 }} // namespace at::native
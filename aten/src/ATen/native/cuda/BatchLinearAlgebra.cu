@@ -1,5 +1,6 @@
 #include <ATen/Context.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDABlas.h>
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/PinnedMemoryAllocator.h>
@@ -11,6 +12,8 @@
 
 #include <THC/THC.h> // for USE_MAGMA
 
+#include <limits>
+
 #ifdef USE_MAGMA
 #include <magma.h>
 #include <magma_types.h>
@@ -528,6 +531,431 @@ void magmaLuSolveBatched<float>(
   auto storage_##name = pin_memory<type>(size); \
   name = static_cast<type*>(storage_##name.data());
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ small matrices ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Batches of tiny square matrices are factorized by kernels in which a single
+// thread holds a whole matrix in its registers. The size of the matrices is a
+// template parameter and all the loops are unrolled, so that the matrices are
+// only ever indexed by compile-time constants and never spill to local memory.
+// The matrices are column-major, element (i, j) being a[j * N + i].
+constexpr int64_t small_matrix_max_size = 8;
+constexpr int small_matrix_block_size = 128;
+
+#define SMALL_MATRIX_SIZE_CASE(N, ...) \
+  case N: {                            \
+    constexpr int matrix_size = N;     \
+    __VA_ARGS__();                     \
+    break;                             \
+  }
+
+// Calls the lambda with the constant matrix_size defined to n.
+#define DISPATCH_SMALL_MATRIX_SIZE(n, ...)                              \
+  switch (n) {                                                          \
+    SMALL_MATRIX_SIZE_CASE(1, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(2, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(3, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(4, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(5, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(6, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(7, __VA_ARGS__)                              \
+    SMALL_MATRIX_SIZE_CASE(8, __VA_ARGS__)                              \
+    default:                                                            \
+      TORCH_INTERNAL_ASSERT(false, "unexpected small matrix size ", n); \
+  }
+
+static bool use_small_matrix_kernel(const Tensor& input) {
+  return input.size(-1) == input.size(-2) && input.size(-1) <= small_matrix_max_size &&
+      input.numel() > 0;
+}
+
+template <typename scalar_t, int N>
+__device__ __forceinline__ void small_matrix_load(scalar_t (&a)[N * N], const scalar_t* src) {
+#pragma unroll
+  for (int i = 0; i < N * N; i++) {
+    a[i] = src[i];
+  }
+}
+
+template <typename scalar_t, int N>
+__device__ __forceinline__ void small_matrix_store(const scalar_t (&a)[N * N], scalar_t* dst) {
+#pragma unroll
+  for (int i = 0; i < N * N; i++) {
+    dst[i] = a[i];
+  }
+}
+
+// LU factorization with partial pivoting, as in getrf: the pivots are 1-based
+// and the returned info is the 1-based index of the first zero pivot, the
+// factorization being carried on regardless.
+template <typename scalar_t, int N>
+__device__ __forceinline__ int small_matrix_lu(scalar_t (&a)[N * N], int (&piv)[N]) {
+  int info = 0;
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+    int p = k;
+    scalar_t p_abs = ::abs(a[k * N + k]);
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (::abs(a[k * N + i]) > p_abs) {
+        p = i;
+        p_abs = ::abs(a[k * N + i]);
+      }
+    }
+    piv[k] = p + 1;
+    // p is only known at runtime: compare it to every candidate row instead of
+    // indexing with it.
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (i == p) {
+#pragma unroll
+        for (int j = 0; j < N; j++) {
+          const scalar_t tmp = a[j * N + k];
+          a[j * N + k] = a[j * N + i];
+          a[j * N + i] = tmp;
+        }
+      }
+    }
+    const scalar_t pivot = a[k * N + k];
+    if (pivot == scalar_t(0)) {
+      if (info == 0) {
+        info = k + 1;
+      }
+    } else {
+      const scalar_t inv_pivot = scalar_t(1) / pivot;
+#pragma unroll
+      for (int i = k + 1; i < N; i++) {
+        a[k * N + i] *= inv_pivot;
+      }
+    }
+#pragma unroll
+    for (int j = k + 1; j < N; j++) {
+#pragma unroll
+      for (int i = k + 1; i < N; i++) {
+        a[j * N + i] -= a[k * N + i] * a[j * N + k];
+      }
+    }
+  }
+  return info;
+}
+
+// Solves for x in place, given the LU factorization of a nonsingular matrix.
+template <typename scalar_t, int N>
+__device__ __forceinline__ void small_matrix_lu_solve(
+    const scalar_t (&lu)[N * N], const int (&piv)[N], scalar_t (&x)[N]) {
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (i == piv[k] - 1) {
+        const scalar_t tmp = x[k];
+        x[k] = x[i];
+        x[i] = tmp;
+      }
+    }
+  }
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      x[i] -= lu[k * N + i] * x[k];
+    }
+  }
+#pragma unroll
+  for (int k = N - 1; k >= 0; k--) {
+    x[k] /= lu[k * N + k];
+#pragma unroll
+    for (int i = 0; i < k; i++) {
+      x[i] -= lu[k * N + i] * x[k];
+    }
+  }
+}
+
+// Lower Cholesky factorization, as in potrf: the returned info is the 1-based
+// index of the first leading minor which is not positive definite, where the
+// factorization stops. The strictly upper triangle is left untouched.
+template <typename scalar_t, int N>
+__device__ __forceinline__ int small_matrix_cholesky(scalar_t (&a)[N * N]) {
+#pragma unroll
+  for (int j = 0; j < N; j++) {
+    scalar_t d = a[j * N + j];
+#pragma unroll
+    for (int k = 0; k < j; k++) {
+      d -= a[k * N + j] * a[k * N + j];
+    }
+    // Also catches NaN
+    if (!(d > scalar_t(0))) {
+      return j + 1;
+    }
+    d = ::sqrt(d);
+    a[j * N + j] = d;
+#pragma unroll
+    for (int i = j + 1; i < N; i++) {
+      scalar_t v = a[j * N + i];
+#pragma unroll
+      for (int k = 0; k < j; k++) {
+        v -= a[k * N + i] * a[k * N + j];
+      }
+      a[j * N + i] = v / d;
+    }
+  }
+  return 0;
+}
+
+template <typename scalar_t, int N>
+__global__ void small_matrix_lu_kernel(
+    scalar_t* self, int* pivots, int* infos, int64_t batch_size) {
+  const int64_t batch = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (batch >= batch_size) {
+    return;
+  }
+  scalar_t a[N * N];
+  int piv[N];
+  small_matrix_load<scalar_t, N>(a, self + batch * N * N);
+  infos[batch] = small_matrix_lu<scalar_t, N>(a, piv);
+  small_matrix_store<scalar_t, N>(a, self + batch * N * N);
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+    pivots[batch * N + k] = piv[k];
+  }
+}
+
+// A is overwritten by its LU factorization and b by the solution.
+template <typename scalar_t, int N>
+__global__ void small_matrix_solve_kernel(
+    scalar_t* A, scalar_t* b, int* infos, int64_t nrhs, int64_t batch_size) {
+  const int64_t batch = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (batch >= batch_size) {
+    return;
+  }
+  scalar_t a[N * N];
+  int piv[N];
+  small_matrix_load<scalar_t, N>(a, A + batch * N * N);
+  const int info = small_matrix_lu<scalar_t, N>(a, piv);
+  infos[batch] = info;
+  small_matrix_store<scalar_t, N>(a, A + batch * N * N);
+  if (info != 0) {
+    return;
+  }
+  scalar_t* b_working_ptr = b + batch * N * nrhs;
+  for (int64_t j = 0; j < nrhs; j++) {
+    scalar_t x[N];
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      x[i] = b_working_ptr[j * N + i];
+    }
+    small_matrix_lu_solve<scalar_t, N>(a, piv, x);
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      b_working_ptr[j * N + i] = x[i];
+    }
+  }
+}
+
+// self is overwritten by its inverse, unless it is singular.
+template <typename scalar_t, int N>
+__global__ void small_matrix_inverse_kernel(scalar_t* self, int* infos, int64_t batch_size) {
+  const int64_t batch = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (batch >= batch_size) {
+    return;
+  }
+  scalar_t a[N * N];
+  int piv[N];
+  small_matrix_load<scalar_t, N>(a, self + batch * N * N);
+  const int info = small_matrix_lu<scalar_t, N>(a, piv);
+  infos[batch] = info;
+  if (info != 0) {
+    return;
+  }
+#pragma unroll
+  for (int j = 0; j < N; j++) {
+    scalar_t x[N];
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      x[i] = i == j ? scalar_t(1) : scalar_t(0);
+    }
+    small_matrix_lu_solve<scalar_t, N>(a, piv, x);
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      self[batch * N * N + j * N + i] = x[i];
+    }
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void small_matrix_cholesky_kernel(scalar_t* self, int* infos, int64_t batch_size) {
+  const int64_t batch = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (batch >= batch_size) {
+    return;
+  }
+  scalar_t a[N * N];
+  small_matrix_load<scalar_t, N>(a, self + batch * N * N);
+  infos[batch] = small_matrix_cholesky<scalar_t, N>(a);
+  small_matrix_store<scalar_t, N>(a, self + batch * N * N);
+}
+
+static dim3 small_matrix_grid(int64_t batch_size) {
+  return dim3((batch_size + small_matrix_block_size - 1) / small_matrix_block_size);
+}
+
+static void copy_infos_to_host(const Tensor& infos_tensor, std::vector<int64_t>& infos) {
+  auto infos_cpu = infos_tensor.cpu();
+  auto infos_data = infos_cpu.data_ptr<int>();
+  for (size_t i = 0; i < infos.size(); i++) {
+    infos[i] = infos_data[i];
+  }
+}
+
+template <typename scalar_t>
+static void apply_small_matrix_solve(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
+  const int64_t batch_size = batchCount(A);
+  auto infos_tensor = at::empty({batch_size}, A.options().dtype(at::kInt));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  DISPATCH_SMALL_MATRIX_SIZE(A.size(-1), [&] {
+    small_matrix_solve_kernel<scalar_t, matrix_size>
+        <<<small_matrix_grid(batch_size), small_matrix_block_size, 0, stream>>>(
+            A.data_ptr<scalar_t>(), b.data_ptr<scalar_t>(), infos_tensor.data_ptr<int>(),
+            b.size(-1), batch_size);
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  copy_infos_to_host(infos_tensor, infos);
+}
+
+template <typename scalar_t>
+static void apply_small_matrix_inverse(Tensor& self, std::vector<int64_t>& infos) {
+  const int64_t batch_size = batchCount(self);
+  auto infos_tensor = at::empty({batch_size}, self.options().dtype(at::kInt));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  DISPATCH_SMALL_MATRIX_SIZE(self.size(-1), [&] {
+    small_matrix_inverse_kernel<scalar_t, matrix_size>
+        <<<small_matrix_grid(batch_size), small_matrix_block_size, 0, stream>>>(
+            self.data_ptr<scalar_t>(), infos_tensor.data_ptr<int>(), batch_size);
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  copy_infos_to_host(infos_tensor, infos);
+}
+
+template <typename scalar_t>
+static void apply_small_matrix_cholesky(Tensor& self, std::vector<int64_t>& infos) {
+  const int64_t batch_size = batchCount(self);
+  auto infos_tensor = at::empty({batch_size}, self.options().dtype(at::kInt));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  DISPATCH_SMALL_MATRIX_SIZE(self.size(-1), [&] {
+    small_matrix_cholesky_kernel<scalar_t, matrix_size>
+        <<<small_matrix_grid(batch_size), small_matrix_block_size, 0, stream>>>(
+            self.data_ptr<scalar_t>(), infos_tensor.data_ptr<int>(), batch_size);
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  copy_infos_to_host(infos_tensor, infos);
+}
+
+// pivots and infos are contiguous device tensors.
+template <typename scalar_t>
+static void apply_small_matrix_lu(Tensor& self, Tensor& pivots, Tensor& infos) {
+  const int64_t batch_size = batchCount(self);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  DISPATCH_SMALL_MATRIX_SIZE(self.size(-1), [&] {
+    small_matrix_lu_kernel<scalar_t, matrix_size>
+        <<<small_matrix_grid(batch_size), small_matrix_block_size, 0, stream>>>(
+            self.data_ptr<scalar_t>(), pivots.data_ptr<int>(), infos.data_ptr<int>(), batch_size);
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ cuBLAS batched LU ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Batches of small matrices which are too large for the kernels above go to the
+// batched LU routines of cuBLAS, which are tuned for these sizes and do not
+// need MAGMA.
+constexpr int64_t cublas_batched_max_size = 32;
+
+static bool use_cublas_batched(const Tensor& input) {
+#ifdef __HIP_PLATFORM_HCC__
+  return false;
+#else
+  return input.dim() > 2 && input.size(-1) == input.size(-2) &&
+      input.size(-1) <= cublas_batched_max_size && input.numel() > 0 &&
+      batchCount(input) <= std::numeric_limits<int>::max();
+#endif
+}
+
+#ifndef __HIP_PLATFORM_HCC__
+
+// The cuBLAS batched routines take a device array of pointers to the matrices,
+// which is computed on the device from the address of the first matrix.
+template <typename scalar_t>
+static Tensor batch_device_pointers(const Tensor& input) {
+  auto input_data = input.data_ptr<scalar_t>();
+  const int64_t matrix_stride = matrixStride(input);
+  return at::arange(
+      reinterpret_cast<int64_t>(input_data),
+      reinterpret_cast<int64_t>(input_data + batchCount(input) * matrix_stride),
+      static_cast<int64_t>(matrix_stride * sizeof(scalar_t)),
+      input.options().dtype(at::kLong));
+}
+
+template <typename scalar_t>
+static scalar_t** as_pointer_array(Tensor& pointers) {
+  return reinterpret_cast<scalar_t**>(pointers.data_ptr<int64_t>());
+}
+
+template <typename scalar_t>
+static void apply_cublas_batched_solve(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
+  const int batch_size = static_cast<int>(batchCount(A));
+  const int n = static_cast<int>(A.size(-1));
+  const int nrhs = static_cast<int>(b.size(-1));
+  auto A_array = batch_device_pointers<scalar_t>(A);
+  auto b_array = batch_device_pointers<scalar_t>(b);
+  auto ipiv = at::empty({batch_size, n}, A.options().dtype(at::kInt));
+  auto infos_tensor = at::empty({batch_size}, A.options().dtype(at::kInt));
+
+  at::cuda::blas::getrfBatched<scalar_t>(
+      n, as_pointer_array<scalar_t>(A_array), n, ipiv.data_ptr<int>(),
+      infos_tensor.data_ptr<int>(), batch_size);
+  copy_infos_to_host(infos_tensor, infos);
+  for (int64_t info : infos) {
+    if (info != 0) {
+      return;
+    }
+  }
+
+  int info = 0;
+  at::cuda::blas::getrsBatched<scalar_t>(
+      'n', n, nrhs, as_pointer_array<scalar_t>(A_array), n, ipiv.data_ptr<int>(),
+      as_pointer_array<scalar_t>(b_array), n, &info, batch_size);
+  TORCH_INTERNAL_ASSERT(info == 0, "getrsBatched: invalid argument ", -info);
+}
+
+template <typename scalar_t>
+static void apply_cublas_batched_inverse(Tensor& self, Tensor& self_inv, std::vector<int64_t>& infos) {
+  const int batch_size = static_cast<int>(batchCount(self));
+  const int n = static_cast<int>(self.size(-1));
+  auto self_array = batch_device_pointers<scalar_t>(self);
+  auto self_inv_array = batch_device_pointers<scalar_t>(self_inv);
+  auto ipiv = at::empty({batch_size, n}, self.options().dtype(at::kInt));
+  auto infos_tensor = at::empty({batch_size}, self.options().dtype(at::kInt));
+
+  at::cuda::blas::getrfBatched<scalar_t>(
+      n, as_pointer_array<scalar_t>(self_array), n, ipiv.data_ptr<int>(),
+      infos_tensor.data_ptr<int>(), batch_size);
+  at::cuda::blas::getriBatched<scalar_t>(
+      n, as_pointer_array<scalar_t>(self_array), n, ipiv.data_ptr<int>(),
+      as_pointer_array<scalar_t>(self_inv_array), n, infos_tensor.data_ptr<int>(), batch_size);
+  copy_infos_to_host(infos_tensor, infos);
+}
+
+// pivots and infos are contiguous device tensors.
+template <typename scalar_t>
+static void apply_cublas_batched_lu(Tensor& self, Tensor& pivots, Tensor& infos) {
+  const int batch_size = static_cast<int>(batchCount(self));
+  const int n = static_cast<int>(self.size(-1));
+  auto self_array = batch_device_pointers<scalar_t>(self);
+  at::cuda::blas::getrfBatched<scalar_t>(
+      n, as_pointer_array<scalar_t>(self_array), n, pivots.data_ptr<int>(),
+      infos.data_ptr<int>(), batch_size);
+}
+
+#endif // __HIP_PLATFORM_HCC__
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ solve ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 template <typename scalar_t>
@@ -609,7 +1037,15 @@ std::tuple<Tensor, Tensor> _solve_helper_cuda(const Tensor& self, const Tensor&
   auto A_working_copy = cloneBatchedColumnMajor(A);
   std::vector<int64_t> infos(batchCount(self), 0);
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "solve_cuda", [&]{
-    apply_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+    if (use_small_matrix_kernel(A_working_copy)) {
+      apply_small_matrix_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+    } else if (use_cublas_batched(A_working_copy)) {
+#ifndef __HIP_PLATFORM_HCC__
+      apply_cublas_batched_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+#endif
+    } else {
+      apply_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+    }
   });
   if (self.dim() > 2) {
     batchCheckErrors(infos, "solve_cuda");
@@ -715,12 +1151,29 @@ AT_ERROR("inverse: MAGMA library not found in "
 
 Tensor _inverse_helper_cuda(const Tensor& self) {
   auto self_inv_working_copy = cloneBatchedColumnMajor(self);
-  if (self.dim() > 2) {
+  if (use_small_matrix_kernel(self)) {
+    std::vector<int64_t> infos(batchCount(self), 0);
+    AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "inverse_cuda", [&]{
+      apply_small_matrix_inverse<scalar_t>(self_inv_working_copy, infos);
+    });
+    if (self.dim() > 2) {
+      batchCheckErrors(infos, "inverse_cuda");
+    } else {
+      singleCheckErrors(infos[0], "inverse_cuda");
+    }
+  } else if (self.dim() > 2) {
     std::vector<int64_t> infos(batchCount(self), 0);
     auto self_working_copy = cloneBatchedColumnMajor(self);
     AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "inverse_cuda", [&]{
-      apply_batched_inverse<scalar_t>(
-        self_working_copy, self_inv_working_copy, infos);
+      if (use_cublas_batched(self)) {
+#ifndef __HIP_PLATFORM_HCC__
+        apply_cublas_batched_inverse<scalar_t>(
+          self_working_copy, self_inv_working_copy, infos);
+#endif
+      } else {
+        apply_batched_inverse<scalar_t>(
+          self_working_copy, self_inv_working_copy, infos);
+      }
     });
     batchCheckErrors(infos, "inverse_cuda");
   } else {
@@ -887,7 +1340,11 @@ Tensor _cholesky_helper_cuda(const Tensor& self, bool upper) {
   }
 
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "cholesky_cuda", [&]{
-    apply_cholesky<scalar_t>(self_working_copy, false, infos);
+    if (use_small_matrix_kernel(self_working_copy)) {
+      apply_small_matrix_cholesky<scalar_t>(self_working_copy, infos);
+    } else {
+      apply_cholesky<scalar_t>(self_working_copy, false, infos);
+    }
   });
   if (self.dim() > 2) {
     batchCheckErrors(infos, "cholesky_cuda");
@@ -985,7 +1442,15 @@ std::tuple<Tensor, Tensor, Tensor> _lu_with_info_cuda(const Tensor& self, bool p
   } else {
     self_working_copy = cloneBatchedColumnMajor(self);
     AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "lu_cuda", [&]{
+      if (pivot && use_small_matrix_kernel(self_working_copy)) {
+        apply_small_matrix_lu<scalar_t>(self_working_copy, pivots_tensor, infos_tensor);
+      } else if (pivot && use_cublas_batched(self_working_copy)) {
+#ifndef __HIP_PLATFORM_HCC__
+        apply_cublas_batched_lu<scalar_t>(self_working_copy, pivots_tensor, infos_tensor);
+#endif
+      } else {
         apply_lu<scalar_t>(self_working_copy, pivots_tensor, infos_tensor, pivot);
+      }
     });
   }
   if (check_errors) {
@@ -27,9 +27,13 @@
 //
 // See BinaryOpsKernel.cu for the complete implementation
 //
+// gpu_kernel_multiple_outputs(TensorIterator iter, <lambda>) supports
+// functions that return a thrust::tuple of outputs, see Loops.cuh.
+//
 
 #include <type_traits>
 #include <tuple>
+#include <thrust/tuple.h>
 
 #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAContext.h>
@@ -157,6 +161,98 @@ static inline void launch_unrolled_kernel(int64_t N, const func_t& f, array_t da
   AT_CUDA_CHECK(cudaGetLastError());
 }
 
+template <int num_outputs, typename func_t, typename array_t, typename inp_calc_t, typename out_calc_t, typename loader_t, typename storer_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void unrolled_elementwise_kernel_for_multi_outputs(int N, func_t f, array_t data,
+                                                              inp_calc_t ic, out_calc_t oc, loader_t l, storer_t s)
+{
+  int remaining = N - block_work_size * blockIdx.x;
+  auto policy = memory::policies::multi_outputs_unroll<array_t, inp_calc_t, out_calc_t, loader_t, storer_t, num_outputs>(
+    data, remaining, ic, oc, l, s);
+  elementwise_kernel_helper(f, policy);
+}
+
+template <int num_outputs, typename func_t, typename array_t, typename inp_calc_t, typename out_calc_t, typename loader_t, typename storer_t>
+static inline void launch_unrolled_kernel_for_multi_outputs(int64_t N, const func_t& f, array_t data,
+                                                            inp_calc_t ic, out_calc_t oc, loader_t l, storer_t s)
+{
+  TORCH_INTERNAL_ASSERT(N > 0 && N <= std::numeric_limits<int32_t>::max());
+  int64_t grid = (N + block_work_size - 1) / block_work_size;
+  auto stream = at::cuda::getCurrentCUDAStream();
+  unrolled_elementwise_kernel_for_multi_outputs<num_outputs, func_t, array_t>
+    <<<grid, num_threads, 0, stream>>>(N, f, data, ic, oc, l, s);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+// Compares the types of the outputs of a kernel with several outputs with the
+// dtypes of the outputs of the iterator, see needs_dynamic_casting.
+template <typename func_t, int nouts=thrust::tuple_size<typename function_traits<func_t>::result_type>::value>
+struct outputs_need_dynamic_casting {
+  static bool check(TensorIterator& iter) {
+    using cpp_type = typename thrust::tuple_element<nouts - 1, typename function_traits<func_t>::result_type>::type;
+    if (iter.dtype(nouts - 1) != cppmap::detail::CPPTypeToScalarType<cpp_type>::value()) {
+      return true;
+    }
+    return outputs_need_dynamic_casting<func_t, nouts - 1>::check(iter);
+  }
+};
+
+template <typename func_t>
+struct outputs_need_dynamic_casting<func_t, 0> {
+  static bool check(TensorIterator& iter) {
+    return inputs_need_dynamic_casting<func_t>::check(iter);
+  }
+};
+
+template <typename func_t>
+void gpu_kernel_multiple_outputs_impl(TensorIterator& iter, const func_t& f) {
+  using traits = function_traits<func_t>;
+  using output_t = typename traits::result_type;
+  constexpr int num_outputs = thrust::tuple_size<output_t>::value;
+  constexpr int num_inputs = traits::arity;
+  constexpr int ntensors = num_outputs + num_inputs;
+
+  TORCH_INTERNAL_ASSERT(iter.can_use_32bit_indexing());
+  TORCH_INTERNAL_ASSERT(iter.ninputs() == num_inputs);
+  TORCH_INTERNAL_ASSERT(iter.noutputs() == num_outputs);
+
+  at::detail::Array<char*, ntensors> data;
+  for (int i = 0; i < ntensors; i++) {
+    data[i] = (char*)iter.data_ptr(i);
+  }
+
+  int64_t numel = iter.numel();
+
+  // Contiguous tensors go through trivial offset calculators, which compile
+  // to coalesced unit-stride accesses.
+  auto launch = [&](auto loader, auto storer) {
+    if (iter.is_contiguous()) {
+      auto input_calc = TrivialOffsetCalculator<num_inputs>();
+      auto output_calc = TrivialOffsetCalculator<num_outputs>();
+      launch_unrolled_kernel_for_multi_outputs<num_outputs>(numel, f, data, input_calc, output_calc, loader, storer);
+    } else {
+      auto input_calc = make_input_offset_calculator<num_inputs, num_outputs>(iter);
+      auto output_calc = make_output_offset_calculator<num_outputs>(iter);
+      launch_unrolled_kernel_for_multi_outputs<num_outputs>(numel, f, data, input_calc, output_calc, loader, storer);
+    }
+  };
+
+  if (!outputs_need_dynamic_casting<func_t>::check(iter)) {
+    launch(memory::LoadWithoutCast(), memory::MultiOutputsStoreWithoutCast());
+  } else {
+    at::detail::Array<ScalarType, std::max<int>(num_inputs, 1)> input_dtypes;
+    for (int i = 0; i < num_inputs; i++) {
+      input_dtypes[i] = iter.input_dtype(i);
+    }
+    at::detail::Array<ScalarType, num_outputs> output_dtypes;
+    for (int i = 0; i < num_outputs; i++) {
+      output_dtypes[i] = iter.dtype(i);
+    }
+    launch(memory::LoadWithCast<num_inputs>(input_dtypes),
+           memory::MultiOutputsStoreWithCast<num_outputs>(output_dtypes));
+  }
+}
+
 template <typename func_t>
 void gpu_kernel_impl(TensorIterator& iter, const func_t& f) {
   using traits = function_traits<func_t>;
@@ -1,9 +1,402 @@
 #include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
 #include <ATen/LegacyTHFunctionsCUDA.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 
 namespace at {
 namespace native {
 
+namespace {
+
+// Channels-last depthwise convolution.
+//
+// In NHWC the channels of a pixel are contiguous, so consecutive threads take
+// consecutive channels of the same pixel and their loads are coalesced. The
+// neighbouring pixels read by the kernel taps are shared with the threads of
+// the nearby pixels through the L1 cache. The weight is transposed to
+// (kH * kW, output channels) so that it is read the same way.
+
+constexpr int kThreadsPerBlock = 256;
+
+// The weight gradient is computed by blocks of kGradWeightChannels channels
+// and kGradWeightRows rows of threads.
+constexpr int kGradWeightChannels = 32;
+constexpr int kGradWeightRows = 8;
+
+// Each thread computes vec_size consecutive output channels of an output
+// pixel, with vectorized loads and stores (e.g. of half2 for vec_size == 2).
+// vec_size > 1 requires a depthwise multiplier of 1.
+template <typename scalar_t, typename accscalar_t, int vec_size>
+__global__ void conv_depthwise2d_forward_channels_last_kernel(
+    const scalar_t* input,
+    scalar_t* output,
+    const scalar_t* weight,
+    const scalar_t* bias,
+    int64_t total_vecs,
+    int in_channels, int out_channels, int depthwise_multiplier,
+    int in_height, int in_width,
+    int out_height, int out_width,
+    int kernel_height, int kernel_width,
+    int stride_height, int stride_width,
+    int pad_height, int pad_width,
+    int dilation_height, int dilation_width) {
+  using vec_t = memory::aligned_vector<scalar_t, vec_size>;
+  const int channel_vecs = out_channels / vec_size;
+
+  for (int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
+       index < total_vecs;
+       index += blockDim.x * gridDim.x) {
+    const int oc = (index % channel_vecs) * vec_size;
+    const int64_t pixel = index / channel_vecs;
+    const int w = pixel % out_width;
+    const int h = (pixel / out_width) % out_height;
+    const int64_t n = pixel / out_width / out_height;
+
+    accscalar_t acc[vec_size];
+#pragma unroll
+    for (int v = 0; v < vec_size; ++v) {
+      acc[v] = bias != nullptr ? static_cast<accscalar_t>(bias[oc + v]) : accscalar_t(0);
+    }
+
+    for (int kh = 0; kh < kernel_height; ++kh) {
+      const int h_in = h * stride_height - pad_height + kh * dilation_height;
+      if (h_in < 0 || h_in >= in_height) {
+        continue;
+      }
+      for (int kw = 0; kw < kernel_width; ++kw) {
+        const int w_in = w * stride_width - pad_width + kw * dilation_width;
+        if (w_in < 0 || w_in >= in_width) {
+          continue;
+        }
+        const scalar_t* in_pixel = input + ((n * in_height + h_in) * in_width + w_in) * in_channels;
+        const vec_t weights = *reinterpret_cast<const vec_t*>(
+            weight + (kh * kernel_width + kw) * out_channels + oc);
+        if (vec_size > 1) {
+          const vec_t values = *reinterpret_cast<const vec_t*>(in_pixel + oc);
+#pragma unroll
+          for (int v = 0; v < vec_size; ++v) {
+            acc[v] += static_cast<accscalar_t>(weights.val[v]) * static_cast<accscalar_t>(values.val[v]);
+          }
+        } else {
+          acc[0] += static_cast<accscalar_t>(weights.val[0]) *
+              static_cast<accscalar_t>(in_pixel[oc / depthwise_multiplier]);
+        }
+      }
+    }
+
+    vec_t out;
+#pragma unroll
+    for (int v = 0; v < vec_size; ++v) {
+      out.val[v] = static_cast<scalar_t>(acc[v]);
+    }
+    *reinterpret_cast<vec_t*>(output + pixel * out_channels + oc) = out;
+  }
+}
+
+// One thread per input element.
+template <typename scalar_t, typename accscalar_t>
+__global__ void conv_depthwise2d_grad_input_channels_last_kernel(
+    const scalar_t* grad_output,
+    scalar_t* grad_input,
+    const scalar_t* weight,
+    int64_t total_elements,
+    int in_channels, int out_channels, int depthwise_multiplier,
+    int in_height, int in_width,
+    int out_height, int out_width,
+    int kernel_height, int kernel_width,
+    int stride_height, int stride_width,
+    int pad_height, int pad_width,
+    int dilation_height, int dilation_width) {
+  for (int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
+       index < total_elements;
+       index += blockDim.x * gridDim.x) {
+    const int c = index % in_channels;
+    const int64_t pixel = index / in_channels;
+    const int w = pixel % in_width;
+    const int h = (pixel / in_width) % in_height;
+    const int64_t n = pixel / in_width / in_height;
+
+    accscalar_t acc = 0;
+    for (int kh = 0; kh < kernel_height; ++kh) {
+      const int h_out_s = h + pad_height - kh * dilation_height;
+      if (h_out_s % stride_height != 0) {
+        continue;
+      }
+      const int h_out = h_out_s / stride_height;
+      if (h_out < 0 || h_out >= out_height) {
+        continue;
+      }
+      for (int kw = 0; kw < kernel_width; ++kw) {
+        const int w_out_s = w + pad_width - kw * dilation_width;
+        if (w_out_s % stride_width != 0) {
+          continue;
+        }
+        const int w_out = w_out_s / stride_width;
+        if (w_out < 0 || w_out >= out_width) {
+          continue;
+        }
+        const scalar_t* grad_pixel = grad_output + ((n * out_height + h_out) * out_width + w_out) * out_channels;
+        const scalar_t* weight_tap = weight + (kh * kernel_width + kw) * out_channels;
+        for (int m = 0; m < depthwise_multiplier; ++m) {
+          const int oc = c * depthwise_multiplier + m;
+          acc += static_cast<accscalar_t>(weight_tap[oc]) * static_cast<accscalar_t>(grad_pixel[oc]);
+        }
+      }
+    }
+    grad_input[index] = static_cast<scalar_t>(acc);
+  }
+}
+
+// First stage of the weight gradient. Block (x, y, z) sums the products for
+// tap z of kGradWeightChannels channels starting at x * kGradWeightChannels
+// over chunk y of the output pixels, each row of threads taking every
+// kGradWeightRows-th pixel of the chunk. The rows are then summed in shared
+// memory, and the second stage sums the chunks.
+template <typename scalar_t, typename accscalar_t>
+__global__ void conv_depthwise2d_grad_weight_channels_last_kernel(
+    const scalar_t* grad_output,
+    const scalar_t* input,
+    accscalar_t* partial_grad_weight,
+    int64_t num_pixels, int64_t pixels_per_chunk,
+    int in_channels, int out_channels, int depthwise_multiplier,
+    int in_height, int in_width,
+    int out_height, int out_width,
+    int kernel_width,
+    int stride_height, int stride_width,
+    int pad_height, int pad_width,
+    int dilation_height, int dilation_width) {
+  __shared__ accscalar_t sums[kGradWeightRows][kGradWeightChannels];
+
+  const int oc = blockIdx.x * kGradWeightChannels + threadIdx.x;
+  const int tap = blockIdx.z;
+  const int kh = tap / kernel_width;
+  const int kw = tap % kernel_width;
+  const int64_t chunk_start = blockIdx.y * pixels_per_chunk;
+  const int64_t chunk_end = chunk_start + pixels_per_chunk < num_pixels ? chunk_start + pixels_per_chunk : num_pixels;
+
+  accscalar_t acc = 0;
+  if (oc < out_channels) {
+    const int ic = oc / depthwise_multiplier;
+    for (int64_t pixel = chunk_start + threadIdx.y; pixel < chunk_end; pixel += kGradWeightRows) {
+      const int w = pixel % out_width;
+      const int h = (pixel / out_width) % out_height;
+      const int64_t n = pixel / out_width / out_height;
+      const int h_in = h * stride_height - pad_height + kh * dilation_height;
+      const int w_in = w * stride_width - pad_width + kw * dilation_width;
+      if (h_in >= 0 && h_in < in_height && w_in >= 0 && w_in < in_width) {
+        acc += static_cast<accscalar_t>(grad_output[pixel * out_channels + oc]) *
+            static_cast<accscalar_t>(input[((n * in_height + h_in) * in_width + w_in) * in_channels + ic]);
+      }
+    }
+  }
+  sums[threadIdx.y][threadIdx.x] = acc;
+  __syncthreads();
+
+  if (threadIdx.y == 0 && oc < out_channels) {
+    for (int row = 1; row < kGradWeightRows; ++row) {
+      acc += sums[row][threadIdx.x];
+    }
+    partial_grad_weight[(blockIdx.y * gridDim.z + tap) * out_channels + oc] = acc;
+  }
+}
+
+struct ConvDepthwise2dShape {
+  int batch_size;
+  int in_channels, out_channels, depthwise_multiplier;
+  int in_height, in_width;
+  int out_height, out_width;
+  int kernel_height, kernel_width;
+  int stride_height, stride_width;
+  int pad_height, pad_width;
+  int dilation_height, dilation_width;
+};
+
+ConvDepthwise2dShape conv_depthwise2d_shape(
+    const Tensor& input, const Tensor& weight,
+    IntArrayRef kernel_size, IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation) {
+  TORCH_CHECK(input.dim() == 4, "conv_depthwise2d: expected 4D input, but got ", input.dim(), "D");
+  TORCH_CHECK(weight.dim() == 4 && weight.size(1) == 1,
+              "conv_depthwise2d: expected weight of shape (out_channels, 1, kH, kW)");
+  TORCH_CHECK(weight.size(0) % input.size(1) == 0,
+              "conv_depthwise2d: the number of output channels must be a multiple of the number of input channels");
+  TORCH_CHECK(input.numel() <= std::numeric_limits<int>::max() / 2,
+              "conv_depthwise2d: input is too large");
+
+  ConvDepthwise2dShape shape;
+  shape.batch_size = input.size(0);
+  shape.in_channels = input.size(1);
+  shape.in_height = input.size(2);
+  shape.in_width = input.size(3);
+  shape.out_channels = weight.size(0);
+  shape.depthwise_multiplier = shape.out_channels / shape.in_channels;
+  shape.kernel_height = kernel_size[0];
+  shape.kernel_width = kernel_size[1];
+  shape.stride_height = stride[0];
+  shape.stride_width = stride[1];
+  shape.pad_height = padding[0];
+  shape.pad_width = padding[1];
+  shape.dilation_height = dilation[0];
+  shape.dilation_width = dilation[1];
+  shape.out_height = (shape.in_height + 2 * shape.pad_height -
+                      (shape.dilation_height * (shape.kernel_height - 1) + 1)) / shape.stride_height + 1;
+  shape.out_width = (shape.in_width + 2 * shape.pad_width -
+                     (shape.dilation_width * (shape.kernel_width - 1) + 1)) / shape.stride_width + 1;
+  return shape;
+}
+
+// (out_channels, 1, kH, kW) -> (kH * kW, out_channels)
+Tensor channels_last_depthwise_weight(const Tensor& weight) {
+  return weight.reshape({weight.size(0), -1}).t().contiguous();
+}
+
+int64_t depthwise_grid_size(int64_t total) {
+  const int64_t max_blocks = at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 32;
+  return std::min(max_blocks, (total + kThreadsPerBlock - 1) / kThreadsPerBlock);
+}
+
+void conv_depthwise2d_forward_channels_last(
+    Tensor& output, const Tensor& input_, const Tensor& weight, const Tensor& bias,
+    IntArrayRef kernel_size, IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation) {
+  const auto shape = conv_depthwise2d_shape(input_, weight, kernel_size, stride, padding, dilation);
+  Tensor input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+  Tensor weight_t = channels_last_depthwise_weight(weight);
+  Tensor bias_ = bias.defined() ? bias.contiguous() : bias;
+  output.resize_({shape.batch_size, shape.out_channels, shape.out_height, shape.out_width},
+                 at::MemoryFormat::ChannelsLast);
+  if (output.numel() == 0) {
+    return;
+  }
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.scalar_type(), "conv_depthwise2d_forward_channels_last", [&] {
+    using accscalar_t = at::acc_type<scalar_t, true>;
+    const scalar_t* input_ptr = input.data_ptr<scalar_t>();
+    scalar_t* output_ptr = output.data_ptr<scalar_t>();
+    const scalar_t* weight_ptr = weight_t.data_ptr<scalar_t>();
+    const scalar_t* bias_ptr = bias_.defined() ? bias_.data_ptr<scalar_t>() : nullptr;
+    auto stream = at::cuda::getCurrentCUDAStream();
+
+    const bool vectorize = shape.depthwise_multiplier == 1 && shape.out_channels % 2 == 0 &&
+        memory::can_vectorize_up_to<scalar_t>((char*)input_ptr) >= 2 &&
+        memory::can_vectorize_up_to<scalar_t>((char*)output_ptr) >= 2 &&
+        memory::can_vectorize_up_to<scalar_t>((char*)weight_ptr) >= 2;
+    const int64_t total_vecs = output.numel() / (vectorize ? 2 : 1);
+    const int64_t grid = depthwise_grid_size(total_vecs);
+    if (vectorize) {
+      conv_depthwise2d_forward_channels_last_kernel<scalar_t, accscalar_t, 2><<<grid, kThreadsPerBlock, 0, stream>>>(
+          input_ptr, output_ptr, weight_ptr, bias_ptr, total_vecs,
+          shape.in_channels, shape.out_channels, shape.depthwise_multiplier,
+          shape.in_height, shape.in_width, shape.out_height, shape.out_width,
+          shape.kernel_height, shape.kernel_width, shape.stride_height, shape.stride_width,
+          shape.pad_height, shape.pad_width, shape.dilation_height, shape.dilation_width);
+    } else {
+      conv_depthwise2d_forward_channels_last_kernel<scalar_t, accscalar_t, 1><<<grid, kThreadsPerBlock, 0, stream>>>(
+          input_ptr, output_ptr, weight_ptr, bias_ptr, total_vecs,
+          shape.in_channels, shape.out_channels, shape.depthwise_multiplier,
+          shape.in_height, shape.in_width, shape.out_height, shape.out_width,
+          shape.kernel_height, shape.kernel_width, shape.stride_height, shape.stride_width,
+          shape.pad_height, shape.pad_width, shape.dilation_height, shape.dilation_width);
+    }
+    AT_CUDA_CHECK(cudaGetLastError());
+  });
+}
+
+void conv_depthwise2d_backward_channels_last(
+    Tensor& grad_input, Tensor& grad_weight,
+    const Tensor& grad_output_, const Tensor& input_, const Tensor& weight,
+    IntArrayRef kernel_size, IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation) {
+  const auto shape = conv_depthwise2d_shape(input_, weight, kernel_size, stride, padding, dilation);
+  Tensor input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+  Tensor grad_output = grad_output_.contiguous(at::MemoryFormat::ChannelsLast);
+  const int taps = shape.kernel_height * shape.kernel_width;
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.scalar_type(), "conv_depthwise2d_backward_channels_last", [&] {
+    using accscalar_t = at::acc_type<scalar_t, true>;
+    auto stream = at::cuda::getCurrentCUDAStream();
+
+    if (grad_input.defined()) {
+      grad_input.resize_(input.sizes(), at::MemoryFormat::ChannelsLast);
+      if (grad_input.numel() != 0) {
+        Tensor weight_t = channels_last_depthwise_weight(weight);
+        const int64_t total = grad_input.numel();
+        conv_depthwise2d_grad_input_channels_last_kernel<scalar_t, accscalar_t>
+            <<<depthwise_grid_size(total), kThreadsPerBlock, 0, stream>>>(
+            grad_output.data_ptr<scalar_t>(), grad_input.data_ptr<scalar_t>(), weight_t.data_ptr<scalar_t>(),
+            total, shape.in_channels, shape.out_channels, shape.depthwise_multiplier,
+            shape.in_height, shape.in_width, shape.out_height, shape.out_width,
+            shape.kernel_height, shape.kernel_width, shape.stride_height, shape.stride_width,
+            shape.pad_height, shape.pad_width, shape.dilation_height, shape.dilation_width);
+        AT_CUDA_CHECK(cudaGetLastError());
+      }
+    }
+
+    if (grad_weight.defined()) {
+      // grad_weight has been zeroed by the caller.
+      const int64_t num_pixels = grad_output.numel() / shape.out_channels;
+      if (num_pixels == 0) {
+        return;
+      }
+      // Enough chunks of at least 64 pixels to give every SM a few blocks.
+      const int64_t channel_blocks = (shape.out_channels + kGradWeightChannels - 1) / kGradWeightChannels;
+      const int64_t target_blocks = at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 4;
+      int64_t num_chunks = std::max<int64_t>(1, std::min<int64_t>(
+          (num_pixels + 63) / 64, target_blocks / (channel_blocks * taps)));
+      const int64_t pixels_per_chunk = (num_pixels + num_chunks - 1) / num_chunks;
+      num_chunks = (num_pixels + pixels_per_chunk - 1) / pixels_per_chunk;
+
+      Tensor partial = at::empty({num_chunks, taps, shape.out_channels},
+                                 grad_output.options().dtype(caffe2::TypeMeta::Make<accscalar_t>()));
+      dim3 grid(channel_blocks, num_chunks, taps);
+      dim3 block(kGradWeightChannels, kGradWeightRows);
+      conv_depthwise2d_grad_weight_channels_last_kernel<scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
+          grad_output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), partial.data_ptr<accscalar_t>(),
+          num_pixels, pixels_per_chunk, shape.in_channels, shape.out_channels, shape.depthwise_multiplier,
+          shape.in_height, shape.in_width, shape.out_height, shape.out_width,
+          shape.kernel_width, shape.stride_height, shape.stride_width,
+          shape.pad_height, shape.pad_width, shape.dilation_height, shape.dilation_width);
+      AT_CUDA_CHECK(cudaGetLastError());
+
+      // Second stage: sum the chunks.
+      grad_weight.copy_(partial.sum(0).t().reshape(weight.sizes()));
+    }
+  });
+}
+
+} // namespace
+
+// NCHW inputs go through the THCUNN kernels, channels-last ones through the
+// kernels above.
+Tensor& thnn_conv_depthwise2d_forward_out_cuda(
+    Tensor& output,
+    const Tensor& self,
+    const Tensor& weight,
+    IntArrayRef kernel_size,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation) {
+  if (self.suggest_memory_format() != at::MemoryFormat::ChannelsLast) {
+    return legacy::cuda::_thnn_conv_depthwise2d_forward_out(output, self, weight,
+                                                            kernel_size, bias, stride, padding, dilation);
+  }
+  conv_depthwise2d_forward_channels_last(output, self, weight, bias, kernel_size, stride, padding, dilation);
+  return output;
+}
+
+Tensor thnn_conv_depthwise2d_forward_cuda(
+    const Tensor& self,
+    const Tensor& weight,
+    IntArrayRef kernel_size,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation) {
+  Tensor output = at::empty({0}, self.options());
+  return native::thnn_conv_depthwise2d_forward_out_cuda(output, self, weight,
+                                                        kernel_size, bias, stride, padding, dilation);
+}
+
 std::tuple<Tensor &,Tensor &> thnn_conv_depthwise2d_backward_out(
     Tensor & grad_input,
     Tensor & grad_weight,
@@ -19,6 +412,12 @@ std::tuple<Tensor &,Tensor &> thnn_conv_depthwise2d_backward_out(
     grad_weight.zero_();
   }
 
+  if (self.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    conv_depthwise2d_backward_channels_last(grad_input, grad_weight, grad_output, self, weight,
+                                            kernel_size, stride, padding, dilation);
+    return std::tuple<Tensor&, Tensor&>(grad_input, grad_weight);
+  }
+
   return legacy::cuda::_thnn_conv_depthwise2d_backward_out(grad_input, grad_weight,
                                                            grad_output, self, weight,
                                                            kernel_size, stride, padding, dilation);
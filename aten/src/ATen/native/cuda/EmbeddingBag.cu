@@ -29,6 +29,23 @@ constexpr int MODE_SUM = 0;
 constexpr int MODE_MEAN = 1;
 constexpr int MODE_MAX = 2;
 
+// Block of the kernels below, whose threads handle consecutive features of a bag along x and different bags along
+// y. x is the smallest power of two that covers the features, up to the warp size, so that embeddings smaller than
+// a warp share it between several bags instead of leaving most of its lanes idle.
+dim3 embedding_bag_block(int64_t featureSize) {
+#ifdef __HIP_PLATFORM_HCC__
+  constexpr int64_t maxBlockX = 64;
+#else
+  constexpr int64_t maxBlockX = 32;
+#endif
+  constexpr int64_t numThreads = 256;
+  int64_t blockX = maxBlockX;
+  while (blockX > 1 && blockX / 2 >= featureSize) {
+    blockX /= 2;
+  }
+  return dim3(blockX, numThreads / blockX);
+}
+
 // This kernel assumes that all input tensors except `weight` and
 // per_sample_weights are contiguous.
 template <typename scalar_t>
@@ -227,11 +244,7 @@ Tensor embedding_bag_backward_cuda_max(const Tensor &grad,
 
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
-#ifdef __HIP_PLATFORM_HCC__
-  dim3 block = dim3(64, 4);
-#else
-  dim3 block = dim3(32, 8);
-#endif
+  dim3 block = embedding_bag_block(stride);
   int grid = 1024;
 
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(
@@ -293,11 +306,7 @@ _embedding_bag_cuda(const Tensor &weight, const Tensor &indices,
     max_indices = at::empty({0}, indices.options());
   }
 
-#ifdef __HIP_PLATFORM_HCC__
-  dim3 block = dim3(64, 4);
-#else
-  dim3 block = dim3(32, 8);
-#endif
+  dim3 block = embedding_bag_block(featureSize);
   int grid = 1024;
   AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, weight.scalar_type(), "embedding_bag_cuda", [&] {
     AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "embedding_bag_cuda", [&] {
@@ -0,0 +1,322 @@
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/ForeachUtils.h>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
+#include <ATen/native/cuda/block_reduce.cuh>
+
+#include <limits>
+
+namespace at { namespace native {
+
+namespace {
+
+// Applies `op` elementwise to the first n_inputs lists of the metadata, and
+// writes the results to the last list. For in-place ops, depth == n_inputs
+// and the results overwrite the first list.
+template <typename scalar_t, int depth, int n_inputs, typename Op>
+struct ElementwiseFunctor {
+  using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+
+  Op op;
+  opmath_t scalar;
+
+  __device__ __forceinline__ void operator()(
+      int64_t chunk_size,
+      TensorListMetadata<depth>& tl) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t offset = chunk_idx * chunk_size;
+    const int64_t remaining = tl.numel_for_tensor[tensor_loc] - offset;
+    const int64_t n = remaining < chunk_size ? remaining : chunk_size;
+
+    scalar_t* inputs[n_inputs];
+    #pragma unroll
+    for (int k = 0; k < n_inputs; k++) {
+      inputs[k] = static_cast<scalar_t*>(tl.addresses[k][tensor_loc]) + offset;
+    }
+    scalar_t* out = static_cast<scalar_t*>(tl.addresses[depth - 1][tensor_loc]) + offset;
+
+    for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+      opmath_t args[n_inputs];
+      #pragma unroll
+      for (int k = 0; k < n_inputs; k++) {
+        args[k] = static_cast<opmath_t>(inputs[k][i]);
+      }
+      out[i] = static_cast<scalar_t>(op(args, scalar));
+    }
+  }
+};
+
+template <typename T> struct AddScalarOp {
+  __device__ __forceinline__ T operator()(const T* args, T scalar) const { return args[0] + scalar; }
+};
+template <typename T> struct MulScalarOp {
+  __device__ __forceinline__ T operator()(const T* args, T scalar) const { return args[0] * scalar; }
+};
+template <typename T> struct DivScalarOp {
+  __device__ __forceinline__ T operator()(const T* args, T scalar) const { return args[0] / scalar; }
+};
+// The scalar is alpha.
+template <typename T> struct AddListOp {
+  __device__ __forceinline__ T operator()(const T* args, T scalar) const { return args[0] + scalar * args[1]; }
+};
+template <typename T> struct SqrtOp {
+  __device__ __forceinline__ T operator()(const T* args, T /*unused*/) const { return ::sqrt(args[0]); }
+};
+// The scalar is value.
+template <typename T> struct AddcmulOp {
+  __device__ __forceinline__ T operator()(const T* args, T scalar) const { return args[0] + scalar * args[1] * args[2]; }
+};
+template <typename T> struct AddcdivOp {
+  __device__ __forceinline__ T operator()(const T* args, T scalar) const { return args[0] + scalar * args[1] / args[2]; }
+};
+
+template <int n_inputs, template <typename> class Op>
+void foreach_apply_(std::vector<std::vector<Tensor>>& tensor_lists, Scalar scalar) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, tensor_lists[0][0].scalar_type(), "foreach_apply_cuda_", [&]() {
+    using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    multi_tensor_apply<n_inputs>(
+        tensor_lists,
+        ElementwiseFunctor<scalar_t, n_inputs, n_inputs, Op<opmath_t>>{Op<opmath_t>(), scalar.to<opmath_t>()});
+  });
+}
+
+template <int n_inputs, template <typename> class Op>
+std::vector<Tensor> foreach_apply(std::vector<std::vector<Tensor>>& tensor_lists, Scalar scalar) {
+  std::vector<Tensor> result;
+  result.reserve(tensor_lists[0].size());
+  for (const auto& t : tensor_lists[0]) {
+    result.emplace_back(at::empty_like(t));
+  }
+  tensor_lists.emplace_back(result);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, tensor_lists[0][0].scalar_type(), "foreach_apply_cuda", [&]() {
+    using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    multi_tensor_apply<n_inputs + 1>(
+        tensor_lists,
+        ElementwiseFunctor<scalar_t, n_inputs + 1, n_inputs, Op<opmath_t>>{Op<opmath_t>(), scalar.to<opmath_t>()});
+  });
+  return result;
+}
+
+// Multiplies the tensors of the first list by the scalar that `scale` points
+// to, which lives on the device so that it can come from an earlier kernel
+// without a sync (e.g. the clip coefficient of clip_grad_norm_).
+template <typename scalar_t>
+struct ScaleByTensorFunctor {
+  using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+
+  const opmath_t* scale;
+
+  __device__ __forceinline__ void operator()(
+      int64_t chunk_size,
+      TensorListMetadata<1>& tl) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t offset = chunk_idx * chunk_size;
+    const int64_t remaining = tl.numel_for_tensor[tensor_loc] - offset;
+    const int64_t n = remaining < chunk_size ? remaining : chunk_size;
+
+    scalar_t* x = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    const opmath_t s = *scale;
+    for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+      x[i] = static_cast<scalar_t>(static_cast<opmath_t>(x[i]) * s);
+    }
+  }
+};
+
+enum class NormType { One, Two, Inf };
+
+template <typename T>
+struct MaxAbsReduceOp {
+  __device__ __forceinline__ T combine(T a, T b) const {
+    // propagates NaNs, like max()
+    return (a != a || a > b) ? a : b;
+  }
+  __device__ __forceinline__ T warp_shfl_down(T val, int offset) const {
+    return WARP_SHFL_DOWN(val, offset);
+  }
+};
+
+// Reduces each chunk of the tensors of the first list to the sum of |x| or
+// |x|^2, or to the max of |x|, which it writes to the chunk's slot of the
+// tensor's row of partial results in the second list. Unlike for the other
+// functors, the second list doesn't have the sizes of the first one: it has
+// one slot per chunk.
+template <typename scalar_t, NormType norm_type>
+struct NormPartialFunctor {
+  using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+
+  __device__ __forceinline__ void operator()(
+      int64_t chunk_size,
+      TensorListMetadata<2>& tl) {
+    __shared__ opmath_t shared[C10_WARP_SIZE];
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t offset = chunk_idx * chunk_size;
+    const int64_t remaining = tl.numel_for_tensor[tensor_loc] - offset;
+    const int64_t n = remaining < chunk_size ? remaining : chunk_size;
+
+    const scalar_t* x = static_cast<const scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    opmath_t* partial = static_cast<opmath_t*>(tl.addresses[1][tensor_loc]);
+
+    opmath_t acc = 0;
+    if (norm_type == NormType::Inf) {
+      MaxAbsReduceOp<opmath_t> op;
+      for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+        acc = op.combine(acc, ::abs(static_cast<opmath_t>(x[i])));
+      }
+      acc = cuda_utils::BlockReduce(acc, op, opmath_t(0), shared);
+    } else {
+      for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+        const opmath_t v = static_cast<opmath_t>(x[i]);
+        acc += norm_type == NormType::One ? ::abs(v) : v * v;
+      }
+      acc = cuda_utils::BlockReduceSum(acc, shared);
+    }
+    if (threadIdx.x == 0) {
+      partial[chunk_idx] = acc;
+    }
+  }
+};
+
+template <NormType norm_type>
+std::vector<Tensor> foreach_norm(TensorList tensors) {
+  int64_t max_chunks = 1;
+  for (const auto& t : tensors) {
+    max_chunks = std::max(max_chunks, (t.numel() + kChunkSize - 1) / kChunkSize);
+  }
+  const auto& first = tensors[0];
+  Tensor partials;
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, first.scalar_type(), "foreach_norm_cuda", [&]() {
+    using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    // Chunks past the end of a tensor, and empty tensors, keep their 0.
+    partials = at::zeros({static_cast<int64_t>(tensors.size()), max_chunks},
+                         first.options().dtype(caffe2::TypeMeta::Make<opmath_t>()));
+    std::vector<std::vector<Tensor>> tensor_lists{tensors.vec(), partials.unbind(0)};
+    multi_tensor_apply<2>(tensor_lists, NormPartialFunctor<scalar_t, norm_type>());
+  });
+
+  Tensor norms;
+  if (norm_type == NormType::Inf) {
+    norms = std::get<0>(partials.max(1));
+  } else if (norm_type == NormType::One) {
+    norms = partials.sum(1);
+  } else {
+    norms = partials.sum(1).sqrt_();
+  }
+  return norms.to(first.scalar_type()).unbind(0);
+}
+
+} // anonymous namespace
+
+#define FOREACH_BINARY_OP_SCALAR(NAME, OP)                                                            \
+std::vector<Tensor> foreach_tensor_##NAME##_scalar_kernel_cuda(TensorList tensors, Scalar scalar) {   \
+  check_foreach_api_restrictions(tensors);                                                            \
+  if (!can_use_fast_route({tensors}, scalar)) {                                                       \
+    return at::native::foreach_tensor_##NAME##_scalar_kernel_slow(tensors, scalar);                   \
+  }                                                                                                   \
+  std::vector<std::vector<Tensor>> tensor_lists{tensors.vec()};                                       \
+  return foreach_apply<1, OP>(tensor_lists, scalar);                                                  \
+}                                                                                                     \
+                                                                                                      \
+void foreach_tensor_##NAME##_scalar_kernel_cuda_(TensorList tensors, Scalar scalar) {                 \
+  check_foreach_api_restrictions(tensors);                                                            \
+  if (!can_use_fast_route({tensors}, scalar)) {                                                       \
+    return at::native::foreach_tensor_##NAME##_scalar_kernel_slow_(tensors, scalar);                  \
+  }                                                                                                   \
+  std::vector<std::vector<Tensor>> tensor_lists{tensors.vec()};                                       \
+  foreach_apply_<1, OP>(tensor_lists, scalar);                                                        \
+}
+
+FOREACH_BINARY_OP_SCALAR(add, AddScalarOp)
+FOREACH_BINARY_OP_SCALAR(mul, MulScalarOp)
+FOREACH_BINARY_OP_SCALAR(div, DivScalarOp)
+
+#undef FOREACH_BINARY_OP_SCALAR
+
+std::vector<Tensor> foreach_tensor_add_list_kernel_cuda(TensorList tensors1, TensorList tensors2, Scalar alpha) {
+  check_foreach_api_restrictions(tensors1, tensors2);
+  if (!can_use_fast_route({tensors1, tensors2}, alpha)) {
+    return at::native::foreach_tensor_add_list_kernel_slow(tensors1, tensors2, alpha);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{tensors1.vec(), tensors2.vec()};
+  return foreach_apply<2, AddListOp>(tensor_lists, alpha);
+}
+
+void foreach_tensor_add_list_kernel_cuda_(TensorList self, TensorList other, Scalar alpha) {
+  check_foreach_api_restrictions(self, other);
+  if (!can_use_fast_route({self, other}, alpha)) {
+    return at::native::foreach_tensor_add_list_kernel_slow_(self, other, alpha);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{self.vec(), other.vec()};
+  foreach_apply_<2, AddListOp>(tensor_lists, alpha);
+}
+
+std::vector<Tensor> foreach_tensor_sqrt_kernel_cuda(TensorList tensors) {
+  check_foreach_api_restrictions(tensors);
+  if (!can_use_fast_route({tensors})) {
+    return at::native::foreach_tensor_sqrt_kernel_slow(tensors);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{tensors.vec()};
+  return foreach_apply<1, SqrtOp>(tensor_lists, /*unused*/ 0);
+}
+
+void foreach_tensor_sqrt_kernel_cuda_(TensorList tensors) {
+  check_foreach_api_restrictions(tensors);
+  if (!can_use_fast_route({tensors})) {
+    return at::native::foreach_tensor_sqrt_kernel_slow_(tensors);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{tensors.vec()};
+  foreach_apply_<1, SqrtOp>(tensor_lists, /*unused*/ 0);
+}
+
+void foreach_tensor_addcmul_scalar_kernel_cuda_(TensorList self, TensorList tensors1, TensorList tensors2, Scalar value) {
+  check_foreach_api_restrictions(self, tensors1, tensors2);
+  if (!can_use_fast_route({self, tensors1, tensors2}, value)) {
+    return at::native::foreach_tensor_addcmul_scalar_kernel_slow_(self, tensors1, tensors2, value);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{self.vec(), tensors1.vec(), tensors2.vec()};
+  foreach_apply_<3, AddcmulOp>(tensor_lists, value);
+}
+
+void foreach_tensor_addcdiv_scalar_kernel_cuda_(TensorList self, TensorList tensors1, TensorList tensors2, Scalar value) {
+  check_foreach_api_restrictions(self, tensors1, tensors2);
+  if (!can_use_fast_route({self, tensors1, tensors2}, value)) {
+    return at::native::foreach_tensor_addcdiv_scalar_kernel_slow_(self, tensors1, tensors2, value);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{self.vec(), tensors1.vec(), tensors2.vec()};
+  foreach_apply_<3, AddcdivOp>(tensor_lists, value);
+}
+
+void foreach_tensor_mul_tensor_kernel_cuda_(TensorList tensors, const Tensor& other) {
+  check_foreach_api_restrictions(tensors);
+  check_foreach_scalar_tensor(other);
+  if (!can_use_fast_route({tensors}) || other.device() != tensors[0].device()) {
+    return at::native::foreach_tensor_mul_tensor_kernel_slow_(tensors, other);
+  }
+  std::vector<std::vector<Tensor>> tensor_lists{tensors.vec()};
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, tensors[0].scalar_type(), "foreach_mul_tensor_cuda_", [&]() {
+    using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    const Tensor scale = other.to(other.options().dtype(caffe2::TypeMeta::Make<opmath_t>()));
+    multi_tensor_apply<1>(tensor_lists, ScaleByTensorFunctor<scalar_t>{scale.data_ptr<opmath_t>()});
+  });
+}
+
+std::vector<Tensor> foreach_tensor_norm_cuda(TensorList tensors, Scalar ord) {
+  check_foreach_api_restrictions(tensors);
+  const double p = ord.toDouble();
+  if (!can_use_fast_route({tensors}) ||
+      !(p == 1 || p == 2 || p == std::numeric_limits<double>::infinity())) {
+    return at::native::foreach_tensor_norm_slow(tensors, ord);
+  }
+  if (p == 1) {
+    return foreach_norm<NormType::One>(tensors);
+  } else if (p == 2) {
+    return foreach_norm<NormType::Two>(tensors);
+  }
+  return foreach_norm<NormType::Inf>(tensors);
+}
+
+}} // namespace at::native
@@ -0,0 +1,260 @@
+#include <ATen/native/FusedCrossEntropy.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/cuda/block_reduce.cuh>
+#include <THC/THCDeviceUtils.cuh>
+
+#include <limits>
+#include <tuple>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// Each row is handled by a block, which reads it once: the max and the sum
+// of the exponentials are computed online, rescaling the sum when the max
+// changes.
+constexpr int kBlockNumThreads = 512;
+constexpr int kBackwardNumThreads = 256;
+
+template <typename acc_t>
+struct LogSumExpState {
+  acc_t max;
+  acc_t sum;
+};
+
+template <typename acc_t>
+struct LogSumExpOp {
+  __device__ __forceinline__ LogSumExpState<acc_t> combine(
+      LogSumExpState<acc_t> a,
+      LogSumExpState<acc_t> b) const {
+    const acc_t max = a.max < b.max ? b.max : a.max;
+    if (max == -std::numeric_limits<acc_t>::infinity()) {
+      return {max, acc_t(0)};
+    }
+    return {max, a.sum * std::exp(a.max - max) + b.sum * std::exp(b.max - max)};
+  }
+
+  __device__ __forceinline__ LogSumExpState<acc_t> warp_shfl_down(
+      LogSumExpState<acc_t> val,
+      int offset) const {
+    return {WARP_SHFL_DOWN(val.max, offset), WARP_SHFL_DOWN(val.sum, offset)};
+  }
+};
+
+template <typename scalar_t, typename acc_t>
+C10_LAUNCH_BOUNDS_1(kBlockNumThreads)
+__global__ void fused_cross_entropy_kernel(
+    const scalar_t* __restrict__ input,
+    const int64_t* __restrict__ target,
+    const scalar_t* __restrict__ weight,
+    const acc_t* __restrict__ weight_sum,
+    int64_t C,
+    int64_t ignore_index,
+    acc_t eps,
+    acc_t* __restrict__ losses,
+    acc_t* __restrict__ row_weights,
+    acc_t* __restrict__ lse) {
+  __shared__ LogSumExpState<acc_t> lse_shared[C10_WARP_SIZE];
+  __shared__ acc_t sum_shared[C10_WARP_SIZE];
+  const int64_t i = blockIdx.x;
+  const scalar_t* x = input + i * C;
+
+  LogSumExpState<acc_t> state{-std::numeric_limits<acc_t>::infinity(), acc_t(0)};
+  acc_t weighted_x_sum = 0;
+  for (int64_t c = threadIdx.x; c < C; c += blockDim.x) {
+    const acc_t v = static_cast<acc_t>(x[c]);
+    if (v > state.max) {
+      state.sum = state.sum * std::exp(state.max - v) + acc_t(1);
+      state.max = v;
+    } else if (v != -std::numeric_limits<acc_t>::infinity()) {
+      state.sum += std::exp(v - state.max);
+    }
+    if (eps != 0) {
+      weighted_x_sum += weight == nullptr ? v : static_cast<acc_t>(weight[c]) * v;
+    }
+  }
+  const LogSumExpState<acc_t> identity{
+      -std::numeric_limits<acc_t>::infinity(), acc_t(0)};
+  state = cuda_utils::BlockReduce(state, LogSumExpOp<acc_t>(), identity, lse_shared);
+  if (eps != 0) {
+    weighted_x_sum = cuda_utils::BlockReduceSum(weighted_x_sum, sum_shared);
+  }
+
+  if (threadIdx.x == 0) {
+    const acc_t row_lse = state.max + std::log(state.sum);
+    lse[i] = row_lse;
+    const int64_t t = target[i];
+    if (t == ignore_index) {
+      losses[i] = 0;
+      row_weights[i] = 0;
+      return;
+    }
+    CUDA_KERNEL_ASSERT(t >= 0 && t < C);
+    const acc_t w_t = weight == nullptr ? acc_t(1) : static_cast<acc_t>(weight[t]);
+    acc_t loss = -(1 - eps) * w_t * (static_cast<acc_t>(x[t]) - row_lse);
+    if (eps != 0) {
+      const acc_t W = weight_sum == nullptr ? static_cast<acc_t>(C) : *weight_sum;
+      loss -= eps / C * (weighted_x_sum - row_lse * W);
+    }
+    losses[i] = loss;
+    row_weights[i] = w_t;
+  }
+}
+
+template <typename scalar_t, typename acc_t>
+C10_LAUNCH_BOUNDS_1(kBackwardNumThreads)
+__global__ void fused_cross_entropy_backward_kernel(
+    const acc_t* __restrict__ grad_scale,
+    const scalar_t* __restrict__ input,
+    const int64_t* __restrict__ target,
+    const scalar_t* __restrict__ weight,
+    const acc_t* __restrict__ weight_sum,
+    const acc_t* __restrict__ lse,
+    int64_t N,
+    int64_t C,
+    int64_t ignore_index,
+    acc_t eps,
+    scalar_t* __restrict__ grad_input) {
+  const acc_t W = weight_sum == nullptr ? static_cast<acc_t>(C) : *weight_sum;
+  const int64_t numel = N * C;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+       idx < numel;
+       idx += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    const int64_t i = idx / C;
+    const int64_t c = idx - i * C;
+    const int64_t t = target[i];
+    if (t == ignore_index) {
+      grad_input[idx] = scalar_t(0);
+      continue;
+    }
+    CUDA_KERNEL_ASSERT(t >= 0 && t < C);
+    const acc_t w_t = weight == nullptr ? acc_t(1) : static_cast<acc_t>(weight[t]);
+    const acc_t softmax_coef = (1 - eps) * w_t + eps / C * W;
+    acc_t d = softmax_coef * std::exp(static_cast<acc_t>(input[idx]) - lse[i]);
+    if (eps != 0) {
+      d -= eps / C * (weight == nullptr ? acc_t(1) : static_cast<acc_t>(weight[c]));
+    }
+    if (c == t) {
+      d -= (1 - eps) * w_t;
+    }
+    grad_input[idx] = static_cast<scalar_t>(grad_scale[i] * d);
+  }
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor, Tensor> fused_cross_entropy_cuda(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight /* optional */,
+    int64_t reduction,
+    int64_t ignore_index,
+    double label_smoothing) {
+  check_fused_cross_entropy_inputs(self, target, weight, label_smoothing);
+  const Tensor input = self.contiguous();
+  const Tensor target_ = target.contiguous();
+  const Tensor weight_ = weight.defined() ? weight.contiguous() : weight;
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  Tensor output, lse, total_weight;
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      self.scalar_type(),
+      "fused_cross_entropy_cuda",
+      [&] {
+        using acc_t = acc_type<scalar_t, true>;
+        const auto acc_options =
+            self.options().dtype(caffe2::TypeMeta::Make<acc_t>());
+        Tensor losses = at::empty({N}, acc_options);
+        Tensor row_weights = at::empty({N}, acc_options);
+        lse = at::empty({N}, acc_options);
+        if (N > 0) {
+          const Tensor weight_sum = weight_.defined()
+              ? weight_.sum(typeMetaToScalarType(acc_options.dtype()))
+              : Tensor();
+          fused_cross_entropy_kernel<scalar_t, acc_t>
+              <<<N, kBlockNumThreads, 0, at::cuda::getCurrentCUDAStream()>>>(
+                  input.data_ptr<scalar_t>(),
+                  target_.data_ptr<int64_t>(),
+                  weight_.defined() ? weight_.data_ptr<scalar_t>() : nullptr,
+                  weight_sum.defined() ? weight_sum.data_ptr<acc_t>() : nullptr,
+                  C,
+                  ignore_index,
+                  static_cast<acc_t>(label_smoothing),
+                  losses.data_ptr<acc_t>(),
+                  row_weights.data_ptr<acc_t>(),
+                  lse.data_ptr<acc_t>());
+          AT_CUDA_CHECK(cudaGetLastError());
+        }
+        output = fused_cross_entropy_reduce(
+            losses, row_weights, reduction, self.scalar_type(), total_weight);
+      });
+  return std::make_tuple(output, lse, total_weight);
+}
+
+Tensor fused_cross_entropy_backward_cuda(
+    const Tensor& grad_output,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight /* optional */,
+    int64_t reduction,
+    int64_t ignore_index,
+    double label_smoothing,
+    const Tensor& lse,
+    const Tensor& total_weight) {
+  check_fused_cross_entropy_inputs(self, target, weight, label_smoothing);
+  const Tensor input = self.contiguous();
+  const Tensor target_ = target.contiguous();
+  const Tensor weight_ = weight.defined() ? weight.contiguous() : weight;
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  Tensor grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (grad_input.numel() == 0) {
+    return grad_input;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      self.scalar_type(),
+      "fused_cross_entropy_backward_cuda",
+      [&] {
+        using acc_t = acc_type<scalar_t, true>;
+        const ScalarType acc_scalar_type =
+            typeMetaToScalarType(caffe2::TypeMeta::Make<acc_t>());
+        const Tensor grad_scale = fused_cross_entropy_grad_scale(
+            grad_output, total_weight, reduction, N, acc_scalar_type);
+        const Tensor lse_ = lse.to(acc_scalar_type).contiguous();
+        const Tensor weight_sum = weight_.defined()
+            ? weight_.sum(acc_scalar_type)
+            : Tensor();
+        const int64_t numel = N * C;
+        const int64_t blocks = std::min<int64_t>(
+            (numel + kBackwardNumThreads - 1) / kBackwardNumThreads,
+            at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 32);
+        fused_cross_entropy_backward_kernel<scalar_t, acc_t>
+            <<<blocks, kBackwardNumThreads, 0, at::cuda::getCurrentCUDAStream()>>>(
+                grad_scale.data_ptr<acc_t>(),
+                input.data_ptr<scalar_t>(),
+                target_.data_ptr<int64_t>(),
+                weight_.defined() ? weight_.data_ptr<scalar_t>() : nullptr,
+                weight_sum.defined() ? weight_sum.data_ptr<acc_t>() : nullptr,
+                lse_.data_ptr<acc_t>(),
+                N,
+                C,
+                ignore_index,
+                static_cast<acc_t>(label_smoothing),
+                grad_input.data_ptr<scalar_t>());
+        AT_CUDA_CHECK(cudaGetLastError());
+      });
+  return grad_input;
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,248 @@
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/ForeachUtils.h>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
+
+// Multi-tensor SGD and Adam steps, which update all the parameters of a list
+// with a single kernel launch.
+//
+// The steps take an optional found_inf, the one-element float tensor written
+// by _amp_foreach_non_finite_check_and_unscale_. If it is nonzero the kernels
+// return without touching the parameters or the optimizer state, so a
+// GradScaler can skip the step without reading found_inf on the host.
+
+namespace at { namespace native {
+
+namespace {
+
+__device__ __forceinline__ bool skip_step(const float* found_inf) {
+  return found_inf != nullptr && *found_inf != 0.f;
+}
+
+// Lists: params, grads and, with momentum, momentum buffers.
+template <typename scalar_t, int depth>
+struct FusedSgdFunctor {
+  using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+
+  opmath_t lr;
+  opmath_t momentum;
+  opmath_t dampening;
+  opmath_t weight_decay;
+  bool nesterov;
+  bool is_first_step;
+  const float* found_inf;
+
+  __device__ __forceinline__ void operator()(
+      int64_t chunk_size,
+      TensorListMetadata<depth>& tl) {
+    if (skip_step(found_inf)) {
+      return;
+    }
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t offset = chunk_idx * chunk_size;
+    const int64_t remaining = tl.numel_for_tensor[tensor_loc] - offset;
+    const int64_t n = remaining < chunk_size ? remaining : chunk_size;
+
+    scalar_t* param = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    const scalar_t* grad = static_cast<scalar_t*>(tl.addresses[1][tensor_loc]) + offset;
+    scalar_t* buf = depth == 3
+        ? static_cast<scalar_t*>(tl.addresses[depth - 1][tensor_loc]) + offset
+        : nullptr;
+
+    for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+      const opmath_t p = static_cast<opmath_t>(param[i]);
+      opmath_t d_p = static_cast<opmath_t>(grad[i]);
+      if (weight_decay != 0) {
+        d_p += weight_decay * p;
+      }
+      if (depth == 3) {
+        const opmath_t b = is_first_step
+            ? d_p
+            : momentum * static_cast<opmath_t>(buf[i]) + (1 - dampening) * d_p;
+        buf[i] = static_cast<scalar_t>(b);
+        d_p = nesterov ? d_p + momentum * b : b;
+      }
+      param[i] = static_cast<scalar_t>(p - lr * d_p);
+    }
+  }
+};
+
+// Lists: params, grads, exp_avgs, exp_avg_sqs and steps. The steps are
+// one-element float tensors holding the number of steps taken so far, which
+// are read by every block of their parameter, so they are incremented by a
+// separate launch of FusedStepIncrementFunctor afterwards.
+template <typename scalar_t>
+struct FusedAdamFunctor {
+  using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+
+  opmath_t lr;
+  opmath_t beta1;
+  opmath_t beta2;
+  opmath_t eps;
+  opmath_t weight_decay;
+  bool adamw;
+  const float* found_inf;
+
+  __device__ __forceinline__ void operator()(
+      int64_t chunk_size,
+      TensorListMetadata<5>& tl) {
+    if (skip_step(found_inf)) {
+      return;
+    }
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int64_t chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int64_t offset = chunk_idx * chunk_size;
+    const int64_t remaining = tl.numel_for_tensor[tensor_loc] - offset;
+    const int64_t n = remaining < chunk_size ? remaining : chunk_size;
+
+    scalar_t* param = static_cast<scalar_t*>(tl.addresses[0][tensor_loc]) + offset;
+    const scalar_t* grad = static_cast<scalar_t*>(tl.addresses[1][tensor_loc]) + offset;
+    scalar_t* exp_avg = static_cast<scalar_t*>(tl.addresses[2][tensor_loc]) + offset;
+    scalar_t* exp_avg_sq = static_cast<scalar_t*>(tl.addresses[3][tensor_loc]) + offset;
+    // Not offset: the step tensors have a single element.
+    const opmath_t step = static_cast<opmath_t>(
+        *static_cast<const float*>(tl.addresses[4][tensor_loc])) + 1;
+
+    const opmath_t bias_correction1 = 1 - ::pow(beta1, step);
+    const opmath_t bias_correction2_sqrt = ::sqrt(1 - ::pow(beta2, step));
+    const opmath_t step_size = lr / bias_correction1;
+
+    for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+      opmath_t p = static_cast<opmath_t>(param[i]);
+      opmath_t g = static_cast<opmath_t>(grad[i]);
+      if (adamw) {
+        p *= 1 - lr * weight_decay;
+      } else if (weight_decay != 0) {
+        g += weight_decay * p;
+      }
+      const opmath_t m = beta1 * static_cast<opmath_t>(exp_avg[i]) + (1 - beta1) * g;
+      const opmath_t v = beta2 * static_cast<opmath_t>(exp_avg_sq[i]) + (1 - beta2) * g * g;
+      exp_avg[i] = static_cast<scalar_t>(m);
+      exp_avg_sq[i] = static_cast<scalar_t>(v);
+      const opmath_t denom = ::sqrt(v) / bias_correction2_sqrt + eps;
+      param[i] = static_cast<scalar_t>(p - step_size * m / denom);
+    }
+  }
+};
+
+// Lists: steps. Each step has a single chunk, hence a single block.
+struct FusedStepIncrementFunctor {
+  const float* found_inf;
+
+  __device__ __forceinline__ void operator()(
+      int64_t /*chunk_size*/,
+      TensorListMetadata<1>& tl) {
+    if (threadIdx.x != 0 || skip_step(found_inf)) {
+      return;
+    }
+    *static_cast<float*>(tl.addresses[0][tl.block_to_tensor[blockIdx.x]]) += 1.f;
+  }
+};
+
+const float* found_inf_ptr(const Tensor& found_inf, const Tensor& param) {
+  if (!found_inf.defined()) {
+    return nullptr;
+  }
+  TORCH_CHECK(found_inf.numel() == 1 && found_inf.scalar_type() == kFloat,
+              "found_inf must be a 1-element float tensor.");
+  TORCH_CHECK(found_inf.device() == param.device(),
+              "found_inf must be on the device of the parameters, ", param.device(),
+              ", but got ", found_inf.device());
+  return found_inf.data_ptr<float>();
+}
+
+} // anonymous namespace
+
+void fused_sgd_cuda_(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool is_first_step,
+    const Tensor& found_inf /* optional */) {
+  check_foreach_api_restrictions(params, grads);
+  TORCH_CHECK(momentum == 0 || momentum_buffers.size() == params.size(),
+              "_fused_sgd_: expected a momentum buffer for each parameter.");
+  if (momentum != 0) {
+    check_foreach_api_restrictions(params, momentum_buffers);
+  }
+  TORCH_CHECK(can_use_fast_route({params, grads, momentum_buffers}),
+              "_fused_sgd_: expected dense, contiguous CUDA tensors of a single floating point ",
+              "dtype and device.");
+  const float* found_inf_data = found_inf_ptr(found_inf, params[0]);
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, params[0].scalar_type(), "fused_sgd_cuda_", [&]() {
+    using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    if (momentum != 0) {
+      std::vector<std::vector<Tensor>> tensor_lists{params.vec(), grads.vec(), momentum_buffers.vec()};
+      multi_tensor_apply<3>(
+          tensor_lists,
+          FusedSgdFunctor<scalar_t, 3>{
+              static_cast<opmath_t>(lr), static_cast<opmath_t>(momentum),
+              static_cast<opmath_t>(dampening), static_cast<opmath_t>(weight_decay),
+              nesterov, is_first_step, found_inf_data});
+    } else {
+      std::vector<std::vector<Tensor>> tensor_lists{params.vec(), grads.vec()};
+      multi_tensor_apply<2>(
+          tensor_lists,
+          FusedSgdFunctor<scalar_t, 2>{
+              static_cast<opmath_t>(lr), opmath_t(0), opmath_t(0),
+              static_cast<opmath_t>(weight_decay), false, false, found_inf_data});
+    }
+  });
+}
+
+void fused_adam_cuda_(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList steps,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    bool adamw,
+    const Tensor& found_inf /* optional */) {
+  check_foreach_api_restrictions(params, grads, exp_avgs);
+  check_foreach_api_restrictions(params, exp_avg_sqs);
+  TORCH_CHECK(steps.size() == params.size(),
+              "_fused_adam_: expected a step tensor for each parameter.");
+  TORCH_CHECK(can_use_fast_route({params, grads, exp_avgs, exp_avg_sqs}),
+              "_fused_adam_: expected dense, contiguous CUDA tensors of a single floating point ",
+              "dtype and device.");
+  for (const auto& step : steps) {
+    TORCH_CHECK(step.numel() == 1 && step.scalar_type() == kFloat &&
+                step.device() == params[0].device(),
+                "_fused_adam_: expected the steps to be 1-element float tensors on ",
+                params[0].device());
+  }
+  const float* found_inf_data = found_inf_ptr(found_inf, params[0]);
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, params[0].scalar_type(), "fused_adam_cuda_", [&]() {
+    using opmath_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    std::vector<std::vector<Tensor>> tensor_lists{
+        params.vec(), grads.vec(), exp_avgs.vec(), exp_avg_sqs.vec(), steps.vec()};
+    multi_tensor_apply<5>(
+        tensor_lists,
+        FusedAdamFunctor<scalar_t>{
+            static_cast<opmath_t>(lr), static_cast<opmath_t>(beta1),
+            static_cast<opmath_t>(beta2), static_cast<opmath_t>(eps),
+            static_cast<opmath_t>(weight_decay), adamw, found_inf_data});
+  });
+
+  // Zero-size parameters are skipped by multi_tensor_apply, but their steps
+  // are still counted.
+  std::vector<std::vector<Tensor>> step_lists{steps.vec()};
+  multi_tensor_apply<1>(step_lists, FusedStepIncrementFunctor{found_inf_data});
+}
+
+}} // namespace at::native
@@ -459,6 +459,13 @@ Tensor& index_add_cuda_(Tensor & self, int64_t dim, const Tensor & index, const
   if (sliceSize == 0) {
     return self;
   }
+  if (use_sorted_accumulate(numIndex, selfAddDimSize)) {
+    // self_.index_add_(dim, index, source_) is self_[:, ..., :, index] += source_ with index at position dim
+    std::vector<Tensor> indices(dim + 1);
+    indices[dim] = index.reshape(-1);
+    index_put_accum_kernel(self_, indices, source_, /*unsafe=*/false);
+    return self;
+  }
   const cudaStream_t stream = at::cuda::getCurrentCUDAStream();
   bool indContig = index.is_contiguous();
 
@@ -0,0 +1,629 @@
+#include <ATen/native/MaskedSoftmaxDropout.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/WrapDimUtils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
+#include <ATen/native/cuda/MemoryAccess.cuh>
+#include <ATen/native/cuda/block_reduce.cuh>
+#include <THC/THCDeviceUtils.cuh>
+
+#include <initializer_list>
+#include <limits>
+#include <mutex>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// Rows of up to kMaxWarpVecs * C10_WARP_SIZE vectors of 4 elements are
+// handled by a single warp, which keeps them in registers. Longer rows are
+// handled by a block of kBlockNumThreads threads, which reads them again in
+// each pass.
+constexpr int kWarpsPerBlock = 4;
+constexpr int kMaxWarpVecs = 8;
+constexpr int kBlockNumThreads = 256;
+
+template <typename T>
+__device__ __forceinline__ T WarpAllReduceMax(T val) {
+#pragma unroll
+  for (int offset = (C10_WARP_SIZE >> 1); offset > 0; offset >>= 1) {
+    const T other = WARP_SHFL_XOR(val, offset);
+    val = val < other ? other : val;
+  }
+  return val;
+}
+
+template <typename T>
+__device__ __forceinline__ T WarpAllReduceSum(T val) {
+#pragma unroll
+  for (int offset = (C10_WARP_SIZE >> 1); offset > 0; offset >>= 1) {
+    val += WARP_SHFL_XOR(val, offset);
+  }
+  return val;
+}
+
+template <typename T>
+struct MaxOp {
+  __device__ __forceinline__ T combine(T a, T b) const {
+    return a < b ? b : a;
+  }
+  __device__ __forceinline__ T warp_shfl_down(T val, int offset) const {
+    return WARP_SHFL_DOWN(val, offset);
+  }
+};
+
+// Returns to all threads of the block the max or the sum of val.
+template <typename T>
+__device__ T BlockAllReduceMax(T val) {
+  __shared__ T shared[C10_WARP_SIZE];
+  val = cuda_utils::BlockReduce(
+      val, MaxOp<T>(), -std::numeric_limits<T>::infinity(), shared);
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    shared[0] = val;
+  }
+  __syncthreads();
+  return shared[0];
+}
+
+template <typename T>
+__device__ T BlockAllReduceSum(T val) {
+  __shared__ T shared[C10_WARP_SIZE];
+  val = cuda_utils::BlockReduceSum<T>(val, shared);
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    shared[0] = val;
+  }
+  __syncthreads();
+  return shared[0];
+}
+
+// Loads and stores elements 4 * j4 to 4 * j4 + 3 of a row of N elements.
+template <typename scalar_t, bool kVectorized>
+__device__ __forceinline__ memory::aligned_vector<scalar_t, 4> load4(
+    const scalar_t* row,
+    int64_t j4,
+    int64_t N) {
+  using Vec = memory::aligned_vector<scalar_t, 4>;
+  if (kVectorized) {
+    return reinterpret_cast<const Vec*>(row)[j4];
+  }
+  Vec v;
+#pragma unroll
+  for (int k = 0; k < 4; ++k) {
+    const int64_t j = j4 * 4 + k;
+    v.val[k] = j < N ? row[j] : scalar_t(0);
+  }
+  return v;
+}
+
+template <typename scalar_t, bool kVectorized>
+__device__ __forceinline__ void store4(
+    const memory::aligned_vector<scalar_t, 4>& v,
+    scalar_t* row,
+    int64_t j4,
+    int64_t N) {
+  using Vec = memory::aligned_vector<scalar_t, 4>;
+  if (kVectorized) {
+    reinterpret_cast<Vec*>(row)[j4] = v;
+    return;
+  }
+#pragma unroll
+  for (int k = 0; k < 4; ++k) {
+    const int64_t j = j4 * 4 + k;
+    if (j < N) {
+      row[j] = v.val[k];
+    }
+  }
+}
+
+// Masked input of elements 4 * j4 to 4 * j4 + 3, which is -inf for masked
+// elements and past the end of the row.
+template <typename scalar_t, bool kVectorized, typename acc_t>
+__device__ __forceinline__ void load_masked4(
+    const scalar_t* x,
+    const bool* m,
+    int64_t mask_stride,
+    int64_t j4,
+    int64_t N,
+    acc_t out[4]) {
+  const auto v = load4<scalar_t, kVectorized>(x, j4, N);
+#pragma unroll
+  for (int k = 0; k < 4; ++k) {
+    const int64_t j = j4 * 4 + k;
+    out[k] = (j >= N || (m != nullptr && m[j * mask_stride]))
+        ? -std::numeric_limits<acc_t>::infinity()
+        : static_cast<acc_t>(v.val[k]);
+  }
+}
+
+// Writes the seed and offset of the kernel to rng_state for the backward,
+// see MaskedSoftmaxDropout.h.
+__device__ __forceinline__ void save_rng_state(
+    uint64_t seed,
+    uint64_t offset,
+    int64_t* rng_state) {
+  if (blockIdx.x == 0 && threadIdx.x == 0 && threadIdx.y == 0) {
+    rng_state[0] = static_cast<int64_t>(seed);
+    rng_state[1] = static_cast<int64_t>(offset);
+  }
+}
+
+template <typename scalar_t, int kVecs, bool kVectorized>
+__global__ void masked_softmax_dropout_warp_kernel(
+    int64_t M,
+    int64_t N,
+    const scalar_t* input,
+    const bool* mask,
+    const int64_t* mask_offsets,
+    int64_t mask_stride,
+    uint64_t threshold,
+    acc_type<scalar_t, true> scale,
+    PhiloxCudaState philox_args,
+    int64_t* rng_state,
+    scalar_t* output,
+    scalar_t* softmax) {
+  using acc_t = acc_type<scalar_t, true>;
+  using Vec = memory::aligned_vector<scalar_t, 4>;
+  uint64_t seed;
+  uint64_t offset;
+  at::cuda::philox::unpack(philox_args, seed, offset);
+  save_rng_state(seed, offset, rng_state);
+  const int64_t i =
+      static_cast<int64_t>(blockIdx.x) * blockDim.y + threadIdx.y;
+  if (i >= M) {
+    return;
+  }
+  const scalar_t* x = input + i * N;
+  const bool* m = mask == nullptr ? nullptr : mask + mask_offsets[i];
+  acc_t vals[kVecs][4];
+  acc_t max = -std::numeric_limits<acc_t>::infinity();
+#pragma unroll
+  for (int v = 0; v < kVecs; ++v) {
+    const int64_t j4 = threadIdx.x + v * C10_WARP_SIZE;
+    if (j4 * 4 < N) {
+      load_masked4<scalar_t, kVectorized>(x, m, mask_stride, j4, N, vals[v]);
+    } else {
+#pragma unroll
+      for (int k = 0; k < 4; ++k) {
+        vals[v][k] = -std::numeric_limits<acc_t>::infinity();
+      }
+    }
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      max = max < vals[v][k] ? vals[v][k] : max;
+    }
+  }
+  max = WarpAllReduceMax(max);
+  acc_t sum = 0;
+#pragma unroll
+  for (int v = 0; v < kVecs; ++v) {
+    const int64_t j4 = threadIdx.x + v * C10_WARP_SIZE;
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      vals[v][k] = j4 * 4 + k < N ? std::exp(vals[v][k] - max) : acc_t(0);
+      sum += vals[v][k];
+    }
+  }
+  sum = WarpAllReduceSum(sum);
+#pragma unroll
+  for (int v = 0; v < kVecs; ++v) {
+    const int64_t j4 = threadIdx.x + v * C10_WARP_SIZE;
+    if (j4 * 4 < N) {
+      bool keep[4];
+      masked_softmax_dropout_keep4(seed, offset, i, j4, threshold, keep);
+      Vec s;
+      Vec y;
+#pragma unroll
+      for (int k = 0; k < 4; ++k) {
+        const acc_t s_v = vals[v][k] / sum;
+        s.val[k] = static_cast<scalar_t>(s_v);
+        y.val[k] = static_cast<scalar_t>(keep[k] ? s_v * scale : acc_t(0));
+      }
+      store4<scalar_t, kVectorized>(s, softmax + i * N, j4, N);
+      store4<scalar_t, kVectorized>(y, output + i * N, j4, N);
+    }
+  }
+}
+
+template <typename scalar_t, bool kVectorized>
+__global__ void masked_softmax_dropout_block_kernel(
+    int64_t N,
+    const scalar_t* input,
+    const bool* mask,
+    const int64_t* mask_offsets,
+    int64_t mask_stride,
+    uint64_t threshold,
+    acc_type<scalar_t, true> scale,
+    PhiloxCudaState philox_args,
+    int64_t* rng_state,
+    scalar_t* output,
+    scalar_t* softmax) {
+  using acc_t = acc_type<scalar_t, true>;
+  using Vec = memory::aligned_vector<scalar_t, 4>;
+  uint64_t seed;
+  uint64_t offset;
+  at::cuda::philox::unpack(philox_args, seed, offset);
+  save_rng_state(seed, offset, rng_state);
+  const int64_t i = blockIdx.x;
+  const int64_t num_vecs = (N + 3) / 4;
+  const scalar_t* x = input + i * N;
+  const bool* m = mask == nullptr ? nullptr : mask + mask_offsets[i];
+  acc_t vals[4];
+  acc_t max = -std::numeric_limits<acc_t>::infinity();
+  for (int64_t j4 = threadIdx.x; j4 < num_vecs; j4 += blockDim.x) {
+    load_masked4<scalar_t, kVectorized>(x, m, mask_stride, j4, N, vals);
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      max = max < vals[k] ? vals[k] : max;
+    }
+  }
+  max = BlockAllReduceMax(max);
+  acc_t sum = 0;
+  for (int64_t j4 = threadIdx.x; j4 < num_vecs; j4 += blockDim.x) {
+    load_masked4<scalar_t, kVectorized>(x, m, mask_stride, j4, N, vals);
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      sum += j4 * 4 + k < N ? std::exp(vals[k] - max) : acc_t(0);
+    }
+  }
+  sum = BlockAllReduceSum(sum);
+  for (int64_t j4 = threadIdx.x; j4 < num_vecs; j4 += blockDim.x) {
+    load_masked4<scalar_t, kVectorized>(x, m, mask_stride, j4, N, vals);
+    bool keep[4];
+    masked_softmax_dropout_keep4(seed, offset, i, j4, threshold, keep);
+    Vec s;
+    Vec y;
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      const acc_t s_v = std::exp(vals[k] - max) / sum;
+      s.val[k] = static_cast<scalar_t>(s_v);
+      y.val[k] = static_cast<scalar_t>(keep[k] ? s_v * scale : acc_t(0));
+    }
+    store4<scalar_t, kVectorized>(s, softmax + i * N, j4, N);
+    store4<scalar_t, kVectorized>(y, output + i * N, j4, N);
+  }
+}
+
+// Gradient of the softmax of elements 4 * j4 to 4 * j4 + 3, i.e. grad_output
+// through the dropout, and their softmax.
+template <typename scalar_t, bool kVectorized, typename acc_t>
+__device__ __forceinline__ void load_backward4(
+    const scalar_t* dy,
+    const scalar_t* s,
+    uint64_t seed,
+    uint64_t offset,
+    int64_t i,
+    int64_t j4,
+    int64_t N,
+    uint64_t threshold,
+    acc_t scale,
+    acc_t dy_out[4],
+    acc_t s_out[4]) {
+  const auto dy_v = load4<scalar_t, kVectorized>(dy, j4, N);
+  const auto s_v = load4<scalar_t, kVectorized>(s, j4, N);
+  bool keep[4];
+  masked_softmax_dropout_keep4(seed, offset, i, j4, threshold, keep);
+#pragma unroll
+  for (int k = 0; k < 4; ++k) {
+    dy_out[k] = keep[k] ? static_cast<acc_t>(dy_v.val[k]) * scale : acc_t(0);
+    s_out[k] = static_cast<acc_t>(s_v.val[k]);
+  }
+}
+
+template <typename scalar_t, int kVecs, bool kVectorized>
+__global__ void masked_softmax_dropout_backward_warp_kernel(
+    int64_t M,
+    int64_t N,
+    const scalar_t* grad_output,
+    const scalar_t* softmax,
+    const int64_t* rng_state,
+    uint64_t threshold,
+    acc_type<scalar_t, true> scale,
+    scalar_t* grad_input) {
+  using acc_t = acc_type<scalar_t, true>;
+  using Vec = memory::aligned_vector<scalar_t, 4>;
+  const int64_t i =
+      static_cast<int64_t>(blockIdx.x) * blockDim.y + threadIdx.y;
+  if (i >= M) {
+    return;
+  }
+  const auto seed = static_cast<uint64_t>(rng_state[0]);
+  const auto offset = static_cast<uint64_t>(rng_state[1]);
+  acc_t dy[kVecs][4];
+  acc_t s[kVecs][4];
+  acc_t dot = 0;
+#pragma unroll
+  for (int v = 0; v < kVecs; ++v) {
+    const int64_t j4 = threadIdx.x + v * C10_WARP_SIZE;
+    if (j4 * 4 < N) {
+      load_backward4<scalar_t, kVectorized>(
+          grad_output + i * N, softmax + i * N, seed, offset, i, j4, N,
+          threshold, scale, dy[v], s[v]);
+#pragma unroll
+      for (int k = 0; k < 4; ++k) {
+        dot += dy[v][k] * s[v][k];
+      }
+    }
+  }
+  dot = WarpAllReduceSum(dot);
+#pragma unroll
+  for (int v = 0; v < kVecs; ++v) {
+    const int64_t j4 = threadIdx.x + v * C10_WARP_SIZE;
+    if (j4 * 4 < N) {
+      Vec dx;
+#pragma unroll
+      for (int k = 0; k < 4; ++k) {
+        dx.val[k] = static_cast<scalar_t>(s[v][k] * (dy[v][k] - dot));
+      }
+      store4<scalar_t, kVectorized>(dx, grad_input + i * N, j4, N);
+    }
+  }
+}
+
+template <typename scalar_t, bool kVectorized>
+__global__ void masked_softmax_dropout_backward_block_kernel(
+    int64_t N,
+    const scalar_t* grad_output,
+    const scalar_t* softmax,
+    const int64_t* rng_state,
+    uint64_t threshold,
+    acc_type<scalar_t, true> scale,
+    scalar_t* grad_input) {
+  using acc_t = acc_type<scalar_t, true>;
+  using Vec = memory::aligned_vector<scalar_t, 4>;
+  const int64_t i = blockIdx.x;
+  const int64_t num_vecs = (N + 3) / 4;
+  const auto seed = static_cast<uint64_t>(rng_state[0]);
+  const auto offset = static_cast<uint64_t>(rng_state[1]);
+  const scalar_t* dy_row = grad_output + i * N;
+  const scalar_t* s_row = softmax + i * N;
+  acc_t dy[4];
+  acc_t s[4];
+  acc_t dot = 0;
+  for (int64_t j4 = threadIdx.x; j4 < num_vecs; j4 += blockDim.x) {
+    load_backward4<scalar_t, kVectorized>(
+        dy_row, s_row, seed, offset, i, j4, N, threshold, scale, dy, s);
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      dot += dy[k] * s[k];
+    }
+  }
+  dot = BlockAllReduceSum(dot);
+  for (int64_t j4 = threadIdx.x; j4 < num_vecs; j4 += blockDim.x) {
+    load_backward4<scalar_t, kVectorized>(
+        dy_row, s_row, seed, offset, i, j4, N, threshold, scale, dy, s);
+    Vec dx;
+#pragma unroll
+    for (int k = 0; k < 4; ++k) {
+      dx.val[k] = static_cast<scalar_t>(s[k] * (dy[k] - dot));
+    }
+    store4<scalar_t, kVectorized>(dx, grad_input + i * N, j4, N);
+  }
+}
+
+// Number of vectors per lane of the warp kernels for rows of num_vecs
+// vectors, or 0 if the rows are too long for them.
+int warp_kernel_vecs(int64_t num_vecs) {
+  for (int vecs = 1; vecs <= kMaxWarpVecs; vecs *= 2) {
+    if (num_vecs <= vecs * C10_WARP_SIZE) {
+      return vecs;
+    }
+  }
+  return 0;
+}
+
+template <typename scalar_t>
+bool can_vectorize_rows(
+    int64_t N,
+    std::initializer_list<const Tensor*> tensors) {
+  if (N % 4 != 0) {
+    return false;
+  }
+  for (const Tensor* t : tensors) {
+    if (memory::can_vectorize_up_to<scalar_t>(
+            static_cast<char*>(t->data_ptr())) < 4) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename scalar_t, bool kVectorized>
+void masked_softmax_dropout_cuda_impl(
+    const MaskedSoftmaxRows& rows,
+    double p,
+    const PhiloxCudaState& philox_args,
+    Tensor& rng_state,
+    Tensor& output,
+    Tensor& softmax) {
+  using acc_t = acc_type<scalar_t, true>;
+  const int64_t M = rows.M;
+  const int64_t N = rows.N;
+  const scalar_t* input_data = rows.input.data_ptr<scalar_t>();
+  const bool* mask_data =
+      rows.mask.defined() ? rows.mask.data_ptr<bool>() : nullptr;
+  const int64_t* mask_offsets =
+      rows.mask.defined() ? rows.mask_offsets.data_ptr<int64_t>() : nullptr;
+  const uint64_t threshold = masked_softmax_dropout_threshold(p);
+  const acc_t scale = p < 1 ? static_cast<acc_t>(1 / (1 - p)) : acc_t(0);
+  int64_t* rng_state_data = rng_state.data_ptr<int64_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  scalar_t* softmax_data = softmax.data_ptr<scalar_t>();
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  const dim3 warp_block(C10_WARP_SIZE, kWarpsPerBlock);
+  const int64_t warp_grid = (M + kWarpsPerBlock - 1) / kWarpsPerBlock;
+#define LAUNCH_WARP_KERNEL(VECS)                                         \
+  masked_softmax_dropout_warp_kernel<scalar_t, VECS, kVectorized>        \
+      <<<warp_grid, warp_block, 0, stream>>>(                            \
+          M, N, input_data, mask_data, mask_offsets, rows.mask_stride,   \
+          threshold, scale, philox_args, rng_state_data, output_data,    \
+          softmax_data)
+  switch (warp_kernel_vecs((N + 3) / 4)) {
+    case 1:
+      LAUNCH_WARP_KERNEL(1);
+      break;
+    case 2:
+      LAUNCH_WARP_KERNEL(2);
+      break;
+    case 4:
+      LAUNCH_WARP_KERNEL(4);
+      break;
+    case 8:
+      LAUNCH_WARP_KERNEL(8);
+      break;
+    default:
+      masked_softmax_dropout_block_kernel<scalar_t, kVectorized>
+          <<<M, kBlockNumThreads, 0, stream>>>(
+              N, input_data, mask_data, mask_offsets, rows.mask_stride,
+              threshold, scale, philox_args, rng_state_data, output_data,
+              softmax_data);
+  }
+#undef LAUNCH_WARP_KERNEL
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+template <typename scalar_t, bool kVectorized>
+void masked_softmax_dropout_backward_cuda_impl(
+    const Tensor& grad_output,
+    const Tensor& softmax,
+    const Tensor& rng_state,
+    int64_t M,
+    int64_t N,
+    double p,
+    Tensor& grad_input) {
+  using acc_t = acc_type<scalar_t, true>;
+  const scalar_t* grad_data = grad_output.data_ptr<scalar_t>();
+  const scalar_t* softmax_data = softmax.data_ptr<scalar_t>();
+  const int64_t* rng_state_data = rng_state.data_ptr<int64_t>();
+  scalar_t* grad_input_data = grad_input.data_ptr<scalar_t>();
+  const uint64_t threshold = masked_softmax_dropout_threshold(p);
+  const acc_t scale = p < 1 ? static_cast<acc_t>(1 / (1 - p)) : acc_t(0);
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  const dim3 warp_block(C10_WARP_SIZE, kWarpsPerBlock);
+  const int64_t warp_grid = (M + kWarpsPerBlock - 1) / kWarpsPerBlock;
+#define LAUNCH_WARP_KERNEL(VECS)                                             \
+  masked_softmax_dropout_backward_warp_kernel<scalar_t, VECS, kVectorized>   \
+      <<<warp_grid, warp_block, 0, stream>>>(                                \
+          M, N, grad_data, softmax_data, rng_state_data, threshold, scale,   \
+          grad_input_data)
+  switch (warp_kernel_vecs((N + 3) / 4)) {
+    case 1:
+      LAUNCH_WARP_KERNEL(1);
+      break;
+    case 2:
+      LAUNCH_WARP_KERNEL(2);
+      break;
+    case 4:
+      LAUNCH_WARP_KERNEL(4);
+      break;
+    case 8:
+      LAUNCH_WARP_KERNEL(8);
+      break;
+    default:
+      masked_softmax_dropout_backward_block_kernel<scalar_t, kVectorized>
+          <<<M, kBlockNumThreads, 0, stream>>>(
+              N, grad_data, softmax_data, rng_state_data, threshold, scale,
+              grad_input_data);
+  }
+#undef LAUNCH_WARP_KERNEL
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor, Tensor> masked_softmax_dropout_cuda(
+    const Tensor& self,
+    const Tensor& mask /* optional */,
+    int64_t dim,
+    double p,
+    c10::optional<Generator> gen_) {
+  check_masked_softmax_dropout_p(p);
+  const MaskedSoftmaxRows rows = masked_softmax_rows(self, mask, dim);
+  Tensor output = at::empty_like(rows.input);
+  Tensor softmax = at::empty_like(rows.input);
+  Tensor rng_state = at::zeros({2}, self.options().dtype(kLong));
+  if (rows.M > 0 && rows.N > 0) {
+    auto gen = get_generator_or_default<CUDAGeneratorImpl>(
+        gen_, cuda::detail::getDefaultCUDAGenerator());
+    // Each row draws 4 numbers per vector of 4 elements from its own
+    // subsequence.
+    PhiloxCudaState rng_engine_inputs;
+    {
+      // See Note [Acquire lock when using random generators]
+      std::lock_guard<std::mutex> lock(gen->mutex_);
+      rng_engine_inputs = gen->philox_cuda_state((rows.N + 3) / 4 * 4);
+    }
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::Half,
+        at::ScalarType::BFloat16,
+        self.scalar_type(),
+        "masked_softmax_dropout_cuda",
+        [&] {
+          if (can_vectorize_rows<scalar_t>(
+                  rows.N, {&rows.input, &output, &softmax})) {
+            masked_softmax_dropout_cuda_impl<scalar_t, true>(
+                rows, p, rng_engine_inputs, rng_state, output, softmax);
+          } else {
+            masked_softmax_dropout_cuda_impl<scalar_t, false>(
+                rows, p, rng_engine_inputs, rng_state, output, softmax);
+          }
+        });
+  }
+  return std::make_tuple(
+      masked_softmax_unrows(output, rows, dim),
+      masked_softmax_unrows(softmax, rows, dim),
+      rng_state);
+}
+
+Tensor masked_softmax_dropout_backward_cuda(
+    const Tensor& grad_output,
+    const Tensor& softmax,
+    const Tensor& rng_state,
+    int64_t dim,
+    double p) {
+  check_masked_softmax_dropout_p(p);
+  TORCH_CHECK(
+      rng_state.numel() == 2 && rng_state.scalar_type() == kLong &&
+          rng_state.device() == grad_output.device(),
+      "_masked_softmax_dropout_backward: expected the rng_state returned by ",
+      "_masked_softmax_dropout");
+  TORCH_CHECK(
+      grad_output.sizes() == softmax.sizes(),
+      "_masked_softmax_dropout_backward: expected grad_output of size ",
+      softmax.sizes(), ", but got ", grad_output.sizes());
+  dim = maybe_wrap_dim(dim, grad_output.dim());
+  const Tensor grad_t = grad_output.transpose(dim, -1).contiguous();
+  const Tensor softmax_t = softmax.transpose(dim, -1).contiguous();
+  const Tensor state = rng_state.contiguous();
+  const int64_t N = grad_t.size(-1);
+  const int64_t M = N == 0 ? 0 : grad_t.numel() / N;
+  Tensor grad_input = at::empty_like(grad_t);
+  if (M > 0) {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::Half,
+        at::ScalarType::BFloat16,
+        grad_t.scalar_type(),
+        "masked_softmax_dropout_backward_cuda",
+        [&] {
+          if (can_vectorize_rows<scalar_t>(
+                  N, {&grad_t, &softmax_t, &grad_input})) {
+            masked_softmax_dropout_backward_cuda_impl<scalar_t, true>(
+                grad_t, softmax_t, state, M, N, p, grad_input);
+          } else {
+            masked_softmax_dropout_backward_cuda_impl<scalar_t, false>(
+                grad_t, softmax_t, state, M, N, p, grad_input);
+          }
+        });
+  }
+  return grad_input.transpose(dim, -1);
+}
+
+} // namespace native
+} // namespace at
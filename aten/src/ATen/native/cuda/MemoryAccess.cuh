@@ -8,6 +8,7 @@
 #include <ATen/core/Array.h>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/cuda/detail/OffsetCalculator.cuh>
+#include <thrust/tuple.h>
 
 // References:
 // https://devblogs.nvidia.com/cuda-pro-tip-increase-performance-with-vectorized-memory-access/
@@ -66,11 +67,22 @@ struct vectorized_load_helper {
 template<int arg_index>
 struct unroll_load_helper {
   template <typename args_t, typename policy_t, typename offset_t, typename loader_t>
-  static __device__ void apply(policy_t &self, args_t *args, offset_t offset, loader_t loader, int j) {
+  static __device__ void apply(policy_t &self, args_t *args, offset_t offset, loader_t loader, int j, int num_outputs = 1) {
     using arg_t = std::tuple_element_t<arg_index, args_t>;
     // `data` hold the data_ptr for tensors [output, input0, input1, ...], so we
-    // need a +1 offset to get the input
-    std::get<arg_index>(args[j]) = loader.template load<arg_t>(self.data[arg_index + 1], offset[arg_index], arg_index);
+    // need a +num_outputs offset to get the input
+    std::get<arg_index>(args[j]) = loader.template load<arg_t>(self.data[arg_index + num_outputs], offset[arg_index], arg_index);
+  }
+};
+
+// helper struct to be used with static_unroll to store the outputs of
+// a kernel with several outputs one by one
+template<int current>
+struct multi_outputs_store_helper {
+  template<typename data_t, typename offset_t, typename storer_t, typename return_t>
+  static __device__ void apply(data_t data, offset_t offset, storer_t storer, return_t ret) {
+    using output_t = typename thrust::tuple_element<current, return_t>::type;
+    storer.template store<output_t>(thrust::get<current>(ret), data[current], offset[current], current);
   }
 };
 
@@ -125,6 +137,39 @@ struct StoreWithCast {
   }
 };
 
+// Storers for kernels with several outputs, `arg` is the index of the output
+
+struct MultiOutputsStoreWithoutCast {
+  template<typename scalar_t>
+  __device__ void store(scalar_t value, char *base_ptr, uint32_t offset, int arg) {
+    *(reinterpret_cast<scalar_t *>(base_ptr) + offset) = value;
+  }
+};
+
+template <int N>
+struct MultiOutputsStoreWithCast {
+  using array_t = at::detail::Array<at::ScalarType, N>;
+  using size_array_t = at::detail::Array<uint32_t, N>;
+
+  array_t dtypes;
+  size_array_t element_sizes;
+
+  template<typename array_t_>
+  MultiOutputsStoreWithCast(array_t_ dtypes) {
+    #pragma unroll
+    for (int i = 0; i < N; i++) {
+      this->dtypes[i] = dtypes[i];
+      element_sizes[i] = c10::elementSize(dtypes[i]);
+    }
+  }
+
+  template<typename scalar_t>
+  __device__ void store(scalar_t value, char *base_ptr, uint32_t offset, int arg) {
+    void *ptr = base_ptr + element_sizes[arg] * offset;
+    c10::cast_and_store<scalar_t>(dtypes[arg], ptr, value);
+  }
+};
+
 // aligned vector generates vectorized load/store on CUDA
 template<typename scalar_t, int vec_size>
 struct alignas(sizeof(scalar_t) * vec_size) aligned_vector {
@@ -185,6 +230,57 @@ struct unroll {
   }
 };
 
+// Same as unroll, for kernels that return a thrust::tuple of num_outputs
+// outputs. `data` holds the outputs first, then the inputs.
+template <typename data_t, typename inp_calc_t, typename out_calc_t, typename loader_t, typename storer_t, int num_outputs>
+struct multi_outputs_unroll {
+
+  data_t data;
+  int remaining;
+  inp_calc_t input_offset_calculator;
+  out_calc_t output_offset_calculator;
+  loader_t loader;
+  storer_t storer;
+
+  __device__ multi_outputs_unroll(data_t data, int remaining, inp_calc_t ic, out_calc_t oc, loader_t l, storer_t s):
+    data(data), remaining(remaining), input_offset_calculator(ic), output_offset_calculator(oc), loader(l), storer(s) {}
+
+  __device__ inline bool check_inbounds(int thread_work_elem) {
+    return ((threadIdx.x  + thread_work_elem*num_threads) < remaining);
+  }
+
+  template<typename args_t>
+  __device__ inline void load(args_t *args, int idx) {
+    constexpr int arity = std::tuple_size<args_t>::value;
+    int thread_idx = threadIdx.x;
+    #pragma unroll
+    for (int i = 0; i < thread_work_size; i++) {
+      if (thread_idx >= remaining) {
+        return;
+      }
+      int linear_idx = thread_idx + block_work_size * idx;
+      auto offset = input_offset_calculator.get(linear_idx);
+      detail::static_unroll<detail::unroll_load_helper, arity>::with_args(*this, args, offset, loader, i, num_outputs);
+      thread_idx += num_threads;
+    }
+  }
+
+  template<typename return_t>
+  __device__ inline void store(return_t *from, int idx) {
+    int thread_idx = threadIdx.x;
+    #pragma unroll
+    for (int i = 0; i < thread_work_size; i++) {
+      if (thread_idx >= remaining) {
+        return;
+      }
+      int linear_idx = thread_idx + block_work_size * idx;
+      auto offsets = output_offset_calculator.get(linear_idx);
+      detail::static_unroll<detail::multi_outputs_store_helper, num_outputs>::with_args(data, offsets, storer, from[i]);
+      thread_idx += num_threads;
+    }
+  }
+};
+
 // Assumption:
 // all tensors are contiguous, that is: stride == sizeof(type) for all tensors
 // Note:
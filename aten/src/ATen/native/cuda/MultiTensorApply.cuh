@@ -0,0 +1,119 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+
+namespace at { namespace native {
+
+namespace {
+
+// Multi-tensor apply launches a single kernel over the chunks of many tensors,
+// instead of one kernel per tensor, which dominates the cost of elementwise
+// ops over lists of small tensors (e.g. the optimizer step of a model with
+// many small parameters).
+//
+// The addresses and sizes of the tensors are passed to the kernel by value,
+// in a TensorListMetadata, so they must fit in the 4KB of kernel arguments.
+// The number of tensors and blocks handled by a launch are limited
+// accordingly, depending on the number of lists (the depth).
+
+static constexpr int64_t kChunkSize = 65536;
+static constexpr int kBlockSize = 512;
+
+// 320 blocks of kChunkSize elements cover 20M elements per launch, which
+// keeps every SM of current GPUs busy; more blocks would only leave room for
+// fewer tensors. The number of tensors is then the largest that keeps the
+// metadata at 3.3KB or less (3360 bytes for depth 1, 3136 for depths 2 and 3,
+// 3040 for depths 4 and 5), leaving at least 700 bytes for the callable, which
+// holds the scalar arguments of the op. multi_tensor_apply() checks that both
+// fit. The tensor indices in block_to_tensor must also fit in a byte.
+static constexpr int depth_to_max_tensors[5] = {110, 64, 48, 36, 30};
+static constexpr int depth_to_max_blocks[5] = {320, 320, 320, 320, 320};
+// The size limit of the arguments of a kernel.
+static constexpr size_t kMaxKernelArgsSize = 4096;
+
+template <int n> struct TensorListMetadata {
+  void* addresses[n][depth_to_max_tensors[n - 1]];
+  int64_t numel_for_tensor[depth_to_max_tensors[n - 1]];
+  unsigned char block_to_tensor[depth_to_max_blocks[n - 1]];
+  int block_to_chunk[depth_to_max_blocks[n - 1]];
+};
+
+template <typename T, typename U>
+C10_LAUNCH_BOUNDS_1(kBlockSize)
+__global__ void multi_tensor_apply_kernel(T tensorListMeta, U callable) {
+  callable(kChunkSize, tensorListMeta);
+}
+
+// Runs `callable` over all the chunks of the tensors in `tensor_lists`, whose
+// i-th tensors must all have the same number of elements.
+template <int depth, typename T>
+void multi_tensor_apply(
+    std::vector<std::vector<at::Tensor>>& tensor_lists,
+    T callable) {
+  static_assert(
+      sizeof(TensorListMetadata<depth>) + sizeof(T) <= kMaxKernelArgsSize,
+      "The tensor list metadata and the callable exceed the size limit of "
+      "kernel arguments.");
+  TORCH_CHECK(tensor_lists.size() == depth, "Number of tensor lists has to match the depth.");
+  const auto n_tensors = tensor_lists[0].size();
+
+  const OptionalDeviceGuard device_guard(device_of(tensor_lists[0][0]));
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  TensorListMetadata<depth> tensorListMeta;
+  int loc_block_info = 0;
+  int loc_tensor_info = 0;
+
+  auto launch = [&]() {
+    multi_tensor_apply_kernel<<<loc_block_info, kBlockSize, 0, stream>>>(
+        tensorListMeta, callable);
+    AT_CUDA_CHECK(cudaGetLastError());
+    loc_block_info = 0;
+  };
+
+  for (size_t t = 0; t < n_tensors; t++) {
+    const auto numel = tensor_lists[0][t].numel();
+    if (numel == 0) {
+      continue;
+    }
+    tensorListMeta.numel_for_tensor[loc_tensor_info] = numel;
+    for (int d = 0; d < depth; d++) {
+      tensorListMeta.addresses[d][loc_tensor_info] = tensor_lists[d][t].data_ptr();
+    }
+    loc_tensor_info++;
+
+    const auto chunks = (numel + kChunkSize - 1) / kChunkSize;
+    for (int64_t chunk = 0; chunk < chunks; chunk++) {
+      tensorListMeta.block_to_tensor[loc_block_info] = loc_tensor_info - 1;
+      tensorListMeta.block_to_chunk[loc_block_info] = chunk;
+      loc_block_info++;
+
+      const bool tensors_full = loc_tensor_info == depth_to_max_tensors[depth - 1] &&
+          chunk == chunks - 1;
+      const bool blocks_full = loc_block_info == depth_to_max_blocks[depth - 1];
+      if (tensors_full || blocks_full) {
+        launch();
+        if (chunk == chunks - 1) {
+          loc_tensor_info = 0;
+        } else {
+          // The remaining chunks of the current tensor go to the next launch,
+          // where it is the first tensor.
+          tensorListMeta.numel_for_tensor[0] = tensorListMeta.numel_for_tensor[loc_tensor_info - 1];
+          for (int d = 0; d < depth; d++) {
+            tensorListMeta.addresses[d][0] = tensorListMeta.addresses[d][loc_tensor_info - 1];
+          }
+          loc_tensor_info = 1;
+        }
+      }
+    }
+  }
+
+  if (loc_block_info != 0) {
+    launch();
+  }
+}
+
+} // anonymous namespace
+}} // at::native
@@ -39,6 +39,7 @@
 #include <c10/macros/Macros.h>
 #include <c10/core/ScalarType.h>
 #include <c10/util/TypeCast.h>
+#include <thrust/tuple.h>
 
 // Marks a lambda as executable on both the host and device. The __host__
 // attribute is important so that we can access static type information from
@@ -165,6 +166,26 @@ invoke(const func_t &f, char *const C10_RESTRICT data[], const index_t strides[]
   return invoke_impl<traits>(f, data, strides, dtypes, i, Indices{});
 }
 
+// Stores the outputs of a kernel with several outputs, casting each to the
+// dtype of its tensor.
+template <typename output_t, int n = thrust::tuple_size<output_t>::value>
+struct store_outputs_with_cast {
+  template <typename index_t>
+  static C10_HOST_DEVICE void apply(char *const C10_RESTRICT data[], const index_t offsets[],
+                                    const ScalarType dtypes[], const output_t& outputs) {
+    using T = typename thrust::tuple_element<n - 1, output_t>::type;
+    c10::cast_and_store<T>(dtypes[n - 1], data[n - 1] + offsets[n - 1], thrust::get<n - 1>(outputs));
+    store_outputs_with_cast<output_t, n - 1>::apply(data, offsets, dtypes, outputs);
+  }
+};
+
+template <typename output_t>
+struct store_outputs_with_cast<output_t, 0> {
+  template <typename index_t>
+  static C10_HOST_DEVICE void apply(char *const C10_RESTRICT data[], const index_t offsets[],
+                                    const ScalarType dtypes[], const output_t& outputs) {}
+};
+
 } // namespace legacy
 
 // See the note for namespace legacy above.
@@ -368,4 +389,34 @@ void gpu_kernel_impl(TensorIterator& iter, const func_t& f) {
   }
 }
 
+template <typename func_t>
+void gpu_kernel_multiple_outputs_impl(TensorIterator& iter, const func_t& f) {
+  using traits = function_traits<func_t>;
+  using output_t = typename traits::result_type;
+  constexpr int num_outputs = thrust::tuple_size<output_t>::value;
+  constexpr int ntensors = traits::arity + num_outputs;
+
+  TORCH_INTERNAL_ASSERT(iter.can_use_32bit_indexing());
+  TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
+  TORCH_INTERNAL_ASSERT(iter.noutputs() == num_outputs);
+
+  at::detail::Array<char*, ntensors> data;
+  at::detail::Array<ScalarType, ntensors> dtypes;
+  for (int i = 0; i < ntensors; i++) {
+    data[i] = (char*)iter.data_ptr(i);
+    dtypes[i] = iter.tensor(i).scalar_type();
+  }
+
+  // Loads and stores always go through the dtypes of the tensors, which
+  // covers the kernels that need dynamic casting.
+  int64_t numel = iter.numel();
+  auto offset_calc = ::make_offset_calculator<ntensors>(iter);
+  legacy::launch_kernel<launch_size_nd, launch_bound2>(numel, [=]GPU_LAMBDA(int idx) {
+    auto offsets = offset_calc.get(idx);
+    output_t outputs = legacy::invoke(
+        f, &data.data[num_outputs], &offsets.data[num_outputs], &dtypes.data[num_outputs], 1);
+    legacy::store_outputs_with_cast<output_t>::apply(data.data, offsets.data, dtypes.data, outputs);
+  });
+}
+
 }} // namespace at::native
@@ -18,6 +18,7 @@
 #include <type_traits>
 #include <utility>
 #include <thrust/pair.h>
+#include <thrust/tuple.h>
 
 namespace at { namespace native {
 
@@ -290,13 +291,17 @@ struct ReduceOp {
 
   static constexpr int input_vec_size = ReduceConfig::input_vec_size;
 
+  // Maximum number of results a single reduction can write, the results of
+  // ops_t::project are written to dst[0], ..., dst[noutputs - 1].
+  static constexpr int MAX_NOUTPUTS = 5;
+
   ops_t ops;
   arg_t ident;
   ReduceConfig config;
   InputCalculator input_calc;
   OutputCalculator output_calc;
   const void* src;
-  const char* dst[2]; //it accepts at most two destinations
+  at::detail::Array<char*, MAX_NOUTPUTS> dst;
   // acc_buf used for accumulation among sub Tensor Iterator when accumulation on
   // output is not permissible
   void* acc_buf;
@@ -314,8 +319,7 @@ struct ReduceOp {
       InputCalculator input_calc,
       OutputCalculator output_calc,
       const void* src,
-      char* dst0,
-      optional<char*> dst1,
+      at::detail::Array<char*, MAX_NOUTPUTS> dst,
       void* acc_buf,
       void* cta_buf,
       int* semaphores,
@@ -328,16 +332,12 @@ struct ReduceOp {
         input_calc(input_calc),
         output_calc(output_calc),
         src(src),
+        dst(dst),
         acc_buf(acc_buf),
         cta_buf(cta_buf),
         semaphores(semaphores),
         base_idx(base_idx),
-        noutputs(noutputs) {
-    dst[0] = dst0;
-    if (dst1.has_value()) {
-      dst[1] = dst1.value();
-    }
-  }
+        noutputs(noutputs) {}
 
   template <int output_vec_size>
   C10_DEVICE void run() const {
@@ -710,7 +710,7 @@ struct ReduceOp {
     *res = x;
   }
 
-  //Currently implemented for max of two outputs
+  // Pairs write at most two outputs, see the thrust::tuple overload for more
   template<class T1, class T2>
   C10_DEVICE void set_results(const thrust::pair<T1, T2> x, const index_t base_offset) const {
     if (noutputs >= 1) {
@@ -725,6 +725,28 @@ struct ReduceOp {
     }
   }
 
+  template<int i, class tuple_t>
+  C10_DEVICE typename std::enable_if<i == thrust::tuple_size<tuple_t>::value>::type
+  set_tuple_results(const tuple_t& /*x*/, const index_t /*base_offset*/) const {}
+
+  template<int i, class tuple_t>
+  C10_DEVICE typename std::enable_if<(i < thrust::tuple_size<tuple_t>::value)>::type
+  set_tuple_results(const tuple_t& x, const index_t base_offset) const {
+    using T0 = typename thrust::tuple_element<0, tuple_t>::type;
+    using Ti = typename thrust::tuple_element<i, tuple_t>::type;
+    if (i < noutputs) {
+      // base offset is computed assuming element size being sizeof(T0), as for pairs
+      auto res = (Ti*)((char*)dst[i] + base_offset / sizeof(T0) * sizeof(Ti));
+      *res = thrust::get<i>(x);
+    }
+    set_tuple_results<i + 1>(x, base_offset);
+  }
+
+  template<class... Ts>
+  C10_DEVICE void set_results(const thrust::tuple<Ts...> x, const index_t base_offset) const {
+    set_tuple_results<0>(x, base_offset);
+  }
+
   template <int output_vec_size>
   C10_DEVICE void set_results_to_output(at::detail::Array<arg_t, output_vec_size> value, at::detail::Array<index_t, output_vec_size> base_offset) const {
     assert(final_output);
@@ -961,11 +983,11 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, ident_t id
   const char* in_data = (char*)iter.data_ptr(iter.ntensors() - 1);
   char* out_data = (char*)iter.data_ptr(0);
   const auto noutputs = iter.noutputs();
-  optional<char*> out_data_extra;
-  if (noutputs > 1) {
-    out_data_extra = (char*)iter.data_ptr(1);
-  } else {
-    out_data_extra = nullopt;
+  using reduce_op_t = ReduceOp<scalar_t, ops_t, uint32_t, out_scalar_t, vt0>;
+  TORCH_INTERNAL_ASSERT(noutputs <= reduce_op_t::MAX_NOUTPUTS);
+  at::detail::Array<char*, reduce_op_t::MAX_NOUTPUTS> out_datas(nullptr);
+  for (int i = 0; i < noutputs; i++) {
+    out_datas[i] = (char*)iter.data_ptr(i);
   }
   char* acc_data = acc_buf_ptr->get_acc_slice(out_data);
 
@@ -1111,14 +1133,13 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, ident_t id
   AT_ASSERT(can_use_32bit_indexing);
   auto output_calc = make_output_calculator<uint32_t>(iter);
   auto input_calc = make_input_calculator<uint32_t>(iter);
-  auto reduce = ReduceOp<scalar_t, ops_t, uint32_t, out_scalar_t, vt0>(
+  auto reduce = reduce_op_t(
       ops,
       config,
       input_calc,
       output_calc,
       in_data,
-      out_data,
-      out_data_extra,
+      out_datas,
       acc_data,
       buffer.get(),
       (int*)semaphores.get(),
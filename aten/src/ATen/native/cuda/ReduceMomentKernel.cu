@@ -4,6 +4,8 @@
 #include <ATen/native/SharedReduceOps.h>
 #include <ATen/Dispatch.h>
 #include <ATen/native/ReduceOps.h>
+#include <ATen/AccumulateType.h>
+#include <limits>
 
 namespace at { namespace native {
 
@@ -36,6 +38,21 @@ static void std_var_kernel_cuda(TensorIterator& iter, bool unbiased, bool take_s
   });
 }
 
+template <typename scalar_t, typename acc_t>
+void reduce_stats_kernel_impl(TensorIterator& iter) {
+  // five accumulators per thread, unroll by 2 as for welford
+  gpu_reduce_kernel<scalar_t, scalar_t, 2>(iter, ReduceStatsOps<scalar_t, acc_t> {},
+      ReduceStatsData<acc_t>(0, 0, std::numeric_limits<acc_t>::infinity(), -std::numeric_limits<acc_t>::infinity(), 0));
+}
+
+static void reduce_stats_kernel_cuda(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, iter.input_dtype(), "reduce_stats_cuda", [&]() {
+    AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "reduce_stats_cuda", [&] {
+      reduce_stats_kernel_impl<scalar_t, acc_type<scalar_t, true>>(iter);
+    });
+  });
+}
+
 template <typename scalar_t, typename acc_t=scalar_t, typename out_t=scalar_t>
 void mean_kernel_impl(TensorIterator& iter) {
   float factor = float(iter.num_output_elements()) / iter.numel();
@@ -63,6 +80,7 @@ static void mean_kernel_cuda(TensorIterator& iter) {
 }
 
 REGISTER_DISPATCH(std_var_stub, &std_var_kernel_cuda);
+REGISTER_DISPATCH(reduce_stats_stub, &reduce_stats_kernel_cuda);
 REGISTER_DISPATCH(mean_stub, &mean_kernel_cuda);
 
 }} // namespace at::native
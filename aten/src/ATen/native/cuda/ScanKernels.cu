@@ -17,6 +17,17 @@ constexpr inline integer ceil_div(integer n, integer m) {
   return (n + m - 1) / m;
 }
 
+// Rows at least this long are scanned by tensor_kernel_scan_innermost_dim_single_pass.
+constexpr int64_t scan_single_pass_min_row_size = 4096;
+
+// Scans along an outer dimension run one thread per column, i.e. per element of the other
+// dimensions, which cannot fill the device when there are few long columns. Those are scanned
+// as the rows of a transposed copy instead.
+inline bool use_transposed_scan(const Tensor& self, int64_t dim) {
+  int64_t row_size = self.size(dim);
+  return row_size >= scan_single_pass_min_row_size && self.numel() / row_size < row_size;
+}
+
 template<typename scalar_t, typename idx_t, typename BinaryOperation>
 __device__ void binary_op_update(const scalar_t lhs, scalar_t& rhs, const idx_t lhs_idx, idx_t& rhs_idx, BinaryOperation binary_op) {
   if(!THCNumerics<scalar_t>::isnan(rhs) && (THCNumerics<scalar_t>::isnan(lhs) || !binary_op(rhs, lhs))) {
@@ -199,11 +210,24 @@ void scan_dim_with_indices(const Tensor& self, Tensor& values, Tensor& indices,
   Tensor self_ = self.contiguous();
   Tensor values_ = values.contiguous();
   Tensor indices_ = indices.contiguous();
-   if (dim == ndim - 1) {
-     scan_innermost_dim_with_indices<scalar_t>(self, values, indices, init, binary_op);
-   } else {
-     scan_outer_dim_with_indices<scalar_t>(self, values, indices, dim, init, binary_op);
-   }
+  if (dim == ndim - 1) {
+    scan_innermost_dim_with_indices<scalar_t>(self_, values_, indices_, init, binary_op);
+  } else if (use_transposed_scan(self, dim)) {
+    Tensor self_t = self_.transpose(dim, ndim - 1).contiguous();
+    Tensor values_t = at::empty_like(self_t);
+    Tensor indices_t = at::empty_like(self_t, self_t.options().dtype(kLong));
+    scan_innermost_dim_with_indices<scalar_t>(self_t, values_t, indices_t, init, binary_op);
+    values_.copy_(values_t.transpose(dim, ndim - 1));
+    indices_.copy_(indices_t.transpose(dim, ndim - 1));
+  } else {
+    scan_outer_dim_with_indices<scalar_t>(self_, values_, indices_, dim, init, binary_op);
+  }
+  if (!values.is_same(values_)) {
+    values.copy_(values_);
+  }
+  if (!indices.is_same(indices_)) {
+    indices.copy_(indices_);
+  }
 }
 
 void cummax_helper_cuda(const Tensor& self, Tensor& values, Tensor& indices, int64_t dim) {
@@ -394,6 +418,194 @@ tensor_kernel_scan_innermost_dim(
       row_buf, tgt_, src_, num_rows, row_size, init, binary_op);
 }
 
+/* Perform an inclusive scan along the innermost dimension of a tensor with long rows,
+ * in a single pass with decoupled look-back (Merrill and Garland, "Single-pass Parallel
+ * Prefix Scan with Decoupled Look-back").
+ *
+ * - row_size is the size of the innermost dimension;
+ * - tiles_per_row is the number of tiles of scan_tile_threads * scan_tile_items<T>() elements
+ *   in a row.
+ *
+ * Each thread block scans one tile. Blocks take their tiles in order from tile_counter, so
+ * that the tiles before a tile have always been picked up by a running or finished block.
+ * Once it has reduced its tile, a block publishes the aggregate of the tile, then walks back
+ * over the previous tiles of the row, combining their aggregates until it reaches a tile that
+ * has published its inclusive prefix, and in turn publishes its own inclusive prefix. Every
+ * element is read and written once, unlike with tensor_kernel_scan_innermost_dim where a row
+ * is processed sequentially by a single group of threads.
+ */
+constexpr int scan_tile_threads = 256;
+
+constexpr int scan_tile_invalid = 0;
+constexpr int scan_tile_aggregate = 1;
+constexpr int scan_tile_prefix = 2;
+
+template <typename T>
+constexpr int scan_tile_items() {
+  return sizeof(T) <= 4 ? 8 : 4;
+}
+
+template <typename T>
+struct ScanTileWords {
+  static constexpr int value = (sizeof(T) + sizeof(unsigned) - 1) / sizeof(unsigned);
+};
+
+// Values published by other blocks are accessed through volatile words, so that they are
+// never read from a stale L1 line.
+template <typename T>
+__device__ __forceinline__ void store_tile_value(unsigned* slot, const T& value) {
+  unsigned words[ScanTileWords<T>::value] = {};
+  memcpy(words, &value, sizeof(T));
+  volatile unsigned* dst = slot;
+  for (int i = 0; i < ScanTileWords<T>::value; ++i) {
+    dst[i] = words[i];
+  }
+}
+
+template <typename T>
+__device__ __forceinline__ T load_tile_value(const unsigned* slot) {
+  unsigned words[ScanTileWords<T>::value];
+  const volatile unsigned* src = slot;
+  for (int i = 0; i < ScanTileWords<T>::value; ++i) {
+    words[i] = src[i];
+  }
+  T value;
+  memcpy(&value, words, sizeof(T));
+  return value;
+}
+
+__device__ __forceinline__ int wait_for_tile(const int* tile_flags, int64_t tile) {
+  const volatile int* flag = tile_flags + tile;
+  int status;
+  do {
+    status = *flag;
+  } while (status == scan_tile_invalid);
+  __threadfence();
+  return status;
+}
+
+template <typename T, class BinaryFunction>
+__global__ void tensor_kernel_scan_innermost_dim_single_pass(
+    T* tgt_,
+    const T* src_,
+    int64_t row_size,
+    int64_t tiles_per_row,
+    int* tile_flags,
+    unsigned* tile_aggregates,
+    unsigned* tile_prefixes,
+    unsigned* tile_counter,
+    T init,
+    BinaryFunction binary_op) {
+  constexpr int items = scan_tile_items<T>();
+  constexpr int tile_size = scan_tile_threads * items;
+  constexpr int words = ScanTileWords<T>::value;
+
+  // See tensor_kernel_scan_innermost_dim for why complex values are stored in an array of
+  // their base type.
+  using base_t = typename scalar_value_type<T>::type;
+  constexpr int ratio = sizeof(T) / sizeof(base_t);
+  __shared__ __align__(alignof(T)) base_t tile_storage[ratio * tile_size];
+  __shared__ __align__(alignof(T)) base_t totals_storage[ratio * scan_tile_threads];
+  __shared__ __align__(alignof(T)) base_t prefix_storage[ratio];
+  __shared__ unsigned tile_id_buf;
+  __shared__ bool has_prefix;
+  T* tile_buf = reinterpret_cast<T*>(tile_storage);
+  T* totals = reinterpret_cast<T*>(totals_storage);
+  T* tile_prefix = reinterpret_cast<T*>(prefix_storage);
+
+  if (threadIdx.x == 0) {
+    tile_id_buf = atomicAdd(tile_counter, 1u);
+  }
+  __syncthreads();
+  const int64_t tile_id = tile_id_buf;
+  const int64_t row = tile_id / tiles_per_row;
+  const int64_t tile_col = tile_id % tiles_per_row;
+  const int64_t tile_start = tile_col * tile_size;
+  const int64_t tile_len = row_size - tile_start < tile_size ? row_size - tile_start : tile_size;
+  const T* src = src_ + row * row_size + tile_start;
+  T* tgt = tgt_ + row * row_size + tile_start;
+
+  // Coalesced load of the tile, then each thread scans `items` consecutive values.
+  for (int i = threadIdx.x; i < tile_size; i += scan_tile_threads) {
+    tile_buf[i] = i < tile_len ? src[i] : init;
+  }
+  __syncthreads();
+
+  T local[items];
+  local[0] = tile_buf[threadIdx.x * items];
+  for (int i = 1; i < items; ++i) {
+    local[i] = binary_op(local[i - 1], tile_buf[threadIdx.x * items + i]);
+  }
+  totals[threadIdx.x] = local[items - 1];
+  __syncthreads();
+
+  // Inclusive scan of the thread totals.
+  for (int offset = 1; offset < scan_tile_threads; offset <<= 1) {
+    T other;
+    if (threadIdx.x >= offset) {
+      other = totals[threadIdx.x - offset];
+    }
+    __syncthreads();
+    if (threadIdx.x >= offset) {
+      totals[threadIdx.x] = binary_op(other, totals[threadIdx.x]);
+    }
+    __syncthreads();
+  }
+
+  // Publish the tile and look back for its exclusive prefix.
+  if (threadIdx.x == 0) {
+    const T aggregate = totals[scan_tile_threads - 1];
+    volatile int* flag = tile_flags + tile_id;
+    if (tile_col == 0) {
+      store_tile_value(tile_prefixes + tile_id * words, aggregate);
+      __threadfence();
+      *flag = scan_tile_prefix;
+      has_prefix = false;
+    } else {
+      store_tile_value(tile_aggregates + tile_id * words, aggregate);
+      __threadfence();
+      *flag = scan_tile_aggregate;
+
+      // The first tile of a row always publishes its prefix, so this stops within the row.
+      int64_t pred = tile_id - 1;
+      int status = wait_for_tile(tile_flags, pred);
+      T exclusive = load_tile_value<T>(
+          (status == scan_tile_prefix ? tile_prefixes : tile_aggregates) + pred * words);
+      while (status != scan_tile_prefix) {
+        --pred;
+        status = wait_for_tile(tile_flags, pred);
+        const T value = load_tile_value<T>(
+            (status == scan_tile_prefix ? tile_prefixes : tile_aggregates) + pred * words);
+        exclusive = binary_op(value, exclusive);
+      }
+
+      store_tile_value(tile_prefixes + tile_id * words, binary_op(exclusive, aggregate));
+      __threadfence();
+      *flag = scan_tile_prefix;
+      *tile_prefix = exclusive;
+      has_prefix = true;
+    }
+  }
+  __syncthreads();
+
+  // Add the values before the thread to its values, then store the tile.
+  const bool has_thread_prefix = has_prefix || threadIdx.x > 0;
+  T thread_prefix;
+  if (threadIdx.x > 0) {
+    thread_prefix = has_prefix ? binary_op(*tile_prefix, totals[threadIdx.x - 1]) : totals[threadIdx.x - 1];
+  } else if (has_prefix) {
+    thread_prefix = *tile_prefix;
+  }
+  for (int i = 0; i < items; ++i) {
+    tile_buf[threadIdx.x * items + i] = has_thread_prefix ? binary_op(thread_prefix, local[i]) : local[i];
+  }
+  __syncthreads();
+
+  for (int i = threadIdx.x; i < tile_len; i += scan_tile_threads) {
+    tgt[i] = tile_buf[i];
+  }
+}
+
 void check_fits_in_unsigned(int64_t val, const char* name) {
   constexpr auto umax = std::numeric_limits<unsigned>::max();
   TORCH_CHECK(
@@ -446,6 +658,35 @@ void scan_innermost_dim(const Tensor& self, Tensor& result, scalar_t init, Binar
   AT_CUDA_CHECK(cudaGetLastError());
 }
 
+template <typename scalar_t, class BinaryFunction>
+void scan_innermost_dim_single_pass(const Tensor& self, Tensor& result, scalar_t init, BinaryFunction binary_op) {
+  constexpr int tile_size = scan_tile_threads * scan_tile_items<scalar_t>();
+  constexpr int words = ScanTileWords<scalar_t>::value;
+  int64_t row_size = self.size(self.dim() - 1);
+  int64_t num_rows = self.numel() / row_size;
+  int64_t tiles_per_row = ceil_div(row_size, int64_t{tile_size});
+  int64_t num_tiles = num_rows * tiles_per_row;
+
+  check_fits_in_unsigned(num_tiles, "Number of scan tiles");
+  TORCH_CHECK(num_tiles <= at::cuda::getCurrentDeviceProperties()->maxGridSize[0],
+              "Number of scan tiles exceeds the maximum grid size");
+
+  // The tile flags and the tile counter that follows them must start at zero.
+  Tensor tile_status = at::zeros({num_tiles + 1}, self.options().dtype(kInt));
+  Tensor tile_values = at::empty({2 * num_tiles * words}, self.options().dtype(kInt));
+  int* tile_flags = tile_status.data_ptr<int>();
+  unsigned* tile_counter = reinterpret_cast<unsigned*>(tile_flags + num_tiles);
+  unsigned* tile_aggregates = reinterpret_cast<unsigned*>(tile_values.data_ptr<int>());
+  unsigned* tile_prefixes = tile_aggregates + num_tiles * words;
+
+  dim3 grid(num_tiles);
+  tensor_kernel_scan_innermost_dim_single_pass<scalar_t><<<grid, scan_tile_threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+    result.data_ptr<scalar_t>(), self.data_ptr<scalar_t>(),
+    row_size, tiles_per_row, tile_flags, tile_aggregates, tile_prefixes, tile_counter,
+    init, binary_op);
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
 #ifdef __HIP_PLATFORM_HCC__
 template<typename T>
 struct ROCm_Bug {
@@ -491,7 +732,16 @@ void scan_dim(const Tensor& self, Tensor& result,
   if (self.numel() == self.size(dim)) {
     scan_thrust<scalar_t>(self_, result, init, binary_op);
   } else if (dim == ndim - 1) {
-    scan_innermost_dim<scalar_t>(self_, result, init, binary_op);
+    if (self.size(dim) >= scan_single_pass_min_row_size) {
+      scan_innermost_dim_single_pass<scalar_t>(self_, result, init, binary_op);
+    } else {
+      scan_innermost_dim<scalar_t>(self_, result, init, binary_op);
+    }
+  } else if (use_transposed_scan(self, dim)) {
+    Tensor self_t = self_.transpose(dim, ndim - 1).contiguous();
+    Tensor result_t = at::empty_like(self_t);
+    scan_dim<scalar_t>(self_t, result_t, ndim - 1, init, binary_op);
+    result.copy_(result_t.transpose(dim, ndim - 1));
   } else {
     scan_outer_dim<scalar_t>(self_, result, dim, init, binary_op);
   }
@@ -302,7 +302,36 @@ void scatter_fill_cuda_kernel(Tensor& self, int64_t dim, const Tensor& index, Sc
   );
 }
 
+// Accumulates with index_put_accum_stub: self[i_0]...[index[i]]...[i_n] += src[i_0]...[i_n]
+// for every position i = (i_0, ..., i_n) of index.
+static void scatter_add_sorted_cuda(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  Tensor self_ = self.dim() == 0 ? self.view(1) : self;
+  Tensor index_ = index.dim() == 0 ? index.view(1) : index;
+  Tensor src_ = src.dim() == 0 ? src.view(1) : src;
+  std::vector<Tensor> indices(index_.dim());
+  for (int64_t d = 0; d < index_.dim(); d++) {
+    if (d == dim) {
+      indices[d] = index_;
+    } else {
+      std::vector<int64_t> shape(index_.dim(), 1);
+      shape[d] = index_.size(d);
+      indices[d] = at::arange(index_.size(d), index_.options()).view(shape);
+    }
+    src_ = src_.narrow(d, 0, index_.size(d));
+  }
+  index_put_accum_stub(kCUDA, self_, indices, src_, /*unsafe=*/false);
+}
+
 void scatter_add_cuda_kernel(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  if (index.numel() > 0 && self.scalar_type() != ScalarType::BFloat16) {
+    dim = maybe_wrap_dim(dim, self.dim());
+    scatter_gather_dtype_check("scatter_add_cuda_", self, index, src);
+    scatter_shape_check(self, dim, index, src);
+    if (use_sorted_accumulate(ensure_nonempty_size(index, dim), ensure_nonempty_size(self, dim))) {
+      scatter_add_sorted_cuda(self, dim, index, src);
+      return;
+    }
+  }
   cuda_scatter_gather_base_kernel</*is_scatter_like=*/true, /*cast_to_opaque=*/false>()(
     self, dim, index, src,
     "scatter_add_cuda_", []C10_DEVICE(auto* lhs, const auto* rhs) {
@@ -0,0 +1,106 @@
+#include <ATen/ATen.h>
+#include <ATen/LegacyTHFunctionsCUDA.h>
+#include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/native/SortingUtils.h>
+
+#include <limits>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// Limits of the fused kernel of THC, which computes the mode of a slice in
+// shared memory, with one block per slice.
+constexpr int64_t kMaxFusedModeSliceSize = 1024;
+constexpr int64_t kMaxFusedModeSlices = 65535;
+
+// Computes the mode of each row of the num_slices x slice_size `rows` at once:
+// the rows are sorted by one segmented sort, and the length of each run of
+// equal values is counted. Like THC, this returns the smallest of the most
+// frequent values and the first index it is found at.
+std::tuple<Tensor, Tensor> mode_of_rows(const Tensor& rows) {
+  int64_t num_slices = rows.size(0);
+  int64_t slice_size = rows.size(1);
+  auto long_options = rows.options().dtype(kLong);
+
+  Tensor sorted, permutation;
+  std::tie(sorted, permutation) = rows.sort(/*dim=*/1);
+
+  // run_ids[i][j] is the number of runs of equal values before sorted[i][j]
+  auto run_starts = at::ones({num_slices, slice_size}, long_options);
+  run_starts.narrow(1, 1, slice_size - 1)
+      .copy_(sorted.narrow(1, 1, slice_size - 1) !=
+             sorted.narrow(1, 0, slice_size - 1));
+  auto run_ids = run_starts.cumsum(1).sub_(1);
+  auto run_lengths = at::zeros({num_slices, slice_size}, long_options)
+                         .scatter_add_(1, run_ids, at::ones_like(run_ids));
+
+  // Runs are in increasing order of their value, so the first of the longest
+  // ones is the smallest mode
+  auto max_lengths = std::get<0>(run_lengths.max(1, /*keepdim=*/true));
+  auto positions =
+      at::arange(slice_size, long_options).expand({num_slices, slice_size});
+  auto mode_run = std::get<0>(
+      positions.masked_fill(run_lengths != max_lengths, slice_size)
+          .min(1, /*keepdim=*/true));
+  auto not_in_mode_run = run_ids != mode_run;
+
+  auto first_position = std::get<0>(
+      positions.masked_fill(not_in_mode_run, slice_size).min(1, /*keepdim=*/true));
+  auto values = sorted.gather(1, first_position);
+  auto indices = std::get<0>(
+      permutation.masked_fill(not_in_mode_run, std::numeric_limits<int64_t>::max())
+          .min(1, /*keepdim=*/true));
+  return std::make_tuple(values, indices);
+}
+
+} // namespace
+
+std::tuple<Tensor&, Tensor&> _mode_out_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool keepdim) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  int64_t slice_size = self.dim() > 0 ? self.size(dim) : 1;
+  int64_t num_slices = slice_size > 0 ? self.numel() / slice_size : 0;
+  if (slice_size <= kMaxFusedModeSliceSize &&
+      num_slices <= kMaxFusedModeSlices &&
+      cuda::detail::canUse32BitIndexMath(self)) {
+    return legacy::cuda::_th_mode_out(values, indices, self, dim, keepdim);
+  }
+
+  // THC falls back to a few thrust calls and copies to the host per slice
+  // beyond those limits, so all the slices are done together here instead
+  _reduction_with_indices_allocate_or_resize_output(
+      values, indices, self, dim, keepdim);
+  auto transposed = self.transpose(dim, -1);
+  Tensor mode_values, mode_indices;
+  std::tie(mode_values, mode_indices) =
+      mode_of_rows(transposed.contiguous().view({num_slices, slice_size}));
+
+  auto result_sizes = transposed.sizes().vec();
+  result_sizes.back() = 1;
+  values.copy_(mode_values.view(result_sizes).transpose(dim, -1));
+  indices.copy_(mode_indices.view(result_sizes).transpose(dim, -1));
+  if (!keepdim) {
+    values.squeeze_(dim);
+    indices.squeeze_(dim);
+  }
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> _mode_cuda(
+    const Tensor& self,
+    int64_t dim,
+    bool keepdim) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  _mode_out_cuda(values, indices, self, dim, keepdim);
+  return std::make_tuple(values, indices);
+}
+
+} // namespace native
+} // namespace at
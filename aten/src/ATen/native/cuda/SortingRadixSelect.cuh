@@ -1,3 +1,5 @@
+#pragma once
+
 #include <THC/THCAtomics.cuh>
 
 namespace at {
@@ -6,11 +6,16 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
 #include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/native/SharedReduceOps.h>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <ATen/native/cuda/block_reduce.cuh>
 #include <THC/THCDeviceUtils.cuh>
 
 #include <c10/cuda/CUDAMathCompat.h>
 
+#include <initializer_list>
+#include <type_traits>
+
 namespace at {
 namespace native {
 
@@ -18,90 +23,116 @@ namespace {
 
 constexpr int kCUDANumThreads = 256;
 constexpr int kReduceTileSize = 32;
+// Number of elements of the vectorized loads and stores of the fused kernels.
+constexpr int kVecSize = 4;
+
+template <typename T_ACC>
+using WelfordType = WelfordData<T_ACC, int, T_ACC>;
+
+template <typename T_ACC>
+using WelfordOpsType =
+    WelfordOps<T_ACC, T_ACC, int, T_ACC, thrust::pair<T_ACC, T_ACC>>;
 
+// Returns kVecSize if the groups of X, dY and so on can be read kVecSize
+// elements at a time, which also needs every channel to start on a vector.
 template <typename T>
-__global__ void RowwiseMomentsCUDAKernel(
-    int64_t N,
-    T eps,
-    const T* X,
-    T* mean,
-    T* rstd) {
-  using T_ACC = acc_type<T, true>;
-  __shared__ T_ACC m_shared[C10_WARP_SIZE];
-  __shared__ T_ACC v_shared[C10_WARP_SIZE];
-  const int64_t i = blockIdx.x;
-  T_ACC sum1 = 0;
-  T_ACC sum2 = 0;
-  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
-    const int64_t index = i * N + j;
-    sum1 += static_cast<T_ACC>(X[index]);
-    sum2 += static_cast<T_ACC>(X[index]) * static_cast<T_ACC>(X[index]);
+int GroupNormVecSize(int64_t HxW, std::initializer_list<const T*> ptrs) {
+  if (HxW % kVecSize != 0) {
+    return 1;
   }
-  sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, m_shared);
-  sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, v_shared);
-  if (threadIdx.x == 0) {
-    const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
-    sum1 *= scale;
-    sum2 = c10::cuda::compat::max(sum2 * scale - sum1 * sum1, T_ACC(0));
-    mean[i] = sum1;
-    rstd[i] = c10::cuda::compat::rsqrt(sum2 + static_cast<T_ACC>(eps));
+  for (const T* ptr : ptrs) {
+    if (ptr != nullptr &&
+        memory::can_vectorize_up_to<T>(
+            reinterpret_cast<char*>(const_cast<T*>(ptr))) < kVecSize) {
+      return 1;
+    }
   }
+  return kVecSize;
 }
 
-template <typename T>
-__global__ void ComputeFusedParamsCUDAKernel(
-    int64_t N,
-    int64_t C,
-    int64_t group,
-    const T* mean,
-    const T* rstd,
-    const T* gamma,
-    const T* beta,
-    acc_type<T, true>* a,
-    acc_type<T, true>* b) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
-  if (index < N * C) {
-    const int64_t ng = index / (C / group);
-    const int64_t c = index % C;
-    const T_ACC x = (gamma == nullptr)
-        ? static_cast<T_ACC>(rstd[ng])
-        : static_cast<T_ACC>(rstd[ng]) * static_cast<T_ACC>(gamma[c]);
-    a[index] = x;
-    b[index] = -x * static_cast<T_ACC>(mean[ng]) +
-        (beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(beta[c]));
-  }
+// Number of threads of the per-group kernels, enough to read a group of
+// size D * HxW once with vectors of vec_size elements.
+int64_t GroupNormNumThreads(int64_t D, int64_t HxW, int vec_size) {
+  const int64_t num_vecs = (D * HxW + vec_size - 1) / vec_size;
+  const int64_t threads =
+      (num_vecs + C10_WARP_SIZE - 1) / C10_WARP_SIZE * C10_WARP_SIZE;
+  return std::min<int64_t>(
+      cuda_utils::kCUDABlockReduceNumThreads,
+      std::max<int64_t>(C10_WARP_SIZE, threads));
 }
 
-template <typename T>
-__global__ void GroupNormForwardSimpleCUDAKernel(
-    int64_t N,
+// One block per group of each sample, which computes the moments of the
+// group with Welford's algorithm and then normalizes it.
+template <typename T, int kVec>
+__global__ void GroupNormForwardFusedCUDAKernel(
     int64_t C,
     int64_t HxW,
+    int64_t group,
+    acc_type<T, true> eps,
+    WelfordOpsType<acc_type<T, true>> welford_op,
     const T* X,
-    const acc_type<T, true>* a,
-    const acc_type<T, true>* b,
+    const T* gamma,
+    const T* beta,
+    T* mean,
+    T* rstd,
     T* Y) {
   using T_ACC = acc_type<T, true>;
-  const int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
-  if (index < N * C * HxW) {
-    const int64_t nc = index / HxW;
-    Y[index] = a[nc] * static_cast<T_ACC>(X[index]) + b[nc];
+  using WelfordT = WelfordType<T_ACC>;
+  using Vec = memory::aligned_vector<T, kVec>;
+  using StorageT =
+      typename std::aligned_storage<sizeof(WelfordT), alignof(WelfordT)>::type;
+  __shared__ StorageT shared_storage[C10_WARP_SIZE];
+  WelfordT* shared = reinterpret_cast<WelfordT*>(shared_storage);
+  const int64_t D = C / group;
+  const int64_t ng = blockIdx.x;
+  const int64_t g = ng % group;
+  const int64_t num_vecs = D * HxW / kVec;
+  const Vec* X_vec = reinterpret_cast<const Vec*>(X + ng * D * HxW);
+  Vec* Y_vec = reinterpret_cast<Vec*>(Y + ng * D * HxW);
+
+  WelfordT moments;
+  for (int64_t j = threadIdx.x; j < num_vecs; j += blockDim.x) {
+    const Vec v = X_vec[j];
+#pragma unroll
+    for (int e = 0; e < kVec; ++e) {
+      moments = welford_op.reduce(
+          moments,
+          static_cast<T_ACC>(v.val[e]),
+          static_cast<int>(j * kVec + e));
+    }
+  }
+  moments = cuda_utils::BlockReduce(moments, welford_op, WelfordT(), shared);
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    shared[0] = moments;
+  }
+  __syncthreads();
+  moments = shared[0];
+  const T_ACC mean_v = moments.mean;
+  const T_ACC var_v = c10::cuda::compat::max(
+      moments.m2 / static_cast<T_ACC>(D * HxW), T_ACC(0));
+  const T_ACC rstd_v = c10::cuda::compat::rsqrt(var_v + eps);
+  if (threadIdx.x == 0) {
+    mean[ng] = mean_v;
+    rstd[ng] = rstd_v;
   }
-}
 
-template <typename T>
-__global__ void GroupNormForwardCUDAKernel(
-    int64_t HxW,
-    const T* X,
-    const acc_type<T, true>* a,
-    const acc_type<T, true>* b,
-    T* Y) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t nc = blockIdx.x;
-  for (int64_t hw = threadIdx.x; hw < HxW; hw += blockDim.x) {
-    const int64_t index = nc * HxW + hw;
-    Y[index] = a[nc] * static_cast<T_ACC>(X[index]) + b[nc];
+  for (int64_t j = threadIdx.x; j < num_vecs; j += blockDim.x) {
+    // All elements of a vector belong to the same channel.
+    const int64_t c = g * D + j * kVec / HxW;
+    const T_ACC gamma_v =
+        gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[c]);
+    const T_ACC beta_v =
+        beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(beta[c]);
+    const T_ACC a = rstd_v * gamma_v;
+    const T_ACC b = beta_v - a * mean_v;
+    const Vec v = X_vec[j];
+    Vec out;
+#pragma unroll
+    for (int e = 0; e < kVec; ++e) {
+      out.val[e] = static_cast<T>(a * static_cast<T_ACC>(v.val[e]) + b);
+    }
+    Y_vec[j] = out;
   }
 }
 
@@ -131,44 +162,29 @@ __global__ void ComputeInternalGradientsCUDAKernel(
   }
 }
 
-template <typename T>
-__global__ void ComputeGradOutputCoeffientCUDAKernel(
-    int64_t N,
-    int64_t C,
-    int64_t group,
-    const T* rstd,
-    const T* gamma,
-    acc_type<T, true>* c1) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t nc = blockIdx.x * blockDim.x + threadIdx.x;
-  if (nc < N * C) {
-    const int64_t ng = nc / (C / group);
-    const int64_t c = nc % C;
-    c1[nc] = static_cast<T_ACC>(rstd[ng]) *
-        (gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[c]));
-  }
-}
-
-template <typename T>
-__global__ void ComputeBackwardFusedParamsCUDAKernel(
+// One block per group of each sample, which computes the coefficients of
+// dX = c1 * dY + c2 * X + c3 of the group from ds and db, with
+// c1 = rstd * gamma, and then writes dX.
+template <typename T, int kVec>
+__global__ void GroupNormBackwardFusedCUDAKernel(
     int64_t C,
     int64_t HxW,
     int64_t group,
+    const T* dY,
+    const T* X,
     const T* mean,
     const T* rstd,
     const T* gamma,
     const acc_type<T, true>* ds,
     const acc_type<T, true>* db,
-    acc_type<T, true>* c2,
-    acc_type<T, true>* c3) {
+    T* dX) {
   using T_ACC = acc_type<T, true>;
+  using Vec = memory::aligned_vector<T, kVec>;
   __shared__ T_ACC ds_shared[C10_WARP_SIZE];
   __shared__ T_ACC db_shared[C10_WARP_SIZE];
-  const int64_t G = group;
-  const int64_t D = C / G;
-  const int64_t n = blockIdx.x;
-  const int64_t g = blockIdx.y;
-  const int64_t ng = n * G + g;
+  const int64_t D = C / group;
+  const int64_t ng = blockIdx.x;
+  const int64_t g = ng % group;
   T_ACC sum1 = 0;
   T_ACC sum2 = 0;
   for (int64_t i = threadIdx.x; i < D; i += blockDim.x) {
@@ -181,58 +197,40 @@ __global__ void ComputeBackwardFusedParamsCUDAKernel(
   }
   sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, ds_shared);
   sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, db_shared);
+  __syncthreads();
   if (threadIdx.x == 0) {
-    const T_ACC s = T_ACC(1) / static_cast<T_ACC>(D * HxW);
-    const T_ACC x = (sum2 * static_cast<T_ACC>(mean[ng]) - sum1) *
-        static_cast<T_ACC>(rstd[ng]) * static_cast<T_ACC>(rstd[ng]) *
-        static_cast<T_ACC>(rstd[ng]) * s;
-    c2[ng] = x;
-    c3[ng] = -x * static_cast<T_ACC>(mean[ng]) -
-        sum2 * static_cast<T_ACC>(rstd[ng]) * s;
+    ds_shared[0] = sum1;
+    db_shared[0] = sum2;
   }
-}
-
-template <typename T>
-__global__ void GroupNormBackwardSimpleCUDAKernel(
-    int64_t N,
-    int64_t C,
-    int64_t HxW,
-    int64_t group,
-    const T* dY,
-    const T* X,
-    const acc_type<T, true>* c1,
-    const acc_type<T, true>* c2,
-    const acc_type<T, true>* c3,
-    T* dX) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
-  if (index < N * C * HxW) {
-    const int64_t nc = index / HxW;
-    const int64_t ng = nc / (C / group);
-    dX[index] = c1[nc] * static_cast<T_ACC>(dY[index]) +
-        c2[ng] * static_cast<T_ACC>(X[index]) + c3[ng];
-  }
-}
+  __syncthreads();
+  sum1 = ds_shared[0];
+  sum2 = db_shared[0];
+  const T_ACC s = T_ACC(1) / static_cast<T_ACC>(D * HxW);
+  const T_ACC mean_v = static_cast<T_ACC>(mean[ng]);
+  const T_ACC rstd_v = static_cast<T_ACC>(rstd[ng]);
+  const T_ACC c2 = (sum2 * mean_v - sum1) * rstd_v * rstd_v * rstd_v * s;
+  const T_ACC c3 = -c2 * mean_v - sum2 * rstd_v * s;
 
-template <typename T>
-__global__ void GroupNormBackwardCUDAKernel(
-    int64_t C,
-    int64_t HxW,
-    int64_t group,
-    const T* dY,
-    const T* X,
-    const acc_type<T, true>* c1,
-    const acc_type<T, true>* c2,
-    const acc_type<T, true>* c3,
-    T* dX) {
-  using T_ACC = acc_type<T, true>;
-  const int64_t D = C / group;
-  const int64_t nc = blockIdx.x;
-  const int64_t ng = nc / D;
-  for (int64_t hw = threadIdx.x; hw < HxW; hw += blockDim.x) {
-    const int64_t index = nc * HxW + hw;
-    dX[index] = c1[nc] * static_cast<T_ACC>(dY[index]) +
-        c2[ng] * static_cast<T_ACC>(X[index]) + c3[ng];
+  const int64_t num_vecs = D * HxW / kVec;
+  const Vec* dY_vec = reinterpret_cast<const Vec*>(dY + ng * D * HxW);
+  const Vec* X_vec = reinterpret_cast<const Vec*>(X + ng * D * HxW);
+  Vec* dX_vec = reinterpret_cast<Vec*>(dX + ng * D * HxW);
+  for (int64_t j = threadIdx.x; j < num_vecs; j += blockDim.x) {
+    // All elements of a vector belong to the same channel.
+    const int64_t c = g * D + j * kVec / HxW;
+    const T_ACC c1 = gamma == nullptr
+        ? rstd_v
+        : rstd_v * static_cast<T_ACC>(gamma[c]);
+    const Vec dy = dY_vec[j];
+    const Vec x = X_vec[j];
+    Vec out;
+#pragma unroll
+    for (int e = 0; e < kVec; ++e) {
+      out.val[e] = static_cast<T>(
+          c1 * static_cast<T_ACC>(dy.val[e]) +
+          c2 * static_cast<T_ACC>(x.val[e]) + c3);
+    }
+    dX_vec[j] = out;
   }
 }
 
@@ -361,7 +359,7 @@ void GroupNormKernelImplInternal(
     int64_t C,
     int64_t HxW,
     int64_t group,
-    T eps,
+    double eps,
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
@@ -380,25 +378,40 @@ void GroupNormKernelImplInternal(
   T* Y_data = Y->data_ptr<T>();
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
-  const auto kAccType = X.scalar_type() == kHalf ? kFloat : X.scalar_type();
-  Tensor a = at::empty({N, C}, X.options().dtype(kAccType));
-  Tensor b = at::empty({N, C}, X.options().dtype(kAccType));
-  T_ACC* a_data = a.data_ptr<T_ACC>();
-  T_ACC* b_data = b.data_ptr<T_ACC>();
+  const WelfordOpsType<T_ACC> welford_op(
+      /*unbiased=*/false, /*take_sqrt=*/false);
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
-  RowwiseMomentsCUDAKernel<T>
-      <<<N * G, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
-          D * HxW, eps, X_data, mean_data, rstd_data);
-  int64_t B = (N * C + kCUDANumThreads - 1) / kCUDANumThreads;
-  ComputeFusedParamsCUDAKernel<T><<<B, kCUDANumThreads, 0, cuda_stream>>>(
-      N, C, G, mean_data, rstd_data, gamma_data, beta_data, a_data, b_data);
-  if (HxW < kCUDANumThreads) {
-    B = (N * C * HxW + kCUDANumThreads - 1) / kCUDANumThreads;
-    GroupNormForwardSimpleCUDAKernel<T><<<B, kCUDANumThreads, 0, cuda_stream>>>(
-        N, C, HxW, X_data, a_data, b_data, Y_data);
+  const int vec_size =
+      GroupNormVecSize<T>(HxW, {X_data, Y_data});
+  const int64_t num_threads = GroupNormNumThreads(D, HxW, vec_size);
+  if (vec_size == kVecSize) {
+    GroupNormForwardFusedCUDAKernel<T, kVecSize>
+        <<<N * G, num_threads, 0, cuda_stream>>>(
+            C,
+            HxW,
+            G,
+            static_cast<T_ACC>(eps),
+            welford_op,
+            X_data,
+            gamma_data,
+            beta_data,
+            mean_data,
+            rstd_data,
+            Y_data);
   } else {
-    GroupNormForwardCUDAKernel<T><<<N * C, kCUDANumThreads, 0, cuda_stream>>>(
-        HxW, X_data, a_data, b_data, Y_data);
+    GroupNormForwardFusedCUDAKernel<T, 1>
+        <<<N * G, num_threads, 0, cuda_stream>>>(
+            C,
+            HxW,
+            G,
+            static_cast<T_ACC>(eps),
+            welford_op,
+            X_data,
+            gamma_data,
+            beta_data,
+            mean_data,
+            rstd_data,
+            Y_data);
   }
   AT_CUDA_CHECK(cudaGetLastError());
 }
@@ -421,20 +434,8 @@ void GroupNormKernelImpl(
       X.scalar_type(),
       "GroupNormKernelImpl",
       [&]() {
-        AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "GroupNormKernelImpl", [&]() {
-          GroupNormKernelImplInternal<scalar_t>(
-              X,
-              gamma,
-              beta,
-              N,
-              C,
-              HxW,
-              group,
-              static_cast<scalar_t>(eps),
-              Y,
-              mean,
-              rstd);
-        });
+        GroupNormKernelImplInternal<scalar_t>(
+            X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
       });
 }
 
@@ -481,7 +482,11 @@ void GroupNormBackwardKernelImplInternal(
   const T* rstd_data = rstd.data_ptr<T>();
   const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
   T* dX_data = dX->defined() ? dX->data_ptr<T>() : nullptr;
-  const auto kAccType = X.scalar_type() == kHalf ? kFloat : X.scalar_type();
+  const int64_t D = C / G;
+  const auto kAccType =
+      (X.scalar_type() == kHalf || X.scalar_type() == kBFloat16)
+      ? kFloat
+      : X.scalar_type();
   Tensor ds = at::empty({N, C}, X.options().dtype(kAccType));
   Tensor db = at::empty({N, C}, X.options().dtype(kAccType));
   T_ACC* ds_data = ds.data_ptr<T_ACC>();
@@ -489,41 +494,38 @@ void GroupNormBackwardKernelImplInternal(
   ComputeInternalGradientsCUDAKernel<T>
       <<<N * C, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
           HxW, dY_data, X_data, ds_data, db_data);
-  if (dX != nullptr) {
-    Tensor c1 = at::empty({N, C}, X.options().dtype(kAccType));
-    Tensor c2 = at::empty({N, G}, X.options().dtype(kAccType));
-    Tensor c3 = at::empty({N, G}, X.options().dtype(kAccType));
-    T_ACC* c1_data = c1.data_ptr<T_ACC>();
-    T_ACC* c2_data = c2.data_ptr<T_ACC>();
-    T_ACC* c3_data = c3.data_ptr<T_ACC>();
-    int64_t B = (N * C + kCUDANumThreads - 1) / kCUDANumThreads;
-    ComputeGradOutputCoeffientCUDAKernel<T>
-        <<<B, kCUDANumThreads, 0, cuda_stream>>>(
-            N, C, G, rstd_data, gamma_data, c1_data);
-    ComputeBackwardFusedParamsCUDAKernel<T>
-        <<<dim3(N, G),
-           cuda_utils::kCUDABlockReduceNumThreads,
-           0,
-           cuda_stream>>>(
-            C,
-            HxW,
-            G,
-            mean_data,
-            rstd_data,
-            gamma_data,
-            ds_data,
-            db_data,
-            c2_data,
-            c3_data);
-    if (HxW < kCUDANumThreads) {
-      B = (N * C * HxW + kCUDANumThreads - 1) / kCUDANumThreads;
-      GroupNormBackwardSimpleCUDAKernel<
-          T><<<B, kCUDANumThreads, 0, cuda_stream>>>(
-          N, C, HxW, G, dY_data, X_data, c1_data, c2_data, c3_data, dX_data);
+  if (dX_data != nullptr) {
+    const int vec_size =
+        GroupNormVecSize<T>(HxW, {dY_data, X_data, dX_data});
+    const int64_t num_threads = GroupNormNumThreads(D, HxW, vec_size);
+    if (vec_size == kVecSize) {
+      GroupNormBackwardFusedCUDAKernel<T, kVecSize>
+          <<<N * G, num_threads, 0, cuda_stream>>>(
+              C,
+              HxW,
+              G,
+              dY_data,
+              X_data,
+              mean_data,
+              rstd_data,
+              gamma_data,
+              ds_data,
+              db_data,
+              dX_data);
     } else {
-      GroupNormBackwardCUDAKernel<T>
-          <<<N * C, kCUDANumThreads, 0, cuda_stream>>>(
-              C, HxW, G, dY_data, X_data, c1_data, c2_data, c3_data, dX_data);
+      GroupNormBackwardFusedCUDAKernel<T, 1>
+          <<<N * G, num_threads, 0, cuda_stream>>>(
+              C,
+              HxW,
+              G,
+              dY_data,
+              X_data,
+              mean_data,
+              rstd_data,
+              gamma_data,
+              ds_data,
+              db_data,
+              dX_data);
     }
   }
   if (dgamma->defined() || dbeta->defined()) {
@@ -582,22 +584,8 @@ void GroupNormBackwardKernelImpl(
       X.scalar_type(),
       "GroupNormBackwardKernelImpl",
       [&]() {
-        AT_SKIP_BFLOAT16_IF_NOT_ROCM(
-            scalar_t, "GroupNormBackwardKernelImpl", [&]() {
-              GroupNormBackwardKernelImplInternal<scalar_t>(
-                  dY,
-                  X,
-                  mean,
-                  rstd,
-                  gamma,
-                  N,
-                  C,
-                  HxW,
-                  group,
-                  dX,
-                  dgamma,
-                  dbeta);
-            });
+        GroupNormBackwardKernelImplInternal<scalar_t>(
+            dY, X, mean, rstd, gamma, N, C, HxW, group, dX, dgamma, dbeta);
       });
 }
 
@@ -5,12 +5,18 @@
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/native/SharedReduceOps.h>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <ATen/native/cuda/block_reduce.cuh>
 #include <THC/THCDeviceUtils.cuh>
 
 #include <c10/cuda/CUDAMathCompat.h>
 
+#include <initializer_list>
+#include <type_traits>
+
 namespace at {
 namespace native {
 
@@ -19,131 +25,396 @@ namespace {
 constexpr int kCUDANumThreads = 256;
 constexpr int kColwiseReduceTileSize = 32;
 
+// The fused kernels load and store rows kVecSize elements at a time and keep
+// up to kVecsPerThread vectors of a row per thread in registers, so that the
+// row is read from global memory once.
+constexpr int kVecSize = 4;
+constexpr int kVecsPerThread = 4;
+constexpr int kMaxFusedThreads = 1024;
+// Least number of rows per block of LayerNormBackwardFusedCUDAKernel when it
+// computes the partial sums of dgamma and dbeta, which bounds their size.
+constexpr int64_t kMinRowsPerPartial = 8;
+
+template <typename T_ACC>
+using WelfordType = WelfordData<T_ACC, int, T_ACC>;
+
+template <typename T_ACC>
+using WelfordOpsType =
+    WelfordOps<T_ACC, T_ACC, int, T_ACC, thrust::pair<T_ACC, T_ACC>>;
+
+// Combines the moments of the threads of the block, and returns the result
+// to all of them.
+template <typename T_ACC>
+__device__ WelfordType<T_ACC> BlockWelford(
+    WelfordType<T_ACC> val,
+    const WelfordOpsType<T_ACC>& welford_op) {
+  using WelfordT = WelfordType<T_ACC>;
+  // WelfordData has a constructor, which __shared__ variables cannot have.
+  using StorageT =
+      typename std::aligned_storage<sizeof(WelfordT), alignof(WelfordT)>::type;
+  __shared__ StorageT shared_storage[C10_WARP_SIZE];
+  WelfordT* shared = reinterpret_cast<WelfordT*>(shared_storage);
+  val = cuda_utils::BlockReduce(val, welford_op, WelfordT(), shared);
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    shared[0] = val;
+  }
+  __syncthreads();
+  return shared[0];
+}
+
+// Returns to all threads of the block the sums of sum1 and sum2.
+template <typename T_ACC>
+__device__ thrust::pair<T_ACC, T_ACC> BlockReduceSum2(T_ACC sum1, T_ACC sum2) {
+  __shared__ T_ACC shared1[C10_WARP_SIZE];
+  __shared__ T_ACC shared2[C10_WARP_SIZE];
+  sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, shared1);
+  sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, shared2);
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    shared1[0] = sum1;
+    shared2[0] = sum2;
+  }
+  __syncthreads();
+  return thrust::make_pair(shared1[0], shared2[0]);
+}
+
+template <typename T>
+bool CanUseFusedKernels(int64_t N, std::initializer_list<const T*> ptrs) {
+  if (N % kVecSize != 0 ||
+      (N / kVecSize + kVecsPerThread - 1) / kVecsPerThread > kMaxFusedThreads) {
+    return false;
+  }
+  for (const T* ptr : ptrs) {
+    if (ptr != nullptr &&
+        memory::can_vectorize_up_to<T>(
+            reinterpret_cast<char*>(const_cast<T*>(ptr))) < kVecSize) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t FusedNumThreads(int64_t N) {
+  const int64_t num_vecs = N / kVecSize;
+  const int64_t threads = (num_vecs + kVecsPerThread - 1) / kVecsPerThread;
+  return std::max<int64_t>(
+      C10_WARP_SIZE,
+      (threads + C10_WARP_SIZE - 1) / C10_WARP_SIZE * C10_WARP_SIZE);
+}
+
+// One block per row, which it reads once into registers. The mean and
+// variance of the elements of each thread are computed from the registers,
+// and merged across the block with Welford's algorithm.
 template <typename T>
-__global__ void RowwiseMomentsCUDAKernel(
+__global__ void LayerNormForwardFusedCUDAKernel(
     int64_t N,
-    T eps,
+    acc_type<T, true> eps,
+    WelfordOpsType<acc_type<T, true>> welford_op,
     const T* X,
+    const T* gamma,
+    const T* beta,
     T* mean,
-    T* rstd) {
+    T* rstd,
+    T* Y) {
   using T_ACC = acc_type<T, true>;
-  __shared__ T_ACC m_shared[C10_WARP_SIZE];
-  __shared__ T_ACC v_shared[C10_WARP_SIZE];
+  using Vec = memory::aligned_vector<T, kVecSize>;
   const int64_t i = blockIdx.x;
-  T_ACC sum1 = 0;
-  T_ACC sum2 = 0;
-  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
-    const int64_t index = i * N + j;
-    sum1 += static_cast<T_ACC>(X[index]);
-    sum2 += static_cast<T_ACC>(X[index]) * static_cast<T_ACC>(X[index]);
+  const int64_t num_vecs = N / kVecSize;
+  const Vec* X_vec = reinterpret_cast<const Vec*>(X + i * N);
+  T_ACC x[kVecsPerThread][kVecSize];
+  int count = 0;
+  T_ACC sum = 0;
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t j = threadIdx.x + k * blockDim.x;
+    if (j < num_vecs) {
+      const Vec v = X_vec[j];
+#pragma unroll
+      for (int e = 0; e < kVecSize; ++e) {
+        x[k][e] = static_cast<T_ACC>(v.val[e]);
+        sum += x[k][e];
+      }
+      count += kVecSize;
+    }
   }
-  sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, m_shared);
-  sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, v_shared);
+  const T_ACC thread_mean =
+      count > 0 ? sum / static_cast<T_ACC>(count) : T_ACC(0);
+  T_ACC m2 = 0;
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    if (threadIdx.x + k * blockDim.x < num_vecs) {
+#pragma unroll
+      for (int e = 0; e < kVecSize; ++e) {
+        const T_ACC d = x[k][e] - thread_mean;
+        m2 += d * d;
+      }
+    }
+  }
+  const WelfordType<T_ACC> moments = BlockWelford(
+      WelfordType<T_ACC>(thread_mean, m2, count, static_cast<T_ACC>(count)),
+      welford_op);
+  const T_ACC mean_v = moments.mean;
+  const T_ACC var_v = c10::cuda::compat::max(
+      moments.m2 / static_cast<T_ACC>(N), T_ACC(0));
+  const T_ACC rstd_v = c10::cuda::compat::rsqrt(var_v + eps);
   if (threadIdx.x == 0) {
-    const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
-    sum1 *= scale;
-    sum2 = c10::cuda::compat::max(sum2 * scale - sum1 * sum1, T_ACC(0));
-    mean[i] = sum1;
-    rstd[i] = c10::cuda::compat::rsqrt(sum2 + static_cast<T_ACC>(eps));
+    mean[i] = mean_v;
+    rstd[i] = rstd_v;
+  }
+
+  const Vec* gamma_vec = reinterpret_cast<const Vec*>(gamma);
+  const Vec* beta_vec = reinterpret_cast<const Vec*>(beta);
+  Vec* Y_vec = reinterpret_cast<Vec*>(Y + i * N);
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t j = threadIdx.x + k * blockDim.x;
+    if (j < num_vecs) {
+      Vec g;
+      Vec b;
+      if (gamma_vec != nullptr) {
+        g = gamma_vec[j];
+      }
+      if (beta_vec != nullptr) {
+        b = beta_vec[j];
+      }
+      Vec out;
+#pragma unroll
+      for (int e = 0; e < kVecSize; ++e) {
+        const T_ACC gamma_v =
+            gamma_vec == nullptr ? T_ACC(1) : static_cast<T_ACC>(g.val[e]);
+        const T_ACC beta_v =
+            beta_vec == nullptr ? T_ACC(0) : static_cast<T_ACC>(b.val[e]);
+        out.val[e] = static_cast<T>(
+            (x[k][e] - mean_v) * rstd_v * gamma_v + beta_v);
+      }
+      Y_vec[j] = out;
+    }
   }
 }
 
+// Same as LayerNormForwardFusedCUDAKernel for rows that cannot be vectorized
+// or do not fit in registers, which are read twice.
 template <typename T>
 __global__ void LayerNormForwardCUDAKernel(
     int64_t N,
+    acc_type<T, true> eps,
+    WelfordOpsType<acc_type<T, true>> welford_op,
     const T* X,
-    const T* mean,
-    const T* rstd,
     const T* gamma,
     const T* beta,
+    T* mean,
+    T* rstd,
     T* Y) {
   using T_ACC = acc_type<T, true>;
   const int64_t i = blockIdx.x;
+  WelfordType<T_ACC> moments;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    moments = welford_op.reduce(
+        moments, static_cast<T_ACC>(X[i * N + j]), static_cast<int>(j));
+  }
+  moments = BlockWelford(moments, welford_op);
+  const T_ACC mean_v = moments.mean;
+  const T_ACC var_v = c10::cuda::compat::max(
+      moments.m2 / static_cast<T_ACC>(N), T_ACC(0));
+  const T_ACC rstd_v = c10::cuda::compat::rsqrt(var_v + eps);
+  if (threadIdx.x == 0) {
+    mean[i] = mean_v;
+    rstd[i] = rstd_v;
+  }
   for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
     const int64_t index = i * N + j;
     const T_ACC gamma_v =
         gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
     const T_ACC beta_v =
         beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(beta[j]);
-    Y[index] = (static_cast<T_ACC>(X[index]) - static_cast<T_ACC>(mean[i])) *
-            static_cast<T_ACC>(rstd[i]) * gamma_v +
+    Y[index] = (static_cast<T_ACC>(X[index]) - mean_v) * rstd_v * gamma_v +
         beta_v;
   }
 }
 
+// Each block handles rows blockIdx.x, blockIdx.x + gridDim.x, ... , which it
+// reads once into registers to compute their dX. Each thread handles the
+// same columns of all of these rows, so it also sums their terms of dgamma
+// and dbeta, which are written to row blockIdx.x of dgamma_partial and
+// dbeta_partial, if not null, and summed by GammaBetaPartialsCUDAKernel.
 template <typename T>
-__global__ void ComputeInternalGradientsCUDAKernel(
+__global__ void LayerNormBackwardFusedCUDAKernel(
+    int64_t M,
     int64_t N,
     const T* dY,
     const T* X,
+    const T* mean,
+    const T* rstd,
     const T* gamma,
-    acc_type<T, true>* ds,
-    acc_type<T, true>* db) {
+    T* dX,
+    acc_type<T, true>* dgamma_partial,
+    acc_type<T, true>* dbeta_partial) {
   using T_ACC = acc_type<T, true>;
-  __shared__ T_ACC ds_shared[C10_WARP_SIZE];
-  __shared__ T_ACC db_shared[C10_WARP_SIZE];
-  const int64_t i = blockIdx.x;
-  T_ACC sum1 = 0;
-  T_ACC sum2 = 0;
-  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
-    const int64_t index = i * N + j;
-    const T_ACC gamma_v =
-        gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
-    sum1 +=
-        static_cast<T_ACC>(dY[index]) * static_cast<T_ACC>(X[index]) * gamma_v;
-    sum2 += static_cast<T_ACC>(dY[index]) * gamma_v;
+  using Vec = memory::aligned_vector<T, kVecSize>;
+  using AccVec = memory::aligned_vector<T_ACC, kVecSize>;
+  const int64_t num_vecs = N / kVecSize;
+  const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
+
+  T_ACC g[kVecsPerThread][kVecSize];
+  T_ACC dg_sum[kVecsPerThread][kVecSize];
+  T_ACC db_sum[kVecsPerThread][kVecSize];
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t j = threadIdx.x + k * blockDim.x;
+#pragma unroll
+    for (int e = 0; e < kVecSize; ++e) {
+      g[k][e] = T_ACC(1);
+      dg_sum[k][e] = T_ACC(0);
+      db_sum[k][e] = T_ACC(0);
+    }
+    if (gamma != nullptr && j < num_vecs) {
+      const Vec v = reinterpret_cast<const Vec*>(gamma)[j];
+#pragma unroll
+      for (int e = 0; e < kVecSize; ++e) {
+        g[k][e] = static_cast<T_ACC>(v.val[e]);
+      }
+    }
   }
-  sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, ds_shared);
-  sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, db_shared);
-  if (threadIdx.x == 0) {
-    ds[i] = sum1;
-    db[i] = sum2;
+
+  for (int64_t i = blockIdx.x; i < M; i += gridDim.x) {
+    const Vec* dY_vec = reinterpret_cast<const Vec*>(dY + i * N);
+    const Vec* X_vec = reinterpret_cast<const Vec*>(X + i * N);
+    const T_ACC mean_v = static_cast<T_ACC>(mean[i]);
+    const T_ACC rstd_v = static_cast<T_ACC>(rstd[i]);
+    T_ACC dy[kVecsPerThread][kVecSize];
+    T_ACC x[kVecsPerThread][kVecSize];
+    T_ACC ds = 0;
+    T_ACC db = 0;
+#pragma unroll
+    for (int k = 0; k < kVecsPerThread; ++k) {
+      const int64_t j = threadIdx.x + k * blockDim.x;
+      if (j < num_vecs) {
+        const Vec dy_v = dY_vec[j];
+        const Vec x_v = X_vec[j];
+#pragma unroll
+        for (int e = 0; e < kVecSize; ++e) {
+          dy[k][e] = static_cast<T_ACC>(dy_v.val[e]);
+          x[k][e] = static_cast<T_ACC>(x_v.val[e]);
+          ds += dy[k][e] * g[k][e] * x[k][e];
+          db += dy[k][e] * g[k][e];
+          dg_sum[k][e] += dy[k][e] * (x[k][e] - mean_v) * rstd_v;
+          db_sum[k][e] += dy[k][e];
+        }
+      }
+    }
+    if (dX == nullptr) {
+      continue;
+    }
+    const thrust::pair<T_ACC, T_ACC> sums = BlockReduceSum2(ds, db);
+    ds = sums.first;
+    db = sums.second;
+    const T_ACC b = (db * mean_v - ds) * rstd_v * rstd_v * rstd_v * s;
+    const T_ACC c = -(b * mean_v + db * rstd_v * s);
+    Vec* dX_vec = reinterpret_cast<Vec*>(dX + i * N);
+#pragma unroll
+    for (int k = 0; k < kVecsPerThread; ++k) {
+      const int64_t j = threadIdx.x + k * blockDim.x;
+      if (j < num_vecs) {
+        Vec out;
+#pragma unroll
+        for (int e = 0; e < kVecSize; ++e) {
+          out.val[e] = static_cast<T>(
+              rstd_v * dy[k][e] * g[k][e] + b * x[k][e] + c);
+        }
+        dX_vec[j] = out;
+      }
+    }
+  }
+
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t j = threadIdx.x + k * blockDim.x;
+    if (j < num_vecs) {
+      if (dgamma_partial != nullptr) {
+        AccVec out;
+#pragma unroll
+        for (int e = 0; e < kVecSize; ++e) {
+          out.val[e] = dg_sum[k][e];
+        }
+        reinterpret_cast<AccVec*>(dgamma_partial + blockIdx.x * N)[j] = out;
+      }
+      if (dbeta_partial != nullptr) {
+        AccVec out;
+#pragma unroll
+        for (int e = 0; e < kVecSize; ++e) {
+          out.val[e] = db_sum[k][e];
+        }
+        reinterpret_cast<AccVec*>(dbeta_partial + blockIdx.x * N)[j] = out;
+      }
+    }
   }
 }
 
+// Sums the G rows of the partial sums of LayerNormBackwardFusedCUDAKernel.
 template <typename T>
-__global__ void ComputeGradientFusedParamsCUDAKernel(
-    int64_t M,
+__global__ void GammaBetaPartialsCUDAKernel(
+    int64_t G,
     int64_t N,
-    const T* mean,
-    const T* rstd,
-    const acc_type<T, true>* ds,
-    const acc_type<T, true>* db,
-    acc_type<T, true>* c1,
-    acc_type<T, true>* c2) {
+    const acc_type<T, true>* dgamma_partial,
+    const acc_type<T, true>* dbeta_partial,
+    T* dgamma,
+    T* dbeta) {
   using T_ACC = acc_type<T, true>;
-  const int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
-  if (index < M) {
-    const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
-    const T_ACC a = (db[index] * static_cast<T_ACC>(mean[index]) - ds[index]) *
-        static_cast<T_ACC>(rstd[index]) * static_cast<T_ACC>(rstd[index]) *
-        static_cast<T_ACC>(rstd[index]) * s;
-    c1[index] = a;
-    c2[index] =
-        -(a * static_cast<T_ACC>(mean[index]) +
-          db[index] * static_cast<T_ACC>(rstd[index]) * s);
+  const int64_t j = blockIdx.x * blockDim.x + threadIdx.x;
+  if (j < N) {
+    T_ACC sum1 = 0;
+    T_ACC sum2 = 0;
+    for (int64_t i = 0; i < G; ++i) {
+      sum1 += dgamma == nullptr ? T_ACC(0) : dgamma_partial[i * N + j];
+      sum2 += dbeta == nullptr ? T_ACC(0) : dbeta_partial[i * N + j];
+    }
+    if (dgamma != nullptr) {
+      dgamma[j] = sum1;
+    }
+    if (dbeta != nullptr) {
+      dbeta[j] = sum2;
+    }
   }
 }
 
+// Same as LayerNormBackwardFusedCUDAKernel without dgamma and dbeta, for
+// rows that cannot be vectorized or do not fit in registers.
 template <typename T>
-__global__ void LayerNormBackwardCUDAKenrel(
+__global__ void LayerNormBackwardCUDAKernel(
     int64_t N,
     const T* dY,
     const T* X,
+    const T* mean,
+    const T* rstd,
     const T* gamma,
-    const T* a,
-    const acc_type<T, true>* b,
-    const acc_type<T, true>* c,
     T* dX) {
   using T_ACC = acc_type<T, true>;
   const int64_t i = blockIdx.x;
+  T_ACC ds = 0;
+  T_ACC db = 0;
   for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
     const int64_t index = i * N + j;
     const T_ACC gamma_v =
         gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
-    dX[index] =
-        static_cast<T_ACC>(a[i]) * static_cast<T_ACC>(dY[index]) * gamma_v +
-        b[i] * static_cast<T_ACC>(X[index]) + c[i];
+    ds += static_cast<T_ACC>(dY[index]) * static_cast<T_ACC>(X[index]) *
+        gamma_v;
+    db += static_cast<T_ACC>(dY[index]) * gamma_v;
+  }
+  const thrust::pair<T_ACC, T_ACC> sums = BlockReduceSum2(ds, db);
+  ds = sums.first;
+  db = sums.second;
+  const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
+  const T_ACC mean_v = static_cast<T_ACC>(mean[i]);
+  const T_ACC rstd_v = static_cast<T_ACC>(rstd[i]);
+  const T_ACC b = (db * mean_v - ds) * rstd_v * rstd_v * rstd_v * s;
+  const T_ACC c = -(b * mean_v + db * rstd_v * s);
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    const int64_t index = i * N + j;
+    const T_ACC gamma_v =
+        gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
+    dX[index] = rstd_v * static_cast<T_ACC>(dY[index]) * gamma_v +
+        b * static_cast<T_ACC>(X[index]) + c;
   }
 }
 
@@ -261,25 +532,48 @@ void LayerNormKernelImplInternal(
     const Tensor& beta,
     int64_t M,
     int64_t N,
-    T eps,
+    double eps,
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
   DCHECK_EQ(X.numel(), M * N);
   DCHECK(!gamma.defined() || gamma.numel() == N);
   DCHECK(!beta.defined() || beta.numel() == N);
+  using T_ACC = acc_type<T, true>;
   const T* X_data = X.data_ptr<T>();
   const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
   const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
   T* Y_data = Y->data_ptr<T>();
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
+  const WelfordOpsType<T_ACC> welford_op(
+      /*unbiased=*/false, /*take_sqrt=*/false);
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
-  RowwiseMomentsCUDAKernel<T>
-      <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
-          N, eps, X_data, mean_data, rstd_data);
-  LayerNormForwardCUDAKernel<T><<<M, kCUDANumThreads, 0, cuda_stream>>>(
-      N, X_data, mean_data, rstd_data, gamma_data, beta_data, Y_data);
+  if (CanUseFusedKernels<T>(N, {X_data, gamma_data, beta_data, Y_data})) {
+    LayerNormForwardFusedCUDAKernel<T>
+        <<<M, FusedNumThreads(N), 0, cuda_stream>>>(
+            N,
+            static_cast<T_ACC>(eps),
+            welford_op,
+            X_data,
+            gamma_data,
+            beta_data,
+            mean_data,
+            rstd_data,
+            Y_data);
+  } else {
+    LayerNormForwardCUDAKernel<T>
+        <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
+            N,
+            static_cast<T_ACC>(eps),
+            welford_op,
+            X_data,
+            gamma_data,
+            beta_data,
+            mean_data,
+            rstd_data,
+            Y_data);
+  }
   AT_CUDA_CHECK(cudaGetLastError());
 }
 
@@ -295,10 +589,8 @@ void LayerNormKernelImpl(
     Tensor* rstd) {
   AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
       X.scalar_type(), "LayerNormKernelImpl", [&]() {
-        AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "LayerNormKernelImpl", [&] {
-          LayerNormKernelImplInternal<scalar_t>(
-              X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
-        });
+        LayerNormKernelImplInternal<scalar_t>(
+            X, gamma, beta, M, N, eps, Y, mean, rstd);
       });
 }
 
@@ -327,45 +619,77 @@ void LayerNormBackwardKernelImplInternal(
   const T* gamma_data =
       gamma.defined() ? gamma.template data_ptr<T>() : nullptr;
   T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
+  T* dgamma_data =
+      dgamma->defined() ? dgamma->template data_ptr<T>() : nullptr;
+  T* dbeta_data = dbeta->defined() ? dbeta->template data_ptr<T>() : nullptr;
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
-  if (dX_data != nullptr) {
-    const auto kAccType = (X.scalar_type() == kHalf || X.scalar_type() == kBFloat16) ? kFloat : X.scalar_type();
-    Tensor ds = at::empty({M}, X.options().dtype(kAccType));
-    Tensor db = at::empty({M}, X.options().dtype(kAccType));
-    Tensor scale = at::empty({M}, X.options().dtype(kAccType));
-    Tensor bias = at::empty({M}, X.options().dtype(kAccType));
-    T_ACC* ds_data = ds.template data_ptr<T_ACC>();
-    T_ACC* db_data = db.template data_ptr<T_ACC>();
-    T_ACC* scale_data = scale.template data_ptr<T_ACC>();
-    T_ACC* bias_data = bias.template data_ptr<T_ACC>();
-    ComputeInternalGradientsCUDAKernel<T>
-        <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
-            N, dY_data, X_data, gamma_data, ds_data, db_data);
-    const int64_t B = (M + kCUDANumThreads - 1) / kCUDANumThreads;
-    ComputeGradientFusedParamsCUDAKernel<T>
-        <<<B, kCUDANumThreads, 0, cuda_stream>>>(
-            M,
-            N,
-            mean_data,
-            rstd_data,
-            ds_data,
-            db_data,
-            scale_data,
-            bias_data);
-    LayerNormBackwardCUDAKenrel<T><<<M, kCUDANumThreads, 0, cuda_stream>>>(
+  if (CanUseFusedKernels<T>(N, {dY_data, X_data, gamma_data, dX_data})) {
+    // One wave of blocks, each of which handles several rows. When dgamma or
+    // dbeta are needed, each block also handles at least kMinRowsPerPartial
+    // rows, so that their partial sums stay small next to dY and X.
+    const int64_t num_threads = FusedNumThreads(N);
+    const cudaDeviceProp* prop = at::cuda::getCurrentDeviceProperties();
+    int64_t G = std::min<int64_t>(
+        M,
+        prop->multiProcessorCount *
+            std::max<int64_t>(
+                1, prop->maxThreadsPerMultiProcessor / num_threads));
+    const bool need_partials = dgamma_data != nullptr || dbeta_data != nullptr;
+    if (need_partials) {
+      G = std::min(
+          G,
+          std::max<int64_t>(
+              prop->multiProcessorCount,
+              (M + kMinRowsPerPartial - 1) / kMinRowsPerPartial));
+    }
+    const auto kAccType =
+        (X.scalar_type() == kHalf || X.scalar_type() == kBFloat16)
+        ? kFloat
+        : X.scalar_type();
+    Tensor dgamma_partial;
+    Tensor dbeta_partial;
+    if (dgamma_data != nullptr) {
+      dgamma_partial = at::empty({G, N}, X.options().dtype(kAccType));
+    }
+    if (dbeta_data != nullptr) {
+      dbeta_partial = at::empty({G, N}, X.options().dtype(kAccType));
+    }
+    T_ACC* dgamma_partial_data = dgamma_partial.defined()
+        ? dgamma_partial.template data_ptr<T_ACC>()
+        : nullptr;
+    T_ACC* dbeta_partial_data = dbeta_partial.defined()
+        ? dbeta_partial.template data_ptr<T_ACC>()
+        : nullptr;
+    LayerNormBackwardFusedCUDAKernel<T><<<G, num_threads, 0, cuda_stream>>>(
+        M,
         N,
         dY_data,
         X_data,
-        gamma_data,
+        mean_data,
         rstd_data,
-        scale_data,
-        bias_data,
-        dX_data);
+        gamma_data,
+        dX_data,
+        dgamma_partial_data,
+        dbeta_partial_data);
+    if (need_partials) {
+      const int64_t B = (N + kCUDANumThreads - 1) / kCUDANumThreads;
+      GammaBetaPartialsCUDAKernel<T><<<B, kCUDANumThreads, 0, cuda_stream>>>(
+          G,
+          N,
+          dgamma_partial_data,
+          dbeta_partial_data,
+          dgamma_data,
+          dbeta_data);
+    }
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
   }
-  if (dgamma->defined() || dbeta->defined()) {
-    T* dgamma_data =
-        dgamma->defined() ? dgamma->template data_ptr<T>() : nullptr;
-    T* dbeta_data = dbeta->defined() ? dbeta->template data_ptr<T>() : nullptr;
+  if (dX_data != nullptr) {
+    LayerNormBackwardCUDAKernel<T>
+        <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
+            N, dY_data, X_data, mean_data, rstd_data, gamma_data, dX_data);
+  }
+  if (dgamma_data != nullptr || dbeta_data != nullptr) {
     if (M < 512) {
       // For small batch size, do colwise reduce directly.
       const int64_t B = (N + kCUDANumThreads - 1) / kCUDANumThreads;
@@ -396,6 +720,7 @@ void LayerNormBackwardKernelImplInternal(
               dbeta_data);
     }
   }
+  AT_CUDA_CHECK(cudaGetLastError());
 }
 
 void LayerNormBackwardKernelImpl(
@@ -411,10 +736,8 @@ void LayerNormBackwardKernelImpl(
     Tensor* dbeta) {
   AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
       X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
-        AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "LayerNormBackwardKernelImpl", [&] {
-          LayerNormBackwardKernelImplInternal<scalar_t>(
-              dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
-        });
+        LayerNormBackwardKernelImplInternal<scalar_t>(
+            dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
       });
 }
 
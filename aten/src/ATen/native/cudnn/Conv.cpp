@@ -76,6 +76,7 @@ std::tuple<at::Tensor,at::Tensor> cudnn_convolution_transpose_backward(
 
 #include <THC/THC.h>
 
+#include <ATen/cudnn/BenchmarkCache.h>
 #include <ATen/cudnn/cudnn-wrapper.h>
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
@@ -83,6 +84,7 @@ std::tuple<at::Tensor,at::Tensor> cudnn_convolution_transpose_backward(
 #include <ATen/native/utils/ParamsHash.h>
 
 #include <ATen/TensorUtils.h>
+#include <ATen/cuda/CUDAContext.h>
 
 #include <functional>
 #include <iterator>
@@ -215,6 +217,7 @@ struct ConvolutionParams
   int dilation[max_dim];
   int64_t groups;
   bool deterministic;
+  int device_id;
   // NB: transposed purposely omitted: transposed just swaps
   // forward and backward, so you can reuse the benchmark entry,
 };
@@ -250,6 +253,7 @@ void setConvolutionParams(
   // CuDNN, but it doesn't seem worth the effort to actually do this.
   params->groups = groups;
   params->deterministic = deterministic;
+  params->device_id = c10::cuda::current_device();
 }
 
 // Convenience struct for passing around descriptors and data
@@ -275,8 +279,15 @@ struct ConvolutionArgs {
 // TODO: Use something less heavy duty than a big honking mutex
 template <typename T>
 struct BenchmarkCache {
+  struct Entry {
+    T perf;
+    // Whether perf was selected by benchmarking rather than by the
+    // heuristics of cuDNN. Only these entries are serialized.
+    bool benchmarked;
+  };
+
   std::mutex mutex;
-  std::unordered_map<ConvolutionParams, T, ParamsHash<ConvolutionParams>, ParamsEqual<ConvolutionParams>> map;
+  std::unordered_map<ConvolutionParams, Entry, ParamsHash<ConvolutionParams>, ParamsEqual<ConvolutionParams>> map;
 
   bool find(const ConvolutionParams& params, T* results) {
     std::lock_guard<std::mutex> guard(mutex);
@@ -284,13 +295,30 @@ struct BenchmarkCache {
     if (it == map.end()) {
       return false;
     }
-    *results = it->second;
+    *results = it->second.perf;
     return true;
   }
 
-  void insert(const ConvolutionParams& params, const T& results) {
+  void insert(const ConvolutionParams& params, const T& results, bool benchmarked) {
+    std::lock_guard<std::mutex> guard(mutex);
+    map[params] = Entry{results, benchmarked};
+  }
+
+  // Returns false if params is cached already
+  bool insert_if_absent(const ConvolutionParams& params, const T& results) {
     std::lock_guard<std::mutex> guard(mutex);
-    map[params] = results;
+    return map.emplace(params, Entry{results, true}).second;
+  }
+
+  std::vector<std::pair<ConvolutionParams, T>> benchmarked_entries() {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<std::pair<ConvolutionParams, T>> entries;
+    for (const auto& kv : map) {
+      if (kv.second.benchmarked) {
+        entries.emplace_back(kv.first, kv.second.perf);
+      }
+    }
+    return entries;
   }
 };
 
@@ -298,6 +326,140 @@ BenchmarkCache<cudnnConvolutionFwdAlgoPerf_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgoPerf_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgoPerf_t> bwd_filter_algos;
 
+// ---------------------------------------------------------------------
+//
+// Benchmark cache serialization
+//
+// ---------------------------------------------------------------------
+
+// The serialized cache is a header followed by the entries of fwd_algos,
+// bwd_data_algos and bwd_filter_algos, each preceded by its number of
+// entries. It is read by the build that wrote it, so the entries hold
+// ConvolutionParams as is, except for device_id, which is replaced by the
+// name and compute capability of the device.
+constexpr char kBenchmarkCacheMagic[] = "cudnn_benchmark_cache";
+constexpr uint32_t kBenchmarkCacheFormatVersion = 1;
+
+std::string deviceSignature(int device) {
+  const cudaDeviceProp* prop = at::cuda::getDeviceProperties(device);
+  std::ostringstream ss;
+  ss << prop->name << " sm_" << prop->major << prop->minor;
+  return ss.str();
+}
+
+template <typename T>
+void writePod(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::string& out, const std::string& value) {
+  writePod<uint64_t>(out, value.size());
+  out.append(value);
+}
+
+struct BenchmarkCacheReader {
+  const std::string& data;
+  size_t pos = 0;
+
+  explicit BenchmarkCacheReader(const std::string& data) : data(data) {}
+
+  template <typename T>
+  T readPod() {
+    TORCH_CHECK(pos + sizeof(T) <= data.size(), "Truncated cuDNN benchmark cache");
+    T value;
+    memcpy(&value, data.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+
+  std::string readString() {
+    const uint64_t size = readPod<uint64_t>();
+    TORCH_CHECK(pos + size <= data.size(), "Truncated cuDNN benchmark cache");
+    std::string value = data.substr(pos, size);
+    pos += size;
+    return value;
+  }
+};
+
+template <typename perf_t>
+void serializeCache(std::string& out, BenchmarkCache<perf_t>& cache) {
+  const auto entries = cache.benchmarked_entries();
+  writePod<uint64_t>(out, entries.size());
+  for (const auto& entry : entries) {
+    ConvolutionParams params = entry.first;
+    writeString(out, deviceSignature(params.device_id));
+    params.device_id = -1;
+    writePod(out, params);
+    writePod<int32_t>(out, entry.second.algo);
+    writePod<int32_t>(out, entry.second.mathType);
+    writePod<uint64_t>(out, entry.second.memory);
+  }
+}
+
+template <typename perf_t>
+size_t loadCache(
+    BenchmarkCacheReader& reader,
+    BenchmarkCache<perf_t>& cache,
+    const std::vector<std::string>& signatures) {
+  size_t loaded = 0;
+  const uint64_t count = reader.readPod<uint64_t>();
+  for (uint64_t i = 0; i < count; i++) {
+    const std::string signature = reader.readString();
+    ConvolutionParams params = reader.readPod<ConvolutionParams>();
+    perf_t perf;
+    memset(&perf, 0, sizeof(perf));
+    perf.algo = static_cast<decltype(perf.algo)>(reader.readPod<int32_t>());
+    perf.mathType = static_cast<cudnnMathType_t>(reader.readPod<int32_t>());
+    perf.memory = reader.readPod<uint64_t>();
+    perf.status = CUDNN_STATUS_SUCCESS;
+    perf.time = -1;
+    for (size_t device = 0; device < signatures.size(); device++) {
+      if (signatures[device] == signature) {
+        params.device_id = device;
+        loaded += cache.insert_if_absent(params, perf);
+      }
+    }
+  }
+  return loaded;
+}
+
+std::string serializeCudnnBenchmarkCache() {
+  std::string out;
+  writeString(out, kBenchmarkCacheMagic);
+  writePod(out, kBenchmarkCacheFormatVersion);
+  writePod<uint64_t>(out, cudnnGetVersion());
+  writePod<uint64_t>(out, sizeof(ConvolutionParams));
+  serializeCache(out, fwd_algos);
+  serializeCache(out, bwd_data_algos);
+  serializeCache(out, bwd_filter_algos);
+  return out;
+}
+
+size_t loadCudnnBenchmarkCache(const std::string& data) {
+  BenchmarkCacheReader reader(data);
+  TORCH_CHECK(reader.readString() == kBenchmarkCacheMagic,
+              "Invalid cuDNN benchmark cache");
+  const uint32_t format_version = reader.readPod<uint32_t>();
+  const uint64_t cudnn_version = reader.readPod<uint64_t>();
+  const uint64_t params_size = reader.readPod<uint64_t>();
+  if (format_version != kBenchmarkCacheFormatVersion ||
+      cudnn_version != cudnnGetVersion() ||
+      params_size != sizeof(ConvolutionParams)) {
+    TORCH_WARN("Ignoring cuDNN benchmark cache saved with cuDNN ", cudnn_version,
+               " by a different build (current cuDNN is ", cudnnGetVersion(), ")");
+    return 0;
+  }
+
+  std::vector<std::string> signatures;
+  for (int64_t device = 0; device < at::cuda::getNumGPUs(); device++) {
+    signatures.push_back(deviceSignature(device));
+  }
+  size_t loaded = loadCache(reader, fwd_algos, signatures);
+  loaded += loadCache(reader, bwd_data_algos, signatures);
+  loaded += loadCache(reader, bwd_filter_algos, signatures);
+  return loaded;
+}
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -681,7 +843,7 @@ public:
     for (auto &algoPerf : perfResults) {
       try {
         f(algoPerf);
-        cache.insert(args.params, algoPerf);
+        cache.insert(args.params, algoPerf, benchmark);
         return;
       } catch (c10::CUDAOutOfMemoryError &e) {
         cudaGetLastError(); // clear CUDA error
@@ -63,6 +63,10 @@ Tensor _cudnn_init_dropout_state(double dropout, bool train, int64_t dropout_see
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
 #include <ATen/cudnn/Utils.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <mutex>
+#include <unordered_map>
 
 namespace at { namespace native {
 
@@ -580,8 +584,9 @@ namespace {
   cudnnRNNAlgo_t get_algo(const RNNDescriptorParams& rnn, const TensorDescriptorListParams& tensors, const Tensor input){
       cudaDeviceProp* prop = at::cuda::getCurrentDeviceProperties();
       const int64_t bsize = tensors.mini_batch;
-      //excluding Turing from using persistent rnn.
-      if (prop->major == 7 && prop->minor != 5 && getCudnnDataType(input) == CUDNN_DATA_HALF && !tensors.is_input_packed()) {
+      //persistent rnn on Volta and A100, excluding Turing.
+      const bool persist_capable = (prop->major == 7 && prop->minor != 5) || (prop->major == 8 && prop->minor == 0);
+      if (persist_capable && getCudnnDataType(input) == CUDNN_DATA_HALF && !tensors.is_input_packed()) {
           if (rnn.num_layers == 1 && rnn.hidden_size <= 1024 && rnn.num_directions() == 1 &&
                   rnn.hidden_size % 128 == 0 && tensors.input_size % 128 == 0){
               //technically, batch size should be multiple of 8, but there are quite a few multiple-of-8 batchsizes that give bad perf,
@@ -1169,48 +1174,114 @@ DropoutState& get_dropout_state(double dropout_p, bool train, TensorOptions opti
   return state;
 }
 
-Tensor try_get_weight_buf(
-      const Tensor& input, TensorList parameters, bool has_biases,
-      cudnnRNNMode_t mode, int64_t hidden_size, int64_t num_layers, bool bidirectional) {
-  // Prepare all relevant descriptors
-  auto handle = getCudnnHandle();
+// The size of the cuDNN weight buffer of an RNN and the offsets of the
+// parameters in it only depend on the RNN configuration, so they are queried
+// from cuDNN once per configuration rather than on every call.
+struct WeightBufLayoutParams {
+  int device_id;
+  cudnnRNNMode_t mode;
+  cudnnDirectionMode_t bidirectional;
+  cudnnDataType_t datatype;
+  int64_t input_size;
+  int64_t hidden_size;
+  int64_t num_layers;
+};
+
+struct WeightBufLayout {
+  int64_t num_params;
+  // Byte offsets of the parameters checked by try_get_weight_buf, in the
+  // order of get_expected_data_ptrs.
+  std::vector<ptrdiff_t> offsets;
+};
+
+struct WeightBufLayoutCache {
+  std::mutex mutex;
+  // Entries are never removed, so references to them stay valid.
+  std::unordered_map<WeightBufLayoutParams, WeightBufLayout, ParamsHash<WeightBufLayoutParams>, ParamsEqual<WeightBufLayoutParams>> map;
+};
+
+WeightBufLayoutCache weight_buf_layout_cache;
+
+const WeightBufLayout& get_weight_buf_layout(
+      const Tensor& input, cudnnRNNMode_t mode, int64_t hidden_size, int64_t num_layers, bool bidirectional) {
   auto datatype = getCudnnDataType(input);
 
   RNNDescriptorParams rnn;
   rnn.set(mode, hidden_size, num_layers, bidirectional, promote_rnn_math_type(datatype), datatype);
+
+  WeightBufLayoutParams params;
+  // Zero the padding, which is hashed and compared as well.
+  memset(&params, 0, sizeof(params));
+  params.device_id = input.get_device();
+  params.mode = rnn.mode;
+  params.bidirectional = rnn.bidirectional;
+  params.datatype = datatype;
+  params.input_size = input.size(-1);
+  params.hidden_size = hidden_size;
+  params.num_layers = num_layers;
+
+  {
+    std::lock_guard<std::mutex> guard(weight_buf_layout_cache.mutex);
+    auto it = weight_buf_layout_cache.map.find(params);
+    if (it != weight_buf_layout_cache.map.end()) {
+      return it->second;
+    }
+  }
+
+  // Prepare all relevant descriptors
+  auto handle = getCudnnHandle();
   RNNDescriptor rnn_desc = rnn.descriptor(handle);
 
   TensorGeometry x_geom ({1, input.size(-1)});
   TensorDescriptor x_desc;
   x_desc.set(datatype, x_geom.sizes(), x_geom.strides(), 5);
 
-  auto num_params = get_num_weights(handle, rnn_desc, x_desc, datatype);
+  WeightBufLayout layout;
+  layout.num_params = get_num_weights(handle, rnn_desc, x_desc, datatype);
+
+  // cuDNN only computes the parameter addresses from the buffer address, the
+  // buffer is never accessed.
+  auto weight_buf = at::empty({layout.num_params}, input.options());
+  auto expected_data_ptrs = get_expected_data_ptrs(
+      weight_buf, handle, rnn, rnn_desc, x_desc, datatype);
+  for (void* data_ptr : expected_data_ptrs) {
+    layout.offsets.push_back((char*)data_ptr - (char*)weight_buf.data_ptr());
+  }
+
+  std::lock_guard<std::mutex> guard(weight_buf_layout_cache.mutex);
+  return weight_buf_layout_cache.map.emplace(params, std::move(layout)).first->second;
+}
+
+Tensor try_get_weight_buf(
+      const Tensor& input, TensorList parameters, bool has_biases,
+      cudnnRNNMode_t mode, int64_t hidden_size, int64_t num_layers, bool bidirectional) {
+  const auto& layout = get_weight_buf_layout(input, mode, hidden_size, num_layers, bidirectional);
 
   // Try to get parameter storage
   auto & any_param = parameters.at(0);
   auto param_storage = any_param.storage();
-  auto weight_buf = at::empty({0}, any_param.options()).set_(param_storage);
-  if (weight_buf.size(0) < num_params) {
+  if (param_storage.nbytes() < layout.num_params * any_param.element_size()) {
     return {};
-  } else if (weight_buf.size(0) > num_params) {
-    weight_buf = weight_buf.narrow(0, 0, num_params);
   }
 
-  // Get and check data pointers
-  auto expected_data_ptrs = get_expected_data_ptrs(
-      weight_buf, handle, rnn, rnn_desc, x_desc, datatype);
-
+  // Check data pointers
+  char* base_ptr = (char*)param_storage.data();
   int64_t num_parameters = parameters.size();
-  int64_t num_ptrs = expected_data_ptrs.size();
+  int64_t num_ptrs = layout.offsets.size();
   AT_ASSERT(num_ptrs == (num_parameters * (has_biases ? 1 : 2)));
   AT_ASSERT(num_ptrs % (has_biases ? 4 : 2) == 0);
   for (int64_t param_i = 0, ptr_i = 0;
        ptr_i < num_ptrs;
        ptr_i += (has_biases ? 2 : 4), param_i += 2) {
-    if (expected_data_ptrs[ptr_i] != parameters[param_i].data_ptr()) return {};
-    if (expected_data_ptrs[ptr_i + 1] != parameters[param_i + 1].data_ptr()) return {};
+    if (base_ptr + layout.offsets[ptr_i] != parameters[param_i].data_ptr()) return {};
+    if (base_ptr + layout.offsets[ptr_i + 1] != parameters[param_i + 1].data_ptr()) return {};
   }
   if (!parameters[num_parameters - 1].is_contiguous()) return {};
+
+  auto weight_buf = at::empty({0}, any_param.options()).set_(param_storage);
+  if (weight_buf.size(0) > layout.num_params) {
+    weight_buf = weight_buf.narrow(0, 0, layout.num_params);
+  }
   return weight_buf;
 }
 
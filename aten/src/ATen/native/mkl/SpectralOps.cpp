@@ -25,11 +25,15 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
 #include <ATen/Utils.h>
+#include <ATen/native/utils/ParamsHash.h>
 
 #include <algorithm>
 #include <vector>
 #include <numeric>
 #include <cmath>
+#include <cstring>
+#include <list>
+#include <unordered_map>
 
 #include <mkl_dfti.h>
 #include <ATen/mkl/Exceptions.h>
@@ -144,6 +148,116 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+// Everything set on a DFTI descriptor before it is committed. Must be a POD
+// because we read out its memory contents as char* when hashing.
+struct MklFftParams {
+  DFTI_CONFIG_VALUE precision;
+  DFTI_CONFIG_VALUE signal_type;
+  int64_t signal_ndim;
+  int64_t signal_sizes[3];
+  int64_t batch;
+  int64_t idist;
+  int64_t odist;
+  // first val is offset, always zero (ignored by MKL)
+  int64_t istrides[4];
+  int64_t ostrides[4];
+  bool cce_storage;
+  bool inverse;
+  bool normalized;
+};
+
+static DftiDescriptor make_mkl_fft_descriptor(const MklFftParams& params) {
+  const int64_t signal_ndim = params.signal_ndim;
+  // create descriptor with signal size
+  std::vector<MKL_LONG> mkl_signal_sizes(params.signal_sizes, params.signal_sizes + signal_ndim);
+  DftiDescriptor descriptor;
+  descriptor.init(params.precision, params.signal_type, signal_ndim, mkl_signal_sizes.data());
+  // out of place FFT
+  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+  // batch mode
+  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, static_cast<MKL_LONG>(params.batch)));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, static_cast<MKL_LONG>(params.idist)));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, static_cast<MKL_LONG>(params.odist)));
+  // signal strides
+  std::vector<MKL_LONG> mkl_istrides(params.istrides, params.istrides + 1 + signal_ndim);
+  std::vector<MKL_LONG> mkl_ostrides(params.ostrides, params.ostrides + 1 + signal_ndim);
+  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+  // if conjugate domain of real is involved, set standard CCE storage type
+  // this will become default in MKL in future
+  if (params.cce_storage) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  }
+  // rescale if needed by normalized flag or inverse transform
+  if (params.normalized || params.inverse) {
+    auto signal_numel = std::accumulate(
+        params.signal_sizes, params.signal_sizes + signal_ndim, int64_t(1), std::multiplies<int64_t>());
+    double double_scale;
+    if (params.normalized) {
+      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+    } else {
+      double_scale = 1.0 / static_cast<double>(signal_numel);
+    }
+    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
+      params.inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+      params.precision == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  }
+  // finalize
+  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  return descriptor;
+}
+
+// Committing a DFTI descriptor is the expensive part of a small transform, as
+// that is when MKL picks the kernels and computes the twiddle factors, and
+// the same transforms are usually run over and over (e.g. stft on each batch
+// of audio). So committed descriptors are kept in an LRU cache, like the
+// cuFFT plans in native/cuda/CuFFTPlanCache.h.
+//
+// The cache is thread local: a committed descriptor may only be used by one
+// thread at a time, unless MKL was told the number of user threads before
+// committing it.
+constexpr size_t MKL_FFT_PLAN_CACHE_MAX_SIZE = 64;
+
+class MklFftPlanCache {
+ public:
+  using kv_t = std::pair<MklFftParams, DftiDescriptor>;
+  using map_t = std::unordered_map<std::reference_wrapper<MklFftParams>,
+                                            std::list<kv_t>::iterator,
+                                            ParamsHash<MklFftParams>,
+                                            ParamsEqual<MklFftParams>>;
+
+  // Returns the committed descriptor for `params`, creating it on a miss.
+  DFTI_DESCRIPTOR* lookup(MklFftParams& params) {
+    auto map_it = cache_map_.find(params);
+    if (map_it != cache_map_.end()) {
+      // move the hit to the front of the usage list
+      usage_list_.splice(usage_list_.begin(), usage_list_, map_it->second);
+      return map_it->second->second.get();
+    }
+    DftiDescriptor descriptor = make_mkl_fft_descriptor(params);
+    if (usage_list_.size() >= MKL_FFT_PLAN_CACHE_MAX_SIZE) {
+      cache_map_.erase(usage_list_.back().first);
+      usage_list_.pop_back();
+    }
+    usage_list_.emplace_front(params, std::move(descriptor));
+    auto kv_it = usage_list_.begin();
+    cache_map_.emplace(std::piecewise_construct,
+                       std::forward_as_tuple(kv_it->first),
+                       std::forward_as_tuple(kv_it));
+    return kv_it->second.get();
+  }
+
+ private:
+  // The newly used plans are at the front.
+  std::list<kv_t> usage_list_;
+  map_t cache_map_;
+};
+
+static MklFftPlanCache& mkl_fft_plan_cache() {
+  static thread_local MklFftPlanCache cache;
+  return cache;
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
@@ -206,63 +320,40 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
        << toString(input.scalar_type());
     AT_ERROR(ss.str());
   }
+
+  MklFftParams params;
+  memset(&params, 0, sizeof(params));
+  params.precision = prec;
   // signal type
-  DFTI_CONFIG_VALUE signal_type;
   if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
+    params.signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
   } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
+    params.signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
   }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
-
+  params.signal_ndim = signal_ndim;
+  std::copy(checked_signal_sizes.begin(), checked_signal_sizes.end(), params.signal_sizes);
+  params.batch = batch;
   auto istrides = input.strides();
   auto ostrides = output.strides();
   // batch dim stride, i.e., dist between each data
-  MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
-  MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
+  params.idist = complex_input ? istrides[0] >> 1 : istrides[0];
+  params.odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
   // signal strides
   // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
   for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+    params.istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
+    params.ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
   }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
-    } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
-    }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
-  }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  params.cce_storage = !complex_input || !complex_output;
+  params.inverse = inverse;
+  params.normalized = normalized;
+
+  DFTI_DESCRIPTOR* descriptor = mkl_fft_plan_cache().lookup(params);
   // run
   if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeForward(descriptor, input.data_ptr(), output.data_ptr()));
   } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeBackward(descriptor, input.data_ptr(), output.data_ptr()));
   }
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Config.h>
+
+#if AT_MKLDNN_ENABLED()
+
+#include <ideep.hpp>
+
+namespace at {
+namespace native {
+namespace mkldnn {
+
+// A 2d convolution whose weight is already reordered to the blocked format
+// of the oneDNN primitive, so that running it does not reorder the weight.
+struct ContextConv final {
+  ideep::tensor weight_packed_;
+  c10::optional<at::Tensor> at_bias_;
+  std::vector<int64_t> padding_;
+  std::vector<int64_t> stride_;
+  std::vector<int64_t> dilation_;
+  int64_t groups_;
+
+  ContextConv() = delete;
+
+  ContextConv(
+      ideep::tensor&& weight_packed,
+      c10::optional<at::Tensor> at_bias,
+      std::vector<int64_t> padding,
+      std::vector<int64_t> stride,
+      std::vector<int64_t> dilation,
+      int64_t groups)
+      : weight_packed_(std::move(weight_packed)),
+        at_bias_(std::move(at_bias)),
+        padding_(std::move(padding)),
+        stride_(std::move(stride)),
+        dilation_(std::move(dilation)),
+        groups_(groups) {}
+};
+
+// A transposed 2d convolution whose weight is rearranged to the order of
+// oneDNN deconvolutions and reordered to the blocked format of the primitive.
+struct ContextConvTranspose final {
+  ideep::tensor weight_packed_;
+  c10::optional<at::Tensor> at_bias_;
+  std::vector<int64_t> padding_;
+  std::vector<int64_t> output_padding_;
+  std::vector<int64_t> stride_;
+  std::vector<int64_t> dilation_;
+
+  ContextConvTranspose() = delete;
+
+  ContextConvTranspose(
+      ideep::tensor&& weight_packed,
+      c10::optional<at::Tensor> at_bias,
+      std::vector<int64_t> padding,
+      std::vector<int64_t> output_padding,
+      std::vector<int64_t> stride,
+      std::vector<int64_t> dilation)
+      : weight_packed_(std::move(weight_packed)),
+        at_bias_(std::move(at_bias)),
+        padding_(std::move(padding)),
+        output_padding_(std::move(output_padding)),
+        stride_(std::move(stride)),
+        dilation_(std::move(dilation)) {}
+};
+
+} // namespace mkldnn
+} // namespace native
+} // namespace at
+
+#endif // AT_MKLDNN_ENABLED()
@@ -12,7 +12,7 @@ at::Tensor mkldnn_convolution(
   AT_ERROR("mkldnn_convolution_forward: ATen not compiled with MKLDNN support");
 }
 
-at::Tensor mkldnn_convolution_backward_input(
+Tensor mkldnn_convolution_backward_input(
     IntArrayRef input_size, const at::Tensor& grad_output, const at::Tensor& weight,
     IntArrayRef padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups, bool bias_defined) {
   AT_ERROR("mkldnn_convolution_backward_input: ATen not compiled with MKLDNN support");
@@ -30,13 +30,25 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
   AT_ERROR("mkldnn_convolution_backward: ATen not compiled with MKLDNN support");
 }
 
+at::Tensor mkldnn_convolution_transpose(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef padding, IntArrayRef output_padding, IntArrayRef stride, IntArrayRef dilation, int64_t groups) {
+  AT_ERROR("mkldnn_convolution_transpose: ATen not compiled with MKLDNN support");
+}
+
 }}
 
 #else // AT_MKLDNN_EBABLED
 
+#include <ATen/native/mkldnn/Conv.h>
 #include <ATen/native/mkldnn/MKLDNNCommon.h>
 #include <ATen/native/mkldnn/Utils.h>
 #include <ATen/native/ConvUtils.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace {
 // Helper function for getting an ideep tensor out of an aten Tensor.
@@ -55,6 +67,99 @@ inline ideep::tensor get_mkldnn_tensor(const at::Tensor& tensor) {
 
 namespace at { namespace native {
 
+namespace {
+
+// Shapes and parameters of a 2d convolution, the key of the primitive cache.
+// This must be a POD, it is hashed and compared as bytes.
+struct ConvPrimitiveKey {
+  int64_t input_size[4];
+  int64_t weight_size[4];
+  int64_t padding[2];
+  int64_t stride[2];
+  int64_t dilation[2];
+  int64_t groups;
+  bool has_bias;
+};
+
+// Creating a oneDNN convolution primitive costs more than running it on
+// small inputs, so eager calls reuse the primitives of the last
+// kConvPrimitiveCacheCapacity shapes they have seen. The primitives are
+// stateless and can be executed by several threads at once, the mutex only
+// guards the cache itself.
+constexpr size_t kConvPrimitiveCacheCapacity = 1024;
+
+class ConvPrimitiveCache {
+ public:
+  // Returns whether key was found, in which case params is set to its entry.
+  bool find(const ConvPrimitiveKey& key, ideep::convolution_forward_params& params) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return false;
+    }
+    usage_list_.splice(usage_list_.begin(), usage_list_, it->second);
+    params = it->second->second;
+    return true;
+  }
+
+  void insert(const ConvPrimitiveKey& key, const ideep::convolution_forward_params& params) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (map_.count(key)) {
+      return;
+    }
+    if (usage_list_.size() >= kConvPrimitiveCacheCapacity) {
+      map_.erase(usage_list_.back().first);
+      usage_list_.pop_back();
+    }
+    usage_list_.emplace_front(key, params);
+    map_.emplace(key, usage_list_.begin());
+  }
+
+ private:
+  using kv_t = std::pair<ConvPrimitiveKey, ideep::convolution_forward_params>;
+  std::mutex mutex_;
+  std::list<kv_t> usage_list_;
+  std::unordered_map<
+      ConvPrimitiveKey,
+      std::list<kv_t>::iterator,
+      ParamsHash<ConvPrimitiveKey>,
+      ParamsEqual<ConvPrimitiveKey>> map_;
+};
+
+ConvPrimitiveCache& conv_primitive_cache() {
+  static ConvPrimitiveCache cache;
+  return cache;
+}
+
+ConvPrimitiveKey make_conv_primitive_key(
+    const ideep::tensor& x,
+    const ideep::tensor& w,
+    bool has_bias,
+    at::IntArrayRef padding,
+    at::IntArrayRef stride,
+    at::IntArrayRef dilation,
+    int64_t groups) {
+  ConvPrimitiveKey key;
+  memset(&key, 0, sizeof(key));
+  const auto x_dims = x.get_dims();
+  const auto w_dims = w.get_dims();
+  TORCH_INTERNAL_ASSERT(x_dims.size() == 4 && w_dims.size() == 4);
+  for (size_t i = 0; i < 4; ++i) {
+    key.input_size[i] = x_dims[i];
+    key.weight_size[i] = w_dims[i];
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    key.padding[i] = padding[i];
+    key.stride[i] = stride[i];
+    key.dilation[i] = dilation[i];
+  }
+  key.groups = groups;
+  key.has_bias = has_bias;
+  return key;
+}
+
+} // namespace
+
 ideep::tensor _mkldnn_conv2d(
     const ideep::tensor& x,
     const ideep::tensor& w,
@@ -70,57 +175,211 @@ ideep::tensor _mkldnn_conv2d(
   std::vector<int64_t> output_sizes =
       conv_output_size(input_size, kernel_size, padding, stride, dilation);
 
+  ideep::tensor y;
+  // The cache only knows the shapes of 2d convolutions, the legacy 5-d
+  // grouped weights go through the uncached path.
+  if (x.ndims() != 4 || w.ndims() != 4 || padding.size() != 2 ||
+      stride.size() != 2 || dilation.size() != 2) {
+    if (b.has_value()) {
+      ideep::convolution_forward::compute(
+          x,
+          w,
+          b.value(),
+          {output_sizes.cbegin(), output_sizes.cend()},
+          y,
+          {stride.begin(), stride.end()},
+          {dilation.begin(), dilation.end()},
+          {padding.begin(), padding.end()},
+          {padding.begin(), padding.end()},
+          groups);
+    } else {
+      ideep::convolution_forward::compute(
+          x,
+          w,
+          {output_sizes.cbegin(), output_sizes.cend()},
+          y,
+          {stride.begin(), stride.end()},
+          {dilation.begin(), dilation.end()},
+          {padding.begin(), padding.end()},
+          {padding.begin(), padding.end()},
+          groups);
+    }
+    return y;
+  }
+
+  const ConvPrimitiveKey key = make_conv_primitive_key(
+      x, w, b.has_value(), padding, stride, dilation, groups);
+  ideep::convolution_forward_params params;
+  if (conv_primitive_cache().find(key, params)) {
+    y.init(params.pd.dst_desc());
+  } else {
+    if (b.has_value()) {
+      ideep::convolution_forward::prepare(
+          params,
+          x,
+          w,
+          b.value(),
+          {output_sizes.cbegin(), output_sizes.cend()},
+          y,
+          {stride.begin(), stride.end()},
+          {dilation.begin(), dilation.end()},
+          {padding.begin(), padding.end()},
+          {padding.begin(), padding.end()},
+          groups,
+          ideep::scale_t(),
+          ideep::scale_t(),
+          ideep::scale_t(),
+          ideep::attr_t(),
+          ideep::algorithm::convolution_direct,
+          ideep::prop_kind::forward);
+    } else {
+      ideep::convolution_forward::prepare(
+          params,
+          x,
+          w,
+          {output_sizes.cbegin(), output_sizes.cend()},
+          y,
+          {stride.begin(), stride.end()},
+          {dilation.begin(), dilation.end()},
+          {padding.begin(), padding.end()},
+          {padding.begin(), padding.end()},
+          groups,
+          ideep::scale_t(),
+          ideep::scale_t(),
+          ideep::scale_t(),
+          ideep::attr_t(),
+          ideep::algorithm::convolution_direct,
+          ideep::prop_kind::forward);
+    }
+    conv_primitive_cache().insert(key, params);
+  }
+
+  if (b.has_value()) {
+    ideep::convolution_forward::compute(params, x, w, b.value(), y);
+  } else {
+    ideep::convolution_forward::compute(params, x, w, y);
+  }
+  return y;
+}
+
+at::Tensor mkldnn_convolution(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    IntArrayRef dilation,
+    int64_t groups) {
+  const ideep::tensor mkldnn_input = get_mkldnn_tensor(input);
+  const ideep::tensor mkldnn_weight = get_mkldnn_tensor(weight);
+  c10::optional<ideep::tensor> mkldnn_bias{c10::nullopt};
+  if (bias.defined()) {
+    mkldnn_bias = get_mkldnn_tensor(bias);
+  }
+
+  ideep::tensor mkldnn_output = _mkldnn_conv2d(
+      mkldnn_input,
+      mkldnn_weight,
+      mkldnn_bias,
+      padding,
+      stride,
+      dilation,
+      groups);
+
+  if (input.is_mkldnn()) {
+    return new_with_itensor_mkldnn(std::move(mkldnn_output), input.options());
+  } else {
+    return mkldnn_to_dense(
+        new_with_itensor_mkldnn(std::move(mkldnn_output), input.options()));
+  }
+}
+
+ideep::tensor _mkldnn_conv_transpose(
+    const ideep::tensor& x,
+    const ideep::tensor& w,
+    const c10::optional<ideep::tensor>& b,
+    at::IntArrayRef padding,
+    at::IntArrayRef output_padding,
+    at::IntArrayRef stride,
+    at::IntArrayRef dilation) {
+  const auto input_size = x.get_dims();
+  const auto kernel_size = w.get_dims();
+  std::vector<int64_t> output_sizes{input_size[0], kernel_size[0]};
+  for (size_t d = 2; d < input_size.size(); ++d) {
+    output_sizes.push_back(
+        (input_size[d] - 1) * stride[d - 2] - 2 * padding[d - 2] +
+        dilation[d - 2] * (kernel_size[d] - 1) + output_padding[d - 2] + 1);
+  }
+  // The output padding only adds rows and columns at the end, so it is
+  // taken off the padding on that side.
+  std::vector<int64_t> padding_r(padding.begin(), padding.end());
+  for (size_t d = 0; d < padding_r.size(); ++d) {
+    padding_r[d] -= output_padding[d];
+  }
+
   ideep::tensor y;
   if (b.has_value()) {
-    ideep::convolution_forward::compute(
+    ideep::convolution_transpose_forward::compute(
         x,
         w,
         b.value(),
         {output_sizes.cbegin(), output_sizes.cend()},
         y,
         {stride.begin(), stride.end()},
-        {dilation.begin(), dilation.end()},
         {padding.begin(), padding.end()},
-        {padding.begin(), padding.end()},
-        groups);
+        {padding_r.cbegin(), padding_r.cend()},
+        {dilation.begin(), dilation.end()});
   } else {
-    ideep::convolution_forward::compute(
+    ideep::convolution_transpose_forward::compute(
         x,
         w,
         {output_sizes.cbegin(), output_sizes.cend()},
         y,
         {stride.begin(), stride.end()},
-        {dilation.begin(), dilation.end()},
-        {padding.begin(), padding.end()},
         {padding.begin(), padding.end()},
-        groups);
+        {padding_r.cbegin(), padding_r.cend()},
+        {dilation.begin(), dilation.end()});
   }
   return y;
 }
 
-at::Tensor mkldnn_convolution(
+at::Tensor mkldnn_conv_transpose_weight(const at::Tensor& weight) {
+  return weight.transpose(0, 1).contiguous();
+}
+
+// Replaces the gemm and col2im of slow_conv_transpose2d and
+// slow_conv_transpose3d, which go through a column buffer kernel size times
+// larger than the input one image at a time. This has no derivative, so
+// _convolution only calls it when no gradient is required.
+at::Tensor mkldnn_convolution_transpose(
     const at::Tensor& input,
     const at::Tensor& weight,
     const at::Tensor& bias,
     IntArrayRef padding,
+    IntArrayRef output_padding,
     IntArrayRef stride,
     IntArrayRef dilation,
     int64_t groups) {
+  TORCH_CHECK(groups == 1, "mkldnn_convolution_transpose: groups are not supported");
+  TORCH_CHECK(
+      !weight.is_mkldnn() && (!bias.defined() || !bias.is_mkldnn()),
+      "mkldnn_convolution_transpose: expected dense weight and bias");
   const ideep::tensor mkldnn_input = get_mkldnn_tensor(input);
-  const ideep::tensor mkldnn_weight = get_mkldnn_tensor(weight);
+  const Tensor weight_oihw = mkldnn_conv_transpose_weight(weight);
+  const ideep::tensor mkldnn_weight = get_mkldnn_tensor(weight_oihw);
   c10::optional<ideep::tensor> mkldnn_bias{c10::nullopt};
   if (bias.defined()) {
     mkldnn_bias = get_mkldnn_tensor(bias);
   }
 
-  ideep::tensor mkldnn_output = _mkldnn_conv2d(
+  ideep::tensor mkldnn_output = _mkldnn_conv_transpose(
       mkldnn_input,
       mkldnn_weight,
       mkldnn_bias,
       padding,
+      output_padding,
       stride,
-      dilation,
-      groups);
+      dilation);
 
   if (input.is_mkldnn()) {
     return new_with_itensor_mkldnn(std::move(mkldnn_output), input.options());
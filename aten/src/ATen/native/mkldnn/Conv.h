@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/Config.h>
+
+#if AT_MKLDNN_ENABLED()
+
+#include <ideep.hpp>
+
+namespace at { namespace native {
+
+// 2d convolution of ideep tensors. The weight may be a dense view or already
+// reordered to the format expected by the primitive, see
+// mkldnn_reorder_conv2d_weight. Primitives are cached by shapes and
+// parameters.
+ideep::tensor _mkldnn_conv2d(
+    const ideep::tensor& x,
+    const ideep::tensor& w,
+    const c10::optional<ideep::tensor>& b,
+    at::IntArrayRef padding,
+    at::IntArrayRef stride,
+    at::IntArrayRef dilation,
+    int64_t groups);
+
+// Transposed 2d or 3d convolution of ideep tensors, without groups. The
+// weight is in the (out_channels, in_channels, kernel...) order of oneDNN
+// deconvolutions, see mkldnn_conv_transpose_weight, and may already be
+// reordered to the format expected by the primitive.
+ideep::tensor _mkldnn_conv_transpose(
+    const ideep::tensor& x,
+    const ideep::tensor& w,
+    const c10::optional<ideep::tensor>& b,
+    at::IntArrayRef padding,
+    at::IntArrayRef output_padding,
+    at::IntArrayRef stride,
+    at::IntArrayRef dilation);
+
+// The (in_channels, out_channels, kernel...) weight of a transposed
+// convolution of PyTorch, as the contiguous weight of a oneDNN deconvolution.
+at::Tensor mkldnn_conv_transpose_weight(const at::Tensor& weight);
+
+}}  // namespace at::native
+
+#endif // AT_MKLDNN_ENABLED()
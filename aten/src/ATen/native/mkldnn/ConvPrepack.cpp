@@ -0,0 +1,231 @@
+#include <ATen/native/mkldnn/ConvPrepack.h>
+
+#if AT_MKLDNN_ENABLED()
+
+#include <ATen/native/mkldnn/Conv.h>
+#include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <ATen/native/utils/ParamUtils.h>
+
+namespace at {
+namespace native {
+namespace mkldnn {
+namespace internal {
+namespace convolution {
+
+c10::intrusive_ptr<mkldnn::ConvOpContext> createConvPrePackOpContext(
+    Tensor weight,
+    c10::optional<Tensor> bias,
+    std::vector<int64_t> stride,
+    std::vector<int64_t> padding,
+    std::vector<int64_t> dilation,
+    int64_t groups) {
+  return mkldnn::MkldnnConvOpContext::create_context(
+      std::move(weight),
+      std::move(bias),
+      std::move(padding),
+      std::move(stride),
+      std::move(dilation),
+      groups);
+}
+
+Tensor conv_run(
+    const Tensor& input,
+    const c10::intrusive_ptr<mkldnn::ConvOpContext>& op_context) {
+  return op_context->run(input);
+}
+
+ContextConv create(
+    const Tensor& weight,
+    const c10::optional<Tensor>& bias,
+    const IntArrayRef padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups) {
+  TORCH_CHECK(
+      weight.device().is_cpu() && weight.layout() == c10::kStrided &&
+          weight.scalar_type() == c10::kFloat && weight.dim() == 4,
+      "mkldnn_prepacked::conv2d_prepack: expected a dense 4-d float CPU weight");
+  if (bias.has_value()) {
+    TORCH_CHECK(
+        bias->dim() == 1 && bias->size(0) == weight.size(0) &&
+            bias->scalar_type() == c10::kFloat,
+        "mkldnn_prepacked::conv2d_prepack: expected a float bias of size ",
+        weight.size(0));
+  }
+  const auto padding_expanded = expand_param_if_needed(padding, "padding", 2);
+  const auto stride_expanded = expand_param_if_needed(stride, "stride", 2);
+  const auto dilation_expanded = expand_param_if_needed(dilation, "dilation", 2);
+
+  // The view shares the storage of weight_contig, which outlives it here.
+  const Tensor weight_contig = weight.contiguous();
+  const ideep::tensor w = itensor_view_from_dense(weight_contig);
+  const auto expected_desc = ideep::convolution_forward::expected_weights_desc(
+      w.get_dims(),
+      w.get_data_type(),
+      {stride_expanded.cbegin(), stride_expanded.cend()},
+      {padding_expanded.cbegin(), padding_expanded.cend()},
+      {padding_expanded.cbegin(), padding_expanded.cend()},
+      {dilation_expanded.cbegin(), dilation_expanded.cend()},
+      groups,
+      ideep::algorithm::convolution_direct,
+      ideep::prop_kind::forward);
+  ideep::tensor weight_packed;
+  weight_packed.init(expected_desc);
+  weight_packed.feed_from(w);
+
+  return ContextConv{
+      std::move(weight_packed),
+      bias.has_value() ? c10::make_optional(bias->contiguous()) : c10::nullopt,
+      padding_expanded,
+      stride_expanded,
+      dilation_expanded,
+      groups};
+}
+
+Tensor run(const ContextConv& context, const Tensor& input) {
+  TORCH_CHECK(
+      input.dim() == 4 && input.scalar_type() == c10::kFloat,
+      "mkldnn_prepacked::conv2d_run: expected a 4-d float input");
+  const Tensor input_contig = input.is_mkldnn() ? input : input.contiguous();
+  const ideep::tensor x = input.is_mkldnn()
+      ? itensor_from_mkldnn(input_contig)
+      : itensor_view_from_dense(input_contig);
+  c10::optional<ideep::tensor> b{c10::nullopt};
+  if (context.at_bias_.has_value()) {
+    b = itensor_view_from_dense(context.at_bias_.value());
+  }
+
+  ideep::tensor y = _mkldnn_conv2d(
+      x,
+      context.weight_packed_,
+      b,
+      context.padding_,
+      context.stride_,
+      context.dilation_,
+      context.groups_);
+
+  if (input.is_mkldnn()) {
+    return new_with_itensor_mkldnn(std::move(y), input.options());
+  }
+  return mkldnn_to_dense(new_with_itensor_mkldnn(std::move(y), input.options()));
+}
+
+c10::intrusive_ptr<mkldnn::ConvTransposeOpContext> createConvTransposePrePackOpContext(
+    Tensor weight,
+    c10::optional<Tensor> bias,
+    std::vector<int64_t> stride,
+    std::vector<int64_t> padding,
+    std::vector<int64_t> output_padding,
+    std::vector<int64_t> dilation,
+    int64_t groups) {
+  return mkldnn::MkldnnConvTransposeOpContext::create_context(
+      std::move(weight),
+      std::move(bias),
+      std::move(padding),
+      std::move(output_padding),
+      std::move(stride),
+      std::move(dilation),
+      groups);
+}
+
+Tensor conv_transpose_run(
+    const Tensor& input,
+    const c10::intrusive_ptr<mkldnn::ConvTransposeOpContext>& op_context) {
+  return op_context->run(input);
+}
+
+ContextConvTranspose create_transpose(
+    const Tensor& weight,
+    const c10::optional<Tensor>& bias,
+    const IntArrayRef padding,
+    const IntArrayRef output_padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups) {
+  TORCH_CHECK(
+      weight.device().is_cpu() && weight.layout() == c10::kStrided &&
+          weight.scalar_type() == c10::kFloat && weight.dim() == 4,
+      "mkldnn_prepacked::conv_transpose2d_prepack: expected a dense 4-d float CPU weight");
+  TORCH_CHECK(
+      groups == 1,
+      "mkldnn_prepacked::conv_transpose2d_prepack: groups are not supported");
+  if (bias.has_value()) {
+    TORCH_CHECK(
+        bias->dim() == 1 && bias->size(0) == weight.size(1) &&
+            bias->scalar_type() == c10::kFloat,
+        "mkldnn_prepacked::conv_transpose2d_prepack: expected a float bias of size ",
+        weight.size(1));
+  }
+  const auto padding_expanded = expand_param_if_needed(padding, "padding", 2);
+  const auto output_padding_expanded =
+      expand_param_if_needed(output_padding, "output_padding", 2);
+  const auto stride_expanded = expand_param_if_needed(stride, "stride", 2);
+  const auto dilation_expanded = expand_param_if_needed(dilation, "dilation", 2);
+  std::vector<int64_t> padding_r = padding_expanded;
+  for (size_t i = 0; i < padding_r.size(); ++i) {
+    padding_r[i] -= output_padding_expanded[i];
+    TORCH_CHECK(
+        padding_r[i] >= 0,
+        "mkldnn_prepacked::conv_transpose2d_prepack: output_padding larger than "
+        "padding is not supported");
+  }
+
+  // The view shares the storage of weight_oihw, which outlives it here.
+  const Tensor weight_oihw = mkldnn_conv_transpose_weight(weight);
+  const ideep::tensor w = itensor_view_from_dense(weight_oihw);
+  const auto expected_desc =
+      ideep::convolution_transpose_forward::expected_weights_desc(
+          w.get_dims(),
+          w.get_data_type(),
+          {stride_expanded.cbegin(), stride_expanded.cend()},
+          {padding_expanded.cbegin(), padding_expanded.cend()},
+          {padding_r.cbegin(), padding_r.cend()},
+          {dilation_expanded.cbegin(), dilation_expanded.cend()});
+  ideep::tensor weight_packed;
+  weight_packed.init(expected_desc);
+  weight_packed.feed_from(w);
+
+  return ContextConvTranspose{
+      std::move(weight_packed),
+      bias.has_value() ? c10::make_optional(bias->contiguous()) : c10::nullopt,
+      padding_expanded,
+      output_padding_expanded,
+      stride_expanded,
+      dilation_expanded};
+}
+
+Tensor run(const ContextConvTranspose& context, const Tensor& input) {
+  TORCH_CHECK(
+      input.dim() == 4 && input.scalar_type() == c10::kFloat,
+      "mkldnn_prepacked::conv_transpose2d_run: expected a 4-d float input");
+  const Tensor input_contig = input.is_mkldnn() ? input : input.contiguous();
+  const ideep::tensor x = input.is_mkldnn()
+      ? itensor_from_mkldnn(input_contig)
+      : itensor_view_from_dense(input_contig);
+  c10::optional<ideep::tensor> b{c10::nullopt};
+  if (context.at_bias_.has_value()) {
+    b = itensor_view_from_dense(context.at_bias_.value());
+  }
+
+  ideep::tensor y = _mkldnn_conv_transpose(
+      x,
+      context.weight_packed_,
+      b,
+      context.padding_,
+      context.output_padding_,
+      context.stride_,
+      context.dilation_);
+
+  if (input.is_mkldnn()) {
+    return new_with_itensor_mkldnn(std::move(y), input.options());
+  }
+  return mkldnn_to_dense(new_with_itensor_mkldnn(std::move(y), input.options()));
+}
+
+} // namespace convolution
+} // namespace internal
+} // namespace mkldnn
+} // namespace native
+} // namespace at
+
+#endif // AT_MKLDNN_ENABLED()
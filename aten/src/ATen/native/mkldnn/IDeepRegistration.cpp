@@ -11,10 +11,10 @@ using namespace ideep;
 RegisterEngineAllocator cpu_alloc(
   engine::cpu_engine(),
   [](size_t size) {
-    return c10::GetAllocator(c10::DeviceType::CPU)->raw_allocate(size);
+    return at::getCPUAllocator()->raw_allocate(size);
   },
   [](void* p) {
-    c10::GetAllocator(c10::DeviceType::CPU)->raw_deallocate(p);
+    at::getCPUAllocator()->raw_deallocate(p);
   }
 );
 
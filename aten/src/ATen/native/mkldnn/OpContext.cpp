@@ -0,0 +1,68 @@
+#include <ATen/native/mkldnn/ConvPrepack.h>
+#include <ATen/native/mkldnn/OpContext.h>
+
+#if AT_MKLDNN_ENABLED()
+
+namespace at {
+namespace native {
+namespace mkldnn {
+
+c10::intrusive_ptr<ConvOpContext> MkldnnConvOpContext::create_context(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    std::vector<int64_t>&& padding,
+    std::vector<int64_t>&& stride,
+    std::vector<int64_t>&& dilation,
+    int64_t groups) {
+  auto op_context = mkldnn::internal::convolution::create(
+      weight, bias, padding, stride, dilation, groups);
+
+  auto conv_op_context = c10::make_intrusive<MkldnnConvOpContext>(
+      std::move(weight),
+      std::move(bias),
+      std::move(padding),
+      std::move(stride),
+      std::move(dilation),
+      groups,
+      std::move(op_context));
+
+  return conv_op_context;
+}
+
+Tensor MkldnnConvOpContext::run(const Tensor& input) {
+  return mkldnn::internal::convolution::run(op_context_, input);
+}
+
+c10::intrusive_ptr<ConvTransposeOpContext> MkldnnConvTransposeOpContext::create_context(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    std::vector<int64_t>&& padding,
+    std::vector<int64_t>&& output_padding,
+    std::vector<int64_t>&& stride,
+    std::vector<int64_t>&& dilation,
+    int64_t groups) {
+  auto op_context = mkldnn::internal::convolution::create_transpose(
+      weight, bias, padding, output_padding, stride, dilation, groups);
+
+  auto conv_transpose_op_context = c10::make_intrusive<MkldnnConvTransposeOpContext>(
+      std::move(weight),
+      std::move(bias),
+      std::move(padding),
+      std::move(output_padding),
+      std::move(stride),
+      std::move(dilation),
+      groups,
+      std::move(op_context));
+
+  return conv_transpose_op_context;
+}
+
+Tensor MkldnnConvTransposeOpContext::run(const Tensor& input) {
+  return mkldnn::internal::convolution::run(op_context_, input);
+}
+
+} // namespace mkldnn
+} // namespace native
+} // namespace at
+
+#endif // AT_MKLDNN_ENABLED()
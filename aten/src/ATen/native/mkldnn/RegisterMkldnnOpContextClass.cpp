@@ -0,0 +1,79 @@
+#include <ATen/Config.h>
+
+#if AT_MKLDNN_ENABLED()
+
+#include <ATen/Tensor.h>
+#include <ATen/native/mkldnn/ConvPrepack.h>
+#include <ATen/native/mkldnn/OpContext.h>
+#include <torch/custom_class.h>
+#include <torch/library.h>
+
+namespace at {
+namespace native {
+namespace mkldnn {
+
+using namespace internal::convolution;
+
+TORCH_LIBRARY(mkldnn, m) {
+  m.class_<ConvOpContext>("ConvOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<ConvOpContext>& op_context)
+              -> SerializationTypeConvPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeConvPrePack state)
+              -> c10::intrusive_ptr<ConvOpContext> { // __setstate__
+            return createConvPrePackOpContext(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::move(std::get<2>(state)),
+                std::move(std::get<3>(state)),
+                std::move(std::get<4>(state)),
+                std::move(std::get<5>(state)));
+          });
+  m.class_<ConvTransposeOpContext>("ConvTransposeOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<ConvTransposeOpContext>& op_context)
+              -> SerializationTypeConvTransposePrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeConvTransposePrePack state)
+              -> c10::intrusive_ptr<ConvTransposeOpContext> { // __setstate__
+            return createConvTransposePrePackOpContext(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::move(std::get<2>(state)),
+                std::move(std::get<3>(state)),
+                std::move(std::get<4>(state)),
+                std::move(std::get<5>(state)),
+                std::move(std::get<6>(state)));
+          });
+}
+
+TORCH_LIBRARY(mkldnn_prepacked, m) {
+  m.def(
+      "conv2d_prepack(Tensor W, Tensor? B, int[2] stride, int[2] padding, "
+      "int[2] dilation, int groups) -> __torch__.torch.classes.mkldnn.ConvOpContext");
+  m.def(
+      "conv2d_run(Tensor X, __torch__.torch.classes.mkldnn.ConvOpContext W_prepack) -> Tensor Y");
+  m.def(
+      "conv_transpose2d_prepack(Tensor W, Tensor? B, int[2] stride, int[2] padding, "
+      "int[2] output_padding, int[2] dilation, int groups) "
+      "-> __torch__.torch.classes.mkldnn.ConvTransposeOpContext");
+  m.def(
+      "conv_transpose2d_run(Tensor X, "
+      "__torch__.torch.classes.mkldnn.ConvTransposeOpContext W_prepack) -> Tensor Y");
+}
+
+TORCH_LIBRARY_IMPL(mkldnn_prepacked, CPU, m) {
+  m.impl("conv2d_prepack", TORCH_FN(createConvPrePackOpContext));
+  m.impl("conv2d_run", TORCH_FN(conv_run));
+  m.impl("conv_transpose2d_prepack", TORCH_FN(createConvTransposePrePackOpContext));
+  m.impl("conv_transpose2d_run", TORCH_FN(conv_transpose_run));
+}
+
+} // namespace mkldnn
+} // namespace native
+} // namespace at
+
+#endif // AT_MKLDNN_ENABLED()
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/core/ivalue.h>
+
+struct EmbeddingPackedParamsBase : public torch::jit::CustomClassHolder {
+  // Sums (mode 0) or averages (mode 1) the rows of each bag, like
+  // at::embedding_bag, with the weights dequantized on the fly.
+  virtual at::Tensor embeddingbag(
+      const at::Tensor& indices,
+      const c10::optional<at::Tensor>& offsets,
+      int64_t mode,
+      const c10::optional<at::Tensor>& per_sample_weights,
+      bool include_last_offset) = 0;
+
+  // Returns the k largest inner products of every row of the float matrix
+  // `query` with the rows of the table, in decreasing order, and the indices
+  // of these rows.
+  virtual std::tuple<at::Tensor, at::Tensor> mm_topk(
+      const at::Tensor& query,
+      int64_t k) = 0;
+
+  // Returns the dequantized float weights.
+  virtual at::Tensor unpack() = 0;
+
+  virtual int64_t bit_rate() const = 0;
+};
+
+// Row-wise quantized embedding table, in the fused formats of
+// caffe2/perfkernels. Each row of `packed_w` holds the quantized values of an
+// embedding row followed by its scale and bias:
+//  - with 8 bits per value, one byte per value, then a float scale and bias;
+//  - with 4 or 2 bits per value, 8 / bit_rate values per byte (the first one
+//    in the low bits), then an fp16 scale and bias.
+struct CAFFE2_API PackedEmbeddingBagWeight : public EmbeddingPackedParamsBase {
+  PackedEmbeddingBagWeight(at::Tensor packed_w, int64_t bit_rate)
+      : packed_w(std::move(packed_w)), bit_rate_(bit_rate) {}
+
+  at::Tensor packed_w;
+  int64_t bit_rate_;
+
+  at::Tensor embeddingbag(
+      const at::Tensor& indices,
+      const c10::optional<at::Tensor>& offsets,
+      int64_t mode,
+      const c10::optional<at::Tensor>& per_sample_weights,
+      bool include_last_offset) override;
+
+  std::tuple<at::Tensor, at::Tensor> mm_topk(
+      const at::Tensor& query,
+      int64_t k) override;
+
+  at::Tensor unpack() override;
+
+  int64_t bit_rate() const override {
+    return bit_rate_;
+  }
+
+  // Number of columns of the float weights.
+  int64_t embedding_dim() const;
+
+  static c10::intrusive_ptr<EmbeddingPackedParamsBase> prepack(
+      const at::Tensor& weight,
+      int64_t bit_rate);
+};
@@ -52,6 +52,10 @@ struct CAFFE2_API PackedLinearWeight : public LinearPackedParamsBase {
 
   at::Tensor apply_dynamic(at::Tensor input, bool reduce_range=false) override;
   at::Tensor apply_dynamic_relu(at::Tensor input, bool reduce_range=false) override;
+  at::Tensor& apply_dynamic_out(
+      const at::Tensor& input,
+      at::Tensor& output,
+      bool reduce_range = false) override;
 
   std::tuple<at::Tensor, c10::optional<at::Tensor>> unpack() override;
 
@@ -72,6 +76,12 @@ struct CAFFE2_API PackedLinearWeight : public LinearPackedParamsBase {
 
   template <bool ReluFused>
   at::Tensor apply_dynamic_impl(at::Tensor input, bool reduce_range=false);
+
+  template <bool ReluFused>
+  void apply_dynamic_impl_out(
+      const at::Tensor& input,
+      at::Tensor& output,
+      bool reduce_range);
 };
 
 struct CAFFE2_API PackedLinearWeightFp16 : public LinearPackedParamsBase {
@@ -153,6 +163,10 @@ struct CAFFE2_API PackedConvWeight : public ConvPackedParamsBase<kSpatialDim> {
   std::vector<float> w_scale;
   std::vector<int32_t> w_zp;
   c10::QScheme q_scheme;
+  // Weights for the channels-last depthwise kernels, as int16 with the zero
+  // points removed and laid out (kernel taps) x C. Only defined for depthwise
+  // convolutions that fbgemm does not have a direct kernel for.
+  at::Tensor depthwise_w;
 
   at::Tensor apply(
       const at::Tensor& input,
@@ -2395,6 +2395,118 @@ void dequantize_tensor_per_channel_affine_cpu(
       });
 }
 
+template <bool ReluFused, int kKernelHW>
+void qdepthwise_conv_nhwc_impl(
+    const Tensor& qx,
+    const Tensor& w,
+    const float* bias,
+    const float* requant_scales,
+    int64_t kD,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    Tensor& qy) {
+  const bool is_3d = qx.dim() == 5;
+  const int64_t N = qx.size(0);
+  const int64_t C = qx.size(1);
+  const int64_t iD = is_3d ? qx.size(2) : 1;
+  const int64_t iH = qx.size(qx.dim() - 2);
+  const int64_t iW = qx.size(qx.dim() - 1);
+  const int64_t oD = is_3d ? qy.size(2) : 1;
+  const int64_t oH = qy.size(qy.dim() - 2);
+  const int64_t oW = qy.size(qy.dim() - 1);
+
+  const uint8_t* x_data =
+      reinterpret_cast<const uint8_t*>(qx.data_ptr<c10::quint8>());
+  const int16_t* w_data = w.data_ptr<int16_t>();
+  uint8_t* y_data = reinterpret_cast<uint8_t*>(qy.data_ptr<c10::quint8>());
+
+  const int32_t x_zero_point = qx.q_zero_point();
+  const float y_scale = qy.q_scale();
+  const float y_zero_point = qy.q_zero_point();
+  const float y_min = ReluFused ? y_zero_point : 0.0f;
+  const float y_max = 255.0f;
+  std::vector<float> bias_scaled(C, 0.0f);
+  if (bias != nullptr) {
+    for (int64_t c = 0; c < C; ++c) {
+      bias_scaled[c] = bias[c] / y_scale;
+    }
+  }
+
+  // Each task computes full output rows. All the loops over channels are
+  // over contiguous memory, so that they are vectorized.
+  at::parallel_for(0, N * oD * oH, 0, [&](int64_t begin, int64_t end) {
+    std::vector<int32_t> acc(C);
+    for (int64_t row = begin; row < end; ++row) {
+      const int64_t oh = row % oH;
+      const int64_t od = (row / oH) % oD;
+      const int64_t n = row / (oH * oD);
+      for (int64_t ow = 0; ow < oW; ++ow) {
+        std::fill(acc.begin(), acc.end(), 0);
+        for (int64_t kd = 0; kd < kD; ++kd) {
+          const int64_t id = od * stride[0] - padding[0] + kd * dilation[0];
+          if (id < 0 || id >= iD) {
+            continue;
+          }
+          for (int kh = 0; kh < kKernelHW; ++kh) {
+            const int64_t ih = oh * stride[1] - padding[1] + kh * dilation[1];
+            if (ih < 0 || ih >= iH) {
+              continue;
+            }
+            for (int kw = 0; kw < kKernelHW; ++kw) {
+              const int64_t iw =
+                  ow * stride[2] - padding[2] + kw * dilation[2];
+              if (iw < 0 || iw >= iW) {
+                continue;
+              }
+              // Padding is at the input zero point, so skipping it is exact.
+              const uint8_t* x =
+                  x_data + (((n * iD + id) * iH + ih) * iW + iw) * C;
+              const int16_t* w_k =
+                  w_data + ((kd * kKernelHW + kh) * kKernelHW + kw) * C;
+              for (int64_t c = 0; c < C; ++c) {
+                acc[c] += (static_cast<int32_t>(x[c]) - x_zero_point) *
+                    static_cast<int32_t>(w_k[c]);
+              }
+            }
+          }
+        }
+        uint8_t* y = y_data + (((n * oD + od) * oH + oh) * oW + ow) * C;
+        for (int64_t c = 0; c < C; ++c) {
+          const float y_f = std::nearbyint(
+                                acc[c] * requant_scales[c] + bias_scaled[c]) +
+              y_zero_point;
+          y[c] = static_cast<uint8_t>(std::min(std::max(y_f, y_min), y_max));
+        }
+      }
+    }
+  });
+}
+
+template <bool ReluFused>
+void qdepthwise_conv_nhwc_kernel(
+    const Tensor& qx,
+    const Tensor& w,
+    const float* bias,
+    const float* requant_scales,
+    IntArrayRef kernel,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    Tensor& qy) {
+  TORCH_INTERNAL_ASSERT(kernel[1] == kernel[2]);
+  if (kernel[1] == 3) {
+    qdepthwise_conv_nhwc_impl<ReluFused, 3>(
+        qx, w, bias, requant_scales, kernel[0], stride, padding, dilation, qy);
+  } else if (kernel[1] == 5) {
+    qdepthwise_conv_nhwc_impl<ReluFused, 5>(
+        qx, w, bias, requant_scales, kernel[0], stride, padding, dilation, qy);
+  } else {
+    TORCH_INTERNAL_ASSERT(
+        false, "Unsupported depthwise kernel size ", kernel[1]);
+  }
+}
+
 } // namespace
 
 REGISTER_DISPATCH(qrelu_stub, &qrelu_kernel);
@@ -2444,6 +2556,12 @@ REGISTER_DISPATCH(
     dequantize_tensor_per_channel_affine_stub,
     &dequantize_tensor_per_channel_affine_cpu);
 REGISTER_DISPATCH(quantized_normalize_stub, &quantized_normalize_kernel);
+REGISTER_DISPATCH(
+    qdepthwise_conv_nhwc_stub,
+    &qdepthwise_conv_nhwc_kernel<false>);
+REGISTER_DISPATCH(
+    qdepthwise_conv_relu_nhwc_stub,
+    &qdepthwise_conv_nhwc_kernel<true>);
 
 } // namespace native
 } // namespace at
@@ -15,6 +15,17 @@ struct LinearPackedParamsBase : public torch::jit::CustomClassHolder {
   virtual at::Tensor apply_dynamic(at::Tensor input, bool reduce_range=false) = 0;
   virtual at::Tensor apply_dynamic_relu(at::Tensor input, bool reduce_range=false) = 0;
 
+  // Same as apply_dynamic, but writes the result into `output`, which must be
+  // a contiguous float tensor of the right size. Lets callers running the same
+  // linear repeatedly, such as recurrent cells, reuse the output memory.
+  virtual at::Tensor& apply_dynamic_out(
+      const at::Tensor& input,
+      at::Tensor& output,
+      bool reduce_range = false) {
+    output.copy_(apply_dynamic(input, reduce_range));
+    return output;
+  }
+
   virtual std::tuple<at::Tensor, c10::optional<at::Tensor>> unpack() = 0;
 
   virtual c10::optional<at::Tensor> bias() = 0;
@@ -4,6 +4,8 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
 #include <ATen/quantized/Quantizer.h>
+#include <ATen/native/quantized/cpu/conv_packed_params.h>
+#include <ATen/native/quantized/cpu/packed_params.h>
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
@@ -121,9 +123,11 @@ Tensor _add_scalar_out(Tensor& out, const Tensor& self, Scalar other) {
 
 
 #ifdef USE_PYTORCH_QNNPACK
+// Note: qy must be contiguous in the memory format of qa, and holds the
+// quantization parameters of the sum.
 template <bool ReLUFused = false>
-Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
-  TORCH_CHECK(qa.ndimension() > 0, "qnnpack_add(): Got empty input tensor.");
+void qnnpack_add_out(Tensor& qy, const Tensor& qa, const Tensor& qb) {
+  TORCH_INTERNAL_ASSERT(qy.is_contiguous(qa.suggest_memory_format()));
   Tensor qa_contig = qa.contiguous(qa.suggest_memory_format());
   // Reason for use qa's memory format for qb is that for the underlying
   // kernel can flatten all the dims and iterate over both the tensors.
@@ -136,16 +140,11 @@ Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
   const auto b_zero_point = qb_contig.q_zero_point();
   const auto a_scale = qa_contig.q_scale();
   const auto b_scale = qb_contig.q_scale();
-
-  Tensor qy = at::native::empty_affine_quantized(
-      qa_contig.sizes(),
-      at::device(kCPU).dtype(kQUInt8).memory_format(qa.suggest_memory_format()),
-      scale,
-      zero_point,
-      c10::nullopt);
+  const auto scale = qy.q_scale();
+  const auto zero_point = qy.q_zero_point();
 
   if (qa_contig.size(0) == 0) {
-    return qy;
+    return;
   }
 
   initQNNPACK();
@@ -201,11 +200,36 @@ Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
   TORCH_INTERNAL_ASSERT(
       runStatus == pytorch_qnnp_status_success,
       "failed to run QNNPACK Add operator");
+}
 
+template <bool ReLUFused = false>
+Tensor qnnpack_add(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
+  TORCH_CHECK(qa.ndimension() > 0, "qnnpack_add(): Got empty input tensor.");
+  Tensor qy = at::native::empty_affine_quantized(
+      qa.sizes(),
+      at::device(kCPU).dtype(kQUInt8).memory_format(qa.suggest_memory_format()),
+      scale,
+      zero_point,
+      c10::nullopt);
+  qnnpack_add_out<ReLUFused>(qy, qa, qb);
   return qy;
 }
 #endif
 
+// Same as qadd, but into `out`, which has the memory format of qa.
+template <bool ReLUFused = false>
+void qadd_into(Tensor& out, const Tensor& qa, const Tensor& qb) {
+  check_inputs(qa, qb);
+#ifdef USE_PYTORCH_QNNPACK
+  if (at::globalContext().qEngine() == at::QEngine::QNNPACK &&
+      qa.scalar_type() == kQUInt8 && qb.scalar_type() == kQUInt8) {
+    qnnpack_add_out<ReLUFused>(out, qa, qb);
+    return;
+  }
+#endif
+  _add_out<ReLUFused>(out, qa, qb);
+}
+
 template <bool ReLUFused = false>
 Tensor qadd(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
   check_inputs(qa, qb);
@@ -233,6 +257,98 @@ Tensor qadd_out(Tensor qa, Tensor qb, Tensor out) {
   return _add_out<ReLUFused>(out, qa, qb);
 }
 
+// Approximate size of the chunks of output of the fused ops below: small
+// enough for a chunk to still be in cache when it is added.
+constexpr int64_t kFusedAddChunkBytes = 512 * 1024;
+
+// Computes quantized::add (or add_relu) of produce(qx) and qother, like
+// running the producer and then the add, with the same results. When the
+// output is large, the producer runs on chunks of the batch, each of which is
+// added as soon as it has been produced. Its output is then never written out
+// to memory in full and read back, and only a chunk of it is allocated.
+template <bool ReLUFused, typename Producer>
+Tensor qadd_fused(
+    const Tensor& qx,
+    const Tensor& qother,
+    double scale,
+    int64_t zero_point,
+    const Producer& produce) {
+  TORCH_CHECK(
+      qx.dim() > 0 && qother.dim() > 0 && qx.size(0) == qother.size(0),
+      "Expected the input and the tensor added to its result to have the same "
+      "batch size, got sizes ",
+      qx.sizes(),
+      " and ",
+      qother.sizes());
+  const int64_t batch_size = qx.size(0);
+  const int64_t row_bytes = std::max<int64_t>(
+      1,
+      qother.numel() / std::max<int64_t>(batch_size, 1) *
+          qother.element_size());
+  const int64_t rows_per_chunk =
+      std::max<int64_t>(1, kFusedAddChunkBytes / row_bytes);
+  if (batch_size <= rows_per_chunk) {
+    return qadd<ReLUFused>(produce(qx), qother, scale, zero_point);
+  }
+
+  Tensor out;
+  for (int64_t start = 0; start < batch_size; start += rows_per_chunk) {
+    const int64_t rows = std::min(rows_per_chunk, batch_size - start);
+    Tensor y = produce(qx.narrow(0, start, rows));
+    if (!out.defined()) {
+      auto sizes = y.sizes().vec();
+      sizes[0] = batch_size;
+      out = at::_empty_affine_quantized(
+          sizes,
+          at::device(kCPU)
+              .dtype(y.scalar_type())
+              .memory_format(y.suggest_memory_format()),
+          scale,
+          zero_point,
+          c10::nullopt);
+    }
+    Tensor out_chunk = out.narrow(0, start, rows);
+    qadd_into<ReLUFused>(out_chunk, y, qother.narrow(0, start, rows));
+  }
+  return out;
+}
+
+template <int kSpatialDim, bool ReLUFused>
+class QConvAddInt8 final {
+ public:
+  static Tensor run(
+      Tensor act,
+      const c10::intrusive_ptr<ConvPackedParamsBase<kSpatialDim>>& packed_weight,
+      Tensor qother,
+      double conv_scale,
+      int64_t conv_zero_point,
+      double scale,
+      int64_t zero_point) {
+    return qadd_fused<ReLUFused>(
+        act, qother, scale, zero_point, [&](const Tensor& x) {
+          return packed_weight->apply(x, conv_scale, conv_zero_point);
+        });
+  }
+};
+
+template <bool ReLUFused>
+class QLinearAddInt8 final {
+ public:
+  static Tensor run(
+      Tensor input,
+      const c10::intrusive_ptr<LinearPackedParamsBase>& packed_weight,
+      Tensor qother,
+      double linear_scale,
+      int64_t linear_zero_point,
+      double scale,
+      int64_t zero_point) {
+    return qadd_fused<ReLUFused>(
+        input, qother, scale, zero_point, [&](const Tensor& x) {
+          return packed_weight->apply(x, linear_scale, linear_zero_point);
+        });
+  }
+};
+
 
 template <bool ReLUFused = false>
 Tensor qadd_scalar(Tensor qa, Scalar b) {
@@ -278,6 +394,12 @@ TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
   m.impl("add_scalar_relu.Tensor", TORCH_FN(qadd_scalar_tensor</*ReLUFused=*/true>));
   m.impl("add_scalar_out.Tensor", TORCH_FN(qadd_scalar_tensor_out</*ReLUFused=*/false>));
   m.impl("add_scalar_relu_out.Tensor", TORCH_FN(qadd_scalar_tensor_out</*ReLUFused=*/true>));
+  m.impl("conv2d_add",          TORCH_FN((QConvAddInt8<2, /*ReLUFused=*/false>::run)));
+  m.impl("conv2d_add_relu",     TORCH_FN((QConvAddInt8<2, /*ReLUFused=*/true>::run)));
+  m.impl("conv3d_add",          TORCH_FN((QConvAddInt8<3, /*ReLUFused=*/false>::run)));
+  m.impl("conv3d_add_relu",     TORCH_FN((QConvAddInt8<3, /*ReLUFused=*/true>::run)));
+  m.impl("linear_add",          TORCH_FN(QLinearAddInt8</*ReLUFused=*/false>::run));
+  m.impl("linear_add_relu",     TORCH_FN(QLinearAddInt8</*ReLUFused=*/true>::run));
 }
 
 TORCH_LIBRARY_IMPL(_quantized, QuantizedCPU, m) {
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <vector>
 
@@ -9,6 +10,7 @@
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
 #include <ATen/native/quantized/cpu/quant_utils.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
 #include <ATen/native/quantized/cpu/conv_packed_params.h>
 #include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
@@ -354,6 +356,44 @@ at::Tensor PackedConvWeight<kSpatialDim>::apply_impl(
             device(c10::kCPU).dtype(c10::kQUInt8),
             output_scale,
             output_zero_point);
+  if (depthwise_w.defined()) {
+    std::vector<float> requant_scales(M);
+    for (int c = 0; c < M; ++c) {
+      requant_scales[c] = output_multiplier_float
+          [q_scheme == c10::kPerTensorAffine ? 0 : c];
+    }
+    const std::array<int64_t, 3> kernel_dhw = {kernel_d, kernel_h, kernel_w};
+    const std::array<int64_t, 3> stride_dhw = {stride_d, stride_h, stride_w};
+    const std::array<int64_t, 3> pad_dhw = {pad_d, pad_h, pad_w};
+    const std::array<int64_t, 3> dilation_dhw = {
+        dilation_d, dilation_h, dilation_w};
+    if (kReluFused) {
+      at::native::qdepthwise_conv_relu_nhwc_stub(
+          c10::DeviceType::CPU,
+          act_nhwc,
+          depthwise_w,
+          bias_data,
+          requant_scales.data(),
+          kernel_dhw,
+          stride_dhw,
+          pad_dhw,
+          dilation_dhw,
+          output);
+    } else {
+      at::native::qdepthwise_conv_nhwc_stub(
+          c10::DeviceType::CPU,
+          act_nhwc,
+          depthwise_w,
+          bias_data,
+          requant_scales.data(),
+          kernel_dhw,
+          stride_dhw,
+          pad_dhw,
+          dilation_dhw,
+          output);
+    }
+    return output;
+  }
   at::Tensor buffer =
       at::empty(output.sizes(), output.options().dtype(c10::kInt));
   const int num_tasks = at::get_num_threads();
@@ -636,6 +676,10 @@ template at::Tensor PackedConvWeightsQnnp<3>::apply_relu(
 
 namespace at {
 namespace native {
+
+DEFINE_DISPATCH(qdepthwise_conv_nhwc_stub);
+DEFINE_DISPATCH(qdepthwise_conv_relu_nhwc_stub);
+
 namespace {
 
 /*
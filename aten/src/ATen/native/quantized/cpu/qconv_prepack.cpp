@@ -152,6 +152,31 @@ c10::intrusive_ptr<ConvPackedParamsBase<kSpatialDim>> PackedConvWeight<
           zero_points,
           qtype});
 
+  // fbgemm runs depthwise convolutions it has no direct kernel for through
+  // im2col + GEMM, which is slow for one input channel per group. Keep the
+  // weights for the channels-last depthwise kernels in that case.
+  const int kernel_size = kernel_h;
+  const bool is_depthwise =
+      input_channels_per_group == 1 && groups == output_channels;
+  const bool supported_kernel = kernel_w == kernel_size &&
+      (kSpatialDim == 2 || kernel_d == kernel_size) &&
+      (kernel_size == 3 || kernel_size == 5);
+  if (is_depthwise && supported_kernel &&
+      ret_ptr->w->getPackedWForDepthwise() == nullptr) {
+    const int taps = kernel_d * kernel_h * kernel_w;
+    at::Tensor depthwise_w = at::empty({taps, output_channels}, at::kShort);
+    int16_t* depthwise_w_data = depthwise_w.data_ptr<int16_t>();
+    for (int c = 0; c < output_channels; ++c) {
+      const int32_t zero_point =
+          qtype == c10::kPerTensorAffine ? zero_points[0] : zero_points[c];
+      for (int k = 0; k < taps; ++k) {
+        depthwise_w_data[k * output_channels + c] = static_cast<int16_t>(
+            static_cast<int32_t>(weight_data_int8[c * taps + k]) - zero_point);
+      }
+    }
+    ret_ptr->depthwise_w = depthwise_w;
+  }
+
   return ret_ptr;
 }
 
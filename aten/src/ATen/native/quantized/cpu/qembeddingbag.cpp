@@ -0,0 +1,257 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/quantized/cpu/embedding_packed_params.h>
+#include <caffe2/perfkernels/fused_8bit_rowwise_embedding_lookup_idx.h>
+#include <caffe2/perfkernels/fused_nbit_rowwise_conversion.h>
+#include <torch/custom_class.h>
+#include <torch/library.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+const int MODE_SUM = 0;
+const int MODE_MEAN = 1;
+
+// Sums the rows of the bags [begin, end) of a 2 or 4-bit table. Each row is
+// dequantized into `row` by the perfkernels conversion, then accumulated.
+template <typename IndexType>
+void embedding_bag_nbit_range(
+    int64_t begin,
+    int64_t end,
+    int64_t bit_rate,
+    int64_t embedding_dim,
+    int64_t num_rows,
+    int64_t row_size,
+    const uint8_t* weight_data,
+    const IndexType* indices_data,
+    const int64_t* offsets_data,
+    const float* per_sample_weights_data,
+    bool normalize_by_lengths,
+    float* output_data) {
+  std::vector<float> row(embedding_dim);
+  for (int64_t bag = begin; bag < end; ++bag) {
+    float* output = output_data + bag * embedding_dim;
+    std::fill(output, output + embedding_dim, 0.f);
+    for (int64_t i = offsets_data[bag]; i < offsets_data[bag + 1]; ++i) {
+      const int64_t idx = indices_data[i];
+      TORCH_CHECK(
+          idx >= 0 && idx < num_rows,
+          "Index ",
+          i,
+          " is out of bounds: ",
+          idx,
+          ", range 0 to ",
+          num_rows);
+      caffe2::FusedNBitRowwiseQuantizedSBHalfToFloat(
+          bit_rate, weight_data + idx * row_size, 1, row_size, row.data());
+      const float weight =
+          per_sample_weights_data ? per_sample_weights_data[i] : 1.f;
+      for (int64_t j = 0; j < embedding_dim; ++j) {
+        output[j] += weight * row[j];
+      }
+    }
+    const int64_t length = offsets_data[bag + 1] - offsets_data[bag];
+    if (normalize_by_lengths && length > 0) {
+      const float scale = 1.f / length;
+      for (int64_t j = 0; j < embedding_dim; ++j) {
+        output[j] *= scale;
+      }
+    }
+  }
+}
+
+template <typename IndexType>
+void embedding_bag_impl(
+    const PackedEmbeddingBagWeight& packed,
+    const at::Tensor& indices,
+    const int64_t* offsets_data,
+    int64_t output_size,
+    const float* per_sample_weights_data,
+    bool normalize_by_lengths,
+    at::Tensor& output) {
+  const int64_t embedding_dim = packed.embedding_dim();
+  const int64_t num_rows = packed.packed_w.size(0);
+  const int64_t row_size = packed.packed_w.size(1);
+  const uint8_t* weight_data = packed.packed_w.data_ptr<uint8_t>();
+  const IndexType* indices_data = indices.data_ptr<IndexType>();
+  float* output_data = output.data_ptr<float>();
+
+  // As in embedding_bag, a task gets a range of bags, whose offsets are
+  // relative to the first index of the range.
+  at::parallel_for(0, output_size, 1, [&](int64_t begin, int64_t end) {
+    const int64_t first_index = offsets_data[begin];
+    if (packed.bit_rate() == 8) {
+      caffe2::Fused8BitRowwiseEmbeddingLookupIdx<IndexType, uint8_t, float>(
+          /*block_size=*/embedding_dim,
+          /*output_size=*/end - begin,
+          /*index_size=*/offsets_data[end] - first_index,
+          /*data_size=*/num_rows,
+          /*input=*/weight_data,
+          /*indices=*/indices_data + first_index,
+          /*offsets=*/offsets_data + begin,
+          /*weights=*/per_sample_weights_data
+              ? per_sample_weights_data + first_index
+              : nullptr,
+          /*normalize_by_lengths=*/normalize_by_lengths,
+          /*out=*/output_data + begin * embedding_dim);
+    } else {
+      embedding_bag_nbit_range(
+          begin,
+          end,
+          packed.bit_rate(),
+          embedding_dim,
+          num_rows,
+          row_size,
+          weight_data,
+          indices_data,
+          offsets_data,
+          per_sample_weights_data,
+          normalize_by_lengths,
+          output_data);
+    }
+  });
+}
+} // namespace
+
+at::Tensor PackedEmbeddingBagWeight::embeddingbag(
+    const at::Tensor& indices,
+    const c10::optional<at::Tensor>& offsets,
+    int64_t mode,
+    const c10::optional<at::Tensor>& per_sample_weights,
+    bool include_last_offset) {
+  TORCH_CHECK(
+      mode == MODE_SUM || mode == MODE_MEAN,
+      "Quantized embedding bags only support the sum and mean modes, got mode ",
+      mode);
+  TORCH_CHECK(
+      indices.scalar_type() == at::kInt || indices.scalar_type() == at::kLong,
+      "Expected int32 or int64 indices, got ",
+      indices.scalar_type());
+
+  // Without offsets, every row of a 2-D `indices` is a bag.
+  at::Tensor flat_indices;
+  at::Tensor offsets_include_last;
+  if (offsets.has_value()) {
+    TORCH_CHECK(
+        indices.dim() == 1,
+        "Expected 1-D indices when offsets are given, got ",
+        indices.dim(),
+        "-D indices");
+    TORCH_CHECK(offsets->dim() == 1, "Expected 1-D offsets");
+    TORCH_CHECK(
+        !include_last_offset || offsets->numel() >= 1,
+        "include_last_offset: number of offsets should be at least 1");
+    flat_indices = indices.contiguous();
+    offsets_include_last = offsets->to(at::kLong).contiguous();
+    if (!include_last_offset) {
+      offsets_include_last = at::cat(
+          {offsets_include_last,
+           at::full({1}, indices.numel(), offsets_include_last.options())});
+    }
+  } else {
+    TORCH_CHECK(
+        indices.dim() == 2,
+        "Expected 2-D indices when offsets are not given, got ",
+        indices.dim(),
+        "-D indices");
+    flat_indices = indices.contiguous().view(-1);
+    offsets_include_last =
+        at::arange(indices.size(0) + 1, indices.options().dtype(at::kLong))
+            .mul_(indices.size(1));
+  }
+  const int64_t output_size = offsets_include_last.numel() - 1;
+  const int64_t* offsets_data = offsets_include_last.data_ptr<int64_t>();
+  TORCH_CHECK(
+      offsets_data[0] == 0 && offsets_data[output_size] == flat_indices.numel(),
+      "Offsets should start at 0 and cover all the ",
+      flat_indices.numel(),
+      " indices");
+  for (int64_t bag = 0; bag < output_size; ++bag) {
+    TORCH_CHECK(
+        offsets_data[bag] <= offsets_data[bag + 1],
+        "Offsets should be non-decreasing, got ",
+        offsets_data[bag],
+        " before ",
+        offsets_data[bag + 1]);
+  }
+
+  at::Tensor per_sample_weights_contig;
+  const float* per_sample_weights_data = nullptr;
+  if (per_sample_weights.has_value()) {
+    TORCH_CHECK(
+        mode == MODE_SUM,
+        "Per sample weights are only supported with the sum mode");
+    TORCH_CHECK(
+        per_sample_weights->scalar_type() == at::kFloat &&
+            per_sample_weights->numel() == flat_indices.numel(),
+        "Expected a float per sample weight for each of the ",
+        flat_indices.numel(),
+        " indices");
+    per_sample_weights_contig = per_sample_weights->contiguous();
+    per_sample_weights_data = per_sample_weights_contig.data_ptr<float>();
+  }
+
+  auto output = at::empty(
+      {output_size, embedding_dim()}, packed_w.options().dtype(at::kFloat));
+  if (flat_indices.scalar_type() == at::kInt) {
+    embedding_bag_impl<int32_t>(
+        *this,
+        flat_indices,
+        offsets_data,
+        output_size,
+        per_sample_weights_data,
+        mode == MODE_MEAN,
+        output);
+  } else {
+    embedding_bag_impl<int64_t>(
+        *this,
+        flat_indices,
+        offsets_data,
+        output_size,
+        per_sample_weights_data,
+        mode == MODE_MEAN,
+        output);
+  }
+  return output;
+}
+
+namespace at {
+namespace native {
+namespace {
+
+template <int64_t kBitRate>
+class QEmbeddingBag final {
+ public:
+  // scale_grad_by_freq and sparse only matter for the gradients of
+  // embedding_bag. They are accepted so that the op can replace it.
+  static at::Tensor run(
+      const c10::intrusive_ptr<EmbeddingPackedParamsBase>& packed_weight,
+      const Tensor& indices,
+      const c10::optional<Tensor>& offsets,
+      bool /* scale_grad_by_freq */,
+      int64_t mode,
+      bool /* sparse */,
+      const c10::optional<Tensor>& per_sample_weights,
+      bool include_last_offset) {
+    TORCH_CHECK(
+        packed_weight->bit_rate() == kBitRate,
+        "Expected embedding weights packed with ",
+        kBitRate,
+        " bits, got ",
+        packed_weight->bit_rate(),
+        " bits");
+    return packed_weight->embeddingbag(
+        indices, offsets, mode, per_sample_weights, include_last_offset);
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, CPU, m) {
+  m.impl("embedding_bag_byte", TORCH_FN(QEmbeddingBag<8>::run));
+  m.impl("embedding_bag_4bit", TORCH_FN(QEmbeddingBag<4>::run));
+  m.impl("embedding_bag_2bit", TORCH_FN(QEmbeddingBag<2>::run));
+}
+
+} // namespace
+} // namespace native
+} // namespace at
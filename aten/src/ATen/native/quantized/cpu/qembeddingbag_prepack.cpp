@@ -0,0 +1,191 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/quantized/cpu/embedding_packed_params.h>
+#include <caffe2/perfkernels/fused_nbit_rowwise_conversion.h>
+#include <torch/custom_class.h>
+#include <torch/library.h>
+
+#include <limits>
+
+torch::jit::class_<EmbeddingPackedParamsBase> register_embedding_params();
+
+namespace {
+// Rows converted by a call to the conversion kernels, which take the number of
+// rows as an int.
+constexpr int64_t kRowsPerTask = 1024;
+
+int64_t packed_row_size(int64_t embedding_dim, int64_t bit_rate) {
+  if (bit_rate == 8) {
+    return embedding_dim + 2 * sizeof(float);
+  }
+  const int64_t num_elem_per_byte = 8 / bit_rate;
+  return embedding_dim / num_elem_per_byte + 2 * sizeof(at::Half);
+}
+} // namespace
+
+int64_t PackedEmbeddingBagWeight::embedding_dim() const {
+  if (bit_rate_ == 8) {
+    return packed_w.size(1) - 2 * sizeof(float);
+  }
+  const int64_t num_elem_per_byte = 8 / bit_rate_;
+  return (packed_w.size(1) - 2 * sizeof(at::Half)) * num_elem_per_byte;
+}
+
+c10::intrusive_ptr<EmbeddingPackedParamsBase> PackedEmbeddingBagWeight::prepack(
+    const at::Tensor& weight,
+    int64_t bit_rate) {
+  TORCH_CHECK(
+      bit_rate == 8 || bit_rate == 4 || bit_rate == 2,
+      "Embedding bags can only be quantized to 8, 4 or 2 bits, got ",
+      bit_rate);
+  TORCH_CHECK(
+      weight.dim() == 2 && weight.scalar_type() == at::kFloat,
+      "Expected a 2-D float embedding weight, got a ",
+      weight.dim(),
+      "-D ",
+      weight.scalar_type(),
+      " tensor");
+  const int64_t num_rows = weight.size(0);
+  const int64_t embedding_dim = weight.size(1);
+  TORCH_CHECK(
+      embedding_dim <= std::numeric_limits<int>::max(),
+      "Embedding dimension ",
+      embedding_dim,
+      " is too large to be quantized");
+  // A packed row has no room for the number of values it holds, which must
+  // then fill its bytes.
+  TORCH_CHECK(
+      embedding_dim % (8 / bit_rate) == 0,
+      "The embedding dimension must be a multiple of ",
+      8 / bit_rate,
+      " to be quantized to ",
+      bit_rate,
+      " bits, got ",
+      embedding_dim);
+
+  const auto weight_contig = weight.contiguous();
+  const float* weight_data = weight_contig.data_ptr<float>();
+  const int64_t row_size = packed_row_size(embedding_dim, bit_rate);
+  auto packed_w = at::empty(
+      {num_rows, row_size}, weight.options().dtype(at::kByte));
+  uint8_t* packed_data = packed_w.data_ptr<uint8_t>();
+
+  at::parallel_for(0, num_rows, kRowsPerTask, [&](int64_t begin, int64_t end) {
+    for (int64_t start = begin; start < end; start += kRowsPerTask) {
+      const int rows = std::min(kRowsPerTask, end - start);
+      if (bit_rate == 8) {
+        caffe2::FloatToFused8BitRowwiseQuantized(
+            weight_data + start * embedding_dim,
+            rows,
+            embedding_dim,
+            packed_data + start * row_size);
+      } else {
+        caffe2::FloatToFusedNBitRowwiseQuantizedSBHalf(
+            bit_rate,
+            weight_data + start * embedding_dim,
+            rows,
+            embedding_dim,
+            packed_data + start * row_size);
+      }
+    }
+  });
+  return c10::make_intrusive<PackedEmbeddingBagWeight>(
+      std::move(packed_w), bit_rate);
+}
+
+at::Tensor PackedEmbeddingBagWeight::unpack() {
+  const int64_t num_rows = packed_w.size(0);
+  const int64_t row_size = packed_w.size(1);
+  const int64_t dim = embedding_dim();
+  auto weight = at::empty({num_rows, dim}, packed_w.options().dtype(at::kFloat));
+  const uint8_t* packed_data = packed_w.data_ptr<uint8_t>();
+  float* weight_data = weight.data_ptr<float>();
+
+  at::parallel_for(0, num_rows, kRowsPerTask, [&](int64_t begin, int64_t end) {
+    for (int64_t start = begin; start < end; start += kRowsPerTask) {
+      const int rows = std::min(kRowsPerTask, end - start);
+      if (bit_rate_ == 8) {
+        caffe2::Fused8BitRowwiseQuantizedToFloat(
+            packed_data + start * row_size,
+            rows,
+            row_size,
+            weight_data + start * dim);
+      } else {
+        caffe2::FusedNBitRowwiseQuantizedSBHalfToFloat(
+            bit_rate_,
+            packed_data + start * row_size,
+            rows,
+            row_size,
+            weight_data + start * dim);
+      }
+    }
+  });
+  return weight;
+}
+
+torch::jit::class_<EmbeddingPackedParamsBase> register_embedding_params() {
+  // The packed rows are serialized as they are: unpacking them would store
+  // the table as floats, 4 to 16 times larger.
+  using SerializationType = std::tuple<int64_t, at::Tensor>;
+  static auto register_embedding_params =
+      torch::jit::class_<EmbeddingPackedParamsBase>(
+          "quantized", "EmbeddingPackedParamsBase")
+          .def_pickle(
+              [](const c10::intrusive_ptr<EmbeddingPackedParamsBase>& params)
+                  -> SerializationType { // __getstate__
+                const auto* packed =
+                    dynamic_cast<const PackedEmbeddingBagWeight*>(params.get());
+                TORCH_CHECK(
+                    packed, "Unknown EmbeddingPackedParams implementation");
+                return std::make_tuple(packed->bit_rate(), packed->packed_w);
+              },
+              [](SerializationType state)
+                  -> c10::intrusive_ptr<
+                      EmbeddingPackedParamsBase> { // __setstate__
+                int64_t bit_rate = std::get<0>(state);
+                at::Tensor packed_w = std::move(std::get<1>(state));
+                TORCH_CHECK(
+                    (bit_rate == 8 || bit_rate == 4 || bit_rate == 2) &&
+                        packed_w.dim() == 2 &&
+                        packed_w.scalar_type() == at::kByte,
+                    "Invalid packed weights in serialized "
+                    "EmbeddingPackedParams object");
+                return c10::make_intrusive<PackedEmbeddingBagWeight>(
+                    std::move(packed_w), bit_rate);
+              });
+  return register_embedding_params;
+}
+
+namespace at {
+namespace native {
+namespace {
+
+template <int64_t kBitRate>
+class QEmbeddingBagPackWeight final {
+ public:
+  static c10::intrusive_ptr<EmbeddingPackedParamsBase> run(at::Tensor weight) {
+    return PackedEmbeddingBagWeight::prepack(weight, kBitRate);
+  }
+};
+
+class QEmbeddingBagUnpackWeight final {
+ public:
+  static at::Tensor run(
+      const c10::intrusive_ptr<EmbeddingPackedParamsBase>& packed_weight) {
+    return packed_weight->unpack();
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, CPU, m) {
+  m.impl("embedding_bag_byte_prepack", TORCH_FN(QEmbeddingBagPackWeight<8>::run));
+  m.impl("embedding_bag_4bit_prepack", TORCH_FN(QEmbeddingBagPackWeight<4>::run));
+  m.impl("embedding_bag_2bit_prepack", TORCH_FN(QEmbeddingBagPackWeight<2>::run));
+}
+
+TORCH_LIBRARY_IMPL(quantized, CatchAll, m) {
+  m.impl("embedding_bag_unpack", TORCH_FN(QEmbeddingBagUnpackWeight::run));
+}
+
+} // namespace
+} // namespace native
+} // namespace at
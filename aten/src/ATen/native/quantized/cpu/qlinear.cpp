@@ -253,16 +253,6 @@ at::Tensor PackedLinearWeightsQnnp::apply_impl(
     generate_requantization_scales(
         w_scales, input_scale, output_scale, requantization_scales);
 
-    at::Tensor qnnp_weight = at::_empty_affine_quantized(
-        weight_contig.sizes(),
-        at::device(c10::kCPU).dtype(c10::kQUInt8),
-        weight_scales_data[0],
-        w_zero_points[0]);
-    auto* qnnp_w_data = qnnp_weight.data_ptr<c10::quint8>();
-    auto wt_numel = weight_contig.numel();
-    for (int i = 0; i < wt_numel; ++i) {
-      qnnp_w_data[i] = static_cast<c10::quint8>(w_data[i] + 128);
-    }
     // Original bias was float, so we requantize it here.
     const bool is_per_channel = orig_weight.qscheme() == at::kPerChannelAffine;
     at::Tensor qbias;
@@ -280,15 +270,31 @@ at::Tensor PackedLinearWeightsQnnp::apply_impl(
 
     // Update the input scale to not pack again.
     this->input_scale = input_scale;
-    w.reset();
-    w = std::make_unique<qnnpack::PackBMatrix>(
-        cols_w /* input_channels */,
-        rows_w /* output_channels */,
-        w_zero_points.data(),
-        requantization_scales.data(),
-        reinterpret_cast<uint8_t*>(qnnp_w_data),
-        reinterpret_cast<int32_t*>(qbias.data_ptr<c10::qint32>()));
-    packB = w.get();
+    if (w_sparse) {
+      // The block-sparse weights were packed at prepack time, only the bias
+      // depends on the input scale.
+      sparse_qbias = qbias;
+    } else {
+      at::Tensor qnnp_weight = at::_empty_affine_quantized(
+          weight_contig.sizes(),
+          at::device(c10::kCPU).dtype(c10::kQUInt8),
+          weight_scales_data[0],
+          w_zero_points[0]);
+      auto* qnnp_w_data = qnnp_weight.data_ptr<c10::quint8>();
+      auto wt_numel = weight_contig.numel();
+      for (int i = 0; i < wt_numel; ++i) {
+        qnnp_w_data[i] = static_cast<c10::quint8>(w_data[i] + 128);
+      }
+      w.reset();
+      w = std::make_unique<qnnpack::PackBMatrix>(
+          cols_w /* input_channels */,
+          rows_w /* output_channels */,
+          w_zero_points.data(),
+          requantization_scales.data(),
+          reinterpret_cast<uint8_t*>(qnnp_w_data),
+          reinterpret_cast<int32_t*>(qbias.data_ptr<c10::qint32>()));
+      packB = w.get();
+    }
     if (at::globalContext().releaseWeightsWhenPrepacking()) {
       // On mobile, we release the original weight by resetting the intrusive_ptr.
       // Calling unpack after this will throw an assertion.
@@ -325,6 +331,32 @@ at::Tensor PackedLinearWeightsQnnp::apply_impl(
       ? activationLimits(output_scale, output_zero_point, Activation::RELU)
             .second
       : std::numeric_limits<uint8_t>::max();
+  if (w_sparse) {
+    const pytorch_qnnp_status runStatus = qnnpack::qnnpackLinearSparse(
+        rows_input /* batch_size */,
+        cols_input /* input_channels */,
+        rows_w /* output_channels */,
+        input_contig.q_zero_point(),
+        w_zero_points.data(),
+        requantization_scales.data(),
+        output_zero_point,
+        output_min,
+        output_max,
+        (uint8_t*)input_contig.data_ptr<c10::quint8>(),
+        cols_input /* input_stride */,
+        *w_sparse,
+        reinterpret_cast<int32_t*>(sparse_qbias.data_ptr<c10::qint32>()),
+        (uint8_t*)output.data_ptr<c10::quint8>(),
+        rows_w /* output_stride */,
+        caffe2::mobile_pthreadpool() /* threadpool */);
+
+    TORCH_INTERNAL_ASSERT(
+        runStatus == pytorch_qnnp_status_success,
+        "failed to run QNNPACK sparse Linear operator");
+
+    return output;
+  }
+
   TORCH_INTERNAL_ASSERT(packB != nullptr, "Packed Weights are NULL");
   const pytorch_qnnp_status runStatus = qnnpack::qnnpackLinear(
       rows_input /* batch_size */,
@@ -18,6 +18,25 @@ torch::jit::class_<LinearPackedParamsBase> register_linear_params();
 #ifdef USE_FBGEMM
 template <bool ReluFused>
 at::Tensor PackedLinearWeight::apply_dynamic_impl(at::Tensor input, bool reduce_range) {
+  TORCH_CHECK(
+      input.dim() >= 2,
+      "The dimension of input tensor should be larger than or equal to 2");
+  // The resulting matrix here is 2-D, let's view it with the original
+  // left hand dimensions of the input. Here are two examples:
+  // 1. If the input tensor is {M, K}, the output tensor is {M, N}.
+  // 2. If the input tensor is {b, M, K}, the output tensor is {b, M, N}.
+  std::vector<int64_t> out_sizes = input.sizes().vec();
+  out_sizes.back() = static_cast<int64_t>(w->numCols());
+  auto output = at::empty(out_sizes, input.options().dtype(at::kFloat));
+  apply_dynamic_impl_out<ReluFused>(input, output, reduce_range);
+  return output;
+}
+
+template <bool ReluFused>
+void PackedLinearWeight::apply_dynamic_impl_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    bool reduce_range) {
   using at::Tensor;
   // fp32 * int8 -> fp32 (with quantization on activation, and dequantization
   // on the result).
@@ -91,14 +110,12 @@ at::Tensor PackedLinearWeight::apply_dynamic_impl(at::Tensor input, bool reduce_
     auto bias_contig = bias_vec.contiguous();
     bias_ptr = bias_contig.data_ptr<float>();
   }
-  // The resulting matrix here is 2-D, let's view it with the original
-  // left hand dimensions of the input. Here are two examples:
-  // 1. If the input tensor is {M, K}, the output tensor is {M, N}.
-  // 2. If the input tensor is {b, M, K}, the output tensor is {b, M, N}.
-  std::vector<int64_t> out_sizes = input.sizes().vec();
-  out_sizes.back() = N;
-  // Allocate output Tensor and a buffer for fbgemmPacked to use
-  auto output = at::empty(out_sizes, input.options().dtype(at::kFloat));
+  TORCH_CHECK(
+      output.scalar_type() == at::kFloat && output.is_contiguous() &&
+          output.numel() == M * N,
+      "The output of a dynamic quantized linear should be a contiguous float "
+      "tensor of ", M * N, " elements");
+  // Allocate a buffer for fbgemmPacked to use
   auto buffer = at::empty_like(
       output,
       output.options().dtype(at::kInt),
@@ -203,14 +220,20 @@ at::Tensor PackedLinearWeight::apply_dynamic_impl(at::Tensor input, bool reduce_
       }
     }
   });
-
-  return output;
 }
 
 at::Tensor PackedLinearWeight::apply_dynamic(at::Tensor input, bool reduce_range) {
   return apply_dynamic_impl</*ReluFused=*/false>(std::move(input), reduce_range);
 }
 
+at::Tensor& PackedLinearWeight::apply_dynamic_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    bool reduce_range) {
+  apply_dynamic_impl_out</*ReluFused=*/false>(input, output, reduce_range);
+  return output;
+}
+
 at::Tensor PackedLinearWeight::apply_dynamic_relu(at::Tensor input, bool reduce_range) {
   return apply_dynamic_impl</*ReluFused=*/true>(std::move(input), reduce_range);
 }
@@ -158,6 +158,23 @@ c10::intrusive_ptr<LinearPackedParamsBase> PackedLinearWeightsQnnp::prepack(
       c10::nullopt, /* input_scale */
       w_scales,
       std::move(w_zero_points));
+
+  // Unlike the dense packing, the block-sparse packing does not depend on the
+  // input scale, so it is done here. The weights are adjusted to uint8 the
+  // same way as in qlinear.cpp.
+  const int8_t* w_data = (int8_t*)weight_contig.data_ptr<c10::qint8>();
+  std::vector<uint8_t> qnnp_w_data(weight_contig.numel());
+  for (size_t i = 0; i < qnnp_w_data.size(); ++i) {
+    qnnp_w_data[i] = static_cast<uint8_t>(w_data[i] + 128);
+  }
+  auto w_sparse = std::make_unique<qnnpack::PackBMatrixSparse>(
+      weight_contig.size(1) /* input_channels */,
+      rows_w /* output_channels */,
+      wt_ptr->w_zero_points.data(),
+      qnnp_w_data.data());
+  if (w_sparse->getBlockDensity() < kQnnpackSparseBlockDensityThreshold) {
+    wt_ptr->w_sparse = std::move(w_sparse);
+  }
   return wt_ptr;
 }
 #endif // USE_PYTORCH_QNNPACK
@@ -0,0 +1,330 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/quantized/cpu/embedding_packed_params.h>
+#include <TH/THBlasUtils.h>
+#include <caffe2/perfkernels/fused_nbit_rowwise_conversion.h>
+#include <torch/library.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+// Keys scored at a time, and queries scored against them at a time.
+constexpr int64_t kKeyBlock = 256;
+constexpr int64_t kQueryBlock = 64;
+
+using ScoredKey = std::pair<float, int64_t>;
+
+// Higher scores first, ties go to the lowest key, as with a stable sort.
+inline bool better(const ScoredKey& a, const ScoredKey& b) {
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Heap of the k best scored keys seen so far, the worst one on top.
+class TopK {
+ public:
+  explicit TopK(int64_t k) : k_(k) {
+    heap_.reserve(k);
+  }
+
+  void push(float score, int64_t key) {
+    const ScoredKey scored(score, key);
+    if (static_cast<int64_t>(heap_.size()) < k_) {
+      heap_.push_back(scored);
+      std::push_heap(heap_.begin(), heap_.end(), better);
+    } else if (better(scored, heap_.front())) {
+      std::pop_heap(heap_.begin(), heap_.end(), better);
+      heap_.back() = scored;
+      std::push_heap(heap_.begin(), heap_.end(), better);
+    }
+  }
+
+  const std::vector<ScoredKey>& entries() const {
+    return heap_;
+  }
+
+ private:
+  int64_t k_;
+  std::vector<ScoredKey> heap_;
+};
+
+// Returns the k best scores of every query, in decreasing order, and the keys
+// they are for. The keys are split into one range per thread, which goes
+// through its range kKeyBlock keys at a time: scorer.load(j0, jb) prepares
+// the keys [j0, j0 + jb), and scorer.score(q0, qb, scores) writes the qb x jb
+// row-major scores of the queries [q0, q0 + qb) for them. Only these scores
+// and a heap of k keys per query and thread exist at any time, the heaps are
+// merged at the end.
+template <typename Scorer>
+std::tuple<at::Tensor, at::Tensor> streaming_topk(
+    const Scorer& prototype,
+    int64_t num_queries,
+    int64_t num_keys,
+    int64_t k,
+    const at::TensorOptions& options) {
+  auto values = at::empty({num_queries, k}, options.dtype(at::kFloat));
+  auto indices = at::empty({num_queries, k}, options.dtype(at::kLong));
+  if (k == 0) {
+    return std::make_tuple(values, indices);
+  }
+  const int64_t num_ranges = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), at::divup(num_keys, kKeyBlock)));
+  const int64_t range_size = at::divup(num_keys, num_ranges);
+  std::vector<std::vector<TopK>> range_topk(num_ranges);
+
+  at::parallel_for(0, num_ranges, 1, [&](int64_t begin, int64_t end) {
+    Scorer scorer = prototype;
+    std::vector<float> scores(kQueryBlock * kKeyBlock);
+    for (int64_t r = begin; r < end; ++r) {
+      auto& topk = range_topk[r];
+      topk.assign(num_queries, TopK(k));
+      const int64_t range_end = std::min(num_keys, (r + 1) * range_size);
+      for (int64_t j0 = r * range_size; j0 < range_end; j0 += kKeyBlock) {
+        const int64_t jb = std::min(kKeyBlock, range_end - j0);
+        scorer.load(j0, jb);
+        for (int64_t q0 = 0; q0 < num_queries; q0 += kQueryBlock) {
+          const int64_t qb = std::min(kQueryBlock, num_queries - q0);
+          scorer.score(q0, qb, scores.data());
+          for (int64_t q = 0; q < qb; ++q) {
+            const float* row = scores.data() + q * jb;
+            for (int64_t j = 0; j < jb; ++j) {
+              topk[q0 + q].push(row[j], j0 + j);
+            }
+          }
+        }
+      }
+    }
+  });
+
+  float* values_data = values.data_ptr<float>();
+  int64_t* indices_data = indices.data_ptr<int64_t>();
+  at::parallel_for(0, num_queries, 1, [&](int64_t begin, int64_t end) {
+    std::vector<ScoredKey> merged;
+    for (int64_t q = begin; q < end; ++q) {
+      merged.clear();
+      for (const auto& topk : range_topk) {
+        merged.insert(
+            merged.end(), topk[q].entries().begin(), topk[q].entries().end());
+      }
+      std::partial_sort(merged.begin(), merged.begin() + k, merged.end(), better);
+      for (int64_t i = 0; i < k; ++i) {
+        values_data[q * k + i] = merged[i].first;
+        indices_data[q * k + i] = merged[i].second;
+      }
+    }
+  });
+  return std::make_tuple(values, indices);
+}
+
+// Inner products with the rows of a row-wise quantized table. The rows of a
+// block are dequantized once, then multiplied with every block of queries.
+class EmbeddingScorer {
+ public:
+  EmbeddingScorer(
+      const PackedEmbeddingBagWeight& packed,
+      const float* query_data,
+      int64_t embedding_dim)
+      : bit_rate_(packed.bit_rate()),
+        row_size_(packed.packed_w.size(1)),
+        weight_data_(packed.packed_w.data_ptr<uint8_t>()),
+        query_data_(query_data),
+        embedding_dim_(embedding_dim),
+        rows_(kKeyBlock * embedding_dim) {}
+
+  void load(int64_t j0, int64_t jb) {
+    jb_ = jb;
+    if (bit_rate_ == 8) {
+      caffe2::Fused8BitRowwiseQuantizedToFloat(
+          weight_data_ + j0 * row_size_, jb, row_size_, rows_.data());
+    } else {
+      caffe2::FusedNBitRowwiseQuantizedSBHalfToFloat(
+          bit_rate_, weight_data_ + j0 * row_size_, jb, row_size_, rows_.data());
+    }
+  }
+
+  void score(int64_t q0, int64_t qb, float* scores) {
+    // In column-major order the scores are rows * queries^T.
+    THBlas_gemm<float>(
+        't',
+        'n',
+        jb_,
+        qb,
+        embedding_dim_,
+        1.f,
+        rows_.data(),
+        embedding_dim_,
+        const_cast<float*>(query_data_ + q0 * embedding_dim_),
+        embedding_dim_,
+        0.f,
+        scores,
+        jb_);
+  }
+
+ private:
+  int64_t bit_rate_;
+  int64_t row_size_;
+  const uint8_t* weight_data_;
+  const float* query_data_;
+  int64_t embedding_dim_;
+  std::vector<float> rows_;
+  int64_t jb_ = 0;
+};
+
+// Inner products with product quantized keys, from the table of the inner
+// products of every subvector of every query with every centroid of its
+// codebook.
+class ProductQuantizedScorer {
+ public:
+  ProductQuantizedScorer(
+      const float* lut_data,
+      const uint8_t* codes_data,
+      int64_t num_subvectors,
+      int64_t num_centroids)
+      : lut_data_(lut_data),
+        codes_data_(codes_data),
+        num_subvectors_(num_subvectors),
+        num_centroids_(num_centroids) {}
+
+  void load(int64_t j0, int64_t jb) {
+    j0_ = j0;
+    jb_ = jb;
+  }
+
+  void score(int64_t q0, int64_t qb, float* scores) const {
+    for (int64_t q = 0; q < qb; ++q) {
+      const float* lut = lut_data_ + (q0 + q) * num_subvectors_ * num_centroids_;
+      for (int64_t j = 0; j < jb_; ++j) {
+        const uint8_t* code = codes_data_ + (j0_ + j) * num_subvectors_;
+        float sum = 0.f;
+        for (int64_t m = 0; m < num_subvectors_; ++m) {
+          sum += lut[m * num_centroids_ + code[m]];
+        }
+        scores[q * jb_ + j] = sum;
+      }
+    }
+  }
+
+ private:
+  const float* lut_data_;
+  const uint8_t* codes_data_;
+  int64_t num_subvectors_;
+  int64_t num_centroids_;
+  int64_t j0_ = 0;
+  int64_t jb_ = 0;
+};
+
+void check_topk_query(const at::Tensor& query, int64_t dim, int64_t k, int64_t num_keys) {
+  TORCH_CHECK(
+      query.dim() == 2 && query.scalar_type() == at::kFloat,
+      "Expected a 2-D float query, got a ",
+      query.dim(),
+      "-D ",
+      query.scalar_type(),
+      " tensor");
+  TORCH_CHECK(
+      query.size(1) == dim,
+      "Expected queries of dimension ",
+      dim,
+      ", got ",
+      query.size(1));
+  TORCH_CHECK(
+      k >= 0 && k <= num_keys,
+      "k (",
+      k,
+      ") must be between 0 and the number of keys (",
+      num_keys,
+      ")");
+}
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor> PackedEmbeddingBagWeight::mm_topk(
+    const at::Tensor& query,
+    int64_t k) {
+  const int64_t num_rows = packed_w.size(0);
+  check_topk_query(query, embedding_dim(), k, num_rows);
+  const auto query_contig = query.contiguous();
+  EmbeddingScorer scorer(
+      *this, query_contig.data_ptr<float>(), embedding_dim());
+  return streaming_topk(
+      scorer, query.size(0), num_rows, k, query.options());
+}
+
+namespace at {
+namespace native {
+namespace {
+
+class QEmbeddingMMTopK final {
+ public:
+  static std::tuple<Tensor, Tensor> run(
+      const c10::intrusive_ptr<EmbeddingPackedParamsBase>& packed_weight,
+      const Tensor& query,
+      int64_t k) {
+    return packed_weight->mm_topk(query, k);
+  }
+};
+
+// Product quantization: the D columns of the keys are split into M
+// subvectors of D / M columns, and the m-th subvector of the key n is
+// approximated by the centroid codes[n][m] of the m-th codebook.
+class QProductQuantizedMMTopK final {
+ public:
+  static std::tuple<Tensor, Tensor> run(
+      const Tensor& query,
+      const Tensor& codebooks,
+      const Tensor& codes,
+      int64_t k) {
+    TORCH_CHECK(
+        codebooks.dim() == 3 && codebooks.scalar_type() == kFloat,
+        "Expected float codebooks of shape (num_subvectors, num_centroids, "
+        "subvector_dim)");
+    TORCH_CHECK(
+        codes.dim() == 2 && codes.scalar_type() == kByte &&
+            codes.size(1) == codebooks.size(0),
+        "Expected uint8 codes of shape (num_keys, ",
+        codebooks.size(0),
+        ")");
+    TORCH_CHECK(
+        codebooks.size(1) <= 256,
+        "Expected at most 256 centroids per codebook, got ",
+        codebooks.size(1));
+    const int64_t num_subvectors = codebooks.size(0);
+    const int64_t num_centroids = codebooks.size(1);
+    check_topk_query(query, num_subvectors * codebooks.size(2), k, codes.size(0));
+
+    // lut[q][m][c] is the inner product of the m-th subvector of the query q
+    // with the centroid c of the m-th codebook.
+    const auto lut =
+        at::bmm(
+            query.contiguous()
+                .view({query.size(0), num_subvectors, -1})
+                .transpose(0, 1),
+            codebooks.transpose(1, 2))
+            .transpose(0, 1)
+            .contiguous();
+    const auto codes_contig = codes.contiguous();
+    const uint8_t* codes_data = codes_contig.data_ptr<uint8_t>();
+    for (int64_t i = 0; i < codes_contig.numel(); ++i) {
+      TORCH_CHECK(
+          codes_data[i] < num_centroids,
+          "Code ",
+          static_cast<int>(codes_data[i]),
+          " is out of bounds for codebooks of ",
+          num_centroids,
+          " centroids");
+    }
+    ProductQuantizedScorer scorer(
+        lut.data_ptr<float>(), codes_data, num_subvectors, num_centroids);
+    return streaming_topk(
+        scorer, query.size(0), codes.size(0), k, query.options());
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, CPU, m) {
+  m.impl("embedding_mm_topk", TORCH_FN(QEmbeddingMMTopK::run));
+  m.impl("pq_mm_topk", TORCH_FN(QProductQuantizedMMTopK::run));
+}
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -124,6 +124,7 @@ def main(args):
                     build.cc("q8gemm/4x8c2-xzp-neon.c"),
                     build.cc("q8gemm/6x4-neon.c"),
                     build.cc("q8gemm/8x8-neon.c"),
+                    build.cc("q8gemm_sparse/4x8c1x4-neon.c"),
                     build.cc("q8vadd/neon.c"),
                     build.cc("sgemm/5x8-neon.c"),
                     build.cc("sgemm/6x8-neon.c"),
@@ -163,6 +164,7 @@ def main(args):
                         build.cc("q8gavgpool/up8xm-sse2.c"),
                         build.cc("q8gemm/2x4c8-sse2.c"),
                         build.cc("q8gemm/4x4c2-sse2.c"),
+                        build.cc("q8gemm_sparse/4x4c1x4-sse2.c"),
                         build.cc("q8vadd/sse2.c"),
                         build.cc("u8clamp/sse2.c"),
                         build.cc("u8maxpool/16x9p8q-sse2.c"),
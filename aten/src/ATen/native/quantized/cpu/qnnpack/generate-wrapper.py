@@ -35,6 +35,7 @@ QNNPACK_SOURCES = {
         "q8gemm/4x8c2-xzp-neon.c",
         "q8gemm/6x4-neon.c",
         "q8gemm/8x8-neon.c",
+        "q8gemm_sparse/4x8c1x4-neon.c",
         "q8vadd/neon.c",
         "requantization/fp32-neon.c",
         "requantization/gemmlowp-neon.c",
@@ -67,6 +68,7 @@ QNNPACK_SOURCES = {
         "q8gemm/2x4c8-sse2.c",
         "q8gemm/4x4c2-dq-sse2.c",
         "q8gemm/4x4c2-sse2.c",
+        "q8gemm_sparse/4x4c1x4-sse2.c",
         "q8vadd/sse2.c",
         "requantization/fp32-sse2.c",
         "requantization/gemmlowp-sse2.c",
@@ -1,5 +1,6 @@
 #pragma once
 #include <conv_utils.h>
+#include <vector>
 
 namespace qnnpack {
 class PrePackConvWeights final {
@@ -91,6 +92,66 @@ class PackBMatrix final {
   size_t output_channels_;
 };
 
+// Packs the weights of a fully connected layer as 1x4 blocks in block-CSR
+// format: only blocks of 4 consecutive input channels with at least one
+// weight different from the kernel zero point of their output channel are
+// kept. Bias is not packed, as it depends on the input scale, and is passed
+// to qnnpackLinearSparse instead.
+class PackBMatrixSparse final {
+ public:
+  PackBMatrixSparse(
+      size_t input_channels,
+      size_t output_channels,
+      const uint8_t* kernel_zero_points,
+      const uint8_t* kernel);
+
+  const uint32_t* getRowPtr() const
+  {
+    return row_ptr_.data();
+  }
+
+  const uint32_t* getBlockIds() const
+  {
+    return block_ids_.data();
+  }
+
+  const uint8_t* getValues() const
+  {
+    return values_.data();
+  }
+
+  size_t getInputChannels() const
+  {
+    return input_channels_;
+  }
+
+  size_t getOutputChannels() const
+  {
+    return output_channels_;
+  }
+
+  // Fraction of the 1x4 blocks of the weight that have non-zero weights.
+  float getBlockDensity() const
+  {
+    const size_t k_blocks = (input_channels_ + 3) / 4;
+    const size_t total_blocks = k_blocks * output_channels_;
+    return total_blocks == 0
+        ? 0.0f
+        : static_cast<float>(block_ids_.size()) / total_blocks;
+  }
+
+  PackBMatrixSparse() = delete;
+  PackBMatrixSparse(const PackBMatrixSparse&) = delete;
+  PackBMatrixSparse& operator=(const PackBMatrixSparse&) = delete;
+
+ private:
+  std::vector<uint32_t> row_ptr_;
+  std::vector<uint32_t> block_ids_;
+  std::vector<uint8_t> values_;
+  size_t input_channels_;
+  size_t output_channels_;
+};
+
 enum pytorch_qnnp_status qnnpackLinear(
     const size_t batch_size,
     const size_t input_channels,
@@ -108,6 +169,24 @@ enum pytorch_qnnp_status qnnpackLinear(
     const size_t output_stride,
     pthreadpool_t threadpool);
 
+enum pytorch_qnnp_status qnnpackLinearSparse(
+    const size_t batch_size,
+    const size_t input_channels,
+    const size_t output_channels,
+    const uint8_t input_zero_point,
+    const uint8_t* kernel_zero_points,
+    const float* requantization_scales,
+    const uint8_t output_zero_point,
+    const uint8_t output_min,
+    const uint8_t output_max,
+    const uint8_t* input,
+    const size_t input_stride,
+    const PackBMatrixSparse& packed_weights,
+    const int32_t* bias,
+    uint8_t* output,
+    const size_t output_stride,
+    pthreadpool_t threadpool);
+
 enum pytorch_qnnp_status qnnpackConv(
     const conv_param_t& conv_p,
     void* packed_weights,
@@ -1,6 +1,7 @@
 #include <pytorch_qnnpack.h>
 #include <qnnpack/pack.h>
 #include <qnnpack_func.h>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 
@@ -54,4 +55,45 @@ PackBMatrix::PackBMatrix(
       packed_weights_);
 }
 
+PackBMatrixSparse::PackBMatrixSparse(
+    const size_t input_channels,
+    const size_t output_channels,
+    const uint8_t* kernel_zero_points,
+    const uint8_t* kernel) {
+  const uint32_t nr = pytorch_qnnp_params.q8gemm_sparse_1x4.nr;
+  const size_t n_stride = (output_channels + (nr - 1)) & -nr;
+  const size_t k_blocks = (input_channels + 3) / 4;
+
+  input_channels_ = input_channels;
+  output_channels_ = output_channels;
+  // Output channels past output_channels are left without blocks.
+  row_ptr_.assign(n_stride + 1, 0);
+  for (size_t n = 0; n < output_channels; n++) {
+    const uint8_t* kernel_row = kernel + n * input_channels;
+    const uint8_t kernel_zero_point = kernel_zero_points[n];
+    for (size_t kb = 0; kb < k_blocks; kb++) {
+      const size_t k_start = kb * 4;
+      const size_t k_end = std::min(k_start + 4, input_channels);
+      bool is_zero_block = true;
+      for (size_t k = k_start; k < k_end; k++) {
+        if (kernel_row[k] != kernel_zero_point) {
+          is_zero_block = false;
+          break;
+        }
+      }
+      if (is_zero_block) {
+        continue;
+      }
+      block_ids_.push_back(kb);
+      for (size_t k = k_start; k < k_start + 4; k++) {
+        values_.push_back(k < k_end ? kernel_row[k] : kernel_zero_point);
+      }
+    }
+    row_ptr_[n + 1] = block_ids_.size();
+  }
+  for (size_t n = output_channels; n < n_stride; n++) {
+    row_ptr_[n + 1] = block_ids_.size();
+  }
+}
+
 } // namespace qnnpack
@@ -113,4 +113,98 @@ enum pytorch_qnnp_status qnnpackLinear(
 
   return pytorch_qnnp_status_success;
 }
+
+struct q8gemm_sparse_context {
+  size_t k;
+  const uint8_t* a;
+  size_t a_stride;
+  const uint32_t* row_ptr;
+  const uint32_t* block_ids;
+  const uint8_t* values;
+  const int32_t* bias;
+  uint8_t* c;
+  size_t c_stride;
+  union pytorch_qnnp_conv_quantization_params quantization_params;
+  const pytorch_q8gemm_sparse_ukernel_function ukernel;
+};
+
+static void compute_q8gemm_sparse(
+    const struct q8gemm_sparse_context context[1],
+    size_t mr_block_start,
+    size_t nr_block_start,
+    size_t mr_block_size,
+    size_t nr_block_size)
+{
+  const uint8_t* a = context->a;
+  const size_t a_stride = context->a_stride;
+  uint8_t* c = context->c;
+  const size_t c_stride = context->c_stride;
+
+  context->ukernel(
+      mr_block_size,
+      nr_block_size,
+      context->k,
+      a + mr_block_start * a_stride,
+      a_stride,
+      context->row_ptr + nr_block_start,
+      context->block_ids,
+      context->values,
+      context->bias + nr_block_start,
+      c + mr_block_start * c_stride + nr_block_start,
+      c_stride,
+      nr_block_start,
+      &context->quantization_params);
+}
+
+enum pytorch_qnnp_status qnnpackLinearSparse(
+    const size_t batch_size,
+    const size_t input_channels,
+    const size_t output_channels,
+    const uint8_t input_zero_point,
+    const uint8_t* kernel_zero_points,
+    const float* requantization_scales,
+    const uint8_t output_zero_point,
+    const uint8_t output_min,
+    const uint8_t output_max,
+    const uint8_t* input,
+    const size_t input_stride,
+    const PackBMatrixSparse& packed_weights,
+    const int32_t* bias,
+    uint8_t* output,
+    const size_t output_stride,
+    pthreadpool_t threadpool)
+{
+  const uint32_t mr = pytorch_qnnp_params.q8gemm_sparse_1x4.mr;
+  const uint32_t nr = pytorch_qnnp_params.q8gemm_sparse_1x4.nr;
+
+  union pytorch_qnnp_conv_quantization_params conv_quantization_params =
+      pytorch_qnnp_compute_conv_quantization_params(
+          input_zero_point, kernel_zero_points,
+          requantization_scales, output_zero_point, output_min, output_max);
+
+  struct q8gemm_sparse_context q8gemm_sparse_context = {
+      .k = input_channels,
+      .a = input,
+      .a_stride = input_stride,
+      .row_ptr = packed_weights.getRowPtr(),
+      .block_ids = packed_weights.getBlockIds(),
+      .values = packed_weights.getValues(),
+      .bias = bias,
+      .c = output,
+      .c_stride = output_stride,
+      .quantization_params = conv_quantization_params,
+      .ukernel = pytorch_qnnp_params.q8gemm_sparse_1x4.gemm,
+  };
+
+  pthreadpool_compute_2d_tiled(
+      threadpool,
+      (pthreadpool_function_2d_tiled_t) compute_q8gemm_sparse,
+      &q8gemm_sparse_context,
+      batch_size,
+      output_channels,
+      mr,
+      nr);
+
+  return pytorch_qnnp_status_success;
+}
 } // namespace qnnpack
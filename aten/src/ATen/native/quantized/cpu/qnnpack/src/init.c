@@ -25,6 +25,7 @@
 #include <qnnpack/q8dwconv.h>
 #include <qnnpack/q8gavgpool.h>
 #include <qnnpack/q8gemm.h>
+#include <qnnpack/q8gemm_sparse.h>
 #include <qnnpack/q8vadd.h>
 #include <qnnpack/u8clamp.h>
 #include <qnnpack/u8lut32norm.h>
@@ -89,6 +90,12 @@ static void init(void) {
       .kthreshold = SIZE_MAX,
   };
 #endif
+  pytorch_qnnp_params.q8gemm_sparse_1x4 =
+      (struct pytorch_q8gemm_sparse_parameters){
+          .gemm = pytorch_q8gemm_sparse_1x4_ukernel_4x8__neon,
+          .mr = 4,
+          .nr = 8,
+      };
   pytorch_qnnp_params.q8dw9 = (struct pytorch_q8dwconv_up_parameters){
       .updw = pytorch_q8dwconv_ukernel_up8x9__aarch32_neon,
       .updw_per_channel = pytorch_q8dwconv_ukernel_up8x9_per_channel__aarch32_neon,
@@ -148,6 +155,12 @@ static void init(void) {
   pytorch_qnnp_params.q8conv_xzp = (struct pytorch_q8conv_xzp_parameters){
       .kthreshold = SIZE_MAX,
   };
+  pytorch_qnnp_params.q8gemm_sparse_1x4 =
+      (struct pytorch_q8gemm_sparse_parameters){
+          .gemm = pytorch_q8gemm_sparse_1x4_ukernel_4x8__neon,
+          .mr = 4,
+          .nr = 8,
+      };
   pytorch_qnnp_params.q8dw9 = (struct pytorch_q8dwconv_up_parameters){
       .updw = pytorch_q8dwconv_ukernel_up8x9__neon,
       .updw_per_channel = pytorch_q8dwconv_ukernel_up8x9_per_channel__neon,
@@ -208,6 +221,12 @@ static void init(void) {
   pytorch_qnnp_params.q8conv_xzp = (struct pytorch_q8conv_xzp_parameters){
       .kthreshold = SIZE_MAX,
   };
+  pytorch_qnnp_params.q8gemm_sparse_1x4 =
+      (struct pytorch_q8gemm_sparse_parameters){
+          .gemm = pytorch_q8gemm_sparse_1x4_ukernel_4x4__sse2,
+          .mr = 4,
+          .nr = 4,
+      };
   pytorch_qnnp_params.q8dw9 = (struct pytorch_q8dwconv_up_parameters){
       .updw = pytorch_q8dwconv_ukernel_up8x9__sse2,
       .updw_per_channel = pytorch_q8dwconv_ukernel_up8x9_per_channel__sse2,
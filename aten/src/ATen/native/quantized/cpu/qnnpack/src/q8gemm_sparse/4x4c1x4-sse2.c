@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string.h>
+
+#include <immintrin.h>
+
+#include <qnnpack/q8gemm_sparse.h>
+#include <requantization/runtime-sse2.h>
+
+/*
+ * Loads the 4 elements of a row of A covered by a 1x4 block starting at input
+ * channel col. Only the last block of an output channel can extend past k.
+ */
+static inline __m128i load_a_1x4(
+    const uint8_t* a,
+    size_t col,
+    size_t k) {
+  uint32_t va = 0;
+  if (col + 4 <= k) {
+    memcpy(&va, a + col, 4);
+  } else {
+    memcpy(&va, a + col, k - col);
+  }
+  return _mm_cvtsi32_si128((int)va);
+}
+
+/*
+ * Computes the dot products of rows 0-3 of A with one output channel.
+ * On return vacc01 holds two partial sums for each of rows 0 and 1, and
+ * vacc23 two partial sums for each of rows 2 and 3.
+ */
+static inline void compute_channel_4x1c1x4(
+    size_t k,
+    const uint8_t* a0,
+    const uint8_t* a1,
+    const uint8_t* a2,
+    const uint8_t* a3,
+    uint32_t block_start,
+    uint32_t block_end,
+    const uint32_t* block_ids,
+    const uint8_t* values,
+    int32_t bias,
+    __m128i va_zero_point,
+    __m128i vb_zero_point,
+    __m128i* vacc01,
+    __m128i* vacc23) {
+  const __m128i vzero = _mm_setzero_si128();
+  __m128i vacc01x01 = _mm_setr_epi32(bias, 0, bias, 0);
+  __m128i vacc23x01 = vacc01x01;
+  for (uint32_t b = block_start; b < block_end; b++) {
+    const size_t col = (size_t)block_ids[b] * 4;
+
+    uint32_t vw;
+    memcpy(&vw, values + (size_t)b * 4, 4);
+    const __m128i vxb =
+        _mm_sub_epi16(
+            _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)vw), vzero),
+            vb_zero_point);
+    const __m128i vxb01 = _mm_unpacklo_epi64(vxb, vxb);
+
+    const __m128i va01 =
+        _mm_unpacklo_epi32(load_a_1x4(a0, col, k), load_a_1x4(a1, col, k));
+    const __m128i vxa01 =
+        sub_zero_point(_mm_unpacklo_epi8(va01, vzero), va_zero_point);
+    vacc01x01 = _mm_add_epi32(vacc01x01, _mm_madd_epi16(vxa01, vxb01));
+
+    const __m128i va23 =
+        _mm_unpacklo_epi32(load_a_1x4(a2, col, k), load_a_1x4(a3, col, k));
+    const __m128i vxa23 =
+        sub_zero_point(_mm_unpacklo_epi8(va23, vzero), va_zero_point);
+    vacc23x01 = _mm_add_epi32(vacc23x01, _mm_madd_epi16(vxa23, vxb01));
+  }
+  *vacc01 = vacc01x01;
+  *vacc23 = vacc23x01;
+}
+
+/*
+ * Given [x0, y0, x1, y1] and [x2, y2, x3, y3], returns
+ * [x0 + y0, x1 + y1, x2 + y2, x3 + y3].
+ */
+static inline __m128i pairwise_add_epi32(__m128i va, __m128i vb) {
+  const __m128 vfa = _mm_castsi128_ps(va);
+  const __m128 vfb = _mm_castsi128_ps(vb);
+  return _mm_add_epi32(
+      _mm_castps_si128(_mm_shuffle_ps(vfa, vfb, _MM_SHUFFLE(2, 0, 2, 0))),
+      _mm_castps_si128(_mm_shuffle_ps(vfa, vfb, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+void pytorch_q8gemm_sparse_1x4_ukernel_4x4__sse2(
+    size_t mr,
+    size_t nr,
+    size_t k,
+    const uint8_t* restrict a,
+    size_t a_stride,
+    const uint32_t* restrict row_ptr,
+    const uint32_t* restrict block_ids,
+    const uint8_t* restrict values,
+    const int32_t* restrict bias,
+    uint8_t* restrict c,
+    size_t c_stride,
+    size_t output_channel_index,
+    const union pytorch_qnnp_conv_quantization_params
+        quantization_params[RESTRICT_STATIC 1]) {
+  const uint8_t* a0 = a;
+  const uint8_t* a1 = (const uint8_t*)((uintptr_t)a0 + a_stride);
+  if (mr < 2) {
+    a1 = a0;
+  }
+  const uint8_t* a2 = (const uint8_t*)((uintptr_t)a1 + a_stride);
+  if (mr <= 2) {
+    a2 = a1;
+  }
+  const uint8_t* a3 = (const uint8_t*)((uintptr_t)a2 + a_stride);
+  if (mr != 4) {
+    a3 = a2;
+  }
+
+  const __m128i va_zero_point = _mm_load_si128(
+      (const __m128i*)quantization_params->sse2.input_zero_point);
+
+  /* Output channels past nr have no blocks and produce zeros. */
+  __m128i vacc01x0 = _mm_setzero_si128();
+  __m128i vacc23x0 = _mm_setzero_si128();
+  __m128i vacc01x1 = _mm_setzero_si128();
+  __m128i vacc23x1 = _mm_setzero_si128();
+  __m128i vacc01x2 = _mm_setzero_si128();
+  __m128i vacc23x2 = _mm_setzero_si128();
+  __m128i vacc01x3 = _mm_setzero_si128();
+  __m128i vacc23x3 = _mm_setzero_si128();
+
+  compute_channel_4x1c1x4(
+      k, a0, a1, a2, a3, row_ptr[0], row_ptr[1], block_ids, values, bias[0],
+      va_zero_point,
+      _mm_set1_epi16((int16_t)(uint16_t)quantization_params->sse2
+                         .kernel_zero_points[output_channel_index]),
+      &vacc01x0, &vacc23x0);
+  if (nr >= 2) {
+    compute_channel_4x1c1x4(
+        k, a0, a1, a2, a3, row_ptr[1], row_ptr[2], block_ids, values, bias[1],
+        va_zero_point,
+        _mm_set1_epi16((int16_t)(uint16_t)quantization_params->sse2
+                           .kernel_zero_points[output_channel_index + 1]),
+        &vacc01x1, &vacc23x1);
+  }
+  if (nr >= 3) {
+    compute_channel_4x1c1x4(
+        k, a0, a1, a2, a3, row_ptr[2], row_ptr[3], block_ids, values, bias[2],
+        va_zero_point,
+        _mm_set1_epi16((int16_t)(uint16_t)quantization_params->sse2
+                           .kernel_zero_points[output_channel_index + 2]),
+        &vacc01x2, &vacc23x2);
+  }
+  if (nr == 4) {
+    compute_channel_4x1c1x4(
+        k, a0, a1, a2, a3, row_ptr[3], row_ptr[4], block_ids, values, bias[3],
+        va_zero_point,
+        _mm_set1_epi16((int16_t)(uint16_t)quantization_params->sse2
+                           .kernel_zero_points[output_channel_index + 3]),
+        &vacc01x3, &vacc23x3);
+  }
+
+  /* Reduce the partial sums into one accumulator per row. */
+  __m128i vacc0x0123 = pairwise_add_epi32(
+      _mm_unpacklo_epi64(vacc01x0, vacc01x1),
+      _mm_unpacklo_epi64(vacc01x2, vacc01x3));
+  __m128i vacc1x0123 = pairwise_add_epi32(
+      _mm_unpackhi_epi64(vacc01x0, vacc01x1),
+      _mm_unpackhi_epi64(vacc01x2, vacc01x3));
+  __m128i vacc2x0123 = pairwise_add_epi32(
+      _mm_unpacklo_epi64(vacc23x0, vacc23x1),
+      _mm_unpacklo_epi64(vacc23x2, vacc23x3));
+  __m128i vacc3x0123 = pairwise_add_epi32(
+      _mm_unpackhi_epi64(vacc23x0, vacc23x1),
+      _mm_unpackhi_epi64(vacc23x2, vacc23x3));
+
+  const __m128 vmultiplier =
+      _mm_loadu_ps(&quantization_params->sse2.requantization_scales[output_channel_index]);
+
+  vacc0x0123 = _mm_cvtps_epi32(
+                _mm_mul_ps(
+                  _mm_cvtepi32_ps(vacc0x0123),
+                  vmultiplier
+                  )
+                );
+  vacc1x0123 = _mm_cvtps_epi32(
+                _mm_mul_ps(
+                  _mm_cvtepi32_ps(vacc1x0123),
+                  vmultiplier
+                  )
+                );
+  vacc2x0123 = _mm_cvtps_epi32(
+                _mm_mul_ps(
+                  _mm_cvtepi32_ps(vacc2x0123),
+                  vmultiplier
+                  )
+                );
+  vacc3x0123 = _mm_cvtps_epi32(
+                _mm_mul_ps(
+                  _mm_cvtepi32_ps(vacc3x0123),
+                  vmultiplier
+                  )
+                );
+
+  const __m128i voutput_zero_point = _mm_load_si128(
+      (const __m128i*)quantization_params->sse2.output_zero_point);
+  const __m128i vacc01x0123 = _mm_adds_epi16(
+      _mm_packs_epi32(vacc0x0123, vacc1x0123), voutput_zero_point);
+  const __m128i vacc23x0123 = _mm_adds_epi16(
+      _mm_packs_epi32(vacc2x0123, vacc3x0123), voutput_zero_point);
+  __m128i vout = _mm_packus_epi16(vacc01x0123, vacc23x0123);
+  vout = _mm_min_epu8(
+      vout,
+      _mm_load_si128((const __m128i*)quantization_params->sse2.output_max));
+  vout = _mm_max_epu8(
+      vout,
+      _mm_load_si128((const __m128i*)quantization_params->sse2.output_min));
+
+  uint8_t* c0 = c;
+  uint8_t* c1 = (uint8_t*)((uintptr_t)c0 + c_stride);
+  if (mr < 2) {
+    c1 = c0;
+  }
+  uint8_t* c2 = (uint8_t*)((uintptr_t)c1 + c_stride);
+  if (mr <= 2) {
+    c2 = c1;
+  }
+  uint8_t* c3 = (uint8_t*)((uintptr_t)c2 + c_stride);
+  if (mr != 4) {
+    c3 = c2;
+  }
+  if (nr == 4) {
+    *((uint32_t*)c0) = (uint32_t)_mm_cvtsi128_si32(vout);
+    *((uint32_t*)c1) = (uint32_t)_mm_cvtsi128_si32(_mm_srli_epi64(vout, 32));
+    *((uint32_t*)c2) =
+        (uint32_t)_mm_cvtsi128_si32(_mm_unpackhi_epi32(vout, vout));
+    *((uint32_t*)c3) = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(vout, 12));
+  } else {
+    if (nr >= 2) {
+      *((uint16_t*)c0) = (uint16_t)_mm_extract_epi16(vout, 0);
+      c0 += 2;
+      *((uint16_t*)c1) = (uint16_t)_mm_extract_epi16(vout, 2);
+      c1 += 2;
+      *((uint16_t*)c2) = (uint16_t)_mm_extract_epi16(vout, 4);
+      c2 += 2;
+      *((uint16_t*)c3) = (uint16_t)_mm_extract_epi16(vout, 6);
+      c3 += 2;
+      vout = _mm_srli_epi32(vout, 16);
+      nr -= 2;
+    }
+    if (nr != 0) {
+      *((uint8_t*)c0) = (uint8_t)_mm_cvtsi128_si32(vout);
+      *((uint8_t*)c1) = (uint8_t)_mm_extract_epi16(vout, 2);
+      *((uint8_t*)c2) = (uint8_t)_mm_extract_epi16(vout, 4);
+      *((uint8_t*)c3) = (uint8_t)_mm_extract_epi16(vout, 6);
+    }
+  }
+}
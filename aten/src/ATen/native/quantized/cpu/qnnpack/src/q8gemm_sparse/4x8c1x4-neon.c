@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string.h>
+
+#include <arm_neon.h>
+
+#include <qnnpack/q8gemm_sparse.h>
+#include <requantization/runtime-neon.h>
+
+/*
+ * Loads the 4 elements of a row of A covered by a 1x4 block starting at input
+ * channel col. Only the last block of an output channel can extend past k.
+ */
+static inline uint32_t load_a_1x4(
+    const uint8_t* a,
+    size_t col,
+    size_t k) {
+  uint32_t va = 0;
+  if (col + 4 <= k) {
+    memcpy(&va, a + col, 4);
+  } else {
+    memcpy(&va, a + col, k - col);
+  }
+  return va;
+}
+
+/*
+ * Computes the dot products of rows 0-3 of A with one output channel, and
+ * returns them as [row 0, row 1, row 2, row 3], bias included.
+ */
+static inline int32x4_t compute_channel_4x1c1x4(
+    size_t k,
+    const uint8_t* a0,
+    const uint8_t* a1,
+    const uint8_t* a2,
+    const uint8_t* a3,
+    uint32_t block_start,
+    uint32_t block_end,
+    const uint32_t* block_ids,
+    const uint8_t* values,
+    int32_t bias,
+    uint8x8_t va_zero_point,
+    uint8x8_t vb_zero_point) {
+  int32x4_t vacc0 = vmovq_n_s32(0);
+  int32x4_t vacc1 = vmovq_n_s32(0);
+  int32x4_t vacc2 = vmovq_n_s32(0);
+  int32x4_t vacc3 = vmovq_n_s32(0);
+  for (uint32_t b = block_start; b < block_end; b++) {
+    const size_t col = (size_t)block_ids[b] * 4;
+
+    uint32_t vw;
+    memcpy(&vw, values + (size_t)b * 4, 4);
+    const int16x4_t vxb = vget_low_s16(vreinterpretq_s16_u16(
+        vsubl_u8(vreinterpret_u8_u32(vdup_n_u32(vw)), vb_zero_point)));
+
+    const uint8x8_t va01 = vreinterpret_u8_u32(vset_lane_u32(
+        load_a_1x4(a1, col, k), vdup_n_u32(load_a_1x4(a0, col, k)), 1));
+    const int16x8_t vxa01 =
+        vreinterpretq_s16_u16(sub_zero_point(va01, va_zero_point));
+    const uint8x8_t va23 = vreinterpret_u8_u32(vset_lane_u32(
+        load_a_1x4(a3, col, k), vdup_n_u32(load_a_1x4(a2, col, k)), 1));
+    const int16x8_t vxa23 =
+        vreinterpretq_s16_u16(sub_zero_point(va23, va_zero_point));
+
+    vacc0 = vmlal_s16(vacc0, vget_low_s16(vxa01), vxb);
+    vacc1 = vmlal_s16(vacc1, vget_high_s16(vxa01), vxb);
+    vacc2 = vmlal_s16(vacc2, vget_low_s16(vxa23), vxb);
+    vacc3 = vmlal_s16(vacc3, vget_high_s16(vxa23), vxb);
+  }
+  const int32x2_t vsum01 = vpadd_s32(
+      vadd_s32(vget_low_s32(vacc0), vget_high_s32(vacc0)),
+      vadd_s32(vget_low_s32(vacc1), vget_high_s32(vacc1)));
+  const int32x2_t vsum23 = vpadd_s32(
+      vadd_s32(vget_low_s32(vacc2), vget_high_s32(vacc2)),
+      vadd_s32(vget_low_s32(vacc3), vget_high_s32(vacc3)));
+  return vaddq_s32(vcombine_s32(vsum01, vsum23), vdupq_n_s32(bias));
+}
+
+void pytorch_q8gemm_sparse_1x4_ukernel_4x8__neon(
+    size_t mr,
+    size_t nr,
+    size_t k,
+    const uint8_t* restrict a,
+    size_t a_stride,
+    const uint32_t* restrict row_ptr,
+    const uint32_t* restrict block_ids,
+    const uint8_t* restrict values,
+    const int32_t* restrict bias,
+    uint8_t* restrict c,
+    size_t c_stride,
+    size_t output_channel_index,
+    const union pytorch_qnnp_conv_quantization_params
+        quantization_params[restrict static 1]) {
+  const uint8_t* a0 = a;
+  const uint8_t* a1 = (const uint8_t*)((uintptr_t)a0 + a_stride);
+  if (mr < 2) {
+    a1 = a0;
+  }
+  const uint8_t* a2 = (const uint8_t*)((uintptr_t)a1 + a_stride);
+  if (mr <= 2) {
+    a2 = a1;
+  }
+  const uint8_t* a3 = (const uint8_t*)((uintptr_t)a2 + a_stride);
+  if (mr != 4) {
+    a3 = a2;
+  }
+
+  const uint8x8_t va_zero_point =
+      vld1_dup_u8((const uint8_t*)&quantization_params->neon.input_zero_point);
+  const uint8_t* kernel_zero_points =
+      &quantization_params->neon.kernel_zero_points[output_channel_index];
+
+  /*
+   * Each output channel is computed into a column of 4 rows. Output channels
+   * past nr have no blocks and produce zeros.
+   */
+  int32x4_t vacc_c[8];
+  for (size_t n = 0; n < 8; n++) {
+    vacc_c[n] = n < nr
+        ? compute_channel_4x1c1x4(
+              k, a0, a1, a2, a3, row_ptr[n], row_ptr[n + 1], block_ids, values,
+              bias[n], va_zero_point, vdup_n_u8(kernel_zero_points[n]))
+        : vmovq_n_s32(0);
+  }
+
+  /* Transpose the columns into rows of 4 output channels each. */
+  const int32x4x2_t vacc_c01 = vtrnq_s32(vacc_c[0], vacc_c[1]);
+  const int32x4x2_t vacc_c23 = vtrnq_s32(vacc_c[2], vacc_c[3]);
+  const int32x4x2_t vacc_c45 = vtrnq_s32(vacc_c[4], vacc_c[5]);
+  const int32x4x2_t vacc_c67 = vtrnq_s32(vacc_c[6], vacc_c[7]);
+  int32x4_t vacc0x0123 = vcombine_s32(
+      vget_low_s32(vacc_c01.val[0]), vget_low_s32(vacc_c23.val[0]));
+  int32x4_t vacc1x0123 = vcombine_s32(
+      vget_low_s32(vacc_c01.val[1]), vget_low_s32(vacc_c23.val[1]));
+  int32x4_t vacc2x0123 = vcombine_s32(
+      vget_high_s32(vacc_c01.val[0]), vget_high_s32(vacc_c23.val[0]));
+  int32x4_t vacc3x0123 = vcombine_s32(
+      vget_high_s32(vacc_c01.val[1]), vget_high_s32(vacc_c23.val[1]));
+  int32x4_t vacc0x4567 = vcombine_s32(
+      vget_low_s32(vacc_c45.val[0]), vget_low_s32(vacc_c67.val[0]));
+  int32x4_t vacc1x4567 = vcombine_s32(
+      vget_low_s32(vacc_c45.val[1]), vget_low_s32(vacc_c67.val[1]));
+  int32x4_t vacc2x4567 = vcombine_s32(
+      vget_high_s32(vacc_c45.val[0]), vget_high_s32(vacc_c67.val[0]));
+  int32x4_t vacc3x4567 = vcombine_s32(
+      vget_high_s32(vacc_c45.val[1]), vget_high_s32(vacc_c67.val[1]));
+
+  // Doing 2 VLD1 instead of 1 VLD2 because A75 has higher latency
+  // 8 vs. 5 for VLD2 with both VLD1 and VLD2 having throughput of
+  // 2 per cycle. So probably this is better.
+  const float32x4_t requantization_scale_c0123 =
+      vld1q_f32(
+          &quantization_params->neon.requantization_scales[output_channel_index]
+          );
+  const float32x4_t requantization_scale_c4567 =
+      vld1q_f32(
+          &quantization_params->neon.requantization_scales[
+              output_channel_index + 4]);
+
+  /*
+   * Convert int32_t input to FP32 and multiply by FP32 scale.
+   * Both operations involve statistically unbiased roundings:
+   * - Large int32_t values can't be exactly represented as FP32. The
+   * conversion instruction in ARM NEON would round it to nearest FP32 value
+   * with ties to even.
+   * - Product of two FP32 values is generally not exactly representation as
+   * an FP32 value, and will be rounded to nearest FP32 value with ties to
+   * even.
+   */
+  const float32x4_t vacc0x0123_f =
+    vmulq_f32(vcvtq_f32_s32(vacc0x0123), requantization_scale_c0123);
+  const float32x4_t vacc1x0123_f =
+    vmulq_f32(vcvtq_f32_s32(vacc1x0123), requantization_scale_c0123);
+  const float32x4_t vacc2x0123_f =
+    vmulq_f32(vcvtq_f32_s32(vacc2x0123), requantization_scale_c0123);
+  const float32x4_t vacc3x0123_f =
+    vmulq_f32(vcvtq_f32_s32(vacc3x0123), requantization_scale_c0123);
+  const float32x4_t vacc0x4567_f =
+    vmulq_f32(vcvtq_f32_s32(vacc0x4567), requantization_scale_c4567);
+  const float32x4_t vacc1x4567_f =
+    vmulq_f32(vcvtq_f32_s32(vacc1x4567), requantization_scale_c4567);
+  const float32x4_t vacc2x4567_f =
+    vmulq_f32(vcvtq_f32_s32(vacc2x4567), requantization_scale_c4567);
+  const float32x4_t vacc3x4567_f =
+    vmulq_f32(vcvtq_f32_s32(vacc3x4567), requantization_scale_c4567);
+
+#ifdef __aarch64__
+  const int16x8_t voutput_zero_point =
+      vld1q_dup_s16(&quantization_params->neon.output_zero_point);
+  /*
+   * Leverage "Floating-point Convert to Signed integer, rounding to nearest
+   * with ties to even" instruction. This is an ARMv8 instruction (always
+   * available in AArch64), which saturates result on overflow. We don't need
+   * to specifically consider saturated results, they will be clamped at the
+   * last stage.
+   */
+  vacc0x0123 = vcvtnq_s32_f32(vacc0x0123_f);
+  vacc1x0123 = vcvtnq_s32_f32(vacc1x0123_f);
+  vacc2x0123 = vcvtnq_s32_f32(vacc2x0123_f);
+  vacc3x0123 = vcvtnq_s32_f32(vacc3x0123_f);
+  vacc0x4567 = vcvtnq_s32_f32(vacc0x4567_f);
+  vacc1x4567 = vcvtnq_s32_f32(vacc1x4567_f);
+  vacc2x4567 = vcvtnq_s32_f32(vacc2x4567_f);
+  vacc3x4567 = vcvtnq_s32_f32(vacc3x4567_f);
+
+  const int16x8_t vacc0x01234567 = vqaddq_s16(
+      vqmovn_high_s32(vqmovn_s32(vacc0x0123), vacc0x4567), voutput_zero_point);
+  const int16x8_t vacc1x01234567 = vqaddq_s16(
+      vqmovn_high_s32(vqmovn_s32(vacc1x0123), vacc1x4567), voutput_zero_point);
+  const int16x8_t vacc2x01234567 = vqaddq_s16(
+      vqmovn_high_s32(vqmovn_s32(vacc2x0123), vacc2x4567), voutput_zero_point);
+  const int16x8_t vacc3x01234567 = vqaddq_s16(
+      vqmovn_high_s32(vqmovn_s32(vacc3x0123), vacc3x4567), voutput_zero_point);
+
+  uint8x16_t vout0x01234567_1x01234567 =
+      vqmovun_high_s16(vqmovun_s16(vacc0x01234567), vacc1x01234567);
+  uint8x16_t vout2x01234567_3x01234567 =
+      vqmovun_high_s16(vqmovun_s16(vacc2x01234567), vacc3x01234567);
+
+  const uint8x16_t voutput_min =
+      vld1q_dup_u8(&quantization_params->neon.output_min);
+  const uint8x16_t voutput_max =
+      vld1q_dup_u8(&quantization_params->neon.output_max);
+
+  vout0x01234567_1x01234567 = vmaxq_u8(vout0x01234567_1x01234567, voutput_min);
+  vout2x01234567_3x01234567 = vmaxq_u8(vout2x01234567_3x01234567, voutput_min);
+  vout0x01234567_1x01234567 = vminq_u8(vout0x01234567_1x01234567, voutput_max);
+  vout2x01234567_3x01234567 = vminq_u8(vout2x01234567_3x01234567, voutput_max);
+#else
+  const float32x4_t vfmin = vdupq_n_f32(quantization_params->neon.vfmin);
+  const float32x4_t vfmax = vdupq_n_f32(quantization_params->neon.vfmax);
+  const float32x4_t vfmagic = vdupq_n_f32(quantization_params->neon.vfmagic);
+  const int32x4_t vimagic = vdupq_n_s32(quantization_params->neon.vimagic);
+  /*
+   * ARMv7 NEON offers only a floating-point to integer conversion instruction
+   * with rounding towards zero. In lieu of conversion instruction with
+   * rounding-to-nearest-even, we use a magic trick of adding a large number
+   * (1.5 * 2**23) to scaled value to cause rounding to integer, and then
+   * substracing this magic number as integer. This trick works only in a
+   * limited range (absolute value of input must be less than 2**22), so
+   * generally we have to clamp input to this range before using the magic.
+   * However, clamping to any smaller range works just as well, and thus we
+   * clamp to [qmin - zero point, qmax - zero point] range so that after we
+   * add zero point to the result, it gets into target [qmin, qmax] range.
+   */
+  const float32x4_t vacc0x0123_f_clamped =
+      vminq_f32(vmaxq_f32(vacc0x0123_f, vfmin), vfmax);
+  const float32x4_t vacc1x0123_f_clamped =
+      vminq_f32(vmaxq_f32(vacc1x0123_f, vfmin), vfmax);
+  const float32x4_t vacc2x0123_f_clamped =
+      vminq_f32(vmaxq_f32(vacc2x0123_f, vfmin), vfmax);
+  const float32x4_t vacc3x0123_f_clamped =
+      vminq_f32(vmaxq_f32(vacc3x0123_f, vfmin), vfmax);
+  const float32x4_t vacc0x4567_f_clamped =
+      vminq_f32(vmaxq_f32(vacc0x4567_f, vfmin), vfmax);
+  const float32x4_t vacc1x4567_f_clamped =
+      vminq_f32(vmaxq_f32(vacc1x4567_f, vfmin), vfmax);
+  const float32x4_t vacc2x4567_f_clamped =
+      vminq_f32(vmaxq_f32(vacc2x4567_f, vfmin), vfmax);
+  const float32x4_t vacc3x4567_f_clamped =
+      vminq_f32(vmaxq_f32(vacc3x4567_f, vfmin), vfmax);
+
+  /*
+   * Conversion to integer using the "magic trick". Rounding is performed in
+   * the output of addition operation, and result is rounded to nearest even
+   * integer with ties to even.
+   */
+  vacc0x0123 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc0x0123_f_clamped, vfmagic)), vimagic);
+  vacc1x0123 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc1x0123_f_clamped, vfmagic)), vimagic);
+  vacc2x0123 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc2x0123_f_clamped, vfmagic)), vimagic);
+  vacc3x0123 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc3x0123_f_clamped, vfmagic)), vimagic);
+  vacc0x4567 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc0x4567_f_clamped, vfmagic)), vimagic);
+  vacc1x4567 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc1x4567_f_clamped, vfmagic)), vimagic);
+  vacc2x4567 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc2x4567_f_clamped, vfmagic)), vimagic);
+  vacc3x4567 = vsubq_s32(
+      vreinterpretq_s32_f32(vaddq_f32(vacc3x4567_f_clamped, vfmagic)), vimagic);
+
+  const int16x8_t vacc0x01234567 =
+      vcombine_s16(vqmovn_s32(vacc0x0123), vqmovn_s32(vacc0x4567));
+  const int16x8_t vacc1x01234567 =
+      vcombine_s16(vqmovn_s32(vacc1x0123), vqmovn_s32(vacc1x4567));
+  const int16x8_t vacc2x01234567 =
+      vcombine_s16(vqmovn_s32(vacc2x0123), vqmovn_s32(vacc2x4567));
+  const int16x8_t vacc3x01234567 =
+      vcombine_s16(vqmovn_s32(vacc3x0123), vqmovn_s32(vacc3x4567));
+
+  uint8x16_t vout0x01234567_1x01234567 =
+      vcombine_u8(vqmovun_s16(vacc0x01234567), vqmovun_s16(vacc1x01234567));
+  uint8x16_t vout2x01234567_3x01234567 =
+      vcombine_u8(vqmovun_s16(vacc2x01234567), vqmovun_s16(vacc3x01234567));
+#endif
+
+  uint8_t* c0 = c;
+  uint8_t* c1 = (uint8_t*)((uintptr_t)c0 + c_stride);
+  if (mr < 2) {
+    c1 = c0;
+  }
+  uint8_t* c2 = (uint8_t*)((uintptr_t)c1 + c_stride);
+  if (mr <= 2) {
+    c2 = c1;
+  }
+  uint8_t* c3 = (uint8_t*)((uintptr_t)c2 + c_stride);
+  if (mr != 4) {
+    c3 = c2;
+  }
+  if (nr == 8) {
+    vst1_u8(c0, vget_low_u8(vout0x01234567_1x01234567));
+    vst1_u8(c1, vget_high_u8(vout0x01234567_1x01234567));
+    vst1_u8(c2, vget_low_u8(vout2x01234567_3x01234567));
+    vst1_u8(c3, vget_high_u8(vout2x01234567_3x01234567));
+  } else {
+    if (nr >= 4) {
+      vst1q_lane_u32(
+          __builtin_assume_aligned(c0, 1),
+          vreinterpretq_u32_u8(vout0x01234567_1x01234567),
+          0);
+      c0 += 4;
+      vst1q_lane_u32(
+          __builtin_assume_aligned(c1, 1),
+          vreinterpretq_u32_u8(vout0x01234567_1x01234567),
+          2);
+      c1 += 4;
+      vst1q_lane_u32(
+          __builtin_assume_aligned(c2, 1),
+          vreinterpretq_u32_u8(vout2x01234567_3x01234567),
+          0);
+      c2 += 4;
+      vst1q_lane_u32(
+          __builtin_assume_aligned(c3, 1),
+          vreinterpretq_u32_u8(vout2x01234567_3x01234567),
+          2);
+      c3 += 4;
+      vout0x01234567_1x01234567 =
+          vextq_u8(vout0x01234567_1x01234567, vout0x01234567_1x01234567, 4);
+      vout2x01234567_3x01234567 =
+          vextq_u8(vout2x01234567_3x01234567, vout2x01234567_3x01234567, 4);
+      nr -= 4;
+    }
+    if (nr >= 2) {
+      vst1q_lane_u16(
+          __builtin_assume_aligned(c0, 1),
+          vreinterpretq_u16_u8(vout0x01234567_1x01234567),
+          0);
+      c0 += 2;
+      vst1q_lane_u16(
+          __builtin_assume_aligned(c1, 1),
+          vreinterpretq_u16_u8(vout0x01234567_1x01234567),
+          4);
+      c1 += 2;
+      vst1q_lane_u16(
+          __builtin_assume_aligned(c2, 1),
+          vreinterpretq_u16_u8(vout2x01234567_3x01234567),
+          0);
+      c2 += 2;
+      vst1q_lane_u16(
+          __builtin_assume_aligned(c3, 1),
+          vreinterpretq_u16_u8(vout2x01234567_3x01234567),
+          4);
+      c3 += 2;
+      vout0x01234567_1x01234567 =
+          vextq_u8(vout0x01234567_1x01234567, vout0x01234567_1x01234567, 2);
+      vout2x01234567_3x01234567 =
+          vextq_u8(vout2x01234567_3x01234567, vout2x01234567_3x01234567, 2);
+      nr -= 2;
+    }
+    if (nr != 0) {
+      vst1q_lane_u8(c0, vout0x01234567_1x01234567, 0);
+      vst1q_lane_u8(c1, vout0x01234567_1x01234567, 8);
+      vst1q_lane_u8(c2, vout2x01234567_3x01234567, 0);
+      vst1q_lane_u8(c3, vout2x01234567_3x01234567, 8);
+    }
+  }
+}
@@ -317,6 +317,26 @@ typedef void (*pytorch_q8gemm_dq_ukernel_function)(
     size_t output_channel_index,
     const struct pytorch_qnnp_conv_dynamic_quantization_params* quantization_params);
 
+/*
+  Q8 GEMM kernel for weights packed as 1x4 blocks in block-CSR format.
+  See qnnpack/q8gemm_sparse.h for the layout of row_ptr, block_ids and values.
+*/
+
+typedef void (*pytorch_q8gemm_sparse_ukernel_function)(
+    size_t mr,
+    size_t nr,
+    size_t k,
+    const uint8_t* a,
+    size_t a_stride,
+    const uint32_t* row_ptr,
+    const uint32_t* block_ids,
+    const uint8_t* values,
+    const int32_t* bias,
+    uint8_t* c,
+    size_t c_stride,
+    size_t output_channel_index,
+    const union pytorch_qnnp_conv_quantization_params* quantization_params);
+
 typedef void (*pytorch_q8conv_ukernel_function)(
     size_t mr,
     size_t nr,
@@ -496,6 +516,12 @@ struct pytorch_q8conv_parameters {
   uint8_t kr;
 };
 
+struct pytorch_q8gemm_sparse_parameters {
+  pytorch_q8gemm_sparse_ukernel_function gemm;
+  uint8_t mr;
+  uint8_t nr;
+};
+
 struct pytorch_q8conv_xzp_parameters {
   pytorch_q8gemm_xzp_ukernel_function gemm;
   /* no conv ukernel */
@@ -558,6 +584,7 @@ struct pytorch_x8zip_parameters {
 struct pytorch_qnnp_parameters {
   struct pytorch_q8conv_parameters q8conv;
   struct pytorch_q8conv_xzp_parameters q8conv_xzp;
+  struct pytorch_q8gemm_sparse_parameters q8gemm_sparse_1x4;
   struct pytorch_q8dwconv_up_parameters q8dw9;
   struct pytorch_q8dwconv_mp_parameters q8dw25;
   struct pytorch_q8sum_rows_parameters q8sum_rows;
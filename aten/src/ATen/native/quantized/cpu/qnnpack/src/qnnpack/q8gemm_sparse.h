@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <qnnpack/common.h>
+#include <qnnpack/params.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  Q8 GEMM kernels for weights stored as 1x4 blocks in block-CSR format.
+
+  Output channel n of the tile owns blocks row_ptr[n] to row_ptr[n + 1] - 1.
+  Block b covers input channels 4 * block_ids[b] to 4 * block_ids[b] + 3, and
+  its 4 weights are values[4 * b] to values[4 * b + 3]. Only blocks with at
+  least one weight different from the kernel zero point are stored, so the
+  cost of the kernel scales with the number of non-zero blocks. Weights of a
+  block past the last input channel must be equal to the kernel zero point.
+
+  row_ptr and bias are offset to the first output channel of the tile, while
+  output_channel_index is used to look up the kernel zero points and the
+  requantization scales in quantization_params.
+*/
+#define DECLARE_PYTORCH_Q8GEMM_SPARSE_UKERNEL_FUNCTION(fn_name) \
+  PYTORCH_QNNP_INTERNAL void fn_name(                           \
+      size_t mr,                                                \
+      size_t nr,                                                \
+      size_t k,                                                 \
+      const uint8_t* a,                                         \
+      size_t a_stride,                                          \
+      const uint32_t* row_ptr,                                  \
+      const uint32_t* block_ids,                                \
+      const uint8_t* values,                                    \
+      const int32_t* bias,                                      \
+      uint8_t* c,                                               \
+      size_t c_stride,                                          \
+      size_t output_channel_index,                              \
+      const union pytorch_qnnp_conv_quantization_params* quantization_params);
+
+DECLARE_PYTORCH_Q8GEMM_SPARSE_UKERNEL_FUNCTION(
+    pytorch_q8gemm_sparse_1x4_ukernel_4x8__neon)
+DECLARE_PYTORCH_Q8GEMM_SPARSE_UKERNEL_FUNCTION(
+    pytorch_q8gemm_sparse_1x4_ukernel_4x4__sse2)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
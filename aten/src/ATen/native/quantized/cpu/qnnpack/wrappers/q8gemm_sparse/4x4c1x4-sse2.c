@@ -0,0 +1,5 @@
+/* Auto-generated by generate-wrappers.py script. Do not modify */
+
+#if defined(__i386__) || defined(__i686__) || defined(__x86_64__)
+#include <q8gemm_sparse/4x4c1x4-sse2.c>
+#endif /* defined(__i386__) || defined(__i686__) || defined(__x86_64__) */
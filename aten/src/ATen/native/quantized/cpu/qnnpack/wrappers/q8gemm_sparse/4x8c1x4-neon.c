@@ -0,0 +1,5 @@
+/* Auto-generated by generate-wrappers.py script. Do not modify */
+
+#if defined(__arm__) || defined(__aarch64__)
+#include <q8gemm_sparse/4x8c1x4-neon.c>
+#endif /* defined(__arm__) || defined(__aarch64__) */
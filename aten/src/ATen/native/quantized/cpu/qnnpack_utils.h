@@ -16,6 +16,11 @@ struct QnnpackOperatorDeleter {
   }
 };
 
+// Weights whose fraction of non-zero 1x4 blocks is below this threshold use
+// the block-sparse QNNPACK kernels, whose cost scales with the number of
+// non-zero blocks, instead of the dense ones.
+constexpr float kQnnpackSparseBlockDensityThreshold = 0.4f;
+
 // PackedWeight struct for QNNPACK stores the original Weight and Bias as
 // QNNPACK currently does not support an unpack function.
 // For PyTorch Mobile, once the model is scripted and serialized we don't need
@@ -48,6 +53,11 @@ struct PackedLinearWeightsQnnp : public LinearPackedParamsBase {
   at::Tensor w_scales;
   std::vector<uint8_t> w_zero_points;
   std::vector<float> requantization_scales;
+  // Set at prepack time when the weight is sparse enough for the block-sparse
+  // kernels, in which case it is used instead of w for static quantization.
+  std::unique_ptr<qnnpack::PackBMatrixSparse> w_sparse;
+  // Bias quantized with the current input scale, for the block-sparse kernels.
+  at::Tensor sparse_qbias;
 
   at::Tensor apply(
       at::Tensor input,
@@ -135,6 +135,22 @@ using qnormalize_fn = void (*)(
     double /* eps */,
     Tensor* /* Y */);
 
+// Depthwise convolution (one input channel per group, channel multiplier 1)
+// reading and writing channels-last. qx is N x C x H x W or N x C x D x H x W,
+// w holds the weights with their zero points removed, laid out as
+// (kD * kH * kW) x C. kernel, stride, padding and dilation are given for
+// (D, H, W); kernel[0] is 1 for 2D.
+using qdepthwise_conv_nhwc_fn = void (*)(
+    const Tensor& /* qx */,
+    const Tensor& /* w */,
+    const float* /* bias, may be null */,
+    const float* /* requant_scales: act_scale * w_scale / output_scale */,
+    IntArrayRef /* kernel */,
+    IntArrayRef /* stride */,
+    IntArrayRef /* padding */,
+    IntArrayRef /* dilation */,
+    Tensor& /* qy */);
+
 // using qavg_pool2d_fn
 DECLARE_DISPATCH(qrelu_fn, qrelu_stub);
 DECLARE_DISPATCH(qrelu_fn, qrelu6_stub);
@@ -163,6 +179,8 @@ DECLARE_DISPATCH(qtopk_fn, qtopk_stub);
 DECLARE_DISPATCH(qbatch_norm_fn, qbatch_norm_stub);
 DECLARE_DISPATCH(qbatch_norm_fn, qbatch_norm_relu_stub);
 DECLARE_DISPATCH(qnormalize_fn, quantized_normalize_stub);
+DECLARE_DISPATCH(qdepthwise_conv_nhwc_fn, qdepthwise_conv_nhwc_stub);
+DECLARE_DISPATCH(qdepthwise_conv_nhwc_fn, qdepthwise_conv_relu_nhwc_stub);
 
 } // namespace native
 } // namespace at
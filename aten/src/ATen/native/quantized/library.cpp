@@ -1,10 +1,12 @@
 #include <torch/library.h>
 
 #include <ATen/native/quantized/cpu/conv_packed_params.h>
+#include <ATen/native/quantized/cpu/embedding_packed_params.h>
 #include <ATen/native/quantized/cpu/packed_params.h>
 #include <torch/custom_class.h>
 
 torch::jit::class_<LinearPackedParamsBase> register_linear_params();
+torch::jit::class_<EmbeddingPackedParamsBase> register_embedding_params();
 
 template <int kSpatialDim = 2>
 torch::jit::class_<ConvPackedParamsBase<kSpatialDim>> register_conv_params();
@@ -16,6 +18,7 @@ TORCH_LIBRARY(quantized, m) {
   register_linear_params();
   register_conv_params<2>();
   register_conv_params<3>();
+  register_embedding_params();
 
   m.def("add(Tensor qa, Tensor qb, float scale, int zero_point) -> Tensor qc");
   m.def("add_relu(Tensor qa, Tensor qb, float scale, int zero_point) -> Tensor qc");
@@ -54,6 +57,12 @@ TORCH_LIBRARY(quantized, m) {
   m.def("conv2d_relu.new(Tensor qx, __torch__.torch.classes.quantized.Conv2dPackedParamsBase packed_weight, float output_scale, int output_zero_point) -> Tensor");
   m.def("conv3d.new(Tensor qx, __torch__.torch.classes.quantized.Conv3dPackedParamsBase packed_weight, float output_scale, int output_zero_point) -> Tensor");
   m.def("conv3d_relu.new(Tensor qx, __torch__.torch.classes.quantized.Conv3dPackedParamsBase packed_weight, float output_scale, int output_zero_point) -> Tensor");
+  // conv followed by quantized::add (and relu) of qother, with conv_scale and
+  // conv_zero_point the quantization parameters of the conv output
+  m.def("conv2d_add(Tensor qx, __torch__.torch.classes.quantized.Conv2dPackedParamsBase packed_weight, Tensor qother, float conv_scale, int conv_zero_point, float scale, int zero_point) -> Tensor");
+  m.def("conv2d_add_relu(Tensor qx, __torch__.torch.classes.quantized.Conv2dPackedParamsBase packed_weight, Tensor qother, float conv_scale, int conv_zero_point, float scale, int zero_point) -> Tensor");
+  m.def("conv3d_add(Tensor qx, __torch__.torch.classes.quantized.Conv3dPackedParamsBase packed_weight, Tensor qother, float conv_scale, int conv_zero_point, float scale, int zero_point) -> Tensor");
+  m.def("conv3d_add_relu(Tensor qx, __torch__.torch.classes.quantized.Conv3dPackedParamsBase packed_weight, Tensor qother, float conv_scale, int conv_zero_point, float scale, int zero_point) -> Tensor");
   m.def("conv2d(Tensor qx, __torch__.torch.classes.quantized.Conv2dPackedParamsBase weight, int[] stride, int[] padding, int[] dilation, int groups, float output_scale, int output_zero_point) -> Tensor");
   m.def("conv2d_relu(Tensor qx, __torch__.torch.classes.quantized.Conv2dPackedParamsBase weight, int[] stride, int[] padding, int[] dilation, int groups, float output_scale, int output_zero_point) -> Tensor");
   m.def("conv3d(Tensor qx, __torch__.torch.classes.quantized.Conv3dPackedParamsBase weight, int[] stride, int[] padding, int[] dilation, int groups, float output_scale, int output_zero_point) -> Tensor");
@@ -77,6 +86,14 @@ TORCH_LIBRARY(quantized, m) {
   m.def("conv3d_dilation(__torch__.torch.classes.quantized.Conv3dPackedParamsBase packed_weights) -> int[]");
   m.def("conv3d_groups(__torch__.torch.classes.quantized.Conv3dPackedParamsBase packed_weights) -> int");
   m.def("elu(Tensor self, float output_scale, int output_zero_point, Scalar alpha=1, Scalar scale=1, Scalar input_scale=1) -> Tensor");
+  m.def("embedding_bag_byte_prepack(Tensor weight) -> __torch__.torch.classes.quantized.EmbeddingPackedParamsBase W_prepack");
+  m.def("embedding_bag_4bit_prepack(Tensor weight) -> __torch__.torch.classes.quantized.EmbeddingPackedParamsBase W_prepack");
+  m.def("embedding_bag_2bit_prepack(Tensor weight) -> __torch__.torch.classes.quantized.EmbeddingPackedParamsBase W_prepack");
+  m.def("embedding_bag_unpack(__torch__.torch.classes.quantized.EmbeddingPackedParamsBase W_prepack) -> Tensor W_origin");
+  m.def("embedding_bag_byte(__torch__.torch.classes.quantized.EmbeddingPackedParamsBase weight, Tensor indices, Tensor? offsets=None, bool scale_grad_by_freq=False, int mode=0, bool sparse=False, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor");
+  m.def("embedding_bag_4bit(__torch__.torch.classes.quantized.EmbeddingPackedParamsBase weight, Tensor indices, Tensor? offsets=None, bool scale_grad_by_freq=False, int mode=0, bool sparse=False, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor");
+  m.def("embedding_bag_2bit(__torch__.torch.classes.quantized.EmbeddingPackedParamsBase weight, Tensor indices, Tensor? offsets=None, bool scale_grad_by_freq=False, int mode=0, bool sparse=False, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor");
+  m.def("embedding_mm_topk(__torch__.torch.classes.quantized.EmbeddingPackedParamsBase weight, Tensor query, int k) -> (Tensor, Tensor)");
   m.def("hardswish(Tensor input, float output_scale, int output_zero_point) -> Tensor");
   m.def("group_norm(Tensor input, int num_groups, Tensor? weight, Tensor? bias, float eps, float output_scale, int output_zero_point) -> Tensor");
   m.def("instance_norm(Tensor input, Tensor? weight, Tensor? bias, float eps, float output_scale, int output_zero_point) -> Tensor");
@@ -85,6 +102,10 @@ TORCH_LIBRARY(quantized, m) {
       "linear(Tensor X, __torch__.torch.classes.quantized.LinearPackedParamsBase W_prepack, float Y_scale_i, int Y_zero_point_i) -> Tensor Y");
   m.def(
       "linear_relu(Tensor X, __torch__.torch.classes.quantized.LinearPackedParamsBase W_prepack, float Y_scale_i, int Y_zero_point_i) -> Tensor Y");
+  m.def(
+      "linear_add(Tensor X, __torch__.torch.classes.quantized.LinearPackedParamsBase W_prepack, Tensor qother, float Y_scale_i, int Y_zero_point_i, float scale, int zero_point) -> Tensor");
+  m.def(
+      "linear_add_relu(Tensor X, __torch__.torch.classes.quantized.LinearPackedParamsBase W_prepack, Tensor qother, float Y_scale_i, int Y_zero_point_i, float scale, int zero_point) -> Tensor");
   m.def(
       "linear_dynamic(Tensor X, __torch__.torch.classes.quantized.LinearPackedParamsBase W_prepack, bool reduce_range=False) -> Tensor Y");
   m.def(
@@ -121,6 +142,7 @@ TORCH_LIBRARY(quantized, m) {
   m.def("mul_scalar_relu_out.Tensor(Tensor qa, Tensor b, Tensor(a!) out)-> Tensor(a!) out");
   // NB: missing a space after comma here...
   m.def("max_pool2d(Tensor qx, int[] kernel_size, int[] stride, int[] padding, int[] dilation,bool ceil_mode) -> Tensor");
+  m.def("pq_mm_topk(Tensor query, Tensor codebooks, Tensor codes, int k) -> (Tensor, Tensor)");
   m.def("relu6(Tensor qx, bool inplace=False) -> Tensor");
 }
 
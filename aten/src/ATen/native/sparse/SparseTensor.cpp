@@ -10,11 +10,53 @@
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
 
 
+namespace {
+
+// Start positions of the runs of equal keys of a sorted array, followed by
+// n. The heads of the runs are counted per chunk first, so that each chunk
+// knows where to write its own.
+std::vector<int64_t> sorted_run_starts(const int64_t* keys, int64_t n) {
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / at::internal::GRAIN_SIZE));
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  auto is_head = [&](int64_t j) { return j == 0 || keys[j] != keys[j - 1]; };
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t count = 0;
+      for (int64_t j = c * chunk_size; j < std::min(n, (c + 1) * chunk_size); j++) {
+        count += is_head(j);
+      }
+      chunk_offsets[c + 1] = count;
+    }
+  });
+  std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+  std::vector<int64_t> starts(chunk_offsets.back() + 1);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t k = chunk_offsets[c];
+      for (int64_t j = c * chunk_size; j < std::min(n, (c + 1) * chunk_size); j++) {
+        if (is_head(j)) {
+          starts[k++] = j;
+        }
+      }
+    }
+  });
+  starts.back() = n;
+  return starts;
+}
+
+} // namespace
+
 /******************************************************************************
  * access methods
  ******************************************************************************/
@@ -383,44 +425,47 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   Tensor newValues = at::empty(values.sizes(), values.options());
   alias_into_sparse(dst, newIndices, newValues);
 
+  // The sort is a parallel radix sort on large inputs, see SortingKernel.cpp.
   LongTensor indicesBuffer;
   LongTensor indicesPermutation;
   std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  const std::vector<int64_t> run_starts =
+      sorted_run_starts(indicesBuffer.data_ptr<int64_t>(), nnz);
+  const int64_t new_nnz = run_starts.size() - 1;
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
   auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
 
-  int64_t i = -1;
+  // Each run of equal indices is summed into its own row of newValues, so
+  // the runs are split across threads. Within a run, values are added in
+  // the order of the sort, as before.
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "coalesce", [&] {
-        int64_t prev = -1;
         int64_t blockSize = values.stride(0);
         scalar_t* values_ptr = values.data_ptr<scalar_t>();
         scalar_t* newValues_ptr = newValues.data_ptr<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-            }
-          } else {
-            ++i;
+        int64_t grain_size = std::max<int64_t>(
+            1, at::internal::GRAIN_SIZE / std::max<int64_t>(blockSize, 1));
+        at::parallel_for(0, new_nnz, grain_size, [&](int64_t start, int64_t end) {
+          for (int64_t i = start; i < end; i++) {
+            int64_t pos = indicesPermutationAccessor[run_starts[i]];
             for (int64_t d = 0; d < sparse_dim; d++) {
               newIndicesAccessor[d][i] = indicesAccessor[d][pos];
             }
             if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
               THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+              for (int64_t j = run_starts[i] + 1; j < run_starts[i + 1]; j++) {
+                pos = indicesPermutationAccessor[j];
+                THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+              }
             }
           }
-          prev = curr;
-        }
+        });
     });
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
+  get_sparse_impl(dst)->set_nnz_and_narrow(new_nnz);
 
   return dst;
 }
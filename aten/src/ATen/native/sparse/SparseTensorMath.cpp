@@ -9,9 +9,19 @@
 #include <ATen/SparseTensorUtils.h>
 #include <ATen/WrapDimUtilsMulti.h>
 #include <ATen/native/BinaryOps.h>
+#include <ATen/Config.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <TH/THBlasUtils.h>
 
 #include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#if AT_MKL_ENABLED()
+#include <mkl_spblas.h>
+#endif
 
 namespace at { namespace native {
 
@@ -42,6 +52,42 @@ namespace {
     return csr;
   }
 
+  // CSR row pointers of a coalesced matrix, cached on the tensor until its
+  // indices change, so that repeated products with the same sparse matrix
+  // only convert it once.
+  LongTensor _cached_to_csr(const SparseTensor& sparse) {
+    auto* impl = get_sparse_impl(sparse);
+    LongTensor csr = impl->crow_indices();
+    if (!csr.defined()) {
+      csr = _to_csr(impl->indices().data_ptr<int64_t>(), sparse.size(0), impl->nnz());
+      impl->set_crow_indices(csr);
+    }
+    return csr;
+  }
+
+  // CSR form of a matrix that is not coalesced, without coalescing it: row
+  // pointers, plus the positions of the nonzeros ordered by row. Duplicate
+  // entries are kept as they are, since they add up in products anyway.
+  std::tuple<LongTensor, LongTensor> _to_csr_uncoalesced(const int64_t* rows, int64_t dim, int64_t nnz) {
+    LongTensor csr = native::zeros({dim + 1}, kLong);
+    LongTensor perm = at::empty({nnz}, kLong);
+    auto* csr_data = csr.data_ptr<int64_t>();
+    auto* perm_data = perm.data_ptr<int64_t>();
+    for (int64_t i = 0; i < nnz; i++) {
+      TORCH_CHECK(rows[i] >= 0 && rows[i] < dim,
+          "addmm: index out of row bound: ", rows[i], " not between 1 and ", dim);
+      csr_data[rows[i] + 1]++;
+    }
+    for (int64_t h = 0; h < dim; h++) {
+      csr_data[h + 1] += csr_data[h];
+    }
+    std::vector<int64_t> next(csr_data, csr_data + dim);
+    for (int64_t i = 0; i < nnz; i++) {
+      perm_data[next[rows[i]]++] = i;
+    }
+    return std::make_tuple(csr, perm);
+  }
+
 }
 
 // --------------------------------------------------------------------
@@ -407,26 +453,78 @@ Tensor& sub_out_sparse(Tensor& r, const Tensor& self, const Tensor& other, Scala
 }
 
 
+// Adds two coalesced sparse tensors by merging their sorted indices. The
+// merged order is cut into one chunk per thread; each cut is moved back to the
+// first occurrence of its key in both inputs, so that matching entries of t
+// and src always land in the same chunk. The entries of each chunk are
+// counted first, then written at their offset in the result.
 SparseTensor& add_out_sparse_contiguous(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value, ScalarType commonDtype) {
     // saving those because they can be overwritten when doing in-place operations
     int64_t t_nnz = t._nnz(), s_nnz = src._nnz(), max_nnz = t_nnz + s_nnz;
-    bool coalesced = t.is_coalesced() && src.is_coalesced();
     int64_t sparse_dim = src.sparse_dim();
 
-    LongTensor r_indices = at::empty({src.sparse_dim(), max_nnz}, t._indices().options());
-
     Tensor t_values = t._values().to(commonDtype);
     Tensor s_values = src._values().to(commonDtype);
+    LongTensor t_indices = t._indices();
+    LongTensor src_indices = src._indices();
+    LongTensor t_keys = flatten_indices(t_indices, t.sizes()).contiguous();
+    LongTensor s_keys = flatten_indices(src_indices, src.sizes()).contiguous();
+    const int64_t* t_keys_ptr = t_keys.data_ptr<int64_t>();
+    const int64_t* s_keys_ptr = s_keys.data_ptr<int64_t>();
+
+    int64_t num_chunks = std::max<int64_t>(
+        1, std::min<int64_t>(at::get_num_threads(), max_nnz / at::internal::GRAIN_SIZE));
+    // Chunk c merges t[t_cuts[c]:t_cuts[c + 1]] and src[s_cuts[c]:s_cuts[c + 1]]
+    std::vector<int64_t> t_cuts(num_chunks + 1, t_nnz), s_cuts(num_chunks + 1, s_nnz);
+    t_cuts[0] = s_cuts[0] = 0;
+    for (int64_t c = 1; c < num_chunks; c++) {
+      // Merge path: find the split of the first `diag` merged entries
+      int64_t diag = c * max_nnz / num_chunks;
+      int64_t lo = std::max<int64_t>(0, diag - s_nnz), hi = std::min(diag, t_nnz);
+      while (lo < hi) {
+        int64_t mid = (lo + hi) / 2;
+        if (t_keys_ptr[mid] < s_keys_ptr[diag - mid - 1]) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      int64_t key = lo < t_nnz
+          ? (diag - lo < s_nnz ? std::min(t_keys_ptr[lo], s_keys_ptr[diag - lo]) : t_keys_ptr[lo])
+          : s_keys_ptr[diag - lo];
+      t_cuts[c] = std::lower_bound(t_keys_ptr, t_keys_ptr + t_nnz, key) - t_keys_ptr;
+      s_cuts[c] = std::lower_bound(s_keys_ptr, s_keys_ptr + s_nnz, key) - s_keys_ptr;
+    }
 
-    Tensor r_values = new_values_with_size_of(s_values, max_nnz).zero_();
+    // Calls emit(r_i, t_i, s_i) for each entry of the result in chunk c, with
+    // t_i or s_i set to -1 when the entry only comes from the other input.
+    auto merge_chunk = [&](int64_t c, int64_t r_i, const auto& emit) {
+      int64_t t_i = t_cuts[c], s_i = s_cuts[c];
+      while (t_i < t_cuts[c + 1] || s_i < s_cuts[c + 1]) {
+        if (s_i >= s_cuts[c + 1] || (t_i < t_cuts[c + 1] && t_keys_ptr[t_i] < s_keys_ptr[s_i])) {
+          emit(r_i++, t_i++, -1);
+        } else if (t_i >= t_cuts[c + 1] || s_keys_ptr[s_i] < t_keys_ptr[t_i]) {
+          emit(r_i++, -1, s_i++);
+        } else {
+          emit(r_i++, t_i++, s_i++);
+        }
+      }
+      return r_i;
+    };
 
-    int64_t blockSize = r_values.stride(0);
-    int64_t cmp, d;
-    int64_t r_i = 0, t_i = 0, s_i = 0;
-    auto t_indices = t._indices();
-    auto src_indices = src._indices();
+    std::vector<int64_t> r_offsets(num_chunks + 1, 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        r_offsets[c + 1] = merge_chunk(c, 0, [](int64_t, int64_t, int64_t) {});
+      }
+    });
+    std::partial_sum(r_offsets.begin(), r_offsets.end(), r_offsets.begin());
+    int64_t r_nnz = r_offsets.back();
 
-    // NB: relies on nnz tests above
+    LongTensor r_indices = at::empty({sparse_dim, r_nnz}, t_indices.options());
+    Tensor r_values = new_values_with_size_of(s_values, r_nnz);
+
+    int64_t blockSize = r_values.stride(0);
     auto t_indices_accessor = t_indices.accessor<int64_t, 2>();
     auto r_indices_accessor = r_indices.accessor<int64_t, 2>();
     auto src_indices_accessor = src_indices.accessor<int64_t, 2>();
@@ -437,48 +535,32 @@ SparseTensor& add_out_sparse_contiguous(SparseTensor& r, const SparseTensor& t,
           scalar_t* s_values_ptr = s_values.data_ptr<scalar_t>();
           scalar_t* r_values_ptr = r_values.data_ptr<scalar_t>();
           scalar_t cast_value = value.to<scalar_t>();
-          while (t_i < t_nnz || s_i < s_nnz) {
-            if (t_i >= t_nnz) {
-              cmp = -1;
-            } else if (s_i >= s_nnz) {
-              cmp = 1;
-            } else {
-              cmp = 0;
-              for (d = 0; d < sparse_dim; d++) {
-                if (t_indices_accessor[d][t_i] < src_indices_accessor[d][s_i]) {
-                  cmp = 1;
-                  break;
+          // Values are empty tensors when the dense dimensions are of size 0
+          bool has_values = r_values.numel() > 0;
+          at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+            for (int64_t c = begin; c < end; c++) {
+              merge_chunk(c, r_offsets[c], [&](int64_t r_i, int64_t t_i, int64_t s_i) {
+                for (int64_t d = 0; d < sparse_dim; d++) {
+                  r_indices_accessor[d][r_i] = t_i >= 0
+                      ? t_indices_accessor[d][t_i]
+                      : src_indices_accessor[d][s_i];
                 }
-                if (t_indices_accessor[d][t_i] > src_indices_accessor[d][s_i]) {
-                  cmp = -1;
-                  break;
+                if (!has_values) {
+                  return;
                 }
-              }
-            }
-            if (cmp >= 0) {
-              for (d = 0; d < sparse_dim; d++) {
-                r_indices_accessor[d][r_i] = t_indices_accessor[d][t_i];
-              }
-              if (t_values.numel() > 0) {  // We add all elements from t_values to r_values only if t_values is not an empty tensor
-                THBlas_axpy<scalar_t>(blockSize, 1,
-                  t_values_ptr + t_i * blockSize, 1,
-                  r_values_ptr + r_i * blockSize, 1);
-              }
-              t_i++;
-            }
-            if (cmp <= 0) {
-              for (d = 0; d < sparse_dim; d++) {
-                r_indices_accessor[d][r_i] = src_indices_accessor[d][s_i];
-              }
-              if (s_values.numel() > 0) {  // We add all elements from s_values to r_values only if s_values is not an empty tensor
-                THBlas_axpy<scalar_t>(blockSize, cast_value,
-                  s_values_ptr + s_i * blockSize, 1,
-                  r_values_ptr + r_i * blockSize, 1);
-              }
-              s_i++;
+                scalar_t* r_row = r_values_ptr + r_i * blockSize;
+                if (t_i >= 0) {
+                  THBlas_copy<scalar_t>(blockSize, t_values_ptr + t_i * blockSize, 1, r_row, 1);
+                } else {
+                  std::fill(r_row, r_row + blockSize, static_cast<scalar_t>(0));
+                }
+                if (s_i >= 0) {
+                  THBlas_axpy<scalar_t>(blockSize, cast_value,
+                    s_values_ptr + s_i * blockSize, 1, r_row, 1);
+                }
+              });
             }
-            r_i++;
-          }
+          });
         }
     );
 
@@ -486,21 +568,17 @@ SparseTensor& add_out_sparse_contiguous(SparseTensor& r, const SparseTensor& t,
       r_values = r_values.to(r.scalar_type());
     }
     get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
-    get_sparse_impl(r)->set_nnz_and_narrow(r_i);
-
-    // TODO: I think it may be possible to track inside the loop and
-    // detect when we are uncoalesced (e.g., by observing that an
-    // index goes backwards) which may be more precise than using the
-    // coalesced flag here.  But this is easy.
-    return r._coalesced_(coalesced);
+    get_sparse_impl(r)->set_nnz_and_narrow(r_nnz);
+    return r._coalesced_(true);
 }
 
 SparseTensor& add_out_sparse_non_contiguous(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value, ScalarType commonDtype) {
     Tensor t_values = t._values().to(commonDtype);
     Tensor s_values = src._values().to(commonDtype);
 
-    // If `t` or `src` contains non-contiguous `values`, `THBlas_axpy` doesn't work
-    // and we concat the indices and values tensors instead.
+    // If `t` or `src` contains non-contiguous `values`, `THBlas_axpy` doesn't work,
+    // and if either is uncoalesced, its indices can't be merged in order, so we
+    // concat the indices and values tensors instead.
     AT_DISPATCH_ALL_TYPES(
       commonDtype, "add_out_sparse_cpu", [&] {
           if (value.to<scalar_t>() != static_cast<scalar_t>(1)) {
@@ -551,7 +629,8 @@ SparseTensor& add_out_sparse_cpu(SparseTensor& r, const SparseTensor& t, const S
 
   r.resize_as_(src);
 
-  if (src._values().is_contiguous() && t._values().is_contiguous()) {
+  if (src._values().is_contiguous() && t._values().is_contiguous() &&
+      t.is_coalesced() && src.is_coalesced()) {
     return add_out_sparse_contiguous(r, t, src, value, commonDtype);
   } else {
     return add_out_sparse_non_contiguous(r, t, src, value, commonDtype);
@@ -764,10 +843,66 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // D = beta * D1 + alpha * mm(S, D2)
 // --------------------------------------------------------------------
 
+#if AT_MKL_ENABLED()
+// r += alpha * sparse @ dense with the MKL sparse BLAS, for a coalesced sparse
+// matrix in CSR form and row-major dense and r. Returns false when MKL does
+// not handle the case, so that the caller falls back to its own kernel.
 template <typename scalar_t>
-void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t i;
+bool s_addmm_out_sparse_dense_mkl(int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, scalar_t alpha, const LongTensor& csr, const LongTensor& col_indices, const Tensor& values, const Tensor& dense) {
+  return false;
+}
+
+template <typename scalar_t, typename create_fn_t, typename mm_fn_t>
+bool s_addmm_out_sparse_dense_mkl_impl(int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, scalar_t alpha, const LongTensor& csr, const LongTensor& col_indices, const Tensor& values, const Tensor& dense, create_fn_t create_csr, mm_fn_t mm) {
+  constexpr int64_t kMaxInt = std::numeric_limits<MKL_INT>::max();
+  if (dense.stride(1) != 1 || r.stride(1) != 1 ||
+      dense.stride(0) < dim_k || r.stride(0) < dim_k ||
+      dim_i >= kMaxInt || dim_j >= kMaxInt || dim_k >= kMaxInt ||
+      values.numel() >= kMaxInt || dense.stride(0) >= kMaxInt || r.stride(0) >= kMaxInt) {
+    return false;
+  }
+  auto csr_int = csr.to(sizeof(MKL_INT) == 4 ? kInt : kLong);
+  auto col_indices_int = col_indices.to(csr_int.scalar_type()).contiguous();
+  auto values_contig = values.contiguous();
+  auto* csr_data = static_cast<MKL_INT*>(csr_int.data_ptr());
+
+  sparse_matrix_t handle;
+  TORCH_CHECK(create_csr(
+      &handle, SPARSE_INDEX_BASE_ZERO, dim_i, dim_j, csr_data, csr_data + 1,
+      static_cast<MKL_INT*>(col_indices_int.data_ptr()),
+      values_contig.data_ptr<scalar_t>()) == SPARSE_STATUS_SUCCESS,
+      "addmm: MKL failed to create the sparse matrix");
+  matrix_descr descr;
+  descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+  auto status = mm(
+      SPARSE_OPERATION_NON_TRANSPOSE, alpha, handle, descr, SPARSE_LAYOUT_ROW_MAJOR,
+      dense.data_ptr<scalar_t>(), dim_k, dense.stride(0), scalar_t(1),
+      r.data_ptr<scalar_t>(), r.stride(0));
+  mkl_sparse_destroy(handle);
+  TORCH_CHECK(status == SPARSE_STATUS_SUCCESS, "addmm: MKL sparse matmul failed");
+  return true;
+}
 
+template <>
+bool s_addmm_out_sparse_dense_mkl<float>(int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, float alpha, const LongTensor& csr, const LongTensor& col_indices, const Tensor& values, const Tensor& dense) {
+  return s_addmm_out_sparse_dense_mkl_impl<float>(
+      dim_i, dim_j, dim_k, r, alpha, csr, col_indices, values, dense,
+      mkl_sparse_s_create_csr, mkl_sparse_s_mm);
+}
+
+template <>
+bool s_addmm_out_sparse_dense_mkl<double>(int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, double alpha, const LongTensor& csr, const LongTensor& col_indices, const Tensor& values, const Tensor& dense) {
+  return s_addmm_out_sparse_dense_mkl_impl<double>(
+      dim_i, dim_j, dim_k, r, alpha, csr, col_indices, values, dense,
+      mkl_sparse_d_create_csr, mkl_sparse_d_mm);
+}
+#endif
+
+// The product goes row by row of the CSR form of sparse, in parallel over the
+// rows, so that each row of r is written by a single thread. perm is the order
+// of the nonzeros by row when sparse is not coalesced, and undefined otherwise.
+template <typename scalar_t>
+void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense, const LongTensor& csr, const LongTensor& perm) {
   // r_ = alpha * sparse * dense
   scalar_t cast_alpha = alpha.to<scalar_t>();
   scalar_t cast_beta = beta.to<scalar_t>();
@@ -781,9 +916,20 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
     at::mul_out(r, t, scalar_to_tensor(beta));
   }
 
-  auto indices_accessor = indices.accessor<int64_t, 2>();
+  LongTensor col_indices = indices.select(0, 1).contiguous();
 
-  auto values_accessor = values.accessor<scalar_t, 1>();
+#if AT_MKL_ENABLED()
+  if (!perm.defined() &&
+      s_addmm_out_sparse_dense_mkl<scalar_t>(dim_i, dim_j, dim_k, r, cast_alpha, csr, col_indices, values, dense)) {
+    return;
+  }
+#endif
+
+  Tensor values_contig = values.contiguous();
+  const auto* csr_data = csr.data_ptr<int64_t>();
+  const auto* perm_data = perm.defined() ? perm.data_ptr<int64_t>() : nullptr;
+  const auto* col_data = col_indices.data_ptr<int64_t>();
+  const auto* values_data = values_contig.data_ptr<scalar_t>();
   scalar_t* dense_ptr = dense.data_ptr<scalar_t>();
   scalar_t* r_ptr = r.data_ptr<scalar_t>();
 
@@ -791,23 +937,31 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   int64_t dense_stride1 = dense.stride(1);
   int64_t r_stride0 = r.stride(0);
   int64_t r_stride1 = r.stride(1);
-  for (i = 0; i < nnz; i++) {
-    scalar_t val = values_accessor[i];
-    int64_t row = indices_accessor[0][i];
-    int64_t col = indices_accessor[1][i];
-    if (col >= 0 && col < dim_j && row >= 0 && row < dim_i) {
-      THBlas_axpy<scalar_t>(dim_k,
-            cast_alpha * val,
-            dense_ptr + col * dense_stride0, dense_stride1,
-            r_ptr + row * r_stride0, r_stride1);
-    } else {
-      if (col < 0 || col >= dim_j) {
-        AT_ERROR("addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
-      } else {
-        AT_ERROR("addmm: index out of row bound: ", row, " not between 1 and ", dim_i);
+  const bool contiguous_rows = dense_stride1 == 1 && r_stride1 == 1;
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(nnz / std::max<int64_t>(dim_i, 1) * dim_k, 1));
+
+  at::parallel_for(0, dim_i, grain_size, [&](int64_t start, int64_t end) {
+    using Vec = vec256::Vec256<scalar_t>;
+    for (int64_t row = start; row < end; row++) {
+      scalar_t* r_row = r_ptr + row * r_stride0;
+      for (int64_t p = csr_data[row]; p < csr_data[row + 1]; p++) {
+        const int64_t i = perm_data ? perm_data[p] : p;
+        const int64_t col = col_data[i];
+        TORCH_CHECK(col >= 0 && col < dim_j,
+            "addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
+        const scalar_t val = cast_alpha * values_data[i];
+        scalar_t* dense_row = dense_ptr + col * dense_stride0;
+        if (contiguous_rows) {
+          vec256::map2(
+              [val](Vec x, Vec y) { return y + Vec(val) * x; },
+              r_row, dense_row, r_row, dim_k);
+        } else {
+          THBlas_axpy<scalar_t>(dim_k, val, dense_row, dense_stride1, r_row, r_stride1);
+        }
       }
     }
-  }
+  });
 };
 
 Tensor& s_addmm_out_sparse_dense_cpu(
@@ -852,9 +1006,24 @@ Tensor& s_addmm_out_sparse_dense_cpu(
   LongTensor indices = sparse_._indices();
   Tensor values      = sparse_._values();
 
+  // A coalesced matrix is already sorted by row, otherwise the nonzeros are
+  // bucketed by row without merging duplicates.
+  LongTensor csr, perm;
+  if (sparse_.is_coalesced()) {
+    auto rows_accessor = indices.accessor<int64_t, 2>()[0];
+    TORCH_CHECK(rows_accessor[0] >= 0 && rows_accessor[nnz - 1] < dim_i,
+        "addmm: index out of row bound: ",
+        rows_accessor[0] < 0 ? rows_accessor[0] : rows_accessor[nnz - 1],
+        " not between 1 and ", dim_i);
+    csr = _cached_to_csr(sparse_);
+  } else {
+    LongTensor rows = indices.select(0, 0).contiguous();
+    std::tie(csr, perm) = _to_csr_uncoalesced(rows.data_ptr<int64_t>(), dim_i, nnz);
+  }
+
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "addmm_sparse_dense", [&] {
-        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, indices, values, dense);
+        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, indices, values, dense, csr, perm);
       }
   );
 
@@ -1023,6 +1192,87 @@ SparseTensor hspmm_sparse_cpu(const SparseTensor& sparse, const Tensor& dense) {
   return r;
 }
 
+// --------------------------------------------------------------------
+// _sparse_sampled_addmm(S, D1, D2, beta, alpha) -> S
+//
+// S' = beta * S + alpha * mm(D1, D2) at the nonzeros of S, also known as
+// SDDMM (sampled dense-dense matrix multiplication)
+// --------------------------------------------------------------------
+
+void sparse_sampled_addmm_check(const SparseTensor& self, const Tensor& mat1, const Tensor& mat2) {
+  TORCH_CHECK(self.sparse_dim() == 2 && self.dense_dim() == 0,
+      "sampled_addmm: expected self to be a sparse matrix with scalar values, but got sparse_dim ",
+      self.sparse_dim(), " and dense_dim ", self.dense_dim());
+  TORCH_CHECK(!mat1.is_sparse() && !mat2.is_sparse(), "sampled_addmm: expected mat1 and mat2 to be dense");
+  TORCH_CHECK(mat1.dim() == 2 && mat2.dim() == 2,
+      "sampled_addmm: matrices expected, got ", mat1.dim(), "D and ", mat2.dim(), "D tensors");
+  TORCH_CHECK(mat1.scalar_type() == self.scalar_type() && mat2.scalar_type() == self.scalar_type(),
+      "sampled_addmm: expected mat1 and mat2 to have the dtype of self, ", self.scalar_type());
+  TORCH_CHECK(mat1.size(0) == self.size(0) && mat2.size(1) == self.size(1) && mat1.size(1) == mat2.size(0),
+      "sampled_addmm: self of size ", self.sizes(), " cannot sample the product of mat1 of size ",
+      mat1.sizes(), " and mat2 of size ", mat2.sizes());
+}
+
+SparseTensor sparse_sampled_addmm_cpu(const SparseTensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+  sparse_sampled_addmm_check(self, mat1, mat2);
+  TORCH_CHECK(!mat1.is_cuda() && !mat2.is_cuda(), "sampled_addmm: expected mat1 and mat2 to be CPU tensors");
+
+  int64_t nnz = self._nnz();
+  int64_t dim_i = self.size(0);
+  int64_t dim_j = self.size(1);
+  int64_t dim_k = mat1.size(1);
+  LongTensor indices = self._indices();
+  Tensor values = self._values();
+  Tensor r_values = at::empty({nnz}, values.options());
+
+  // The columns of mat2 are the rows of mat2_t, so that each nonzero is a dot
+  // product of two contiguous rows.
+  Tensor mat1_ = mat1.contiguous();
+  Tensor mat2_t = mat2.t().contiguous();
+
+  AT_DISPATCH_FLOATING_TYPES(values.scalar_type(), "sampled_addmm", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    scalar_t cast_alpha = alpha.to<scalar_t>();
+    scalar_t cast_beta = beta.to<scalar_t>();
+    auto indices_accessor = indices.accessor<int64_t, 2>();
+    auto values_accessor = values.accessor<scalar_t, 1>();
+    auto* r_values_data = r_values.data_ptr<scalar_t>();
+    const auto* mat1_data = mat1_.data_ptr<scalar_t>();
+    const auto* mat2_data = mat2_t.data_ptr<scalar_t>();
+    const int64_t grain_size =
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(dim_k, 1));
+
+    at::parallel_for(0, nnz, grain_size, [&](int64_t start, int64_t end) {
+      for (int64_t i = start; i < end; i++) {
+        int64_t row = indices_accessor[0][i];
+        int64_t col = indices_accessor[1][i];
+        TORCH_CHECK(row >= 0 && row < dim_i && col >= 0 && col < dim_j,
+            "sampled_addmm: index (", row, ", ", col, ") out of bound for self of size (",
+            dim_i, ", ", dim_j, ")");
+        scalar_t dot = 0;
+        if (dim_k > 0) {
+          dot = vec256::map2_reduce_all<scalar_t>(
+              [](Vec x, Vec y) { return x * y; },
+              [](Vec x, Vec y) { return x + y; },
+              mat1_data + row * dim_k,
+              mat2_data + col * dim_k,
+              dim_k);
+        }
+        // beta == 0 ignores self's values, like addmm ignores self
+        r_values_data[i] = cast_beta == 0
+            ? cast_alpha * dot
+            : cast_beta * values_accessor[i] + cast_alpha * dot;
+      }
+    });
+  });
+
+  SparseTensor r = at::empty({0}, self.options());
+  get_sparse_impl(r)->raw_resize_(2, 0, self.sizes());
+  alias_into_sparse(r, indices.clone(), r_values);
+  r._coalesced_(self.is_coalesced());
+  return r;
+}
+
 // --------------------------------------------------------------------
 // sspaddmm(S1, S2, D, beta, alpha) -> S
 //
@@ -1550,6 +1800,9 @@ Tensor& bmm_out_sparse_cpu(Tensor& result, const SparseTensor& self, const Tenso
           LongTensor sparse_indices = indices_dim1_dim2.slice(1, mat_el_begin_idx, mat_el_end_idx);
           Tensor sparse_values = values.slice(0, mat_el_begin_idx, mat_el_end_idx);
           int64_t sparse_nnz = mat_el_end_idx - mat_el_begin_idx;
+          // self is coalesced, so the rows of each matrix are sorted
+          LongTensor sparse_rows = sparse_indices.select(0, 0).contiguous();
+          LongTensor csr = _to_csr(sparse_rows.data_ptr<int64_t>(), dim_i, sparse_nnz);
 
           s_addmm_out_sparse_dense_worker<scalar_t>(
             sparse_nnz,
@@ -1557,7 +1810,7 @@ Tensor& bmm_out_sparse_cpu(Tensor& result, const SparseTensor& self, const Tenso
             result_matrix,
             beta, t_dummy, alpha,
             sparse_indices, sparse_values,
-            dense_matrix
+            dense_matrix, csr, LongTensor()
           );
           mat_el_begin_idx = mat_el_end_idx;
 
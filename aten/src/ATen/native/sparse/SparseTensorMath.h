@@ -7,5 +7,6 @@ namespace at { namespace native {
 
 TORCH_API sparse::SparseTensor& mul_out_sparse_scalar(sparse::SparseTensor& r, const sparse::SparseTensor& t, Scalar value);
 TORCH_API sparse::SparseTensor& mul_out_sparse_zerodim(sparse::SparseTensor& r, const sparse::SparseTensor& t, const Tensor& value);
+TORCH_API void sparse_sampled_addmm_check(const sparse::SparseTensor& self, const Tensor& mat1, const Tensor& mat2);
 
 }}
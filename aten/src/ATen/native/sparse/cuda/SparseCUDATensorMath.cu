@@ -45,18 +45,29 @@ namespace {
     sparse::cuda::Xcoo2csr(rowIndicesInt.data_ptr<int32_t>(), nnz, dim, csr.data_ptr<int32_t>());
     return csr;
   }
+
+  // CSR row pointers of a coalesced matrix, cached on the tensor until its
+  // indices change, so that repeated products with the same sparse matrix
+  // only convert it once.
+  IntTensor _cached_to_csr_int(const SparseTensor& sparse) {
+    auto* impl = get_sparse_impl(sparse);
+    IntTensor csr = impl->crow_indices();
+    if (!csr.defined()) {
+      csr = _to_csr_int(impl->indices().select(0, 0), sparse.size(0), impl->nnz());
+      impl->set_crow_indices(csr);
+    }
+    return csr;
+  }
 }
 
 // NB: Deleted spaddcmul (aka addcmul_, but not actually wired up), spaddcdiv (not
 // wired at all)
 
 template <typename scalar_t>
-void s_addmm_out_sparse_dense_cuda_worker(int64_t nnz, int64_t m, int64_t n, int64_t k, Tensor& r_, Scalar beta, const Tensor& t, Scalar alpha, LongTensor& indices, Tensor& values, const Tensor& dense) {
+void s_addmm_out_sparse_dense_cuda_worker(int64_t nnz, int64_t m, int64_t n, int64_t k, Tensor& r_, Scalar beta, const Tensor& t, Scalar alpha, LongTensor& indices, Tensor& values, const Tensor& dense, const IntTensor& csr) {
   scalar_t cast_beta = beta.to<scalar_t>();
   scalar_t cast_alpha = alpha.to<scalar_t>();
-  LongTensor rowIndices = indices.select(0, 0);
   LongTensor colIndices = indices.select(0, 1);
-  IntTensor csr = _to_csr_int(rowIndices, m, nnz);
   IntTensor colIndicesInt = at::empty({colIndices.size(0)}, indices.options().dtype(kInt));
   colIndicesInt.copy_(colIndices);
 
@@ -148,12 +159,12 @@ Tensor& s_addmm_out_sparse_dense_cuda(Tensor& r_, const Tensor& t, const SparseT
   int64_t nnz = sparse._nnz();
   LongTensor indices = sparse._indices();
   Tensor values = sparse._values();
-
+  IntTensor csr = _cached_to_csr_int(sparse);
 
   // No half support, so we don't have to use CUDATypeConversion
   AT_DISPATCH_FLOATING_TYPES(
     values.scalar_type(), "addmm_sparse_cuda", [&] {
-      s_addmm_out_sparse_dense_cuda_worker<scalar_t>(nnz, m, n, k, r_, beta, t, alpha, indices, values, dense);
+      s_addmm_out_sparse_dense_cuda_worker<scalar_t>(nnz, m, n, k, r_, beta, t, alpha, indices, values, dense, csr);
     }
   );
 
@@ -279,6 +290,47 @@ SparseTensor hspmm_sparse_cuda(const SparseTensor& sparse, const Tensor& dense)
   return r;
 }
 
+// --------------------------------------------------------------------
+// _sparse_sampled_addmm(S, D1, D2, beta, alpha) -> S
+// --------------------------------------------------------------------
+
+SparseTensor sparse_sampled_addmm_cuda(const SparseTensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+  sparse_sampled_addmm_check(self, mat1, mat2);
+  TORCH_CHECK(cuda::check_device({self, mat1, mat2}));
+
+  int64_t nnz = self._nnz();
+  int64_t k = mat1.size(1);
+  LongTensor indices = self._indices();
+  LongTensor rowIndices = indices.select(0, 0);
+  LongTensor colIndices = indices.select(0, 1);
+  Tensor values = self._values();
+  Tensor r_values = at::empty({nnz}, values.options());
+
+  // Gathers the rows of mat1 and the columns of mat2 of each nonzero and
+  // reduces their products, in chunks of nonzeros so that the gathered rows
+  // stay within a bounded workspace.
+  Tensor mat2_t = mat2.t();
+  int64_t chunk = std::max<int64_t>(1, (int64_t(1) << 24) / std::max<int64_t>(k, 1));
+  for (int64_t start = 0; start < nnz; start += chunk) {
+    int64_t len = std::min(chunk, nnz - start);
+    Tensor dots = mat1.index_select(0, rowIndices.narrow(0, start, len))
+        .mul_(mat2_t.index_select(0, colIndices.narrow(0, start, len)))
+        .sum(1);
+    Tensor r_chunk = r_values.narrow(0, start, len);
+    if (beta.toDouble() == 0) {
+      at::mul_out(r_chunk, dots, scalar_to_tensor(alpha));
+    } else {
+      at::add_out(r_chunk, values.narrow(0, start, len).mul(beta), dots, alpha);
+    }
+  }
+
+  SparseTensor r = at::empty({0}, self.options());
+  get_sparse_impl(r)->raw_resize_(2, 0, self.sizes());
+  alias_into_sparse(r, indices.clone(), r_values);
+  r._coalesced_(self.is_coalesced());
+  return r;
+}
+
 // --------------------------------------------------------------------
 // add(Tensor, SparseTensor, Scalar)
 //    formerly known as spcadd
@@ -36,13 +36,59 @@ namespace vulkan {
 namespace detail {
 
 VContext::VContext(bool enableValidationLayers)
-    : enableValidationLayers_(enableValidationLayers) {
+    : enableValidationLayers_(enableValidationLayers),
+      commandBuffer_(VK_NULL_HANDLE),
+      recording_(false),
+      descriptorPoolIndex_(0),
+      descriptorSetsInPool_(0),
+      computeUnitFactory_(std::make_unique<ComputeUnitFactory>()) {
   createInstance();
   findPhysicalDevice();
   createDevice();
 }
 
+void destroyBufferResource(
+    VkDevice device,
+    const VContext::BufferResource& resource) {
+  vkFreeMemory(device, resource.memory, nullptr);
+  vkDestroyBuffer(device, resource.buffer, nullptr);
+}
+
+void destroyImageResource(
+    VkDevice device,
+    const VContext::ImageResource& resource) {
+  vkFreeMemory(device, resource.memory, nullptr);
+  vkDestroySampler(device, resource.sampler, nullptr);
+  vkDestroyImageView(device, resource.view, nullptr);
+  vkDestroyImage(device, resource.image, nullptr);
+}
+
 VContext::~VContext() {
+  vkDeviceWaitIdle(device_);
+  computeUnitFactory_.reset();
+  for (const auto& pending : pendingBuffers_) {
+    destroyBufferResource(device_, pending.second);
+  }
+  for (const auto& pending : pendingImages_) {
+    destroyImageResource(device_, pending.second);
+  }
+  for (const auto& cached : cachedBuffers_) {
+    for (const auto& resource : cached.second) {
+      destroyBufferResource(device_, resource);
+    }
+  }
+  for (const auto& cached : cachedImages_) {
+    for (const auto& resource : cached.second) {
+      destroyImageResource(device_, resource);
+    }
+  }
+  for (const auto& layout : descriptorSetLayouts_) {
+    vkDestroyDescriptorSetLayout(device_, layout.second, nullptr);
+  }
+  for (const auto& pool : descriptorPools_) {
+    vkDestroyDescriptorPool(device_, pool, nullptr);
+  }
+  vkDestroyFence(device_, fence_, nullptr);
   vkDestroyCommandPool(device_, commandPool_, nullptr);
   if (enableValidationLayers_) {
     auto func = (PFN_vkDestroyDebugReportCallbackEXT)vkGetInstanceProcAddr(
@@ -228,6 +274,183 @@ void VContext::createDevice() {
   VK_CHECK(vkCreateCommandPool(
       device_, &commandPoolCreateInfo, nullptr, &commandPool_));
   physicalDeviceLimits_ = physicalDeviceProperties.limits;
+  vendorID_ = physicalDeviceProperties.vendorID;
+
+  VkFenceCreateInfo fenceCreateInfo{};
+  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  fenceCreateInfo.flags = 0;
+  VK_CHECK(vkCreateFence(device_, &fenceCreateInfo, nullptr, &fence_));
+}
+
+VkCommandBuffer VContext::recordingCommandBuffer() const {
+  if (recording_) {
+    return commandBuffer_;
+  }
+  if (commandBuffer_ == VK_NULL_HANDLE) {
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType =
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = commandPool_;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    VK_CHECK(vkAllocateCommandBuffers(
+        device_, &commandBufferAllocateInfo, &commandBuffer_));
+  }
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  VK_CHECK(vkBeginCommandBuffer(commandBuffer_, &beginInfo));
+  recording_ = true;
+  return commandBuffer_;
+}
+
+void VContext::flush() const {
+  if (!recording_) {
+    return;
+  }
+  recording_ = false;
+  VK_CHECK(vkEndCommandBuffer(commandBuffer_));
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer_;
+  VK_CHECK(vkQueueSubmit(queue_, 1, &submitInfo, fence_));
+  VK_CHECK(vkWaitForFences(
+      device_, 1, &fence_, VK_TRUE, ComputeUnit::kFenceTimeoutNanos));
+  VK_CHECK(vkResetFences(device_, 1, &fence_));
+
+  VK_CHECK(vkResetCommandPool(device_, commandPool_, 0));
+  for (const auto& pool : descriptorPools_) {
+    VK_CHECK(vkResetDescriptorPool(device_, pool, 0));
+  }
+  descriptorPoolIndex_ = 0;
+  descriptorSetsInPool_ = 0;
+  recycleResources();
+}
+
+VkDescriptorSetLayout VContext::descriptorSetLayout(
+    const std::vector<VkDescriptorType>& descrTypes) const {
+  TORCH_INTERNAL_ASSERT(
+      descrTypes.size() <= kMaxDescriptorsPerSet,
+      "Vulkan: Too many descriptors in a descriptor set");
+  auto it = descriptorSetLayouts_.find(descrTypes);
+  if (it != descriptorSetLayouts_.end()) {
+    return it->second;
+  }
+  std::vector<VkDescriptorSetLayoutBinding> bindings;
+  uint32_t i = 0;
+  for (const auto& descrType : descrTypes) {
+    bindings.push_back(descriptorSetLayoutBinding(i++, descrType));
+  }
+  VkDescriptorSetLayout descrSetLayout{};
+  createDescriptorSetLayout(
+      device_, bindings.data(), bindings.size(), &descrSetLayout);
+  descriptorSetLayouts_.emplace(descrTypes, descrSetLayout);
+  return descrSetLayout;
+}
+
+void createDescriptorPool(
+    VkDevice device,
+    const VkDescriptorPoolSize* poolSizes,
+    uint32_t poolSizeCount,
+    uint32_t maxSets,
+    VkDescriptorPool* descriptorPool);
+
+VkDescriptorSet VContext::allocateDescriptorSet(
+    VkDescriptorSetLayout descrSetLayout) const {
+  if (descriptorSetsInPool_ == kDescriptorSetsPerPool) {
+    descriptorPoolIndex_++;
+    descriptorSetsInPool_ = 0;
+  }
+  if (descriptorPoolIndex_ == descriptorPools_.size()) {
+    // Every set fits in a pool with kMaxDescriptorsPerSet descriptors of each
+    // type per set.
+    const uint32_t descrCount = kDescriptorSetsPerPool * kMaxDescriptorsPerSet;
+    VkDescriptorPoolSize poolSizes[] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, descrCount},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, descrCount},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descrCount},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, descrCount}};
+    VkDescriptorPool descrPool{};
+    createDescriptorPool(
+        device_,
+        poolSizes,
+        4 /* poolSizeCount */,
+        kDescriptorSetsPerPool,
+        &descrPool);
+    descriptorPools_.push_back(descrPool);
+  }
+  VkDescriptorSet descrSet{};
+  ::at::native::vulkan::detail::allocateDescriptorSet(
+      device_,
+      descriptorPools_[descriptorPoolIndex_],
+      &descrSetLayout,
+      &descrSet);
+  descriptorSetsInPool_++;
+  return descrSet;
+}
+
+bool VContext::acquireBuffer(
+    VkDeviceSize size,
+    VkBufferUsageFlags usage,
+    BufferResource* resource) const {
+  auto it = cachedBuffers_.find(BufferKey{size, usage});
+  if (it == cachedBuffers_.end() || it->second.empty()) {
+    return false;
+  }
+  *resource = it->second.back();
+  it->second.pop_back();
+  return true;
+}
+
+void VContext::releaseBuffer(
+    VkDeviceSize size,
+    VkBufferUsageFlags usage,
+    BufferResource resource) const {
+  pendingBuffers_.emplace_back(BufferKey{size, usage}, resource);
+  if (!recording_) {
+    recycleResources();
+  }
+}
+
+bool VContext::acquireImage(ImageSize size, ImageResource* resource) const {
+  auto it = cachedImages_.find(size);
+  if (it == cachedImages_.end() || it->second.empty()) {
+    return false;
+  }
+  *resource = it->second.back();
+  it->second.pop_back();
+  return true;
+}
+
+void VContext::releaseImage(ImageSize size, ImageResource resource) const {
+  pendingImages_.emplace_back(size, resource);
+  if (!recording_) {
+    recycleResources();
+  }
+}
+
+void VContext::recycleResources() const {
+  for (const auto& pending : pendingBuffers_) {
+    auto& cached = cachedBuffers_[pending.first];
+    if (cached.size() < kMaxCachedResourcesPerSize) {
+      cached.push_back(pending.second);
+    } else {
+      destroyBufferResource(device_, pending.second);
+    }
+  }
+  pendingBuffers_.clear();
+  for (const auto& pending : pendingImages_) {
+    auto& cached = cachedImages_[pending.first];
+    if (cached.size() < kMaxCachedResourcesPerSize) {
+      cached.push_back(pending.second);
+    } else {
+      destroyImageResource(device_, pending.second);
+    }
+  }
+  pendingImages_.clear();
 }
 
 static std::unique_ptr<VContext> gContext;
@@ -301,7 +524,15 @@ VBuffer::VBuffer(
     VkDeviceSize bufferSizeBytes,
     VkBufferUsageFlags bufferUsageFlags,
     VkDescriptorType descriptorType)
-    : bufferSizeBytes_(bufferSizeBytes), descriptorType_(descriptorType) {
+    : bufferSizeBytes_(bufferSizeBytes),
+      bufferUsageFlags_(bufferUsageFlags),
+      descriptorType_(descriptorType) {
+  VContext::BufferResource resource{};
+  if (context().acquireBuffer(bufferSizeBytes_, bufferUsageFlags_, &resource)) {
+    buffer_ = resource.buffer;
+    bufferMemory_ = resource.memory;
+    return;
+  }
   auto device = context().device();
   auto physicalDevice = context().physicalDevice();
   VkBufferCreateInfo bufferCreateInfo{};
@@ -324,12 +555,48 @@ VBuffer::VBuffer(
   VK_CHECK(vkBindBufferMemory(device, buffer_, bufferMemory_, 0));
 }
 
+VBuffer::VBuffer(VBuffer&& other) noexcept
+    : bufferSizeBytes_(other.bufferSizeBytes_),
+      bufferUsageFlags_(other.bufferUsageFlags_),
+      descriptorType_(other.descriptorType_),
+      buffer_(other.buffer_),
+      bufferMemory_(other.bufferMemory_) {
+  other.buffer_ = VK_NULL_HANDLE;
+  other.bufferMemory_ = VK_NULL_HANDLE;
+}
+
+VBuffer& VBuffer::operator=(VBuffer&& other) noexcept {
+  if (this != &other) {
+    release();
+    bufferSizeBytes_ = other.bufferSizeBytes_;
+    bufferUsageFlags_ = other.bufferUsageFlags_;
+    descriptorType_ = other.descriptorType_;
+    buffer_ = other.buffer_;
+    bufferMemory_ = other.bufferMemory_;
+    other.buffer_ = VK_NULL_HANDLE;
+    other.bufferMemory_ = VK_NULL_HANDLE;
+  }
+  return *this;
+}
+
 VBuffer::~VBuffer() {
-  vkFreeMemory(context().device(), bufferMemory_, nullptr);
-  vkDestroyBuffer(context().device(), buffer_, nullptr);
+  release();
+}
+
+void VBuffer::release() {
+  if (buffer_ == VK_NULL_HANDLE) {
+    return;
+  }
+  // The recorded ops may still use the buffer, the context frees or reuses it
+  // once they are done.
+  context().releaseBuffer(
+      bufferSizeBytes_, bufferUsageFlags_, {buffer_, bufferMemory_});
+  buffer_ = VK_NULL_HANDLE;
+  bufferMemory_ = VK_NULL_HANDLE;
 }
 
 void VBuffer::copy_from_device_to_host(void* outputData, int64_t size) {
+  context().flush();
   auto mm = map();
   TORCH_INTERNAL_ASSERT(mm.ptr(), "Vulkan: Failed to map Vulkan Buffer memory");
   ::memcpy(outputData, mm.ptr(), size);
@@ -414,6 +681,15 @@ void VBuffer::addBufferMemoryBarrier(
 
 VImage::VImage(ImageSize imageSize, ImageSize dataSize)
     : imageSize_(imageSize), dataSize_(dataSize) {
+  VContext::ImageResource resource{};
+  if (context().acquireImage(imageSize_, &resource)) {
+    image_ = resource.image;
+    imageMemory_ = resource.memory;
+    imageView_ = resource.view;
+    sampler_ = resource.sampler;
+    imageLayout_ = resource.layout;
+    return;
+  }
   auto device = context().device();
   auto physicalDevice = context().physicalDevice();
 
@@ -459,11 +735,45 @@ VImage::VImage(ImageSize imageSize, ImageSize dataSize)
   VK_CHECK(vkCreateSampler(device, &samplerCreateInfo, nullptr, &sampler_));
 }
 
+VImage::VImage(VImage&& other) noexcept
+    : imageSize_(other.imageSize_),
+      dataSize_(other.dataSize_),
+      image_(other.image_),
+      imageMemory_(other.imageMemory_),
+      imageView_(other.imageView_),
+      sampler_(other.sampler_),
+      imageLayout_(other.imageLayout_) {
+  other.image_ = VK_NULL_HANDLE;
+}
+
+VImage& VImage::operator=(VImage&& other) noexcept {
+  if (this != &other) {
+    release();
+    imageSize_ = other.imageSize_;
+    dataSize_ = other.dataSize_;
+    image_ = other.image_;
+    imageMemory_ = other.imageMemory_;
+    imageView_ = other.imageView_;
+    sampler_ = other.sampler_;
+    imageLayout_ = other.imageLayout_;
+    other.image_ = VK_NULL_HANDLE;
+  }
+  return *this;
+}
+
 VImage::~VImage() {
-  vkFreeMemory(context().device(), imageMemory_, nullptr);
-  vkDestroySampler(context().device(), sampler_, nullptr);
-  vkDestroyImageView(context().device(), imageView_, nullptr);
-  vkDestroyImage(context().device(), image_, nullptr);
+  release();
+}
+
+void VImage::release() {
+  if (image_ == VK_NULL_HANDLE) {
+    return;
+  }
+  // Keeps the layout, so that the barriers of the next user of the image
+  // start from it.
+  context().releaseImage(
+      imageSize_, {image_, imageMemory_, imageView_, sampler_, imageLayout_});
+  image_ = VK_NULL_HANDLE;
 }
 
 VkImageViewCreateInfo VImage::makeImageViewCreateInfo() const {
@@ -679,27 +989,15 @@ void createDescriptorSetLayoutSinglePool(
     VkDevice device,
     std::vector<VkDescriptorType> descrTypes,
     VkDescriptorSetLayout* descrSetLayout,
-    VkDescriptorPool* descrPool,
     VkDescriptorSet* descrSet) {
-  auto size = descrTypes.size();
-  std::vector<VkDescriptorSetLayoutBinding> bindings;
-  std::vector<VkDescriptorPoolSize> poolSizes;
-  uint32_t i = 0;
-  for (const auto& descrType : descrTypes) {
-    bindings.push_back(descriptorSetLayoutBinding(i, descrType));
-    poolSizes.push_back(VkDescriptorPoolSize{descrType, 1});
-    i++;
-  }
-  createDescriptorSetLayout(device, bindings.data(), size, descrSetLayout);
-  createDescriptorPool(
-      device, poolSizes.data(), size, 1 /* maxSets */, descrPool);
-  allocateDescriptorSet(device, *descrPool, descrSetLayout, descrSet);
+  *descrSetLayout = context().descriptorSetLayout(descrTypes);
+  *descrSet = context().allocateDescriptorSet(*descrSetLayout);
 }
 
 ComputeUnit::~ComputeUnit() {
-  vkDestroyShaderModule(context().device(), computeShaderModule_, nullptr);
-  vkDestroyPipelineLayout(context().device(), pipelineLayout_, nullptr);
-  vkDestroyPipeline(context().device(), pipeline_, nullptr);
+  vkDestroyShaderModule(device_, computeShaderModule_, nullptr);
+  vkDestroyPipelineLayout(device_, pipelineLayout_, nullptr);
+  vkDestroyPipeline(device_, pipeline_, nullptr);
 }
 
 void ComputeUnit::createComputePipeline(
@@ -707,7 +1005,8 @@ void ComputeUnit::createComputePipeline(
     const uint32_t codeSize,
     const VkDescriptorSetLayout& descrSetLayout,
     WorkGroupSize& workGroupSize) {
-  auto device = context().device();
+  device_ = context().device();
+  auto device = device_;
   VkShaderModuleCreateInfo createInfo{};
   createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
   createInfo.pCode = code;
@@ -799,22 +1098,7 @@ void ComputeUnit::createComputePipelineCompile(
 #endif
 
 void ComputeUnit::createCommandBuffer(VkDescriptorSet& descriptorSet) {
-  auto device = context().device();
-  VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
-  commandBufferAllocateInfo.sType =
-      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  commandBufferAllocateInfo.commandPool = context().commandPool();
-  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  commandBufferAllocateInfo.commandBufferCount = 1;
-
-  VK_CHECK(vkAllocateCommandBuffers(
-      device, &commandBufferAllocateInfo, &commandBuffer_));
-
-  VkCommandBufferBeginInfo beginInfo{};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-  VK_CHECK(vkBeginCommandBuffer(commandBuffer_, &beginInfo));
-
+  commandBuffer_ = context().recordingCommandBuffer();
   vkCmdBindPipeline(commandBuffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
   vkCmdBindDescriptorSets(
       commandBuffer_,
@@ -858,7 +1142,11 @@ void ComputeUnit::dispatchCommandBuffer(
 }
 
 void ComputeUnit::endCommandBuffer() {
-  VK_CHECK(vkEndCommandBuffer(commandBuffer_));
+  addMemoryBarrier(
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_WRITE_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
 }
 
 void ComputeUnit::dispatchCommandBuffer(
@@ -872,23 +1160,44 @@ void ComputeUnit::dispatchCommandBuffer(
       UP_DIV(gridZ, workGroupSize.z));
 }
 
-void ComputeUnit::submitAndWaitCommandBuffer() {
-  VkSubmitInfo submitInfo{};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer_;
-
-  VkFence fence;
-  VkFenceCreateInfo fenceCreateInfo{};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceCreateInfo.flags = 0;
-  VK_CHECK(vkCreateFence(context().device(), &fenceCreateInfo, NULL, &fence))
-
-  VK_CHECK(vkQueueSubmit(context().queue(), 1, &submitInfo, fence));
-  vkWaitForFences(context().device(), 1, &fence, VK_TRUE, kFenceTimeoutNanos);
-
-  vkDestroyFence(context().device(), fence, NULL);
+#ifdef USE_VULKAN_SHADERC_RUNTIME
+ComputeUnit& ComputeUnitFactory::get(
+    const char* glslSrc,
+    const VkDescriptorSetLayout& descrSetLayout,
+    WorkGroupSize workGroupSize) {
+  const Key key{glslSrc,
+                descrSetLayout,
+                workGroupSize.x,
+                workGroupSize.y,
+                workGroupSize.z};
+  auto it = computeUnits_.find(key);
+  if (it != computeUnits_.end()) {
+    return *it->second;
+  }
+  auto computeUnit =
+      std::make_unique<ComputeUnit>(glslSrc, descrSetLayout, workGroupSize);
+  return *computeUnits_.emplace(key, std::move(computeUnit)).first->second;
+}
+#else
+ComputeUnit& ComputeUnitFactory::get(
+    const uint32_t* spvCode,
+    const unsigned int spvCodeSize,
+    const VkDescriptorSetLayout& descrSetLayout,
+    WorkGroupSize workGroupSize) {
+  const Key key{spvCode,
+                descrSetLayout,
+                workGroupSize.x,
+                workGroupSize.y,
+                workGroupSize.z};
+  auto it = computeUnits_.find(key);
+  if (it != computeUnits_.end()) {
+    return *it->second;
+  }
+  auto computeUnit = std::make_unique<ComputeUnit>(
+      spvCode, spvCodeSize, descrSetLayout, workGroupSize);
+  return *computeUnits_.emplace(key, std::move(computeUnit)).first->second;
 }
+#endif
 
 VBuffer makeUniformConstBuffer(void* ptr, VkDeviceSize size) {
   VBuffer constBuffer = VBuffer::makeUniformBuffer(size);
@@ -909,30 +1218,23 @@ void copy_buffer_to_image(const VBuffer& buffer, VImage& image) {
       makeUniformConstBuffer((void*)&constBlock, sizeof(constBlock));
 
   VkDescriptorSetLayout descrSetLayout{};
-  VkDescriptorSetLayoutBinding bindings[] = {
-      descriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
-      descriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
-      descriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)};
-  createDescriptorSetLayout(
-      device, bindings, 3 /* bindingsCount */, &descrSetLayout);
-
-  VkDescriptorPool descrPool{};
-  VkDescriptorPoolSize poolSizes[] = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
-                                      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
-                                      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}};
-  createDescriptorPool(
-      device, poolSizes, 3 /* poolSizeCount */, 1 /* maxSets */, &descrPool);
-
   VkDescriptorSet descrSet{};
-  allocateDescriptorSet(device, descrPool, &descrSetLayout, &descrSet);
+  createDescriptorSetLayoutSinglePool(
+      device,
+      {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},
+      &descrSetLayout,
+      &descrSet);
 
   image.bindStorageImage(descrSet, 0);
   buffer.bind(descrSet, 1);
   constBuffer.bind(descrSet, 2);
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit{at::native::vulkan::GLSL_SPV(nchw_to_image),
-                          descrSetLayout,
-                          workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(nchw_to_image),
+      descrSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descrSet);
 
   image.addImageMemoryBarrierToGeneral(computeUnit.commandBuffer());
@@ -946,10 +1248,6 @@ void copy_buffer_to_image(const VBuffer& buffer, VImage& image) {
   computeUnit.dispatchCommandBuffer(
       image.w(), image.h(), image.d(), workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-
-  vkDestroyDescriptorPool(device, descrPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descrSetLayout, nullptr);
 }
 
 void copy_image_to_buffer(
@@ -970,32 +1268,24 @@ void copy_image_to_buffer(
       makeUniformConstBuffer((void*)&constBlock, sizeof(constBlock));
 
   VkDescriptorSetLayout descrSetLayout{};
-  VkDescriptorSetLayoutBinding bindings[] = {
-      descriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
-      descriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
-      descriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)};
-  createDescriptorSetLayout(
-      device, bindings, 3 /* bindingsCount */, &descrSetLayout);
-
-  VkDescriptorPool descrPool{};
-  VkDescriptorPoolSize poolSizes[] = {
-      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
-      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
-      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}};
-  createDescriptorPool(
-      device, poolSizes, 3 /* poolSizeCount */, 1 /* maxSets */, &descrPool);
-
   VkDescriptorSet descrSet{};
-  allocateDescriptorSet(device, descrPool, &descrSetLayout, &descrSet);
+  createDescriptorSetLayoutSinglePool(
+      device,
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},
+      &descrSetLayout,
+      &descrSet);
 
   image.bindShaderRead(descrSet, 0);
   buffer.bind(descrSet, 1);
   constBuffer.bind(descrSet, 2);
 
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit{at::native::vulkan::GLSL_SPV(image_to_nchw),
-                          descrSetLayout,
-                          workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(image_to_nchw),
+      descrSetLayout,
+      workGroupSize);
 
   computeUnit.createCommandBuffer(descrSet);
   image.addImageMemoryBarrierToShaderRead(computeUnit.commandBuffer());
@@ -1010,10 +1300,6 @@ void copy_image_to_buffer(
         VK_ACCESS_HOST_READ_BIT);
   }
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-
-  vkDestroyDescriptorPool(device, descrPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descrSetLayout, nullptr);
 } // VBuffer <-> VImage
 
 // VulkanTensor
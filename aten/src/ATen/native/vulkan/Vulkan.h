@@ -3,7 +3,9 @@
 #include <c10/util/Optional.h>
 #include <array>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #ifdef USE_VULKAN_WRAPPER
@@ -30,6 +32,7 @@ bool is_available();
 
 class VContext;
 const VContext& context();
+class ComputeUnitFactory;
 
 // VulkanTensor is a handle that holds shared pointer to VulkanTensor:Impl,
 // that owns Tensor representation on GPU.
@@ -157,6 +160,9 @@ class VContext final {
   inline VkPhysicalDeviceLimits limits() const {
     return physicalDeviceLimits_;
   }
+  inline uint32_t vendorID() const {
+    return vendorID_;
+  }
   inline VkCommandPool commandPool() const {
     return commandPool_;
   }
@@ -164,22 +170,88 @@ class VContext final {
     return queue_;
   }
 
+  // Ops are not submitted one by one: they are all recorded into a single
+  // command buffer, started by the first op after the previous flush.
+  VkCommandBuffer recordingCommandBuffer() const;
+  // Submits the recorded ops and waits for them, it has to be called before
+  // the host reads the memory they write. The resources released while the
+  // ops were pending are recycled once they are done.
+  void flush() const;
+
+  // Descriptor set layouts are shared by the ops with the same bindings, the
+  // descriptor sets are allocated from pools reset on flush().
+  VkDescriptorSetLayout descriptorSetLayout(
+      const std::vector<VkDescriptorType>& descrTypes) const;
+  VkDescriptorSet allocateDescriptorSet(
+      VkDescriptorSetLayout descrSetLayout) const;
+
+  inline ComputeUnitFactory& computeUnitFactory() const {
+    return *computeUnitFactory_;
+  }
+
+  // The buffers and images of the same size are recycled instead of being
+  // freed, acquire*() return false if none is available.
+  struct BufferResource {
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+  };
+  struct ImageResource {
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;
+    VkSampler sampler;
+    VkImageLayout layout;
+  };
+  bool acquireBuffer(
+      VkDeviceSize size,
+      VkBufferUsageFlags usage,
+      BufferResource* resource) const;
+  void releaseBuffer(
+      VkDeviceSize size,
+      VkBufferUsageFlags usage,
+      BufferResource resource) const;
+  bool acquireImage(ImageSize size, ImageResource* resource) const;
+  void releaseImage(ImageSize size, ImageResource resource) const;
+
  private:
+  static constexpr uint32_t kDescriptorSetsPerPool = 256;
+  static constexpr uint32_t kMaxDescriptorsPerSet = 8;
+  static constexpr size_t kMaxCachedResourcesPerSize = 4;
+  using BufferKey = std::pair<VkDeviceSize, VkBufferUsageFlags>;
+
   void createInstance();
   void findPhysicalDevice();
   void createDevice();
   uint32_t getComputeQueueFamilyIndex();
+  void recycleResources() const;
 
   VkInstance instance_;
   VkDebugReportCallbackEXT debugReportCallback_;
   VkDevice device_;
   VkPhysicalDevice physicalDevice_;
   VkPhysicalDeviceLimits physicalDeviceLimits_;
+  uint32_t vendorID_;
   std::vector<const char*> enabledValidationLayers_;
   VkQueue queue_;
   uint32_t queueFamilyIndex_;
   bool enableValidationLayers_;
   VkCommandPool commandPool_;
+  VkFence fence_;
+
+  // The state of the recording, the caches and the resources to recycle.
+  // Need to be mutable as the ops only get the const VContext of context().
+  mutable VkCommandBuffer commandBuffer_;
+  mutable bool recording_;
+  mutable std::vector<VkDescriptorPool> descriptorPools_;
+  mutable size_t descriptorPoolIndex_;
+  mutable uint32_t descriptorSetsInPool_;
+  mutable std::map<std::vector<VkDescriptorType>, VkDescriptorSetLayout>
+      descriptorSetLayouts_;
+  std::unique_ptr<ComputeUnitFactory> computeUnitFactory_;
+  mutable std::vector<std::pair<BufferKey, BufferResource>> pendingBuffers_;
+  mutable std::vector<std::pair<ImageSize, ImageResource>> pendingImages_;
+  mutable std::map<BufferKey, std::vector<BufferResource>> cachedBuffers_;
+  mutable std::map<ImageSize, std::vector<ImageResource>> cachedImages_;
 };
 
 class VBuffer final {
@@ -228,8 +300,8 @@ class VBuffer final {
 
   VBuffer(const VBuffer&) = delete;
   VBuffer& operator=(const VBuffer&) = delete;
-  VBuffer(VBuffer&&) = default;
-  VBuffer& operator=(VBuffer&&) = default;
+  VBuffer(VBuffer&& other) noexcept;
+  VBuffer& operator=(VBuffer&& other) noexcept;
 
   static inline VBuffer makeUniformBuffer(VkDeviceSize bufferSize) {
     return VBuffer{bufferSize,
@@ -241,6 +313,7 @@ class VBuffer final {
     return MapMemory{context().device(), bufferMemory_, 0, bufferSizeBytes_};
   }
 
+  // Flushes the recorded ops before reading.
   void copy_from_device_to_host(void* outputData, int64_t size);
   void copy_from_host_to_device(const void* data, int64_t size);
   void set_zeros();
@@ -263,7 +336,10 @@ class VBuffer final {
       VkDeviceSize size) const;
 
  private:
+  void release();
+
   VkDeviceSize bufferSizeBytes_;
+  VkBufferUsageFlags bufferUsageFlags_;
   VkDescriptorType descriptorType_;
   VkBuffer buffer_;
   VkDeviceMemory bufferMemory_;
@@ -286,8 +362,8 @@ class VImage final {
   ~VImage();
   VImage(const VImage&) = delete;
   VImage& operator=(const VImage&) = delete;
-  VImage(VImage&&) = default;
-  VImage& operator=(VImage&&) = default;
+  VImage(VImage&& other) noexcept;
+  VImage& operator=(VImage&& other) noexcept;
 
   inline auto w() const {
     return imageSize_[0];
@@ -335,6 +411,8 @@ class VImage final {
   void addImageMemoryBarrierToShaderRead(VkCommandBuffer commandBuffer) const;
 
  private:
+  void release();
+
   ImageSize imageSize_;
   ImageSize dataSize_;
   VkImage image_;
@@ -370,11 +448,12 @@ void allocateDescriptorSet(
     const VkDescriptorSetLayout* descriptorSetLayout,
     VkDescriptorSet* descriptorSet);
 
+// Gets the shared layout for descrTypes and allocates a descriptor set of it,
+// both are owned by the context.
 void createDescriptorSetLayoutSinglePool(
     VkDevice device,
     std::vector<VkDescriptorType> descrTypes,
     VkDescriptorSetLayout* descrSetLayout,
-    VkDescriptorPool* descrPool,
     VkDescriptorSet* descrSet);
 
 struct WorkGroupSize {
@@ -438,19 +517,47 @@ class ComputeUnit final {
       uint32_t gridY,
       uint32_t gridZ,
       WorkGroupSize workGroupSize);
-  void submitAndWaitCommandBuffer();
+  // Ends the recording of the op with a barrier making its writes visible to
+  // the next ops, the commands are submitted by VContext::flush().
   void endCommandBuffer();
   inline VkCommandBuffer commandBuffer() {
     return commandBuffer_;
   }
 
  private:
+  VkDevice device_;
   VkCommandBuffer commandBuffer_;
   VkPipeline pipeline_;
   VkPipelineLayout pipelineLayout_;
   VkShaderModule computeShaderModule_;
 };
 
+// Keeps the pipelines of the ops, created on their first run.
+class ComputeUnitFactory final {
+ public:
+  ComputeUnitFactory() = default;
+  ComputeUnitFactory(const ComputeUnitFactory&) = delete;
+  ComputeUnitFactory& operator=(const ComputeUnitFactory&) = delete;
+
+#ifdef USE_VULKAN_SHADERC_RUNTIME
+  ComputeUnit& get(
+      const char* glslSrc,
+      const VkDescriptorSetLayout& descrSetLayout,
+      WorkGroupSize workGroupSize);
+#else
+  ComputeUnit& get(
+      const uint32_t* spvCode,
+      const unsigned int spvCodeSize,
+      const VkDescriptorSetLayout& descrSetLayout,
+      WorkGroupSize workGroupSize);
+#endif
+
+ private:
+  using Key = std::
+      tuple<const void*, VkDescriptorSetLayout, uint32_t, uint32_t, uint32_t>;
+  std::map<Key, std::unique_ptr<ComputeUnit>> computeUnits_;
+};
+
 std::ostream& operator<<(std::ostream& s, const WorkGroupSize& workGroupSize);
 std::ostream& operator<<(std::ostream& s, const ImageSize& imageSize);
 std::ostream& operator<<(std::ostream& s, const ImageSizes& imageSizes);
@@ -41,7 +41,6 @@ void upsample_nearest2d(
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -51,7 +50,6 @@ void upsample_nearest2d(
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -59,16 +57,14 @@ void upsample_nearest2d(
   constBuffer.bind(descriptorSet, 2);
 
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit{at::native::vulkan::GLSL_SPV(upsampleNearest2d),
-                          descriptorSetLayout,
-                          workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(upsampleNearest2d),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   input.image()->addImageMemoryBarrierToShaderRead(computeUnit.commandBuffer());
   computeUnit.dispatchCommandBuffer(OW, OH, C, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void add(
@@ -102,7 +98,6 @@ void add(
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -113,7 +108,6 @@ void add(
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -122,8 +116,10 @@ void add(
   constBuffer.bind(descriptorSet, 3);
 
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit{
-      at::native::vulkan::GLSL_SPV(add), descriptorSetLayout, workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(add),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   output.image()->addImageMemoryBarrierToGeneral(commandBuffer);
@@ -131,9 +127,6 @@ void add(
   input1.image()->addImageMemoryBarrierToShaderRead(commandBuffer);
   computeUnit.dispatchCommandBuffer(W, H, C, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 VBuffer kernelNCHW_OCHW_repack_O4C4HWi4o4(
@@ -233,7 +226,6 @@ void conv2d_depthwise(
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -246,7 +238,6 @@ void conv2d_depthwise(
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -256,10 +247,10 @@ void conv2d_depthwise(
   constBuffer.bind(descriptorSet, 4);
 
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit =
-      ComputeUnit{at::native::vulkan::GLSL_SPV(conv2d_dw_clamp),
-                  descriptorSetLayout,
-                  workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(conv2d_dw_clamp),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   output.image()->addImageMemoryBarrierToGeneral(commandBuffer);
@@ -268,10 +259,6 @@ void conv2d_depthwise(
   computeUnit.dispatchCommandBuffer(
       params.OW, params.OH, params.OC_4, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void conv2d_depthwise(
@@ -345,7 +332,6 @@ void conv2d_prepack_weights_to_image(
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -355,7 +341,6 @@ void conv2d_prepack_weights_to_image(
       context().device(),
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   image.bindStorageImage(descriptorSet, 0);
@@ -363,9 +348,10 @@ void conv2d_prepack_weights_to_image(
   constBuffer.bind(descriptorSet, 2);
 
   WorkGroupSize workGroupSize{1, 1, 1};
-  ComputeUnit computeUnit{at::native::vulkan::GLSL_SPV(KO4C4HW_to_image),
-                          descriptorSetLayout,
-                          workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(KO4C4HW_to_image),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   image.addImageMemoryBarrierToGeneral(commandBuffer);
@@ -378,10 +364,6 @@ void conv2d_prepack_weights_to_image(
       VK_ACCESS_SHADER_READ_BIT);
   computeUnit.dispatchCommandBuffer(C_4, OC_4, KH * KW, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(context().device(), descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(
-      context().device(), descriptorSetLayout, nullptr);
 }
 
 VImage conv2d_prepack_weights_image(
@@ -407,6 +389,23 @@ void conv2d_prepack_weights(
       *(output.image(imageSizes)), weight, OC, C, KH, KW);
 }
 
+static constexpr uint32_t kVendorIDArm = 0x13B5;
+
+bool conv2d_is_pointwise(const Conv2DParams& params) {
+  return params.KH == 1 && params.KW == 1 && params.SY == 1 &&
+      params.SX == 1 && params.PY == 0 && params.PX == 0;
+}
+
+WorkGroupSize conv2d_pointwise_workGroupSize() {
+  // The invocations of a work group run on the same Mali shader core and
+  // share its texture cache: spreading the group over 4 output channel
+  // blocks reads each input texel once for the 4 of them.
+  if (context().vendorID() == kVendorIDArm) {
+    return {4, 4, 4};
+  }
+  return {8, 8, 1};
+}
+
 void conv2d(
     VulkanTensor& output,
     const VulkanTensor& input,
@@ -451,7 +450,6 @@ void conv2d(
 
   auto device = context().device();
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -463,7 +461,6 @@ void conv2d(
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -472,10 +469,20 @@ void conv2d(
   biasBuffer.bind(descriptorSet, 3);
   constBuffer.bind(descriptorSet, 4);
 
-  WorkGroupSize workGroupSize{1, 1, params.OC_4};
-  ComputeUnit computeUnit{at::native::vulkan::GLSL_SPV(conv2d_nogroup_clamp),
-                          descriptorSetLayout,
-                          workGroupSize};
+  // The shader variant is selected by the kernel size, 1x1 convolutions
+  // skip the kernel window loops.
+  const bool pointwise = conv2d_is_pointwise(params);
+  WorkGroupSize workGroupSize = pointwise ? conv2d_pointwise_workGroupSize()
+                                          : WorkGroupSize{1, 1, params.OC_4};
+  auto& computeUnit = pointwise
+      ? context().computeUnitFactory().get(
+            at::native::vulkan::GLSL_SPV(conv2d_pw_clamp),
+            descriptorSetLayout,
+            workGroupSize)
+      : context().computeUnitFactory().get(
+            at::native::vulkan::GLSL_SPV(conv2d_nogroup_clamp),
+            descriptorSetLayout,
+            workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   output.image()->addImageMemoryBarrierToGeneral(commandBuffer);
@@ -486,10 +493,6 @@ void conv2d(
       UP_DIV(params.OH, workGroupSize.y),
       UP_DIV(params.OC_4, workGroupSize.z));
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void conv2d(
@@ -625,7 +628,6 @@ void clamp(
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -635,7 +637,6 @@ void clamp(
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -643,17 +644,16 @@ void clamp(
   constBuffer.bind(descriptorSet, 2);
 
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit{
-      at::native::vulkan::GLSL_SPV(clamp), descriptorSetLayout, workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(clamp),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   output.image()->addImageMemoryBarrierToGeneral(commandBuffer);
   input.image()->addImageMemoryBarrierToShaderRead(commandBuffer);
   computeUnit.dispatchCommandBuffer(W, H, C, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void addmm(
@@ -708,7 +708,6 @@ void addmm(
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -720,7 +719,6 @@ void addmm(
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -730,8 +728,10 @@ void addmm(
   constBuffer.bind(descriptorSet, 4);
 
   WorkGroupSize workGroupSize{8, 8, 1};
-  ComputeUnit computeUnit{
-      at::native::vulkan::GLSL_SPV(addmm), descriptorSetLayout, workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(addmm),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   output.image()->addImageMemoryBarrierToGeneral(commandBuffer);
@@ -740,9 +740,6 @@ void addmm(
   t.image()->addImageMemoryBarrierToShaderRead(commandBuffer);
   computeUnit.dispatchCommandBuffer(OW, OH, C_4, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void mean(VulkanTensor& output, const VulkanTensor& input) {
@@ -765,7 +762,6 @@ void mean(VulkanTensor& output, const VulkanTensor& input) {
   VBuffer constBuffer = makeUniformConstBuffer((void*)&cb, sizeof(cb));
 
   VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
   VkDescriptorSet descriptorSet{};
   std::vector<VkDescriptorType> descriptorTypes{
       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
@@ -775,7 +771,6 @@ void mean(VulkanTensor& output, const VulkanTensor& input) {
       device,
       descriptorTypes,
       &descriptorSetLayout,
-      &descriptorPool,
       &descriptorSet);
 
   output.image()->bindStorageImage(descriptorSet, 0);
@@ -783,17 +778,16 @@ void mean(VulkanTensor& output, const VulkanTensor& input) {
   constBuffer.bind(descriptorSet, 2);
 
   WorkGroupSize workGroupSize{1, 1, 1};
-  ComputeUnit computeUnit{
-      at::native::vulkan::GLSL_SPV(mean), descriptorSetLayout, workGroupSize};
+  auto& computeUnit = context().computeUnitFactory().get(
+      at::native::vulkan::GLSL_SPV(mean),
+      descriptorSetLayout,
+      workGroupSize);
   computeUnit.createCommandBuffer(descriptorSet);
   auto commandBuffer = computeUnit.commandBuffer();
   output.image()->addImageMemoryBarrierToGeneral(commandBuffer);
   input.image()->addImageMemoryBarrierToShaderRead(commandBuffer);
   computeUnit.dispatchCommandBuffer(1, 1, C_4, workGroupSize);
   computeUnit.endCommandBuffer();
-  computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 } // namespace detail
@@ -0,0 +1,58 @@
+#version 450 core
+layout(std430) buffer;
+layout(std430) uniform;
+layout(set = 0, rgba16f, binding = 0) writeonly highp uniform image3D uOutput;
+layout(set = 0, binding = 1) uniform highp sampler3D uInput;
+layout(set = 0, binding = 2) uniform highp sampler3D uKernel;
+layout(set = 0, binding = 3) readonly buffer bias {
+  vec4 data[];
+}
+uBias;
+layout(set = 0, binding = 4) uniform constBlock {
+  ivec2 padding;
+  ivec2 kernelSize;
+  ivec2 stride;
+  ivec2 dilate;
+  ivec4 outputSize;
+  ivec4 inputSize;
+  float outputMin;
+  float outputMax;
+}
+uConstBlock;
+
+layout(local_size_x_id = 1, local_size_y_id = 2, local_size_z_id = 3) in;
+
+// 1x1 convolution with unit stride and no padding: the output pixels read
+// the input pixels at the same position, without the kernel window loops and
+// bounds of conv2d_nogroup_clamp.
+void main() {
+  ivec3 pos = ivec3(gl_GlobalInvocationID) * ivec3(4, 1, 1);
+  if (all(lessThan(pos, uConstBlock.outputSize.xyz))) {
+    int inputWidth = uConstBlock.inputSize.x;
+    float m2 = pos.x + 1 < inputWidth ? 1.0 : 0.0;
+    float m3 = pos.x + 2 < inputWidth ? 1.0 : 0.0;
+    float m4 = pos.x + 3 < inputWidth ? 1.0 : 0.0;
+    vec4 color = uBias.data[pos.z];
+    vec4 color2 = color;
+    vec4 color3 = color;
+    vec4 color4 = color;
+    for (int fz = 0; fz < uConstBlock.inputSize.z; ++fz) {
+      int kX = 4 * fz;
+      mat4 k = mat4(
+          texelFetch(uKernel, ivec3(kX + 0, pos.z, 0), 0),
+          texelFetch(uKernel, ivec3(kX + 1, pos.z, 0), 0),
+          texelFetch(uKernel, ivec3(kX + 2, pos.z, 0), 0),
+          texelFetch(uKernel, ivec3(kX + 3, pos.z, 0), 0));
+      color += k * texelFetch(uInput, ivec3(pos.x, pos.y, fz), 0);
+      color2 += k * texelFetch(uInput, ivec3(pos.x + 1, pos.y, fz), 0) * m2;
+      color3 += k * texelFetch(uInput, ivec3(pos.x + 2, pos.y, fz), 0) * m3;
+      color4 += k * texelFetch(uInput, ivec3(pos.x + 3, pos.y, fz), 0) * m4;
+    }
+    vec4 outputMin = vec4(uConstBlock.outputMin);
+    vec4 outputMax = vec4(uConstBlock.outputMax);
+    imageStore(uOutput, ivec3(pos.x + 0, pos.y, pos.z), clamp(color, outputMin, outputMax));
+    imageStore(uOutput, ivec3(pos.x + 1, pos.y, pos.z), clamp(color2, outputMin, outputMax));
+    imageStore(uOutput, ivec3(pos.x + 2, pos.y, pos.z), clamp(color3, outputMin, outputMax));
+    imageStore(uOutput, ivec3(pos.x + 3, pos.y, pos.z), clamp(color4, outputMin, outputMax));
+  }
+}
@@ -62,6 +62,11 @@ Tensor allocate_padded_contiguous_if_needed(
   return padded_input.copy_(input);
 }
 
+Tensor to_channels_last_padded(const Tensor& input) {
+  return allocate_padded_contiguous_if_needed(
+      input, MemoryFormat::ChannelsLast);
+}
+
 } // namespace internal
 } // namespace xnnpack
 } // namespace native
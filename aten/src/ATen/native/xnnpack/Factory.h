@@ -22,6 +22,10 @@ at::Tensor empty_with_tail_padding(
     c10::MemoryFormat memory_format,
     DimnameList maybe_names);
 
+// Converts the input to NHWC in memory that the operators read without a
+// copy, so that a graph can keep its activations in this layout between them.
+Tensor to_channels_last_padded(const Tensor& input);
+
 } // namespace internal
 } // namespace xnnpack
 } // namespace native
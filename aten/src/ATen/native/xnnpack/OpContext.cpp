@@ -1,4 +1,5 @@
 #ifdef USE_XNNPACK
+#include <ATen/Context.h>
 #include <ATen/native/xnnpack/Convolution.h>
 #include <ATen/native/xnnpack/Linear.h>
 #include <ATen/native/xnnpack/OpContext.h>
@@ -27,6 +28,9 @@ XNNPackLinearOpContext::create_context(
               output_max ? output_max->to<float>()
                          : xnnpack::ContextLinear::kMax)
           );
+  if (at::globalContext().releaseWeightsWhenPrepacking()) {
+    linear_op_context->free_orig_weight_and_bias();
+  }
   return linear_op_context;
 }
 
@@ -66,6 +70,9 @@ XNNPackConv2dOpContext::create_context(at::Tensor&& weight,
           output_min,
           output_max,
           std::move(op_context));
+  if (at::globalContext().releaseWeightsWhenPrepacking()) {
+    conv2d_op_context->free_orig_weight_and_bias();
+  }
   return conv2d_op_context;
 }
 
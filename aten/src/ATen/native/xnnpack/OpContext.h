@@ -31,9 +31,22 @@ class LinearOpContext : public torch::jit::CustomClassHolder {
   c10::optional<Tensor> orig_bias_;
   c10::optional<Scalar> output_min_;
   c10::optional<Scalar> output_max_;
+  bool orig_weight_and_bias_freed_ = false;
+
+  // The weights are packed into the XNNPACK operator, the original ones are
+  // only needed to serialize the context again.
+  void free_orig_weight_and_bias() {
+    orig_weight_and_bias_freed_ = true;
+    orig_weight_.reset();
+    orig_bias_.reset();
+  }
 
  public:
   SerializationTypeLinearPrePack unpack() {
+    TORCH_CHECK(
+        !orig_weight_and_bias_freed_,
+        "Cannot unpack weights. "
+        "Call at::globalContext()::setReleaseWeightsWhenPrepacking(false) before packing or loading to enable unpacking.");
     return std::make_tuple(orig_weight_, orig_bias_, output_min_, output_max_);
   }
 
@@ -77,9 +90,22 @@ class Conv2dOpContext : public torch::jit::CustomClassHolder {
   int64_t groups_;
   c10::optional<Scalar> output_min_;
   c10::optional<Scalar> output_max_;
+  bool orig_weight_and_bias_freed_ = false;
+
+  // The weights are packed into the XNNPACK operator, the original ones are
+  // only needed to serialize the context again.
+  void free_orig_weight_and_bias() {
+    orig_weight_and_bias_freed_ = true;
+    orig_weight_.reset();
+    orig_bias_.reset();
+  }
 
  public:
   SerializationTypeConv2dPrePack unpack() {
+    TORCH_CHECK(
+        !orig_weight_and_bias_freed_,
+        "Cannot unpack weights. "
+        "Call at::globalContext()::setReleaseWeightsWhenPrepacking(false) before packing or loading to enable unpacking.");
     return std::make_tuple(
         orig_weight_,
         orig_bias_,
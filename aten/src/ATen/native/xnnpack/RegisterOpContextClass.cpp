@@ -2,6 +2,7 @@
 
 #include <torch/library.h>
 #include <ATen/native/xnnpack/Convolution.h>
+#include <ATen/native/xnnpack/Factory.h>
 #include <ATen/native/xnnpack/Linear.h>
 #include <ATen/native/xnnpack/OpContext.h>
 #include <ATen/Tensor.h>
@@ -55,6 +56,7 @@ TORCH_LIBRARY(prepacked, m) {
   m.def("linear_clamp_run(Tensor X, __torch__.torch.classes.xnnpack.LinearOpContext W_prepack) -> Tensor Y");
   m.def("conv2d_clamp_prepack(Tensor W, Tensor? B, int[2] stride, int[2] padding, int[2] dilation, int groups, Scalar? output_min=None, Scalar? output_max=None) -> __torch__.torch.classes.xnnpack.Conv2dOpContext");
   m.def("conv2d_clamp_run(Tensor X, __torch__.torch.classes.xnnpack.Conv2dOpContext W_prepack) -> Tensor Y");
+  m.def("to_channels_last_padded(Tensor(a) X) -> Tensor(a) Y");
 }
 
 TORCH_LIBRARY_IMPL(prepacked, CPU, m) {
@@ -62,6 +64,7 @@ TORCH_LIBRARY_IMPL(prepacked, CPU, m) {
   m.impl("linear_clamp_run", TORCH_FN(internal::linear::linear_clamp_run));
   m.impl("conv2d_clamp_prepack", TORCH_FN(createConv2dClampPrePackOpContext));
   m.impl("conv2d_clamp_run", TORCH_FN(internal::convolution2d::conv2d_clamp_run));
+  m.impl("to_channels_last_padded", TORCH_FN(internal::to_channels_last_padded));
 }
 
 } // namespace xnnpack
@@ -1,5 +1,6 @@
 #include <ATen/record_function.h>
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <random>
 
@@ -24,6 +25,24 @@ thread_local RecordFunctionCallbacks sorted_tls_callbacks_;
 
 std::atomic<int64_t> defaultNodeId(-1);
 
+// Number of RecordFunctions left to skip in this thread before the next
+// pre-sampled one
+thread_local int64_t sampling_tries_left_ = 0;
+// Sampling epoch of the global callbacks sampling_tries_left_ was drawn for,
+// 0 until drawn for the first time. The count is drawn again when the global
+// callbacks, and so their sampling probability, change.
+thread_local uint64_t sampling_epoch_ = 0;
+
+// Draws the number of RecordFunctions to skip before the next sampled one,
+// i.e. the number of failures before the first success of Bernoulli trials
+// with probability prob, in (0, 1)
+int64_t sample_geometric(double prob) {
+  static thread_local auto gen =
+      std::make_unique<std::mt19937>(std::random_device()());
+  std::geometric_distribution<int64_t> dist(prob);
+  return dist(*gen);
+}
+
 class CallbackManager {
  public:
   CallbackHandle addThreadLocalCallback(RecordFunctionCallback cb) {
@@ -37,6 +56,7 @@ class CallbackManager {
   CallbackHandle addGlobalCallback(RecordFunctionCallback cb) {
     auto handle = next_unique_callback_handle();
     sorted_global_callbacks_.emplace_back(std::move(cb), handle);
+    updateGlobalSampling();
     return handle;
   }
 
@@ -60,6 +80,7 @@ class CallbackManager {
     auto found = find_and_remove(sorted_tls_callbacks_);
     if (!found) {
       found = find_and_remove(sorted_global_callbacks_);
+      updateGlobalSampling();
     }
     if (!found) {
       LOG(WARNING) << "Requested callback is not found";
@@ -68,6 +89,7 @@ class CallbackManager {
 
   void clearGlobalCallbacks() {
     sorted_global_callbacks_.clear();
+    updateGlobalSampling();
   }
 
   void clearThreadLocalCallbacks() {
@@ -82,20 +104,48 @@ class CallbackManager {
     return !sorted_tls_callbacks_.empty();
   }
 
+  // Fast check run for every RecordFunction, see shouldRunRecordFunction
+  inline bool shouldRun(bool* pre_sampled) {
+    *pre_sampled = false;
+    if (!hasThreadLocalCallbacks()) {
+      if (!hasGlobalCallbacks() || !isRecordFunctionEnabled()) {
+        return false;
+      }
+      if (all_global_sampled_) {
+        if (max_global_sampling_prob_ == 0.0) {
+          return false;
+        }
+        if (sampling_epoch_ != global_sampling_epoch_) {
+          // first RecordFunction of this thread since the callbacks changed
+          sampling_tries_left_ = sample_geometric(max_global_sampling_prob_);
+          sampling_epoch_ = global_sampling_epoch_;
+        }
+        if (sampling_tries_left_ > 0) {
+          --sampling_tries_left_;
+          return false;
+        }
+        sampling_tries_left_ = sample_geometric(max_global_sampling_prob_);
+        *pre_sampled = true;
+      }
+      return true;
+    }
+    return isRecordFunctionEnabled();
+  }
+
   // init is called by RecordFunction in constructor to
   // determine which thread local and global callbacks are going
   // to be executed and whether any of them need inputs
-  inline void init(RecordFunction& rec_fn) {
+  inline void init(RecordFunction& rec_fn, bool pre_sampled) {
     auto scope = rec_fn.scope();
     bool found_active_cb = false;
     bool found_needs_inputs = false;
     bool found_needs_ids = false;
     auto init_handles = [
         scope, &found_active_cb, &found_needs_inputs, &found_needs_ids](
-          CallbackHandles& handles, RecordFunctionCallbacks& cbs) {
+          CallbackHandles& handles, RecordFunctionCallbacks& cbs, double pre_sampled_prob) {
       handles.clear();
       for (const auto& cb : cbs) {
-        if (cb.first.shouldRun(scope)) {
+        if (cb.first.shouldRun(scope, pre_sampled_prob)) {
           handles.push_back(cb.second);
           found_active_cb = true;
           if (cb.first.needsInputs()) {
@@ -108,8 +158,11 @@ class CallbackManager {
       }
     };
 
-    init_handles(rec_fn.sorted_active_tls_handles_, sorted_tls_callbacks_);
-    init_handles(rec_fn.sorted_active_global_handles_, sorted_global_callbacks_);
+    init_handles(rec_fn.sorted_active_tls_handles_, sorted_tls_callbacks_, 1.0);
+    init_handles(
+        rec_fn.sorted_active_global_handles_,
+        sorted_global_callbacks_,
+        pre_sampled ? max_global_sampling_prob_ : 1.0);
     rec_fn.active = found_active_cb;
     rec_fn.needs_inputs = found_needs_inputs;
     if (found_needs_ids && found_active_cb) {
@@ -144,6 +197,21 @@ class CallbackManager {
   }
 
  private:
+  // Recomputes whether all the global callbacks are sampled (and not decided
+  // by a should_run function), and their highest sampling probability
+  void updateGlobalSampling() {
+    ++global_sampling_epoch_;
+    all_global_sampled_ = !sorted_global_callbacks_.empty();
+    max_global_sampling_prob_ = 0.0;
+    for (const auto& cb : sorted_global_callbacks_) {
+      if (cb.first.samplingProb() >= 1.0 || cb.first.hasShouldRun()) {
+        all_global_sampled_ = false;
+      }
+      max_global_sampling_prob_ =
+          std::max(max_global_sampling_prob_, cb.first.samplingProb());
+    }
+  }
+
   bool tryRunCallback(
       const std::function<void(const RecordFunction&)>& fn,
       RecordFunction& rf) {
@@ -196,6 +264,12 @@ class CallbackManager {
 
   // Global callbacks; must be sorted in increasing handle order
   RecordFunctionCallbacks sorted_global_callbacks_;
+  // Whether all the global callbacks are sampled with sampling_probability < 1
+  bool all_global_sampled_ = false;
+  // Highest sampling_probability of the global callbacks
+  double max_global_sampling_prob_ = 0.0;
+  // Incremented whenever the global callbacks change, see sampling_epoch_
+  uint64_t global_sampling_epoch_ = 0;
 };
 
 // Enumerates thread ids logically;
@@ -243,6 +317,10 @@ bool hasCallbacks() {
   return m.hasGlobalCallbacks() || m.hasThreadLocalCallbacks();
 }
 
+bool shouldRunRecordFunction(bool* pre_sampled) {
+  return manager().shouldRun(pre_sampled);
+}
+
 bool hasGlobalCallbacks() {
   return manager().hasGlobalCallbacks();
 }
@@ -288,8 +366,9 @@ void enableRecordFunction(bool enable) {
 }
 
 RecordFunction::RecordFunction(RecordScope scope) : scope_(scope) {
-  if (hasCallbacks() && isRecordFunctionEnabled()) {
-    manager().init(*this);
+  bool pre_sampled = false;
+  if (shouldRunRecordFunction(&pre_sampled)) {
+    manager().init(*this, pre_sampled);
   }
 }
 
@@ -216,7 +216,9 @@ struct TORCH_API RecordFunction {
  *     function/range; NOTE: passing the inputs incurs an additional overhead;
  *   sampling_probability - if not 1.0, then the callback is probabilistically sampled
  *     to run; NOTE: start and end callbacks always run as a pair and are sampled
- *     together;
+ *     together; when all the callbacks are sampled global callbacks, the
+ *     RecordFunctions that are not sampled only pay for a thread local counter
+ *     decrement (see shouldRunRecordFunction);
  *   scopes - types of scopes to execute the callbacks on (see RecordScope);
  *     passing empty set means the callbacks will be executed for all possible
  *     scope types
@@ -245,7 +247,7 @@ class TORCH_API RecordFunctionCallback {
   }
 
   RecordFunctionCallback& samplingProb(double sampling_prob) {
-    TORCH_CHECK(sampling_prob >= 0.0 && sampling_prob_ <= 1.0,
+    TORCH_CHECK(sampling_prob >= 0.0 && sampling_prob <= 1.0,
         "Invalid sampling probability");
     sampling_prob_ = sampling_prob;
     return *this;
@@ -282,6 +284,10 @@ class TORCH_API RecordFunctionCallback {
     return sampling_prob_;
   }
 
+  inline bool hasShouldRun() const {
+    return static_cast<bool>(should_run_);
+  }
+
   inline bool checkScope(RecordScope sc) const {
     return scopes_[(size_t)sc];
   }
@@ -294,8 +300,11 @@ class TORCH_API RecordFunctionCallback {
     return end_;
   }
 
-  // whether this callbacks should run in the given scope
-  inline bool shouldRun(RecordScope scope) const {
+  // whether this callbacks should run in the given scope;
+  // pre_sampled_prob is the probability with which the RecordFunction was
+  // already sampled, the callback then runs with the remaining conditional
+  // probability
+  inline bool shouldRun(RecordScope scope, double pre_sampled_prob = 1.0) const {
     // first check whether this callback is interested in
     // the given scope type
     if (!checkScope(scope)) {
@@ -306,8 +315,9 @@ class TORCH_API RecordFunctionCallback {
       return should_run_(*this);
     }
     // otherwise potentially do the uniform sampling
-    if (sampling_prob_ != 1.0) {
-      return (sample_zero_one() < sampling_prob_);
+    double sampling_prob = sampling_prob_ / pre_sampled_prob;
+    if (sampling_prob < 1.0) {
+      return (sample_zero_one() < sampling_prob);
     }
     return true;
   }
@@ -430,6 +440,19 @@ TORCH_API void clearGlobalCallbacks();
 
 // for both thread local and global callbacks
 TORCH_API bool hasCallbacks();
+
+/**
+ * shouldRunRecordFunction returns whether a RecordFunction created now in this
+ * thread may run any callbacks; used by the RecordFunction constructor.
+ *
+ * When the only callbacks are global callbacks with sampling_probability < 1,
+ * the RecordFunctions are pre-sampled with the highest of their probabilities
+ * using a thread local counter of the RecordFunctions to skip, drawn from the
+ * geometric distribution, so that the skipped ones only pay for its decrement;
+ * pre_sampled is then set to true and each callback of a pre-sampled
+ * RecordFunction runs with its remaining conditional probability.
+ */
+TORCH_API bool shouldRunRecordFunction(bool* pre_sampled);
 TORCH_API void clearCallbacks(); // not thread safe
 
 /**
@@ -524,6 +524,13 @@ class CAFFE2_API Tensor {
     return impl_->requires_grad();
   }
 
+  /// Returns true if the Tensor is an inference tensor, that is, was created
+  /// in inference mode or is a view of an inference tensor.
+  /// See `at::InferenceMode`.
+  bool is_inference() const {
+    return impl_->is_inference();
+  }
+
   /// Return a mutable reference to the gradient. This is conventionally
   /// used as `t.grad() = x` to set a gradient to a completely new tensor.
   Tensor& grad() {
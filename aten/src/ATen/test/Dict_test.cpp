@@ -271,6 +271,38 @@ TEST(DictTest, givenConstDict_whenCallingFindOnNonExistingKey_thenReturnsEnd) {
   EXPECT_EQ(dict.end(), found);
 }
 
+TEST(DictTest, givenStringKeys_whenCallingFindWithStringView_thenFindsCorrectElement) {
+  Dict<string, int64_t> dict;
+  dict.insert("3", 3);
+  dict.insert("4", 4);
+  Dict<string, int64_t>::iterator found = dict.find(c10::string_view("3"));
+  EXPECT_EQ("3", found->key());
+  EXPECT_EQ(3, found->value());
+  EXPECT_EQ(dict.end(), dict.find(c10::string_view("5")));
+  EXPECT_EQ(found, dict.find(string("3")));
+}
+
+TEST(DictTest, givenStringKeys_whenCallingAtOrContainsWithStringView_thenReturnsCorrectResult) {
+  Dict<string, int64_t> dict;
+  dict.insert("3", 3);
+  dict.insert("4", 4);
+  EXPECT_EQ(4, dict.at(c10::string_view("4")));
+  EXPECT_THROW(dict.at(c10::string_view("5")), std::out_of_range);
+  EXPECT_TRUE(dict.contains(c10::string_view("3")));
+  EXPECT_FALSE(dict.contains(c10::string_view("5")));
+}
+
+TEST(DictTest, givenLargeIntKeys_whenCallingFind_thenFindsCorrectElement) {
+  // Keys only differing in their upper 32 bits.
+  Dict<int64_t, int64_t> dict;
+  for (int64_t i = 0; i < 10; ++i) {
+    dict.insert(i << 32, i);
+  }
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, dict.at(i << 32));
+  }
+}
+
 TEST(DictTest, whenCallingContainsWithExistingKey_thenReturnsTrue) {
   Dict<int64_t, string> dict;
   dict.insert(3, "3");
@@ -6,6 +6,9 @@
 #include <c10/util/Exception.h>
 #include <c10/util/C++17.h>
 
+#include <atomic>
+#include <thread>
+
 using at::Dimname;
 using at::DimnameList;
 using at::Symbol;
@@ -234,3 +237,80 @@ TEST(NamedTensorTest, TensorNamesCheckUnique) {
 }
 
 
+
+TEST(NamedTensorTest, anyAlive) {
+  using at::NamedTensorMeta;
+  ASSERT_FALSE(NamedTensorMeta::any_alive());
+  {
+    auto tensor = at::empty({1, 2, 3, 4}, nchw());
+    ASSERT_TRUE(NamedTensorMeta::any_alive());
+
+    // Copies of the metadata are counted on their own
+    auto copy = tensor.clone();
+    ASSERT_TRUE(copy.has_names());
+    tensor.reset();
+    ASSERT_TRUE(NamedTensorMeta::any_alive());
+
+    // Names that propagate through an op with an unnamed tensor
+    auto result = at::add(copy, at::ones({1, 2, 3, 4}));
+    ASSERT_TRUE(dimnames_equal(result.names(), nchw()));
+
+    at::internal_set_names_inplace(copy, at::nullopt);
+    ASSERT_TRUE(NamedTensorMeta::any_alive());
+    result.unsafeGetTensorImpl()->set_named_tensor_meta(nullptr);
+    ASSERT_FALSE(NamedTensorMeta::any_alive());
+  }
+  ASSERT_FALSE(NamedTensorMeta::any_alive());
+
+  // Without named tensors ops give unnamed results
+  auto result = at::add(at::ones({2, 3}), at::ones({2, 3}));
+  ASSERT_FALSE(result.has_names());
+  ASSERT_FALSE(NamedTensorMeta::any_alive());
+}
+
+TEST(NamedTensorTest, anyAliveAcrossThreads) {
+  using at::NamedTensorMeta;
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIters = 1000;
+  const auto names = nchw();
+  ASSERT_FALSE(NamedTensorMeta::any_alive());
+
+  // A named tensor kept alive by one thread must be seen by all the others,
+  // while they create and destroy their own named tensors.
+  auto named = at::empty({1, 2, 3, 4}, names);
+  std::atomic<int> errors{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kNumIters; i++) {
+        auto tensor = at::empty({1, 2, 3, 4}, names);
+        auto result = at::add(named, at::zeros({1, 2, 3, 4}));
+        if (!NamedTensorMeta::any_alive() || !result.has_names()) {
+          errors++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(errors.load(), 0);
+  ASSERT_TRUE(NamedTensorMeta::any_alive());
+  named.reset();
+  ASSERT_FALSE(NamedTensorMeta::any_alive());
+
+  // Every increment is matched by a decrement once the threads are done
+  threads.clear();
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kNumIters; i++) {
+        auto tensor = at::empty({1, 2, 3, 4}, names);
+        auto copy = tensor.clone();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(NamedTensorMeta::any_alive());
+}
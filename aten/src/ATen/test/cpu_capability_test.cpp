@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <ATen/ATen.h>
+#include <ATen/native/BinaryOps.h>
+#include <ATen/native/DispatchStub.h>
+#include <ATen/native/TensorIterator.h>
+
+using namespace at;
+using namespace at::native;
+
+#ifdef HAVE_AVX512_CPU_DEFINITION
+
+namespace {
+
+bool has_avx512() {
+  return get_cpu_capability() == CPUCapability::AVX512;
+}
+
+// Sizes around the number of floats and doubles in a Vec512, so that both
+// the vectorized loop and its scalar tail run.
+const std::vector<int64_t> kSizes = {1, 7, 8, 15, 16, 17, 31, 32, 33, 1000};
+
+// Runs the given kernel of a binary op on `a` and `b`, where `b` may be a
+// scalar that is broadcast.
+template <typename Fn, typename... Args>
+Tensor run(Fn kernel, const Tensor& a, const Tensor& b, Args... args) {
+  Tensor out = at::empty({0}, a.options());
+  auto iter = TensorIterator::binary_op(out, a, b);
+  kernel(iter, args...);
+  return out;
+}
+
+} // namespace
+
+TEST(CPUCapabilityTest, AVX512ArithmeticMatchesDefault) {
+  if (!has_avx512()) {
+    return;
+  }
+  for (auto dtype : {kFloat, kDouble}) {
+    for (auto size : kSizes) {
+      auto a = at::randn({size}, dtype);
+      // Keep the divisors away from 0.
+      auto b = at::rand({size}, dtype) + 0.5;
+      for (const auto& rhs : {b, b[0]}) {
+        // The AVX512 kernel fuses the multiplication by alpha and the
+        // addition, so the results may differ in the last bit.
+        ASSERT_TRUE(at::allclose(
+            run(add_stub.AVX512, a, rhs, Scalar(2.5)),
+            run(add_stub.DEFAULT, a, rhs, Scalar(2.5))));
+        ASSERT_TRUE(at::equal(
+            run(sub_stub.AVX512, a, rhs, Scalar(1)),
+            run(sub_stub.DEFAULT, a, rhs, Scalar(1))));
+        ASSERT_TRUE(at::equal(
+            run(mul_stub.AVX512, a, rhs), run(mul_stub.DEFAULT, a, rhs)));
+        ASSERT_TRUE(at::allclose(
+            run(div_stub.AVX512, a, rhs), run(div_stub.DEFAULT, a, rhs)));
+      }
+    }
+  }
+}
+
+TEST(CPUCapabilityTest, AVX512ArithmeticOtherTypes) {
+  if (!has_avx512()) {
+    return;
+  }
+  // These keep using Vec256 in the AVX512 kernels.
+  for (auto dtype : {kInt, kLong}) {
+    auto a = at::randint(1, 100, {33}, dtype);
+    auto b = at::randint(1, 100, {33}, dtype);
+    ASSERT_TRUE(at::equal(
+        run(add_stub.AVX512, a, b, Scalar(3)),
+        run(add_stub.DEFAULT, a, b, Scalar(3))));
+    ASSERT_TRUE(at::equal(
+        run(mul_stub.AVX512, a, b), run(mul_stub.DEFAULT, a, b)));
+  }
+}
+
+TEST(CPUCapabilityTest, AVX512IsDispatched) {
+  if (!has_avx512()) {
+    return;
+  }
+  auto a = at::randn({100});
+  auto b = at::randn({100});
+  ASSERT_TRUE(at::equal(a + b, run(add_stub.AVX512, a, b, Scalar(1))));
+  ASSERT_TRUE(at::equal(a * b, run(mul_stub.AVX512, a, b)));
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <ATen/ATen.h>
+#include <ATen/native/CPUBlas.h>
+
+#include <tuple>
+#include <vector>
+
+using namespace at;
+
+namespace {
+
+// Column-major op(X) of a rows x cols matrix with leading dimension ld
+template <typename T>
+T elem(const std::vector<T>& x, bool trans, int64_t ld, int64_t row, int64_t col) {
+  return trans ? x[row * ld + col] : x[col * ld + row];
+}
+
+template <typename T>
+void test_gemm(
+    ScalarType type,
+    bool transa,
+    bool transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    T alpha,
+    T beta) {
+  // Leading dimensions larger than the matrices, as for views
+  const int64_t lda = (transa ? k : m) + 3;
+  const int64_t ldb = (transb ? n : k) + 2;
+  const int64_t ldc = m + 1;
+  auto random = [](int64_t size) {
+    auto t = at::randn({size}, at::dtype(at::kDouble));
+    const auto* data = t.data_ptr<double>();
+    return std::vector<T>(data, data + size);
+  };
+  const auto a = random(lda * (transa ? m : k));
+  const auto b = random(ldb * (transb ? k : n));
+  auto c = random(ldc * n);
+
+  auto expected = c;
+  for (int64_t j = 0; j < n; j++) {
+    for (int64_t i = 0; i < m; i++) {
+      T sum = 0;
+      for (int64_t p = 0; p < k; p++) {
+        sum += elem(a, transa, lda, i, p) * elem(b, transb, ldb, p, j);
+      }
+      expected[j * ldc + i] = alpha * sum + beta * c[j * ldc + i];
+    }
+  }
+
+  native::gemm_stub(
+      kCPU,
+      type,
+      transa ? 't' : 'n',
+      transb ? 't' : 'n',
+      m,
+      n,
+      k,
+      alpha,
+      a.data(),
+      lda,
+      b.data(),
+      ldb,
+      beta,
+      c.data(),
+      ldc);
+
+  for (int64_t j = 0; j < n; j++) {
+    for (int64_t i = 0; i < ldc; i++) {
+      if (i < m) {
+        ASSERT_NEAR(c[j * ldc + i], expected[j * ldc + i], 1e-3 * (k + 1))
+            << "m=" << m << " n=" << n << " k=" << k << " i=" << i
+            << " j=" << j;
+      } else {
+        // Padding between the columns of C is left alone
+        ASSERT_EQ(c[j * ldc + i], expected[j * ldc + i]);
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST(CPUGemmTest, MatchesNaiveGemm) {
+  manual_seed(123);
+  const std::vector<std::tuple<int64_t, int64_t, int64_t>> sizes = {
+      {1, 1, 1},
+      {2, 2, 2},
+      {3, 3, 3},
+      {4, 4, 4},
+      {1, 7, 5},
+      {17, 1, 9},
+      {33, 13, 300},
+      {130, 390, 20},
+      {0, 5, 5},
+      {5, 5, 0},
+  };
+  for (const auto& size : sizes) {
+    int64_t m, n, k;
+    std::tie(m, n, k) = size;
+    for (bool transa : {false, true}) {
+      for (bool transb : {false, true}) {
+        test_gemm<float>(kFloat, transa, transb, m, n, k, 1.f, 0.f);
+        test_gemm<float>(kFloat, transa, transb, m, n, k, 0.5f, 2.f);
+        test_gemm<double>(kDouble, transa, transb, m, n, k, 2.0, 1.0);
+      }
+    }
+  }
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <ATen/ATen.h>
+
+#include <array>
+#include <tuple>
+#include <vector>
+
+using namespace at;
+
+namespace {
+
+// Compares a float result with its double precision reference
+void expect_close(const Tensor& actual, const Tensor& expected) {
+  ASSERT_EQ(actual.sizes(), expected.sizes());
+  EXPECT_TRUE(
+      at::allclose(actual, expected.to(actual.scalar_type()), 1e-4, 1e-5))
+      << "max difference "
+      << (actual.to(kDouble) - expected).abs().max().item<double>();
+}
+
+void test_layer_norm_backward(int64_t M, int64_t N, bool with_gamma) {
+  auto X = at::randn({M, N});
+  auto dY = at::randn({M, N});
+  auto gamma = with_gamma ? at::randn({N}) : Tensor();
+  auto beta = with_gamma ? at::randn({N}) : Tensor();
+  Tensor mean, rstd;
+  std::tie(std::ignore, mean, rstd) =
+      at::native_layer_norm(X, gamma, beta, M, N, 1e-5);
+
+  const std::array<bool, 3> mask = {true, with_gamma, with_gamma};
+  Tensor dX, dgamma, dbeta;
+  std::tie(dX, dgamma, dbeta) =
+      at::native_layer_norm_backward(dY, X, mean, rstd, gamma, M, N, mask);
+
+  auto x = X.to(kDouble);
+  auto dy = dY.to(kDouble);
+  auto m = mean.to(kDouble).view({M, 1});
+  auto r = rstd.to(kDouble).view({M, 1});
+  auto x_hat = (x - m) * r;
+  auto g = with_gamma ? dy * gamma.to(kDouble) : dy;
+  auto expected_dX = r *
+      (g - g.mean(1, true) - x_hat * (g * x_hat).mean(1, true));
+  expect_close(dX, expected_dX);
+  if (with_gamma) {
+    expect_close(dgamma, (dy * x_hat).sum(0));
+    expect_close(dbeta, dy.sum(0));
+  }
+}
+
+void test_group_norm_backward(
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    bool with_gamma) {
+  auto X = at::randn({N, C, HxW});
+  auto dY = at::randn({N, C, HxW});
+  auto gamma = with_gamma ? at::randn({C}) : Tensor();
+  auto beta = with_gamma ? at::randn({C}) : Tensor();
+  Tensor mean, rstd;
+  std::tie(std::ignore, mean, rstd) =
+      at::native_group_norm(X, gamma, beta, N, C, HxW, group, 1e-5);
+
+  const std::array<bool, 3> mask = {true, with_gamma, with_gamma};
+  Tensor dX, dgamma, dbeta;
+  std::tie(dX, dgamma, dbeta) = at::native_group_norm_backward(
+      dY, X, mean, rstd, gamma, N, C, HxW, group, mask);
+
+  const int64_t D = C / group;
+  auto x = X.to(kDouble).view({N, group, D * HxW});
+  auto dy = dY.to(kDouble).view({N, group, D * HxW});
+  auto m = mean.to(kDouble).view({N, group, 1});
+  auto r = rstd.to(kDouble).view({N, group, 1});
+  auto x_hat = (x - m) * r;
+  auto g = with_gamma
+      ? (dY.to(kDouble) * gamma.to(kDouble).view({1, C, 1}))
+            .view({N, group, D * HxW})
+      : dy;
+  auto expected_dX = r *
+      (g - g.mean(2, true) - x_hat * (g * x_hat).mean(2, true));
+  expect_close(dX, expected_dX.view({N, C, HxW}));
+  if (with_gamma) {
+    auto dy_c = dy.view({N, C, HxW});
+    expect_close(dgamma, (dy_c * x_hat.view({N, C, HxW})).sum(IntArrayRef{0, 2}));
+    expect_close(dbeta, dy_c.sum(IntArrayRef{0, 2}));
+  }
+}
+
+} // namespace
+
+// Sizes with and without a vector tail, and with enough rows for the
+// backward to run in parallel.
+TEST(CPUNormBackwardTest, LayerNorm) {
+  manual_seed(0);
+  const std::vector<std::tuple<int64_t, int64_t>> sizes = {
+      {1, 1}, {3, 7}, {5, 16}, {17, 33}, {257, 64}, {64, 1000}, {1000, 3}};
+  for (const auto& size : sizes) {
+    for (bool with_gamma : {true, false}) {
+      SCOPED_TRACE(
+          ::testing::Message() << "M=" << std::get<0>(size)
+                               << " N=" << std::get<1>(size)
+                               << " gamma=" << with_gamma);
+      test_layer_norm_backward(
+          std::get<0>(size), std::get<1>(size), with_gamma);
+    }
+  }
+}
+
+TEST(CPUNormBackwardTest, GroupNorm) {
+  manual_seed(0);
+  const std::vector<std::tuple<int64_t, int64_t, int64_t, int64_t>> sizes = {
+      {1, 4, 1, 2},
+      {2, 6, 7, 3},
+      {3, 32, 9, 8},
+      {4, 16, 33, 16},
+      {8, 64, 64, 4},
+      {33, 8, 5, 1}};
+  for (const auto& size : sizes) {
+    for (bool with_gamma : {true, false}) {
+      SCOPED_TRACE(
+          ::testing::Message()
+          << "N=" << std::get<0>(size) << " C=" << std::get<1>(size)
+          << " HxW=" << std::get<2>(size) << " group=" << std::get<3>(size)
+          << " gamma=" << with_gamma);
+      test_group_norm_backward(
+          std::get<0>(size),
+          std::get<1>(size),
+          std::get<2>(size),
+          std::get<3>(size),
+          with_gamma);
+    }
+  }
+}
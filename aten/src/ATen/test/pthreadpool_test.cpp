@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <ATen/Parallel.h>
+#include <caffe2/utils/threadpool/ThreadPool.h>
+#include <caffe2/utils/threadpool/ThreadPoolMobile.h>
+#include <caffe2/utils/threadpool/pthreadpool.h>
+#ifdef USE_INTERNAL_THREADPOOL_IMPL
+#include <caffe2/utils/threadpool/ThreadPoolXNNPACK.h>
+#endif
+
+#include <atomic>
+#include <vector>
+
+#ifndef C10_MOBILE
+
+using namespace at;
+
+namespace {
+
+// Every test sets the same number of threads: the native backend only takes
+// it before the first parallel work.
+constexpr int kNumThreads = 3;
+constexpr size_t kRange = 1000;
+
+// Counts the runs of each item, and the items run outside of the intra-op
+// pool or with a thread id it does not have.
+struct Runs {
+  Runs() : counts(kRange) {}
+
+  void record(size_t thread_id, size_t i) {
+    counts[i]++;
+    if (!in_parallel_region() || thread_id >= size_t(kNumThreads) ||
+        get_thread_num() >= kNumThreads) {
+      errors++;
+    }
+  }
+
+  void check() {
+    for (size_t i = 0; i < kRange; i++) {
+      ASSERT_EQ(counts[i].load(), 1) << "item " << i;
+    }
+    ASSERT_EQ(errors.load(), 0);
+  }
+
+  std::vector<std::atomic<int>> counts;
+  std::atomic<int> errors{0};
+};
+
+} // namespace
+
+TEST(PThreadPoolTest, ThreadPoolRunsOnIntraOpPool) {
+  set_num_threads(kNumThreads);
+  const auto* executor = pthreadpool_get_executor();
+  ASSERT_NE(executor, nullptr);
+  ASSERT_EQ(executor->get_threads_count(), size_t(get_num_threads()));
+
+  auto* pool = caffe2::mobile_threadpool();
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(pool->getNumThreads(), kNumThreads);
+  pool->setMinWorkSize(1);
+
+  Runs runs;
+  pool->run(
+      [&](int thread_id, size_t i) { runs.record(thread_id, i); }, kRange);
+  runs.check();
+}
+
+#ifdef USE_INTERNAL_THREADPOOL_IMPL
+TEST(PThreadPoolTest, ParallelizeRunsOnIntraOpPool) {
+  set_num_threads(kNumThreads);
+  auto* pool = caffe2::xnnpack_threadpool();
+  ASSERT_EQ(pthreadpool_get_threads_count_xnnpack(pool), size_t(kNumThreads));
+
+  Runs runs;
+  pthreadpool_parallelize_1d(
+      pool,
+      [](void* context, size_t i) {
+        static_cast<Runs*>(context)->record(get_thread_num(), i);
+      },
+      &runs,
+      kRange,
+      0);
+  runs.check();
+
+  // The 2-D tiled functions split their work on the same pool
+  Runs tiled_runs;
+  pthreadpool_parallelize_2d_tile_2d(
+      pool,
+      [](void* context, size_t i, size_t j, size_t tile_i, size_t tile_j) {
+        auto* runs = static_cast<Runs*>(context);
+        for (size_t ii = i; ii < i + tile_i; ii++) {
+          for (size_t jj = j; jj < j + tile_j; jj++) {
+            runs->record(get_thread_num(), ii * 50 + jj);
+          }
+        }
+      },
+      &tiled_runs,
+      kRange / 50,
+      50,
+      3,
+      7,
+      0);
+  tiled_runs.check();
+}
+#endif
+
+#endif // C10_MOBILE
@@ -210,3 +210,78 @@ TEST(TensorIteratorTest, FailNonPromotingBinaryOp) {
   config.add_input(at::ones({1,1}, at::dtype(at::kInt)));
   ASSERT_ANY_THROW(config.build());
 }
+
+// Iterators built with cache_geometry(true) on the same geometry reuse the
+// strides and shape of the first build, including for allocated outputs.
+TEST(TensorIteratorTest, CachedGeometry) {
+  auto x = at::randn({4, 3, 5}).permute({2, 0, 1});
+  auto y = at::randn({1, 3});
+  for (int i = 0; i < 2; i++) {
+    auto build = [&](bool cache) {
+      return at::TensorIteratorConfig()
+          .add_output(Tensor())
+          .add_input(x)
+          .add_input(y)
+          .cache_geometry(cache)
+          .build();
+    };
+    auto expected = build(false);
+    auto iter = build(true);
+    EXPECT_EQ(iter.shape(), expected.shape());
+    for (int arg = 0; arg < iter.ntensors(); arg++) {
+      EXPECT_EQ(iter.strides(arg), expected.strides(arg));
+    }
+    EXPECT_EQ(iter.output().sizes(), expected.output().sizes());
+    EXPECT_EQ(iter.output().strides(), expected.output().strides());
+  }
+  // A different layout of the same shape misses the cache
+  x = x.contiguous();
+  auto iter = at::TensorIteratorConfig()
+      .add_output(Tensor())
+      .add_input(x)
+      .add_input(y)
+      .cache_geometry(true)
+      .build();
+  EXPECT_TRUE(iter.output().is_contiguous());
+}
+
+TEST(TensorIteratorTest, CpuKernelMultipleOutputs) {
+  auto in1 = at::randn({128, 5});
+  auto in2 = at::randn({5}).expand({128, 5});
+  auto out1 = at::empty({128, 5});
+  auto out2 = at::empty({128, 5}).t().contiguous().t();
+  auto iter = at::TensorIteratorConfig()
+    .add_output(out1)
+    .add_output(out2)
+    .add_input(in1)
+    .add_input(in2)
+    .build();
+  at::native::cpu_kernel_multiple_outputs(iter, [=](float a, float b) -> std::tuple<float, float> {
+    return std::make_tuple(a + b, a * b);
+  });
+  EXPECT_TRUE(out1.equal(in1 + in2));
+  EXPECT_TRUE(out2.allclose(in1 * in2));
+}
+
+TEST(TensorIteratorTest, CpuKernelMultipleOutputsVec) {
+  // Odd size to cover the scalar tail of the vectorized loop
+  auto in1 = at::randn({1001});
+  auto in2 = at::randn({1001});
+  auto out1 = at::empty({1001});
+  auto out2 = at::empty({1001});
+  auto iter = at::TensorIteratorConfig()
+    .add_output(out1)
+    .add_output(out2)
+    .add_input(in1)
+    .add_input(in2)
+    .build();
+  at::native::cpu_kernel_multiple_outputs_vec(iter,
+    [=](float a, float b) -> std::tuple<float, float> {
+      return std::make_tuple(a + b, a * b);
+    },
+    [=](vec256::Vec256<float> a, vec256::Vec256<float> b) {
+      return std::make_tuple(a + b, a * b);
+    });
+  EXPECT_TRUE(out1.equal(in1 + in2));
+  EXPECT_TRUE(out2.allclose(in1 * in2));
+}
@@ -4,9 +4,12 @@
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
 
+#include <atomic>
 #include <iostream>
 #include <string.h>
 #include <sstream>
+#include <string>
+#include <vector>
 
 using namespace at;
 
@@ -69,3 +72,45 @@ TEST(TestParallel, IntraOpLaunchFuture) {
 
   ASSERT_TRUE(v1 == 1 && v2 == 2);
 }
+
+TEST(TestParallel, UnevenWork) {
+  // the first elements are much more expensive than the rest, every element
+  // must still be visited exactly once
+  const int64_t numel = 100000;
+  std::vector<std::atomic<int>> visits(numel);
+  at::parallel_for(0, numel, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      if (i < 1000) {
+        volatile double x = 0;
+        for (int k = 0; k < 1000; ++k) {
+          x += k;
+        }
+      }
+      visits[i]++;
+    }
+  });
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_EQ(visits[i].load(), 1);
+  }
+}
+
+TEST(TestParallel, ReduceOrder) {
+  // sf is associative but not commutative, partial results must be combined
+  // in the order of their subranges
+  std::string expected;
+  for (int64_t i = 0; i < 1000; ++i) {
+    expected += std::to_string(i % 10);
+  }
+  auto result = at::parallel_reduce(
+      0, 1000, 1, std::string(),
+      [](int64_t begin, int64_t end, std::string ident) {
+        for (int64_t i = begin; i < end; ++i) {
+          ident += std::to_string(i % 10);
+        }
+        return ident;
+      },
+      [](const std::string& a, const std::string& b) {
+        return a + b;
+      });
+  ASSERT_EQ(result, expected);
+}
@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace at::vec256;
+
+// Checks each operation of Vec256<float>, as built for the DEFAULT CPU
+// capability of this platform (the NEON one with USE_VEC256_NEON on
+// aarch64), against the same operation on each element.
+
+namespace {
+
+using Vec = Vec256<float>;
+constexpr int kSize = Vec::size();
+
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+const float kInf = std::numeric_limits<float>::infinity();
+
+// Inputs with halfway values, signed zeros, infinities and NaNs
+std::vector<float> test_values() {
+  return {-2.5f, -1.5f, -0.5f, -0.0f, 0.0f,  0.5f,  1.5f,  2.5f,
+          -3.7f, 3.7f,  1e-3f, -1e6f, 7.0f,  -kInf, kInf,  kNaN,
+          0.25f, 4.0f,  -9.0f, 1.0f,  1e30f, -1e-30f, 2.0f, 100.f};
+}
+
+// Other operands, for the binary operations
+std::vector<float> other_values() {
+  return {1.0f,  -1.5f, 2.0f,  0.0f,  -0.0f, kNaN,  0.5f,   -2.5f,
+          3.7f,  3.7f,  -1e-3f, 2.0f, 7.0f,  kInf,  -kInf,  1.0f,
+          -0.25f, 4.0f, 9.0f,  kNaN,  1e-30f, 1e30f, -2.0f, 0.1f};
+}
+
+std::vector<float> to_vector(const Vec& v) {
+  std::vector<float> out(kSize);
+  v.store(out.data());
+  return out;
+}
+
+bool same(float a, float b) {
+  return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+bool close(float a, float b) {
+  if (std::isnan(a) || std::isnan(b) || std::isinf(a) || std::isinf(b)) {
+    return same(a, b);
+  }
+  return std::abs(a - b) <= 1e-6f + 1e-5f * std::abs(b);
+}
+
+// Returns a float with all its bits set if pred holds, zero otherwise, as the
+// comparison operators do.
+float mask_value(bool pred) {
+  uint32_t bits = pred ? 0xFFFFFFFF : 0;
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+bool same_bits(float a, float b) {
+  return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+template <typename VecOp, typename ScalarOp>
+void check_unary(const char* name, VecOp vec_op, ScalarOp scalar_op,
+                 bool exact = true) {
+  const auto values = test_values();
+  for (size_t base = 0; base < values.size(); base += kSize) {
+    auto result = to_vector(vec_op(Vec::loadu(values.data() + base)));
+    for (int i = 0; i < kSize; i++) {
+      const float x = values[base + i];
+      const float expected = scalar_op(x);
+      EXPECT_TRUE(exact ? same(result[i], expected)
+                        : close(result[i], expected))
+          << name << "(" << x << ") = " << result[i] << ", expected "
+          << expected;
+    }
+  }
+}
+
+template <typename VecOp, typename ScalarOp>
+void check_binary(const char* name, VecOp vec_op, ScalarOp scalar_op,
+                  bool exact = true) {
+  const auto values = test_values();
+  const auto others = other_values();
+  for (size_t base = 0; base < values.size(); base += kSize) {
+    auto result = to_vector(vec_op(
+        Vec::loadu(values.data() + base), Vec::loadu(others.data() + base)));
+    for (int i = 0; i < kSize; i++) {
+      const float a = values[base + i];
+      const float b = others[base + i];
+      const float expected = scalar_op(a, b);
+      EXPECT_TRUE(exact ? same(result[i], expected)
+                        : close(result[i], expected))
+          << name << "(" << a << ", " << b << ") = " << result[i]
+          << ", expected " << expected;
+    }
+  }
+}
+
+template <typename VecOp, typename ScalarOp>
+void check_comparison(const char* name, VecOp vec_op, ScalarOp scalar_op) {
+  const auto values = test_values();
+  const auto others = other_values();
+  for (size_t base = 0; base < values.size(); base += kSize) {
+    auto result = to_vector(vec_op(
+        Vec::loadu(values.data() + base), Vec::loadu(others.data() + base)));
+    for (int i = 0; i < kSize; i++) {
+      const float a = values[base + i];
+      const float b = others[base + i];
+      EXPECT_TRUE(same_bits(result[i], mask_value(scalar_op(a, b))))
+          << name << "(" << a << ", " << b << ")";
+    }
+  }
+}
+
+} // namespace
+
+TEST(Vec256FloatTest, LoadStore) {
+  const auto values = test_values();
+  for (int count = 0; count <= kSize; count++) {
+    std::vector<float> out(kSize, 42.0f);
+    Vec::loadu(values.data(), count).store(out.data(), count);
+    for (int i = 0; i < kSize; i++) {
+      // The elements past count are not written
+      EXPECT_TRUE(same(out[i], i < count ? values[i] : 42.0f))
+          << "count " << count << " element " << i;
+    }
+  }
+
+  auto v = to_vector(Vec(3.5f));
+  for (int i = 0; i < kSize; i++) {
+    EXPECT_EQ(v[i], 3.5f);
+  }
+  v = to_vector(Vec::arange(1.0f, 0.5f));
+  for (int i = 0; i < kSize; i++) {
+    EXPECT_EQ(v[i], 1.0f + 0.5f * i);
+  }
+}
+
+TEST(Vec256FloatTest, Blend) {
+  const auto values = test_values();
+  const auto others = other_values();
+  const auto a = Vec::loadu(values.data());
+  const auto b = Vec::loadu(others.data());
+
+  auto blended = to_vector(Vec::blend<0xA5>(a, b));
+  auto blendedv = to_vector(Vec::blendv(a, b, a < b));
+  for (int i = 0; i < kSize; i++) {
+    EXPECT_TRUE(same(blended[i], (0xA5 >> i) & 1 ? others[i] : values[i]));
+    EXPECT_TRUE(
+        same(blendedv[i], values[i] < others[i] ? others[i] : values[i]));
+  }
+
+  for (int count = 0; count <= kSize; count++) {
+    auto set = to_vector(Vec::set(a, b, count));
+    for (int i = 0; i < kSize; i++) {
+      EXPECT_TRUE(same(set[i], i < count ? others[i] : values[i]))
+          << "count " << count << " element " << i;
+    }
+  }
+
+  const float zeros[kSize] = {0.f, 1.f, -0.f, 2.f, 0.f, kNaN, 3.f, 0.f};
+  EXPECT_EQ(Vec::loadu(zeros).zero_mask(), 0x95);
+}
+
+TEST(Vec256FloatTest, Arithmetic) {
+  check_binary("add", [](Vec a, Vec b) { return a + b; },
+               [](float a, float b) { return a + b; });
+  check_binary("sub", [](Vec a, Vec b) { return a - b; },
+               [](float a, float b) { return a - b; });
+  check_binary("mul", [](Vec a, Vec b) { return a * b; },
+               [](float a, float b) { return a * b; });
+  check_binary("div", [](Vec a, Vec b) { return a / b; },
+               [](float a, float b) { return a / b; });
+  // Fused or not, depending on the platform
+  check_binary("fmadd", [](Vec a, Vec b) { return fmadd(a, b, b); },
+               [](float a, float b) { return a * b + b; }, false);
+  check_unary("neg", [](Vec a) { return a.neg(); },
+              [](float a) { return -a; });
+  check_unary("abs", [](Vec a) { return a.abs(); },
+              [](float a) { return std::abs(a); });
+}
+
+TEST(Vec256FloatTest, MinMax) {
+  // NaNs propagate from either operand
+  auto nan_or = [](float a, float b, float r) {
+    return std::isnan(a) || std::isnan(b) ? kNaN : r;
+  };
+  check_binary("maximum", [](Vec a, Vec b) { return maximum(a, b); },
+               [&](float a, float b) { return nan_or(a, b, std::max(a, b)); });
+  check_binary("minimum", [](Vec a, Vec b) { return minimum(a, b); },
+               [&](float a, float b) { return nan_or(a, b, std::min(a, b)); });
+
+  const Vec lo(-2.0f), hi(3.0f);
+  auto clamped = [](float a, float l, float h) {
+    return std::isnan(a) ? kNaN : std::min(std::max(a, l), h);
+  };
+  check_unary("clamp", [&](Vec a) { return clamp(a, lo, hi); },
+              [&](float a) { return clamped(a, -2.0f, 3.0f); });
+  check_unary("clamp_min", [&](Vec a) { return clamp_min(a, lo); },
+              [&](float a) { return clamped(a, -2.0f, kInf); });
+  check_unary("clamp_max", [&](Vec a) { return clamp_max(a, hi); },
+              [&](float a) { return clamped(a, -kInf, 3.0f); });
+}
+
+TEST(Vec256FloatTest, Comparisons) {
+  check_comparison("==", [](Vec a, Vec b) { return a == b; },
+                   [](float a, float b) { return a == b; });
+  check_comparison("!=", [](Vec a, Vec b) { return a != b; },
+                   [](float a, float b) { return a != b; });
+  check_comparison("<", [](Vec a, Vec b) { return a < b; },
+                   [](float a, float b) { return a < b; });
+  check_comparison("<=", [](Vec a, Vec b) { return a <= b; },
+                   [](float a, float b) { return a <= b; });
+  check_comparison(">", [](Vec a, Vec b) { return a > b; },
+                   [](float a, float b) { return a > b; });
+  check_comparison(">=", [](Vec a, Vec b) { return a >= b; },
+                   [](float a, float b) { return a >= b; });
+  check_binary("eq", [](Vec a, Vec b) { return a.eq(b); },
+               [](float a, float b) { return float(a == b); });
+  check_binary("ne", [](Vec a, Vec b) { return a.ne(b); },
+               [](float a, float b) { return float(a != b); });
+  check_binary("lt", [](Vec a, Vec b) { return a.lt(b); },
+               [](float a, float b) { return float(a < b); });
+  check_binary("ge", [](Vec a, Vec b) { return a.ge(b); },
+               [](float a, float b) { return float(a >= b); });
+}
+
+TEST(Vec256FloatTest, Rounding) {
+  check_unary("floor", [](Vec a) { return a.floor(); },
+              [](float a) { return std::floor(a); });
+  check_unary("ceil", [](Vec a) { return a.ceil(); },
+              [](float a) { return std::ceil(a); });
+  check_unary("trunc", [](Vec a) { return a.trunc(); },
+              [](float a) { return std::trunc(a); });
+  // Halfway values round to even
+  check_unary("round", [](Vec a) { return a.round(); },
+              [](float a) { return std::nearbyint(a); });
+  check_unary("frac", [](Vec a) { return a.frac(); },
+              [](float a) { return a - std::trunc(a); });
+}
+
+TEST(Vec256FloatTest, Math) {
+  check_unary("sqrt", [](Vec a) { return a.sqrt(); },
+              [](float a) { return std::sqrt(a); });
+  check_unary("reciprocal", [](Vec a) { return a.reciprocal(); },
+              [](float a) { return 1.0f / a; });
+  check_unary("rsqrt", [](Vec a) { return a.rsqrt(); },
+              [](float a) { return 1.0f / std::sqrt(a); }, false);
+  check_unary("exp", [](Vec a) { return a.exp(); },
+              [](float a) { return std::exp(a); }, false);
+  check_unary("log", [](Vec a) { return a.log(); },
+              [](float a) { return std::log(a); }, false);
+  check_unary("tanh", [](Vec a) { return a.tanh(); },
+              [](float a) { return std::tanh(a); }, false);
+  check_binary("pow", [](Vec a, Vec b) { return a.pow(b); },
+               [](float a, float b) { return std::pow(a, b); }, false);
+}
@@ -717,4 +717,189 @@ TEST(VmapTest, TestBatchedTensorExpand) {
   }
 }
 
+// Checks that `batched_out` has a single batch dim, at the front, and that
+// its examples are `expected`.
+static void checkExamples(const Tensor& batched_out, TensorList expected) {
+  auto* batched = maybeGetBatched(batched_out);
+  ASSERT_TRUE(batched != nullptr);
+  checkBatchDimsEqual(batched->bdims(), {{/*lvl*/1, /*dim*/0}});
+  ASSERT_EQ(batched->value().size(0), static_cast<int64_t>(expected.size()));
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(batched->value()[i].sizes(), expected[i].sizes());
+    ASSERT_TRUE(at::allclose(batched->value()[i], expected[i], 1e-4, 1e-5));
+  }
+}
+
+TEST(VmapTest, TestBatchedTensorPointwise) {
+  {
+    // The batch dims stay where they are
+    Tensor x = at::randn({3, 2, 5});
+    Tensor Bx = makeBatched(x, {{/*lvl*/1, /*dim*/1}});
+    Tensor Bout = Bx.exp();
+    auto* batched = maybeGetBatched(Bout);
+    checkBatchDimsEqual(batched->bdims(), {{1, 1}});
+    ASSERT_TRUE(at::allclose(batched->value(), x.exp()));
+  }
+  {
+    // batched + unbatched, with alpha
+    Tensor x = at::randn({2, 3});
+    Tensor y = at::randn({3});
+    Tensor Bout = at::add(addBatchDim(x, /*lvl*/1, /*dim*/0), y, 2);
+    checkExamples(Bout, {x[0] + 2 * y, x[1] + 2 * y});
+  }
+  {
+    // unbatched / batched
+    Tensor x = at::randn({3});
+    Tensor y = at::rand({2, 3}) + 1;
+    Tensor Bout = x / addBatchDim(y, /*lvl*/1, /*dim*/0);
+    checkExamples(Bout, {x / y[0], x / y[1]});
+  }
+}
+
+TEST(VmapTest, TestBatchedTensorInplace) {
+  {
+    // batched += unbatched writes to the underlying tensor
+    Tensor x = at::randn({2, 3});
+    Tensor y = at::randn({3});
+    Tensor expected = x + y;
+    Tensor Bx = addBatchDim(x, /*lvl*/1, /*dim*/0);
+    Bx.add_(y);
+    ASSERT_TRUE(at::allclose(x, expected));
+  }
+  {
+    // batch dim not at the front
+    Tensor x = at::randn({3, 2});
+    Tensor y = at::randn({2, 3});
+    Tensor expected = x * y.t();
+    Tensor Bx = addBatchDim(x, /*lvl*/1, /*dim*/1);
+    Bx.mul_(addBatchDim(y, /*lvl*/1, /*dim*/0));
+    ASSERT_TRUE(at::allclose(x, expected));
+  }
+  {
+    // self doesn't have the batch dims of other
+    Tensor x = at::randn({3});
+    Tensor y = at::randn({2, 3});
+    ASSERT_THROW(x.add_(addBatchDim(y, /*lvl*/1, /*dim*/0)), c10::Error);
+  }
+}
+
+TEST(VmapTest, TestBatchedTensorMatmul) {
+  {
+    // batched matrix @ unbatched matrix
+    Tensor x = at::randn({2, 4, 3});
+    Tensor w = at::randn({3, 5});
+    Tensor Bout = at::matmul(addBatchDim(x, 1, 0), w);
+    checkExamples(Bout, {x[0].mm(w), x[1].mm(w)});
+    Bout = at::mm(addBatchDim(x, 1, 0), w);
+    checkExamples(Bout, {x[0].mm(w), x[1].mm(w)});
+  }
+  {
+    // batched vector @ unbatched matrix, batch dim not at the front
+    Tensor x = at::randn({3, 2});
+    Tensor w = at::randn({3, 5});
+    Tensor Bout = at::matmul(addBatchDim(x, 1, 1), w);
+    checkExamples(Bout, {at::matmul(x.select(1, 0), w), at::matmul(x.select(1, 1), w)});
+  }
+  {
+    // unbatched matrix @ batched vector
+    Tensor w = at::randn({5, 3});
+    Tensor x = at::randn({2, 3});
+    Tensor Bout = at::mv(w, addBatchDim(x, 1, 0));
+    checkExamples(Bout, {w.mv(x[0]), w.mv(x[1])});
+  }
+  {
+    // batched vector . batched vector
+    Tensor x = at::randn({2, 3});
+    Tensor y = at::randn({2, 3});
+    Tensor Bout = at::dot(addBatchDim(x, 1, 0), addBatchDim(y, 1, 0));
+    checkExamples(Bout, {x[0].dot(y[0]), x[1].dot(y[1])});
+  }
+  {
+    // batched vector @ batched 3D, and batched 3D @ batched vector
+    Tensor x = at::randn({2, 3});
+    Tensor y = at::randn({2, 4, 3, 5});
+    Tensor z = at::randn({2, 5});
+    Tensor Bout = at::matmul(addBatchDim(x, 1, 0), addBatchDim(y, 1, 0));
+    checkExamples(Bout, {at::matmul(x[0], y[0]), at::matmul(x[1], y[1])});
+    Bout = at::matmul(addBatchDim(y, 1, 0), addBatchDim(z, 1, 0));
+    checkExamples(Bout, {at::matmul(y[0], z[0]), at::matmul(y[1], z[1])});
+  }
+  {
+    // batched bmm
+    Tensor x = at::randn({2, 4, 3, 5});
+    Tensor y = at::randn({4, 5, 6});
+    Tensor Bout = at::bmm(addBatchDim(x, 1, 0), y);
+    checkExamples(Bout, {x[0].bmm(y), x[1].bmm(y)});
+  }
+  {
+    // linear with batched weight and bias
+    Tensor x = at::randn({3});
+    Tensor w = at::randn({2, 4, 3});
+    Tensor b = at::randn({2, 4});
+    Tensor Bout = at::linear(x, addBatchDim(w, 1, 0), addBatchDim(b, 1, 0));
+    checkExamples(Bout, {at::linear(x, w[0], b[0]), at::linear(x, w[1], b[1])});
+  }
+}
+
+TEST(VmapTest, TestBatchedTensorConv2d) {
+  {
+    // batched input
+    Tensor x = at::randn({2, 3, 4, 7, 7});
+    Tensor w = at::randn({6, 4, 3, 3});
+    Tensor b = at::randn({6});
+    Tensor Bout = at::conv2d(addBatchDim(x, 1, 0), w, b, /*stride*/2, /*padding*/1);
+    checkExamples(Bout, {at::conv2d(x[0], w, b, 2, 1), at::conv2d(x[1], w, b, 2, 1)});
+  }
+  {
+    // batched input, weight and bias, with groups
+    Tensor x = at::randn({2, 3, 4, 7, 7});
+    Tensor w = at::randn({2, 6, 2, 3, 3});
+    Tensor b = at::randn({2, 6});
+    Tensor Bout = at::conv2d(
+        addBatchDim(x, 1, 0), addBatchDim(w, 1, 0), addBatchDim(b, 1, 0),
+        /*stride*/1, /*padding*/0, /*dilation*/1, /*groups*/2);
+    checkExamples(Bout, {
+        at::conv2d(x[0], w[0], b[0], 1, 0, 1, 2),
+        at::conv2d(x[1], w[1], b[1], 1, 0, 1, 2)});
+  }
+  {
+    // unbatched input, batched weight
+    Tensor x = at::randn({3, 4, 7, 7});
+    Tensor w = at::randn({2, 6, 4, 3, 3});
+    Tensor Bout = at::conv2d(x, addBatchDim(w, 1, 0));
+    checkExamples(Bout, {at::conv2d(x, w[0]), at::conv2d(x, w[1])});
+  }
+}
+
+TEST(VmapTest, TestBatchedTensorLosses) {
+  {
+    // per-example log_softmax and nll_loss
+    Tensor x = at::randn({2, 5});
+    Tensor target = at::tensor({1, 4}, kLong);
+    Tensor Bout = at::nll_loss(
+        at::log_softmax(addBatchDim(x, 1, 0), /*dim*/-1), addBatchDim(target, 1, 0));
+    checkExamples(Bout, {
+        at::nll_loss(at::log_softmax(x.narrow(0, 0, 1), 1), target.narrow(0, 0, 1)),
+        at::nll_loss(at::log_softmax(x.narrow(0, 1, 1), 1), target.narrow(0, 1, 1))});
+  }
+  {
+    // batched input, unbatched target, with weight and ignore_index
+    Tensor x = at::randn({2, 4, 5});
+    Tensor target = at::tensor({1, 4, 0, 2}, kLong);
+    Tensor weight = at::rand({5});
+    for (auto reduction : {Reduction::None, Reduction::Sum, Reduction::Mean}) {
+      Tensor Bout = at::nll_loss(addBatchDim(x, 1, 0), target, weight, reduction, /*ignore_index*/0);
+      checkExamples(Bout, {
+          at::nll_loss(x[0], target, weight, reduction, 0),
+          at::nll_loss(x[1], target, weight, reduction, 0)});
+    }
+  }
+  {
+    // mean over all dims
+    Tensor x = at::randn({2, 3, 5});
+    Tensor Bout = addBatchDim(x, 1, 0).mean();
+    checkExamples(Bout, {x[0].mean(), x[1].mean()});
+  }
+}
+
 }
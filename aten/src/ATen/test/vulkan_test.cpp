@@ -62,6 +62,25 @@ TEST(VulkanTest, add) {
   ASSERT_TRUE(almostEqual(t_out, t_out_expected));
 }
 
+TEST(VulkanTest, addChainReadback) {
+  if (!at::vulkan::is_available())
+    return;
+  // The adds are only submitted by the reads, the released intermediate
+  // tensors are reused by the next iterations.
+  auto t_in0 = at::rand({1, 2, 2, 3}, at::device(at::kCPU).dtype(at::kFloat));
+  auto t_in1 = at::rand({1, 2, 2, 3}, at::device(at::kCPU).dtype(at::kFloat));
+  auto tv_in0 = t_in0.vulkan();
+  auto tv_in1 = t_in1.vulkan();
+  for (int i = 0; i < 3; ++i) {
+    auto tv_out0 = at::add(tv_in0, tv_in1, 2);
+    auto tv_out1 = at::add(tv_out0, tv_in1, 2);
+    auto tv_out2 = at::add(tv_out1, tv_out0, 1);
+    ASSERT_TRUE(almostEqual(tv_out0.cpu(), at::add(t_in0, t_in1, 2)));
+    auto t_out1 = at::add(at::add(t_in0, t_in1, 2), t_in1, 2);
+    ASSERT_TRUE(almostEqual(tv_out2.cpu(), t_out1 + at::add(t_in0, t_in1, 2)));
+  }
+}
+
 TEST(VulkanTest, conv2d) {
   if (!at::vulkan::is_available())
     return;
@@ -91,6 +110,33 @@ TEST(VulkanTest, conv2d) {
   ASSERT_TRUE(check);
 }
 
+TEST(VulkanTest, conv2dPointwise) {
+  if (!at::vulkan::is_available())
+    return;
+  auto OC = 6;
+  auto C = 5;
+  int64_t H = 3;
+  int64_t W = 7;
+  auto t_in = at::rand({1, C, H, W}, at::device(at::kCPU).dtype(at::kFloat));
+  auto t_w = at::rand({OC, C, 1, 1}, at::device(at::kCPU).dtype(at::kFloat));
+  auto t_b = at::rand({OC}, at::device(at::kCPU).dtype(at::kFloat));
+  auto stride = c10::IntArrayRef{1};
+  auto padding = c10::IntArrayRef{0};
+  auto dilation = c10::IntArrayRef{1};
+  int64_t groups = 1;
+  auto t_out_expected =
+      at::conv2d(t_in, t_w, t_b, stride, padding, dilation, groups);
+  auto tv_in = t_in.vulkan();
+  auto tv_out = at::conv2d(tv_in, t_w, t_b, stride, padding, dilation, groups);
+  auto t_out = tv_out.cpu();
+  bool check = almostEqual(t_out, t_out_expected);
+  if (!check) {
+    std::cout << "expected:\n" << t_out_expected << std::endl;
+    std::cout << "got:\n" << t_out << std::endl;
+  }
+  ASSERT_TRUE(check);
+}
+
 TEST(VulkanTest, conv2dDWWeightsOnCPU) {
   if (!at::vulkan::is_available())
     return;
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#ifdef USE_XNNPACK
+
+#include <ATen/ATen.h>
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/xnnpack/OpContext.h>
+
+using namespace at;
+using namespace at::native::xnnpack;
+
+namespace {
+
+// Restores the release weights flag when a test ends
+struct ReleaseWeightsGuard {
+  explicit ReleaseWeightsGuard(bool release)
+      : prev_(globalContext().releaseWeightsWhenPrepacking()) {
+    globalContext().setReleaseWeightsWhenPrepacking(release);
+  }
+  ~ReleaseWeightsGuard() {
+    globalContext().setReleaseWeightsWhenPrepacking(prev_);
+  }
+
+ private:
+  bool prev_;
+};
+
+c10::intrusive_ptr<LinearOpContext> create_linear(
+    const Tensor& weight,
+    const Tensor& bias) {
+  return XNNPackLinearOpContext::create_context(
+      Tensor(weight), c10::optional<Tensor>(bias), {}, {});
+}
+
+c10::intrusive_ptr<Conv2dOpContext> create_conv2d(
+    const Tensor& weight,
+    const Tensor& bias) {
+  return XNNPackConv2dOpContext::create_context(
+      Tensor(weight), c10::optional<Tensor>(bias), {1, 1}, {1, 1}, {1, 1}, 1,
+      {}, {});
+}
+
+} // namespace
+
+TEST(XNNPACKTest, LinearReleasesWeightsWhenPrepacking) {
+  if (!internal::available()) {
+    return;
+  }
+  auto weight = at::rand({8, 16});
+  auto bias = at::rand({8});
+  auto input = at::rand({4, 16});
+  auto expected = at::linear(input, weight, bias);
+
+  {
+    ReleaseWeightsGuard guard(false);
+    auto context = create_linear(weight, bias);
+    EXPECT_EQ(weight.use_count(), 2);
+    EXPECT_EQ(bias.use_count(), 2);
+    ASSERT_TRUE(at::allclose(context->run(input), expected, 1e-3, 1e-4));
+    auto unpacked = context->unpack();
+    EXPECT_TRUE(std::get<0>(unpacked).is_same(weight));
+    EXPECT_TRUE(std::get<1>(unpacked)->is_same(bias));
+  }
+
+  ReleaseWeightsGuard guard(true);
+  auto context = create_linear(weight, bias);
+  // Only the caller still holds the original weight and bias
+  EXPECT_EQ(weight.use_count(), 1);
+  EXPECT_EQ(bias.use_count(), 1);
+  ASSERT_TRUE(at::allclose(context->run(input), expected, 1e-3, 1e-4));
+  EXPECT_THROW(context->unpack(), c10::Error);
+}
+
+TEST(XNNPACKTest, Conv2dReleasesWeightsWhenPrepacking) {
+  if (!internal::available()) {
+    return;
+  }
+  auto weight = at::rand({8, 3, 3, 3});
+  auto bias = at::rand({8});
+  auto input = at::rand({2, 3, 10, 10});
+  auto expected = at::conv2d(input, weight, bias, 1, 1);
+
+  {
+    ReleaseWeightsGuard guard(false);
+    auto context = create_conv2d(weight, bias);
+    EXPECT_EQ(weight.use_count(), 2);
+    EXPECT_EQ(bias.use_count(), 2);
+    ASSERT_TRUE(at::allclose(context->run(input), expected, 1e-3, 1e-4));
+    auto unpacked = context->unpack();
+    EXPECT_TRUE(std::get<0>(unpacked).is_same(weight));
+    EXPECT_TRUE(std::get<1>(unpacked)->is_same(bias));
+  }
+
+  ReleaseWeightsGuard guard(true);
+  auto context = create_conv2d(weight, bias);
+  EXPECT_EQ(weight.use_count(), 1);
+  EXPECT_EQ(bias.use_count(), 1);
+  ASSERT_TRUE(at::allclose(context->run(input), expected, 1e-3, 1e-4));
+  EXPECT_THROW(context->unpack(), c10::Error);
+}
+
+#endif /* USE_XNNPACK */
@@ -1,5 +1,9 @@
 #include <TH/THBlas.h>
 
+#include <vector>
+
+#include <ATen/native/CPUBlas.h>
+
 #include <TH/generic/THBlas.cpp>
 #include <TH/THGenerateAllTypes.h>
 
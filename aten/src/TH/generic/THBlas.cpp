@@ -273,6 +273,71 @@ void THBlas_(gemm)(
   }
 #endif
 
+#if defined(USE_BLAS) && defined(TH_REAL_IS_BFLOAT16)
+  // There is no BLAS routine for BFloat16, so the operands are widened to
+  // float and multiplied by sgemm, which also accumulates in float. This is
+  // both faster and more accurate than the loops below, which round every
+  // partial sum to BFloat16.
+  if( (m <= INT_MAX) && (n <= INT_MAX) && (k <= INT_MAX) &&
+      (lda <= INT_MAX) && (ldb <= INT_MAX) && (ldc <= INT_MAX) &&
+      (lda >= THMax(1, (transa_ ? k : m))) && (ldb >= THMax(1, (transb_ ? n : k))) &&
+      (ldc >= THMax(1, m)))
+  {
+    int i_m = (int)m;
+    int i_n = (int)n;
+    int i_k = (int)k;
+    int i_lda = (int)lda;
+    int i_ldb = (int)ldb;
+    int i_ldc = (int)ldc;
+    // Only the elements up to the last one of the last column are read, the
+    // matrices may be views into larger buffers.
+    auto matrix_size = [](int64_t rows, int64_t cols, int64_t ld) -> int64_t {
+      return (rows == 0 || cols == 0) ? 0 : ld * (cols - 1) + rows;
+    };
+    const int64_t a_size = matrix_size(transa_ ? k : m, transa_ ? m : k, lda);
+    const int64_t b_size = matrix_size(transb_ ? n : k, transb_ ? k : n, ldb);
+    const int64_t c_size = matrix_size(m, n, ldc);
+    std::vector<float> a_float(a_size);
+    std::vector<float> b_float(b_size);
+    std::vector<float> c_float(c_size, 0.f);
+    for (int64_t i = 0; i < a_size; i++) {
+      a_float[i] = static_cast<float>(a[i]);
+    }
+    for (int64_t i = 0; i < b_size; i++) {
+      b_float[i] = static_cast<float>(b[i]);
+    }
+    if (beta != 0) {
+      for (int64_t i = 0; i < c_size; i++) {
+        c_float[i] = static_cast<float>(c[i]);
+      }
+    }
+    float f_alpha = static_cast<float>(alpha);
+    float f_beta = static_cast<float>(beta);
+    sgemm_(&transa, &transb, &i_m, &i_n, &i_k, &f_alpha, a_float.data(), &i_lda,
+           b_float.data(), &i_ldb, &f_beta, c_float.data(), &i_ldc);
+    for (int64_t j = 0; j < n; j++) {
+      for (int64_t i = 0; i < m; i++) {
+        c[j * ldc + i] = static_cast<scalar_t>(c_float[j * ldc + i]);
+      }
+    }
+    return;
+  }
+#endif
+
+#if !defined(USE_BLAS) && (defined(TH_REAL_IS_DOUBLE) || defined(TH_REAL_IS_FLOAT))
+  // Without BLAS, use the cache blocked and vectorized gemm of ATen rather
+  // than the loops below.
+  at::native::gemm_stub(
+      at::kCPU,
+#if defined(TH_REAL_IS_DOUBLE)
+      at::kDouble,
+#else
+      at::kFloat,
+#endif
+      transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+  return;
+#endif
+
 #if defined(USE_FBGEMM) && defined(TH_REAL_IS_LONG)
   if (alpha == 1 && (beta == 0 || beta == 1)) {
     // In FBGEMM, we assume row-major ordering; However, here we assume the
@@ -4,84 +4,115 @@
 
 
 #include <cuda_runtime_api.h>
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <stdint.h>
 #include <unordered_map>
-#include <unordered_set>
-#include <set>
 #include <utility>
+#include <vector>
 
 namespace {
 
-struct BlockSize
-{
-  size_t  size; // allocation size
-  void*   ptr;  // host memory pointer
+using c10::cuda::CUDACachingAllocator::Stat;
 
-  BlockSize(size_t size, void* ptr=NULL) : size(size), ptr(ptr) {}
-};
+// all sizes are rounded to at least 512 bytes
+constexpr size_t kMinBlockSize = 512;
 
-struct Block : public BlockSize
+// Rounds size up to its size class. There are four size classes per power of
+// two, so rounding wastes at most 25% of a block.
+size_t roundSize(size_t size)
 {
-  bool  allocated;    // true if the block is currently allocated
-  int   event_count;  // number of outstanding cuda events
-  std::unordered_set<at::cuda::CUDAStream> streams;
-
-  Block(size_t size, void* ptr, bool allocated) :
-      BlockSize(size, ptr), allocated(allocated), event_count(0), streams() {}
-};
+  size_t power = kMinBlockSize;
+  while (power < size) {
+    power <<= 1;
+  }
+  const size_t step = power / 8;
+  return (size + step - 1) / step * step;
+}
 
-static bool BlockComparator(const BlockSize& a, const BlockSize& b)
+void updateStat(Stat& stat, int64_t amount)
 {
-  // sort by size, break ties with pointer
-  if (a.size != b.size) {
-    return a.size < b.size;
+  stat.current += amount;
+  THAssert(stat.current >= 0);
+  stat.peak = std::max(stat.current, stat.peak);
+  if (amount > 0) {
+    stat.allocated += amount;
+  } else {
+    stat.freed += -amount;
   }
-  return (uintptr_t)a.ptr < (uintptr_t)b.ptr;
 }
 
-struct HostAllocator
+struct Block
 {
-  typedef bool (*Comparison)(const BlockSize&, const BlockSize&);
+  size_t  size;         // allocation size, a size class
+  void*   ptr;          // host memory pointer
+  bool    allocated;    // true if the block is currently allocated
+  int     event_count;  // number of outstanding cuda events
+  // streams on which the block was used since it was allocated
+  std::vector<at::cuda::CUDAStream> streams;
+
+  Block(size_t size, void* ptr) :
+      size(size), ptr(ptr), allocated(true), event_count(0), streams() {}
+};
 
+struct HostAllocator
+{
   // lock around all operations
   std::mutex mutex;
 
   // blocks by pointer
   std::unordered_map<void*, Block> blocks;
 
-  // pointers that are ready to be allocated (event_count=0)
-  std::set<BlockSize, Comparison> available;
+  // blocks that are ready to be allocated (event_count=0), by size class
+  std::unordered_map<size_t, std::vector<Block*>> available;
+
+  // outstanding cuda events, by the stream they were recorded on. The events
+  // of a stream complete in order, so each queue only needs to be polled up
+  // to its first pending event.
+  std::unordered_map<at::cuda::CUDAStream, std::deque<std::pair<cudaEvent_t, Block*>>> cuda_events;
 
-  // outstanding cuda events
-  std::deque<std::pair<cudaEvent_t, void*>> cuda_events;
+  // completed cuda events kept for reuse, by device
+  std::vector<std::vector<cudaEvent_t>> free_events;
 
-  HostAllocator() : available(BlockComparator) {}
+  THCCachingHostAllocatorStats stats;
 
   cudaError_t malloc(void** ptr, size_t size)
   {
     std::lock_guard<std::mutex> lock(mutex);
 
-    // process outstanding cuda events which may have occurred
-    cudaError_t err = processEvents();
-    if (err != cudaSuccess) {
-      return err;
+    // note that cudaHostAlloc may not touch pointer if size is 0
+    *ptr = 0;
+    if (size == 0) {
+      return cudaSuccess;
     }
+    size = roundSize(size);
 
-    // search for the smallest block which can hold this allocation
-    BlockSize search_key(size);
-    auto it = available.lower_bound(search_key);
-    if (it != available.end()) {
-      Block& block = blocks.at(it->ptr);
-      THAssert(!block.allocated && block.event_count == 0);
-      block.allocated = true;
-      *ptr = block.ptr;
-      available.erase(it);
+    // outstanding cuda events are only processed when no block of this size
+    // class is ready, which keeps cudaEventQuery off the common path
+    Block* block = popAvailable(size);
+    if (!block) {
+      cudaError_t err = processEvents();
+      if (err != cudaSuccess) {
+        return err;
+      }
+      block = popAvailable(size);
+    }
+    if (block) {
+      THAssert(!block->allocated && block->event_count == 0);
+      block->allocated = true;
+      *ptr = block->ptr;
+      updateStat(stats.allocation, 1);
+      updateStat(stats.allocated_bytes, block->size);
       return cudaSuccess;
     }
 
+    const size_t limit = c10::cuda::CUDACachingAllocator::pinnedMaxCachedSize();
+    if (limit > 0) {
+      releaseAvailable(limit > size ? limit - size : 0, /*trim=*/true);
+    }
+
     // Pinned memory pointers allocated by any device can be directly used by any
     // other device, regardless of the current device at the time of allocation,
     // since we assume unified addressing.
@@ -93,16 +124,24 @@ struct HostAllocator
       device_guard.reset_device(at::Device(at::DeviceType::CUDA, *primary_ctx_device_index));
     }
 
-    // note that cudaHostAlloc may not touch pointer if size is 0
-    *ptr = 0;
-
-    // allocate a new block if no cached allocation is found
-    err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
+    // allocate a new block if no cached allocation is found, releasing the
+    // cached blocks and retrying once if the host is out of pinned memory
+    cudaError_t err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
+    if (err == cudaErrorMemoryAllocation) {
+      cudaGetLastError();  // clear CUDA error
+      stats.num_alloc_retries++;
+      releaseAvailable(0, /*trim=*/false);
+      err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
+    }
     if (err != cudaSuccess) {
       return err;
     }
 
-    blocks.insert({*ptr, Block(size, *ptr, true)});
+    blocks.emplace(*ptr, Block(size, *ptr));
+    updateStat(stats.segment, 1);
+    updateStat(stats.reserved_bytes, size);
+    updateStat(stats.allocation, 1);
+    updateStat(stats.allocated_bytes, size);
     return cudaSuccess;
   }
 
@@ -114,12 +153,6 @@ struct HostAllocator
       return cudaSuccess;
     }
 
-    // process outstanding cuda events which may have occurred
-    cudaError_t err = processEvents();
-    if (err != cudaSuccess) {
-      return err;
-    }
-
     auto it = blocks.find(ptr);
     THAssert(it != blocks.end());
 
@@ -129,16 +162,24 @@ struct HostAllocator
     // free (on valid memory) shouldn't fail, so mark unallocated before
     // we process the streams.
     block.allocated = false;
+    updateStat(stats.allocation, -1);
+    updateStat(stats.allocated_bytes, -static_cast<int64_t>(block.size));
 
-    // insert CUDA events for each stream on which this block was used. This
-    err = insertEvents(block);
+    // insert CUDA events for each stream on which this block was used. The
+    // events are processed in bulk by the next malloc that needs them.
+    cudaError_t err = insertEvents(block);
     if (err != cudaSuccess) {
       return err;
     }
 
     if (block.event_count == 0) {
       // the block can be re-used if there are no outstanding cuda events
-      available.insert(block);
+      available[block.size].push_back(&block);
+    }
+
+    const size_t limit = c10::cuda::CUDACachingAllocator::pinnedMaxCachedSize();
+    if (limit > 0) {
+      releaseAvailable(limit, /*trim=*/true);
     }
     return cudaSuccess;
   }
@@ -156,38 +197,41 @@ struct HostAllocator
     Block& block = it->second;
     THAssert(block.allocated);
 
-    block.streams.insert(stream);
+    if (std::find(block.streams.begin(), block.streams.end(), stream) == block.streams.end()) {
+      block.streams.push_back(stream);
+    }
     return cudaSuccess;
   }
 
   cudaError_t processEvents()
   {
     // Process outstanding cudaEvents. Events that are completed are removed
-    // from the queue, and the 'event_count' for the corresponding allocation
-    // is decremented. Stops at the first event which has not been completed.
-    // Since events on different devices or streams may occur out of order,
-    // the processing of some events may be delayed.
-    while (!cuda_events.empty()) {
-      auto& e = cuda_events.front();
-      cudaEvent_t event = e.first;
-
-      cudaError_t err = cudaEventQuery(event);
-      if (err == cudaErrorNotReady) {
-        break;
-      } else if (err != cudaSuccess) {
-        return err;
-      }
-      err = cudaEventDestroy(event);
-      if (err != cudaSuccess) {
-        return err;
+    // from the queue of their stream, and the 'event_count' for the
+    // corresponding allocation is decremented. Events recorded on the same
+    // stream complete in order, so each queue stops at its first event which
+    // has not been completed, without delaying the queues of other streams.
+    for (auto& stream_events : cuda_events) {
+      auto& events = stream_events.second;
+      while (!events.empty()) {
+        auto& e = events.front();
+        cudaEvent_t event = e.first;
+
+        cudaError_t err = cudaEventQuery(event);
+        if (err == cudaErrorNotReady) {
+          cudaGetLastError();  // clear CUDA error
+          break;
+        } else if (err != cudaSuccess) {
+          return err;
+        }
+        free_events[stream_events.first.device_index()].push_back(event);
+
+        Block* block = e.second;
+        block->event_count--;
+        if (block->event_count == 0 && !block->allocated) {
+          available[block->size].push_back(block);
+        }
+        events.pop_front();
       }
-
-      Block& block = blocks.at(e.second);
-      block.event_count--;
-      if (block.event_count == 0 && !block.allocated) {
-        available.insert(block);
-      }
-      cuda_events.pop_front();
     }
     return cudaSuccess;
   }
@@ -196,56 +240,134 @@ struct HostAllocator
   {
     std::lock_guard<std::mutex> lock(mutex);
 
-    // remove events for freed blocks
-    for (auto it = cuda_events.begin(); it != cuda_events.end(); ++it) {
-      cudaEvent_t event = it->first;
-      Block& block = blocks.at(it->second);
-      if (!block.allocated) {
+    // Outstanding events all belong to freed blocks, since blocks are not
+    // reallocated before their events complete. cudaFreeHost synchronizes
+    // with the device, so these blocks can be freed along with the
+    // available ones.
+    for (auto& stream_events : cuda_events) {
+      for (auto& e : stream_events.second) {
+        THCudaCheckWarn(cudaEventDestroy(e.first));
+        Block* block = e.second;
+        block->event_count--;
+        if (block->event_count == 0) {
+          available[block->size].push_back(block);
+        }
+      }
+    }
+    cuda_events.clear();
+
+    for (auto& events : free_events) {
+      for (cudaEvent_t event : events) {
         THCudaCheckWarn(cudaEventDestroy(event));
-        block.event_count--;
       }
+      events.clear();
     }
 
-    // all cuda_events have been processed
-    cuda_events.clear();
+    releaseAvailable(0, /*trim=*/false);
+  }
 
-    // clear list of available blocks
-    available.clear();
+  THCCachingHostAllocatorStats getStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+  }
 
-    // free and erase non-allocated blocks
-    for (auto it = blocks.begin(); it != blocks.end();) {
-      Block& block = it->second;
-      if (!block.allocated) {
-        THCudaCheckWarn(cudaFreeHost(block.ptr));
-        it = blocks.erase(it);
-      } else {
-        ++it;
+  void resetAccumulatedStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Stat* stat : {&stats.allocation, &stats.segment,
+                       &stats.allocated_bytes, &stats.reserved_bytes}) {
+      stat->allocated = 0;
+      stat->freed = 0;
+    }
+    stats.num_trims = 0;
+    stats.num_alloc_retries = 0;
+  }
+
+  void resetPeakStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Stat* stat : {&stats.allocation, &stats.segment,
+                       &stats.allocated_bytes, &stats.reserved_bytes}) {
+      stat->peak = stat->current;
+    }
+  }
+
+ private:
+
+  Block* popAvailable(size_t size)
+  {
+    auto it = available.find(size);
+    if (it == available.end() || it->second.empty()) {
+      return nullptr;
+    }
+    // the most recently freed block is the most likely to be in cache
+    Block* block = it->second.back();
+    it->second.pop_back();
+    return block;
+  }
+
+  // Frees available blocks via cudaFreeHost until at most 'target' bytes
+  // stay pinned, or no block is available.
+  void releaseAvailable(size_t target, bool trim)
+  {
+    for (auto& size_blocks : available) {
+      auto& free_blocks = size_blocks.second;
+      while (!free_blocks.empty() &&
+             static_cast<size_t>(stats.reserved_bytes.current) > target) {
+        Block* block = free_blocks.back();
+        free_blocks.pop_back();
+        const size_t size = block->size;
+        THCudaCheckWarn(cudaFreeHost(block->ptr));
+        blocks.erase(block->ptr);
+        updateStat(stats.segment, -1);
+        updateStat(stats.reserved_bytes, -static_cast<int64_t>(size));
+        if (trim) {
+          stats.num_trims++;
+        }
       }
     }
   }
 
   cudaError_t insertEvents(Block& block)
   {
+    if (block.streams.empty()) {
+      return cudaSuccess;
+    }
+
     cudaError_t err;
 
     int prev_device;
     err = cudaGetDevice(&prev_device);
     if (err != cudaSuccess) return err;
 
-    std::unordered_set<at::cuda::CUDAStream> streams(std::move(block.streams));
-    for (auto it = streams.begin(); it != streams.end(); ++it) {
-      err = cudaSetDevice(it->device_index());
+    std::vector<at::cuda::CUDAStream> streams(std::move(block.streams));
+    block.streams.clear();
+    for (const auto& stream : streams) {
+      const auto device = stream.device_index();
+      err = cudaSetDevice(device);
       if (err != cudaSuccess) break;
 
+      if (free_events.size() <= static_cast<size_t>(device)) {
+        free_events.resize(device + 1);
+      }
       cudaEvent_t event;
-      err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
-      if (err != cudaSuccess) break;
+      if (free_events[device].empty()) {
+        err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+        if (err != cudaSuccess) break;
+      } else {
+        event = free_events[device].back();
+        free_events[device].pop_back();
+      }
 
-      err = cudaEventRecord(event, it->stream());
-      if (err != cudaSuccess) break;
+      err = cudaEventRecord(event, stream.stream());
+      if (err != cudaSuccess) {
+        free_events[device].push_back(event);
+        break;
+      }
 
       block.event_count++;
-      cuda_events.emplace_back(event, block.ptr);
+      cuda_events[stream].emplace_back(event, &block);
     }
 
     cudaSetDevice(prev_device);
@@ -267,6 +389,21 @@ void THCCachingHostAllocator_emptyCache()
   allocator.emptyCache();
 }
 
+THCCachingHostAllocatorStats THCCachingHostAllocator_getStats()
+{
+  return allocator.getStats();
+}
+
+void THCCachingHostAllocator_resetAccumulatedStats()
+{
+  allocator.resetAccumulatedStats();
+}
+
+void THCCachingHostAllocator_resetPeakStats()
+{
+  allocator.resetPeakStats();
+}
+
 static void THCCachingHostDeleter(void* ptr) {
   allocator.free(ptr);
 }
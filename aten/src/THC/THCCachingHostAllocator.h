@@ -4,6 +4,7 @@
 #include <THC/THCGeneral.h>
 
 
+#include <c10/cuda/CUDACachingAllocator.h>
 #include <c10/cuda/CUDAStream.h>
 
 //
@@ -18,8 +19,19 @@
 // call between host and device. We implement this for storages and tensors in
 // copy_from_cpu_async_ and copy_to_cpu_async_.
 //
-// Note that this allocator does not split larger allocations into smaller
-// blocks, unlike the caching device allocator.
+// Requests are rounded up to size classes, four per power of two, and freed
+// blocks are only reused for requests of the same size class. Note that this
+// allocator does not split larger allocations into smaller blocks, unlike the
+// caching device allocator.
+//
+// A freed block that was used on some streams is reused once the events
+// recorded on these streams at free time have completed. The events are
+// queued per stream and only polled when an allocation finds no free block
+// of its size class.
+//
+// The pinned_max_cached_mb option of PYTORCH_CUDA_ALLOC_CONF bounds the
+// pinned memory held by the allocator: before pinning more memory past the
+// bound, cached blocks are released with cudaFreeHost.
 //
 THC_API c10::Allocator* getTHCCachingHostAllocator(void);
 
@@ -30,4 +42,25 @@ THC_API cudaError_t THCCachingHostAllocator_recordEvent(void *ptr, at::cuda::CUD
 // Releases cached pinned memory allocations via cudaHostFree
 THC_API void THCCachingHostAllocator_emptyCache(void);
 
+// Summary statistics of the caching host allocator.
+struct THCCachingHostAllocatorStats {
+  // COUNT: allocations requested by client code
+  c10::cuda::CUDACachingAllocator::Stat allocation;
+  // COUNT: number of blocks pinned with cudaHostAlloc
+  c10::cuda::CUDACachingAllocator::Stat segment;
+  // SUM: bytes of the blocks handed to client code
+  c10::cuda::CUDACachingAllocator::Stat allocated_bytes;
+  // SUM: bytes pinned by this allocator (both free and used)
+  c10::cuda::CUDACachingAllocator::Stat reserved_bytes;
+
+  // COUNT: blocks released to stay under pinned_max_cached_mb
+  int64_t num_trims = 0;
+  // COUNT: failed calls to cudaHostAlloc necessitating cache flushes
+  int64_t num_alloc_retries = 0;
+};
+
+THC_API THCCachingHostAllocatorStats THCCachingHostAllocator_getStats(void);
+THC_API void THCCachingHostAllocator_resetAccumulatedStats(void);
+THC_API void THCCachingHostAllocator_resetPeakStats(void);
+
 #endif
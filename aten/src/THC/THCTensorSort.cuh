@@ -8,9 +8,16 @@
 #include <THC/THCTensorCopy.h>
 #include <THC/THCTensorTypeUtils.cuh>
 
+#include <ATen/native/cuda/SortingRadixSelect.cuh>
+#include <c10/cuda/CUDAStream.h>
+
 #include <THC/THCThrustAllocator.cuh>
 #include <thrust/device_ptr.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/sequence.h>
 #include <thrust/sort.h>
+#include <thrust/transform.h>
 #if CUDA_VERSION >= 7000 || defined(__HIP_PLATFORM_HCC__)
 #include <thrust/system/cuda/execution_policy.h>
 #endif
@@ -29,36 +36,48 @@ struct ThrustLTOp {
   }
 };
 
-template <typename T, typename IndT, bool handleNaN = true>
-struct ThrustSliceGTOp {
-ThrustSliceGTOp(int64_t size) : sliceSize(size) {}
-  __device__ bool operator()(const thrust::tuple<int64_t, T>& lhs, const thrust::tuple<int64_t, T>& rhs) const {
-    IndT segA = (IndT)thrust::get<0>(lhs) / sliceSize;
-    IndT segB = (IndT)thrust::get<0>(rhs) / sliceSize;
-    if (segA != segB)
-        return segA < segB;
-    else
-        return (handleNaN && THCNumerics<T>::isnan(thrust::get<1>(lhs)) && !THCNumerics<T>::isnan(thrust::get<1>(rhs))) || THCNumerics<T>::gt(thrust::get<1>(lhs), thrust::get<1>(rhs));
+// Converts keys to the unsigned integers of TopKTypeConfig, which sort like
+// the keys with NaN last, so that Thrust sorts them with a radix sort
+// instead of a comparison sort. The bits are flipped for descending sorts,
+// which puts NaN first like GTComp does.
+template <typename T>
+struct ThrustToRadixKeyOp {
+  using RadixType = typename at::native::TopKTypeConfig<T>::RadixType;
+
+  ThrustToRadixKeyOp(bool descending) : descending(descending) {}
+
+  __device__ inline RadixType operator()(const T& v) const {
+    RadixType x = at::native::TopKTypeConfig<T>::convert(v);
+    return descending ? ~x : x;
   }
-  const IndT sliceSize;
+
+  const bool descending;
 };
 
-template <typename T, typename IndT, bool handleNaN = true>
-struct ThrustSliceLTOp {
-ThrustSliceLTOp(int64_t size) : sliceSize(size) {}
-  __device__ bool operator()(const thrust::tuple<int64_t, T>& lhs, const thrust::tuple<int64_t, T>& rhs) const {
-    IndT segA = (IndT)thrust::get<0>(lhs) / sliceSize;
-    IndT segB = (IndT)thrust::get<0>(rhs) / sliceSize;
-    if (segA != segB)
-        return segA < segB;
-    else
-        return (handleNaN && THCNumerics<T>::isnan(thrust::get<1>(rhs)) && !THCNumerics<T>::isnan(thrust::get<1>(lhs))) || THCNumerics<T>::lt(thrust::get<1>(lhs), thrust::get<1>(rhs));
+template <typename T>
+struct ThrustFromRadixKeyOp {
+  using RadixType = typename at::native::TopKTypeConfig<T>::RadixType;
+
+  ThrustFromRadixKeyOp(bool descending) : descending(descending) {}
+
+  __device__ inline T operator()(const RadixType& x) const {
+    return at::native::TopKTypeConfig<T>::deconvert(descending ? ~x : x);
   }
-  const IndT sliceSize;
+
+  const bool descending;
 };
 
+// Extracts the slice of a linear index
+template <typename IndT>
+struct GlobalIndexToSlice {
+  GlobalIndexToSlice(int64_t size) : sliceSize(size) {}
 
+  __device__ inline IndT operator()(const int64_t& v) const {
+    return static_cast<IndT>(v / sliceSize);
+  }
 
+  const int64_t sliceSize;
+};
 
 // `base` is the base address of a tensor
 // For each slice (defined as a linear point of `out`, from 0 ->
@@ -97,6 +116,53 @@ struct GlobalIndexToPerSliceIndex {
   const int64_t sliceSize;
 };
 
+// Sorts the consecutive slices of sliceSize `keys` in place, and fills
+// `indices` with the position of every sorted key in its slice.
+//
+// The keys are radix sorted together with their linear index, then the
+// linear indices are stably radix sorted by slice, which keeps the order of
+// the keys within each slice. Unlike sorting every slice separately, the
+// number of kernel launches does not depend on the number of slices.
+template <typename T, typename IndT>
+void THCSegmentedRadixSort(THCState* state,
+                           T* keys,
+                           int64_t* indices,
+                           int64_t totalElements,
+                           int64_t sliceSize,
+                           bool descending) {
+  using RadixType = typename at::native::TopKTypeConfig<T>::RadixType;
+  RadixType* radixKeys = static_cast<RadixType*>(
+    THCudaMalloc(state, totalElements * sizeof(RadixType)));
+  IndT* slices = static_cast<IndT*>(
+    THCudaMalloc(state, totalElements * sizeof(IndT)));
+
+  THCThrustAllocator thrustAlloc(state);
+  auto policy = thrust::cuda::par(thrustAlloc).on(c10::cuda::getCurrentCUDAStream());
+  thrust::device_ptr<T> keyIter(keys);
+  thrust::device_ptr<int64_t> indexIter(indices);
+  thrust::device_ptr<RadixType> radixKeyIter(radixKeys);
+  thrust::device_ptr<IndT> sliceIter(slices);
+
+  thrust::sequence(policy, indexIter, indexIter + totalElements);
+  thrust::transform(policy, keyIter, keyIter + totalElements, radixKeyIter,
+                    ThrustToRadixKeyOp<T>(descending));
+  thrust::stable_sort_by_key(policy, radixKeyIter, radixKeyIter + totalElements,
+                             indexIter);
+
+  thrust::transform(policy, indexIter, indexIter + totalElements, sliceIter,
+                    GlobalIndexToSlice<IndT>(sliceSize));
+  thrust::stable_sort_by_key(policy, sliceIter, sliceIter + totalElements,
+                             thrust::make_zip_iterator(thrust::make_tuple(indexIter, radixKeyIter)));
+
+  thrust::transform(policy, radixKeyIter, radixKeyIter + totalElements, keyIter,
+                    ThrustFromRadixKeyOp<T>(descending));
+  thrust::for_each(policy, indexIter, indexIter + totalElements,
+                   GlobalIndexToPerSliceIndex(sliceSize));
+
+  THCudaFree(state, slices);
+  THCudaFree(state, radixKeys);
+}
+
 void THCudaLongTensor_fillSliceWithIndex(THCState* state,
                                          THCudaLongTensor* t,
                                          int dim);
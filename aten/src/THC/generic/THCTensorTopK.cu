@@ -155,7 +155,8 @@ void THCTensor_(topk)(THCState* state,
 #else
     int maxSliceSize = 2048;
 #endif
-    if (sliceSize <= maxSliceSize) {
+    // Only the k selected values of each slice are sorted
+    if (k <= maxSliceSize) {
       // This avoids any memory allocations and performs all sorting
       // work inplace along the slice
       THCTensor_(sortKeyValueInplace)(state, topK, indices, dim, dir);
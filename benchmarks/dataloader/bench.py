@@ -0,0 +1,34 @@
+import argparse
+import os
+
+from torch.utils.cpp_extension import load
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Measures C++ DataLoader throughput against the number of workers")
+    parser.add_argument("--workers", type=int, nargs="+", default=[1, 2, 4, 8, 16, 32, 64])
+    parser.add_argument("--batch-size", type=int, default=1)
+    parser.add_argument("--examples", type=int, default=200000)
+    parser.add_argument("--features", type=int, default=16)
+    parser.add_argument("--repeats", type=int, default=3)
+    parser.add_argument("--no-enforce-ordering", action="store_true")
+    args = parser.parse_args()
+
+    bench = load(
+        name="dataloader_bench",
+        sources=[os.path.join(os.path.dirname(os.path.abspath(__file__)), "dataloader_bench.cpp")],
+        extra_cflags=["-O2"])
+
+    print("{:>8} {:>20}".format("workers", "examples/s (best)"))
+    for workers in args.workers:
+        best = max(
+            bench.examples_per_second(
+                workers, args.batch_size, args.examples, args.features,
+                not args.no_enforce_ordering)
+            for _ in range(args.repeats))
+        print("{:>8} {:>20.0f}".format(workers, best))
+
+
+if __name__ == "__main__":
+    main()
@@ -8,6 +8,14 @@ def add_tensors_loop(x, y):
         z = torch.add(z, x)
     return z
 
+def add_mixed_loop(x, y):
+    # Alternates between the Tensor and Scalar overloads of add
+    z = torch.add(x, y)
+    for i in range(NUM_LOOP_ITERS):
+        z = torch.add(z, 1.0)
+        z = torch.add(z, x)
+    return z
+
 class SimpleAddModule(torch.nn.Module):
     def __init__(self, add_op):
         super(SimpleAddModule, self).__init__()
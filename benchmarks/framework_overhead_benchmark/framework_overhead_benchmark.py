@@ -3,12 +3,13 @@ from utils import ms_to_us, benchmark_module, BenchmarkConfig, ModuleConfig
 import argparse
 from C2Module import C2SimpleNet
 
-from SimpleAddModule import SimpleAddModule, add_tensors_loop
+import torch
+from SimpleAddModule import SimpleAddModule, add_tensors_loop, add_mixed_loop
 from pt_wrapper_module import WrapperModule
 
 """ Framework overhead benchmark script.
 Benchmark framework overhead.
-Currently supported ops: add.
+Currently supported ops: add, add_mixed (alternates between overloads of add).
 As of now runs only forward pass.
 Supports both graph mode and eager mode. In graph mode the module is traced via JIT tracing.
 Debug option prints the traced graph is graph_mode is enabled.
@@ -19,12 +20,15 @@ buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_ben
  --add_op --graph_mode --eager_mode (Runs both graph mode and eager mode)
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --graph_mode (Runs only graph mode)
+To measure the cost of overload resolution in eager mode:
+buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
+ --op add_mixed_op --eager_mode --compare_overload_cache
 To run C2 benchmark:
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --benchmark_c2_net
 """
 
-SUPPORTED_OPS = {"add_op"}
+SUPPORTED_OPS = {"add_op", "add_mixed_op"}
 
 def parse_op_args(op):
     op_list = ops.split(",")
@@ -72,6 +76,9 @@ def main():
     parser.add_argument("--eager_mode", default=False, dest="eager_mode", action="store_true")
     parser.add_argument("--num_warmup_iters", type=int, default=100)
     parser.add_argument("--num_iters", type=int, default=1000)
+    parser.add_argument("--compare_overload_cache", default=False, dest="compare_overload_cache",
+                        action="store_true",
+                        help="Also run with the overload cache of the Python argument parser disabled")
     args = parser.parse_args()
 
     if args.op not in SUPPORTED_OPS:
@@ -94,6 +101,20 @@ def main():
         else:
             module_config = ModuleConfig(add_tensors_loop, None, num_params, graph_mode)
         benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
+    elif args.op == "add_mixed_op":
+        assert not args.benchmark_c2_net, "add_mixed_op is not supported for C2"
+        module_config = ModuleConfig(add_mixed_loop, None, 2, graph_mode)
+        benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
+    if args.compare_overload_cache and not args.benchmark_c2_net:
+        cached = dict(result)
+        result = {}
+        torch._C._set_arg_parser_overload_cache(False)
+        try:
+            benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
+        finally:
+            torch._C._set_arg_parser_overload_cache(True)
+        result = dict([(key + ",Overload cache:True", value) for key, value in cached.items()] +
+                      [(key + ",Overload cache:False", value) for key, value in result.items()])
     print_results(result)
 
 if __name__ == "__main__":
@@ -42,3 +42,11 @@ def generate_pt_tests_from_op_list(ops_list, configs, pt_bench_op):
     """
     for op in ops_list:
         _register_test(configs, pt_bench_op, create_pytorch_op_test_case, False, op)
+
+
+def generate_pt_gradient_tests_from_op_list(ops_list, configs, pt_bench_op):
+    """ This function creates pt op gradient tests one by one from a list of
+        dictionaries, as generate_pt_tests_from_op_list does for the forward.
+    """
+    for op in ops_list:
+        _register_test(configs, pt_bench_op, create_pytorch_op_test_case, True, op)
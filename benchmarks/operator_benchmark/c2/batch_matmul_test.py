@@ -0,0 +1,59 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+
+import operator_benchmark as op_bench
+import benchmark_caffe2 as op_bench_c2
+from benchmark_caffe2 import Caffe2BenchmarkBase # noqa
+from caffe2.python import core
+
+"""Microbenchmarks for BatchMatMul operator with a 2D B, with the default BLAS
+gemm and with the fp16 gemm of fbgemm (engine FBGEMM_FP16)"""
+
+# Configs for C2 BatchMatMul operator
+batch_mm_long_configs = op_bench.cross_product_configs(
+    B=[1, 4, 16],
+    M=[1, 2, 4, 8],
+    N=[64, 256],
+    K=[64, 256],
+    engine=["", "FBGEMM_FP16"],
+    tags=["long"]
+)
+
+
+batch_mm_short_configs = op_bench.config_list(
+    attrs=[
+        [4, 1, 256, 256, ""],
+        [4, 1, 256, 256, "FBGEMM_FP16"],
+        [16, 8, 256, 64, ""],
+        [16, 8, 256, 64, "FBGEMM_FP16"],
+    ],
+    attr_names=["B", "M", "N", "K", "engine"],
+    tags=["short"],
+)
+
+
+class BatchMatMulBenchmark(op_bench_c2.Caffe2BenchmarkBase):
+    def init(self, B, M, N, K, engine):
+        self.input_one = self.tensor([B, M, K])
+        self.input_two = self.tensor([K, N])
+        self.output = self.tensor([B, M, N])
+        self.args = {"broadcast": True, "constant_b": True, "engine": engine}
+        self.set_module_name("batch_matmul")
+
+    def forward(self):
+        op = core.CreateOperator(
+            "BatchMatMul", [self.input_one, self.input_two], self.output, **self.args
+        )
+        return op
+
+
+op_bench_c2.generate_c2_test(
+    batch_mm_long_configs + batch_mm_short_configs, BatchMatMulBenchmark
+)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
@@ -0,0 +1,60 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+
+import operator_benchmark as op_bench
+import benchmark_caffe2 as op_bench_c2
+from benchmark_caffe2 import Caffe2BenchmarkBase # noqa
+from caffe2.python import core
+
+"""Microbenchmarks for FC operator, with the default BLAS gemm and with the
+fp16 gemm of fbgemm (engine FBGEMM_FP16)"""
+
+# Configs for C2 FC operator
+fc_long_configs = op_bench.cross_product_configs(
+    M=[1, 2, 4, 8, 64],
+    N=[64, 256, 1024],
+    K=[64, 256, 1024],
+    engine=["", "FBGEMM_FP16"],
+    tags=["long"]
+)
+
+
+fc_short_configs = op_bench.config_list(
+    attrs=[
+        [1, 512, 512, ""],
+        [1, 512, 512, "FBGEMM_FP16"],
+        [8, 1024, 512, ""],
+        [8, 1024, 512, "FBGEMM_FP16"],
+    ],
+    attr_names=["M", "N", "K", "engine"],
+    tags=["short"],
+)
+
+
+class FCBenchmark(op_bench_c2.Caffe2BenchmarkBase):
+    def init(self, M, N, K, engine):
+        self.input_one = self.tensor([M, K])
+        self.input_two = self.tensor([N, K])
+        self.input_three = self.tensor([N])
+        self.output = self.tensor([M, N])
+        self.engine = engine
+        self.set_module_name("fc")
+
+    def forward(self):
+        op = core.CreateOperator(
+            "FC",
+            [self.input_one, self.input_two, self.input_three],
+            self.output,
+            engine=self.engine,
+        )
+        return op
+
+
+op_bench_c2.generate_c2_test(fc_long_configs + fc_short_configs, FCBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
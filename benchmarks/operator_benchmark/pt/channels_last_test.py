@@ -0,0 +1,74 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import operator_benchmark as op_bench
+import torch
+import torch.nn as nn
+
+
+"""
+Microbenchmarks comparing the contiguous (NCHW) and channels last (NHWC)
+memory formats of the CPU kernels of the usual CNN operators.
+"""
+
+
+channels_last_configs_short = op_bench.config_list(
+    attr_names=['N', 'C', 'H', 'W'],
+    attrs=[
+        [1, 64, 56, 56],
+    ],
+    cross_product_configs={
+        'memory_format': ['contiguous', 'channels_last'],
+        'device': ['cpu'],
+    },
+    tags=['short']
+)
+
+channels_last_configs_long = op_bench.cross_product_configs(
+    N=[8, 32],
+    C=[64, 256],
+    H=[28],
+    W=[28],
+    memory_format=['contiguous', 'channels_last'],
+    device=['cpu'],
+    tags=['long']
+)
+
+channels_last_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['Conv2d', lambda C: nn.Conv2d(C, C, 3, padding=1)],
+        ['MaxPool2d', lambda C: nn.MaxPool2d(3, stride=2, padding=1)],
+        ['AdaptiveAvgPool2d', lambda C: nn.AdaptiveAvgPool2d((7, 7))],
+        ['BatchNorm2d', lambda C: nn.BatchNorm2d(C)],
+        ['UpsampleNearest2d', lambda C: nn.Upsample(scale_factor=2, mode='nearest')],
+        ['UpsampleBilinear2d', lambda C: nn.Upsample(scale_factor=2, mode='bilinear', align_corners=False)],
+    ],
+)
+
+
+class ChannelsLastBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, N, C, H, W, memory_format, device, op_func):
+        memory_format = (torch.channels_last if memory_format == 'channels_last'
+                         else torch.contiguous_format)
+        self.input = torch.rand(N, C, H, W, device=device, requires_grad=self.auto_set())
+        self.input = self.input.detach().contiguous(memory_format=memory_format).requires_grad_(
+            self.input.requires_grad)
+        self.op_func = op_func(C).to(device=device, memory_format=memory_format)
+
+    def forward(self):
+        return self.op_func(self.input)
+
+
+op_bench.generate_pt_tests_from_op_list(channels_last_ops_list,
+                                        channels_last_configs_short + channels_last_configs_long,
+                                        ChannelsLastBenchmark)
+op_bench.generate_pt_gradient_tests_from_op_list(channels_last_ops_list,
+                                                 channels_last_configs_short + channels_last_configs_long,
+                                                 ChannelsLastBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
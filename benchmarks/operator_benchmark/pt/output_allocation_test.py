@@ -0,0 +1,45 @@
+import operator_benchmark as op_bench
+import torch
+
+
+"""Microbenchmarks for the allocation of the outputs of small ops. An op
+allocating its output is compared to its out= variant writing into a
+preallocated tensor; the difference is the cost of the allocation."""
+
+
+output_allocation_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['add', lambda in1, in2, out: torch.add(in1, in2)],
+        ['add_out', lambda in1, in2, out: torch.add(in1, in2, out=out)],
+        ['empty', lambda in1, in2, out: torch.empty(in1.shape)],
+        ['empty_strided',
+         lambda in1, in2, out: torch.empty_strided(in1.shape, in1.stride())],
+    ],
+)
+
+output_allocation_configs = op_bench.cross_product_configs(
+    numel=[1, 64, 1024],
+    device=['cpu'],
+    tags=['short']
+)
+
+
+class OutputAllocationBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, numel, device, op_func):
+        self.input_one = torch.rand(numel, device=device)
+        self.input_two = torch.rand(numel, device=device)
+        self.output = torch.empty(numel, device=device)
+        self.op_func = op_func
+
+    def forward(self):
+        return self.op_func(self.input_one, self.input_two, self.output)
+
+
+op_bench.generate_pt_tests_from_op_list(output_allocation_ops_list,
+                                        output_allocation_configs,
+                                        OutputAllocationBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
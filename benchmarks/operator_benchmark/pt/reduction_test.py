@@ -0,0 +1,56 @@
+import operator_benchmark as op_bench
+import torch
+
+
+"""Microbenchmarks for reductions over the inner, outer and channel
+dimensions of CPU tensors."""
+
+
+reduction_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['sum', lambda x, dim: x.sum(dim)],
+        ['mean', lambda x, dim: x.mean(dim)],
+        ['norm', lambda x, dim: x.norm(2, dim)],
+        ['amax', lambda x, dim: x.max(dim)],
+        ['argmax', lambda x, dim: x.argmax(dim)],
+    ],
+)
+
+# layout 'inner' reduces the contiguous dimension, 'outer' reduces dim 0 of
+# a contiguous matrix, 'tall' is the same on a tall and narrow matrix and
+# 'channels_last' reduces the width of an NHWC tensor, whose channels are
+# contiguous.
+reduction_configs = op_bench.cross_product_configs(
+    numel=[2 ** 16, 2 ** 22],
+    layout=['inner', 'outer', 'tall', 'channels_last'],
+    device=['cpu'],
+    tags=['short']
+)
+
+
+class ReductionBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, numel, layout, device, op_func):
+        if layout == 'channels_last':
+            channels = 64
+            side = int((numel // (2 * channels)) ** 0.5)
+            self.input = torch.rand(2, channels, side, side, device=device).contiguous(
+                memory_format=torch.channels_last)
+            self.dim = 3
+        else:
+            cols = 8 if layout == 'tall' else int(numel ** 0.5)
+            self.input = torch.rand(numel // cols, cols, device=device)
+            self.dim = 1 if layout == 'inner' else 0
+        self.op_func = op_func
+
+    def forward(self):
+        return self.op_func(self.input, self.dim)
+
+
+op_bench.generate_pt_tests_from_op_list(reduction_ops_list,
+                                        reduction_configs,
+                                        ReductionBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
@@ -0,0 +1,52 @@
+import operator_benchmark as op_bench
+import torch
+
+
+"""Microbenchmarks for elementwise operators on small tensors, where the
+setup of the TensorIterator dominates the cost of the kernel."""
+
+
+small_elementwise_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['add', torch.add],
+        ['mul', torch.mul],
+        ['add_', lambda in1, in2: in1.add_(in2)],
+        ['lt', torch.lt],
+    ],
+)
+
+# layout 'contiguous' takes the fast setup path of TensorIterator, the other
+# layouts go through the general path (broadcast, reordered or coalesced
+# dimensions) whose geometry is cached across calls.
+small_elementwise_configs = op_bench.cross_product_configs(
+    numel=[16, 256, 4096],
+    layout=['contiguous', 'broadcast', 'transposed'],
+    device=['cpu'],
+    tags=['short']
+)
+
+
+class SmallElementwiseBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, numel, layout, device, op_func):
+        side = int(numel ** 0.5)
+        self.input_one = torch.rand(side, side, device=device)
+        if layout == 'contiguous':
+            self.input_two = torch.rand(side, side, device=device)
+        elif layout == 'broadcast':
+            self.input_two = torch.rand(side, device=device)
+        else:
+            self.input_two = torch.rand(side, side, device=device).t()
+        self.op_func = op_func
+
+    def forward(self):
+        return self.op_func(self.input_one, self.input_two)
+
+
+op_bench.generate_pt_tests_from_op_list(small_elementwise_ops_list,
+                                        small_elementwise_configs,
+                                        SmallElementwiseBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
@@ -0,0 +1,59 @@
+import io
+
+import torch
+from pyarkbench import Benchmark, Timer, default_args
+from typing import Dict, List
+
+
+# Loading a TorchScript module unpickles its attributes and constants with the
+# C++ Unpickler. These modules hold many small containers, so that unpickling
+# them rather than reading tensor data dominates loading.
+class ManyDicts(torch.nn.Module):
+    def __init__(self, n):
+        super(ManyDicts, self).__init__()
+        self.tensors = {}  # type: Dict[str, torch.Tensor]
+        self.lists = {}  # type: Dict[str, List[int]]
+        for i in range(n):
+            self.tensors["tensor_" + str(i)] = torch.ones(1)
+            self.lists["list_" + str(i)] = list(range(10))
+
+    def forward(self, x):
+        return x
+
+
+class ManyLists(torch.nn.Module):
+    def __init__(self, n):
+        super(ManyLists, self).__init__()
+        self.nested = [[float(j) for j in range(10)] for i in range(n)]  # type: List[List[float]]
+        self.names = ["name_" + str(i) for i in range(n)]  # type: List[str]
+
+    def forward(self, x):
+        return x
+
+
+def save_to_buffer(module):
+    buffer = io.BytesIO()
+    torch.jit.save(torch.jit.script(module), buffer)
+    return buffer.getvalue()
+
+
+class Unpickle(Benchmark):
+    def benchmark(self):
+        dicts = save_to_buffer(ManyDicts(10000))
+        lists = save_to_buffer(ManyLists(10000))
+
+        with Timer() as dicts_load:
+            torch.jit.load(io.BytesIO(dicts))
+
+        with Timer() as lists_load:
+            torch.jit.load(io.BytesIO(lists))
+
+        return {
+            "Many Dicts Load": dicts_load.ms_duration,
+            "Many Lists Load": lists_load.ms_duration,
+        }
+
+if __name__ == '__main__':
+    bench = Unpickle(*default_args.bench())
+    results = bench.run()
+    bench.print_stats(results, stats=['mean', 'median'])
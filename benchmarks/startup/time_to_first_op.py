@@ -0,0 +1,58 @@
+"""Measures the startup cost of a process using PyTorch.
+
+Every run starts a fresh interpreter that reports the time it took to import
+torch, to run a first eager operator, and to script and run a first
+TorchScript function. The medians over all the runs are printed.
+
+    python time_to_first_op.py --runs 20
+"""
+
+import argparse
+import json
+import statistics
+import subprocess
+import sys
+
+CHILD = """
+import json, time
+start = time.perf_counter()
+import torch
+imported = time.perf_counter()
+x = torch.ones(2, 2)
+torch.add(x, x)
+first_op = time.perf_counter()
+
+@torch.jit.script
+def f(a, b):
+    return a * b + a
+
+f(x, x)
+first_script_op = time.perf_counter()
+print(json.dumps({
+    "import": imported - start,
+    "first_op": first_op - imported,
+    "first_script_op": first_script_op - first_op,
+}))
+"""
+
+
+def run_once():
+    out = subprocess.check_output([sys.executable, "-c", CHILD])
+    return json.loads(out.decode().strip().splitlines()[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--runs", type=int, default=10)
+    args = parser.parse_args()
+
+    results = [run_once() for _ in range(args.runs)]
+    for key in ("import", "first_op", "first_script_op"):
+        median = statistics.median(r[key] for r in results)
+        print("{:<16} {:8.1f} ms".format(key, median * 1000))
+    total = statistics.median(r["import"] + r["first_op"] for r in results)
+    print("{:<16} {:8.1f} ms".format("time_to_first_op", total * 1000))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,414 @@
+// Microbenchmarks of the ATen CPU kernels, without the Python overhead of
+// benchmarks/operator_benchmark.
+//
+// The arguments of each benchmark are listed in its name, e.g.
+// "BM_Add/numel:1048576/dtype:0/contig:1/threads:1". The dtype indices are
+// the ones of kDtypes, threads:0 means the default number of threads. The
+// inputs are generated from a fixed seed.
+//
+// The results can be written in JSON to compare two builds, e.g.:
+//   aten_op_bench --benchmark_filter=BM_Sum --benchmark_out=sum.json \
+//     --benchmark_out_format=json --benchmark_repetitions=5
+//   third_party/benchmark/tools/compare.py benchmarks base.json new.json
+//
+// Changing the number of threads between benchmarks requires the OpenMP
+// parallel backend, the native backend keeps the number of threads of the
+// first parallel region.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+
+#include <cmath>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const c10::ScalarType kDtypes[] = {at::kFloat, at::kDouble, at::kBFloat16};
+
+c10::ScalarType dtypeArg(int64_t index) {
+  return kDtypes[index];
+}
+
+// Sets the number of threads and the seed, and returns the default options
+// of the inputs of a benchmark.
+at::TensorOptions setUp(int64_t threads) {
+  static const int default_threads = at::get_num_threads();
+  at::set_num_threads(threads > 0 ? threads : default_threads);
+  at::manual_seed(0);
+  return at::TensorOptions(at::kCPU);
+}
+
+void setBytes(benchmark::State& state, int64_t bytes_per_iteration) {
+  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
+}
+
+int64_t bytes(const at::Tensor& t) {
+  return t.numel() * t.element_size();
+}
+
+// Elementwise (TensorIterator)
+
+// The numels are squares, a non contiguous input is the transpose of a
+// square matrix.
+at::Tensor elementwiseInput(
+    int64_t numel, c10::ScalarType dtype, bool contiguous, at::TensorOptions options) {
+  // randn doesn't support all the dtypes
+  if (contiguous) {
+    return at::randn({numel}, options).to(dtype);
+  }
+  auto side = static_cast<int64_t>(std::sqrt(numel));
+  return at::randn({side, side}, options).to(dtype).t();
+}
+
+void elementwiseArgs(
+    benchmark::internal::Benchmark* b,
+    std::initializer_list<int64_t> dtypes) {
+  b->ArgNames({"numel", "dtype", "contig", "threads"});
+  for (int64_t numel : {1 << 10, 1 << 16, 1 << 20, 1 << 24}) {
+    for (int64_t dtype : dtypes) {
+      for (int64_t contiguous : {1, 0}) {
+        for (int64_t threads : {1, 0}) {
+          b->Args({numel, dtype, contiguous, threads});
+        }
+      }
+    }
+  }
+}
+
+void BM_Add(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = elementwiseInput(
+      state.range(0), dtypeArg(state.range(1)), state.range(2), options);
+  auto b = elementwiseInput(
+      state.range(0), dtypeArg(state.range(1)), state.range(2), options);
+  auto out = at::empty_like(a);
+  for (auto _ : state) {
+    at::add_out(out, a, b);
+  }
+  setBytes(state, 3 * bytes(a));
+}
+BENCHMARK(BM_Add)->Apply([](benchmark::internal::Benchmark* b) {
+  elementwiseArgs(b, {0, 1, 2});
+});
+
+void BM_Sigmoid(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = elementwiseInput(
+      state.range(0), dtypeArg(state.range(1)), state.range(2), options);
+  auto out = at::empty_like(a);
+  for (auto _ : state) {
+    at::sigmoid_out(out, a);
+  }
+  setBytes(state, 2 * bytes(a));
+}
+BENCHMARK(BM_Sigmoid)->Apply([](benchmark::internal::Benchmark* b) {
+  elementwiseArgs(b, {0, 1});
+});
+
+void BM_CastToHalfPrecision(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = elementwiseInput(
+      state.range(0), dtypeArg(state.range(1)), state.range(2), options);
+  auto out = at::empty_like(a, a.options().dtype(at::kHalf));
+  for (auto _ : state) {
+    out.copy_(a);
+  }
+  setBytes(state, bytes(a) + bytes(out));
+}
+BENCHMARK(BM_CastToHalfPrecision)->Apply([](benchmark::internal::Benchmark* b) {
+  elementwiseArgs(b, {0, 1});
+});
+
+// Reductions over the inner (dim 1) or outer (dim 0) dimension of a matrix
+
+void ReductionArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"M", "N", "dim", "dtype", "threads"});
+  for (auto shape : std::vector<std::pair<int64_t, int64_t>>{
+           {1, 1 << 20}, {1 << 10, 1 << 10}, {1 << 16, 16}, {16, 1 << 16}}) {
+    for (int64_t dim : {0, 1}) {
+      for (int64_t dtype : {0, 1}) {
+        for (int64_t threads : {1, 0}) {
+          b->Args({shape.first, shape.second, dim, dtype, threads});
+        }
+      }
+    }
+  }
+}
+
+void BM_Sum(benchmark::State& state) {
+  auto options = setUp(state.range(4));
+  auto a = at::randn(
+      {state.range(0), state.range(1)}, options.dtype(dtypeArg(state.range(3))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::sum(a, {state.range(2)}));
+  }
+  setBytes(state, bytes(a));
+}
+BENCHMARK(BM_Sum)->Apply(ReductionArgs);
+
+void BM_Max(benchmark::State& state) {
+  auto options = setUp(state.range(4));
+  auto a = at::randn(
+      {state.range(0), state.range(1)}, options.dtype(dtypeArg(state.range(3))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::max(a, state.range(2)));
+  }
+  setBytes(state, bytes(a));
+}
+BENCHMARK(BM_Max)->Apply(ReductionArgs);
+
+void BM_Norm(benchmark::State& state) {
+  auto options = setUp(state.range(4));
+  auto a = at::randn(
+      {state.range(0), state.range(1)}, options.dtype(dtypeArg(state.range(3))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::norm(a, 2, {state.range(2)}));
+  }
+  setBytes(state, bytes(a));
+}
+BENCHMARK(BM_Norm)->Apply(ReductionArgs);
+
+// Indexing
+
+void IndexingArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"rows", "cols", "indices", "threads"});
+  for (int64_t rows : {1 << 10, 1 << 18}) {
+    for (int64_t cols : {1, 64, 512}) {
+      for (int64_t indices : {1 << 8, 1 << 14}) {
+        for (int64_t threads : {1, 0}) {
+          b->Args({rows, cols, indices, threads});
+        }
+      }
+    }
+  }
+}
+
+void BM_IndexSelect(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = at::randn({state.range(0), state.range(1)}, options);
+  auto index = at::randint(state.range(0), {state.range(2)}, options.dtype(at::kLong));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::index_select(a, 0, index));
+  }
+  setBytes(state, 2 * state.range(2) * state.range(1) * a.element_size());
+}
+BENCHMARK(BM_IndexSelect)->Apply(IndexingArgs);
+
+void BM_AdvancedIndex(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = at::randn({state.range(0), state.range(1)}, options);
+  auto index = at::randint(state.range(0), {state.range(2)}, options.dtype(at::kLong));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::index(a, {index}));
+  }
+  setBytes(state, 2 * state.range(2) * state.range(1) * a.element_size());
+}
+BENCHMARK(BM_AdvancedIndex)->Apply(IndexingArgs);
+
+void BM_IndexAdd(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = at::zeros({state.range(0), state.range(1)}, options);
+  auto source = at::randn({state.range(2), state.range(1)}, options);
+  auto index = at::randint(state.range(0), {state.range(2)}, options.dtype(at::kLong));
+  for (auto _ : state) {
+    a.index_add_(0, index, source);
+  }
+  setBytes(state, 3 * bytes(source));
+}
+BENCHMARK(BM_IndexAdd)->Apply(IndexingArgs);
+
+void BM_Gather(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = at::randn({state.range(0), state.range(1)}, options);
+  auto index = at::randint(
+      state.range(0), {state.range(2), state.range(1)}, options.dtype(at::kLong));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::gather(a, 0, index));
+  }
+  setBytes(state, 2 * index.numel() * a.element_size() + bytes(index));
+}
+BENCHMARK(BM_Gather)->Apply(IndexingArgs);
+
+// Sort and topk along the last dimension
+
+void SortArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"rows", "cols", "dtype", "threads"});
+  for (auto shape : std::vector<std::pair<int64_t, int64_t>>{
+           {1, 1 << 20}, {1 << 10, 1 << 10}, {1 << 16, 16}}) {
+    for (int64_t dtype : {0, 1}) {
+      for (int64_t threads : {1, 0}) {
+        b->Args({shape.first, shape.second, dtype, threads});
+      }
+    }
+  }
+}
+
+void BM_Sort(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = at::randn(
+      {state.range(0), state.range(1)}, options.dtype(dtypeArg(state.range(2))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::sort(a, -1));
+  }
+  state.SetItemsProcessed(state.iterations() * a.numel());
+}
+BENCHMARK(BM_Sort)->Apply(SortArgs);
+
+void BM_Topk(benchmark::State& state) {
+  auto options = setUp(state.range(3));
+  auto a = at::randn(
+      {state.range(0), state.range(1)}, options.dtype(dtypeArg(state.range(2))));
+  const int64_t k = std::max<int64_t>(1, state.range(1) / 100);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::topk(a, k, -1));
+  }
+  state.SetItemsProcessed(state.iterations() * a.numel());
+}
+BENCHMARK(BM_Topk)->Apply(SortArgs);
+
+// EmbeddingBag
+
+void EmbeddingBagArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"embeddings", "dim", "bags", "bag_size", "mode", "threads"});
+  for (int64_t embeddings : {1 << 12, 1 << 20}) {
+    for (int64_t dim : {16, 128}) {
+      for (int64_t bag_size : {1, 20}) {
+        // modes of embedding_bag: 0 sum, 1 mean, 2 max
+        for (int64_t mode : {0, 1, 2}) {
+          for (int64_t threads : {1, 0}) {
+            b->Args({embeddings, dim, 512, bag_size, mode, threads});
+          }
+        }
+      }
+    }
+  }
+}
+
+void BM_EmbeddingBag(benchmark::State& state) {
+  auto options = setUp(state.range(5));
+  auto weight = at::randn({state.range(0), state.range(1)}, options);
+  const int64_t bags = state.range(2);
+  const int64_t bag_size = state.range(3);
+  auto indices = at::randint(
+      state.range(0), {bags * bag_size}, options.dtype(at::kLong));
+  auto offsets = at::arange(0, bags * bag_size, bag_size, options.dtype(at::kLong));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(at::embedding_bag(
+        weight, indices, offsets, false, state.range(4)));
+  }
+  setBytes(
+      state,
+      bags * bag_size * state.range(1) * weight.element_size() + bytes(indices));
+}
+BENCHMARK(BM_EmbeddingBag)->Apply(EmbeddingBagArgs);
+
+// Convolution, on layers of ResNet-50
+
+void ConvArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"N", "C", "HW", "K", "R", "stride", "channels_last", "threads"});
+  const std::vector<std::vector<int64_t>> layers = {
+      // C, HW, K, R, stride
+      {3, 224, 64, 7, 2},
+      {64, 56, 64, 3, 1},
+      {256, 56, 64, 1, 1},
+      {128, 28, 128, 3, 1},
+      {512, 14, 1024, 1, 1},
+      {512, 7, 512, 3, 1},
+  };
+  for (int64_t batch : {1, 32}) {
+    for (const auto& layer : layers) {
+      for (int64_t channels_last : {0, 1}) {
+        for (int64_t threads : {1, 0}) {
+          b->Args({batch,
+                   layer[0],
+                   layer[1],
+                   layer[2],
+                   layer[3],
+                   layer[4],
+                   channels_last,
+                   threads});
+        }
+      }
+    }
+  }
+}
+
+void BM_Conv2d(benchmark::State& state) {
+  auto options = setUp(state.range(7));
+  const int64_t N = state.range(0), C = state.range(1), HW = state.range(2);
+  const int64_t K = state.range(3), R = state.range(4), stride = state.range(5);
+  const auto memory_format = state.range(6) ? at::MemoryFormat::ChannelsLast
+                                            : at::MemoryFormat::Contiguous;
+  auto input = at::randn({N, C, HW, HW}, options).contiguous(memory_format);
+  auto weight = at::randn({K, C, R, R}, options).contiguous(memory_format);
+  auto bias = at::randn({K}, options);
+  const int64_t padding = R / 2;
+  at::Tensor output;
+  for (auto _ : state) {
+    output = at::conv2d(input, weight, bias, stride, padding);
+  }
+  // 2 flops per multiply-add
+  state.counters["flops"] = benchmark::Counter(
+      2. * output.numel() * C * R * R * state.iterations(),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Conv2d)->Apply(ConvArgs)->Unit(benchmark::kMicrosecond);
+
+// GEMM
+
+void GemmArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"M", "N", "K", "dtype", "threads"});
+  const std::vector<std::vector<int64_t>> shapes = {
+      {64, 64, 64},
+      {256, 256, 256},
+      {1024, 1024, 1024},
+      // tall and skinny, e.g. the linear layers of small batches
+      {16, 4096, 1024},
+      {4096, 16, 1024},
+  };
+  for (const auto& shape : shapes) {
+    for (int64_t dtype : {0, 1}) {
+      for (int64_t threads : {1, 0}) {
+        b->Args({shape[0], shape[1], shape[2], dtype, threads});
+      }
+    }
+  }
+}
+
+void BM_Addmm(benchmark::State& state) {
+  auto options = setUp(state.range(4)).dtype(dtypeArg(state.range(3)));
+  const int64_t M = state.range(0), N = state.range(1), K = state.range(2);
+  auto a = at::randn({M, K}, options);
+  auto b = at::randn({K, N}, options);
+  auto bias = at::randn({N}, options);
+  auto out = at::empty({M, N}, options);
+  for (auto _ : state) {
+    at::addmm_out(out, bias, a, b);
+  }
+  state.counters["flops"] = benchmark::Counter(
+      2. * M * N * K * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Addmm)->Apply(GemmArgs)->Unit(benchmark::kMicrosecond);
+
+void BM_Bmm(benchmark::State& state) {
+  auto options = setUp(state.range(4)).dtype(dtypeArg(state.range(3)));
+  const int64_t M = state.range(0), N = state.range(1), K = state.range(2);
+  constexpr int64_t batch = 8;
+  auto a = at::randn({batch, M, K}, options);
+  auto b = at::randn({batch, K, N}, options);
+  auto out = at::empty({batch, M, N}, options);
+  for (auto _ : state) {
+    at::bmm_out(out, a, b);
+  }
+  state.counters["flops"] = benchmark::Counter(
+      2. * batch * M * N * K * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Bmm)->Apply(GemmArgs)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
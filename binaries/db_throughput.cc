@@ -32,10 +32,17 @@ C10_DEFINE_int(
     num_read_threads,
     1,
     "The number of concurrent reading threads.");
+C10_DEFINE_bool(
+    use_parallel_reader,
+    false,
+    "If true, use the parallel reader with 1, 2, 4, ... up to "
+    "num_read_threads threads.");
+C10_DEFINE_int(readahead, 64, "The readahead of every parallel reader thread.");
 
 using caffe2::db::Cursor;
 using caffe2::db::DB;
 using caffe2::db::DBReader;
+using caffe2::db::ParallelDBReader;
 using caffe2::string;
 
 void TestThroughputWithDB() {
@@ -93,9 +100,37 @@ void TestThroughputWithReader() {
   }
 }
 
+void TestThroughputWithParallelReader() {
+  std::vector<int> thread_counts;
+  for (int n = 1; n < FLAGS_num_read_threads; n *= 2) {
+    thread_counts.push_back(n);
+  }
+  thread_counts.push_back(FLAGS_num_read_threads);
+  for (const int num_threads : thread_counts) {
+    ParallelDBReader reader(
+        FLAGS_input_db_type, FLAGS_input_db, num_threads, FLAGS_readahead);
+    string key, value;
+    double total_seconds = 0;
+    for (int iter_id = 0; iter_id < FLAGS_repeat; ++iter_id) {
+      caffe2::Timer timer;
+      for (int i = 0; i < FLAGS_report_interval; ++i) {
+        reader.Read(&key, &value);
+      }
+      total_seconds += timer.Seconds();
+    }
+    printf(
+        "%03d threads, took %4.5f seconds, throughput %f items/sec.\n",
+        num_threads,
+        total_seconds,
+        FLAGS_repeat * FLAGS_report_interval / total_seconds);
+  }
+}
+
 int main(int argc, char** argv) {
   caffe2::GlobalInit(&argc, &argv);
-  if (FLAGS_use_reader) {
+  if (FLAGS_use_parallel_reader) {
+    TestThroughputWithParallelReader();
+  } else if (FLAGS_use_reader) {
     TestThroughputWithReader();
   } else {
     TestThroughputWithDB();
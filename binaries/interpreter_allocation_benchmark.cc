@@ -0,0 +1,78 @@
+#include <torch/torch.h>
+#include <torch/jit.h>
+
+#include "c10/util/Flags.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+C10_DEFINE_int(iter, 10000, "Number of iterations");
+C10_DEFINE_int(warmup_iter, 100, "Number of warmup iterations");
+
+namespace {
+std::atomic<size_t> num_allocations{0};
+
+// Tuple and list heavy code: every value goes through the interpreter stack
+// and the tuple and list instructions, while the tensor work is negligible.
+const auto kSource = R"JIT(
+def pack(a: Tensor, b: Tensor, c: Tensor):
+    return (a, b, c), [a, b, c]
+
+def forward(a: Tensor, b: Tensor, c: Tensor):
+    t, l = pack(a, b, c)
+    x, y, z = t
+    u, v, w = l
+    s = t[1:]
+    return (x, s[0], z, w, t[2])
+)JIT";
+} // namespace
+
+void* operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+
+  auto cu = torch::jit::compile(kSource);
+  auto& forward = cu->get_function("forward");
+  std::vector<c10::IValue> inputs{
+      torch::ones({1}), torch::ones({1}), torch::ones({1})};
+
+  for (auto idx = 0; idx < FLAGS_warmup_iter; ++idx) {
+    forward(inputs);
+  }
+
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::nanoseconds ns;
+  const size_t allocations_before = num_allocations.load();
+  std::chrono::time_point<clock> start_time = clock::now();
+  for (auto idx = 0; idx < FLAGS_iter; ++idx) {
+    forward(inputs);
+  }
+  auto duration = static_cast<float>(
+      std::chrono::duration_cast<ns>(clock::now() - start_time).count());
+  const size_t allocations = num_allocations.load() - allocations_before;
+
+  std::cout << "Time per iteration: " << (duration / FLAGS_iter) << " ns."
+            << std::endl;
+  std::cout << "Allocations per iteration: "
+            << (static_cast<float>(allocations) / FLAGS_iter) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,352 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Latency distribution of a TorchScript or lite interpreter model under
+// concurrent requests, as opposed to speed_benchmark_torch which reports the
+// mean latency of a single input.
+//
+// Each of the --concurrency threads sends its requests back to back, with
+// inputs sampled from --input_dims. The latencies of all the requests are
+// reported as percentiles, along with the throughput and the peak RSS.
+// With --tail_profile_iters, the model is then run under the profiler and the
+// traces of the requests slower than the --tail_percentile latency of the
+// main runs are saved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "ATen/ATen.h"
+#include "ATen/Parallel.h"
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/profiler.h"
+#include "torch/csrc/jit/mobile/import.h"
+#include "torch/csrc/jit/mobile/module.h"
+#include "torch/csrc/jit/serialization/import.h"
+#include "torch/script.h"
+
+C10_DEFINE_string(model, "", "The given torch script model to benchmark.");
+C10_DEFINE_bool(
+    lite,
+    false,
+    "Whether the model is a bytecode model for the lite interpreter.");
+C10_DEFINE_string(
+    input_dims,
+    "",
+    "The dimensions of the float inputs, comma separated, with a semicolon "
+    "between the inputs. Alternative sets of inputs are separated by '|', "
+    "e.g. '1,3,224,224|8,3,224,224', each request uses one of them, "
+    "see --input_weights.");
+C10_DEFINE_string(
+    input_type,
+    "float",
+    "Input type (uint8_t/float/int64), semicolon separated, shared by the "
+    "alternative sets of inputs.");
+C10_DEFINE_string(
+    input_weights,
+    "",
+    "Comma separated probabilities of the alternative sets of inputs of "
+    "--input_dims, uniform if empty.");
+C10_DEFINE_int(concurrency, 1, "The number of threads sending requests.");
+C10_DEFINE_int(
+    intra_op_threads,
+    0,
+    "The number of intra op threads, 0 keeps the default.");
+C10_DEFINE_int(warmup, 10, "The number of requests per thread to warm up.");
+C10_DEFINE_int(iter, 1000, "The total number of requests to measure.");
+C10_DEFINE_int(seed, 0, "The seed of the sampling of the inputs.");
+C10_DEFINE_double(
+    tail_percentile,
+    99,
+    "The percentile above which the latency of a request is in the tail.");
+C10_DEFINE_int(
+    tail_profile_iters,
+    0,
+    "The number of requests to run under the profiler after the main runs, "
+    "on a single thread. The chrome traces of the tail requests are saved.");
+C10_DEFINE_string(
+    tail_profile_prefix,
+    "tail_profile",
+    "The prefix of the chrome trace files of the tail requests.");
+C10_DEFINE_bool(
+    report_pep,
+    false,
+    "Whether to print performance stats for AI-PEP.");
+
+namespace {
+
+std::vector<std::string>
+split(char separator, const std::string& string, bool ignore_empty = true) {
+  std::vector<std::string> pieces;
+  std::stringstream ss(string);
+  std::string item;
+  while (getline(ss, item, separator)) {
+    if (!ignore_empty || !item.empty()) {
+      pieces.push_back(std::move(item));
+    }
+  }
+  return pieces;
+}
+
+at::ScalarType parseType(const std::string& type) {
+  if (type == "float") {
+    return at::ScalarType::Float;
+  } else if (type == "uint8_t") {
+    return at::ScalarType::Byte;
+  } else if (type == "int64") {
+    return at::ScalarType::Long;
+  }
+  CAFFE_THROW("Unsupported input type: ", type);
+}
+
+// The alternative sets of inputs of --input_dims
+std::vector<std::vector<c10::IValue>> createInputSets() {
+  std::vector<std::vector<c10::IValue>> input_sets;
+  auto types = split(';', FLAGS_input_type);
+  for (const auto& set : split('|', FLAGS_input_dims)) {
+    auto dims_list = split(';', set);
+    CAFFE_ENFORCE_EQ(
+        dims_list.size(),
+        types.size(),
+        "Input dims and type should have the same number of items.");
+    std::vector<c10::IValue> inputs;
+    for (size_t i = 0; i < dims_list.size(); ++i) {
+      std::vector<int64_t> dims;
+      for (const auto& s : split(',', dims_list[i])) {
+        dims.push_back(c10::stoi(s));
+      }
+      inputs.emplace_back(
+          torch::ones(dims, at::TensorOptions(parseType(types[i]))));
+    }
+    input_sets.push_back(std::move(inputs));
+  }
+  if (input_sets.empty()) {
+    // model without inputs
+    input_sets.emplace_back();
+  }
+  return input_sets;
+}
+
+std::vector<double> inputWeights(size_t num_sets) {
+  if (FLAGS_input_weights.empty()) {
+    return std::vector<double>(num_sets, 1.);
+  }
+  std::vector<double> weights;
+  for (const auto& s : split(',', FLAGS_input_weights)) {
+    weights.push_back(std::stod(s));
+  }
+  CAFFE_ENFORCE_EQ(
+      weights.size(),
+      num_sets,
+      "There should be one input weight per set of inputs.");
+  return weights;
+}
+
+// Either kind of model
+struct Model {
+  c10::optional<torch::jit::Module> module;
+  c10::optional<torch::jit::mobile::Module> mobile_module;
+
+  void forward(std::vector<c10::IValue> inputs) {
+    if (module) {
+      module->forward(std::move(inputs));
+    } else {
+      mobile_module->forward(std::move(inputs));
+    }
+  }
+};
+
+int64_t peakRSSKiB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+// Nearest rank percentile of sorted latencies
+double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  auto rank = static_cast<size_t>(std::ceil(p / 100. * sorted.size()));
+  return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+void profileTail(
+    Model& model,
+    const std::vector<std::vector<c10::IValue>>& input_sets,
+    std::discrete_distribution<size_t> sampler,
+    double threshold_us) {
+  namespace profiler = torch::autograd::profiler;
+  std::mt19937 rng(FLAGS_seed);
+  int saved = 0;
+  for (int i = 0; i < FLAGS_tail_profile_iters; ++i) {
+    const auto& inputs = input_sets[sampler(rng)];
+    profiler::enableProfiler(
+        profiler::ProfilerConfig(profiler::ProfilerState::CPU, true, false));
+    auto start = std::chrono::steady_clock::now();
+    model.forward(inputs);
+    auto end = std::chrono::steady_clock::now();
+    auto event_lists = profiler::disableProfiler();
+    double latency_us =
+        std::chrono::duration<double, std::micro>(end - start).count();
+    if (latency_us < threshold_us) {
+      continue;
+    }
+    std::vector<profiler::Event*> events;
+    for (auto& list : event_lists) {
+      for (auto& event : list) {
+        events.push_back(&event);
+      }
+    }
+    auto filename =
+        FLAGS_tail_profile_prefix + "_" + c10::to_string(saved++) + ".json";
+    std::ofstream out(filename);
+    profiler::writeProfilerEventsToStream(out, events);
+    std::cout << "Tail request of " << latency_us << " us profiled in "
+              << filename << std::endl;
+  }
+  std::cout << saved << " of " << FLAGS_tail_profile_iters
+            << " profiled requests were in the tail." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Run latency benchmark for pytorch model.\n"
+      "Example usage:\n"
+      "./latency_benchmark_torch"
+      " --model=<model_file>"
+      " --input_dims=\"1,3,224,224|8,3,224,224\""
+      " --input_weights=0.9,0.1"
+      " --concurrency=4"
+      " --iter=2000");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cerr << "Failed to parse command line flags!" << std::endl;
+    return 1;
+  }
+  CAFFE_ENFORCE_GT(FLAGS_concurrency, 0, "Concurrency should be positive.");
+  CAFFE_ENFORCE_GE(FLAGS_warmup, 0, "Warmup should be non negative.");
+  CAFFE_ENFORCE_GT(FLAGS_iter, 0, "Number of iterations should be positive.");
+
+  if (FLAGS_intra_op_threads > 0) {
+    at::set_num_threads(FLAGS_intra_op_threads);
+  }
+
+  auto input_sets = createInputSets();
+  auto weights = inputWeights(input_sets.size());
+  std::discrete_distribution<size_t> sampler(weights.begin(), weights.end());
+
+  torch::autograd::AutoGradMode guard(false);
+  // the lite interpreter runs the ops without autograd, see
+  // lite_interpreter_model_load
+  torch::AutoNonVariableTypeMode non_var_guard(FLAGS_lite);
+  Model model;
+  if (FLAGS_lite) {
+    model.mobile_module = torch::jit::_load_for_mobile(FLAGS_model);
+  } else {
+    model.module = torch::jit::load(FLAGS_model);
+    model.module->eval();
+  }
+
+  std::cout << "Running " << FLAGS_iter << " requests on "
+            << FLAGS_concurrency << " threads." << std::endl;
+  std::vector<std::vector<double>> latencies(FLAGS_concurrency);
+  std::atomic<int> remaining{FLAGS_iter};
+  auto run = [&](int worker) {
+    torch::autograd::AutoGradMode worker_guard(false);
+    torch::AutoNonVariableTypeMode worker_non_var_guard(FLAGS_lite);
+    std::mt19937 rng(FLAGS_seed + worker);
+    auto local_sampler = sampler;
+    for (int i = 0; i < FLAGS_warmup; ++i) {
+      model.forward(input_sets[local_sampler(rng)]);
+    }
+    while (remaining.fetch_sub(1) > 0) {
+      const auto& inputs = input_sets[local_sampler(rng)];
+      auto start = std::chrono::steady_clock::now();
+      model.forward(inputs);
+      auto end = std::chrono::steady_clock::now();
+      latencies[worker].push_back(
+          std::chrono::duration<double, std::micro>(end - start).count());
+    }
+  };
+  // The warmup is included in the wall time, it is short compared to the
+  // main runs in the intended use.
+  auto wall_start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int worker = 0; worker < FLAGS_concurrency; ++worker) {
+    workers.emplace_back(run, worker);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto wall_end = std::chrono::steady_clock::now();
+  double wall_s =
+      std::chrono::duration<double>(wall_end - wall_start).count();
+
+  std::vector<double> all;
+  for (const auto& worker_latencies : latencies) {
+    all.insert(all.end(), worker_latencies.begin(), worker_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  double mean = 0;
+  for (double l : all) {
+    mean += l;
+  }
+  mean /= all.size();
+
+  const std::vector<std::pair<std::string, double>> stats = {
+      {"mean", mean},
+      {"p50", percentile(all, 50)},
+      {"p90", percentile(all, 90)},
+      {"p99", percentile(all, 99)},
+      {"p999", percentile(all, 99.9)},
+      {"max", all.back()},
+  };
+  for (const auto& stat : stats) {
+    std::cout << "Latency " << stat.first << ": " << stat.second << " us"
+              << std::endl;
+  }
+  std::cout << "Throughput: " << all.size() / wall_s << " requests/s"
+            << std::endl;
+  std::cout << "Peak RSS: " << peakRSSKiB() << " KiB" << std::endl;
+  if (FLAGS_report_pep) {
+    for (const auto& stat : stats) {
+      std::cout << "PyTorchObserver {\"type\": \"NET\", \"unit\": \"us\", "
+                << "\"metric\": \"latency_" << stat.first << "\", \"value\": \""
+                << stat.second << "\"}" << std::endl;
+    }
+  }
+
+  if (FLAGS_tail_profile_iters > 0) {
+    profileTail(
+        model, input_sets, sampler, percentile(all, FLAGS_tail_percentile));
+  }
+  return 0;
+}
@@ -9,6 +9,8 @@
 
 C10_DEFINE_int(iter, 100, "Number of iterations");
 C10_DEFINE_int(warmup_iter, 10, "Number of warmup iterations")
+C10_DEFINE_int(rec_fn_iter, 10000000, "Number of RecordFunctions in the overhead benchmark")
+C10_DEFINE_double(rec_fn_sampling_prob, 1e-6, "Sampling probability of the callbacks in the overhead benchmark")
 
 namespace {
 const int kInnerIter = 100;
@@ -41,6 +43,31 @@ void setupCallbacks() {
   }
 }
 
+// Returns the average time, in ns, of a RecordFunction when all the callbacks
+// are sampled with the given probability
+float runRecordFunctionBench(int iter, double sampling_prob) {
+  at::clearCallbacks();
+  for (auto idx = 0; idx < kNumSampledCb; ++idx) {
+    at::addGlobalCallback(at::RecordFunctionCallback(
+        [](const at::RecordFunction& fn) {},
+        [](const at::RecordFunction&) {})
+      .needsInputs(true)
+      .samplingProb(sampling_prob)
+    );
+  }
+
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::nanoseconds ns;
+  std::chrono::time_point<clock> start_time = clock::now();
+  for (auto idx = 0; idx < iter; ++idx) {
+    RECORD_USER_SCOPE("test");
+  }
+  auto duration = static_cast<float>(
+      std::chrono::duration_cast<ns>(clock::now() - start_time).count());
+  at::clearCallbacks();
+  return duration / iter;
+}
+
 float runBench(int tensor_size, int outer_iter) {
   typedef std::chrono::high_resolution_clock clock;
   typedef std::chrono::microseconds us;
@@ -76,5 +103,15 @@ int main(int argc, char** argv) {
               << " us." << std::endl;
   }
 
+  // Overhead of the RecordFunctions which are not sampled
+  runRecordFunctionBench(FLAGS_warmup_iter * kInnerIter, FLAGS_rec_fn_sampling_prob);
+  std::cout << "RecordFunction overhead, sampling probability "
+            << FLAGS_rec_fn_sampling_prob << ": "
+            << runRecordFunctionBench(FLAGS_rec_fn_iter, FLAGS_rec_fn_sampling_prob)
+            << " ns per RecordFunction." << std::endl;
+  std::cout << "RecordFunction overhead, callbacks never sampled: "
+            << runRecordFunctionBench(FLAGS_rec_fn_iter, 0.0)
+            << " ns per RecordFunction." << std::endl;
+
   return 0;
 }
@@ -0,0 +1,49 @@
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/TensorImpl.h>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// Creates and destroys a TensorImpl with `state.range(0)` dimensions of size
+// 1, as models holding many tiny tensors do. Tensors with up to five
+// dimensions keep their sizes and strides inline.
+static void BM_TensorImplCtorDtor(benchmark::State& state) {
+  const std::vector<int64_t> sizes(state.range(0), 1);
+  c10::Storage storage(
+      c10::Storage::use_byte_size_t(),
+      sizeof(float),
+      c10::GetCPUAllocator(),
+      /*resizable=*/false);
+  while (state.KeepRunning()) {
+    auto impl = c10::make_intrusive<c10::TensorImpl>(
+        c10::Storage(storage),
+        c10::DispatchKeySet(c10::DispatchKey::CPU),
+        caffe2::TypeMeta::Make<float>());
+    impl->set_sizes_contiguous(sizes);
+    benchmark::DoNotOptimize(impl.get());
+  }
+}
+BENCHMARK(BM_TensorImplCtorDtor)->DenseRange(0, 7);
+
+// Same, but every tensor owns its storage.
+static void BM_TensorImplWithStorageCtorDtor(benchmark::State& state) {
+  const std::vector<int64_t> sizes(state.range(0), 1);
+  while (state.KeepRunning()) {
+    auto impl = c10::make_intrusive<c10::TensorImpl>(
+        c10::Storage(
+            c10::Storage::use_byte_size_t(),
+            sizeof(float),
+            c10::GetCPUAllocator(),
+            /*resizable=*/false),
+        c10::DispatchKeySet(c10::DispatchKey::CPU),
+        caffe2::TypeMeta::Make<float>());
+    impl->set_sizes_contiguous(sizes);
+    benchmark::DoNotOptimize(impl.get());
+  }
+}
+BENCHMARK(BM_TensorImplWithStorageCtorDtor)->DenseRange(0, 7);
+
+} // namespace
+
+BENCHMARK_MAIN();
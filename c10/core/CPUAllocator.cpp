@@ -1,4 +1,5 @@
 #include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
 #include <c10/core/DeviceType.h>
 
 // TODO: rename flags to C10
@@ -185,10 +186,6 @@ class DefaultMobileCPUAllocator final : public at::Allocator {
 
 void NoDelete(void*) {}
 
-at::Allocator* GetCPUAllocator() {
-  return GetAllocator(DeviceType::CPU);
-}
-
 void SetCPUAllocator(at::Allocator* alloc, uint8_t priority) {
   SetAllocator(DeviceType::CPU, alloc, priority);
 }
@@ -215,17 +212,41 @@ at::Allocator* GetDefaultCPUAllocator() {
 
 REGISTER_ALLOCATOR(DeviceType::CPU, &g_mobile_cpu_allocator);
 
+at::Allocator* GetCPUAllocator() {
+  return GetAllocator(DeviceType::CPU);
+}
+
 #else
 
 // Global default CPU Allocator
 static DefaultCPUAllocator g_cpu_alloc;
 
+// PYTORCH_CPU_ALLOC_CONF=caching:True swaps in the caching implementation
+// (see CPUCachingAllocator.h) at startup.
 at::Allocator* GetDefaultCPUAllocator() {
-  return &g_cpu_alloc;
+  static at::Allocator* allocator = CPUCachingAllocator::enabled()
+      ? CPUCachingAllocator::get()
+      : &g_cpu_alloc;
+  return allocator;
 }
 
+// Reading PYTORCH_CPU_ALLOC_CONF is deferred to the first GetCPUAllocator()
+// call, so the plain allocator is what gets registered at static
+// initialization.
 REGISTER_ALLOCATOR(DeviceType::CPU, &g_cpu_alloc);
 
+at::Allocator* GetCPUAllocator() {
+  static const bool default_installed = [] {
+    // unless an allocator was set explicitly in the meantime
+    if (GetAllocator(DeviceType::CPU) == &g_cpu_alloc) {
+      SetAllocator(DeviceType::CPU, GetDefaultCPUAllocator());
+    }
+    return true;
+  }();
+  (void)default_installed;
+  return GetAllocator(DeviceType::CPU);
+}
+
 #endif /* C10_Mobile */
 
 void ProfiledCPUMemoryReporter::New(void* ptr, size_t nbytes) {
@@ -0,0 +1,472 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Exception.h>
+#include <c10/util/llvmMathExtras.h>
+#include <c10/util/numa.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+namespace {
+
+constexpr size_t kMinClassSize = 64;              // smallest size class
+constexpr size_t kMaxClassSize = 33554432;        // largest cached size, 32 MiB
+constexpr size_t kHugePageSize = 2097152;         // transparent huge page size
+constexpr size_t kNumSizeClasses = 77;            // classes up to kMaxClassSize
+constexpr size_t kUncached = kNumSizeClasses;     // marks bypassing blocks
+
+// Allocator settings, parsed once from the PYTORCH_CPU_ALLOC_CONF environment
+// variable (see CPUCachingAllocator.h).
+struct Config {
+  bool caching = false;
+  bool huge_pages = false;
+  size_t thread_cache_size = 64 * 1048576;
+
+  static const Config& get() {
+    static Config* config = parse_or_default(getenv("PYTORCH_CPU_ALLOC_CONF"));
+    return *config;
+  }
+
+ private:
+  // An invalid setting must not stop the process: the config may first be
+  // read while the library is being loaded.
+  static Config* parse_or_default(const char* env) {
+    try {
+      return parse(env);
+    } catch (const c10::Error& e) {
+      TORCH_WARN(e.msg(), "; ignoring PYTORCH_CPU_ALLOC_CONF");
+      return new Config();
+    }
+  }
+
+  static Config* parse(const char* env) {
+    auto config = new Config();
+    if (env == nullptr) {
+      return config;
+    }
+    const std::string options(env);
+    size_t begin = 0;
+    while (begin < options.size()) {
+      size_t end = options.find(',', begin);
+      if (end == std::string::npos) {
+        end = options.size();
+      }
+      const std::string option = options.substr(begin, end - begin);
+      begin = end + 1;
+      if (option.empty()) {
+        continue;
+      }
+      const size_t colon = option.find(':');
+      TORCH_CHECK(colon != std::string::npos,
+          "Invalid PYTORCH_CPU_ALLOC_CONF option '", option,
+          "', expected key:value");
+      const std::string key = option.substr(0, colon);
+      const std::string value = option.substr(colon + 1);
+      if (key == "caching") {
+        config->caching = parse_bool(key, value);
+      } else if (key == "huge_pages") {
+        config->huge_pages = parse_bool(key, value);
+      } else if (key == "thread_cache_size_mb") {
+        char* value_end = nullptr;
+        const long long mb = strtoll(value.c_str(), &value_end, 10);
+        TORCH_CHECK(!value.empty() && *value_end == '\0' && mb >= 0,
+            "Invalid value for PYTORCH_CPU_ALLOC_CONF option ", key, ": ", value);
+        config->thread_cache_size = static_cast<size_t>(mb) * 1048576;
+      } else {
+        TORCH_CHECK(false, "Unrecognized PYTORCH_CPU_ALLOC_CONF option: ", key);
+      }
+    }
+    return config;
+  }
+
+  static bool parse_bool(const std::string& key, const std::string& value) {
+    TORCH_CHECK(value == "True" || value == "False",
+        "Invalid value for PYTORCH_CPU_ALLOC_CONF option ", key, ": ", value,
+        " (expected True or False)");
+    return value == "True";
+  }
+};
+
+// Stat updated concurrently by all threads.
+struct AtomicStat {
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+  std::atomic<int64_t> allocated{0};
+  std::atomic<int64_t> freed{0};
+
+  void update(int64_t amount) {
+    const int64_t value =
+        current.fetch_add(amount, std::memory_order_relaxed) + amount;
+    int64_t old_peak = peak.load(std::memory_order_relaxed);
+    while (value > old_peak &&
+           !peak.compare_exchange_weak(old_peak, value, std::memory_order_relaxed)) {
+    }
+    if (amount > 0) {
+      allocated.fetch_add(amount, std::memory_order_relaxed);
+    } else {
+      freed.fetch_add(-amount, std::memory_order_relaxed);
+    }
+  }
+
+  Stat load() const {
+    Stat stat;
+    stat.current = current.load(std::memory_order_relaxed);
+    stat.peak = peak.load(std::memory_order_relaxed);
+    stat.allocated = allocated.load(std::memory_order_relaxed);
+    stat.freed = freed.load(std::memory_order_relaxed);
+    return stat;
+  }
+
+  void reset_accumulated() {
+    allocated.store(0, std::memory_order_relaxed);
+    freed.store(0, std::memory_order_relaxed);
+  }
+
+  void reset_peak() {
+    peak.store(current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+};
+
+struct AtomicStats {
+  AtomicStat allocation;
+  AtomicStat allocated_bytes;
+  AtomicStat reserved_bytes;
+  AtomicStat cached_bytes;
+  std::atomic<int64_t> num_cache_hits{0};
+  std::atomic<int64_t> num_cache_misses{0};
+  std::atomic<int64_t> num_huge_page_allocs{0};
+};
+
+AtomicStats& stats() {
+  static AtomicStats* s = new AtomicStats();
+  return *s;
+}
+
+// Header stored in the gAlignment bytes preceding every block handed out by
+// the allocator, so that the deleter finds the size class and NUMA node of
+// a block without any lookup.
+struct alignas(gAlignment) BlockHeader {
+  size_t size;        // usable bytes following the header
+  size_t size_class;  // index of the size class, kUncached if not cacheable
+  size_t system_size; // bytes obtained from the system, header included
+  int numa_node;      // node the block was placed on, -1 if unknown
+};
+
+static_assert(sizeof(BlockHeader) == gAlignment,
+    "BlockHeader must preserve the alignment of the data following it");
+
+// Rounds nbytes up to its size class and returns the class index.
+size_t size_class(size_t nbytes, size_t* class_size) {
+  if (nbytes <= kMinClassSize) {
+    *class_size = kMinClassSize;
+    return 0;
+  }
+  // 2^p < nbytes <= 2^(p+1); classes in that range are 2^(p-2) apart
+  const unsigned p = llvm::Log2_64(nbytes - 1);
+  const size_t base = size_t(1) << p;
+  const size_t step = base >> 2;
+  const size_t steps = (nbytes - base + step - 1) / step;
+  *class_size = base + steps * step;
+  return 1 + (p - 6) * 4 + (steps - 1);
+}
+
+BlockHeader* system_alloc(size_t system_size, bool huge) {
+  void* ptr = nullptr;
+#ifdef _MSC_VER
+  ptr = _aligned_malloc(system_size, gAlignment);
+  TORCH_CHECK(ptr,
+      "CPUCachingAllocator: not enough memory: you tried to allocate ",
+      system_size, " bytes.");
+#else
+  const int err = posix_memalign(
+      &ptr, huge ? kHugePageSize : gAlignment, system_size);
+  TORCH_CHECK(err == 0,
+      "CPUCachingAllocator: can't allocate memory: you tried to allocate ",
+      system_size, " bytes. Error code ", err, " (", strerror(err), ")");
+#endif
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge) {
+    // Only advisory; fall back to regular pages if THP is unavailable.
+    madvise(ptr, system_size, MADV_HUGEPAGE);
+  }
+#endif
+  stats().reserved_bytes.update(system_size);
+  return static_cast<BlockHeader*>(ptr);
+}
+
+void system_free(BlockHeader* header) {
+  stats().reserved_bytes.update(-static_cast<int64_t>(header->system_size));
+  free_cpu(header);
+}
+
+// Cache of freed blocks owned by a single thread, with one free list per
+// (NUMA node, size class). The mutex is only contended when emptyCache()
+// drains the cache from another thread.
+struct ThreadCache {
+  using FreeLists = std::array<std::vector<BlockHeader*>, kNumSizeClasses>;
+
+  ThreadCache();
+  ~ThreadCache();
+
+  BlockHeader* pop(int numa_node, size_t size_class) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t node_index = numa_node + 1;
+    if (node_index >= nodes.size() || nodes[node_index][size_class].empty()) {
+      return nullptr;
+    }
+    auto& free_list = nodes[node_index][size_class];
+    BlockHeader* header = free_list.back();
+    free_list.pop_back();
+    cached_bytes -= header->system_size;
+    return header;
+  }
+
+  // Returns false if the cache has no room for the block.
+  bool push(BlockHeader* header) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cached_bytes + header->system_size > Config::get().thread_cache_size) {
+      return false;
+    }
+    const size_t node_index = header->numa_node + 1;
+    if (node_index >= nodes.size()) {
+      nodes.resize(node_index + 1);
+    }
+    nodes[node_index][header->size_class].push_back(header);
+    cached_bytes += header->system_size;
+    return true;
+  }
+
+  void drain(std::vector<BlockHeader*>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& free_lists : nodes) {
+      for (auto& free_list : free_lists) {
+        out.insert(out.end(), free_list.begin(), free_list.end());
+        free_list.clear();
+      }
+    }
+    cached_bytes = 0;
+  }
+
+  std::mutex mutex;
+  // indexed by NUMA node + 1, so that unknown placement (-1) maps to 0
+  std::vector<FreeLists> nodes;
+  size_t cached_bytes = 0;
+};
+
+// Registry of all live thread caches; intentionally leaked to outlive
+// thread_local destructors.
+std::mutex& thread_caches_mutex() {
+  static std::mutex* m = new std::mutex();
+  return *m;
+}
+
+std::vector<ThreadCache*>& thread_caches() {
+  static std::vector<ThreadCache*>* caches = new std::vector<ThreadCache*>();
+  return *caches;
+}
+
+void release_blocks(const std::vector<BlockHeader*>& blocks) {
+  for (BlockHeader* header : blocks) {
+    stats().cached_bytes.update(-static_cast<int64_t>(header->system_size));
+    system_free(header);
+  }
+}
+
+// Set when the calling thread's cache is destroyed at thread exit. Blocks
+// freed after that, e.g. by other thread_local destructors, go straight back
+// to the system.
+thread_local bool local_cache_destroyed = false;
+
+ThreadCache::ThreadCache() {
+  std::lock_guard<std::mutex> lock(thread_caches_mutex());
+  thread_caches().push_back(this);
+}
+
+ThreadCache::~ThreadCache() {
+  local_cache_destroyed = true;
+  std::vector<BlockHeader*> blocks;
+  {
+    std::lock_guard<std::mutex> lock(thread_caches_mutex());
+    auto& caches = thread_caches();
+    caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+    drain(blocks);
+  }
+  release_blocks(blocks);
+}
+
+// Returns nullptr once the calling thread's cache has been destroyed.
+ThreadCache* local_cache() {
+  if (local_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void fill(void* data, size_t nbytes) {
+  TORCH_CHECK(
+      !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
+          !FLAGS_caffe2_cpu_allocator_do_junk_fill,
+      "Cannot request both zero-fill and junk-fill at the same time");
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
+struct CachingCPUAllocator final : at::Allocator {
+  at::DataPtr allocate(size_t nbytes) const override {
+    if (nbytes == 0) {
+      return {nullptr, nullptr, &Delete, at::Device(at::DeviceType::CPU)};
+    }
+    // We might have clowny upstream code that tries to alloc a negative
+    // number of bytes. Let's catch it early.
+    TORCH_CHECK(((ptrdiff_t)nbytes) >= 0,
+        "CPUCachingAllocator seems to have been called with negative number: ",
+        nbytes);
+
+    const Config& config = Config::get();
+    auto& s = stats();
+    BlockHeader* header = nullptr;
+    const bool huge = config.huge_pages && nbytes >= kHugePageSize;
+
+    if (!huge && nbytes <= kMaxClassSize) {
+      size_t class_size;
+      const size_t index = size_class(nbytes, &class_size);
+      const int numa_node = GetCurrentNUMANode();
+      ThreadCache* cache = local_cache();
+      header = cache ? cache->pop(numa_node, index) : nullptr;
+      if (header) {
+        s.num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+        s.cached_bytes.update(-static_cast<int64_t>(header->system_size));
+      } else {
+        s.num_cache_misses.fetch_add(1, std::memory_order_relaxed);
+        const size_t system_size = sizeof(BlockHeader) + class_size;
+        header = system_alloc(system_size, /*huge=*/false);
+        NUMAMove(header, system_size, numa_node);
+        header->size = class_size;
+        header->size_class = index;
+        header->system_size = system_size;
+        header->numa_node = numa_node;
+      }
+    } else {
+      size_t system_size = sizeof(BlockHeader) + nbytes;
+      if (huge) {
+        system_size = kHugePageSize * ((system_size + kHugePageSize - 1) / kHugePageSize);
+        s.num_huge_page_allocs.fetch_add(1, std::memory_order_relaxed);
+      }
+      header = system_alloc(system_size, huge);
+      const int numa_node = GetCurrentNUMANode();
+      NUMAMove(header, system_size, numa_node);
+      header->size = system_size - sizeof(BlockHeader);
+      header->size_class = kUncached;
+      header->system_size = system_size;
+      header->numa_node = numa_node;
+    }
+
+    void* data = header + 1;
+    fill(data, nbytes);
+    s.allocation.update(1);
+    s.allocated_bytes.update(header->size);
+    profiledCPUMemoryReporter().New(data, nbytes);
+    return {data, data, &Delete, at::Device(at::DeviceType::CPU)};
+  }
+
+  static void Delete(void* ptr) {
+    if (!ptr) {
+      return;
+    }
+    profiledCPUMemoryReporter().Delete(ptr);
+    BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+    auto& s = stats();
+    s.allocation.update(-1);
+    s.allocated_bytes.update(-static_cast<int64_t>(header->size));
+    if (header->size_class != kUncached) {
+      ThreadCache* cache = local_cache();
+      if (cache && cache->push(header)) {
+        s.cached_bytes.update(header->system_size);
+        return;
+      }
+    }
+    system_free(header);
+  }
+
+  at::DeleterFnPtr raw_deleter() const override {
+    return &Delete;
+  }
+};
+
+} // namespace
+
+bool enabled() {
+#ifdef C10_MOBILE
+  return false;
+#else
+  return Config::get().caching;
+#endif
+}
+
+at::Allocator* get() {
+  static CachingCPUAllocator allocator;
+  return &allocator;
+}
+
+AllocatorStats getStats() {
+  const auto& s = stats();
+  AllocatorStats result;
+  result.allocation = s.allocation.load();
+  result.allocated_bytes = s.allocated_bytes.load();
+  result.reserved_bytes = s.reserved_bytes.load();
+  result.cached_bytes = s.cached_bytes.load();
+  result.num_cache_hits = s.num_cache_hits.load();
+  result.num_cache_misses = s.num_cache_misses.load();
+  result.num_huge_page_allocs = s.num_huge_page_allocs.load();
+  return result;
+}
+
+void resetAccumulatedStats() {
+  auto& s = stats();
+  s.allocation.reset_accumulated();
+  s.allocated_bytes.reset_accumulated();
+  s.reserved_bytes.reset_accumulated();
+  s.cached_bytes.reset_accumulated();
+  s.num_cache_hits = 0;
+  s.num_cache_misses = 0;
+  s.num_huge_page_allocs = 0;
+}
+
+void resetPeakStats() {
+  auto& s = stats();
+  s.allocation.reset_peak();
+  s.allocated_bytes.reset_peak();
+  s.reserved_bytes.reset_peak();
+  s.cached_bytes.reset_peak();
+}
+
+void emptyCache() {
+  std::vector<BlockHeader*> blocks;
+  {
+    std::lock_guard<std::mutex> lock(thread_caches_mutex());
+    for (ThreadCache* cache : thread_caches()) {
+      cache->drain(blocks);
+    }
+  }
+  release_blocks(blocks);
+}
+
+} // namespace CPUCachingAllocator
+} // namespace c10
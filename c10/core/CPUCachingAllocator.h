@@ -0,0 +1,80 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+#include <cstdint>
+
+namespace c10 {
+
+// An alternative implementation of the default CPU allocator which keeps
+// freed blocks in per-thread caches, segregated by NUMA node and by size
+// class, instead of returning every block to the system right away. It is
+// meant for workloads with many short-lived intermediate tensors, where
+// posix_memalign/free and the page faults of freshly mapped memory dominate.
+//
+// - Allocation sizes are rounded up to size classes spaced a quarter of a
+//   power of two apart (64, 80, 96, 112, 128, 160, ... bytes), up to 32 MiB.
+//   Larger allocations bypass the caches.
+// - A freed block is cached by the freeing thread under the NUMA node it was
+//   allocated on; allocations only reuse blocks of the current thread's node.
+//   NUMA placement follows the existing caffe2_cpu_numa_enabled flag; without
+//   it, all blocks share a single node.
+// - Optionally, allocations of at least 2 MiB are aligned to 2 MiB and
+//   advised to be backed by transparent huge pages (Linux only).
+//
+// The allocator is selected on the first GetCPUAllocator() call through the
+// PYTORCH_CPU_ALLOC_CONF environment variable, a comma separated list of
+// key:value pairs (an invalid setting is ignored with a warning):
+//
+//   caching:True              use this allocator as the default CPU allocator
+//   thread_cache_size_mb:<N>  bytes each thread may cache (default 64)
+//   huge_pages:True           back large allocations with huge pages
+//
+// e.g. PYTORCH_CPU_ALLOC_CONF=caching:True,huge_pages:True
+
+namespace CPUCachingAllocator {
+
+struct Stat {
+  int64_t current = 0;
+  int64_t peak = 0;
+  int64_t allocated = 0;
+  int64_t freed = 0;
+};
+
+// Struct containing memory allocator summary statistics, mirroring
+// CUDACachingAllocator::DeviceStats.
+struct AllocatorStats {
+  // COUNT: allocations requested by client code
+  Stat allocation;
+  // SUM: bytes handed out to client code (rounded up to the size class)
+  Stat allocated_bytes;
+  // SUM: bytes obtained from the system (both handed out and cached)
+  Stat reserved_bytes;
+  // SUM: bytes held in thread caches
+  Stat cached_bytes;
+
+  // COUNT: allocations served from a thread cache
+  int64_t num_cache_hits = 0;
+  // COUNT: allocations of a cacheable size that needed a system allocation
+  int64_t num_cache_misses = 0;
+  // COUNT: allocations backed by huge pages
+  int64_t num_huge_page_allocs = 0;
+};
+
+// Whether PYTORCH_CPU_ALLOC_CONF selected this allocator as the default CPU
+// allocator.
+C10_API bool enabled();
+
+// Returns the caching allocator (regardless of whether it is enabled).
+C10_API at::Allocator* get();
+
+C10_API AllocatorStats getStats();
+C10_API void resetAccumulatedStats();
+C10_API void resetPeakStats();
+
+// Returns the blocks held in all thread caches to the system.
+C10_API void emptyCache();
+
+} // namespace CPUCachingAllocator
+} // namespace c10
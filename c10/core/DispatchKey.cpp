@@ -46,6 +46,8 @@ const char* toString(DispatchKey t) {
       return "Batched";
     case DispatchKey::TESTING_ONLY_GenericMode:
       return "TESTING_ONLY_GenericMode";
+    case DispatchKey::AutocastCPU:
+      return "AutocastCPU";
     case DispatchKey::Autocast:
       return "Autocast";
     case DispatchKey::TESTING_ONLY_GenericWrapper:
@@ -156,6 +156,9 @@ enum class DispatchKey : uint8_t {
 
   // Autocasting precedes VariableTypeId, to ensure casts are autograd-exposed
   // and inputs are saved for backward in the post-autocast type.
+  // AutocastCPU autocasts CPU tensors to BFloat16, Autocast CUDA tensors to
+  // Half; both are enabled through the thread local included set.
+  AutocastCPU,
   Autocast,
 
   // Here are some reserved pre-autograd keys for user-defined backends, see
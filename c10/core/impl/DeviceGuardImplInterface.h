@@ -1,5 +1,6 @@
 #pragma once
 
+#include <c10/core/Allocator.h>
 #include <c10/core/Device.h>
 #include <c10/core/DeviceType.h>
 #include <c10/core/Stream.h>
@@ -109,6 +110,14 @@ struct C10_API DeviceGuardImplInterface {
     TORCH_CHECK(false, "Backend doesn't support acquiring a default stream.")
   }
 
+  /**
+   * Get a stream from the global pool for a given device.
+   */
+  virtual Stream getStreamFromGlobalPool(Device, bool isHighPriority = false)
+      const {
+    TORCH_CHECK(false, "Backend doesn't support acquiring a stream from pool.")
+  }
+
   /**
    * Set a stream to be the thread local current stream for its device.
    * Return the previous stream for that device. You are NOT required
@@ -161,6 +170,15 @@ struct C10_API DeviceGuardImplInterface {
     TORCH_CHECK(false, "Backend doesn't support events.");
   }
 
+  /**
+   * Tells the caching allocator, if any, that the memory of the DataPtr is
+   * used on the given stream, so that it is not reused before the work
+   * currently queued on that stream is done.
+   */
+  virtual void recordDataPtrOnStream(
+    const c10::DataPtr& /*data_ptr*/,
+    const Stream& /*stream*/) const { }
+
   /**
    * Get the number of devices.  WARNING: This is REQUIRED to not raise
    * an exception.  If there is some sort of problem, e.g., driver error,
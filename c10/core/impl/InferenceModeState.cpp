@@ -0,0 +1,32 @@
+#include <c10/core/impl/InferenceModeState.h>
+
+namespace c10 {
+namespace impl {
+
+// Like at::GradMode, inference mode is only provided when thread_local is
+// available.
+#if !defined(C10_MOBILE) || defined(FEATURE_TORCH_MOBILE)
+
+namespace {
+thread_local bool inference_mode_enabled = false;
+}
+
+bool tls_is_inference_mode_enabled() {
+  return inference_mode_enabled;
+}
+
+void tls_set_inference_mode_enabled(bool enabled) {
+  inference_mode_enabled = enabled;
+}
+
+#else
+
+bool tls_is_inference_mode_enabled() {
+  return false;
+}
+
+void tls_set_inference_mode_enabled(bool enabled) {}
+
+#endif
+
+}} // namespace c10::impl
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+// The thread local flag of at::InferenceMode.  It lives in c10 so that
+// TensorImpl can mark the tensors created while inference mode is enabled;
+// use at::InferenceMode and at::AutoInferenceMode to change it, which also
+// update the dispatch keys and grad mode.
+
+namespace c10 {
+namespace impl {
+
+C10_API bool tls_is_inference_mode_enabled();
+C10_API void tls_set_inference_mode_enabled(bool enabled);
+
+}} // namespace c10::impl
@@ -40,6 +40,10 @@ public:
   Stream getDefaultStream(Device d) const override {
     return impl_->getDefaultStream(d);
   }
+  Stream getStreamFromGlobalPool(Device d, bool isHighPriority = false)
+      const override {
+    return impl_->getStreamFromGlobalPool(d, isHighPriority);
+  }
   Stream exchangeStream(Stream s) const noexcept override {
     return impl_->exchangeStream(s);
   }
@@ -67,6 +71,11 @@ public:
     const DeviceIndex device_index) const noexcept override {
     impl_->destroyEvent(event, device_index);
   }
+  void recordDataPtrOnStream(
+    const c10::DataPtr& data_ptr,
+    const Stream& stream) const override {
+    impl_->recordDataPtrOnStream(data_ptr, stream);
+  }
 
 private:
   const DeviceGuardImplInterface* impl_ = nullptr;
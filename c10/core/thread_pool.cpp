@@ -1,7 +1,62 @@
 #include <c10/core/thread_pool.h>
+#include <c10/util/Exception.h>
+#include <c10/util/string_utils.h>
+
+#include <sstream>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 namespace c10 {
 
+namespace {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// Parses a non-negative CPU id, which must make up all of str.
+int parse_cpu(const std::string& str, const std::string& item) {
+  size_t end = 0;
+  int cpu = -1;
+  try {
+    cpu = c10::stoi(str, &end);
+  } catch (const std::exception&) {
+  }
+  TORCH_CHECK(
+      !str.empty() && end == str.size() && cpu >= 0,
+      "invalid CPU list item '", item, "'");
+  return cpu;
+}
+
+} // namespace
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> cpus;
+  std::istringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    const size_t dash = item.find('-');
+    const int first = parse_cpu(item.substr(0, dash), item);
+    const int last = dash == std::string::npos
+        ? first
+        : parse_cpu(item.substr(dash + 1), item);
+    TORCH_CHECK(first <= last, "invalid CPU range '", item, "'");
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
 ThreadPool::ThreadPool(
       int pool_size,
       int numa_node_id,
@@ -64,6 +119,7 @@ void ThreadPool::run(std::function<void()> func) {
   // Set task and signal condition variable so that a worker thread will
   // wake up and use the task.
   tasks_.emplace(std::move(func));
+  ++num_pending_;
   complete_ = false;
   condition_.notify_one();
 }
@@ -75,12 +131,42 @@ void ThreadPool::waitWorkComplete() {
   }
 }
 
+void ThreadPool::setSpinDuration(std::chrono::microseconds duration) {
+  spin_duration_us_ = duration.count();
+}
+
+bool ThreadPool::spin_for_task(std::unique_lock<std::mutex>& lock) {
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::microseconds(spin_duration_us_.load());
+  lock.unlock();
+  bool found = false;
+  while (true) {
+    if (num_pending_.load() > 0 || !running_) {
+      found = true;
+      break;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    cpu_relax();
+  }
+  lock.lock();
+  return found;
+}
+
 void ThreadPool::main_loop(std::size_t index) {
   std::unique_lock<std::mutex> lock(mutex_);
   while (running_) {
     // Wait on condition variable while the task is empty and
-    // the pool is still running.
+    // the pool is still running, after spinning for a while if requested.
+    bool spun = false;
     while (tasks_.empty() && running_) {
+      if (!spun && spin_duration_us_.load() > 0) {
+        spun = true;
+        if (spin_for_task(lock)) {
+          continue;
+        }
+      }
       condition_.wait(lock);
     }
     // If pool is no longer running, break out of loop.
@@ -96,6 +182,7 @@ void ThreadPool::main_loop(std::size_t index) {
     {
       task_element_t tasks = std::move(tasks_.front());
       tasks_.pop();
+      --num_pending_;
       // Decrement count, indicating thread is no longer available.
       --available_;
 
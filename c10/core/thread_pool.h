@@ -1,11 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <c10/util/Optional.h>
 #include <c10/util/intrusive_ptr.h>
@@ -65,6 +69,9 @@ class C10_API ThreadPool : public c10::TaskThreadPoolBase {
   std::size_t available_;
   std::size_t total_;
   int numa_node_id_;
+  // tasks_.size(), readable without the mutex while spinning
+  std::atomic<std::size_t> num_pending_{0};
+  std::atomic<int64_t> spin_duration_us_{0};
 
  public:
   ThreadPool() = delete;
@@ -91,6 +98,7 @@ class C10_API ThreadPool : public c10::TaskThreadPoolBase {
     // Set task and signal condition variable so that a worker thread will
     // wake up and use the task.
     tasks_.emplace(static_cast<std::function<void(std::size_t)>>(task));
+    ++num_pending_;
     complete_ = false;
     condition_.notify_one();
   }
@@ -98,9 +106,19 @@ class C10_API ThreadPool : public c10::TaskThreadPoolBase {
   /// @brief Wait for queue to be empty
   void waitWorkComplete();
 
+  /// @brief Sets how long an idle thread polls for new tasks before it
+  /// blocks on the condition variable. Spinning spends CPU time to avoid the
+  /// wakeup latency of blocked threads, which dominates for short tasks.
+  /// Zero, the default, blocks right away.
+  void setSpinDuration(std::chrono::microseconds duration);
+
  private:
   // @brief Entry point for pool threads.
   void main_loop(std::size_t index);
+
+  // @brief Polls for a task for up to the spin duration with the lock
+  // released. Returns true if a task was queued or the pool was stopped.
+  bool spin_for_task(std::unique_lock<std::mutex>& lock);
 };
 
 class C10_API TaskThreadPool : public c10::ThreadPool {
@@ -114,6 +132,10 @@ class C10_API TaskThreadPool : public c10::ThreadPool {
       }) {}
 };
 
+// Parses a list of CPUs and CPU ranges such as "0-3,8", as used to pin pool
+// threads. Throws c10::Error on malformed input.
+C10_API std::vector<int> parse_cpu_list(const std::string& list);
+
 C10_DECLARE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
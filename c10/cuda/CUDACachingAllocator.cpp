@@ -3,12 +3,18 @@
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/cuda/CUDAException.h>
 #include <c10/cuda/CUDAFunctions.h>
+#include <c10/util/Backtrace.h>
 #include <c10/util/UniqueVoidPtr.h>
+#include <c10/util/flat_hash_map.h>
 
+#include <cuda.h>
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <atomic>
 #include <bitset>
+#include <cstdlib>
 #include <deque>
+#include <fstream>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -18,9 +24,19 @@
 #include <unordered_set>
 #include <vector>
 
+// Expandable segments are built on the CUDA virtual memory management driver
+// API (cuMemCreate/cuMemMap), which first shipped in CUDA 10.2. The driver
+// entry points are resolved at runtime so c10_cuda keeps linking against
+// cudart only.
+#if !defined(__HIP_PLATFORM_HCC__) && !defined(_WIN32) && CUDA_VERSION >= 10020
+#define C10_CUDA_EXPANDABLE_SEGMENTS
+#include <dlfcn.h>
+#endif
+
 namespace c10 {
 
 C10_DEFINE_REGISTRY(FreeCudaMemoryCallbacksRegistry, FreeMemoryCallback);
+C10_DEFINE_REGISTRY(CudaOutOfMemoryCallbacksRegistry, OutOfMemoryCallback);
 
 namespace cuda {
 namespace CUDACachingAllocator {
@@ -51,6 +67,33 @@ namespace CUDACachingAllocator {
 // ensure that the block is not reused before each recorded stream completes
 // work.
 //
+// - Optionally (PYTORCH_CUDA_ALLOC_CONF=thread_cache_size_mb:<N>), freed
+//   small blocks are parked in a per-thread cache segregated by device,
+//   stream and exact block size. Allocations of a matching size on the same
+//   stream are then served from that cache without taking the allocator
+//   mutex. Each cache has its own mutex, which is only contended when
+//   another thread drains the cache. Cached blocks still count as "active" (they are owned by the
+//   cache), but not as "allocated", so memory_allocated() stays exact. The
+//   caches are drained back into the pools by emptyCache(), snapshot(),
+//   cacheInfo() and before retrying a failed cudaMalloc.
+//
+// - Optionally (PYTORCH_CUDA_ALLOC_CONF=expandable_segments:True), large
+//   blocks are carved out of one expandable segment per stream instead of
+//   separate cudaMalloc segments. An expandable segment reserves a virtual
+//   address range as large as the device memory and maps physical pages at
+//   its end on demand, so a free block at the end of the segment can be
+//   grown in place rather than cached next to a fresh allocation. Freeing
+//   the cache unmaps the pages under free blocks at the end of the segment.
+//
+// - Optionally (PYTORCH_CUDA_ALLOC_CONF=trace_entries:<N>), the last N
+//   alloc/free/segment events of each device are kept in a ring buffer,
+//   each with a truncated backtrace (trace_frames:<K>, default 16). The
+//   trace is available through allocationTrace(), allocated blocks report
+//   their allocation site in snapshot(), and with trace_oom_file:<path> the
+//   trace and a snapshot are written to <path> when an allocation fails.
+//   Tracing records events under the allocator mutex and therefore disables
+//   the thread-local caches.
+//
 
 
 namespace {
@@ -98,8 +141,20 @@ void update_stat_array(StatArray& stat_array, int64_t amount, const StatTypes& s
 }
 
 struct Block;
+struct ExpandableSegment;
+struct PrivatePool;
 typedef bool (*Comparison)(const Block*, const Block*);
-typedef std::set<Block*, Comparison> BlockPool;
+
+// Free blocks of the small or large blocks of the device, or of a private
+// pool of CUDA graphs.
+struct BlockPool : public std::set<Block*, Comparison> {
+  BlockPool(Comparison comparator, bool small, PrivatePool* private_pool = nullptr) :
+    std::set<Block*, Comparison>(comparator), is_small(small),
+    owner_PrivatePool(private_pool) { }
+
+  const bool is_small;
+  PrivatePool* owner_PrivatePool;
+};
 
 struct Block {
   int           device;      // gpu
@@ -112,21 +167,44 @@ struct Block {
   Block*        prev;        // prev block if split from a larger allocation
   Block*        next;        // next block if split from a larger allocation
   int           event_count; // number of outstanding CUDA events
+  ExpandableSegment* segment; // owning expandable segment, if any
+  std::shared_ptr<const std::string> backtrace; // allocation site, if traced
 
   Block(int device, cudaStream_t stream, size_t size, BlockPool* pool, void* ptr) :
     device(device), stream(stream), stream_uses(), size(size), pool(pool),
-    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    segment(nullptr) { }
 
   // constructor for search key
   Block(int device, cudaStream_t stream, size_t size) :
     device(device), stream(stream), stream_uses(), size(size), pool(nullptr),
-    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    segment(nullptr) { }
 
   bool is_split() const {
     return (prev != nullptr) || (next != nullptr);
   }
 };
 
+static bool BlockComparator(const Block* a, const Block* b);
+
+// Memory of the CUDA graphs sharing a MempoolId_t, see notifyCaptureBegin.
+struct PrivatePool {
+  PrivatePool() :
+    large_blocks(BlockComparator, /*small=*/false, this),
+    small_blocks(BlockComparator, /*small=*/true, this) { }
+  PrivatePool(const PrivatePool&) = delete;
+  PrivatePool& operator=(const PrivatePool&) = delete;
+
+  // number of graphs using the pool
+  int use_count = 1;
+  // number of cudaMallocs of the pool that are not freed yet; the pool is
+  // deleted once this and use_count are both zero
+  int cudaMalloc_count = 0;
+  BlockPool large_blocks;
+  BlockPool small_blocks;
+};
+
 static bool BlockComparator(const Block* a, const Block* b)
 {
   if (a->stream != b->stream) {
@@ -157,6 +235,452 @@ static std::string format_size(uint64_t size) {
   return os.str();
 }
 
+// Allocator settings, parsed once from the PYTORCH_CUDA_ALLOC_CONF
+// environment variable. The variable holds a comma separated list of
+// key:value pairs, e.g. PYTORCH_CUDA_ALLOC_CONF=thread_cache_size_mb:64
+class CachingAllocatorConfig {
+ public:
+  // Maximum number of bytes each thread may keep in its block cache;
+  // 0 disables the thread-local caches.
+  static size_t thread_cache_size() {
+    return instance().m_thread_cache_size;
+  }
+
+  // Whether large blocks are allocated from expandable segments.
+  static bool expandable_segments() {
+    return instance().m_expandable_segments;
+  }
+
+  // Capacity of each device's allocation trace ring buffer; 0 disables
+  // tracing.
+  static size_t trace_entries() {
+    return instance().m_trace_entries;
+  }
+
+  // Maximum number of stack frames recorded per traced event.
+  static size_t trace_frames() {
+    return instance().m_trace_frames;
+  }
+
+  // File the trace is written to when an allocation fails, if any.
+  static const std::string& trace_oom_file() {
+    return instance().m_trace_oom_file;
+  }
+
+  // Maximum number of bytes of pinned host memory the caching host
+  // allocator keeps; 0 means no limit.
+  static size_t pinned_max_cached_size() {
+    return instance().m_pinned_max_cached_size;
+  }
+
+ private:
+  static CachingAllocatorConfig& instance() {
+    static CachingAllocatorConfig* s_instance = new CachingAllocatorConfig();
+    return *s_instance;
+  }
+
+  CachingAllocatorConfig()
+      : m_thread_cache_size(0),
+        m_expandable_segments(false),
+        m_trace_entries(0),
+        m_trace_frames(16),
+        m_pinned_max_cached_size(0) {
+    parse(getenv("PYTORCH_CUDA_ALLOC_CONF"));
+    if (m_trace_entries > 0) {
+      m_thread_cache_size = 0;
+    }
+  }
+
+  void parse(const char* env) {
+    if (env == nullptr) {
+      return;
+    }
+    std::string config(env);
+    size_t begin = 0;
+    while (begin < config.size()) {
+      size_t end = config.find(',', begin);
+      if (end == std::string::npos) {
+        end = config.size();
+      }
+      const std::string option = config.substr(begin, end - begin);
+      begin = end + 1;
+      if (option.empty()) {
+        continue;
+      }
+      const size_t colon = option.find(':');
+      TORCH_CHECK(colon != std::string::npos,
+          "Invalid PYTORCH_CUDA_ALLOC_CONF option '", option,
+          "', expected key:value");
+      const std::string key = option.substr(0, colon);
+      const std::string value = option.substr(colon + 1);
+      if (key == "thread_cache_size_mb") {
+        m_thread_cache_size = parse_int(key, value) * 1048576;
+      } else if (key == "trace_entries") {
+        m_trace_entries = parse_int(key, value);
+      } else if (key == "trace_frames") {
+        m_trace_frames = parse_int(key, value);
+      } else if (key == "trace_oom_file") {
+        m_trace_oom_file = value;
+      } else if (key == "pinned_max_cached_mb") {
+        m_pinned_max_cached_size = parse_int(key, value) * 1048576;
+      } else if (key == "expandable_segments") {
+        m_expandable_segments = parse_bool(key, value);
+#ifndef C10_CUDA_EXPANDABLE_SEGMENTS
+        TORCH_CHECK(!m_expandable_segments,
+            "expandable_segments requires CUDA 10.2 or newer on Linux");
+#endif
+      } else {
+        TORCH_CHECK(false, "Unrecognized PYTORCH_CUDA_ALLOC_CONF option: ", key);
+      }
+    }
+  }
+
+  static size_t parse_int(const std::string& key, const std::string& value) {
+    char* end = nullptr;
+    const long long result = strtoll(value.c_str(), &end, 10);
+    TORCH_CHECK(!value.empty() && *end == '\0' && result >= 0,
+        "Invalid value for PYTORCH_CUDA_ALLOC_CONF option ", key, ": ", value);
+    return static_cast<size_t>(result);
+  }
+
+  static bool parse_bool(const std::string& key, const std::string& value) {
+    TORCH_CHECK(value == "True" || value == "False",
+        "Invalid value for PYTORCH_CUDA_ALLOC_CONF option ", key, ": ", value,
+        " (expected True or False)");
+    return value == "True";
+  }
+
+  size_t m_thread_cache_size;
+  bool m_expandable_segments;
+  size_t m_trace_entries;
+  size_t m_trace_frames;
+  std::string m_trace_oom_file;
+  size_t m_pinned_max_cached_size;
+};
+
+#ifdef C10_CUDA_EXPANDABLE_SEGMENTS
+
+// Virtual memory management entry points of the CUDA driver, loaded from
+// libcuda on first use.
+struct DriverAPI {
+#define C10_DRIVER_API_MEMBER(name) decltype(&name) name##_;
+  C10_DRIVER_API_MEMBER(cuGetErrorString)
+  C10_DRIVER_API_MEMBER(cuMemAddressReserve)
+  C10_DRIVER_API_MEMBER(cuMemAddressFree)
+  C10_DRIVER_API_MEMBER(cuMemCreate)
+  C10_DRIVER_API_MEMBER(cuMemRelease)
+  C10_DRIVER_API_MEMBER(cuMemMap)
+  C10_DRIVER_API_MEMBER(cuMemUnmap)
+  C10_DRIVER_API_MEMBER(cuMemSetAccess)
+  C10_DRIVER_API_MEMBER(cuMemGetAllocationGranularity)
+#undef C10_DRIVER_API_MEMBER
+
+  static const DriverAPI& get() {
+    static DriverAPI* api = create();
+    return *api;
+  }
+
+ private:
+  static DriverAPI* create() {
+    void* handle = dlopen("libcuda.so.1", RTLD_LAZY | RTLD_NOLOAD);
+    if (!handle) {
+      handle = dlopen("libcuda.so.1", RTLD_LAZY);
+    }
+    TORCH_CHECK(handle, "expandable_segments: failed to load libcuda.so.1: ", dlerror());
+    auto api = new DriverAPI();
+#define C10_LOAD_DRIVER_API(name)                                          \
+    api->name##_ = reinterpret_cast<decltype(&name)>(dlsym(handle, #name)); \
+    TORCH_CHECK(api->name##_, "expandable_segments: driver lacks " #name);
+    C10_LOAD_DRIVER_API(cuGetErrorString)
+    C10_LOAD_DRIVER_API(cuMemAddressReserve)
+    C10_LOAD_DRIVER_API(cuMemAddressFree)
+    C10_LOAD_DRIVER_API(cuMemCreate)
+    C10_LOAD_DRIVER_API(cuMemRelease)
+    C10_LOAD_DRIVER_API(cuMemMap)
+    C10_LOAD_DRIVER_API(cuMemUnmap)
+    C10_LOAD_DRIVER_API(cuMemSetAccess)
+    C10_LOAD_DRIVER_API(cuMemGetAllocationGranularity)
+#undef C10_LOAD_DRIVER_API
+    return api;
+  }
+};
+
+#define C10_CUDA_DRIVER_CHECK(EXPR)                                    \
+  do {                                                                 \
+    CUresult __err = EXPR;                                             \
+    if (__err != CUDA_SUCCESS) {                                       \
+      const char* err_str = nullptr;                                   \
+      DriverAPI::get().cuGetErrorString_(__err, &err_str);             \
+      AT_ERROR("CUDA driver error: ", err_str ? err_str : "unknown");  \
+    }                                                                  \
+  } while (0)
+
+// A virtual address range reserved for one (device, stream) pair whose
+// prefix [ptr, ptr + mapped_size) is backed by physical pages. Pages are
+// mapped and unmapped individually, one cuMemCreate handle each, so the
+// segment can shrink again from its end.
+//
+// Like cudaMalloc'd segments, expandable segments are never released at
+// process exit.
+struct ExpandableSegment {
+  ExpandableSegment(int device, cudaStream_t stream) :
+      device(device), stream(stream), base(0), reserved_size(0),
+      granularity(0), tail(nullptr) {
+    // cudaMemGetInfo also makes sure the primary context is initialized
+    // before any driver call.
+    size_t device_free;
+    size_t device_total;
+    C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+
+    const DriverAPI& api = DriverAPI::get();
+    CUmemAllocationProp prop = {};
+    prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    prop.location.id = device;
+    C10_CUDA_DRIVER_CHECK(api.cuMemGetAllocationGranularity_(
+        &granularity, &prop, CU_MEM_ALLOC_GRANULARITY_MINIMUM));
+    reserved_size = round_up(device_total);
+    C10_CUDA_DRIVER_CHECK(
+        api.cuMemAddressReserve_(&base, reserved_size, 0, 0, 0));
+  }
+
+  char* ptr() const {
+    return reinterpret_cast<char*>(base);
+  }
+
+  size_t mapped_size() const {
+    return handles.size() * granularity;
+  }
+
+  size_t round_up(size_t size) const {
+    return granularity * ((size + granularity - 1) / granularity);
+  }
+
+  // Maps pages at the end of the segment until at least size more bytes are
+  // mapped. Returns cudaErrorMemoryAllocation if the device is out of memory
+  // or the range is exhausted, and throws on other driver errors; either way
+  // the pages mapped so far are released and the segment is left unchanged.
+  cudaError_t grow(size_t size) {
+    const DriverAPI& api = DriverAPI::get();
+    const size_t num_pages = round_up(size) / granularity;
+    if (mapped_size() + num_pages * granularity > reserved_size) {
+      return cudaErrorMemoryAllocation;
+    }
+
+    CUmemAllocationProp prop = {};
+    prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    prop.location.id = device;
+
+    const size_t first_page = handles.size();
+    for (size_t i = 0; i < num_pages; i++) {
+      CUmemGenericAllocationHandle handle;
+      CUresult err = api.cuMemCreate_(&handle, granularity, &prop, 0);
+      if (err == CUDA_SUCCESS) {
+        err = api.cuMemMap_(
+            base + handles.size() * granularity, granularity, 0, handle, 0);
+        if (err != CUDA_SUCCESS) {
+          // the handle is only tracked in handles once it is mapped
+          api.cuMemRelease_(handle);
+        }
+      }
+      if (err != CUDA_SUCCESS) {
+        unmap_pages(first_page);
+        if (err == CUDA_ERROR_OUT_OF_MEMORY) {
+          return cudaErrorMemoryAllocation;
+        }
+        C10_CUDA_DRIVER_CHECK(err);
+      }
+      handles.push_back(handle);
+    }
+
+    CUmemAccessDesc desc = {};
+    desc.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    desc.location.id = device;
+    desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    CUresult err = api.cuMemSetAccess_(
+        base + first_page * granularity, num_pages * granularity, &desc, 1);
+    if (err != CUDA_SUCCESS) {
+      unmap_pages(first_page);
+      C10_CUDA_DRIVER_CHECK(err);
+    }
+    return cudaSuccess;
+  }
+
+  // Unmaps and releases every page from index first_page onwards.
+  void unmap_pages(size_t first_page) {
+    const DriverAPI& api = DriverAPI::get();
+    while (handles.size() > first_page) {
+      C10_CUDA_DRIVER_CHECK(api.cuMemUnmap_(
+          base + (handles.size() - 1) * granularity, granularity));
+      C10_CUDA_DRIVER_CHECK(api.cuMemRelease_(handles.back()));
+      handles.pop_back();
+    }
+  }
+
+  int device;
+  cudaStream_t stream;
+  CUdeviceptr base;
+  size_t reserved_size;
+  size_t granularity;
+  std::vector<CUmemGenericAllocationHandle> handles;
+  // last block of the segment, nullptr while nothing is mapped
+  Block* tail;
+};
+
+#else
+
+struct ExpandableSegment {
+  Block* tail;
+};
+
+#endif // C10_CUDA_EXPANDABLE_SEGMENTS
+
+// Cache of freed small blocks owned by a single thread. Blocks are segregated
+// by (device, stream) and then by their exact size, which is always a multiple
+// of kMinBlockSize, so a lookup is a short linear scan over the streams the
+// thread has used followed by one hash lookup.
+//
+// The mutex is only ever contended when another thread drains the cache
+// (emptyCache() or an OOM retry); the owning thread never calls into a
+// DeviceCachingAllocator while holding it.
+struct ThreadBlockCache {
+  struct StreamFreeLists {
+    int device;
+    cudaStream_t stream;
+    ska::flat_hash_map<size_t, std::vector<Block*>> size_classes;
+  };
+
+  ThreadBlockCache();
+  ~ThreadBlockCache();
+
+  Block* pop(int device, cudaStream_t stream, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& lists : streams) {
+      if (lists.device != device || lists.stream != stream) {
+        continue;
+      }
+      auto it = lists.size_classes.find(size);
+      if (it == lists.size_classes.end() || it->second.empty()) {
+        return nullptr;
+      }
+      Block* block = it->second.back();
+      it->second.pop_back();
+      cached_bytes -= size;
+      return block;
+    }
+    return nullptr;
+  }
+
+  // Returns false if the cache is full; the caller must free the block
+  // through its DeviceCachingAllocator instead.
+  bool push(Block* block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cached_bytes + block->size > CachingAllocatorConfig::thread_cache_size()) {
+      return false;
+    }
+    cached_bytes += block->size;
+    for (auto& lists : streams) {
+      if (lists.device == block->device && lists.stream == block->stream) {
+        lists.size_classes[block->size].push_back(block);
+        return true;
+      }
+    }
+    streams.emplace_back();
+    streams.back().device = block->device;
+    streams.back().stream = block->stream;
+    streams.back().size_classes[block->size].push_back(block);
+    return true;
+  }
+
+  // Moves all cached blocks of the given device (or of all devices if device
+  // is -1) into out.
+  void drain(int device, std::vector<Block*>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& lists : streams) {
+      if (device != -1 && lists.device != device) {
+        continue;
+      }
+      for (auto& size_class : lists.size_classes) {
+        for (Block* block : size_class.second) {
+          cached_bytes -= block->size;
+          out.push_back(block);
+        }
+        size_class.second.clear();
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::vector<StreamFreeLists> streams;
+  size_t cached_bytes = 0;
+};
+
+// Registry of all live thread caches, so that they can be drained from any
+// thread. Intentionally leaked to outlive thread_local destructors.
+std::mutex& thread_caches_mutex() {
+  static std::mutex* m = new std::mutex();
+  return *m;
+}
+
+std::vector<ThreadBlockCache*>& thread_caches() {
+  static std::vector<ThreadBlockCache*>* caches = new std::vector<ThreadBlockCache*>();
+  return *caches;
+}
+
+ThreadBlockCache::ThreadBlockCache() {
+  std::lock_guard<std::mutex> lock(thread_caches_mutex());
+  thread_caches().push_back(this);
+}
+
+ThreadBlockCache& local_block_cache() {
+  static thread_local ThreadBlockCache cache;
+  return cache;
+}
+
+// Moves the cached blocks of the given device (-1 for all devices) out of
+// every thread cache.
+void drain_thread_caches(int device, std::vector<Block*>& out) {
+  std::lock_guard<std::mutex> lock(thread_caches_mutex());
+  for (ThreadBlockCache* cache : thread_caches()) {
+    cache->drain(device, out);
+  }
+}
+
+// Hands blocks drained from a thread cache back to their device allocators.
+// Defined after THCCachingAllocator.
+void return_thread_cached_blocks(const std::vector<Block*>& blocks);
+
+// Internal form of TraceEntry; backtraces are shared with the traced block.
+struct TraceRecord {
+  TraceEntry::Action action;
+  void* address;
+  size_t size;
+  cudaStream_t stream;
+  std::shared_ptr<const std::string> backtrace;
+};
+
+std::shared_ptr<const std::string> capture_backtrace() {
+  const size_t frames = CachingAllocatorConfig::trace_frames();
+  if (frames == 0) {
+    return nullptr;
+  }
+  // skip capture_backtrace and DeviceCachingAllocator::record_trace
+  return std::make_shared<const std::string>(
+      c10::get_backtrace(/*frames_to_skip=*/2, frames));
+}
+
+const char* trace_action_name(TraceEntry::Action action) {
+  switch (action) {
+    case TraceEntry::ALLOC: return "alloc";
+    case TraceEntry::FREE: return "free";
+    case TraceEntry::SEGMENT_ALLOC: return "segment_alloc";
+    case TraceEntry::SEGMENT_FREE: return "segment_free";
+    case TraceEntry::OOM: return "oom";
+  }
+  return "unknown";
+}
+
 struct AllocParams {
   AllocParams(int device, size_t size, cudaStream_t stream, BlockPool* pool, size_t alloc_size,
               DeviceStats& stats) :
@@ -202,11 +726,39 @@ class DeviceCachingAllocator {
   // outstanding cuda events
   std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
 
+  // expandable segments backing the large pool, one per stream
+  std::vector<std::unique_ptr<ExpandableSegment>> expandable_segments;
+
+  // private pools of CUDA graphs by id, and the pools of the streams
+  // capturing into them; allocations on a capturing stream come from its
+  // pool. Pools no longer used by any graph are released by
+  // free_cached_blocks once all of their blocks are free.
+  std::unordered_map<MempoolId_t, std::unique_ptr<PrivatePool>> graph_pools;
+  std::unordered_map<cudaStream_t, PrivatePool*> capturing_streams;
+  // size of capturing_streams, readable without the mutex
+  std::atomic<int> num_capturing_streams{0};
+
+  // freed blocks with uses on other streams, whose events are recorded once
+  // no capture is underway (recording or querying events would be captured)
+  std::vector<Block*> needs_events_deferred_until_no_capture;
+
+  // ring buffer of the most recent allocator events; trace_next is the slot
+  // overwritten by the next event once the buffer is full
+  std::vector<TraceRecord> trace;
+  size_t trace_next = 0;
+
+  // allocations and frees served by the thread-local block caches without
+  // holding the mutex; folded into stats by fold_thread_cache_stats()
+  std::atomic<int64_t> thread_cache_allocs{0};
+  std::atomic<int64_t> thread_cache_alloc_bytes{0};
+  std::atomic<int64_t> thread_cache_frees{0};
+  std::atomic<int64_t> thread_cache_free_bytes{0};
+
  public:
 
   DeviceCachingAllocator() :
-      large_blocks(BlockComparator),
-      small_blocks(BlockComparator) {}
+      large_blocks(BlockComparator, /*small=*/false),
+      small_blocks(BlockComparator, /*small=*/true) {}
 
   // All public methods (except the above) acquire the allocator mutex.
   // Thus, do not call a public method from another public method.
@@ -215,11 +767,17 @@ class DeviceCachingAllocator {
   {
     std::unique_lock<std::recursive_mutex> lock(mutex);
 
-    // process outstanding cudaEvents
-    process_events();
+    fold_thread_cache_stats();
+
+    // process outstanding cudaEvents, unless a capture is underway
+    // (cudaEventQuery is not allowed then)
+    if (C10_LIKELY(capturing_streams.empty())) {
+      insert_deferred_events();
+      process_events();
+    }
 
     size = round_size(size);
-    auto& pool = get_pool(size);
+    auto& pool = get_pool(size, stream);
     const size_t alloc_size = get_allocation_size(size);
     AllocParams params(device, size, stream, &pool, alloc_size, stats);
     params.stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
@@ -232,8 +790,11 @@ class DeviceCachingAllocator {
       || (trigger_free_memory_callbacks(params) && get_free_block(params))
       // Attempt allocate
       || alloc_block(params, false)
-      // Free all non-split cached blocks and retry alloc.
-      || (free_cached_blocks() && alloc_block(params, true));
+      // Free all non-split cached blocks and retry alloc. Not while a capture
+      // is underway, since cudaFree synchronizes the device.
+      || (C10_LIKELY(capturing_streams.empty())
+          && release_thread_cached_blocks(device) && free_cached_blocks()
+          && alloc_block(params, true));
 
     TORCH_INTERNAL_ASSERT((!block_found && params.err != cudaSuccess) || params.block);
     if (!block_found) {
@@ -244,6 +805,9 @@ class DeviceCachingAllocator {
 
         stats.num_ooms += 1;
 
+        record_trace(TraceEntry::OOM, nullptr, alloc_size, stream);
+        trigger_out_of_memory_callbacks(device, alloc_size);
+
         // "total capacity": total global memory on GPU
         // "already allocated": memory allocated by the program using the
         //                      caching allocator
@@ -284,6 +848,7 @@ class DeviceCachingAllocator {
       remaining = block;
 
       block = new Block(device, stream, size, &pool, block->ptr);
+      block->segment = remaining->segment;
       block->prev = remaining->prev;
       if (block->prev) {
         block->prev->next = block;
@@ -312,6 +877,7 @@ class DeviceCachingAllocator {
 
     block->allocated = true;
     active_blocks.insert(block);
+    block->backtrace = record_trace(TraceEntry::ALLOC, block->ptr, block->size, stream);
 
     c10::reportMemoryUsageToProfiler(
         block, block->size, c10::Device(c10::DeviceType::CUDA, device));
@@ -328,7 +894,11 @@ class DeviceCachingAllocator {
   {
     std::lock_guard<std::recursive_mutex> lock(mutex);
 
+    fold_thread_cache_stats();
+
     block->allocated = false;
+    block->backtrace.reset();
+    record_trace(TraceEntry::FREE, block->ptr, block->size, block->stream);
 
     c10::reportMemoryUsageToProfiler(
         block, -block->size, c10::Device(c10::DeviceType::CUDA, block->device));
@@ -340,7 +910,11 @@ class DeviceCachingAllocator {
     update_stat_array(stats.allocated_bytes, -block->size, {stat_types});
 
     if (!block->stream_uses.empty()) {
-      insert_events(block);
+      if (C10_UNLIKELY(!capturing_streams.empty())) {
+        needs_events_deferred_until_no_capture.push_back(block);
+      } else {
+        insert_events(block);
+      }
     } else {
       free_block(block);
     }
@@ -373,12 +947,79 @@ class DeviceCachingAllocator {
     block->stream_uses.insert(stream);
   }
 
+  /** whether a freed block may be parked in a thread-local cache **/
+  bool isThreadCacheable(const Block* block) const {
+    return block->pool == &small_blocks && block->stream_uses.empty();
+  }
+
+  /** accounts for a block handed out by a thread-local cache, without the allocator mutex **/
+  void recordThreadCacheAlloc(Block* block) {
+    thread_cache_allocs.fetch_add(1, std::memory_order_relaxed);
+    thread_cache_alloc_bytes.fetch_add(block->size, std::memory_order_relaxed);
+    c10::reportMemoryUsageToProfiler(
+        block, block->size, c10::Device(c10::DeviceType::CUDA, block->device));
+  }
+
+  /** accounts for a block parked in a thread-local cache, without the allocator mutex **/
+  void recordThreadCacheFree(Block* block, size_t size) {
+    thread_cache_frees.fetch_add(1, std::memory_order_relaxed);
+    thread_cache_free_bytes.fetch_add(size, std::memory_order_relaxed);
+    c10::reportMemoryUsageToProfiler(
+        block, -static_cast<int64_t>(size),
+        c10::Device(c10::DeviceType::CUDA, block->device));
+  }
+
+  /** moves blocks drained from thread-local caches back into the pools **/
+  void returnThreadCachedBlocks(const std::vector<Block*>& blocks) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return_thread_cached_blocks_locked(blocks);
+  }
+
   /** returns cached blocks to the system allocator **/
   void emptyCache() {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    TORCH_CHECK(capturing_streams.empty(),
+                "emptyCache is not allowed while a CUDA graph capture is underway");
     free_cached_blocks();
   }
 
+  /** whether allocations may currently come from a private pool, without the allocator mutex **/
+  bool capturesUnderway() const {
+    return num_capturing_streams.load(std::memory_order_relaxed) > 0;
+  }
+
+  /** allocations on stream come from the private pool mempool_id until
+      notifyCaptureEnd **/
+  void notifyCaptureBegin(cudaStream_t stream, MempoolId_t mempool_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    TORCH_INTERNAL_ASSERT(mempool_id != 0, "invalid private pool id");
+    TORCH_CHECK(capturing_streams.count(stream) == 0,
+                "a CUDA graph capture is already underway on this stream");
+    auto it = graph_pools.find(mempool_id);
+    if (it == graph_pools.end()) {
+      it = graph_pools.emplace(mempool_id, std::unique_ptr<PrivatePool>(new PrivatePool())).first;
+    } else {
+      it->second->use_count++;
+    }
+    capturing_streams[stream] = it->second.get();
+    num_capturing_streams = capturing_streams.size();
+  }
+
+  void notifyCaptureEnd(cudaStream_t stream) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    capturing_streams.erase(stream);
+    num_capturing_streams = capturing_streams.size();
+  }
+
+  /** a graph of the private pool mempool_id no longer uses it **/
+  void notifyCaptureDestroy(MempoolId_t mempool_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    auto it = graph_pools.find(mempool_id);
+    TORCH_INTERNAL_ASSERT(it != graph_pools.end(), "unknown private pool ", mempool_id);
+    TORCH_INTERNAL_ASSERT(it->second->use_count > 0);
+    it->second->use_count--;
+  }
+
   /** Retrieves info (total size + largest block) of the memory cache **/
   void cacheInfo(size_t* total, size_t* largest)
   {
@@ -395,12 +1036,14 @@ class DeviceCachingAllocator {
   /** Returns a copy of the memory allocator stats **/
   DeviceStats getStats() {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    fold_thread_cache_stats();
     return stats;
   }
 
   /** Resets the historical accumulation stats for the device **/
   void resetAccumulatedStats() {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    fold_thread_cache_stats();
 
     for (size_t statType = 0; statType < static_cast<size_t>(StatType::NUM_TYPES); ++statType) {
       reset_accumulated_stat(stats.allocation[statType]);
@@ -420,6 +1063,7 @@ class DeviceCachingAllocator {
   /** Resets the historical peak stats for the device **/
   void resetPeakStats() {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    fold_thread_cache_stats();
 
     for (size_t statType = 0; statType < static_cast<size_t>(StatType::NUM_TYPES); ++statType) {
       reset_peak_stat(stats.allocation[statType]);
@@ -448,7 +1092,9 @@ class DeviceCachingAllocator {
       SegmentInfo& segment_info = result.back();
       segment_info.device = head_block->device;
       segment_info.address = reinterpret_cast<int64_t>(head_block->ptr);
-      segment_info.is_large = (head_block->pool == &large_blocks);
+      segment_info.stream = reinterpret_cast<int64_t>(head_block->stream);
+      segment_info.is_large = !head_block->pool->is_small;
+      segment_info.is_expandable = (head_block->segment != nullptr);
 
       const Block* block = head_block;
       while (block != nullptr) {
@@ -458,6 +1104,9 @@ class DeviceCachingAllocator {
         block_info.size = block->size;
         block_info.allocated = block->allocated;
         block_info.active = block->allocated || (block->event_count > 0);
+        if (block->allocated && block->backtrace) {
+          block_info.backtrace = *block->backtrace;
+        }
 
         segment_info.total_size += block_info.size;
         if (block_info.allocated) {
@@ -478,6 +1127,27 @@ class DeviceCachingAllocator {
     return result;
   }
 
+  /** Returns the traced events, oldest first. **/
+  std::vector<TraceEntry> allocationTrace() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    std::vector<TraceEntry> result;
+    result.reserve(trace.size());
+    for (size_t i = 0; i < trace.size(); i++) {
+      // before the buffer wraps around trace_next is 0
+      const TraceRecord& record = trace[(trace_next + i) % trace.size()];
+      result.emplace_back();
+      TraceEntry& entry = result.back();
+      entry.action = record.action;
+      entry.address = reinterpret_cast<int64_t>(record.address);
+      entry.size = record.size;
+      entry.stream = reinterpret_cast<int64_t>(record.stream);
+      if (record.backtrace) {
+        entry.backtrace = *record.backtrace;
+      }
+    }
+    return result;
+  }
+
   static size_t round_size(size_t size) {
     if (size < kMinBlockSize) {
       return kMinBlockSize;
@@ -490,10 +1160,81 @@ class DeviceCachingAllocator {
 
   // All private methods do not acquire the allocator mutex.
 
+  /** appends an event to the trace; returns its backtrace, if captured **/
+  std::shared_ptr<const std::string> record_trace(
+      TraceEntry::Action action, void* address, size_t size, cudaStream_t stream) {
+    const size_t capacity = CachingAllocatorConfig::trace_entries();
+    if (capacity == 0) {
+      return nullptr;
+    }
+    TraceRecord record{action, address, size, stream, capture_backtrace()};
+    auto backtrace = record.backtrace;
+    if (trace.size() < capacity) {
+      trace.push_back(std::move(record));
+    } else {
+      trace[trace_next] = std::move(record);
+      trace_next = (trace_next + 1) % capacity;
+    }
+    return backtrace;
+  }
+
+  void trigger_out_of_memory_callbacks(int device, size_t alloc_size) {
+    for (const auto& name : CudaOutOfMemoryCallbacksRegistry()->Keys()) {
+      CudaOutOfMemoryCallbacksRegistry()->Create(name)->Execute(device, alloc_size);
+    }
+  }
+
+  /** applies the stat changes made by the thread-local caches **/
+  void fold_thread_cache_stats() {
+    const int64_t allocs = thread_cache_allocs.exchange(0);
+    const int64_t alloc_bytes = thread_cache_alloc_bytes.exchange(0);
+    const int64_t frees = thread_cache_frees.exchange(0);
+    const int64_t free_bytes = thread_cache_free_bytes.exchange(0);
+    if (allocs == 0 && frees == 0) {
+      return;
+    }
+
+    // Thread caches only ever hold small blocks. Allocations are applied
+    // before frees so that the tracked current value never goes negative;
+    // as a consequence peaks may be overestimated by at most the
+    // allocations made since the previous fold.
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(StatType::SMALL_POOL)] = true;
+    update_stat_array(stats.allocation, allocs, stat_types);
+    update_stat_array(stats.allocated_bytes, alloc_bytes, stat_types);
+    update_stat_array(stats.allocation, -frees, stat_types);
+    update_stat_array(stats.allocated_bytes, -free_bytes, stat_types);
+  }
+
+  void return_thread_cached_blocks_locked(const std::vector<Block*>& blocks) {
+    for (Block* block : blocks) {
+      // Blocks stay marked allocated while owned by a thread cache;
+      // their allocation stats were already released by recordThreadCacheFree.
+      block->allocated = false;
+      free_block(block);
+    }
+  }
+
+  /** drains this device's blocks from every thread-local cache **/
+  bool release_thread_cached_blocks(int device) {
+    if (CachingAllocatorConfig::thread_cache_size() > 0) {
+      std::vector<Block*> blocks;
+      drain_thread_caches(device, blocks);
+      return_thread_cached_blocks_locked(blocks);
+    }
+    return true;
+  }
+
   std::vector<const Block*> get_all_blocks() const {
     std::vector<const Block*> blocks;
     blocks.insert(blocks.end(), small_blocks.begin(), small_blocks.end());
     blocks.insert(blocks.end(), large_blocks.begin(), large_blocks.end());
+    for (const auto& entry : graph_pools) {
+      const PrivatePool& private_pool = *entry.second;
+      blocks.insert(blocks.end(), private_pool.small_blocks.begin(), private_pool.small_blocks.end());
+      blocks.insert(blocks.end(), private_pool.large_blocks.begin(), private_pool.large_blocks.end());
+    }
     blocks.insert(blocks.end(), active_blocks.begin(), active_blocks.end());
     return blocks;
   }
@@ -557,6 +1298,10 @@ class DeviceCachingAllocator {
       }
     }
 
+    if (src->segment && src->segment->tail == src) {
+      src->segment->tail = dst;
+    }
+
     const size_t subsumed_size = src->size;
     dst->size += subsumed_size;
     pool.erase(src);
@@ -565,7 +1310,14 @@ class DeviceCachingAllocator {
     return subsumed_size;
   }
 
-  BlockPool& get_pool(size_t size) {
+  BlockPool& get_pool(size_t size, cudaStream_t stream) {
+    if (C10_UNLIKELY(!capturing_streams.empty())) {
+      auto it = capturing_streams.find(stream);
+      if (it != capturing_streams.end()) {
+        PrivatePool* private_pool = it->second;
+        return size <= kSmallSize ? private_pool->small_blocks : private_pool->large_blocks;
+      }
+    }
     if (size <= kSmallSize) {
       return small_blocks;
     } else {
@@ -574,23 +1326,15 @@ class DeviceCachingAllocator {
   }
 
   StatType get_stat_type_for_pool(const BlockPool& pool) {
-    if (&pool == &small_blocks) {
-      return StatType::SMALL_POOL;
-    } else if (&pool == &large_blocks) {
-      return StatType::LARGE_POOL;
-    } else {
-      AT_ERROR("get_stat_type_for_pool: invalid pool");
-    }
+    return pool.is_small ? StatType::SMALL_POOL : StatType::LARGE_POOL;
   }
 
   bool should_split(const Block* block, size_t size) {
     size_t remaining = block->size - size;
-    if (block->pool == &small_blocks) {
+    if (block->pool->is_small) {
       return remaining >= kMinBlockSize;
-    } else if (block->pool == &large_blocks) {
-      return remaining > kSmallSize;
     } else {
-      AT_ERROR("should_split: invalid pool");
+      return remaining > kSmallSize;
     }
   }
 
@@ -631,6 +1375,10 @@ class DeviceCachingAllocator {
       stats.num_alloc_retries += 1;
     }
 
+    if (CachingAllocatorConfig::expandable_segments() && p.pool == &large_blocks) {
+      return grow_expandable_segment(p);
+    }
+
     p.err = cudaMalloc(&ptr, size);
     if (p.err != cudaSuccess) {
       if (!isRetry || p.err == cudaErrorMemoryAllocation)
@@ -638,33 +1386,173 @@ class DeviceCachingAllocator {
       return false;
     }
 
+    if (p.pool->owner_PrivatePool) {
+      p.pool->owner_PrivatePool->cudaMalloc_count++;
+    }
     p.block = new Block(p.device(), p.stream(), size, p.pool, (char*)ptr);
+    record_trace(TraceEntry::SEGMENT_ALLOC, ptr, size, p.stream());
     update_stat_array(stats.segment, 1, p.stat_types);
     update_stat_array(stats.reserved_bytes, size, p.stat_types);
 
     return (p.block != nullptr);
   }
 
+  /** extends the expandable segment of p's stream so that the
+      segment's last block can satisfy p **/
+  bool grow_expandable_segment(AllocParams& p) {
+#ifdef C10_CUDA_EXPANDABLE_SEGMENTS
+    ExpandableSegment* segment = get_expandable_segment(p.device(), p.stream());
+    Block* tail = segment->tail;
+    // A free tail is too small for p (otherwise get_free_block would have
+    // returned it), so grow the segment by the missing bytes only.
+    const bool extend_tail = tail && !tail->allocated && tail->event_count == 0;
+    const size_t old_mapped_size = segment->mapped_size();
+
+    p.err = segment->grow(p.size() - (extend_tail ? tail->size : 0));
+    if (p.err != cudaSuccess) {
+      return false;
+    }
+
+    const size_t grown = segment->mapped_size() - old_mapped_size;
+    record_trace(TraceEntry::SEGMENT_ALLOC, segment->ptr() + old_mapped_size,
+                 grown, p.stream());
+    if (old_mapped_size == 0) {
+      update_stat_array(stats.segment, 1, p.stat_types);
+    }
+    update_stat_array(stats.reserved_bytes, grown, p.stat_types);
+
+    if (extend_tail) {
+      large_blocks.erase(tail);
+      tail->size += grown;
+      if (tail->is_split()) {
+        update_stat_array(stats.inactive_split_bytes, grown, p.stat_types);
+      }
+      p.block = tail;
+    } else {
+      Block* block = new Block(p.device(), p.stream(), grown, p.pool,
+                               segment->ptr() + old_mapped_size);
+      block->segment = segment;
+      block->prev = tail;
+      if (tail) {
+        // The new block is an inactive split of the segment until malloc
+        // hands it out.
+        tail->next = block;
+        update_stat_array(stats.inactive_split, 1, p.stat_types);
+        update_stat_array(stats.inactive_split_bytes, grown, p.stat_types);
+      }
+      segment->tail = block;
+      p.block = block;
+    }
+    return true;
+#else
+    AT_ERROR("expandable segments are not supported by this build");
+#endif
+  }
+
+#ifdef C10_CUDA_EXPANDABLE_SEGMENTS
+  ExpandableSegment* get_expandable_segment(int device, cudaStream_t stream) {
+    for (const auto& segment : expandable_segments) {
+      if (segment->stream == stream) {
+        return segment.get();
+      }
+    }
+    expandable_segments.emplace_back(new ExpandableSegment(device, stream));
+    return expandable_segments.back().get();
+  }
+#endif
+
+  /** unmaps the pages under free blocks at the end of expandable segments **/
+  void release_expandable_segments() {
+#ifdef C10_CUDA_EXPANDABLE_SEGMENTS
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(StatType::LARGE_POOL)] = true;
+
+    for (const auto& segment : expandable_segments) {
+      Block* tail = segment->tail;
+      if (!tail || tail->allocated || tail->event_count > 0) {
+        continue;
+      }
+      // Pages overlapping the preceding (in use) blocks must stay mapped.
+      const size_t offset = static_cast<char*>(tail->ptr) - segment->ptr();
+      const size_t kept_size = segment->round_up(offset);
+      const size_t released = segment->mapped_size() - kept_size;
+      if (released == 0) {
+        continue;
+      }
+
+      large_blocks.erase(tail);
+      segment->unmap_pages(kept_size / segment->granularity);
+      record_trace(TraceEntry::SEGMENT_FREE, segment->ptr() + kept_size,
+                   released, segment->stream);
+      update_stat_array(stats.reserved_bytes, -released, stat_types);
+
+      if (kept_size == offset) {
+        if (tail->prev) {
+          tail->prev->next = nullptr;
+          update_stat_array(stats.inactive_split, -1, stat_types);
+          update_stat_array(stats.inactive_split_bytes, -tail->size, stat_types);
+        }
+        segment->tail = tail->prev;
+        delete tail;
+        if (segment->mapped_size() == 0) {
+          update_stat_array(stats.segment, -1, stat_types);
+        }
+      } else {
+        // offset is not page aligned, so the tail has a predecessor and is
+        // still an inactive split block.
+        tail->size -= released;
+        update_stat_array(stats.inactive_split_bytes, -released, stat_types);
+        large_blocks.insert(tail);
+      }
+    }
+#endif
+  }
+
   bool free_cached_blocks()
   {
     // First ensure that all blocks that can't currently be allocated due to
     // outstanding events are returned to the pool.
+    insert_deferred_events();
     synchronize_and_free_events();
 
     // Free all non-split cached blocks
     free_blocks(large_blocks);
     free_blocks(small_blocks);
+    release_expandable_segments();
+
+    // Free the blocks of the private pools no graph uses anymore, and the
+    // pools themselves once all of their memory is returned.
+    for (auto it = graph_pools.begin(); it != graph_pools.end();) {
+      PrivatePool& private_pool = *it->second;
+      if (private_pool.use_count > 0) {
+        ++it;
+        continue;
+      }
+      free_blocks(private_pool.large_blocks);
+      free_blocks(private_pool.small_blocks);
+      if (private_pool.cudaMalloc_count == 0) {
+        it = graph_pools.erase(it);
+      } else {
+        ++it;
+      }
+    }
     return true;
   }
 
   void free_blocks(BlockPool& blocks)
   {
-    // Frees all non-split blocks
+    // Frees all non-split blocks. Blocks of expandable segments are released
+    // by release_expandable_segments instead.
     auto it = blocks.begin();
     while (it != blocks.end()) {
       Block* block = *it;
-      if (!block->prev && !block->next) {
+      if (!block->prev && !block->next && !block->segment) {
         C10_CUDA_CHECK(cudaFree((void*)block->ptr));
+        record_trace(TraceEntry::SEGMENT_FREE, block->ptr, block->size, block->stream);
+        if (block->pool->owner_PrivatePool) {
+          block->pool->owner_PrivatePool->cudaMalloc_count--;
+        }
 
         StatTypes stat_types;
         stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
@@ -731,6 +1619,14 @@ class DeviceCachingAllocator {
     C10_CUDA_CHECK(cudaSetDevice(prev_device));
   }
 
+  void insert_deferred_events()
+  {
+    for (Block* block : needs_events_deferred_until_no_capture) {
+      insert_events(block);
+    }
+    needs_events_deferred_until_no_capture.clear();
+  }
+
   void process_events()
   {
     // Process outstanding cudaEvents. Events that are completed are removed
@@ -779,17 +1675,28 @@ class THCCachingAllocator {
 
  private:
 
-  std::mutex mutex;
-
-  // allocated blocks by device pointer
-  std::unordered_map<void*, Block*> allocated_blocks;
+  // allocated blocks by device pointer, sharded by address so that threads
+  // allocating concurrently rarely contend on the same mutex
+  struct AllocatedBlocksShard {
+    std::mutex mutex;
+    std::unordered_map<void*, Block*> blocks;
+  };
+  static constexpr size_t kNumAllocatedBlocksShards = 16;
+  std::array<AllocatedBlocksShard, kNumAllocatedBlocksShards> allocated_blocks;
 
   // lock around calls to cudaFree (to prevent deadlocks with NCCL)
   mutable std::mutex cuda_free_mutex;
 
+  AllocatedBlocksShard& get_shard(void* ptr) {
+    // block pointers are at least kMinBlockSize aligned
+    const uintptr_t key = reinterpret_cast<uintptr_t>(ptr) / kMinBlockSize;
+    return allocated_blocks[key % kNumAllocatedBlocksShards];
+  }
+
   void add_allocated_block(Block* block) {
-    std::lock_guard<std::mutex> lock(mutex);
-    allocated_blocks[block->ptr] = block;
+    auto& shard = get_shard(block->ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.blocks[block->ptr] = block;
   }
 
  public:
@@ -801,14 +1708,15 @@ class THCCachingAllocator {
   }
 
   Block* get_allocated_block(void *ptr, bool remove=false) {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto it = allocated_blocks.find(ptr);
-    if (it == allocated_blocks.end()) {
+    auto& shard = get_shard(ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.blocks.find(ptr);
+    if (it == shard.blocks.end()) {
       return nullptr;
     }
     Block* block = it->second;
     if (remove) {
-      allocated_blocks.erase(it);
+      shard.blocks.erase(it);
     }
     return block;
   }
@@ -830,7 +1738,20 @@ class THCCachingAllocator {
         "Allocator not initialized for device ",
         device,
         ": did you call init?");
-    Block* block = device_allocator[device]->malloc(device, size, stream);
+    Block* block = nullptr;
+    // Thread caches only hold blocks of the device's pools, which must not be
+    // handed out to a capture.
+    if (size <= kSmallSize && CachingAllocatorConfig::thread_cache_size() > 0 &&
+        !device_allocator[device]->capturesUnderway()) {
+      block = local_block_cache().pop(
+          device, stream, DeviceCachingAllocator::round_size(size));
+      if (block) {
+        device_allocator[device]->recordThreadCacheAlloc(block);
+      }
+    }
+    if (!block) {
+      block = device_allocator[device]->malloc(device, size, stream);
+    }
     add_allocated_block(block);
     *devPtr = (void*)block->ptr;
   }
@@ -843,15 +1764,54 @@ class THCCachingAllocator {
     if (!block) {
       AT_ERROR("invalid device pointer: ", ptr);
     }
-    device_allocator[block->device]->free(block);
+    auto& allocator = *device_allocator[block->device];
+    if (CachingAllocatorConfig::thread_cache_size() > 0 &&
+        allocator.isThreadCacheable(block)) {
+      // Once pushed, the block may be drained and merged by another thread,
+      // so read its size first.
+      const size_t size = block->size;
+      if (local_block_cache().push(block)) {
+        allocator.recordThreadCacheFree(block, size);
+        return;
+      }
+    }
+    allocator.free(block);
+  }
+
+  /** moves all blocks held by thread-local caches back into the pools **/
+  void flushThreadCaches() {
+    if (CachingAllocatorConfig::thread_cache_size() == 0) {
+      return;
+    }
+    std::vector<Block*> blocks;
+    drain_thread_caches(-1, blocks);
+    returnThreadCachedBlocks(blocks);
+  }
+
+  void returnThreadCachedBlocks(const std::vector<Block*>& blocks) {
+    std::vector<std::vector<Block*>> per_device(device_allocator.size());
+    for (Block* block : blocks) {
+      per_device[block->device].push_back(block);
+    }
+    for (size_t i = 0; i < per_device.size(); i++) {
+      if (!per_device[i].empty()) {
+        device_allocator[i]->returnThreadCachedBlocks(per_device[i]);
+      }
+    }
   }
 
   void emptyCache() {
+    flushThreadCaches();
     int count = device_allocator.size();
     for (int i = 0; i < count; i++)
       device_allocator[i]->emptyCache();
   }
 
+  void cacheInfo(int dev_id, size_t* cachedAndFree, size_t* largestBlock) {
+    flushThreadCaches();
+    device_allocator[dev_id]->cacheInfo(cachedAndFree, largestBlock);
+  }
+
   void* getBaseAllocation(void* ptr, size_t* outSize)
   {
     Block* block = get_allocated_block(ptr);
@@ -883,6 +1843,7 @@ class THCCachingAllocator {
   }
 
   std::vector<SegmentInfo> snapshot() {
+    flushThreadCaches();
     std::vector<SegmentInfo> result;
     int count = device_allocator.size();
     for (int i = 0; i < count; i++) {
@@ -896,6 +1857,25 @@ class THCCachingAllocator {
 
 THCCachingAllocator caching_allocator;
 
+namespace {
+
+void return_thread_cached_blocks(const std::vector<Block*>& blocks) {
+  caching_allocator.returnThreadCachedBlocks(blocks);
+}
+
+} // namespace
+
+ThreadBlockCache::~ThreadBlockCache() {
+  std::vector<Block*> blocks;
+  {
+    std::lock_guard<std::mutex> lock(thread_caches_mutex());
+    auto& caches = thread_caches();
+    caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+    drain(-1, blocks);
+  }
+  return_thread_cached_blocks(blocks);
+}
+
 // NB: I decided not to fold this into THCCachingAllocator, because the latter
 // has a lot more methods and it wasn't altogether clear that they should
 // actually be publicly exposed
@@ -930,7 +1910,7 @@ void emptyCache(void) {
 }
 
 void cacheInfo(int dev_id, size_t* cachedAndFree, size_t* largestBlock) {
-  caching_allocator.device_allocator[dev_id]->cacheInfo(cachedAndFree, largestBlock);
+  caching_allocator.cacheInfo(dev_id, cachedAndFree, largestBlock);
 }
 
 void* getBaseAllocation(void *ptr, size_t *size)
@@ -948,11 +1928,31 @@ std::mutex* getFreeMutex()
   return caching_allocator.getCudaFreeMutex();
 }
 
+size_t pinnedMaxCachedSize()
+{
+  return CachingAllocatorConfig::pinned_max_cached_size();
+}
+
 static inline void assertValidDevice(int device) {
   int device_num = device_count();
   AT_ASSERTM(0 <= device && device < device_num, "Invalid device argument.");
 }
 
+void notifyCaptureBegin(int device, cudaStream_t stream, MempoolId_t mempool_id) {
+  assertValidDevice(device);
+  caching_allocator.device_allocator[device]->notifyCaptureBegin(stream, mempool_id);
+}
+
+void notifyCaptureEnd(int device, cudaStream_t stream) {
+  assertValidDevice(device);
+  caching_allocator.device_allocator[device]->notifyCaptureEnd(stream);
+}
+
+void notifyCaptureDestroy(int device, MempoolId_t mempool_id) {
+  assertValidDevice(device);
+  caching_allocator.device_allocator[device]->notifyCaptureDestroy(mempool_id);
+}
+
 DeviceStats getDeviceStats(int device) {
   assertValidDevice(device);
   return caching_allocator.device_allocator[device]->getStats();
@@ -972,6 +1972,69 @@ std::vector<SegmentInfo> snapshot() {
   return caching_allocator.snapshot();
 }
 
+std::vector<TraceEntry> allocationTrace(int device) {
+  assertValidDevice(device);
+  return caching_allocator.device_allocator[device]->allocationTrace();
+}
+
+namespace {
+
+// Writes the allocation trace and a snapshot of the failing device to the
+// trace_oom_file, so that fragmentation can be told apart from genuine
+// peak usage after the fact.
+class TraceDumpOnOutOfMemory : public OutOfMemoryCallback {
+ public:
+  void Execute(int device, size_t alloc_size) override {
+    const std::string& path = CachingAllocatorConfig::trace_oom_file();
+    if (path.empty() || CachingAllocatorConfig::trace_entries() == 0) {
+      return;
+    }
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+      return;
+    }
+    const auto indent = [&out](const std::string& text) {
+      std::istringstream lines(text);
+      std::string line;
+      while (std::getline(lines, line)) {
+        out << "      " << line << "\n";
+      }
+    };
+
+    out << "CUDA out of memory: tried to allocate " << format_size(alloc_size)
+        << " on device " << device << "\n";
+    out << "segments:\n";
+    // Only the failing device is inspected: its mutex is already held by
+    // this thread, and taking another device's mutex could deadlock.
+    for (const SegmentInfo& segment :
+         caching_allocator.device_allocator[device]->snapshot()) {
+      out << "  segment 0x" << std::hex << segment.address << std::dec
+          << " (" << (segment.is_large ? "large" : "small") << "): "
+          << format_size(segment.total_size) << " total, "
+          << format_size(segment.allocated_size) << " allocated, "
+          << format_size(segment.active_size) << " active\n";
+      for (const BlockInfo& block : segment.blocks) {
+        out << "    block " << format_size(block.size)
+            << (block.allocated ? " allocated" : (block.active ? " pending free" : " free"))
+            << "\n";
+        indent(block.backtrace);
+      }
+    }
+    out << "trace (oldest first):\n";
+    for (const TraceEntry& entry : allocationTrace(device)) {
+      out << "  " << trace_action_name(entry.action) << " 0x" << std::hex
+          << entry.address << " stream 0x" << entry.stream << std::dec << " "
+          << format_size(entry.size) << "\n";
+      indent(entry.backtrace);
+    }
+    out << "\n";
+  }
+};
+
+} // namespace
+
+REGISTER_OUT_OF_MEMORY_CALLBACK(TraceDumpOnOutOfMemory, TraceDumpOnOutOfMemory);
+
 //
 // In CUDA IPC, sender sends a tensor to receiver, getIpcDevPtr
 // is called by the receiving process to map the CUDA memory from the sending
@@ -27,6 +27,20 @@ C10_DECLARE_REGISTRY(FreeCudaMemoryCallbacksRegistry, FreeMemoryCallback);
 #define REGISTER_FREE_MEMORY_CALLBACK(name, ...) \
   C10_REGISTER_CLASS(FreeCudaMemoryCallbacksRegistry, name, __VA_ARGS__);
 
+// Caching allocator will execute every registered callback once an allocation
+// has definitively failed, right before CUDAOutOfMemoryError is thrown. The
+// callbacks run on the allocating thread; they may inspect the allocator
+// (getDeviceStats, snapshot, allocationTrace) but must not allocate from it.
+class C10_CUDA_API OutOfMemoryCallback {
+ public:
+  virtual ~OutOfMemoryCallback() {};
+  virtual void Execute(int device, size_t alloc_size) = 0;
+};
+
+C10_DECLARE_REGISTRY(CudaOutOfMemoryCallbacksRegistry, OutOfMemoryCallback);
+#define REGISTER_OUT_OF_MEMORY_CALLBACK(name, ...) \
+  C10_REGISTER_CLASS(CudaOutOfMemoryCallbacksRegistry, name, __VA_ARGS__);
+
 namespace cuda {
 
 // TODO: Turn this into an honest to goodness class. I briefly attempted to do
@@ -92,19 +106,42 @@ struct BlockInfo {
   int64_t size = 0;
   bool allocated = false;
   bool active = false;
+  // allocation site of an allocated block; only recorded when tracing
+  std::string backtrace;
 };
 
-// Struct containing info of a memory segment (i.e. one contiguous cudaMalloc).
+// Struct containing info of a memory segment (i.e. one contiguous cudaMalloc,
+// or the mapped part of an expandable segment).
 struct SegmentInfo {
   int64_t device = 0;
   int64_t address = 0;
   int64_t total_size = 0;
   int64_t allocated_size = 0;
   int64_t active_size = 0;
+  int64_t stream = 0;
   bool is_large = false;
+  bool is_expandable = false;
   std::vector<BlockInfo> blocks;
 };
 
+// Struct containing an event recorded by the allocation trace ring buffer,
+// enabled with PYTORCH_CUDA_ALLOC_CONF=trace_entries:<N>.
+struct TraceEntry {
+  enum Action {
+    ALLOC,          // block handed out to client code
+    FREE,           // block returned by client code
+    SEGMENT_ALLOC,  // memory obtained from cudaMalloc (or mapped)
+    SEGMENT_FREE,   // memory returned to cudaFree (or unmapped)
+    OOM             // allocation failed; size is the requested segment size
+  };
+  Action action = ALLOC;
+  int64_t address = 0;
+  int64_t size = 0;
+  int64_t stream = 0;
+  // truncated backtrace of the event; empty if trace_frames is 0
+  std::string backtrace;
+};
+
 C10_CUDA_API void* raw_alloc(size_t nbytes);
 C10_CUDA_API void* raw_alloc_with_stream(size_t nbytes, cudaStream_t stream);
 C10_CUDA_API void raw_delete(void* ptr);
@@ -119,9 +156,30 @@ C10_CUDA_API DeviceStats getDeviceStats(int device);
 C10_CUDA_API void resetAccumulatedStats(int device);
 C10_CUDA_API void resetPeakStats(int device);
 C10_CUDA_API std::vector<SegmentInfo> snapshot();
+// Returns the traced events of a device, oldest first.
+C10_CUDA_API std::vector<TraceEntry> allocationTrace(int device);
 
 C10_CUDA_API std::mutex* getFreeMutex();
 
+// The pinned_max_cached_mb option of PYTORCH_CUDA_ALLOC_CONF, in bytes, which
+// bounds the pinned memory kept by THCCachingHostAllocator. 0 if unset.
+C10_CUDA_API size_t pinnedMaxCachedSize();
+
+// Id of a private memory pool of CUDA graphs. 0 is not a valid id.
+using MempoolId_t = uint64_t;
+
+// CUDA graphs replay the kernels of a capture with the addresses they had
+// during the capture, so the memory allocated on the capturing stream comes
+// from a private pool, which keeps it for the graphs sharing the pool until
+// the last of them is destroyed, even when it is freed during the capture.
+// notifyCaptureBegin creates the pool mempool_id, or adds a graph to it if it
+// exists already.
+C10_CUDA_API void notifyCaptureBegin(int device, cudaStream_t stream, MempoolId_t mempool_id);
+C10_CUDA_API void notifyCaptureEnd(int device, cudaStream_t stream);
+// Releases a graph's use of its pool. The memory of the pool goes back to
+// the device once no graph uses it and all of its blocks are free.
+C10_CUDA_API void notifyCaptureDestroy(int device, MempoolId_t mempool_id);
+
 C10_CUDA_API std::shared_ptr<void> getIpcDevPtr(std::string handle);
 } // namespace CUDACachingAllocator
 
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace c10;
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocks) {
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  const auto before = CPUCachingAllocator::getStats();
+
+  void* first;
+  {
+    auto ptr = allocator->allocate(1000);
+    first = ptr.get();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0);
+    memset(first, 1, 1000);
+  }
+  // 1000 bytes and 1010 bytes share a size class
+  auto ptr = allocator->allocate(1010);
+  EXPECT_EQ(ptr.get(), first);
+
+  const auto stats = CPUCachingAllocator::getStats();
+  EXPECT_EQ(stats.num_cache_hits - before.num_cache_hits, 1);
+  EXPECT_EQ(stats.num_cache_misses - before.num_cache_misses, 1);
+  EXPECT_EQ(stats.allocation.current - before.allocation.current, 1);
+  EXPECT_EQ(stats.allocated_bytes.current - before.allocated_bytes.current, 1024);
+  EXPECT_EQ(stats.cached_bytes.current, before.cached_bytes.current);
+}
+
+TEST(CPUCachingAllocatorTest, EmptyCacheReleasesBlocks) {
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  const auto before = CPUCachingAllocator::getStats();
+  EXPECT_EQ(before.cached_bytes.current, 0);
+
+  {
+    std::vector<DataPtr> ptrs;
+    for (size_t i = 1; i < 100; i++) {
+      ptrs.push_back(allocator->allocate(i * 100));
+    }
+  }
+  auto stats = CPUCachingAllocator::getStats();
+  EXPECT_GT(stats.cached_bytes.current, 0);
+  EXPECT_EQ(stats.allocation.current, before.allocation.current);
+  EXPECT_EQ(stats.allocated_bytes.current, before.allocated_bytes.current);
+
+  CPUCachingAllocator::emptyCache();
+  stats = CPUCachingAllocator::getStats();
+  EXPECT_EQ(stats.cached_bytes.current, 0);
+  EXPECT_EQ(stats.reserved_bytes.current, before.reserved_bytes.current);
+}
+
+TEST(CPUCachingAllocatorTest, LargeAllocationsBypassCache) {
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  const auto before = CPUCachingAllocator::getStats();
+  {
+    auto ptr = allocator->allocate(64 * 1024 * 1024);
+    ASSERT_NE(ptr.get(), nullptr);
+  }
+  const auto stats = CPUCachingAllocator::getStats();
+  EXPECT_EQ(stats.num_cache_misses, before.num_cache_misses);
+  EXPECT_EQ(stats.cached_bytes.current, 0);
+  EXPECT_EQ(stats.reserved_bytes.current, before.reserved_bytes.current);
+}
+
+TEST(CPUCachingAllocatorTest, ThreadExitReleasesCache) {
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  const auto before = CPUCachingAllocator::getStats();
+  std::thread t([&]() {
+    for (int i = 0; i < 10; i++) {
+      auto ptr = allocator->allocate(4096);
+    }
+  });
+  t.join();
+  const auto stats = CPUCachingAllocator::getStats();
+  EXPECT_EQ(stats.cached_bytes.current, 0);
+  EXPECT_EQ(stats.reserved_bytes.current, before.reserved_bytes.current);
+  EXPECT_EQ(stats.num_cache_hits - before.num_cache_hits, 9);
+}
+
+namespace {
+
+// Frees its block from a thread_local destructor, which runs after the
+// thread's cache was destroyed if the holder was constructed first.
+struct ThreadExitHolder {
+  DataPtr ptr;
+};
+
+} // namespace
+
+TEST(CPUCachingAllocatorTest, FreeAfterThreadCacheDestroyed) {
+  at::Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  const auto before = CPUCachingAllocator::getStats();
+  std::thread t([&]() {
+    static thread_local ThreadExitHolder holder;
+    // constructs the thread cache after the holder
+    auto warmup = allocator->allocate(4096);
+    holder.ptr = allocator->allocate(4096);
+  });
+  t.join();
+  const auto stats = CPUCachingAllocator::getStats();
+  EXPECT_EQ(stats.allocation.current, before.allocation.current);
+  EXPECT_EQ(stats.cached_bytes.current, 0);
+  EXPECT_EQ(stats.reserved_bytes.current, before.reserved_bytes.current);
+}
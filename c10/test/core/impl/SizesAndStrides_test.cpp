@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/impl/SizesAndStrides.h>
+
+using namespace c10;
+using namespace c10::impl;
+
+static void checkData(
+    const SizesAndStrides& sz,
+    IntArrayRef sizes,
+    IntArrayRef strides) {
+  ASSERT_EQ(sizes.size(), strides.size());
+  ASSERT_EQ(sz.size(), sizes.size());
+  ASSERT_EQ(sz.sizes_arrayref(), sizes);
+  ASSERT_EQ(sz.strides_arrayref(), strides);
+  for (size_t i = 0; i < sizes.size(); i++) {
+    EXPECT_EQ(sz.size_at(i), sizes[i]);
+    EXPECT_EQ(sz.stride_at(i), strides[i]);
+  }
+}
+
+TEST(SizesAndStridesTest, DefaultConstructor) {
+  SizesAndStrides sz;
+  checkData(sz, {0}, {1});
+}
+
+TEST(SizesAndStridesTest, SetSizes) {
+  SizesAndStrides sz;
+  sz.set_sizes({5, 6, 7, 8});
+  ASSERT_EQ(sz.sizes_arrayref(), IntArrayRef({5, 6, 7, 8}));
+  // The stride of the first dimension is kept, the new ones are zero.
+  ASSERT_EQ(sz.strides_arrayref(), IntArrayRef({1, 0, 0, 0}));
+}
+
+TEST(SizesAndStridesTest, Resize) {
+  SizesAndStrides sz;
+  sz.resize(2);
+  sz.size_at(1) = 2;
+  sz.stride_at(1) = 3;
+  checkData(sz, {0, 2}, {1, 3});
+
+  // Inline to out-of-line.
+  sz.resize(7);
+  for (size_t i = 0; i < 7; i++) {
+    sz.size_at(i) = i + 1;
+    sz.stride_at(i) = 2 * (i + 1);
+  }
+  checkData(sz, {1, 2, 3, 4, 5, 6, 7}, {2, 4, 6, 8, 10, 12, 14});
+
+  // Out-of-line, growing then shrinking.
+  sz.resize(8);
+  checkData(sz, {1, 2, 3, 4, 5, 6, 7, 0}, {2, 4, 6, 8, 10, 12, 14, 0});
+  sz.resize(6);
+  checkData(sz, {1, 2, 3, 4, 5, 6}, {2, 4, 6, 8, 10, 12});
+
+  // Out-of-line to inline.
+  sz.resize(3);
+  checkData(sz, {1, 2, 3}, {2, 4, 6});
+  sz.resize(0);
+  checkData(sz, {}, {});
+}
+
+TEST(SizesAndStridesTest, CopyAndMove) {
+  for (size_t dim : {2, 7}) {
+    SizesAndStrides sz;
+    sz.resize(dim);
+    for (size_t i = 0; i < dim; i++) {
+      sz.size_at(i) = i;
+      sz.stride_at(i) = 10 + i;
+    }
+
+    SizesAndStrides copy(sz);
+    checkData(copy, sz.sizes_arrayref(), sz.strides_arrayref());
+    SizesAndStrides assigned;
+    assigned.resize(9);
+    assigned = sz;
+    checkData(assigned, sz.sizes_arrayref(), sz.strides_arrayref());
+
+    SizesAndStrides moved(std::move(copy));
+    checkData(moved, sz.sizes_arrayref(), sz.strides_arrayref());
+    EXPECT_EQ(copy.size(), 0);
+    SizesAndStrides move_assigned;
+    move_assigned = std::move(assigned);
+    checkData(move_assigned, sz.sizes_arrayref(), sz.strides_arrayref());
+    EXPECT_EQ(assigned.size(), 0);
+  }
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/thread_pool.h>
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace c10;
+
+TEST(ThreadPoolTest, ParseCpuList) {
+  EXPECT_EQ(parse_cpu_list("0-3,8"), std::vector<int>({0, 1, 2, 3, 8}));
+  EXPECT_EQ(parse_cpu_list("5"), std::vector<int>({5}));
+  EXPECT_EQ(parse_cpu_list("2-2"), std::vector<int>({2}));
+  EXPECT_EQ(parse_cpu_list("1,,4-5,"), std::vector<int>({1, 4, 5}));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+TEST(ThreadPoolTest, ParseCpuListRejectsMalformedInput) {
+  for (const char* list : {"a", "3-1", "1-", "-1", "1x", "1-2-3", "0-b", "-"}) {
+    EXPECT_THROW(parse_cpu_list(list), c10::Error) << list;
+  }
+}
+
+TEST(ThreadPoolTest, SpinningThreadsRunTasks) {
+  ThreadPool pool(2);
+  pool.setSpinDuration(std::chrono::milliseconds(1));
+  std::atomic<int> count{0};
+
+  // picked up while the workers spin after the previous task
+  for (int i = 0; i < 100; i++) {
+    pool.run([&count]() { count++; });
+  }
+  pool.waitWorkComplete();
+  EXPECT_EQ(count, 100);
+
+  // picked up after the workers stopped spinning and blocked
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pool.run([&count]() { count++; });
+  pool.waitWorkComplete();
+  EXPECT_EQ(count, 101);
+}
+
+TEST(ThreadPoolTest, ShutdownWhileSpinning) {
+  const auto start = std::chrono::steady_clock::now();
+  {
+    ThreadPool pool(2);
+    pool.setSpinDuration(std::chrono::seconds(30));
+    std::atomic<int> count{0};
+    pool.run([&count]() { count++; });
+    pool.waitWorkComplete();
+    EXPECT_EQ(count, 1);
+    // the workers now spin for 30s unless the destructor stops them
+  }
+  EXPECT_LT(
+      std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+}
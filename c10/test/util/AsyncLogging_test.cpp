@@ -0,0 +1,113 @@
+#include <c10/util/AsyncLogging.h>
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct CapturedRecord {
+  int severity;
+  std::string event;
+  std::vector<std::pair<std::string, std::string>> fields;
+};
+
+class AsyncLoggingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    prev_log_level_ = FLAGS_caffe2_log_level;
+    FLAGS_caffe2_log_level = 0;
+    c10::SetAsyncLogSink([this](const c10::AsyncLogRecord& record) {
+      CapturedRecord captured{record.severity, record.event, {}};
+      for (const auto& field : record.fields) {
+        captured.fields.emplace_back(field.first, field.second);
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      records_.push_back(std::move(captured));
+    });
+  }
+
+  void TearDown() override {
+    c10::FlushAsyncLog();
+    c10::SetAsyncLogSink(nullptr);
+    FLAGS_caffe2_log_level = prev_log_level_;
+  }
+
+  std::vector<CapturedRecord> records() {
+    c10::FlushAsyncLog();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+  }
+
+ private:
+  int prev_log_level_;
+  std::mutex mutex_;
+  std::vector<CapturedRecord> records_;
+};
+
+// Counts how many times it is formatted.
+struct CountsFormatting {
+  int* count;
+};
+
+std::ostream& operator<<(std::ostream& out, const CountsFormatting& value) {
+  ++*value.count;
+  return out << "formatted";
+}
+
+} // namespace
+
+TEST_F(AsyncLoggingTest, givenFields_whenLogging_thenSinkGetsThem) {
+  C10_ASYNC_LOG(INFO, "request").field("id", 42).field("peer", "worker1");
+
+  const auto logged = records();
+  ASSERT_EQ(1u, logged.size());
+  EXPECT_EQ(c10::detail::kAsyncLog_INFO, logged[0].severity);
+  EXPECT_EQ("request", logged[0].event);
+  ASSERT_EQ(2u, logged[0].fields.size());
+  EXPECT_EQ("id", logged[0].fields[0].first);
+  EXPECT_EQ("42", logged[0].fields[0].second);
+  EXPECT_EQ("peer", logged[0].fields[1].first);
+  EXPECT_EQ("worker1", logged[0].fields[1].second);
+}
+
+TEST_F(AsyncLoggingTest, givenManyThreads_whenLogging_thenAllRecordsAreWritten) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumRecords = 100;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([] {
+      for (int j = 0; j < kNumRecords; ++j) {
+        C10_ASYNC_LOG(INFO, "record").field("j", j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(static_cast<size_t>(kNumThreads * kNumRecords), records().size());
+}
+
+TEST_F(AsyncLoggingTest, givenDisabledSeverity_whenLogging_thenNothingIsFormatted) {
+  FLAGS_caffe2_log_level = c10::detail::kAsyncLog_ERROR;
+  int count = 0;
+  C10_ASYNC_LOG(WARNING, "ignored").field("value", CountsFormatting{&count});
+
+  EXPECT_EQ(0, count);
+  EXPECT_EQ(0u, records().size());
+}
+
+TEST_F(AsyncLoggingTest, givenRateLimit_whenLoggingRepeatedly_thenOnlyFirstIsFormatted) {
+  int count = 0;
+  for (int i = 0; i < 10; ++i) {
+    C10_ASYNC_LOG_EVERY_MS(INFO, 1000000, "limited")
+        .field("value", CountsFormatting{&count});
+  }
+
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(1u, records().size());
+}
@@ -147,6 +147,46 @@ namespace {
 class MyException : public std::exception {};
 }
 
+TEST(LeftRightTest, givenManyReaderThreads_whenWriting_thenReadersSeeConsistentState) {
+    // More readers than reader counter stripes, so that stripes are shared.
+    constexpr int kNumReaders = 2 * c10::detail::kNumReaderStripes + 1;
+    constexpr int kNumWrites = 1000;
+    LeftRight<vector<int>> obj;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    vector<std::thread> readers;
+    for (int i = 0; i < kNumReaders; ++i) {
+        readers.emplace_back([&] () {
+            size_t last_size = 0;
+            while (!done.load()) {
+                obj.read([&] (const vector<int>& obj) {
+                    for (size_t j = 0; j < obj.size(); ++j) {
+                        if (obj[j] != static_cast<int>(j)) {
+                            consistent = false;
+                        }
+                    }
+                    if (obj.size() < last_size) {
+                        consistent = false;
+                    }
+                    last_size = obj.size();
+                });
+            }
+        });
+    }
+
+    for (int i = 0; i < kNumWrites; ++i) {
+        obj.write([&] (vector<int>& obj) {obj.push_back(i);});
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_TRUE(consistent.load());
+    EXPECT_EQ(static_cast<size_t>(kNumWrites), obj.read([] (const vector<int>& obj) {return obj.size();}));
+}
+
 TEST(LeftRightTest, whenReadThrowsException_thenThrowsThrough) {
     LeftRight<int> obj;
 
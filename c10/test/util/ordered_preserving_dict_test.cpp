@@ -101,6 +101,25 @@ TEST(OrderedPreservingDictTest, testRefType) {
 }
 
 
+TEST(OrderedPreservingDictTest, FindWithOtherKeyType) {
+  ska_ordered::order_preserving_flat_hash_map<std::string, int64_t> dict;
+  for (int64_t i = 0; i < 100; ++i) {
+    dict[std::to_string(i)] = i;
+  }
+  auto hash = [](const char* key) {
+    return std::hash<std::string>()(std::string(key));
+  };
+  auto equal = [](const char* key, const std::pair<std::string, int64_t>& entry) {
+    return entry.first == key;
+  };
+  for (int64_t i = 0; i < 100; ++i) {
+    auto found = dict.find_with(std::to_string(i).c_str(), hash, equal);
+    ASSERT_TRUE(found != dict.end());
+    ASSERT_EQUAL_PRIM(found->second, i);
+  }
+  ASSERT_TRUE(dict.find_with("100", hash, equal) == dict.end());
+}
+
 TEST(OrderedPreservingDictTest, DictCollisions) {
   struct BadHash {
     size_t operator()(const int64_t input) {
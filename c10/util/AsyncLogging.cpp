@@ -0,0 +1,251 @@
+#include <c10/util/AsyncLogging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace c10 {
+
+namespace {
+
+constexpr size_t kRingBufferCapacity = 1024;
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+
+int64_t nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void writeToStderr(const AsyncLogRecord& record) {
+  static const char kSeverityChars[] = {'I', 'W', 'E'};
+  std::ostringstream line;
+  line << "[" << kSeverityChars[record.severity] << record.timestamp_us / 1000000
+       << "." << std::setfill('0') << std::setw(6)
+       << record.timestamp_us % 1000000 << " " << record.file << ":"
+       << record.line << "] " << record.event;
+  for (const auto& field : record.fields) {
+    line << " " << field.first << "=" << field.second;
+  }
+  line << "\n";
+  std::cerr << line.str();
+}
+
+// Single producer (the thread that owns it), single consumer (the flush
+// thread) ring buffer of records.
+class RingBuffer final {
+ public:
+  RingBuffer() : slots_(kRingBufferCapacity), head_(0), tail_(0) {}
+
+  bool push(AsyncLogRecord&& record) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kRingBufferCapacity) {
+      return false;
+    }
+    slots_[head % kRingBufferCapacity] = std::move(record);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename F>
+  void drain(const F& f) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    for (size_t i = tail; i != head; ++i) {
+      auto& slot = slots_[i % kRingBufferCapacity];
+      f(slot);
+      slot.fields.clear();
+    }
+    tail_.store(head, std::memory_order_release);
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+        tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<AsyncLogRecord> slots_;
+  std::atomic<size_t> head_;
+  std::atomic<size_t> tail_;
+};
+
+class AsyncLogger final {
+ public:
+  static AsyncLogger& get() {
+    // Leaked so that threads may still log during static destruction, the
+    // flush thread is stopped by an atexit handler instead.
+    static AsyncLogger* logger = [] {
+      auto* logger = new AsyncLogger();
+      std::atexit([] { get().stop(); });
+      return logger;
+    }();
+    return *logger;
+  }
+
+  std::shared_ptr<RingBuffer> registerBuffer() {
+    auto buffer = std::make_shared<RingBuffer>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(buffer);
+    if (!thread_.joinable() && !stopped_) {
+      thread_ = std::thread([this] { run(); });
+    }
+    return buffer;
+  }
+
+  void setSink(AsyncLogSink sink) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    sink_ = std::move(sink);
+  }
+
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) {
+      lock.unlock();
+      drainAll();
+      return;
+    }
+    const int64_t generation = ++requested_flush_;
+    cv_.notify_all();
+    flushed_cv_.wait(
+        lock, [&] { return stopped_ || completed_flush_ >= generation; });
+  }
+
+  std::atomic<int64_t> dropped{0};
+
+ private:
+  AsyncLogger() = default;
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopped_) {
+      cv_.wait_for(lock, kFlushInterval, [&] {
+        return stopped_ || requested_flush_ > completed_flush_;
+      });
+      const int64_t generation = requested_flush_;
+      lock.unlock();
+      drainAll();
+      lock.lock();
+      completed_flush_ = generation;
+      flushed_cv_.notify_all();
+    }
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    drainAll();
+  }
+
+  // Writes out the records of all the buffers, and forgets the buffers of
+  // threads that exited once they are empty.
+  void drainAll() {
+    std::vector<std::shared_ptr<RingBuffer>> buffers;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers = buffers_;
+    }
+    {
+      std::lock_guard<std::mutex> lock(sink_mutex_);
+      for (const auto& buffer : buffers) {
+        buffer->drain([&](const AsyncLogRecord& record) {
+          if (sink_) {
+            sink_(record);
+          }
+        });
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.erase(
+        std::remove_if(
+            buffers_.begin(),
+            buffers_.end(),
+            [](const std::shared_ptr<RingBuffer>& buffer) {
+              // Only referenced by buffers_ and buffers: its thread exited.
+              return buffer.use_count() <= 2 && buffer->empty();
+            }),
+        buffers_.end());
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable flushed_cv_;
+  std::vector<std::shared_ptr<RingBuffer>> buffers_;
+  std::thread thread_;
+  bool stopped_ = false;
+  int64_t requested_flush_ = 0;
+  int64_t completed_flush_ = 0;
+
+  std::mutex sink_mutex_;
+  AsyncLogSink sink_ = writeToStderr;
+};
+
+RingBuffer& threadBuffer() {
+  thread_local std::shared_ptr<RingBuffer> buffer =
+      AsyncLogger::get().registerBuffer();
+  return *buffer;
+}
+
+} // namespace
+
+void SetAsyncLogSink(AsyncLogSink sink) {
+  AsyncLogger::get().setSink(std::move(sink));
+}
+
+void FlushAsyncLog() {
+  AsyncLogger::get().flush();
+}
+
+int64_t AsyncLogDroppedCount() {
+  return AsyncLogger::get().dropped.load();
+}
+
+namespace detail {
+
+void EnqueueAsyncLogRecord(AsyncLogRecord&& record) {
+  if (!threadBuffer().push(std::move(record))) {
+    AsyncLogger::get().dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool AsyncLogRateLimiter::admit() {
+  const int64_t now = nowMicros();
+  int64_t next = next_us_.load(std::memory_order_relaxed);
+  return now >= next &&
+      next_us_.compare_exchange_strong(
+          next, now + interval_us_, std::memory_order_relaxed);
+}
+
+AsyncLogMessage::AsyncLogMessage(
+    bool active,
+    int severity,
+    const char* file,
+    int line,
+    const char* event)
+    : active_(active), record_{severity, file, line, 0, event, {}} {
+  if (active_) {
+    record_.timestamp_us = nowMicros();
+  }
+}
+
+AsyncLogMessage::~AsyncLogMessage() {
+  if (active_) {
+    EnqueueAsyncLogRecord(std::move(record_));
+  }
+}
+
+} // namespace detail
+} // namespace c10
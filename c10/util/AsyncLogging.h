@@ -0,0 +1,139 @@
+#ifndef C10_UTIL_ASYNC_LOGGING_H_
+#define C10_UTIL_ASYNC_LOGGING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <c10/macros/Macros.h>
+#include <c10/util/Logging.h>
+#include <c10/util/StringUtil.h>
+
+/**
+ * Asynchronous structured logging for hot paths.
+ *
+ * A record is built on the logging thread and pushed to a lock-free ring
+ * buffer owned by that thread. A background thread drains the buffers and
+ * hands the records to the sink, so logging threads never wait for a mutex or
+ * for I/O. When the buffer of a thread is full, its records are dropped and
+ * counted instead of blocking.
+ *
+ * Nothing is formatted unless the record will be emitted: the severity is
+ * checked against caffe2_log_level, and the rate limit of the call site, if
+ * any, first.
+ *
+ * Example:
+ *   C10_ASYNC_LOG(INFO, "request_sent").field("id", id).field("bytes", size);
+ *   // At most one record per second from this call site.
+ *   C10_ASYNC_LOG_EVERY_MS(WARNING, 1000, "slow_request").field("ms", ms);
+ *
+ * Events and field keys must be string literals, or outlive the flush.
+ */
+
+namespace c10 {
+
+struct C10_API AsyncLogRecord {
+  // One of INFO (0), WARNING (1) and ERROR (2).
+  int severity;
+  const char* file;
+  int line;
+  // Microseconds since the epoch.
+  int64_t timestamp_us;
+  const char* event;
+  std::vector<std::pair<const char*, std::string>> fields;
+};
+
+using AsyncLogSink = std::function<void(const AsyncLogRecord&)>;
+
+// Replaces the sink records are written to, which writes one
+// "[I<timestamp> file:line] event key=value ..." line per record to stderr by
+// default. The sink is only called from the flush thread.
+C10_API void SetAsyncLogSink(AsyncLogSink sink);
+
+// Blocks until the records the calling thread logged so far are written.
+C10_API void FlushAsyncLog();
+
+// Number of records dropped because the buffer of their thread was full.
+C10_API int64_t AsyncLogDroppedCount();
+
+namespace detail {
+
+constexpr int kAsyncLog_INFO = 0;
+constexpr int kAsyncLog_WARNING = 1;
+constexpr int kAsyncLog_ERROR = 2;
+
+inline bool AsyncLogSeverityEnabled(int severity) {
+  return severity >= FLAGS_caffe2_log_level;
+}
+
+C10_API void EnqueueAsyncLogRecord(AsyncLogRecord&& record);
+
+// Admits at most one record every `interval_ms` milliseconds.
+class C10_API AsyncLogRateLimiter final {
+ public:
+  explicit AsyncLogRateLimiter(int64_t interval_ms)
+      : interval_us_(interval_ms * 1000), next_us_(0) {}
+
+  bool admit();
+
+ private:
+  const int64_t interval_us_;
+  std::atomic<int64_t> next_us_;
+};
+
+// Collects the fields of a record, enqueued on destruction if it is active.
+class C10_API AsyncLogMessage final {
+ public:
+  AsyncLogMessage(
+      bool active,
+      int severity,
+      const char* file,
+      int line,
+      const char* event);
+  ~AsyncLogMessage();
+
+  template <typename T>
+  AsyncLogMessage& field(const char* key, const T& value) {
+    if (active_) {
+      record_.fields.emplace_back(key, ::c10::str(value));
+    }
+    return *this;
+  }
+
+ private:
+  bool active_;
+  AsyncLogRecord record_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(AsyncLogMessage);
+};
+
+} // namespace detail
+} // namespace c10
+
+#define C10_ASYNC_LOG(severity, event)                                       \
+  ::c10::detail::AsyncLogMessage(                                            \
+      ::c10::detail::AsyncLogSeverityEnabled(                                \
+          ::c10::detail::kAsyncLog_##severity),                              \
+      ::c10::detail::kAsyncLog_##severity,                                   \
+      __FILE__,                                                              \
+      __LINE__,                                                              \
+      event)
+
+// The lambda gives every call site its own rate limiter.
+#define C10_ASYNC_LOG_EVERY_MS(severity, ms, event)                          \
+  ::c10::detail::AsyncLogMessage(                                            \
+      ::c10::detail::AsyncLogSeverityEnabled(                                \
+          ::c10::detail::kAsyncLog_##severity) &&                            \
+          []() -> ::c10::detail::AsyncLogRateLimiter& {                      \
+            static ::c10::detail::AsyncLogRateLimiter limiter(ms);           \
+            return limiter;                                                  \
+          }().admit(),                                                       \
+      ::c10::detail::kAsyncLog_##severity,                                   \
+      __FILE__,                                                              \
+      __LINE__,                                                              \
+      event)
+
+#endif // C10_UTIL_ASYNC_LOGGING_H_
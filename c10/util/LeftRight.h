@@ -9,6 +9,27 @@ namespace c10 {
 
 namespace detail {
 
+// Readers increment one of kNumReaderStripes counters, chosen per thread, so
+// that readers on different threads don't keep bouncing the cache line of a
+// single shared counter. Writers wait for all the stripes.
+constexpr size_t kNumReaderStripes = 32;
+constexpr size_t kCacheLineSize = 64;
+
+struct ReaderCounter final {
+    std::atomic<int32_t> value{0};
+    // Keeps neighbouring counters out of this one's cache line.
+    char padding[kCacheLineSize - sizeof(std::atomic<int32_t>)];
+};
+
+using ReaderCounters = std::array<ReaderCounter, kNumReaderStripes>;
+
+// Stripe of the calling thread, assigned round robin on its first read.
+inline size_t readerStripe() {
+    static std::atomic<size_t> nextStripe{0};
+    thread_local size_t stripe = nextStripe.fetch_add(1) % kNumReaderStripes;
+    return stripe;
+}
+
 struct IncrementRAII final {
 public:
     explicit IncrementRAII(std::atomic<int32_t> *counter): _counter(counter) {
@@ -33,7 +54,7 @@ class LeftRight final {
 public:
     template<class... Args>
     explicit LeftRight(const Args& ...args)
-    : _counters{{{0}, {0}}}
+    : _counters()
     , _foregroundCounterIndex(0)
     , _foregroundDataIndex(0)
     , _data{{T{args...}, T{args...}}}
@@ -54,14 +75,14 @@ public:
         }
 
         // wait until any potentially running readers are finished
-        while (_counters[0].load() != 0 || _counters[1].load() != 0) {
-            std::this_thread::yield();
-        }
+        _waitForCountersToBeZero(_counters[0]);
+        _waitForCountersToBeZero(_counters[1]);
     }
 
     template <typename F>
     auto read(F&& readFunc) const -> typename std::result_of<F(const T&)>::type {
-        detail::IncrementRAII _increment_counter(&_counters[_foregroundCounterIndex.load()]);
+        detail::IncrementRAII _increment_counter(
+            &_counters[_foregroundCounterIndex.load()][detail::readerStripe()].value);
 
         return readFunc(_data[_foregroundDataIndex.load()]);
     }
@@ -149,12 +170,20 @@ private:
     }
 
     void _waitForBackgroundCounterToBeZero(uint8_t counterIndex) {
-        while (_counters[counterIndex ^ 1].load() != 0) {
-            std::this_thread::yield();
+        _waitForCountersToBeZero(_counters[counterIndex ^ 1]);
+    }
+
+    // Each stripe only needs to be seen at zero once: readers that increment
+    // it later started after the caller's switch, and read the new state.
+    static void _waitForCountersToBeZero(const detail::ReaderCounters& counters) {
+        for (const auto& counter : counters) {
+            while (counter.value.load() != 0) {
+                std::this_thread::yield();
+            }
         }
     }
 
-    mutable std::array<std::atomic<int32_t>, 2> _counters;
+    mutable std::array<detail::ReaderCounters, 2> _counters;
     std::atomic<uint8_t> _foregroundCounterIndex;
     std::atomic<uint8_t> _foregroundDataIndex;
     std::array<T, 2> _data;
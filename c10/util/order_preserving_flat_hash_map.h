@@ -564,6 +564,27 @@ public:
     {
         return find(key) == end() ? 0 : 1;
     }
+    // Looks up a key of another type than FindKey, like a string_view in a
+    // table of strings, without converting it. hash(key) must be the hash of
+    // the matching FindKey, and equal(key, value) compares key with the key of
+    // a stored value.
+    template<typename LookupKey, typename LookupHash, typename LookupEqual>
+    iterator find_with(const LookupKey & key, const LookupHash & hash, const LookupEqual & equal)
+    {
+        uint64_t index = hash_policy.index_for_hash(hash(key), num_slots_minus_one);
+        EntryPointer it = entries + ptrdiff_t(index);
+        for (int8_t distance = 0; it->distance_from_desired >= distance; ++distance, ++it)
+        {
+            if (equal(key, it->value))
+                return { it };
+        }
+        return end();
+    }
+    template<typename LookupKey, typename LookupHash, typename LookupEqual>
+    const_iterator find_with(const LookupKey & key, const LookupHash & hash, const LookupEqual & equal) const
+    {
+        return const_cast<sherwood_v3_table *>(this)->find_with(key, hash, equal);
+    }
     std::pair<iterator, iterator> equal_range(const FindKey & key)
     {
         iterator found = find(key);
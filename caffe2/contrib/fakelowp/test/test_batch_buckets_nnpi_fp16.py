@@ -0,0 +1,88 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import numpy as np
+
+import caffe2.python.fakelowp.init_shared_libs  # noqa
+from hypothesis import given, settings
+from hypothesis import strategies as st
+from caffe2.proto import caffe2_pb2
+from caffe2.python import core
+from caffe2.python import workspace
+from caffe2.python.onnx.onnxifi import onnxifi_caffe2_net
+from caffe2.python.fakelowp.test_utils import print_test_debug_info
+import caffe2.python.serialized_test.serialized_test_util as serial
+
+core.GlobalInit(["caffe2", "--caffe2_log_level=-3", "--glow_global_fp16=1"])
+
+
+class BatchBucketsTest(serial.SerializedTestCase):
+    @given(seed=st.integers(0, 65534))
+    @settings(max_examples=10)
+    def test_fc_batch_buckets(self, seed):
+        """ Batches run on the graph of their bucket, with padded inputs,
+            must give the same rows as on the graph at max_batch_size
+        """
+        np.random.seed(seed)
+        max_batch_size, k, n = 16, 12, 10
+        batch_buckets = [4, 8]
+        dtype = np.float32
+
+        def make_net(name):
+            net = caffe2_pb2.NetDef()
+            net.name = name
+            net.external_input.extend(["X", "W0", "b0"])
+            net.external_output.append("Y")
+            net.op.add().CopyFrom(
+                core.CreateOperator(
+                    "FC",
+                    ["X", "W0", "b0"],
+                    ["Y"],
+                )
+            )
+            return net
+
+        workspace.SwitchWorkspace("glow_test_ws", True)
+        workspace.ResetWorkspace()
+        W0 = np.random.uniform(-1, 1, size=(n, k)).astype(dtype)
+        b0 = np.random.uniform(-1, 1, size=(n)).astype(dtype)
+        workspace.FeedBlob("W0", W0)
+        workspace.FeedBlob("b0", b0)
+        workspace.FeedBlob("X", np.zeros((max_batch_size, k), dtype))
+
+        nets = {}
+        for buckets in [None, batch_buckets]:
+            net = onnxifi_caffe2_net(
+                make_net("pred_buckets" if buckets else "pred"),
+                {"X": (max_batch_size, k)},
+                max_batch_size=max_batch_size,
+                debug=True,
+                adjust_batch=True,
+                use_onnx=False,
+                batch_buckets=buckets)
+            onnxifi_ops = [o for o in net.op if o.type == "Onnxifi"]
+            np.testing.assert_equal(len(onnxifi_ops), 1)
+            has_buckets = any(
+                arg.name == "batch_buckets" for arg in onnxifi_ops[0].arg)
+            np.testing.assert_equal(has_buckets, buckets is not None)
+            workspace.CreateNet(net)
+            nets[net.name] = net
+
+        # Every bucket, the batch sizes between and on their boundaries, and
+        # batches that only fit at max_batch_size
+        for batch_size in [1, 3, 4, 5, 8, 9, 15, 16]:
+            X = np.random.uniform(-1, 1, size=(batch_size, k)).astype(dtype)
+            workspace.FeedBlob("X", X)
+            workspace.RunNet(nets["pred"].name)
+            Y_max = workspace.FetchBlob("Y")
+            workspace.RunNet(nets["pred_buckets"].name)
+            Y_bucket = workspace.FetchBlob("Y")
+
+            np.testing.assert_equal(Y_bucket.shape, (batch_size, n))
+            if not np.array_equal(Y_max, Y_bucket):
+                print_test_debug_info("fc_batch_buckets", {
+                    "seed": seed, "batch_size": batch_size, "X": X,
+                    "Y_max": Y_max, "Y_bucket": Y_bucket})
+                assert(0)
@@ -171,6 +171,127 @@ class MiniDB : public DB {
 REGISTER_CAFFE2_DB(MiniDB, MiniDB);
 REGISTER_CAFFE2_DB(minidb, MiniDB);
 
+ParallelDBReader::ParallelDBReader(
+    const string& db_type,
+    const string& source,
+    int num_threads,
+    int readahead)
+    : readahead_(readahead) {
+  CAFFE_ENFORCE_GE(num_threads, 1);
+  CAFFE_ENFORCE_GE(readahead, 1);
+  db_ = CreateDB(db_type, source, READ);
+  CAFFE_ENFORCE(
+      db_,
+      "Cannot find db implementation of type ",
+      db_type,
+      " (while trying to open ",
+      source,
+      ")");
+  // All cursors are created before any thread starts, as dbs don't promise
+  // that NewCursor() is thread safe.
+  for (int i = 0; i < num_threads; ++i) {
+    shards_.push_back(make_unique<Shard>());
+    shards_.back()->cursor = db_->NewCursor();
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    shards_[i]->thread =
+        std::thread(&ParallelDBReader::Prefetch, this, shards_[i].get(), i);
+  }
+}
+
+ParallelDBReader::~ParallelDBReader() {
+  stop_ = true;
+  for (auto& shard : shards_) {
+    {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+    }
+    shard->cv.notify_all();
+  }
+  for (auto& shard : shards_) {
+    shard->thread.join();
+  }
+}
+
+void ParallelDBReader::Prefetch(Shard* shard, int shard_id) {
+  Cursor* cursor = shard->cursor.get();
+  try {
+    while (!stop_) {
+      cursor->SeekToFirst();
+      for (int i = 0; i < shard_id && cursor->Valid(); ++i) {
+        cursor->Next();
+      }
+      while (cursor->Valid()) {
+        Record record;
+        record.key = cursor->key();
+        record.value = cursor->value();
+        if (!Push(shard, std::move(record))) {
+          return;
+        }
+        for (size_t i = 0; i < shards_.size() && cursor->Valid(); ++i) {
+          cursor->Next();
+        }
+      }
+      Record end;
+      end.end = true;
+      if (!Push(shard, std::move(end))) {
+        return;
+      }
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->error = std::current_exception();
+    shard->cv.notify_all();
+  }
+}
+
+bool ParallelDBReader::Push(Shard* shard, Record record) {
+  std::unique_lock<std::mutex> lock(shard->mutex);
+  shard->cv.wait(
+      lock, [&] { return stop_ || shard->queue.size() < readahead_; });
+  if (stop_) {
+    return false;
+  }
+  shard->queue.push_back(std::move(record));
+  shard->cv.notify_all();
+  return true;
+}
+
+ParallelDBReader::Record ParallelDBReader::Pop(Shard* shard) {
+  std::unique_lock<std::mutex> lock(shard->mutex);
+  shard->cv.wait(lock, [&] { return !shard->queue.empty() || shard->error; });
+  if (shard->queue.empty()) {
+    std::rethrow_exception(shard->error);
+  }
+  Record record = std::move(shard->queue.front());
+  shard->queue.pop_front();
+  shard->cv.notify_all();
+  return record;
+}
+
+void ParallelDBReader::Read(string* key, string* value) {
+  std::lock_guard<std::mutex> lock(read_mutex_);
+  while (true) {
+    Record record = Pop(shards_[next_shard_].get());
+    if (!record.end) {
+      next_shard_ = (next_shard_ + 1) % shards_.size();
+      ++records_since_first_;
+      *key = std::move(record.key);
+      *value = std::move(record.value);
+      return;
+    }
+    // Once a cursor is past the last record, the next record of all the
+    // others is also past it: take their end markers and start over from the
+    // first cursor.
+    for (size_t i = 1; i < shards_.size(); ++i) {
+      auto other = Pop(shards_[(next_shard_ + i) % shards_.size()].get());
+      CAFFE_ENFORCE(other.end, "Cursors of a db went out of sync");
+    }
+    CAFFE_ENFORCE_GT(records_since_first_, 0, "Reading an empty db");
+    next_shard_ = 0;
+    records_since_first_ = 0;
+  }
+}
+
 void DBReaderSerializer::Serialize(
     const void* pointer,
     TypeMeta typeMeta,
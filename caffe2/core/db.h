@@ -1,7 +1,13 @@
 #ifndef CAFFE2_CORE_DB_H_
 #define CAFFE2_CORE_DB_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include "c10/util/Registry.h"
 #include "caffe2/core/blob_serialization.h"
@@ -294,6 +300,66 @@ class CAFFE2_API DBReader {
   C10_DISABLE_COPY_AND_ASSIGN(DBReader);
 };
 
+/**
+ * A reader that reads a db with several threads ahead of its caller.
+ *
+ * The records are split between num_threads cursors: cursor i reads records
+ * i, i + num_threads, i + 2 * num_threads and so on, and keeps up to
+ * readahead of them in a queue. Read() takes the records from the queues in
+ * turn, so that they come in the order of the db, like with DBReader, and
+ * goes back to the first record once all of them are read.
+ *
+ * The db must support several cursors at the same time, like lmdb, leveldb
+ * and rocksdb do.
+ */
+class CAFFE2_API ParallelDBReader {
+ public:
+  ParallelDBReader(
+      const string& db_type,
+      const string& source,
+      int num_threads,
+      int readahead = 64);
+  ~ParallelDBReader();
+
+  /**
+   * Reads the next key and value. Thread safe. Rethrows the errors of the
+   * reading threads.
+   */
+  void Read(string* key, string* value);
+
+ private:
+  struct Record {
+    string key;
+    string value;
+    // Marks the end of the records of a cursor in the db.
+    bool end = false;
+  };
+
+  struct Shard {
+    unique_ptr<Cursor> cursor;
+    std::deque<Record> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+    std::thread thread;
+  };
+
+  void Prefetch(Shard* shard, int shard_id);
+  bool Push(Shard* shard, Record record);
+  Record Pop(Shard* shard);
+
+  unique_ptr<DB> db_;
+  std::vector<unique_ptr<Shard>> shards_;
+  const size_t readahead_;
+  std::atomic<bool> stop_{false};
+
+  std::mutex read_mutex_;
+  size_t next_shard_ = 0;
+  size_t records_since_first_ = 0;
+
+  C10_DISABLE_COPY_AND_ASSIGN(ParallelDBReader);
+};
+
 class CAFFE2_API DBReaderSerializer : public BlobSerializerBase {
  public:
   /**
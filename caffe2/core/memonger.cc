@@ -1,5 +1,6 @@
 #include "caffe2/core/memonger.h"
 
+#include <algorithm>
 #include <set>
 #include <unordered_set>
 
@@ -8,9 +9,42 @@
 namespace caffe2 {
 namespace memonger {
 
-NetDef optimize_inference_net(
+namespace {
+
+// Returns the index in `free_blobs` of the blob to reuse for a blob of
+// `size` bytes, see the size-aware optimize_inference_net().
+size_t pick_free_blob(
+    const std::vector<std::string>& free_blobs,
+    const std::unordered_map<std::string, int64_t>& shared_sizes,
+    int64_t size) {
+  if (size <= 0) {
+    return free_blobs.size() - 1;
+  }
+  auto size_of = [&](const std::string& blob) -> int64_t {
+    auto it = shared_sizes.find(blob);
+    return it == shared_sizes.end() ? 0 : it->second;
+  };
+  size_t best_fit = free_blobs.size();
+  size_t largest = free_blobs.size() - 1;
+  for (size_t i = 0; i < free_blobs.size(); i++) {
+    const int64_t free_size = size_of(free_blobs[i]);
+    if (free_size >= size &&
+        (best_fit == free_blobs.size() ||
+         free_size < size_of(free_blobs[best_fit]))) {
+      best_fit = i;
+    }
+    if (free_size > size_of(free_blobs[largest])) {
+      largest = i;
+    }
+  }
+  return best_fit != free_blobs.size() ? best_fit : largest;
+}
+
+NetDef optimize_inference_net_impl(
     const NetDef& net,
-    const std::set<string>& static_blobs) {
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, int64_t>* blob_sizes,
+    MemongerStats* stats) {
   if (net.type() != "" && net.type() != "simple") {
     LOG(INFO) << "Cannot optimize memory for nets of type: " << net.type();
     return net;
@@ -48,10 +82,20 @@ NetDef optimize_inference_net(
     }
   }
 
+  auto size_of = [&](const std::string& blob) -> int64_t {
+    if (!blob_sizes) {
+      return 0;
+    }
+    auto it = blob_sizes->find(blob);
+    return it == blob_sizes->end() ? 0 : it->second;
+  };
+
   // Step 2: pass over ops and recycle
   std::vector<std::string> free_blobs;
   std::unordered_map<std::string, std::string> renaming;
   std::unordered_map<std::string, std::string> mapping;
+  // Size of the largest blob mapped to each shared blob so far
+  std::unordered_map<std::string, int64_t> shared_sizes;
 
   for (int i = 0; i < (int)ops.size(); i++) {
     auto& op = ops[i];
@@ -64,6 +108,7 @@ NetDef optimize_inference_net(
         if (mapping.find(inp) == mapping.end()) {
           new_free_blobs.insert(inp);
           mapping[inp] = inp;
+          shared_sizes[inp] = size_of(inp);
 
           // Safety check to prevent double-memongering nets.
           string shared_blob =
@@ -86,9 +131,12 @@ NetDef optimize_inference_net(
         // first use?
         auto rit = ranges.find(outp);
         if (rit != ranges.end() && rit->second.first == i) {
-          std::string recycled = free_blobs.back();
-          free_blobs.pop_back();
+          const int64_t size = size_of(outp);
+          size_t index = pick_free_blob(free_blobs, shared_sizes, size);
+          std::string recycled = free_blobs[index];
+          free_blobs.erase(free_blobs.begin() + index);
           mapping[outp] = recycled;
+          shared_sizes[recycled] = std::max(shared_sizes[recycled], size);
         }
       }
     }
@@ -119,10 +167,43 @@ NetDef optimize_inference_net(
     ao->CopyFrom(op);
   }
 
+  if (stats) {
+    std::unordered_map<std::string, int64_t> group_sizes;
+    stats->bytes_before = 0;
+    for (const auto& range : ranges) {
+      const int64_t size = size_of(range.first);
+      stats->bytes_before += size;
+      auto it = mapping.find(range.first);
+      auto& group_size =
+          group_sizes[it == mapping.end() ? range.first : it->second];
+      group_size = std::max(group_size, size);
+    }
+    stats->bytes_after = 0;
+    for (const auto& group : group_sizes) {
+      stats->bytes_after += group.second;
+    }
+  }
+
   VLOG(1) << "optimized net using " << renaming.size() << " shared blobs";
   return optim_net;
 }
 
+} // namespace
+
+NetDef optimize_inference_net(
+    const NetDef& net,
+    const std::set<string>& static_blobs) {
+  return optimize_inference_net_impl(net, static_blobs, nullptr, nullptr);
+}
+
+NetDef optimize_inference_net(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, int64_t>& blob_sizes,
+    MemongerStats* stats) {
+  return optimize_inference_net_impl(net, static_blobs, &blob_sizes, stats);
+}
+
 class ComputeBlobRecyclingForDag {
  public:
   explicit ComputeBlobRecyclingForDag(const int size)
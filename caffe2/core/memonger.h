@@ -1,6 +1,8 @@
 #ifndef CAFFE2_CORE_MEMONGER_H_
 #define CAFFE2_CORE_MEMONGER_H_
 
+#include <set>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "caffe2/core/common.h"
@@ -14,6 +16,26 @@ CAFFE2_API NetDef optimize_inference_net(
     const NetDef& net,
     const std::set<string>& static_blobs);
 
+// Memory taken by the intermediate blobs of a net whose size is known, see
+// the size-aware optimize_inference_net().
+struct CAFFE2_API MemongerStats {
+  // When every intermediate blob has its own memory.
+  int64_t bytes_before = 0;
+  // When the blobs that share a blob take the size of the largest of them.
+  int64_t bytes_after = 0;
+};
+
+// Like optimize_inference_net(), but takes the sizes in bytes of the blobs,
+// e.g. from shape inference. A blob produced for the first time reuses the
+// smallest free shared blob at least as large as it, or, if there is none,
+// the largest free shared blob, which then grows the least. Blobs whose size
+// isn't in `blob_sizes` reuse the last freed blob, like without sizes.
+CAFFE2_API NetDef optimize_inference_net(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, int64_t>& blob_sizes,
+    MemongerStats* stats = nullptr);
+
 CAFFE2_API NetDef compute_blob_recycling_for_dag(
     const NetDef& net,
     const std::vector<string>& heads,
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "caffe2/core/memonger.h"
+
+namespace caffe2 {
+
+namespace {
+
+void AddOp(
+    NetDef* net,
+    const std::vector<std::string>& inputs,
+    const std::string& output) {
+  auto* op = net->add_op();
+  op->set_type("MemongerTestOp");
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  op->add_output(output);
+}
+
+// a and d are large, the other blobs are small. When d is produced, a and b
+// are free, and d should reuse a whatever the order they were freed in.
+NetDef MakeNet() {
+  NetDef net;
+  AddOp(&net, {"x"}, "a");
+  AddOp(&net, {"x"}, "b");
+  AddOp(&net, {"a", "b"}, "c");
+  AddOp(&net, {"c"}, "d");
+  AddOp(&net, {"d"}, "e");
+  AddOp(&net, {"e"}, "out");
+  return net;
+}
+
+} // namespace
+
+TEST(MemongerTest, SharesBlobs) {
+  auto optim_net = memonger::optimize_inference_net(MakeNet(), {"x", "out"});
+  ASSERT_EQ(optim_net.op_size(), 6);
+  EXPECT_EQ(optim_net.op(5).output(0), "out");
+  // c is produced while a and b are still used.
+  EXPECT_NE(optim_net.op(2).output(0), optim_net.op(0).output(0));
+  EXPECT_NE(optim_net.op(2).output(0), optim_net.op(1).output(0));
+}
+
+TEST(MemongerTest, SizeAwareSharing) {
+  std::unordered_map<std::string, int64_t> sizes{
+      {"a", 100}, {"b", 10}, {"c", 10}, {"d", 100}, {"e", 10}};
+  memonger::MemongerStats stats;
+  auto optim_net = memonger::optimize_inference_net(
+      MakeNet(), {"x", "out"}, sizes, &stats);
+  ASSERT_EQ(optim_net.op_size(), 6);
+  EXPECT_EQ(optim_net.op(3).output(0), optim_net.op(0).output(0));
+  EXPECT_NE(optim_net.op(4).output(0), optim_net.op(0).output(0));
+  EXPECT_EQ(stats.bytes_before, 230);
+  EXPECT_EQ(stats.bytes_after, 120);
+}
+
+} // namespace caffe2
@@ -56,6 +56,18 @@ C10_DEFINE_bool(
     false,
     "Run root tasks in current thread instread of scheduling to threadpool");
 
+C10_DEFINE_bool(
+    caffe2_net_async_priority_scheduling,
+    false,
+    "Schedule ready tasks by the estimated cost of their longest path to the "
+    "end of the net instead of FIFO");
+
+C10_DEFINE_double(
+    caffe2_net_async_inline_task_cost,
+    -1.0,
+    "Run tasks with at most this estimated cost inline in the thread of their "
+    "parent, negative to disable");
+
 namespace caffe2 {
 
 std::vector<int>& AsyncNetBase::getStreamCounters() {
@@ -588,6 +600,8 @@ ExecutionOptions::ExecutionOptions(
   }
 
   use_dfs_scheduling_ = false;
+  use_priority_scheduling_ = FLAGS_caffe2_net_async_priority_scheduling;
+  inline_task_cost_ = FLAGS_caffe2_net_async_inline_task_cost;
 
   for (int arg_idx = 0; arg_idx < net_def->arg_size(); ++arg_idx) {
     auto& arg = net_def->arg(arg_idx);
@@ -599,6 +613,14 @@ ExecutionOptions::ExecutionOptions(
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
     }
+    if (arg.has_name() && arg.name() == "priority_scheduling") {
+      CAFFE_ENFORCE(arg.has_i(), "priority_scheduling should be an int");
+      use_priority_scheduling_ = arg.i() == 1;
+    }
+    if (arg.has_name() && arg.name() == "inline_task_cost") {
+      CAFFE_ENFORCE(arg.has_f(), "inline_task_cost should be a float");
+      inline_task_cost_ = arg.f();
+    }
   }
 
   if (FLAGS_caffe2_net_async_profile_operators) {
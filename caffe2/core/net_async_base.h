@@ -24,6 +24,8 @@ C10_DECLARE_bool(caffe2_net_async_use_single_pool);
 C10_DECLARE_bool(caffe2_net_async_use_per_net_pools);
 C10_DECLARE_bool(caffe2_net_async_run_root_tasks_inline);
 C10_DECLARE_bool(caffe2_net_async_profile_operators);
+C10_DECLARE_bool(caffe2_net_async_priority_scheduling);
+C10_DECLARE_double(caffe2_net_async_inline_task_cost);
 
 namespace caffe2 {
 
@@ -55,6 +57,14 @@ struct ExecutionOptions {
   bool use_dfs_scheduling_ = false;
   // run net's root tasks in RunAsync thread instead of in thread pool
   bool run_root_tasks_inline_ = false;
+  // run ready tasks in the order of the cost of their longest path to the end
+  // of the net instead of FIFO
+  bool use_priority_scheduling_ = false;
+  // run children tasks inline when their estimated cost is at most this,
+  // a negative value disables it. Costs are in units of the "cost_hint"
+  // arguments of the ops (1 per op by default), or in ms once the ops are
+  // profiled
+  float inline_task_cost_ = -1.0f;
 };
 
 struct CAFFE2_API AsyncNetCancelled : public std::exception {
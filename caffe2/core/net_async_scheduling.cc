@@ -1,5 +1,7 @@
 #include "caffe2/core/net_async_scheduling.h"
 
+#include <algorithm>
+
 #include "caffe2/core/net_async_tracing.h"
 
 namespace caffe2 {
@@ -7,7 +9,32 @@ namespace caffe2 {
 AsyncSchedulingNet::AsyncSchedulingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false) {}
+    : AsyncNetBase(net_def, ws), running_(false) {
+  if (options_.use_priority_scheduling_ || options_.inline_task_cost_ >= 0) {
+    // Until operators are measured, use the "cost_hint" argument of the
+    // operators, or a cost of 1 per operator
+    std::vector<float> op_costs;
+    op_costs.reserve(operators_.size());
+    for (const auto* op : operators_) {
+      op_costs.push_back(
+          ArgumentHelper::GetSingleArgument<OperatorDef, float>(
+              op->debug_def(), "cost_hint", 1.0f));
+    }
+    updateTaskCosts(op_costs);
+  }
+}
+
+void AsyncSchedulingNet::updateTaskCosts(const std::vector<float>& op_costs) {
+  CAFFE_ENFORCE_EQ(op_costs.size(), operators_.size());
+  task_costs_.assign(tasksNum(), 0.0f);
+  for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
+    for (auto op_id : chains_[task_id]) {
+      task_costs_[task_id] += op_costs[op_id];
+    }
+  }
+  task_priorities_ =
+      dag_utils::computeChainPriorities(chain_nodes_, task_costs_);
+}
 
 void AsyncSchedulingNet::reset() {
   AsyncNetBase::reset();
@@ -22,7 +49,9 @@ void AsyncSchedulingNet::Wait() {
 }
 
 bool AsyncSchedulingNet::isInlineTask(int parent_id, int child_id) const {
-  if (!options_.use_dfs_scheduling_) {
+  const bool is_short_task = options_.inline_task_cost_ >= 0 &&
+      task_costs_[child_id] <= options_.inline_task_cost_;
+  if (!options_.use_dfs_scheduling_ && !is_short_task) {
     return false;
   }
   const auto* last_parent_op = lastTaskOp(parent_id);
@@ -172,12 +201,44 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
 
   if (run_inline) {
     schedule_func();
+  } else if (options_.use_priority_scheduling_) {
+    schedulePrioritized(task_id, std::move(schedule_func));
   } else {
     const auto& device_option = event(task_id).GetDeviceOption();
     pool(device_option)->run(schedule_func);
   }
 }
 
+void AsyncSchedulingNet::schedulePrioritized(
+    int task_id,
+    std::function<void()> func) {
+  auto* task_pool = pool(event(task_id).GetDeviceOption());
+  {
+    std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+    auto& ready_tasks = ready_tasks_[task_pool];
+    ready_tasks.push_back(
+        ReadyTask{task_priorities_[task_id], task_id, std::move(func)});
+    std::push_heap(ready_tasks.begin(), ready_tasks.end());
+  }
+  // There is exactly one job per queued task, but a job does not necessarily
+  // run the task it was submitted for
+  task_pool->run(
+      std::bind(&AsyncSchedulingNet::runReadyTask, this, task_pool));
+}
+
+void AsyncSchedulingNet::runReadyTask(TaskThreadPoolBase* task_pool) {
+  std::function<void()> func;
+  {
+    std::lock_guard<std::mutex> lock(ready_tasks_mutex_);
+    auto& ready_tasks = ready_tasks_[task_pool];
+    CAFFE_ENFORCE(!ready_tasks.empty(), "No ready task in the pool queue");
+    std::pop_heap(ready_tasks.begin(), ready_tasks.end());
+    func = std::move(ready_tasks.back().func);
+    ready_tasks.pop_back();
+  }
+  func();
+}
+
 void AsyncSchedulingNet::parentCallback(int parent_id) {
   if (event(parent_id).Query() != EventStatus::EVENT_SUCCESS) {
     success_ = false;
@@ -234,6 +295,14 @@ bool AsyncSchedulingNet::RunAsync() {
     running_ = true;
     reset();
 
+    // Once runs are profiled, use the measured operator times as costs
+    if (!task_costs_.empty() && options_.report_stats_) {
+      auto op_times = counters_.GetPerOperatorMeanTime();
+      if (!op_times.empty()) {
+        updateTaskCosts(op_times);
+      }
+    }
+
     StartAllObservers();
     tracing::startIter(tracer_);
     if (options_.report_stats_) {
@@ -1,6 +1,8 @@
 #ifndef CAFFE2_CORE_NET_ASYNC_SCHEDULING_H_
 #define CAFFE2_CORE_NET_ASYNC_SCHEDULING_H_
 
+#include <functional>
+
 #include "caffe2/core/net_async_base.h"
 
 namespace caffe2 {
@@ -16,6 +18,10 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void Cancel() override;
 
+  const std::vector<float>& TEST_task_priorities() const {
+    return task_priorities_;
+  }
+
  protected:
   bool RunAsync() override;
 
@@ -28,6 +34,29 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void CancelAndFinishAsyncTasks();
 
+  // Priority scheduling: tasks are queued per pool in a max-heap of their
+  // priorities, and each job submitted to a pool runs the task on top of the
+  // heap of that pool
+  struct ReadyTask {
+    float priority;
+    int task_id;
+    std::function<void()> func;
+
+    bool operator<(const ReadyTask& other) const {
+      return priority < other.priority ||
+          (priority == other.priority && task_id > other.task_id);
+    }
+  };
+  void updateTaskCosts(const std::vector<float>& op_costs);
+  void schedulePrioritized(int task_id, std::function<void()> func);
+  void runReadyTask(TaskThreadPoolBase* task_pool);
+
+  std::vector<float> task_costs_;
+  std::vector<float> task_priorities_;
+  std::mutex ready_tasks_mutex_;
+  std::unordered_map<TaskThreadPoolBase*, std::vector<ReadyTask>>
+      ready_tasks_;
+
   std::mutex running_mutex_;
   std::condition_variable running_cv_;
   std::atomic<bool> running_;
@@ -512,5 +512,41 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
   return chain_nodes;
 }
 
+std::vector<float> computeChainPriorities(
+    const std::vector<OpGraphNode>& chain_nodes,
+    const std::vector<float>& chain_costs) {
+  CAFFE_ENFORCE_EQ(chain_nodes.size(), chain_costs.size());
+  // Visit the chains in reverse topological order, starting from the sinks,
+  // so that the priorities of all children are known when a chain is visited
+  std::vector<float> priorities(chain_nodes.size(), 0.0f);
+  std::vector<int> pending_children(chain_nodes.size());
+  std::vector<int> ready;
+  for (int chain_idx = 0; chain_idx < (int)chain_nodes.size(); ++chain_idx) {
+    pending_children[chain_idx] = chain_nodes[chain_idx].children_.size();
+    if (pending_children[chain_idx] == 0) {
+      ready.push_back(chain_idx);
+    }
+  }
+  int num_visited = 0;
+  while (!ready.empty()) {
+    auto chain_idx = ready.back();
+    ready.pop_back();
+    ++num_visited;
+    float max_child_priority = 0.0f;
+    for (const auto& child_idx : chain_nodes[chain_idx].children_) {
+      max_child_priority = std::max(max_child_priority, priorities[child_idx]);
+    }
+    priorities[chain_idx] = chain_costs[chain_idx] + max_child_priority;
+    for (const auto& parent_idx : chain_nodes[chain_idx].parents_) {
+      if (--pending_children[parent_idx] == 0) {
+        ready.push_back(parent_idx);
+      }
+    }
+  }
+  CAFFE_ENFORCE_EQ(
+      num_visited, (int)chain_nodes.size(), "Chain graph has a cycle");
+  return priorities;
+}
+
 } // namespace dag_utils
 } // namespace caffe2
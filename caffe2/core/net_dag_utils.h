@@ -63,6 +63,13 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
     const std::vector<dag_utils::OperatorNode>& operator_nodes,
     const std::vector<std::vector<int>>& execution_chains);
 
+// Computes for each chain the cost of the most expensive path from the start
+// of the chain to a sink of the chain graph. Running the ready chains with the
+// highest value first favors the critical path of the net.
+C10_EXPORT std::vector<float> computeChainPriorities(
+    const std::vector<OpGraphNode>& chain_nodes,
+    const std::vector<float>& chain_costs);
+
 } // namespace dag_utils
 } // namespace caffe2
 
@@ -293,4 +293,20 @@ TEST(DagUtilTest, Mixed2) {
       {0, {0}}, {1, {1}}, {3, {3, 6}}, {4, {4, 2, 5}}, {7, {7}}, {8, {8}}};
   EXPECT_EQ(chains, expected);
 }
+
+// 0 -> 1 -> 3
+//  \-> 2 -/
+TEST(DagUtilTest, ChainPriorities) {
+  std::vector<dag_utils::OpGraphNode> chain_nodes(4);
+  chain_nodes[0].children_ = {1, 2};
+  chain_nodes[1].parents_ = {0};
+  chain_nodes[1].children_ = {3};
+  chain_nodes[2].parents_ = {0};
+  chain_nodes[2].children_ = {3};
+  chain_nodes[3].parents_ = {1, 2};
+  auto priorities =
+      dag_utils::computeChainPriorities(chain_nodes, {1.0f, 5.0f, 2.0f, 1.0f});
+  std::vector<float> expected{7.0f, 6.0f, 3.0f, 1.0f};
+  EXPECT_EQ(priorities, expected);
+}
 } // namespace caffe2
@@ -697,6 +697,72 @@ TEST(NetTest, AsyncEmptyNet) {
   }
 }
 
+TEST(NetTest, AsyncPriorityScheduling) {
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        external_input: "in"
+        arg {
+          name: "priority_scheduling"
+          i: 1
+        }
+        arg {
+          name: "inline_task_cost"
+          f: 1.0
+        }
+        op {
+          input: "in"
+          output: "hidden"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "hidden"
+          output: "long"
+          type: "NetTestDummy"
+          arg {
+            name: "cost_hint"
+            f: 5.0
+          }
+        }
+        op {
+          input: "hidden"
+          output: "short"
+          type: "NetTestDummy"
+          arg {
+            name: "cost_hint"
+            f: 0.0
+          }
+        }
+        op {
+          input: "long"
+          input: "short"
+          output: "out"
+          type: "NetTestDummy"
+        }
+  )DOC";
+
+  Workspace ws;
+  ws.CreateBlob("in");
+  NetDef net_def;
+  CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  auto* async_net =
+      caffe2::dynamic_cast_if_rtti<AsyncSchedulingNet*>(net.get());
+  ASSERT_TRUE(async_net != nullptr);
+
+  // The longest path goes through the op with the largest cost hint
+  const auto& priorities = async_net->TEST_task_priorities();
+  ASSERT_FALSE(priorities.empty());
+  EXPECT_FLOAT_EQ(
+      *std::max_element(priorities.begin(), priorities.end()), 7.0f);
+
+  for (int run = 0; run < 10; ++run) {
+    counter.exchange(0);
+    ASSERT_TRUE(net->Run());
+    ASSERT_EQ(counter.load(), 4);
+  }
+}
+
 TEST(NetTest, DISABLED_RunAsyncFailure) {
   const auto spec = R"DOC(
         name: "example"
@@ -105,6 +105,10 @@ class ProfDAGCounters {
   void AddPerOpAsyncEndTime(size_t op_id);
   ProfDAGReport GetReport() const;
 
+  // Mean time in ms of each operator of the net, empty if no run has been
+  // measured yet
+  std::vector<float> GetPerOperatorMeanTime() const;
+
  private:
   Timer timer_;
 
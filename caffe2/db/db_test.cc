@@ -200,5 +200,24 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+TEST(ParallelDBReaderTest, Reader) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("leveldb", name);
+  for (int num_threads : {1, 3, 4, 12}) {
+    ParallelDBReader reader("leveldb", name, num_threads, 2);
+    string key;
+    string value;
+    // The records come in the order of the db, also after going back to the
+    // first one.
+    for (int i = 0; i < 3 * kMaxItems; ++i) {
+      std::stringstream ss;
+      ss << std::setw(2) << std::setfill('0') << i % kMaxItems;
+      reader.Read(&key, &value);
+      EXPECT_EQ(key, ss.str());
+      EXPECT_EQ(value, ss.str());
+    }
+  }
+}
+
 } // namespace db
 } // namespace caffe2
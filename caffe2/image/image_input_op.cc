@@ -128,8 +128,9 @@ The dimension of the output image will always be cropxcrop
     .Arg("use_caffe_datum", "1 if the input is in Caffe format. Defaults to 0")
     .Arg(
         "use_gpu_transform",
-        "1 if GPU acceleration should be used."
-        " Defaults to 0. Can only be 1 in a CUDAContext")
+        "1 if GPU acceleration should be used: the decode threads only crop"
+        " and mirror, and color jitter, color lighting and normalization are"
+        " done on the GPU. Defaults to 0. Can only be 1 in a CUDAContext")
     .Arg(
         "decode_threads",
         "Number of CPU decode/transform threads."
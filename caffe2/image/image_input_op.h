@@ -92,6 +92,7 @@ class ImageInputOp final : public PrefetchOperator<Context> {
       int item_id,
       const int channels,
       std::size_t thread_index);
+  void DrawColorJitter(float* params, std::mt19937* randgen);
   bool ApplyTransformOnGPU(
       const std::vector<std::int64_t>& dims,
       const c10::Device& type);
@@ -103,6 +104,10 @@ class ImageInputOp final : public PrefetchOperator<Context> {
   vector<Tensor> prefetched_additional_outputs_;
   Tensor prefetched_image_on_device_;
   Tensor prefetched_label_on_device_;
+  // Color jitter and lighting of every image of the batch, when they are
+  // applied by the GPU transform, see TransformWithColorJitterOnGPU.
+  Tensor prefetched_color_jitter_;
+  Tensor prefetched_color_jitter_on_device_;
   vector<Tensor> prefetched_additional_outputs_on_device_;
   // Default parameters for images
   PerImageArg default_arg_;
@@ -135,6 +140,7 @@ class ImageInputOp final : public PrefetchOperator<Context> {
   bool is_test_;
   bool use_caffe_datum_;
   bool gpu_transform_;
+  bool gpu_color_jitter_;
   bool mean_std_copied_ = false;
 
   // thread pool for parse + decode
@@ -334,10 +340,16 @@ ImageInputOp<Context>::ImageInputOp(
     std_.resize(3, std_[0]);
   }
 
+  gpu_color_jitter_ = gpu_transform_ && !is_test_ && color_ &&
+      (color_jitter_ || color_lighting_);
+
   LOG(INFO) << "Creating an image input op with the following setting: ";
   LOG(INFO) << "    Using " << num_decode_threads_ << " CPU threads;";
   if (gpu_transform_) {
     LOG(INFO) << "    Performing transformation on GPU";
+    if (gpu_color_jitter_) {
+      LOG(INFO) << "    Performing color jitter and lighting on GPU";
+    }
   }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " images;";
   LOG(INFO) << "    Treating input image as "
@@ -405,6 +417,12 @@ ImageInputOp<Context>::ImageInputOp(
   }
   // data type for prefetched_label_ is actually not known here..
   ReinitializeTensor(&prefetched_label_, sizes, at::dtype<int>().device(CPU));
+  if (gpu_color_jitter_) {
+    ReinitializeTensor(
+        &prefetched_color_jitter_,
+        {int64_t(batch_size_), int64_t(kColorJitterParams)},
+        at::dtype<float>().device(CPU));
+  }
 
   for (int i = 0; i < additional_output_sizes_.size(); ++i) {
     prefetched_additional_outputs_on_device_.emplace_back();
@@ -1144,6 +1162,54 @@ void ImageInputOp<Context>::DecodeAndTransposeOnly(
       randgen,
       &mirror_this_image,
       is_test_);
+
+  if (gpu_color_jitter_) {
+    DrawColorJitter(
+        prefetched_color_jitter_.mutable_data<float>() +
+            kColorJitterParams * item_id,
+        randgen);
+  }
+}
+
+// Draws the color jitter and lighting of an image the same way as
+// ColorJitter and ColorLighting, for the GPU transform to apply.
+template <class Context>
+void ImageInputOp<Context>::DrawColorJitter(
+    float* params,
+    std::mt19937* randgen) {
+  const float ranges[3] = {img_saturation_, img_brightness_, img_contrast_};
+  for (int i = 0; i < 3; ++i) {
+    params[i] = color_jitter_
+        ? 1.0f +
+            std::uniform_real_distribution<float>(-ranges[i], ranges[i])(
+                *randgen)
+        : 1.0f;
+  }
+  std::vector<int> jitter_order{0, 1, 2};
+  std::shuffle(jitter_order.begin(), jitter_order.end(), *randgen);
+  for (int i = 0; i < 3; ++i) {
+    params[3 + i] = jitter_order[i];
+  }
+
+  std::vector<float> delta_rgb(3, 0.0);
+  if (color_lighting_) {
+    std::normal_distribution<float> d(0, color_lighting_std_);
+    std::vector<float> alphas(3);
+    for (int i = 0; i < 3; ++i) {
+      alphas[i] = d(*randgen);
+    }
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        delta_rgb[i] +=
+            color_lighting_eigvecs_[i][j] * color_lighting_eigvals_[j] *
+            alphas[j];
+      }
+    }
+  }
+  // BGR order
+  for (int c = 0; c < 3; ++c) {
+    params[6 + c] = delta_rgb[2 - c];
+  }
 }
 
 template <class Context>
@@ -1217,7 +1283,6 @@ bool ImageInputOp<Context>::Prefetch() {
     }
 
     // launch into thread pool for processing
-    // TODO: support color jitter and color lighting in gpu_transform
     if (gpu_transform_) {
       // output of decode will still be int8
       uint8_t* image_data = prefetched_image_.mutable_data<uint8_t>() +
@@ -1263,6 +1328,12 @@ bool ImageInputOp<Context>::Prefetch() {
         &prefetched_image_on_device_, device, prefetched_image_);
     ReinitializeAndCopyFrom(
         &prefetched_label_on_device_, device, prefetched_label_);
+    if (gpu_color_jitter_) {
+      ReinitializeAndCopyFrom(
+          &prefetched_color_jitter_on_device_,
+          device,
+          prefetched_color_jitter_);
+    }
 
     for (int i = 0; i < prefetched_additional_outputs_on_device_.size(); ++i) {
       ReinitializeAndCopyFrom(
@@ -1295,7 +1366,6 @@ bool ImageInputOp<Context>::CopyPrefetched() {
           i, options, prefetched_additional_outputs_[i - 2], /* async */ true);
     }
   } else {
-    // TODO: support color jitter and color lighting in gpu_transform
     if (gpu_transform_) {
       if (!mean_std_copied_) {
         ReinitializeTensor(
@@ -46,6 +46,96 @@ __global__ void transform_kernel(
   }
 }
 
+// Same as transform_kernel, but also applies the color jitter and lighting of
+// every image, see TransformWithColorJitterOnGPU. The image is 3-channel BGR.
+template <typename In, typename Out>
+__global__ void transform_color_jitter_kernel(
+    const int N,
+    const int H,
+    const int W,
+    const float* mean,
+    const float* std,
+    const float* params,
+    const In* in,
+    Out* out) {
+  const int n = blockIdx.x;
+  const int C = 3;
+  const int nStride = C*H*W;
+  const In* input_ptr = &in[n*nStride];
+  Out* output_ptr = &out[n*nStride];
+  const float* p = &params[n*kColorJitterParams];
+
+  // Saturation, brightness and contrast are all linear, so their composition
+  // maps a pixel x to a * x + b * gray(x) + k, where gray(x) is the gray
+  // level of x. Contrast needs the mean gray level of the image when it is
+  // applied, which is (a + b) times that of the input plus k.
+  __shared__ float gray_sum[256];
+  __shared__ float coeffs[3];
+  const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+  float sum = 0;
+  for (int h=threadIdx.y; h < H; h += blockDim.y) {
+    for (int w=threadIdx.x; w < W; w += blockDim.x) {
+      const In* px = &input_ptr[C*w + C*W*h];
+      sum += convert::To<In,float>(px[0]) * 0.114f +
+          convert::To<In,float>(px[1]) * 0.587f +
+          convert::To<In,float>(px[2]) * 0.299f;
+    }
+  }
+  gray_sum[tid] = sum;
+  __syncthreads();
+  for (int s = blockDim.x * blockDim.y / 2; s > 0; s >>= 1) {
+    if (tid < s) {
+      gray_sum[tid] += gray_sum[tid + s];
+    }
+    __syncthreads();
+  }
+  if (tid == 0) {
+    const float gray_mean = gray_sum[0] / (H*W);
+    float a = 1, b = 0, k = 0;
+    for (int i = 0; i < 3; ++i) {
+      const int op = static_cast<int>(p[3 + i]);
+      const float alpha = p[op];
+      if (op == 0) {
+        // saturation
+        b = alpha * b + (1 - alpha) * (a + b);
+        a *= alpha;
+      } else if (op == 1) {
+        // brightness
+        a *= alpha;
+        b *= alpha;
+        k *= alpha;
+      } else {
+        // contrast
+        const float m = (a + b) * gray_mean + k;
+        a *= alpha;
+        b *= alpha;
+        k = alpha * k + (1 - alpha) * m;
+      }
+    }
+    coeffs[0] = a;
+    coeffs[1] = b;
+    coeffs[2] = k;
+  }
+  __syncthreads();
+
+  const float a = coeffs[0], b = coeffs[1], k = coeffs[2];
+  for (int h=threadIdx.y; h < H; h += blockDim.y) {
+    for (int w=threadIdx.x; w < W; w += blockDim.x) {
+      const In* px = &input_ptr[C*w + C*W*h];
+      float x[3];
+      for (int c=0; c < C; ++c) {
+        x[c] = convert::To<In,float>(px[c]);
+      }
+      const float gray = x[0] * 0.114f + x[1] * 0.587f + x[2] * 0.299f;
+      for (int c=0; c < C; ++c) {
+        const float v = a * x[c] + b * gray + k + p[6 + c];
+        output_ptr[c*H*W + h*W + w] =
+            convert::To<float,Out>((v - mean[c]) * std[c]);
+      }
+    }
+  }
+}
+
 }
 
 template <typename T_IN, typename T_OUT, class Context>
@@ -67,6 +157,26 @@ bool TransformOnGPU(
   return true;
 };
 
+template <typename T_IN, typename T_OUT, class Context>
+bool TransformWithColorJitterOnGPU(
+    Tensor& X,
+    Tensor* Y,
+    Tensor& mean,
+    Tensor& std,
+    Tensor& params,
+    Context* context) {
+  const int N = X.dim32(0), C = X.dim32(3), H = X.dim32(1), W = X.dim32(2);
+  CAFFE_ENFORCE_EQ(C, 3, "Color jitter needs color images");
+  auto* input_data = X.template data<T_IN>();
+  auto* output_data = Y->template mutable_data<T_OUT>();
+
+  transform_color_jitter_kernel<
+    T_IN, T_OUT><<<N, dim3(16, 16), 0, context->cuda_stream()>>>(
+      N, H, W, mean.template data<float>(), std.template data<float>(),
+      params.template data<float>(), input_data, output_data);
+  return true;
+}
+
 template bool TransformOnGPU<uint8_t, float, CUDAContext>(
     Tensor& X,
     Tensor* Y,
@@ -81,4 +191,20 @@ template bool TransformOnGPU<uint8_t, at::Half, CUDAContext>(
     Tensor& std,
     CUDAContext* context);
 
+template bool TransformWithColorJitterOnGPU<uint8_t, float, CUDAContext>(
+    Tensor& X,
+    Tensor* Y,
+    Tensor& mean,
+    Tensor& std,
+    Tensor& params,
+    CUDAContext* context);
+
+template bool TransformWithColorJitterOnGPU<uint8_t, at::Half, CUDAContext>(
+    Tensor& X,
+    Tensor* Y,
+    Tensor& mean,
+    Tensor& std,
+    Tensor& params,
+    CUDAContext* context);
+
 }  // namespace caffe2
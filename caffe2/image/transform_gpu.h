@@ -38,6 +38,24 @@ bool TransformOnGPU(
     Tensor& std,
     Context* context);
 
+// Number of floats describing the color jitter and lighting of an image:
+// the saturation, brightness and contrast factors, the order to apply them
+// in (0 for saturation, 1 for brightness and 2 for contrast), and the
+// lighting offsets of the B, G and R channels.
+constexpr int kColorJitterParams = 9;
+
+// Like TransformOnGPU, but first applies to every image the color jitter and
+// lighting given by the N x kColorJitterParams floats in params. Only for
+// 3-channel images.
+template <typename T_IN, typename T_OUT, class Context>
+bool TransformWithColorJitterOnGPU(
+    Tensor& X,
+    Tensor* Y,
+    Tensor& mean,
+    Tensor& std,
+    Tensor& params,
+    Context* context);
+
 }  // namespace caffe2
 
 #endif
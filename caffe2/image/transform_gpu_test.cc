@@ -0,0 +1,110 @@
+#include <random>
+
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/image/image_input_op.h"
+#include "caffe2/image/transform_gpu.h"
+#include "gtest/gtest.h"
+
+namespace caffe2 {
+namespace {
+
+// The factor of a jitter drawn by Saturation, Brightness and Contrast from a
+// generator seeded with seed.
+float JitterFactor(float range, unsigned seed) {
+  std::mt19937 randgen(seed);
+  return 1.0f +
+      std::uniform_real_distribution<float>(-range, range)(randgen);
+}
+
+} // namespace
+
+// Checks the fused color jitter, lighting and normalization of the GPU
+// transform against the CPU functions applied one after the other.
+TEST(ImageTransformGPUTest, ColorJitterMatchesCPU) {
+  if (!HasCudaGPU()) {
+    return;
+  }
+  const int N = 2, H = 8, W = 8, C = 3;
+  const float ranges[3] = {0.4f, 0.4f, 0.4f};
+  const std::vector<std::vector<int>> orders = {{2, 0, 1}, {1, 2, 0}};
+  const std::vector<float> mean = {104.f, 117.f, 123.f};
+  const std::vector<float> std = {1.f / 57.f, 1.f / 57.f, 1.f / 58.f};
+  const std::vector<std::vector<float>> eigvecs = {
+      {-0.5675f, 0.7192f, 0.4009f},
+      {-0.5808f, -0.0045f, -0.8140f},
+      {-0.5836f, -0.6948f, 0.4203f}};
+  const std::vector<float> eigvals = {0.2175f, 0.0188f, 0.0045f};
+  const float lighting_std = 0.1f;
+
+  std::mt19937 pixels(0);
+  Tensor X({N, H, W, C}, CPU);
+  auto* x = X.mutable_data<uint8_t>();
+  for (int i = 0; i < X.numel(); ++i) {
+    x[i] = std::uniform_int_distribution<int>(0, 255)(pixels);
+  }
+
+  Tensor params({N, kColorJitterParams}, CPU);
+  std::vector<float> expected(N * C * H * W);
+  for (int n = 0; n < N; ++n) {
+    float* p = params.mutable_data<float>() + n * kColorJitterParams;
+    for (int i = 0; i < 3; ++i) {
+      p[i] = JitterFactor(ranges[i], n * 10 + i);
+      p[3 + i] = orders[n][i];
+    }
+    // The offsets ColorLighting adds, by lighting a black pixel
+    float lighting[3] = {0, 0, 0};
+    std::mt19937 lighting_gen(n * 10 + 3);
+    ColorLighting<CPUContext>(
+        lighting, 1, lighting_std, eigvecs, eigvals, &lighting_gen);
+    for (int c = 0; c < C; ++c) {
+      p[6 + c] = lighting[c];
+    }
+
+    std::vector<float> img(x + n * H * W * C, x + (n + 1) * H * W * C);
+    for (int op : orders[n]) {
+      std::mt19937 randgen(n * 10 + op);
+      if (op == 0) {
+        Saturation<CPUContext>(img.data(), H, ranges[op], &randgen);
+      } else if (op == 1) {
+        Brightness<CPUContext>(img.data(), H, ranges[op], &randgen);
+      } else {
+        Contrast<CPUContext>(img.data(), H, ranges[op], &randgen);
+      }
+    }
+    lighting_gen.seed(n * 10 + 3);
+    ColorLighting<CPUContext>(
+        img.data(), H, lighting_std, eigvecs, eigvals, &lighting_gen);
+    ColorNormalization<CPUContext>(img.data(), H, C, mean, std);
+    for (int h = 0; h < H; ++h) {
+      for (int w = 0; w < W; ++w) {
+        for (int c = 0; c < C; ++c) {
+          expected[((n * C + c) * H + h) * W + w] = img[(h * W + w) * C + c];
+        }
+      }
+    }
+  }
+
+  Tensor mean_cpu({C}, CPU);
+  Tensor std_cpu({C}, CPU);
+  std::copy(mean.begin(), mean.end(), mean_cpu.mutable_data<float>());
+  std::copy(std.begin(), std.end(), std_cpu.mutable_data<float>());
+
+  CUDAContext context;
+  Tensor X_gpu(X, CUDA);
+  Tensor mean_gpu(mean_cpu, CUDA);
+  Tensor std_gpu(std_cpu, CUDA);
+  Tensor params_gpu(params, CUDA);
+  Tensor Y_gpu({N, C, H, W}, CUDA);
+  EXPECT_TRUE((TransformWithColorJitterOnGPU<uint8_t, float, CUDAContext>(
+      X_gpu, &Y_gpu, mean_gpu, std_gpu, params_gpu, &context)));
+  context.FinishDeviceComputation();
+
+  Tensor Y(Y_gpu, CPU);
+  const float* y = Y.data<float>();
+  for (int i = 0; i < Y.numel(); ++i) {
+    EXPECT_NEAR(y[i], expected[i], 1e-3f * (1.0f + std::abs(expected[i])))
+        << "at " << i;
+  }
+}
+
+} // namespace caffe2
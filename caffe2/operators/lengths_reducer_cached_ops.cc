@@ -0,0 +1,53 @@
+#include "caffe2/operators/lengths_reducer_cached_ops.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(SparseLengthsSumCached, SparseLengthsSumCachedOp);
+
+OPERATOR_SCHEMA(SparseLengthsSumCached)
+    .NumInputs(3)
+    .NumOutputs(1, 2)
+    .ValueKeyLengthInputFillers(
+        SparseLengthsSumCachedOp::DATA,
+        SparseLengthsSumCachedOp::INDICES,
+        SparseLengthsSumCachedOp::LENGTHS)
+    .SetDoc(R"DOC(
+Same as SparseLengthsSum for a float DATA table, except that the most accessed
+rows of DATA are read from a compact copy, of which every NUMA node gets its
+own, rather than from DATA. This helps with tables much larger than the caches
+whose rows are accessed with a skewed distribution, like embedding tables.
+
+The operator counts how often every row is accessed, and every
+`reorganize_every` runs copies the `cache_rows` rows accessed the most since
+the last time. Rows are only copied then, so DATA must not be modified in
+place in between, like during training.
+)DOC")
+    .Arg("cache_rows", "Number of rows to cache. Defaults to 4096.")
+    .Arg(
+        "reorganize_every",
+        "Number of runs between two updates of the cached rows. "
+        "Defaults to 1000.")
+    .Input(0, "DATA", "float tensor, the rows of which are summed")
+    .Input(
+        1,
+        "INDICES",
+        "Integer vector containing indices of the first "
+        "dimension of DATA for the slices that are being aggregated")
+    .Input(
+        2,
+        "LENGTHS",
+        "Non negative vector with sum of elements equal to INDICES length")
+    .Output(
+        0,
+        "OUTPUT",
+        "Aggregated output tensor. Has the first dimension of K "
+        "(the number of segments).")
+    .Output(
+        1,
+        "CACHE_STATS",
+        "Optional int64 vector with the number of lookups that hit the cache "
+        "and the number of lookups, since the operator was created.");
+
+NO_GRADIENT(SparseLengthsSumCached);
+
+} // namespace caffe2
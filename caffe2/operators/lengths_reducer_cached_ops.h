@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "c10/util/numa.h"
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+// SparseLengthsSum for float tables whose rows are accessed with a skewed
+// distribution. The most accessed rows are copied into a compact cache, of
+// which every NUMA node gets its own copy, and read from there.
+//
+// Rows are counted as they are accessed, and every reorganize_every runs the
+// cache_rows most accessed rows since the last reorganization become the
+// cached rows. Rows are only copied into the cache when it is reorganized, so
+// the table must not be updated in place in between, as is the case for
+// inference.
+class SparseLengthsSumCachedOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  template <class... Args>
+  explicit SparseLengthsSumCachedOp(Args&&... args)
+      : Operator<CPUContext>(std::forward<Args>(args)...),
+        cache_rows_(
+            this->template GetSingleArgument<int64_t>("cache_rows", 4096)),
+        reorganize_every_(this->template GetSingleArgument<int64_t>(
+            "reorganize_every",
+            1000)) {
+    CAFFE_ENFORCE_GE(cache_rows_, 0);
+    CAFFE_ENFORCE_GT(reorganize_every_, 0);
+  }
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename IndexType>
+  bool DoRunWithType() {
+    auto& dataInput = Input(DATA);
+    auto& indicesInput = Input(INDICES);
+    auto& lengthsInput = Input(LENGTHS);
+    CAFFE_ENFORCE_EQ(1, indicesInput.dim(), "INDICES must be a vector");
+    CAFFE_ENFORCE_EQ(1, lengthsInput.dim(), "LENGTHS must be a vector");
+
+    const int64_t M = lengthsInput.size(0);
+    const int64_t indices_size = indicesInput.numel();
+    const int64_t N = dataInput.size(0);
+    const int64_t D = dataInput.size_from_dim(1);
+
+    auto shape = dataInput.sizes().vec();
+    shape[0] = M;
+    auto* output = Output(0, shape, at::dtype<float>());
+    float* out_data = output->template mutable_data<float>();
+
+    const float* in_data = dataInput.template data<float>();
+    const IndexType* indices = indicesInput.template data<IndexType>();
+    const int* lengths = lengthsInput.template data<int>();
+
+    if (in_data != table_ || N != static_cast<int64_t>(counts_.size())) {
+      // A new table, forget about the rows of the previous one.
+      table_ = in_data;
+      counts_.assign(N, 0);
+      slots_.assign(N, -1);
+      cached_rows_.clear();
+      ++version_;
+    }
+
+    const int node = c10::IsNUMAEnabled()
+        ? std::max(c10::GetCurrentNUMANode(), 0)
+        : 0;
+    if (node >= static_cast<int>(replicas_.size())) {
+      replicas_.resize(node + 1);
+    }
+    auto& replica = replicas_[node];
+    if (replica.version != version_) {
+      // The default CPU allocator places the copy on the node of this thread.
+      replica.rows = Tensor(CPU);
+      replica.rows.Resize(cached_rows_.size(), D);
+      float* rows = replica.rows.template mutable_data<float>();
+      for (size_t i = 0; i < cached_rows_.size(); ++i) {
+        std::copy(
+            in_data + cached_rows_[i] * D,
+            in_data + (cached_rows_[i] + 1) * D,
+            rows + i * D);
+      }
+      replica.version = version_;
+    }
+    const float* cache = replica.rows.template data<float>();
+
+    int64_t current = 0;
+    for (int64_t m = 0; m < M; ++m) {
+      float* out = out_data + m * D;
+      std::fill(out, out + D, 0.0f);
+      for (int i = 0; i < lengths[m]; ++i) {
+        CAFFE_ENFORCE_LT(
+            current,
+            indices_size,
+            "Your input seems to be incorrect: the sum of lengths values "
+            "should be the size of the indices tensor, but it appears not.");
+        const IndexType idx = indices[current++];
+        CAFFE_ENFORCE(
+            0 <= idx && idx < N,
+            "Index ",
+            current - 1,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            N);
+        ++counts_[idx];
+        const float* row;
+        if (slots_[idx] >= 0) {
+          row = cache + slots_[idx] * D;
+          ++hits_;
+        } else {
+          row = in_data + idx * D;
+        }
+        for (int64_t j = 0; j < D; ++j) {
+          out[j] += row[j];
+        }
+      }
+    }
+    CAFFE_ENFORCE_EQ(
+        current,
+        indices_size,
+        "Your input seems to be incorrect: the sum of lengths values should be "
+        "the size of the indices tensor, but it appears not.");
+    lookups_ += indices_size;
+
+    if (++runs_ % reorganize_every_ == 0) {
+      Reorganize();
+    }
+
+    if (OutputSize() > 1) {
+      auto* stats = Output(1, {2}, at::dtype<int64_t>());
+      stats->template mutable_data<int64_t>()[0] = hits_;
+      stats->template mutable_data<int64_t>()[1] = lookups_;
+    }
+    return true;
+  }
+
+  enum { DATA = 0, INDICES = 1, LENGTHS = 2 };
+
+ private:
+  // Makes the most accessed rows the cached rows, and halves the counts so
+  // that the cache follows changes of the distribution.
+  void Reorganize() {
+    std::vector<int64_t> rows;
+    for (int64_t i = 0; i < static_cast<int64_t>(counts_.size()); ++i) {
+      if (counts_[i] > 0) {
+        rows.push_back(i);
+      }
+    }
+    auto by_count = [this](int64_t a, int64_t b) {
+      return counts_[a] > counts_[b];
+    };
+    if (static_cast<int64_t>(rows.size()) > cache_rows_) {
+      std::nth_element(
+          rows.begin(), rows.begin() + cache_rows_, rows.end(), by_count);
+      rows.resize(cache_rows_);
+    }
+    // Keep the rows in table order for more sequential copies.
+    std::sort(rows.begin(), rows.end());
+
+    for (const auto row : cached_rows_) {
+      slots_[row] = -1;
+    }
+    cached_rows_ = std::move(rows);
+    for (size_t i = 0; i < cached_rows_.size(); ++i) {
+      slots_[cached_rows_[i]] = i;
+    }
+    for (auto& count : counts_) {
+      count /= 2;
+    }
+    ++version_;
+  }
+
+  struct Replica {
+    Tensor rows{CPU};
+    int64_t version = -1;
+  };
+
+  const int64_t cache_rows_;
+  const int64_t reorganize_every_;
+
+  const float* table_ = nullptr;
+  // Number of accesses of every row of the table.
+  std::vector<uint32_t> counts_;
+  // Index of every row of the table in the cache, or -1.
+  std::vector<int32_t> slots_;
+  // Row of the table of every index in the cache.
+  std::vector<int64_t> cached_rows_;
+  // Incremented when the cached rows change.
+  int64_t version_ = 0;
+  // Copies of the cached rows, by NUMA node.
+  std::vector<Replica> replicas_;
+
+  int64_t runs_ = 0;
+  int64_t hits_ = 0;
+  int64_t lookups_ = 0;
+};
+
+} // namespace caffe2
@@ -338,6 +338,9 @@ class RecurrentNetworkOp final : public Operator<Context> {
       // we cannot shrink it to 2 if there are more than 2 step workspaces.
       stepWorkspaces.resize(num_workspaces_on_fwd_only);
     }
+    if (stepNets_.size() < stepWorkspaces.size()) {
+      stepNets_.resize(stepWorkspaces.size());
+    }
 
     for (auto t = 0; t < seqLen; ++t) {
       auto& currentStepWorkspace =
@@ -356,14 +359,25 @@ class RecurrentNetworkOp final : public Operator<Context> {
             t, currentStepWorkspace.get(), this->observers_list_);
       } else {
         // Use plain Caffe2 nets
-        detail::UpdateTimestepBlob(currentStepWorkspace.get(), timestep_, t);
-        auto* stepNet = currentStepWorkspace->GetNet(stepNetDef_.name());
-        if (stepNet == nullptr) {
-          stepNet = currentStepWorkspace->CreateNet(stepNetDef_);
+        auto& step = stepNets_[&currentStepWorkspace - stepWorkspaces.data()];
+        if (step.ws.lock() != currentStepWorkspace) {
+          // Look up the step net and the timestep blob of this workspace once
+          // rather than at every timestep.
+          detail::UpdateTimestepBlob(currentStepWorkspace.get(), timestep_, t);
+          auto* stepNet = currentStepWorkspace->GetNet(stepNetDef_.name());
+          if (stepNet == nullptr) {
+            stepNet = currentStepWorkspace->CreateNet(stepNetDef_);
+          }
+          CAFFE_ENFORCE(stepNet, "Step Net construction failure");
+          step.ws = currentStepWorkspace;
+          step.net = stepNet;
+          step.timestep = BlobGetMutableTensor(
+                              currentStepWorkspace->GetBlob(timestep_), CPU)
+                              ->template mutable_data<int32_t>();
         }
-        CAFFE_ENFORCE(stepNet, "Step Net construction failure");
+        *step.timestep = t;
         // Since we have a SimpleNet, there are no races here.
-        stepNet->RunAsync();
+        step.net->RunAsync();
       }
     }
 
@@ -393,10 +407,20 @@ class RecurrentNetworkOp final : public Operator<Context> {
   }
 
  protected:
+  // The step net of a step workspace and the data of its timestep blob,
+  // when running plain Caffe2 nets.
+  struct StepNet {
+    std::weak_ptr<Workspace> ws;
+    NetBase* net = nullptr;
+    int32_t* timestep = nullptr;
+  };
+
   NetDef stepNetDef_;
   Workspace* sharedWs_;
   bool enable_rnn_executor_;
   std::unique_ptr<RecurrentNetworkExecutorBase> rnnExecutor_;
+  // Indexed like the step workspaces.
+  std::vector<StepNet> stepNets_;
 
   std::vector<detail::Link> links_;
   std::vector<detail::OffsetAlias> aliases_;
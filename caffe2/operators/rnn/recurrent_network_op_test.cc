@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/rnn/recurrent_network_op.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace {
+
+const int kSeqLen = 5;
+const int kBatchSize = 2;
+const int kStateSize = 3;
+
+// A forward only RecurrentNetwork, without the RNN executor, whose state is
+// the running sum of its inputs: output[t + 1] = output[t] + input[t].
+OperatorDef RunningSumOp() {
+  NetDef step;
+  step.set_name("running_sum_step");
+  step.add_external_input("input_t");
+  step.add_external_input("output_t_prev");
+  step.add_external_output("output_t");
+  auto* sum = step.add_op();
+  sum->set_type("Sum");
+  sum->add_input("input_t");
+  sum->add_input("output_t_prev");
+  sum->add_output("output_t");
+
+  OperatorDef def;
+  def.set_type("RecurrentNetwork");
+  def.add_input("input");
+  def.add_input("initial_output");
+  def.add_output("output");
+  def.add_output("step_workspaces");
+  auto* step_net = def.add_arg();
+  step_net->set_name("step_net");
+  step_net->mutable_n()->CopyFrom(step);
+  AddArgument<vector<string>>("recurrent_states", {"output"}, &def);
+  AddArgument<vector<int>>("initial_recurrent_state_ids", {1}, &def);
+  AddArgument<vector<string>>(
+      "link_internal", {"input_t", "output_t_prev", "output_t"}, &def);
+  AddArgument<vector<string>>(
+      "link_external", {"input", "output", "output"}, &def);
+  AddArgument<vector<int>>("link_offset", {0, 0, 1}, &def);
+  AddArgument<int>("enable_rnn_executor", 0, &def);
+  return def;
+}
+
+std::unique_ptr<OperatorBase> CreateRunningSumOp(Workspace* ws) {
+  // The inputs must exist when the op is created
+  BlobGetMutableTensor(ws->CreateBlob("input"), CPU);
+  BlobGetMutableTensor(ws->CreateBlob("initial_output"), CPU);
+  return CreateOperator(RunningSumOp(), ws);
+}
+
+// Feeds inputs of value base + t at timestep t, runs the op and checks the
+// running sums.
+void RunAndCheck(OperatorBase* op, Workspace* ws, float base) {
+  auto* input = BlobGetMutableTensor(ws->CreateBlob("input"), CPU);
+  input->Resize(kSeqLen, kBatchSize, kStateSize);
+  auto* x = input->mutable_data<float>();
+  for (int t = 0; t < kSeqLen; ++t) {
+    for (int i = 0; i < kBatchSize * kStateSize; ++i) {
+      x[t * kBatchSize * kStateSize + i] = base + t;
+    }
+  }
+  auto* initial = BlobGetMutableTensor(ws->CreateBlob("initial_output"), CPU);
+  initial->Resize(kBatchSize, kStateSize);
+  auto* h = initial->mutable_data<float>();
+  std::fill(h, h + initial->numel(), 1.0f);
+
+  ASSERT_TRUE(op->Run());
+
+  const auto& output = ws->GetBlob("output")->Get<Tensor>();
+  ASSERT_EQ(
+      output.sizes(),
+      (vector<int64_t>{kSeqLen + 1, kBatchSize, kStateSize}));
+  const auto* y = output.data<float>();
+  float expected = 1.0f;
+  for (int t = 0; t <= kSeqLen; ++t) {
+    for (int i = 0; i < kBatchSize * kStateSize; ++i) {
+      EXPECT_EQ(y[t * kBatchSize * kStateSize + i], expected)
+          << "base " << base << " timestep " << t;
+    }
+    expected += base + t;
+  }
+}
+
+} // namespace
+
+TEST(RecurrentNetworkTest, StepNetsReusedAcrossRuns) {
+  Workspace ws;
+  auto op = CreateRunningSumOp(&ws);
+  ASSERT_NE(op, nullptr);
+
+  RunAndCheck(op.get(), &ws, 1.0f);
+  auto* scratch =
+      ws.GetBlob("step_workspaces")->GetMutable<detail::ScratchWorkspaces>();
+  ASSERT_EQ(scratch->stepWorkspaces.size(), 2);
+  std::vector<NetBase*> nets;
+  for (const auto& stepWs : scratch->stepWorkspaces) {
+    ASSERT_EQ(stepWs->Nets().size(), 1);
+    nets.push_back(stepWs->GetNet("running_sum_step"));
+  }
+
+  // The same step nets run again, with the timesteps of the new run
+  RunAndCheck(op.get(), &ws, -2.0f);
+  for (size_t i = 0; i < nets.size(); ++i) {
+    const auto& stepWs = scratch->stepWorkspaces[i];
+    EXPECT_EQ(stepWs->Nets().size(), 1);
+    EXPECT_EQ(stepWs->GetNet("running_sum_step"), nets[i]);
+  }
+  // Timesteps alternate between the two workspaces
+  EXPECT_EQ(
+      scratch->stepWorkspaces[0]
+          ->GetBlob("timestep")
+          ->Get<Tensor>()
+          .data<int32_t>()[0],
+      kSeqLen - 1);
+}
+
+TEST(RecurrentNetworkTest, StepNetsRecreatedWithWorkspaces) {
+  Workspace ws;
+  auto op = CreateRunningSumOp(&ws);
+  ASSERT_NE(op, nullptr);
+  RunAndCheck(op.get(), &ws, 1.0f);
+
+  auto* scratch =
+      ws.GetBlob("step_workspaces")->GetMutable<detail::ScratchWorkspaces>();
+  for (int i = 0; i < 3; ++i) {
+    // Destroy a step workspace and replace it with an empty one, which
+    // usually gets the address of the destroyed one. The op must not run the
+    // step net of the destroyed workspace.
+    auto& stepWs = scratch->stepWorkspaces[i % 2];
+    stepWs.reset();
+    stepWs = std::make_shared<Workspace>(scratch->sharedBlobsWs.get());
+    ASSERT_EQ(stepWs->GetNet("running_sum_step"), nullptr);
+
+    RunAndCheck(op.get(), &ws, 2.0f + i);
+    EXPECT_NE(stepWs->GetNet("running_sum_step"), nullptr);
+  }
+
+  // Workspaces the op creates itself after they are all gone
+  scratch->stepWorkspaces.clear();
+  RunAndCheck(op.get(), &ws, 10.0f);
+  ASSERT_EQ(scratch->stepWorkspaces.size(), 2);
+  for (const auto& stepWs : scratch->stepWorkspaces) {
+    EXPECT_NE(stepWs->GetNet("running_sum_step"), nullptr);
+  }
+}
+
+} // namespace caffe2
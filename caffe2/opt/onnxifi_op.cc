@@ -2,10 +2,43 @@
 #include "caffe2/operators/slice_op.h"
 #include "caffe2/opt/bound_shape_inferencer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
 namespace caffe2 {
 
 namespace {
 
+// Scales the dimensions of a shape at max_batch_size that depend on the batch,
+// according to their dim_types, to batch_size.
+template <typename DimTypes, typename Dims>
+void rebatchDims(
+    const DimTypes& dim_types,
+    int max_batch_size,
+    int batch_size,
+    Dims* dims) {
+  for (int j = 0; j < dims->size() && j < dim_types.size(); ++j) {
+    switch (dim_types.Get(j)) {
+      case TensorBoundShape_DimType_BATCH:
+        dims->Set(j, batch_size);
+        break;
+      case TensorBoundShape_DimType_BATCH_OF_FEATURE_MAX:
+      case TensorBoundShape_DimType_BATCH_OF_FEATURE_MAX_DEFAULT:
+        dims->Set(j, dims->Get(j) / max_batch_size * batch_size);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+template <typename DimTypes>
+bool isBatched(const DimTypes& dim_types) {
+  return dim_types.size() &&
+      dim_types.Get(0) == TensorBoundShape_DimType_BATCH;
+}
+
 void setInputTensorDescriptorTypeAndBuffer(
     const Tensor& cpu_tensor,
     onnxTensorDescriptorV1* desc) {
@@ -297,13 +330,160 @@ details::OutputReshapeInfo OnnxifiOp<CPUContext>::initOutputReshapeInfo()
 }
 
 template <>
-int OnnxifiOp<CPUContext>::extractOutputBatchSizes() {
+void OnnxifiOp<CPUContext>::buildBatchBuckets(
+    Workspace* ws,
+    const std::vector<uint64_t>& property_pointers,
+    const std::vector<int>& batch_sizes,
+    const std::vector<TensorProto>& output_shape_info,
+    const std::vector<QTensorProto>& output_qshape_info) {
+  CAFFE_ENFORCE(!use_onnx_, "batch_buckets needs a Caffe2 model");
+  CAFFE_ENFORCE(adjust_output_batch_, "batch_buckets needs adjust_output_batch");
+  CAFFE_ENFORCE_GT(max_batch_size_, 0, "batch_buckets needs max_batch_size");
+
+  // Find out which inputs to pad from the input shapes the model was built
+  // with
+  std::unordered_set<std::string> batched_inputs;
+  for (const auto& arg : netdef_.arg()) {
+    if (arg.name() == "input_shape_info") {
+      for (const auto& t : arg.tensors()) {
+        if (isBatched(t.int32_data())) {
+          batched_inputs.emplace(t.name());
+        }
+      }
+    } else if (arg.name() == "input_qshape_info") {
+      for (const auto& t : arg.qtensors()) {
+        if (isBatched(t.data())) {
+          batched_inputs.emplace(t.name());
+        }
+      }
+    }
+  }
+  for (int i = 0; i < input_names_.size(); ++i) {
+    batched_inputs_.push_back(batched_inputs.count(input_names_[i]) > 0);
+    padded_inputs_.emplace_back(CPU);
+  }
+  CAFFE_ENFORCE(
+      batched_inputs_[nominal_batch_idx_],
+      "The batch of ",
+      input_names_[nominal_batch_idx_],
+      " is unknown, cannot pad the inputs to batch_buckets");
+
+  std::unordered_map<std::string, const TensorProto*> output_shapes;
+  for (const auto& t : output_shape_info) {
+    output_shapes.emplace(t.name(), &t);
+  }
+  std::unordered_map<std::string, const QTensorProto*> output_qshapes;
+  for (const auto& t : output_qshape_info) {
+    output_qshapes.emplace(t.name(), &t);
+  }
+
+  auto sizes = batch_sizes;
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  std::vector<std::string> bucket_names;
+  for (const auto batch_size : sizes) {
+    CAFFE_ENFORCE_GT(batch_size, 0);
+    CAFFE_ENFORCE_LE(
+        batch_size,
+        max_batch_size_,
+        "Batch bucket larger than max_batch_size: ",
+        batch_size);
+    if (batch_size == max_batch_size_) {
+      continue;
+    }
+
+    NetDef net(netdef_);
+    for (auto& arg : *net.mutable_arg()) {
+      if (arg.name() == "input_shape_info") {
+        for (auto& t : *arg.mutable_tensors()) {
+          rebatchDims(
+              t.int32_data(), max_batch_size_, batch_size, t.mutable_dims());
+        }
+      } else if (arg.name() == "input_qshape_info") {
+        for (auto& t : *arg.mutable_qtensors()) {
+          rebatchDims(t.data(), max_batch_size_, batch_size, t.mutable_dims());
+        }
+      }
+    }
+    std::string model_str;
+    CAFFE_ENFORCE(net.SerializeToString(&model_str));
+
+    details::BatchBucket bucket;
+    bucket.batch_size = batch_size;
+    bucket.key = op_id_string_ + ":batch" + c10::to_string(batch_size);
+    bucket.backend_graph =
+        buildBackendGraph(ws, property_pointers, bucket.key, model_str);
+    for (const auto& kv : output_shape_hints_) {
+      const auto& name = output_names_[kv.first];
+      if (!kv.second.quantized) {
+        TensorProto t(*output_shapes.at(name));
+        rebatchDims(
+            t.int32_data(), max_batch_size_, batch_size, t.mutable_dims());
+        bucket.output_shape_hints.emplace(kv.first, details::TensorInfo(t));
+      } else {
+        QTensorProto t(*output_qshapes.at(name));
+        rebatchDims(t.data(), max_batch_size_, batch_size, t.mutable_dims());
+        bucket.output_shape_hints.emplace(kv.first, details::TensorInfo(t));
+      }
+    }
+    batch_buckets_.push_back(std::move(bucket));
+    bucket_names.push_back(c10::to_string(batch_size));
+  }
+  bucket_names.push_back(c10::to_string(max_batch_size_));
+
+  batch_bucket_stats_ =
+      caffe2::make_unique<details::BatchBucketStats>("onnxifi:" + op_id_string_);
+  batch_bucket_stats_->bucket_runs.setDetails(bucket_names);
+}
+
+template <>
+const details::BatchBucket* OnnxifiOp<CPUContext>::findBatchBucket(
+    int current_batch_size) const {
+  for (const auto& bucket : batch_buckets_) {
+    if (current_batch_size <= bucket.batch_size) {
+      return &bucket;
+    }
+  }
+  return nullptr;
+}
+
+template <>
+const Tensor& OnnxifiOp<CPUContext>::padInputBatch(
+    int input_idx,
+    int batch_size) {
+  const auto& input = Input(input_idx);
+  CAFFE_ENFORCE_GE(input.dim(), 1, input_names_[input_idx], " has 0 dim");
+  if (input.size(0) == batch_size) {
+    return input;
+  }
+  CAFFE_ENFORCE_LT(
+      input.size(0),
+      batch_size,
+      "Batch of ",
+      input_names_[input_idx],
+      " is larger than the batch of ",
+      input_names_[nominal_batch_idx_]);
+  auto dims = input.sizes().vec();
+  dims[0] = batch_size;
+  auto& padded = padded_inputs_[input_idx];
+  padded.Resize(dims);
+  auto* dst = static_cast<char*>(padded.raw_mutable_data(input.dtype()));
+  const size_t nbytes = input.nbytes();
+  if (nbytes) {
+    std::memcpy(dst, input.raw_data(), nbytes);
+  }
+  std::memset(dst + nbytes, 0, padded.nbytes() - nbytes);
+  return padded;
+}
+
+template <>
+int OnnxifiOp<CPUContext>::extractOutputBatchSizes(int graph_batch_size) {
   if (use_onnx_ || !adjust_output_batch_) {
-    return max_batch_size_;
+    return graph_batch_size;
   }
 
   // Get the real batch size from nominal input. If it's equal to
-  // max_batch_size, mark that we don't need to adjust batch size and return.
+  // graph_batch_size, mark that we don't need to adjust batch size and return.
   // Otherwise, do a pass of shape inference to get the real shapes of the
   // outputs.
   const auto& t = Input(nominal_batch_idx_);
@@ -312,8 +492,8 @@ int OnnxifiOp<CPUContext>::extractOutputBatchSizes() {
   const auto dims = t.sizes();
   const int current_batch_size = dims[0];
 
-  if (current_batch_size == max_batch_size_) {
-    return max_batch_size_;
+  if (current_batch_size == graph_batch_size) {
+    return graph_batch_size;
   }
 
   // We still need to adjust output size but we can skip the shape inference as
@@ -413,13 +593,15 @@ void OnnxifiOp<CPUContext>::adjustOutputBatchSizes(int current_batch_size) {
 }
 
 template <>
-void OnnxifiOp<CPUContext>::setOutputShapeAndType(int output_idx) {
+void OnnxifiOp<CPUContext>::setOutputShapeAndType(
+    int output_idx,
+    const std::unordered_map<int, details::TensorInfo>& output_shape_hints) {
   tensor_dims_int64_.clear();
   std::vector<size_t> tensor_dims;
   uint64_t type = ONNXIFI_DATATYPE_FLOAT32;
-  const auto it = output_shape_hints_.find(output_idx);
+  const auto it = output_shape_hints.find(output_idx);
   CAFFE_ENFORCE(
-      it != output_shape_hints_.end(),
+      it != output_shape_hints.end(),
       "Cannot find shape hint for output: ",
       output_names_[output_idx]);
   const auto& info = it->second;
@@ -471,9 +653,33 @@ void OnnxifiOp<CPUContext>::setOutputShapeAndType(int output_idx) {
 
 template <>
 bool OnnxifiOp<CPUContext>::RunOnDevice() {
+  // Run the graph of the smallest batch bucket the inputs fit in, if any
+  const details::BatchBucket* bucket = nullptr;
+  if (!batch_buckets_.empty()) {
+    const auto& t = Input(nominal_batch_idx_);
+    CAFFE_ENFORCE(
+        !t.sizes().empty(),
+        input_names_[nominal_batch_idx_],
+        " cannot be empty");
+    const int rows = t.size(0);
+    bucket = findBatchBucket(rows);
+    const int bucket_idx = bucket ? bucket - batch_buckets_.data()
+                                  : batch_buckets_.size();
+    const int bucket_size = bucket ? bucket->batch_size : max_batch_size_;
+    auto& stats = *batch_bucket_stats_;
+    CAFFE_EVENT(stats, bucket_runs, 1, bucket_idx);
+    CAFFE_EVENT(stats, rows, rows);
+    CAFFE_EVENT(stats, padded_rows, std::max(bucket_size - rows, 0));
+  }
+  onnxBackend backend = bucket ? bucket->backend_graph->backend : backend_;
+  onnxGraph graph = bucket ? bucket->backend_graph->graph : graph_;
+  const int graph_batch_size = bucket ? bucket->batch_size : max_batch_size_;
+
   CAFFE_ENFORCE_EQ(input_desc_.size(), InputSize());
   for (unsigned i = 0U; i < InputSize(); ++i) {
-    const auto& input_tensor = Input(i);
+    const auto& input_tensor = bucket && batched_inputs_[i]
+        ? padInputBatch(i, bucket->batch_size)
+        : Input(i);
     const at::IntArrayRef tensor_dims = input_tensor.sizes();
     auto& tensor_descriptor = input_desc_[i];
     tensor_descriptor.tag = ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1;
@@ -489,13 +695,14 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
 
   CAFFE_ENFORCE_EQ(output_desc_.size(), OutputSize());
   for (unsigned i = 0U; i < OutputSize(); ++i) {
-    setOutputShapeAndType(i);
+    setOutputShapeAndType(
+        i, bucket ? bucket->output_shape_hints : output_shape_hints_);
   }
   bool ext_supported = false;
   onnxMemoryFenceV1 input_fence;
   onnxMemoryFenceV1 output_fence;
   std::vector<int> output_batch_sizes;
-  int current_batch_size = max_batch_size_;
+  int current_batch_size = graph_batch_size;
 #ifdef ONNXIFI_ENABLE_EXT
   /**
    * If onnxifi extension mode is enabled,
@@ -521,7 +728,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     }
     CAFFE_ENFORCE_EQ(
         (*onnxSetIOAndRunGraphPointer_)(
-            graph_,
+            graph,
             input_desc_.size(),
             input_desc_.data(),
             output_desc_.size(),
@@ -529,7 +736,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
             &output_fence,
             traces_.get()),
         ONNXIFI_STATUS_SUCCESS);
-    current_batch_size = extractOutputBatchSizes();
+    current_batch_size = extractOutputBatchSizes(graph_batch_size);
     onnxEventState eventState;
     onnxStatus eventStatus;
     CAFFE_ENFORCE_EQ(
@@ -550,7 +757,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
   if (!ext_supported) {
     CAFFE_ENFORCE_EQ(
         lib_->onnxSetGraphIO(
-            graph_,
+            graph,
             input_desc_.size(),
             input_desc_.data(),
             output_desc_.size(),
@@ -560,7 +767,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     input_fence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
     input_fence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
     CAFFE_ENFORCE_EQ(
-        lib_->onnxInitEvent(backend_, &input_fence.event),
+        lib_->onnxInitEvent(backend, &input_fence.event),
         ONNXIFI_STATUS_SUCCESS);
     output_fence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
     output_fence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
@@ -568,11 +775,11 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     // Call the async run on backend, signal event on input fence and wait for
     // the event on output fence
     CAFFE_ENFORCE_EQ(
-        lib_->onnxRunGraph(graph_, &input_fence, &output_fence),
+        lib_->onnxRunGraph(graph, &input_fence, &output_fence),
         ONNXIFI_STATUS_SUCCESS);
     CAFFE_ENFORCE_EQ(
         lib_->onnxSignalEvent(input_fence.event), ONNXIFI_STATUS_SUCCESS);
-    current_batch_size = extractOutputBatchSizes();
+    current_batch_size = extractOutputBatchSizes(graph_batch_size);
     CAFFE_ENFORCE_EQ(
         lib_->onnxWaitEvent(output_fence.event), ONNXIFI_STATUS_SUCCESS);
 
@@ -593,7 +800,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     }
   }
 
-  if (adjust_output_batch_ && current_batch_size != max_batch_size_) {
+  if (adjust_output_batch_ && current_batch_size != graph_batch_size) {
     adjustOutputBatchSizes(current_batch_size);
   }
   enable_tracing_ = false;
@@ -615,5 +822,8 @@ OPERATOR_SCHEMA(Onnxifi)
         "Initialization pair indicating the mapping of the name between NetDef and ONNX model")
     .Arg(
         "output_resize_hints",
-        "A list of key/value pairs indicating which input index to look up for real batch size for the given max output batch size");
+        "A list of key/value pairs indicating which input index to look up for real batch size for the given max output batch size")
+    .Arg(
+        "batch_buckets",
+        "(list of ints) Batch sizes below max_batch_size to compile a graph for. Each batch runs on the graph of the smallest bucket it fits in, with the batched inputs zero padded to the bucket and the outputs sliced back. Needs a Caffe2 model and adjust_output_batch");
 } // namespace caffe2
@@ -8,6 +8,7 @@
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
 #include "caffe2/onnx/onnxifi_graph_info.h"
 #include "caffe2/onnx/onnxifi_init.h"
 #include "caffe2/opt/shape_info.h"
@@ -38,6 +39,23 @@ struct TensorInfo {
   TensorInfo(TensorInfo&&) = default;
   TensorInfo& operator=(TensorInfo&&) = default;
 };
+
+/// A graph compiled for a batch size below max_batch_size. Inputs whose first
+/// dimension is the batch are padded to batch_size before running it.
+struct BatchBucket {
+  int batch_size;
+  std::string key;
+  onnx::SharedPtrBackendGraphInfo backend_graph;
+  std::unordered_map<int, TensorInfo> output_shape_hints;
+};
+
+struct BatchBucketStats {
+  CAFFE_STAT_CTOR(BatchBucketStats);
+  // Runs by bucket, the last one being the graph at max_batch_size
+  CAFFE_DETAILED_EXPORTED_STAT(bucket_runs);
+  CAFFE_EXPORTED_STAT(rows);
+  CAFFE_EXPORTED_STAT(padded_rows);
+};
 } // namespace details
 
 template <typename Context>
@@ -138,9 +156,26 @@ class OnnxifiOp final : public Operator<Context> {
     // cached backend and therefore there is no need to repeat the above
     // process.
     buildBackendAndGraph(ws, property_pointers, onnx_model_str);
+
+    // Compile a graph for every batch bucket below max_batch_size, so that
+    // smaller batches run on a graph that is closer to their size.
+    const auto batch_buckets =
+        this->template GetRepeatedArgument<int>("batch_buckets");
+    if (!batch_buckets.empty()) {
+      buildBatchBuckets(
+          ws,
+          property_pointers,
+          batch_buckets,
+          output_shape_info,
+          output_qshape_info);
+    }
   }
 
   ~OnnxifiOp() {
+    for (auto& bucket : batch_buckets_) {
+      bucket.backend_graph.reset();
+      backend_graph_map_ptr_->remove(bucket.key);
+    }
     backend_graph_shared_ptr_.reset();
     backend_graph_map_ptr_->remove(op_id_string_);
 #ifdef ONNXIFI_ENABLE_EXT
@@ -160,7 +195,9 @@ class OnnxifiOp final : public Operator<Context> {
   }
 #endif
  private:
-  void setOutputShapeAndType(int output_idx);
+  void setOutputShapeAndType(
+      int output_idx,
+      const std::unordered_map<int, details::TensorInfo>& output_shape_hints);
 
   void buildPropertyList(
       const OperatorDef& /* unused */,
@@ -178,6 +215,24 @@ class OnnxifiOp final : public Operator<Context> {
         this->template GetSingleArgument<std::string>("model_id", "") + ":" +
         this->template GetSingleArgument<std::string>("net_pos", "");
 
+    backend_graph_shared_ptr_ =
+        buildBackendGraph(ws, property_pointers, op_id_string_, onnx_model_str);
+
+    backend_id_ = backend_graph_shared_ptr_->backend_id;
+    backend_ = backend_graph_shared_ptr_->backend;
+    graph_ = backend_graph_shared_ptr_->graph;
+    input_shape_info_ = backend_graph_shared_ptr_->weight_shape_info;
+
+    getExtFunctionPointers();
+  }
+
+  /// Returns the backend and graph of the model cached under key, creating
+  /// them if they haven't been already.
+  onnx::SharedPtrBackendGraphInfo buildBackendGraph(
+      Workspace* ws,
+      const std::vector<uint64_t>& property_pointers,
+      const std::string& key,
+      const std::string& onnx_model_str) {
     auto initializers =
         this->template GetRepeatedArgument<std::string>("initializers");
     // Build the Onnxifi engine
@@ -268,16 +323,25 @@ class OnnxifiOp final : public Operator<Context> {
       return std::make_shared<onnx::BackendGraphInfo>(
           backend_id, backend, graph, lib_, std::move(weight_shape_info));
     };
-    backend_graph_shared_ptr_ =
-        backend_graph_map_ptr_->insert(op_id_string_, creator);
+    return backend_graph_map_ptr_->insert(key, creator);
+  }
 
-    backend_id_ = backend_graph_shared_ptr_->backend_id;
-    backend_ = backend_graph_shared_ptr_->backend;
-    graph_ = backend_graph_shared_ptr_->graph;
-    input_shape_info_ = backend_graph_shared_ptr_->weight_shape_info;
+  /// Builds the graphs of batch_buckets_ from the Caffe2 model, with the
+  /// batch dimensions of its inputs and outputs scaled down to every bucket.
+  void buildBatchBuckets(
+      Workspace* ws,
+      const std::vector<uint64_t>& property_pointers,
+      const std::vector<int>& batch_sizes,
+      const std::vector<TensorProto>& output_shape_info,
+      const std::vector<QTensorProto>& output_qshape_info);
 
-    getExtFunctionPointers();
-  }
+  /// Returns the smallest bucket the current batch fits in, or nullptr if it
+  /// only fits in the graph at max_batch_size.
+  const details::BatchBucket* findBatchBucket(int current_batch_size) const;
+
+  /// Returns input input_idx with its first dimension zero padded to
+  /// batch_size.
+  const Tensor& padInputBatch(int input_idx, int batch_size);
 
   /// Set up function pointer if onnxifi_ext is enabled
   void getExtFunctionPointers() {
@@ -313,9 +377,10 @@ class OnnxifiOp final : public Operator<Context> {
   }
 
   /// Extract output batch size. If the output batch size is going to be at
-  /// max_batch_size_, return true indicating that no output shape adjustment is
-  /// needed. Otherwise, return false.
-  int extractOutputBatchSizes();
+  /// graph_batch_size, the batch size the graph run was compiled for, return
+  /// it, indicating that no output shape adjustment is needed. Otherwise,
+  /// return the real batch size.
+  int extractOutputBatchSizes(int graph_batch_size);
 
   /// Adjust output tensor shape based on the current input batch size.
   /// If the output shape is conditioned on first dim (batch size), we have a
@@ -431,6 +496,18 @@ class OnnxifiOp final : public Operator<Context> {
 
   // Adjust the quantized offset to compensate mismatch of certain backend
   uint8_t adjust_quantized_offset_{0};
+
+  // Graphs compiled for batch sizes below max_batch_size, in increasing order
+  // of batch size
+  std::vector<details::BatchBucket> batch_buckets_;
+
+  // Whether the first dimension of i-th input is the batch
+  std::vector<bool> batched_inputs_;
+
+  // Inputs padded to the batch size of a bucket
+  std::vector<Tensor> padded_inputs_;
+
+  std::unique_ptr<details::BatchBucketStats> batch_bucket_stats_;
 };
 
 } // namespace caffe2
@@ -770,6 +770,9 @@ OperatorDef OnnxifiTransformer::buildOnnxifiOp(
   AddArgument("max_seq_size", opts_.bound_shape_spec.max_seq_size, &op);
   AddArgument("timeout", opts_.timeout, &op);
   AddArgument("nominal_batch_idx", nominal_batch_idx, &op);
+  if (!opts_.use_onnx && !opts_.batch_buckets.empty()) {
+    AddArgument("batch_buckets", opts_.batch_buckets, &op);
+  }
 
   return op;
 }
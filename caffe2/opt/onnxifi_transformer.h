@@ -44,6 +44,10 @@ struct OnnxifiTransformerOptions final : public BackendTransformOptions {
 
   // Inference timeout
   int timeout{0};
+
+  // Batch sizes below max_batch_size to compile extra graphs for, with inputs
+  // padded to the nearest one. Only used with c2 models.
+  std::vector<int> batch_buckets;
 };
 
 class CAFFE2_API OnnxifiTransformer final : public BackendTransformerBase {
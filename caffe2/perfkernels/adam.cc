@@ -0,0 +1,49 @@
+#include "caffe2/perfkernels/adam.h"
+
+#include <cmath>
+
+#include "caffe2/perfkernels/common.h"
+
+namespace caffe2 {
+
+void adam_update__base(
+    int N,
+    const float* w,
+    const float* g,
+    const float* m,
+    const float* v,
+    float* nw,
+    float* nm,
+    float* nv,
+    float beta1,
+    float beta2,
+    float eps_hat,
+    float lr) {
+  for (auto i = 0; i < N; ++i) {
+    float gi = g[i];
+    float mi = nm[i] = m[i] * beta1 + gi * (1 - beta1);
+    float vi = nv[i] = v[i] * beta2 + gi * gi * (1 - beta2);
+    nw[i] = w[i] + lr * mi / (std::sqrt(vi) + eps_hat);
+  }
+}
+
+decltype(adam_update__base) adam_update__avx2_fma;
+void adam_update(
+    int N,
+    const float* w,
+    const float* g,
+    const float* m,
+    const float* v,
+    float* nw,
+    float* nm,
+    float* nv,
+    float beta1,
+    float beta2,
+    float eps_hat,
+    float lr) {
+  AVX2_FMA_DO(
+      adam_update, N, w, g, m, v, nw, nm, nv, beta1, beta2, eps_hat, lr);
+  BASE_DO(adam_update, N, w, g, m, v, nw, nm, nv, beta1, beta2, eps_hat, lr);
+}
+
+} // namespace caffe2
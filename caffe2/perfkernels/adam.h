@@ -0,0 +1,26 @@
+#pragma once
+
+namespace caffe2 {
+
+// Adam update of one row, as done by sparse (lazy) Adam: only the moments of
+// the rows that have a gradient are decayed.
+//   nm = beta1 * m + (1 - beta1) * g
+//   nv = beta2 * v + (1 - beta2) * g * g
+//   nw = w + lr * nm / (sqrt(nv) + eps_hat)
+// lr is expected to include the bias correction, and to be negative to
+// descend.
+void adam_update(
+    int N,
+    const float* w,
+    const float* g,
+    const float* m,
+    const float* v,
+    float* nw,
+    float* nm,
+    float* nv,
+    float beta1,
+    float beta2,
+    float eps_hat,
+    float lr);
+
+} // namespace caffe2
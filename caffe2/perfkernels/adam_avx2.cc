@@ -0,0 +1,53 @@
+#include "caffe2/perfkernels/adam.h"
+
+#include <cmath>
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+void adam_update__avx2_fma(
+    int N,
+    const float* w,
+    const float* g,
+    const float* m,
+    const float* v,
+    float* nw,
+    float* nm,
+    float* nv,
+    float beta1,
+    float beta2,
+    float eps_hat,
+    float lr) {
+  constexpr int kSize = 8;
+  const __m256 vbeta1 = _mm256_set1_ps(beta1);
+  const __m256 vbeta1c = _mm256_set1_ps(1 - beta1);
+  const __m256 vbeta2 = _mm256_set1_ps(beta2);
+  const __m256 vbeta2c = _mm256_set1_ps(1 - beta2);
+  const __m256 veps = _mm256_set1_ps(eps_hat);
+  const __m256 vlr = _mm256_set1_ps(lr);
+  auto i = 0;
+  for (; i + kSize <= N; i += kSize) {
+    __m256 gi = _mm256_loadu_ps(g + i);
+    __m256 mi = _mm256_fmadd_ps(
+        vbeta1c, gi, _mm256_mul_ps(vbeta1, _mm256_loadu_ps(m + i)));
+    __m256 vi = _mm256_fmadd_ps(
+        vbeta2c,
+        _mm256_mul_ps(gi, gi),
+        _mm256_mul_ps(vbeta2, _mm256_loadu_ps(v + i)));
+    _mm256_storeu_ps(nm + i, mi);
+    _mm256_storeu_ps(nv + i, vi);
+    __m256 vtmp = _mm256_div_ps(
+        _mm256_mul_ps(vlr, mi), _mm256_add_ps(_mm256_sqrt_ps(vi), veps));
+    _mm256_storeu_ps(nw + i, _mm256_add_ps(_mm256_loadu_ps(w + i), vtmp));
+  }
+
+  for (; i < N; ++i) {
+    float gi = g[i];
+    float mi = nm[i] = m[i] * beta1 + gi * (1 - beta1);
+    float vi = nv[i] = v[i] * beta2 + gi * gi * (1 - beta2);
+    nw[i] = w[i] + lr * mi / (std::sqrt(vi) + eps_hat);
+  }
+}
+
+} // namespace caffe2
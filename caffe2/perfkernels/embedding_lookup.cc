@@ -1,10 +1,35 @@
 #include "caffe2/perfkernels/embedding_lookup.h"
 
+#include <c10/util/Flags.h>
 #include "caffe2/core/types.h"
 #include "caffe2/perfkernels/common.h"
 
+C10_DEFINE_int64(
+    caffe2_embedding_lookup_prefetch_distance,
+    0,
+    "If positive, number of indices ahead whose rows the embedding lookup "
+    "kernels prefetch. Otherwise it is picked from the size of the table.");
+C10_DEFINE_int64(
+    caffe2_embedding_lookup_large_table_mb,
+    32,
+    "Size in MB above which embedding tables are assumed not to fit in the "
+    "last level cache, and are prefetched further ahead.");
+
 namespace caffe2 {
 
+int64_t EmbeddingLookupPrefetchDistance(int64_t data_size, int64_t row_bytes) {
+  if (FLAGS_caffe2_embedding_lookup_prefetch_distance > 0) {
+    return FLAGS_caffe2_embedding_lookup_prefetch_distance;
+  }
+  if (data_size * row_bytes <=
+      (FLAGS_caffe2_embedding_lookup_large_table_mb << 20)) {
+    return 16;
+  }
+  // Rows of at most a few cache lines take less time to accumulate, so more of
+  // them are needed to cover the latency of a DRAM (or TLB) miss
+  return row_bytes <= 256 ? 64 : 32;
+}
+
 /**
  * Base implementation does runtime dispatch for each segment of reduction
  * @return false if there is an out-of-bound error
@@ -105,6 +130,9 @@ static bool EmbeddingLookupGenericSlow(
   decltype(                                                                                        \
       EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL##__base)     \
       EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL##__avx2_fma; \
+  decltype(                                                                                        \
+      EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL##__base)     \
+      EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL##__avx512;   \
   bool                                                                                             \
       EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL(             \
           const int64_t block_size,                                                                \
@@ -123,6 +151,19 @@ static bool EmbeddingLookupGenericSlow(
     } else {                                                                                       \
       CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");                          \
     }                                                                                              \
+    AVX512_DO(                                                                                     \
+        EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL,           \
+        block_size,                                                                                \
+        output_size,                                                                               \
+        index_size,                                                                                \
+        data_size,                                                                                 \
+        input,                                                                                     \
+        indices,                                                                                   \
+        lengths,                                                                                   \
+        weights,                                                                                   \
+        scale_bias,                                                                                \
+        normalize_by_lengths,                                                                      \
+        out);                                                                                      \
     AVX2_FMA_DO(                                                                                   \
         EmbeddingLookup_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL,           \
         block_size,                                                                                \
@@ -50,4 +50,18 @@ void EmbeddingLookup(
     bool normalize_by_lengths,
     OutType* out);
 
+/**
+ * Number of indices ahead of the current one whose rows the vectorized
+ * embedding lookup kernels prefetch, for a table of data_size rows of
+ * row_bytes bytes each.
+ *
+ * Tables that fit in the last level cache use a short distance. Larger tables
+ * are bound by memory latency and keep more rows in flight, the more so the
+ * shorter their rows are. --caffe2_embedding_lookup_prefetch_distance
+ * overrides the distance for all tables.
+ */
+std::int64_t EmbeddingLookupPrefetchDistance(
+    std::int64_t data_size,
+    std::int64_t row_bytes);
+
 } // namespace caffe2
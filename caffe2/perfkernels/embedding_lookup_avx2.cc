@@ -7,6 +7,7 @@
 
 #include <c10/util/Half.h>
 #include <immintrin.h>
+#include "caffe2/perfkernels/embedding_lookup.h"
 namespace caffe2 {
 
 template <bool IS_WEIGHT_POSITIONAL>
@@ -22,8 +23,9 @@ static bool EmbeddingLookup_int32_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 0;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(float));
   int dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -449,8 +451,9 @@ static bool EmbeddingLookup_int64_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(float));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -876,8 +879,9 @@ static bool EmbeddingLookup_int32_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 0;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(at::Half));
   int dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1423,8 +1427,9 @@ static bool EmbeddingLookup_int64_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(at::Half));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1970,8 +1975,9 @@ static bool EmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 0;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(uint8_t));
   int dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -2530,8 +2536,9 @@ static bool EmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(uint8_t));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
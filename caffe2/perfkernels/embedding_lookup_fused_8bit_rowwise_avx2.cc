@@ -7,6 +7,7 @@
 
 #include <c10/util/Half.h>
 #include <immintrin.h>
+#include "caffe2/perfkernels/embedding_lookup.h"
 namespace caffe2 {
 
 template <bool IS_WEIGHT_POSITIONAL>
@@ -21,8 +22,9 @@ static bool Fused8BitRowwiseEmbeddingLookup_int32_t_float_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 2;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(float));
   int dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -443,8 +445,9 @@ static bool Fused8BitRowwiseEmbeddingLookup_int64_t_float_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 2;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(float));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -865,8 +868,9 @@ static bool Fused8BitRowwiseEmbeddingLookup_int32_t_half_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 4;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(at::Half));
   int dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1407,8 +1411,9 @@ static bool Fused8BitRowwiseEmbeddingLookup_int64_t_half_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 4;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(at::Half));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1949,8 +1954,9 @@ static bool Fused8BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 8;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(uint8_t));
   int dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -2514,8 +2520,9 @@ static bool Fused8BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 8;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(uint8_t));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
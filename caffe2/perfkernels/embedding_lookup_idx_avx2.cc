@@ -7,6 +7,7 @@
 
 #include <c10/util/Half.h>
 #include <immintrin.h>
+#include "caffe2/perfkernels/embedding_lookup.h"
 namespace caffe2 {
 
 template <bool IS_WEIGHT_POSITIONAL>
@@ -22,8 +23,9 @@ static bool EmbeddingLookupIdx_int32_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 0;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(float));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -459,8 +461,9 @@ static bool EmbeddingLookupIdx_int64_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(float));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -896,8 +899,9 @@ static bool EmbeddingLookupIdx_int32_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 0;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(at::Half));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1453,8 +1457,9 @@ static bool EmbeddingLookupIdx_int64_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(at::Half));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -2010,8 +2015,9 @@ static bool EmbeddingLookupIdx_int32_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int prefdist_T0 = 16;
   const int fused_block_size = block_size + 0;
+  const int prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(uint8_t));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
@@ -2580,8 +2586,9 @@ static bool EmbeddingLookupIdx_int64_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
   const int64_t fused_block_size = block_size + 0;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance(
+      data_size, fused_block_size * sizeof(uint8_t));
   int64_t dataInd = 0;
   if (block_size == 128) {
     // unrolling 16 times
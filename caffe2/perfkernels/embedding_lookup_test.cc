@@ -0,0 +1,319 @@
+#include <gtest/gtest.h>
+
+#include <c10/util/Half.h>
+#include "caffe2/utils/cpuid.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace caffe2 {
+
+// The base and AVX512 variants of the embedding lookup kernels, as declared
+// by the dispatching functions in embedding_lookup.cc and friends.
+#define DECLARE_EMBEDDING_LOOKUP(NAME, IndexType, InTypeName, InType, POS) \
+  bool NAME##_##IndexType##_##InTypeName##_float_##POS##__base(            \
+      const int64_t block_size,                                            \
+      const int64_t output_size,                                           \
+      const int64_t index_size,                                            \
+      const int64_t data_size,                                             \
+      const InType* input,                                                 \
+      const IndexType* indices,                                            \
+      const int* lengths,                                                  \
+      const float* weights,                                                \
+      const float* scale_bias,                                             \
+      bool normalize_by_lengths,                                           \
+      float* out);                                                         \
+  decltype(NAME##_##IndexType##_##InTypeName##_float_##POS##__base)        \
+      NAME##_##IndexType##_##InTypeName##_float_##POS##__avx512;
+
+#define DECLARE_EMBEDDING_LOOKUP_IDX(NAME, IndexType, InTypeName, InType, POS) \
+  bool NAME##_##IndexType##_##InTypeName##_float_##POS##__base(                \
+      const int64_t block_size,                                                \
+      const int64_t output_size,                                               \
+      const int64_t index_size,                                                \
+      const int64_t data_size,                                                 \
+      const InType* input,                                                     \
+      const IndexType* indices,                                                \
+      const int64_t* offsets,                                                  \
+      const float* weights,                                                    \
+      const float* scale_bias,                                                 \
+      bool normalize_by_lengths,                                               \
+      float* out);                                                             \
+  decltype(NAME##_##IndexType##_##InTypeName##_float_##POS##__base)            \
+      NAME##_##IndexType##_##InTypeName##_float_##POS##__avx512;
+
+#define DECLARE_FUSED_EMBEDDING_LOOKUP(NAME, IndexType, Segments) \
+  bool NAME##_##IndexType##_uint8_t_float_false__base(            \
+      const int64_t block_size,                                   \
+      const int64_t output_size,                                  \
+      const int64_t index_size,                                   \
+      const int64_t data_size,                                    \
+      const uint8_t* input,                                       \
+      const IndexType* indices,                                   \
+      Segments,                                                   \
+      const float* weights,                                       \
+      bool normalize_by_lengths,                                  \
+      float* out);                                                \
+  decltype(NAME##_##IndexType##_uint8_t_float_false__base)        \
+      NAME##_##IndexType##_uint8_t_float_false__avx512;
+
+#define DECLARE_ALL_VARIANTS(DECLARE, NAME)        \
+  DECLARE(NAME, int32_t, float, float, false)      \
+  DECLARE(NAME, int64_t, float, float, false)      \
+  DECLARE(NAME, int32_t, half, at::Half, false)    \
+  DECLARE(NAME, int64_t, half, at::Half, false)    \
+  DECLARE(NAME, int32_t, uint8_t, uint8_t, false)  \
+  DECLARE(NAME, int64_t, uint8_t, uint8_t, false)  \
+  DECLARE(NAME, int32_t, float, float, true)       \
+  DECLARE(NAME, int64_t, float, float, true)       \
+  DECLARE(NAME, int32_t, half, at::Half, true)     \
+  DECLARE(NAME, int64_t, half, at::Half, true)     \
+  DECLARE(NAME, int32_t, uint8_t, uint8_t, true)   \
+  DECLARE(NAME, int64_t, uint8_t, uint8_t, true)
+
+DECLARE_ALL_VARIANTS(DECLARE_EMBEDDING_LOOKUP, EmbeddingLookup)
+DECLARE_ALL_VARIANTS(DECLARE_EMBEDDING_LOOKUP_IDX, EmbeddingLookupIdx)
+DECLARE_FUSED_EMBEDDING_LOOKUP(
+    Fused8BitRowwiseEmbeddingLookup,
+    int32_t,
+    const int* lengths)
+DECLARE_FUSED_EMBEDDING_LOOKUP(
+    Fused8BitRowwiseEmbeddingLookup,
+    int64_t,
+    const int* lengths)
+DECLARE_FUSED_EMBEDDING_LOOKUP(
+    Fused8BitRowwiseEmbeddingLookupIdx,
+    int32_t,
+    const int64_t* offsets)
+DECLARE_FUSED_EMBEDDING_LOOKUP(
+    Fused8BitRowwiseEmbeddingLookupIdx,
+    int64_t,
+    const int64_t* offsets)
+
+#undef DECLARE_ALL_VARIANTS
+#undef DECLARE_FUSED_EMBEDDING_LOOKUP
+#undef DECLARE_EMBEDDING_LOOKUP_IDX
+#undef DECLARE_EMBEDDING_LOOKUP
+
+namespace {
+
+bool HasAvx512() {
+  return GetCpuId().avx512f() && GetCpuId().avx512dq() &&
+      GetCpuId().avx512vl();
+}
+
+constexpr int64_t kDataSize = 100;
+// The block sizes the kernels have unrolled paths for, and others that go
+// through the generic path, with and without a remainder.
+const std::vector<int64_t> kBlockSizes = {128, 64, 32, 16, 48, 40, 7, 1};
+// Segments of varied lengths, including empty ones.
+const std::vector<int> kLengths = {3, 0, 1, 17, 0, 8};
+
+template <typename InType>
+InType Convert(float value) {
+  return static_cast<InType>(value);
+}
+
+template <>
+uint8_t Convert<uint8_t>(float value) {
+  return static_cast<uint8_t>(std::abs(value) * 40);
+}
+
+struct Inputs {
+  std::vector<int> lengths;
+  std::vector<int64_t> offsets;
+  std::vector<float> weights;
+  int64_t index_size = 0;
+};
+
+Inputs MakeInputs(std::mt19937& gen) {
+  Inputs inputs;
+  inputs.lengths = kLengths;
+  inputs.offsets.push_back(0);
+  for (int length : kLengths) {
+    inputs.index_size += length;
+    inputs.offsets.push_back(inputs.index_size);
+  }
+  std::uniform_real_distribution<float> dist(-2, 2);
+  // Positional weights are indexed by the position in the segment, others by
+  // the position in the indices; both fit in index_size.
+  for (int64_t i = 0; i < inputs.index_size; ++i) {
+    inputs.weights.push_back(dist(gen));
+  }
+  return inputs;
+}
+
+template <typename IndexType>
+std::vector<IndexType> MakeIndices(std::mt19937& gen, int64_t index_size) {
+  std::vector<IndexType> indices;
+  for (int64_t i = 0; i < index_size; ++i) {
+    indices.push_back(gen() % kDataSize);
+  }
+  return indices;
+}
+
+void ExpectNear(const std::vector<float>& expected, const std::vector<float>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(expected[i], actual[i], 1e-4 * (1 + std::abs(expected[i])))
+        << "at " << i;
+  }
+}
+
+// Compares `avx512` with `base` for every block size, with and without
+// weights and normalization, and checks that both reject an out of range
+// index. `segments` are the lengths or the offsets.
+template <typename IndexType, typename InType, typename Segments, typename Fn>
+void CompareWithBase(Fn base, Fn avx512, const Segments& segments) {
+  std::mt19937 gen(0);
+  const Inputs inputs = MakeInputs(gen);
+  const int64_t output_size = kLengths.size();
+  std::uniform_real_distribution<float> dist(-2, 2);
+  for (int64_t block_size : kBlockSizes) {
+    std::vector<InType> input;
+    for (int64_t i = 0; i < kDataSize * block_size; ++i) {
+      input.push_back(Convert<InType>(dist(gen)));
+    }
+    std::vector<float> scale_bias;
+    for (int64_t i = 0; i < 2 * kDataSize; ++i) {
+      scale_bias.push_back(dist(gen));
+    }
+    const float* scale_bias_ptr =
+        std::is_same<InType, uint8_t>::value ? scale_bias.data() : nullptr;
+    auto indices = MakeIndices<IndexType>(gen, inputs.index_size);
+
+    for (bool weighted : {false, true}) {
+      for (bool normalize : {false, true}) {
+        const float* weights = weighted ? inputs.weights.data() : nullptr;
+        std::vector<float> expected(output_size * block_size);
+        std::vector<float> actual(output_size * block_size);
+        ASSERT_TRUE(base(
+            block_size, output_size, inputs.index_size, kDataSize,
+            input.data(), indices.data(), segments.data(), weights,
+            scale_bias_ptr, normalize, expected.data()));
+        ASSERT_TRUE(avx512(
+            block_size, output_size, inputs.index_size, kDataSize,
+            input.data(), indices.data(), segments.data(), weights,
+            scale_bias_ptr, normalize, actual.data()));
+        ExpectNear(expected, actual);
+      }
+    }
+
+    auto bad_indices = indices;
+    bad_indices.back() = kDataSize;
+    std::vector<float> out(output_size * block_size);
+    EXPECT_FALSE(avx512(
+        block_size, output_size, inputs.index_size, kDataSize, input.data(),
+        bad_indices.data(), segments.data(), nullptr, scale_bias_ptr, false,
+        out.data()));
+  }
+}
+
+// Same for the fused 8-bit rowwise kernels, whose rows end with their float
+// scale and bias.
+template <typename IndexType, typename Segments, typename Fn>
+void CompareFusedWithBase(Fn base, Fn avx512, const Segments& segments) {
+  std::mt19937 gen(0);
+  const Inputs inputs = MakeInputs(gen);
+  const int64_t output_size = kLengths.size();
+  std::uniform_real_distribution<float> dist(-2, 2);
+  for (int64_t block_size : kBlockSizes) {
+    const int64_t row_size = block_size + 2 * sizeof(float);
+    std::vector<uint8_t> input(kDataSize * row_size);
+    for (int64_t r = 0; r < kDataSize; ++r) {
+      for (int64_t j = 0; j < block_size; ++j) {
+        input[r * row_size + j] = gen() % 256;
+      }
+      const float scale_bias[2] = {dist(gen) / 100, dist(gen)};
+      memcpy(&input[r * row_size + block_size], scale_bias, sizeof(scale_bias));
+    }
+    auto indices = MakeIndices<IndexType>(gen, inputs.index_size);
+
+    for (bool weighted : {false, true}) {
+      for (bool normalize : {false, true}) {
+        const float* weights = weighted ? inputs.weights.data() : nullptr;
+        std::vector<float> expected(output_size * block_size);
+        std::vector<float> actual(output_size * block_size);
+        ASSERT_TRUE(base(
+            block_size, output_size, inputs.index_size, kDataSize,
+            input.data(), indices.data(), segments.data(), weights, normalize,
+            expected.data()));
+        ASSERT_TRUE(avx512(
+            block_size, output_size, inputs.index_size, kDataSize,
+            input.data(), indices.data(), segments.data(), weights, normalize,
+            actual.data()));
+        ExpectNear(expected, actual);
+      }
+    }
+  }
+}
+
+} // namespace
+
+#define EXPECT_MATCHES_BASE(NAME, IndexType, InTypeName, InType, POS, SEGMENTS) \
+  CompareWithBase<IndexType, InType>(                                           \
+      NAME##_##IndexType##_##InTypeName##_float_##POS##__base,                  \
+      NAME##_##IndexType##_##InTypeName##_float_##POS##__avx512,                \
+      SEGMENTS)
+
+#define EXPECT_ALL_VARIANTS_MATCH_BASE(NAME, SEGMENTS)                          \
+  EXPECT_MATCHES_BASE(NAME, int32_t, float, float, false, SEGMENTS);            \
+  EXPECT_MATCHES_BASE(NAME, int64_t, float, float, false, SEGMENTS);            \
+  EXPECT_MATCHES_BASE(NAME, int32_t, half, at::Half, false, SEGMENTS);          \
+  EXPECT_MATCHES_BASE(NAME, int64_t, half, at::Half, false, SEGMENTS);          \
+  EXPECT_MATCHES_BASE(NAME, int32_t, uint8_t, uint8_t, false, SEGMENTS);        \
+  EXPECT_MATCHES_BASE(NAME, int64_t, uint8_t, uint8_t, false, SEGMENTS);        \
+  EXPECT_MATCHES_BASE(NAME, int32_t, float, float, true, SEGMENTS);             \
+  EXPECT_MATCHES_BASE(NAME, int64_t, float, float, true, SEGMENTS);             \
+  EXPECT_MATCHES_BASE(NAME, int32_t, half, at::Half, true, SEGMENTS);           \
+  EXPECT_MATCHES_BASE(NAME, int64_t, half, at::Half, true, SEGMENTS);           \
+  EXPECT_MATCHES_BASE(NAME, int32_t, uint8_t, uint8_t, true, SEGMENTS);         \
+  EXPECT_MATCHES_BASE(NAME, int64_t, uint8_t, uint8_t, true, SEGMENTS)
+
+TEST(EmbeddingLookupTest, Avx512MatchesBase) {
+  if (!HasAvx512()) {
+    return;
+  }
+  EXPECT_ALL_VARIANTS_MATCH_BASE(EmbeddingLookup, kLengths);
+}
+
+TEST(EmbeddingLookupTest, Avx512IdxMatchesBase) {
+  if (!HasAvx512()) {
+    return;
+  }
+  std::mt19937 gen(0);
+  const auto offsets = MakeInputs(gen).offsets;
+  EXPECT_ALL_VARIANTS_MATCH_BASE(EmbeddingLookupIdx, offsets);
+}
+
+TEST(EmbeddingLookupTest, Avx512Fused8BitRowwiseMatchesBase) {
+  if (!HasAvx512()) {
+    return;
+  }
+  std::mt19937 gen(0);
+  const auto offsets = MakeInputs(gen).offsets;
+  CompareFusedWithBase<int32_t>(
+      Fused8BitRowwiseEmbeddingLookup_int32_t_uint8_t_float_false__base,
+      Fused8BitRowwiseEmbeddingLookup_int32_t_uint8_t_float_false__avx512,
+      kLengths);
+  CompareFusedWithBase<int64_t>(
+      Fused8BitRowwiseEmbeddingLookup_int64_t_uint8_t_float_false__base,
+      Fused8BitRowwiseEmbeddingLookup_int64_t_uint8_t_float_false__avx512,
+      kLengths);
+  CompareFusedWithBase<int32_t>(
+      Fused8BitRowwiseEmbeddingLookupIdx_int32_t_uint8_t_float_false__base,
+      Fused8BitRowwiseEmbeddingLookupIdx_int32_t_uint8_t_float_false__avx512,
+      offsets);
+  CompareFusedWithBase<int64_t>(
+      Fused8BitRowwiseEmbeddingLookupIdx_int64_t_uint8_t_float_false__base,
+      Fused8BitRowwiseEmbeddingLookupIdx_int64_t_uint8_t_float_false__avx512,
+      offsets);
+}
+
+#undef EXPECT_ALL_VARIANTS_MATCH_BASE
+#undef EXPECT_MATCHES_BASE
+
+} // namespace caffe2
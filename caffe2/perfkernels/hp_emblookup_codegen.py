@@ -6,12 +6,64 @@ import sys
 
 sizeof = {"float": 4, "at::Half": 2, "uint8_t": 1}
 
+# Number of floats per vector register and the prefix of the intrinsics
+# operating on them.
+vlen = {"AVX2": 8, "AVX512": 16}
+vtype = {"AVX2": "__m256", "AVX512": "__m512"}
+vprefix = {"AVX2": "_mm256", "AVX512": "_mm512"}
+
+
+def prefetch_scale_bias(InType, isa, fused):
+    # The scale and bias of uint8 rows are not covered by the prefetches of the
+    # row data, so on AVX512, where lookups are more often bound by memory
+    # latency, they are prefetched along with the row.
+    code = []
+    if isa != "AVX512" or InType != "uint8_t":
+        return code
+    if fused:
+        code.append(
+            "        _mm_prefetch(\n"
+            "            reinterpret_cast<const char*>(&ip_next_T0[block_size]),\n"
+            "            _MM_HINT_T0);"
+        )
+    else:
+        code.append(
+            "        _mm_prefetch(\n"
+            "            reinterpret_cast<const char*>(&scale_bias[2 * idx_pref_T0]),\n"
+            "            _MM_HINT_T0);"
+        )
+    return code
+
 
 def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
     def compute(regid, InType, use_weights, isa, prefetch):
         code = []
 
-        if InType == "float":
+        if isa == "AVX512":
+            if InType == "float":
+                code.append(
+                    "        vop%d = _mm512_fmadd_ps(vwgt, _mm512_loadu_ps(ip + (%d)), vop%d);"  # noqa
+                    % (regid, regid, regid)
+                )
+            elif InType == "at::Half":
+                code.append(
+                    "        vop%d = _mm512_fmadd_ps(\n"
+                    "            vwgt,\n"
+                    "            _mm512_cvtph_ps(\n"
+                    "                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ip + (%d)))),\n"  # noqa
+                    "            vop%d);" % (regid, regid, regid)
+                )
+            elif InType == "uint8_t":
+                code.append(
+                    "        vop%d = _mm512_fmadd_ps(\n"
+                    "            vwgt,\n"
+                    "            _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(\n"
+                    "                _mm_loadu_si128(reinterpret_cast<const __m128i*>(ip + (%d))))),\n"  # noqa
+                    "            _mm512_add_ps(vop%d, vbio));" % (regid, regid, regid)
+                )
+            else:
+                assert False
+        elif InType == "float":
             code.append(
                 "        vop%d = _mm256_fmadd_ps(vwgt, _mm256_loadu_ps(ip + (%d)), vop%d);"  # noqa
                 % (regid, regid, regid)
@@ -66,8 +118,10 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets)
 
     code.append("      " + OutType + "* op = &out[rangeIndex * block_size];")
     for i in range(0, uf):
-        j = 8 * i
-        code.append("      __m256 vop" + str(j) + " = _mm256_setzero_ps();")
+        j = vlen[isa] * i
+        code.append(
+            "      {} vop{} = {}_setzero_ps();".format(vtype[isa], j, vprefix[isa])
+        )
 
     # inner loop
     if use_offsets:
@@ -120,7 +174,9 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets)
         else:
             code.append("        bio = wgt * scale_bias[2 * idx + 1];")
             code.append("        wgt = wgt * scale_bias[2 * idx];")
-        code.append("        __m256 vbio = _mm256_set1_ps(bio);")
+        code.append(
+            "        {} vbio = {}_set1_ps(bio);".format(vtype[isa], vprefix[isa])
+        )
     else:
         code.append("        " + OutType + " wgt = 1.f;")
         code.append("        if (weights) {")
@@ -128,7 +184,7 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets)
             "          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];"  # noqa
         )
         code.append("        }")
-    code.append("        __m256 vwgt = _mm256_set1_ps(wgt);")
+    code.append("        {} vwgt = {}_set1_ps(wgt);".format(vtype[isa], vprefix[isa]))
 
     code.append("        const {}* ip = &input[idx * fused_block_size];".format(InType))
     code.append(
@@ -148,9 +204,10 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets)
         "        const {}* ip_next_T0 = "
         "&input[idx_pref_T0 * fused_block_size];".format(InType)
     )
+    code.extend(prefetch_scale_bias(InType, isa, fused))
 
     for i in range(0, uf):
-        j = 8 * i
+        j = vlen[isa] * i
         cachelinesize = 64
         byteoffset = sizeof[InType] * j
         prefetch = (byteoffset % cachelinesize) == 0
@@ -162,20 +219,34 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets)
     else:
         code.append("      if (!normalize_by_lengths || lengths[rangeIndex] == 0) {")
     for i in range(0, uf):
-        j = 8 * i
-        code.append("        _mm256_storeu_ps(&op[" + str(j) + "], vop" + str(j) + ");")
+        j = vlen[isa] * i
+        code.append(
+            "        " + vprefix[isa] + "_storeu_ps(&op[" + str(j) + "], vop" + str(j) + ");"
+        )
     code.append("      } else {")
     # inv of length
     if use_offsets:
-        code.append("        __m256 vlen_inv = _mm256_set1_ps(1.0f / length);")
+        code.append(
+            "        {} vlen_inv = {}_set1_ps(1.0f / length);".format(
+                vtype[isa], vprefix[isa]
+            )
+        )
     else:
-        code.append("        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);")
+        code.append(
+            "        {} vlen_inv = {}_set1_ps(1.0f / lengths[rangeIndex]);".format(
+                vtype[isa], vprefix[isa]
+            )
+        )
     for i in range(0, uf):
-        j = 8 * i
+        j = vlen[isa] * i
         code.append(
-            "        _mm256_storeu_ps(&op["
+            "        "
+            + vprefix[isa]
+            + "_storeu_ps(&op["
             + str(j)
-            + "], _mm256_mul_ps("
+            + "], "
+            + vprefix[isa]
+            + "_mul_ps("
             + "vop"
             + str(j)
             + ", vlen_inv));"
@@ -189,7 +260,37 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, use_offsets)
 def generic(IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
     def compute(InType, use_weights, isa):
         code = []
-        if InType == "float":
+        if isa == "AVX512":
+            if InType == "float":
+                code.append(
+                    "          _mm512_storeu_ps(\n"
+                    "              &op[j],\n"
+                    "              _mm512_fmadd_ps(\n"
+                    "                  vwgt, _mm512_loadu_ps(&ip[j]), _mm512_loadu_ps(&op[j])));"  # noqa
+                )
+            elif InType == "at::Half":
+                code.append(
+                    "          _mm512_storeu_ps(\n"
+                    "              &op[j],\n"
+                    "              _mm512_fmadd_ps(\n"
+                    "                  vwgt,\n"
+                    "                  _mm512_cvtph_ps(_mm256_loadu_si256(\n"
+                    "                      reinterpret_cast<const __m256i*>(&ip[j]))),\n"
+                    "                  _mm512_loadu_ps(&op[j])));"
+                )
+            elif InType == "uint8_t":
+                code.append(
+                    "          _mm512_storeu_ps(\n"
+                    "              &op[j],\n"
+                    "              _mm512_fmadd_ps(\n"
+                    "                  vwgt,\n"
+                    "                  _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(\n"  # noqa
+                    "                      reinterpret_cast<const __m128i*>(&ip[j])))),\n"
+                    "                  _mm512_add_ps(_mm512_loadu_ps(&op[j]), vbio)));"
+                )
+            else:
+                assert False
+        elif InType == "float":
             code.append(
                 "          _mm256_storeu_ps(\n"
                 "              &op[j],\n"
@@ -249,8 +350,12 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
 
     # initialize to 0
     code.append("      int64_t j = 0;")
-    code.append("      for (; j + 8 <= block_size; j += 8) {")
-    code.append("        _mm256_storeu_ps(op + j, _mm256_setzero_ps());")
+    code.append(
+        "      for (; j + {0} <= block_size; j += {0}) {{".format(vlen[isa])
+    )
+    code.append(
+        "        {0}_storeu_ps(op + j, {0}_setzero_ps());".format(vprefix[isa])
+    )
     code.append("      }")
     code.append("      for (; j < block_size; j++) {")
     code.append("        op[j] = 0.0f;")
@@ -307,7 +412,9 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
         else:
             code.append("        bio = wgt * scale_bias[2 * idx + 1];")
             code.append("        wgt = wgt * scale_bias[2 * idx];")
-        code.append("        __m256 vbio = _mm256_set1_ps(bio);")
+        code.append(
+            "        {} vbio = {}_set1_ps(bio);".format(vtype[isa], vprefix[isa])
+        )
     else:
         code.append("        " + OutType + " wgt = 1.f;")
         code.append("        if (weights) {")
@@ -315,7 +422,7 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
             "          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];"  # noqa
         )
         code.append("        }")
-    code.append("        __m256 vwgt = _mm256_set1_ps(wgt);")
+    code.append("        {} vwgt = {}_set1_ps(wgt);".format(vtype[isa], vprefix[isa]))
 
     code.append("        const {}* ip = &input[idx * fused_block_size];".format(InType))
     code.append(
@@ -334,10 +441,13 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
         "        const {}* ip_next_T0 = "
         "&input[idx_pref_T0 * fused_block_size];".format(InType)
     )
+    code.extend(prefetch_scale_bias(InType, isa, fused))
 
     # compute and store main loop
     code.append("        j = 0;")
-    code.append("        for (; j + 8 <= block_size; j += 8) {")
+    code.append(
+        "        for (; j + {0} <= block_size; j += {0}) {{".format(vlen[isa])
+    )
     code.extend(compute(InType, use_weights, isa))
     code.append("        }")
     # leftover
@@ -366,12 +476,18 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused, use_offsets):
     else:
         code.append("      if (normalize_by_lengths && lengths[rangeIndex]) {")
         code.append("        float len_inv = 1.0f / lengths[rangeIndex];")
-    code.append("        __m256 vlen_inv = _mm256_set1_ps(len_inv);")
+    code.append(
+        "        {} vlen_inv = {}_set1_ps(len_inv);".format(vtype[isa], vprefix[isa])
+    )
     code.append("        j = 0;")
-    code.append("        for (; j + 8 <= block_size; j += 8) {")
     code.append(
-        "          _mm256_storeu_ps(\n"
-        "              &op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));"
+        "        for (; j + {0} <= block_size; j += {0}) {{".format(vlen[isa])
+    )
+    code.append(
+        "          {0}_storeu_ps(\n"
+        "              &op[j], {0}_mul_ps({0}_loadu_ps(&op[j]), vlen_inv));".format(
+            vprefix[isa]
+        )
     )
     code.append("        }")
     code.append("        for (; j < block_size; j++) {")
@@ -389,19 +505,21 @@ parser = argparse.ArgumentParser()
 parser.add_argument("-f", "--filename", help="file name")
 parser.add_argument("--fused", action="store_true")
 parser.add_argument("--use-offsets", action="store_true")
+parser.add_argument("--isa", choices=["avx2", "avx512"], default="avx2")
 opts = parser.parse_args()
+isa = opts.isa.upper()
 if opts.filename:
     filename = opts.filename
 elif opts.fused:
     if opts.use_offsets:
-        filename = "embedding_lookup_fused_8bit_rowwise_idx_avx2.cc"
+        filename = "embedding_lookup_fused_8bit_rowwise_idx_{}.cc".format(opts.isa)
     else:
-        filename = "embedding_lookup_fused_8bit_rowwise_avx2.cc"
+        filename = "embedding_lookup_fused_8bit_rowwise_{}.cc".format(opts.isa)
 else:
     if opts.use_offsets:
-        filename = "embedding_lookup_idx_avx2.cc"
+        filename = "embedding_lookup_idx_{}.cc".format(opts.isa)
     else:
-        filename = "embedding_lookup_avx2.cc"
+        filename = "embedding_lookup_{}.cc".format(opts.isa)
 
 options = [
     ["int32_t", "int", "float", "float", "float", "float"],
@@ -423,6 +541,7 @@ code.append("//// --------------------------\n")
 
 code.append("#include <c10/util/Half.h>")
 code.append("#include <immintrin.h>")
+code.append('#include "caffe2/perfkernels/embedding_lookup.h"')
 
 code.append("namespace caffe2 {\n")
 for o in options:
@@ -438,7 +557,7 @@ for o in options:
         fn_base = "{}EmbeddingLookup_{}_{}_{}".format(
             prefix, IndexTypeName, InTypeName, OutTypeName
         )
-    suffix = "__avx2_fma"
+    suffix = "__avx512" if isa == "AVX512" else "__avx2_fma"
     fn = "static bool " + fn_base + suffix
     code.append(fn + "(")
 
@@ -460,13 +579,16 @@ for o in options:
     args.append("    " + OutType + "* out) {")
     code += args
 
-    code.append("  const " + IndexType + " prefdist_T0 = 16;")
     # block_size is the number of elements and fused_block_size is the size of
     # an entire row, including scale and bias.
     offset = (8 // sizeof[InType]) if opts.fused else 0
     code.append(
         "  const {} fused_block_size = block_size + {};".format(IndexType, offset)
     )
+    code.append(
+        "  const {} prefdist_T0 = EmbeddingLookupPrefetchDistance(\n"
+        "      data_size, fused_block_size * sizeof({}));".format(IndexType, InType)
+    )
     if opts.use_offsets:
         code.append("  int64_t dataInd = 0;")
     else:
@@ -474,17 +596,25 @@ for o in options:
 
     # code.append("printf(\"calling " + fn + "\\n\");");
 
-    code.append("  if (block_size == 128) {")
-    code += unroll(16, IndexType, InType, OutType, True, "AVX2", opts.fused, opts.use_offsets)
-    code.append("  } else if (block_size == 64) {")
-    code += unroll(8, IndexType, InType, OutType, True, "AVX2", opts.fused, opts.use_offsets)
-    code.append("  } else if (block_size == 32) {")
-    code += unroll(4, IndexType, InType, OutType, True, "AVX2", opts.fused, opts.use_offsets)
-    code.append("  } else if (block_size == 16) {")
-    code += unroll(2, IndexType, InType, OutType, True, "AVX2", opts.fused, opts.use_offsets)
+    for block_size in [128, 64, 32, 16]:
+        code.append(
+            "  {}if (block_size == {}) {{".format(
+                "" if block_size == 128 else "} else ", block_size
+            )
+        )
+        code += unroll(
+            block_size // vlen[isa],
+            IndexType,
+            InType,
+            OutType,
+            True,
+            isa,
+            opts.fused,
+            opts.use_offsets,
+        )
     code.append("  } else {")
     code.append("    // generic code")
-    code += generic(IndexType, InType, OutType, True, "AVX2", opts.fused, opts.use_offsets)
+    code += generic(IndexType, InType, OutType, True, isa, opts.fused, opts.use_offsets)
     code.append("  }")
     code.append("  return dataInd == index_size;")
 
@@ -0,0 +1,318 @@
+#include "caffe2/predictor/batching_predictor.h"
+
+#include <array>
+
+#include "caffe2/core/context.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Upper bounds, in microseconds, of the buckets of the latency histograms.
+// The last bucket holds everything above the last bound.
+constexpr std::array<int64_t, 4> kLatencyBucketBoundsUs = {
+    100,
+    1000,
+    10000,
+    100000};
+
+const std::vector<std::string>& latencyBucketNames() {
+  static const std::vector<std::string> names = {
+      "lt_100us", "lt_1ms", "lt_10ms", "lt_100ms", "ge_100ms"};
+  return names;
+}
+
+size_t latencyBucket(int64_t us) {
+  size_t bucket = 0;
+  while (bucket < kLatencyBucketBoundsUs.size() &&
+         us >= kLatencyBucketBoundsUs[bucket]) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+int64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+Tensor concatRows(const std::vector<const Tensor*>& parts, int64_t rows) {
+  const Tensor& first = *parts.front();
+  auto dims = first.sizes().vec();
+  dims[0] = rows;
+  Tensor result(dims, CPU);
+  char* dst = static_cast<char*>(result.raw_mutable_data(first.dtype()));
+  CPUContext context;
+  for (const Tensor* part : parts) {
+    context.CopyItemsSameDevice(
+        first.dtype(), part->numel(), part->raw_data(), dst);
+    dst += part->nbytes();
+  }
+  return result;
+}
+
+Tensor sliceRows(const Tensor& src, int64_t begin, int64_t rows) {
+  auto dims = src.sizes().vec();
+  dims[0] = rows;
+  Tensor result(dims, CPU);
+  const int64_t row_items = src.size_from_dim(1);
+  CPUContext context;
+  context.CopyItemsSameDevice(
+      src.dtype(),
+      rows * row_items,
+      static_cast<const char*>(src.raw_data()) +
+          begin * row_items * src.itemsize(),
+      result.raw_mutable_data(src.dtype()));
+  return result;
+}
+
+bool sameRowShape(const Tensor& a, const Tensor& b) {
+  return a.dtype() == b.dtype() && a.sizes().slice(1) == b.sizes().slice(1);
+}
+
+} // namespace
+
+BatchingPredictor::BatchingPredictor(
+    PredictorConfig config,
+    BatchingPredictorOptions options)
+    : config_(std::move(config)),
+      options_(std::move(options)),
+      stats_(options_.stats_name) {
+  CAFFE_ENFORCE_GT(options_.max_batch_size, 0);
+  CAFFE_ENFORCE_GT(options_.num_workers, 0);
+  CAFFE_ENFORCE(config_.ws, "BatchingPredictor needs an initialized workspace");
+
+  // Without explicit input names, the inputs are the external inputs of the
+  // predict net that the init net did not create.
+  input_names_ = config_.input_names;
+  if (input_names_.empty()) {
+    for (const auto& name : config_.predict_net->external_input()) {
+      if (!config_.ws->HasBlob(name)) {
+        input_names_.push_back(name);
+      }
+    }
+  }
+  CAFFE_ENFORCE(
+      !input_names_.empty(), "BatchingPredictor needs at least one input");
+
+  stats_.queue_latency_hist.setDetails(latencyBucketNames());
+  stats_.run_latency_hist.setDetails(latencyBucketNames());
+
+  for (size_t i = 0; i < options_.num_workers; ++i) {
+    PredictorConfig worker_config = config_;
+    worker_config.input_names = input_names_;
+    worker_config.ws = std::make_shared<Workspace>(config_.ws.get());
+    // Inputs and intermediate blobs have to be local to each worker, while
+    // the parameters are shared with the workspace of the config.
+    for (const auto& name : input_names_) {
+      worker_config.ws->CreateLocalBlob(name);
+    }
+    for (const auto& op : config_.predict_net->op()) {
+      for (const auto& output : op.output()) {
+        worker_config.ws->CreateLocalBlob(output);
+      }
+    }
+    predictors_.push_back(
+        std::make_unique<Predictor>(std::move(worker_config)));
+  }
+  for (auto& predictor : predictors_) {
+    Predictor* p = predictor.get();
+    workers_.emplace_back([this, p]() { workerLoop(p); });
+  }
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+bool BatchingPredictor::operator()(
+    const TensorList& inputs,
+    TensorList* outputs) {
+  CAFFE_ENFORCE_EQ(inputs.size(), input_names_.size());
+  auto request = std::make_shared<Request>();
+  request->rows = -1;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    CAFFE_ENFORCE_GE(
+        inputs[i].dim(), 1, "Input ", input_names_[i], " has no batch dim");
+    if (request->rows < 0) {
+      request->rows = inputs[i].size(0);
+    }
+    CAFFE_ENFORCE_EQ(
+        inputs[i].size(0),
+        request->rows,
+        "All inputs need the same first dimension, got ",
+        inputs[i].size(0),
+        " for input ",
+        input_names_[i]);
+    request->inputs.push_back(inputs[i].UnsafeSharedInstance());
+  }
+  auto done = request->done.get_future();
+  request->enqueued = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CAFFE_ENFORCE(!stop_, "BatchingPredictor is shutting down");
+    queue_.push_back(request);
+  }
+  cv_.notify_all();
+  CAFFE_EVENT(stats_, num_requests);
+
+  if (!done.get()) {
+    return false;
+  }
+  *outputs = std::move(request->outputs);
+  return true;
+}
+
+int64_t BatchingPredictor::batchableRows() const {
+  const Request& first = *queue_.front();
+  int64_t rows = 0;
+  for (const auto& request : queue_) {
+    for (size_t i = 0; i < first.inputs.size(); ++i) {
+      if (!sameRowShape(first.inputs[i], request->inputs[i])) {
+        return rows;
+      }
+    }
+    rows += request->rows;
+    if (rows >= static_cast<int64_t>(options_.max_batch_size)) {
+      return rows;
+    }
+  }
+  return rows;
+}
+
+std::vector<std::shared_ptr<BatchingPredictor::Request>>
+BatchingPredictor::takeBatch() {
+  std::vector<std::shared_ptr<Request>> batch;
+  batch.push_back(std::move(queue_.front()));
+  queue_.pop_front();
+  int64_t rows = batch.front()->rows;
+  while (!queue_.empty()) {
+    const Request& next = *queue_.front();
+    if (rows + next.rows > static_cast<int64_t>(options_.max_batch_size)) {
+      break;
+    }
+    bool batchable = true;
+    for (size_t i = 0; i < next.inputs.size() && batchable; ++i) {
+      batchable = sameRowShape(batch.front()->inputs[i], next.inputs[i]);
+    }
+    if (!batchable) {
+      break;
+    }
+    rows += next.rows;
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop_front();
+  }
+  return batch;
+}
+
+void BatchingPredictor::workerLoop(Predictor* predictor) {
+  while (true) {
+    std::vector<std::shared_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true) {
+        if (queue_.empty()) {
+          if (stop_) {
+            return;
+          }
+          cv_.wait(lock);
+          continue;
+        }
+        // The deadline is that of the oldest request, so it moves when
+        // another worker takes the front of the queue.
+        const auto deadline =
+            queue_.front()->enqueued + options_.max_batch_delay;
+        if (stop_ ||
+            batchableRows() >=
+                static_cast<int64_t>(options_.max_batch_size) ||
+            std::chrono::steady_clock::now() >= deadline) {
+          break;
+        }
+        cv_.wait_until(lock, deadline);
+      }
+      batch = takeBatch();
+    }
+    // Other workers may be able to run what is left in the queue.
+    cv_.notify_all();
+    runBatch(predictor, batch);
+  }
+}
+
+void BatchingPredictor::runBatch(
+    Predictor* predictor,
+    const std::vector<std::shared_ptr<Request>>& batch) {
+  int64_t rows = 0;
+  for (const auto& request : batch) {
+    const int64_t queue_us = elapsedUs(request->enqueued);
+    CAFFE_EVENT(stats_, queue_latency_us, queue_us);
+    CAFFE_EVENT(stats_, queue_latency_hist, 1, latencyBucket(queue_us));
+    rows += request->rows;
+  }
+  CAFFE_EVENT(stats_, num_batches);
+  CAFFE_EVENT(stats_, batch_size, rows);
+
+  const auto start = std::chrono::steady_clock::now();
+  bool success = false;
+  try {
+    Predictor::TensorMap inputs;
+    for (size_t i = 0; i < input_names_.size(); ++i) {
+      if (batch.size() == 1) {
+        inputs.emplace(
+            input_names_[i], batch.front()->inputs[i].UnsafeSharedInstance());
+        continue;
+      }
+      std::vector<const Tensor*> parts;
+      parts.reserve(batch.size());
+      for (const auto& request : batch) {
+        parts.push_back(&request->inputs[i]);
+      }
+      inputs.emplace(input_names_[i], concatRows(parts, rows));
+    }
+
+    TensorList outputs;
+    success = (*predictor)(inputs, &outputs);
+    if (success) {
+      // The outputs live in the workspace of the worker, which the next batch
+      // reuses, so each request gets a copy of its rows.
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        CAFFE_ENFORCE(
+            outputs[i].dim() >= 1 && outputs[i].size(0) == rows,
+            "Output ",
+            i,
+            " does not have the batch size as first dimension");
+        int64_t begin = 0;
+        for (const auto& request : batch) {
+          request->outputs.push_back(
+              sliceRows(outputs[i], begin, request->rows));
+          begin += request->rows;
+        }
+      }
+    }
+  } catch (...) {
+    CAFFE_EVENT(stats_, num_failed_batches);
+    for (const auto& request : batch) {
+      request->done.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  const int64_t run_us = elapsedUs(start);
+  CAFFE_EVENT(stats_, run_latency_us, run_us);
+  CAFFE_EVENT(stats_, run_latency_hist, 1, latencyBucket(run_us));
+  if (!success) {
+    CAFFE_EVENT(stats_, num_failed_batches);
+  }
+  for (const auto& request : batch) {
+    request->done.set_value(success);
+  }
+}
+
+} // namespace caffe2
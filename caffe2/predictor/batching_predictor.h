@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "caffe2/core/stats.h"
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+struct CAFFE2_API BatchingPredictorOptions {
+  // Maximum number of rows (sum of the first dimension of the inputs of all
+  // requests) that are run together. A single request larger than this is
+  // run on its own.
+  size_t max_batch_size = 64;
+  // Maximum time the oldest request of a batch waits for more requests
+  // before the batch is run.
+  std::chrono::microseconds max_batch_delay{1000};
+  // Number of workspaces, and threads, that run batches concurrently.
+  size_t num_workers = 1;
+  // Group name of the exported stats.
+  std::string stats_name = "batching_predictor";
+};
+
+/**
+ * Runs a predict net on batches of requests.
+ *
+ * Requests are queued and concatenated along their first dimension until
+ * either max_batch_size rows are pending or the oldest request has waited for
+ * max_batch_delay. Each batch runs on one of num_workers workspaces, which
+ * are created once as children of the workspace of the config, so that they
+ * share its parameter blobs. The outputs are split back per request along the
+ * first dimension.
+ *
+ * Requests are only batched with requests whose inputs have the same types
+ * and the same sizes past the first dimension.
+ */
+class CAFFE2_API BatchingPredictor {
+ public:
+  using TensorList = Predictor::TensorList;
+
+  explicit BatchingPredictor(
+      PredictorConfig config,
+      BatchingPredictorOptions options = BatchingPredictorOptions());
+
+  // Runs the requests still queued, then stops the workers.
+  ~BatchingPredictor();
+
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+
+  // Queues a request and blocks until its batch has run. inputs are given in
+  // the order of input_names(), all with the same first dimension.
+  //
+  // Unlike Predictor, outputs own their data and stay valid after the call.
+  //
+  // Returns true on success
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+
+  const std::vector<std::string>& input_names() const {
+    return input_names_;
+  }
+
+  const NetDef& def() const {
+    return *config_.predict_net;
+  }
+
+ private:
+  struct Request {
+    TensorList inputs;
+    int64_t rows;
+    TensorList outputs;
+    std::promise<bool> done;
+    std::chrono::steady_clock::time_point enqueued;
+  };
+
+  struct BatchingPredictorStats {
+    CAFFE_STAT_CTOR(BatchingPredictorStats);
+    CAFFE_EXPORTED_STAT(num_requests);
+    CAFFE_EXPORTED_STAT(num_batches);
+    CAFFE_EXPORTED_STAT(num_failed_batches);
+    CAFFE_AVG_EXPORTED_STAT(batch_size);
+    CAFFE_AVG_EXPORTED_STAT(queue_latency_us);
+    CAFFE_DETAILED_EXPORTED_STAT(queue_latency_hist);
+    CAFFE_AVG_EXPORTED_STAT(run_latency_us);
+    CAFFE_DETAILED_EXPORTED_STAT(run_latency_hist);
+  };
+
+  void workerLoop(Predictor* predictor);
+  // Takes the requests of the next batch from the front of the queue. Called
+  // with mutex_ held.
+  std::vector<std::shared_ptr<Request>> takeBatch();
+  // Number of rows of the requests at the front of the queue that can be
+  // batched with the first one. Called with mutex_ held.
+  int64_t batchableRows() const;
+  void runBatch(
+      Predictor* predictor,
+      const std::vector<std::shared_ptr<Request>>& batch);
+
+  PredictorConfig config_;
+  BatchingPredictorOptions options_;
+  std::vector<std::string> input_names_;
+  BatchingPredictorStats stats_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Request>> queue_;
+  bool stop_ = false;
+
+  std::vector<std::unique_ptr<Predictor>> predictors_;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace caffe2
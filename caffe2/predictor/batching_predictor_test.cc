@@ -0,0 +1,154 @@
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/utils/math.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "dag"
+        op {
+          type: "GivenTensorFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 3
+            ints: 4
+          }
+          arg {
+            name: "values"
+            floats: [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12]
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 3
+          }
+          arg {
+            name: "value"
+            f: 0.5
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+Tensor randomTensor(const std::vector<int64_t>& dims, CPUContext* ctx) {
+  Tensor t(dims, CPU);
+  math::RandUniform<float, CPUContext>(
+      t.numel(), -1.0, 1.0, t.template mutable_data<float>(), ctx);
+  return t;
+}
+
+} // namespace
+
+class BatchingPredictorTest : public testing::Test {
+ public:
+  void SetUp() override {
+    DeviceOption op;
+    op.set_random_seed(1701);
+    ctx_ = std::make_unique<CPUContext>(op);
+  }
+
+  PredictorConfig makeConfig() {
+    return makePredictorConfig(
+        parseNetDef(initSpec), parseNetDef(predictSpec));
+  }
+
+  std::unique_ptr<CPUContext> ctx_;
+};
+
+TEST_F(BatchingPredictorTest, ConcurrentRequests) {
+  BatchingPredictorOptions options;
+  options.max_batch_size = 8;
+  options.max_batch_delay = std::chrono::milliseconds(20);
+  options.num_workers = 2;
+  BatchingPredictor batching(makeConfig(), options);
+  Predictor reference(makeConfig());
+  EXPECT_EQ(batching.input_names(), std::vector<std::string>{"data"});
+
+  constexpr int kNumRequests = 16;
+  std::vector<Tensor> inputs;
+  std::vector<std::vector<float>> expected;
+  for (int i = 0; i < kNumRequests; ++i) {
+    inputs.push_back(randomTensor({1 + i % 3, 4}, ctx_.get()));
+    Predictor::TensorList input{inputs.back()};
+    Predictor::TensorList output;
+    ASSERT_TRUE(reference(input, &output));
+    const float* data = output.front().data<float>();
+    expected.emplace_back(data, data + output.front().numel());
+  }
+
+  std::vector<Predictor::TensorList> outputs(kNumRequests);
+  std::vector<char> success(kNumRequests, false);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      Predictor::TensorList input{inputs[i]};
+      success[i] = batching(input, &outputs[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumRequests; ++i) {
+    ASSERT_TRUE(success[i]);
+    ASSERT_EQ(outputs[i].size(), 1);
+    const Tensor& y = outputs[i].front();
+    ASSERT_EQ(y.sizes().size(), 2);
+    EXPECT_EQ(y.size(0), 1 + i % 3);
+    EXPECT_EQ(y.size(1), 3);
+    for (int64_t j = 0; j < y.numel(); ++j) {
+      EXPECT_NEAR(y.data<float>()[j], expected[i][j], 1E-5);
+    }
+  }
+}
+
+TEST_F(BatchingPredictorTest, FailedBatch) {
+  BatchingPredictor batching(makeConfig());
+  Predictor::TensorList outputs;
+  // The error of a failed batch is reported to its requests, and the
+  // predictor keeps serving the next ones.
+  Predictor::TensorList bad_input{randomTensor({2, 5}, ctx_.get())};
+  EXPECT_THROW(batching(bad_input, &outputs), EnforceNotMet);
+  Predictor::TensorList input{randomTensor({2, 4}, ctx_.get())};
+  EXPECT_TRUE(batching(input, &outputs));
+  EXPECT_EQ(outputs.front().size(0), 2);
+}
+
+} // namespace caffe2
@@ -1,10 +1,14 @@
 #include "predictor_config.h"
 
 #include <atomic>
+#include <set>
+#include <unordered_map>
 
 #include "caffe2/core/init.h"
+#include "caffe2/core/memonger.h"
 #include "caffe2/utils/proto_utils.h"
 #ifdef CAFFE2_OPTIMIZER
+#include "caffe2/opt/bound_shape_inferencer.h"
 #include "caffe2/opt/optimizer.h"
 #endif
 
@@ -35,6 +39,68 @@ const ::google::protobuf::RepeatedPtrField<::std::string>& getBlobs(
   CAFFE_THROW("Blob not found: ", name);
 }
 
+// Sizes in bytes of the blobs of `net` when its batch size is `max_batch_size`,
+// or nothing if the shapes can't be inferred.
+std::unordered_map<std::string, int64_t> inferBlobSizes(
+    const NetDef& net,
+    Workspace* ws,
+    int64_t max_batch_size) {
+  std::unordered_map<std::string, int64_t> sizes;
+#ifdef CAFFE2_OPTIMIZER
+  if (max_batch_size <= 0) {
+    return sizes;
+  }
+  try {
+    BoundShapeInferencer inferencer(BoundShapeSpec(max_batch_size, 0));
+    inferencer.InferBoundShapeAndType(net, ShapeInfoMap(), ws);
+    for (const auto& kv : inferencer.shape_info()) {
+      const auto& shape = kv.second.shape;
+      if (shape.unknown_shape()) {
+        continue;
+      }
+      int64_t numel = 1;
+      for (const auto d : shape.dims()) {
+        numel *= d;
+      }
+      sizes[kv.first] =
+          numel * DataTypeToTypeMeta(shape.data_type()).itemsize();
+    }
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Shape inference for memonger failed: " << e.what();
+    sizes.clear();
+  }
+#endif
+  return sizes;
+}
+
+// Makes the intermediate blobs of the predict net share blobs, see
+// memonger::optimize_inference_net(). Blobs of the workspace, like the
+// weights, and the external inputs and outputs are left alone.
+void applyMemonger(NetDef* net, Workspace* ws) {
+  std::set<std::string> static_blobs;
+  for (const auto& blob : ws->Blobs()) {
+    static_blobs.insert(blob);
+  }
+  for (const auto& blob : net->external_input()) {
+    static_blobs.insert(blob);
+  }
+  for (const auto& blob : net->external_output()) {
+    static_blobs.insert(blob);
+  }
+  const auto sizes = inferBlobSizes(
+      *net,
+      ws,
+      ArgumentHelper::GetSingleArgument<NetDef, int64_t>(
+          *net, "memonger_max_batch_size", 0));
+  memonger::MemongerStats stats;
+  *net = memonger::optimize_inference_net(*net, static_blobs, sizes, &stats);
+  if (!sizes.empty()) {
+    LOG(INFO) << "Memonger reduced the memory of intermediate blobs from "
+              << stats.bytes_before << " to " << stats.bytes_after
+              << " bytes";
+  }
+}
+
 } // namespace
 
 PredictorConfig
@@ -91,6 +157,10 @@ PredictorConfig makePredictorConfig(
     }
 #endif
   }
+  if (ArgumentHelper::GetSingleArgument<NetDef, bool>(
+          *config.predict_net, "memonger", false)) {
+    applyMemonger(config.predict_net.get(), &ws);
+  }
   return config;
 }
 
@@ -1350,6 +1350,41 @@ class TestOperators(hu.HypothesisTestCase):
             v += self.ws.blobs[str(counter)].fetch().tolist()
         self.assertEqual(v, truth)
 
+    @given(num_enqueue=st.integers(1, 6),
+           num_records=st.integers(1, 6),
+           num_blobs=st.integers(1, 3))
+    def test_safe_dequeue_blobs_batch(self, num_enqueue, num_records,
+                                      num_blobs):
+        self.ws.run(core.CreateOperator(
+            'CreateBlobsQueue', [], ['queue'],
+            capacity=num_enqueue, num_blobs=num_blobs))
+        blob_names = ['x_%d' % i for i in range(num_blobs)]
+        xs = []
+        for i in range(num_enqueue):
+            record = [np.full((i + 1, 2), 10 * i + j, dtype=np.float32)
+                      for j in range(num_blobs)]
+            xs.append(record)
+            for name, value in zip(blob_names, record):
+                self.ws.create_blob(name).feed(value)
+            self.ws.run(core.CreateOperator(
+                'SafeEnqueueBlobs', ['queue'] + blob_names,
+                blob_names + ['status']))
+
+        # Closing the queue lets the dequeue return fewer records than asked
+        self.ws.run(core.CreateOperator('CloseBlobsQueue', ['queue'], []))
+
+        # Records are concatenated in the order they were enqueued
+        y_names = ['y_%d' % i for i in range(num_blobs)]
+        self.ws.run(core.CreateOperator(
+            'SafeDequeueBlobs', ['queue'], y_names + ['status'],
+            num_records=num_records))
+        self.assertFalse(self.ws.blobs['status'].fetch())
+        num_read = min(num_enqueue, num_records)
+        for j in range(num_blobs):
+            np.testing.assert_array_equal(
+                self.ws.blobs[y_names[j]].fetch(),
+                np.concatenate([xs[i][j] for i in range(num_read)]))
+
     @given(num_queues=st.integers(1, 5),
            num_iter=st.integers(5, 10),
            capacity=st.integers(1, 5),
@@ -27,7 +27,8 @@ def onnxifi_caffe2_net(
         adjust_batch=True,
         black_list=None,
         weight_names=None,
-        timeout=0):
+        timeout=0,
+        batch_buckets=None):
     """
     Transform the caffe2_net by collapsing ONNXIFI-runnable nodes into Onnxifi c2 ops
     """
@@ -44,7 +45,8 @@ def onnxifi_caffe2_net(
                              adjust_batch,
                              debug,
                              merge_fp32_inputs_into_fp16,
-                             use_onnx)
+                             use_onnx,
+                             batch_buckets if batch_buckets else [])
     pred_net_cut = caffe2_pb2.NetDef()
     pred_net_cut.ParseFromString(pred_net_str)
     return pred_net_cut
@@ -607,6 +607,30 @@ class TestSegmentOps(hu.HypothesisTestCase):
         )
         self.assertDeviceChecks(dc, op, [X, Y, Z], [0])
 
+    @given(**hu.gcs_cpu_only)
+    def test_sparse_lengths_sum_cached(self, gc, dc):
+        D = np.random.rand(50, 3, 4).astype(np.float32)
+        # Skewed indices, so that some rows are cached.
+        I = np.minimum(np.random.zipf(1.5, size=40) - 1, 49).astype(np.int64)
+        L = np.asarray([10, 0, 20, 10]).astype(np.int32)
+        workspace.FeedBlob("D", D)
+        workspace.FeedBlob("I", I)
+        workspace.FeedBlob("L", L)
+        net = core.Net("test_net")
+        net.SparseLengthsSum(["D", "I", "L"], "expected")
+        net.SparseLengthsSumCached(
+            ["D", "I", "L"], ["out", "stats"], cache_rows=5, reorganize_every=2)
+        workspace.CreateNet(net)
+        for _ in range(5):
+            workspace.RunNet(net)
+            np.testing.assert_allclose(
+                workspace.FetchBlob("out"),
+                workspace.FetchBlob("expected"),
+                rtol=1e-5)
+        hits, lookups = workspace.FetchBlob("stats")
+        self.assertEqual(lookups, 5 * I.size)
+        self.assertGreater(hits, 0)
+
     @given(**hu.gcs_cpu_only)
     def test_legacy_sparse_and_lengths_sum_gradient(self, gc, dc):
         X = np.random.rand(3, 64).astype(np.float32)
@@ -1740,7 +1740,8 @@ void addGlobalMethods(py::module& m) {
          bool adjust_batch,
          bool debug_builder,
          bool merge_fp32_inputs_into_fp16,
-         bool use_onnx) -> py::bytes {
+         bool use_onnx,
+         const std::vector<int>& batch_buckets) -> py::bytes {
         caffe2::NetDef pred_net;
         CAFFE_ENFORCE(
             ParseProtoFromLargeString(
@@ -1764,6 +1765,7 @@ void addGlobalMethods(py::module& m) {
         opts.debug = debug_builder;
         opts.merge_fp32_inputs_into_fp16 = merge_fp32_inputs_into_fp16;
         opts.use_onnx = use_onnx;
+        opts.batch_buckets = batch_buckets;
         OnnxifiTransformer ts(opts);
         std::unordered_set<int> blacklist_set(
             black_list.begin(), black_list.end());
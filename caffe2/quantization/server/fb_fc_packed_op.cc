@@ -27,6 +27,11 @@ REGISTER_CPU_OPERATOR(
     FbFCPacked,
     FbFCPackedOperator<CPUContext, DefaultEngine, fbgemm::float16>);
 
+REGISTER_CPU_OPERATOR_WITH_ENGINE(
+    FC,
+    FBGEMM_FP16,
+    FbFCPackedOperator<CPUContext, DefaultEngine, fbgemm::float16>);
+
 using namespace std::placeholders;
 
 vector<int64_t>
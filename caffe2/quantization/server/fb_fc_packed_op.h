@@ -58,6 +58,12 @@ namespace caffe2 {
  * }
  * ...
  * external_input: "w_packed"
+ *
+ * Alternatively, set engine: "FBGEMM_FP16" on the FC operator itself. The
+ * fp32 weight is then packed when the operator is created, if it is already in
+ * the workspace, or on the first run otherwise, and packed again only if the
+ * weight blob is replaced by another tensor. As with FbGemmPack, the weight
+ * must not be updated in place afterwards.
  */
 template <
     class Context,
@@ -69,7 +75,11 @@ class FbFCPackedOperator final : public Operator<Context> {
   FbFCPackedOperator(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
         axis_(this->template GetSingleArgument<int32_t>("axis", 1)),
-        axis_w_(this->template GetSingleArgument<int32_t>("axis_w", 1)) {}
+        axis_w_(this->template GetSingleArgument<int32_t>("axis_w", 1)) {
+    if (this->InputIsTensorType(1, CPU) && Input(1).numel() > 0) {
+      PackWeight(Input(1));
+    }
+  }
   ~FbFCPackedOperator() {}
 
   // template on X, B, and Y.
@@ -85,9 +95,14 @@ class FbFCPackedOperator final : public Operator<Context> {
     const int N = b.numel();
 
     // Load the packed matrix
-    auto* W =
-        OperatorBase::Input<caffe2::unique_ptr<fbgemm::PackedGemmMatrixFP16>>(1)
-            .get();
+    fbgemm::PackedGemmMatrixFP16* W;
+    if (this->InputIsTensorType(1, CPU)) {
+      W = PackWeight(Input(1));
+    } else {
+      W = OperatorBase::Input<
+              caffe2::unique_ptr<fbgemm::PackedGemmMatrixFP16>>(1)
+              .get();
+    }
     const int K = W->numRows();
     if (!W->packed()) {
       if (!packed_w_) {
@@ -186,6 +201,21 @@ class FbFCPackedOperator final : public Operator<Context> {
   }
 
  protected:
+  // Returns the fp32 weight W packed, packing it if it isn't yet.
+  fbgemm::PackedGemmMatrixFP16* PackWeight(const Tensor& W) {
+    const auto canonical_axis_w = W.canonical_axis_index(axis_w_);
+    const int N = W.size_to_dim(canonical_axis_w);
+    const int K = W.size_from_dim(canonical_axis_w);
+    const float* W_data = W.template data<float>();
+    if (!packed_w_ || packed_w_src_ != W_data || packed_w_->numRows() != K ||
+        packed_w_->numCols() != N) {
+      packed_w_ = std::make_unique<fbgemm::PackedGemmMatrixFP16>(
+          fbgemm::matrix_op_t::Transpose, K, N, 1.0f, W_data);
+      packed_w_src_ = W_data;
+    }
+    return packed_w_.get();
+  }
+
   size_t axis_{1};
   size_t axis_w_{1};
   // A local vector to cache the output shape so we don't need to recreate
@@ -193,6 +223,8 @@ class FbFCPackedOperator final : public Operator<Context> {
   vector<int64_t> Y_shape_cache_;
   Tensor bias_multiplier_{Context::GetDeviceType()};
   caffe2::unique_ptr<fbgemm::PackedGemmMatrixFP16> packed_w_{nullptr};
+  // The fp32 weight packed_w_ was packed from, if any
+  const float* packed_w_src_{nullptr};
 };
 
 class PackedGemmMatrixFP16ShapeFunctions : public ExternalTensorFunctionsBase {
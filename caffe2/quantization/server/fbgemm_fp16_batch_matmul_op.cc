@@ -0,0 +1,10 @@
+#include "caffe2/quantization/server/fbgemm_fp16_batch_matmul_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR_WITH_ENGINE(
+    BatchMatMul,
+    FBGEMM_FP16,
+    FbgemmFP16BatchMatMulOp);
+
+} // namespace caffe2
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <fbgemm/FbgemmFP16.h>
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/batch_matmul_op.h"
+
+namespace caffe2 {
+
+/**
+ * BatchMatMul with a 2D B, the same for all matrices of A, using the fp16 gemm
+ * of fbgemm. A is multiplied as a single (batch_size * M) x K matrix with B
+ * packed in fp16, which avoids the per-call overhead of BLAS for the small M
+ * of online inference. Other shapes, and trans_a, fall back to BatchMatMul.
+ *
+ * B is packed again on every run, unless constant_b is set, in which case it
+ * is packed once per B tensor and must not be updated in place afterwards.
+ */
+class FbgemmFP16BatchMatMulOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+
+  FbgemmFP16BatchMatMulOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        OP_SINGLE_ARG(bool, "trans_a", trans_a_, false),
+        OP_SINGLE_ARG(bool, "trans_b", trans_b_, false),
+        OP_SINGLE_ARG(bool, "broadcast", broadcast_, false),
+        OP_SINGLE_ARG(bool, "constant_b", constant_b_, false),
+        fallback_op_(operator_def, ws) {}
+
+  bool RunOnDevice() override {
+    const auto& A = Input(0);
+    const auto& B = Input(1);
+    if (trans_a_ || A.dim() < 2 || B.dim() != 2 ||
+        (A.dim() > 2 && !broadcast_) || !A.template IsType<float>()) {
+      return fallback_op_.RunOnDevice();
+    }
+
+    const int K = A.size(A.dim() - 1);
+    const int N = trans_b_ ? B.size(0) : B.size(1);
+    CAFFE_ENFORCE_EQ(trans_b_ ? B.size(1) : B.size(0), K);
+    const int M = A.numel() / K;
+    auto Y_dims = A.sizes().vec();
+    Y_dims.back() = N;
+    auto* Y = Output(0, Y_dims, at::dtype<float>());
+    float* Y_data = Y->template mutable_data<float>();
+    if (M == 0 || N == 0) {
+      return true;
+    }
+
+    const float* B_data = B.template data<float>();
+    if (!packed_b_ || !constant_b_ || packed_b_src_ != B_data ||
+        packed_b_->numRows() != K || packed_b_->numCols() != N) {
+      packed_b_ = std::make_unique<fbgemm::PackedGemmMatrixFP16>(
+          trans_b_ ? fbgemm::matrix_op_t::Transpose
+                   : fbgemm::matrix_op_t::NoTranspose,
+          K,
+          N,
+          1.0f,
+          B_data);
+      packed_b_src_ = B_data;
+    }
+    fbgemm::cblas_gemm_compute(
+        fbgemm::matrix_op_t::NoTranspose,
+        M,
+        A.template data<float>(),
+        *packed_b_,
+        0.f,
+        Y_data);
+    return true;
+  }
+
+ private:
+  bool trans_a_;
+  bool trans_b_;
+  bool broadcast_;
+  bool constant_b_;
+  BatchMatMulOp<CPUContext> fallback_op_;
+  std::unique_ptr<fbgemm::PackedGemmMatrixFP16> packed_b_;
+  // The B packed_b_ was packed from
+  const float* packed_b_src_{nullptr};
+};
+
+} // namespace caffe2
@@ -70,3 +70,81 @@ class FullyConnectedFP16Test(hu.HypothesisTestCase):
         mse_py = mse(Yref, Yrefh)
         print(np.abs(mse_c2 - mse_py))
         assert np.isclose(mse_c2, mse_py, atol=1e-3), np.abs(mse_c2 - mse_py)
+
+    @given(
+        input_channels=st.integers(1, 64),
+        output_channels=st.integers(1, 64),
+        batch_size=st.integers(0, 8),
+        **hu.gcs_cpu_only
+    )
+    def test_fully_connected_fbgemm_fp16(
+        self, input_channels, output_channels, batch_size, gc, dc
+    ):
+        W = np.random.randn(output_channels, input_channels).astype(np.float32)
+        X = np.random.randn(batch_size, input_channels).astype(np.float32)
+        b = np.random.randn(output_channels).astype(np.float32)
+
+        self.ws.create_blob("X").feed(X, device_option=gc)
+        self.ws.create_blob("W").feed(W, device_option=gc)
+        self.ws.create_blob("b").feed(b, device_option=gc)
+        net = core.Net("test_net")
+        net.Proto().op.extend(
+            [
+                core.CreateOperator(
+                    "FC",
+                    ["X", "W", "b"],
+                    ["Y"],
+                    engine="FBGEMM_FP16",
+                    device_option=gc,
+                )
+            ]
+        )
+        # Twice, the second time with the weight packed when the op was created
+        for _ in range(2):
+            self.ws.run(net)
+            Y = self.ws.blobs["Y"].fetch()
+
+            Wh = W.astype(np.float16).astype(np.float32)
+            Yref = np.matmul(X, Wh.transpose()) + b
+            np.testing.assert_allclose(Y, Yref, rtol=1e-3, atol=1e-3)
+
+    @given(
+        m=st.integers(1, 8),
+        n=st.integers(1, 32),
+        k=st.integers(1, 32),
+        batch_size=st.integers(0, 4),
+        trans_b=st.booleans(),
+        constant_b=st.booleans(),
+        **hu.gcs_cpu_only
+    )
+    def test_batch_matmul_fbgemm_fp16(
+        self, m, n, k, batch_size, trans_b, constant_b, gc, dc
+    ):
+        A = np.random.randn(batch_size, m, k).astype(np.float32)
+        B = np.random.randn(k, n).astype(np.float32)
+        if trans_b:
+            B = B.transpose().copy()
+
+        self.ws.create_blob("A").feed(A, device_option=gc)
+        self.ws.create_blob("B").feed(B, device_option=gc)
+        net = core.Net("test_net")
+        net.Proto().op.extend(
+            [
+                core.CreateOperator(
+                    "BatchMatMul",
+                    ["A", "B"],
+                    ["Y"],
+                    trans_b=trans_b,
+                    broadcast=1,
+                    constant_b=constant_b,
+                    engine="FBGEMM_FP16",
+                    device_option=gc,
+                )
+            ]
+        )
+        self.ws.run(net)
+        Y = self.ws.blobs["Y"].fetch()
+
+        Bh = B.astype(np.float16).astype(np.float32)
+        Yref = np.matmul(A, Bh.transpose() if trans_b else Bh)
+        np.testing.assert_allclose(Y, Yref, rtol=1e-3, atol=1e-3)
@@ -7,6 +7,7 @@
 #include <queue>
 
 #include "caffe2/core/blob_stats.h"
+#include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/stats.h"
 #include "caffe2/core/tensor.h"
@@ -30,6 +31,7 @@ BlobsQueue::BlobsQueue(
     bool enforceUniqueName,
     const std::vector<std::string>& fieldNames)
     : numBlobs_(numBlobs), name_(queueName), stats_(queueName) {
+  CAFFE_ENFORCE_GT(capacity, 0, "Queue capacity should be positive.");
   if (!fieldNames.empty()) {
     CAFFE_ENFORCE_EQ(
         fieldNames.size(), numBlobs, "Wrong number of fieldNames provided.");
@@ -52,6 +54,116 @@ BlobsQueue::BlobsQueue(
     queue_.push_back(blobs);
   }
   DCHECK_EQ(queue_.size(), capacity);
+  sequences_.reset(new std::atomic<int64_t>[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    sequences_[i].store(i);
+  }
+}
+
+bool BlobsQueue::canRead() const {
+  const auto pos = reader_.load();
+  return sequences_[pos % queue_.size()].load() == pos + 1;
+}
+
+bool BlobsQueue::canWrite() const {
+  const auto pos = writer_.load();
+  return sequences_[pos % queue_.size()].load() == pos;
+}
+
+size_t BlobsQueue::tryClaimRead(size_t maxRecords, int64_t* pos) {
+  const int64_t capacity = queue_.size();
+  int64_t start = reader_.load(std::memory_order_relaxed);
+  while (true) {
+    int64_t count = 0;
+    while (count < static_cast<int64_t>(maxRecords) && count < capacity &&
+           sequences_[(start + count) % capacity].load(
+               std::memory_order_acquire) == start + count + 1) {
+      ++count;
+    }
+    if (count == 0) {
+      // Either the queue is empty, or another reader took the record
+      const auto current = reader_.load(std::memory_order_relaxed);
+      if (current == start) {
+        return 0;
+      }
+      start = current;
+      continue;
+    }
+    // Positions only grow, so if the reader position did not change, none of
+    // the counted records has been read since they were checked
+    if (reader_.compare_exchange_weak(
+            start, start + count, std::memory_order_relaxed)) {
+      *pos = start;
+      return count;
+    }
+    CAFFE_EVENT(stats_, queue_contention);
+  }
+}
+
+bool BlobsQueue::tryClaimWrite(int64_t* pos) {
+  const int64_t capacity = queue_.size();
+  int64_t current = writer_.load(std::memory_order_relaxed);
+  while (true) {
+    const auto sequence =
+        sequences_[current % capacity].load(std::memory_order_acquire);
+    if (sequence == current) {
+      if (writer_.compare_exchange_weak(
+              current, current + 1, std::memory_order_relaxed)) {
+        *pos = current;
+        return true;
+      }
+      CAFFE_EVENT(stats_, queue_contention);
+    } else if (sequence < current) {
+      // The record of the previous round of this slot was not read yet
+      return false;
+    } else {
+      current = writer_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+size_t BlobsQueue::blockingClaimRead(
+    size_t maxRecords,
+    float timeout_secs,
+    int64_t* pos) {
+  auto count = tryClaimRead(maxRecords, pos);
+  if (count > 0) {
+    return count;
+  }
+  Timer waitTimer;
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  // Registering as a waiter before checking the queue again under the mutex
+  // guarantees that a writer publishing a record after that check notifies us
+  ++waitingReaders_;
+  {
+    std::unique_lock<std::mutex> g(mutex_);
+    auto ready = [this]() { return closing_ || canRead(); };
+    while (true) {
+      count = tryClaimRead(maxRecords, pos);
+      if (count > 0 || closing_) {
+        break;
+      }
+      if (timeout_secs > 0) {
+        if (!cv_.wait_until(g, deadline, ready)) {
+          count = tryClaimRead(maxRecords, pos);
+          break;
+        }
+      } else {
+        cv_.wait(g, ready);
+      }
+    }
+  }
+  --waitingReaders_;
+  CAFFE_EVENT(stats_, read_wait_time_ns, waitTimer.NanoSeconds());
+  return count;
+}
+
+void BlobsQueue::notifyWaiters(const std::atomic<int>& waiters) {
+  if (waiters.load() > 0) {
+    std::lock_guard<std::mutex> g(mutex_);
+    cv_.notify_all();
+  }
 }
 
 bool BlobsQueue::blockingRead(
@@ -61,22 +173,11 @@ bool BlobsQueue::blockingRead(
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  auto canRead = [this]() {
-    CAFFE_ENFORCE_LE(reader_, writer_);
-    return reader_ != writer_;
-  };
   // Decrease queue balance before reading to indicate queue read pressure
   // is being increased (-ve queue balance indicates more reads than writes)
   CAFFE_EVENT(stats_, queue_balance, -1);
-  if (timeout_secs > 0) {
-    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
-        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
-  } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
-  }
-  if (!canRead()) {
+  int64_t pos = 0;
+  if (blockingClaimRead(1, timeout_secs, &pos) == 0) {
     if (timeout_secs > 0 && !closing_) {
       LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
@@ -85,38 +186,62 @@ bool BlobsQueue::blockingRead(
     }
     return false;
   }
-  DCHECK(canRead());
-  auto& result = queue_[reader_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
-  }
+  doRead(pos, inputs);
   CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
   CAFFE_EVENT(stats_, queue_dequeued_records);
-  ++reader_;
-  cv_.notify_all();
+  notifyWaiters(waitingWriters_);
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
   return true;
 }
 
+size_t BlobsQueue::blockingReadBatch(
+    const std::vector<Blob*>& outputs,
+    size_t maxRecords,
+    float timeout_secs) {
+  CAFFE_ENFORCE_GT(maxRecords, 0);
+  Timer readTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
+  CAFFE_EVENT(stats_, queue_balance, -1);
+  int64_t pos = 0;
+  const auto count = blockingClaimRead(maxRecords, timeout_secs, &pos);
+  if (count == 0) {
+    if (timeout_secs > 0 && !closing_) {
+      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+    } else {
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+    }
+    return 0;
+  }
+  if (count == 1) {
+    doRead(pos, outputs);
+  } else {
+    CAFFE_EVENT(stats_, queue_balance, 1 - static_cast<int64_t>(count));
+    doReadConcat(pos, count, outputs);
+  }
+  CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
+  CAFFE_EVENT(stats_, queue_dequeued_records, count);
+  notifyWaiters(waitingWriters_);
+  CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
+  return count;
+}
+
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   Timer writeTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_NONBLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  if (!canWrite()) {
+  int64_t pos = 0;
+  if (!tryClaimWrite(&pos)) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(pos, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -126,17 +251,28 @@ bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
-  if (!canWrite()) {
+  int64_t pos = 0;
+  bool claimed = tryClaimWrite(&pos);
+  if (!claimed) {
+    Timer waitTimer;
+    ++waitingWriters_;
+    {
+      std::unique_lock<std::mutex> g(mutex_);
+      while (!(claimed = tryClaimWrite(&pos)) && !closing_) {
+        cv_.wait(g, [this]() { return closing_ || canWrite(); });
+      }
+    }
+    --waitingWriters_;
+    CAFFE_EVENT(stats_, write_wait_time_ns, waitTimer.NanoSeconds());
+  }
+  if (!claimed) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
-  DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(pos, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -148,26 +284,79 @@ void BlobsQueue::close() {
   cv_.notify_all();
 }
 
-bool BlobsQueue::canWrite() {
-  // writer is always within [reader, reader + size)
-  // we can write if reader is within [reader, reader + size)
-  CAFFE_ENFORCE_LE(reader_, writer_);
-  CAFFE_ENFORCE_LE(writer_, reader_ + queue_.size());
-  return writer_ != reader_ + queue_.size();
+void BlobsQueue::doRead(int64_t pos, const std::vector<Blob*>& inputs) {
+  const int64_t capacity = queue_.size();
+  auto& result = queue_[pos % capacity];
+  CAFFE_ENFORCE(inputs.size() >= result.size());
+  for (auto i = 0; i < result.size(); ++i) {
+    auto bytes = BlobStat::sizeBytes(*result[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
+  // Hand the slot over to the writer of the next round
+  sequences_[pos % capacity].store(pos + capacity);
+}
+
+void BlobsQueue::doReadConcat(
+    int64_t pos,
+    size_t count,
+    const std::vector<Blob*>& outputs) {
+  const int64_t capacity = queue_.size();
+  CAFFE_ENFORCE(outputs.size() >= numBlobs_);
+  CPUContext context;
+  for (auto col = 0; col < numBlobs_; ++col) {
+    const auto* firstBlob = queue_[pos % capacity][col];
+    CAFFE_ENFORCE(
+        BlobIsTensorType(*firstBlob, CPU),
+        "Only CPU tensors can be dequeued in batches, field ",
+        col);
+    const auto& first = firstBlob->Get<Tensor>();
+    CAFFE_ENFORCE_GT(
+        first.dim(), 0, "Empty tensor to dequeue at column ", col);
+    auto dims = first.sizes().vec();
+    dims[0] = 0;
+    for (size_t k = 0; k < count; ++k) {
+      const auto* blob = queue_[(pos + k) % capacity][col];
+      CAFFE_ENFORCE(BlobIsTensorType(*blob, CPU));
+      const auto& in = blob->Get<Tensor>();
+      CAFFE_ENFORCE(
+          in.dim() > 0 && in.dtype() == first.dtype() &&
+              in.sizes().slice(1) == first.sizes().slice(1),
+          "Records of column ",
+          col,
+          " can't be concatenated");
+      dims[0] += in.size(0);
+      CAFFE_EVENT(stats_, queue_dequeued_bytes, in.nbytes(), col);
+    }
+    auto* out = BlobGetMutableTensor(
+        outputs[col], dims, at::dtype(first.dtype()).device(CPU));
+    auto* dst = static_cast<char*>(out->raw_mutable_data(first.dtype()));
+    for (size_t k = 0; k < count; ++k) {
+      const auto& in = queue_[(pos + k) % capacity][col]->Get<Tensor>();
+      context.CopyItemsSameDevice(in.dtype(), in.numel(), in.raw_data(), dst);
+      dst += in.nbytes();
+    }
+  }
+  for (size_t k = 0; k < count; ++k) {
+    sequences_[(pos + k) % capacity].store(pos + k + capacity);
+  }
 }
 
-void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
-  auto& result = queue_[writer_ % queue_.size()];
+void BlobsQueue::doWrite(int64_t pos, const std::vector<Blob*>& inputs) {
+  const int64_t capacity = queue_.size();
+  auto& result = queue_[pos % capacity];
   CAFFE_ENFORCE(inputs.size() >= result.size());
   const auto& name = name_.c_str();
   for (auto i = 0; i < result.size(); ++i) {
     using std::swap;
     swap(*(inputs[i]), *(result[i]));
   }
+  // Publish the record to the readers
+  sequences_[pos % capacity].store(pos + 1);
   CAFFE_SDT(
-      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
-  ++writer_;
-  cv_.notify_all();
+      queue_write_end, name, (void*)this, reader_ + capacity - writer_);
+  notifyWaiters(waitingReaders_);
 }
 
 } // namespace caffe2
@@ -15,7 +15,10 @@
 namespace caffe2 {
 
 // A thread-safe, bounded, blocking queue.
-// Modelled as a circular buffer.
+// Modelled as a circular buffer of slots. Readers and writers claim slots with
+// a CAS on their position and hand them over through a sequence number per
+// slot, so that they only take a lock when they need to wait for the queue to
+// become non-empty or non-full.
 
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
@@ -37,6 +40,15 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   bool blockingRead(
       const std::vector<Blob*>& inputs,
       float timeout_secs = 0.0f);
+  // Reads up to maxRecords records at once, blocking until at least one is
+  // available. When more than one record is read, the CPU tensors of each
+  // field are concatenated along their first dimension into outputs.
+  // Returns the number of records read, 0 if the queue is closed and empty or
+  // if the read timed out.
+  size_t blockingReadBatch(
+      const std::vector<Blob*>& outputs,
+      size_t maxRecords,
+      float timeout_secs = 0.0f);
   bool tryWrite(const std::vector<Blob*>& inputs);
   bool blockingWrite(const std::vector<Blob*>& inputs);
   void close();
@@ -45,19 +57,38 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   }
 
  private:
-  bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
+  bool canRead() const;
+  bool canWrite() const;
+  // Claims up to maxRecords consecutive records from the read position,
+  // returns the number of records claimed and their first position in *pos
+  size_t tryClaimRead(size_t maxRecords, int64_t* pos);
+  size_t blockingClaimRead(size_t maxRecords, float timeout_secs, int64_t* pos);
+  bool tryClaimWrite(int64_t* pos);
+  void doRead(int64_t pos, const std::vector<Blob*>& inputs);
+  void doReadConcat(
+      int64_t pos,
+      size_t count,
+      const std::vector<Blob*>& outputs);
+  void doWrite(int64_t pos, const std::vector<Blob*>& inputs);
+  void notifyWaiters(const std::atomic<int>& waiters);
 
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
-  std::mutex mutex_; // protects all variables in the class.
-  std::condition_variable cv_;
-  int64_t reader_{0};
-  int64_t writer_{0};
+  // The slot of position p (p % capacity) holds the record of position p when
+  // its sequence is p + 1, and is free for it when its sequence is p.
+  std::unique_ptr<std::atomic<int64_t>[]> sequences_;
+  std::atomic<int64_t> reader_{0};
+  std::atomic<int64_t> writer_{0};
   std::vector<std::vector<Blob*>> queue_;
   const std::string name_;
 
+  // Only used to wait for the queue to become readable or writable
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<int> waitingReaders_{0};
+  std::atomic<int> waitingWriters_{0};
+
   struct QueueStats {
     CAFFE_STAT_CTOR(QueueStats);
     CAFFE_EXPORTED_STAT(queue_balance);
@@ -65,6 +96,10 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
     CAFFE_DETAILED_EXPORTED_STAT(queue_dequeued_bytes);
     CAFFE_AVG_EXPORTED_STAT(read_time_ns);
     CAFFE_AVG_EXPORTED_STAT(write_time_ns);
+    // Number of times a reader or writer lost a race for a slot
+    CAFFE_EXPORTED_STAT(queue_contention);
+    CAFFE_AVG_EXPORTED_STAT(read_wait_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(write_wait_time_ns);
   } stats_;
 };
 } // namespace caffe2
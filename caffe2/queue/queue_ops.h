@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <type_traits>
 #include "blobs_queue.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/utils/math.h"
@@ -139,8 +140,13 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
     }
 
     const int kTensorGrowthPct = 40;
-    for (int i = 0; i < numRecords_; ++i) {
-      if (!queue->blockingRead(blobPtrs_)) {
+    for (int i = 0; i < numRecords_;) {
+      // On CPU, the queue concatenates all the records available at once, so
+      // that they are claimed and copied in one go
+      size_t numRead = std::is_same<Context, CPUContext>::value
+          ? queue->blockingReadBatch(blobPtrs_, numRecords_ - i)
+          : queue->blockingRead(blobPtrs_);
+      if (numRead == 0) {
         // if we read at least one record, status is still true
         return i > 0;
       }
@@ -167,6 +173,7 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
               in.meta(), in.numel(), in.raw_data(), dst);
         }
       }
+      i += numRead;
     }
     return true;
   }
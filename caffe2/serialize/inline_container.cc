@@ -180,6 +180,7 @@ static size_t getPadding(
 }
 
 bool PyTorchStreamReader::hasRecord(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   std::string ss = archive_name_plus_slash_ + name;
   mz_zip_reader_locate_file(ar_.get(), ss.c_str(), nullptr, 0);
   bool result = ar_->m_last_error != MZ_ZIP_FILE_NOT_FOUND;
@@ -191,6 +192,7 @@ bool PyTorchStreamReader::hasRecord(const std::string& name) {
 }
 
 std::vector<std::string> PyTorchStreamReader::getAllRecords() {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   mz_uint num_files = mz_zip_reader_get_num_files(ar_.get());
   std::vector<std::string> out;
   char buf[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
@@ -211,37 +213,67 @@ size_t PyTorchStreamReader::getRecordID(const std::string& name) {
   return result;
 }
 
+static int64_t read_le_16(uint8_t* buf) {
+  return buf[0] + (buf[1] << 8);
+}
+
+// Returns the offset of the data of the file whose local header is at
+// `local_header_ofs`.
+static size_t getDataOffset(
+    const ReadAdapterInterface& in,
+    uint64_t local_header_ofs) {
+  uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
+  in.read(
+      local_header_ofs,
+      local_header,
+      MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
+      "reading file header");
+  size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
+  size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+  return local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+}
+
 // return dataptr, size
 std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   size_t key = getRecordID(name);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data for ", name.c_str());
+
+  // A record that is stored uncompressed and aligned (as PyTorchStreamWriter
+  // writes them) is returned without copying it if the reader supports that,
+  // e.g. when it maps the file. Its CRC is then not checked, since that would
+  // touch all of it.
+  if (stat.m_method == 0 && stat.m_comp_size == stat.m_uncomp_size) {
+    size_t offset = getDataOffset(*in_, stat.m_local_header_ofs);
+    if (offset % kFieldAlignment == 0) {
+      at::DataPtr alias = in_->aliasData(offset, stat.m_uncomp_size);
+      if (alias) {
+        return std::make_tuple(std::move(alias), stat.m_uncomp_size);
+      }
+    }
+  }
+
+  // The raw data of a stored record is the record itself, and reading it raw
+  // skips the CRC check.
+  mz_uint flags = !verify_crc_ && stat.m_method == 0
+      ? MZ_ZIP_FLAG_COMPRESSED_DATA
+      : 0;
   void * ptr = malloc(stat.m_uncomp_size);
-  mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, 0);
+  mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, flags);
   valid("reading file ", name.c_str());
 
   at::DataPtr retval(ptr, ptr, free, at::kCPU);
   return std::make_tuple(std::move(retval), stat.m_uncomp_size);
 }
 
-static int64_t read_le_16(uint8_t* buf) {
-  return buf[0] + (buf[1] << 8);
-}
-
 size_t PyTorchStreamReader::getRecordOffset(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
   valid("retrieving file meta-data for ", name.c_str());
-  uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
-  in_->read(
-      stat.m_local_header_ofs,
-      local_header,
-      MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
-      "reading file header");
-  size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
-  size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+  return getDataOffset(*in_, stat.m_local_header_ofs);
 }
 
 
@@ -319,7 +351,7 @@ void PyTorchStreamWriter::writeRecord(
   std::string full_name = archive_name_plus_slash_ + name;
   size_t padding_size =
       getPadding(ar_->m_archive_size, full_name.size(), size, padding_);
-  uint32_t flags = compress ? MZ_BEST_COMPRESSION : 0;
+  uint32_t flags = compress ? MZ_BEST_SPEED : 0;
   mz_zip_writer_add_mem_ex_v2(
       ar_.get(),
       full_name.c_str(),
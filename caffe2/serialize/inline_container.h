@@ -5,6 +5,7 @@
 #include <cstring>
 #include <fstream>
 #include <istream>
+#include <mutex>
 #include <ostream>
 
 #include <c10/core/Allocator.h>
@@ -103,9 +104,20 @@ constexpr uint64_t kMaxSupportedFileFormatVersion = 0x5L;
 //      when given integer fill values.
 constexpr uint64_t kProducedFileFormatVersion = 0x4L;
 
+// The bytecode archive of the lite interpreter (bytecode.pkl) has its own
+// version, written as its first element.
+// Versions:
+// 2. (Implicit) Archives written before the version was added
+// 3. Added the version. Stores whose value is immediately moved back are
+//    removed.
+constexpr uint64_t kMinSupportedBytecodeVersion = 0x2L;
+constexpr uint64_t kProducedBytecodeVersion = 0x3L;
+
 // Writer-specific constants
 constexpr uint64_t kFieldAlignment = 64;
 
+// The methods of PyTorchStreamReader may be called from several threads at
+// once; they are serialized internally.
 class CAFFE2_API PyTorchStreamReader final {
  public:
   explicit PyTorchStreamReader(const std::string& file_name);
@@ -123,6 +135,13 @@ class CAFFE2_API PyTorchStreamReader final {
     return version_;
   }
 
+  // Whether getRecord checks the CRC32 of the records stored uncompressed,
+  // which reads all of them once more. Archives from trusted sources may skip
+  // it. Compressed records are always checked, as they are inflated.
+  void setVerifyCrc(bool verify_crc) {
+    verify_crc_ = verify_crc;
+  }
+
  private:
   void init();
   size_t read(uint64_t pos, char* buf, size_t n);
@@ -136,6 +155,8 @@ class CAFFE2_API PyTorchStreamReader final {
   std::string archive_name_plus_slash_;
   std::unique_ptr<ReadAdapterInterface> in_;
   int64_t version_;
+  std::mutex reader_lock_;
+  bool verify_crc_ = true;
 };
 
 class CAFFE2_API PyTorchStreamWriter final {
@@ -144,6 +165,10 @@ class CAFFE2_API PyTorchStreamWriter final {
   explicit PyTorchStreamWriter(
       const std::function<size_t(const void*, size_t)>& writer_func);
 
+  // Records are stored uncompressed, so that readers can map them, unless
+  // `compress` is set, in which case they are deflated at the fastest level;
+  // this is worth it for tensors with many repeated values, like sparse
+  // embeddings.
   void writeRecord(
       const std::string& name,
       const void* data,
@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -63,6 +64,48 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, LoadMapped) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  writer.writeRecord("key1", data1.data(), data1.size());
+  writer.writeEndOfFile();
+
+  std::string the_file = oss.str();
+  const char* file_name = "output_mapped.zip";
+  std::ofstream foo(file_name, std::ios::binary);
+  foo.write(the_file.c_str(), the_file.size());
+  foo.close();
+
+  at::DataPtr data_ptr;
+  int64_t size;
+  {
+    PyTorchStreamReader reader(std::make_unique<MmapFileAdapter>(file_name));
+    ASSERT_TRUE(reader.hasRecord("key1"));
+    std::tie(data_ptr, size) = reader.getRecord("key1");
+  }
+  // The record aliases the mapping, which outlives the reader.
+  ASSERT_NE(data_ptr.get(), data_ptr.get_context());
+  ASSERT_EQ(size, data1.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+
+  // Writing to the record doesn't change the file.
+  static_cast<char*>(data_ptr.get())[0] = 0;
+  PyTorchStreamReader reader(std::make_unique<MmapFileAdapter>(file_name));
+  at::DataPtr other_ptr;
+  std::tie(other_ptr, size) = reader.getRecord("key1");
+  ASSERT_EQ(memcmp(other_ptr.get(), data1.data(), data1.size()), 0);
+  data_ptr.clear();
+  other_ptr.clear();
+  std::remove(file_name);
+}
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
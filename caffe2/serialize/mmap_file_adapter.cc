@@ -0,0 +1,153 @@
+#include "caffe2/serialize/mmap_file_adapter.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <c10/util/Exception.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace caffe2 {
+namespace serialize {
+
+struct MmapFileAdapter::Mapping {
+  C10_DISABLE_COPY_AND_ASSIGN(Mapping);
+  explicit Mapping(const std::string& file_name);
+  ~Mapping();
+
+  // nullptr for an empty file, which can't be mapped.
+  char* base = nullptr;
+  size_t size = 0;
+};
+
+#ifdef _WIN32
+
+MmapFileAdapter::Mapping::Mapping(const std::string& file_name) {
+  HANDLE file = CreateFileA(
+      file_name.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    AT_ERROR("getting the size of file failed, file path: ", file_name);
+  }
+  size = static_cast<size_t>(file_size.QuadPart);
+  if (size > 0) {
+    // PAGE_WRITECOPY and FILE_MAP_COPY make the view copy-on-write.
+    HANDLE handle =
+        CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (handle != nullptr) {
+      base = static_cast<char*>(MapViewOfFile(handle, FILE_MAP_COPY, 0, 0, 0));
+      CloseHandle(handle);
+    }
+  }
+  CloseHandle(file);
+  if (size > 0 && base == nullptr) {
+    AT_ERROR("mapping file failed, file path: ", file_name);
+  }
+}
+
+MmapFileAdapter::Mapping::~Mapping() {
+  if (base != nullptr) {
+    UnmapViewOfFile(base);
+  }
+}
+
+#else
+
+MmapFileAdapter::Mapping::Mapping(const std::string& file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    AT_ERROR("getting the size of file failed, file path: ", file_name);
+  }
+  size = static_cast<size_t>(file_stat.st_size);
+  void* ptr = MAP_FAILED;
+  if (size > 0) {
+    // A private mapping is copy-on-write, so it can be writable although the
+    // file was opened read-only.
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+  if (size > 0) {
+    if (ptr == MAP_FAILED) {
+      AT_ERROR(
+          "mapping file failed, file path: ",
+          file_name,
+          ": ",
+          std::strerror(errno));
+    }
+    base = static_cast<char*>(ptr);
+  }
+}
+
+MmapFileAdapter::Mapping::~Mapping() {
+  if (base != nullptr) {
+    munmap(base, size);
+  }
+}
+
+#endif
+
+MmapFileAdapter::MmapFileAdapter(const std::string& file_name)
+    : mapping_(std::make_shared<Mapping>(file_name)) {}
+
+size_t MmapFileAdapter::size() const {
+  return mapping_->size;
+}
+
+size_t MmapFileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  if (pos > mapping_->size || n > mapping_->size - pos) {
+    AT_ERROR("mmap reader failed: ", what, ".");
+  }
+  if (n > 0) {
+    std::memcpy(buf, mapping_->base + pos, n);
+  }
+  return n;
+}
+
+at::DataPtr MmapFileAdapter::aliasData(uint64_t pos, size_t n) const {
+  TORCH_CHECK(
+      pos <= mapping_->size && n <= mapping_->size - pos,
+      "aliasing [",
+      pos,
+      ", ",
+      pos + n,
+      ") of a mapped file of ",
+      mapping_->size,
+      " bytes");
+  // Every DataPtr holds a reference to the mapping, so that records outlive
+  // the reader they come from.
+  auto* ctx = new std::shared_ptr<Mapping>(mapping_);
+  return at::DataPtr(
+      mapping_->base + pos,
+      ctx,
+      [](void* ptr) { delete static_cast<std::shared_ptr<Mapping>*>(ptr); },
+      at::kCPU);
+}
+
+MmapFileAdapter::~MmapFileAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
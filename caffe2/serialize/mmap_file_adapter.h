@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// A reader that maps the whole file into memory. Besides read(), which copies
+// out of the mapping, it implements aliasData(), so PyTorchStreamReader hands
+// out records (and torch::jit::load builds tensor storages) that point into the
+// mapping instead of copies of it. The mapping is private: writing to a record
+// copies the pages written to, and never modifies the file. Pages that are
+// only read are backed by the page cache, so processes that load the same file
+// share them.
+//
+// The mapping lives until this adapter and every DataPtr returned by
+// aliasData() are gone. The file must not be truncated while it is mapped.
+class CAFFE2_API MmapFileAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MmapFileAdapter);
+  explicit MmapFileAdapter(const std::string& file_name);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  at::DataPtr aliasData(uint64_t pos, size_t n) const override;
+  ~MmapFileAdapter();
+
+ private:
+  struct Mapping;
+  std::shared_ptr<Mapping> mapping_;
+};
+
+} // namespace serialize
+} // namespace caffe2
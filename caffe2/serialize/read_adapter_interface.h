@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "c10/core/Allocator.h"
 #include "c10/macros/Macros.h"
 
 namespace caffe2 {
@@ -16,6 +17,11 @@ class CAFFE2_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // Adapters whose data stays addressable for as long as a DataPtr may live
+  // (e.g. a mapped file) can return a DataPtr that aliases [pos, pos + n)
+  // instead of copying it. The default returns an empty DataPtr, which tells
+  // the caller to read() the data instead.
+  virtual at::DataPtr aliasData(uint64_t pos, size_t n) const;
   virtual ~ReadAdapterInterface();
 };
 
@@ -1,9 +1,12 @@
 #include "caffe2/utils/threadpool/ThreadPool.h"
 #include "WorkersPool.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/utils/threadpool/pthreadpool.h"
 
 #include <cpuinfo.h>
 
+#include <atomic>
+
 C10_DEFINE_bool(
     caffe2_threadpool_force_inline,
     false,
@@ -15,6 +18,26 @@ C10_DEFINE_int(caffe2_threadpool_android_cap, true, "");
 // Whether or not threadpool caps apply to iOS
 C10_DEFINE_int(caffe2_threadpool_ios_cap, true, "");
 
+namespace {
+
+// Defined here rather than with the pthreadpool shims, which are not built on
+// every platform.
+std::atomic<const pthreadpool_executor*> global_executor{nullptr};
+
+} // namespace
+
+extern "C" {
+
+void pthreadpool_set_executor(const pthreadpool_executor* new_executor) {
+  global_executor.store(new_executor, std::memory_order_release);
+}
+
+const pthreadpool_executor* pthreadpool_get_executor() {
+  return global_executor.load(std::memory_order_acquire);
+}
+
+} // extern "C"
+
 namespace caffe2 {
 
 size_t getDefaultNumThreads() {
@@ -92,7 +115,33 @@ ThreadPool::ThreadPool(int numThreads)
 
 ThreadPool::~ThreadPool() {}
 
+namespace {
+
+#ifndef C10_MOBILE
+// On servers ATen's intra-op pool runs the work. On mobile ATen itself runs
+// on mobile_threadpool(), so its pools keep their own workers.
+const pthreadpool_executor* serverExecutor() {
+  return pthreadpool_get_executor();
+}
+#else
+const pthreadpool_executor* serverExecutor() {
+  return nullptr;
+}
+#endif
+
+void runFnRange(void* fn, size_t threadId, size_t begin, size_t end) {
+  const auto& f = *static_cast<const std::function<void(int, size_t)>*>(fn);
+  for (size_t i = begin; i < end; ++i) {
+    f(threadId, i);
+  }
+}
+
+} // namespace
+
 int ThreadPool::getNumThreads() const {
+  if (const auto* executor = serverExecutor()) {
+    return executor->get_threads_count();
+  }
   return numThreads_;
 }
 
@@ -114,6 +163,23 @@ void ThreadPool::setMinWorkSize(size_t size) {
 }
 
 void ThreadPool::run(const std::function<void(int, size_t)>& fn, size_t range) {
+  if (const auto* executor = serverExecutor()) {
+    size_t minWorkSize;
+    {
+      std::lock_guard<std::mutex> guard(executionMutex_);
+      minWorkSize = minWorkSize_;
+    }
+    if (range >= minWorkSize && !FLAGS_caffe2_threadpool_force_inline) {
+      // Not under executionMutex_: the executor takes concurrent calls, and
+      // its workers may themselves call into this pool.
+      executor->parallelize(
+          &runFnRange,
+          const_cast<std::function<void(int, size_t)>*>(&fn),
+          range);
+      return;
+    }
+  }
+
   const auto numThreads = numThreads_.load(std::memory_order_relaxed);
 
   std::lock_guard<std::mutex> guard(executionMutex_);
@@ -10,7 +10,12 @@ caffe2::ThreadPool* mobile_threadpool() {
       caffe2::ThreadPool::defaultThreadPool();
   return thread_pool.get();
 #else
-  return nullptr;
+  // On servers the pool only forwards to the executor ATen sets, and there is
+  // no pool without one.
+  static std::unique_ptr<caffe2::ThreadPool> thread_pool =
+      pthreadpool_get_executor() ? std::make_unique<caffe2::ThreadPool>(1)
+                                 : nullptr;
+  return thread_pool.get();
 #endif
 }
 
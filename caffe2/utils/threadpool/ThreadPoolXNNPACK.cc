@@ -10,8 +10,13 @@ pthreadpool_t xnnpack_threadpool() {
 // Depending on internal implemenation vs. OSS we will link against pthreadpool_create_xnnpack
 // or pthreadpool_create. This is only temporary. It will be unified soon.
 #ifdef USE_INTERNAL_THREADPOOL_IMPL
+  // With an executor set the work runs on it, so the pool needs no threads
+  // of its own.
   static std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy_xnnpack)>
-      threadpool(pthreadpool_create_xnnpack(getDefaultNumThreads()), pthreadpool_destroy_xnnpack);
+      threadpool(
+          pthreadpool_create_xnnpack(
+              pthreadpool_get_executor() ? 1 : getDefaultNumThreads()),
+          pthreadpool_destroy_xnnpack);
 #else
   static std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)>
       threadpool(pthreadpool_create(getDefaultNumThreads()), pthreadpool_destroy);
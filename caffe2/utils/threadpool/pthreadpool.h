@@ -195,6 +195,33 @@ size_t pthreadpool_get_threads_count_xnnpack(pthreadpool_t threadpool);
 // Copied third-party impl.
 void pthreadpool_destroy_xnnpack(pthreadpool_t threadpool);
 
+/**
+ * Runs fn(context, thread_id, begin, end) on disjoint ranges covering
+ * [0, range), thread_id being less than the threads count of the executor.
+ */
+typedef void (*pthreadpool_executor_task_t)(void*, size_t, size_t, size_t);
+
+/**
+ * Process-wide executor the work of caffe2::ThreadPool (on servers) and of
+ * the pthreadpool_parallelize_* functions is run on instead of the threads
+ * of the pool, so that all the libraries share one set of worker threads.
+ * ATen sets it to its intra-op pool.
+ */
+struct pthreadpool_executor {
+  /* Number of threads the work is split between, the caller included. */
+  size_t (*get_threads_count)(void);
+  /* Returns once all the ranges are processed. */
+  void (*parallelize)(pthreadpool_executor_task_t task, void* context, size_t range);
+};
+
+/**
+ * Sets the executor, which must outlive every pool. NULL runs the work on
+ * the threads of the pools again.
+ */
+void pthreadpool_set_executor(const struct pthreadpool_executor* executor);
+
+const struct pthreadpool_executor* pthreadpool_get_executor(void);
+
 /**
  * Processes items in parallel using threads from a thread pool.
  *
@@ -478,13 +478,42 @@ struct pthreadpool* pthreadpool_create_xnnpack(size_t threads_count) {
 }
 
 size_t pthreadpool_get_threads_count_xnnpack(struct pthreadpool* threadpool) {
+  const struct pthreadpool_executor* executor = pthreadpool_get_executor();
   if (threadpool == NULL) {
     return 1;
+  } else if (executor != NULL) {
+    return executor->get_threads_count();
   } else {
     return threadpool->threads_count;
   }
 }
 
+/* The work of a pool goes to the executor, if one is set, even if the pool has no threads of its own. */
+static bool run_sequentially(struct pthreadpool* threadpool) {
+  return threadpool == NULL || (threadpool->threads_count <= 1 && pthreadpool_get_executor() == NULL);
+}
+
+struct executor_task_1d {
+  pthreadpool_task_1d_t task;
+  void* argument;
+  uint32_t flags;
+};
+
+static void compute_executor_range(void* context, size_t thread_id, size_t range_start, size_t range_end) {
+  const struct executor_task_1d* executor_task = (const struct executor_task_1d*) context;
+  struct fpu_state saved_fpu_state = { 0 };
+  if (executor_task->flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
+    saved_fpu_state = get_fpu_state();
+    disable_fpu_denormals();
+  }
+  for (size_t i = range_start; i < range_end; i++) {
+    executor_task->task(executor_task->argument, i);
+  }
+  if (executor_task->flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
+    set_fpu_state(saved_fpu_state);
+  }
+}
+
 void pthreadpool_parallelize_1d(
   struct pthreadpool* threadpool,
   pthreadpool_task_1d_t task,
@@ -492,7 +521,12 @@ void pthreadpool_parallelize_1d(
   size_t range,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  const struct pthreadpool_executor* executor = pthreadpool_get_executor();
+  if (threadpool != NULL && executor != NULL) {
+    /* Run on the shared executor rather than on the threads of the pool */
+    struct executor_task_1d executor_task = { task, argument, flags };
+    executor->parallelize(&compute_executor_range, &executor_task, range);
+  } else if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -617,7 +651,7 @@ void pthreadpool_parallelize_1d_tile_1d(
   size_t tile,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -663,7 +697,7 @@ void pthreadpool_parallelize_2d(
   size_t range_j,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -717,7 +751,7 @@ void pthreadpool_parallelize_2d_tile_1d(
   size_t tile_j,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -779,7 +813,7 @@ void pthreadpool_parallelize_2d_tile_2d(
   size_t tile_j,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -848,7 +882,7 @@ void pthreadpool_parallelize_3d_tile_2d(
   size_t tile_k,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -927,7 +961,7 @@ void pthreadpool_parallelize_4d_tile_2d(
   size_t tile_l,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -1016,7 +1050,7 @@ void pthreadpool_parallelize_5d_tile_2d(
   size_t tile_m,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
@@ -1113,7 +1147,7 @@ void pthreadpool_parallelize_6d_tile_2d(
   size_t tile_n,
   uint32_t flags)
 {
-  if (threadpool == NULL || threadpool->threads_count <= 1) {
+  if (run_sequentially(threadpool)) {
     /* No thread pool used: execute task sequentially on the calling thread */
     struct fpu_state saved_fpu_state = { 0 };
     if (flags & PTHREADPOOL_FLAG_DISABLE_DENORMALS) {
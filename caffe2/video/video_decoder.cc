@@ -369,6 +369,10 @@ void VideoDecoder::decodeLoop(
     std::mt19937 meta_randgen(time(nullptr));
     long int start_ts = -1;
     bool mustDecodeAll = false;
+    // Starting timestamps of the clips to sample with DO_UNIFORM_SMP and
+    // num_of_clips_, see Params.
+    std::vector<long int> clipStartTs;
+    long int margin = 0;
 
     if (videoStream_->duration > 0 && videoStream_->nb_frames > 0) {
       /* we have a valid duration and nb_frames. We can safely
@@ -376,7 +380,7 @@ void VideoDecoder::decodeLoop(
 
       // leave a margin of 10 frames to take in to account the error
       // from av_seek_frame
-      long int margin =
+      margin =
           int(ceil((10 * videoStream_->duration) / (videoStream_->nb_frames)));
       // if we need to do temporal jittering
       if (params.decode_type_ == DecodeType::DO_TMP_JITTER) {
@@ -411,6 +415,26 @@ void VideoDecoder::decodeLoop(
             videoStreamIndex_,
             0 > (start_ts - margin) ? 0 : (start_ts - margin),
             AVSEEK_FLAG_BACKWARD);
+      } else if (
+          params.decode_type_ == DecodeType::DO_UNIFORM_SMP &&
+          params.num_of_clips_ > 1 && params.num_of_required_frame_ > 0 &&
+          !params.keyFrames_ && params.intervals_.size() == 1 &&
+          params.intervals_[0].fps == SpecialFps::SAMPLE_ALL_FRAMES) {
+        // Only decode the frames of the clips if there are frames to skip
+        // between them, otherwise decode all frames as usual.
+        const double step =
+            double(videoStream_->nb_frames - params.num_of_required_frame_) /
+            (params.num_of_clips_ - 1);
+        if (step > params.num_of_required_frame_) {
+          for (int i = 0; i < params.num_of_clips_; i++) {
+            clipStartTs.push_back(int(floor(
+                (videoStream_->duration * floor(i * step)) /
+                (videoStream_->nb_frames))));
+          }
+          start_ts = clipStartTs[0];
+        } else {
+          mustDecodeAll = true;
+        }
       } else {
         mustDecodeAll = true;
       }
@@ -432,6 +456,10 @@ void VideoDecoder::decodeLoop(
     int maxFrames = (params.decode_type_ == DecodeType::DO_UNIFORM_SMP)
         ? MAX_DECODING_FRAMES
         : params.num_of_required_frame_;
+    if (!clipStartTs.empty()) {
+      maxFrames = params.num_of_clips_ * params.num_of_required_frame_;
+    }
+    size_t clipIndex = 0;
     // There is a delay between reading packets from the
     // transport and getting decoded frames back.
     // Therefore, after EOF, continue going while
@@ -488,6 +516,13 @@ void VideoDecoder::decodeLoop(
           }
         }
 
+        // Frames before start_ts are never output, so those that no other
+        // frame refers to don't need to be decoded.
+        if (!mustDecodeAll && packet.data != nullptr &&
+            packet.pts != AV_NOPTS_VALUE) {
+          videoCodecContext_->skip_frame =
+              packet.pts < start_ts ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+        }
         ret = avcodec_decode_video2(
             videoCodecContext_, videoStreamFrame_, &gotPicture, &packet);
         if (ret < 0) {
@@ -617,6 +652,23 @@ void VideoDecoder::decodeLoop(
 
               selectiveDecodedFrames++;
               av_frame_free(&rgbFrame);
+
+              // Once a clip is complete, go to the next one, seeking to it
+              // when it starts further than the margin of the seek.
+              if (!clipStartTs.empty() &&
+                  selectiveDecodedFrames % params.num_of_required_frame_ ==
+                      0 &&
+                  clipIndex + 1 < clipStartTs.size()) {
+                start_ts = clipStartTs[++clipIndex];
+                if (start_ts - margin > frame_ts &&
+                    av_seek_frame(
+                        inputContext,
+                        videoStreamIndex_,
+                        start_ts - margin,
+                        AVSEEK_FLAG_BACKWARD) >= 0) {
+                  avcodec_flush_buffers(videoCodecContext_);
+                }
+              }
             } catch (const std::exception&) {
               av_frame_free(&rgbFrame);
             }
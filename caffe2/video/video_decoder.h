@@ -114,6 +114,11 @@ class Params {
   // params for decoding behavior
   int decode_type_ = DecodeType::DO_TMP_JITTER;
   int num_of_required_frame_ = -1;
+  // With DO_UNIFORM_SMP, the number of clips of num_of_required_frame_ frames
+  // that are going to be sampled uniformly from the video. When it is more
+  // than 1, the decoder only outputs the frames of these clips, one clip after
+  // the other, and seeks over the frames between them. 0 outputs all frames.
+  int num_of_clips_ = 0;
 
   // intervals_ control variable sampling fps between different timestamps
   // intervals_ must be ordered strictly ascending by timestamps
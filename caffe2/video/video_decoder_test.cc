@@ -0,0 +1,106 @@
+#include <caffe2/video/video_decoder.h>
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+namespace caffe2 {
+namespace {
+
+const int kNumFrames = 100;
+const int kWidth = 64;
+const int kHeight = 48;
+const int kClipLength = 8;
+
+// Writes a video whose frame i is uniformly gray with level 2 * i, and
+// returns false if no video writer is available.
+bool WriteTestVideo(const std::string& filename) {
+  cv::VideoWriter writer(
+      filename,
+      cv::VideoWriter::fourcc('M', 'J', 'P', 'G'),
+      25,
+      cv::Size(kWidth, kHeight));
+  if (!writer.isOpened()) {
+    return false;
+  }
+  for (int i = 0; i < kNumFrames; i++) {
+    writer.write(cv::Mat(kHeight, kWidth, CV_8UC3, cv::Scalar::all(2 * i)));
+  }
+  return true;
+}
+
+std::vector<std::vector<unsigned char>> DecodeClips(
+    const std::string& filename,
+    int clip_per_video,
+    int num_of_clips) {
+  Params params;
+  params.maximumOutputFrames_ = 1000;
+  params.outputWidth_ = kWidth;
+  params.outputHeight_ = kHeight;
+  params.decode_type_ = DecodeType::DO_UNIFORM_SMP;
+  params.num_of_required_frame_ = kClipLength;
+  params.num_of_clips_ = num_of_clips;
+
+  int height = 0, width = 0;
+  std::vector<unsigned char*> buffer_rgb;
+  DecodeMultipleClipsFromVideo(
+      nullptr,
+      filename,
+      0,
+      params,
+      0,
+      clip_per_video,
+      {},
+      true,
+      height,
+      width,
+      buffer_rgb);
+  EXPECT_EQ(height, kHeight);
+  EXPECT_EQ(width, kWidth);
+
+  const int clip_size = kClipLength * 3 * kHeight * kWidth;
+  std::vector<std::vector<unsigned char>> clips;
+  for (unsigned char* buffer : buffer_rgb) {
+    clips.emplace_back(buffer, buffer + clip_size);
+    delete[] buffer;
+  }
+  return clips;
+}
+
+} // namespace
+
+// Decoding only the uniformly sampled clips gives the same clips as decoding
+// all the frames and sampling them afterwards.
+TEST(VideoDecoderTest, UniformSamplingDecodesOnlyTheClips) {
+  const std::string filename = std::tmpnam(nullptr) + std::string(".avi");
+  if (!WriteTestVideo(filename)) {
+    return;
+  }
+  const int frame_size = 3 * kHeight * kWidth;
+  for (int clip_per_video : {2, 3, 5, 10}) {
+    auto clips = DecodeClips(filename, clip_per_video, clip_per_video);
+    auto reference = DecodeClips(filename, clip_per_video, 0);
+    ASSERT_EQ(clips.size(), size_t(clip_per_video));
+    ASSERT_EQ(reference.size(), size_t(clip_per_video));
+
+    const double step =
+        double(kNumFrames - kClipLength) / (clip_per_video - 1);
+    for (int i = 0; i < clip_per_video; i++) {
+      EXPECT_TRUE(clips[i] == reference[i])
+          << "clip " << i << " of " << clip_per_video;
+      for (int j = 0; j < kClipLength; j++) {
+        const unsigned char* frame = clips[i].data() + j * frame_size;
+        const double level =
+            std::accumulate(frame, frame + frame_size, 0.0) / frame_size;
+        EXPECT_NEAR(level, 2 * (std::floor(i * step) + j), 1.0)
+            << "frame " << j << " of clip " << i << " of " << clip_per_video;
+      }
+    }
+  }
+  std::remove(filename.c_str());
+}
+
+} // namespace caffe2
@@ -692,6 +692,12 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
   params.outputHeight_ = scale_h_;
   params.decode_type_ = decode_type_;
   params.num_of_required_frame_ = num_of_required_frame_;
+  // The start positions of the clips are frame indices among all frames, so
+  // all frames have to be decoded then.
+  if (decode_type_ == DecodeType::DO_UNIFORM_SMP &&
+      clip_start_positions_.empty()) {
+    params.num_of_clips_ = clip_per_video_;
+  }
 
   if (jitter_scales_.size() > 0) {
     int select_idx =
@@ -110,6 +110,16 @@ if(INTERN_BUILD_ATEN_OPS)
     endif(MSVC)
   endif(CXX_AVX2_FOUND)
 
+  if(CXX_AVX512_FOUND)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_CPU_DEFINITION")
+    list(APPEND CPU_CAPABILITY_NAMES "AVX512")
+    if(MSVC)
+      list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX512")
+    else(MSVC)
+      list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma")
+    endif(MSVC)
+  endif(CXX_AVX512_FOUND)
+
   list(LENGTH CPU_CAPABILITY_NAMES NUM_CPU_CAPABILITY_NAMES)
   math(EXPR NUM_CPU_CAPABILITY_NAMES "${NUM_CPU_CAPABILITY_NAMES}-1")
 
@@ -126,6 +136,15 @@ if(INTERN_BUILD_ATEN_OPS)
       else(MSVC)
         set(EXTRA_FLAGS "-DCPU_CAPABILITY=${CPU_CAPABILITY} -DCPU_CAPABILITY_${CPU_CAPABILITY}")
       endif(MSVC)
+      # AVX512 kernels keep using the Vec256 AVX2 code paths, except where they
+      # opt in to Vec512.
+      if("${CPU_CAPABILITY}" STREQUAL "AVX512")
+        if(MSVC)
+          set(EXTRA_FLAGS "${EXTRA_FLAGS} /DCPU_CAPABILITY_AVX2")
+        else(MSVC)
+          set(EXTRA_FLAGS "${EXTRA_FLAGS} -DCPU_CAPABILITY_AVX2")
+        endif(MSVC)
+      endif()
       # Disable certain warnings for GCC-9.X
       if(CMAKE_COMPILER_IS_GNUCXX AND (CMAKE_CXX_COMPILER_VERSION VERSION_GREATER 9.0.0))
         if(("${NAME}" STREQUAL "native/cpu/GridSamplerKernel.cpp") AND ("${CPU_CAPABILITY}" STREQUAL "DEFAULT"))
@@ -177,6 +196,9 @@ if(INTERN_BUILD_ATEN_OPS)
     )
     separate_arguments(OP_REGISTRATION_WHITELIST)
     message(STATUS "Custom build with op registration whitelist: ${OP_REGISTRATION_WHITELIST}")
+    # The same list, separated by commas, filters the registration of the JIT
+    # operators (see torch/csrc/jit/runtime/operator.cpp).
+    string(REPLACE ";" "," TORCH_OPERATOR_WHITELIST "${OP_REGISTRATION_WHITELIST}")
     list(APPEND CUSTOM_BUILD_FLAGS
       --force_schema_registration
       --op_registration_whitelist ${OP_REGISTRATION_WHITELIST})
@@ -153,6 +153,8 @@
 #       OMP - use OpenMP for intra-op and native backend for inter-op tasks
 #       NATIVE - use native thread pool for both intra- and inter-op tasks
 #       TBB - using TBB for intra- and native thread pool for inter-op parallelism
+#       WORK_STEALING - use work-stealing thread pool for intra- and native
+#         thread pool for inter-op parallelism
 #
 #   USE_TBB
 #      enable TBB support
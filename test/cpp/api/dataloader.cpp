@@ -8,7 +8,9 @@
 #include <c10/util/tempfile.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
@@ -450,6 +452,101 @@ TEST(DataTest, TensorDatasetConstructsFromInitializerListOfTensors) {
       torch::tensor({0, 0, 1, 0, 0}, torch::kFloat32).allclose(dataset.get(2)));
 }
 
+// Writes a columnar dataset of 10 rows, with a fixed-width column whose row
+// `i` is filled with `i` and a variable-length column whose row `i` holds the
+// numbers `0, ..., i - 1`.
+datasets::ColumnarDataset make_columnar_dataset(const std::string& path) {
+  datasets::ColumnarColumn features;
+  features.name = "features";
+  features.values =
+      torch::arange(10, torch::kFloat).view({10, 1}).repeat({1, 3});
+  datasets::ColumnarColumn tokens;
+  tokens.name = "tokens";
+  std::vector<torch::Tensor> rows;
+  std::vector<int64_t> offsets = {0};
+  for (int64_t i = 0; i < 10; ++i) {
+    rows.push_back(torch::arange(i, torch::kLong));
+    offsets.push_back(offsets.back() + i);
+  }
+  tokens.values = torch::cat(rows);
+  tokens.offsets = torch::tensor(offsets, torch::kLong);
+  datasets::ColumnarDataset::write(path, {features, tokens});
+  return datasets::ColumnarDataset(path);
+}
+
+TEST(DataTest, ColumnarDatasetReturnsViewsForConsecutiveIndices) {
+  auto tempfile = c10::make_tempfile();
+  auto dataset = make_columnar_dataset(tempfile.name);
+  ASSERT_EQ(dataset.size().value(), 10);
+  ASSERT_EQ(dataset.columns().size(), 2);
+  ASSERT_EQ(dataset.column_index("tokens"), 1);
+  ASSERT_THROWS_WITH(dataset.column_index("labels"), "No column named");
+
+  auto batch = dataset.get_batch({3, 4, 5});
+  ASSERT_EQ(batch.size(), 2);
+  const auto& features = batch[0];
+  ASSERT_EQ(features.name, "features");
+  ASSERT_FALSE(features.is_variable_length());
+  ASSERT_EQ(features.values.sizes(), std::vector<int64_t>({3, 3}));
+  ASSERT_TRUE(features.values.select(1, 0).equal(
+      torch::arange(3, 6, torch::kFloat)));
+  ASSERT_EQ(
+      features.values.data_ptr(),
+      dataset.columns()[0].values[3].data_ptr());
+
+  const auto& tokens = batch[1];
+  ASSERT_TRUE(tokens.is_variable_length());
+  ASSERT_TRUE(tokens.offsets.equal(torch::tensor({0, 3, 7, 12}, torch::kLong)));
+  ASSERT_TRUE(tokens.values.equal(torch::cat(
+      {torch::arange(3, torch::kLong),
+       torch::arange(4, torch::kLong),
+       torch::arange(5, torch::kLong)})));
+}
+
+TEST(DataTest, ColumnarDatasetGathersOtherIndices) {
+  auto tempfile = c10::make_tempfile();
+  auto dataset = make_columnar_dataset(tempfile.name);
+
+  auto batch = dataset.get_batch({7, 0, 2});
+  ASSERT_TRUE(batch[0].values.select(1, 2).equal(
+      torch::tensor({7, 0, 2}, torch::kFloat)));
+  ASSERT_TRUE(
+      batch[1].offsets.equal(torch::tensor({0, 7, 7, 9}, torch::kLong)));
+  ASSERT_TRUE(batch[1].values.equal(torch::cat(
+      {torch::arange(7, torch::kLong), torch::arange(2, torch::kLong)})));
+
+  ASSERT_THROWS_WITH(dataset.get_batch({10}), "out of range");
+}
+
+TEST(DataTest, ColumnarDatasetShards) {
+  auto tempfile = c10::make_tempfile();
+  auto dataset = make_columnar_dataset(tempfile.name);
+
+  auto last = dataset.shard(/*num_shards=*/3, /*shard_index=*/2);
+  ASSERT_EQ(last.size().value(), 2);
+  auto batch = last.get_batch({1, 0});
+  ASSERT_TRUE(batch[0].values.select(1, 0).equal(
+      torch::tensor({9, 8}, torch::kFloat)));
+  ASSERT_TRUE(batch[1].values.equal(torch::cat(
+      {torch::arange(9, torch::kLong), torch::arange(8, torch::kLong)})));
+
+  size_t rows = 0;
+  for (size_t shard = 0; shard < 3; ++shard) {
+    rows += dataset.shard(3, shard).size().value();
+  }
+  ASSERT_EQ(rows, 10);
+}
+
+TEST(DataTest, ColumnarDatasetRejectsOtherFiles) {
+  auto tempfile = c10::make_tempfile();
+  {
+    std::ofstream stream(tempfile.name);
+    stream << "definitely not a columnar dataset";
+  }
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarDataset(tempfile.name), "is not a columnar dataset");
+}
+
 TEST(DataTest, StackTransformWorksForExample) {
   struct D : public datasets::Dataset<D> {
     Example<> get(size_t index) override {
@@ -688,6 +785,62 @@ TEST(DataTest, QueueClearEmptiesTheQueue) {
   ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
 }
 
+TEST(DataTest, BoundedQueueRoundsUpItsCapacity) {
+  using torch::data::detail::BoundedQueue;
+  ASSERT_EQ(BoundedQueue<int>(0).capacity(), 2);
+  ASSERT_EQ(BoundedQueue<int>(1).capacity(), 2);
+  ASSERT_EQ(BoundedQueue<int>(5).capacity(), 8);
+  ASSERT_EQ(BoundedQueue<int>(64).capacity(), 64);
+}
+
+TEST(DataTest, BoundedQueuePushAndPopFromSameThread) {
+  torch::data::detail::BoundedQueue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  ASSERT_EQ(queue.pop(), 1);
+  ASSERT_EQ(queue.pop(), 2);
+  ASSERT_THROWS_WITH(
+      queue.pop(10 * kMillisecond),
+      "Timeout in DataLoader queue while waiting for next batch "
+      "(timeout was 10 ms)");
+}
+
+TEST(DataTest, BoundedQueueClearEmptiesTheQueue) {
+  torch::data::detail::BoundedQueue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  queue.push(3);
+  ASSERT_EQ(queue.clear(), 3);
+  ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
+}
+
+TEST(DataTest, BoundedQueueBlocksWhenFullOrEmpty) {
+  // Many more values than the queue holds go through it, so producers and
+  // consumers both end up waiting on each other.
+  torch::data::detail::BoundedQueue<size_t> queue(2);
+  const size_t kThreads = 4;
+  const size_t kValuesPerThread = 10000;
+  std::atomic<size_t> sum(0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 1; i <= kValuesPerThread; ++i) {
+        queue.push(t * kValuesPerThread + i);
+      }
+    });
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < kValuesPerThread; ++i) {
+        sum += queue.pop();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const size_t n = kThreads * kValuesPerThread;
+  ASSERT_EQ(sum.load(), n * (n + 1) / 2);
+}
+
 TEST(DataTest, DataShuttleCanPushAndPopJob) {
   torch::data::detail::DataShuttle<int, int> shuttle;
   shuttle.push_job(1);
@@ -1030,6 +1183,7 @@ TEST(DataLoaderTest, DataLoaderOptionsDefaultAsExpected) {
   ASSERT_EQ(full_options.max_jobs, 0);
   ASSERT_FALSE(full_options.timeout.has_value());
   ASSERT_TRUE(full_options.enforce_ordering);
+  ASSERT_FALSE(full_options.pin_memory);
 }
 
 TEST(DataLoaderTest, DataLoaderOptionsCoalesceOptionalValues) {
@@ -1045,6 +1199,41 @@ TEST(DataLoaderTest, MakeDataLoaderDefaultsAsExpected) {
   ASSERT_EQ(data_loader->options().batch_size, 1);
 }
 
+struct IndexTensorDataset : datasets::Dataset<IndexTensorDataset> {
+  torch::data::Example<> get(size_t index) override {
+    const auto value = static_cast<int64_t>(index);
+    return {torch::full({3}, value, torch::kLong), torch::tensor(value)};
+  }
+  torch::optional<size_t> size() const override {
+    return 100;
+  }
+};
+
+TEST(DataLoaderTest, PrefetchToDevice_CUDA) {
+  auto data_loader = torch::data::make_data_loader(
+      IndexTensorDataset().map(transforms::Stack<>()),
+      DataLoaderOptions(10).workers(2).pin_memory(true));
+  data_loader->prefetch_to_device(torch::kCUDA, /*depth=*/3);
+
+  for (size_t epoch = 0; epoch < 2; ++epoch) {
+    std::vector<int64_t> targets;
+    for (auto& batch : *data_loader) {
+      ASSERT_TRUE(batch.data.is_cuda());
+      ASSERT_TRUE(batch.target.is_cuda());
+      ASSERT_TRUE(batch.data.select(1, 0).equal(batch.target));
+      auto cpu_target = batch.target.cpu();
+      for (int64_t i = 0; i < cpu_target.numel(); ++i) {
+        targets.push_back(cpu_target[i].item<int64_t>());
+      }
+    }
+    std::sort(targets.begin(), targets.end());
+    ASSERT_EQ(targets.size(), 100);
+    for (size_t i = 0; i < targets.size(); ++i) {
+      ASSERT_EQ(targets[i], i);
+    }
+  }
+}
+
 struct UnsizedDataset : public datasets::Dataset<UnsizedDataset> {
   torch::data::Example<> get(size_t i) {
     return {torch::ones(i), torch::ones(i)};
@@ -1723,6 +1912,67 @@ TEST(DataLoaderTest, ChunkDataSetWithBatchSizeMismatch) {
   ASSERT_THROWS_WITH(*(data_loader->begin()), exception_msg);
 }
 
+TEST(DataLoaderTest, ChunkDataSetAdaptivePreloading) {
+  const size_t total_example_count = 35;
+  DummyChunkDataReader data_reader;
+  samplers::SequentialSampler sampler(0);
+
+  // Both with a cache bounded by examples and by bytes.
+  for (size_t cache_bytes : {size_t(0), 16 * sizeof(int)}) {
+    datasets::ChunkDataset<
+        DummyChunkDataReader,
+        samplers::SequentialSampler,
+        samplers::SequentialSampler>
+        dataset(
+            data_reader,
+            sampler,
+            sampler,
+            datasets::ChunkDatasetOptions(/*preloader_count=*/3, 5, 16)
+                .cache_bytes(cache_bytes)
+                .adaptive_preloading(true));
+
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      dataset.reset();
+      std::vector<bool> result(total_example_count, false);
+      size_t example_count = 0;
+      while (auto batch = dataset.get_batch()) {
+        for (auto data : *batch) {
+          ASSERT_FALSE(result[data]);
+          result[data] = true;
+        }
+        example_count += batch->size();
+
+        auto stats = dataset.stats();
+        ASSERT_GE(stats.read_slots, 1);
+        ASSERT_LE(stats.read_slots, 3);
+        ASSERT_LE(stats.in_flight_reads, 3);
+      }
+      ASSERT_EQ(example_count, total_example_count);
+
+      auto stats = dataset.stats();
+      ASSERT_EQ(stats.chunks_loaded, 3);
+      ASSERT_EQ(stats.buffered_examples, 0);
+      ASSERT_EQ(stats.buffered_bytes, 0);
+    }
+  }
+}
+
+TEST(DataLoaderTest, ChunkDataSetMinPreloaderCountIsChecked) {
+  DummyChunkDataReader data_reader;
+  samplers::SequentialSampler sampler(0);
+  using Dataset = datasets::ChunkDataset<
+      DummyChunkDataReader,
+      samplers::SequentialSampler,
+      samplers::SequentialSampler>;
+  ASSERT_THROWS_WITH(
+      Dataset(
+          data_reader,
+          sampler,
+          sampler,
+          datasets::ChunkDatasetOptions(2, 5).min_preloader_count(3)),
+      "min_preloader_count must be positive and at most preloader_count.");
+}
+
 TEST(DataLoaderTest, ChunkDataSetWithEmptyBatch) {
   struct DummyEmptyChunkDataReader
       : datasets::ChunkDataReader<int> {
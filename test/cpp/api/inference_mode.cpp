@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <ATen/core/InferenceMode.h>
+#include <torch/torch.h>
+
+#include <test/cpp/api/support.h>
+
+using namespace torch::test;
+
+namespace {
+
+torch::Tensor inference_tensor() {
+  at::AutoInferenceMode guard;
+  return torch::ones({2, 3});
+}
+
+} // namespace
+
+TEST(InferenceModeTest, TensorsCreatedInInferenceMode) {
+  auto x = torch::ones({2, 3}, torch::requires_grad());
+  ASSERT_FALSE(x.is_inference());
+  {
+    at::AutoInferenceMode guard;
+    ASSERT_TRUE(at::InferenceMode::is_enabled());
+    ASSERT_TRUE(torch::ones({2, 3}).is_inference());
+    auto y = x * 2;
+    ASSERT_TRUE(y.is_inference());
+    ASSERT_FALSE(y.requires_grad());
+    {
+      at::AutoInferenceMode disabled(false);
+      ASSERT_FALSE(torch::ones({2, 3}).is_inference());
+    }
+  }
+  ASSERT_FALSE(at::InferenceMode::is_enabled());
+  ASSERT_FALSE(torch::ones({2, 3}).is_inference());
+  // Clones of inference tensors are normal tensors
+  ASSERT_FALSE(inference_tensor().clone().is_inference());
+}
+
+TEST(InferenceModeTest, Views) {
+  auto base = torch::ones({2, 3});
+  {
+    at::AutoInferenceMode guard;
+    // Views created in inference mode are inference tensors, even those of
+    // normal tensors
+    auto view = base.view({6});
+    ASSERT_TRUE(view.is_inference());
+    ASSERT_FALSE(base.is_inference());
+    view.mul_(2);
+  }
+  ASSERT_TRUE(torch::equal(base, torch::full({2, 3}, 2.)));
+
+  // Views of inference tensors are inference tensors
+  auto t = inference_tensor();
+  ASSERT_TRUE(t.view({6}).is_inference());
+  ASSERT_TRUE(t[0].is_inference());
+  ASSERT_TRUE(t.detach().is_inference());
+  for (const auto& row : t.unbind()) {
+    ASSERT_TRUE(row.is_inference());
+  }
+  ASSERT_THROWS_WITH(
+      t.view({6}).add_(1), "Inplace update to inference tensor outside InferenceMode");
+  ASSERT_THROWS_WITH(
+      t[0].requires_grad_(), "Setting requires_grad=True on inference tensor");
+}
+
+TEST(InferenceModeTest, InplaceUpdates) {
+  auto t = inference_tensor();
+  {
+    at::AutoInferenceMode guard;
+    t.add_(1);
+  }
+  ASSERT_TRUE(torch::equal(t, torch::full({2, 3}, 2.)));
+  ASSERT_THROWS_WITH(t.add_(1), "Inplace update to inference tensor outside InferenceMode");
+  ASSERT_THROWS_WITH(
+      torch::add_out(t, torch::ones({2, 3}), torch::ones({2, 3})),
+      "Inplace update to inference tensor outside InferenceMode");
+  ASSERT_TRUE(torch::equal(t, torch::full({2, 3}, 2.)));
+  auto c = t.clone();
+  c.add_(1);
+  ASSERT_TRUE(torch::equal(c, torch::full({2, 3}, 3.)));
+
+  // In-place updates of normal tensors in inference mode don't bump their
+  // version counters, and don't make them inference tensors
+  auto normal = torch::ones({2, 3});
+  auto version = normal._version();
+  {
+    at::AutoInferenceMode guard;
+    normal.add_(1);
+  }
+  ASSERT_EQ(normal._version(), version);
+  ASSERT_FALSE(normal.is_inference());
+  ASSERT_TRUE(torch::equal(normal, torch::full({2, 3}, 2.)));
+  normal.add_(1);
+  ASSERT_EQ(normal._version(), version + 1);
+}
+
+TEST(InferenceModeTest, InferenceTensorsInAutograd) {
+  auto t = inference_tensor();
+  ASSERT_THROWS_WITH(
+      t.requires_grad_(), "Setting requires_grad=True on inference tensor outside InferenceMode");
+  ASSERT_FALSE(t.requires_grad());
+
+  auto x = torch::ones({2, 3}, torch::requires_grad());
+  // Inference tensors can be used as constants when they aren't saved
+  (x + t).sum().backward();
+  ASSERT_TRUE(torch::equal(x.grad(), torch::ones({2, 3})));
+  ASSERT_THROWS_WITH((x * t), "Inference tensors cannot be saved for backward");
+  ASSERT_THROWS_WITH((t * x), "Inference tensors cannot be saved for backward");
+  ASSERT_THROWS_WITH((x * t[0]), "Inference tensors cannot be saved for backward");
+  (x * t.clone()).sum().backward();
+  ASSERT_TRUE(torch::equal(x.grad(), torch::full({2, 3}, 2.)));
+
+  // Inference tensors may require grad in inference mode
+  {
+    at::AutoInferenceMode guard;
+    auto u = torch::ones({2, 3});
+    u.set_requires_grad(true);
+    ASSERT_TRUE(u.requires_grad());
+  }
+}
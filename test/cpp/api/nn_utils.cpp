@@ -615,3 +615,46 @@ TEST_F(NNUtilsTest, PadSequence) {
     ASSERT_TRUE(padded.allclose(expected.transpose(0, 1)));
   }
 }
+
+TEST_F(NNUtilsTest, OptimizeForInference) {
+  torch::nn::Sequential model(
+      torch::nn::Conv2d(torch::nn::Conv2dOptions(3, 8, 3).padding(1).bias(false)),
+      torch::nn::BatchNorm2d(8),
+      torch::nn::ReLU(),
+      torch::nn::BatchNorm2d(8),
+      torch::nn::ReLU(),
+      torch::nn::Flatten(),
+      torch::nn::Linear(8 * 5 * 5, 10),
+      torch::nn::BatchNorm1d(10));
+  {
+    // Non trivial running statistics and affine parameters
+    torch::NoGradGuard no_grad;
+    for (auto& buffer : model->named_buffers()) {
+      if (buffer.key().find("running_mean") != std::string::npos) {
+        buffer.value().normal_();
+      } else if (buffer.key().find("running_var") != std::string::npos) {
+        buffer.value().uniform_(0.5, 2);
+      }
+    }
+    for (auto& param : model->parameters()) {
+      param.normal_();
+    }
+  }
+  ASSERT_THROWS_WITH(
+      torch::nn::utils::optimize_for_inference(model),
+      "expects a module in evaluation mode");
+  model->eval();
+
+  auto optimized = torch::nn::utils::optimize_for_inference(model);
+  // Conv2d + BatchNorm2d, ReLU, BatchNorm2d + ReLU, Flatten, Linear + BatchNorm1d
+  ASSERT_EQ(optimized->size(), 5);
+  ASSERT_TRUE(optimized[0]->as<torch::nn::Conv2d>());
+  ASSERT_TRUE(optimized[2]->as<torch::nn::Functional>());
+  ASSERT_TRUE(optimized[4]->as<torch::nn::Linear>());
+
+  torch::NoGradGuard no_grad;
+  auto input = torch::randn({4, 3, 5, 5});
+  ASSERT_TRUE(optimized->forward(input).allclose(model->forward(input), 1e-4, 1e-4));
+  auto input_nhwc = input.contiguous(torch::MemoryFormat::ChannelsLast);
+  ASSERT_TRUE(optimized->forward(input_nhwc).allclose(model->forward(input), 1e-4, 1e-4));
+}
@@ -412,6 +412,33 @@ TEST(OptimTest, ZeroGrad) {
   }
 }
 
+TEST(OptimTest, SparseGradients_SGD) {
+  torch::manual_seed(0);
+  // The same steps, with the sparse gradients of an embedding, and with the
+  // dense gradients of a copy of it in another parameter group.
+  Embedding sparse(EmbeddingOptions(10, 4).sparse(true));
+  Embedding dense(EmbeddingOptions(10, 4));
+  {
+    torch::NoGradGuard no_grad;
+    dense->weight.copy_(sparse->weight);
+  }
+  SGD optimizer(
+      {OptimizerParamGroup(sparse->parameters()),
+       OptimizerParamGroup(dense->parameters())},
+      SGDOptions(0.1).momentum(0.9));
+
+  const auto indices = torch::tensor({1, 4, 4, 7}, torch::kLong);
+  for (int i = 0; i < 3; i++) {
+    optimizer.zero_grad();
+    sparse->forward(indices).sum().backward();
+    dense->forward(indices).sum().backward();
+    ASSERT_TRUE(sparse->weight.grad().is_sparse());
+    ASSERT_FALSE(dense->weight.grad().is_sparse());
+    optimizer.step();
+    ASSERT_TRUE(torch::allclose(sparse->weight, dense->weight));
+  }
+}
+
 TEST(OptimTest, ExternalVectorOfParameters) {
   torch::manual_seed(0);
 
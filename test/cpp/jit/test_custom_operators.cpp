@@ -1,6 +1,7 @@
 #include "test/cpp/jit/test_base.h"
 #include "test/cpp/jit/test_utils.h"
 
+#include "ATen/core/op_registration/op_registration.h"
 #include "torch/csrc/jit/ir/alias_analysis.h"
 #include "torch/csrc/jit/ir/irparser.h"
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
@@ -181,6 +182,113 @@ graph(%x: Tensor, %y: Tensor):
   }
 }
 
+void testCustomOperatorLazyRegistration() {
+  auto returnFirst = [](Stack& stack) {
+    drop(stack, 1);
+    return 0;
+  };
+  // The name is read from the schema string without parsing it
+  ASSERT_EQ(
+      Operator(
+          "foo::lazy.overload(int a) -> int",
+          returnFirst,
+          c10::AliasAnalysisKind::FROM_SCHEMA)
+          .name(),
+      "foo::lazy");
+  ASSERT_EQ(
+      Operator(
+          "foo::lazy (int a) -> int",
+          returnFirst,
+          c10::AliasAnalysisKind::FROM_SCHEMA)
+          .name(),
+      "foo::lazy");
+
+  RegisterOperators reg({
+      Operator(
+          "foo::lazy(int a, int b) -> int",
+          returnFirst,
+          c10::AliasAnalysisKind::FROM_SCHEMA),
+      Operator(
+          "foo::lazy.overload(int a, int b) -> int",
+          returnFirst,
+          c10::AliasAnalysisKind::FROM_SCHEMA),
+      Operator(
+          "foo::lazy_other(int a, int b) -> int",
+          returnFirst,
+          c10::AliasAnalysisKind::FROM_SCHEMA),
+      Operator(
+          "foo::lazy_removed(int a, int b) -> int",
+          returnFirst,
+          c10::AliasAnalysisKind::FROM_SCHEMA),
+  });
+
+  // Lookups by name register the pending operators of that name only
+  auto op = findOperatorFor(c10::OperatorName("foo::lazy", "overload"));
+  ASSERT_TRUE(op);
+  ASSERT_EQ(op->schema().overload_name(), "overload");
+  ASSERT_EQ(getAllOperatorsFor(Symbol::fromQualString("foo::lazy")).size(), 2);
+  ASSERT_FALSE(findOperatorFor(c10::OperatorName("foo::lazy", "missing")));
+
+  auto other = getOperatorForLiteral("foo::lazy_other(int a, int b) -> int");
+  ASSERT_TRUE(other);
+  ASSERT_EQ(other->schema().name(), "foo::lazy_other");
+
+  // An operator can be deregistered while it is still pending
+  deregisterOperator(parseSchema("foo::lazy_removed(int a, int b) -> int"));
+  ASSERT_EQ(
+      getAllOperatorsFor(Symbol::fromQualString("foo::lazy_removed")).size(),
+      0);
+
+  // Lookups of the whole table see the operators of all names
+  size_t num_lazy = 0;
+  for (const auto& op : getAllOperators()) {
+    if (op->schema().name().rfind("foo::lazy", 0) == 0) {
+      num_lazy++;
+    }
+  }
+  ASSERT_EQ(num_lazy, 3);
+}
+
+static std::atomic<int> num_lookup_hook_calls{0};
+
+void testOperatorLookupHook() {
+  // The c10 operators are found on the first lookups of the registry
+  ASSERT_TRUE(findOperatorFor(c10::OperatorName("aten::add", "Tensor")));
+  ASSERT_TRUE(getOperatorForLiteral(
+      "aten::mul.Tensor(Tensor self, Tensor other) -> Tensor"));
+
+  setOperatorLookupHook(+[]() {
+    num_lookup_hook_calls++;
+    ensure_c10_registerer_defined();
+  });
+  num_lookup_hook_calls = 0;
+  {
+    // c10 operators registered after the hook was set are found as well
+    auto reg = c10::RegisterOperators().op(
+        "_test::lookup_hook(Tensor a) -> Tensor",
+        [](at::Tensor a) { return a.add(1); });
+    auto op = findOperatorFor(c10::OperatorName("_test::lookup_hook", ""));
+    ASSERT_TRUE(op);
+    ASSERT_TRUE(num_lookup_hook_calls.load() > 0);
+
+    Stack stack;
+    push(stack, at::zeros({2}));
+    op->getOperation()(stack);
+    ASSERT_EQ(stack.size(), 1);
+    ASSERT_TRUE(pop(stack).toTensor().equal(at::ones({2})));
+  }
+  // and are removed from the JIT registry with their c10 registration
+  ASSERT_FALSE(findOperatorFor(c10::OperatorName("_test::lookup_hook", "")));
+
+  const int num_calls = num_lookup_hook_calls.load();
+  ASSERT_FALSE(
+      getAllOperatorsFor(Symbol::fromQualString("aten::add")).empty());
+  ASSERT_TRUE(num_lookup_hook_calls.load() > num_calls);
+
+  setOperatorLookupHook(&ensure_c10_registerer_defined);
+  ASSERT_TRUE(findOperatorFor(c10::OperatorName("aten::add", "Tensor")));
+}
+
 void testIValueKWargs() {
   const auto text = R"(
     def foo(a : int, b : int, c : int = 4):
@@ -0,0 +1,71 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
+#include <torch/csrc/jit/testing/file_check.h>
+
+namespace torch {
+namespace jit {
+void testForkIndependentBranches() {
+  // Three towers reading the same input, concatenated at the end. The two
+  // cheapest ones are forked, the trunk and the concatenation are not.
+  const std::string input =
+      R"IR(
+graph(%x : Tensor, %w : Tensor):
+  %dim : int = prim::Constant[value=1]()
+  %trunk : Tensor = aten::relu(%x)
+  %a1 : Tensor = aten::mm(%trunk, %w)
+  %a2 : Tensor = aten::mm(%a1, %w)
+  %a3 : Tensor = aten::mm(%a2, %w)
+  %b1 : Tensor = aten::mm(%trunk, %w)
+  %b2 : Tensor = aten::mm(%b1, %w)
+  %c1 : Tensor = aten::mm(%trunk, %w)
+  %c2 : Tensor = aten::tanh(%c1)
+  %c3 : Tensor = aten::mm(%c2, %w)
+  %d : Tensor = aten::sigmoid(%trunk)
+  %l : Tensor[] = prim::ListConstruct(%a3, %b2, %c3, %d)
+  %y : Tensor = aten::cat(%l, %dim)
+  return (%y)
+)IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(input, graph.get());
+  auto reference = graph->copy();
+
+  ASSERT_TRUE(ForkIndependentBranches(graph));
+  testing::FileCheck()
+      .check("aten::relu")
+      ->check_count("= prim::fork", 2, /*exactly*/ true)
+      ->check_count("aten::wait", 2, /*exactly*/ true)
+      ->check("aten::cat")
+      ->run(*graph);
+  // The sigmoid branch is too cheap to be forked.
+  testing::FileCheck().check("aten::sigmoid")->check("aten::cat")->run(*graph);
+
+  auto x = at::randn({8, 8});
+  auto w = at::randn({8, 8});
+  Code reference_code(reference, "");
+  InterpreterState reference_interp(reference_code);
+  Code code(graph, "");
+  InterpreterState interp(code);
+  ASSERT_TRUE(exactlyEqual(
+      run(reference_interp, {x, w}).at(0), run(interp, {x, w}).at(0)));
+
+  // Mutated values are not moved to another thread.
+  const std::string mutation =
+      R"IR(
+graph(%x : Tensor, %w : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %a1 : Tensor = aten::mm(%x, %w)
+  %a2 : Tensor = aten::mm(%a1, %w)
+  %b1 : Tensor = aten::mm(%x, %w)
+  %b2 : Tensor = aten::mm(%b1, %w)
+  %c : Tensor = aten::add_(%b2, %one, %one)
+  %y : Tensor = aten::add(%a2, %c, %one)
+  return (%y)
+)IR";
+  auto mutation_graph = std::make_shared<Graph>();
+  parseIR(mutation, mutation_graph.get());
+  ASSERT_FALSE(ForkIndependentBranches(mutation_graph));
+}
+} // namespace jit
+} // namespace torch
@@ -1,5 +1,9 @@
 #include "test/cpp/jit/test_base.h"
 #include "test/cpp/jit/test_utils.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/csrc/jit/runtime/observer.h"
+#include "torch/jit.h"
 
 namespace torch {
 namespace jit {
@@ -27,5 +31,138 @@ void testInterp() {
   ASSERT_TRUE(exactlyEqual(outputs[0], hx));
   ASSERT_TRUE(exactlyEqual(outputs[1], cx));
 }
+
+namespace {
+struct CountingObserver : public LatencyHistogramObserver {
+  using LatencyHistogramObserver::LatencyHistogramObserver;
+
+  void onMethodStart(const std::string& /* name */) override {
+    method_starts++;
+  }
+  void onNodeStart(const Node* /* node */) override {
+    node_starts++;
+  }
+
+  std::atomic<int> method_starts{0};
+  std::atomic<int> node_starts{0};
+};
+} // namespace
+
+void testInterpreterObserver() {
+  LatencyHistogram histogram;
+  for (int64_t ns : {1, 3, 100}) {
+    histogram.add(ns);
+  }
+  ASSERT_EQ(histogram.count(), 3);
+  ASSERT_EQ(histogram.sum(), 104);
+  ASSERT_EQ(histogram.percentile(50), 4);
+  ASSERT_EQ(histogram.percentile(99), 128);
+
+  auto cu = compile(R"JIT(
+    def foo(x):
+      return x.relu().sigmoid()
+  )JIT");
+  auto& foo = cu->get_function("foo");
+  const auto& name = foo.qualname().qualifiedName();
+
+  // Observes all the nodes
+  auto observer = std::make_shared<CountingObserver>(1);
+  setInterpreterObserver(observer);
+  for (int i = 0; i < 3; i++) {
+    foo({at::randn({4})});
+  }
+  setInterpreterObserver(nullptr);
+  foo({at::randn({4})});
+
+  ASSERT_EQ(observer->method_starts, 3);
+  ASSERT_EQ(observer->methodHistogram(name)->count(), 3);
+  ASSERT_EQ(observer->nodeHistogram("aten::relu")->count(), 3);
+  ASSERT_TRUE(observer->node_starts >= 6);
+
+  logging::LockingLogger logger;
+  observer->exportStats(logger);
+  ASSERT_EQ(
+      logger.getCounterValue("pytorch_runtime.latency_ns.method." + name + ".count"),
+      3);
+  ASSERT_EQ(
+      logger.getCounterValue("pytorch_runtime.latency_ns.node.aten::relu.count"),
+      3);
+
+  // Samples one node in 1000
+  auto sampled = std::make_shared<CountingObserver>(1000);
+  setInterpreterObserver(sampled);
+  for (int i = 0; i < 3; i++) {
+    foo({at::randn({4})});
+  }
+  setInterpreterObserver(nullptr);
+  ASSERT_EQ(sampled->method_starts, 3);
+  ASSERT_TRUE(sampled->node_starts <= 1);
+}
+
+void testInterpreterUnpackMovesElements() {
+  auto x = at::randn({2});
+  auto y = at::randn({3});
+
+  // Tuple::create forwards its elements instead of copying them
+  auto tmp = at::randn({4});
+  auto created = c10::ivalue::Tuple::create(x, std::move(tmp), 1);
+  ASSERT_EQ(x.use_count(), 2);
+  ASSERT_EQ(created->elements()[1].toTensor().use_count(), 1);
+
+  // The tuples and lists built in the graph are only referenced from the
+  // stack when they are unpacked, the ones passed in are also held by the
+  // caller, which must still see all of their elements.
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x : Tensor, %y : Tensor, %t_in : (Tensor, Tensor), %l_in : Tensor[]):
+  %i : int = prim::Constant[value=3]()
+  %one : int = prim::Constant[value=1]()
+  %t : (Tensor, Tensor, int) = prim::TupleConstruct(%x, %y, %i)
+  %a : Tensor, %b : Tensor, %c : int = prim::TupleUnpack(%t)
+  %l : Tensor[] = prim::ListConstruct(%x, %y)
+  %p : Tensor, %q : Tensor = prim::ListUnpack(%l)
+  %u : (Tensor, Tensor, Tensor) = prim::TupleConstruct(%x, %y, %x)
+  %s : (Tensor, Tensor) = prim::TupleSlice[beg=1, end=3](%u)
+  %v : (Tensor, Tensor) = prim::TupleConstruct(%x, %y)
+  %w : Tensor = prim::TupleIndex(%v, %one)
+  %e : Tensor, %f : Tensor = prim::TupleUnpack(%t_in)
+  %g : Tensor, %h : Tensor = prim::ListUnpack(%l_in)
+  %out : (Tensor, Tensor, int, Tensor, Tensor, (Tensor, Tensor), Tensor, Tensor, Tensor, Tensor, Tensor) = prim::TupleConstruct(%a, %b, %c, %p, %q, %s, %w, %e, %f, %g, %h)
+  return (%out)
+)IR",
+      graph.get());
+
+  IValue t_in = c10::ivalue::Tuple::create(y, x);
+  c10::List<at::Tensor> l_in({y, x});
+  Code code(graph, "");
+  InterpreterState interp(code);
+  Stack stack = {x, y, t_in, l_in};
+  interp.run(stack);
+  ASSERT_EQ(stack.size(), 1);
+
+  auto out = stack[0].toTuple()->elements();
+  ASSERT_EQ(out.size(), 11);
+  ASSERT_TRUE(out[0].toTensor().is_same(x));
+  ASSERT_TRUE(out[1].toTensor().is_same(y));
+  ASSERT_EQ(out[2].toInt(), 3);
+  ASSERT_TRUE(out[3].toTensor().is_same(x));
+  ASSERT_TRUE(out[4].toTensor().is_same(y));
+  auto slice = out[5].toTuple()->elements();
+  ASSERT_EQ(slice.size(), 2);
+  ASSERT_TRUE(slice[0].toTensor().is_same(y));
+  ASSERT_TRUE(slice[1].toTensor().is_same(x));
+  ASSERT_TRUE(out[6].toTensor().is_same(y));
+  for (size_t i : {7, 9}) {
+    ASSERT_TRUE(out[i].toTensor().is_same(y));
+    ASSERT_TRUE(out[i + 1].toTensor().is_same(x));
+  }
+
+  const auto& t_elements = t_in.toTuple()->elements();
+  ASSERT_TRUE(t_elements[0].toTensor().is_same(y));
+  ASSERT_TRUE(t_elements[1].toTensor().is_same(x));
+  ASSERT_TRUE(l_in.get(0).is_same(y));
+  ASSERT_TRUE(l_in.get(1).is_same(x));
+}
 } // namespace jit
 } // namespace torch
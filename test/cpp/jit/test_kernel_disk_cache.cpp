@@ -0,0 +1,57 @@
+#include <test/cpp/jit/test_base.h>
+
+#include <torch/csrc/jit/codegen/kernel_disk_cache.h>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace torch {
+namespace jit {
+
+void testKernelDiskCache() {
+#if !defined(_WIN32)
+  char dir[] = "/tmp/torch-kernel-cache-XXXXXX";
+  ASSERT_TRUE(mkdtemp(dir));
+  const std::string old_dir = getKernelCacheDir();
+  const std::string binary("obj\0code\n", 9);
+
+  // Disabled.
+  setKernelCacheDir("");
+  storeCachedKernel("test", "key", binary);
+  ASSERT_FALSE(loadCachedKernel("test", "key"));
+
+  setKernelCacheDir(dir);
+  ASSERT_FALSE(loadCachedKernel("test", "key"));
+  storeCachedKernel("test", "key", binary);
+  auto loaded = loadCachedKernel("test", "key");
+  ASSERT_TRUE(loaded);
+  ASSERT_EQ(*loaded, binary);
+  ASSERT_FALSE(loadCachedKernel("test", "other key"));
+  ASSERT_FALSE(loadCachedKernel("other", "key"));
+
+  // Storing again replaces the entry.
+  storeCachedKernel("test", "key", "new binary");
+  ASSERT_EQ(*loadCachedKernel("test", "key"), "new binary");
+
+  setKernelCacheDir(old_dir);
+  DIR* d = opendir(dir);
+  ASSERT_TRUE(d);
+  while (dirent* entry = readdir(d)) {
+    std::string name = entry->d_name;
+    if (name != "." && name != "..") {
+      std::remove((std::string(dir) + "/" + name).c_str());
+    }
+  }
+  closedir(d);
+  rmdir(dir);
+#endif
+}
+
+} // namespace jit
+} // namespace torch
@@ -358,6 +358,31 @@ void testLiteInterpreterBuiltinFunction() {
   AT_ASSERT(str == expected);
 }
 
+void testLiteInterpreterLoop() {
+  // Exercises the jumps around the stores removed at export.
+  Module m("m");
+  m.define(R"(
+    def forward(self, x: Tensor, n: int):
+      y = x
+      for i in range(n):
+        z = torch.relu(y * 2) + 1
+        if i % 2 == 0:
+          y = torch.sigmoid(z) - 1
+        else:
+          y = z * z
+      return y
+  )");
+
+  std::vector<IValue> inputs{torch::randn({4}), 5};
+  auto ref = m.forward(inputs);
+
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+  auto res = bc.forward(inputs);
+  AT_ASSERT(res.toTensor().equal(ref.toTensor()));
+}
+
 namespace {
 static auto reg =
     torch::jit::class_<TorchBindLiteInterpreterTestStruct>(
@@ -0,0 +1,95 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <random>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Checks that every request of `plan` lies within the arena, is aligned, and
+// that requests whose live ranges overlap occupy disjoint bytes.
+void checkPlan(
+    const std::vector<MemoryRequest>& requests,
+    const MemoryPlan& plan) {
+  ASSERT_EQ(plan.offsets.size(), requests.size());
+  for (size_t i = 0; i < requests.size(); i++) {
+    ASSERT_EQ(plan.offsets[i] % 64, 0);
+    ASSERT_TRUE(plan.offsets[i] + requests[i].size <= plan.total_size);
+    for (size_t j = 0; j < i; j++) {
+      const auto& a = requests[i].range;
+      const auto& b = requests[j].range;
+      if (a.begin <= b.end && b.begin <= a.end) {
+        ASSERT_TRUE(
+            plan.offsets[i] + requests[i].size <= plan.offsets[j] ||
+            plan.offsets[j] + requests[j].size <= plan.offsets[i]);
+      }
+    }
+  }
+}
+
+} // namespace
+
+void testMemoryPlanning() {
+  // Ranges:  0 1 2 3 4
+  //   r0:    ---
+  //   r1:      -----
+  //   r2:          -----
+  //   r3:    -
+  std::vector<MemoryRequest> requests = {
+      {100, {0, 1}}, {64, {1, 3}}, {128, {3, 4}}, {1, {0, 0}}};
+  for (auto strategy :
+       {MemoryPlanningStrategy::GREEDY_BY_SIZE,
+        MemoryPlanningStrategy::LINEAR_SCAN}) {
+    auto plan = PlanMemory(requests, strategy);
+    checkPlan(requests, plan);
+    // With sizes rounded up to 64, at most 192 bytes are live at once.
+    ASSERT_EQ(plan.total_size, 192);
+  }
+
+  // Many requests of varied sizes and ranges, which both strategies have to
+  // pack around each other.
+  std::mt19937 gen(42);
+  std::vector<MemoryRequest> random_requests;
+  for (int i = 0; i < 200; i++) {
+    const size_t begin = gen() % 50;
+    const size_t end = begin + gen() % 10;
+    random_requests.push_back({1 + gen() % 5000, {begin, end}});
+  }
+  for (auto strategy :
+       {MemoryPlanningStrategy::GREEDY_BY_SIZE,
+        MemoryPlanningStrategy::LINEAR_SCAN}) {
+    checkPlan(random_requests, PlanMemory(random_requests, strategy));
+  }
+
+  const auto graph_string = R"IR(
+    graph(%x : Tensor):
+      %zero : int = prim::Constant[value=0]()
+      %a : Tensor = aten::relu(%x)
+      %b : Tensor = aten::select(%a, %zero, %zero)
+      %c : Tensor = aten::sigmoid(%x)
+      %d : Tensor = aten::mul(%b, %c)
+      %e : Tensor = aten::tanh(%d)
+      return (%e))IR";
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<std::string, Value*> vmap;
+  parseIR(graph_string, graph.get(), vmap);
+  AliasDb alias_db(graph);
+  auto ranges = ComputeLiveRanges(graph, alias_db);
+  ASSERT_EQ(ranges.at(vmap["x"]).begin, 0);
+  ASSERT_EQ(ranges.at(vmap["x"]).end, 3);
+  // %a stays live as long as its view %b.
+  ASSERT_EQ(ranges.at(vmap["a"]).begin, 1);
+  ASSERT_EQ(ranges.at(vmap["a"]).end, 4);
+  ASSERT_EQ(ranges.at(vmap["d"]).begin, 4);
+  ASSERT_EQ(ranges.at(vmap["d"]).end, 5);
+  // Graph outputs are live past the last node.
+  ASSERT_EQ(ranges.at(vmap["e"]).end, 6);
+}
+
+} // namespace jit
+} // namespace torch
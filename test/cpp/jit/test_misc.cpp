@@ -1,5 +1,6 @@
 #include <ATen/ATen.h>
 #include <ATen/Parallel.h>
+#include <ATen/ThreadLocalState.h>
 #include <ATen/core/interned_strings.h>
 #include <ATen/core/ivalue.h>
 
@@ -64,6 +65,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <utility>
@@ -930,6 +932,41 @@ void testRecordFunction() {
   TORCH_CHECK(sampled_cb_ctr == 1000);
   clearCallbacks();
 
+  // test pre-sampling, when all the callbacks are sampled
+  sampled_cb_ctr = 0;
+  int other_sampled_cb_ctr = 0;
+  setup_sampled_callback(0.5);
+  addGlobalCallback(RecordFunctionCallback(
+                        [&other_sampled_cb_ctr](const RecordFunction& fn) {
+                          if (std::string(fn.name().str()) == "test") {
+                            ++other_sampled_cb_ctr;
+                          }
+                          return true;
+                        },
+                        [](const RecordFunction&) {})
+                        .samplingProb(0.1));
+  run_test_function();
+  TORCH_CHECK(sampled_cb_ctr > 0 && sampled_cb_ctr < 1000);
+  TORCH_CHECK(other_sampled_cb_ctr > 0 && other_sampled_cb_ctr < sampled_cb_ctr);
+  clearCallbacks();
+
+  sampled_cb_ctr = 0;
+  setup_sampled_callback(0.0);
+  run_test_function();
+  TORCH_CHECK(sampled_cb_ctr == 0);
+  clearCallbacks();
+
+  // the number of RecordFunctions to skip is drawn again when the callbacks
+  // change, a rarely sampled callback doesn't hold back its replacement
+  setup_sampled_callback(1e-6);
+  run_test_function();
+  clearCallbacks();
+  sampled_cb_ctr = 0;
+  setup_sampled_callback(0.5);
+  run_test_function();
+  TORCH_CHECK(sampled_cb_ctr > 0 && sampled_cb_ctr < 1000);
+  clearCallbacks();
+
   // test the scope of the callbacks
   checkScopeCallbacks();
   clearCallbacks();
@@ -1230,6 +1267,62 @@ void testAutogradProfiler() {
   TORCH_CHECK(count == 200);
 }
 
+void testAutogradProfilerEventLists() {
+  // The input shapes are stored flat in the events, the number of dimensions
+  // of each input followed by its sizes.
+  std::vector<std::vector<int64_t>> shapes = {{2, 3}, {}, {4}, {0, 5}};
+  torch::autograd::profiler::Event event(
+      EventKind::Mark,
+      at::StringView("shapes"),
+      0,
+      false,
+      0,
+      std::vector<std::vector<int64_t>>(shapes));
+  ASSERT_EQ(event.shapes(), shapes);
+  event.setFlatShapes({1, 7, 0});
+  ASSERT_EQ(event.shapes(), std::vector<std::vector<int64_t>>({{7}, {}}));
+
+  // More adds than fit in a block of the event lists, on the main thread and
+  // on another one. The second run must only see its own events, although the
+  // event lists of the first run are cached by both threads.
+  constexpr int kNumAdds = 2500;
+  auto a = at::randn({2, 3});
+  auto b = at::randn({2, 3});
+  for (int run = 0; run < 2; run++) {
+    enableProfiler(ProfilerConfig(ProfilerState::CPU, true, false));
+    auto state = at::ThreadLocalState();
+    std::thread other([&]() {
+      at::ThreadLocalStateGuard guard(state);
+      for (int i = 0; i < kNumAdds; i++) {
+        at::add(a, b);
+      }
+    });
+    for (int i = 0; i < kNumAdds; i++) {
+      at::add(a, b);
+    }
+    other.join();
+    auto event_lists = disableProfiler();
+
+    size_t num_lists_with_adds = 0;
+    for (const auto& events : event_lists) {
+      size_t num_adds = 0;
+      for (const auto& e : events) {
+        if (e.kind() == "push" && std::string(e.name()) == "aten::add") {
+          ASSERT_EQ(
+              e.shapes(),
+              std::vector<std::vector<int64_t>>({{2, 3}, {2, 3}, {}}));
+          num_adds++;
+        }
+      }
+      if (num_adds > 0) {
+        ASSERT_EQ(num_adds, kNumAdds);
+        num_lists_with_adds++;
+      }
+    }
+    ASSERT_EQ(num_lists_with_adds, 2);
+  }
+}
+
 void testNoneSchemaMatch() {
   RegisterOperators reg({
       Operator(
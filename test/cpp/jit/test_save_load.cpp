@@ -89,5 +89,27 @@ void testTypeTags() {
   }
 }
 
+void testPrefetchTensorRecords() {
+  std::stringstream ss;
+  std::vector<at::Tensor> params;
+  {
+    Module m("__torch__.m");
+    for (size_t i = 0; i < 8; i++) {
+      params.push_back(torch::randn({16, 16}));
+      m.register_parameter("w" + std::to_string(i), params.back(), false);
+    }
+    m.save(ss);
+  }
+  bool prefetch = getPrefetchTensorRecords();
+  setPrefetchTensorRecords(true);
+  ss.seekg(0);
+  Module loaded = jit::load(ss);
+  setPrefetchTensorRecords(prefetch);
+  for (size_t i = 0; i < params.size(); i++) {
+    auto t = loaded.attr("w" + std::to_string(i)).toTensor();
+    ASSERT_TRUE(t.equal(params[i]));
+  }
+}
+
 } // namespace jit
 } // namespace torch
@@ -0,0 +1,167 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <ATen/core/grad_mode.h>
+#include <torch/csrc/autograd/autograd.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+#include <torch/csrc/jit/runtime/static/inference_session.h>
+
+#include <thread>
+
+namespace torch {
+namespace jit {
+
+void testStaticRuntime() {
+  const auto graph_string = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %a : Tensor = aten::mul(%x, %y)
+      %b : Tensor = aten::add(%a, %x, %one)
+      %c : Tensor = aten::sigmoid(%b)
+      %d : Tensor = aten::tanh(%c)
+      %e : Tensor = aten::add(%d, %y, %one)
+      return (%e, %c))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, graph.get());
+
+  Code code(graph, "");
+  for (auto strategy :
+       {MemoryPlanningStrategy::GREEDY_BY_SIZE,
+        MemoryPlanningStrategy::LINEAR_SCAN}) {
+    StaticRuntime runtime(graph, strategy);
+    ASSERT_EQ(runtime.num_out_variant_nodes(), 5);
+    ASSERT_EQ(runtime.num_planned_values(), 0);
+
+    for (auto dtype : {at::kFloat, at::kFloat, at::kFloat, at::kDouble}) {
+      auto x = at::randn({4, 3}, dtype);
+      auto y = at::randn({4, 3}, dtype);
+      InterpreterState interp(code);
+      auto expected = run(interp, {x, y});
+      auto outputs = runtime.run(std::vector<at::Tensor>{x, y});
+      ASSERT_EQ(outputs.size(), 2);
+      ASSERT_TRUE(exactlyEqual(outputs[0], expected[0]));
+      ASSERT_TRUE(exactlyEqual(outputs[1], expected[1]));
+    }
+    // %a, %b and %d are written into the arena, where %a and %d share a slot
+    // of 96 bytes, rounded up to 128. The outputs %c and %e are allocated by
+    // every run.
+    ASSERT_EQ(runtime.num_planned_values(), 3);
+    ASSERT_EQ(runtime.arena_size(), 2 * 128);
+  }
+}
+
+void testStaticRuntimeGradMode() {
+  const auto graph_string = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %a : Tensor = aten::mul(%x, %y)
+      %b : Tensor = aten::add(%a, %x, %one)
+      %c : Tensor = aten::sigmoid(%b)
+      return (%c))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, graph.get());
+  StaticRuntime runtime(graph);
+  auto y = at::randn({4, 3});
+
+  // The first run plans %a and %b, the second one writes them into the arena.
+  for (int i = 0; i < 2; i++) {
+    auto x = at::randn({4, 3});
+    auto outputs = runtime.run(std::vector<at::Tensor>{x, y});
+    ASSERT_TRUE(outputs[0].allclose(at::sigmoid(x * y + x)));
+    ASSERT_FALSE(outputs[0].requires_grad());
+  }
+  ASSERT_EQ(runtime.num_planned_values(), 2);
+
+  // Inputs that require grad don't match the plan, and out= kernels don't
+  // support autograd, so the nodes run functionally and stay out of the arena.
+  for (int i = 0; i < 2; i++) {
+    auto x = at::randn({4, 3}).set_requires_grad(true);
+    auto outputs = runtime.run(std::vector<at::Tensor>{x, y});
+    ASSERT_TRUE(outputs[0].requires_grad());
+    auto expected = at::sigmoid(x * y + x);
+    ASSERT_TRUE(outputs[0].allclose(expected));
+    auto grad = torch::autograd::grad({outputs[0].sum()}, {x});
+    auto expected_grad = torch::autograd::grad({expected.sum()}, {x});
+    ASSERT_TRUE(grad[0].allclose(expected_grad[0]));
+    ASSERT_EQ(runtime.num_planned_values(), 0);
+  }
+
+  // Without grad mode, the outputs don't require grad and can be planned.
+  {
+    at::NoGradGuard no_grad;
+    for (int i = 0; i < 2; i++) {
+      auto x = at::randn({4, 3}).set_requires_grad(true);
+      auto outputs = runtime.run(std::vector<at::Tensor>{x, y});
+      ASSERT_FALSE(outputs[0].requires_grad());
+      ASSERT_TRUE(outputs[0].allclose(at::sigmoid(x * y + x)));
+    }
+    ASSERT_EQ(runtime.num_planned_values(), 2);
+  }
+
+  // The same inputs with grad mode enabled again don't match that plan.
+  auto x = at::randn({4, 3}).set_requires_grad(true);
+  auto outputs = runtime.run(std::vector<at::Tensor>{x, y});
+  ASSERT_TRUE(outputs[0].requires_grad());
+  ASSERT_TRUE(outputs[0].allclose(at::sigmoid(x * y + x)));
+}
+
+void testInferenceSession() {
+  const auto graph_string = R"IR(
+    graph(%x : Tensor, %y : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %a : Tensor = aten::mul(%x, %y)
+      %b : Tensor = aten::add(%a, %x, %one)
+      %c : Tensor = aten::sigmoid(%b)
+      return (%c))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, graph.get());
+  auto x = at::randn({4, 3});
+  auto y = at::randn({4, 3});
+  auto expected = at::sigmoid(x * y + x);
+
+  {
+    InferenceSessionOptions options;
+    options.max_concurrency = 2;
+    InferenceSession session(graph, options);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < 10; j++) {
+          auto outputs = session.run({x, y});
+          ASSERT_EQ(outputs.size(), 1);
+          ASSERT_TRUE(outputs[0].toTensor().allclose(expected));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    ASSERT_TRUE(session.num_runtimes() <= 2);
+    ASSERT_EQ(session.num_rejected(), 0);
+  }
+
+  // Without a queue, requests coming while the runtime is busy are rejected.
+  InferenceSessionOptions options;
+  options.max_concurrency = 1;
+  options.max_queue_size = 0;
+  InferenceSession session(graph, options);
+  std::vector<c10::intrusive_ptr<c10::ivalue::Future>> futures;
+  for (int i = 0; i < 20; i++) {
+    futures.push_back(session.runAsync({x, y}));
+  }
+  size_t num_errors = 0;
+  for (auto& future : futures) {
+    future->wait();
+    if (future->hasError()) {
+      num_errors++;
+    } else {
+      ASSERT_TRUE(future->value().toTensor().allclose(expected));
+    }
+  }
+  ASSERT_EQ(session.num_runtimes(), 1);
+  ASSERT_EQ(session.num_rejected(), num_errors);
+}
+
+} // namespace jit
+} // namespace torch
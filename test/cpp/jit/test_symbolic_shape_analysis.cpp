@@ -0,0 +1,96 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+std::vector<c10::ShapeSymbol> symbolicSizes(Value* value) {
+  auto sizes = value->type()->expect<TensorType>()->symbolic_sizes().sizes();
+  TORCH_INTERNAL_ASSERT(sizes);
+  return *sizes;
+}
+} // namespace
+
+void testSymbolicShapeAnalysis() {
+  const std::string input =
+      R"IR(
+graph(%x : Tensor, %w : Float(32, 16), %y : Tensor):
+  %none : None = prim::Constant()
+  %zero : int = prim::Constant[value=0]()
+  %one : int = prim::Constant[value=1]()
+  %minus_one : int = prim::Constant[value=-1]()
+  %z : Tensor = aten::linear(%x, %w, %none)
+  %r : Tensor = aten::relu(%z)
+  %l : Tensor[] = prim::ListConstruct(%r, %y)
+  %c : Tensor = aten::cat(%l, %one)
+  %batch : int = aten::size(%x, %zero)
+  %shape : int[] = prim::ListConstruct(%batch, %minus_one)
+  %v : Tensor = aten::view(%c, %shape)
+  %u : Tensor = aten::unsqueeze(%v, %one)
+  return (%u)
+)IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(input, graph.get());
+  // x is [batch, 16] and y is [batch', 8], with unknown batch sizes
+  auto batch = c10::ShapeSymbol::newSymbol();
+  auto other_batch = c10::ShapeSymbol::newSymbol();
+  graph->inputs()[0]->setType(TensorType::create(
+      at::kFloat,
+      at::kCPU,
+      c10::SymbolicShape(std::vector<c10::ShapeSymbol>{
+          batch, c10::ShapeSymbol::fromStaticSize(16)}),
+      c10::VaryingShape<c10::Stride>(2),
+      /*requires_grad=*/false));
+  graph->inputs()[2]->setType(TensorType::create(
+      at::kFloat,
+      at::kCPU,
+      c10::SymbolicShape(std::vector<c10::ShapeSymbol>{
+          other_batch, c10::ShapeSymbol::fromStaticSize(8)}),
+      c10::VaryingShape<c10::Stride>(2),
+      /*requires_grad=*/false));
+
+  PropagateSymbolicShapes(graph);
+
+  // cat tells that both batch sizes are the same
+  auto x_sizes = symbolicSizes(graph->inputs()[0]);
+  auto y_sizes = symbolicSizes(graph->inputs()[2]);
+  ASSERT_FALSE(x_sizes[0].is_static());
+  ASSERT_EQ(x_sizes[0], y_sizes[0]);
+
+  auto output_sizes = symbolicSizes(graph->outputs()[0]);
+  ASSERT_EQ(output_sizes.size(), 3);
+  ASSERT_EQ(output_sizes[0], x_sizes[0]);
+  ASSERT_EQ(output_sizes[1], c10::ShapeSymbol::fromStaticSize(1));
+  // the -1 of the view is what remains of [batch, 40] once batch is cancelled
+  ASSERT_EQ(output_sizes[2], c10::ShapeSymbol::fromStaticSize(40));
+
+  // The branches of an if only keep the dimensions they agree on.
+  const std::string if_input =
+      R"IR(
+graph(%x : Float(*, *), %cond : bool):
+  %one : int = prim::Constant[value=1]()
+  %y : Tensor = prim::If(%cond)
+    block0():
+      %a : Tensor = aten::relu(%x)
+      -> (%a)
+    block1():
+      %b : Tensor = aten::t(%x)
+      -> (%b)
+  %z : Tensor = aten::mul(%y, %one)
+  return (%z)
+)IR";
+  auto if_graph = std::make_shared<Graph>();
+  parseIR(if_input, if_graph.get());
+  PropagateSymbolicShapes(if_graph);
+  auto if_x_sizes = symbolicSizes(if_graph->inputs()[0]);
+  auto if_sizes = symbolicSizes(if_graph->outputs()[0]);
+  ASSERT_EQ(if_sizes.size(), 2);
+  ASSERT_FALSE(if_sizes[0] == if_x_sizes[0]);
+  ASSERT_FALSE(if_sizes[1] == if_x_sizes[1]);
+}
+
+} // namespace jit
+} // namespace torch
@@ -19,6 +19,8 @@ namespace jit {
   _(CreateAutodiffSubgraphs)           \
   _(CustomOperators)                   \
   _(CustomOperatorAliasing)            \
+  _(CustomOperatorLazyRegistration)    \
+  _(OperatorLookupHook)                \
   _(IValueKWargs)                      \
   _(CustomFusion)                      \
   _(SchemaMatching)                    \
@@ -47,6 +49,7 @@ namespace jit {
   _(ClassParser)                       \
   _(UnifyTypes)                        \
   _(Profiler)                          \
+  _(AutogradProfilerEventLists)        \
   _(InsertAndEliminateRedundantGuards) \
   _(LoopPeeler)                        \
   _(InsertBailOuts)                    \
@@ -68,6 +71,7 @@ namespace jit {
   _(ScriptObject)                      \
   _(SaveExtraFilesHook)                \
   _(TypeTags)                          \
+  _(PrefetchTensorRecords)             \
   _(DCE)                               \
   _(CustomFusionNestedBlocks)          \
   _(ClassDerive)                       \
@@ -93,7 +97,17 @@ namespace jit {
   _(LiteInterpreterSetState)           \
   _(TorchbindIValueAPI)                \
   _(LiteInterpreterDict)               \
-  _(FusionAliasing)
+  _(LiteInterpreterLoop)               \
+  _(FusionAliasing)                    \
+  _(MemoryPlanning)                    \
+  _(InterpreterObserver)               \
+  _(InterpreterUnpackMovesElements)    \
+  _(ForkIndependentBranches)           \
+  _(SymbolicShapeAnalysis)             \
+  _(StaticRuntime)                     \
+  _(StaticRuntimeGradMode)             \
+  _(InferenceSession)                   \
+  _(KernelDiskCache)
 
 #if defined(USE_CUDA)
 #define TH_FORALL_TESTS_CUDA(_)  \
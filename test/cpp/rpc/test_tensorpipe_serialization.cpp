@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <tensorpipe/core/message.h>
 #include <torch/csrc/distributed/rpc/utils.h>
 #include <torch/torch.h>
@@ -150,3 +151,115 @@ TEST(TensorpipeSerialize, NoDeleterTensors) {
           t2.storage().data(),
           sendingTpMessage.tensors[1].length) == 0);
 }
+
+#ifdef USE_CUDA
+TEST(TensorpipeSerialize, DeviceMapPinnedNonBlocking) {
+  if (!torch::cuda::is_available()) {
+    return;
+  }
+  // Large enough for the copy to CUDA to still be running when the receive
+  // buffers are released.
+  constexpr int64_t kNumel = 1 << 22;
+  at::Tensor t1 = torch::randn({kNumel});
+  at::Tensor t2 = torch::arange(1024, at::ScalarType::Int);
+  std::vector<at::Tensor> tensors{t1, t2};
+  torch::distributed::rpc::Message sendingRpcMessage(
+      std::vector<char>{'1'},
+      std::move(tensors),
+      torch::distributed::rpc::MessageType::UNKNOWN);
+  tensorpipe::Message sendingTpMessage;
+  torch::distributed::rpc::TensorpipeWriteBuffers sendingTpBuffers;
+  std::tie(sendingTpMessage, sendingTpBuffers) =
+      torch::distributed::rpc::tensorpipeSerialize(
+          std::move(sendingRpcMessage), {0, -1});
+
+  // Mimic receiving message descriptor
+  tensorpipe::Message recvingTpMessage;
+  recvingTpMessage.metadata = sendingTpMessage.metadata;
+  for (auto& tpPayload : sendingTpMessage.payloads) {
+    tensorpipe::Message::Payload p;
+    p.length = tpPayload.length;
+    p.metadata = tpPayload.metadata;
+    recvingTpMessage.payloads.push_back(std::move(p));
+  }
+  for (auto& tpTensor : sendingTpMessage.tensors) {
+    tensorpipe::Message::Tensor t;
+    t.length = tpTensor.length;
+    t.metadata = tpTensor.metadata;
+    recvingTpMessage.tensors.push_back(std::move(t));
+  }
+
+  // Tensors that go to a device are read into pinned memory
+  torch::distributed::rpc::TensorpipeReadBuffers recvingTpBuffers =
+      torch::distributed::rpc::tensorpipeAllocate(recvingTpMessage);
+  ASSERT_EQ(recvingTpBuffers.tensors.size(), 2);
+  for (const auto& buffer : recvingTpBuffers.tensors) {
+    EXPECT_TRUE(at::detail::getCUDAHooks().isPinnedPtr(buffer.get()));
+  }
+
+  // Mimic tensorpipe data transfer
+  for (int i = 0; i < recvingTpMessage.payloads.size(); i++) {
+    memcpy(
+        recvingTpMessage.payloads[i].data,
+        sendingTpMessage.payloads[i].data,
+        sendingTpMessage.payloads[i].length);
+  }
+  for (int i = 0; i < recvingTpMessage.tensors.size(); i++) {
+    memcpy(
+        recvingTpMessage.tensors[i].data,
+        sendingTpMessage.tensors[i].data,
+        sendingTpMessage.tensors[i].length);
+  }
+
+  torch::distributed::rpc::Message recvingRpcMessage =
+      torch::distributed::rpc::tensorpipeDeserialize(
+          std::move(recvingTpMessage), std::move(recvingTpBuffers));
+  const auto& recvingTensors = recvingRpcMessage.tensors();
+  ASSERT_EQ(recvingTensors.size(), 2);
+  EXPECT_EQ(recvingTensors[0].device(), at::Device(at::kCUDA, 0));
+  EXPECT_EQ(recvingTensors[1].device(), at::Device(at::kCPU));
+
+  // The pinned buffer of the tensor copied to the device is now only held by
+  // the copy. Pinned memory allocated and overwritten meanwhile must not
+  // reuse it before the copy is done.
+  at::Tensor scratch = at::empty(
+      {kNumel}, at::TensorOptions().dtype(at::kFloat).pinned_memory(true));
+  scratch.fill_(-1);
+
+  EXPECT_TRUE(torch::equal(t1, recvingTensors[0].cpu()));
+  EXPECT_TRUE(torch::equal(t2, recvingTensors[1]));
+}
+
+TEST(TensorpipeSerialize, NoDeviceMapNotPinned) {
+  if (!torch::cuda::is_available()) {
+    return;
+  }
+  std::vector<at::Tensor> tensors{torch::ones({1024})};
+  torch::distributed::rpc::Message sendingRpcMessage(
+      std::vector<char>{'1'},
+      std::move(tensors),
+      torch::distributed::rpc::MessageType::UNKNOWN);
+  tensorpipe::Message sendingTpMessage;
+  torch::distributed::rpc::TensorpipeWriteBuffers sendingTpBuffers;
+  std::tie(sendingTpMessage, sendingTpBuffers) =
+      torch::distributed::rpc::tensorpipeSerialize(
+          std::move(sendingRpcMessage));
+
+  tensorpipe::Message recvingTpMessage;
+  for (auto& tpPayload : sendingTpMessage.payloads) {
+    tensorpipe::Message::Payload p;
+    p.length = tpPayload.length;
+    recvingTpMessage.payloads.push_back(std::move(p));
+  }
+  for (auto& tpTensor : sendingTpMessage.tensors) {
+    tensorpipe::Message::Tensor t;
+    t.length = tpTensor.length;
+    recvingTpMessage.tensors.push_back(std::move(t));
+  }
+  torch::distributed::rpc::TensorpipeReadBuffers recvingTpBuffers =
+      torch::distributed::rpc::tensorpipeAllocate(recvingTpMessage);
+  ASSERT_EQ(recvingTpBuffers.tensors.size(), 1);
+  EXPECT_FALSE(at::detail::getCUDAHooks().isPinnedPtr(
+      recvingTpBuffers.tensors[0].get()));
+}
+#endif
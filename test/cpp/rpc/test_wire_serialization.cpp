@@ -7,6 +7,14 @@
 #include <string>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+
 TEST(WireSerialize, Base) {
   auto run = [](const std::string& payload,
                 const std::vector<at::Tensor>& tensors) {
@@ -100,3 +108,67 @@ TEST(WireSerialize, DISABLED_Sparse) {
   auto deser = torch::distributed::rpc::wireDeserialize(ser.data(), ser.size());
   EXPECT_TRUE(torch::equal(main, deser.second[0]));
 }
+
+TEST(WireSerialize, Metadata) {
+  std::vector<char> payload = {'h', 'i'};
+  std::vector<at::Tensor> tensors = {torch::randn({5, 5}),
+                                     torch::arange(10, torch::kInt64)};
+  auto ser = torch::distributed::rpc::wireSerializeMetadata(payload, tensors);
+  EXPECT_EQ(tensors.size(), ser.second.size());
+  // The tensor data is not part of the serialized string.
+  EXPECT_LT(ser.first.size(), tensors[0].nbytes() + tensors[1].nbytes());
+
+  auto sizes = torch::distributed::rpc::wireTensorDataSizes(
+      ser.first.data(), ser.first.size());
+  EXPECT_EQ(sizes.size(), ser.second.size());
+  // Receive the tensor data in separate buffers, as transports would.
+  std::vector<at::Tensor> received;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    EXPECT_EQ(sizes[i], ser.second[i].numel());
+    received.push_back(torch::empty({sizes[i]}, torch::kChar));
+    received.back().copy_(ser.second[i]);
+  }
+
+  auto deser = torch::distributed::rpc::wireDeserializeMetadata(
+      ser.first.data(), ser.first.size(), received);
+  EXPECT_EQ(payload, deser.first);
+  EXPECT_EQ(tensors.size(), deser.second.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_TRUE(torch::equal(tensors[i], deser.second[i]));
+    // The received buffers are used without copying them.
+    EXPECT_EQ(deser.second[i].data_ptr(), received[i].data_ptr());
+  }
+}
+
+#ifndef _WIN32
+TEST(WireSerialize, ShmSegment) {
+  std::vector<char> payload = {'h', 'i'};
+  std::vector<at::Tensor> tensors = {torch::randn({300, 5}),
+                                     torch::arange(10, torch::kInt64)};
+  auto ser = torch::distributed::rpc::wireSerializeMetadata(payload, tensors);
+  auto sizes = torch::distributed::rpc::wireTensorDataSizes(
+      ser.first.data(), ser.first.size());
+
+  const std::string name = "/trpc_test_" + std::to_string(getpid());
+  ASSERT_TRUE(torch::distributed::rpc::writeShmSegment(name, ser.second));
+  // The name can't be taken twice.
+  EXPECT_FALSE(torch::distributed::rpc::writeShmSegment(name, ser.second));
+
+  auto tensorData = torch::distributed::rpc::readShmSegment(name, sizes);
+  // The segment is removed as soon as the receiver has mapped it...
+  EXPECT_EQ(-1, shm_open(name.c_str(), O_RDONLY, 0));
+  EXPECT_EQ(ENOENT, errno);
+  EXPECT_THROW(
+      torch::distributed::rpc::readShmSegment(name, sizes), c10::Error);
+
+  // ...but the mapping stays valid until the tensors are freed.
+  auto deser = torch::distributed::rpc::wireDeserializeMetadata(
+      ser.first.data(), ser.first.size(), tensorData);
+  tensorData.clear();
+  EXPECT_EQ(payload, deser.first);
+  ASSERT_EQ(tensors.size(), deser.second.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_TRUE(torch::equal(tensors[i], deser.second[i]));
+  }
+}
+#endif
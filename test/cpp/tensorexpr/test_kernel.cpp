@@ -105,5 +105,108 @@ void testKernel_3() {
   }
 }
 
+void testKernelDynamicShapes() {
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(*, *),
+            %1 : Float(*, *)):
+        %2 : Float(*, *) = aten::mul(%0, %1)
+        %3 : Float(*, *) = aten::mul(%0, %2)
+        return (%3))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  bool fallback_allowed = setFallbackAllowed(false);
+  TensorExprKernel k(graph);
+  auto check = [&](const at::Tensor& a, const at::Tensor& b) {
+    auto ref = a * (a * b);
+    std::vector<IValue> stack = fmap<IValue>(std::vector<at::Tensor>{a, b});
+    k.run(stack);
+    auto o = stack[0].toTensor();
+    ASSERT_EQ(o.sizes(), ref.sizes());
+    ASSERT_TRUE(at::equal(o, ref));
+    ASSERT_TRUE(k.getCodeGenStmt());
+  };
+  auto options = TensorOptions(kCPU).dtype(at::kFloat);
+  // The same shape class for different sizes.
+  check(at::rand({5, 3}, options), at::rand({5, 3}, options));
+  check(at::rand({7, 2}, options), at::rand({7, 2}, options));
+  // Broadcasting and non-contiguous inputs are other shape classes.
+  check(at::rand({5, 3}, options), at::rand({1, 3}, options));
+  check(at::rand({4, 1}, options), at::rand({4, 6}, options));
+  check(
+      at::rand({6, 4}, options),
+      at::rand({4, 6}, options).transpose(0, 1));
+
+  // Sizes that don't broadcast aren't run by the generated code.
+  bool threw = false;
+  try {
+    check(at::rand({5, 3}, options), at::rand({4, 3}, options));
+  } catch (const std::exception&) {
+    threw = true;
+  }
+  ASSERT_TRUE(threw);
+  setFallbackAllowed(fallback_allowed);
+}
+
+void testKernelSum() {
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(5:3,3:1),
+            %1 : Float(5:3,3:1)):
+        %2 : Float(5:3,3:1) = aten::mul(%0, %1)
+        %3 : int[] = prim::Constant[value=[1]]()
+        %4 : int[] = prim::Constant[value=[-2]]()
+        %5 : bool = prim::Constant[value=0]()
+        %6 : bool = prim::Constant[value=1]()
+        %7 : None = prim::Constant()
+        %8 : Float(5:1) = aten::sum(%2, %3, %5, %7)
+        %9 : Float(1:3,3:1) = aten::sum(%2, %4, %6, %7)
+        return (%8, %9))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  auto a = at::rand({5, 3}, TensorOptions(kCPU).dtype(at::kFloat));
+  auto b = at::rand({5, 3}, TensorOptions(kCPU).dtype(at::kFloat));
+  bool fallback_allowed = setFallbackAllowed(false);
+  TensorExprKernel k(graph);
+  std::vector<IValue> stack = fmap<IValue>(std::vector<at::Tensor>{a, b});
+  k.run(stack);
+  setFallbackAllowed(fallback_allowed);
+
+  auto o1 = stack[0].toTensor();
+  auto o2 = stack[1].toTensor();
+  ASSERT_EQ(o1.sizes(), at::IntArrayRef({5}));
+  ASSERT_EQ(o2.sizes(), at::IntArrayRef({1, 3}));
+  ASSERT_TRUE(at::allclose(o1, (a * b).sum({1})));
+  ASSERT_TRUE(at::allclose(o2, (a * b).sum({0}, /*keepdim=*/true)));
+}
+
+void testKernelSoftmax() {
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(4:6,6:1)):
+        %1 : int = prim::Constant[value=1]()
+        %2 : None = prim::Constant()
+        %3 : Float(4:6,6:1) = aten::softmax(%0, %1, %2)
+        return (%3))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  // exp underflows for these inputs unless the max is subtracted first.
+  auto a = at::randn({4, 6}, TensorOptions(kCPU).dtype(at::kFloat)) - 200;
+  bool fallback_allowed = setFallbackAllowed(false);
+  TensorExprKernel k(graph);
+  std::vector<IValue> stack = fmap<IValue>(std::vector<at::Tensor>{a});
+  k.run(stack);
+  setFallbackAllowed(fallback_allowed);
+
+  auto o = stack[0].toTensor();
+  ASSERT_TRUE(at::allclose(o, at::softmax(a, 1)));
+}
+
 } // namespace jit
 } // namespace torch
@@ -159,6 +159,22 @@ void testLLVMByteToDoubleCastTest() {
   ASSERT_EQ(cg.value<double>(), 2);
 }
 
+void testLLVMByteToFloatCastTest() {
+  KernelScope kernel_scope;
+  auto a = ByteImm::make(200);
+  auto b = Cast::make(kFloat, a);
+  LLVMExprEval cg(b);
+  ASSERT_EQ(cg.value<float>(), 200.0f);
+}
+
+void testLLVMByteToIntCastTest() {
+  KernelScope kernel_scope;
+  auto a = ByteImm::make(200);
+  auto b = Cast::make(kInt, a);
+  LLVMExprEval cg(b);
+  ASSERT_EQ(cg.value<int>(), 200);
+}
+
 void testLLVMLetTest01() {
   KernelScope kernel_scope;
 
@@ -440,6 +456,34 @@ void testLLVMVectorizerLoadStoreTest() {
   assertAllEqual(c_vec, 21);
 }
 
+void testLLVMVectorizerRintTest() {
+  KernelScope kernel_scope;
+  Buffer a(BufHandle("A", {8}, kFloat));
+
+  Tensor* c = Compute("c", {{8, "i"}}, [&](const VarHandle& i) {
+    return rint(Load::make(a, {i}, 1));
+  });
+
+  Buffer c_buf(BufHandle(c->func_var()));
+  LoopNest l({c});
+  Stmt* s = l.root_stmt();
+  l.vectorize(dynamic_cast<Block*>(s)->front());
+
+  ASSERT_TRUE(dynamic_cast<For*>(dynamic_cast<Block*>(s)->front()) == nullptr);
+
+  LLVMCodeGen cg(s, {a, c_buf});
+
+  // Halfway cases are rounded to even
+  std::vector<float> a_vec = {0.5f, 1.5f, 2.5f, -0.5f, -1.5f, 2.4f, 2.6f, -2.6f};
+  std::vector<float> c_vec(8, 0.0f);
+  std::vector<void*> args({a_vec.data(), c_vec.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+  std::vector<float> expected = {0.0f, 2.0f, 2.0f, -0.0f, -2.0f, 2.0f, 3.0f, -3.0f};
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(c_vec[i], expected[i]);
+  }
+}
+
 void testLLVMMemcpyTest() {
   KernelScope kernel_scope;
   constexpr int N = 32;
@@ -1383,6 +1427,43 @@ void testLLVMRFactorVectorizedReduction() {
   ExpectAllNear(b_v, b_ref, 1e-5);
 }
 
+void testLLVMParallelReduction() {
+  KernelScope kernel_scope;
+
+  int M = 128;
+  int N = 64;
+
+  Buffer a("a", kFloat, {M, N});
+  Tensor* b = Reduce("sum", {{M, "m"}}, Sum(), a, {{N, "n"}});
+  LoopNest loop({b});
+  For* loop_m = loop.getLoopStmtsFor(b).at(0);
+  loop.setParallel(loop_m);
+  ASSERT_TRUE(loop_m->loop_options().is_parallel());
+
+  loop.prepareForCodegen();
+  Stmt* s = loop.root_stmt();
+  s = IRSimplifier::simplify(s);
+
+  LLVMCodeGen cg(s, {a, b});
+
+  PaddedBuffer<float> a_v(M, N, "a_v");
+  PaddedBuffer<float> b_v(M, "b_v");
+  PaddedBuffer<float> b_ref(M, "b_ref");
+
+  for (int i = 0; i < M; i++) {
+    b_ref(i) = 0;
+    for (int j = 0; j < N; j++) {
+      int v = i + j;
+      a_v(i, j) = v;
+      b_ref(i) += v;
+    }
+  }
+
+  cg.call({a_v, b_v});
+
+  ExpectAllNear(b_v, b_ref, 1e-5);
+}
+
 } // namespace jit
 } // namespace torch
 
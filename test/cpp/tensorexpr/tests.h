@@ -191,6 +191,9 @@ namespace jit {
   _(Kernel_1)                               \
   _(Kernel_2)                               \
   _(Kernel_3)                               \
+  _(KernelDynamicShapes)                    \
+  _(KernelSum)                              \
+  _(KernelSoftmax)                          \
   _(FuserPass_1)                            \
   _(FuserPass_2)
 
@@ -241,6 +244,8 @@ namespace jit {
   _(LLVMByteToCharCastTest)                \
   _(LLVMHalfToLongCastTest)                \
   _(LLVMByteToDoubleCastTest)              \
+  _(LLVMByteToFloatCastTest)               \
+  _(LLVMByteToIntCastTest)                 \
   _(LLVMLetTest01)                         \
   _(LLVMLetTest02)                         \
   _(LLVMLetTestMultitype)                  \
@@ -314,9 +319,11 @@ namespace jit {
   _(LLVMEliminatedStmt)                    \
   _(LLVMIfThenElseTest)                    \
   _(LLVMVectorizerLoadStoreTest)           \
+  _(LLVMVectorizerRintTest)                \
   _(LLVMSimpleReduction)                   \
   _(LLVMRFactorReduction)                  \
-  _(LLVMRFactorVectorizedReduction)
+  _(LLVMRFactorVectorizedReduction)        \
+  _(LLVMParallelReduction)
 
 #define TH_FORALL_TENSOREXPR_TESTS_CUDA(_) \
   _(CudaTestVectorAdd01)                   \
@@ -214,6 +214,30 @@ class StoreTestBase(object):
     def test_set_get(self):
         self._test_set_get(self._create_store())
 
+    def _test_multi_set_get(self, fs):
+        fs.multi_set(["key0", "key1"], ["value0", "value1"])
+        fs.multi_set([], [])
+        self.assertEqual([b"value1", b"value0"], fs.multi_get(["key1", "key0"]))
+        self.assertEqual([], fs.multi_get([]))
+        self.assertEqual(b"value1", fs.get("key1"))
+        with self.assertRaises(ValueError):
+            fs.multi_set(["key2"], [])
+
+    def test_multi_set_get(self):
+        self._test_multi_set_get(self._create_store())
+
+    def _test_compare_set(self, fs):
+        # A missing key is only set if the expected value is empty.
+        self.assertEqual(b"", fs.compare_set("key", "value0", "value1"))
+        self.assertEqual(b"value0", fs.compare_set("key", "", "value0"))
+        # A present key is only set if it has the expected value.
+        self.assertEqual(b"value0", fs.compare_set("key", "wrong", "value1"))
+        self.assertEqual(b"value1", fs.compare_set("key", "value0", "value1"))
+        self.assertEqual(b"value1", fs.get("key"))
+
+    def test_compare_set(self):
+        self._test_compare_set(self._create_store())
+
 
 class FileStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -615,6 +639,36 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         pg.broadcast(xs).wait()
         self.assertEqual(0, xs[0].numel())
 
+    def test_collective_profiling(self):
+        from torch.distributed.profiling import (
+            analyze_collective_skew, gather_collective_records)
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Not profiled, it still takes a sequence number
+        pg.allreduce(torch.ones(4)).wait()
+        with torch.autograd.profiler.profile() as prof:
+            for _ in range(3):
+                pg.allreduce(torch.ones(4)).wait()
+            pg.broadcast(torch.ones(4), root=0).wait()
+        self.assertEqual(5, pg.sequence_number())
+
+        collectives = [evt for evt in prof.function_events
+                       if evt.name.startswith('gloo:')]
+        self.assertEqual(
+            ['gloo:all_reduce'] * 3 + ['gloo:broadcast'],
+            [evt.name for evt in collectives])
+        self.assertEqual([1, 2, 3, 4], [evt.sequence_nr for evt in collectives])
+
+        records = gather_collective_records(
+            prof.function_events, store, self.rank, self.world_size)
+        self.assertEqual(self.world_size, len(records))
+        report = analyze_collective_skew(records)
+        self.assertEqual([1, 2, 3, 4], [c.sequence_nr for c in report.collectives])
+        self.assertEqual(4, sum(report.last_counts))
+        self.assertEqual(0.0, report.clock_offsets[0])
+        self.assertTrue(all(c.skew >= 0 for c in report.collectives))
+
     def test_broadcast_checks(self):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -738,6 +792,17 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         inputs = [torch.tensor([i * self.world_size + self.rank]).cuda() for i in range(1000)]
         self._test_broadcast_stress(inputs)
 
+    @skip_if_not_multigpu
+    def test_broadcast_pipelined_cuda(self):
+        # Larger than a pipeline chunk of 4 MB, and not a multiple of it.
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+        numel = 3 * 1024 * 1024 + 7
+        for root in range(self.world_size):
+            t = torch.arange(numel, dtype=torch.float).cuda(self.rank) + self.rank
+            pg.broadcast([t], root=root).wait()
+            self.assertEqual(torch.arange(numel, dtype=torch.float) + root, t)
+
     def test_allreduce_checks(self):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -843,8 +908,9 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
             opts = c10d.AllreduceCoalescedOptions()
             pg.allreduce_coalesced([t1, t3], opts)
 
-        with self.assertRaisesRegex(ValueError, "unsupported layout"):
+        with self.assertRaisesRegex(ValueError, "unsupported reduction operation"):
             opts = c10d.AllreduceCoalescedOptions()
+            opts.reduceOp = c10d.ReduceOp.MAX
             pg.allreduce_coalesced([t3, t3.clone()], opts)
 
     @skip_if_lt_x_gpu(1)
@@ -944,6 +1010,56 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
     def test_sparse_allreduce_basics_cuda(self):
         self._test_sparse_allreduce_basics(lambda t: t.clone().cuda())
 
+    def _test_sparse_allreduce_coalesced_basics(self, fn):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        tests = simple_sparse_reduce_tests(self.rank, self.world_size)
+        expected = [outputs[0] for _, outputs in tests]
+        # A tiny density threshold allreduces all tensors as dense tensors.
+        for density_threshold in [0.0, 1e-6]:
+            tensors = [fn(inputs[0]) for inputs, _ in tests]
+            opts = c10d.AllreduceCoalescedOptions()
+            opts.sparseDensityThreshold = density_threshold
+            work = pg.allreduce_coalesced(tensors, opts)
+            work.wait()
+            self.assertEqual(tensors, expected)
+            self.assertEqual(work.result(), expected)
+            for tensor in work.result():
+                self.assertTrue(tensor.is_sparse)
+                self.assertTrue(tensor.is_coalesced())
+
+    def test_sparse_allreduce_coalesced_basics(self):
+        self._test_sparse_allreduce_coalesced_basics(lambda t: t)
+
+    @skip_if_not_multigpu
+    @skip_if_rocm
+    def test_sparse_allreduce_coalesced_basics_cuda(self):
+        self._test_sparse_allreduce_coalesced_basics(lambda t: t.clone().cuda())
+
+    def test_sparse_allreduce_coalesced_large(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Enough entries for the merge of the gathered tensors to be split
+        # into several partitions.
+        rows = 200000
+        tensors = []
+        expected = []
+        for i in range(2):
+            generator = torch.Generator().manual_seed(i)
+            size = (rows, 3)
+            dense = [torch.zeros(size) for _ in range(self.world_size)]
+            for rank in range(self.world_size):
+                indices = torch.randperm(rows, generator=generator)[:rows // 2]
+                dense[rank][indices] = torch.rand(indices.numel(), 3, generator=generator)
+            tensors.append(dense[self.rank].to_sparse(1))
+            expected.append(sum(dense))
+        pg.allreduce_coalesced(tensors).wait()
+        for tensor, dense in zip(tensors, expected):
+            self.assertTrue(tensor.is_coalesced())
+            self.assertEqual(tensor.to_dense(), dense)
+
     def test_scatter_checks(self):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -1368,6 +1484,30 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
             c10d.all_gather_coalesced(dummy_output_lists, dummy_input, pg)
 
 
+    @skip_if_not_multigpu
+    def test_allgather_coalesced_cuda(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+        device = torch.device('cuda:%d' % self.rank)
+        # The last tensor makes the flattened input span several pipeline
+        # chunks.
+        sizes = [[2, 3], [5], [1024 * 1024 + 3]]
+        inputs = [
+            torch.full(size, float(self.rank * 10 + i), device=device)
+            for i, size in enumerate(sizes)]
+        output_lists = [
+            [torch.empty(size, device=device) for size in sizes]
+            for _ in range(self.world_size)]
+        c10d.all_gather_coalesced(output_lists, inputs, pg)
+        for rank, output_list in enumerate(output_lists):
+            for i, (size, output) in enumerate(zip(sizes, output_list)):
+                self.assertEqual(torch.full(size, float(rank * 10 + i)), output)
+
+        # Outputs must be on the device of the inputs.
+        output_lists[0][0] = torch.empty(sizes[0])
+        with self.assertRaisesRegex(ValueError, "device of the inputs"):
+            c10d.all_gather_coalesced(output_lists, inputs, pg)
+
     def test_reduce_checks(self):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -1554,6 +1694,55 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
                 self.assertEqual(torch.full([10, 10], self.world_size), tensor)
             del pg
 
+    def test_hierarchical(self):
+        # Pretend that ranks {0, 1} and {2, 3} are on the same node.
+        local_size = 2
+        node, local_rank = divmod(self.rank, local_size)
+        store = c10d.FileStore(self.file_name, self.world_size)
+        global_pg = c10d.ProcessGroupGloo(
+            c10d.PrefixStore("global", store), self.rank, self.world_size, self.opts())
+        intra_pg = c10d.ProcessGroupGloo(
+            c10d.PrefixStore("intra/%d" % node, store), local_rank, local_size, self.opts())
+        inter_pg = c10d.ProcessGroupGloo(
+            c10d.PrefixStore("inter/%d" % local_rank, store), node,
+            self.world_size // local_size, self.opts())
+        pg = c10d.ProcessGroupHierarchical(
+            self.rank, self.world_size, global_pg, intra_pg, inter_pg,
+            use_reduce_scatter=False)
+
+        works = []
+        tensors = []
+        for numel in [1, 7, 100]:
+            tensor = torch.full([numel], float(self.rank + 1))
+            tensors.append(tensor)
+            works.append(pg.allreduce(tensor))
+        # Non-contiguous tensors are copied back.
+        tensor = torch.full([4, 6], float(self.rank + 1)).t()
+        tensors.append(tensor)
+        works.append(pg.allreduce(tensor))
+        for work in works:
+            work.wait()
+        expected = float(sum(range(1, self.world_size + 1)))
+        for tensor in tensors:
+            self.assertEqual(torch.full_like(tensor, expected), tensor)
+
+        opts = c10d.AllreduceOptions()
+        opts.reduceOp = c10d.ReduceOp.MAX
+        tensor = torch.full([5], float(self.rank))
+        pg.allreduce([tensor], opts).wait()
+        self.assertEqual(torch.full([5], float(self.world_size - 1)), tensor)
+
+        coalesced = [torch.ones(3), torch.full([2, 2], float(self.rank))]
+        pg.allreduce_coalesced(coalesced).wait()
+        self.assertEqual(torch.full([3], float(self.world_size)), coalesced[0])
+        self.assertEqual(
+            torch.full([2, 2], float(sum(range(self.world_size)))), coalesced[1])
+
+        # Other collectives use the global group.
+        tensor = torch.full([3], float(self.rank))
+        pg.broadcast(tensor, root=3).wait()
+        self.assertEqual(torch.full([3], 3.), tensor)
+
 
 @requires_nccl()
 class ProcessGroupNCCLTest(TestCase):
@@ -1888,6 +2077,72 @@ class QuadraGpuNet(nn.Module):
         return F.softmax(x, dim=1).to(dev0)
 
 
+@unittest.skipIf(TEST_WITH_TSAN, "TSAN is not fork-safe since we're forking in a multi-threaded environment")
+class ProcessGroupHierarchicalNCCLTest(MultiProcessTestCase):
+    def setUp(self):
+        super(ProcessGroupHierarchicalNCCLTest, self).setUp()
+        self._fork_processes()
+
+    @property
+    def world_size(self):
+        return 4
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(4)
+    def test_hierarchical_reduce_scatter(self):
+        # Pretend that ranks {0, 1} and {2, 3} are on the same node.
+        local_size = 2
+        node, local_rank = divmod(self.rank, local_size)
+        store = c10d.FileStore(self.file_name, self.world_size)
+        global_pg = c10d.ProcessGroupNCCL(
+            c10d.PrefixStore("global", store), self.rank, self.world_size)
+        intra_pg = c10d.ProcessGroupNCCL(
+            c10d.PrefixStore("intra/%d" % node, store), local_rank, local_size)
+        inter_pg = c10d.ProcessGroupNCCL(
+            c10d.PrefixStore("inter/%d" % local_rank, store), node,
+            self.world_size // local_size)
+        pg = c10d.ProcessGroupHierarchical(
+            self.rank, self.world_size, global_pg, intra_pg, inter_pg,
+            use_reduce_scatter=True)
+        device = torch.device("cuda", self.rank)
+
+        # Sizes that do not split evenly across the node are padded.
+        works = []
+        tensors = []
+        for numel in [1, 7, 100]:
+            for dtype in [torch.float, torch.half]:
+                tensor = torch.full([numel], float(self.rank + 1), dtype=dtype, device=device)
+                tensors.append(tensor)
+                works.append(pg.allreduce(tensor))
+        # Non-contiguous tensors are copied back.
+        tensor = torch.full([4, 6], float(self.rank + 1), device=device).t()
+        tensors.append(tensor)
+        works.append(pg.allreduce(tensor))
+        for work in works:
+            work.wait()
+        expected = float(sum(range(1, self.world_size + 1)))
+        for tensor in tensors:
+            self.assertEqual(torch.full_like(tensor, expected), tensor)
+
+        # Each rank holds distinct values, so every shard must come back
+        # to its position.
+        tensor = torch.arange(9, dtype=torch.float, device=device) * (self.rank + 1)
+        pg.allreduce(tensor).wait()
+        self.assertEqual(torch.arange(9, dtype=torch.float, device=device) * expected, tensor)
+
+        opts = c10d.AllreduceOptions()
+        opts.reduceOp = c10d.ReduceOp.MAX
+        tensor = torch.full([5], float(self.rank), device=device)
+        pg.allreduce([tensor], opts).wait()
+        self.assertEqual(torch.full([5], float(self.world_size - 1), device=device), tensor)
+
+        coalesced = [torch.ones(3, device=device), torch.full([2, 2], float(self.rank), device=device)]
+        pg.allreduce_coalesced(coalesced).wait()
+        self.assertEqual(torch.full([3], float(self.world_size), device=device), coalesced[0])
+        self.assertEqual(
+            torch.full([2, 2], float(sum(range(self.world_size))), device=device), coalesced[1])
+
+
 @unittest.skipIf(TEST_WITH_TSAN, "TSAN is not fork-safe since we're forking in a multi-threaded environment")
 class DistributedDataParallelTest(MultiProcessTestCase):
     def setUp(self):
@@ -2762,6 +3017,173 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         ddp_parameter = next(ddp_model.parameters())
         self.assertEqual(vanilla_parameter.grad, ddp_parameter.grad)
 
+    @requires_gloo()
+    def test_sparse_gradients_coalesced(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        class SparseGradientModule(nn.Module):
+            def __init__(self):
+                super(SparseGradientModule, self).__init__()
+                self.embedding1 = nn.EmbeddingBag(10, 10, sparse=True)
+                self.embedding2 = nn.EmbeddingBag(20, 10, sparse=True)
+                self.fc = nn.Linear(10, 10)
+
+            def forward(self, x):
+                return F.softmax(self.fc(self.embedding1(x) + self.embedding2(x)), dim=1)
+
+        # Ensure initialized weights and inputs are identical across processes
+        torch.manual_seed(1337)
+
+        vanilla_model = SparseGradientModule()
+        ddp_model = DistributedDataParallel(
+            copy.deepcopy(vanilla_model),
+            process_group=process_group,
+        )
+        ddp_model.set_coalesce_sparse_gradients(True)
+
+        mult = 2
+        batch_size = mult * self.world_size
+        criterion = nn.CrossEntropyLoss()
+        # Run twice, before and after the buckets are rebuilt.
+        for _ in range(2):
+            vanilla_model.zero_grad()
+            ddp_model.zero_grad()
+            input = torch.randint(0, 10, [batch_size, 2])
+            target = torch.randint(0, 10, [batch_size])
+
+            # Run with entire batch against single process version
+            criterion(vanilla_model(input), target).backward()
+
+            # Run with partial batch against multi process version
+            partial_input = input.split(mult)[self.rank]
+            partial_target = target.split(mult)[self.rank]
+            criterion(ddp_model(partial_input), partial_target).backward()
+
+            for vanilla_parameter, ddp_parameter in zip(
+                    vanilla_model.parameters(), ddp_model.parameters()):
+                self.assertEqual(vanilla_parameter.grad, ddp_parameter.grad)
+
+    @requires_gloo()
+    def test_reconfigure_process_group(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        c10d.init_process_group(
+            "gloo", store=store, rank=self.rank, world_size=self.world_size)
+
+        # Ensure initialized weights and inputs are identical across processes
+        torch.manual_seed(1337)
+
+        model = nn.Sequential(nn.Linear(2, 10), nn.ReLU(), nn.Linear(10, 4))
+        ddp_model = DistributedDataParallel(copy.deepcopy(model), bucket_cap_mb=0.0001)
+        input = torch.rand([self.world_size, 2])
+        ddp_model(input[self.rank:self.rank + 1]).sum().backward()
+
+        # Reverse the ranks, and make the parameters differ across processes.
+        rank = self.world_size - 1 - self.rank
+        expected = [torch.rand_like(p) for p in ddp_model.parameters()]
+        with torch.no_grad():
+            for p, e in zip(ddp_model.parameters(), expected):
+                p.copy_(e + rank)
+        pg = c10d.reconfigure_process_group(store, rank, self.world_size, version=1)
+        self.assertEqual(pg, c10d.distributed_c10d._get_default_group())
+        self.assertEqual(rank, c10d.get_rank())
+        ddp_model.reconfigure()
+
+        # The parameters of the new rank 0 were broadcast.
+        for p, e in zip(ddp_model.parameters(), expected):
+            self.assertEqual(e, p)
+
+        with torch.no_grad():
+            for p, q in zip(model.parameters(), ddp_model.parameters()):
+                p.copy_(q)
+        model.zero_grad()
+        ddp_model.zero_grad()
+        model(input).sum().div(self.world_size).backward()
+        ddp_model(input[rank:rank + 1]).sum().backward()
+        for p, q in zip(model.parameters(), ddp_model.parameters()):
+            self.assertEqual(p.grad, q.grad)
+
+        c10d.destroy_process_group()
+
+    @requires_gloo()
+    def test_gradient_as_bucket_view(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        # Ensure initialized weights and inputs are identical across processes
+        torch.manual_seed(1337)
+
+        model = nn.Sequential(nn.Linear(2, 10), nn.ReLU(), nn.Linear(10, 4))
+        ddp_model = DistributedDataParallel(
+            copy.deepcopy(model), process_group=process_group, bucket_cap_mb=0.0001)
+        ddp_model.set_gradient_as_bucket_view(True)
+        input = torch.rand([self.world_size * 2, 2])
+
+        # Run before and after the buckets are rebuilt, with gradients zeroed
+        # in place and set to None.
+        for i in range(4):
+            if i == 3:
+                for p in ddp_model.parameters():
+                    p.grad = None
+            else:
+                ddp_model.zero_grad()
+            model.zero_grad()
+            model(input).sum().div(self.world_size).backward()
+            ddp_model(input.split(2)[self.rank]).sum().backward()
+            for p, q in zip(model.parameters(), ddp_model.parameters()):
+                self.assertEqual(p.grad, q.grad)
+            if i > 0:
+                buckets = [
+                    q.grad.storage().data_ptr() for q in ddp_model.parameters()]
+                # Several parameters share the storage of a bucket.
+                self.assertLess(len(set(buckets)), len(buckets))
+
+    @requires_nccl()
+    @skip_if_not_multigpu
+    def test_sharded_optimizer(self):
+        from torch.distributed.optim import ShardedOptimizer
+
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+        device_id = gpus_for_rank(self.world_size)[self.rank][0]
+
+        # Ensure initialized weights and inputs are identical across processes
+        torch.manual_seed(1337)
+
+        model = nn.Sequential(
+            nn.Linear(2, 7), nn.ReLU(), nn.Linear(7, 4)).cuda(device_id)
+        # A small bucket cap gives several buckets, of sizes that aren't
+        # multiples of the world size.
+        ddp_model = DistributedDataParallel(
+            copy.deepcopy(model), device_ids=[device_id],
+            process_group=process_group, bucket_cap_mb=0.0001)
+        sharded_model = DistributedDataParallel(
+            copy.deepcopy(model), device_ids=[device_id],
+            process_group=process_group, bucket_cap_mb=0.0001)
+        optimizer = torch.optim.Adam(ddp_model.parameters(), lr=0.01)
+        sharded_optimizer = ShardedOptimizer(
+            sharded_model, torch.optim.Adam, lr=0.01)
+
+        criterion = nn.CrossEntropyLoss()
+        batch_size = 4
+        for _ in range(3):
+            input = torch.rand([batch_size, 2], device=device_id)
+            target = torch.LongTensor(
+                [random.randrange(4) for _ in range(batch_size)]).to(device_id)
+            for m, o in [(ddp_model, optimizer), (sharded_model, sharded_optimizer)]:
+                o.zero_grad()
+                criterion(m(input), target).backward()
+                o.step()
+            for p, q in zip(ddp_model.parameters(), sharded_model.parameters()):
+                self.assertEqual(p, q)
+
+        # Every process only keeps the state of its shard.
+        numel = sum(p.numel() for p in model.parameters())
+        state_numel = sum(
+            state['exp_avg'].numel()
+            for state in sharded_optimizer.optimizer.state.values())
+        self.assertLess(state_numel, numel)
+
 
 class ReducerModule(nn.Module):
     def __init__(self):
@@ -2897,6 +3319,105 @@ class ReducerTest(TestCase):
             output.backward()
             optimizer.step()
 
+    def _run_reducer_with_comm_hook(self, comm_hook, iterations=1):
+        torch.manual_seed(0)
+        model = self._create_mixed_precision_model()
+        reducer = self._create_reducer_for_models([model])
+        if comm_hook is not None:
+            reducer._register_comm_hook(comm_hook)
+        loss = nn.CrossEntropyLoss()
+        grads = []
+        for _ in range(iterations):
+            model.zero_grad()
+            input = torch.rand([10, 2], dtype=torch.double)
+            target = torch.LongTensor([random.randrange(4) for _ in range(10)])
+            output = loss(model(input), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            grads.append([p.grad.clone() for p in model.parameters()])
+        return reducer, grads
+
+    def test_comm_hook_fp16_compress(self):
+        _, expected = self._run_reducer_with_comm_hook(None)
+        reducer, grads = self._run_reducer_with_comm_hook(
+            dist.FP16CompressCommHook(self.process_group))
+        for e, g in zip(expected[0], grads[0]):
+            self.assertEqual(e.dtype, g.dtype)
+            self.assertEqual(e, g, atol=1e-3, rtol=1e-3)
+        with self.assertRaisesRegex(RuntimeError, "only be called once"):
+            reducer._register_comm_hook(dist.FP16CompressCommHook(self.process_group))
+
+    def test_comm_hook_topk(self):
+        _, expected = self._run_reducer_with_comm_hook(None, iterations=3)
+        _, grads = self._run_reducer_with_comm_hook(
+            dist.TopKCommHook(self.process_group, 1.0), iterations=3)
+        for e, g in zip(expected, grads):
+            self.assertEqual(e, g)
+
+        # fc1 is alone in its bucket, so only one of its 20 elements is
+        # communicated every iteration. With error feedback, nothing is lost.
+        _, grads = self._run_reducer_with_comm_hook(
+            dist.TopKCommHook(self.process_group, 0.05), iterations=3)
+        residual = torch.zeros_like(expected[0][0]).view(-1)
+        for e, g in zip(expected, grads):
+            residual += e[0].view(-1)
+            index = residual.abs().argmax()
+            self.assertEqual(g[0].nonzero().size(0), 1)
+            self.assertEqual(g[0].view(-1)[index], residual[index])
+            residual[index] = 0
+        with self.assertRaisesRegex(RuntimeError, "ratio"):
+            dist.TopKCommHook(self.process_group, 0.)
+
+    def test_comm_hook_power_sgd(self):
+        # A rank at least the size of the bucket matrix makes PowerSGD exact.
+        _, expected = self._run_reducer_with_comm_hook(None, iterations=2)
+        _, grads = self._run_reducer_with_comm_hook(
+            dist.PowerSGDCommHook(self.process_group, matrix_rank=16), iterations=2)
+        for e, g in zip(expected, grads):
+            for ep, gp in zip(e, g):
+                self.assertEqual(ep, gp, atol=1e-4, rtol=1e-4)
+
+        _, grads = self._run_reducer_with_comm_hook(
+            dist.PowerSGDCommHook(self.process_group, matrix_rank=1), iterations=2)
+        for e, g in zip(expected, grads):
+            for ep, gp in zip(e, g):
+                self.assertEqual(ep.size(), gp.size())
+                self.assertTrue(torch.isfinite(gp).all())
+
+    def test_defer_finalize(self):
+        torch.manual_seed(0)
+        model = self._create_mixed_precision_model()
+        reducer = self._create_reducer_for_models([model])
+        reducer._set_defer_finalize(True)
+        loss = nn.CrossEntropyLoss()
+        parameters = list(model.parameters())
+        for i in range(3):
+            model.zero_grad()
+            input = torch.rand([10, 2], dtype=torch.double)
+            target = torch.LongTensor([random.randrange(4) for _ in range(10)])
+            output = loss(model(input), target)
+            expected = torch.autograd.grad(output, parameters, retain_graph=True)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            pending = reducer._get_pending_buckets()
+            if i == 0:
+                # Buckets are rebuilt after the first iteration.
+                self.assertEqual(pending, [])
+                continue
+            self.assertEqual(pending, [0, 1])
+            finalized = reducer._finalize_bucket(pending[0])
+            self.assertEqual(reducer._get_pending_buckets(), [1])
+            # Finalizing a bucket twice is a no-op.
+            self.assertEqual(reducer._finalize_bucket(pending[0]), finalized)
+            for index in finalized:
+                self.assertEqual(parameters[index].grad, expected[index])
+            if i == 1:
+                reducer._finalize_pending_buckets()
+            # Otherwise the next call to prepare_for_backward finalizes.
+            self.assertEqual(reducer._get_pending_buckets(), [] if i == 1 else [1])
+        with self.assertRaisesRegex(RuntimeError, "out of range"):
+            reducer._finalize_bucket(2)
+
 
 class ComputeBucketAssignmentTest(TestCase):
     def test_single_limit_single_dtype(self):
@@ -3073,6 +3594,50 @@ class NcclErrorHandlingTest(MultiProcessTestCase):
                 process_group.barrier().wait()
 
 
+    @requires_nccl()
+    @requires_nccl_version(2400, "Need NCCL 2.4+ for error checking")
+    @skip_if_lt_x_gpu(3)
+    def test_nccl_errors_async_timeout(self):
+        os.environ["NCCL_ASYNC_ERROR_HANDLING"] = "1"
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(
+            store,
+            self.rank,
+            self.world_size,
+            timeout=timedelta(seconds=self.op_timeout_sec))
+        process_group.allreduce(torch.rand(10).cuda(self.rank)).wait()
+        if self.rank == 0:
+            work = process_group.allreduce(torch.rand(10).cuda(self.rank))
+            # Doesn't block, the timeout is detected in the background.
+            work.wait()
+            self._wait_for_comm_abort(process_group)
+            with self.assertRaisesRegex(RuntimeError, "timed out"):
+                work.wait()
+            # The aborted collective returned, so CUDA can run new events.
+            torch.rand(10).cuda(self.rank).sum().item()
+        elif self.rank == 1:
+            # Wait for the other ranks to abort their communicators before
+            # exiting.
+            time.sleep(4 * self.op_timeout_sec)
+        else:
+            # Now verify communicators on this rank have been aborted by the
+            # watchdog thread, after rank 0 wrote them to the store.
+            time.sleep(2 * self.op_timeout_sec)
+            self._wait_for_comm_abort(process_group)
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(3)
+    def test_invalid_nccl_async_error_handling_env(self):
+        os.environ["NCCL_ASYNC_ERROR_HANDLING"] = "abc"
+        store = c10d.FileStore(self.file_name, self.world_size)
+        with self.assertRaises(RuntimeError):
+            c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        os.environ["NCCL_ASYNC_ERROR_HANDLING"] = "1"
+        os.environ["NCCL_BLOCKING_WAIT"] = "1"
+        with self.assertRaisesRegex(RuntimeError, "cannot be enabled"):
+            c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
     def _run_invalid_nccl_blocking_wait_env(self, val):
         os.environ["NCCL_BLOCKING_WAIT"] = val
         store = c10d.FileStore(self.file_name, self.world_size)
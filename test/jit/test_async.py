@@ -1,6 +1,7 @@
 import io
 import os
 import sys
+import unittest
 
 import torch
 import torch.nn as nn
@@ -8,7 +9,7 @@ import torch.nn as nn
 # Make the helper files in test/ importable
 pytorch_test_dir = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
 sys.path.append(pytorch_test_dir)
-from torch.testing._internal.jit_utils import JitTestCase, _inline_everything
+from torch.testing._internal.jit_utils import JitTestCase, _inline_everything, RUN_CUDA
 from torch.testing._internal.common_utils import TemporaryFileName
 from typing import List, Tuple
 from torch import Tensor
@@ -81,6 +82,35 @@ class TestAsync(JitTestCase):
 
         self.assertEqual(y, y_hat)
 
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    def test_async_script_cuda_streams(self):
+        # forks with CUDA inputs run on their own streams, the results must
+        # still be ready and intact when waited on
+        @torch.jit.script
+        def branch(x, n):
+            # type: (Tensor, int) -> Tensor
+            for _ in range(n):
+                x = torch.mm(x, x).clamp(-1, 1)
+            return x
+
+        @torch.jit.script
+        def fork_branches(x):
+            futures = torch.jit.annotate(List[Future[Tensor]], [])
+            for i in range(4):
+                futures.append(torch.jit._fork(branch, x + i, 10))
+            results = torch.jit.annotate(List[Tensor], [])
+            for future in futures:
+                results.append(torch.jit._wait(future) * 2)
+            return results
+
+        x = torch.randn(512, 512, device='cuda')
+        results = fork_branches(x)
+        for i, result in enumerate(results):
+            self.assertEqual(result, branch(x + i, 10) * 2)
+
+        fut = torch.jit._fork(fork_branches, x)
+        self.assertEqual(torch.jit._wait(fut), results)
+
     def test_async_script_capture(self):
         class Mod(torch.jit.ScriptModule):
             __constants__ = ['const']
@@ -1015,3 +1015,35 @@ class TestFreezing(JitTestCase):
         fm = torch._C._freeze_module(m._c, ["modify_a"])
         FileCheck().check('prim::GetAttr[name="a"]').run(fm.forward.graph)
         FileCheck().check('prim::GetAttr[name="b"]').run(fm.modify_a.graph)
+
+    def test_freeze_module_batches_shared_input_ops(self):
+        class Module(nn.Module):
+            def __init__(self):
+                super(Module, self).__init__()
+                self.wq = torch.randn(8, 4)
+                self.wk = torch.randn(8, 4)
+                self.wv = torch.randn(8, 6)
+                self.bq = torch.randn(4)
+                self.bk = torch.randn(4)
+                self.bv = torch.randn(6)
+                self.conv1 = nn.Conv2d(3, 4, 3, padding=1)
+                self.conv2 = nn.Conv2d(3, 5, 3, padding=1)
+
+            def forward(self, x, y):
+                q = torch.addmm(self.bq, x, self.wq)
+                k = torch.addmm(self.bk, x, self.wk)
+                v = torch.addmm(self.bv, x, self.wv)
+                return q.view(-1) + k.view(-1), v, self.conv1(y).view(-1), self.conv2(y)
+
+        m = torch.jit.script(Module())
+        m.eval()
+        x = torch.randn(2, 8)
+        y = torch.randn(2, 3, 5, 5)
+        expected = m.forward(x, y)
+        fm = torch._C._freeze_module(m._c)
+        FileCheck().check_count("aten::linear", 1, exactly=True) \
+                   .check_count("aten::conv2d", 1, exactly=True).run(fm.forward.graph)
+        FileCheck().check_not("aten::addmm").run(fm.forward.graph)
+        out = fm.forward(x, y)
+        for e, o in zip(expected, out):
+            self.assertEqual(e, o)
@@ -2,7 +2,7 @@
 # torch
 import torch
 from torch.testing import FileCheck
-from torch.testing._internal.common_quantization import QuantizationTestCase
+from torch.testing._internal.common_quantization import QuantizationTestCase, skipIfNoFBGEMM
 
 class TestFusionPasses(QuantizationTestCase):
     def test_quantized_add_relu_fusion(self):
@@ -117,3 +117,48 @@ class TestFusionPasses(QuantizationTestCase):
                    .run(scripted_m.graph)
         output = scripted_m(qA, 3., qC)
         self.assertEqual(ref_output, output)
+
+    @skipIfNoFBGEMM
+    def test_quantized_conv_linear_add_fusion(self):
+        class ConvAddRelu(torch.nn.Module):
+            def __init__(self):
+                super(ConvAddRelu, self).__init__()
+                w = torch.quantize_per_tensor(
+                    torch.randn(4, 4, 3, 3), 0.05, 0, torch.qint8)
+                self.w = torch.ops.quantized.conv2d_prepack(
+                    w, torch.randn(4), [1, 1], [1, 1], [1, 1], 1)
+
+            def forward(self, x, y):
+                a = torch.ops.quantized.conv2d(x, self.w, 0.1, 120)
+                b = torch.ops.quantized.add(y, a, 0.15, 110)
+                return torch.relu(b)
+
+        class LinearAdd(torch.nn.Module):
+            def __init__(self):
+                super(LinearAdd, self).__init__()
+                w = torch.quantize_per_tensor(
+                    torch.randn(4, 16), 0.05, 0, torch.qint8)
+                self.w = torch.ops.quantized.linear_prepack(w, torch.randn(4))
+
+            def forward(self, x, y):
+                a = torch.ops.quantized.linear(x, self.w, 0.1, 120)
+                return torch.ops.quantized.add(a, y, 0.15, 110)
+
+        for m, x_shape, y_shape, fused_op in [
+                (ConvAddRelu(), (2, 4, 8, 8), (2, 4, 8, 8), "quantized::conv2d_add_relu"),
+                (LinearAdd(), (2, 16), (2, 4), "quantized::linear_add(")]:
+            qx = torch.quantize_per_tensor(
+                torch.rand(x_shape), 0.01, 3, torch.quint8)
+            qy = torch.quantize_per_tensor(
+                torch.randn(y_shape), 0.02, 128, torch.quint8)
+            scripted_m = torch.jit.script(m)
+            ref_output = scripted_m(qx, qy)
+            torch._C._jit_pass_inline(scripted_m.graph)
+            torch._C._jit_pass_fuse_quantized_add_relu(scripted_m.graph)
+            torch._C._jit_pass_fuse_quantized_producer_add(scripted_m.graph)
+            FileCheck().check_not("quantized::add") \
+                       .check_not("aten::relu") \
+                       .check(fused_op) \
+                       .run(scripted_m.graph)
+            output = scripted_m(qx, qy)
+            self.assertEqual(ref_output, output)
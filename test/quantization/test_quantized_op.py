@@ -1,6 +1,7 @@
 from __future__ import division
 from builtins import round
 
+import io
 import itertools
 import numpy as np
 import unittest
@@ -2311,6 +2312,66 @@ class TestDynamicQuantizedRNNOp(TestCase):
 
                 self.assertEqual(result_ref[0], result_dynamic[0], msg="torch.quantized_lstm results are off")
 
+    @skipIfNoFBGEMM
+    @given(
+        seq_len=st.integers(2, 5),
+        num_batches=st.integers(1, 4),
+        input_size=st.integers(16, 32),
+        hidden_size=st.integers(4, 8),
+        per_channel_quant=st.booleans())
+    def test_qlstmGRU_sequence(self, seq_len, num_batches, input_size, hidden_size,
+                               per_channel_quant):
+        # The layers quantize the input of the whole sequence at once, while the
+        # cells quantize the input of each step. Every step holds the extreme
+        # values of the sequence so that both use the same quantization
+        # parameters, and running the cells step by step must give the results
+        # of the layer.
+        X = torch.randn(seq_len, num_batches, input_size)
+        X[:, 0, 0] = X.min()
+        X[:, 0, 1] = X.max()
+        H = torch.randn(2, num_batches, hidden_size)
+        C = torch.randn(2, num_batches, hidden_size)
+
+        for rnn_type in ['LSTM', 'GRU']:
+            Wq1, Wq2, b1, b2 = self._get_rnn_weights_and_bias(input_size,
+                                                              hidden_size,
+                                                              2,
+                                                              per_channel_quant,
+                                                              rnn_type)
+            packed_ih = torch.ops.quantized.linear_prepack(Wq1, b1)
+            packed_hh = torch.ops.quantized.linear_prepack(Wq2, b2)
+            cell_params = torch.ops.quantized.make_quantized_cell_params_dynamic(
+                packed_ih, packed_hh, b1, b2, False)
+
+            def run_cells(steps, hidden):
+                outputs = []
+                for t in steps:
+                    if rnn_type == 'LSTM':
+                        hidden = torch.ops.quantized.quantized_lstm_cell_dynamic(
+                            X[t], hidden, packed_ih, packed_hh, b1, b2)
+                        outputs.append(hidden[0])
+                    else:
+                        hidden = torch.ops.quantized.quantized_gru_cell_dynamic(
+                            X[t], hidden, packed_ih, packed_hh, b1, b2)
+                        outputs.append(hidden)
+                return outputs
+
+            if rnn_type == 'LSTM':
+                fw_outputs = run_cells(range(seq_len), (H[0], C[0]))
+                rev_outputs = run_cells(reversed(range(seq_len)), (H[1], C[1]))
+                result = torch.quantized_lstm(X, (H, C), [cell_params, cell_params],
+                                              True, 1, 0, False, True, False,
+                                              dtype=torch.qint8, use_dynamic=True)
+            else:
+                fw_outputs = run_cells(range(seq_len), H[0])
+                rev_outputs = run_cells(reversed(range(seq_len)), H[1])
+                result = torch.quantized_gru(X, H, [cell_params, cell_params],
+                                             True, 1, 0, False, True, False)
+            rev_outputs.reverse()
+            result_ref = torch.cat([torch.stack(fw_outputs), torch.stack(rev_outputs)], 2)
+            self.assertEqual(result_ref, result[0],
+                             msg="torch.quantized_{} sequence results are off".format(rnn_type.lower()))
+
     @given(
         num_batches=st.integers(1, 4),
         input_size=st.integers(16, 32),
@@ -2437,6 +2498,119 @@ class TestDynamicQuantizedRNNOp(TestCase):
         self.assertEqual(Y_fp32, Y_fp32_ref,
                          msg="torch.ops.quantized.fbgemm_linear_dynamic results are off")
 
+class TestQuantizedEmbeddingBag(TestCase):
+    """Tests the correctness of the row-wise quantized embedding bags."""
+
+    ops = {8: (torch.ops.quantized.embedding_bag_byte_prepack, torch.ops.quantized.embedding_bag_byte),
+           4: (torch.ops.quantized.embedding_bag_4bit_prepack, torch.ops.quantized.embedding_bag_4bit),
+           2: (torch.ops.quantized.embedding_bag_2bit_prepack, torch.ops.quantized.embedding_bag_2bit)}
+
+    @given(bit_rate=st.sampled_from([8, 4, 2]),
+           num_embeddings=st.integers(10, 100),
+           embedding_dim=st.integers(1, 16).map(lambda x: x * 8))
+    def test_embedding_bag_prepack_unpack(self, bit_rate, num_embeddings, embedding_dim):
+        prepack, _ = self.ops[bit_rate]
+        weights = torch.randn(num_embeddings, embedding_dim)
+        packed = prepack(weights)
+        unpacked = torch.ops.quantized.embedding_bag_unpack(packed)
+        self.assertEqual(unpacked.size(), weights.size())
+        # The values are rounded to the nearest step of their row. With n-bit
+        # rows, the scale and bias are also rounded to fp16.
+        steps = (weights.max(1, keepdim=True)[0] - weights.min(1, keepdim=True)[0]) / ((1 << bit_rate) - 1)
+        self.assertTrue(((unpacked - weights).abs() <= steps * 0.51 + 1e-2).all())
+
+        # The packed rows are serialized, not the floats.
+        buffer = io.BytesIO()
+        torch.save(packed, buffer)
+        buffer.seek(0)
+        loaded = torch.load(buffer)
+        self.assertEqual(torch.ops.quantized.embedding_bag_unpack(loaded), unpacked)
+
+    @given(bit_rate=st.sampled_from([8, 4, 2]),
+           num_embeddings=st.integers(10, 100),
+           embedding_dim=st.integers(1, 8).map(lambda x: x * 8),
+           num_bags=st.integers(1, 10),
+           mode=st.sampled_from(['sum', 'mean']),
+           use_per_sample_weights=st.booleans(),
+           include_last_offset=st.booleans(),
+           index_dtype=st.sampled_from([torch.int32, torch.int64]))
+    def test_embedding_bag(self, bit_rate, num_embeddings, embedding_dim, num_bags,
+                           mode, use_per_sample_weights, include_last_offset, index_dtype):
+        assume(mode == 'sum' or not use_per_sample_weights)
+        prepack, embedding_bag = self.ops[bit_rate]
+        packed = prepack(torch.randn(num_embeddings, embedding_dim))
+        unpacked = torch.ops.quantized.embedding_bag_unpack(packed)
+
+        lengths = torch.randint(0, 5, (num_bags,))
+        indices = torch.randint(0, num_embeddings, (int(lengths.sum()),))
+        offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)])
+        if not include_last_offset:
+            offsets = offsets[:-1]
+        per_sample_weights = torch.rand(indices.numel()) if use_per_sample_weights else None
+
+        result_ref = F.embedding_bag(indices, unpacked, offsets, mode=mode,
+                                     per_sample_weights=per_sample_weights,
+                                     include_last_offset=include_last_offset)
+        result = embedding_bag(packed, indices.to(index_dtype), offsets,
+                               mode={'sum': 0, 'mean': 1}[mode],
+                               per_sample_weights=per_sample_weights,
+                               include_last_offset=include_last_offset)
+        self.assertEqual(result_ref, result, prec=1e-4)
+
+        # Without offsets, each row of the indices is a bag.
+        bag_size = indices.numel() // num_bags
+        assume(bag_size > 0)
+        indices_2d = indices[:num_bags * bag_size].view(num_bags, bag_size)
+        result_ref = F.embedding_bag(indices_2d, unpacked, mode=mode)
+        result = embedding_bag(packed, indices_2d.to(index_dtype), mode={'sum': 0, 'mean': 1}[mode])
+        self.assertEqual(result_ref, result, prec=1e-4)
+
+    @given(bit_rate=st.sampled_from([8, 4, 2]),
+           num_embeddings=st.integers(1, 600),
+           embedding_dim=st.integers(1, 8).map(lambda x: x * 8),
+           num_queries=st.integers(1, 80),
+           k=st.integers(0, 10))
+    def test_embedding_mm_topk(self, bit_rate, num_embeddings, embedding_dim, num_queries, k):
+        assume(k <= num_embeddings)
+        prepack, _ = self.ops[bit_rate]
+        packed = prepack(torch.randn(num_embeddings, embedding_dim))
+        unpacked = torch.ops.quantized.embedding_bag_unpack(packed)
+        query = torch.randn(num_queries, embedding_dim)
+
+        values, indices = torch.ops.quantized.embedding_mm_topk(packed, query, k)
+        scores = query.mm(unpacked.t())
+        self.assertEqual(scores.topk(k)[0], values, prec=1e-4)
+        self.assertEqual(scores.gather(1, indices), values, prec=1e-4)
+
+    @given(num_keys=st.integers(1, 600),
+           num_subvectors=st.integers(1, 8),
+           subvector_dim=st.integers(1, 4),
+           num_centroids=st.sampled_from([2, 16, 256]),
+           num_queries=st.integers(1, 80),
+           k=st.integers(0, 10))
+    def test_pq_mm_topk(self, num_keys, num_subvectors, subvector_dim, num_centroids, num_queries, k):
+        assume(k <= num_keys)
+        codebooks = torch.randn(num_subvectors, num_centroids, subvector_dim)
+        codes = torch.randint(0, num_centroids, (num_keys, num_subvectors), dtype=torch.uint8)
+        query = torch.randn(num_queries, num_subvectors * subvector_dim)
+
+        values, indices = torch.ops.quantized.pq_mm_topk(query, codebooks, codes, k)
+        # The keys are the concatenations of the centroids of their codes.
+        keys = torch.cat([codebooks[m][codes[:, m].long()] for m in range(num_subvectors)], 1)
+        scores = query.mm(keys.t())
+        self.assertEqual(scores.topk(k)[0], values, prec=1e-4)
+        self.assertEqual(scores.gather(1, indices), values, prec=1e-4)
+
+        with self.assertRaisesRegex(RuntimeError, "out of bounds"):
+            torch.ops.quantized.pq_mm_topk(query, codebooks[:, :1], codes.fill_(1), k)
+
+    def test_embedding_bag_bit_rate_mismatch(self):
+        packed = torch.ops.quantized.embedding_bag_4bit_prepack(torch.randn(10, 8))
+        with self.assertRaisesRegex(RuntimeError, "packed with 8 bits"):
+            torch.ops.quantized.embedding_bag_byte(packed, torch.tensor([0, 1]), torch.tensor([0]))
+        with self.assertRaisesRegex(RuntimeError, "multiple of 2"):
+            torch.ops.quantized.embedding_bag_4bit_prepack(torch.randn(10, 7))
+
 class TestQuantizedLinear(unittest.TestCase):
     """Tests the correctness of the quantized linear and linear_relu op."""
     @given(batch_size=st.integers(1, 4),
@@ -2602,6 +2776,35 @@ class TestQuantizedLinear(unittest.TestCase):
             np.testing.assert_equal(
                 W_q.q_zero_point(), W_q_origin.q_zero_point())
 
+    """Tests that quantized::linear_add(_relu) match linear followed by add."""
+    @given(use_relu=st.booleans(),
+           swap_operands=st.booleans())
+    @override_qengines
+    def test_qlinear_add(self, use_relu, swap_operands):
+        input_channels, output_channels = 16, 64
+        W = torch.randn(output_channels, input_channels)
+        W_q = torch.quantize_per_tensor(W, 0.05, 0, torch.qint8)
+        W_prepack = torch.ops.quantized.linear_prepack(W_q, torch.randn(output_channels))
+        qlinear_add = torch.ops.quantized.linear_add_relu if use_relu \
+            else torch.ops.quantized.linear_add
+        qadd = torch.ops.quantized.add_relu if use_relu else torch.ops.quantized.add
+        # The large batch is added in several chunks.
+        for batch_size in [3, 10000]:
+            X_q = torch.quantize_per_tensor(
+                torch.rand(batch_size, input_channels), 0.01, 3, torch.quint8)
+            other_q = torch.quantize_per_tensor(
+                torch.randn(batch_size, output_channels), 0.02, 128, torch.quint8)
+            Y_q = torch.ops.quantized.linear(X_q, W_prepack, 0.1, 120)
+            if swap_operands:
+                ref = qadd(other_q, Y_q, 0.15, 110)
+            else:
+                ref = qadd(Y_q, other_q, 0.15, 110)
+            result = qlinear_add(X_q, W_prepack, other_q, 0.1, 120, 0.15, 110)
+            self.assertEqual(result.q_scale(), 0.15)
+            self.assertEqual(result.q_zero_point(), 110)
+            np.testing.assert_equal(
+                ref.int_repr().numpy(), result.int_repr().numpy())
+
 class TestQuantizedConv(unittest.TestCase):
     def _test_qconv_unpack_impl(
         self, qconv_prepack_fn, qconv_unpack_fn, inputs, strides, pads,
@@ -2848,6 +3051,86 @@ class TestQuantizedConv(unittest.TestCase):
             dilations, X_scale, X_zero_point, W_scale, W_zero_point,
             Y_scale, Y_zero_point, use_bias, use_relu, use_channelwise)
 
+    """Tests that quantized::conv2d_add(_relu) match conv2d followed by add."""
+    @given(use_relu=st.booleans(),
+           swap_operands=st.booleans())
+    @override_qengines
+    def test_qconv2d_add(self, use_relu, swap_operands):
+        input_channels, output_channels = 4, 64
+        W = torch.randn(output_channels, input_channels, 3, 3)
+        W_q = torch.quantize_per_tensor(W, 0.05, 0, torch.qint8)
+        W_prepack = torch.ops.quantized.conv2d_prepack(
+            W_q, torch.randn(output_channels), [1, 1], [1, 1], [1, 1], 1)
+        qconv_add = torch.ops.quantized.conv2d_add_relu if use_relu \
+            else torch.ops.quantized.conv2d_add
+        qadd = torch.ops.quantized.add_relu if use_relu else torch.ops.quantized.add
+        # An output image of the large batch takes 64KB, the batch is added in
+        # several chunks.
+        for batch_size in [1, 20]:
+            X_q = torch.quantize_per_tensor(
+                torch.rand(batch_size, input_channels, 32, 32), 0.01, 3,
+                torch.quint8)
+            other_q = torch.quantize_per_tensor(
+                torch.randn(batch_size, output_channels, 32, 32), 0.02, 128,
+                torch.quint8)
+            Y_q = torch.ops.quantized.conv2d(X_q, W_prepack, 0.1, 120)
+            if swap_operands:
+                ref = qadd(other_q, Y_q, 0.15, 110)
+            else:
+                ref = qadd(Y_q, other_q, 0.15, 110)
+            result = qconv_add(X_q, W_prepack, other_q, 0.1, 120, 0.15, 110)
+            self.assertEqual(result.q_scale(), 0.15)
+            self.assertEqual(result.q_zero_point(), 110)
+            np.testing.assert_equal(
+                ref.int_repr().numpy(), result.int_repr().numpy())
+
+    """Tests depthwise convolutions, including the ones fbgemm runs with the
+    channels-last depthwise kernels instead of im2col."""
+    @given(batch_size=st.integers(1, 2),
+           spatial_dim=st.sampled_from([2, 3]),
+           groups=st.sampled_from([3, 8, 16]),
+           kernel=st.sampled_from([3, 5]),
+           stride=st.integers(1, 2),
+           pad=st.integers(0, 2),
+           dilation=st.integers(1, 2),
+           X_scale=st.floats(1.2, 1.6),
+           X_zero_point=st.integers(0, 4),
+           W_scale=st.lists(st.floats(0.2, 1.6), min_size=1, max_size=2),
+           W_zero_point=st.lists(st.integers(-5, 5), min_size=1, max_size=2),
+           Y_scale=st.floats(4.2, 5.6),
+           Y_zero_point=st.integers(0, 4),
+           use_bias=st.booleans(),
+           use_relu=st.booleans(),
+           use_channelwise=st.booleans())
+    @skipIfNoFBGEMM
+    def test_qconv_depthwise(
+            self, batch_size, spatial_dim, groups, kernel, stride, pad,
+            dilation, X_scale, X_zero_point, W_scale, W_zero_point, Y_scale,
+            Y_zero_point, use_bias, use_relu, use_channelwise):
+        kernels = (kernel,) * spatial_dim
+        strides = (stride,) * spatial_dim
+        pads = (pad,) * spatial_dim
+        dilations = (dilation,) * spatial_dim
+        input_feature_map_shape = (11,) * spatial_dim
+        if spatial_dim == 2:
+            qconv = torch.ops.quantized.conv2d_relu if use_relu \
+                else torch.ops.quantized.conv2d
+            qconv_prepack = torch.ops.quantized.conv2d_prepack
+            conv_op = torch.nn.Conv2d(
+                groups, groups, kernels, strides, pads, dilations, groups)
+        else:
+            qconv = torch.ops.quantized.conv3d_relu if use_relu \
+                else torch.ops.quantized.conv3d
+            qconv_prepack = torch.ops.quantized.conv3d_prepack
+            conv_op = torch.nn.Conv3d(
+                groups, groups, kernels, strides, pads, dilations, groups)
+        with override_quantized_engine('fbgemm'):
+            self._test_qconv_impl(
+                qconv, qconv_prepack, conv_op, batch_size, 1,
+                input_feature_map_shape, 1, groups, kernels, strides, pads,
+                dilations, X_scale, X_zero_point, W_scale, W_zero_point,
+                Y_scale, Y_zero_point, use_bias, use_relu, use_channelwise)
+
     """Tests the correctness of the quantized::qconv_unpack op."""
     @given(
         inputs=hu.tensor_conv(
@@ -3230,6 +3513,48 @@ class TestQNNPackOps(TestCase):
             self.assertEqual(qYserver, qY_hat,
                              msg="QNNPACK Sigmoid failed (FBGEMM ref)!")
 
+    """Tests quantized::linear (qnnpack) with weights that use the block-sparse
+    kernels."""
+    @given(batch_size=st.integers(1, 9),
+           input_channels=st.integers(1, 37),
+           output_channels=st.integers(1, 19),
+           use_relu=st.booleans(),
+           use_channelwise=st.booleans())
+    def test_qnnpack_linear_sparse(self, batch_size, input_channels,
+                                   output_channels, use_relu, use_channelwise):
+        with override_quantized_engine('qnnpack'):
+            W = torch.randn(output_channels, input_channels)
+            # Keep about one in ten of the 1x4 blocks.
+            num_blocks = (input_channels + 3) // 4
+            block_mask = torch.rand(output_channels, num_blocks) < 0.1
+            W *= block_mask.repeat_interleave(4, dim=1)[:, :input_channels]
+            b = torch.randn(output_channels)
+            if use_channelwise:
+                W_q = torch.quantize_per_channel(
+                    W, scales=torch.rand(output_channels) * 0.05 + 0.01,
+                    zero_points=torch.randint(-10, 10, (output_channels,)),
+                    axis=0, dtype=torch.qint8)
+            else:
+                W_q = torch.quantize_per_tensor(W, 0.02, 3, torch.qint8)
+            X_q = torch.quantize_per_tensor(
+                torch.rand(batch_size, input_channels), 0.01, 10, torch.quint8)
+            Y_scale, Y_zp = 0.05, 100
+
+            W_prepack = torch.ops.quantized.linear_prepack(W_q, b)
+            qlinear = torch.ops.quantized.linear_relu if use_relu \
+                else torch.ops.quantized.linear
+            # Run twice, so that the bias is not requantized the second time.
+            qlinear(X_q, W_prepack, Y_scale, Y_zp)
+            Y_q = qlinear(X_q, W_prepack, Y_scale, Y_zp)
+
+            Y_ref = F.linear(X_q.dequantize(), W_q.dequantize(), b)
+            if use_relu:
+                Y_ref = F.relu(Y_ref)
+            Y_q_ref = torch.quantize_per_tensor(Y_ref, Y_scale, Y_zp, torch.quint8)
+            # Bias is quantized to int32 by QNNPACK, so allow off by one.
+            np.testing.assert_array_almost_equal(
+                Y_q_ref.int_repr().numpy(), Y_q.int_repr().numpy(), decimal=0)
+
     """Tests the correctness of the quantized::add (qnnpack) op."""
     @settings(suppress_health_check=(HealthCheck.filter_too_much,))
     @given(A=hu.tensor(shapes=hu.array_shapes(1, 5, 1, 5),
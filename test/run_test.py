@@ -66,6 +66,7 @@ TESTS = [
     'test_type_promotion',
     'test_jit_disabled',
     'test_function_schema',
+    'test_foreach',
     'test_overrides',
     'test_jit_fuser_te',
     'test_tensorexpr',
@@ -261,6 +261,39 @@ class TestAutograd(TestCase):
             torch.sparse_coo_tensor(torch.tensor([[1, 1]]).long(), torch.tensor([1., 1.])),
             True)
 
+    def test_accumulate_grad_released_grad(self):
+        a = torch.randn(5, 5, requires_grad=True)
+        torch.autograd._reset_accumulate_grad_stats()
+
+        # The gradient of sum() is expanded, so it is cloned rather than
+        # stolen.
+        a.sum().backward()
+        data_ptr = a.grad.data_ptr()
+        self.assertEqual(torch.autograd._accumulate_grad_stats()["cloned"], 1)
+        a.sum().backward()
+        self.assertEqual(a.grad, torch.full((5, 5), 2.))
+        self.assertEqual(torch.autograd._accumulate_grad_stats()["accumulated_in_place"], 1)
+
+        # The released memory is reused for the next gradient.
+        torch.autograd._release_grad(a)
+        self.assertIsNone(a.grad)
+        a.sum().backward()
+        self.assertEqual(a.grad, torch.ones(5, 5))
+        self.assertEqual(a.grad.data_ptr(), data_ptr)
+        stats = torch.autograd._accumulate_grad_stats()
+        self.assertEqual(stats["reused"], 1)
+        self.assertEqual(stats["cloned"], 1)
+
+        # Memory that is referenced elsewhere isn't reused.
+        grad = a.grad
+        torch.autograd._release_grad(a)
+        a.sum().mul(2).backward()
+        self.assertEqual(grad, torch.ones(5, 5))
+        self.assertEqual(a.grad, torch.full((5, 5), 2.))
+        self.assertNotEqual(a.grad.data_ptr(), grad.data_ptr())
+        self.assertEqual(torch.autograd._accumulate_grad_stats()["cloned"], 2)
+        torch.autograd._reset_accumulate_grad_stats()
+
     @skipIfNoLapack
     def test_slogdet_sign(self):
         a = torch.randn(3, 3, requires_grad=True)
@@ -902,6 +935,53 @@ class TestAutograd(TestCase):
             w = adder(x, y)
             self.assertFalse(torch.is_grad_enabled())
 
+    def test_inference_mode(self):
+        x = torch.ones(5, 5, requires_grad=True)
+        y = torch.ones(5, 5) * 4
+        with torch.autograd.inference_mode():
+            self.assertTrue(torch._C._is_inference_mode_enabled())
+            self.assertFalse(torch.is_grad_enabled())
+            w = x + y
+            # In-place operations skip the version counter
+            version = y._version
+            y.add_(1)
+            self.assertEqual(y._version, version)
+            with torch.autograd.inference_mode(False):
+                self.assertFalse(torch._C._is_inference_mode_enabled())
+                y.add_(1)
+                self.assertEqual(y._version, version + 1)
+            self.assertTrue(torch._C._is_inference_mode_enabled())
+        self.assertFalse(torch._C._is_inference_mode_enabled())
+        self.assertTrue(torch.is_grad_enabled())
+        self.assertFalse(w.requires_grad)
+        self.assertIsNone(w.grad_fn)
+        self.assertEqual(w, torch.full((5, 5), 5.))
+        # w is an inference tensor, which autograd refuses outside of the mode
+        with self.assertRaisesRegex(RuntimeError, "Inplace update to inference tensor"):
+            w.add_(1)
+        with self.assertRaisesRegex(RuntimeError, "Setting requires_grad=True on inference tensor"):
+            w.requires_grad_()
+        with self.assertRaisesRegex(RuntimeError, "Inference tensors cannot be saved for backward"):
+            x * w
+        self.assertEqual((x * w.clone()).sum(), 125.)
+
+        @torch.autograd.inference_mode()
+        def adder(x, y):
+            return x + y
+
+        z = adder(x, y)
+        self.assertFalse(z.requires_grad)
+        self.assertTrue(torch.is_grad_enabled())
+        self.assertTrue((x * 2).requires_grad)
+
+        # Plain backward works, but can't record the graph of the derivatives
+        out = (x * 2).sum()
+        with torch.autograd.inference_mode():
+            with self.assertRaisesRegex(RuntimeError, "inference mode"):
+                torch.autograd.grad(out, x, create_graph=True)
+            grad, = torch.autograd.grad(out, x)
+        self.assertEqual(grad, torch.full((5, 5), 2.))
+
     def test_set_grad_generator_functions(self):
         @torch.no_grad()
         def gen_no_grad():
@@ -2650,6 +2730,36 @@ class TestAutograd(TestCase):
             # Now validate the json
             json.load(f)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA not available")
+    @unittest.skipIf(not torch.autograd._cupti_available(), "CUPTI not available")
+    @unittest.skipIf(IS_WINDOWS, """File open permission error on Windows,
+            https://github.com/pytorch/pytorch/issues/34086""")
+    def test_profiler_cupti(self):
+        device = torch.device("cuda:0")
+        t1 = torch.ones(1000, device=device)
+        side_stream = torch.cuda.Stream()
+        with torch.autograd.profiler.profile(use_cupti=True) as prof:
+            torch.add(t1, t1)
+            with torch.cuda.stream(side_stream):
+                torch.mul(t1, t1)
+            t1.cpu()
+
+        kernels = {evt.name: evt.kernels for evt in prof.function_events if evt.kernels}
+        self.assertIn("aten::add", kernels)
+        self.assertIn("aten::mul", kernels)
+        add_streams = {k.stream for k in kernels["aten::add"]}
+        mul_streams = {k.stream for k in kernels["aten::mul"]}
+        self.assertTrue(add_streams.isdisjoint(mul_streams))
+        for evt in prof.function_events:
+            for k in evt.kernels:
+                self.assertGreaterEqual(k.interval.start, evt.cpu_interval.start)
+                self.assertGreaterEqual(k.interval.end, k.interval.start)
+
+        with tempfile.NamedTemporaryFile(mode="w+") as f:
+            prof.export_chrome_trace(f.name)
+            trace = json.load(f)
+            self.assertTrue(any(e["pid"] == "CUDA functions" for e in trace))
+
     def test_profiler(self):
         x = torch.randn(10, 10)
 
@@ -2996,6 +3106,80 @@ class TestAutograd(TestCase):
             ]
         )
 
+    def test_memory_profiler_timeline(self):
+        with profile(profile_memory=True) as prof:
+            x = torch.empty(1024, dtype=torch.uint8)
+            y = torch.empty(2048, dtype=torch.uint8)
+            del x
+            del y
+
+        timeline = prof.function_events.memory_timeline()
+        self.assertTrue(len(timeline) >= 4)
+        timestamps = [timestamp for timestamp, _, _ in timeline]
+        self.assertEqual(timestamps, sorted(timestamps))
+        self.assertGreaterEqual(prof.function_events.peak_cpu_memory_usage, 1024 + 2048)
+        self.assertEqual(timeline[-1][1], 0)
+        self.assertIn("Peak CPU memory allocated", prof.key_averages().table())
+
+        if sys.platform != "win32":
+            with tempfile.NamedTemporaryFile(mode="w+") as f:
+                prof.export_chrome_trace(f.name)
+                trace = json.load(f)
+                counters = [e for e in trace if e["ph"] == "C"]
+                self.assertEqual(len(counters), len(timeline))
+                self.assertEqual(
+                    max(e["args"]["CPU bytes"] for e in counters),
+                    prof.function_events.peak_cpu_memory_usage)
+
+    def test_profiler_flops(self):
+        a = torch.randn(16, 32)
+        b = torch.randn(32, 8)
+        x = torch.randn(2, 3, 10, 10)
+        w = torch.randn(4, 3, 3, 3)
+        with profile(with_flops=True) as prof:
+            torch.mm(a, b)
+            torch.nn.functional.conv2d(x, w, stride=1, padding=1)
+            torch.add(a, a)
+
+        events = {evt.name: evt for evt in prof.function_events}
+        mm = events["aten::mm"]
+        self.assertEqual(mm.flops, 2 * 16 * 32 * 8)
+        self.assertEqual(mm.bytes_moved, (16 * 32 + 32 * 8 + 16 * 8) * 4)
+        # stride 1 and padding 1 keep the 10x10 output size
+        self.assertEqual(events["aten::conv2d"].flops, 2 * 2 * 4 * 10 * 10 * 3 * 3 * 3)
+        add = events["aten::add"]
+        self.assertEqual(add.flops, 16 * 32)
+        self.assertEqual(add.bytes_moved, 3 * 16 * 32 * 4)
+        self.assertGreater(mm.gflops_per_second, 0)
+
+        table = prof.key_averages().table()
+        self.assertIn("GFLOP/s", table)
+        self.assertIn("GB/s", table)
+
+        with profile() as prof:
+            torch.mm(a, b)
+        self.assertEqual(prof.function_events[0].flops, 0)
+
+    @unittest.skipIf(not torch.autograd._perf_counters_available(),
+                     "perf_event counters are not available")
+    def test_profiler_perf_counters(self):
+        a = torch.randn(128, 128)
+        with profile(with_perf_counters=True) as prof:
+            torch.mm(a, a)
+
+        mm = [evt for evt in prof.function_events if evt.name == "aten::mm"][0]
+        self.assertGreater(mm.cycles, 0)
+        self.assertGreater(mm.instructions, 0)
+        self.assertGreater(mm.instructions_per_cycle, 0)
+
+        averages = prof.key_averages()
+        self.assertEqual(
+            [evt for evt in averages if evt.key == "aten::mm"][0].instructions,
+            mm.instructions)
+        table = averages.table(sort_by="cycles")
+        self.assertIn("Cycles", table)
+        self.assertIn("IPC", table)
+
     def test_record_function(self):
         x = torch.randn(10, 10)
 
@@ -3547,6 +3731,200 @@ for shape in [(1,), ()]:
         s = TestCase.runWithPytorchAPIUsageStderr(code)
         self.assertRegex(s, "PYTORCH_API_USAGE torch.autograd.thread_shutdown")
 
+    def test_cpu_workers(self):
+        class Reentrant(Function):
+            @staticmethod
+            def forward(ctx, x):
+                return x * 2
+
+            @staticmethod
+            def backward(ctx, grad):
+                with torch.enable_grad():
+                    y = torch.ones(2, requires_grad=True)
+                    (y * 3).sum().backward()
+                return grad * 2 + y.grad.sum()
+
+        def run():
+            torch.manual_seed(0)
+            x = torch.randn(4, 8, requires_grad=True)
+            towers = [torch.randn(8, 8, requires_grad=True) for _ in range(16)]
+            out = sum((x.mm(w).tanh() * (i + 1)).sum() for i, w in enumerate(towers))
+            out = out + Reentrant.apply(x).sum()
+            grads = torch.autograd.grad(out, [x] + towers, retain_graph=True)
+            out.backward()
+            return grads + (x.grad,) + tuple(w.grad for w in towers)
+
+        expected = run()
+        old_num_workers = torch._C._get_autograd_cpu_workers()
+        try:
+            torch._C._set_autograd_cpu_workers(4)
+            self.assertEqual(torch._C._get_autograd_cpu_workers(), 4)
+            for _ in range(5):
+                for e, r in zip(expected, run()):
+                    self.assertEqual(e, r)
+        finally:
+            torch._C._set_autograd_cpu_workers(old_num_workers)
+        with self.assertRaisesRegex(RuntimeError, "non-negative"):
+            torch._C._set_autograd_cpu_workers(-1)
+
+    def test_static_schedule(self):
+        class Reentrant(Function):
+            @staticmethod
+            def forward(ctx, x):
+                return x * 2
+
+            @staticmethod
+            def backward(ctx, grad):
+                with torch.enable_grad():
+                    y = torch.ones(2, requires_grad=True)
+                    (y * 3).sum().backward()
+                return grad * 2 + y.grad.sum()
+
+        def run(seed):
+            torch.manual_seed(seed)
+            x = torch.randn(4, 8, requires_grad=True)
+            w = torch.randn(8, 8, requires_grad=True)
+            hidden = x
+            for _ in range(3):
+                hidden = hidden.mm(w).tanh()
+            out = hidden.sum() + Reentrant.apply(x).sum() + x.sum()
+            out.backward(retain_graph=True)
+            x_grad, w_grad = x.grad.clone(), w.grad.clone()
+            out.backward()
+            return x_grad, w_grad, x.grad, w.grad
+
+        expected = [run(seed) for seed in range(3)]
+        self.assertFalse(torch._C._is_autograd_static_schedule_enabled())
+        torch._C._set_autograd_static_schedule(True)
+        try:
+            self.assertTrue(torch._C._is_autograd_static_schedule_enabled())
+            # Replays the schedules of the first iteration
+            for _ in range(2):
+                for seed in range(3):
+                    for e, r in zip(expected[seed], run(seed)):
+                        self.assertEqual(e, r)
+
+            a = torch.randn(3, requires_grad=True)
+            b = a.exp()
+            b.sum().backward()
+            with self.assertRaisesRegex(RuntimeError, "Trying to backward through the graph a second time"):
+                b.sum().backward()
+        finally:
+            torch._C._set_autograd_static_schedule(False)
+
+    def test_saved_tensors_hooks(self):
+        from torch.autograd.saved_tensors import saved_tensors_hooks
+        packed = []
+        unpacked = []
+
+        def pack(tensor):
+            packed.append(tensor)
+            return tensor.clone() if tensor.numel() > 1 else None
+
+        def unpack(tensor):
+            unpacked.append(tensor)
+            return tensor
+
+        a = torch.randn(5, requires_grad=True)
+        b = torch.randn(5, requires_grad=True)
+        with saved_tensors_hooks(pack, unpack):
+            out = (a * b).sum() * torch.tensor(2.)
+        self.assertEqual(len(packed), 4)
+        out.backward(retain_graph=True)
+        self.assertEqual(len(unpacked), 2)
+        self.assertEqual(a.grad, 2 * b)
+        self.assertEqual(b.grad, 2 * a)
+        out.backward()
+        self.assertEqual(len(unpacked), 4)
+        with self.assertRaisesRegex(RuntimeError, "second time"):
+            out.backward()
+
+        # Hooks only apply in their scope, and in-place checks still apply.
+        with saved_tensors_hooks(pack, unpack):
+            x = a.detach().requires_grad_()
+            y = x.clone()
+            out = (y * y).sum()
+        self.assertEqual(len(packed), 6)
+        (a * b).sum().backward()
+        self.assertEqual(len(packed), 6)
+        y.add_(1)
+        with self.assertRaisesRegex(RuntimeError, "modified by an inplace operation"):
+            out.backward()
+
+        def bad_unpack(tensor):
+            return None
+
+        with saved_tensors_hooks(pack, bad_unpack):
+            out = (a * b).sum()
+        with self.assertRaisesRegex(RuntimeError, "must return a Tensor"):
+            out.backward()
+
+    def test_saved_tensors_recompute_policy(self):
+        from torch.autograd.saved_tensors import (RecomputePolicy, OffloadPolicy,
+                                                  apply_saved_tensors_policy)
+
+        def make_model():
+            torch.manual_seed(0)
+            return nn.Sequential(nn.Linear(8, 8), nn.Tanh(), nn.Dropout(0.5),
+                                 nn.Sequential(nn.Linear(8, 8), nn.Sigmoid()), nn.Linear(8, 1))
+
+        def run(model):
+            torch.manual_seed(1)
+            x = torch.randn(4, 8, requires_grad=True)
+            model(x).sum().backward()
+            return [x.grad] + [p.grad for p in model.parameters()]
+
+        expected = run(make_model())
+        model = make_model()
+        policy = RecomputePolicy()
+        handles = [apply_saved_tensors_policy(model[i], policy) for i in (1, 2, 3)]
+        # Ignored, since model[3] is recomputed.
+        apply_saved_tensors_policy(model[3][0], OffloadPolicy())
+        for e, r in zip(expected, run(model)):
+            self.assertEqual(e, r)
+        stats = policy.stats()
+        self.assertEqual(stats['num_recomputes'], 3)
+        self.assertGreater(stats['num_dropped'], 0)
+        self.assertGreater(stats['bytes_dropped'], 0)
+
+        with self.assertRaisesRegex(RuntimeError, "modified by an inplace operation"):
+            x = torch.randn(4, 8, requires_grad=True)
+            inp = x * 2
+            out = model[1](inp).sum()
+            inp.add_(1)
+            out.backward()
+
+        for handle in handles:
+            handle.remove()
+        model.zero_grad()
+        policy.reset_stats()
+        run(model)
+        self.assertEqual(policy.stats()['num_recomputes'], 0)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA not available")
+    def test_saved_tensors_offload_policy(self):
+        from torch.autograd.saved_tensors import OffloadPolicy, apply_saved_tensors_policy
+        torch.manual_seed(0)
+        model = nn.Sequential(*[nn.Sequential(nn.Linear(256, 256), nn.ReLU())
+                                for _ in range(4)]).cuda()
+        x = torch.randn(1024, 256, device='cuda', requires_grad=True)
+        model(x).sum().backward()
+        expected = [x.grad.clone()] + [p.grad.clone() for p in model.parameters()]
+        x.grad = None
+        model.zero_grad()
+
+        policy = OffloadPolicy(min_bytes=1024 * 1024, prefetch=2)
+        for layer in model:
+            apply_saved_tensors_policy(layer, policy)
+        model(x).sum().backward()
+        for e, r in zip(expected, [x.grad] + [p.grad for p in model.parameters()]):
+            self.assertEqual(e, r)
+        stats = policy.stats()
+        self.assertGreater(stats['num_offloaded'], 0)
+        self.assertEqual(stats['bytes_offloaded'] % (1024 * 256 * 4), 0)
+        self.assertGreater(stats['num_prefetched'], 0)
+        self.assertLess(stats['num_prefetch_misses'], stats['num_offloaded'])
+
     @unittest.skipIf(IS_MACOS, "Fails with SIGBUS on macOS; https://github.com/pytorch/pytorch/issues/25941")
     def test_deep_reentrant(self):
 
@@ -3648,6 +4026,45 @@ for shape in [(1,), ()]:
         mean_combined = torch.stack(feat_combined).mean()
         mean_combined.backward()
 
+    def test_checkpointing_without_reentrant(self):
+        module = nn.Sequential(
+            nn.Linear(5, 10),
+            nn.Tanh(),
+            nn.Dropout(0.5),
+            nn.Linear(10, 5),
+        )
+        x = torch.randn(3, 5, requires_grad=True)
+
+        torch.manual_seed(0)
+        out = module(x)
+        expected = torch.autograd.grad(out.sum(), [x] + list(module.parameters()))
+
+        for keep_outputs_of in [(), ("AddmmBackward",)]:
+            torch.manual_seed(0)
+            out = checkpoint(module, x, reentrant=False, keep_outputs_of=keep_outputs_of)
+            # Works with torch.autograd.grad, unlike the reentrant checkpoint.
+            grads = torch.autograd.grad(out.sum(), [x] + list(module.parameters()))
+            self.assertEqual(grads, expected)
+
+        # Non-tensor arguments and tuple outputs
+        def fn(a, scale, b):
+            return a.exp() * scale, (a * b).sin()
+
+        a = torch.randn(4, requires_grad=True)
+        b = torch.randn(4, requires_grad=True)
+        out1, out2 = checkpoint(fn, a, 2., b, reentrant=False)
+        (out1.sum() + out2.sum()).backward()
+        self.assertEqual(a.grad, 2 * a.exp() + b * (a * b).cos())
+        self.assertEqual(b.grad, a * (a * b).cos())
+
+        # The inputs can't be modified before backward.
+        a = torch.randn(4, requires_grad=True)
+        b = a.clone()
+        out = checkpoint(lambda t: t.exp().exp(), b, reentrant=False)
+        b.add_(1)
+        with self.assertRaisesRegex(RuntimeError, "modified by an inplace"):
+            out.sum().backward()
+
     def _test_reentrant_with_callbacks(self, install_callbacks_in_depths):
         counter = {}
         counter["inner"] = 0
@@ -23,7 +23,7 @@ from torch.testing._internal.common_methods_invocations import tri_tests_args, t
     _compare_trilu_indices, _compare_large_trilu_indices
 from torch.testing._internal.common_utils import TestCase, get_gpu_type, freeze_rng_state, run_tests, \
     NO_MULTIPROCESSING_SPAWN, skipIfRocm, load_tests, \
-    slowTest, skipCUDANonDefaultStreamIf, TEST_WITH_ROCM, TEST_NUMPY
+    slowTest, skipCUDANonDefaultStreamIf, TEST_WITH_ROCM, TEST_NUMPY, IS_WINDOWS
 from torch.testing._internal.autocast_test_lists import AutocastTestLists
 
 # load_tests from common_utils is used to automatically filter tests for
@@ -301,6 +301,107 @@ class TestCuda(TestCase):
                 torch.cuda.caching_allocator_delete(mem)
                 self.assertEqual(torch.cuda.memory_allocated(), prev)
 
+    def test_memory_stats_thread_cache(self):
+        # The thread-local block caches are configured once per process, so
+        # exercise them in a fresh interpreter.
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="thread_cache_size_mb:4")
+        subprocess.check_call([sys.executable, '-c', """\
+import threading
+import torch
+
+m0 = torch.cuda.memory_allocated()
+
+def worker():
+    stream = torch.cuda.Stream()
+    with torch.cuda.stream(stream):
+        for _ in range(100):
+            tensors = [torch.empty(i * 128, device='cuda') for i in range(1, 64)]
+            assert torch.cuda.memory_allocated() > m0
+            del tensors
+
+threads = [threading.Thread(target=worker) for _ in range(4)]
+for t in threads:
+    t.start()
+for t in threads:
+    t.join()
+
+assert torch.cuda.memory_allocated() == m0, torch.cuda.memory_allocated()
+stats = torch.cuda.memory_stats()
+snapshot = torch.cuda.memory_snapshot()
+assert stats["allocated_bytes.all.current"] == sum(s["allocated_size"] for s in snapshot)
+assert stats["active_bytes.all.current"] == sum(s["active_size"] for s in snapshot)
+torch.cuda.empty_cache()
+assert torch.cuda.memory_reserved() == sum(s["total_size"] for s in torch.cuda.memory_snapshot())
+"""], env=env)
+
+    @unittest.skipIf(TEST_WITH_ROCM or IS_WINDOWS, "expandable segments need the CUDA VMM API")
+    def test_memory_stats_expandable_segments(self):
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="expandable_segments:True")
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+
+def check_consistency():
+    stats = torch.cuda.memory_stats()
+    snapshot = torch.cuda.memory_snapshot()
+    assert stats["reserved_bytes.all.current"] == sum(s["total_size"] for s in snapshot)
+    assert stats["allocated_bytes.all.current"] == sum(s["allocated_size"] for s in snapshot)
+    assert stats["segment.all.current"] == len(snapshot)
+    return snapshot
+
+m0 = torch.cuda.memory_allocated()
+mb = 1024 * 1024 // 4
+tensors = [torch.empty(i * mb, device='cuda') for i in (3, 7, 2, 11, 5)]
+snapshot = check_consistency()
+large = [s for s in snapshot if s["segment_type"] == "large"]
+assert len(large) == 1 and large[0]["is_expandable"], snapshot
+
+# free blocks at the end of the segment are grown in place
+del tensors[-1]
+tensors.append(torch.empty(9 * mb, device='cuda'))
+check_consistency()
+
+del tensors
+torch.cuda.empty_cache()
+check_consistency()
+assert torch.cuda.memory_allocated() == m0
+assert not any(s["segment_type"] == "large" for s in torch.cuda.memory_snapshot())
+"""], env=env)
+
+    def test_memory_trace(self):
+        import subprocess
+        with tempfile.TemporaryDirectory() as tmpdir:
+            oom_file = os.path.join(tmpdir, "oom.txt")
+            env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="trace_entries:4,trace_oom_file:" + oom_file)
+            subprocess.check_call([sys.executable, '-c', """\
+import sys
+import torch
+
+assert torch.cuda.memory_trace() == []
+a = torch.empty(1024, device='cuda')
+b = torch.empty(1 << 20, device='cuda')
+del a
+trace = torch.cuda.memory_trace()
+assert [e["action"] for e in trace] == ["alloc", "segment_alloc", "alloc", "free"], trace
+assert trace[-1]["action"] == "free" and trace[-1]["size"] == 4096, trace
+assert all(e["backtrace"] for e in trace)
+assert any("backtrace" in block for s in torch.cuda.memory_snapshot() for block in s["blocks"])
+
+# the ring buffer only keeps the last trace_entries events
+for _ in range(10):
+    torch.empty(1024, device='cuda')
+assert len(torch.cuda.memory_trace()) == 4
+
+try:
+    torch.empty(1 << 50, dtype=torch.int8, device='cuda')
+except RuntimeError:
+    pass
+assert torch.cuda.memory_trace()[-1]["action"] == "oom"
+with open(sys.argv[1]) as f:
+    assert "CUDA out of memory" in f.read()
+""", oom_file], env=env)
+
     def test_cuda_get_device_name(self):
         # Testing the behaviour with None as an argument
         current_device = torch.cuda.current_device()
@@ -1300,6 +1401,72 @@ class TestCuda(TestCase):
             # real execution time by least 40%.
             self.assertGreater(parent_time + child_time, total_time * 1.4)
 
+    @unittest.skipIf((not TEST_CUDA) or
+                     TEST_WITH_ROCM or
+                     int(torch.version.cuda.split(".")[0]) < 11, "CUDA >= 11.0 required for graphs")
+    def test_graph_capture_simple(self):
+        s = torch.cuda.Stream()
+
+        with torch.cuda.stream(s):
+            a = torch.full((1000,), 1, device="cuda")
+            g = torch._C._CUDAGraph()
+            g.capture_begin()
+            b = a
+            for _ in range(10):
+                b = b + 1
+            g.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+
+        g.replay()
+
+        self.assertTrue(b.sum().item() == 11000.)
+
+    @unittest.skipIf((not TEST_CUDA) or
+                     TEST_WITH_ROCM or
+                     int(torch.version.cuda.split(".")[0]) < 11, "CUDA >= 11.0 required for graphs")
+    def test_graph_rng_functional(self):
+        # Replays of a graph that holds RNG kernels get fresh philox offsets,
+        # so they draw the same values as the ops would eagerly.
+        size = 10000
+        ops = (lambda t: torch.nn.functional.dropout(t, p=0.1),
+               lambda t: t.uniform_(),
+               lambda t: t.normal_())
+        for op in ops:
+            a = torch.randn((size,), device="cuda", dtype=torch.float)
+
+            torch.cuda.manual_seed(5)
+            eager_out = a
+            for _ in range(6):
+                eager_out = op(eager_out)
+
+            torch.cuda.manual_seed(5)
+            s = torch.cuda.Stream()
+            s.wait_stream(torch.cuda.current_stream())
+            with torch.cuda.stream(s):
+                # Warms up the op outside the capture
+                graph_in = a.clone()
+                op(graph_in)
+                torch.cuda.manual_seed(5)
+
+                g = torch._C._CUDAGraph()
+                g.capture_begin()
+                graph_out = graph_in
+                for _ in range(2):
+                    graph_out = op(graph_out)
+                g.capture_end()
+            torch.cuda.current_stream().wait_stream(s)
+
+            # The capture itself does not run the kernels
+            graph_in.copy_(a)
+            g.replay()
+            for _ in range(2):
+                graph_in.copy_(graph_out)
+                g.replay()
+            self.assertEqual(eager_out, graph_out)
+
+            del g
+            torch.cuda.synchronize()
+
     @unittest.skipIf(not TEST_MULTIGPU, "detected only one GPU")
     def test_events_wait(self):
         d0 = torch.device('cuda:0')
@@ -1496,6 +1663,25 @@ class TestCuda(TestCase):
         self.assertNotEqual(t.data_ptr(), ptr, msg='allocation re-used too soon')
         self.assertEqual(list(gpu_tensor), [1])
 
+    def test_caching_pinned_memory_size_classes(self):
+        # sizes are rounded up to one of four size classes per power of two,
+        # and freed blocks are reused within their size class
+        t = torch.empty(1000, dtype=torch.float).pin_memory()
+        ptr = t.data_ptr()
+        stats = torch.cuda.host_memory_stats()
+        del t
+        self.assertEqual(torch.cuda.host_memory_stats()["allocated_bytes.current"],
+                         stats["allocated_bytes.current"] - 4096)
+        t = torch.empty(900, dtype=torch.float).pin_memory()
+        self.assertEqual(t.data_ptr(), ptr, msg='allocation not reused')
+        u = torch.empty(100, dtype=torch.float).pin_memory()
+        self.assertNotEqual(u.data_ptr(), ptr)
+
+        new_stats = torch.cuda.host_memory_stats()
+        self.assertEqual(new_stats["allocation.current"], stats["allocation.current"] + 1)
+        self.assertEqual(new_stats["allocated_bytes.current"], stats["allocated_bytes.current"] + 512)
+        self.assertGreaterEqual(new_stats["reserved_bytes.current"], new_stats["allocated_bytes.current"])
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_caching_pinned_memory_multi_gpu(self):
         # checks that the events preventing pinned memory from being re-used
@@ -2055,6 +2241,46 @@ t2.start()
         self.assertEqual(growth_tracker, 0)
         self.assertEqual(scale, 2.0)
 
+    def test_grad_scaling_foreach_builtins(self, device="cuda"):
+        inv_scale = torch.tensor([0.25], dtype=torch.float, device=device)
+        found_inf = torch.tensor([0.0], dtype=torch.float, device=device)
+
+        # Enough grads, some of several chunks, to need several kernel launches
+        for dtype in torch.float, torch.half:
+            grads = [torch.full((n,), 4.0, dtype=dtype, device=device) for n in (1, 100, 70000) * 40]
+            found_inf.zero_()
+            torch._amp_foreach_non_finite_check_and_unscale_(grads, found_inf, inv_scale)
+            self.assertEqual(found_inf, 0.0)
+            for g in grads:
+                self.assertEqual(g, torch.ones_like(g))
+
+            for bad in float('inf'), float('nan'):
+                grads[-1][-1] = bad
+                found_inf.zero_()
+                torch._amp_foreach_non_finite_check_and_unscale_(grads, found_inf, inv_scale)
+                self.assertEqual(found_inf, 1.0)
+
+        # Mixed dtypes and non-contiguous grads are unscaled one at a time
+        grads = [torch.full((4, 4), 4.0, device=device).t(), torch.full((3,), 4.0, dtype=torch.half, device=device)]
+        found_inf.zero_()
+        torch._amp_foreach_non_finite_check_and_unscale_(grads, found_inf, inv_scale)
+        self.assertEqual(found_inf, 0.0)
+        for g in grads:
+            self.assertEqual(g, torch.ones_like(g))
+
+        scale = torch.tensor([4.0], dtype=torch.float, device=device)
+        scale_ptr = scale.data_ptr()
+        growth_tracker = torch.tensor([0], dtype=torch.int32, device=device)
+        found_inf.zero_()
+        torch._amp_update_scale_(scale, growth_tracker, found_inf, 2.0, 0.25, 2)
+        torch._amp_update_scale_(scale, growth_tracker, found_inf, 2.0, 0.25, 2)
+        self.assertEqual(growth_tracker, 0)
+        self.assertEqual(scale, 8.0)
+        found_inf.fill_(1.0)
+        torch._amp_update_scale_(scale, growth_tracker, found_inf, 2.0, 0.25, 2)
+        self.assertEqual(scale, 2.0)
+        self.assertEqual(scale.data_ptr(), scale_ptr)
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_grad_scaling_device_as_key(self):
         # Ensure that different instances of "device" objects that point to the same device
@@ -2195,6 +2421,32 @@ t2.start()
         try_pickle = True
         self._run_scaling_case(run, unskipped=3, skipped=1, atol=1e-3)
 
+    # Compares the fused optimizers, which skip the step on the device, against the unfused ones.
+    def test_grad_scaling_fused_optimizers(self):
+        for optimizer_ctor, kwargs in ((torch.optim.SGD, dict(lr=1.0)),
+                                       (torch.optim.SGD, dict(lr=0.5, momentum=0.9, dampening=0.1, weight_decay=0.1)),
+                                       (torch.optim.SGD, dict(lr=0.5, momentum=0.9, nesterov=True)),
+                                       (torch.optim.Adam, dict(lr=0.1, weight_decay=0.1)),
+                                       (torch.optim.AdamW, dict(lr=0.1))):
+            def run(data, model, optimizer, scaler, loss_fn, skip_iter, try_scaling_api):
+                optimizer = optimizer_ctor(model.parameters(), fused=try_scaling_api, **kwargs)
+                for i, (input, target) in enumerate(data):
+                    optimizer.zero_grad()
+                    output = model(input)
+                    loss = loss_fn(output, target)
+                    if try_scaling_api:
+                        scaler.scale(loss).backward()
+                        if i == skip_iter and scaler.is_enabled():
+                            model[1].weight.grad.data.fill_(float('inf'))
+                        scaler.step(optimizer)
+                        scaler.update()
+                    else:
+                        loss.backward()
+                        if (not scaler.is_enabled()) or (i != skip_iter):
+                            optimizer.step()
+
+            self._run_scaling_case(run, unskipped=3, skipped=1, atol=1e-5)
+
     def test_grad_scaling_clipping(self):
         def run(data, model, optimizer, scaler, loss_fn, skip_iter, try_scaling_api):
             max_norm = 0.2  # A reasonable value that actually has an effect, based on printouts of grads
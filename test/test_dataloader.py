@@ -9,6 +9,7 @@ import time
 import signal
 import unittest
 import itertools
+import collections
 import warnings
 from torch import multiprocessing as mp
 from torch.utils.data import _utils, Dataset, IterableDataset, TensorDataset, DataLoader, ConcatDataset, ChainDataset
@@ -1263,6 +1264,56 @@ except RuntimeError as e:
     def test_seqential_batch_workers(self):
         self._test_sequential(DataLoader(self.dataset, batch_size=2, num_workers=4))
 
+    def test_worker_ring(self):
+        for ring_size in (4096, 768):
+            # Only some of the batches fit in the smaller ring, the others
+            # are pickled as usual.
+            self._test_sequential(DataLoader(
+                self.dataset, batch_size=2, num_workers=4, worker_ring_size=ring_size))
+            self._test_shuffle(DataLoader(
+                self.dataset, batch_size=2, shuffle=True, num_workers=4,
+                worker_ring_size=ring_size))
+            if TEST_CUDA:
+                self._test_sequential(DataLoader(
+                    self.dataset, batch_size=2, num_workers=4, pin_memory=True,
+                    worker_ring_size=ring_size))
+        with self.assertRaisesRegex(ValueError, "worker_ring_size option should be non-negative"):
+            DataLoader(self.dataset, num_workers=4, worker_ring_size=-1)
+
+    def test_tensor_ring(self):
+        ring = _utils.ring.TensorRing(1024)
+        point = collections.namedtuple('point', ['x', 'y'])
+        param = torch.nn.Parameter(torch.ones(2))
+        # Every batch takes 128 bytes of the 896 bytes of records of the ring,
+        # so that they wrap around its end.
+        for i in range(10):
+            a = torch.arange(i, i + 6, dtype=torch.int64).view(2, 3).t()
+            c = torch.zeros(20, dtype=torch.uint8)
+            sent = [
+                ring.put(0, {'a': a, 'b': 'b'}),
+                ring.put(0, [point(torch.tensor(float(i)), torch.empty(0, 2)), (param, 3)]),
+                ring.put(0, c),
+            ]
+            for data in sent:
+                self.assertIsInstance(data, _utils.ring._RingBatch)
+            received = [_utils.ring.unpack(data, [ring]) for data in sent]
+
+            self.assertEqual(set(received[0].keys()), {'a', 'b'})
+            self.assertEqual(received[0]['a'], a, atol=0, rtol=0)
+            self.assertEqual(received[0]['b'], 'b')
+            pt, (p, n) = received[1]
+            self.assertIsInstance(pt, point)
+            self.assertEqual(pt.x, torch.tensor(float(i)), atol=0, rtol=0)
+            self.assertEqual(pt.y.size(), torch.Size([0, 2]))
+            self.assertIs(p, param)
+            self.assertEqual(n, 3)
+            self.assertEqual(received[2], c, atol=0, rtol=0)
+        # Too large for the ring, or without tensors
+        t = torch.zeros(1024)
+        self.assertIs(ring.put(0, t), t)
+        self.assertEqual(ring.put(0, [1, 'a']), [1, 'a'])
+        self.assertIsNone(torch._C._tensor_ring_get(ring.buffer))
+
     def test_shuffle_workers(self):
         self._test_shuffle(DataLoader(self.dataset, shuffle=True, num_workers=4))
 
@@ -1736,14 +1787,14 @@ except RuntimeError as e:
 
         # FIXME: fix the following hack that makes `default_collate` believe
         #        that it is in a worker process (since it tests
-        #        `get_worker_info() != None`), even though it is not.
-        old = _utils.worker._worker_info
+        #        `_worker_arena != None`), even though it is not.
+        old = _utils.worker._worker_arena
         try:
-            _utils.worker._worker_info = 'x'
+            _utils.worker._worker_arena = mp.SharedMemoryArena()
             self.assertEqual(_utils.collate.default_collate([t_in]).is_shared(), True)
             self.assertEqual(_utils.collate.default_collate([n_in]).is_shared(), True)
         finally:
-            _utils.worker._worker_info = old
+            _utils.worker._worker_arena = old
 
 
 class StringDataset(Dataset):
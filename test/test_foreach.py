@@ -0,0 +1,113 @@
+import torch
+from torch.testing._internal.common_utils import TestCase, run_tests
+from torch.testing._internal.common_device_type import instantiate_device_type_tests, dtypes
+
+class TestForeach(TestCase):
+    def _get_test_data(self, device, dtype, n_tensors, size=20):
+        return [torch.randn(size, size, device=device, dtype=dtype) for _ in range(n_tensors)]
+
+    @dtypes(torch.float, torch.double)
+    def test_binary_op_scalar(self, device, dtype):
+        for n_tensors in [1, 5, 300]:
+            tensors = self._get_test_data(device, dtype, n_tensors)
+            for foreach_op, foreach_op_, torch_op in [
+                    (torch._foreach_add, torch._foreach_add_, torch.add),
+                    (torch._foreach_mul, torch._foreach_mul_, torch.mul),
+                    (torch._foreach_div, torch._foreach_div_, torch.div)]:
+                expected = [torch_op(t, 3) for t in tensors]
+                self.assertEqual(foreach_op(tensors, 3), expected)
+
+                copies = [t.clone() for t in tensors]
+                foreach_op_(copies, 3)
+                self.assertEqual(copies, expected)
+
+    @dtypes(torch.float, torch.double)
+    def test_add_list(self, device, dtype):
+        for n_tensors in [1, 5, 300]:
+            tensors1 = self._get_test_data(device, dtype, n_tensors)
+            tensors2 = self._get_test_data(device, dtype, n_tensors)
+            expected = [torch.add(t1, t2, alpha=0.5) for t1, t2 in zip(tensors1, tensors2)]
+            self.assertEqual(torch._foreach_add(tensors1, tensors2, alpha=0.5), expected)
+
+            torch._foreach_add_(tensors1, tensors2, alpha=0.5)
+            self.assertEqual(tensors1, expected)
+
+    @dtypes(torch.float, torch.double)
+    def test_sqrt(self, device, dtype):
+        tensors = [t.abs() for t in self._get_test_data(device, dtype, 20)]
+        expected = [torch.sqrt(t) for t in tensors]
+        self.assertEqual(torch._foreach_sqrt(tensors), expected)
+
+        torch._foreach_sqrt_(tensors)
+        self.assertEqual(tensors, expected)
+
+    @dtypes(torch.float, torch.double)
+    def test_addcmul_addcdiv(self, device, dtype):
+        tensors = self._get_test_data(device, dtype, 20)
+        tensors1 = self._get_test_data(device, dtype, 20)
+        tensors2 = [t.abs() + 1 for t in self._get_test_data(device, dtype, 20)]
+        for foreach_op_, torch_op in [(torch._foreach_addcmul_, torch.addcmul),
+                                      (torch._foreach_addcdiv_, torch.addcdiv)]:
+            expected = [torch_op(t, t1, t2, value=-0.5) for t, t1, t2 in zip(tensors, tensors1, tensors2)]
+            copies = [t.clone() for t in tensors]
+            foreach_op_(copies, tensors1, tensors2, value=-0.5)
+            self.assertEqual(copies, expected)
+
+    @dtypes(torch.float, torch.double)
+    def test_norm(self, device, dtype):
+        tensors = self._get_test_data(device, dtype, 20)
+        tensors.append(torch.randn(300000, device=device, dtype=dtype))
+        for ord in [1, 2, float('inf'), 0.5]:
+            expected = [torch.norm(t, ord) for t in tensors]
+            self.assertEqual(torch._foreach_norm(tensors, ord), expected)
+
+    @dtypes(torch.float, torch.double)
+    def test_mul_tensor(self, device, dtype):
+        tensors = self._get_test_data(device, dtype, 20)
+        scale = torch.tensor(0.25, device=device)
+        expected = [torch.mul(t, scale) for t in tensors]
+        torch._foreach_mul_(tensors, scale)
+        self.assertEqual(tensors, expected)
+
+        with self.assertRaisesRegex(RuntimeError, "Expected a 0-dim tensor"):
+            torch._foreach_mul_(tensors, torch.ones(2, device=device))
+
+    def test_large_tensors(self, device):
+        # Tensors that span several chunks, and launches, of the multi-tensor
+        # kernels.
+        tensors = [torch.randn(300000, device=device) for _ in range(3)]
+        expected = [torch.add(t, 1) for t in tensors]
+        self.assertEqual(torch._foreach_add(tensors, 1), expected)
+
+    def test_mixed_dtypes_and_layouts(self, device):
+        # Lists the multi-tensor kernels don't handle take the slow route.
+        tensors = [torch.randn(10, 10, device=device),
+                   torch.randn(10, 10, device=device, dtype=torch.double),
+                   torch.randn(10, 10, device=device).t(),
+                   torch.zeros(10, 10, device=device, dtype=torch.long)]
+        expected = [torch.mul(t, 2) for t in tensors]
+        self.assertEqual(torch._foreach_mul(tensors, 2), expected)
+
+    def test_bumps_version(self, device):
+        tensors = self._get_test_data(device, torch.float, 3)
+        versions = [t._version for t in tensors]
+        torch._foreach_add_(tensors, 1)
+        self.assertEqual([t._version for t in tensors], [v + 1 for v in versions])
+
+    def test_errors(self, device):
+        with self.assertRaisesRegex(RuntimeError, "must have at least one tensor"):
+            torch._foreach_add([], 1)
+
+        tensors1 = self._get_test_data(device, torch.float, 3)
+        tensors2 = self._get_test_data(device, torch.float, 2)
+        with self.assertRaisesRegex(RuntimeError, "must have the same number of tensors"):
+            torch._foreach_add(tensors1, tensors2)
+
+        tensors2 = self._get_test_data(device, torch.float, 3, size=5)
+        with self.assertRaisesRegex(RuntimeError, "must have the same size"):
+            torch._foreach_add(tensors1, tensors2)
+
+instantiate_device_type_tests(TestForeach, globals())
+
+if __name__ == '__main__':
+    run_tests()
@@ -2383,6 +2383,29 @@ class TestScript(JitTestCase):
             .check("aten::mul") \
             .run(m.inlined_graph)
 
+    def test_unboxed_trampoline_ops(self):
+        # These ops are called unboxed by the interpreter, see NOTE [Unboxed
+        # calls from the interpreter] in register_c10_ops.cpp
+        def fn(x, w, b, img, kernel):
+            y = torch.add(x, x, alpha=2) - torch.sub(x, w, alpha=0.5)
+            y = torch.mm(y * w, w.t()) / (x + 1)
+            y = torch.addmm(y, x, w.t(), beta=0.5, alpha=2)
+            y = torch.relu(torch.matmul(y, x)) + torch.sigmoid(y) + torch.tanh(y)
+            z = torch.nn.functional.linear(y, w, b) + torch.nn.functional.linear(y, w)
+            c = torch.conv2d(img, kernel, None, [2, 1], [1, 0], [1, 1], 1)
+            return z, c
+
+        scripted = torch.jit.script(fn)
+        args = [torch.randn(3, 3, requires_grad=True), torch.randn(3, 3, requires_grad=True),
+                torch.randn(3), torch.randn(1, 2, 5, 5), torch.randn(4, 2, 3, 3, requires_grad=True)]
+        for _ in range(2):
+            outputs = scripted(*args)
+            expected = fn(*args)
+            self.assertEqual(outputs, expected)
+            grads = torch.autograd.grad(outputs[0].sum() + outputs[1].sum(), [args[0], args[4]])
+            expected_grads = torch.autograd.grad(expected[0].sum() + expected[1].sum(), [args[0], args[4]])
+            self.assertEqual(grads, expected_grads)
+
     def test_static_method_on_module(self):
         """
         Check that the `@staticmethod` annotation on a function on a module works.
@@ -2566,6 +2589,30 @@ class TestScript(JitTestCase):
                 FileCheck().check("Double(*:2, 2:1) = ").run(graph_str)
                 FileCheck().check_not("Double(1:2, 2:1) = ").run(graph_str)
 
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "skip if profiling isn't enabled")
+    def test_specialized_plans(self):
+        @torch.jit.script
+        def foo(x):
+            return x * 2 + 1
+
+        old_max_plans = torch._C._jit_set_max_specialized_plans(2)
+        old_threshold = torch._C._jit_set_plan_promotion_threshold(2)
+        try:
+            with enable_profiling_mode_for_profiling_tests():
+                for size in [2, 2, 3, 3, 2, 3, 4, 4, 5]:
+                    x = torch.ones(size)
+                    self.assertEqual(foo(x), x * 2 + 1)
+                stats = foo.get_debug_state().plan_cache_stats
+        finally:
+            torch._C._jit_set_max_specialized_plans(old_max_plans)
+            torch._C._jit_set_plan_promotion_threshold(old_threshold)
+
+        # the plan of the least recently used shape (2) made room for (4)
+        self.assertEqual(stats.hits, 2)
+        self.assertEqual(stats.misses, 4)
+        self.assertEqual(stats.promotions, 3)
+        self.assertEqual(stats.evictions, 1)
+        self.assertEqual(stats.size, 2)
 
     def test_nested_bailouts(self):
         @torch.jit.script
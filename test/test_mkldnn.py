@@ -1,5 +1,6 @@
 from __future__ import absolute_import, division, print_function, unicode_literals
 import copy
+import itertools
 import unittest
 
 try:
@@ -177,6 +178,102 @@ class TestMkldnn(TestCase):
                 conv2d(x),
                 conv2d_loaded(x.to_mkldnn()).to_dense())
 
+    def test_conv2d_primitive_cache(self):
+        # Alternate shapes, so that the cached primitives are reused
+        conv2d = torch.nn.Conv2d(8, 16, 3, padding=1).float()
+        for _ in range(2):
+            for shape in [(2, 8, 16, 16), (3, 8, 9, 12)]:
+                x = torch.randn(shape, dtype=torch.float32)
+                with torch.backends.mkldnn.flags(enabled=False):
+                    y_aten = conv2d(x)
+                y_mkldnn = torch.mkldnn_convolution(
+                    x, conv2d.weight, conv2d.bias, conv2d.padding,
+                    conv2d.stride, conv2d.dilation, conv2d.groups)
+                self.assertEqual(y_aten, y_mkldnn)
+
+    def test_conv2d_prepacked_frozen_module(self):
+        class Net(torch.nn.Module):
+            def __init__(self, groups, bias):
+                super(Net, self).__init__()
+                self.conv1 = torch.nn.Conv2d(8, 8, 3, padding=1, groups=groups, bias=bias)
+                self.conv2 = torch.nn.Conv2d(8, 4, 1, stride=2, bias=bias)
+
+            def forward(self, x):
+                return self.conv2(F.relu(self.conv1(x)))
+
+        for groups in [1, 4]:
+            for bias in [True, False]:
+                model = Net(groups, bias).eval()
+                x = torch.randn(2, 8, 14, 14, dtype=torch.float32)
+                with torch.backends.mkldnn.flags(enabled=False):
+                    y_aten = model(x)
+
+                packed = torch._C._jit_pass_mkldnn_prepack_frozen_module(torch.jit.script(model)._c)
+                graph = str(packed.forward.graph)
+                self.assertIn("mkldnn_prepacked::conv2d_run", graph)
+                self.assertNotIn("mkldnn_prepacked::conv2d_prepack", graph)
+                self.assertEqual(y_aten, packed.forward(x))
+                self.assertEqual(y_aten, packed.forward(x.to_mkldnn()).to_dense())
+
+    def _test_conv_transpose_base(self, dim):
+        conv_module = {2: torch.nn.ConvTranspose2d, 3: torch.nn.ConvTranspose3d}
+        input_shapes = {2: (14, 15), 3: (6, 7, 5)}
+        options = itertools.product([True, False], [1, 2], [(0, 0), (1, 0), (1, 1)], [1, 2])
+        for bias, stride, (padding, output_padding), dilation in options:
+            N = torch.randint(1, 3, (1,)).item()
+            C = torch.randint(1, 3, (1,)).item() * 4
+            M = torch.randint(1, 3, (1,)).item() * 4
+            x = torch.randn((N, C) + input_shapes[dim], dtype=torch.float32)
+            conv = conv_module[dim](in_channels=C,
+                                    out_channels=M,
+                                    kernel_size=3,
+                                    stride=stride,
+                                    padding=padding,
+                                    output_padding=output_padding if stride > 1 or dilation > 1 else 0,
+                                    dilation=dilation,
+                                    bias=bias).float()
+            # The weight requires grad, which takes the gemm and col2im path
+            with torch.backends.mkldnn.flags(enabled=False):
+                y_aten = conv(x)
+            with torch.no_grad():
+                y_mkldnn = conv(x)
+                self.assertEqual(y_aten, y_mkldnn)
+                self.assertEqual(y_aten, conv(x.to_mkldnn()).to_dense())
+                if dim == 2:
+                    # Direct channels last kernel
+                    with torch.backends.mkldnn.flags(enabled=False):
+                        self.assertEqual(y_aten, conv(x))
+                        self.assertEqual(y_aten, conv(x.to(memory_format=torch.channels_last)))
+
+    def test_conv_transpose2d(self):
+        self._test_conv_transpose_base(dim=2)
+
+    def test_conv_transpose3d(self):
+        self._test_conv_transpose_base(dim=3)
+
+    def test_conv_transpose2d_prepacked_frozen_module(self):
+        class Net(torch.nn.Module):
+            def __init__(self, bias):
+                super(Net, self).__init__()
+                self.up1 = torch.nn.ConvTranspose2d(8, 8, 3, stride=2, padding=1, output_padding=1, bias=bias)
+                self.up2 = torch.nn.ConvTranspose2d(8, 4, 4, stride=2, padding=1, bias=bias)
+
+            def forward(self, x):
+                return self.up2(F.relu(self.up1(x)))
+
+        for bias in [True, False]:
+            model = Net(bias).eval()
+            x = torch.randn(2, 8, 7, 9, dtype=torch.float32)
+            with torch.backends.mkldnn.flags(enabled=False):
+                y_aten = model(x)
+
+            packed = torch._C._jit_pass_mkldnn_prepack_frozen_module(torch.jit.script(model)._c)
+            graph = str(packed.forward.graph)
+            self.assertIn("mkldnn_prepacked::conv_transpose2d_run", graph)
+            self.assertNotIn("mkldnn_prepacked::conv_transpose2d_prepack", graph)
+            self.assertEqual(y_aten, packed.forward(x))
+            self.assertEqual(y_aten, packed.forward(x.to_mkldnn()).to_dense())
+
     def test_relu(self):
         x = torch.randn((4, 5), dtype=torch.float32) * 10
         self.assertEqual(torch.relu(x), torch.relu(x.to_mkldnn()).to_dense())
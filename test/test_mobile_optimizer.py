@@ -127,6 +127,46 @@ class TestOptimizer(unittest.TestCase):
         bn_input = torch.rand(1, 1, 6, 6)
         torch.testing.assert_allclose(bn_scripted_module(bn_input), no_bn_fold_scripted_module(bn_input), rtol=1e-2, atol=1e-3)
 
+    @unittest.skipUnless(torch.backends.xnnpack.enabled,
+                         " XNNPACK must be enabled for these tests."
+                         " Please build with USE_XNNPACK=1.")
+    def test_optimize_for_mobile_channels_last(self):
+        class ConvRunModule(torch.nn.Module):
+            def __init__(self):
+                super(ConvRunModule, self).__init__()
+                self.conv1 = torch.nn.Conv2d(3, 8, 3, padding=1)
+                self.conv2 = torch.nn.Conv2d(8, 8, 3, padding=1)
+                self.conv3 = torch.nn.Conv2d(8, 8, 1)
+
+            def forward(self, x):
+                o = F.relu(self.conv1(x))
+                o = F.max_pool2d(o, 2)
+                o = o + self.conv2(o)
+                o = self.conv3(o)
+                return o.view(o.size(0), -1)
+
+        input_data = torch.rand(2, 3, 16, 16)
+        scripted_model = torch.jit.script(ConvRunModule())
+        scripted_model.eval()
+        initial_result = scripted_model(input_data)
+
+        # The activations are converted to NHWC before the first convolution
+        # and back to contiguous before the view only.
+        optimized_model = optimize_for_mobile(scripted_model)
+        FileCheck().check_count("prepacked::to_channels_last_padded", 1, exactly=True) \
+                   .check_count("prepacked::conv2d_clamp_run", 3, exactly=True) \
+                   .check("aten::contiguous") \
+                   .check("aten::view") \
+                   .run(optimized_model.graph)
+        torch.testing.assert_allclose(initial_result, optimized_model(input_data), rtol=1e-2, atol=1e-3)
+
+        blacklist = {MobileOptimizerType.CHANNELS_LAST_PREPACKED_OPS}
+        optimized_model_no_channels_last = optimize_for_mobile(scripted_model, blacklist)
+        FileCheck().check_not("prepacked::to_channels_last_padded") \
+                   .run(optimized_model_no_channels_last.graph)
+        torch.testing.assert_allclose(
+            initial_result, optimized_model_no_channels_last(input_data), rtol=1e-2, atol=1e-3)
+
     def test_generate_mobile_module_lints(self):
         class MyTestModule(torch.nn.Module):
             def __init__(self):
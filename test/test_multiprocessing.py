@@ -150,6 +150,14 @@ def mixed_type_producer(queue, event):
         event.wait()
         event.clear()
 
+def send_arena_tensors(queue, event):
+    arena = mp.SharedMemoryArena(segment_size=4096)
+    small = [arena.share_(torch.full([3], float(i))) for i in range(4)]
+    large = arena.share_(torch.ones(1024))
+    queue.put((small, large))
+    event.wait()
+
+
 def simple_autograd_function(a=1):
     torch.rand(3).requires_grad_(True).mean().backward()
     return a ** 2
@@ -829,6 +837,57 @@ if __name__ == "__main__":
         with fs_sharing():
             self._test_is_shared()
 
+    def _test_arena_sharing(self):
+        with leak_checker(self) as lc:
+            arena = mp.SharedMemoryArena(segment_size=4096)
+            t = arena.empty([2, 3], torch.double)
+            self.assertTrue(t.is_shared())
+            self.assertEqual(t.size(), torch.Size([2, 3]))
+            self.assertEqual(t.data_ptr() % 64, 0)
+            u = arena.empty([5], torch.double)
+            self.assertEqual(u.storage().data_ptr(), t.storage().data_ptr())
+            self.assertEqual(u.data_ptr() % 64, 0)
+            # The last one doesn't fit in the rest of the segment
+            v = [arena.empty([100], torch.double) for _ in range(5)]
+            for x in v[:4]:
+                self.assertEqual(x.storage().data_ptr(), t.storage().data_ptr())
+            self.assertNotEqual(v[4].storage().data_ptr(), t.storage().data_ptr())
+            # Larger than a quarter of a segment
+            w = arena.empty([200], torch.double)
+            self.assertEqual(w.storage().size(), 200)
+            x = torch.randn(3, 4)
+            y = arena.share_(x.t())
+            self.assertTrue(y.is_shared())
+            self.assertEqual(y, x.t(), atol=0, rtol=0)
+            self.assertIs(arena.share_(y), y)
+            arena.close()
+            del arena, t, u, v, w, y
+
+            q = mp.Queue()
+            e = mp.Event()
+            p = mp.Process(target=send_arena_tensors, args=(q, e))
+            p.daemon = True
+            p.start()
+            lc.check_pid(p.pid)
+            small, large = q.get()
+            for i, t in enumerate(small):
+                self.assertEqual(t, torch.full([3], float(i)), atol=0, rtol=0)
+                self.assertEqual(t.storage()._cdata, small[0].storage()._cdata)
+            self.assertEqual(large, torch.ones(1024), atol=0, rtol=0)
+            self.assertNotEqual(large.storage()._cdata, small[0].storage()._cdata)
+            del small, large
+            e.set()
+            p.join(10)
+            self.assertFalse(p.is_alive())
+
+    @unittest.skipIf(platform == 'darwin', "file descriptor strategy is not supported on macOS")
+    def test_arena_sharing(self):
+        self._test_arena_sharing()
+
+    def test_fs_arena_sharing(self):
+        with fs_sharing():
+            self._test_arena_sharing()
+
     @unittest.skipIf(not torch.cuda.is_available(), 'CUDA not available')
     def test_is_shared_cuda(self):
         t = torch.randn(5, 5).cuda()
@@ -44,7 +44,7 @@ from torch.testing._internal.common_nn import NNTestCase, NewModuleTest, NewCrit
 from torch.testing._internal.common_device_type import instantiate_device_type_tests, dtypes, \
     dtypesIfCUDA, skipCUDAIfNoCudnn, skipCUDAIfCudnnVersionLessThan, onlyCUDA, \
     skipCUDAIfRocm, skipCUDAIf, skipCUDAIfNotRocm, largeCUDATensorTest, onlyOnCPUAndCUDA, \
-    deviceCountAtLeast
+    deviceCountAtLeast, onlyCPU
 from torch.nn import MultiheadAttention
 
 from hypothesis import given
@@ -595,6 +595,12 @@ class TestNN(NNTestCase):
         self.assertEqual(module.weight.grad.data, module.weight.data.clone().zero_())
         self.assertEqual(module.bias.grad.data, module.bias.data.clone().zero_())
 
+        module.zero_grad(set_to_none=True)
+        self.assertIsNone(module.weight.grad)
+        self.assertIsNone(module.bias.grad)
+        module(i).sum().backward()
+        self.assertEqual(module.bias.grad, torch.full((5,), 2.))
+
     def test_no_grad(self):
         for dtype in [torch.bfloat16, torch.float, torch.double]:
             module = nn.Conv2d(2, 5, kernel_size=3, padding=1).to(dtype)
@@ -3869,6 +3875,24 @@ class TestNN(NNTestCase):
             bias=True).cuda()
         result = m(x)
 
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN or TEST_WITH_ROCM, 'CUDNN not available')
+    def test_cudnn_benchmark_cache_save_load(self):
+        x = torch.randn(2, 3, 17, 19, device='cuda', requires_grad=True)
+        # A shape no other test uses, so that it is cached by this one
+        m = nn.Conv2d(3, 5, kernel_size=(3, 4), padding=(1, 2)).cuda()
+        with torch.backends.cudnn.flags(enabled=True, benchmark=True):
+            m(x).sum().backward()
+
+        f = io.BytesIO()
+        torch.backends.cudnn.save_benchmark_cache(f)
+        f.seek(0)
+        # Everything in the cache is already selected in this process
+        self.assertEqual(torch.backends.cudnn.load_benchmark_cache(f), 0)
+
+        with self.assertRaisesRegex(RuntimeError, "cuDNN benchmark cache"):
+            torch.backends.cudnn.load_benchmark_cache(io.BytesIO(b"not a cache"))
+
     @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
     @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
     def test_Conv2d_inconsistent_types_on_GPU_with_cudnn(self):
@@ -4383,6 +4407,41 @@ class TestNN(NNTestCase):
         self.assertAlmostEqual(g1, g2, delta=1e-4)
         self.assertTrue((g1 == g1).all().item())  # check that we don't have NaN
 
+    def test_CTCLoss_cpu_reference(self):
+        # Lengths that differ across the batch, so that the elements are split
+        # unevenly across threads, and that leave vector tails in the rows of
+        # alpha and beta. The small vocabulary gives repeated labels, which
+        # disable the skip transitions.
+        input_lengths = [31, 7, 50, 50, 19, 1, 40, 23]
+        target_lengths = [9, 3, 20, 1, 8, 1, 16, 11]
+        vocab_size = 5
+        blank = 2
+        for dtype in [torch.float, torch.double]:
+            tol = dict(atol=1e-4, rtol=1e-4) if dtype == torch.float else {}
+            for padded in [False, True]:
+                targets = torch.randint(0, vocab_size - 1, (sum(target_lengths),))
+                targets[targets >= blank] += 1
+                if padded:
+                    targets_arg = torch.zeros(len(target_lengths), max(target_lengths), dtype=torch.long)
+                    offset = 0
+                    for i, length in enumerate(target_lengths):
+                        targets_arg[i, :length] = targets[offset:offset + length]
+                        offset += length
+                else:
+                    targets_arg = targets
+                x = torch.randn(max(input_lengths), len(input_lengths), vocab_size,
+                                dtype=dtype, requires_grad=True)
+                res = torch.nn.functional.ctc_loss(x.log_softmax(2), targets_arg, input_lengths,
+                                                   target_lengths, blank=blank, reduction='none')
+                expected = ctcloss_reference(x.log_softmax(2), targets_arg, input_lengths,
+                                             target_lengths, blank=blank, reduction='none')
+                self.assertEqual(res, expected, **tol)
+
+                grad_out = torch.rand_like(res)
+                grad, = torch.autograd.grad(res, x, grad_out)
+                expected_grad, = torch.autograd.grad(expected, x, grad_out)
+                self.assertEqual(grad, expected_grad, **tol)
+
     def test_RNN_cell_no_broadcasting(self):
         def test(cell_module, input, hx, input_size, hidden_size):
             cell = cell_module(input_size, hidden_size)
@@ -5119,6 +5178,23 @@ class TestNN(NNTestCase):
             weight_data[:] = 4
             self.assertEqual(weight_data, all_vars[4].data)
 
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    @skipIfRocm
+    def test_cudnn_weight_format_load_state_dict(self):
+        # load_state_dict copies into the parameters, which stay views of
+        # the flat weight buffer.
+        for num_layers, bidirectional in [(1, False), (2, True)]:
+            rnn = nn.LSTM(10, 20, num_layers, bidirectional=bidirectional).cuda()
+            other = nn.LSTM(10, 20, num_layers, bidirectional=bidirectional).cuda()
+            input = torch.randn(5, 4, 10, device="cuda")
+            rnn.load_state_dict(other.state_dict())
+            for _ in range(2):
+                with warnings.catch_warnings(record=True) as w:
+                    warnings.simplefilter("always")
+                    output, _ = rnn(input)
+                self.assertEqual(len(w), 0)
+                self.assertEqual(output, other(input)[0])
+
     @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
     def test_cudnn_weight_tying(self):
         rnns = [
@@ -5151,6 +5227,25 @@ class TestNN(NNTestCase):
             output_cpu = rnn(input.cpu(), hx)
             self.assertEqual(output_cuda, output_cpu)
 
+    def test_rnn_packed_sequence_fused_cpu(self):
+        # Without gradients, CPU LSTMs and GRUs run packed sequences with fused
+        # kernels, compare with the unfused path that runs with gradients.
+        lengths = [7, 7, 5, 2, 1]
+        inputs = [torch.randn(length, 10) for length in lengths]
+        packed = rnn_utils.pack_sequence(inputs)
+        for module in (nn.LSTM, nn.GRU):
+            for bias, bidirectional in product((True, False), (True, False)):
+                rnn = module(10, 20, num_layers=2, bias=bias, bidirectional=bidirectional)
+                num_directions = 2 if bidirectional else 1
+                hx = torch.randn(2 * num_directions, len(lengths), 20)
+                hx = (hx, torch.randn_like(hx)) if module is nn.LSTM else hx
+                expected_output, expected_hy = rnn(packed, hx)
+                with torch.no_grad():
+                    output, hy = rnn(packed, hx)
+                self.assertEqual(expected_output.data, output.data)
+                self.assertEqual(expected_output.batch_sizes, output.batch_sizes)
+                self.assertEqual(expected_hy, hy)
+
     @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
     @repeat_test_for_types(NO_HALF_TENSORTYPES)
     def test_cuda_rnn_fused(self, dtype=torch.float):
@@ -7563,6 +7658,19 @@ class TestNN(NNTestCase):
                     input = torch.randn(2, 2, 2, 2, requires_grad=True)
                     gradcheck(lambda x: F.interpolate(x, out_size, **kwargs), [input])
 
+    def test_upsamplingBilinear2d_channels_last_batch_1(self):
+        # the channels last kernel is vectorized over the channels, with a
+        # scalar tail, and parallelized over the output positions
+        for align_corners in [True, False]:
+            for channels in [3, 17]:
+                for size in [(5, 7), (29, 31)]:
+                    input = torch.randn(1, channels, 11, 13)
+                    out_cf = F.interpolate(input, size=size, mode='bilinear', align_corners=align_corners)
+                    out_cl = F.interpolate(input.contiguous(memory_format=torch.channels_last), size=size,
+                                           mode='bilinear', align_corners=align_corners)
+                    self.assertTrue(out_cl.is_contiguous(memory_format=torch.channels_last))
+                    self.assertEqual(out_cf, out_cl)
+
     def test_upsamplingBilinear2d_spatial_invariance(self):
         m = nn.Upsample(scale_factor=3, mode='bilinear', align_corners=False)
         in_t_9 = torch.zeros(1, 1, 9, 9)
@@ -9309,6 +9417,114 @@ class TestNNDeviceType(NNTestCase):
         input = torch.Tensor(num_features, b, d, w, h)
         self._test_dropout(nn.Dropout3d, device, input)
 
+    @dtypes(torch.float, torch.double)
+    def test_masked_softmax_dropout(self, device, dtype):
+        # Without dropout, the result is that of masked_fill and softmax. The
+        # sizes cover the warp and block CUDA kernels, with and without
+        # vectorized rows, and masks broadcast along different dims.
+        for size, mask_size, dim in [((2, 3, 8, 8), (2, 1, 1, 8), -1),
+                                     ((2, 3, 7, 7), (7, 7), -1),
+                                     ((2, 3, 5, 9), (2, 3, 5, 9), 1),
+                                     ((4, 1500), (1, 1500), -1),
+                                     ((3, 4099), None, -1)]:
+            x = torch.randn(size, device=device, dtype=dtype, requires_grad=True)
+            mask = None
+            if mask_size is not None:
+                mask = torch.rand(mask_size, device=device) < 0.3
+            out, softmax, _ = torch._masked_softmax_dropout(x, mask, dim, 0.)
+            x_ref = x.detach().clone().requires_grad_()
+            masked = x_ref if mask is None else x_ref.masked_fill(mask, float('-inf'))
+            expected = torch.softmax(masked, dim)
+            self.assertEqual(out, expected)
+            self.assertEqual(softmax, expected)
+            grad = torch.randn_like(out)
+            out.backward(grad)
+            expected.backward(grad)
+            self.assertEqual(x.grad, x_ref.grad)
+
+        # With dropout, elements are zeroed or scaled by 1 / (1 - p), and the
+        # backward draws the same mask again.
+        p = 0.3
+        x = torch.randn(64, 256, device=device, dtype=dtype, requires_grad=True)
+        out, softmax, _ = torch._masked_softmax_dropout(x, None, -1, p)
+        keep = out != 0
+        self.assertEqual(out[keep], softmax[keep] / (1 - p))
+        self.assertEqual(1 - keep.to(dtype).mean().item(), p, atol=0.02, rtol=0)
+        grad = torch.randn_like(out)
+        out.backward(grad)
+        x_ref = x.detach().clone().requires_grad_()
+        expected = torch.softmax(x_ref, -1) * keep.to(dtype) / (1 - p)
+        expected.backward(grad)
+        self.assertEqual(x.grad, x_ref.grad)
+
+        # The same seed draws the same mask.
+        torch.manual_seed(0)
+        out1 = torch._masked_softmax_dropout(x, None, -1, p)[0]
+        torch.manual_seed(0)
+        out2 = torch._masked_softmax_dropout(x, None, -1, p)[0]
+        self.assertEqual(out1, out2)
+
+        if dtype == torch.double:
+            def fn(input):
+                torch.manual_seed(0)
+                return torch._masked_softmax_dropout(input, None, -1, p)[0]
+            gradcheck(fn, (torch.randn(3, 10, device=device, dtype=dtype, requires_grad=True),))
+
+    @onlyCUDA
+    @dtypes(torch.half, torch.bfloat16)
+    def test_masked_softmax_dropout_reduced_precision(self, device, dtype):
+        x = torch.randn(2, 4, 64, 64, device=device, dtype=dtype)
+        mask = torch.rand(2, 1, 1, 64, device=device) < 0.3
+        out, softmax, _ = torch._masked_softmax_dropout(x, mask, -1, 0.)
+        expected = torch.softmax(x.float().masked_fill(mask, float('-inf')), -1)
+        self.assertEqual(out.float(), expected, atol=1e-2, rtol=1e-2)
+        self.assertEqual(softmax.float(), expected, atol=1e-2, rtol=1e-2)
+
+    @dtypes(torch.float, torch.double)
+    def test_fused_cross_entropy(self, device, dtype):
+        def reference(x, target, weight, reduction, label_smoothing):
+            logp = torch.log_softmax(x, 1)
+            w = torch.ones(x.size(1), device=device, dtype=dtype) if weight is None else weight
+            valid = target != -100
+            nll = F.nll_loss(logp, target, weight, reduction='none')
+            smooth = -(logp * w).sum(1) / x.size(1) * valid
+            loss = (1 - label_smoothing) * nll + label_smoothing * smooth
+            if reduction == 'none':
+                return loss
+            if reduction == 'sum':
+                return loss.sum()
+            return loss.sum() / (w[target.masked_fill(~valid, 0)] * valid).sum()
+
+        x = torch.randn(7, 11, device=device, dtype=dtype)
+        target = torch.randint(11, (7,), device=device)
+        target[2] = -100
+        weight = torch.rand(11, device=device, dtype=dtype)
+        reductions = {'none': 0, 'mean': 1, 'sum': 2}
+        for reduction, w, label_smoothing in product(reductions, [None, weight], [0., 0.1]):
+            x1 = x.clone().requires_grad_()
+            x2 = x.clone().requires_grad_()
+            expected = reference(x1, target, w, reduction, label_smoothing)
+            out = torch._fused_cross_entropy(x2, target, w, reductions[reduction], -100, label_smoothing)[0]
+            self.assertEqual(out, expected)
+            grad = torch.randn_like(out)
+            expected.backward(grad)
+            out.backward(grad)
+            self.assertEqual(x2.grad, x1.grad)
+            self.assertEqual(x2.grad[2], torch.zeros_like(x2.grad[2]))
+
+        self.assertEqual(F.cross_entropy(x, target, weight), F.nll_loss(torch.log_softmax(x, 1), target, weight))
+
+        if dtype == torch.double:
+            for reduction in reductions.values():
+                def fn(x):
+                    return torch._fused_cross_entropy(x, target, weight, reduction, -100, 0.1)[0]
+                x1 = x.clone().requires_grad_()
+                self.assertTrue(gradcheck(fn, (x1,)))
+                self.assertTrue(gradgradcheck(fn, (x1,)))
+
+        with self.assertRaisesRegex(RuntimeError, "expected self of size"):
+            torch._fused_cross_entropy(x.view(7, 11, 1), target)
+
     def test_InstanceNorm1d_general(self, device):
         b = random.randint(3, 5)
         c = random.randint(3, 5)
@@ -9353,10 +9569,8 @@ class TestNNDeviceType(NNTestCase):
     def test_LayerNorm_general(self, device):
         self._test_LayerNorm_general(device)
 
-        if self.device_type == 'cuda' and TEST_WITH_ROCM:
-            self._test_LayerNorm_general(device, dtype=torch.bfloat16)
-
         if self.device_type == 'cuda':
+            self._test_LayerNorm_general(device, dtype=torch.bfloat16)
             self._test_LayerNorm_cuda_half(device)
 
     def test_GroupNorm_general(self, device):
@@ -9365,6 +9579,51 @@ class TestNNDeviceType(NNTestCase):
         if self.device_type == 'cuda':
             self._test_GroupNorm_cuda_half()
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.half, torch.bfloat16)
+    def test_norm_cuda_vectorized_and_generic_paths(self, device, dtype):
+        # Sizes that take the vectorized and the generic kernels, including
+        # rows too long to be kept in registers and misaligned storage.
+        prec = 1e-4 if dtype == torch.float else 5e-2
+        for M, N, offset in [(5, 8, 0), (5, 7, 0), (3, 4 * 1024 + 4, 0),
+                             (2, 32 * 1024, 0), (1000, 64, 0), (4, 64, 1)]:
+            buf = torch.randn(M * N + offset, device=device, dtype=dtype)
+            x = buf[offset:].view(M, N).requires_grad_()
+            ln = nn.LayerNorm(N).to(device, dtype)
+            ln.weight.data.uniform_()
+            ln.bias.data.uniform_()
+            ln_ref = nn.LayerNorm(N).to(device, torch.double)
+            ln_ref.load_state_dict(ln.state_dict())
+            x_ref = x.detach().double().requires_grad_()
+            grad = torch.randn(M, N, device=device, dtype=dtype)
+            out = ln(x)
+            out.backward(grad)
+            out_ref = ln_ref(x_ref)
+            out_ref.backward(grad.double())
+            self.assertEqual(out.double(), out_ref, atol=prec, rtol=prec)
+            self.assertEqual(x.grad.double(), x_ref.grad, atol=prec, rtol=prec)
+            self.assertEqual(ln.weight.grad.double(), ln_ref.weight.grad,
+                             atol=prec * M, rtol=prec)
+            self.assertEqual(ln.bias.grad.double(), ln_ref.bias.grad,
+                             atol=prec * M, rtol=prec)
+
+        for shape, groups in [((2, 6, 4, 4), 3), ((2, 6, 3, 3), 2),
+                              ((3, 4, 65, 64), 2)]:
+            x = torch.randn(shape, device=device, dtype=dtype).requires_grad_()
+            gn = nn.GroupNorm(groups, shape[1]).to(device, dtype)
+            gn.weight.data.uniform_()
+            gn.bias.data.uniform_()
+            gn_ref = nn.GroupNorm(groups, shape[1]).to(device, torch.double)
+            gn_ref.load_state_dict(gn.state_dict())
+            x_ref = x.detach().double().requires_grad_()
+            grad = torch.randn(shape, device=device, dtype=dtype)
+            out = gn(x)
+            out.backward(grad)
+            out_ref = gn_ref(x_ref)
+            out_ref.backward(grad.double())
+            self.assertEqual(out.double(), out_ref, atol=prec, rtol=prec)
+            self.assertEqual(x.grad.double(), x_ref.grad, atol=prec, rtol=prec)
+
     def test_GroupNorm_raises_error_if_one_value_per_group(self, device):
         x = torch.rand(10)[None, :, None]
         with self.assertRaises(ValueError):
@@ -9615,7 +9874,8 @@ class TestNNDeviceType(NNTestCase):
         helper(1, 100000, 32, 32, ks=4)
         helper(1, 100000, 1, 4, ks=(1, 4))  # test for max_pool1d
 
-    @onlyCUDA
+    @onlyOnCPUAndCUDA
+    @dtypes(torch.float, torch.double)
     @dtypesIfCUDA(torch.half, torch.float, torch.double)
     def test_max_pool2d_nhwc(self, device, dtype):
         def helper(n, c, h, w, kernel_size, stride=None):
@@ -9647,6 +9907,46 @@ class TestNNDeviceType(NNTestCase):
         helper(10, 512, 31, 31, 3, stride=2)
         helper(1, 129, 8, 8, 3, stride=2)
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_channels_last_cpu_kernels(self, device, dtype):
+        def helper(module, n, c, h, w, grad_size=None):
+            input = torch.randn(n, c, h, w, dtype=dtype, device=device)
+            input = input.contiguous(memory_format=torch.channels_last).requires_grad_()
+            ref_input = input.detach().clone().contiguous().requires_grad_()
+            ref_module = deepcopy(module)
+            module = module.to(memory_format=torch.channels_last)
+
+            out = module(input)
+            ref_out = ref_module(ref_input)
+            grad = torch.randn_like(ref_out)
+            out.backward(grad.contiguous(memory_format=torch.channels_last))
+            ref_out.backward(grad)
+
+            self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+            self.assertTrue(input.grad.is_contiguous(memory_format=torch.channels_last))
+            self.assertEqual(out, ref_out)
+            self.assertEqual(input.grad, ref_input.grad)
+            for p, ref_p in zip(module.parameters(), ref_module.parameters()):
+                self.assertEqual(p.grad, ref_p.grad)
+            for b, ref_b in zip(module.buffers(), ref_module.buffers()):
+                self.assertEqual(b, ref_b)
+
+        for c in [3, 8, 37]:
+            helper(nn.AdaptiveAvgPool2d((3, 5)), 4, c, 11, 13)
+            helper(nn.AdaptiveAvgPool2d((7, 7)), 2, c, 7, 7)
+            # mkldnn convolutions return contiguous outputs
+            with torch.backends.mkldnn.flags(enabled=False):
+                helper(nn.Conv2d(c, 16, 3, padding=1).to(dtype), 2, c, 9, 10)
+                helper(nn.Conv2d(c, 5, (2, 3), stride=2).to(dtype), 2, c, 9, 10)
+                helper(nn.Conv2d(c, 6, 1).to(dtype), 2, c, 5, 5)
+            helper(nn.BatchNorm2d(c).to(dtype), 4, c, 6, 7)
+            helper(nn.BatchNorm2d(c).to(dtype).eval(), 4, c, 6, 7)
+            helper(nn.Upsample(scale_factor=2, mode='nearest'), 2, c, 5, 6)
+            helper(nn.Upsample(size=(7, 13), mode='nearest'), 2, c, 5, 6)
+            helper(nn.Upsample(scale_factor=2, mode='bilinear', align_corners=False), 2, c, 5, 6)
+            helper(nn.Upsample(size=(7, 13), mode='bilinear', align_corners=True), 2, c, 5, 6)
+
     @onlyCUDA
     def test_max_pool2d_indices(self, device):
         def helper(n, c, h, w, ks):
@@ -9854,6 +10154,26 @@ class TestNNDeviceType(NNTestCase):
                 y = getattr(F, 'conv_transpose{}d'.format(dim))(x, w, groups=groups)
                 y.sum().backward()
 
+    @onlyCPU
+    def test_conv_cpu_inference_algorithms(self, device):
+        # Without gradients nor MKLDNN, 3x3 convolutions of NCHW tensors go
+        # through Winograd and convolutions of channels last tensors through
+        # the direct kernel, when they are cheaper than im2col.
+        def helper(n, c, h, w, k, memory_format, **kwargs):
+            x = torch.randn(n, c, h, w, device=device).contiguous(memory_format=memory_format)
+            conv = nn.Conv2d(c, k, **kwargs).to(device)
+            with torch.no_grad(), torch.backends.mkldnn.flags(enabled=False):
+                out = conv(x)
+                ref_out = F.conv2d(x.double(), conv.weight.double(), conv.bias.double(),
+                                   conv.stride, conv.padding, conv.dilation)
+            self.assertEqual(out, ref_out, atol=1e-4, rtol=1e-4, exact_dtype=False)
+
+        for c in [3, 16, 37]:
+            helper(2, c, 9, 10, 24, torch.contiguous_format, kernel_size=3, padding=1)
+            helper(1, c, 13, 7, 40, torch.contiguous_format, kernel_size=3)
+            helper(2, c, 9, 10, 5, torch.channels_last, kernel_size=3, padding=1)
+            helper(2, c, 9, 10, 19, torch.channels_last, kernel_size=(2, 3), stride=2, dilation=(1, 2))
+
     def test_conv_noncontig_weights_and_bias(self, device):
         # need floats to exercise https://github.com/pytorch/pytorch/issues/16018
         for bias in [True, False]:
@@ -10644,6 +10964,69 @@ class TestNNDeviceType(NNTestCase):
         self._test_EmbeddingBag(device, 'mean', True, dtype, test_backward=test_backward)
 
 
+    @dtypes(torch.float, torch.double)
+    def test_embedding_bag_variable_bags(self, device, dtype):
+        # Bags of random sizes, some empty, and enough of them for the CPU
+        # kernels to split the bags and the rows of the gradient across threads
+        for dim in (3, 16, 37):
+            self._test_embedding_bag_variable_bags(device, dtype, dim)
+
+    def _test_embedding_bag_variable_bags(self, device, dtype, dim):
+        # Dims below the warp size share warps between bags on CUDA
+        num_weights, num_bags = 50, 300
+        lengths = torch.randint(0, 9, (num_bags,))
+        lengths[::7] = 0
+        offsets = torch.cat((lengths.new_zeros(1), lengths.cumsum(0)[:-1])).to(device)
+        input = torch.randint(num_weights, (int(lengths.sum()),), device=device)
+        bounds = offsets.tolist() + [input.numel()]
+        counts = torch.bincount(input, minlength=num_weights).clamp(min=1)
+
+        for mode, contiguous, per_sample, scale_grad_by_freq in itertools.product(
+                ('sum', 'mean', 'max'), (True, False), (True, False), (True, False)):
+            if mode != 'sum' and per_sample:
+                continue
+            if mode == 'max' and scale_grad_by_freq:
+                continue
+            # Weights with strided rows go through the generic kernels
+            if contiguous:
+                weight = torch.randn(num_weights, dim, device=device, dtype=dtype)
+            else:
+                weight = torch.randn(dim, num_weights, device=device, dtype=dtype).t()
+            weight.requires_grad_()
+            ref_weight = weight.detach().clone().requires_grad_()
+            per_sample_weights = None
+            if per_sample:
+                per_sample_weights = torch.rand(input.numel(), device=device, dtype=dtype)
+
+            output = F.embedding_bag(input, weight, offsets, mode=mode,
+                                     scale_grad_by_freq=scale_grad_by_freq,
+                                     per_sample_weights=per_sample_weights)
+            bags = []
+            for begin, end in zip(bounds[:-1], bounds[1:]):
+                if begin == end:
+                    bags.append(ref_weight.new_zeros(dim))
+                    continue
+                embeddings = ref_weight.index_select(0, input[begin:end])
+                if per_sample:
+                    embeddings = embeddings * per_sample_weights[begin:end].unsqueeze(1)
+                if mode == 'sum':
+                    bags.append(embeddings.sum(0))
+                elif mode == 'mean':
+                    bags.append(embeddings.mean(0))
+                else:
+                    bags.append(embeddings.max(0)[0])
+            expected = torch.stack(bags)
+            self.assertEqual(output, expected, atol=dtype2prec_DONTUSE[dtype], rtol=0)
+
+            grad = torch.randn_like(expected)
+            output.backward(grad)
+            expected.backward(grad)
+            expected_grad = ref_weight.grad
+            if scale_grad_by_freq:
+                expected_grad = expected_grad / counts.unsqueeze(1).to(dtype)
+            self.assertEqual(weight.grad, expected_grad,
+                             atol=dtype2prec_DONTUSE[dtype] * 3, rtol=0)
+
     @onlyCUDA
     @skipCUDAIfNotRocm
     def test_embedding_bag_bfloat16(self, device):
@@ -10787,6 +11170,32 @@ class TestNNDeviceType(NNTestCase):
             with torch.backends.cudnn.flags(enabled=False):
                 self._test_batchnorm_eval(device)
 
+    @dtypes(torch.float, torch.double)
+    def test_batch_norm_relu(self, device, dtype):
+        def helper(shape, memory_format, affine):
+            c = shape[1]
+            x = torch.randn(shape, dtype=dtype, device=device).contiguous(memory_format=memory_format)
+            mean = torch.randn(c, dtype=dtype, device=device)
+            var = torch.rand(c, dtype=dtype, device=device) + 0.5
+            weight = torch.randn(c, dtype=dtype, device=device) if affine else None
+            bias = torch.randn(c, dtype=dtype, device=device) if affine else None
+            out = torch._batch_norm_relu(x, weight, bias, mean, var, 1e-5)
+            ref_out = F.relu(F.batch_norm(x, mean, var, weight, bias, eps=1e-5))
+            self.assertEqual(out, ref_out)
+
+            # Falls back to batch_norm and relu for gradients
+            x.requires_grad_()
+            ref_x = x.detach().clone().requires_grad_()
+            torch._batch_norm_relu(x, weight, bias, mean, var, 1e-5).sum().backward()
+            F.relu(F.batch_norm(ref_x, mean, var, weight, bias, eps=1e-5)).sum().backward()
+            self.assertEqual(x.grad, ref_x.grad)
+
+        for affine in [True, False]:
+            helper((4, 3), torch.contiguous_format, affine)
+            helper((2, 19, 5, 7), torch.contiguous_format, affine)
+            helper((2, 19, 5, 7), torch.channels_last, affine)
+            helper((2, 5, 3, 4, 2), torch.contiguous_format, affine)
+
     @onlyCUDA
     @skipCUDAIfNotRocm
     def test_batchnorm_eval_bfloat16(self, device):
@@ -11308,6 +11717,40 @@ class TestNNDeviceType(NNTestCase):
         o.sum().backward()
 
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.double, torch.half)
+    def test_conv_depthwise_channels_last(self, device, dtype):
+        # With cuDNN disabled, channels-last depthwise convolutions use the
+        # channels-last kernels of thnn_conv_depthwise2d.
+        configs = [
+            # channels, multiplier, kernel_size, stride, padding, dilation
+            (8, 1, 3, 1, 1, 1),
+            (8, 1, 3, 2, 1, 1),
+            (6, 2, 3, 1, 2, 2),
+            (5, 1, (3, 5), (2, 1), (1, 2), 1),
+            (16, 1, 1, 1, 0, 1),
+        ]
+        for c, m, kernel_size, stride, padding, dilation in configs:
+            ref_conv = nn.Conv2d(c, c * m, kernel_size, stride, padding, dilation, groups=c).to(device, torch.double)
+            conv = nn.Conv2d(c, c * m, kernel_size, stride, padding, dilation, groups=c).to(device, dtype)
+            conv.load_state_dict(ref_conv.state_dict())
+            ref_input = torch.randn(3, c, 11, 13, dtype=torch.double, device=device, requires_grad=True)
+            input = ref_input.detach().to(dtype).contiguous(memory_format=torch.channels_last).requires_grad_()
+
+            with torch.backends.cudnn.flags(enabled=False):
+                out = conv(input)
+                ref_out = ref_conv(ref_input)
+                grad = torch.randn_like(ref_out)
+                out.backward(grad.to(dtype))
+                ref_out.backward(grad)
+
+            self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+            atol, rtol = (1e-2, 1e-2) if dtype == torch.half else (1e-5, 1e-5)
+            self.assertEqual(out, ref_out, atol=atol, rtol=rtol, exact_dtype=False)
+            self.assertEqual(input.grad, ref_input.grad, atol=atol, rtol=rtol, exact_dtype=False)
+            self.assertEqual(conv.weight.grad, ref_conv.weight.grad, atol=atol * 10, rtol=rtol, exact_dtype=False)
+            self.assertEqual(conv.bias.grad, ref_conv.bias.grad, atol=atol * 10, rtol=rtol, exact_dtype=False)
+
     @onlyCUDA
     @skipCUDAIfRocm
     @skipCUDAIfCudnnVersionLessThan(7603)
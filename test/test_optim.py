@@ -416,6 +416,53 @@ class TestOptim(TestCase):
              lambda opt: ReduceLROnPlateau(opt, threshold=1e-4)]
         )
 
+    def _sparse_embedding_grad(self, num_rows, dim, num_indices):
+        # Gradient of embedding_bag with sparse=True, with repeated indices
+        weight = torch.randn(num_rows, dim, requires_grad=True)
+        indices = torch.randint(num_rows, (num_indices,))
+        offsets = torch.arange(0, num_indices, 3)
+        F.embedding_bag(indices, weight, offsets, sparse=True).pow(2).sum().backward()
+        return weight.detach(), weight.grad
+
+    def test_fused_sparse_adagrad(self):
+        for num_rows, dim, num_indices in [(10, 5, 30), (100, 64, 1000), (7, 3, 0)]:
+            weight, grad = self._sparse_embedding_grad(num_rows, dim, num_indices)
+            param = weight.clone().requires_grad_()
+            param.grad = grad
+            opt = optim.Adagrad([param], lr=0.1)
+            fused_param = weight.clone()
+            state_sum = torch.zeros_like(weight)
+            for _ in range(3):
+                opt.step()
+                torch._fused_sparse_adagrad_(
+                    fused_param, state_sum, grad._indices()[0], grad._values(), 0.1)
+            self.assertEqual(fused_param, param.detach())
+            self.assertEqual(state_sum, opt.state[param]['sum'])
+
+        weight, grad = self._sparse_embedding_grad(10, 5, 30)
+        with self.assertRaisesRegex(RuntimeError, "index out of range"):
+            torch._fused_sparse_adagrad_(
+                weight[:5].clone(), torch.zeros(5, 5), grad._indices()[0],
+                grad._values(), 0.1)
+
+    def test_fused_sparse_adam(self):
+        for num_rows, dim, num_indices in [(10, 5, 30), (100, 64, 1000)]:
+            weight, grad = self._sparse_embedding_grad(num_rows, dim, num_indices)
+            param = weight.clone().requires_grad_()
+            param.grad = grad
+            opt = optim.SparseAdam([param], lr=0.01)
+            fused_param = weight.clone()
+            exp_avg = torch.zeros_like(weight)
+            exp_avg_sq = torch.zeros_like(weight)
+            for step in range(1, 4):
+                opt.step()
+                torch._fused_sparse_adam_(
+                    fused_param, exp_avg, exp_avg_sq, grad._indices()[0],
+                    grad._values(), step, 0.01)
+            self.assertEqual(fused_param, param.detach())
+            self.assertEqual(exp_avg, opt.state[param]['exp_avg'])
+            self.assertEqual(exp_avg_sq, opt.state[param]['exp_avg_sq'])
+
     def test_adamax(self):
         self._test_basic_cases(
             lambda weight, bias: optim.Adamax([weight, bias], lr=1e-1)
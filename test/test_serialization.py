@@ -673,6 +673,74 @@ class TestSerialization(TestCase, SerializationMixin):
 
         test(io.BytesIO())
 
+    @unittest.skipIf(IS_WINDOWS, "NamedTemporaryFile on windows")
+    def test_save_async(self):
+        data = self._test_serialization_data()
+        big = torch.randn(10 * 1024 * 1024)  # CRC32 computed by several threads
+        expected = copy.deepcopy((data, big))
+
+        def test(name_or_buffer):
+            pending = torch.save_async((data, big), name_or_buffer)
+            # The storages were copied before save_async returned
+            big.add_(1)
+            pending.wait()
+            self.assertTrue(pending.done())
+            big.sub_(1)
+
+            if hasattr(name_or_buffer, 'seek'):
+                name_or_buffer.seek(0)
+
+            result = torch.load(name_or_buffer)
+            self.assertEqual(result, expected)
+
+        with tempfile.NamedTemporaryFile() as f:
+            test(f)
+        with tempfile.NamedTemporaryFile() as f:
+            test(f.name)
+
+        test(io.BytesIO())
+
+    @unittest.skipIf(not torch.cuda.is_available(), "no CUDA")
+    def test_save_async_cuda(self):
+        x = torch.randn(1000, 1000, device='cuda')
+        expected = x.clone()
+        buf = io.BytesIO()
+        pending = torch.save_async({'x': x}, buf)
+        x.zero_()
+        pending.wait()
+        buf.seek(0)
+        result = torch.load(buf)
+        self.assertEqual(result['x'].device, expected.device)
+        self.assertEqual(result['x'], expected)
+
+    def test_compress_storages(self):
+        data = {'sparse': torch.zeros(1000, 1000), 'dense': torch.randn(100)}
+        plain, compressed = io.BytesIO(), io.BytesIO()
+        torch.save(data, plain)
+        torch.save(data, compressed, compress_storages=True)
+        self.assertLess(len(compressed.getvalue()), len(plain.getvalue()) // 10)
+        compressed.seek(0)
+        self.assertEqual(torch.load(compressed), data)
+        compressed.seek(0)
+        self.assertEqual(torch.load(compressed, verify_crc=False), data)
+
+    def test_verify_crc(self):
+        buf = io.BytesIO()
+        torch.save(torch.full((1000,), 7, dtype=torch.uint8), buf)
+        value = bytearray(buf.getvalue())
+        offset = value.find(b'\x07' * 1000)
+        value[offset] = 8
+        with self.assertRaisesRegex(RuntimeError, "CRC"):
+            torch.load(io.BytesIO(bytes(value)))
+        result = torch.load(io.BytesIO(bytes(value)), verify_crc=False)
+        self.assertEqual(result[0].item(), 8)
+        self.assertEqual(result[1:], torch.full((999,), 7, dtype=torch.uint8))
+
+    def test_save_async_error(self):
+        pending = torch.save_async(torch.ones(2), os.path.join(tempfile.gettempdir(), 'nonexistent', 'dir', 'x.pt'))
+        with self.assertRaises(RuntimeError):
+            pending.wait()
+
     def run(self, *args, **kwargs):
         with serialization_method(use_zip=True):
             return super(TestSerialization, self).run(*args, **kwargs)
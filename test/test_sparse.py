@@ -1122,6 +1122,44 @@ class TestSparse(TestCase):
         test_shape(7, 8, 9, 20, False)
         test_shape(7, 8, 9, 20, True)
 
+    def test_sparse_addmm_cached_csr(self):
+        # The row pointers of a coalesced matrix are cached across products
+        # until its indices change, so a product after an in-place update of
+        # the indices must not reuse them.
+        i = self.index_tensor([[0, 1, 2, 2], [1, 0, 1, 2]])
+        v = self.value_tensor([1., 2., 3., 4.])
+        S = self.sparse_tensor(i, v, torch.Size([3, 3])).coalesce()
+        D = torch.randn(3, 5, device=self.device)
+        self.assertEqual(torch.sparse.mm(S, D), torch.mm(S.to_dense(), D))
+        self.assertEqual(torch.sparse.mm(S, D), torch.mm(S.to_dense(), D))
+        S._indices()[0].zero_()
+        self.assertEqual(torch.sparse.mm(S, D), torch.mm(S.to_dense(), D))
+
+        # Enough rows for the CPU kernel to split them across threads
+        S = self._gen_sparse(2, 3000, [1000, 300])[0]
+        D = torch.randn(300, 40, device=self.device)
+        T = torch.randn(1000, 40, device=self.device)
+        self.assertEqual(torch.addmm(T, S, D, beta=0.5, alpha=2),
+                         torch.addmm(T, S.to_dense(), D, beta=0.5, alpha=2))
+
+    def test_sparse_sampled_addmm(self):
+        def test_shape(m, n, p, nnz, beta, alpha):
+            S = self._gen_sparse(2, nnz, [m, p])[0]
+            D1 = torch.randn(m, n, device=self.device)
+            D2 = torch.randn(n, p, device=self.device)
+            res = torch.sparse.sampled_addmm(S, D1, D2, beta=beta, alpha=alpha)
+            self.assertEqual(res._indices(), S._indices())
+            self.assertEqual(res.is_coalesced(), S.is_coalesced())
+            # Each nonzero of S, duplicates included, samples the product
+            i = S._indices()
+            expected = beta * S._values() + alpha * torch.mm(D1, D2)[i[0], i[1]]
+            self.assertEqual(res._values(), expected)
+
+        test_shape(7, 8, 9, 20, 1, 1)
+        test_shape(7, 8, 9, 20, 0, 2)
+        test_shape(7, 0, 9, 20, 0.5, 1)
+        test_shape(300, 40, 200, 2000, 0.5, -1)
+
     def test_dsmm(self):
         def test_shape(di, dj, dk, nnz):
             x = self._gen_sparse(2, nnz, [di, dj])[0]
@@ -1720,6 +1758,26 @@ class TestSparse(TestCase):
 
         self.assertFalse(z._indices().numel() != 2 and z.is_coalesced())
 
+    def test_coalesce_add_large_nnz(self):
+        # Enough nonzeros for the CPU kernels to split coalesce and the merge
+        # of sparse + sparse across threads
+        for dense_shape in [[], [3]]:
+            i = torch.randint(0, 50, (2, 100000), device=self.device)
+            v = torch.randn([100000] + dense_shape, dtype=torch.double, device=self.device)
+            x = self.sparse_tensor(i, v, torch.Size([50, 50] + dense_shape))
+            y = self._gen_sparse(2, 20000, [50, 50] + dense_shape)[0]
+
+            xc = x.coalesce()
+            self.assertTrue(xc.is_coalesced())
+            self.assertEqual(xc._nnz(), torch.unique(i[0] * 50 + i[1]).numel())
+            self.assertEqual(xc.to_dense(), x.to_dense())
+
+            z = xc + y.coalesce() * 2
+            self.assertTrue(z.is_coalesced())
+            self.assertEqual(z.to_dense(), x.to_dense() + 2 * y.to_dense())
+            z = y.coalesce().add(xc, alpha=-1)
+            self.assertEqual(z.to_dense(), y.to_dense() - x.to_dense())
+
     @cuda_only
     def test_storage_not_null(self):
         x = torch.cuda.sparse.FloatTensor(2)
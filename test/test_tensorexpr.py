@@ -1260,5 +1260,35 @@ class TestTensorExprFuser(BaseTestClass):
         assert torch.allclose(scripted(a), 2 * a)
         assert cx.elapsed_value() == 1
 
+    def test_quantized_chain(self):
+        def test_dequant_add(x, y):
+            z = torch.relu(x.dequantize() + y.dequantize())
+            return torch.quantize_per_tensor(z, 0.1, 10, torch.quint8)
+
+        def test_quantized_add(x, y):
+            return torch.ops.quantized.add(x, y, 0.2, 3)
+
+        def test_hardswish(x, y):
+            return torch.ops.quantized.hardswish(torch.ops.quantized.mul(x, y, 0.3, 128), 0.05, 64)
+
+        fns = [test_dequant_add, test_quantized_add, test_hardswish]
+        for dtype in [torch.quint8, torch.qint8]:
+            a = torch.quantize_per_tensor(torch.randn(1027) * 4, 0.05, 2, dtype)
+            b = torch.quantize_per_tensor(torch.randn(1027) * 4, 0.04, 7, dtype)
+            for fn in fns:
+                if fn is test_hardswish and dtype == torch.qint8:
+                    continue
+                scripted = torch.jit.script(fn)
+                for _ in range(num_profiled_runs):
+                    scripted(a, b)
+                llvm = LLVMCodeGenExecuted()
+                interp = SimpleIREvalExecuted()
+                x = scripted(a, b)
+                y = fn(a, b)
+                # Rounding of the intermediate float values may differ by one
+                np.testing.assert_allclose(
+                    x.int_repr().numpy().astype(int), y.int_repr().numpy().astype(int), atol=1)
+                assert llvm.elapsed_value() == 1 or interp.elapsed_value() > 1
+
 if __name__ == '__main__':
     unittest.main()
@@ -3,6 +3,7 @@ from __future__ import absolute_import, division, print_function, unicode_litera
 import torch
 import tempfile
 from torch.utils import ThroughputBenchmark
+from torch.utils.throughput_benchmark import benchmark_mix
 from torch.testing import assert_allclose
 
 from torch.testing._internal.common_utils import run_tests, TestCase
@@ -80,6 +81,36 @@ class TestThroughputBenchmark(TestCase):
         with tempfile.NamedTemporaryFile(delete=False) as f:
             self.linear_test(TwoLayerNetModule, profiler_output_path=f.name)
 
+    def test_open_loop(self):
+        module = TwoLayerNet(10, 5, 15)
+        bench = ThroughputBenchmark(module)
+        bench.add_input(torch.randn(8, 10), torch.randn(8, 10))
+
+        stats = bench.benchmark(num_calling_threads=2, num_warmup_iters=10, num_iters=200, arrival_rate=2000, seed=1)
+        print(stats)
+        self.assertEqual(stats.num_iters, 200)
+        self.assertLessEqual(stats.latency_p50_ms, stats.latency_p99_ms)
+        self.assertLessEqual(stats.latency_p99_ms, stats.latency_max_ms)
+
+        # The run can't end before the last of the requests arrives
+        stats = bench.benchmark(num_calling_threads=2, arrival_times_ms=[0, 1, 2, 50])
+        self.assertEqual(stats.num_iters, 4)
+        self.assertGreaterEqual(stats.total_time_seconds, 0.05)
+
+        curve = bench.latency_curve([500, 1000], num_iters=50)
+        self.assertEqual(len(curve), 2)
+
+    def test_mix(self):
+        benches = [ThroughputBenchmark(TwoLayerNet(10, 5, 15)), ThroughputBenchmark(TwoLayerNetModule(10, 5, 15))]
+        for bench in benches:
+            bench.add_input(torch.randn(8, 10), torch.randn(8, 10))
+
+        total, per_model = benchmark_mix(benches, [3, 1], num_calling_threads=2, num_iters=200, arrival_rate=2000)
+        print(total)
+        self.assertEqual(total.num_iters, 200)
+        self.assertEqual(len(per_model), 2)
+        self.assertEqual(sum(stats.num_iters for stats in per_model), 200)
+
 
 if __name__ == '__main__':
     run_tests()
@@ -795,6 +795,38 @@ class AbstractTestCases:
             self.assertEqual(y[:, 0], range(100))
             self.assertEqual(y[:, 40], range(4000, 4100))
 
+        @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+        def test_copy_transpose_batched(self):
+            for dtype in (torch.uint8, torch.int16, torch.float, torch.double, torch.bfloat16):
+                x = torch.arange(2 * 3 * 37 * 45).reshape(2, 3, 37, 45).to(dtype)
+                # NCHW to NHWC and back
+                nhwc = x.permute(0, 2, 3, 1).contiguous()
+                expected = np.ascontiguousarray(x.double().numpy().transpose(0, 2, 3, 1))
+                self.assertEqual(nhwc.double(), torch.from_numpy(expected))
+                self.assertEqual(nhwc.permute(0, 3, 1, 2).contiguous(), x)
+                # Both directions through channels last, whose destination
+                # is a dense permutation rather than contiguous
+                cl = x.contiguous(memory_format=torch.channels_last)
+                self.assertTrue(cl.is_contiguous(memory_format=torch.channels_last))
+                self.assertEqual(cl, x)
+                self.assertEqual(cl.permute(0, 2, 3, 1).contiguous().double(), torch.from_numpy(expected))
+                self.assertEqual(cl.contiguous(), x)
+                out = torch.empty(2, 37, 45, 3, dtype=dtype).permute(0, 3, 1, 2)
+                self.assertEqual(out.copy_(x), x)
+                x3d = torch.arange(2 * 3 * 9 * 11 * 13).reshape(2, 3, 9, 11, 13).to(dtype)
+                self.assertEqual(x3d.contiguous(memory_format=torch.channels_last_3d), x3d)
+                # batch of transposes of a sliced tensor
+                y = x[:, :, 1:, 2:].transpose(2, 3)
+                expected = np.ascontiguousarray(x.double().numpy()[:, :, 1:, 2:].transpose(0, 1, 3, 2))
+                self.assertEqual(y.contiguous().double(), torch.from_numpy(expected))
+
+        def test_copy_cast_contiguous(self):
+            x = torch.arange(1000, dtype=torch.float).div_(7)
+            self.assertEqual(x.bfloat16().float(), torch.tensor([float(v) for v in x.bfloat16()]))
+            self.assertEqual(x.bfloat16().float(), x, atol=0.5, rtol=0.01)
+            y = torch.arange(256 * 4, dtype=torch.int64).remainder_(256).to(torch.uint8)
+            self.assertEqual(y.float().tolist(), [float(v) for v in y.tolist()])
+
         def test_device(self):
             cpu = torch.device('cpu')
             self.assertEqual('cpu', str(cpu))
@@ -2307,6 +2339,47 @@ class AbstractTestCases:
             self.assertEqual(x, y)
             torch.set_rng_state(rng_state)
 
+        def test_parallel_cpu_rng(self):
+            ops = [
+                lambda t: t.uniform_(-2, 3),
+                lambda t: t.normal_(1, 2),
+                lambda t: t.bernoulli_(0.3),
+            ]
+            prev_parallel_rng = torch._C._get_parallel_cpu_rng()
+            num_threads = torch.get_num_threads()
+            try:
+                torch._C._set_parallel_cpu_rng(True)
+                for op, dtype in product(ops, [torch.float, torch.double]):
+                    torch.manual_seed(5)
+                    x = op(torch.empty(10007, dtype=dtype))
+                    # same values regardless of the number of threads
+                    torch.set_num_threads(1)
+                    torch.manual_seed(5)
+                    self.assertEqual(x, op(torch.empty(10007, dtype=dtype)), atol=0, rtol=0)
+                    torch.set_num_threads(num_threads)
+                    # and of the memory layout
+                    torch.manual_seed(5)
+                    y = op(torch.empty(10007, 2, dtype=dtype)[:, 0])
+                    self.assertEqual(x, y, atol=0, rtol=0)
+                    # the generator state is saved and restored as before
+                    state = torch.get_rng_state()
+                    a = op(torch.empty(100, dtype=dtype))
+                    torch.set_rng_state(state)
+                    self.assertEqual(a, op(torch.empty(100, dtype=dtype)), atol=0, rtol=0)
+
+                x = torch.empty(100000, dtype=torch.double)
+                x.uniform_(-2, 3)
+                self.assertTrue(x.min() >= -2 and x.max() < 3)
+                self.assertEqual(x.mean().item(), 0.5, atol=0.05, rtol=0)
+                x.normal_(1, 2)
+                self.assertEqual(x.mean().item(), 1, atol=0.05, rtol=0)
+                self.assertEqual(x.std().item(), 2, atol=0.05, rtol=0)
+                x.bernoulli_(0.3)
+                self.assertEqual(x.mean().item(), 0.3, atol=0.01, rtol=0)
+            finally:
+                torch.set_num_threads(num_threads)
+                torch._C._set_parallel_cpu_rng(prev_parallel_rng)
+
         def test_numel(self):
             b = torch.ByteTensor(3, 100, 100)
             self.assertEqual(b.nelement(), 3 * 100 * 100)
@@ -2448,6 +2521,35 @@ class AbstractTestCases:
                         dest2[idx[i]] += src[i]
                     self.assertEqual(dest, dest2)
 
+        def test_index_add_repeated_indices(self):
+            # large enough to add the rows in parallel
+            for dtype in (torch.float, torch.double, torch.long):
+                num_dest, num_copy, row_size = 64, 2048, 64
+                dest = torch.randint(0, 10, (num_dest, row_size), dtype=dtype)
+                src = torch.randint(0, 10, (num_copy, row_size), dtype=dtype)
+                idx = torch.randint(0, num_dest, (num_copy,))
+                dest2 = dest.clone()
+                dest.index_add_(0, idx, src)
+                for i in range(num_copy):
+                    dest2[idx[i]] += src[i]
+                self.assertEqual(dest, dest2)
+                with self.assertRaises(IndexError):
+                    dest.index_add_(0, torch.tensor([0, num_dest]), src[:2])
+
+        def test_index_add_slice_sizes(self):
+            dest = torch.zeros(4, 64)
+            idx = torch.tensor([0, 2, 2])
+            # Slices that don't match still raise
+            with self.assertRaisesRegex(RuntimeError, "must match"):
+                dest.index_add_(0, idx, torch.ones(3, 32))
+            self.assertEqual(dest, torch.zeros(4, 64))
+            # and slices of size 1 are broadcast
+            dest.index_add_(0, idx, torch.tensor([[1.], [2.], [3.]]))
+            expected = torch.zeros(4, 64)
+            expected[0] = 1
+            expected[2] = 5
+            self.assertEqual(dest, expected)
+
         # add coverage for issue with atomic add that appeared only for
         # specific dtypes on cuda:
         # https://github.com/pytorch/pytorch/issues/29153
@@ -3662,6 +3764,42 @@ class AbstractTestCases:
                                    "missing 1 required positional arguments",
                                    lambda: torch.tensor().new_zeros((5, 5), 0))
 
+        def test_parsing_overload_cache(self):
+            x = torch.randn(3)
+            scalar = torch.tensor(2.)
+            scalar_grad = torch.tensor(2., requires_grad=True)
+
+            def run():
+                results = []
+                # Alternates between the overloads with the same and different
+                # argument types
+                for _ in range(3):
+                    results.append(torch.pow(x, 2))
+                    results.append(torch.pow(x, 2.))
+                    results.append(torch.pow(x, scalar))
+                    results.append(torch.pow(x, x))
+                    results.append(torch.pow(2, x))
+                    results.append(torch.pow(x, scalar_grad))
+                    results.append(torch.sum(x, 0))
+                    results.append(torch.sum(x, (0,)))
+                    results.append(torch.sum(x))
+                return results
+
+            self.assertTrue(torch._C._get_arg_parser_overload_cache())
+            cached = run()
+            torch._C._set_arg_parser_overload_cache(False)
+            try:
+                self.assertFalse(torch._C._get_arg_parser_overload_cache())
+                expected = run()
+            finally:
+                torch._C._set_arg_parser_overload_cache(True)
+            for e, c in zip(expected, cached):
+                self.assertEqual(e, c)
+                self.assertEqual(e.requires_grad, c.requires_grad)
+            # a 0-dim tensor that requires grad only matches Tensor parameters
+            self.assertTrue(cached[5].requires_grad)
+            self.assertRaises(TypeError, lambda: torch.pow(x, "2"))
+
         def test_half_tensor(self):
             x = torch.randn(5, 5).float()
             y = torch.randn(5, 5).float()
@@ -4357,6 +4495,70 @@ tensor([[[1., 1., 1.,  ..., 1., 1., 1.],
             x.strides = (3,)
             self.assertRaises(ValueError, lambda: torch.from_numpy(x))
 
+        @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+        def test_tensor_from_unviewable_numpy_array(self):
+            expected = torch.tensor([1., 2., 3., 4.], dtype=torch.double)
+            # non-native byte order
+            swapped = np.array([1, 2, 3, 4], dtype=np.double).newbyteorder().byteswap()
+            self.assertRaises(ValueError, lambda: torch.from_numpy(swapped))
+            self.assertEqual(torch.tensor(swapped), expected)
+            self.assertEqual(torch.as_tensor(swapped), expected)
+            # negative strides
+            reversed_array = np.array([4, 3, 2, 1], dtype=np.double)[::-1]
+            self.assertRaises(ValueError, lambda: torch.from_numpy(reversed_array))
+            self.assertEqual(torch.tensor(reversed_array), expected)
+            # misaligned
+            buf = np.zeros(4 * 8 + 1, dtype=np.uint8)
+            misaligned = np.frombuffer(buf.data, dtype=np.double, count=4, offset=1)
+            self.assertFalse(misaligned.flags.aligned)
+            misaligned_expected = torch.tensor(misaligned.copy())
+            self.assertEqual(torch.tensor(misaligned), misaligned_expected)
+
+        @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+        def test_tensor_from_list_of_numpy_arrays(self):
+            arrays = [np.random.randn(3, 4) for _ in range(5)]
+            expected = torch.from_numpy(np.stack(arrays))
+            self.assertEqual(torch.tensor(arrays), expected)
+            self.assertEqual(torch.tensor(tuple(arrays)), expected)
+            self.assertEqual(torch.tensor(arrays, dtype=torch.float), expected.float())
+            self.assertEqual(torch.as_tensor(arrays), expected)
+            # the result doesn't share memory with the arrays
+            result = torch.tensor(arrays)
+            result.zero_()
+            self.assertNotEqual(torch.from_numpy(arrays[0]), result[0])
+            # mixed dtypes and shapes take the generic path
+            mixed = [np.arange(3, dtype=np.int32), np.arange(3, dtype=np.int64)]
+            self.assertEqual(torch.tensor(mixed), torch.tensor([[0, 1, 2], [0, 1, 2]]))
+            self.assertRaises(ValueError, lambda: torch.tensor([np.zeros(2), np.zeros(3)]))
+            # unsupported dtypes with an explicit dtype take the generic path
+            unsupported = [np.arange(3, dtype=np.uint16)] * 2
+            self.assertEqual(torch.tensor(unsupported, dtype=torch.long),
+                             torch.tensor([[0, 1, 2], [0, 1, 2]]))
+
+        def test_frombuffer(self):
+            data = bytearray(b'\x01\x00\x00\x00\x02\x00\x00\x00')
+            t = torch.frombuffer(data, dtype=torch.int32)
+            self.assertEqual(t, torch.tensor([1, 2], dtype=torch.int32) if sys.byteorder == 'little'
+                             else torch.tensor([1 << 24, 2 << 24], dtype=torch.int32))
+            # shares memory with writable buffers
+            t.zero_()
+            self.assertEqual(data, bytearray(8))
+            self.assertEqual(torch.frombuffer(data, dtype=torch.uint8, count=3, offset=2).shape, (3,))
+            self.assertEqual(torch.frombuffer(b'abc', dtype=torch.uint8), torch.tensor([97, 98, 99], dtype=torch.uint8))
+            # misaligned data is copied
+            data = bytearray(9)
+            t = torch.frombuffer(data, dtype=torch.int32, count=2, offset=1)
+            self.assertEqual(t, torch.zeros(2, dtype=torch.int32))
+            view = memoryview(bytearray(16))
+            self.assertEqual(torch.frombuffer(view, dtype=torch.float32).shape, (4,))
+            with self.assertRaisesRegex(ValueError, "multiple of element size"):
+                torch.frombuffer(bytearray(6), dtype=torch.int32)
+            with self.assertRaisesRegex(ValueError, "greater than buffer length"):
+                torch.frombuffer(bytearray(8), dtype=torch.int32, count=3)
+            with self.assertRaisesRegex(ValueError, "offset"):
+                torch.frombuffer(bytearray(8), dtype=torch.int32, offset=9)
+            self.assertRaises(TypeError, lambda: torch.frombuffer([1, 2], dtype=torch.int32))
+
         @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
         def test_ctor_with_numpy_scalar_ctor(self) -> None:
             dtypes = [
@@ -7057,14 +7259,26 @@ class TestTorchDeviceType(TestCase):
         res2 = torch.cat((x, y), out=z)
         self.assertEqual(res1, res2)
 
-    @onlyCUDA
     def test_cat_preserve_channels_last(self, device):
         x = torch.randn((4, 3, 8, 8), device=device)
         y = torch.randn(x.shape, device=device)
-        res1 = torch.cat((x, y))
-        res2 = torch.cat((x.contiguous(memory_format=torch.channels_last), y.contiguous(memory_format=torch.channels_last)))
-        self.assertEqual(res1, res2)
-        self.assertTrue(res2.is_contiguous(memory_format=torch.channels_last))
+        for dim in range(4):
+            res1 = torch.cat((x, y), dim)
+            res2 = torch.cat((x.contiguous(memory_format=torch.channels_last),
+                              y.contiguous(memory_format=torch.channels_last)), dim)
+            self.assertEqual(res1, res2)
+            self.assertTrue(res2.is_contiguous(memory_format=torch.channels_last))
+
+    def test_stack_many_small(self, device):
+        for dtype in (torch.float, torch.long, torch.bool):
+            xs = [torch.randint(0, 2, (3, 5), dtype=dtype, device=device) for _ in range(5000)]
+            for dim in range(3):
+                res = torch.stack(xs, dim)
+                for i in (0, 1234, 4999):
+                    self.assertEqual(res.select(dim, i), xs[i])
+            out = torch.empty(0, dtype=dtype, device=device)
+            torch.stack(xs, 1, out=out)
+            self.assertEqual(out, torch.stack(xs, 1))
 
     @onlyCUDA
     @deviceCountAtLeast(2)
@@ -7696,6 +7910,30 @@ class TestTorchDeviceType(TestCase):
         x, _ = torch.solve(b, A)
         self.assertEqual(torch.matmul(A, x), b)
 
+    @skipCUDAIfNoMagma
+    @skipCPUIfNoLapack
+    @dtypes(torch.double)
+    def test_linalg_small_matrix_batches(self, device, dtype):
+        from torch.testing._internal.common_utils import random_symmetric_pd_matrix
+        # Small matrices take the batched fast paths, compare them to the
+        # matrices factorized one at a time
+        for n in [1, 2, 3, 4, 8, 9, 16, 32]:
+            b, A = self.solve_test_helper((n, 64), (64, n, 2), device, dtype)
+            x, LU = torch.solve(b, A)
+            self.assertEqual(x, torch.stack([torch.solve(b[i], A[i])[0] for i in range(64)]))
+            self.assertEqual(torch.matmul(A, x), b)
+            self.assertEqual(torch.inverse(A), torch.stack([torch.inverse(A[i]) for i in range(64)]))
+
+            A_LU, pivots = torch.lu(A)
+            self.assertEqual(A_LU, LU)
+            P, L, U = torch.lu_unpack(A_LU, pivots)
+            self.assertEqual(P.matmul(L).matmul(U), A)
+
+            A_pd = random_symmetric_pd_matrix(n, 64, dtype=dtype, device=device)
+            L = torch.cholesky(A_pd)
+            self.assertEqual(L, torch.stack([torch.cholesky(A_pd[i]) for i in range(64)]))
+            self.assertEqual(torch.matmul(L, L.transpose(-2, -1)), A_pd)
+
     @skipCUDAIfNoMagma
     @skipCPUIfNoLapack
     @unittest.skipIf(not TEST_NUMPY, "NumPy not found")
@@ -9111,6 +9349,22 @@ class TestTorchDeviceType(TestCase):
             self.assertEqual(res1val[:, :], res2val[:, :, k - 1], atol=0, rtol=0)
             self.assertEqual(res1ind[:, :], res2ind[:, :, k - 1], atol=0, rtol=0)
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.long)
+    def test_mode_large_slices(self, device, dtype):
+        # Slices longer than 1024 elements, and more than 65535 slices, don't
+        # fit the fused kernel and have their modes computed all at once
+        for shape, dim in [((3, 5000), 1), ((4000, 7), 0), ((66000, 2), 1)]:
+            x = torch.randint(0, 20, shape, device=device).to(dtype)
+            values, indices = torch.mode(x, dim)
+            counts = torch.nn.functional.one_hot(x.long(), 20).sum(dim)
+            self.assertEqual(counts.gather(-1, values.long().unsqueeze(-1)).squeeze(-1), counts.max(-1)[0])
+            self.assertEqual(x.gather(dim, indices.unsqueeze(dim)).squeeze(dim), values)
+
+            values_keepdim, indices_keepdim = torch.mode(x, dim, keepdim=True)
+            self.assertEqual(values_keepdim.squeeze(dim), values)
+            self.assertEqual(indices_keepdim.squeeze(dim), indices)
+
     @skipCUDAIfNoMagma
     @skipCPUIfNoLapack
     @unittest.skipIf(not TEST_NUMPY, "NumPy not found")
@@ -9574,6 +9828,36 @@ class TestTorchDeviceType(TestCase):
         run_test(torch.zeros(64, 61, dtype=dtype, device=device))
         run_test(torch.zeros(64, 1, dtype=dtype, device=device))
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_reduction_layouts(self, device, dtype):
+        # inner, outer, tall and narrow, and channels last reductions, which
+        # take different vectorized and parallel paths
+        inputs = [
+            (torch.randn(300, 517, dtype=dtype, device=device), 1),
+            (torch.randn(300, 517, dtype=dtype, device=device), 0),
+            (torch.randn(40000, 3, dtype=dtype, device=device), 0),
+            (torch.randn(2, 19, 31, 37, dtype=dtype, device=device).contiguous(memory_format=torch.channels_last), 3),
+        ]
+        for x, dim in inputs:
+            a = x.numpy()
+
+            def expected(result):
+                return torch.from_numpy(np.ascontiguousarray(result))
+            self.assertEqual(x.sum(dim), expected(np.sum(a, axis=dim)), atol=1e-3, rtol=1e-4)
+            self.assertEqual(x.mean(dim), expected(np.mean(a, axis=dim)), atol=1e-5, rtol=1e-4)
+            self.assertEqual(x.mean(dim, keepdim=True), expected(np.mean(a, axis=dim, keepdims=True)),
+                             atol=1e-5, rtol=1e-4)
+            self.assertEqual(x.mean(dim, dtype=torch.double), expected(np.mean(a.astype(np.float64), axis=dim)),
+                             atol=1e-5, rtol=1e-4)
+            self.assertEqual(x.mean(), expected(np.mean(a)), atol=1e-5, rtol=1e-4)
+            for p in [1, 2, 3, 1.5]:
+                norm = np.sum(np.abs(a) ** p, axis=dim) ** (1. / p)
+                self.assertEqual(x.norm(p, dim), expected(norm), atol=1e-4, rtol=1e-4)
+            self.assertEqual(x.max(dim).values, expected(np.max(a, axis=dim)))
+            self.assertEqual(x.argmax(dim), expected(np.argmax(a, axis=dim)))
+            self.assertEqual(x.argmin(dim), expected(np.argmin(a, axis=dim)))
+
     @slowTest
     def test_argminmax_large_axis(self, device):
         # Regression test for gh-32863
@@ -11385,6 +11669,27 @@ class TestTorchDeviceType(TestCase):
             self.assertTrue(y.is_contiguous())
             self.assertEqual(expected, actual)
 
+    def test_cdist_topk(self, device):
+        for r1, r2, m, k in [(5, 7, 3, 2), (70, 300, 10, 5), (3, 600, 17, 600), (0, 4, 3, 2), (4, 4, 0, 3)]:
+            x = torch.randn(r1, m, device=device)
+            y = torch.randn(r2, m, device=device)
+            values, indices = torch._cdist_topk(x, y, k)
+            expected = self._brute_cdist(x, y).sort(-1)[0][..., :k]
+            self.assertEqual(expected, values, atol=1e-3, rtol=0)
+            self.assertEqual(values, self._brute_cdist(x, y).gather(-1, indices), atol=1e-3, rtol=0)
+
+        x = torch.randn(2, 1, 30, 6, device=device, dtype=torch.double)
+        y = torch.randn(3, 40, 6, device=device, dtype=torch.double)
+        values, indices = torch._cdist_topk(x, y, 4)
+        self.assertEqual(values.shape, (2, 3, 30, 4))
+        self.assertEqual(self._brute_cdist(x, y).sort(-1)[0][..., :4], values)
+
+        x = torch.randn(6, 3, device=device, requires_grad=True)
+        y = torch.randn(8, 3, device=device)
+        values, _ = torch._cdist_topk(x, y, 3)
+        values.sum().backward()
+        self.assertEqual(x.grad.shape, x.shape)
+
     def test_multinomial_constraints(self, device):
         x = torch.empty(1, 2, 3, dtype=torch.double, device=device)
         self.assertRaisesRegex(
@@ -11753,6 +12058,26 @@ class TestTorchDeviceType(TestCase):
                 'expected scalar_type Double but found Float'):
             torch.logcumsumexp(b, axis, out=inplace_out)
 
+    @onlyCUDA
+    def test_scan_long_rows(self, device):
+        # Long rows are scanned in a single pass, and outer dimensions with few
+        # long columns through a transposed copy.
+        for shape, dim in [((3, 20000), 1), ((20000, 3), 0), ((2, 10000, 2), 1), ((50000,), 0)]:
+            x = torch.randn(shape, dtype=torch.double)
+            x_cuda = x.to(device)
+            self.assertEqual(torch.cumsum(x_cuda, dim), torch.cumsum(x, dim))
+            self.assertEqual(torch.logcumsumexp(x_cuda, dim), torch.logcumsumexp(x, dim))
+            y = 1 + x / 10000
+            self.assertEqual(torch.cumprod(y.to(device), dim), torch.cumprod(y, dim))
+            for op in (torch.cummax, torch.cummin):
+                values, indices = op(x_cuda, dim)
+                expected_values, expected_indices = op(x, dim)
+                self.assertEqual(values, expected_values)
+                self.assertEqual(indices, expected_indices)
+
+            i = torch.randint(-100, 100, shape)
+            self.assertEqual(torch.cumsum(i.to(device), dim), torch.cumsum(i, dim))
+
     def test_std_mean(self, device):
         x = torch.rand(100, 50, 20, device=device)
         for dim in range(x.dim()):
@@ -11773,6 +12098,39 @@ class TestTorchDeviceType(TestCase):
             self.assertEqual(std1, std2)
             self.assertEqual(mean1, mean2)
 
+    @dtypes(torch.float, torch.double)
+    def test_reduce_stats(self, device, dtype):
+        x = torch.randn(20, 30, 10, device=device, dtype=dtype)
+        x[0, 0, 0] = float('inf')
+        x[1, 2, 3] = float('nan')
+        finite = x.masked_fill(~torch.isfinite(x), 0)
+        for dim in [[], [0], [1], [2], [0, 2]]:
+            for keepdim in [False, True]:
+                sum_, sumsq, min_, max_, nonfinite = torch._reduce_stats(finite, dim, keepdim)
+                full_dim = dim or list(range(x.dim()))
+                self.assertEqual(sum_, finite.sum(full_dim, keepdim=keepdim))
+                self.assertEqual(sumsq, (finite * finite).sum(full_dim, keepdim=keepdim))
+                expected_min, expected_max = finite, finite
+                for d in reversed(full_dim):
+                    expected_min = expected_min.min(d, keepdim=keepdim)[0]
+                    expected_max = expected_max.max(d, keepdim=keepdim)[0]
+                self.assertEqual(min_, expected_min)
+                self.assertEqual(max_, expected_max)
+                self.assertEqual(nonfinite, torch.zeros_like(sum_, dtype=torch.long))
+
+                nonfinite = torch._reduce_stats(x, dim, keepdim)[4]
+                self.assertEqual(nonfinite, (~torch.isfinite(x)).sum(full_dim, keepdim=keepdim))
+
+        sum_, sumsq, min_, max_, nonfinite = torch._reduce_stats(x)
+        self.assertTrue(torch.isnan(min_))
+        self.assertTrue(torch.isnan(max_))
+        self.assertEqual(nonfinite.item(), 2)
+
+        empty = torch._reduce_stats(torch.empty(0, 3, device=device, dtype=dtype), [0])
+        self.assertEqual(empty[0], torch.zeros(3, device=device, dtype=dtype))
+        self.assertEqual(empty[2], torch.full((3,), float('inf'), device=device, dtype=dtype))
+        self.assertEqual(empty[3], torch.full((3,), float('-inf'), device=device, dtype=dtype))
+
     def test_var_mean(self, device):
         x = torch.rand(100, 300, 50, device=device)
         for dim in range(x.dim()):
@@ -12530,6 +12888,33 @@ class TestTorchDeviceType(TestCase):
                                               [1, 0, 0, 0],
                                               [0, 0, 0, 0]], device=device, dtype=torch.float32))
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.double, torch.long)
+    def test_scatter_add_index_add_sorted_accumulate(self, device, dtype):
+        # Many duplicated destinations, or deterministic mode, accumulate by sorting the indices instead of with atomics
+        def run(num_destinations):
+            index = torch.randint(num_destinations, (4, 1000), device=device)
+            src = torch.randint(-10, 10, (4, 1200), device=device).to(dtype)
+            self_ = torch.zeros(4, num_destinations, device=device, dtype=dtype)
+            result = self_.scatter_add(1, index, src)
+            expected = self_.cpu().scatter_add(1, index.cpu(), src.cpu())
+            self.assertEqual(result, expected, atol=0, rtol=0)
+
+            index = index[0]
+            src = src[:, :1000]
+            result = self_.index_add(1, index, src)
+            expected = self_.cpu().index_add(1, index.cpu(), src.cpu())
+            self.assertEqual(result, expected, atol=0, rtol=0)
+            self.assertEqual(self_.index_add(1, index, src), result, atol=0, rtol=0)
+
+        run(2)
+        deterministic = torch.is_deterministic()
+        try:
+            torch.set_deterministic(True)
+            run(500)
+        finally:
+            torch.set_deterministic(deterministic)
+
     def test_scatter_bool(self, device):
         x = torch.tensor([[True, True, True], [True, True, True]], device=device)
         res = torch.zeros(3, 3, dtype=torch.bool, device=device)
@@ -13546,6 +13931,29 @@ class TestTorchDeviceType(TestCase):
         _ = torch.irfft(half_spectrum_copy, 2, signal_sizes=(2, 2))
         self.assertEqual(half_spectrum, half_spectrum_copy)
 
+    @skipIfRocm
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    @dtypes(torch.double)
+    def test_fft_plan_reuse(self, device, dtype):
+        # Repeated transforms reuse cached plans, which must not be shared
+        # between inputs of the same shape but different strides or batch
+        x = torch.randn(8, 16, 2, device=device, dtype=dtype)
+        expected = torch.fft(x, 1)
+        for _ in range(3):
+            self.assertEqual(torch.fft(x, 1), expected)
+        x_t = x.transpose(0, 1).contiguous().transpose(0, 1)
+        self.assertEqual(torch.fft(x_t, 1), expected)
+        self.assertEqual(torch.fft(x[:4], 1), expected[:4])
+        self.assertEqual(torch.fft(x, 1, normalized=True), expected / 4)
+        self.assertEqual(torch.ifft(expected, 1), x)
+
+        r = torch.randn(6, 32, device=device, dtype=dtype)
+        expected = torch.rfft(r, 1)
+        for _ in range(3):
+            self.assertEqual(torch.rfft(r, 1), expected)
+        self.assertEqual(torch.rfft(r[::2], 1), expected[::2])
+        self.assertEqual(torch.irfft(expected, 1, signal_sizes=(32,)), r)
+
     @onlyOnCPUAndCUDA
     @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
     @dtypes(torch.double)
@@ -14406,6 +14814,69 @@ class TestTorchDeviceType(TestCase):
         self.assertEqual(sort_topk, topk[0])      # check values
         self.assertEqual(sort_topk, a[topk[1]])   # check indices
 
+    @dtypes(torch.int32, torch.int64, torch.float, torch.double)
+    def test_sort_large_1d(self, device, dtype):
+        # Large enough for the radix sort of 1-D inputs on CPU
+        n = 1 << 17
+        if dtype.is_floating_point:
+            x = torch.randn(n, device=device).to(dtype)
+            x[::100] = float('nan')
+            x[1::100] = float('inf')
+            x[2::100] = -float('inf')
+        else:
+            x = torch.randint(-1000, 1000, (n,), device=device, dtype=dtype)
+        for descending in [False, True]:
+            val, idx = x.sort(descending=descending)
+            self.assertEqual(val, x[idx])
+            # NaNs are sorted as the largest values
+            not_nan = val == val
+            pairs = not_nan[1:] & not_nan[:-1]
+            num_nan = int((~not_nan).sum())
+            if descending:
+                self.assertTrue(bool((~not_nan[:num_nan]).all()))
+                self.assertTrue(bool((val[1:][pairs] <= val[:-1][pairs]).all()))
+            else:
+                self.assertTrue(bool((~not_nan[n - num_nan:]).all()))
+                self.assertTrue(bool((val[1:][pairs] >= val[:-1][pairs]).all()))
+
+    def test_topk_large_rows(self, device):
+        # Few rows, large enough to be split across threads on CPU
+        for size in [(100000,), (2, 100000), (100000, 2)]:
+            x = torch.randn(size, device=device)
+            dim = 0 if size[-1] == 2 else -1
+            for largest in [True, False]:
+                val, idx = x.topk(10, dim=dim, largest=largest)
+                expected = x.sort(dim=dim, descending=largest)[0].narrow(dim, 0, 10)
+                self.assertEqual(val, expected, atol=0, rtol=0)
+                self.assertEqual(x.gather(dim, idx), val, atol=0, rtol=0)
+
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    @dtypes(torch.uint8, torch.int64, torch.float, torch.double)
+    def test_sort_many_large_rows(self, device, dtype):
+        # Rows too large for the in-place sort of each row on CUDA
+        if dtype.is_floating_point:
+            x = torch.randn(8, 5000, device=device).to(dtype)
+            x[:, ::50] = float('nan')
+            x[:, 1::50] = -float('inf')
+        else:
+            x = torch.randint(0, 100, (8, 5000), device=device, dtype=dtype)
+        for dim, descending in product([0, 1], [False, True]):
+            y = x if dim == 1 else x.t()
+            val, idx = y.sort(dim=dim, descending=descending)
+            self.assertEqual(val, y.gather(dim, idx), atol=0, rtol=0)
+            # numpy also sorts NaN last
+            expected = np.sort(y.cpu().numpy(), axis=dim)
+            if descending:
+                expected = np.flip(expected, axis=dim).copy()
+            self.assertEqual(val.cpu(), torch.from_numpy(expected), atol=0, rtol=0)
+
+    def test_topk_small_k_large_rows(self, device):
+        x = torch.randn(16, 5000, device=device)
+        for largest in [True, False]:
+            val, idx = x.topk(100, largest=largest)
+            self.assertEqual(val, x.sort(descending=largest)[0][:, :100], atol=0, rtol=0)
+            self.assertEqual(x.gather(1, idx), val, atol=0, rtol=0)
+
     @dtypesIfCUDA(*([torch.half, torch.float, torch.double]
                     + ([torch.bfloat16] if TEST_WITH_ROCM else [])))
     @dtypes(torch.float, torch.double)
@@ -14947,6 +15418,17 @@ class TestTorchDeviceType(TestCase):
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+        class Exporter(object):
+            def __init__(self, tensor):
+                self.tensor = tensor
+
+            def __dlpack__(self):
+                return to_dlpack(self.tensor)
+
+        z = from_dlpack(Exporter(x))
+        self.assertEqual(z, x)
+        self.assertEqual(z.data_ptr(), x.data_ptr())
+
     @onlyCUDA
     @unittest.skipIf(PYTORCH_CUDA_MEMCHECK, "is_pinned uses failure to detect pointer property")
     def test_pin_memory_from_constructor(self, device):
@@ -15173,6 +15655,35 @@ class TestTorchDeviceType(TestCase):
         big_out = torch.ones(1000000, dtype=torch.int8, device=device).bincount()
         self.assertEqual(big_exp, big_out)
 
+    def test_bincount_large_input(self, device):
+        # large enough inputs are counted with one histogram per thread
+        x = torch.randint(0, 100, (100000,), device=device)
+        w = torch.randint(0, 10, (100000,), device=device, dtype=torch.double)
+        expected = torch.zeros(100, dtype=torch.int64)
+        expected_weighted = torch.zeros(100, dtype=torch.double)
+        for i, j in zip(x.tolist(), w.tolist()):
+            expected[i] += 1
+            expected_weighted[i] += j
+        self.assertEqual(expected, x.bincount().cpu())
+        self.assertEqual(expected_weighted, x.bincount(w).cpu())
+        self.assertEqual(expected_weighted, x.bincount(w, minlength=1000).cpu()[:100])
+
+    def test_unique_large_input(self, device):
+        # large enough inputs are deduplicated with one set per thread
+        x = torch.randint(-500, 500, (100000,), device=device)
+        x_list = x.tolist()
+        for sorted_ in [True, False]:
+            unique, inverse, counts = torch.unique(x, sorted=sorted_, return_inverse=True, return_counts=True)
+            unique_list = unique.tolist()
+            self.assertEqual(sorted(set(x_list)), sorted(unique_list))
+            if sorted_:
+                self.assertEqual(sorted(unique_list), unique_list)
+            self.assertEqual(x, unique[inverse])
+            expected_counts = [0] * len(unique_list)
+            for i in inverse.tolist():
+                expected_counts[i] += 1
+            self.assertEqual(expected_counts, counts.tolist())
+
     @dtypes(torch.float, torch.double, torch.half)
     def test_multinomial(self, device, dtype):
         def make_prob_dist(shape, is_contiguous):
@@ -16787,6 +17298,24 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
         res6 = torch.baddbmm(res2, b1, b2, beta=.1, alpha=.5)
         self.assertEqual(res6, res2 * .1 + res * .5)
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_bmm_parallel_over_batch(self, device, dtype):
+        # Enough small matrices for the batch to be distributed over threads
+        num_batches = 4 * torch.get_num_threads()
+        M, N, O = 16, 24, 20
+        for t1, t2 in product([False, True], repeat=2):
+            b1 = torch.randn(num_batches, M, N, dtype=dtype, device=device)
+            b2 = torch.randn(num_batches, N, O, dtype=dtype, device=device)
+            if t1:
+                b1 = b1.transpose(1, 2).contiguous().transpose(1, 2)
+            if t2:
+                b2 = b2.transpose(1, 2).contiguous().transpose(1, 2)
+            c = torch.randn(num_batches, M, O, dtype=dtype, device=device)
+            expected = torch.stack([torch.mm(b1[i], b2[i]) for i in range(num_batches)])
+            self.assertEqual(torch.bmm(b1, b2), expected)
+            self.assertEqual(torch.baddbmm(c, b1, b2, beta=.5, alpha=2), c * .5 + expected * 2)
+
     def _test_cop(self, torchfn, mathfn, dtype, device):
         def reference_implementation(res2):
             for i, j in iter_indices(sm1):
@@ -17598,6 +18127,23 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
         test_output_dtype(torch.int32, False)
         test_output_dtype(torch.int64, True)
 
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    @dtypes(torch.float, torch.int64)
+    def test_searchsorted_large(self, device, dtype):
+        # boundary lengths that are and are not powers of two, and inputs that are not a multiple of the batch size
+        for num_boundaries in [0, 1, 7, 64, 1000]:
+            boundaries = torch.randint(-100, 100, (3, num_boundaries), device=device).sort(dim=-1)[0].to(dtype)
+            values = torch.randint(-110, 110, (3, 1001), device=device).to(dtype)
+            for right, out_int32 in product([False, True], [False, True]):
+                side = 'right' if right else 'left'
+                result = torch.searchsorted(boundaries, values, right=right, out_int32=out_int32)
+                expected = [np.searchsorted(b, v, side=side) for b, v in zip(boundaries.cpu().numpy(), values.cpu().numpy())]
+                self.assertEqual(result, torch.tensor(np.stack(expected)), exact_dtype=False)
+
+                result = torch.bucketize(values, boundaries[0], right=right, out_int32=out_int32)
+                expected = np.searchsorted(boundaries[0].cpu().numpy(), values.cpu().numpy(), side=side)
+                self.assertEqual(result, torch.tensor(expected), exact_dtype=False)
+
     def test_pickle_gradscaler(self, device):
         # This test is not in test_cuda.py because it should pass in 3 cases:
         #  1. cuda is not available.
@@ -17860,6 +18406,88 @@ class TestDevicePrecision(TestCase):
 
         self.assertEqual(out_cpu, out_gpu, atol=1e-2, rtol=0)
 
+    @onlyCPU
+    def test_bfloat16_cpu_fast_paths(self, device):
+        x = torch.randn(8, 67, device=device)
+        xb = x.bfloat16()
+        self.assertEqual(torch.softmax(xb, -1).float(), torch.softmax(xb.float(), -1), atol=1e-2, rtol=0)
+        self.assertEqual(torch.log_softmax(xb, -1).float(), torch.log_softmax(xb.float(), -1), atol=5e-2, rtol=0)
+        ln = torch.nn.LayerNorm(67)
+        self.assertEqual(ln.bfloat16()(xb).float(), ln.float()(xb.float()), atol=5e-2, rtol=0)
+        self.assertEqual(torch.sigmoid(xb).float(), torch.sigmoid(xb.float()), atol=1e-2, rtol=0)
+
+        w = torch.randn(67, 33, device=device)
+        self.assertEqual(torch.mm(xb, w.bfloat16()).float(), torch.mm(xb.float(), w.bfloat16().float()),
+                         atol=1e-1, rtol=1e-2)
+
+        self.assertFalse(torch.is_autocast_cpu_enabled())
+        with torch.cpu.amp.autocast():
+            self.assertTrue(torch.is_autocast_cpu_enabled())
+            self.assertEqual(torch.mm(x, w).dtype, torch.bfloat16)
+            self.assertEqual(torch.sum(xb).dtype, torch.float32)
+            self.assertEqual(torch.cat((xb, x)).dtype, torch.float32)
+        self.assertFalse(torch.is_autocast_cpu_enabled())
+
+    @onlyCPU
+    def test_autocast_persistent_cache(self, device):
+        w = torch.randn(16, 16, device=device, requires_grad=True)
+        x = torch.randn(4, 16, device=device)
+        self.assertFalse(torch.is_autocast_cache_persistent())
+        torch.set_autocast_cache_persistent(True)
+        try:
+            with torch.no_grad():
+                with torch.cpu.amp.autocast():
+                    out = torch.mm(x, w)
+                torch.clear_autocast_cache()
+                stats = torch.autocast_cache_stats()
+                with torch.cpu.amp.autocast():
+                    self.assertEqual(torch.mm(x, w), out)
+                torch.clear_autocast_cache()
+                # The cast made in the previous region was reused
+                self.assertEqual(torch.autocast_cache_stats()['hits'], stats['hits'] + 1)
+                self.assertEqual(torch.autocast_cache_stats()['misses'], stats['misses'])
+
+                w.add_(1)
+                with torch.cpu.amp.autocast():
+                    self.assertEqual(torch.mm(x, w), torch.mm(x.bfloat16(), w.bfloat16()))
+                torch.clear_autocast_cache()
+                self.assertEqual(torch.autocast_cache_stats()['invalidations'], stats['invalidations'] + 1)
+
+                # Replacing the data with p.data = t doesn't bump the version
+                # but is detected
+                w.data = w.data * 2
+                with torch.cpu.amp.autocast():
+                    self.assertEqual(torch.mm(x, w), torch.mm(x.bfloat16(), w.bfloat16()))
+                torch.clear_autocast_cache()
+                self.assertEqual(torch.autocast_cache_stats()['invalidations'], stats['invalidations'] + 2)
+
+                # In-place updates through p.data are not, see
+                # at::autocast::set_cache_persistent. Turning the cache off
+                # and on again drops the stale cast.
+                w.data.mul_(2)
+                with torch.cpu.amp.autocast():
+                    torch.mm(x, w)
+                torch.clear_autocast_cache()
+                self.assertEqual(torch.autocast_cache_stats()['invalidations'], stats['invalidations'] + 2)
+                torch.set_autocast_cache_persistent(False)
+                torch.set_autocast_cache_persistent(True)
+                with torch.cpu.amp.autocast():
+                    self.assertEqual(torch.mm(x, w), torch.mm(x.bfloat16(), w.bfloat16()))
+                torch.clear_autocast_cache()
+
+            # A cast without autograd history isn't reused when grad is needed
+            with torch.cpu.amp.autocast():
+                torch.mm(x, w).sum().backward()
+            torch.clear_autocast_cache()
+            self.assertIsNotNone(w.grad)
+
+            torch.set_autocast_cache_max_bytes(1)
+            self.assertEqual(torch.autocast_cache_stats()['bytes'], 0)
+        finally:
+            torch.set_autocast_cache_max_bytes(0)
+            torch.set_autocast_cache_persistent(False)
+        self.assertEqual(torch.autocast_cache_stats()['entries'], 0)
+
     @skipCUDAIfRocm
     @dtypes(torch.double)
     def test_sum_noncontig(self, device, dtype):
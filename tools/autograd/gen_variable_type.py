@@ -1132,6 +1132,14 @@ def emit_body(declaration):
             return []
         return ['increment_version({});'.format(arg['name']) for arg in differentiable_outputs]
 
+    def emit_increment_tensorlist_version():
+        # In-place ops on tensor lists (e.g. _foreach_add_) return nothing, so
+        # the tensors they modify aren't among the differentiable outputs.
+        if not inplace or not returns_void:
+            return []
+        return ['increment_version({});'.format(arg['name']) for arg in arguments
+                if arg['type'] == 'TensorList' and arg.get('annotation') == 'a!']
+
     env = {}
     combined = nested_dict(env, declaration)
 
@@ -1152,6 +1160,8 @@ def emit_body(declaration):
         # requires that the counter is incremented before it is called
         body.extend(emit_increment_version())
         body.append(emit_history())
+    else:
+        body.extend(emit_increment_tensorlist_version())
     if requires_derivative:
         body.append(emit_save_outputs())
     if base_name in RESET_GRAD_ACCUMULATOR:
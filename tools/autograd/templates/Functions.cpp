@@ -1046,6 +1046,36 @@ Tensor binary_cross_entropy_double_backward_grad_output(const Tensor & grad, con
   return ggO;
 }
 
+Tensor fused_cross_entropy_double_backward(const Tensor & grad, const Tensor & grad_output, const Tensor & input, const Tensor & target, const Tensor & weight, int64_t reduction, int64_t ignore_index, double label_smoothing, const Tensor & lse, const Tensor & total_weight) {
+  // The gradient of a row x with target t is a * softmax(x) plus terms that
+  // don't depend on x, where a = g * ((1 - eps) * w[t] + eps / C * sum(w)), g
+  // is the factor of grad_output of the row, and a = 0 if t is ignored.
+  const int64_t C = input.size(1);
+  auto valid = target.ne(ignore_index);
+  Tensor w_t, w_sum;
+  if (weight.defined()) {
+    w_t = weight.index_select(0, target.masked_fill(valid.logical_not(), 0));
+    w_sum = weight.sum();
+  } else {
+    w_t = at::ones({input.size(0)}, input.options());
+    w_sum = at::scalar_tensor(C, input.options());
+  }
+  auto g = reduction == at::Reduction::Mean ? grad_output / total_weight : grad_output;
+  auto a = (g * ((1 - label_smoothing) * w_t + label_smoothing / C * w_sum) * valid).to(input.scalar_type());
+  auto z = (input - lse.unsqueeze(1)).exp().to(input.scalar_type());
+  return a.unsqueeze(1) * z * (grad - (grad * z).sum(1, true));
+}
+
+Tensor fused_cross_entropy_double_backward_grad_output(const Tensor & grad, const Tensor & input, const Tensor & target, const Tensor & weight, int64_t reduction, int64_t ignore_index, double label_smoothing, const Tensor & lse, const Tensor & total_weight) {
+  // The backward is linear in grad_output.
+  auto ones = reduction == at::Reduction::None ? at::ones({input.size(0)}, input.options()) : at::ones({}, input.options());
+  auto ggO = grad * at::_fused_cross_entropy_backward(ones, input, target, weight, reduction, ignore_index, label_smoothing, lse, total_weight);
+  if (reduction == at::Reduction::None) {
+    return ggO.sum(1);
+  }
+  return ggO.sum();
+}
+
 Tensor l1_loss_double_backward_grad_output(const Tensor & grad, const Tensor & input, const Tensor & target, int64_t reduction) {
   auto output = l1_loss_backward(grad, input, target, at::Reduction::None);
   if (reduction == at::Reduction::Mean) {
@@ -81,6 +81,7 @@ jit_core_sources = [
 libtorch_core_sources = [
     "torch/csrc/autograd/anomaly_mode.cpp",
     "torch/csrc/autograd/autograd.cpp",
+    "torch/csrc/autograd/checkpoint.cpp",
     "torch/csrc/autograd/cpp_hook.cpp",
     "torch/csrc/autograd/custom_function.cpp",
     "torch/csrc/autograd/engine.cpp",
@@ -105,6 +106,7 @@ libtorch_core_sources = [
     "torch/csrc/jit/codegen/fuser/fallback.cpp",
     "torch/csrc/jit/codegen/fuser/interface.cpp",
     "torch/csrc/jit/codegen/fuser/kernel_cache.cpp",
+    "torch/csrc/jit/codegen/kernel_disk_cache.cpp",
     "torch/csrc/jit/frontend/builtin_functions.cpp",
     "torch/csrc/jit/frontend/versioned_symbols.cpp",
     "torch/csrc/jit/frontend/canonicalize_modified_loop.cpp",
@@ -157,6 +159,7 @@ libtorch_core_sources = [
     "torch/csrc/jit/passes/insert_guards.cpp",
     "torch/csrc/jit/passes/lift_closures.cpp",
     "torch/csrc/jit/passes/liveness.cpp",
+    "torch/csrc/jit/passes/memory_planning.cpp",
     "torch/csrc/jit/passes/loop_unrolling.cpp",
     "torch/csrc/jit/passes/lower_grad_of.cpp",
     "torch/csrc/jit/passes/lower_tuples.cpp",
@@ -167,17 +170,20 @@ libtorch_core_sources = [
     "torch/csrc/jit/passes/create_functional_graphs.cpp",
     "torch/csrc/jit/passes/prepack_folding.cpp",
     "torch/csrc/jit/passes/fold_conv_bn.cpp",
+    "torch/csrc/jit/passes/fork_independent_branches.cpp",
     "torch/csrc/jit/passes/remove_expands.cpp",
     "torch/csrc/jit/passes/remove_dropout.cpp",
     "torch/csrc/jit/passes/requires_grad_analysis.cpp",
     "torch/csrc/jit/passes/shape_analysis.cpp",
     "torch/csrc/jit/passes/specialize_autogradzero.cpp",
     "torch/csrc/jit/passes/subgraph_rewrite.cpp",
+    "torch/csrc/jit/passes/symbolic_shape_analysis.cpp",
     "torch/csrc/jit/passes/tensorexpr_fuser.cpp",
     "torch/csrc/jit/passes/utils/memory_dag.cpp",
     "torch/csrc/jit/passes/utils/subgraph_utils.cpp",
     "torch/csrc/jit/passes/xnnpack_rewrite.cpp",
     "torch/csrc/jit/passes/vulkan_rewrite.cpp",
+    "torch/csrc/jit/passes/mkldnn_rewrite.cpp",
     "torch/csrc/jit/passes/quantization/helper.cpp",
     "torch/csrc/jit/passes/quantization/quantization_type.cpp",
     "torch/csrc/jit/passes/quantization/insert_observers.cpp",
@@ -193,11 +199,14 @@ libtorch_core_sources = [
     "torch/csrc/jit/runtime/interpreter.cpp",
     "torch/csrc/jit/runtime/jit_exception.cpp",
     "torch/csrc/jit/runtime/logging.cpp",
+    "torch/csrc/jit/runtime/observer.cpp",
     "torch/csrc/jit/runtime/operator.cpp",
     "torch/csrc/jit/runtime/print_handler.cpp",
     "torch/csrc/jit/runtime/profiling_graph_executor_impl.cpp",
     "torch/csrc/jit/runtime/profiling_record.cpp",
     "torch/csrc/jit/runtime/register_ops_utils.cpp",
+    "torch/csrc/jit/runtime/static/impl.cpp",
+    "torch/csrc/jit/runtime/static/inference_session.cpp",
     "torch/csrc/jit/runtime/symbolic_script.cpp",
     "torch/csrc/jit/runtime/vararg_functions.cpp",
     "torch/csrc/jit/serialization/import.cpp",
@@ -343,6 +352,7 @@ libtorch_cuda_sources = [
 
 torch_cpp_srcs = [
     "torch/csrc/api/src/cuda.cpp",  # this just forwards stuff, no real CUDA
+    "torch/csrc/api/src/data/datasets/columnar.cpp",
     "torch/csrc/api/src/data/datasets/mnist.cpp",
     "torch/csrc/api/src/data/samplers/distributed.cpp",
     "torch/csrc/api/src/data/samplers/random.cpp",
@@ -399,6 +409,7 @@ torch_cpp_srcs = [
 
 libtorch_python_cuda_sources = [
     "torch/csrc/cuda/Event.cpp",
+    "torch/csrc/cuda/Graph.cpp",
     "torch/csrc/cuda/Module.cpp",
     "torch/csrc/cuda/Storage.cpp",
     "torch/csrc/cuda/Stream.cpp",
@@ -445,6 +456,7 @@ libtorch_python_core_sources = [
     "torch/csrc/jit/backends/backend_resolver.cpp",
     "torch/csrc/jit/backends/test_backend.cpp",
     "torch/csrc/jit/python/init.cpp",
+    "torch/csrc/jit/runtime/static/init.cpp",
     "torch/csrc/jit/passes/onnx.cpp",
     "torch/csrc/jit/passes/onnx/cast_all_constant_to_floating.cpp",
     "torch/csrc/jit/passes/onnx/constant_fold.cpp",
@@ -501,6 +513,7 @@ libtorch_python_distributed_sources = [
     "torch/csrc/distributed/rpc/python_functions.cpp",
     "torch/csrc/distributed/rpc/python_rpc_handler.cpp",
     "torch/csrc/distributed/rpc/request_callback_impl.cpp",
+    "torch/csrc/distributed/rpc/script_call_batcher.cpp",
     "torch/csrc/distributed/rpc/tensorpipe_agent.cpp",
     "torch/csrc/distributed/rpc/testing/faulty_process_group_agent.cpp",
     "torch/csrc/distributed/rpc/testing/init.cpp",
@@ -536,6 +549,7 @@ def glob_libtorch_python_sources():
         "test/cpp/jit/test_custom_class.cpp",
         "test/cpp/jit/test_custom_operators.cpp",
         "test/cpp/jit/test_dce.cpp",
+        "test/cpp/jit/test_fork_independent_branches.cpp",
         "test/cpp/jit/test_fuser.cpp",
         "test/cpp/jit/test_gpu.cpp",
         "test/cpp/jit/test_graph_executor.cpp",
@@ -545,7 +559,9 @@ def glob_libtorch_python_sources():
         "test/cpp/jit/test_ir.cpp",
         "test/cpp/jit/test_irparser.cpp",
         "test/cpp/jit/test_jit_type.cpp",
+        "test/cpp/jit/test_kernel_disk_cache.cpp",
         "test/cpp/jit/test_lite_interpreter.cpp",
+        "test/cpp/jit/test_memory_planning.cpp",
         "test/cpp/jit/test_misc.cpp",
         "test/cpp/jit/test_mobile_type_parser.cpp",
         "test/cpp/jit/test_module_api.cpp",
@@ -553,9 +569,11 @@ def glob_libtorch_python_sources():
         "test/cpp/jit/test_qualified_name.cpp",
         "test/cpp/jit/test_save_load.cpp",
         "test/cpp/jit/test_schema_matching.cpp",
+        "test/cpp/jit/test_static_runtime.cpp",
         "test/cpp/jit/test_subgraph_matcher.cpp",
         "test/cpp/jit/test_subgraph_rewriter.cpp",
         "test/cpp/jit/test_subgraph_utils.cpp",
+        "test/cpp/jit/test_symbolic_shape_analysis.cpp",
         "test/cpp/jit/test_utils.cpp",
     ])
 
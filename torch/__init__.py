@@ -28,7 +28,7 @@ from typing import Set, Type
 __all__ = [
     'typename', 'is_tensor', 'is_storage', 'set_default_tensor_type',
     'set_rng_state', 'get_rng_state', 'manual_seed', 'initial_seed', 'seed',
-    'save', 'load', 'set_printoptions', 'chunk', 'split', 'stack', 'matmul',
+    'save', 'save_async', 'load', 'set_printoptions', 'chunk', 'split', 'stack', 'matmul',
     'no_grad', 'enable_grad', 'rand', 'randn',
     'DoubleStorage', 'FloatStorage', 'LongStorage', 'IntStorage',
     'ShortStorage', 'CharStorage', 'ByteStorage', 'BoolStorage',
@@ -313,7 +313,7 @@ def is_deterministic():
 
 # If you edit these imports, please update torch/__init__.py.in as well
 from .random import set_rng_state, get_rng_state, manual_seed, initial_seed, seed
-from .serialization import save, load
+from .serialization import save, save_async, load
 from ._tensor_str import set_printoptions
 
 ################################################################################
@@ -450,6 +450,7 @@ del ComplexFloatStorageBase
 ################################################################################
 
 import torch.cuda
+import torch.cpu
 import torch.autograd
 from torch.autograd import no_grad, enable_grad, set_grad_enabled
 import torch.futures
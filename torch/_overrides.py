@@ -45,6 +45,7 @@ def get_ignored_functions():
         torch.initial_seed,
         torch.seed,
         torch.save,
+        torch.save_async,
         torch.load,
         torch.set_printoptions,
         torch.fork,
@@ -67,6 +68,7 @@ def get_ignored_functions():
         torch.wait,
         torch.as_tensor,
         torch.from_numpy,
+        torch.frombuffer,
         torch.get_device,
         torch.tensor,
         torch.default_generator,
@@ -135,7 +137,13 @@ def get_ignored_functions():
         torch.nn.functional.tanh,
         torch.set_autocast_enabled,
         torch.is_autocast_enabled,
+        torch.set_autocast_cpu_enabled,
+        torch.is_autocast_cpu_enabled,
         torch.clear_autocast_cache,
+        torch.set_autocast_cache_persistent,
+        torch.is_autocast_cache_persistent,
+        torch.set_autocast_cache_max_bytes,
+        torch.autocast_cache_stats,
         torch.autocast_increment_nesting,
         torch.autocast_decrement_nesting,
         torch.nn.functional.hardswish,
@@ -2332,6 +2332,47 @@ Example::
     array([-1,  2,  3])
 """)
 
+add_docstr(torch.frombuffer,
+           r"""
+frombuffer(buffer, *, dtype=None, count=-1, offset=0, requires_grad=False) -> Tensor
+
+Creates a 1-dimensional :class:`Tensor` from an object that implements the
+Python buffer protocol, like :class:`bytes`, :class:`bytearray`,
+:class:`memoryview` or Arrow buffers.
+
+Skips the first :attr:`offset` bytes of the buffer, and interprets the rest as
+:attr:`count` elements of type :attr:`dtype`. If the data is aligned to the
+element size, the returned tensor shares the memory of the buffer and keeps it
+exported until the tensor is freed, so modifications to the tensor will be
+reflected in the buffer and vice versa. Otherwise, the data is copied.
+
+.. note::
+    PyTorch doesn't support read-only tensors. Writing to a tensor created
+    from a read-only buffer, like :class:`bytes`, modifies the buffer.
+
+Args:
+    buffer (object): a Python object that exposes the buffer interface.
+
+Keyword args:
+    {dtype}
+    count (int, optional): the number of elements to read. If negative, reads
+        all elements after :attr:`offset`, whose size must then be a multiple
+        of the element size. Default: -1.
+    offset (int, optional): the number of bytes to skip at the start of the
+        buffer. Default: 0.
+    {requires_grad}
+
+Example::
+
+    >>> a = bytearray([1, 2, 3, 4])
+    >>> t = torch.frombuffer(a, dtype=torch.uint8)
+    >>> t
+    tensor([1, 2, 3, 4], dtype=torch.uint8)
+    >>> t[0] = 5
+    >>> a
+    bytearray(b'\x05\x02\x03\x04')
+""".format(**factory_common_args))
+
 add_docstr(torch.flatten,
            r"""
 flatten(input, start_dim=0, end_dim=-1) -> Tensor
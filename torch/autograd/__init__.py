@@ -14,10 +14,11 @@ from torch.types import _TensorOrTensors
 from .variable import Variable
 from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck, gradgradcheck
-from .grad_mode import no_grad, enable_grad, set_grad_enabled
+from .grad_mode import no_grad, enable_grad, set_grad_enabled, inference_mode
 from .anomaly_mode import detect_anomaly, set_detect_anomaly
 from . import profiler
 from . import functional
+from . import saved_tensors
 
 __all__ = ['Variable', 'Function', 'backward', 'grad_mode']
 
@@ -155,3 +155,62 @@ class set_grad_enabled(object):
 
     def __exit__(self, *args):
         torch.set_grad_enabled(self.prev)
+
+
+class inference_mode(_DecoratorContextManager):
+    r"""Context-manager that enables or disables inference mode.
+
+    Inference mode is a stricter :class:`~no_grad` for code that never runs
+    backward through the tensors it computes, like the forward pass of a
+    model being served. Besides disabling gradient calculation, it skips the
+    autograd layer of every operation: operations go straight to their CPU
+    or CUDA kernels, without looking up or creating autograd metadata for
+    their inputs and outputs, which lowers the overhead of every operation
+    on small tensors.
+
+    Tensors created in inference mode, views included, are inference
+    tensors, and so are views of inference tensors. Outside of inference
+    mode, they can't be saved for backward, be set to require grad, or be
+    updated in-place; use a clone instead.
+
+    In-place operations in inference mode don't increment the version
+    counters of the tensors they modify, so modifying a tensor saved for
+    backward outside of inference mode isn't detected. Only use inference
+    mode on tensors that don't take part in a graph you will call
+    :meth:`Tensor.backward()` on. Backward can't be run with
+    ``create_graph=True`` in inference mode.
+
+    This context manager is thread local; it will not affect computation
+    in other threads.
+
+    Also functions as a decorator. (Make sure to instantiate with parenthesis.)
+
+    Arguments:
+        mode (bool): Flag whether to enable inference mode (``True``), or
+                     disable it (``False``). Default: ``True``.
+
+    Example::
+
+        >>> x = torch.ones(2, 2, requires_grad=True)
+        >>> with torch.autograd.inference_mode():
+        ...   y = x * 2
+        >>> y.requires_grad
+        False
+        >>> @torch.autograd.inference_mode()
+        ... def doubler(x):
+        ...     return x * 2
+        >>> z = doubler(x)
+        >>> z.requires_grad
+        False
+    """
+    def __init__(self, mode=True):
+        self.mode = mode
+
+    def __enter__(self):
+        self.prev = torch._C._is_inference_mode_enabled()
+        self.prev_grad = torch.is_grad_enabled()
+        torch._C._set_inference_mode(self.mode)
+
+    def __exit__(self, *args):
+        torch._C._set_inference_mode(self.prev)
+        torch._C.set_grad_enabled(self.prev_grad)
@@ -25,10 +25,16 @@ class EventList(list):
     def __init__(self, *args, **kwargs):
         use_cuda = kwargs.pop('use_cuda', True)
         profile_memory = kwargs.pop('profile_memory', False)
+        memory_records = kwargs.pop('memory_records', [])
+        with_flops = kwargs.pop('with_flops', False)
+        with_perf_counters = kwargs.pop('with_perf_counters', False)
         super(EventList, self).__init__(*args, **kwargs)
         self._cpu_children_populated = False
         self._use_cuda = use_cuda
         self._profile_memory = profile_memory
+        self._memory_records = memory_records
+        self._with_flops = with_flops
+        self._with_perf_counters = with_perf_counters
 
     def __str__(self):
         return self.table()
@@ -105,6 +111,33 @@ class EventList(list):
     def cpu_children_populated(self):
         return self._cpu_children_populated
 
+    def memory_timeline(self):
+        """Returns the memory allocated by the profiled code over time.
+
+        Only available when profiling with ``profile_memory=True``.
+
+        Returns:
+            A list of ``(timestamp, cpu_bytes, cuda_bytes)`` tuples, one per
+            allocation or free, where timestamp is in us since the start of
+            the profiler and the bytes are allocated since then.
+        """
+        timeline = []
+        cpu_bytes = 0
+        cuda_bytes = 0
+        for record in self._memory_records:
+            cpu_bytes += record.cpu_memory_usage
+            cuda_bytes += record.cuda_memory_usage
+            timeline.append((record.timestamp, cpu_bytes, cuda_bytes))
+        return timeline
+
+    @property
+    def peak_cpu_memory_usage(self):
+        return max([cpu_bytes for _, cpu_bytes, _ in self.memory_timeline()], default=0)
+
+    @property
+    def peak_cuda_memory_usage(self):
+        return max([cuda_bytes for _, _, cuda_bytes in self.memory_timeline()], default=0)
+
     def table(self, sort_by=None, row_limit=100, header=None):
         """Prints an EventList as a nicely formatted table.
 
@@ -113,7 +146,9 @@ class EventList(list):
                 they are printed in the same order as they were registered.
                 Valid keys include: ``cpu_time``, ``cuda_time``, ``cpu_time_total``,
                 ``cuda_time_total``, ``cpu_memory_usage``, ``cuda_memory_usage``,
-                ``self_cpu_memory_usage``, ``self_cuda_memory_usage``, ``count``.
+                ``self_cpu_memory_usage``, ``self_cuda_memory_usage``, ``count``,
+                and with ``with_perf_counters``: ``cycles``, ``instructions``,
+                ``llc_misses``, ``branch_misses``.
 
         Returns:
             A string containing the table.
@@ -124,7 +159,11 @@ class EventList(list):
             row_limit=row_limit,
             header=header,
             use_cuda=self._use_cuda,
-            profile_memory=self._profile_memory)
+            profile_memory=self._profile_memory,
+            with_flops=self._with_flops,
+            with_perf_counters=self._with_perf_counters,
+            peak_memory_usage=(self.peak_cpu_memory_usage, self.peak_cuda_memory_usage)
+            if self._memory_records else None)
 
     def export_chrome_trace(self, path):
         """Exports an EventList as a Chrome tracing tools file.
@@ -160,6 +199,10 @@ class EventList(list):
                     )
                 )
                 for k in evt.kernels:
+                    # one track per device, or per stream for the CUPTI
+                    # activities
+                    cuda_tid = k.device if k.stream is None \
+                        else f'"device {k.device}, stream {k.stream}"'
                     # 's' and 'f' draw Flow arrows from
                     # the CPU launch to the GPU kernel
                     f.write('{"name": "%s", '
@@ -178,7 +221,7 @@ class EventList(list):
                             '"pid": "CUDA functions", '
                             '"id": %s, '
                             '"cat": "cpu_to_cuda", '
-                            '"args": {}}, ' % (k.name, k.interval.start, k.device, next_id))
+                            '"args": {}}, ' % (k.name, k.interval.start, cuda_tid, next_id))
                     f.write('{"name": "%s", '
                             '"ph": "X", '
                             '"ts": %s, '
@@ -186,9 +229,18 @@ class EventList(list):
                             '"tid": %s, '
                             '"pid": "CUDA functions", '
                             '"args": {}}, ' % (k.name, k.interval.start,
-                                               k.interval.elapsed_us(), k.device))
+                                               k.interval.elapsed_us(), cuda_tid))
                     next_id += 1
 
+            # 'C' draws the memory allocated over time as a counter track
+            for timestamp, cpu_bytes, cuda_bytes in self.memory_timeline():
+                f.write('{"name": "Memory allocated", '
+                        '"ph": "C", '
+                        '"ts": %s, '
+                        '"pid": "CPU functions", '
+                        '"args": {"CPU bytes": %s, "CUDA bytes": %s}}, '
+                        % (timestamp, cpu_bytes, cuda_bytes))
+
             # remove trailing whitespace and comma
             f.seek(f.tell() - 2, os.SEEK_SET)
             f.truncate()
@@ -216,7 +268,13 @@ class EventList(list):
         for evt in self:
             stats[get_key(evt, group_by_input_shapes)].add(
                 evt, group_by_input_shapes)
-        return EventList(stats.values(), use_cuda=self._use_cuda, profile_memory=self._profile_memory)
+        return EventList(
+            stats.values(),
+            use_cuda=self._use_cuda,
+            profile_memory=self._profile_memory,
+            memory_records=self._memory_records,
+            with_flops=self._with_flops,
+            with_perf_counters=self._with_perf_counters)
 
     def total_average(self):
         """Averages all events.
@@ -260,6 +318,31 @@ class profile(object):
 
         profile_memory (bool, optional): Whether to report memory usage, default: ``False``
 
+        use_cupti (bool, optional): Collects the kernels, memcpys and memsets
+            executed on the GPUs with CUPTI instead of timing the operators with
+            cudaEvents. The records are buffered asynchronously, so they don't
+            stall the CUDA streams, and carry the actual execution interval and
+            stream of each kernel, which shows the overlap of the streams in
+            :meth:`export_chrome_trace`. Each activity is attributed to the
+            innermost operator that launched it; the activities launched outside
+            of any operator are dropped. Takes precedence over ``use_cuda``.
+            Requires PyTorch to be built with CUPTI. Default: ``False``
+
+        with_flops (bool, optional): Estimates the FLOPs and the bytes read and
+            written by matrix multiplications, convolutions and elementwise ops
+            from their inputs, and reports the achieved GFLOP/s and GB/s of each
+            op in the table, to compare them with the roofline of the hardware.
+            The rates use the CUDA time of the ops when available, their CPU
+            time otherwise. Default: ``False``
+
+        with_perf_counters (bool, optional): Reads the hardware counters of the
+            CPU (cycles, instructions, last level cache misses and branch
+            mispredictions) of the thread at the start and end of each op, and
+            reports them in the table with the instructions per cycle. The
+            counts of an op include its children. Requires Linux, with
+            ``kernel.perf_event_paranoid`` at most 2, see
+            ``torch.autograd._perf_counters_available()``. Default: ``False``
+
     .. warning:
         Enabling memory profiling incurs additional profiler overhead
 
@@ -297,15 +380,21 @@ class profile(object):
             enabled=True,
             use_cuda=False,
             record_shapes=False,
-            profile_memory=False):
+            profile_memory=False,
+            use_cupti=False,
+            with_flops=False,
+            with_perf_counters=False):
         self.enabled = enabled
-        self.use_cuda = use_cuda
+        self.use_cupti = use_cupti
+        self.use_cuda = use_cuda or use_cupti
         self.function_events = None
         if not self.enabled:
             return
         self.entered = False
         self.record_shapes = record_shapes
         self.profile_memory = profile_memory
+        self.with_flops = with_flops
+        self.with_perf_counters = with_perf_counters
 
     def __enter__(self):
         if not self.enabled:
@@ -313,21 +402,30 @@ class profile(object):
         if self.entered:
             raise RuntimeError("autograd profiler traces are not reentrant")
         self.entered = True
-        profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
-            else torch.autograd.ProfilerState.CPU
-
-        config = torch.autograd.ProfilerConfig(profiler_kind, self.record_shapes, self.profile_memory)
+        if self.use_cupti:
+            profiler_kind = torch.autograd.ProfilerState.CUPTI
+        elif self.use_cuda:
+            profiler_kind = torch.autograd.ProfilerState.CUDA
+        else:
+            profiler_kind = torch.autograd.ProfilerState.CPU
+
+        config = torch.autograd.ProfilerConfig(
+            profiler_kind, self.record_shapes, self.profile_memory, self.with_flops,
+            self.with_perf_counters)
         torch.autograd._enable_profiler(config)
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
         if not self.enabled:
             return
-        records = torch.autograd._disable_profiler()
+        records, cuda_activities = torch.autograd._disable_profiler_with_cuda_activities()
         self.function_events = EventList(
-            parse_cpu_trace(records),
+            parse_cpu_trace(records, cuda_activities),
             use_cuda=self.use_cuda,
-            profile_memory=self.profile_memory)
+            profile_memory=self.profile_memory,
+            memory_records=parse_memory_trace(records) if self.profile_memory else [],
+            with_flops=self.with_flops,
+            with_perf_counters=self.with_perf_counters)
         return False
 
     def __repr__(self):
@@ -630,6 +728,23 @@ class FormattedTimesMixin(object):
     def cuda_time(self):
         return 0.0 if self.count == 0 else 1.0 * self.cuda_time_total / self.count
 
+    def _achieved_rate(self, amount):
+        # amount per us -> giga amount per s
+        time_total = self.cuda_time_total if self.cuda_time_total > 0 else self.cpu_time_total
+        return 0.0 if time_total == 0 else amount / time_total / 1e3
+
+    @property
+    def gflops_per_second(self):
+        return self._achieved_rate(self.flops)
+
+    @property
+    def gbytes_per_second(self):
+        return self._achieved_rate(self.bytes_moved)
+
+    @property
+    def instructions_per_cycle(self):
+        return 0.0 if self.cycles == 0 else 1.0 * self.instructions / self.cycles
+
 
 class Interval(object):
     def __init__(self, start, end):
@@ -640,14 +755,16 @@ class Interval(object):
         return self.end - self.start
 
 
-Kernel = namedtuple('Kernel', ['name', 'device', 'interval'])
+# stream is None for the kernels timed with cudaEvents
+Kernel = namedtuple('Kernel', ['name', 'device', 'interval', 'stream'])
 
 
 class FunctionEvent(FormattedTimesMixin):
     """Profiling information about a single function."""
     def __init__(
             self, id, node_id, name, thread, cpu_start, cpu_end, input_shapes=None,
-            cpu_memory_usage=0, cuda_memory_usage=0, is_async=False, is_remote=True):
+            cpu_memory_usage=0, cuda_memory_usage=0, is_async=False, is_remote=True,
+            flops=0, bytes_moved=0, sequence_nr=-1, perf_counters=None):
         self.id = id
         self.node_id = node_id
         self.name = name
@@ -661,9 +778,15 @@ class FunctionEvent(FormattedTimesMixin):
         self.cuda_memory_usage = cuda_memory_usage
         self.is_async = is_async
         self.is_remote = is_remote
+        self.flops = flops
+        self.bytes_moved = bytes_moved
+        self.sequence_nr = sequence_nr
+        # see profile(with_perf_counters=True)
+        (self.cycles, self.instructions, self.llc_misses,
+         self.branch_misses) = perf_counters or (0, 0, 0, 0)
 
-    def append_kernel(self, name, device, start, end):
-        self.kernels.append(Kernel(name, device, Interval(start, end)))
+    def append_kernel(self, name, device, start, end, stream=None):
+        self.kernels.append(Kernel(name, device, Interval(start, end), stream))
 
     def append_cpu_child(self, child):
         """Append a CPU child of type FunctionEvent.
@@ -751,6 +874,12 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.cuda_memory_usage = 0
         self.self_cpu_memory_usage = 0
         self.self_cuda_memory_usage = 0
+        self.flops = 0
+        self.bytes_moved = 0
+        self.cycles = 0
+        self.instructions = 0
+        self.llc_misses = 0
+        self.branch_misses = 0
 
     def add(self, other, group_by_input_shapes=False):
         if self.key is None:
@@ -776,6 +905,12 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.cuda_memory_usage += other.cuda_memory_usage
         self.self_cpu_memory_usage += other.self_cpu_memory_usage
         self.self_cuda_memory_usage += other.self_cuda_memory_usage
+        self.flops += other.flops
+        self.bytes_moved += other.bytes_moved
+        self.cycles += other.cycles
+        self.instructions += other.instructions
+        self.llc_misses += other.llc_misses
+        self.branch_misses += other.branch_misses
         self.count += other.count
         return self
 
@@ -810,7 +945,7 @@ class StringTable(defaultdict):
 ################################################################################
 # CPU checkpoints
 
-def parse_cpu_trace(thread_records):
+def parse_cpu_trace(thread_records, cuda_activities=()):
     def get_record_key(record):
         """
         Returns a tuple to be used by parse_cpu_trace for correlating start and
@@ -904,6 +1039,11 @@ def parse_cpu_trace(thread_records):
                 cuda_memory_usage = cuda_memory_allocs[record_key]
                 is_async = start.thread_id() != record.thread_id()
                 is_remote_event = record.is_remote()
+                # the counters are per thread
+                perf_counters = None
+                if not is_async and start.perf_counters() and record.perf_counters():
+                    perf_counters = [end - begin for begin, end in zip(
+                        start.perf_counters(), record.perf_counters())]
 
                 fe = FunctionEvent(
                     id=record.handle(),
@@ -917,6 +1057,10 @@ def parse_cpu_trace(thread_records):
                     cuda_memory_usage=cuda_memory_usage,
                     is_async=is_async,
                     is_remote=is_remote_event,
+                    flops=start.flops(),
+                    bytes_moved=start.bytes_moved(),
+                    sequence_nr=start.sequence_nr(),
+                    perf_counters=perf_counters,
                 )
                 # note: async events have only cpu total time
                 if not is_async and start.has_cuda():
@@ -945,9 +1089,51 @@ def parse_cpu_trace(thread_records):
     # the outermost nested call first. This adds stability
     # in how FunctionEvents appear
     functions.sort(key=lambda evt: [evt.cpu_interval.start, -evt.cpu_interval.end])
+
+    # CUPTI activities are correlated to the handle of the innermost local
+    # range that launched them
+    if cuda_activities:
+        local_functions = {fe.id: fe for fe in functions if not fe.is_remote}
+        start_us = start_record.cpu_us()
+        for activity in cuda_activities:
+            fe = local_functions.get(activity.correlation_id())
+            if fe is None:
+                continue
+            fe.append_kernel(
+                activity.name(),
+                activity.device(),
+                activity.start_us() - start_us,
+                activity.end_us() - start_us,
+                activity.stream())
     return functions
 
 
+# cpu_memory_usage and cuda_memory_usage are the signed sizes of an allocation
+# or a free, timestamp is in us since the start of the profiler
+MemoryRecord = namedtuple('MemoryRecord', ['timestamp', 'cpu_memory_usage', 'cuda_memory_usage'])
+
+
+def parse_memory_trace(thread_records):
+    """Returns the MemoryRecords of the local allocations and frees, sorted by time."""
+    start_record = None
+    for record in itertools.chain(*thread_records):
+        if record.name() == '__start_profile' and not record.is_remote():
+            start_record = record
+            break
+    assert start_record is not None
+
+    memory_records = [
+        MemoryRecord(
+            start_record.cpu_elapsed_us(record),
+            record.cpu_memory_usage(),
+            record.cuda_memory_usage())
+        for record in itertools.chain(*thread_records)
+        if record.kind() == 'memory_alloc' and not record.is_remote()
+    ]
+    memory_records.sort(key=attrgetter('timestamp'))
+    return memory_records
+
+
 ################################################################################
 # CUDA checkpoints
 
@@ -1035,15 +1221,23 @@ def build_table(
         header=None,
         row_limit=100,
         use_cuda=True,
-        profile_memory=False):
-    """Prints a summary of events (which can be a list of FunctionEvent or FunctionEventAvg)."""
+        profile_memory=False,
+        with_flops=False,
+        with_perf_counters=False,
+        peak_memory_usage=None):
+    """Prints a summary of events (which can be a list of FunctionEvent or FunctionEventAvg).
+
+    peak_memory_usage is an optional (cpu bytes, cuda bytes) tuple reported
+    after the table.
+    """
     if len(events) == 0:
         return ""
 
     if sort_by is not None:
         events = EventList(sorted(
             events, key=lambda evt: getattr(evt, sort_by), reverse=True
-        ), use_cuda=use_cuda, profile_memory=profile_memory)
+        ), use_cuda=use_cuda, profile_memory=profile_memory, with_flops=with_flops,
+            with_perf_counters=with_perf_counters)
 
     has_input_shapes = any(
         [event.input_shapes is not None for event in events])
@@ -1075,6 +1269,19 @@ def build_table(
                 'CUDA Mem',
                 'Self CUDA Mem',
             ])
+    if with_flops:
+        headers.extend([
+            'GFLOP/s',
+            'GB/s',
+        ])
+    if with_perf_counters:
+        headers.extend([
+            'Cycles',
+            'Instructions',
+            'IPC',
+            'LLC Misses',
+            'Branch Misses',
+        ])
     headers.append(
         'Number of Calls'
     )
@@ -1159,6 +1366,19 @@ def build_table(
                     # Self CUDA Mem Total
                     format_memory(evt.self_cuda_memory_usage),
                 ])
+        if with_flops:
+            row_values.extend([
+                '{:.2f}'.format(evt.gflops_per_second),
+                '{:.2f}'.format(evt.gbytes_per_second),
+            ])
+        if with_perf_counters:
+            row_values.extend([
+                evt.cycles,
+                evt.instructions,
+                '{:.2f}'.format(evt.instructions_per_cycle),
+                evt.llc_misses,
+                evt.branch_misses,
+            ])
         row_values.append(
             evt.count,  # Number of calls
         )
@@ -1173,4 +1393,9 @@ def build_table(
     append("Self CPU time total: {}".format(format_time(self_cpu_time_total)))
     if use_cuda:
         append("CUDA time total: {}".format(format_time(cuda_time_total)))
+    if profile_memory and peak_memory_usage is not None:
+        peak_cpu_memory_usage, peak_cuda_memory_usage = peak_memory_usage
+        append("Peak CPU memory allocated: {}".format(format_memory(peak_cpu_memory_usage)))
+        if torch.cuda.is_available():
+            append("Peak CUDA memory allocated: {}".format(format_memory(peak_cuda_memory_usage)))
     return ''.join(result)
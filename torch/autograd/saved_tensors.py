@@ -0,0 +1,400 @@
+r"""
+Policies controlling how tensors saved for backward are stored between the
+forward and the backward pass.
+
+By default, every tensor an operation saves for backward stays resident on its
+device until the graph is freed. The hooks in this module are called whenever
+a tensor is saved and whenever it is needed again, which allows trading memory
+for bandwidth (:class:`OffloadPolicy`) or for compute
+(:class:`RecomputePolicy`). Policies can be installed for a region of code as
+context managers or for the forward pass of individual modules with
+:func:`apply_saved_tensors_policy`.
+"""
+import threading
+import time
+import weakref
+
+import torch
+
+
+class saved_tensors_hooks(object):
+    r"""Context-manager that sets a pair of pack / unpack hooks for the tensors
+    saved for backward in its scope.
+
+    ``pack_hook(tensor)`` is called with every tensor saved for backward and
+    returns the object to keep in its place, or ``None`` to save the tensor as
+    usual. ``unpack_hook(packed)`` is called with that object every time the
+    tensor is needed in backward and must return a tensor with the same size
+    and dtype as the one that was saved.
+
+    Tensors saved by the hooks themselves are saved as usual. The hooks are
+    thread local, just like the grad mode.
+
+    Arguments:
+        pack_hook (callable): called when a tensor is saved.
+        unpack_hook (callable): called when a tensor is unpacked.
+
+    Example::
+
+        >>> def pack(tensor):
+        ...     return tensor.cpu()
+        >>> def unpack(packed):
+        ...     return packed.to('cuda')
+        >>> with torch.autograd.saved_tensors.saved_tensors_hooks(pack, unpack):
+        ...     y = x.pow(2)
+        >>> y.sum().backward()
+    """
+
+    def __init__(self, pack_hook, unpack_hook):
+        self.hooks = torch.autograd._make_saved_tensors_hooks(pack_hook, unpack_hook)
+        self.prev = []
+
+    def __enter__(self):
+        self.prev.append(torch.autograd._get_saved_tensors_hooks())
+        torch.autograd._set_saved_tensors_hooks(self.hooks)
+
+    def __exit__(self, *args):
+        torch.autograd._set_saved_tensors_hooks(self.prev.pop())
+        return False
+
+
+# Policies are not applied within the forward of a module handled by a
+# RecomputePolicy, nor while it is being recomputed, so that a recomputation
+# saves exactly the tensors the original forward saved.
+_state = threading.local()
+
+
+def _policies_disabled():
+    return getattr(_state, 'disabled', 0) > 0
+
+
+def _disable_policies(delta):
+    _state.disabled = getattr(_state, 'disabled', 0) + delta
+
+
+class SavedTensorsPolicy(object):
+    r"""Base class for saved tensor policies.
+
+    Subclasses implement :meth:`pack` and :meth:`unpack`, which are used as the
+    hooks of :class:`saved_tensors_hooks`. A policy is a context manager that
+    installs its hooks, and can be applied to modules with
+    :func:`apply_saved_tensors_policy`.
+    """
+
+    def __init__(self):
+        self._hooks = saved_tensors_hooks(self.pack, self.unpack)
+        self._module_active = []
+
+    def pack(self, tensor):
+        return None
+
+    def unpack(self, packed):
+        raise NotImplementedError
+
+    def stats(self):
+        r"""Returns a dictionary of statistics about the tensors handled by
+        the policy."""
+        return {}
+
+    def __enter__(self):
+        self._hooks.__enter__()
+        return self
+
+    def __exit__(self, *args):
+        return self._hooks.__exit__(*args)
+
+    def _enter_module(self, module, inputs):
+        active = not _policies_disabled()
+        self._module_active.append(active)
+        if active:
+            self.__enter__()
+
+    def _exit_module(self, module):
+        if self._module_active.pop():
+            self.__exit__(None, None, None)
+
+
+class _OffloadedTensor(object):
+    __slots__ = ['cpu', 'device', 'nbytes', 'gpu', 'event', 'prev', '__weakref__']
+
+    def __init__(self, cpu, device, nbytes, event, prev):
+        self.cpu = cpu
+        self.device = device
+        self.nbytes = nbytes
+        self.gpu = None
+        self.event = event
+        self.prev = prev
+
+
+class OffloadPolicy(SavedTensorsPolicy):
+    r"""Offloads CUDA tensors saved for backward to pinned host memory.
+
+    The device to host copies run on a side stream, so they overlap with the
+    rest of the forward pass. When backward unpacks an offloaded tensor, the
+    ``prefetch`` tensors saved right before it (the ones backward is about to
+    need, since it runs in roughly the reverse order of the forward pass) are
+    copied back to the device on the side stream as well.
+
+    Arguments:
+        min_bytes (int): tensors smaller than this are saved as usual.
+            Default: 1 MiB.
+        prefetch (int): number of tensors to copy back ahead of their use.
+            Default: 2.
+
+    :meth:`stats` reports ``num_offloaded``, ``bytes_offloaded``,
+    ``num_prefetched``, ``num_prefetch_misses`` (tensors that had not been
+    prefetched when backward needed them) and ``stall_time``, the time in
+    seconds the backward pass spent in the unpack hook.
+    """
+
+    def __init__(self, min_bytes=1024 * 1024, prefetch=2):
+        super(OffloadPolicy, self).__init__()
+        if prefetch < 0:
+            raise ValueError("prefetch must be non-negative, but got {}".format(prefetch))
+        self.min_bytes = min_bytes
+        self.prefetch = prefetch
+        self._streams = {}
+        self._last = None
+        self.reset_stats()
+
+    def reset_stats(self):
+        self.num_offloaded = 0
+        self.bytes_offloaded = 0
+        self.num_prefetched = 0
+        self.num_prefetch_misses = 0
+        self.stall_time = 0.
+
+    def stats(self):
+        return {
+            'num_offloaded': self.num_offloaded,
+            'bytes_offloaded': self.bytes_offloaded,
+            'num_prefetched': self.num_prefetched,
+            'num_prefetch_misses': self.num_prefetch_misses,
+            'stall_time': self.stall_time,
+        }
+
+    def _stream(self, device):
+        stream = self._streams.get(device)
+        if stream is None:
+            stream = torch.cuda.Stream(device)
+            self._streams[device] = stream
+        return stream
+
+    def pack(self, tensor):
+        if not tensor.is_cuda or tensor.is_sparse:
+            return None
+        nbytes = tensor.numel() * tensor.element_size()
+        if nbytes < self.min_bytes:
+            return None
+        device = tensor.device
+        stream = self._stream(device)
+        stream.wait_stream(torch.cuda.current_stream(device))
+        with torch.no_grad(), torch.cuda.stream(stream):
+            cpu = torch.empty(tensor.size(), dtype=tensor.dtype, pin_memory=True)
+            cpu.copy_(tensor, non_blocking=True)
+            event = torch.cuda.Event()
+            event.record(stream)
+        # The caching allocator must not hand out the memory of the saved
+        # tensor before the copy on the side stream is done.
+        tensor.record_stream(stream)
+        self.num_offloaded += 1
+        self.bytes_offloaded += nbytes
+        prev = self._last() if self._last is not None else None
+        packed = _OffloadedTensor(cpu, device, nbytes, event,
+                                  weakref.ref(prev) if prev is not None else None)
+        self._last = weakref.ref(packed)
+        return packed
+
+    def _copy_back(self, packed):
+        stream = self._stream(packed.device)
+        with torch.no_grad(), torch.cuda.stream(stream):
+            packed.gpu = packed.cpu.to(packed.device, non_blocking=True)
+            packed.event = torch.cuda.Event()
+            packed.event.record(stream)
+
+    def unpack(self, packed):
+        start = time.time()
+        if packed.gpu is None:
+            self.num_prefetch_misses += 1
+            self._copy_back(packed)
+        current = torch.cuda.current_stream(packed.device)
+        current.wait_event(packed.event)
+        result = packed.gpu
+        result.record_stream(current)
+        # Don't keep the device copy alive in case the graph is retained.
+        packed.gpu = None
+
+        prev = packed.prev() if packed.prev is not None else None
+        for _ in range(self.prefetch):
+            if prev is None:
+                break
+            if prev.gpu is None:
+                self._copy_back(prev)
+                self.num_prefetched += 1
+            prev = prev.prev() if prev.prev is not None else None
+        self.stall_time += time.time() - start
+        return result
+
+
+class _RecomputeFrame(object):
+    def __init__(self, module, inputs):
+        from torch.utils.checkpoint import get_device_states
+        self.module = module
+        self.inputs = inputs
+        self.versions = [inp._version if isinstance(inp, torch.Tensor) else None
+                         for inp in inputs]
+        self.cpu_rng_state = torch.get_rng_state()
+        self.had_cuda = torch.cuda._initialized
+        if self.had_cuda:
+            self.gpu_devices, self.gpu_states = get_device_states(*inputs)
+        self.num_saved = 0
+        self.saved = None
+
+
+class RecomputePolicy(SavedTensorsPolicy):
+    r"""Drops the tensors saved for backward by a module and recomputes them
+    by running the module's forward again when backward first needs one.
+
+    This policy only takes effect for modules it was applied to with
+    :func:`apply_saved_tensors_policy`; it keeps references to the inputs of
+    every forward call instead. Other policies applied to submodules of such a
+    module are ignored, since their saved tensors are recomputed as well. The CPU and CUDA RNG states are restored
+    before recomputing, so that random operations produce the same results.
+    The module's inputs must not be modified in-place before backward, and
+    its forward must save the same tensors when run again.
+
+    :meth:`stats` reports ``num_dropped``, ``bytes_dropped``,
+    ``num_recomputes`` and ``recompute_time`` in seconds.
+    """
+
+    def __init__(self):
+        super(RecomputePolicy, self).__init__()
+        self._frame = None
+        self.reset_stats()
+
+    def reset_stats(self):
+        self.num_dropped = 0
+        self.bytes_dropped = 0
+        self.num_recomputes = 0
+        self.recompute_time = 0.
+
+    def stats(self):
+        return {
+            'num_dropped': self.num_dropped,
+            'bytes_dropped': self.bytes_dropped,
+            'num_recomputes': self.num_recomputes,
+            'recompute_time': self.recompute_time,
+        }
+
+    def _enter_module(self, module, inputs):
+        active = not _policies_disabled()
+        self._module_active.append(active)
+        if active:
+            self._frame = _RecomputeFrame(module, inputs)
+            self.__enter__()
+            _disable_policies(1)
+
+    def _exit_module(self, module):
+        if self._module_active.pop():
+            _disable_policies(-1)
+            self.__exit__(None, None, None)
+            self._frame = None
+
+    def pack(self, tensor):
+        frame = self._frame
+        if frame is None:
+            return None
+        index = frame.num_saved
+        frame.num_saved += 1
+        self.num_dropped += 1
+        self.bytes_dropped += tensor.numel() * tensor.element_size()
+        return (frame, index)
+
+    def _recompute(self, frame):
+        from torch.utils.checkpoint import set_device_states
+        for inp, version in zip(frame.inputs, frame.versions):
+            if version is not None and inp._version != version:
+                raise RuntimeError(
+                    "an input of {} was modified by an inplace operation after "
+                    "its forward; its saved tensors can't be recomputed".format(
+                        type(frame.module).__name__))
+        saved = []
+
+        def capture(tensor):
+            saved.append(tensor)
+            return len(saved) - 1
+
+        def no_unpack(index):
+            raise RuntimeError("tensors saved during recomputation can't be unpacked")
+
+        inputs = [inp.detach().requires_grad_(inp.requires_grad)
+                  if isinstance(inp, torch.Tensor) else inp
+                  for inp in frame.inputs]
+        rng_devices = frame.gpu_devices if frame.had_cuda else []
+        start = time.time()
+        _disable_policies(1)
+        try:
+            with torch.random.fork_rng(devices=rng_devices):
+                torch.set_rng_state(frame.cpu_rng_state)
+                if frame.had_cuda:
+                    set_device_states(frame.gpu_devices, frame.gpu_states)
+                with torch.enable_grad(), saved_tensors_hooks(capture, no_unpack):
+                    frame.module.forward(*inputs)
+        finally:
+            _disable_policies(-1)
+        if len(saved) != frame.num_saved:
+            raise RuntimeError(
+                "recomputing the forward of {} saved {} tensors, but the original "
+                "forward saved {}".format(type(frame.module).__name__, len(saved),
+                                          frame.num_saved))
+        self.num_recomputes += 1
+        self.recompute_time += time.time() - start
+        frame.saved = saved
+
+    def unpack(self, packed):
+        frame, index = packed
+        if frame.saved is None:
+            self._recompute(frame)
+        return frame.saved[index]
+
+
+class _PolicyHandles(object):
+    def __init__(self, *handles):
+        self.handles = handles
+
+    def remove(self):
+        for handle in self.handles:
+            handle.remove()
+
+
+def apply_saved_tensors_policy(module, policy):
+    r"""Applies ``policy`` to the tensors saved for backward during every
+    forward call of ``module``, including the ones saved by its submodules.
+
+    A policy applied to a submodule takes precedence over the one of its
+    parent for the tensors saved by the submodule.
+
+    Arguments:
+        module (Module): the module to apply the policy to.
+        policy (SavedTensorsPolicy): the policy.
+
+    Returns:
+        a handle that can be used to remove the policy by calling
+        ``handle.remove()``
+
+    Example::
+
+        >>> policy = torch.autograd.saved_tensors.OffloadPolicy()
+        >>> for layer in model.layers:
+        ...     torch.autograd.saved_tensors.apply_saved_tensors_policy(layer, policy)
+        >>> model(x).sum().backward()
+        >>> policy.stats()['bytes_offloaded']
+    """
+    def pre_hook(module, inputs):
+        policy._enter_module(module, inputs)
+
+    def hook(module, inputs, output):
+        policy._exit_module(module)
+
+    return _PolicyHandles(module.register_forward_pre_hook(pre_hook),
+                          module.register_forward_hook(hook))
@@ -105,6 +105,68 @@ def flags(enabled=False, benchmark=False, deterministic=False):
             set_flags(orig_flags[0], orig_flags[1], orig_flags[2])
 
 
+def save_benchmark_cache(f):
+    r"""Saves the convolution algorithms selected by
+    ``torch.backends.cudnn.benchmark = True`` in this process.
+
+    The saved cache can be loaded by :func:`load_benchmark_cache` in later
+    processes that use the same cuDNN version and build of PyTorch, which then
+    skip benchmarking the convolutions it holds.
+
+    Arguments:
+        f: a file-like object (has to implement ``write``) or a string
+            containing a file name
+    """
+    data = _cudnn._serialize_benchmark_cache()
+    if isinstance(f, str):
+        with open(f, 'wb') as fh:
+            fh.write(data)
+    else:
+        f.write(data)
+
+
+def load_benchmark_cache(f):
+    r"""Loads the convolution algorithms saved by :func:`save_benchmark_cache`.
+
+    Algorithms are loaded for the devices with the same name and compute
+    capability as the device they were selected on, and do not replace the
+    ones this process has selected already. A cache saved with another cuDNN
+    version is ignored with a warning.
+
+    Arguments:
+        f: a file-like object (has to implement ``read``) or a string
+            containing a file name
+
+    Returns:
+        the number of algorithms loaded
+    """
+    if isinstance(f, str):
+        with open(f, 'rb') as fh:
+            data = fh.read()
+    else:
+        data = f.read()
+    return _cudnn._load_benchmark_cache(data)
+
+
+def share_benchmark_cache(store, rank, world_size, prefix='cudnn_benchmark_cache'):
+    r"""Exchanges the convolution algorithms selected by each rank of a job
+    through a :class:`torch.distributed.Store`.
+
+    Each rank publishes its cache under ``prefix`` and loads the caches of the
+    other ranks, so shapes benchmarked by any rank are not benchmarked again
+    by the others. All ranks have to call it.
+
+    Returns:
+        the number of algorithms loaded from the other ranks
+    """
+    store.set('{}/{}'.format(prefix, rank), _cudnn._serialize_benchmark_cache())
+    loaded = 0
+    for other in range(world_size):
+        if other != rank:
+            loaded += _cudnn._load_benchmark_cache(store.get('{}/{}'.format(prefix, other)))
+    return loaded
+
+
 # The magic here is to allow us to intercept code like this:
 #
 #   torch.backends.<cudnn|mkldnn>.enabled = True
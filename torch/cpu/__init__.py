@@ -0,0 +1,6 @@
+r"""
+This package holds CPU specific utilities, for now the CPU automatic mixed
+precision in :mod:`torch.cpu.amp`.
+"""
+
+from . import amp  # noqa: F401
@@ -0,0 +1,63 @@
+import torch
+import functools
+
+
+class autocast(object):
+    r"""
+    Instances of :class:`autocast` serve as context managers or decorators that
+    allow regions of your script to run in mixed precision on the CPU.
+
+    In these regions, CPU ops run in an op-specific dtype chosen by autocast:
+    matrix multiplications and convolutions run in ``torch.bfloat16``, ops that
+    need the range or precision of ``float32`` (losses, reductions with an
+    output ``dtype``, norms) run in ``float32``, and ops with several inputs
+    like :func:`torch.cat` run in the widest input type.  It is the CPU
+    counterpart of :class:`torch.cuda.amp.autocast`, which it can be nested
+    with; each only affects the tensors of its own device.
+
+    ``bfloat16`` has the exponent range of ``float32``, so unlike ``float16``
+    gradients don't underflow and no :class:`torch.cuda.amp.GradScaler` is needed.
+
+    Example::
+
+        model = Net()
+        optimizer = optim.SGD(model.parameters(), ...)
+
+        for input, target in data:
+            optimizer.zero_grad()
+
+            # Runs the forward pass (model + loss) with autocasting.
+            with torch.cpu.amp.autocast():
+                output = model(input)
+                loss = loss_fn(output, target)
+
+            loss.backward()
+            optimizer.step()
+
+    The autocast state is thread-local.  If you want it enabled in a new thread, the context manager or decorator
+    must be invoked in that thread.
+
+    Arguments:
+        enabled(bool, optional, default=True):  Whether autocasting should be enabled in the region.
+    """
+    def __init__(self, enabled=True):
+        self._enabled = enabled
+
+    def __enter__(self):
+        self.prev = torch.is_autocast_cpu_enabled()
+        torch.set_autocast_cpu_enabled(self._enabled)
+        torch.autocast_increment_nesting()
+
+    def __exit__(self, *args):
+        # Drop the cache when we exit to a nesting level that's outside any instance of autocast.
+        if torch.autocast_decrement_nesting() == 0:
+            torch.clear_autocast_cache()
+        torch.set_autocast_cpu_enabled(self.prev)
+        return False
+
+    def __call__(self, func):
+        @functools.wraps(func)
+        def decorate_autocast(*args, **kwargs):
+            with self:
+                return func(*args, **kwargs)
+        return decorate_autocast
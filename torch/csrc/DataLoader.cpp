@@ -1,5 +1,19 @@
 #include <torch/csrc/DataLoader.h>
 
+#include <torch/csrc/Exceptions.h>
+#include <torch/csrc/autograd/python_variable.h>
+#include <torch/csrc/utils/object_ptr.h>
+#include <torch/csrc/utils/pybind.h>
+#include <torch/csrc/utils/python_numbers.h>
+
+#include <ATen/ATen.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
 // Together with `torch/utils/data/_utils/signal_handling.py`, the following
 // is an effort to do our best to provide some error message to users when a
 // worker dies due to error / critical signals.
@@ -12,16 +26,12 @@
 
 #ifndef _WIN32
 
-#include <atomic>
 #include <map>
 #include <set>
 #include <csignal>
 #include <sstream>
 #include <sys/wait.h>
 
-#include <torch/csrc/Exceptions.h>
-#include <torch/csrc/utils/python_numbers.h>
-
 using namespace torch;
 
 // Critical signal handlers should be registered on worker processes before
@@ -213,10 +223,219 @@ static PyObject *THPModule_errorIfAnyWorkerFails(PyObject *module, PyObject *_ig
 
 #endif
 
+// NOTE [ Tensor rings ]
+//
+// A tensor ring is a contiguous uint8 tensor in shared memory used as a
+// single-producer single-consumer queue of lists of CPU tensors. A DataLoader
+// worker copies the tensors of a batch into its ring, and the main process
+// copies them out, so that the tensors don't each need a shared memory
+// segment and file descriptor of their own. Python handle is
+// `torch/utils/data/_utils/ring.py`.
+//
+// The first two cache lines of the ring hold the positions of the consumer
+// (head) and of the producer (tail), which count the bytes read and written
+// so far. The rest holds the records, one per list of tensors. A record is
+// made of
+//   int64 size of the record in bytes, int64 number of tensors, and for every
+//   tensor its int64 scalar type, int64 dim and int64 sizes,
+// followed by the data of every tensor at 64-byte aligned offsets. Records
+// never wrap around the end of the ring: a producer that reaches it writes a
+// wrap marker in place of the size and continues at the beginning.
+
+namespace {
+
+constexpr uint64_t kRingAlignment = 64;
+constexpr uint64_t kRingHeaderSize = 2 * kRingAlignment;
+constexpr uint64_t kRingWrapMarker = std::numeric_limits<uint64_t>::max();
+
+uint64_t ring_align(uint64_t n) {
+  return (n + kRingAlignment - 1) / kRingAlignment * kRingAlignment;
+}
+
+struct TensorRing {
+  explicit TensorRing(const at::Tensor& buffer) {
+    TORCH_CHECK(
+        buffer.device().is_cpu() && buffer.scalar_type() == at::kByte &&
+            buffer.dim() == 1 && buffer.is_contiguous() &&
+            static_cast<uint64_t>(buffer.numel()) >= kRingHeaderSize + kRingAlignment,
+        "a tensor ring must be a contiguous 1-dimensional uint8 CPU tensor of "
+        "at least ", kRingHeaderSize + kRingAlignment, " elements");
+    auto base = buffer.data_ptr<uint8_t>();
+    TORCH_CHECK(
+        reinterpret_cast<uintptr_t>(base) % kRingAlignment == 0,
+        "the data of a tensor ring must be ", kRingAlignment, "-byte aligned");
+    head = reinterpret_cast<std::atomic<uint64_t>*>(base);
+    tail = reinterpret_cast<std::atomic<uint64_t>*>(base + kRingAlignment);
+    data = base + kRingHeaderSize;
+    capacity = (buffer.numel() - kRingHeaderSize) / kRingAlignment * kRingAlignment;
+  }
+
+  // Returns false if the record doesn't fit in the free space of the ring.
+  bool put(const std::vector<at::Tensor>& tensors) {
+    uint64_t header_size = 2 * sizeof(int64_t);
+    uint64_t size = 0;
+    for (const auto& tensor : tensors) {
+      header_size += (2 + tensor.dim()) * sizeof(int64_t);
+      size += ring_align(tensor.nbytes());
+    }
+    size += ring_align(header_size);
+
+    const uint64_t h = head->load(std::memory_order_acquire);
+    uint64_t t = tail->load(std::memory_order_relaxed);
+    uint64_t offset = t % capacity;
+    const uint64_t pad = size > capacity - offset ? capacity - offset : 0;
+    if (size > capacity || pad + size > capacity - (t - h)) {
+      return false;
+    }
+    if (pad > 0) {
+      *reinterpret_cast<uint64_t*>(data + offset) = kRingWrapMarker;
+      t += pad;
+      offset = 0;
+    }
+
+    auto header = reinterpret_cast<int64_t*>(data + offset);
+    *header++ = size;
+    *header++ = tensors.size();
+    for (const auto& tensor : tensors) {
+      *header++ = static_cast<int64_t>(tensor.scalar_type());
+      *header++ = tensor.dim();
+      for (const auto s : tensor.sizes()) {
+        *header++ = s;
+      }
+    }
+    auto out = data + offset + ring_align(header_size);
+    for (const auto& tensor : tensors) {
+      if (tensor.nbytes() > 0) {
+        std::memcpy(out, tensor.data_ptr(), tensor.nbytes());
+      }
+      out += ring_align(tensor.nbytes());
+    }
+    tail->store(t + size, std::memory_order_release);
+    return true;
+  }
+
+  // Returns false if the ring is empty.
+  bool get(std::vector<at::Tensor>& tensors) {
+    uint64_t h = head->load(std::memory_order_relaxed);
+    const uint64_t t = tail->load(std::memory_order_acquire);
+    if (h == t) {
+      return false;
+    }
+    uint64_t offset = h % capacity;
+    if (*reinterpret_cast<uint64_t*>(data + offset) == kRingWrapMarker) {
+      h += capacity - offset;
+      offset = 0;
+    }
+
+    auto header = reinterpret_cast<const int64_t*>(data + offset);
+    const uint64_t size = *header++;
+    const int64_t num_tensors = *header++;
+    tensors.reserve(num_tensors);
+    for (int64_t i = 0; i < num_tensors; i++) {
+      const auto scalar_type = *header++;
+      TORCH_CHECK(
+          scalar_type >= 0 &&
+              scalar_type < static_cast<int64_t>(at::ScalarType::NumOptions),
+          "corrupted tensor ring record");
+      const auto dim = *header++;
+      tensors.push_back(at::empty(
+          at::IntArrayRef(header, dim),
+          at::TensorOptions().dtype(static_cast<at::ScalarType>(scalar_type))));
+      header += dim;
+    }
+    auto in = reinterpret_cast<const uint8_t*>(header);
+    in = data + offset + ring_align(in - (data + offset));
+    for (const auto& tensor : tensors) {
+      if (tensor.nbytes() > 0) {
+        std::memcpy(tensor.data_ptr(), in, tensor.nbytes());
+      }
+      in += ring_align(tensor.nbytes());
+    }
+    head->store(h + size, std::memory_order_release);
+    return true;
+  }
+
+  std::atomic<uint64_t>* head;
+  std::atomic<uint64_t>* tail;
+  uint8_t* data;
+  uint64_t capacity;
+};
+
+} // namespace
+
+// Copies a list of CPU tensors into a tensor ring, see NOTE [ Tensor rings ].
+// Returns False if they don't fit in its free space.
+static PyObject *THPModule_tensorRingPut(PyObject *module, PyObject *args) {
+  HANDLE_TH_ERRORS
+  if (PyTuple_GET_SIZE(args) != 2 ||
+      !THPVariable_Check(PyTuple_GET_ITEM(args, 0)) ||
+      !PyList_Check(PyTuple_GET_ITEM(args, 1))) {
+    throw torch::TypeError("_tensor_ring_put expects a tensor and a list of tensors.");
+  }
+  TensorRing ring(THPVariable_Unpack(PyTuple_GET_ITEM(args, 0)));
+  PyObject *list = PyTuple_GET_ITEM(args, 1);
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(PyList_GET_SIZE(list));
+  for (Py_ssize_t idx = 0; idx < PyList_GET_SIZE(list); idx++) {
+    PyObject *obj = PyList_GET_ITEM(list, idx);
+    if (!THPVariable_Check(obj)) {
+      throw torch::TypeError("_tensor_ring_put expects a list of tensors, but got %s.",
+          Py_TYPE(obj)->tp_name);
+    }
+    const auto& tensor = THPVariable_Unpack(obj);
+    TORCH_CHECK(
+        tensor.device().is_cpu() && tensor.layout() == at::kStrided &&
+            !tensor.is_quantized(),
+        "only dense CPU tensors can be put in a tensor ring");
+    tensors.push_back(tensor.contiguous());
+  }
+  bool success;
+  {
+    pybind11::gil_scoped_release no_gil;
+    success = ring.put(tensors);
+  }
+  if (success) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+  END_HANDLE_TH_ERRORS
+}
+
+// Copies the oldest list of tensors out of a tensor ring, see
+// NOTE [ Tensor rings ]. Returns None if the ring is empty.
+static PyObject *THPModule_tensorRingGet(PyObject *module, PyObject *buffer) {
+  HANDLE_TH_ERRORS
+  if (!THPVariable_Check(buffer)) {
+    throw torch::TypeError("_tensor_ring_get expects a tensor, but got %s.",
+        Py_TYPE(buffer)->tp_name);
+  }
+  TensorRing ring(THPVariable_Unpack(buffer));
+  std::vector<at::Tensor> tensors;
+  bool success;
+  {
+    pybind11::gil_scoped_release no_gil;
+    success = ring.get(tensors);
+  }
+  if (!success) {
+    Py_RETURN_NONE;
+  }
+  THPObjectPtr list(PyList_New(tensors.size()));
+  if (!list) throw python_error();
+  for (size_t idx = 0; idx < tensors.size(); idx++) {
+    PyObject *obj = THPVariable_Wrap(std::move(tensors[idx]));
+    if (!obj) throw python_error();
+    PyList_SET_ITEM(list.get(), idx, obj);
+  }
+  return list.release();
+  END_HANDLE_TH_ERRORS
+}
+
 PyMethodDef DataLoaderMethods[] = {
   {"_set_worker_signal_handlers",  (PyCFunction)THPModule_setWorkerSignalHandlers,  METH_NOARGS,   nullptr},
   {"_set_worker_pids",             (PyCFunction)THPModule_setWorkerPIDs,            METH_VARARGS,  nullptr},
   {"_remove_worker_pids",          (PyCFunction)THPModule_removeWorkerPIDs,         METH_O,        nullptr},
   {"_error_if_any_worker_fails",   (PyCFunction)THPModule_errorIfAnyWorkerFails,    METH_NOARGS,   nullptr},
+  {"_tensor_ring_put",             (PyCFunction)THPModule_tensorRingPut,            METH_VARARGS,  nullptr},
+  {"_tensor_ring_get",             (PyCFunction)THPModule_tensorRingGet,            METH_O,        nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
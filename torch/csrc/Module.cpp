@@ -40,6 +40,7 @@
 #include <torch/csrc/utils/tensor_memoryformats.h>
 #include <torch/csrc/utils/tensor_qschemes.h>
 #include <torch/csrc/utils/tensor_numpy.h>
+#include <torch/csrc/utils/python_arg_parser.h>
 #include <torch/csrc/utils/python_dispatch.h>
 #include <torch/csrc/jit/python/python_tracer.h>
 #include <torch/csrc/jit/python/init.h>
@@ -296,6 +297,19 @@ static PyObject *THPModule_getBackcompatBroadcastWarn(PyObject *module, PyObject
   else Py_RETURN_FALSE;
 }
 
+static PyObject *THPModule_setArgParserOverloadCache(PyObject *module, PyObject *arg) {
+  THPUtils_assert(PyBool_Check(arg), "set_arg_parser_overload_cache expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  torch::set_overload_cache_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+}
+
+static PyObject *THPModule_getArgParserOverloadCache(PyObject *module, PyObject *noargs)
+{
+  if (torch::overload_cache_enabled()) Py_RETURN_TRUE;
+  else Py_RETURN_FALSE;
+}
+
 static PyObject *THPModule_setBackcompatKeepdimWarn(PyObject *module, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "set_backcompat_keepdim_warn expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -440,6 +454,20 @@ PyObject *THPModule_deterministic(PyObject *_unused, PyObject *noargs)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setParallelCPURNG(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(PyBool_Check(arg), "set_parallel_cpu_rng expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setParallelCPURNG(arg == Py_True);
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_parallelCPURNG(PyObject *_unused, PyObject *noargs)
+{
+  if (at::globalContext().parallelCPURNG()) Py_RETURN_TRUE;
+  else Py_RETURN_FALSE;
+}
+
 PyObject *THPModule_setBenchmarkCuDNN(PyObject *_unused, PyObject *arg)
 {
   THPUtils_assert(PyBool_Check(arg), "set_benchmark_cudnn expects a bool, "
@@ -537,6 +565,8 @@ static PyMethodDef TorchMethods[] = {
   {"_parallel_info",    (PyCFunction)THPModule_parallelInfo, METH_NOARGS, nullptr},
   {"_set_backcompat_broadcast_warn", (PyCFunction)THPModule_setBackcompatBroadcastWarn, METH_O, nullptr},
   {"_get_backcompat_broadcast_warn", (PyCFunction)THPModule_getBackcompatBroadcastWarn, METH_NOARGS, nullptr},
+  {"_set_arg_parser_overload_cache", (PyCFunction)THPModule_setArgParserOverloadCache, METH_O, nullptr},
+  {"_get_arg_parser_overload_cache", (PyCFunction)THPModule_getArgParserOverloadCache, METH_NOARGS, nullptr},
   {"_set_backcompat_keepdim_warn", (PyCFunction)THPModule_setBackcompatKeepdimWarn, METH_O, nullptr},
   {"_get_backcompat_keepdim_warn", (PyCFunction)THPModule_getBackcompatKeepdimWarn, METH_NOARGS, nullptr},
   {"get_num_threads", (PyCFunction)THPModule_getNumThreads,     METH_NOARGS,  nullptr},
@@ -553,6 +583,8 @@ static PyMethodDef TorchMethods[] = {
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  nullptr},
   {"_get_deterministic", (PyCFunction)THPModule_deterministic, METH_NOARGS,     nullptr},
   {"_set_deterministic", (PyCFunction)THPModule_setDeterministic, METH_O,  nullptr},
+  {"_get_parallel_cpu_rng", (PyCFunction)THPModule_parallelCPURNG, METH_NOARGS,     nullptr},
+  {"_set_parallel_cpu_rng", (PyCFunction)THPModule_setParallelCPURNG, METH_O,  nullptr},
   {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       nullptr},
   {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_O,       nullptr},
   {"set_flush_denormal", (PyCFunction)THPModule_setFlushDenormal, METH_O,     nullptr},
@@ -580,6 +612,7 @@ bool THCPComplexFloatStorage_init(PyObject *module);
 
 void THCPStream_init(PyObject *module);
 void THCPEvent_init(PyObject *module);
+void THCPGraph_init(PyObject *module);
 
 #ifdef USE_CUDA
 PyMethodDef* THCPModule_methods();
@@ -716,6 +749,7 @@ PyObject* initModule() {
 
   THCPStream_init(module);
   THCPEvent_init(module);
+  THCPGraph_init(module);
 #endif
 
   auto set_module_attr = [&](const char* name, PyObject* v, bool incref = true) {
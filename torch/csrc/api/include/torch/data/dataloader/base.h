@@ -2,6 +2,7 @@
 
 #include <torch/data/dataloader_options.h>
 #include <torch/data/detail/data_shuttle.h>
+#include <torch/data/detail/device_transfer.h>
 #include <torch/data/detail/sequencers.h>
 #include <torch/data/iterator.h>
 #include <torch/data/samplers/random.h>
@@ -13,6 +14,7 @@
 
 #include <c10/util/Exception.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <memory>
@@ -37,6 +39,9 @@ class DataLoaderBase {
       std::unique_ptr<Dataset> main_thread_dataset = nullptr)
       : options_(std::move(options)),
         main_thread_dataset_(std::move(main_thread_dataset)),
+        // At most `max_jobs` jobs are in flight, and one `QuitWorker` per
+        // worker when joining.
+        shuttle_(std::max(options_.max_jobs, options_.workers)),
         sequencer_(new_sequencer()) {}
 
   virtual ~DataLoaderBase() {
@@ -91,6 +96,21 @@ class DataLoaderBase {
     joined_ = true;
   }
 
+  /// Makes the DataLoader copy batches to `device` ahead of their use, keeping
+  /// up to `depth` batches in flight. Batches are then returned on the device,
+  /// with their copy ordered before any work queued afterwards on the current
+  /// stream of the device. The copies run on a separate stream, so enable
+  /// `pin_memory` too for them to overlap with the computation. Must not be
+  /// called while iterating.
+  void prefetch_to_device(Device device, size_t depth = 2) {
+    TORCH_CHECK(
+        shuttle_.in_flight_jobs() == 0,
+        "Attempted to start prefetching to a device "
+        "while an iterator is not yet exhausted");
+    device_prefetcher_ =
+        torch::make_unique<detail::DevicePrefetcher<Batch>>(device, depth);
+  }
+
   /// Returns the options with which the DataLoader was configured.
   const FullDataLoaderOptions& options() const noexcept {
     return options_;
@@ -136,6 +156,9 @@ class DataLoaderBase {
   /// Resets the internal state of the DataLoader, optionally pre-fetching
   /// new jobs.
   virtual void reset() {
+    if (device_prefetcher_) {
+      device_prefetcher_->clear();
+    }
     shuttle_.drain();
     sequence_number_ = 0;
     sequencer_ = new_sequencer();
@@ -163,6 +186,25 @@ class DataLoaderBase {
   /// is exhausted. This operation will block until a batch is available if one
   /// is still expected.
   optional<BatchType> next() {
+    if (!device_prefetcher_) {
+      return next_loaded();
+    }
+    while (!device_prefetcher_->full()) {
+      optional<BatchType> batch = next_loaded();
+      if (!batch) {
+        break;
+      }
+      device_prefetcher_->push(std::move(*batch));
+    }
+    if (device_prefetcher_->empty()) {
+      return nullopt;
+    }
+    return device_prefetcher_->pop();
+  }
+
+  /// Returns the next batch as loaded from the dataset, before any copy to a
+  /// device.
+  optional<BatchType> next_loaded() {
     if (options_.workers > 0) {
       while (optional<Result> result = this->pop_result()) {
         if (result->exception) {
@@ -173,7 +215,12 @@ class DataLoaderBase {
         }
       }
     } else if (auto batch_request = get_batch_request()) {
-      return this->main_thread_dataset_->get_batch(std::move(*batch_request));
+      optional<BatchType> batch =
+          this->main_thread_dataset_->get_batch(std::move(*batch_request));
+      if (options_.pin_memory) {
+        detail::pin_batch(batch);
+      }
+      return batch;
     }
     return nullopt;
   }
@@ -187,6 +234,9 @@ class DataLoaderBase {
       }
       try {
         auto batch = dataset.get_batch(std::move(*job.batch_request));
+        if (options_.pin_memory) {
+          detail::pin_batch(batch);
+        }
         shuttle_.push_result({std::move(batch), job.sequence_number});
       } catch (...) {
         shuttle_.push_result({std::current_exception(), job.sequence_number});
@@ -239,6 +289,10 @@ class DataLoaderBase {
   /// The `Sequencer`, which handles optional ordering of batches.
   std::unique_ptr<detail::sequencers::Sequencer<Result>> sequencer_;
 
+  /// Copies batches to a device ahead of their use, if
+  /// `prefetch_to_device()` was called.
+  std::unique_ptr<detail::DevicePrefetcher<Batch>> device_prefetcher_;
+
   /// True if the DataLoader has joined its worker threads.
   bool joined_ = false;
 };
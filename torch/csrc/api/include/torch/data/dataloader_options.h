@@ -37,6 +37,11 @@ struct DataLoaderOptions {
   /// Whether to omit the last batch if it contains less than `batch_size`
   /// examples.
   TORCH_ARG(bool, drop_last) = false;
+
+  /// Whether to move the tensors of each batch into pinned (page-locked)
+  /// memory once it is loaded, so that copying it to a CUDA device can be
+  /// asynchronous. Requires CUDA.
+  TORCH_ARG(bool, pin_memory) = false;
 };
 
 /// Like `DataLoaderOptions`, but without any unconfigured state.
@@ -52,7 +57,8 @@ struct FullDataLoaderOptions {
         max_jobs(options.max_jobs().value_or(2 * workers)),
         timeout(options.timeout()),
         enforce_ordering(options.enforce_ordering()),
-        drop_last(options.drop_last()) {}
+        drop_last(options.drop_last()),
+        pin_memory(options.pin_memory()) {}
 
   size_t batch_size;
   size_t workers;
@@ -60,6 +66,7 @@ struct FullDataLoaderOptions {
   optional<std::chrono::milliseconds> timeout;
   bool enforce_ordering;
   bool drop_last;
+  bool pin_memory;
 };
 } // namespace data
 } // namespace torch
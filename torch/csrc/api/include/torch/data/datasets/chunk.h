@@ -3,8 +3,14 @@
 #include <torch/arg.h>
 #include <torch/csrc/utils/memory.h>
 #include <torch/data/datasets/stateful.h>
+#include <torch/data/example.h>
 #include <torch/data/samplers.h>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 #include <queue>
+#include <string>
 #include <thread>
 
 #include <torch/serialize.h>
@@ -37,12 +43,85 @@ class ChunkDataReader {
   virtual void reset() = 0;
 };
 
+/// Statistics of the preloading of a `ChunkDataset`, over the current epoch.
+struct ChunkDatasetStats {
+  /// The number of times, and the total time, `get_batch` waited for the
+  /// preloaders to provide data.
+  size_t stall_count = 0;
+  std::chrono::nanoseconds stall_time{0};
+
+  /// The number of chunks loaded, and the total time spent reading them.
+  size_t chunks_loaded = 0;
+  std::chrono::nanoseconds chunk_read_time{0};
+
+  /// The number of examples in the buffer and, if the buffer is bounded by
+  /// `ChunkDatasetOptions::cache_bytes`, their estimated size in bytes.
+  size_t buffered_examples = 0;
+  size_t buffered_bytes = 0;
+
+  /// The number of chunk reads currently allowed at a time, and the number
+  /// currently running.
+  size_t read_slots = 0;
+  size_t in_flight_reads = 0;
+};
+
 namespace detail {
+template <typename T>
+size_t approximate_bytes(const std::vector<T>& values);
+template <typename Data, typename Target>
+size_t approximate_bytes(const Example<Data, Target>& example);
+template <typename Data>
+size_t approximate_bytes(const Example<Data, example::NoTarget>& example);
+template <typename T>
+size_t approximate_bytes(const T& value);
+
+/// Estimates the memory held by an example, to enforce the memory budget set
+/// by `ChunkDatasetOptions::cache_bytes`. Tensors count their data, strings
+/// their characters, and `Example`s and vectors their elements. Anything else
+/// counts its size.
+inline size_t approximate_bytes(const Tensor& tensor) {
+  return tensor.defined() ? tensor.nbytes() : 0;
+}
+
+inline size_t approximate_bytes(const std::string& value) {
+  return sizeof(value) + value.size();
+}
+
+template <typename T>
+size_t approximate_bytes(const std::vector<T>& values) {
+  size_t bytes = sizeof(values);
+  for (const auto& value : values) {
+    bytes += approximate_bytes(value);
+  }
+  return bytes;
+}
+
+template <typename Data, typename Target>
+size_t approximate_bytes(const Example<Data, Target>& example) {
+  return approximate_bytes(example.data) + approximate_bytes(example.target);
+}
+
+template <typename Data>
+size_t approximate_bytes(const Example<Data, example::NoTarget>& example) {
+  return approximate_bytes(example.data);
+}
+
+template <typename T>
+size_t approximate_bytes(const T& value) {
+  return sizeof(value);
+}
+
 /// BatchDataBuffer manages a queue of UnwrappedBatchData. After a new chunk is
 /// loaded, BatchDataBuffer splits it into small batches and push them into the
 /// queue. When get_batch is called from data loader, it pops cached batches and
 /// return. If the cache is empty, it either waits to load more chunks or return
 /// null if all chunks are loaded.
+///
+/// The buffer also hands out the read slots that preloaders take before reading
+/// a chunk, and release once the chunk is in the queue. With adaptive
+/// preloading, the number of slots grows by one whenever `get_batch` has to
+/// wait for data, and shrinks by one whenever a chunk leaves the queue more
+/// than three quarters full.
 template <
     typename UnwrappedBatch,
     typename ExampleSampler = samplers::RandomSampler>
@@ -52,25 +131,50 @@ class BatchDataBuffer {
   using BatchType = torch::optional<UnwrappedBatchType>;
   using BatchRequestType = typename ExampleSampler::BatchRequestType;
 
+  /// Constructs a buffer that holds up to `queue_capacity` examples or, if
+  /// `queue_capacity_bytes` is positive, up to that many bytes of examples.
+  /// `max_read_slots` preloaders may read chunks at a time, and as few as
+  /// `min_read_slots` if `adaptive` is true.
   BatchDataBuffer(
       size_t batch_size,
       ExampleSampler& example_sampler,
-      size_t queue_capacity)
+      size_t queue_capacity,
+      size_t queue_capacity_bytes = 0,
+      size_t max_read_slots = std::numeric_limits<size_t>::max(),
+      size_t min_read_slots = 1,
+      bool adaptive = false)
       : batch_size_(batch_size),
         example_sampler_(example_sampler),
-        queue_capacity_(queue_capacity) {}
+        queue_capacity_(queue_capacity),
+        queue_capacity_bytes_(queue_capacity_bytes),
+        max_read_slots_(max_read_slots),
+        min_read_slots_(std::min(min_read_slots, max_read_slots)),
+        adaptive_(adaptive),
+        read_slots_(adaptive ? min_read_slots_ : max_read_slots) {}
 
   /// Return batch data from the queue. Called from the ChunkDataset main
   /// thread.
   BatchType get_batch() {
     std::unique_lock<std::mutex> lock(queue_mutex_);
-    cv_read_.wait(lock, [this] {
-      // wait till there is available data in the queue or if all chunks are
-      // loaded (i.e. the dataset is exhausted for this epoch)
+    // wait till there is available data in the queue or if all chunks are
+    // loaded (i.e. the dataset is exhausted for this epoch)
+    auto ready = [this] {
       return (
           this->total_example_count_in_queue_ >= batch_size_ ||
           this->stop_);
-    });
+    };
+    if (!ready()) {
+      // The preloaders did not keep up, so let one more of them read.
+      if (adaptive_ && read_slots_ < max_read_slots_) {
+        ++read_slots_;
+        cv_read_slot_.notify_one();
+      }
+      const auto start = std::chrono::steady_clock::now();
+      cv_read_.wait(lock, ready);
+      ++stats_.stall_count;
+      stats_.stall_time += std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start);
+    }
     if (batch_queue_.empty()) {
       AT_ASSERT(stop_);
       // All batches have been retrieved. Return an empty batch.
@@ -84,6 +188,7 @@ class BatchDataBuffer {
     }
 
     total_example_count_in_queue_ -= batch.batch_data.size();
+    total_bytes_in_queue_ -= batch.bytes;
     lock.unlock();
     cv_write_.notify_all();
 
@@ -96,8 +201,7 @@ class BatchDataBuffer {
     std::unique_lock<std::mutex> lock(queue_mutex_);
     cv_write_.wait(lock, [this] {
       // stop loading if we have preloaded enough data.
-      return this->total_example_count_in_queue_ < this->queue_capacity_ ||
-          this->stop_;
+      return this->has_room() || this->stop_;
     });
     if (stop_) {
       // When stop_ is true, it means no further chunk loading is necessary.
@@ -109,7 +213,7 @@ class BatchDataBuffer {
     auto remaining_size = data_size;
     example_sampler_.reset(data_size);
 
-    auto fill_batch = [&](size_t example_count, UnwrappedBatchType& batch) {
+    auto fill_batch = [&](size_t example_count, UnwrappedBatchData& batch) {
       auto batch_example_indices = this->example_sampler_.next(example_count);
       AT_ASSERT(
           batch_example_indices &&
@@ -117,7 +221,12 @@ class BatchDataBuffer {
       BatchRequestType& indices = batch_example_indices.value();
       for (size_t i : indices) {
         TORCH_CHECK(i < data_size, "Index out of range");
-        batch.emplace_back(std::move(data[i]));
+        if (queue_capacity_bytes_ > 0) {
+          const auto bytes = approximate_bytes(data[i]);
+          batch.bytes += bytes;
+          total_bytes_in_queue_ += bytes;
+        }
+        batch.batch_data.emplace_back(std::move(data[i]));
       }
       remaining_size -= example_count;
     };
@@ -130,23 +239,28 @@ class BatchDataBuffer {
       if (current_count < batch_size_) {
         auto example_count =
             std::min(remaining_size, batch_size_ - current_count);
-        fill_batch(example_count, batch.batch_data);
+        fill_batch(example_count, batch);
       }
     }
 
     // If we still have data remaining after filling the last pushed batch, add
     // them to the queue too.
     while (remaining_size > 0) {
-      UnwrappedBatchType current_batch;
+      UnwrappedBatchData current_batch{UnwrappedBatchType()};
 
       // Allocate the batch memory ahead of time.
-      current_batch.reserve(batch_size_);
+      current_batch.batch_data.reserve(batch_size_);
 
       auto example_count = std::min(remaining_size, batch_size_);
       fill_batch(example_count, current_batch);
       batch_queue_.emplace(std::move(current_batch));
     }
     total_example_count_in_queue_ += data_size;
+    ++stats_.chunks_loaded;
+    // The preloaders are ahead of the consumer, so let one fewer of them read.
+    if (adaptive_ && read_slots_ > min_read_slots_ && above_high_watermark()) {
+      --read_slots_;
+    }
     lock.unlock();
     cv_read_.notify_all();
   }
@@ -157,9 +271,7 @@ class BatchDataBuffer {
     std::unique_lock<std::mutex> lock(queue_mutex_);
     cv_write_.wait(lock, [this] {
       // stop loading if we have preloaded enough data.
-      return (
-        this->total_example_count_in_queue_ < this->queue_capacity_ ||
-        this->stop_);
+      return this->has_room() || this->stop_;
     });
     if (stop_){
       // When stop_ is true, it means this current thread needs to be tore down,
@@ -173,6 +285,49 @@ class BatchDataBuffer {
     cv_read_.notify_all();
   }
 
+  /// Blocks until a preloader may read a chunk. Returns false if the buffer
+  /// was stopped in the meantime. Called from the ChunkDataset worker threads.
+  bool acquire_read_slot() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    cv_read_slot_.wait(lock, [this] {
+      return this->in_flight_reads_ < this->read_slots_ || this->stop_;
+    });
+    if (stop_) {
+      return false;
+    }
+    ++in_flight_reads_;
+    return true;
+  }
+
+  /// Gives back a read slot taken with `acquire_read_slot`. Called from the
+  /// ChunkDataset worker threads.
+  void release_read_slot() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      AT_ASSERT(in_flight_reads_ > 0);
+      --in_flight_reads_;
+    }
+    cv_read_slot_.notify_one();
+  }
+
+  /// Accounts for the time a preloader spent in `read_chunk`. Called from the
+  /// ChunkDataset worker threads.
+  void record_chunk_read(std::chrono::nanoseconds duration) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stats_.chunk_read_time += duration;
+  }
+
+  /// Returns the statistics of this buffer so far.
+  ChunkDatasetStats stats() {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    ChunkDatasetStats stats = stats_;
+    stats.buffered_examples = total_example_count_in_queue_;
+    stats.buffered_bytes = total_bytes_in_queue_;
+    stats.read_slots = read_slots_;
+    stats.in_flight_reads = in_flight_reads_;
+    return stats;
+  }
+
   void stop(){
     {
       // Hold the lock before changing stop_ to prevent a race condition which can
@@ -194,7 +349,28 @@ class BatchDataBuffer {
     cv_write_.notify_all();
     // notify all readers too.
     cv_read_.notify_all();
+    // and the preloaders waiting for a read slot.
+    cv_read_slot_.notify_all();
+  }
+
+  /// Returns true if the queue can take another chunk. Called with the lock
+  /// held.
+  bool has_room() const {
+    if (queue_capacity_bytes_ > 0) {
+      return total_bytes_in_queue_ < queue_capacity_bytes_;
+    }
+    return total_example_count_in_queue_ < queue_capacity_;
   }
+
+  /// Returns true if the queue is more than three quarters full. Called with
+  /// the lock held.
+  bool above_high_watermark() const {
+    if (queue_capacity_bytes_ > 0) {
+      return total_bytes_in_queue_ > queue_capacity_bytes_ / 4 * 3;
+    }
+    return total_example_count_in_queue_ > queue_capacity_ / 4 * 3;
+  }
+
   /// The batch size is needed to create batches from the chunk data. Similar to
   /// regular dataloader where the batches are created with prefetches,
   /// BatchDataBuffer perform the batch creation using the provided batch size.
@@ -203,6 +379,10 @@ class BatchDataBuffer {
   /// count of total example stored in the queue
   size_t total_example_count_in_queue_ = 0;
 
+  /// estimated bytes of the examples stored in the queue, only counted when
+  /// the queue capacity is in bytes.
+  size_t total_bytes_in_queue_ = 0;
+
   /// struct that contains a raw unwrapped batch unit. An unwrapped batch unit is
   /// the raw data without 'optional' wrapper. It can be a collection of images,
   /// utterances, e.t.c.
@@ -214,6 +394,10 @@ class BatchDataBuffer {
     /// batch data to return
     UnwrappedBatchType batch_data;
 
+    /// estimated bytes of batch_data, only counted when the queue capacity is
+    /// in bytes.
+    size_t bytes = 0;
+
     /// exception pointer which captures any abnormal exceptions while creating the
     /// batch.
     std::exception_ptr exception;
@@ -227,12 +411,29 @@ class BatchDataBuffer {
 
   std::condition_variable cv_read_;
   std::condition_variable cv_write_;
+  std::condition_variable cv_read_slot_;
 
   ExampleSampler& example_sampler_;
 
   // configurable maximun number of elements the queue can hold at one time.
   size_t queue_capacity_;
 
+  // configurable maximum number of bytes the queue can hold at one time, which
+  // replaces queue_capacity_ if positive.
+  size_t queue_capacity_bytes_;
+
+  // the bounds of read_slots_, and whether it adapts between them.
+  size_t max_read_slots_;
+  size_t min_read_slots_;
+  bool adaptive_;
+
+  // the number of preloaders that may currently read a chunk, and the number
+  // that do.
+  size_t read_slots_;
+  size_t in_flight_reads_ = 0;
+
+  ChunkDatasetStats stats_;
+
   // When set to true, it wakes the writer threads from the wait and exit current
   // function call. This is needed when ChunkDataSet.Reset is called while the
   // previous epoch is not exhausted yet. When ChunkDataset is waiting its
@@ -282,6 +483,22 @@ struct ChunkDatasetOptions {
   /// The capacity of the queue for batch caching.
   TORCH_ARG(size_t, cache_size) = 2048;
 
+  /// If positive, the capacity in bytes of the queue for batch caching, which
+  /// replaces `cache_size`. The size of examples is estimated as described
+  /// for `detail::approximate_bytes`.
+  TORCH_ARG(size_t, cache_bytes) = 0;
+
+  /// Whether to adapt the number of chunks read at a time to the rate at which
+  /// batches are consumed. Preloading then starts with
+  /// `min_preloader_count` chunk reads at a time. One more read is allowed
+  /// whenever `get_batch` has to wait for data, and one fewer whenever the
+  /// cache is more than three quarters full, up to `preloader_count` and down
+  /// to `min_preloader_count`.
+  TORCH_ARG(bool, adaptive_preloading) = false;
+
+  /// The least number of chunks read at a time with `adaptive_preloading`.
+  TORCH_ARG(size_t, min_preloader_count) = 1;
+
   // The number of chunks to perfrom cross-chunk shuffling. Default to 1 meaning
   // no cross-chunk shuffling. When it is equal to n (n > 1), n random
   // chunks will be loaded at once and example shuffling will be performed
@@ -332,7 +549,12 @@ class ChunkDataset final
         preprocessing_policy_(preprocessing_policy),
         quit_worker_(false),
         running_preloaders_(0),
-        load_checkpoint_(false) {}
+        load_checkpoint_(false) {
+    TORCH_CHECK(
+        options_.min_preloader_count() > 0 &&
+            options_.min_preloader_count() <= options_.preloader_count(),
+        "min_preloader_count must be positive and at most preloader_count.");
+  }
 
   virtual ~ChunkDataset() {
     // stop batch buffer first.
@@ -387,7 +609,11 @@ class ChunkDataset final
         detail::BatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>(
         options_.batch_size(),
         example_sampler_,
-        options_.cache_size());
+        options_.cache_size(),
+        options_.cache_bytes(),
+        options_.preloader_count(),
+        options_.min_preloader_count(),
+        options_.adaptive_preloading());
 
     // create new workers for this new epoch.
     quit_worker_ = false;
@@ -404,6 +630,15 @@ class ChunkDataset final
     return torch::nullopt;
   }
 
+  /// Returns the statistics of the preloading during the current epoch, which
+  /// help tune `preloader_count`, `cache_size` and `cache_bytes`.
+  ChunkDatasetStats stats() const {
+    TORCH_CHECK(
+        batch_buffer_ != nullptr,
+        "Dataset needs to call reset() before calling stats().");
+    return batch_buffer_->stats();
+  }
+
   // provide a references to chunk sampler. Used mainly in distributed data
   // loading to set the epoch number for the sampler.
   ChunkSamplerType& chunk_sampler() {
@@ -425,6 +660,10 @@ class ChunkDataset final
   /// running on worker thread to preload chunk data.
   void preloader(size_t id) {
     while (!quit_worker_.load()) {
+      if (!batch_buffer_->acquire_read_slot()) {
+        break;
+      }
+      bool exhausted = false;
       try {
         std::vector<size_t> chunk_idx;
         {
@@ -432,24 +671,36 @@ class ChunkDataset final
           if (auto chunk_sampler_result = chunk_sampler_.next(this->options_.cross_chunk_shuffle_count())) {
             chunk_idx = chunk_sampler_result.value();
           } else {
-            break;
+            exhausted = true;
           }
         }
-        UnwrappedBatchType data = chunk_reader_.read_chunk(chunk_idx[0]);
-        for (size_t i = 1; i < chunk_idx.size(); ++i) {
-          auto chunk_data = chunk_reader_.read_chunk(chunk_idx[i]);
-          std::move(
-              chunk_data.begin(), chunk_data.end(), std::back_inserter(data));
-        }
-        if (preprocessing_policy_) {
-          preprocessing_policy_(data);
-        }
-        if (!data.empty()) { // skip empty chunks.
-          batch_buffer_->add_chunk_data(std::move(data));
+        if (!exhausted) {
+          const auto start = std::chrono::steady_clock::now();
+          UnwrappedBatchType data = chunk_reader_.read_chunk(chunk_idx[0]);
+          for (size_t i = 1; i < chunk_idx.size(); ++i) {
+            auto chunk_data = chunk_reader_.read_chunk(chunk_idx[i]);
+            std::move(
+                chunk_data.begin(), chunk_data.end(), std::back_inserter(data));
+          }
+          batch_buffer_->record_chunk_read(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start));
+          if (preprocessing_policy_) {
+            preprocessing_policy_(data);
+          }
+          if (!data.empty()) { // skip empty chunks.
+            batch_buffer_->add_chunk_data(std::move(data));
+          }
         }
       } catch (...) {
         batch_buffer_->add_chunk_data(std::current_exception());
       }
+      // The slot is held until the chunk is in the queue, so that chunks
+      // waiting for room count against the number of reads too.
+      batch_buffer_->release_read_slot();
+      if (exhausted) {
+        break;
+      }
     }
     AT_ASSERT(running_preloaders_.load() > 0);
     --running_preloaders_;
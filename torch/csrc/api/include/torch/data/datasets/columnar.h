@@ -0,0 +1,95 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <c10/util/ArrayRef.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A column of a `ColumnarDataset`, or of one of its batches.
+///
+/// The rows of a fixed-width column are the slices of `values` along its first
+/// dimension, and `offsets` is undefined. The rows of a variable-length column
+/// are concatenated along the first dimension of `values`, and `offsets` is a
+/// 1-D `int64` tensor of `rows + 1` elements: row `i` is the slice
+/// `[offsets[i], offsets[i + 1])` of `values`.
+struct TORCH_API ColumnarColumn {
+  std::string name;
+  Tensor values;
+  Tensor offsets;
+
+  /// Returns true if the rows of the column have varying lengths.
+  bool is_variable_length() const noexcept {
+    return offsets.defined();
+  }
+};
+
+/// A dataset over a memory-mapped file in a simple columnar format, as written
+/// by `ColumnarDataset::write()`.
+///
+/// The file holds a header describing the columns, followed by the data of
+/// each column, 64-byte aligned. A fixed-width column stores its `values`
+/// contiguously. A variable-length column stores its `values` and then its
+/// `offsets`, which start at zero. The file is mapped copy-on-write, so the
+/// tensors of a batch may be written to without modifying it.
+///
+/// `get_batch()` returns a `ColumnarColumn` per column of the dataset. When the
+/// requested indices are consecutive, as from a `SequentialSampler`, the
+/// `values` of each column are views of the mapped file. Otherwise, the rows
+/// are gathered into new tensors.
+///
+/// The dataset can be used with a `DistributedRandomSampler`, which picks rows
+/// from all over the file. Alternatively, `shard()` splits the rows into
+/// contiguous ranges, one per replica, so that each replica only touches its
+/// part of the file when sampling with a local `RandomSampler`.
+class TORCH_API ColumnarDataset
+    : public BatchDataset<ColumnarDataset, std::vector<ColumnarColumn>> {
+ public:
+  /// Maps the columnar dataset stored at `path`.
+  explicit ColumnarDataset(const std::string& path);
+
+  /// Returns the rows at `indices` of each column.
+  std::vector<ColumnarColumn> get_batch(ArrayRef<size_t> indices) override;
+
+  /// Returns the number of rows of the dataset.
+  optional<size_t> size() const override;
+
+  /// Returns the columns of the dataset, whose `values` and `offsets` are views
+  /// of the mapped file. The `offsets` of a variable-length column do not
+  /// start at zero if the dataset is a shard.
+  const std::vector<ColumnarColumn>& columns() const noexcept;
+
+  /// Returns the index of the column called `name`.
+  size_t column_index(const std::string& name) const;
+
+  /// Returns the dataset made of the `shard_index`-th of `num_shards`
+  /// contiguous, (nearly) equal ranges of rows. The shard shares the mapping of
+  /// this dataset.
+  ColumnarDataset shard(size_t num_shards, size_t shard_index) const;
+
+  /// Writes `columns` to `path` in the format that `ColumnarDataset` reads.
+  /// Every column must have the same number of rows, and the `offsets` of
+  /// variable-length columns must start at zero.
+  static void write(
+      const std::string& path,
+      const std::vector<ColumnarColumn>& columns);
+
+ private:
+  ColumnarDataset(std::vector<ColumnarColumn> columns, size_t rows);
+
+  std::vector<ColumnarColumn> columns_;
+  size_t rows_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <c10/core/Event.h>
+#include <c10/core/Stream.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// Calls `function` on every tensor of a batch, which may replace the tensor
+/// it is given. Batches are tensors, `Example`s and `std::vector`s or
+/// `optional`s of them; anything else is left alone.
+template <typename Function>
+void for_each_tensor(Tensor& tensor, Function& function);
+template <typename Data, typename Target, typename Function>
+void for_each_tensor(Example<Data, Target>& example, Function& function);
+template <typename Data, typename Function>
+void for_each_tensor(
+    Example<Data, example::NoTarget>& example,
+    Function& function);
+template <typename T, typename Function>
+void for_each_tensor(std::vector<T>& values, Function& function);
+template <typename T, typename Function>
+void for_each_tensor(optional<T>& value, Function& function);
+template <typename T, typename Function>
+void for_each_tensor(T& value, Function& function);
+
+template <typename Function>
+void for_each_tensor(Tensor& tensor, Function& function) {
+  if (tensor.defined()) {
+    function(tensor);
+  }
+}
+
+template <typename Data, typename Target, typename Function>
+void for_each_tensor(Example<Data, Target>& example, Function& function) {
+  for_each_tensor(example.data, function);
+  for_each_tensor(example.target, function);
+}
+
+template <typename Data, typename Function>
+void for_each_tensor(
+    Example<Data, example::NoTarget>& example,
+    Function& function) {
+  for_each_tensor(example.data, function);
+}
+
+template <typename T, typename Function>
+void for_each_tensor(std::vector<T>& values, Function& function) {
+  for (auto& value : values) {
+    for_each_tensor(value, function);
+  }
+}
+
+template <typename T, typename Function>
+void for_each_tensor(optional<T>& value, Function& function) {
+  if (value) {
+    for_each_tensor(*value, function);
+  }
+}
+
+template <typename T, typename Function>
+void for_each_tensor(T& value, Function& function) {}
+
+/// Moves the CPU tensors of `batch` into pinned memory. The pinned buffers come
+/// from the caching host allocator, which reuses them once the copies reading
+/// from them have completed.
+template <typename Batch>
+void pin_batch(Batch& batch) {
+  auto pin = [](Tensor& tensor) {
+    if (tensor.device().is_cpu() && !tensor.is_pinned()) {
+      tensor = tensor.pin_memory();
+    }
+  };
+  for_each_tensor(batch, pin);
+}
+
+/// Copies batches to a device ahead of their use. Each copy is issued on a
+/// stream of its own, taken from the device's stream pool, and is followed by
+/// an event that the stream popping the batch waits on. In the meantime, the
+/// current stream of the device is free to run the computation on earlier
+/// batches. The copies only overlap with that computation if the batches are
+/// in pinned memory.
+template <typename Batch>
+class DevicePrefetcher {
+ public:
+  DevicePrefetcher(Device device, size_t depth)
+      : guard_impl_(device.type()),
+        device_(device.has_index() ? device : guard_impl_.getDevice()),
+        depth_(depth),
+        copy_stream_(guard_impl_.getStreamFromGlobalPool(device_)) {
+    TORCH_CHECK(depth_ > 0, "Device prefetching depth must be positive");
+  }
+
+  ~DevicePrefetcher() {
+    clear();
+  }
+
+  /// The device batches are copied to.
+  Device device() const noexcept {
+    return device_;
+  }
+
+  /// True if `depth` batches are being copied, or have been, and not popped.
+  bool full() const noexcept {
+    return in_flight_.size() >= depth_;
+  }
+
+  bool empty() const noexcept {
+    return in_flight_.empty();
+  }
+
+  /// Starts copying `batch` to the device.
+  void push(Batch batch) {
+    // The copies are allocated on the current stream, which uses them, so
+    // that the caching allocator does not hand their memory out to it again
+    // before it is done with them.
+    std::vector<Tensor> sources;
+    std::vector<Tensor> destinations;
+    auto allocate = [&](Tensor& tensor) {
+      sources.push_back(tensor);
+      tensor = torch::empty_like(tensor, tensor.options().device(device_));
+      destinations.push_back(tensor);
+    };
+    for_each_tensor(batch, allocate);
+    const Stream compute_stream = guard_impl_.getStream(device_);
+    // The memory may have been in use by work still queued on the current
+    // stream.
+    c10::Event allocated(device_.type());
+    allocated.record(compute_stream);
+    allocated.block(copy_stream_);
+    c10::Event copied(device_.type());
+    {
+      c10::StreamGuard stream_guard(copy_stream_);
+      for (size_t i = 0; i < sources.size(); ++i) {
+        destinations[i].copy_(sources[i], /*non_blocking=*/true);
+      }
+      copied.record(copy_stream_);
+    }
+    in_flight_.push_back({std::move(batch), std::move(copied)});
+  }
+
+  /// Returns the oldest batch. Work queued on the current stream of the device
+  /// from now on runs after its copy has completed.
+  Batch pop() {
+    TORCH_INTERNAL_ASSERT(!in_flight_.empty());
+    InFlight in_flight = std::move(in_flight_.front());
+    in_flight_.pop_front();
+    in_flight.copied.block(guard_impl_.getStream(device_));
+    return std::move(in_flight.batch);
+  }
+
+  /// Drops the batches that have not been popped.
+  void clear() {
+    // The memory of a dropped batch goes back to the current stream, which
+    // must not reuse it while the copy stream writes to it.
+    while (!in_flight_.empty()) {
+      pop();
+    }
+  }
+
+ private:
+  struct InFlight {
+    Batch batch;
+    c10::Event copied;
+  };
+
+  c10::impl::VirtualGuardImpl guard_impl_;
+  Device device_;
+  size_t depth_;
+  Stream copy_stream_;
+  std::deque<InFlight> in_flight_;
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
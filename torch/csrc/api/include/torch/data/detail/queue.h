@@ -4,11 +4,15 @@
 
 #include <c10/util/Exception.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <thread>
 
 namespace torch {
 namespace data {
@@ -79,6 +83,208 @@ class Queue {
   std::mutex mutex_;
   std::condition_variable cv_;
 };
+
+/// A bounded, lock-free MPMC queue with a blocking fallback.
+///
+/// Values live in a ring buffer of slots, each of which carries a sequence
+/// number telling a producer or consumer at a given position whether the slot
+/// is ready for it (as in Dmitry Vyukov's bounded MPMC queue). Producers and
+/// consumers therefore only contend on a compare-and-swap of the tail or head
+/// of the ring. A `push()` to a full queue or a `pop()` from an empty one spins
+/// briefly and then sleeps on a condition variable, which the other side only
+/// takes the mutex to signal if a thread is asleep on it.
+///
+/// Like `Queue`, this is written for the `DataLoader`, which never has more
+/// than `max_jobs` jobs or results in flight and sizes its queues accordingly.
+template <typename T>
+class BoundedQueue {
+ public:
+  /// Constructs a queue holding at least `capacity` values. The capacity is
+  /// rounded up to a power of two, and to no less than two: with a single
+  /// slot, a full slot and a free one would have the same sequence number.
+  explicit BoundedQueue(size_t capacity)
+      : capacity_(round_up_to_power_of_two(std::max<size_t>(capacity, 2))),
+        slots_(new Slot[capacity_]) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /// Returns the number of values the queue can hold.
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+  /// Pushes a new value to the back of the `BoundedQueue`, blocking while the
+  /// queue is full.
+  void push(T value) {
+    wait_until(
+        [this, &value] { return this->try_push(value); },
+        waiting_producers_,
+        not_full_,
+        /*timeout=*/nullopt);
+    notify(waiting_consumers_, not_empty_);
+  }
+
+  /// Blocks until at least one element is ready to be popped from the front of
+  /// the queue. An optional `timeout` in seconds can be used to limit the time
+  /// spent waiting for an element. If the wait times out, an exception is
+  /// raised.
+  T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
+    optional<T> value;
+    const bool popped = wait_until(
+        [this, &value] { return this->try_pop(value); },
+        waiting_consumers_,
+        not_empty_,
+        timeout);
+    if (!popped) {
+      // clang-format off
+      AT_ERROR(
+          "Timeout in DataLoader queue while waiting for next batch"
+          " (timeout was ", timeout->count(), " ms)");
+      // clang-format on
+    }
+    notify(waiting_producers_, not_full_);
+    return std::move(*value);
+  }
+
+  /// Empties the queue and returns the number of elements that were popped.
+  /// Only producers blocked on a full queue are notified about this event.
+  size_t clear() {
+    size_t size = 0;
+    optional<T> value;
+    while (try_pop(value)) {
+      value.reset();
+      ++size;
+    }
+    if (size > 0) {
+      notify(waiting_producers_, not_full_);
+    }
+    return size;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    optional<T> value;
+  };
+
+  /// The number of times a thread retries before it goes to sleep.
+  static constexpr size_t kSpinCount = 64;
+
+  static size_t round_up_to_power_of_two(size_t n) {
+    size_t power = 1;
+    while (power < n) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+  /// Moves `value` into the queue and returns true, unless the queue is full.
+  bool try_push(T& value) {
+    size_t position = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position & (capacity_ - 1)];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      // The slot is free for this position once the consumer of the previous
+      // lap has advanced its sequence number to `position`.
+      if (sequence == position) {
+        if (tail_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Moves the front of the queue into `value` and returns true, unless the
+  /// queue is empty.
+  bool try_pop(optional<T>& value) {
+    size_t position = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position & (capacity_ - 1)];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence == position + 1) {
+        if (head_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(slot.value);
+          slot.value.reset();
+          slot.sequence.store(position + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position + 1) {
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Retries `attempt` until it succeeds or the `timeout` expires, sleeping on
+  /// `condition` after a few retries.
+  template <typename Attempt>
+  bool wait_until(
+      Attempt attempt,
+      std::atomic<size_t>& waiting,
+      std::condition_variable& condition,
+      optional<std::chrono::milliseconds> timeout) {
+    for (size_t spin = 0; spin < kSpinCount; ++spin) {
+      if (attempt()) {
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting.fetch_add(1);
+    // Pairs with the fence in `notify()`: either the other side sees this
+    // thread waiting, or the attempt below sees the other side's update.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool succeeded = true;
+    if (timeout) {
+      succeeded = condition.wait_for(lock, *timeout, attempt);
+    } else {
+      condition.wait(lock, attempt);
+    }
+    waiting.fetch_sub(1);
+    return succeeded;
+  }
+
+  /// Wakes up a thread sleeping on `condition`, if there is one.
+  void notify(
+      std::atomic<size_t>& waiting,
+      std::condition_variable& condition) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) > 0) {
+      // Taking the mutex makes sure a thread that is about to sleep is not
+      // missed between its last attempt and the wait.
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      condition.notify_one();
+    }
+  }
+
+  /// Pads the ends of the ring apart, so that producers and consumers do not
+  /// invalidate each other's cache lines.
+  static constexpr size_t kCacheLineSize = 64;
+
+  const size_t capacity_;
+  const std::unique_ptr<Slot[]> slots_;
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> tail_{0};
+  char pad1_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> head_{0};
+  char pad2_[kCacheLineSize - sizeof(std::atomic<size_t>)];
+  std::mutex mutex_;
+  std::atomic<size_t> waiting_producers_{0};
+  std::atomic<size_t> waiting_consumers_{0};
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
 } // namespace detail
 } // namespace data
 } // namespace torch
@@ -2,7 +2,6 @@
 
 #include <torch/types.h>
 
-#include <algorithm>
 #include <cstddef>
 #include <vector>
 
@@ -10,15 +9,6 @@ namespace torch {
 namespace data {
 namespace detail {
 namespace sequencers {
-namespace detail {
-template<typename Result>
-bool buffer_contains_result(const std::vector<optional<Result>>& buffer) {
-  return std::any_of(
-      buffer.begin(), buffer.end(), [](const optional<Result>& result) {
-        return result.has_value();
-      });
-}
-} // namespace detail
 
 /// A `Sequencer` accepts a function that yields the next result of a
 /// `DataLoader` and then has the opportunity to influence the order in which
@@ -59,6 +49,11 @@ struct NoSequencer final : public Sequencer<Result> {
 /// means no new jobs can be scheduled in the `DataLoader` in the meantime,
 /// which enforces that as long as sqn `s` has not been received, `s + m` (which
 /// would cause a collision in the fixed-size buffer) will not yet be scheduled.
+///
+/// The buffer is a reorder ring: the slot of sqn `s` is tracked as
+/// `next_slot_`, and a result with sqn `s + k` is stashed `k` slots after it,
+/// so no division is needed to find a slot. The number of stashed results is
+/// counted too, which makes the end of an epoch cheap to check.
 template <typename Result>
 struct OrderedSequencer : public Sequencer<Result> {
   using typename Sequencer<Result>::ResultProducer;
@@ -70,27 +65,37 @@ struct OrderedSequencer : public Sequencer<Result> {
   /// Buffers results until the next one in the expected order is received.
   optional<Result> next(ResultProducer next_result) override {
     // If we already have the result for the next sqn, return it.
-    if (auto& maybe_result = buffer(next_sequence_number_)) {
-      auto result = std::move(*maybe_result);
-      buffer(next_sequence_number_++).reset();
+    auto& stashed = buffer_[next_slot_];
+    if (stashed) {
+      optional<Result> result = std::move(stashed);
+      stashed.reset();
+      --buffered_results_;
+      advance();
       return result;
     }
     // Otherwise wait for the next result.
     while (true) {
       auto result = next_result();
       if (!result) {
-        AT_ASSERT(!detail::buffer_contains_result(buffer_));
+        AT_ASSERT(buffered_results_ == 0);
         break;
       }
       // If it was not nullopt and the sequence numbers match, return it
       // directly and bump the sequence number.
       if (result->sequence_number == next_sequence_number_) {
-        ++next_sequence_number_;
+        advance();
         return result;
       }
       // Stash the result for later.
-      AT_ASSERT(!buffer(result->sequence_number).has_value());
-      buffer(result->sequence_number) = std::move(result);
+      const size_t offset = result->sequence_number - next_sequence_number_;
+      AT_ASSERT(offset < buffer_.size());
+      size_t slot = next_slot_ + offset;
+      if (slot >= buffer_.size()) {
+        slot -= buffer_.size();
+      }
+      AT_ASSERT(!buffer_[slot].has_value());
+      buffer_[slot] = std::move(result);
+      ++buffered_results_;
     }
     // The result was an empty optional, so we are done with this epoch.
     return nullopt;
@@ -101,9 +106,24 @@ struct OrderedSequencer : public Sequencer<Result> {
     return buffer_.at(index % buffer_.size());
   }
 
+  /// Moves on to the next sequence number and its slot.
+  void advance() {
+    ++next_sequence_number_;
+    if (++next_slot_ == buffer_.size()) {
+      next_slot_ = 0;
+    }
+  }
+
   /// The monotonically increasing sequence number we expect.
   size_t next_sequence_number_ = 0;
 
+  /// The slot of `next_sequence_number_`, i.e. that number modulo the buffer
+  /// size.
+  size_t next_slot_ = 0;
+
+  /// The number of results stashed in the buffer.
+  size_t buffered_results_ = 0;
+
   /// A fixed-size buffer (after construction).
   std::vector<optional<Result>> buffer_;
 };
@@ -14,37 +14,28 @@ inline double clip_grad_norm_(
     std::vector<Tensor> parameters,
     double max_norm,
     double norm_type = 2.0) {
-  std::vector<Tensor> params_with_grad;
-
+  std::vector<Tensor> grads;
   for (const auto& param : parameters) {
     auto& grad = param.grad();
     if (grad.defined()) {
-      params_with_grad.push_back(param);
+      grads.push_back(grad.data());
     }
   }
-  double total_norm = 0.0;
-  if (norm_type == std::numeric_limits<double>::infinity()) {
-    for (const auto& param : params_with_grad) {
-      auto param_max = param.grad().data().abs().max().item().toDouble();
-      if (param_max > total_norm) {
-        total_norm = param_max;
-      }
-    }
-  } else {
-    for (const auto& param : params_with_grad) {
-      auto param_norm = param.grad().data().norm(norm_type);
-      total_norm += std::pow(param_norm.item().toDouble(), norm_type);
-    }
-    total_norm = std::pow(total_norm, 1.0 / norm_type);
+  if (grads.empty()) {
+    return 0.0;
   }
 
-  auto clip_coef = max_norm / (total_norm + 1e-6);
-  if (clip_coef < 1) {
-    for (auto& param : params_with_grad) {
-      param.grad().data().mul_(clip_coef);
-    }
+  // The norms and the clip coefficient stay on the device until the total
+  // norm is returned, so that there is a single sync.
+  const auto device = grads[0].device();
+  std::vector<Tensor> norms = at::_foreach_norm(grads, norm_type);
+  for (auto& norm : norms) {
+    norm = norm.to(device, torch::kDouble);
   }
-  return total_norm;
+  Tensor total_norm = torch::stack(norms).norm(norm_type);
+  Tensor clip_coef = (max_norm / (total_norm + 1e-6)).clamp_max(1.0);
+  at::_foreach_mul_(grads, clip_coef);
+  return total_norm.item().toDouble();
 }
 
 // A wrapper around clip_grad_norm_ that allows us to call the function with a
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/nn/modules/activation.h>
+#include <torch/nn/modules/batchnorm.h>
+#include <torch/nn/modules/container/functional.h>
+#include <torch/nn/modules/container/sequential.h>
+#include <torch/nn/modules/conv.h>
+#include <torch/nn/modules/linear.h>
+#include <torch/types.h>
+#include <torch/utils.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace nn {
+namespace utils {
+
+// Returns the weight and bias of a convolution or linear layer of weight
+// `weight` and bias `bias` (optional), followed by a batch norm evaluated with
+// the running statistics `running_mean` and `running_var` and the affine
+// parameters `bn_weight` and `bn_bias` (optional).
+inline std::pair<Tensor, Tensor> fold_batch_norm_weights(
+    const Tensor& weight,
+    const Tensor& bias,
+    const Tensor& running_mean,
+    const Tensor& running_var,
+    const Tensor& bn_weight,
+    const Tensor& bn_bias,
+    double eps) {
+  NoGradGuard no_grad;
+  Tensor scale = torch::rsqrt(running_var + eps);
+  if (bn_weight.defined()) {
+    scale = scale * bn_weight;
+  }
+  std::vector<int64_t> shape(weight.dim(), 1);
+  shape[0] = -1;
+  Tensor folded_weight = weight * scale.reshape(shape);
+  Tensor folded_bias = (bias.defined() ? bias - running_mean : -running_mean) * scale;
+  if (bn_bias.defined()) {
+    folded_bias = folded_bias + bn_bias;
+  }
+  return {folded_weight, folded_bias};
+}
+
+// Parameters of a batch norm layer evaluated with its running statistics
+struct _BatchNormParams {
+  Tensor weight;
+  Tensor bias;
+  Tensor running_mean;
+  Tensor running_var;
+  double eps;
+};
+
+template <typename BatchNorm>
+inline bool _eval_batch_norm_params_of(const Module& module, _BatchNormParams& params) {
+  const auto* bn = module.as<BatchNorm>();
+  if (!bn || bn->is_training() || !bn->options.track_running_stats()) {
+    return false;
+  }
+  params = {bn->weight, bn->bias, bn->running_mean, bn->running_var, bn->options.eps()};
+  return true;
+}
+
+inline bool _eval_batch_norm_params(const Module& module, _BatchNormParams& params) {
+  return _eval_batch_norm_params_of<BatchNorm1dImpl>(module, params) ||
+      _eval_batch_norm_params_of<BatchNorm2dImpl>(module, params) ||
+      _eval_batch_norm_params_of<BatchNorm3dImpl>(module, params);
+}
+
+template <size_t D>
+inline ConvOptions<D> _folded_options(const detail::ConvNdOptions<D>& options) {
+  return ConvOptions<D>(options.in_channels(), options.out_channels(), options.kernel_size())
+      .stride(options.stride())
+      .padding(options.padding())
+      .dilation(options.dilation())
+      .groups(options.groups())
+      .bias(true)
+      .padding_mode(options.padding_mode());
+}
+
+inline LinearOptions _folded_options(const LinearOptions& options) {
+  return LinearOptions(options).bias(true);
+}
+
+// Returns a copy of `layer`, a convolution or linear layer, with `bn` folded
+// into its weight and bias.
+template <typename Layer>
+inline AnyModule _fold_batch_norm(const Layer& layer, const _BatchNormParams& bn) {
+  Tensor weight, bias;
+  std::tie(weight, bias) = fold_batch_norm_weights(
+      layer.weight, layer.bias, bn.running_mean, bn.running_var, bn.weight, bn.bias, bn.eps);
+  auto folded = std::make_shared<Layer>(_folded_options(layer.options));
+  folded->to(weight.device(), weight.scalar_type());
+  NoGradGuard no_grad;
+  folded->weight.copy_(weight);
+  folded->bias.copy_(bias);
+  folded->eval();
+  return AnyModule(std::move(folded));
+}
+
+// Returns the copy of `module` with `bn` folded in if it is a convolution or
+// linear layer with as many outputs as `bn` has features, else an empty
+// `AnyModule`.
+inline AnyModule _fold_batch_norm(const Module& module, const _BatchNormParams& bn) {
+  const int64_t features = bn.running_mean.numel();
+  if (const auto* linear = module.as<LinearImpl>()) {
+    if (linear->options.out_features() == features) {
+      return _fold_batch_norm(*linear, bn);
+    }
+  } else if (const auto* conv1d = module.as<Conv1dImpl>()) {
+    if (conv1d->options.out_channels() == features) {
+      return _fold_batch_norm(*conv1d, bn);
+    }
+  } else if (const auto* conv2d = module.as<Conv2dImpl>()) {
+    if (conv2d->options.out_channels() == features) {
+      return _fold_batch_norm(*conv2d, bn);
+    }
+  } else if (const auto* conv3d = module.as<Conv3dImpl>()) {
+    if (conv3d->options.out_channels() == features) {
+      return _fold_batch_norm(*conv3d, bn);
+    }
+  }
+  return AnyModule();
+}
+
+// Returns a version of `sequential`, which must be in evaluation mode, for
+// inference:
+// - Every convolution or linear layer followed by a batch norm layer that
+//   uses its running statistics is replaced by a copy with the batch norm
+//   folded into its weight and bias.
+// - Every other such batch norm layer followed by a ReLU is replaced by a
+//   module applying both in a single pass.
+// The other modules are shared with `sequential`.
+inline Sequential optimize_for_inference(const Sequential& sequential) {
+  TORCH_CHECK(
+      !sequential->is_training(),
+      "optimize_for_inference() expects a module in evaluation mode, call eval() first");
+  const std::vector<AnyModule> modules(sequential->begin(), sequential->end());
+  Sequential optimized;
+  for (size_t i = 0; i < modules.size(); i++) {
+    _BatchNormParams bn;
+    if (i + 1 < modules.size() && _eval_batch_norm_params(*modules[i + 1].ptr(), bn)) {
+      AnyModule folded = _fold_batch_norm(*modules[i].ptr(), bn);
+      if (!folded.is_empty()) {
+        optimized->push_back(std::move(folded));
+        i++;
+        continue;
+      }
+    }
+    if (i + 1 < modules.size() && _eval_batch_norm_params(*modules[i].ptr(), bn) &&
+        modules[i + 1].ptr()->as<ReLUImpl>()) {
+      optimized->push_back(Functional([bn](Tensor input) {
+        return torch::_batch_norm_relu(
+            input, bn.weight, bn.bias, bn.running_mean, bn.running_var, bn.eps);
+      }));
+      i++;
+      continue;
+    }
+    optimized->push_back(modules[i]);
+  }
+  optimized->eval();
+  return optimized;
+}
+
+} // namespace utils
+} // namespace nn
+} // namespace torch
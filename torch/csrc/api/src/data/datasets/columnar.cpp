@@ -0,0 +1,468 @@
+#include <torch/data/datasets/columnar.h>
+
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <caffe2/serialize/mmap_file_adapter.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+// The file starts with the magic, the version, the number of rows and the
+// number of columns, each in 8 bytes. Then, for each column, come the size of
+// its name and the name, its scalar type, whether it is variable-length, the
+// number of dimensions of its values and their sizes, the position of its
+// values and that of its offsets (zero for fixed-width columns), each integer
+// in 8 bytes. All integers are little-endian.
+constexpr char kMagic[8] = {'P', 'T', 'C', 'O', 'L', 'U', 'M', 'N'};
+constexpr uint64_t kVersion = 1;
+constexpr uint64_t kAlignment = 64;
+
+bool check_is_little_endian() {
+  const uint32_t word = 1;
+  return reinterpret_cast<const uint8_t*>(&word)[0] == 1;
+}
+
+uint64_t align(uint64_t position) {
+  return (position + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint64_t number_of_bytes(IntArrayRef sizes, ScalarType dtype) {
+  uint64_t bytes = c10::elementSize(dtype);
+  for (const auto size : sizes) {
+    TORCH_CHECK(
+        size >= 0 &&
+            (size == 0 ||
+             bytes <= std::numeric_limits<uint64_t>::max() / size),
+        "Invalid size ",
+        size,
+        " in columnar dataset");
+    bytes *= static_cast<uint64_t>(size);
+  }
+  return bytes;
+}
+
+/// Reads the fields of the header one after the other.
+class HeaderReader {
+ public:
+  explicit HeaderReader(const caffe2::serialize::ReadAdapterInterface& reader)
+      : reader_(reader), size_(reader.size()) {}
+
+  void read_bytes(void* buffer, size_t n) {
+    TORCH_CHECK(
+        n <= size_ - position_, "Unexpected end of columnar dataset header");
+    reader_.read(position_, buffer, n, "reading columnar dataset header");
+    position_ += n;
+  }
+
+  template <typename T>
+  T read() {
+    T value;
+    read_bytes(&value, sizeof value);
+    return value;
+  }
+
+  std::string read_string() {
+    std::string value(read<uint64_t>(), '\0');
+    read_bytes(&value[0], value.size());
+    return value;
+  }
+
+ private:
+  const caffe2::serialize::ReadAdapterInterface& reader_;
+  const uint64_t size_;
+  uint64_t position_ = 0;
+};
+
+/// Returns a tensor whose data is the mapped file at `position`.
+Tensor map_tensor(
+    const caffe2::serialize::MmapFileAdapter& reader,
+    uint64_t position,
+    IntArrayRef sizes,
+    ScalarType dtype) {
+  TORCH_CHECK(
+      position % kAlignment == 0,
+      "Misaligned column in columnar dataset, at position ",
+      position);
+  // The DataPtr holds a reference to the mapping, which therefore lives as
+  // long as the tensor or any view of it.
+  auto data = std::make_shared<at::DataPtr>(
+      reader.aliasData(position, number_of_bytes(sizes, dtype)));
+  return torch::from_blob(
+      data->get(), sizes, [data](void*) {}, torch::dtype(dtype));
+}
+
+/// Returns the number of bytes of an element along the first dimension of
+/// `values`.
+size_t row_element_bytes(const Tensor& values) {
+  size_t bytes = values.element_size();
+  for (int64_t d = 1; d < values.dim(); ++d) {
+    bytes *= values.size(d);
+  }
+  return bytes;
+}
+
+std::vector<int64_t> sizes_with_length(const Tensor& values, int64_t length) {
+  auto sizes = values.sizes().vec();
+  sizes[0] = length;
+  return sizes;
+}
+
+void check_offsets(
+    const ColumnarColumn& column,
+    size_t rows,
+    const std::string& what) {
+  TORCH_CHECK(
+      column.offsets.dim() == 1 && column.offsets.scalar_type() == kLong &&
+          static_cast<size_t>(column.offsets.numel()) == rows + 1,
+      "The offsets of column '",
+      column.name,
+      "' ",
+      what,
+      " must be an int64 tensor of ",
+      rows + 1,
+      " elements");
+  const auto offsets = column.offsets.contiguous();
+  const int64_t* data = offsets.data_ptr<int64_t>();
+  TORCH_CHECK(
+      data[0] == 0 && data[rows] == column.values.size(0),
+      "The offsets of column '",
+      column.name,
+      "' ",
+      what,
+      " must start at zero and end at the length of its values");
+  for (size_t i = 0; i < rows; ++i) {
+    TORCH_CHECK(
+        data[i] <= data[i + 1],
+        "The offsets of column '",
+        column.name,
+        "' ",
+        what,
+        " must be non-decreasing");
+  }
+}
+
+template <typename T>
+void write_value(std::ofstream& stream, T value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+void write_padding(std::ofstream& stream, uint64_t& position) {
+  static const char kZeros[kAlignment] = {};
+  const uint64_t aligned = align(position);
+  stream.write(kZeros, aligned - position);
+  position = aligned;
+}
+
+void write_data(
+    std::ofstream& stream,
+    const Tensor& tensor,
+    uint64_t& position) {
+  stream.write(static_cast<const char*>(tensor.data_ptr()), tensor.nbytes());
+  position += tensor.nbytes();
+  write_padding(stream, position);
+}
+} // namespace
+
+ColumnarDataset::ColumnarDataset(const std::string& path) {
+  static const bool is_little_endian = check_is_little_endian();
+  TORCH_CHECK(
+      is_little_endian,
+      "ColumnarDataset is only supported on little-endian hosts");
+  caffe2::serialize::MmapFileAdapter reader(path);
+  HeaderReader header(reader);
+
+  char magic[sizeof kMagic];
+  header.read_bytes(magic, sizeof magic);
+  TORCH_CHECK(
+      std::memcmp(magic, kMagic, sizeof kMagic) == 0,
+      "File at ",
+      path,
+      " is not a columnar dataset");
+  const auto version = header.read<uint64_t>();
+  TORCH_CHECK(
+      version == kVersion,
+      "Unsupported columnar dataset version ",
+      version,
+      " (expected ",
+      kVersion,
+      ")");
+  rows_ = header.read<uint64_t>();
+  const auto num_columns = header.read<uint64_t>();
+
+  for (uint64_t c = 0; c < num_columns; ++c) {
+    ColumnarColumn column;
+    column.name = header.read_string();
+    const auto dtype = header.read<int64_t>();
+    TORCH_CHECK(
+        dtype >= 0 && dtype < static_cast<int64_t>(ScalarType::Undefined),
+        "Invalid scalar type ",
+        dtype,
+        " of column '",
+        column.name,
+        "'");
+    const bool is_variable_length = header.read<uint64_t>() != 0;
+    const auto dim = header.read<uint64_t>();
+    TORCH_CHECK(
+        dim >= 1 && dim <= 64,
+        "Invalid number of dimensions ",
+        dim,
+        " of column '",
+        column.name,
+        "'");
+    std::vector<int64_t> sizes(dim);
+    for (auto& size : sizes) {
+      size = header.read<int64_t>();
+    }
+    const auto values_position = header.read<uint64_t>();
+    const auto offsets_position = header.read<uint64_t>();
+
+    column.values = map_tensor(
+        reader, values_position, sizes, static_cast<ScalarType>(dtype));
+    if (is_variable_length) {
+      column.offsets = map_tensor(
+          reader, offsets_position, {static_cast<int64_t>(rows_) + 1}, kLong);
+      check_offsets(column, rows_, "in the file");
+    } else {
+      TORCH_CHECK(
+          static_cast<uint64_t>(sizes[0]) == rows_,
+          "Column '",
+          column.name,
+          "' has ",
+          sizes[0],
+          " rows, but the dataset has ",
+          rows_);
+    }
+    columns_.push_back(std::move(column));
+  }
+}
+
+ColumnarDataset::ColumnarDataset(
+    std::vector<ColumnarColumn> columns,
+    size_t rows)
+    : columns_(std::move(columns)), rows_(rows) {}
+
+std::vector<ColumnarColumn> ColumnarDataset::get_batch(
+    ArrayRef<size_t> indices) {
+  const auto n = static_cast<int64_t>(indices.size());
+  bool consecutive = true;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    TORCH_CHECK(
+        indices[i] < rows_,
+        "Index ",
+        indices[i],
+        " is out of range for a columnar dataset of ",
+        rows_,
+        " rows");
+    consecutive = consecutive && indices[i] == indices[0] + i;
+  }
+  const auto first =
+      indices.empty() ? int64_t(0) : static_cast<int64_t>(indices[0]);
+
+  // The indices as a tensor, to gather the rows of fixed-width columns.
+  Tensor index;
+  std::vector<ColumnarColumn> batch;
+  batch.reserve(columns_.size());
+  for (const auto& column : columns_) {
+    ColumnarColumn rows;
+    rows.name = column.name;
+    if (!column.is_variable_length()) {
+      if (consecutive) {
+        rows.values = column.values.narrow(0, first, n);
+      } else {
+        if (!index.defined()) {
+          index = torch::empty({n}, kLong);
+          std::copy(
+              indices.begin(), indices.end(), index.data_ptr<int64_t>());
+        }
+        rows.values = column.values.index_select(0, index);
+      }
+    } else {
+      const int64_t* offsets = column.offsets.data_ptr<int64_t>();
+      if (consecutive) {
+        const int64_t begin = offsets[first];
+        rows.values =
+            column.values.narrow(0, begin, offsets[first + n] - begin);
+        rows.offsets = column.offsets.narrow(0, first, n + 1) - begin;
+      } else {
+        rows.offsets = torch::empty({n + 1}, kLong);
+        int64_t* row_offsets = rows.offsets.data_ptr<int64_t>();
+        row_offsets[0] = 0;
+        for (int64_t i = 0; i < n; ++i) {
+          const auto row = indices[i];
+          row_offsets[i + 1] =
+              row_offsets[i] + offsets[row + 1] - offsets[row];
+        }
+        rows.values = torch::empty(
+            sizes_with_length(column.values, row_offsets[n]),
+            column.values.options());
+        const size_t element_bytes = row_element_bytes(column.values);
+        const char* source = static_cast<const char*>(column.values.data_ptr());
+        char* destination = static_cast<char*>(rows.values.data_ptr());
+        for (int64_t i = 0; i < n; ++i) {
+          const auto row = indices[i];
+          std::memcpy(
+              destination + row_offsets[i] * element_bytes,
+              source + offsets[row] * element_bytes,
+              (offsets[row + 1] - offsets[row]) * element_bytes);
+        }
+      }
+    }
+    batch.push_back(std::move(rows));
+  }
+  return batch;
+}
+
+optional<size_t> ColumnarDataset::size() const {
+  return rows_;
+}
+
+const std::vector<ColumnarColumn>& ColumnarDataset::columns() const noexcept {
+  return columns_;
+}
+
+size_t ColumnarDataset::column_index(const std::string& name) const {
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].name == name) {
+      return i;
+    }
+  }
+  AT_ERROR("No column named '", name, "' in columnar dataset");
+}
+
+ColumnarDataset ColumnarDataset::shard(size_t num_shards, size_t shard_index)
+    const {
+  TORCH_CHECK(
+      shard_index < num_shards,
+      "Invalid shard ",
+      shard_index,
+      " of ",
+      num_shards);
+  const size_t shard_size = (rows_ + num_shards - 1) / num_shards;
+  const auto begin = std::min(rows_, shard_index * shard_size);
+  const auto end = std::min(rows_, begin + shard_size);
+  const auto rows = static_cast<int64_t>(end - begin);
+  std::vector<ColumnarColumn> columns;
+  columns.reserve(columns_.size());
+  for (const auto& column : columns_) {
+    ColumnarColumn shard_column;
+    shard_column.name = column.name;
+    if (column.is_variable_length()) {
+      // The offsets keep pointing into all of the values.
+      shard_column.values = column.values;
+      shard_column.offsets = column.offsets.narrow(0, begin, rows + 1);
+    } else {
+      shard_column.values = column.values.narrow(0, begin, rows);
+    }
+    columns.push_back(std::move(shard_column));
+  }
+  return ColumnarDataset(std::move(columns), end - begin);
+}
+
+void ColumnarDataset::write(
+    const std::string& path,
+    const std::vector<ColumnarColumn>& columns) {
+  static const bool is_little_endian = check_is_little_endian();
+  TORCH_CHECK(
+      is_little_endian,
+      "ColumnarDataset is only supported on little-endian hosts");
+
+  std::vector<Tensor> values;
+  std::vector<Tensor> offsets;
+  size_t rows = 0;
+  uint64_t header_size = sizeof kMagic + 3 * sizeof(uint64_t);
+  for (size_t c = 0; c < columns.size(); ++c) {
+    const auto& column = columns[c];
+    TORCH_CHECK(
+        column.values.defined() && column.values.dim() >= 1,
+        "The values of column '",
+        column.name,
+        "' must have at least one dimension");
+    TORCH_CHECK(
+        !column.is_variable_length() || column.offsets.numel() >= 1,
+        "The offsets of column '",
+        column.name,
+        "' must not be empty");
+    const size_t column_rows = column.is_variable_length()
+        ? column.offsets.numel() - 1
+        : column.values.size(0);
+    if (c == 0) {
+      rows = column_rows;
+    }
+    TORCH_CHECK(
+        column_rows == rows,
+        "Column '",
+        column.name,
+        "' has ",
+        column_rows,
+        " rows, but column '",
+        columns[0].name,
+        "' has ",
+        rows);
+    if (column.is_variable_length()) {
+      check_offsets(column, rows, "to write");
+    }
+    values.push_back(column.values.cpu().contiguous());
+    offsets.push_back(
+        column.is_variable_length() ? column.offsets.cpu().contiguous()
+                                    : Tensor());
+    header_size += column.name.size() + (6 + column.values.dim()) * 8;
+  }
+
+  // Lay the data of the columns out after the header.
+  std::vector<uint64_t> values_positions;
+  std::vector<uint64_t> offsets_positions;
+  uint64_t position = align(header_size);
+  for (size_t c = 0; c < columns.size(); ++c) {
+    values_positions.push_back(position);
+    position = align(position + values[c].nbytes());
+    offsets_positions.push_back(offsets[c].defined() ? position : 0);
+    if (offsets[c].defined()) {
+      position = align(position + offsets[c].nbytes());
+    }
+  }
+
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  TORCH_CHECK(stream, "Error opening columnar dataset file at ", path);
+  stream.write(kMagic, sizeof kMagic);
+  write_value<uint64_t>(stream, kVersion);
+  write_value<uint64_t>(stream, rows);
+  write_value<uint64_t>(stream, columns.size());
+  for (size_t c = 0; c < columns.size(); ++c) {
+    write_value<uint64_t>(stream, columns[c].name.size());
+    stream.write(columns[c].name.data(), columns[c].name.size());
+    write_value<int64_t>(stream, static_cast<int64_t>(values[c].scalar_type()));
+    write_value<uint64_t>(stream, offsets[c].defined());
+    write_value<uint64_t>(stream, values[c].dim());
+    for (const auto size : values[c].sizes()) {
+      write_value<int64_t>(stream, size);
+    }
+    write_value<uint64_t>(stream, values_positions[c]);
+    write_value<uint64_t>(stream, offsets_positions[c]);
+  }
+  position = header_size;
+  write_padding(stream, position);
+  for (size_t c = 0; c < columns.size(); ++c) {
+    write_data(stream, values[c], position);
+    if (offsets[c].defined()) {
+      write_data(stream, offsets[c], position);
+    }
+  }
+  stream.close();
+  TORCH_CHECK(stream, "Error writing columnar dataset file at ", path);
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -8,6 +8,8 @@
 #include <ATen/ATen.h>
 
 #include <functional>
+#include <map>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -63,6 +65,10 @@ Tensor Adagrad::step(LossClosure closure) {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdagradOptions&>(group.options());
+    // Dense gradients are updated with the _foreach_* ops, a list at a time,
+    // grouped by step since the learning rate depends on it.
+    std::map<int64_t, std::vector<Tensor>> dense_params_by_step;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -70,40 +76,56 @@ Tensor Adagrad::step(LossClosure closure) {
       auto grad = p.grad();
       TORCH_INTERNAL_ASSERT(state_[c10::guts::to_string(p.unsafeGetTensorImpl())] != nullptr, "state found NULL for the Tensor ", p);
       auto& state = static_cast<AdagradParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
-      auto& options = static_cast<AdagradOptions&>(group.options());
 
       state.step(state.step() + 1);
 
-      if (options.weight_decay() != 0) {
-        TORCH_CHECK(!p.grad().is_sparse(), "weight_decay option is not compatible with sparse gradients");
-        grad = grad.add(p, options.weight_decay());
+      if (!grad.is_sparse()) {
+        dense_params_by_step[state.step()].push_back(p);
+        continue;
       }
+
+      TORCH_CHECK(options.weight_decay() == 0, "weight_decay option is not compatible with sparse gradients");
       const auto clr = options.lr() /
           (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
 
-      if (grad.is_sparse()) {
-        grad = grad.coalesce();
-        auto grad_indices = grad._indices();
-        auto grad_values = grad._values();
-        auto size = grad.sizes();
-
-        auto make_sparse = [&] (const Tensor& values) -> Tensor {
-          if (grad_indices.dim() == 0 || values.dim() == 0) {
-            return torch::empty({0}, grad.options()).resize_as_(grad);
-          }
-          return torch::sparse_coo_tensor(grad_indices, values, size, grad.options());
-        };
-        state.sum(state.sum().add_(make_sparse(grad_values.pow(2))));
-        auto std = state.sum().sparse_mask(grad);
-        const auto std_values = std._values().sqrt_().add_(options.eps());
-
-        p.add_(make_sparse(grad_values / std_values), -clr);
+      grad = grad.coalesce();
+      auto grad_indices = grad._indices();
+      auto grad_values = grad._values();
+      auto size = grad.sizes();
+
+      auto make_sparse = [&] (const Tensor& values) -> Tensor {
+        if (grad_indices.dim() == 0 || values.dim() == 0) {
+          return torch::empty({0}, grad.options()).resize_as_(grad);
+        }
+        return torch::sparse_coo_tensor(grad_indices, values, size, grad.options());
+      };
+      state.sum(state.sum().add_(make_sparse(grad_values.pow(2))));
+      auto std = state.sum().sparse_mask(grad);
+      const auto std_values = std._values().sqrt_().add_(options.eps());
+
+      p.add_(make_sparse(grad_values / std_values), -clr);
+    }
+
+    for (auto& entry : dense_params_by_step) {
+      const auto step = entry.first;
+      auto& params = entry.second;
+      std::vector<Tensor> grads;
+      std::vector<Tensor> state_sums;
+      for (auto& p : params) {
+        grads.push_back(p.grad());
+        state_sums.push_back(static_cast<AdagradParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]).sum());
       }
-      else {
-        state.sum(state.sum().addcmul_(grad, grad, 1.0));
-        const auto std = state.sum().sqrt().add_(options.eps());
-        p.addcdiv_(grad, std, -clr);
+
+      if (options.weight_decay() != 0) {
+        grads = at::_foreach_add(grads, params, options.weight_decay());
       }
+      const auto clr = options.lr() /
+          (1 + static_cast<double>(step - 1) * options.lr_decay());
+
+      at::_foreach_addcmul_(state_sums, grads, grads, 1.0);
+      auto std = at::_foreach_sqrt(state_sums);
+      at::_foreach_add_(std, options.eps());
+      at::_foreach_addcdiv_(params, grads, std, -clr);
     }
   }
   return loss;
@@ -9,6 +9,8 @@
 
 #include <cmath>
 #include <functional>
+#include <map>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -69,14 +71,19 @@ Tensor Adam::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdamOptions&>(group.options());
+    auto beta1 = std::get<0>(options.betas());
+    auto beta2 = std::get<1>(options.betas());
+
+    // The parameters are updated with the _foreach_* ops, a list at a time,
+    // grouped by step since the bias corrections depend on it.
+    std::map<int64_t, std::vector<Tensor>> params_by_step;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
-      auto grad = p.grad();
-      TORCH_CHECK(!grad.is_sparse(), "Adam does not support sparse gradients"/*, please consider SparseAdam instead*/);
+      TORCH_CHECK(!p.grad().is_sparse(), "Adam does not support sparse gradients"/*, please consider SparseAdam instead*/);
       auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-      auto& options = static_cast<AdamOptions&>(group.options());
 
       // State initialization
       if(param_state == state_.end()) {
@@ -94,37 +101,56 @@ Tensor Adam::step(LossClosure closure)  {
       }
 
       auto& state = static_cast<AdamParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
-      auto& exp_avg = state.exp_avg();
-      auto& exp_avg_sq = state.exp_avg_sq();
-      auto& max_exp_avg_sq = state.max_exp_avg_sq();
-
       state.step(state.step()+1);
-      auto beta1 = std::get<0>(options.betas());
-      auto beta2 = std::get<1>(options.betas());
+      params_by_step[state.step()].push_back(p);
+    }
+
+    for (auto& entry : params_by_step) {
+      const auto step = entry.first;
+      auto& params = entry.second;
+      std::vector<Tensor> grads;
+      std::vector<Tensor> exp_avgs;
+      std::vector<Tensor> exp_avg_sqs;
+      std::vector<Tensor> max_exp_avg_sqs;
+      for (auto& p : params) {
+        auto& state = static_cast<AdamParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
+        grads.push_back(p.grad());
+        exp_avgs.push_back(state.exp_avg());
+        exp_avg_sqs.push_back(state.exp_avg_sq());
+        if(options.amsgrad()) {
+          max_exp_avg_sqs.push_back(state.max_exp_avg_sq());
+        }
+      }
 
-      auto bias_correction1 = 1 - std::pow(beta1, state.step());
-      auto bias_correction2 = 1 - std::pow(beta2, state.step());
+      auto bias_correction1 = 1 - std::pow(beta1, step);
+      auto bias_correction2 = 1 - std::pow(beta2, step);
 
       if(options.weight_decay() != 0) {
-        grad = grad.add(p, options.weight_decay());
+        grads = at::_foreach_add(grads, params, options.weight_decay());
       }
 
       // Decay the first and second moment running average coefficient
-      exp_avg.mul_(beta1).add_(grad, 1 - beta1);
-      exp_avg_sq.mul_(beta2).addcmul_(grad, grad, 1 - beta2);
+      at::_foreach_mul_(exp_avgs, beta1);
+      at::_foreach_add_(exp_avgs, grads, 1 - beta1);
+      at::_foreach_mul_(exp_avg_sqs, beta2);
+      at::_foreach_addcmul_(exp_avg_sqs, grads, grads, 1 - beta2);
 
-      Tensor denom;
+      std::vector<Tensor> denom;
       if(options.amsgrad()) {
         // Maintains the maximum of all 2nd moment running avg. till now
-        torch::max_out(max_exp_avg_sq, exp_avg_sq, max_exp_avg_sq);
+        for (size_t i = 0; i < max_exp_avg_sqs.size(); i++) {
+          torch::max_out(max_exp_avg_sqs[i], exp_avg_sqs[i], max_exp_avg_sqs[i]);
+        }
         // Use the max. for normalizing running avg. of gradient
-        denom = (max_exp_avg_sq.sqrt() / sqrt(bias_correction2)).add_(options.eps());
+        denom = at::_foreach_sqrt(max_exp_avg_sqs);
       } else {
-        denom = (exp_avg_sq.sqrt() / sqrt(bias_correction2)).add_(options.eps());
+        denom = at::_foreach_sqrt(exp_avg_sqs);
       }
+      at::_foreach_div_(denom, sqrt(bias_correction2));
+      at::_foreach_add_(denom, options.eps());
 
       auto step_size = options.lr() / bias_correction1;
-      p.addcdiv_(exp_avg, denom, -step_size);
+      at::_foreach_addcdiv_(params, exp_avgs, denom, -step_size);
     }
   }
   return loss;
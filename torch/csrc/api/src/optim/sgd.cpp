@@ -10,6 +10,7 @@
 #include <ATen/ATen.h>
 
 #include <functional>
+#include <vector>
 
 namespace torch {
 namespace optim {
@@ -66,10 +67,23 @@ Tensor SGD::step(LossClosure closure)  {
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
 
+    // The update of dense gradients is applied to all the parameters of the
+    // group at once, with the _foreach_* ops, which launch a few kernels for
+    // the whole list instead of a few kernels per parameter. They have no
+    // sparse kernels, so sparse gradients are applied one parameter at a time.
+    std::vector<Tensor> params_with_grad;
+    std::vector<Tensor> params;
+    std::vector<Tensor> grads;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
+      if (!p.grad().is_sparse()) {
+        params_with_grad.push_back(p);
+        params.push_back(p.data());
+        grads.push_back(p.grad().data());
+        continue;
+      }
       auto d_p = p.grad().data();
       if (weight_decay != 0) {
         d_p = d_p.add(p.data(), weight_decay);
@@ -94,6 +108,44 @@ Tensor SGD::step(LossClosure closure)  {
       }
       p.data().add_(d_p, -1 * options.lr());
     }
+    if (params.empty()) {
+      continue;
+    }
+    if (weight_decay != 0) {
+      grads = at::_foreach_add(grads, params, weight_decay);
+    }
+    if (momentum != 0) {
+      std::vector<Tensor> bufs;
+      std::vector<Tensor> old_bufs;
+      std::vector<Tensor> old_bufs_grads;
+      bufs.reserve(params.size());
+      for (size_t i = 0; i < params.size(); i++) {
+        const auto key = c10::guts::to_string(params_with_grad[i].unsafeGetTensorImpl());
+        Tensor buf;
+        auto param_state = state_.find(key);
+        if(param_state == state_.end()) {
+          buf = torch::clone(grads[i]).detach();
+          auto state = std::make_unique<SGDParamState>();
+          state->momentum_buffer(buf);
+          state_[key] = std::move(state);
+        } else {
+          buf = static_cast<SGDParamState&>(*param_state->second).momentum_buffer();
+          old_bufs.push_back(buf);
+          old_bufs_grads.push_back(grads[i]);
+        }
+        bufs.push_back(buf);
+      }
+      if (!old_bufs.empty()) {
+        at::_foreach_mul_(old_bufs, momentum);
+        at::_foreach_add_(old_bufs, old_bufs_grads, 1 - dampening);
+      }
+      if (nesterov) {
+        grads = at::_foreach_add(grads, bufs, momentum);
+      } else {
+        grads = bufs;
+      }
+    }
+    at::_foreach_add_(params, grads, -1 * options.lr());
   }
   return loss;
 }
@@ -84,10 +84,26 @@ inline void rebase_history(std::vector<Variable>&& vars, std::shared_ptr<Node> g
   }
 }
 
+// The version counters of inference tensors are not bumped in inference mode,
+// so they can't be updated in-place outside of it.  See at::InferenceMode.
+inline void check_not_inference(const Tensor& t) {
+  TORCH_CHECK(!t.defined() || !t.is_inference(),
+    "Inplace update to inference tensor outside InferenceMode is not allowed. "
+    "You can make a clone to get a normal tensor before doing inplace update.");
+}
+
 inline void increment_version(Tensor & t) {
+  check_not_inference(t);
   impl::bump_version(t);
 }
 
+inline void increment_version(TensorList tensors) {
+  for (const auto& t : tensors) {
+    check_not_inference(t);
+    impl::bump_version(t);
+  }
+}
+
 struct Flatten : IterArgs<Flatten> {
   Flatten(variable_list& out) : out(out) {}
   variable_list& out;
@@ -141,6 +157,10 @@ inline Tensor as_view(const Tensor & base, Tensor tensor, bool is_differentiable
     }
     base_var = base_var._base();
   }
+  // Views of inference tensors are inference tensors
+  if (base.is_inference()) {
+    tensor.unsafeGetTensorImpl()->set_inference(true);
+  }
   if (is_differentiable) {
     return make_variable_differentiable_view(std::move(base_var), std::move(tensor), creation_meta, std::move(view_func));
   } else {
@@ -158,6 +178,9 @@ inline std::vector<Tensor> as_view(const Tensor & base, std::vector<Tensor> tens
     base_var = base_var._base();
   }
   for(Tensor &tensor : tensors) {
+    if (base.is_inference()) {
+      tensor.unsafeGetTensorImpl()->set_inference(true);
+    }
     if (is_differentiable) {
       tensor = make_variable_differentiable_view(base_var, std::move(tensor), creation_meta);
     } else {
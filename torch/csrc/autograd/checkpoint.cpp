@@ -0,0 +1,237 @@
+#include <torch/csrc/autograd/checkpoint.h>
+
+#include <torch/csrc/autograd/grad_mode.h>
+#include <torch/csrc/autograd/saved_variable.h>
+
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace torch { namespace autograd {
+
+namespace {
+
+// Clones of the default generators a region ran with, and the generators
+// themselves.
+struct RngState {
+  at::Generator cpu;
+  std::vector<std::pair<at::Generator, at::Generator>> cuda;
+};
+
+RngState get_rng_state(const variable_list& inputs) {
+  RngState state;
+  at::Generator cpu_gen = at::detail::getDefaultCPUGenerator();
+  {
+    std::lock_guard<std::mutex> lock(cpu_gen.mutex());
+    state.cpu = cpu_gen.clone();
+  }
+  std::set<at::DeviceIndex> devices;
+  for (const auto& input : inputs) {
+    if (input.defined() && input.is_cuda()) {
+      devices.insert(input.get_device());
+    }
+  }
+  for (const auto device : devices) {
+    at::Generator gen = at::detail::getCUDAHooks().getDefaultCUDAGenerator(device);
+    std::lock_guard<std::mutex> lock(gen.mutex());
+    state.cuda.emplace_back(gen, gen.clone());
+  }
+  return state;
+}
+
+void set_rng_state(const RngState& state) {
+  at::Generator cpu_gen = at::detail::getDefaultCPUGenerator();
+  {
+    auto* src = state.cpu.get<at::CPUGeneratorImpl>();
+    auto* dst = cpu_gen.get<at::CPUGeneratorImpl>();
+    std::lock_guard<std::mutex> lock(cpu_gen.mutex());
+    dst->set_engine(src->engine());
+    dst->set_next_float_normal_sample(src->next_float_normal_sample());
+    dst->set_next_double_normal_sample(src->next_double_normal_sample());
+  }
+  for (const auto& gen : state.cuda) {
+    at::detail::getCUDAHooks().setCUDAGeneratorState(gen.first, gen.second);
+  }
+}
+
+// Collects the tensors saved while a region is recomputed, in order.
+struct CaptureHooks : public SavedVariableHooks {
+  std::unique_ptr<PackedTensor> pack(
+      const Variable& variable,
+      const at::Tensor& data) override {
+    saved.push_back(data);
+    return nullptr;
+  }
+
+  std::vector<at::Tensor> saved;
+};
+
+struct CheckpointRegion
+    : public SavedVariableHooks,
+      public std::enable_shared_from_this<CheckpointRegion> {
+  CheckpointRegion(
+      std::function<variable_list(const variable_list&)> fn,
+      const variable_list& inputs,
+      const CheckpointOptions& options)
+      : fn_(std::move(fn)), options_(options) {
+    inputs_.reserve(inputs.size());
+    for (const auto& input : inputs) {
+      if (input.defined()) {
+        inputs_.push_back(input.detach());
+        versions_.push_back(impl::version_counter(input).current_version());
+        requires_grad_.push_back(input.requires_grad());
+      } else {
+        inputs_.emplace_back();
+        versions_.push_back(0);
+        requires_grad_.push_back(false);
+      }
+    }
+    if (options_.preserve_rng_state) {
+      rng_state_ = get_rng_state(inputs_);
+    }
+  }
+
+  variable_list run(const variable_list& inputs) {
+    return fn_(inputs);
+  }
+
+  std::unique_ptr<PackedTensor> pack(
+      const Variable& variable,
+      const at::Tensor& data) override;
+
+  at::Tensor unpack(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!recomputed_) {
+      recompute();
+    }
+    return saved_.at(index);
+  }
+
+ private:
+  bool keep(const Variable& variable, const at::Tensor& data) {
+    if (variable.is_leaf() && variable.requires_grad()) {
+      return true;
+    }
+    for (const auto& input : inputs_) {
+      if (input.defined() && data.is_alias_of(input)) {
+        return true;
+      }
+    }
+    if (!options_.keep_outputs_of.empty()) {
+      const auto& grad_fn = variable.grad_fn();
+      if (grad_fn && options_.keep_outputs_of.count(grad_fn->name())) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void recompute() {
+    for (size_t i = 0; i < inputs_.size(); i++) {
+      TORCH_CHECK(
+          !inputs_[i].defined() ||
+              impl::version_counter(inputs_[i]).current_version() ==
+                  versions_[i],
+          "an input of a checkpointed region was modified by an inplace "
+          "operation after the forward pass, its saved tensors can't be "
+          "recomputed");
+    }
+    variable_list inputs;
+    inputs.reserve(inputs_.size());
+    for (size_t i = 0; i < inputs_.size(); i++) {
+      if (inputs_[i].defined()) {
+        inputs.push_back(inputs_[i].detach().requires_grad_(requires_grad_[i]));
+      } else {
+        inputs.emplace_back();
+      }
+    }
+
+    auto capture = std::make_shared<CaptureHooks>();
+    RngState prev_rng_state;
+    if (options_.preserve_rng_state) {
+      prev_rng_state = get_rng_state(inputs_);
+      set_rng_state(rng_state_);
+    }
+    try {
+      AutoGradMode enable_grad(true);
+      SavedVariableHooksGuard guard(capture);
+      fn_(inputs);
+    } catch (...) {
+      if (options_.preserve_rng_state) {
+        set_rng_state(prev_rng_state);
+      }
+      throw;
+    }
+    if (options_.preserve_rng_state) {
+      set_rng_state(prev_rng_state);
+    }
+
+    TORCH_CHECK(
+        capture->saved.size() == num_saved_,
+        "recomputing a checkpointed region saved ",
+        capture->saved.size(),
+        " tensors, but its forward pass saved ",
+        num_saved_);
+    saved_ = std::move(capture->saved);
+    recomputed_ = true;
+    // The region isn't recomputed again.
+    fn_ = nullptr;
+    inputs_.clear();
+  }
+
+  std::function<variable_list(const variable_list&)> fn_;
+  CheckpointOptions options_;
+  variable_list inputs_;
+  std::vector<uint32_t> versions_;
+  std::vector<bool> requires_grad_;
+  RngState rng_state_;
+
+  // Number of tensors saved during the forward pass, including kept ones.
+  size_t num_saved_ = 0;
+
+  std::mutex mutex_;
+  bool recomputed_ = false;
+  std::vector<at::Tensor> saved_;
+};
+
+// A tensor saved in a checkpointed region, recomputed when it is unpacked.
+struct RecomputedTensor : public PackedTensor {
+  RecomputedTensor(std::shared_ptr<CheckpointRegion> region, size_t index)
+      : region_(std::move(region)), index_(index) {}
+
+  at::Tensor unpack() override {
+    return region_->unpack(index_);
+  }
+
+  std::shared_ptr<CheckpointRegion> region_;
+  size_t index_;
+};
+
+std::unique_ptr<PackedTensor> CheckpointRegion::pack(
+    const Variable& variable,
+    const at::Tensor& data) {
+  const auto index = num_saved_++;
+  if (keep(variable, data)) {
+    return nullptr;
+  }
+  return std::make_unique<RecomputedTensor>(shared_from_this(), index);
+}
+
+} // namespace
+
+variable_list checkpoint(
+    std::function<variable_list(const variable_list&)> fn,
+    const variable_list& inputs,
+    const CheckpointOptions& options) {
+  auto region =
+      std::make_shared<CheckpointRegion>(std::move(fn), inputs, options);
+  SavedVariableHooksGuard guard(region);
+  return region->run(inputs);
+}
+
+}} // namespace torch::autograd
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+namespace torch { namespace autograd {
+
+/// Options of a checkpointed region, see `checkpoint`.
+struct TORCH_API CheckpointOptions {
+  /// Saved tensors that are outputs of operations whose backward function has
+  /// one of these names, like "MmBackward", are kept rather than recomputed.
+  /// This is meant for tensors that are cheap to keep compared to the cost of
+  /// recomputing them, like the outputs of matrix multiplications.
+  std::unordered_set<std::string> keep_outputs_of;
+
+  /// Whether to restore the state of the default CPU generator, and of the
+  /// default CUDA generators of the devices of the inputs, before the region
+  /// is recomputed, so that random operations produce the same results.
+  bool preserve_rng_state = true;
+};
+
+/// Runs `fn` on `inputs` as usual, except that the tensors the operations in
+/// `fn` save for backward are dropped rather than kept until backward. The
+/// first time backward needs one of them, `fn` is run again on the inputs and
+/// the tensors saved by that run are used in their place.
+///
+/// The outputs are those of `fn`, so the gradients flow through the graph
+/// recorded by `fn` like they would without checkpointing. The recomputation
+/// runs within the backward pass that needs it instead of in a nested
+/// backward pass, which works with `torch.autograd.grad` and with hooks on
+/// the graph, like those of DDP.
+///
+/// Saved tensors that share storage with an input, and leaves that require
+/// grad like parameters, are alive anyway and are kept. `fn` must save the
+/// same tensors in the same order when it is run again, and the inputs must
+/// not be modified in place before backward.
+TORCH_API variable_list checkpoint(
+    std::function<variable_list(const variable_list&)> fn,
+    const variable_list& inputs,
+    const CheckpointOptions& options = {});
+
+}} // namespace torch::autograd
@@ -6,6 +6,7 @@
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
 #include <torch/csrc/autograd/variable.h>
+#include <torch/csrc/utils/hash.h>
 #include <torch/csrc/utils/memory.h>
 
 #include <ATen/DeviceGuard.h>
@@ -23,6 +24,7 @@
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -127,6 +129,46 @@ static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 // When the GraphTask is finished, the parent worker thread that is waiting on
 // the task is notified and the current thread returns to the pool.
 
+// Note [CPU worker threads]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default, all CPU functions of a backward pass run on the thread that
+// called backward(), so independent branches of the graph run one after the
+// other. With set_num_cpu_workers(n), every backward call started on a CPU
+// thread also hands its GraphTask to n threads of a CPU worker pool. Each of
+// them takes tasks of that GraphTask from the GraphTask's cpu_ready_queue_
+// (see ReadyQueue::pop_for_graph_task) until the GraphTask is completed. The
+// owning thread keeps draining the same queue as usual, so nothing changes
+// when the workers are busy with other backward calls. Since the last task may
+// now finish on a worker, the owning thread passes its GraphTask to
+// thread_main and waits with ReadyQueue::pop_until_completed, which returns
+// once the GraphTask is completed.
+//
+// Dependency counting, InputBuffer accumulation and captured gradients are
+// already protected by GraphTask::mutex_ since device threads run concurrently
+// with the owning thread, and outstanding_tasks_ is atomic. The workers never
+// take dummy tasks (fn_ == nullptr) or tasks of other GraphTasks; those are
+// left to the owning thread. In particular, a reentrant backward started by
+// the owning thread runs on the owning thread alone. A reentrant backward
+// started on a worker thread is executed by that worker like a fresh backward
+// call (worker_device stays NO_DEVICE on worker threads), so it blocks only
+// that worker.
+
+// Note [Static schedules]
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Training loops usually run backward() on a graph with the same structure
+// every iteration. With set_static_schedule_enabled(true), a backward() call
+// started on a CPU thread, without CPU workers, anomaly mode or inputs to
+// compute the gradients of, flattens its graph in a single traversal instead
+// of computing dependencies_. If every function takes its inputs on CPU, the
+// functions are then run on the calling thread in a schedule cached by the
+// structure of the graph (the targets of the next edges of every function, in
+// traversal order), with one InputBuffer per function allocated upfront. That
+// skips the dependencies_ and not_ready_ maps, the GraphTask mutex and the
+// ready queue. A schedule is computed like the CPU ready queue would order
+// the functions of the first graph of its structure, and is a valid
+// topological order of every graph of that structure. Reentrant backward
+// calls from within the functions run as usual.
+
 // Note [Streaming backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // On CUDA devices the autograd engine's device operations are run on the
@@ -169,6 +211,7 @@ int NodeTask::getReentrantDepth() const {
 }
 
 auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
+  bool has_waiting_workers;
   {
     // Lock mutex for writing to heap_
     std::lock_guard<std::mutex> lock(mutex_);
@@ -178,8 +221,12 @@ auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
       ++graph_task->outstanding_tasks_;
     }
     heap_.push(std::move(item));
+    has_waiting_workers = num_waiting_workers_ > 0;
   }
   not_empty_.notify_one();
+  if (has_waiting_workers) {
+    not_empty_for_workers_.notify_one();
+  }
 }
 
 auto ReadyQueue::pushShutdownTask() -> void {
@@ -205,13 +252,69 @@ auto ReadyQueue::pop() -> NodeTask {
   return task;
 }
 
+bool ReadyQueue::pop_until_completed(
+    const std::shared_ptr<GraphTask>& graph_task,
+    NodeTask& task) {
+  // Lock mutex for accesses to heap_
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [&]() {
+    return !heap_.empty() || graph_task->future_completed_.load();
+  });
+  if (heap_.empty()) {
+    return false;
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+  return true;
+}
+
+bool ReadyQueue::pop_for_graph_task(
+    const std::shared_ptr<GraphTask>& graph_task,
+    NodeTask& task) {
+  // Lock mutex for accesses to heap_
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto can_pop = [this, &graph_task]() {
+    if (heap_.empty()) {
+      return false;
+    }
+    const NodeTask& top = heap_.top();
+    return top.fn_ && !top.isShutdownTask_ &&
+        !top.base_.owner_before(graph_task) &&
+        !graph_task.owner_before(top.base_);
+  };
+  ++num_waiting_workers_;
+  not_empty_for_workers_.wait(lock, [&]() {
+    return graph_task->future_completed_.load() || can_pop();
+  });
+  --num_waiting_workers_;
+  if (graph_task->future_completed_.load()) {
+    return false;
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+  return true;
+}
+
+void ReadyQueue::notify_completed() {
+  // Lock mutex so that waiting threads cannot miss the notification between
+  // checking their GraphTask and starting to wait
+  std::lock_guard<std::mutex> lock(mutex_);
+  not_empty_.notify_all();
+  not_empty_for_workers_.notify_all();
+}
+
 bool ReadyQueue::empty() const {
   // Lock mutex for accesses to heap_
   std::unique_lock<std::mutex> lock(mutex_);
   return heap_.empty();
 }
 
-Engine::Engine() : max_recursion_depth_(MAX_DEPTH), non_reentrant_device_thread_count_(0) {}
+Engine::Engine()
+    : max_recursion_depth_(MAX_DEPTH),
+      num_cpu_workers_(0),
+      cpu_worker_pool_shared_(std::make_shared<CpuWorkerPoolShared>()),
+      static_schedule_enabled_(false),
+      non_reentrant_device_thread_count_(0) {}
 
 // Send shutdown tasks to all device_ready_queues_ if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest priority
@@ -338,8 +441,10 @@ auto Engine::thread_main(
     const std::shared_ptr<GraphTask>& graph_task,
     bool reentrant_thread) -> void {
   // Either reentrant_thread should be false or we should pass in a non-null
-  // graph_task.
-  TORCH_INTERNAL_ASSERT(reentrant_thread != (graph_task == nullptr));
+  // graph_task. The owning thread of a GraphTask executed with CPU worker
+  // threads passes in its graph_task with reentrant_thread false, see
+  // Note [CPU worker threads].
+  TORCH_INTERNAL_ASSERT(!reentrant_thread || graph_task != nullptr);
 
   // local_ready_queue should already been initialized when we get into thread_main
   TORCH_INTERNAL_ASSERT(local_ready_queue != nullptr);
@@ -354,7 +459,14 @@ auto Engine::thread_main(
       // Scope this block of execution since NodeTask is not needed after this
       // block and can be deallocated (release any references to grad tensors
       // as part of inputs_).
-      NodeTask task = local_ready_queue->pop();
+      NodeTask task({}, nullptr, InputBuffer(0));
+      if (reentrant_thread || !graph_task) {
+        task = local_ready_queue->pop();
+      } else if (!local_ready_queue->pop_until_completed(graph_task, task)) {
+        // The last task was completed by a CPU worker thread
+        graph_task->future_result_->waitNoThrow();
+        break;
+      }
       // This will only work if the worker is running a non backward task
       // TODO Needs to be fixed this to work in all cases
       if (task.isShutdownTask_) {
@@ -447,6 +559,94 @@ void Engine::reentrant_thread_init() {
   }
 }
 
+void Engine::set_num_cpu_workers(int num_workers) {
+  TORCH_CHECK(num_workers >= 0, "Expected a non-negative number of CPU workers");
+  num_cpu_workers_ = num_workers;
+}
+
+int Engine::num_cpu_workers() const {
+  return num_cpu_workers_.load();
+}
+
+// CPU worker threads wait for GraphTasks to help with, see
+// Note [CPU worker threads]
+void Engine::cpu_worker_thread_init() {
+  at::init_num_threads();
+  auto pool_shared = cpu_worker_pool_shared_;
+  while (true) {
+    std::unique_lock<std::mutex> lk(pool_shared->mutex_);
+    pool_shared->work_.wait(lk, [&pool_shared]{ return !pool_shared->graphtasks_queue_.empty();});
+    auto task = pool_shared->graphtasks_queue_.front();
+    pool_shared->graphtasks_queue_.pop();
+    lk.unlock();
+    std::shared_ptr<GraphTask> graph_task;
+    if (!(graph_task = task.lock()) || graph_task->future_completed_.load()) {
+      continue;
+    }
+    cpu_worker_main(std::move(graph_task));
+  }
+}
+
+void Engine::cpu_worker_main(std::shared_ptr<GraphTask> graph_task) {
+  auto cpu_ready_queue = graph_task->cpu_ready_queue_;
+  while (true) {
+    {
+      // Scope this block of execution since NodeTask is not needed after this
+      // block and can be deallocated (release any references to grad tensors
+      // as part of inputs_).
+      NodeTask task({}, nullptr, InputBuffer(0));
+      if (!cpu_ready_queue->pop_for_graph_task(graph_task, task)) {
+        break;
+      }
+      if (!graph_task->has_error_.load()) {
+        AutoGradMode grad_mode(graph_task->grad_mode_);
+        try {
+          GraphTaskGuard guard(graph_task);
+          evaluate_function(graph_task, task.fn_.get(), task.inputs_, cpu_ready_queue);
+        } catch (std::exception& e) {
+          thread_on_exception(graph_task, task.fn_, e);
+        }
+      }
+    }
+
+    // Decrement the outstanding tasks.
+    --graph_task->outstanding_tasks_;
+
+    if (graph_task->completed()) {
+      // This wakes up the owning thread waiting in pop_until_completed
+      graph_task->mark_as_completed_and_run_post_processing();
+      break;
+    }
+  }
+}
+
+void Engine::add_cpu_worker_tasks(const std::shared_ptr<GraphTask>& graph_task) {
+  int num_workers = num_cpu_workers_.load();
+  int threads_to_start;
+  {
+    std::lock_guard<std::mutex> lck(cpu_worker_pool_shared_->mutex_);
+    threads_to_start = std::max(0, num_workers - cpu_worker_pool_shared_->num_threads_);
+    cpu_worker_pool_shared_->num_threads_ += threads_to_start;
+    for (int i = 0; i < num_workers; ++i) {
+      cpu_worker_pool_shared_->graphtasks_queue_.push(graph_task);
+    }
+  }
+  // The threads are leaked like the reentrant threads
+  for (int i = 0; i < threads_to_start; ++i) {
+    std::thread t(&Engine::cpu_worker_thread_init, this);
+    t.detach();
+  }
+  cpu_worker_pool_shared_->work_.notify_all();
+}
+
+void Engine::set_static_schedule_enabled(bool enabled) {
+  static_schedule_enabled_ = enabled;
+}
+
+bool Engine::static_schedule_enabled() const {
+  return static_schedule_enabled_.load();
+}
+
 void Engine::thread_on_exception(
     std::shared_ptr<GraphTask> graph_task,
     const std::shared_ptr<Node>& fn,
@@ -484,6 +684,11 @@ void GraphTask::mark_as_completed_and_run_post_processing() {
   } catch (std::exception& e) {
     future_result_->setErrorIfNeeded(e.what());
   }
+  // Threads waiting in pop_until_completed or pop_for_graph_task stop once the
+  // future is marked complete
+  if (cpu_ready_queue_) {
+    cpu_ready_queue_->notify_completed();
+  }
 }
 
 void GraphTask::exec_post_processing() {
@@ -537,6 +742,9 @@ void GraphTask::set_exception(
   set_exception_without_signal(fn);
   if (!future_completed_.exchange(true)) {
     future_result_->setError(e.what());
+    if (cpu_ready_queue_) {
+      cpu_ready_queue_->notify_completed();
+    }
   }
 }
 
@@ -855,6 +1063,10 @@ auto Engine::execute(const edge_list& roots,
                      bool keep_graph,
                      bool create_graph,
                      const edge_list& outputs) -> variable_list {
+  TORCH_CHECK(
+      !(create_graph && InferenceMode::is_enabled()),
+      "backward with create_graph=True can't record the graph of the ",
+      "derivatives in inference mode");
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   validate_outputs(roots, const_cast<variable_list&>(inputs), [](const std::string& msg) {
     return msg;
@@ -873,8 +1085,17 @@ auto Engine::execute(const edge_list& roots,
       /* depth */ not_reentrant_backward_call ? 0 : total_depth + 1,
       /* cpu_ready_queue */ local_ready_queue);
 
-  // Now compute the dependencies for all executable functions and queue the root
   auto graph_root = std::make_shared<GraphRoot>(roots, inputs);
+  if (outputs.empty() && not_reentrant_backward_call &&
+      static_schedule_enabled_.load() && num_cpu_workers_.load() == 0 &&
+      !AnomalyMode::is_enabled()) {
+    // See Note [Static schedules]
+    if (auto future = execute_with_static_schedule(graph_task, graph_root)) {
+      return future->wait();
+    }
+  }
+
+  // Now compute the dependencies for all executable functions and queue the root
   compute_dependencies(graph_root.get(), *graph_task);
 
   if (!outputs.empty()) {
@@ -884,6 +1105,169 @@ auto Engine::execute(const edge_list& roots,
   return execute_with_graph_task(graph_task, graph_root)->wait();
 }
 
+struct StaticSchedule {
+  // The structure of the graph the schedule was computed for, see
+  // FlatGraph::signature
+  std::vector<size_t> signature;
+  // Indices of the functions of the graph in execution order
+  std::vector<size_t> order;
+};
+
+namespace {
+
+constexpr size_t kNoFunction = std::numeric_limits<size_t>::max();
+constexpr size_t kMaxStaticSchedules = 16;
+
+// The functions of a graph in traversal order, with the indices of the
+// functions their next edges point to.
+struct FlatGraph {
+  std::vector<std::shared_ptr<Node>> functions;
+  // The next edges of functions[i] are edge_targets[edge_offsets[i]] to
+  // edge_targets[edge_offsets[i + 1] - 1]
+  std::vector<size_t> edge_offsets;
+  std::vector<size_t> edge_targets;
+  // The number of next edges of every function, followed by the target and
+  // input_nr of each of them
+  std::vector<size_t> signature;
+};
+
+// Returns false if a function of the graph takes inputs on another device
+// than CPU.
+bool flatten_graph(const std::shared_ptr<Node>& graph_root, FlatGraph& graph) {
+  std::unordered_map<Node*, size_t> index;
+  graph.functions.push_back(graph_root);
+  index.emplace(graph_root.get(), 0);
+  for (size_t i = 0; i < graph.functions.size(); ++i) {
+    Node* fn = graph.functions[i].get();
+    for (size_t j = 0; j < fn->num_inputs(); ++j) {
+      if (fn->input_metadata(j).device().type() != at::kCPU) {
+        return false;
+      }
+    }
+    graph.edge_offsets.push_back(graph.edge_targets.size());
+    graph.signature.push_back(fn->num_outputs());
+    for (const auto& edge : fn->next_edges()) {
+      size_t target = kNoFunction;
+      if (edge.is_valid()) {
+        auto it = index.find(edge.function.get());
+        if (it == index.end()) {
+          it = index.emplace(edge.function.get(), graph.functions.size()).first;
+          graph.functions.push_back(edge.function);
+        }
+        target = it->second;
+      }
+      graph.edge_targets.push_back(target);
+      graph.signature.push_back(target);
+      graph.signature.push_back(edge.input_nr);
+    }
+  }
+  graph.edge_offsets.push_back(graph.edge_targets.size());
+  return true;
+}
+
+// Orders the functions like the CPU ready queue would: among the functions
+// whose dependencies have run, the one with the highest sequence number runs
+// first.
+std::vector<size_t> schedule_order(const FlatGraph& graph) {
+  std::vector<size_t> dependencies(graph.functions.size(), 0);
+  for (const auto target : graph.edge_targets) {
+    if (target != kNoFunction) {
+      ++dependencies[target];
+    }
+  }
+  std::vector<size_t> order;
+  order.reserve(graph.functions.size());
+  std::priority_queue<std::pair<uint64_t, size_t>> ready;
+  ready.emplace(graph.functions[0]->sequence_nr(), 0);
+  while (!ready.empty()) {
+    const size_t i = ready.top().second;
+    ready.pop();
+    order.push_back(i);
+    for (size_t k = graph.edge_offsets[i]; k < graph.edge_offsets[i + 1]; ++k) {
+      const size_t target = graph.edge_targets[k];
+      if (target != kNoFunction && --dependencies[target] == 0) {
+        ready.emplace(graph.functions[target]->sequence_nr(), target);
+      }
+    }
+  }
+  return order;
+}
+
+} // namespace
+
+std::shared_ptr<FutureVariableList> Engine::execute_with_static_schedule(
+    std::shared_ptr<GraphTask> graph_task,
+    const std::shared_ptr<Node>& graph_root) {
+  FlatGraph graph;
+  if (!flatten_graph(graph_root, graph)) {
+    return nullptr;
+  }
+
+  const size_t hash = torch::hash<std::vector<size_t>>()(graph.signature);
+  std::shared_ptr<const StaticSchedule> schedule;
+  {
+    std::lock_guard<std::mutex> lock(static_schedules_mutex_);
+    auto it = static_schedules_.find(hash);
+    if (it != static_schedules_.end() &&
+        it->second->signature == graph.signature) {
+      schedule = it->second;
+    }
+  }
+  if (!schedule) {
+    auto new_schedule = std::make_shared<StaticSchedule>();
+    new_schedule->order = schedule_order(graph);
+    new_schedule->signature = std::move(graph.signature);
+    schedule = new_schedule;
+    std::lock_guard<std::mutex> lock(static_schedules_mutex_);
+    if (static_schedules_.size() >= kMaxStaticSchedules) {
+      static_schedules_.clear();
+    }
+    static_schedules_[hash] = schedule;
+  }
+
+  initialize_device_threads_pool();
+  // Reentrant backward calls from the functions see that they are nested
+  set_device(CPU_DEVICE);
+  graph_task->owner_ = worker_device;
+
+  std::vector<InputBuffer> input_buffers;
+  input_buffers.reserve(graph.functions.size());
+  for (const auto& fn : graph.functions) {
+    input_buffers.emplace_back(fn->num_inputs());
+  }
+  for (const auto i : schedule->order) {
+    const auto& fn = graph.functions[i];
+    try {
+      AutoGradMode grad_mode(graph_task->grad_mode_);
+      GraphTaskGuard guard(graph_task);
+      auto outputs = call_function(graph_task, fn.get(), input_buffers[i]);
+      if (!graph_task->keep_graph_) {
+        fn->release_variables();
+      }
+      const size_t begin = graph.edge_offsets[i];
+      for (size_t j = 0; j < outputs.size(); ++j) {
+        const size_t target = graph.edge_targets[begin + j];
+        if (target == kNoFunction) {
+          continue;
+        }
+        input_buffers[target].add(
+            fn->next_edge(j).input_nr,
+            std::move(outputs[j]),
+            c10::nullopt,
+            c10::nullopt);
+      }
+    } catch (std::exception& e) {
+      thread_on_exception(graph_task, fn, e);
+      break;
+    }
+  }
+  if (!graph_task->has_error_.load()) {
+    graph_task->mark_as_completed_and_run_post_processing();
+  }
+  worker_device = NO_DEVICE;
+  return graph_task->future_result_;
+}
+
 void Engine::initialize_device_threads_pool() {
   track_bad_autograd_forks();
   TORCH_CHECK(!in_bad_autograd_fork,
@@ -916,7 +1300,13 @@ std::shared_ptr<FutureVariableList> Engine::execute_with_graph_task(
     // The owning thread start to drive the engine execution with the GraphTask
     // that has already been pushed to the current CPU thread's ready_queue
     lock.unlock();
-    thread_main(nullptr, false);
+    if (num_cpu_workers_.load() > 0) {
+      // See Note [CPU worker threads]
+      add_cpu_worker_tasks(graph_task);
+      thread_main(graph_task, /* reentrant_thread */ false);
+    } else {
+      thread_main(nullptr, false);
+    }
     TORCH_INTERNAL_ASSERT(graph_task->future_result_->completed());
     // reset the worker_device after the completion of the graph_task, this is so
     // that the initial state of the engine remains the same across every backward()
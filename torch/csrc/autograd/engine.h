@@ -24,6 +24,7 @@
 
 namespace torch { namespace autograd {
 struct ReadyQueue;
+struct StaticSchedule;
 }} // namespace torch::autograd
 
 namespace torch { namespace autograd {
@@ -238,6 +239,10 @@ struct ReadyQueue {
 
   // To notify threads waiting on the ReadyQueue of available tasks on the heap_
   std::condition_variable not_empty_;
+  // To notify CPU worker threads waiting in pop_for_graph_task
+  std::condition_variable not_empty_for_workers_;
+  // Number of CPU worker threads waiting in pop_for_graph_task
+  int num_waiting_workers_ = 0;
   // To protect read and writes to heap_
   mutable std::mutex mutex_;
 
@@ -251,6 +256,22 @@ struct ReadyQueue {
   void push(NodeTask item, bool incrementOutstandingTasks = true);
   void pushShutdownTask();
   NodeTask pop();
+  // Like pop(), but returns false instead of waiting once graph_task is
+  // completed and the queue is empty. Used by the owning thread of a
+  // GraphTask executed with CPU worker threads.
+  bool pop_until_completed(
+      const std::shared_ptr<GraphTask>& graph_task,
+      NodeTask& task);
+  // Pops the next task if it runs a function of graph_task. Used by the CPU
+  // worker threads, see Note [CPU worker threads]: waits while the queue is
+  // empty or its first task is not a function of graph_task, and returns
+  // false once graph_task is completed.
+  bool pop_for_graph_task(
+      const std::shared_ptr<GraphTask>& graph_task,
+      NodeTask& task);
+  // Wakes up the threads waiting in pop_until_completed and
+  // pop_for_graph_task after a GraphTask was completed
+  void notify_completed();
   bool empty() const;
   size_t size() const;
 };
@@ -312,6 +333,19 @@ struct TORCH_API Engine {
   // Should be called after fork to notify that worker threads are gone
   void release_workers();
 
+  // Sets the number of additional threads that execute CPU functions of a
+  // backward pass together with the thread that called backward().
+  // 0 (the default) runs all CPU functions on the calling thread.
+  // See Note [CPU worker threads]
+  void set_num_cpu_workers(int num_workers);
+  int num_cpu_workers() const;
+
+  // Enables executing backward() calls whose graph only has CPU functions
+  // with a schedule cached by the structure of the graph, instead of the
+  // ready queues. Disabled by default. See Note [Static schedules]
+  void set_static_schedule_enabled(bool enabled);
+  bool static_schedule_enabled() const;
+
  protected:
   Engine();
   void compute_dependencies(Node* root, GraphTask& task);
@@ -340,6 +374,14 @@ struct TORCH_API Engine {
       bool reentrant_thread);
   void reentrant_thread_init();
   void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
+  void cpu_worker_thread_init();
+  void cpu_worker_main(std::shared_ptr<GraphTask> graph_task);
+  void add_cpu_worker_tasks(const std::shared_ptr<GraphTask>& graph_task);
+  // Returns nullptr, without executing anything, if the graph of graph_root
+  // can't be executed with a static schedule.
+  std::shared_ptr<FutureVariableList> execute_with_static_schedule(
+      std::shared_ptr<GraphTask> graph_task,
+      const std::shared_ptr<Node>& graph_root);
 
   // Ensures device_ready_queues_ are initialized only once
   std::once_flag start_device_threads_flag_;
@@ -376,6 +418,31 @@ struct TORCH_API Engine {
  // for the graphtasks_queue_ to be nonempty.
  std::shared_ptr<ThreadPoolShared> thread_pool_shared_;
 
+ struct CpuWorkerPoolShared {
+   // Number of CPU worker threads started so far
+   int num_threads_;
+   // The threads will wait on work_ to be notified of GraphTasks
+   std::condition_variable work_;
+   // To protect reads and writes to graphtasks_queue_ and num_threads_
+   std::mutex mutex_;
+   // Every CPU worker thread that takes a GraphTask from this queue helps
+   // executing it until it is completed. See Note [CPU worker threads]
+   std::queue<std::weak_ptr<GraphTask>> graphtasks_queue_;
+
+   CpuWorkerPoolShared() : num_threads_(0) {}
+ };
+
+ // Configured number of CPU worker threads used by each backward call
+ std::atomic<int> num_cpu_workers_;
+ // Shared for the same reason as thread_pool_shared_
+ std::shared_ptr<CpuWorkerPoolShared> cpu_worker_pool_shared_;
+
+ std::atomic<bool> static_schedule_enabled_;
+ // Cached schedules by the hash of the structure of their graph
+ std::unordered_map<size_t, std::shared_ptr<const StaticSchedule>> static_schedules_;
+ // To protect reads and writes to static_schedules_
+ std::mutex static_schedules_mutex_;
+
 private:
   // Number of non-reentrant threads
   std::atomic<uint32_t> non_reentrant_device_thread_count_;
@@ -14,6 +14,11 @@ using at::Tensor;
 
 namespace torch { namespace autograd {
 
+AccumulateGradStats& accumulate_grad_stats() {
+  static AccumulateGradStats stats;
+  return stats;
+}
+
 // AccumulateGrad sets sequence_nr to the max value so it's always called
 // ASAP during backwards.
 AccumulateGrad::AccumulateGrad(Variable variable_)
@@ -56,7 +61,8 @@ auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
       grad,
       new_grad,
       1 + !post_hooks().empty() /* num_expected_refs */,
-      [&grad](at::Tensor&& grad_update) { grad = std::move(grad_update); });
+      [&grad](at::Tensor&& grad_update) { grad = std::move(grad_update); },
+      &impl::released_grad(variable));
 
   return variable_list();
 }
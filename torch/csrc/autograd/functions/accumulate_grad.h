@@ -4,10 +4,39 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 
 namespace torch { namespace autograd {
 
+// Counts how gradients are accumulated into the grad of leaf variables,
+// which tells how many of them allocate memory. Reset it every iteration
+// to get per-iteration counts.
+struct TORCH_API AccumulateGradStats {
+  // The grad was undefined, and the incoming gradient was stolen (no
+  // allocation) ...
+  std::atomic<uint64_t> stolen{0};
+  // ... or copied into the released memory of the grad (no allocation) ...
+  std::atomic<uint64_t> reused{0};
+  // ... or cloned (allocation).
+  std::atomic<uint64_t> cloned{0};
+  // The incoming gradient was added to the grad in place (no allocation) ...
+  std::atomic<uint64_t> accumulated_in_place{0};
+  // ... or out of place (allocation).
+  std::atomic<uint64_t> accumulated_out_of_place{0};
+
+  void reset() {
+    stolen = 0;
+    reused = 0;
+    cloned = 0;
+    accumulated_in_place = 0;
+    accumulated_out_of_place = 0;
+  }
+};
+
+TORCH_API AccumulateGradStats& accumulate_grad_stats();
+
 struct TORCH_API AccumulateGrad : public Node {
   explicit AccumulateGrad(Variable variable_);
 
@@ -36,13 +65,20 @@ struct TORCH_API AccumulateGrad : public Node {
   // update_grad: Function that is used to update grad for the variable.
   //              The argument to the function is a Tensor which
   //              is used to set a new value for the grad.
+  // released_grad: Optional memory of an earlier grad of the variable, see
+  //                `impl::release_grad`. If variable_grad is undefined and
+  //                new_grad can't be stolen, new_grad is copied into it
+  //                rather than cloned, if it matches. It is cleared once the
+  //                grad is defined again.
   template <typename T>
   static void accumulateGrad(
       const Variable& variable,
       at::Tensor& variable_grad,
       const at::Tensor& new_grad,
       size_t num_expected_refs,
-      const T& update_grad) {
+      const T& update_grad,
+      at::Tensor* released_grad = nullptr) {
+    auto& stats = accumulate_grad_stats();
     if (!variable_grad.defined()) {
       // under following condition, we can avoid clone()
       if (!GradMode::is_enabled() && !new_grad.is_sparse() &&
@@ -56,6 +92,7 @@ struct TORCH_API AccumulateGrad : public Node {
         // references we expect is basically internal structures that are
         // holding references to the Tensor and that is fine since these are not
         // exposed to the user.
+        ++stats.stolen;
         update_grad(new_grad.detach());
       } else if (
           !GradMode::is_enabled() && new_grad.is_sparse() &&
@@ -75,18 +112,34 @@ struct TORCH_API AccumulateGrad : public Node {
         // earlier we would clone the entire SparseTensor which cloned indices
         // and values.
         // For details see https://github.com/pytorch/pytorch/issues/34375.
+        ++stats.stolen;
         update_grad(at::_sparse_coo_tensor_unsafe(
             new_grad._indices(),
             new_grad._values(),
             new_grad.sizes(),
             new_grad.options()));
+      } else if (
+          !GradMode::is_enabled() && released_grad &&
+          released_grad->defined() && !new_grad.is_sparse() &&
+          released_grad->sizes().equals(new_grad.sizes()) &&
+          released_grad->options().type_equal(new_grad.options()) &&
+          released_grad->device() == new_grad.device()) {
+        // Reuse the memory of the released grad rather than allocating new
+        // memory for the clone.
+        ++stats.reused;
+        released_grad->copy_(new_grad);
+        update_grad(std::move(*released_grad));
       } else {
+        ++stats.cloned;
         if (new_grad.is_sparse()) {
           update_grad(new_grad.clone());
         } else {
           update_grad(new_grad.clone(at::MemoryFormat::Contiguous));
         }
       }
+      if (released_grad) {
+        released_grad->reset();
+      }
     } else if (!GradMode::is_enabled()) {
       // This case is not strictly necessary, but it makes the first-order only
       // case slightly more efficient.
@@ -96,6 +149,7 @@ struct TORCH_API AccumulateGrad : public Node {
         // `variable_grad` for it to store the result. However, changing the
         // TensorImpl type of a tensor requires changing the tensor itself, and
         // thus in this case we have to change the grad tensor.
+        ++stats.accumulated_out_of_place;
         update_grad(new_grad + variable_grad);
       } else {
         // In this case we can avoid changing the grad tensor. There are three
@@ -108,10 +162,14 @@ struct TORCH_API AccumulateGrad : public Node {
         // In all of these three cases, `variable_grad += new_grad` is a
         // valid operation which adds `new_grad` to `variable_grad` in
         // place. `variable_grad` is thus still referring to the same tensor
-        // after the operation.
+        // after the operation. This is relied on by gradients that share
+        // storage with a larger buffer, like the gradient buckets of DDP
+        // (see `Reducer::set_gradient_as_bucket_view`).
+        ++stats.accumulated_in_place;
         variable_grad += new_grad;
       }
     } else {
+      ++stats.accumulated_out_of_place;
       update_grad(variable_grad + new_grad);
     }
   }
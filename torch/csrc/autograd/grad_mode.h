@@ -1,11 +1,14 @@
 #pragma once
 
 #include <ATen/core/grad_mode.h>
+#include <ATen/core/InferenceMode.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 
 namespace torch { namespace autograd {
 
 using GradMode = at::GradMode;
 using AutoGradMode = at::AutoGradMode;
+using InferenceMode = at::InferenceMode;
+using AutoInferenceMode = at::AutoInferenceMode;
 
 }}
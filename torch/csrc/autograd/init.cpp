@@ -6,7 +6,80 @@
 #include <ATen/autocast_mode.h>
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/autograd/python_function.h>
+#include <torch/csrc/autograd/checkpoint.h>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/functions/accumulate_grad.h>
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/python_variable.h>
+#include <torch/csrc/autograd/saved_variable.h>
+#include <torch/csrc/utils/python_numbers.h>
+
+namespace {
+
+// Saved variable hooks calling a pair of Python functions: pack_hook(tensor)
+// returns an arbitrary object (or None to save the tensor as usual) that is
+// passed to unpack_hook when the tensor is needed in backward.
+struct PyPackedTensor : public torch::autograd::PackedTensor {
+  PyPackedTensor(PyObject* packed, PyObject* unpack_hook)
+    : packed_(packed), unpack_hook_(unpack_hook) {
+    Py_INCREF(unpack_hook_);
+  }
+
+  ~PyPackedTensor() override {
+    // Saved variables can be freed from any thread.
+    pybind11::gil_scoped_acquire gil;
+    Py_DECREF(packed_);
+    Py_DECREF(unpack_hook_);
+  }
+
+  at::Tensor unpack() override {
+    pybind11::gil_scoped_acquire gil;
+    THPObjectPtr res(PyObject_CallFunctionObjArgs(unpack_hook_, packed_, nullptr));
+    if (!res) throw python_error();
+    TORCH_CHECK(THPVariable_Check(res.get()),
+        "unpack_hook must return a Tensor, but got ", Py_TYPE(res.get())->tp_name);
+    return ((THPVariable*)res.get())->cdata.tensor_data();
+  }
+
+ private:
+  // Owned references.
+  PyObject* packed_;
+  PyObject* unpack_hook_;
+};
+
+struct PySavedVariableHooks : public torch::autograd::SavedVariableHooks {
+  PySavedVariableHooks(PyObject* pack_hook, PyObject* unpack_hook)
+    : pack_hook_(pack_hook), unpack_hook_(unpack_hook) {
+    Py_INCREF(pack_hook_);
+    Py_INCREF(unpack_hook_);
+  }
+
+  ~PySavedVariableHooks() override {
+    pybind11::gil_scoped_acquire gil;
+    Py_DECREF(pack_hook_);
+    Py_DECREF(unpack_hook_);
+  }
+
+  std::unique_ptr<torch::autograd::PackedTensor> pack(
+      const torch::autograd::Variable& variable,
+      const at::Tensor& data) override {
+    pybind11::gil_scoped_acquire gil;
+    THPObjectPtr value(THPVariable_Wrap(data));
+    if (!value) throw python_error();
+    THPObjectPtr res(PyObject_CallFunctionObjArgs(pack_hook_, value.get(), nullptr));
+    if (!res) throw python_error();
+    if (res == Py_None) {
+      return nullptr;
+    }
+    return std::make_unique<PyPackedTensor>(res.release(), unpack_hook_);
+  }
+
+ private:
+  PyObject* pack_hook_;
+  PyObject* unpack_hook_;
+};
+
+} // namespace
 
 PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
   using namespace torch::autograd::profiler;
@@ -34,10 +107,17 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .value("Disabled", ProfilerState::Disabled)
       .value("CPU", ProfilerState::CPU)
       .value("CUDA", ProfilerState::CUDA)
-      .value("NVTX", ProfilerState::NVTX);
+      .value("NVTX", ProfilerState::NVTX)
+      .value("CUPTI", ProfilerState::CUPTI);
 
   py::class_<ProfilerConfig>(m, "ProfilerConfig")
-      .def(py::init<ProfilerState, bool, bool>());
+      .def(
+          py::init<ProfilerState, bool, bool, bool, bool>(),
+          py::arg("state"),
+          py::arg("report_input_shapes"),
+          py::arg("profile_memory"),
+          py::arg("with_flops") = false,
+          py::arg("with_perf_counters") = false);
 
   py::class_<Event>(m, "ProfilerEvent")
       .def("kind", &Event::kind)
@@ -45,6 +125,7 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .def("thread_id", &Event::thread_id)
       .def("device", &Event::device)
       .def("cpu_elapsed_us", &Event::cpu_elapsed_us)
+      .def("cpu_us", &Event::cpu_us)
       .def("cuda_elapsed_us", &Event::cuda_elapsed_us)
       .def("has_cuda", &Event::has_cuda)
       .def("shapes", &Event::shapes)
@@ -52,15 +133,84 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .def("cuda_memory_usage", &Event::cuda_memory_usage)
       .def("handle", &Event::handle)
       .def("node_id", &Event::node_id)
-      .def("is_remote", &Event::isRemote);
+      .def("is_remote", &Event::isRemote)
+      .def("flops", &Event::flops)
+      .def("bytes_moved", &Event::bytes_moved)
+      .def("sequence_nr", &Event::sequence_nr)
+      .def("perf_counters", &Event::perf_counters);
+
+  py::class_<CUDAActivity>(m, "ProfilerCUDAActivity")
+      .def("name", [](const CUDAActivity& a) { return a.name; })
+      .def("kind", [](const CUDAActivity& a) { return a.kind; })
+      .def("device", [](const CUDAActivity& a) { return a.device; })
+      .def("stream", [](const CUDAActivity& a) { return a.stream; })
+      .def("start_us", [](const CUDAActivity& a) { return a.start_ns / 1000.0; })
+      .def("end_us", [](const CUDAActivity& a) { return a.end_ns / 1000.0; })
+      .def("correlation_id", [](const CUDAActivity& a) { return a.correlation_id; });
 
   m.def("_enable_profiler", enableProfiler);
   m.def("_disable_profiler", disableProfiler);
+  m.def("_disable_profiler_with_cuda_activities", disableProfilerWithCUDAActivities);
+  m.def("_cupti_available", cuptiAvailable);
+  m.def("_perf_counters_available", perfCountersAvailable);
   m.def("_profiler_enabled", profilerEnabled);
   m.def("_enable_record_function", [](bool enable) {
     at::enableRecordFunction(enable);
   });
 
+  using torch::autograd::SavedVariableHooks;
+  using torch::autograd::SavedVariableHooksGuard;
+  py::class_<SavedVariableHooks, std::shared_ptr<SavedVariableHooks>>(
+      m, "_SavedVariableHooks");
+  m.def("_make_saved_tensors_hooks",
+      [](py::function pack_hook, py::function unpack_hook)
+          -> std::shared_ptr<SavedVariableHooks> {
+        return std::make_shared<PySavedVariableHooks>(
+            pack_hook.ptr(), unpack_hook.ptr());
+      });
+  m.def("_get_saved_tensors_hooks", &SavedVariableHooksGuard::get_current);
+  m.def("_set_saved_tensors_hooks", &SavedVariableHooksGuard::set_current);
+
+  m.def("_checkpoint",
+      [](py::function fn,
+         std::vector<at::Tensor> inputs,
+         std::unordered_set<std::string> keep_outputs_of,
+         bool preserve_rng_state) {
+        // The region may be recomputed and destroyed on a backward thread,
+        // which doesn't hold the GIL.
+        std::shared_ptr<py::function> run_fn(
+            new py::function(std::move(fn)), [](py::function* f) {
+              pybind11::gil_scoped_acquire gil;
+              delete f;
+            });
+        torch::autograd::CheckpointOptions options;
+        options.keep_outputs_of = std::move(keep_outputs_of);
+        options.preserve_rng_state = preserve_rng_state;
+        return torch::autograd::checkpoint(
+            [run_fn](const torch::autograd::variable_list& inputs) {
+              pybind11::gil_scoped_acquire gil;
+              return (*run_fn)(inputs).cast<torch::autograd::variable_list>();
+            },
+            inputs,
+            options);
+      });
+  m.def("_release_grad", [](const at::Tensor& variable) {
+    torch::autograd::impl::release_grad(variable);
+  });
+  m.def("_accumulate_grad_stats", []() {
+    const auto& stats = torch::autograd::accumulate_grad_stats();
+    py::dict result;
+    result["stolen"] = stats.stolen.load();
+    result["reused"] = stats.reused.load();
+    result["cloned"] = stats.cloned.load();
+    result["accumulated_in_place"] = stats.accumulated_in_place.load();
+    result["accumulated_out_of_place"] = stats.accumulated_out_of_place.load();
+    return result;
+  });
+  m.def("_reset_accumulate_grad_stats", []() {
+    torch::autograd::accumulate_grad_stats().reset();
+  });
+
   Py_RETURN_TRUE;
 }
 
@@ -86,6 +236,26 @@ static PyObject * is_autocast_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_autocast_cpu_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  at::autocast::set_cpu_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autocast_cpu_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (at::autocast::is_cpu_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * clear_autocast_cache(PyObject* _unused, PyObject *arg) {
   HANDLE_TH_ERRORS
   at::autocast::clear_cache();
@@ -93,6 +263,50 @@ static PyObject * clear_autocast_cache(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_autocast_cache_persistent(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("persistent must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  at::autocast::set_cache_persistent(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autocast_cache_persistent(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (at::autocast::is_cache_persistent()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * set_autocast_cache_max_bytes(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!THPUtils_checkLong(arg)) {
+    throw TypeError("max_bytes must be an int (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  at::autocast::set_cache_max_bytes(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * autocast_cache_stats(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  const auto stats = at::autocast::get_cache_stats();
+  return Py_BuildValue(
+      "{s:L,s:L,s:L,s:L,s:L,s:L}",
+      "hits", static_cast<long long>(stats.hits),
+      "misses", static_cast<long long>(stats.misses),
+      "invalidations", static_cast<long long>(stats.invalidations),
+      "evictions", static_cast<long long>(stats.evictions),
+      "entries", static_cast<long long>(stats.entries),
+      "bytes", static_cast<long long>(stats.bytes));
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * autocast_increment_nesting(PyObject* _unused, PyObject *arg) {
   HANDLE_TH_ERRORS
   return THPUtils_packInt64(at::autocast::increment_nesting());
@@ -125,6 +339,26 @@ static PyObject * is_grad_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_inference_mode(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  InferenceMode::set_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_inference_mode_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (InferenceMode::is_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * set_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   HANDLE_TH_ERRORS
   if (!PyBool_Check(arg)) {
@@ -145,17 +379,65 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_autograd_cpu_workers(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!THPUtils_checkLong(arg)) {
+    throw TypeError("num_workers must be an int (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  Engine::get_default_engine().set_num_cpu_workers(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * get_autograd_cpu_workers(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  return THPUtils_packInt64(Engine::get_default_engine().num_cpu_workers());
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * set_autograd_static_schedule(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  Engine::get_default_engine().set_static_schedule_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autograd_static_schedule_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (Engine::get_default_engine().static_schedule_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = { // NOLINT
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
+  {"_set_inference_mode", (PyCFunction)set_inference_mode, METH_O, nullptr},
+  {"_is_inference_mode_enabled", (PyCFunction)is_inference_mode_enabled, METH_NOARGS, nullptr},
   {"set_autocast_enabled", (PyCFunction)set_autocast_enabled, METH_O, nullptr},
   {"is_autocast_enabled", (PyCFunction)is_autocast_enabled, METH_NOARGS, nullptr},
+  {"set_autocast_cpu_enabled", (PyCFunction)set_autocast_cpu_enabled, METH_O, nullptr},
+  {"is_autocast_cpu_enabled", (PyCFunction)is_autocast_cpu_enabled, METH_NOARGS, nullptr},
   {"clear_autocast_cache", (PyCFunction)clear_autocast_cache, METH_NOARGS, nullptr},
+  {"set_autocast_cache_persistent", (PyCFunction)set_autocast_cache_persistent, METH_O, nullptr},
+  {"is_autocast_cache_persistent", (PyCFunction)is_autocast_cache_persistent, METH_NOARGS, nullptr},
+  {"set_autocast_cache_max_bytes", (PyCFunction)set_autocast_cache_max_bytes, METH_O, nullptr},
+  {"autocast_cache_stats", (PyCFunction)autocast_cache_stats, METH_NOARGS, nullptr},
   {"autocast_increment_nesting", (PyCFunction)autocast_increment_nesting, METH_NOARGS, nullptr},
   {"autocast_decrement_nesting", (PyCFunction)autocast_decrement_nesting, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"_set_autograd_cpu_workers", (PyCFunction)set_autograd_cpu_workers, METH_O, nullptr},
+  {"_get_autograd_cpu_workers", (PyCFunction)get_autograd_cpu_workers, METH_NOARGS, nullptr},
+  {"_set_autograd_static_schedule", (PyCFunction)set_autograd_static_schedule, METH_O, nullptr},
+  {"_is_autograd_static_schedule_enabled", (PyCFunction)is_autograd_static_schedule_enabled, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
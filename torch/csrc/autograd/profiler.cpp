@@ -7,11 +7,15 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <torch/library.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <list>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <ATen/record_function.h>
@@ -20,12 +24,19 @@
 
 #include <iostream>
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace torch { namespace autograd { namespace profiler {
 
 namespace {
 
-  constexpr auto kProfilerConfigIValuesSize = 3;
-  constexpr auto kEventIValuesSize = 11;
+  constexpr auto kProfilerConfigIValuesSize = 5;
+  constexpr auto kEventIValuesSize = 14;
   enum EventIValueIdx {
     KIND = 0,
     NAME,
@@ -37,13 +48,18 @@ namespace {
     CUDA_RECORDED,
     CUDA_MEM_USAGE,
     CUDA_DEVICE,
-    CUDA_US
+    CUDA_US,
+    FLOPS,
+    BYTES_MOVED,
+    SEQUENCE_NR
   };
 
   enum ProfilerIValueIdx {
     STATE = 0,
     REPORT_INPUT_SHAPES,
     PROFILE_MEMORY,
+    WITH_FLOPS,
+    WITH_PERF_COUNTERS,
   };
 
 CUDAStubs default_stubs;
@@ -52,6 +68,96 @@ constexpr CUDAStubs* default_stubs_addr = &default_stubs;
 // static initialization calls which may invoke registerCUDAMethods
 static CUDAStubs* cuda_stubs = default_stubs_addr;
 
+CUPTIStubs default_cupti_stubs;
+constexpr CUPTIStubs* default_cupti_stubs_addr = &default_cupti_stubs;
+// Registered from profiler_cupti.cpp, which is only built when CUPTI is found
+static CUPTIStubs* cupti_stubs = default_cupti_stubs_addr;
+
+constexpr size_t kNumPerfCounters = 4;
+
+// The hardware counters of the calling thread, in the order of
+// Event::perf_counters. They are opened as a group, so that they are
+// scheduled together on the PMU and read with a single read().
+class PerfCounterGroup {
+ public:
+  PerfCounterGroup() {
+#ifdef __linux__
+    const uint64_t configs[kNumPerfCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    for (size_t i = 0; i < kNumPerfCounters; ++i) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      // the group starts when its leader is enabled
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      int group_fd = fds_.empty() ? -1 : fds_[0];
+      int fd = static_cast<int>(syscall(
+          __NR_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */,
+          group_fd, 0));
+      if (fd < 0) {
+        closeAll();
+        return;
+      }
+      fds_.push_back(fd);
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  ~PerfCounterGroup() {
+    closeAll();
+  }
+
+  bool valid() const {
+    return !fds_.empty();
+  }
+
+  // Counts since the group was opened, zeros if it couldn't be opened.
+  std::vector<int64_t> values() const {
+    std::vector<int64_t> result(kNumPerfCounters, 0);
+#ifdef __linux__
+    if (valid()) {
+      // PERF_FORMAT_GROUP: the number of counters, then their values
+      uint64_t buffer[kNumPerfCounters + 1];
+      if (::read(fds_[0], buffer, sizeof(buffer)) ==
+          static_cast<ssize_t>(sizeof(buffer))) {
+        for (size_t i = 0; i < kNumPerfCounters; ++i) {
+          result[i] = static_cast<int64_t>(buffer[i + 1]);
+        }
+      }
+    }
+#endif
+    return result;
+  }
+
+ private:
+  void closeAll() {
+#ifdef __linux__
+    for (int fd : fds_) {
+      close(fd);
+    }
+#endif
+    fds_.clear();
+  }
+
+  std::vector<int> fds_;
+};
+
+std::vector<int64_t> readPerfCounters() {
+  thread_local PerfCounterGroup group;
+  return group.values();
+}
+
 // We decompose the profiler logic into the following components:
 //
 // ThreadLocalDebugInfo:
@@ -142,12 +248,130 @@ static CUDAStubs* cuda_stubs = default_stubs_addr;
 //  - save profiling events into the profiling state
 //
 
+// FLOPs and bytes moved by an op, estimated from its inputs by
+// estimateOpCost. Only the ops doing the bulk of the work of the usual models
+// are covered, the others report 0 FLOPs and the bytes of their inputs.
+struct OpCost {
+  int64_t flops = 0;
+  int64_t bytes_moved = 0;
+};
+
+int64_t tensorBytes(const at::Tensor& t) {
+  return t.numel() * t.element_size();
+}
+
+const std::unordered_set<std::string>& elementwiseOps() {
+  static const std::unordered_set<std::string> ops = {
+      "aten::add", "aten::add_", "aten::sub", "aten::sub_",
+      "aten::mul", "aten::mul_", "aten::div", "aten::div_",
+      "aten::addcmul", "aten::addcmul_", "aten::addcdiv", "aten::addcdiv_",
+      "aten::relu", "aten::relu_", "aten::threshold", "aten::threshold_",
+      "aten::threshold_backward", "aten::sigmoid", "aten::sigmoid_",
+      "aten::tanh", "aten::tanh_", "aten::gelu", "aten::exp", "aten::log",
+      "aten::sqrt", "aten::rsqrt", "aten::neg", "aten::abs", "aten::pow",
+      "aten::clamp", "aten::clamp_", "aten::where",
+  };
+  return ops;
+}
+
+// Expands the int[] arguments of the convolutions given as a single value
+int64_t convParam(const c10::List<int64_t>& param, size_t dim) {
+  return param.size() == 1 ? param.get(0) : param.get(dim);
+}
+
+// aten::conv1d/2d/3d(input, weight, bias, stride, padding, dilation, groups)
+// and aten::convolution(input, weight, bias, stride, padding, dilation,
+// transposed, output_padding, groups)
+void estimateConvCost(
+    const std::vector<c10::IValue>& inputs, bool transposed, OpCost& cost) {
+  if (transposed || inputs.size() < 6 || !inputs[0].isTensor() ||
+      !inputs[1].isTensor() || !inputs[3].isIntList() ||
+      !inputs[4].isIntList() || !inputs[5].isIntList()) {
+    return;
+  }
+  const auto& input = inputs[0].toTensor();
+  const auto& weight = inputs[1].toTensor();
+  if (!input.defined() || !weight.defined() || input.dim() != weight.dim() ||
+      input.dim() < 3) {
+    return;
+  }
+  auto stride = inputs[3].toIntList();
+  auto padding = inputs[4].toIntList();
+  auto dilation = inputs[5].toIntList();
+  // weight is [out channels, in channels / groups, kernel...]
+  int64_t output_numel = input.size(0) * weight.size(0);
+  int64_t kernel_numel = weight.size(1);
+  for (int64_t d = 2; d < input.dim(); d++) {
+    size_t i = d - 2;
+    int64_t output_size = (input.size(d) + 2 * convParam(padding, i) -
+        convParam(dilation, i) * (weight.size(d) - 1) - 1) /
+        convParam(stride, i) + 1;
+    output_numel *= output_size;
+    kernel_numel *= weight.size(d);
+  }
+  // a multiply and an add per weight and output element
+  cost.flops = 2 * output_numel * kernel_numel;
+  cost.bytes_moved += output_numel * input.element_size();
+}
+
+OpCost estimateOpCost(
+    const char* name, const std::vector<c10::IValue>& inputs) {
+  OpCost cost;
+  std::vector<at::Tensor> tensors;
+  for (const c10::IValue& input : inputs) {
+    if (input.isTensor()) {
+      auto tensor = input.toTensor();
+      if (tensor.defined()) {
+        cost.bytes_moved += tensorBytes(tensor);
+        tensors.push_back(std::move(tensor));
+      }
+    }
+  }
+  if (tensors.empty()) {
+    return cost;
+  }
+
+  const std::string op(name);
+  if ((op == "aten::mm" || op == "aten::addmm") && tensors.size() >= 2) {
+    const auto& a = tensors[tensors.size() - 2];
+    const auto& b = tensors[tensors.size() - 1];
+    if (a.dim() == 2 && b.dim() == 2) {
+      cost.flops = 2 * a.size(0) * a.size(1) * b.size(1);
+      cost.bytes_moved += a.size(0) * b.size(1) * a.element_size();
+    }
+  } else if ((op == "aten::bmm" || op == "aten::baddbmm") && tensors.size() >= 2) {
+    const auto& a = tensors[tensors.size() - 2];
+    const auto& b = tensors[tensors.size() - 1];
+    if (a.dim() == 3 && b.dim() == 3) {
+      cost.flops = 2 * a.size(0) * a.size(1) * a.size(2) * b.size(2);
+      cost.bytes_moved += a.size(0) * a.size(1) * b.size(2) * a.element_size();
+    }
+  } else if (op == "aten::conv1d" || op == "aten::conv2d" || op == "aten::conv3d") {
+    estimateConvCost(inputs, /* transposed */ false, cost);
+  } else if (op == "aten::convolution") {
+    estimateConvCost(
+        inputs, inputs.size() > 6 && inputs[6].isBool() && inputs[6].toBool(), cost);
+  } else if (elementwiseOps().count(op)) {
+    // one FLOP per output element, the output having the broadcast size of
+    // the inputs
+    int64_t numel = 0;
+    for (const auto& t : tensors) {
+      numel = std::max(numel, t.numel());
+    }
+    cost.flops = numel;
+    cost.bytes_moved += numel * tensors[0].element_size();
+  }
+  return cost;
+}
+
 // Profiler state
 struct ProfilerThreadLocalState
     : public c10::MemoryReportingInfoBase {
   explicit ProfilerThreadLocalState(
       const ProfilerConfig& config)
-    : config_(config), remoteProfiledEvents_{c10::nullopt} {}
+    : config_(config),
+      remoteProfiledEvents_{c10::nullopt},
+      id_(next_state_id_++) {}
   ~ProfilerThreadLocalState() override = default;
 
   inline const ProfilerConfig& config() const {
@@ -155,13 +379,23 @@ struct ProfilerThreadLocalState
   }
 
   thread_event_lists consolidate() {
-    std::lock_guard<std::mutex> g(state_mutex_);
+    // The events are moved out of the lists without holding the state lock,
+    // which would block the threads still registering their lists
+    std::vector<std::shared_ptr<RangeEventList>> lists;
+    {
+      std::lock_guard<std::mutex> g(state_mutex_);
+      lists.reserve(event_lists_map_.size());
+      for (auto& kv : event_lists_map_) {
+        lists.push_back(kv.second);
+      }
+    }
     thread_event_lists result;
-    for (auto& kv : event_lists_map_) {
-      auto& list = kv.second;
+    result.reserve(lists.size());
+    for (auto& list : lists) {
       result.emplace_back(list->consolidate());
     }
     // Consolidate remote events if applicable as well.
+    std::lock_guard<std::mutex> g(state_mutex_);
     if (remoteProfiledEvents_) {
       result.insert(
           result.end(),
@@ -205,23 +439,35 @@ struct ProfilerThreadLocalState
       const at::StringView& name,
       const char* msg = "",
       int64_t sequence_nr = -1,
-      std::vector<std::vector<int64_t>>&& shapes = {},
-      at::RecordFunctionHandle handle = 0) {
+      std::vector<int64_t>&& flat_shapes = {},
+      at::RecordFunctionHandle handle = 0,
+      const OpCost& cost = {}) {
     if (config_.state == ProfilerState::Disabled) {
       return;
     }
     if (config_.state == ProfilerState::NVTX) {
       cuda_stubs->nvtxRangePushA(getNvtxStr(
-          name, msg, sequence_nr, shapes).c_str());
+          name, msg, sequence_nr, flat_shapes).c_str());
     } else {
-      getEventList().record(
+      Event evt(
           EventKind::PushRange,
           name,
           at::RecordFunction::currentThreadId(),
           config_.state == ProfilerState::CUDA,
           handle,
-          std::move(shapes),
+          {},
           at::RecordFunction::getDefaultNodeId());
+      evt.setFlatShapes(std::move(flat_shapes));
+      evt.setOpCost(cost.flops, cost.bytes_moved);
+      evt.setSequenceNr(sequence_nr);
+      if (config_.with_perf_counters) {
+        // last, to leave out the cost of recording the event
+        evt.setPerfCounters(readPerfCounters());
+      }
+      getEventList().record(std::move(evt));
+      if (config_.state == ProfilerState::CUPTI) {
+        cupti_stubs->pushCorrelationId(handle);
+      }
     }
   }
 
@@ -236,12 +482,23 @@ struct ProfilerThreadLocalState
       // called on a different thread than pushRange
       // As a convention, we put the async pop on the original
       // thread and save current thread id in pop event
+      if (config_.state == ProfilerState::CUPTI &&
+          thread_id == at::RecordFunction::currentThreadId()) {
+        // CUPTI correlation ids are kept in a per thread stack, so the async
+        // ranges leave their id on the stack of the original thread
+        cupti_stubs->popCorrelationId();
+      }
+      std::vector<int64_t> perf_counters;
+      if (config_.with_perf_counters) {
+        perf_counters = readPerfCounters();
+      }
       Event evt(EventKind::PopRange,
           at::StringView(""),
           at::RecordFunction::currentThreadId(),
           config_.state == ProfilerState::CUDA,
           handle);
       evt.setNodeId(at::RecordFunction::getDefaultNodeId());
+      evt.setPerfCounters(std::move(perf_counters));
       getEventList(thread_id).record(std::move(evt));
     }
   }
@@ -258,13 +515,15 @@ struct ProfilerThreadLocalState
       void* /* unused */, int64_t alloc_size, c10::Device device) override {
     if (config_.profile_memory && config_.state != ProfilerState::Disabled) {
       uint64_t thread_id = at::RecordFunction::currentThreadId();
+      // Allocations are attributed to the enclosing ranges by their CPU
+      // time, recording a CUDA event for each of them would only add a sync
       Event evt(
           EventKind::MemoryAlloc,
           at::StringView(""),
           thread_id,
-          config_.state == ProfilerState::CUDA);
+          /* record_cuda */ false);
       evt.updateMemoryStats(alloc_size, device);
-      getEventList(thread_id).record(evt);
+      getEventList(thread_id).record(std::move(evt));
     }
   }
 
@@ -277,28 +536,28 @@ struct ProfilerThreadLocalState
       const at::StringView& name,
       const char* msg,
       int64_t sequence_nr,
-      const std::vector<std::vector<int64_t>>& shapes) const {
-    if (sequence_nr >= 0 || shapes.size() > 0) {
+      const std::vector<int64_t>& flat_shapes) const {
+    if (sequence_nr >= 0 || flat_shapes.size() > 0) {
       std::stringstream s;
       if (sequence_nr >= 0) {
         s << name.str() << msg << sequence_nr;
       }
-      if (shapes.size() > 0) {
+      if (flat_shapes.size() > 0) {
         s << ", sizes = [";
-        for (size_t idx = 0; idx < shapes.size(); ++idx) {
-          if (shapes[idx].size() > 0) {
-            s << "[";
-            for (size_t dim = 0; dim < shapes[idx].size(); ++dim) {
-              s << shapes[idx][dim];
-              if (dim < shapes[idx].size() - 1) {
-                s << ", ";
-              }
+        // see Event::setFlatShapes for the encoding
+        size_t idx = 0;
+        while (idx < flat_shapes.size()) {
+          int64_t dims = flat_shapes[idx];
+          s << "[";
+          for (int64_t dim = 0; dim < dims; ++dim) {
+            s << flat_shapes[idx + 1 + dim];
+            if (dim < dims - 1) {
+              s << ", ";
             }
-            s << "]";
-          } else {
-            s << "[]";
           }
-          if (idx < shapes.size() - 1) {
+          s << "]";
+          idx += dims + 1;
+          if (idx < flat_shapes.size()) {
             s << ", ";
           }
         }
@@ -311,18 +570,34 @@ struct ProfilerThreadLocalState
   }
 
   RangeEventList& getEventList(int64_t thread_id = -1) {
+    int64_t current_thread_id = at::RecordFunction::currentThreadId();
     if (thread_id < 0) {
-      thread_id = at::RecordFunction::currentThreadId();
+      thread_id = current_thread_id;
+    }
+    // The list of the current thread is cached in a thread local, so that
+    // recording an event doesn't take the state lock
+    static thread_local uint64_t cached_state_id = 0;
+    static thread_local RangeEventList* cached_list = nullptr;
+    bool is_current_thread = thread_id == current_thread_id;
+    if (is_current_thread && cached_state_id == id_) {
+      return *cached_list;
     }
+
     RangeEventList* list_ptr = nullptr;
-    std::lock_guard<std::mutex> guard(state_mutex_);
-    auto it = event_lists_map_.find(thread_id);
-    if (it != event_lists_map_.end()) {
-      list_ptr = it->second.get();
-    } else {
-      auto event_list = std::make_shared<RangeEventList>();
-      event_lists_map_[thread_id] = event_list;
-      list_ptr = event_list.get();
+    {
+      std::lock_guard<std::mutex> guard(state_mutex_);
+      auto it = event_lists_map_.find(thread_id);
+      if (it != event_lists_map_.end()) {
+        list_ptr = it->second.get();
+      } else {
+        auto event_list = std::make_shared<RangeEventList>();
+        event_lists_map_[thread_id] = event_list;
+        list_ptr = event_list.get();
+      }
+    }
+    if (is_current_thread) {
+      cached_state_id = id_;
+      cached_list = list_ptr;
     }
     return *list_ptr;
   }
@@ -334,13 +609,51 @@ struct ProfilerThreadLocalState
   ProfilerConfig config_ = ProfilerConfig(ProfilerState::Disabled, false, false);
   at::CallbackHandle handle_ = 0;
   c10::optional<std::vector<std::vector<Event>>> remoteProfiledEvents_;
+  // Unique per profiling run (unlike the address of the state, which may be
+  // reused), to invalidate the cached event lists of getEventList
+  static std::atomic<uint64_t> next_state_id_;
+  const uint64_t id_;
 };
 
+std::atomic<uint64_t> ProfilerThreadLocalState::next_state_id_{1};
+
 ProfilerThreadLocalState* getProfilerTLSState() {
   const auto& state = c10::ThreadLocalDebugInfo::get(c10::DebugInfoKind::PROFILER_STATE);
   return dynamic_cast<ProfilerThreadLocalState*>(state.get());
 }
 
+// Input shapes in the flat encoding of Event::setFlatShapes, non tensor and
+// undefined tensor inputs having no dimensions. Sized upfront and filled from
+// the TensorImpls, to take a single allocation and no refcount bumps.
+std::vector<int64_t> flatInputShapes(const at::RecordFunction& fn) {
+  const auto& inputs = fn.inputs();
+  auto tensorImpl = [](const c10::IValue& input) -> const at::TensorImpl* {
+    if (!input.isTensor()) {
+      return nullptr;
+    }
+    auto* impl = input.unsafeToTensorImpl();
+    return impl == at::UndefinedTensorImpl::singleton() ? nullptr : impl;
+  };
+  size_t size = inputs.size();
+  for (const c10::IValue& input : inputs) {
+    if (auto* impl = tensorImpl(input)) {
+      size += impl->dim();
+    }
+  }
+  std::vector<int64_t> flat_shapes;
+  flat_shapes.reserve(size);
+  for (const c10::IValue& input : inputs) {
+    if (auto* impl = tensorImpl(input)) {
+      auto sizes = impl->sizes();
+      flat_shapes.push_back(sizes.size());
+      flat_shapes.insert(flat_shapes.end(), sizes.begin(), sizes.end());
+    } else {
+      flat_shapes.push_back(0);
+    }
+  }
+  return flat_shapes;
+}
+
 void pushProfilingCallbacks() {
   auto state_ptr = getProfilerTLSState();
   TORCH_INTERNAL_ASSERT(state_ptr, "Expected profiler state set");
@@ -352,25 +665,15 @@ void pushProfilingCallbacks() {
         }
 
         auto* msg = (fn.seqNr() >= 0) ? ", seq = " : "";
+        OpCost cost;
+        if (state_ptr->config().with_flops) {
+          cost = estimateOpCost(fn.name().str(), fn.inputs());
+        }
         if (state_ptr->config().report_input_shapes) {
-          std::vector<std::vector<int64_t>> inputSizes;
-          inputSizes.reserve(fn.inputs().size());
-          for (const c10::IValue& input : fn.inputs()) {
-            if (!input.isTensor()) {
-              inputSizes.emplace_back();
-              continue;
-            }
-            const at::Tensor& tensor = input.toTensor();
-            if (tensor.defined()) {
-              inputSizes.push_back(input.toTensor().sizes().vec());
-            } else {
-              inputSizes.emplace_back();
-            }
-          }
           state_ptr->pushRange(
-              fn.name(), msg, fn.seqNr(), std::move(inputSizes), fn.handle());
+              fn.name(), msg, fn.seqNr(), flatInputShapes(fn), fn.handle(), cost);
         } else {
-          state_ptr->pushRange(fn.name(), msg, fn.seqNr(), {}, fn.handle());
+          state_ptr->pushRange(fn.name(), msg, fn.seqNr(), {}, fn.handle(), cost);
         }
       },
       [](const at::RecordFunction& fn) {
@@ -380,7 +683,8 @@ void pushProfilingCallbacks() {
         }
         state_ptr->popRange(fn.getStartCallbacksThreadId(), fn.handle());
       })
-    .needsInputs(state_ptr->config().report_input_shapes)
+    .needsInputs(state_ptr->config().report_input_shapes ||
+                 state_ptr->config().with_flops)
     .needsIds(true));
   state_ptr->setCallbackHandle(handle);
 }
@@ -396,6 +700,18 @@ void registerCUDAMethods(CUDAStubs* stubs) {
   cuda_stubs = stubs;
 }
 
+void registerCUPTIMethods(CUPTIStubs* stubs) {
+  cupti_stubs = stubs;
+}
+
+bool cuptiAvailable() {
+  return cupti_stubs->enabled();
+}
+
+bool perfCountersAvailable() {
+  return PerfCounterGroup().valid();
+}
+
 ProfilerConfig::~ProfilerConfig() = default;
 
 at::IValue ProfilerConfig::toIValue() const {
@@ -404,6 +720,8 @@ at::IValue ProfilerConfig::toIValue() const {
   eventIValueList.emplace_back(static_cast<int64_t>(state));
   eventIValueList.emplace_back(report_input_shapes);
   eventIValueList.emplace_back(profile_memory);
+  eventIValueList.emplace_back(with_flops);
+  eventIValueList.emplace_back(with_perf_counters);
   return eventIValueList;
 }
 
@@ -422,7 +740,9 @@ ProfilerConfig ProfilerConfig::fromIValue(
   return ProfilerConfig(
       static_cast<ProfilerState>(ivalues.get(ProfilerIValueIdx::STATE).toInt()),
       ivalues.get(ProfilerIValueIdx::REPORT_INPUT_SHAPES).toBool(),
-      ivalues.get(ProfilerIValueIdx::PROFILE_MEMORY).toBool());
+      ivalues.get(ProfilerIValueIdx::PROFILE_MEMORY).toBool(),
+      ivalues.get(ProfilerIValueIdx::WITH_FLOPS).toBool(),
+      ivalues.get(ProfilerIValueIdx::WITH_PERF_COUNTERS).toBool());
 }
 
 ProfilerConfig getProfilerConfig() {
@@ -441,6 +761,11 @@ bool profilerEnabled() {
 void enableProfiler(const ProfilerConfig& new_config) {
   TORCH_CHECK(new_config.state != ProfilerState::NVTX || cuda_stubs->enabled(),
     "Can't use NVTX profiler - PyTorch was compiled without CUDA");
+  TORCH_CHECK(new_config.state != ProfilerState::CUPTI || cupti_stubs->enabled(),
+    "Can't use CUPTI profiler - PyTorch was compiled without CUPTI");
+  TORCH_CHECK(!new_config.with_perf_counters || perfCountersAvailable(),
+    "Can't read the hardware performance counters - requires Linux and "
+    "kernel.perf_event_paranoid <= 2");
 
   auto state_ptr = getProfilerTLSState();
   TORCH_CHECK(!state_ptr, "Profiler is already enabled on this thread");
@@ -448,6 +773,12 @@ void enableProfiler(const ProfilerConfig& new_config) {
   auto state = std::make_shared<ProfilerThreadLocalState>(new_config);
   c10::ThreadLocalDebugInfo::_push(c10::DebugInfoKind::PROFILER_STATE, state);
 
+  if (new_config.state == ProfilerState::CUPTI) {
+    // before the callbacks, so that no range pushes a correlation id
+    // while the activities are not collected
+    cupti_stubs->enableActivities();
+  }
+
   pushProfilingCallbacks();
   g_.emplace_back(std::make_shared<at::RecordFunctionGuard>());
 
@@ -472,6 +803,11 @@ void enableProfiler(const ProfilerConfig& new_config) {
 }
 
 thread_event_lists disableProfiler() {
+  return disableProfilerWithCUDAActivities().first;
+}
+
+std::pair<thread_event_lists, std::vector<CUDAActivity>>
+disableProfilerWithCUDAActivities() {
   // all the DebugInfoBase objects are scope based and supposed to use DebugInfoGuard
   auto state = c10::ThreadLocalDebugInfo::_pop(c10::DebugInfoKind::PROFILER_STATE);
   auto state_ptr = static_cast<ProfilerThreadLocalState*>(state.get());
@@ -482,12 +818,16 @@ thread_event_lists disableProfiler() {
   at::removeCallback(state_ptr->callbackHandle());
 
   if (state_ptr->config().state == ProfilerState::NVTX) {
-    return thread_event_lists();
+    return {};
   }
 
   state_ptr->mark("__stop_profile");
 
-  return state_ptr->consolidate();
+  std::vector<CUDAActivity> activities;
+  if (state_ptr->config().state == ProfilerState::CUPTI) {
+    activities = cupti_stubs->disableActivities();
+  }
+  return {state_ptr->consolidate(), std::move(activities)};
 }
 
 void addEventList(std::vector<Event>&& profiledEvents) {
@@ -532,6 +872,10 @@ void Event::record(bool record_cuda) {
       ivalues.get(EventIValueIdx::CUDA_DEVICE).toInt(), // device
       ivalues.get(EventIValueIdx::CUDA_US).toInt() // cuda_us
   );
+  evt.setOpCost(
+      ivalues.get(EventIValueIdx::FLOPS).toInt(),
+      ivalues.get(EventIValueIdx::BYTES_MOVED).toInt());
+  evt.setSequenceNr(ivalues.get(EventIValueIdx::SEQUENCE_NR).toInt());
   return evt;
 }
 
@@ -551,6 +895,9 @@ at::IValue Event::toIValue() const {
   eventIValueList.emplace_back(static_cast<int64_t>(cuda_memory_usage_));
   eventIValueList.emplace_back(device_);
   eventIValueList.emplace_back(cuda_us_);
+  eventIValueList.emplace_back(flops_);
+  eventIValueList.emplace_back(bytes_moved_);
+  eventIValueList.emplace_back(sequence_nr_);
   return at::IValue(eventIValueList);
 }
 
@@ -570,6 +917,8 @@ double Event::cuda_elapsed_us(const Event & e) const {
 
 CUDAStubs::~CUDAStubs() = default;
 
+CUPTIStubs::~CUPTIStubs() = default;
+
 
 static jit::CodeTemplate event_template(R"(
 {
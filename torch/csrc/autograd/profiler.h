@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <string>
 #include <sstream>
+#include <deque>
 #include <forward_list>
 #include <tuple>
 #include <ATen/ATen.h>
@@ -64,6 +65,57 @@ private:
 
 TORCH_API void registerCUDAMethods(CUDAStubs* stubs);
 
+// A kernel, memcpy or memset executed on a GPU, as recorded by CUPTI.
+struct TORCH_API CUDAActivity {
+  std::string name;
+  // "kernel", "memcpy" or "memset"
+  std::string kind;
+  int device = -1;
+  int64_t stream = -1;
+  // Execution interval on the GPU, converted to the getTime() clock.
+  int64_t start_ns = 0;
+  int64_t end_ns = 0;
+  // Handle of the innermost RecordFunction range that was open on the
+  // launching thread, 0 if the activity was launched outside of any range.
+  at::RecordFunctionHandle correlation_id = 0;
+};
+
+// Collects CUDA activity records with CUPTI. Unlike the cudaEvent based
+// CUDAStubs::record, nothing is inserted into the CUDA streams: CUPTI fills
+// buffers asynchronously, which are only flushed when the profiler is
+// disabled, and the records carry the actual execution time of each kernel.
+struct TORCH_API CUPTIStubs {
+  // Starts collecting the activity records of all the devices.
+  virtual void enableActivities() {
+    fail();
+  }
+  // Stops collecting and returns the records collected since
+  // enableActivities, sorted by start time.
+  virtual std::vector<CUDAActivity> disableActivities() {
+    fail();
+    return {};
+  }
+  // The activities launched by the current thread between a push and the
+  // matching pop are correlated to handle.
+  virtual void pushCorrelationId(at::RecordFunctionHandle handle) {
+    fail();
+  }
+  virtual void popCorrelationId() {
+    fail();
+  }
+  virtual bool enabled() {
+    return false;
+  }
+  virtual ~CUPTIStubs();
+
+private:
+  void fail() {
+    AT_ERROR("CUPTI used in profiler but PyTorch was compiled without CUPTI.");
+  }
+};
+
+TORCH_API void registerCUPTIMethods(CUPTIStubs* stubs);
+
 constexpr inline size_t ceilToMultiple(size_t a, size_t b) {
   return ((a + b - 1) / b) * b;
 }
@@ -98,20 +150,30 @@ enum class TORCH_API ProfilerState {
     CPU, // CPU-only profiling
     CUDA, // CPU + CUDA events
     NVTX,  // only emit NVTX markers
+    CUPTI, // CPU events + CUDA activity records collected with CUPTI
 };
 
 struct TORCH_API ProfilerConfig {
   ProfilerConfig(
       ProfilerState state,
       bool report_input_shapes,
-      bool profile_memory)
+      bool profile_memory,
+      bool with_flops = false,
+      bool with_perf_counters = false)
       : state(state),
         report_input_shapes(report_input_shapes),
-        profile_memory(profile_memory) {}
+        profile_memory(profile_memory),
+        with_flops(with_flops),
+        with_perf_counters(with_perf_counters) {}
   ~ProfilerConfig();
   ProfilerState state;
   bool report_input_shapes;
   bool profile_memory;
+  // Estimate the FLOPs and the bytes moved by the ops from their inputs.
+  bool with_flops;
+  // Read the hardware counters of the thread at the start and end of the
+  // ranges, see Event::perf_counters.
+  bool with_perf_counters;
 
   // Returns IValues corresponding to ProfilerConfig struct, to be used for
   // serialization.
@@ -145,7 +207,7 @@ struct TORCH_API Event final {
         kind_(kind),
         thread_id_(thread_id),
         handle_(handle),
-        shapes_(shapes),
+        shapes_(flattenShapes(shapes)),
         node_id_(node_id) {
     record(record_cuda);
   }
@@ -170,7 +232,7 @@ struct TORCH_API Event final {
         kind_(kind),
         thread_id_(thread_id),
         handle_(handle),
-        shapes_(shapes),
+        shapes_(flattenShapes(shapes)),
         cpu_memory_usage_(cpu_memory_usage),
         cuda_memory_usage_(cuda_memory_usage),
         device_(device),
@@ -215,7 +277,19 @@ struct TORCH_API Event final {
     return thread_id_;
   }
   std::vector<std::vector<int64_t>> shapes() const {
-    return shapes_;
+    std::vector<std::vector<int64_t>> result;
+    for (size_t i = 0; i < shapes_.size(); i += shapes_[i] + 1) {
+      result.emplace_back(
+          shapes_.begin() + i + 1, shapes_.begin() + i + 1 + shapes_[i]);
+    }
+    return result;
+  }
+
+  // Sets the input shapes from their flat encoding, the number of dimensions
+  // of each input followed by its sizes, which takes a single allocation per
+  // event instead of one per input.
+  void setFlatShapes(std::vector<int64_t>&& flat_shapes) {
+    shapes_ = std::move(flat_shapes);
   }
   double cpu_elapsed_us(const Event & e) const {
     return (e.cpu_ns_ - cpu_ns_)/(1000.0);
@@ -276,14 +350,62 @@ struct TORCH_API Event final {
     cuda_us_ = cuda_us;
 }
 
+  // Estimated FLOPs and bytes read and written by the op of a PushRange
+  // event, 0 if not profiled with ProfilerConfig::with_flops or unknown.
+  int64_t flops() const {
+    return flops_;
+  }
+
+  int64_t bytes_moved() const {
+    return bytes_moved_;
+  }
+
+  void setOpCost(int64_t flops, int64_t bytes_moved) {
+    flops_ = flops;
+    bytes_moved_ = bytes_moved;
+  }
+
+  // Sequence number of the RecordFunction of a PushRange event, -1 if none
+  // (e.g. the autograd sequence number of an op, or the number of a c10d
+  // collective in its process group).
+  int64_t sequence_nr() const {
+    return sequence_nr_;
+  }
+
+  void setSequenceNr(int64_t sequence_nr) {
+    sequence_nr_ = sequence_nr;
+  }
+
+  // Hardware counters of the thread when the event was recorded with
+  // ProfilerConfig::with_perf_counters: cycles, instructions, last level
+  // cache misses and branch mispredictions, in this order. Empty otherwise.
+  const std::vector<int64_t>& perf_counters() const {
+    return perf_counters_;
+  }
+
+  void setPerfCounters(std::vector<int64_t>&& perf_counters) {
+    perf_counters_ = std::move(perf_counters);
+  }
+
 private:
+  static std::vector<int64_t> flattenShapes(
+      const std::vector<std::vector<int64_t>>& shapes) {
+    std::vector<int64_t> flat;
+    for (const auto& shape : shapes) {
+      flat.push_back(shape.size());
+      flat.insert(flat.end(), shape.begin(), shape.end());
+    }
+    return flat;
+  }
+
   // signed to allow for negative intervals, initialized for safety.
   int64_t cpu_ns_ = 0;
   at::StringView name_;
   EventKind kind_;
   uint16_t thread_id_;
   at::RecordFunctionHandle handle_ {0};
-  std::vector<std::vector<int64_t>> shapes_;
+  // see setFlatShapes
+  std::vector<int64_t> shapes_;
   int64_t cpu_memory_usage_ = 0;
   int64_t cuda_memory_usage_ = 0;
   int device_ = -1;
@@ -291,45 +413,57 @@ private:
   int node_id_ = 0;
   bool is_remote_ = false;
   int64_t cuda_us_ = -1;
+  int64_t flops_ = 0;
+  int64_t bytes_moved_ = 0;
+  int64_t sequence_nr_ = -1;
+  std::vector<int64_t> perf_counters_;
 };
 
-// a linked-list of fixed sized vectors, to avoid
+// a list of fixed sized blocks of events, to avoid
 // a std::vector resize from taking a large amount of time inside
-// a profiling  event
+// a profiling  event. The blocks are only merged by consolidate.
 struct RangeEventList {
-  RangeEventList() {
-    events_.reserve(kReservedCapacity);
-  }
-
   template<typename... Args>
   void record(Args&&... args) {
     std::lock_guard<std::mutex> guard(mutex_);
-    events_.emplace_back(std::forward<Args>(args)...);
+    if (blocks_.empty() || blocks_.back().size() == kBlockSize) {
+      blocks_.emplace_back();
+      blocks_.back().reserve(kBlockSize);
+    }
+    blocks_.back().emplace_back(std::forward<Args>(args)...);
   }
 
   std::vector<Event> consolidate() {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<Event> result;
-    result.insert(
-        result.begin(),
-        std::make_move_iterator(events_.begin()),
-        std::make_move_iterator(events_.end()));
-    events_.erase(events_.begin(), events_.end());
+    result.reserve(sizeLocked());
+    for (auto& block : blocks_) {
+      result.insert(
+          result.end(),
+          std::make_move_iterator(block.begin()),
+          std::make_move_iterator(block.end()));
+    }
+    blocks_.clear();
     return result;
   }
 
   size_t size() {
     std::lock_guard<std::mutex> lock(mutex_);
-    return events_.size();
+    return sizeLocked();
   }
 
  private:
-  // This mutex is used to serialize access when different threads are writing
-  // to the same instance of RangeEventList.
+  size_t sizeLocked() const {
+    return blocks_.empty()
+        ? 0 : (blocks_.size() - 1) * kBlockSize + blocks_.back().size();
+  }
+
+  // Each list is written by its own thread, this mutex is only contended by
+  // the async ranges that end on a different thread than they started.
   std::mutex mutex_;
-  std::vector<Event> events_;
+  std::deque<std::vector<Event>> blocks_;
 
-  static const size_t kReservedCapacity = 1024;
+  static const size_t kBlockSize = 1024;
 };
 
 using thread_event_lists = std::vector<std::vector<Event>>;
@@ -337,6 +471,18 @@ using thread_event_lists = std::vector<std::vector<Event>>;
 // across thread boundary (e.g. at::launch tasks)
 TORCH_API void enableProfiler(const ProfilerConfig&);
 TORCH_API thread_event_lists disableProfiler();
+// Same as disableProfiler, but also returns the CUDA activity records
+// collected in ProfilerState::CUPTI mode (empty in the other modes).
+TORCH_API std::pair<thread_event_lists, std::vector<CUDAActivity>>
+disableProfilerWithCUDAActivities();
+// Returns if PyTorch was compiled with CUPTI, i.e. ProfilerState::CUPTI can
+// be used.
+TORCH_API bool cuptiAvailable();
+
+// Whether the hardware counters of ProfilerConfig::with_perf_counters can be
+// read: requires Linux and a perf_event_paranoid level allowing to count the
+// events of the process.
+TORCH_API bool perfCountersAvailable();
 // adds profiledEvents to the current thread local recorded events. Each event
 // will be marked with node ID given by fromNodeId.
 TORCH_API void addEventList(std::vector<Event>&& profiledEvents);
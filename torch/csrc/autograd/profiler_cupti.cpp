@@ -0,0 +1,240 @@
+#include <torch/csrc/autograd/profiler.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Type.h>
+#include <cupti.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+namespace torch { namespace autograd { namespace profiler {
+
+namespace {
+
+#define TORCH_CUPTI_CHECK(EXPR)                                   \
+  do {                                                            \
+    CUptiResult __err = EXPR;                                     \
+    if (__err != CUPTI_SUCCESS) {                                 \
+      const char* __msg = nullptr;                                \
+      cuptiGetResultString(__err, &__msg);                        \
+      AT_ERROR("CUPTI error: ", __msg ? __msg : "unknown error"); \
+    }                                                             \
+  } while (0)
+
+// CUPTI requests buffers from its own threads and hands them back once they
+// are full, or on cuptiActivityFlushAll. The records have to be 8-byte
+// aligned.
+constexpr size_t kBufferSize = 4 * 1024 * 1024;
+constexpr size_t kBufferAlignment = 8;
+
+constexpr CUpti_ActivityKind kActivityKinds[] = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL,
+    CUPTI_ACTIVITY_KIND_MEMCPY,
+    CUPTI_ACTIVITY_KIND_MEMSET,
+    CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION,
+};
+
+const char* memcpyName(uint8_t copy_kind) {
+  switch (copy_kind) {
+    case CUPTI_ACTIVITY_MEMCPY_KIND_HTOD: return "Memcpy HtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOH: return "Memcpy DtoH";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_DTOD: return "Memcpy DtoD";
+    case CUPTI_ACTIVITY_MEMCPY_KIND_PTOP: return "Memcpy PtoP";
+    default: return "Memcpy";
+  }
+}
+
+// The records collected between enableActivities and disableActivities.
+// Their correlation ids are the CUPTI ones (one per CUDA API call) until
+// disableActivities maps them to the RecordFunction handles, using the
+// external correlation records.
+struct ActivityBuffer {
+  std::mutex mutex;
+  std::vector<CUDAActivity> activities;
+  std::unordered_map<uint32_t, at::RecordFunctionHandle> external_ids;
+};
+
+ActivityBuffer& activityBuffer() {
+  static ActivityBuffer buffer;
+  return buffer;
+}
+
+void CUPTIAPI bufferRequested(
+    uint8_t** buffer, size_t* size, size_t* max_num_records) {
+  // Kept on the heap until bufferCompleted, aligned_alloc is not available
+  // on all the supported platforms
+  auto* raw = static_cast<uint8_t*>(malloc(kBufferSize + kBufferAlignment));
+  TORCH_INTERNAL_ASSERT(raw, "Could not allocate a CUPTI activity buffer");
+  size_t offset = kBufferAlignment -
+      (reinterpret_cast<uintptr_t>(raw) % kBufferAlignment);
+  // Store the offset right before the aligned buffer to free it afterwards
+  raw[offset - 1] = static_cast<uint8_t>(offset);
+  *buffer = raw + offset;
+  *size = kBufferSize;
+  *max_num_records = 0;
+}
+
+void CUPTIAPI bufferCompleted(
+    CUcontext /* unused */,
+    uint32_t /* unused */,
+    uint8_t* buffer,
+    size_t /* unused */,
+    size_t valid_size) {
+  auto& state = activityBuffer();
+  {
+    std::lock_guard<std::mutex> guard(state.mutex);
+    CUpti_Activity* record = nullptr;
+    while (cuptiActivityGetNextRecord(buffer, valid_size, &record) ==
+           CUPTI_SUCCESS) {
+      CUDAActivity activity;
+      switch (record->kind) {
+        case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+          auto* kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+          activity.name = c10::demangle(kernel->name);
+          activity.kind = "kernel";
+          activity.device = kernel->deviceId;
+          activity.stream = kernel->streamId;
+          activity.start_ns = kernel->start;
+          activity.end_ns = kernel->end;
+          activity.correlation_id = kernel->correlationId;
+          break;
+        }
+        case CUPTI_ACTIVITY_KIND_MEMCPY: {
+          auto* copy = reinterpret_cast<CUpti_ActivityMemcpy*>(record);
+          activity.name = memcpyName(copy->copyKind);
+          activity.kind = "memcpy";
+          activity.device = copy->deviceId;
+          activity.stream = copy->streamId;
+          activity.start_ns = copy->start;
+          activity.end_ns = copy->end;
+          activity.correlation_id = copy->correlationId;
+          break;
+        }
+        case CUPTI_ACTIVITY_KIND_MEMSET: {
+          auto* set = reinterpret_cast<CUpti_ActivityMemset*>(record);
+          activity.name = "Memset";
+          activity.kind = "memset";
+          activity.device = set->deviceId;
+          activity.stream = set->streamId;
+          activity.start_ns = set->start;
+          activity.end_ns = set->end;
+          activity.correlation_id = set->correlationId;
+          break;
+        }
+        case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+          auto* correlation =
+              reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+          state.external_ids[correlation->correlationId] =
+              correlation->externalId;
+          continue;
+        }
+        default:
+          continue;
+      }
+      state.activities.push_back(std::move(activity));
+    }
+  }
+  uint8_t* raw = buffer - buffer[-1];
+  free(raw);
+}
+
+struct CUPTIMethods : public CUPTIStubs {
+  void enableActivities() override {
+    std::lock_guard<std::mutex> guard(mutex_);
+    TORCH_CHECK(!active_, "CUPTI profiler is already enabled in this process");
+    if (!callbacks_registered_) {
+      TORCH_CUPTI_CHECK(
+          cuptiActivityRegisterCallbacks(bufferRequested, bufferCompleted));
+      callbacks_registered_ = true;
+    }
+    for (auto kind : kActivityKinds) {
+      TORCH_CUPTI_CHECK(cuptiActivityEnable(kind));
+    }
+    // CUPTI timestamps have their own epoch, record the offset to the
+    // profiler clock once and apply it to all the records
+    uint64_t cupti_ns = 0;
+    TORCH_CUPTI_CHECK(cuptiGetTimestamp(&cupti_ns));
+    clock_offset_ns_ = getTime() - static_cast<int64_t>(cupti_ns);
+    active_ = true;
+  }
+
+  std::vector<CUDAActivity> disableActivities() override {
+    std::lock_guard<std::mutex> guard(mutex_);
+    TORCH_INTERNAL_ASSERT(active_, "CUPTI profiler is not enabled");
+    active_ = false;
+    // The records of the activities still running are not flushed
+    synchronizeDevices();
+    for (auto kind : kActivityKinds) {
+      TORCH_CUPTI_CHECK(cuptiActivityDisable(kind));
+    }
+    TORCH_CUPTI_CHECK(cuptiActivityFlushAll(CUPTI_ACTIVITY_FLAG_FLUSH_FORCED));
+
+    auto& state = activityBuffer();
+    std::vector<CUDAActivity> result;
+    std::unordered_map<uint32_t, at::RecordFunctionHandle> external_ids;
+    {
+      std::lock_guard<std::mutex> buffer_guard(state.mutex);
+      result.swap(state.activities);
+      external_ids.swap(state.external_ids);
+    }
+    for (auto& activity : result) {
+      auto it = external_ids.find(
+          static_cast<uint32_t>(activity.correlation_id));
+      activity.correlation_id = it != external_ids.end() ? it->second : 0;
+      activity.start_ns += clock_offset_ns_;
+      activity.end_ns += clock_offset_ns_;
+    }
+    std::sort(
+        result.begin(),
+        result.end(),
+        [](const CUDAActivity& a, const CUDAActivity& b) {
+          return a.start_ns < b.start_ns;
+        });
+    return result;
+  }
+
+  void pushCorrelationId(at::RecordFunctionHandle handle) override {
+    TORCH_CUPTI_CHECK(cuptiActivityPushExternalCorrelationId(
+        CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, handle));
+  }
+
+  void popCorrelationId() override {
+    uint64_t unused;
+    TORCH_CUPTI_CHECK(cuptiActivityPopExternalCorrelationId(
+        CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, &unused));
+  }
+
+  bool enabled() override {
+    return true;
+  }
+
+ private:
+  void synchronizeDevices() {
+    at::cuda::OptionalCUDAGuard device_guard;
+    int count = at::cuda::device_count();
+    for (int i = 0; i < count; i++) {
+      device_guard.set_index(i);
+      cudaDeviceSynchronize();
+    }
+  }
+
+  std::mutex mutex_;
+  bool active_ = false;
+  bool callbacks_registered_ = false;
+  int64_t clock_offset_ns_ = 0;
+};
+
+struct RegisterCUPTIMethods {
+  RegisterCUPTIMethods() {
+    static CUPTIMethods methods;
+    registerCUPTIMethods(&methods);
+  }
+};
+RegisterCUPTIMethods reg;
+
+} // namespaces
+} // namespace profiler
+} // namespace autograd
+} // namespace torch
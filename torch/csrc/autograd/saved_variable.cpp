@@ -14,8 +14,34 @@
 
 namespace torch { namespace autograd {
 
+namespace {
+thread_local std::shared_ptr<SavedVariableHooks> current_hooks;
+} // namespace
+
+SavedVariableHooksGuard::SavedVariableHooksGuard(
+    std::shared_ptr<SavedVariableHooks> hooks)
+    : prev_hooks_(std::move(current_hooks)) {
+  current_hooks = std::move(hooks);
+}
+
+SavedVariableHooksGuard::~SavedVariableHooksGuard() {
+  current_hooks = std::move(prev_hooks_);
+}
+
+std::shared_ptr<SavedVariableHooks> SavedVariableHooksGuard::get_current() {
+  return current_hooks;
+}
+
+void SavedVariableHooksGuard::set_current(
+    std::shared_ptr<SavedVariableHooks> hooks) {
+  current_hooks = std::move(hooks);
+}
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_inplace_view) {
   if (variable.defined()) {
+    TORCH_CHECK(!variable.is_inference(),
+      "Inference tensors cannot be saved for backward. To work around "
+      "you can make a clone to get a normal tensor and use it in autograd.");
     was_default_constructed_ = false;
     output_nr_ = variable.output_nr();
     requires_grad_ = variable.requires_grad();
@@ -24,6 +50,15 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
     // These copies are all shared_ptr copies, so slightly more expensive.
     // Do them here instead of in the init list in case data is undefined.
     data_ = variable.tensor_data();
+    if (current_hooks) {
+      // Tensors saved by the hooks themselves are saved as usual.
+      auto hooks = current_hooks;
+      SavedVariableHooksGuard no_hooks(nullptr);
+      packed_ = hooks->pack(variable, data_);
+      if (packed_) {
+        data_.reset();
+      }
+    }
     if (variable.is_leaf()) {
       grad_accumulator_ = impl::grad_accumulator(variable);
     } else if (!is_output) {
@@ -37,7 +72,7 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
 }
 
 Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
-  if (!data_.defined()) {
+  if (!data_.defined() && !packed_) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
@@ -54,11 +89,18 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
     grad_fn = std::move(saved_for);
   }
 
+  at::Tensor data = data_;
+  if (packed_) {
+    data = packed_->unpack();
+    TORCH_CHECK(data.defined(),
+        "saved tensor hooks must not unpack an undefined tensor");
+  }
+
   if (saved_version_ != version_counter_.current_version()) {
     std::stringstream message;
     message << "one of the variables needed for gradient computation has been "
-        "modified by an inplace operation: [" << data_.toString() << " "
-        << data_.sizes() << "]";
+        "modified by an inplace operation: [" << data.toString() << " "
+        << data.sizes() << "]";
     if (grad_fn) {
         message << ", which is output " << output_nr_
             << " of " << grad_fn->name() << ",";
@@ -83,9 +125,9 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   // in-place functions on unpacked variables.
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   impl::set_version_counter(var, saved_version_);
 
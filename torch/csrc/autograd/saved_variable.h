@@ -14,6 +14,44 @@ struct Node;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
+/// The stand-in for a tensor that was handed over to `SavedVariableHooks`
+/// when it was saved for backward. `unpack` is called every time the saved
+/// variable is unpacked and must return a tensor with the same metadata as
+/// the one that was saved.
+struct TORCH_API PackedTensor {
+  virtual ~PackedTensor() = default;
+  virtual at::Tensor unpack() = 0;
+};
+
+/// A policy for how tensors saved for backward are kept alive, e.g. by
+/// offloading them to host memory or by dropping and recomputing them. The
+/// hooks installed on the current thread (see `SavedVariableHooksGuard`) are
+/// called for every defined tensor saved while they are installed.
+struct TORCH_API SavedVariableHooks {
+  virtual ~SavedVariableHooks() = default;
+  /// Returns the stand-in for `data`, the detached data of `variable`, or
+  /// nullptr to save `data` as usual.
+  virtual std::unique_ptr<PackedTensor> pack(
+      const Variable& variable,
+      const at::Tensor& data) = 0;
+};
+
+/// Installs `hooks` as the saved variable hooks of the current thread for the
+/// lifetime of the guard. Guards nest; passing nullptr disables the hooks.
+struct TORCH_API SavedVariableHooksGuard {
+  explicit SavedVariableHooksGuard(std::shared_ptr<SavedVariableHooks> hooks);
+  ~SavedVariableHooksGuard();
+
+  SavedVariableHooksGuard(const SavedVariableHooksGuard&) = delete;
+  SavedVariableHooksGuard& operator=(const SavedVariableHooksGuard&) = delete;
+
+  static std::shared_ptr<SavedVariableHooks> get_current();
+  static void set_current(std::shared_ptr<SavedVariableHooks> hooks);
+
+ private:
+  std::shared_ptr<SavedVariableHooks> prev_hooks_;
+};
+
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
 class TORCH_API SavedVariable {
@@ -29,6 +67,7 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Node> saved_for = nullptr) const;
 
   void reset_data() {
+    packed_.reset();
     return data_.reset();
   }
 
@@ -38,6 +77,9 @@ class TORCH_API SavedVariable {
 
  private:
   at::Tensor data_;
+  // Set instead of data_ if the hooks installed when the variable was saved
+  // took over the data.
+  std::unique_ptr<PackedTensor> packed_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
@@ -233,6 +233,23 @@ namespace impl {
     materialize_autograd_meta(self)->hooks_.clear();
   }
 
+  void release_grad(const Variable& self) {
+    auto meta = get_autograd_meta(self);
+    if (!meta || !meta->grad_.defined()) {
+      return;
+    }
+    Variable grad = std::move(meta->grad_);
+    // Only keep memory that nothing else can observe being overwritten.
+    if (grad.has_storage() && !grad.requires_grad() && grad.use_count() == 1 &&
+        grad.unsafeGetTensorImpl()->storage().use_count() == 1) {
+      meta->released_grad_ = std::move(grad);
+    }
+  }
+
+  Variable& released_grad(const Variable& self) {
+    return materialize_autograd_meta(self)->released_grad_;
+  }
+
   void set_name(const Variable& self, const std::string& name) {
     materialize_autograd_meta(self)->name_ = name;
   }
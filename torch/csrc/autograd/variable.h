@@ -175,6 +175,15 @@ namespace impl {
   TORCH_API void clear_hooks(const Variable&);
 
   TORCH_API void create_cpp_hook(const Variable&);
+
+  /// Sets the gradient of this `Variable` to undefined, but keeps its memory
+  /// if nothing else refers to it, such that the next gradient accumulated
+  /// into this `Variable` is copied into that memory rather than allocating
+  /// new memory (see `AccumulateGrad`).
+  TORCH_API void release_grad(const Variable&);
+
+  /// The memory kept by `release_grad`, undefined if there is none.
+  TORCH_API Variable& released_grad(const Variable&);
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -190,6 +199,8 @@ struct TORCH_API AutogradMeta : public c10::AutogradMetaInterface {
   std::string name_;
 
   Variable grad_;
+  // The memory of a gradient released by `impl::release_grad`.
+  Variable released_grad_;
   std::shared_ptr<Node> grad_fn_;
   std::weak_ptr<Node> grad_accumulator_;
 
@@ -0,0 +1,31 @@
+#include <torch/csrc/python_headers.h>
+
+#include <torch/csrc/utils/pybind.h>
+
+#include <ATen/cuda/CUDAGraph.h>
+
+template <typename T>
+using shared_ptr_class_ = py::class_<T, std::shared_ptr<T>>;
+
+void THCPGraph_init(PyObject *module) {
+  auto torch_C_m = py::handle(module).cast<py::module>();
+
+  // Capture and replay may allocate through the caching allocator or wait on
+  // the device, so they release the GIL.
+  shared_ptr_class_<::at::cuda::CUDAGraph>(torch_C_m, "_CUDAGraph")
+      .def(py::init<>())
+      .def("capture_begin",
+           &::at::cuda::CUDAGraph::capture_begin,
+           py::call_guard<py::gil_scoped_release>(),
+           py::arg("pool") = 0)
+      .def("capture_end",
+           &::at::cuda::CUDAGraph::capture_end,
+           py::call_guard<py::gil_scoped_release>())
+      .def("replay",
+           &::at::cuda::CUDAGraph::replay,
+           py::call_guard<py::gil_scoped_release>())
+      .def("reset",
+           &::at::cuda::CUDAGraph::reset,
+           py::call_guard<py::gil_scoped_release>())
+      .def("pool", &::at::cuda::CUDAGraph::pool);
+}
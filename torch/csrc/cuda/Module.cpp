@@ -353,6 +353,43 @@ PyObject * THCPModule_resetPeakMemoryStats(PyObject *_unused, PyObject *arg)
   Py_RETURN_NONE;
 }
 
+PyObject * THCPModule_hostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  using c10::cuda::CUDACachingAllocator::Stat;
+
+  const auto statToDict = [](const Stat& stat) {
+    py::dict dict;
+
+    dict["current"] = stat.current;
+    dict["peak"] = stat.peak;
+    dict["allocated"] = stat.allocated;
+    dict["freed"] = stat.freed;
+    return dict;
+  };
+
+  const THCCachingHostAllocatorStats stats = THCCachingHostAllocator_getStats();
+
+  py::dict result;
+  result["num_trims"] = stats.num_trims;
+  result["num_alloc_retries"] = stats.num_alloc_retries;
+  result["allocation"] = statToDict(stats.allocation);
+  result["segment"] = statToDict(stats.segment);
+  result["allocated_bytes"] = statToDict(stats.allocated_bytes);
+  result["reserved_bytes"] = statToDict(stats.reserved_bytes);
+
+  return result.release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject * THCPModule_resetPeakHostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingHostAllocator_resetPeakStats();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
 {
   HANDLE_TH_ERRORS
@@ -367,13 +404,18 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
     segmentDict["total_size"] = segmentInfo.total_size;
     segmentDict["allocated_size"] = segmentInfo.allocated_size;
     segmentDict["active_size"] = segmentInfo.active_size;
+    segmentDict["stream"] = segmentInfo.stream;
     segmentDict["segment_type"] = (segmentInfo.is_large ? "large" : "small");
+    segmentDict["is_expandable"] = segmentInfo.is_expandable;
 
     py::list blocks;
     for (const auto& blockInfo : segmentInfo.blocks) {
       py::dict blockDict;
       blockDict["size"] = blockInfo.size;
       blockDict["state"] = (blockInfo.allocated ? "active_allocated" : (blockInfo.active ? "active_pending_free" : "inactive"));
+      if (!blockInfo.backtrace.empty()) {
+        blockDict["backtrace"] = blockInfo.backtrace;
+      }
       blocks.append(blockDict);
     }
     segmentDict["blocks"] = blocks;
@@ -392,6 +434,38 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_allocationTrace(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to allocation_trace");
+  const int device = (int) THPUtils_unpackLong(arg);
+
+  using c10::cuda::CUDACachingAllocator::TraceEntry;
+  const auto actionToString = [](TraceEntry::Action action) {
+    switch (action) {
+      case TraceEntry::ALLOC: return "alloc";
+      case TraceEntry::FREE: return "free";
+      case TraceEntry::SEGMENT_ALLOC: return "segment_alloc";
+      case TraceEntry::SEGMENT_FREE: return "segment_free";
+      case TraceEntry::OOM: return "oom";
+    }
+    return "unknown";
+  };
+
+  py::list result;
+  for (const auto& entry : c10::cuda::CUDACachingAllocator::allocationTrace(device)) {
+    py::dict entryDict;
+    entryDict["action"] = actionToString(entry.action);
+    entryDict["address"] = entry.address;
+    entryDict["size"] = entry.size;
+    entryDict["stream"] = entry.stream;
+    entryDict["backtrace"] = entry.backtrace;
+    result.append(entryDict);
+  }
+  return result.release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Cuda module initialization
 ////////////////////////////////////////////////////////////////////////////////
@@ -508,7 +582,10 @@ static struct PyMethodDef _THCPModule_methods[] = {
   {"_cuda_memoryStats", (PyCFunction) THCPModule_memoryStats, METH_O, nullptr},
   {"_cuda_resetAccumulatedMemoryStats", (PyCFunction) THCPModule_resetAccumulatedMemoryStats, METH_O, nullptr},
   {"_cuda_resetPeakMemoryStats", (PyCFunction) THCPModule_resetPeakMemoryStats, METH_O,  nullptr},
+  {"_cuda_hostMemoryStats", (PyCFunction) THCPModule_hostMemoryStats, METH_NOARGS,  nullptr},
+  {"_cuda_resetPeakHostMemoryStats", (PyCFunction) THCPModule_resetPeakHostMemoryStats, METH_NOARGS,  nullptr},
   {"_cuda_memorySnapshot", (PyCFunction) THCPModule_memorySnapshot, METH_NOARGS, nullptr},
+  {"_cuda_allocationTrace", (PyCFunction) THCPModule_allocationTrace, METH_O, nullptr},
   {"_cuda_cudaHostAllocator", (PyCFunction)THCPModule_cudaHostAllocator, METH_NOARGS, nullptr},
   {"_cuda_cudaCachingAllocator_raw_alloc", (PyCFunction)THCPModule_cudaCachingAllocator_raw_alloc, METH_VARARGS, nullptr},
   {"_cuda_cudaCachingAllocator_raw_delete", (PyCFunction)THCPModule_cudaCachingAllocator_raw_delete, METH_O, nullptr},
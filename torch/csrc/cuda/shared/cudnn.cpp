@@ -12,6 +12,7 @@ using version_tuple = std::tuple<size_t, size_t, size_t>;
 
 #ifdef USE_CUDNN
 #include <cudnn.h>
+#include <ATen/cudnn/BenchmarkCache.h>
 
 namespace {
 
@@ -87,6 +88,15 @@ void initCudnnBindings(PyObject* module) {
   cudnn.def("getRuntimeVersion", getRuntimeVersion);
   cudnn.def("getCompileVersion", getCompileVersion);
   cudnn.def("getVersionInt", getVersionInt);
+
+#ifdef USE_CUDNN
+  cudnn.def("_serialize_benchmark_cache", []() {
+    return py::bytes(at::native::serializeCudnnBenchmarkCache());
+  });
+  cudnn.def("_load_benchmark_cache", [](const std::string& data) {
+    return at::native::loadCudnnBenchmarkCache(data);
+  });
+#endif
 }
 
 } // namespace shared
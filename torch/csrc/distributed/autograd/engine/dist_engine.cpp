@@ -355,23 +355,51 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::runEngineAndAccumulateGradients(
   return accumulateGradFuture;
 }
 
+bool DistEngine::initializeContext(
+    const ContextPtr& autogradContext,
+    const std::function<void()>& computeFn) {
+  const auto contextId = autogradContext->contextId();
+  std::unique_lock<std::mutex> lock(initializedContextIdsLock_);
+  auto it = initializedContextIds_.find(contextId);
+  if (it != initializedContextIds_.end()) {
+    auto initialized = it->second;
+    lock.unlock();
+    // Rethrows if computing the dependencies failed.
+    initialized.get();
+    return false;
+  }
+
+  // Mark the autograd context id as initialized and unlock.
+  std::promise<void> initialized;
+  initializedContextIds_.emplace(
+      contextId, initialized.get_future().share());
+  lock.unlock();
+
+  try {
+    computeFn();
+  } catch (...) {
+    initialized.set_exception(std::current_exception());
+    lock.lock();
+    initializedContextIds_.erase(contextId);
+    throw;
+  }
+  initialized.set_value();
+  return true;
+}
+
 std::shared_ptr<rpc::FutureMessage> DistEngine::executeSendFunctionAsync(
     const ContextPtr& autogradContext,
     const std::shared_ptr<Node>& sendFunction,
     bool retainGraph) {
-  std::unique_lock<std::mutex> lock(initializedContextIdsLock_);
-  if (initializedContextIds_.find(autogradContext->contextId()) ==
-      initializedContextIds_.end()) {
-    edge_list outputEdges;
+  edge_list outputEdges;
+  const bool initialized = initializeContext(autogradContext, [&]() {
     // Pass in a dummy graphRoot since all send functions are the roots.
     auto dummyRoot = std::make_shared<GraphRoot>(edge_list(), variable_list());
     computeDependencies(
         autogradContext, {}, {}, dummyRoot, outputEdges, retainGraph);
+  });
 
-    // Mark the autograd context id as initialized and unlock.
-    initializedContextIds_.insert(autogradContext->contextId());
-    lock.unlock();
-
+  if (initialized) {
     // Enqueue the current send function.
     auto graphTask = autogradContext->retrieveGraphTask();
     // Run the autograd engine.
@@ -427,7 +455,6 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::executeSendFunctionAsync(
     // Return the future which waits for all async processing to be done.
     return callbackFuture;
   } else {
-    lock.unlock();
     auto graphTask = autogradContext->retrieveGraphTask();
     at::launch([this, graphTask, sendFunction]() {
       execute_graph_task_until_ready_queue_empty(
@@ -458,19 +485,12 @@ void DistEngine::execute(
   edge_list outputEdges;
   // Compute dependencies locally, starting from all roots and all 'send'
   // functions.
-  {
-    std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-    // Context should not have been initialized already.
-    TORCH_INTERNAL_ASSERT(
-        initializedContextIds_.find(autogradContext->contextId()) ==
-        initializedContextIds_.end());
-
+  const bool initialized = initializeContext(autogradContext, [&]() {
     computeDependencies(
         autogradContext, rootEdges, grads, graphRoot, outputEdges, retainGraph);
-
-    // Mark the autograd context id as initialized.
-    initializedContextIds_.insert(autogradContext->contextId());
-  }
+  });
+  // Context should not have been initialized already.
+  TORCH_INTERNAL_ASSERT(initialized);
 
   BackwardPassCleanupGuard guard(autogradContext);
 
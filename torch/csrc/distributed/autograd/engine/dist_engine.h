@@ -1,7 +1,9 @@
 #pragma once
 
+#include <functional>
+#include <future>
 #include <mutex>
-#include <unordered_set>
+#include <unordered_map>
 
 #include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/function.h>
@@ -135,9 +137,20 @@ class TORCH_API DistEngine {
   // Run after the backward pass is done to appropriately cleanup structures.
   void cleanupBackwardPass(const ContextPtr& autogradContext);
 
-  // Set of autograd context_ids, which we have already initialized for
-  // distributed autograd on this node (e.g.: already computed dependencies)
-  std::unordered_set<int64_t> initializedContextIds_;
+  // Registers the autograd context as initialized for distributed autograd on
+  // this node and computes its dependencies with `computeFn`, returning true.
+  // If the context was registered already, waits for the call computing its
+  // dependencies to finish and returns false instead. The lock on
+  // `initializedContextIds_` is only held to register the context, so that
+  // independent contexts compute their dependencies concurrently.
+  bool initializeContext(
+      const ContextPtr& autogradContext,
+      const std::function<void()>& computeFn);
+
+  // Autograd context_ids which we have already initialized (or are
+  // initializing) for distributed autograd on this node, mapped to a future
+  // that completes once their dependencies have been computed.
+  std::unordered_map<int64_t, std::shared_future<void>> initializedContextIds_;
 
   mutable std::mutex initializedContextIdsLock_;
 
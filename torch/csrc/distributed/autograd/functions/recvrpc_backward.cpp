@@ -10,11 +10,16 @@ namespace autograd {
 using torch::autograd::Variable;
 using torch::autograd::variable_list;
 
+// Like AccumulateGrad, RecvRpcBackward sets sequence_nr to the max value so
+// that it's called ASAP during backwards: the gradients are sent to the next
+// worker as soon as they are ready, instead of after the rest of the local
+// backward pass.
 RecvRpcBackward::RecvRpcBackward(
     const AutogradMetadata& autogradMetadata,
     ContextPtr autogradContext,
     rpc::worker_id_t fromWorkerId)
-    : autogradMetadata_(autogradMetadata),
+    : Node(/*sequence_nr=*/UINT64_MAX),
+      autogradMetadata_(autogradMetadata),
       autogradContext_(std::move(autogradContext)),
       fromWorkerId_(fromWorkerId) {}
 
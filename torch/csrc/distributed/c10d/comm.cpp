@@ -1,7 +1,9 @@
 #include <torch/csrc/distributed/c10d/comm.h>
 
+#include <cmath>
 #include <deque>
 
+#include <ATen/CPUGeneratorImpl.h>
 #include <ATen/core/functional.h>
 #include <torch/csrc/distributed/c10d/reducer.h>
 #include <torch/csrc/utils/tensor_flatten.h>
@@ -79,4 +81,205 @@ void broadcast_coalesced(
   }
 }
 
+std::vector<at::Tensor> CommHookFuture::wait() {
+  if (!completed_) {
+    result_ = wait_fn_();
+    wait_fn_ = nullptr;
+    completed_ = true;
+  }
+  return result_;
+}
+
+std::shared_ptr<CommHookFuture> FP16CompressCommHook::runHook(
+    GradBucket& bucket) {
+  auto tensors = bucket.getTensors();
+  std::vector<at::Tensor> compressed;
+  compressed.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    compressed.push_back(tensor.to(at::kHalf));
+  }
+  auto work = process_group_->allreduce(compressed);
+  return std::make_shared<CommHookFuture>(
+      [work, compressed, tensors]() mutable {
+        work->wait();
+        for (size_t i = 0; i < tensors.size(); i++) {
+          tensors[i].copy_(compressed[i]);
+        }
+        return tensors;
+      });
+}
+
+std::shared_ptr<CommHookFuture> ReduceScatterCommHook::runHook(
+    GradBucket& bucket) {
+  const auto& tensors = bucket.getTensors();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "ReduceScatterCommHook only supports a single model replica per process.");
+  auto tensor = tensors[0];
+
+  const int64_t world_size = process_group_->getSize();
+  const int64_t rank = process_group_->getRank();
+  const auto numel = tensor.numel();
+  const auto shard_size = (numel + world_size - 1) / world_size;
+  auto input = tensor;
+  if (shard_size * world_size != numel) {
+    input = at::zeros({shard_size * world_size}, tensor.options());
+    input.narrow(0, 0, numel).copy_(tensor);
+  }
+  std::vector<std::vector<at::Tensor>> inputs = {input.chunk(world_size)};
+  std::vector<at::Tensor> outputs = {at::empty({shard_size}, tensor.options())};
+  auto work = process_group_->reduce_scatter(outputs, inputs);
+  // Keep the padded input alive until the reduction has completed.
+  return std::make_shared<CommHookFuture>(
+      [work, inputs, outputs, tensor, rank, shard_size, numel]() mutable {
+        work->wait();
+        const auto begin = std::min(numel, rank * shard_size);
+        const auto length = std::min(numel - begin, shard_size);
+        tensor.zero_();
+        tensor.narrow(0, begin, length)
+            .copy_(outputs[0].narrow(0, 0, length));
+        return std::vector<at::Tensor>{tensor};
+      });
+}
+
+TopKCommHook::TopKCommHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    double ratio)
+    : process_group_(std::move(process_group)), ratio_(ratio) {
+  TORCH_CHECK(
+      ratio > 0 && ratio <= 1,
+      "TopKCommHook expects a ratio in (0, 1], got ",
+      ratio);
+}
+
+std::shared_ptr<CommHookFuture> TopKCommHook::runHook(GradBucket& bucket) {
+  const auto& tensors = bucket.getTensors();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "TopKCommHook only supports a single model replica per process.");
+  auto tensor = tensors[0];
+
+  // Buckets are rebuilt after the first iteration, so a residual is only
+  // reused if it still matches the bucket.
+  auto& residual = residuals_[bucket.getIndex()];
+  if (!residual.defined() || !residual.options().type_equal(tensor.options()) ||
+      residual.numel() != tensor.numel()) {
+    residual = at::zeros_like(tensor);
+  }
+  residual.add_(tensor);
+
+  const auto numel = tensor.numel();
+  const auto k = std::max<int64_t>(
+      1, std::min<int64_t>(numel, std::llround(numel * ratio_)));
+  auto indices = std::get<1>(residual.abs().topk(k, 0, true, false));
+  auto values = residual.index_select(0, indices);
+  residual.index_fill_(0, indices, 0);
+
+  const auto world_size = process_group_->getSize();
+  std::vector<std::vector<at::Tensor>> values_out(1);
+  std::vector<std::vector<at::Tensor>> indices_out(1);
+  for (int i = 0; i < world_size; i++) {
+    values_out[0].push_back(at::empty_like(values));
+    indices_out[0].push_back(at::empty_like(indices));
+  }
+  std::vector<at::Tensor> values_in = {values};
+  std::vector<at::Tensor> indices_in = {indices};
+  auto values_work = process_group_->allgather(values_out, values_in);
+  auto indices_work = process_group_->allgather(indices_out, indices_in);
+  return std::make_shared<CommHookFuture>(
+      [values_work, indices_work, values_out, indices_out, tensor]() mutable {
+        values_work->wait();
+        indices_work->wait();
+        tensor.zero_();
+        tensor.index_add_(
+            0, at::cat(indices_out[0]), at::cat(values_out[0]));
+        return std::vector<at::Tensor>{tensor};
+      });
+}
+
+namespace {
+
+// Orthonormalizes the columns of `matrix` in place (Gram-Schmidt).
+void orthogonalize(at::Tensor& matrix) {
+  const auto num_cols = matrix.size(1);
+  for (int64_t i = 0; i < num_cols; i++) {
+    auto col = matrix.select(1, i);
+    // The epsilon avoids dividing by zero for all-zero gradients.
+    col.div_(col.norm().add_(1e-8));
+    if (i + 1 < num_cols) {
+      auto rest = matrix.narrow(1, i + 1, num_cols - i - 1);
+      rest.sub_(at::ger(col, at::mv(rest.t(), col)));
+    }
+  }
+}
+
+} // namespace
+
+PowerSGDCommHook::PowerSGDCommHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    int64_t matrix_rank,
+    uint64_t seed)
+    : process_group_(std::move(process_group)),
+      matrix_rank_(matrix_rank),
+      seed_(seed) {
+  TORCH_CHECK(
+      matrix_rank > 0,
+      "PowerSGDCommHook expects a positive matrix_rank, got ",
+      matrix_rank);
+}
+
+std::shared_ptr<CommHookFuture> PowerSGDCommHook::runHook(GradBucket& bucket) {
+  const auto& tensors = bucket.getTensors();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "PowerSGDCommHook only supports a single model replica per process.");
+  auto tensor = tensors[0];
+
+  const auto numel = tensor.numel();
+  const auto rows = static_cast<int64_t>(
+      std::ceil(std::sqrt(static_cast<double>(numel))));
+  const auto cols = (numel + rows - 1) / rows;
+  const auto rank = std::min(matrix_rank_, std::min(rows, cols));
+  // Compute in at least single precision.
+  const auto options = tensor.options().dtype(
+      tensor.scalar_type() == at::kDouble ? at::kDouble : at::kFloat);
+
+  auto& state = states_[bucket.getIndex()];
+  if (!state.error.defined() || state.error.numel() != rows * cols ||
+      !state.error.options().type_equal(options) || state.q.size(1) != rank) {
+    state.error = at::zeros({rows, cols}, options);
+    // Q must be initialized identically on every process.
+    auto generator = at::detail::createCPUGenerator(seed_ + bucket.getIndex());
+    state.q = at::randn({cols, rank}, generator, options.device(at::kCPU))
+                  .to(options.device());
+  }
+
+  // M = contents + error, padded with zeros to rows x cols.
+  auto matrix = state.error;
+  matrix.view({-1}).narrow(0, 0, numel).add_(tensor);
+  auto p = at::mm(matrix, state.q);
+  std::vector<at::Tensor> p_tensors = {p};
+  auto p_work = process_group_->allreduce(p_tensors);
+
+  auto process_group = process_group_;
+  auto* state_ptr = &state;
+  return std::make_shared<CommHookFuture>(
+      [process_group, p_work, p, matrix, state_ptr, tensor, numel]() mutable {
+        p_work->wait();
+        orthogonalize(p);
+        auto q = at::mm(matrix.t(), p);
+        std::vector<at::Tensor> q_tensors = {q};
+        process_group->allreduce(q_tensors)->wait();
+        // The approximation of the sum of M across processes.
+        auto approx = at::mm(p, q.t());
+        // Error feedback: keep what the local approximation missed.
+        state_ptr->error.sub_(at::mm(p, at::mm(p.t(), matrix)));
+        state_ptr->error.view({-1}).narrow(0, numel, matrix.numel() - numel)
+            .zero_();
+        state_ptr->q = q;
+        tensor.copy_(approx.view({-1}).narrow(0, 0, numel));
+        return std::vector<at::Tensor>{tensor};
+      });
+}
+
 } // namespace c10d
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <ATen/ATen.h>
 #include <c10d/ProcessGroup.hpp>
@@ -13,4 +16,132 @@ void broadcast_coalesced(
     at::TensorList tensors,
     size_t buffer_size);
 
+// A bucket of gradients to be reduced by a communication hook. It holds the
+// flattened bucket contents of every model replica; all of them live on the
+// same device type and have the same dtype and size. The contents have been
+// divided by the world size already, so hooks compute a sum across processes.
+class GradBucket {
+ public:
+  GradBucket(size_t index, std::vector<at::Tensor> tensors)
+      : index_(index), tensors_(std::move(tensors)) {}
+
+  // Index of the bucket in the reducer. Buckets are handed to the hook in the
+  // same order on every process.
+  size_t getIndex() const {
+    return index_;
+  }
+
+  const std::vector<at::Tensor>& getTensors() const {
+    return tensors_;
+  }
+
+ private:
+  size_t index_;
+  std::vector<at::Tensor> tensors_;
+};
+
+// The pending result of a communication hook. `wait` blocks until the
+// reduction has completed and returns the reduced tensors, one per model
+// replica of the bucket.
+class CommHookFuture {
+ public:
+  explicit CommHookFuture(std::function<std::vector<at::Tensor>()> wait_fn)
+      : wait_fn_(std::move(wait_fn)) {}
+
+  std::vector<at::Tensor> wait();
+
+ private:
+  std::function<std::vector<at::Tensor>()> wait_fn_;
+  std::vector<at::Tensor> result_;
+  bool completed_ = false;
+};
+
+// A communication hook replaces the allreduce the reducer runs for every
+// bucket of dense gradients, e.g. to compress gradients before communicating
+// them. `runHook` is called as soon as a bucket is ready, while the backward
+// pass is still running, and should kick off its communication
+// asynchronously; the reducer waits for the returned future at the end of the
+// backward pass.
+class CommHookInterface {
+ public:
+  virtual ~CommHookInterface() = default;
+
+  virtual std::shared_ptr<CommHookFuture> runHook(GradBucket& bucket) = 0;
+};
+
+// Allreduces the bucket contents cast to fp16 and casts the result back.
+class FP16CompressCommHook : public CommHookInterface {
+ public:
+  explicit FP16CompressCommHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  std::shared_ptr<CommHookFuture> runHook(GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// Reduce-scatters the bucket contents: they are padded to a multiple of the
+// world size and split into one shard per process, and every process only
+// receives the sum of its shard, at offset rank * shard size. The rest of the
+// bucket contents is set to zero. Used by the reducer to shard gradients, see
+// `Reducer::set_shard_gradients`. Only supports single-replica buckets.
+class ReduceScatterCommHook : public CommHookInterface {
+ public:
+  explicit ReduceScatterCommHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  std::shared_ptr<CommHookFuture> runHook(GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// Communicates only the `ratio` fraction of the bucket contents with the
+// largest magnitude (at least one element) through an allgather of their
+// values and indices. What is not communicated is kept as a per-bucket
+// residual and added to the bucket contents of the next iteration (error
+// feedback). Only supports single-replica buckets.
+class TopKCommHook : public CommHookInterface {
+ public:
+  TopKCommHook(std::shared_ptr<ProcessGroup> process_group, double ratio);
+
+  std::shared_ptr<CommHookFuture> runHook(GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+  double ratio_;
+  // Indexed by bucket index.
+  std::unordered_map<size_t, at::Tensor> residuals_;
+};
+
+// PowerSGD (Vogels et al., 2019): the bucket contents, padded and viewed as
+// a roughly square matrix M, are approximated by the rank `matrix_rank`
+// product P Q^T computed with one step of power iteration, which takes two
+// allreduces of the much smaller P and Q instead of one of M. Q is reused
+// across iterations (warm start) and the approximation error is added to the
+// next iteration's bucket contents (error feedback). Only the first allreduce
+// overlaps with the backward pass. Only supports single-replica buckets.
+class PowerSGDCommHook : public CommHookInterface {
+ public:
+  PowerSGDCommHook(
+      std::shared_ptr<ProcessGroup> process_group,
+      int64_t matrix_rank,
+      uint64_t seed = 0);
+
+  std::shared_ptr<CommHookFuture> runHook(GradBucket& bucket) override;
+
+ private:
+  struct State {
+    at::Tensor error;
+    at::Tensor q;
+  };
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  int64_t matrix_rank_;
+  uint64_t seed_;
+  // Indexed by bucket index.
+  std::unordered_map<size_t, State> states_;
+};
+
 } // namespace c10d
@@ -17,6 +17,7 @@
 #endif
 
 #include <c10d/PrefixStore.hpp>
+#include <c10d/ProcessGroupHierarchical.hpp>
 #include <c10d/ProcessGroupRoundRobin.hpp>
 #include <c10d/TCPStore.hpp>
 #include <pybind11/chrono.h>
@@ -141,7 +142,91 @@ PyObject* c10d_init(PyObject* _unused) {
           [](::c10d::Reducer& reducer, const torch::autograd::Variable& output)
               -> void { reducer.prepare_for_backward({output}); },
           py::call_guard<py::gil_scoped_release>())
-      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats);
+      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats)
+      .def(
+          "_register_comm_hook",
+          &::c10d::Reducer::register_comm_hook,
+          py::arg("comm_hook"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_defer_finalize",
+          &::c10d::Reducer::set_defer_finalize,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_get_pending_buckets",
+          &::c10d::Reducer::get_pending_buckets,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_finalize_bucket",
+          &::c10d::Reducer::finalize_bucket,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_finalize_pending_buckets",
+          &::c10d::Reducer::finalize_pending_buckets,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_shard_gradients",
+          &::c10d::Reducer::set_shard_gradients,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_get_bucket_indices",
+          &::c10d::Reducer::get_bucket_indices,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_coalesce_sparse_gradients",
+          &::c10d::Reducer::set_coalesce_sparse_gradients,
+          py::arg("coalesce_sparse_gradients"),
+          py::arg("density_threshold") = 0.0,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_process_group",
+          &::c10d::Reducer::set_process_group,
+          py::arg("process_group"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_set_gradient_as_bucket_view",
+          &::c10d::Reducer::set_gradient_as_bucket_view,
+          py::call_guard<py::gil_scoped_release>());
+
+  shared_ptr_class_<::c10d::CommHookInterface>(module, "CommHook");
+
+  py::class_<
+      ::c10d::FP16CompressCommHook,
+      ::c10d::CommHookInterface,
+      std::shared_ptr<::c10d::FP16CompressCommHook>>(
+      module, "FP16CompressCommHook", R"(
+Allreduces gradient buckets in half precision.
+)")
+      .def(
+          py::init<std::shared_ptr<::c10d::ProcessGroup>>(),
+          py::arg("process_group"));
+
+  py::class_<
+      ::c10d::TopKCommHook,
+      ::c10d::CommHookInterface,
+      std::shared_ptr<::c10d::TopKCommHook>>(module, "TopKCommHook", R"(
+Communicates the ``ratio`` fraction of every gradient bucket with the largest
+magnitude and accumulates the rest into the next iteration (error feedback).
+)")
+      .def(
+          py::init<std::shared_ptr<::c10d::ProcessGroup>, double>(),
+          py::arg("process_group"),
+          py::arg("ratio"));
+
+  py::class_<
+      ::c10d::PowerSGDCommHook,
+      ::c10d::CommHookInterface,
+      std::shared_ptr<::c10d::PowerSGDCommHook>>(
+      module, "PowerSGDCommHook", R"(
+Communicates a rank ``matrix_rank`` approximation of every gradient bucket
+computed with PowerSGD, with error feedback. ``seed`` must be the same on all
+processes.
+)")
+      .def(
+          py::init<std::shared_ptr<::c10d::ProcessGroup>, int64_t, uint64_t>(),
+          py::arg("process_group"),
+          py::arg("matrix_rank"),
+          py::arg("seed") = 0);
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class for available reduction operations: ``SUM``, ``PRODUCT``,
@@ -173,7 +258,10 @@ They are used in specifying strategies for reduction collectives, e.g.,
       module, "AllreduceCoalescedOptions")
       .def(py::init<>())
       .def_readwrite("reduceOp", &::c10d::AllreduceCoalescedOptions::reduceOp)
-      .def_readwrite("timeout", &::c10d::AllreduceCoalescedOptions::timeout);
+      .def_readwrite("timeout", &::c10d::AllreduceCoalescedOptions::timeout)
+      .def_readwrite(
+          "sparseDensityThreshold",
+          &::c10d::AllreduceCoalescedOptions::sparseDensityThreshold);
 
   py::class_<::c10d::ReduceOptions>(module, "ReduceOptions")
       .def(py::init<>())
@@ -255,7 +343,56 @@ They are used in specifying strategies for reduction collectives, e.g.,
                  const std::chrono::milliseconds& timeout) {
                 store.wait(keys, timeout);
               },
-              py::call_guard<py::gil_scoped_release>());
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          // The GIL is only released while waiting for the values, since
+          // py::bytes can only be created while holding it.
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                py::list result;
+                for (auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<char*>(value.data()), value.size()));
+                }
+                return result;
+              })
+          .def(
+              "compare_set",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& expected_value,
+                 const std::string& desired_value) -> py::bytes {
+                std::vector<uint8_t> value;
+                {
+                  py::gil_scoped_release release;
+                  value = store.compareSet(
+                      key,
+                      std::vector<uint8_t>(
+                          expected_value.begin(), expected_value.end()),
+                      std::vector<uint8_t>(
+                          desired_value.begin(), desired_value.end()));
+                }
+                return py::bytes(
+                    reinterpret_cast<char*>(value.data()), value.size());
+              });
 
   shared_ptr_class_<::c10d::FileStore>(module, "FileStore", store)
       .def(py::init<const std::string&, int>());
@@ -285,6 +422,9 @@ They are used in specifying strategies for reduction collectives, e.g.,
       shared_ptr_class_<::c10d::ProcessGroup>(module, "ProcessGroup")
           .def("rank", &::c10d::ProcessGroup::getRank)
           .def("size", &::c10d::ProcessGroup::getSize)
+          .def(
+              "sequence_number",
+              &::c10d::ProcessGroup::getSequenceNumber)
 
           .def(
               "broadcast",
@@ -558,6 +698,24 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("process_groups"),
       py::call_guard<py::gil_scoped_release>());
 
+  shared_ptr_class_<::c10d::ProcessGroupHierarchical>(
+      module, "ProcessGroupHierarchical", processGroup)
+      .def(
+          py::init<
+              int,
+              int,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              std::shared_ptr<::c10d::ProcessGroup>,
+              bool>(),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("global_group"),
+          py::arg("intra_node_group"),
+          py::arg("inter_node_group"),
+          py::arg("use_reduce_scatter"),
+          py::call_guard<py::gil_scoped_release>());
+
 #ifdef USE_C10D_GLOO
   auto processGroupGloo = shared_ptr_class_<::c10d::ProcessGroupGloo>(
       module, "ProcessGroupGloo", processGroup);
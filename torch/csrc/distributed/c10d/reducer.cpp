@@ -38,7 +38,12 @@ Reducer::Reducer(
       local_used_maps_reduced_(false),
       backward_stats_base_(0),
       has_rebuilt_bucket_(false),
-      bucket_bytes_cap_(bucket_bytes_cap) {
+      bucket_bytes_cap_(bucket_bytes_cap),
+      defer_finalize_(false),
+      num_buckets_pending_finalize_(0),
+      coalesce_sparse_gradients_(false),
+      sparse_density_threshold_(0),
+      gradient_as_bucket_view_(false) {
   C10_LOG_API_USAGE_ONCE("torch.distributed.ddp.reducer");
   TORCH_CHECK(replicas_.size() >= 1, "Expected at least one model replica.");
   TORCH_CHECK(replicas_[0].size() >= 1, "Expected at least one parameter.");
@@ -216,8 +221,14 @@ void Reducer::mark_variable_ready_dense(VariableIndex index) {
   // as part of the current backwards pass, and zero the part
   // of the bucket it would otherwise hold.
   auto bucket_view = replica.contents.narrow(0, offset, length);
+  const auto as_bucket_view = use_gradient_as_bucket_view();
   runGradCallbackForVariable(variable, [&](auto& grad) {
     if (grad.defined()) {
+      // If the gradient already is the bucket view, the autograd engine
+      // accumulated it in place and there is nothing to copy.
+      if (as_bucket_view && grad.is_alias_of(bucket_view)) {
+        return false;
+      }
       // Ensure that the gradient type matches the bucket type.
       TORCH_CHECK(
           grad.options().type_equal(bucket_view.options()),
@@ -225,14 +236,17 @@ void Reducer::mark_variable_ready_dense(VariableIndex index) {
           bucket_view.toString(),
           ", got ",
           grad.toString());
-      // Assert that the grad tensor and the bucket don't share storage.
-      // If they did, we could avoid the copy altogether.
-      // The reason for not doing this is that existing code calls
-      // `detach_` from `zero_grad`, which is incompatible with views.
-      TORCH_INTERNAL_ASSERT(!grad.is_alias_of(bucket_view));
       TORCH_INTERNAL_ASSERT(grad.device() == bucket_view.device());
       TORCH_INTERNAL_ASSERT(grad.numel() == bucket_view.numel());
       bucket_view.copy_(grad.view({-1}), /* non_blocking */ true);
+      // Gradients that are part of a graph (`create_graph=True`) stay as
+      // they are.
+      if (as_bucket_view && !grad.requires_grad()) {
+        grad = replica.bucket_views[bucket_index.intra_bucket_index];
+        // The grad is replaced by the bucket view and needs to be written
+        // back.
+        return true;
+      }
     } else {
       bucket_view.zero_();
     }
@@ -433,6 +447,19 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
   for (; next_bucket_ < buckets_.size() && buckets_[next_bucket_].pending == 0;
        next_bucket_++) {
     auto& bucket = buckets_[next_bucket_];
+    if (coalesce_sparse_gradients_ && bucket.expect_sparse_gradient) {
+      // Coalesced tensors must have the same type.
+      if (!pending_sparse_buckets_.empty() &&
+          !buckets_[pending_sparse_buckets_.front()]
+               .replicas[0]
+               .contents.options()
+               .type_equal(bucket.replicas[0].contents.options())) {
+        reduce_pending_sparse_buckets();
+      }
+      pending_sparse_buckets_.push_back(next_bucket_);
+      continue;
+    }
+    reduce_pending_sparse_buckets();
     std::vector<at::Tensor> tensors;
     tensors.reserve(bucket.replicas.size());
     for (const auto& replica : bucket.replicas) {
@@ -447,10 +474,159 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
       //
       tensors.push_back(replica.contents);
     }
-    bucket.work = process_group_->allreduce(tensors);
+    // The buckets are about to be rebuilt if the backward pass records the
+    // order of the gradients, so the layout of the shards isn't final yet.
+    const bool rebuild_pending =
+        !has_rebuilt_bucket_ && unused_parameters_.empty();
+    if (shard_hook_ && !bucket.expect_sparse_gradient && !rebuild_pending &&
+        tensors[0].numel() > 0) {
+      GradBucket grad_bucket(next_bucket_, std::move(tensors));
+      bucket.future = shard_hook_->runHook(grad_bucket);
+    } else if (comm_hook_ && !bucket.expect_sparse_gradient) {
+      GradBucket grad_bucket(next_bucket_, std::move(tensors));
+      bucket.future = comm_hook_->runHook(grad_bucket);
+    } else {
+      bucket.work = process_group_->allreduce(tensors);
+    }
+  }
+
+  // Keep holding back the sparse buckets if the next bucket can be coalesced
+  // with them once it is ready.
+  if (next_bucket_ == buckets_.size() ||
+      !buckets_[next_bucket_].expect_sparse_gradient) {
+    reduce_pending_sparse_buckets();
+  }
+}
+
+void Reducer::reduce_pending_sparse_buckets() {
+  if (pending_sparse_buckets_.empty()) {
+    return;
+  }
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(pending_sparse_buckets_.size());
+  for (const auto bucket_index : pending_sparse_buckets_) {
+    tensors.push_back(buckets_[bucket_index].replicas[0].contents);
+  }
+  AllreduceCoalescedOptions opts;
+  opts.sparseDensityThreshold = sparse_density_threshold_;
+  auto work = process_group_->allreduce_coalesced(tensors, opts);
+  for (const auto bucket_index : pending_sparse_buckets_) {
+    buckets_[bucket_index].work = work;
+  }
+  pending_sparse_buckets_.clear();
+}
+
+void Reducer::register_comm_hook(std::shared_ptr<CommHookInterface> hook) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(hook, "Expected a communication hook.");
+  TORCH_CHECK(
+      !comm_hook_,
+      "register_comm_hook can only be called once per DDP model.");
+  TORCH_CHECK(
+      !shard_hook_,
+      "register_comm_hook can't be called when gradients are sharded.");
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "register_comm_hook must not be called between the forward and the "
+      "backward pass.");
+  comm_hook_ = std::move(hook);
+}
+
+void Reducer::set_shard_gradients(bool shard_gradients) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "set_shard_gradients must not be called between the forward and the "
+      "backward pass.");
+  if (!shard_gradients) {
+    shard_hook_ = nullptr;
+    return;
+  }
+  TORCH_CHECK(
+      replicas_.size() == 1,
+      "Sharding gradients only supports a single model replica per process.");
+  TORCH_CHECK(
+      !comm_hook_,
+      "Gradients can't be sharded when a communication hook is registered.");
+  if (!shard_hook_) {
+    shard_hook_ = std::make_shared<ReduceScatterCommHook>(process_group_);
   }
 }
 
+void Reducer::set_coalesce_sparse_gradients(
+    bool coalesce_sparse_gradients,
+    double density_threshold) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "set_coalesce_sparse_gradients must not be called between the forward "
+      "and the backward pass.");
+  TORCH_CHECK(
+      !coalesce_sparse_gradients || replicas_.size() == 1,
+      "Coalescing sparse gradients only supports a single model replica per "
+      "process.");
+  coalesce_sparse_gradients_ = coalesce_sparse_gradients;
+  sparse_density_threshold_ = density_threshold;
+}
+
+void Reducer::set_gradient_as_bucket_view(bool gradient_as_bucket_view) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "set_gradient_as_bucket_view must not be called between the forward "
+      "and the backward pass.");
+  gradient_as_bucket_view_ = gradient_as_bucket_view;
+}
+
+bool Reducer::use_gradient_as_bucket_view() {
+  return gradient_as_bucket_view_ &&
+      rpc_context_.context_ptr.load() == nullptr;
+}
+
+void Reducer::set_process_group(
+    std::shared_ptr<c10d::ProcessGroup> process_group) {
+  TORCH_CHECK(process_group, "Expected a process group.");
+  std::vector<std::vector<size_t>> bucket_indices;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TORCH_CHECK(
+        !expect_autograd_hooks_,
+        "set_process_group must not be called between the forward and the "
+        "backward pass.");
+    TORCH_CHECK(
+        num_buckets_pending_finalize_ == 0,
+        "set_process_group must not be called while buckets are pending "
+        "finalization.");
+    process_group_ = std::move(process_group);
+    if (shard_hook_) {
+      shard_hook_ = std::make_shared<ReduceScatterCommHook>(process_group_);
+    }
+    bucket_indices.reserve(buckets_.size());
+    for (const auto& bucket : buckets_) {
+      bucket_indices.push_back(bucket.variable_indices);
+    }
+
+    // Processes may disagree on whether the buckets were rebuilt, which is
+    // a collective, so all of them take the layout of rank 0 as final.
+    has_rebuilt_bucket_ = true;
+    rebuilt_params_.clear();
+    rebuilt_param_indices_.clear();
+  }
+
+  sync_bucket_indices(bucket_indices);
+  initialize_buckets(std::move(bucket_indices));
+}
+
+std::vector<std::vector<size_t>> Reducer::get_bucket_indices() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::vector<size_t>> bucket_indices;
+  bucket_indices.reserve(buckets_.size());
+  for (const auto& bucket : buckets_) {
+    bucket_indices.push_back(bucket.variable_indices);
+  }
+  return bucket_indices;
+}
+
 void Reducer::initialize_buckets(
     std::vector<std::vector<size_t>> bucket_indices) {
   std::lock_guard<std::mutex> lock(mutex_);
@@ -459,6 +635,10 @@ void Reducer::initialize_buckets(
   TORCH_CHECK(
       !expect_autograd_hooks_,
       "`initialize_buckets` must NOT be called during autograd execution.");
+  TORCH_CHECK(
+      num_buckets_pending_finalize_ == 0,
+      "`initialize_buckets` must NOT be called while buckets are pending "
+      "finalization.");
 
   // Clear current bucket assignment.
   buckets_.clear();
@@ -537,6 +717,21 @@ void Reducer::initialize_buckets(
 
         // Allocate bucket contents tensor.
         replica.contents = at::empty({static_cast<long>(offset)}, options);
+
+        // Create the tensors gradients are made if gradients are bucket
+        // views. They share the storage of the bucket contents but aren't
+        // autograd views of it, because `zero_grad` calls `detach_` on
+        // gradients, which is incompatible with views.
+        for (size_t i = 0; i < replica.variables.size(); i++) {
+          const auto view =
+              replica.contents.narrow(0, replica.offsets[i], replica.lengths[i])
+                  .view(replica.variables[i].sizes());
+          replica.bucket_views.push_back(at::empty({0}, options).set_(
+              replica.contents.storage(),
+              view.storage_offset(),
+              view.sizes(),
+              view.strides()));
+        }
       }
 
       // Add bucket replica to enclosing bucket.
@@ -598,6 +793,10 @@ void Reducer::prepare_for_backward(
         "list, dict, iterable).");
   }
 
+  // Write back the gradients of buckets whose finalization was deferred and
+  // that haven't been finalized explicitly.
+  finalize_pending_buckets_locked();
+
   // Reset accounting.
   expect_autograd_hooks_ = true;
   next_bucket_ = 0;
@@ -656,6 +855,7 @@ void Reducer::prepare_for_backward(
 
 // A bucket with one or more dense tensors needs to be unflattened.
 void Reducer::finalize_bucket_dense(Bucket& bucket) {
+  const auto as_bucket_view = use_gradient_as_bucket_view();
   for (size_t replica_index = 0; replica_index < bucket.replicas.size();
        replica_index++) {
     auto& replica = bucket.replicas[replica_index];
@@ -705,6 +905,16 @@ void Reducer::finalize_bucket_dense(Bucket& bucket) {
       runGradCallbackForVariable(variable, [&](auto& grad) {
         // If a parameter is globally unused, we keep its grad untouched.
         if (!global_unused) {
+          if (as_bucket_view) {
+            // The reduced gradient already is in place.
+            if (grad.defined() && grad.is_alias_of(bucket_view)) {
+              return false;
+            }
+            if (!grad.defined()) {
+              grad = replica.bucket_views[intra_bucket_index];
+              return true;
+            }
+          }
           if (!grad.defined()) {
             grad = at::empty(bucket_view.sizes(), bucket_view.options());
           }
@@ -731,18 +941,60 @@ void Reducer::finalize_backward() {
   // Check that all buckets were completed and had their work kicked off.
   TORCH_INTERNAL_ASSERT(next_bucket_ == buckets_.size());
 
+  // Leave waiting for the reductions to finalize_bucket. Buckets are about to
+  // be rebuilt after the first iteration, and under distributed autograd the
+  // gradients must be written back before the backward pass completes, so
+  // those cases are always finalized right away.
+  if (defer_finalize_ && rebuilt_params_.empty() &&
+      rpc_context_.context_ptr.load() == nullptr) {
+    for (auto& bucket : buckets_) {
+      bucket.finalize_pending = true;
+    }
+    num_buckets_pending_finalize_ = buckets_.size();
+    return;
+  }
+
   // Wait for asynchronous reduction to complete and unflatten contents.
   for (auto& bucket : buckets_) {
-    TORCH_INTERNAL_ASSERT(bucket.work);
-    bucket.work->wait();
-    if (!bucket.expect_sparse_gradient) {
-      // We don't need to finalize the sparse bucket since the sparse grad and
-      // the bucket essentially point to the same storage. As a result, once
-      // the allreduce is done, the sparse grads are automatically updated.
-      finalize_bucket_dense(bucket);
+    wait_and_finalize_bucket(bucket);
+  }
+  finalize_reduction();
+}
+
+void Reducer::wait_and_finalize_bucket(Bucket& bucket) {
+  if (bucket.future) {
+    auto result = bucket.future->wait();
+    bucket.future = nullptr;
+    TORCH_CHECK(
+        result.size() == bucket.replicas.size(),
+        "Expected the communication hook to return ",
+        bucket.replicas.size(),
+        " tensors, got ",
+        result.size());
+    for (size_t i = 0; i < result.size(); i++) {
+      auto& contents = bucket.replicas[i].contents;
+      if (!result[i].is_same(contents)) {
+        TORCH_CHECK(
+            result[i].numel() == contents.numel(),
+            "Expected the communication hook to return tensors of the "
+            "same size as the bucket contents.");
+        contents.copy_(result[i].view({-1}));
+      }
     }
+    finalize_bucket_dense(bucket);
+    return;
+  }
+  TORCH_INTERNAL_ASSERT(bucket.work);
+  bucket.work->wait();
+  if (!bucket.expect_sparse_gradient) {
+    // We don't need to finalize the sparse bucket since the sparse grad and
+    // the bucket essentially point to the same storage. As a result, once
+    // the allreduce is done, the sparse grads are automatically updated.
+    finalize_bucket_dense(bucket);
   }
+}
 
+void Reducer::finalize_reduction() {
   // Reset unused parameter accounting.
   for (auto& local_used : local_used_maps_) {
     local_used.fill_(0);
@@ -759,6 +1011,61 @@ void Reducer::finalize_backward() {
   local_used_maps_reduced_ = false;
 }
 
+void Reducer::set_defer_finalize(bool defer_finalize) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  defer_finalize_ = defer_finalize;
+}
+
+std::vector<size_t> Reducer::get_pending_buckets() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    if (buckets_[i].finalize_pending) {
+      pending.push_back(i);
+    }
+  }
+  return pending;
+}
+
+std::vector<size_t> Reducer::finalize_bucket(size_t bucket_index) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      bucket_index < buckets_.size(),
+      "Bucket index ",
+      bucket_index,
+      " out of range for ",
+      buckets_.size(),
+      " buckets.");
+  auto& bucket = buckets_[bucket_index];
+  if (bucket.finalize_pending) {
+    finalize_pending_bucket(bucket);
+  }
+  return bucket.variable_indices;
+}
+
+void Reducer::finalize_pending_buckets() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  finalize_pending_buckets_locked();
+}
+
+void Reducer::finalize_pending_bucket(Bucket& bucket) {
+  TORCH_INTERNAL_ASSERT(bucket.finalize_pending);
+  bucket.finalize_pending = false;
+  wait_and_finalize_bucket(bucket);
+  if (--num_buckets_pending_finalize_ == 0) {
+    finalize_reduction();
+  }
+}
+
+void Reducer::finalize_pending_buckets_locked() {
+  for (auto& bucket : buckets_) {
+    if (bucket.finalize_pending) {
+      finalize_pending_bucket(bucket);
+    }
+  }
+  TORCH_INTERNAL_ASSERT(num_buckets_pending_finalize_ == 0);
+}
+
 void Reducer::runGradCallbackForVariable(
     torch::autograd::Variable& variable,
     GradCallback&& cb) {
@@ -11,6 +11,7 @@
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/distributed/autograd/context/context.h>
+#include <torch/csrc/distributed/c10d/comm.h>
 
 namespace c10d {
 
@@ -52,6 +53,82 @@ class Reducer {
     return backward_stats_;
   }
 
+  // Registers a hook that reduces the buckets of dense gradients instead of
+  // the default allreduce. May be called at most once, and not between a
+  // forward pass and its backward pass.
+  void register_comm_hook(std::shared_ptr<CommHookInterface> hook);
+
+  // If enabled, the backward pass doesn't wait for the reduction of the
+  // buckets to complete. Instead, the reduced gradients of every bucket are
+  // written back by `finalize_bucket`, so that e.g. the optimizer can update
+  // the parameters of a bucket as soon as its reduction has completed, while
+  // later buckets are still being reduced. Buckets that haven't been
+  // finalized when the next backward pass is prepared are finalized then.
+  void set_defer_finalize(bool defer_finalize);
+
+  // Returns the indices of the buckets whose gradients have been reduced, or
+  // are still being reduced, but haven't been written back yet.
+  std::vector<size_t> get_pending_buckets();
+
+  // Waits for the reduction of the bucket at `bucket_index` and writes the
+  // reduced gradients back if that's still pending. Returns the indices of
+  // the variables in the bucket (into the variables of a single replica).
+  std::vector<size_t> finalize_bucket(size_t bucket_index);
+
+  // Finalizes all pending buckets.
+  void finalize_pending_buckets();
+
+  // If enabled, buckets of dense gradients are reduce-scattered instead of
+  // allreduced: the flattened contents of every bucket are split into world
+  // size shards and each process only receives the reduced gradients of its
+  // own shard, the gradients outside of it are set to zero. This is for
+  // optimizers that shard their state across processes, see
+  // `torch.distributed.optim.ShardedOptimizer`. Buckets are still reduced
+  // while the backward pass runs.
+  //
+  // Until the buckets have been rebuilt after the first iteration, the bucket
+  // layout isn't final and the buckets are allreduced instead. Requires a
+  // single model replica, and can't be combined with a communication hook.
+  void set_shard_gradients(bool shard_gradients);
+
+  // Returns the indices of the variables (into the variables of a single
+  // replica) of every bucket, in bucket order. The flattened contents of a
+  // bucket of dense gradients are the gradients of its variables, flattened
+  // and concatenated in that order.
+  std::vector<std::vector<size_t>> get_bucket_indices();
+
+  // If enabled, consecutive buckets of sparse gradients are reduced together
+  // with a single `allreduce_coalesced`, which gathers the indices and values
+  // of all of them at once instead of running one sparse allreduce per
+  // gradient. Gradients that the gathered entries make at least
+  // `density_threshold` times as many as their rows are allreduced as dense
+  // tensors instead, if the threshold is positive. Requires a single model
+  // replica and a process group that supports sparse `allreduce_coalesced`,
+  // like Gloo.
+  void set_coalesce_sparse_gradients(
+      bool coalesce_sparse_gradients,
+      double density_threshold);
+
+  // Replaces the process group gradients are reduced over, e.g. after the
+  // processes of a job changed, without rebuilding the model or the reducer.
+  // All processes of the new process group must call it. The bucket layout
+  // of the process with rank 0 in the new process group is broadcast and
+  // used by all of them, such that processes that join with a fresh reducer
+  // use the same buckets as the others, and buckets aren't rebuilt anymore.
+  // Communication hooks keep the process group they were created with.
+  void set_process_group(std::shared_ptr<c10d::ProcessGroup> process_group);
+
+  // If enabled, the gradients of dense buckets are views into the flattened
+  // bucket contents, such that the autograd engine accumulates gradients
+  // right into the bucket and the reduced gradients are in place once the
+  // reduction completes: the copies of the gradients into the bucket and of
+  // the reduced bucket back into the gradients are skipped, and so is the
+  // separate allocation of the gradients. A gradient is made a view when it
+  // is first copied into its bucket, and whenever it was replaced, e.g. by
+  // setting it to None. Not used under distributed autograd, whose
+  // gradients live in the autograd context.
+  void set_gradient_as_bucket_view(bool gradient_as_bucket_view);
+
  protected:
   // Forward declaration.
   struct Bucket;
@@ -107,10 +184,26 @@ class Reducer {
 
   void mark_bucket_ready(size_t bucket_index);
 
+  // Kicks off the reduction of `pending_sparse_buckets_` with a single
+  // collective.
+  void reduce_pending_sparse_buckets();
+
   void finalize_bucket_dense(Bucket& replica);
 
   void finalize_backward();
 
+  void wait_and_finalize_bucket(Bucket& bucket);
+
+  // Resets the unused parameter accounting once all buckets are finalized.
+  void finalize_reduction();
+
+  void finalize_pending_bucket(Bucket& bucket);
+
+  void finalize_pending_buckets_locked();
+
+  // Whether gradients are made bucket views in this backward pass.
+  bool use_gradient_as_bucket_view();
+
   // Broadcast rebuilt buckets from rank 0 to other ranks before initializing
   // the buckets
   void sync_bucket_indices(std::vector<std::vector<size_t>>& bucket_indices);
@@ -155,6 +248,11 @@ class Reducer {
     std::vector<size_t> offsets;
     std::vector<size_t> lengths;
 
+    // Per-variable tensors sharing the storage of the flat bucket contents
+    // tensor, shaped like the variables. Gradients are made these views if gradients are bucket
+    // views, see `set_gradient_as_bucket_view`.
+    std::vector<at::Tensor> bucket_views;
+
     // Number of tensors to be added before this bucket is complete.
     // This is reset to `variables.size()` every iteration.
     size_t pending;
@@ -183,9 +281,16 @@ class Reducer {
     // Keep work handle around when this set of buckets is being reduced.
     std::shared_ptr<c10d::ProcessGroup::Work> work;
 
+    // Set instead of `work` if the bucket is reduced by the comm hook.
+    std::shared_ptr<CommHookFuture> future;
+
     // If this bucket should expect a single sparse gradient.
     // Implies: replicas[i].variables.size() == 1.
     bool expect_sparse_gradient = false;
+
+    // If the reduced gradients still need to be written back, see
+    // `set_defer_finalize`.
+    bool finalize_pending = false;
   };
 
   std::vector<Bucket> buckets_;
@@ -225,6 +330,25 @@ class Reducer {
     void set(ContextPtr&& new_context_ptr);
   };
   RpcContext rpc_context_;
+
+  std::shared_ptr<CommHookInterface> comm_hook_;
+
+  // Set if gradients are sharded, see `set_shard_gradients`.
+  std::shared_ptr<CommHookInterface> shard_hook_;
+
+  bool defer_finalize_;
+  size_t num_buckets_pending_finalize_;
+
+  // See `set_coalesce_sparse_gradients`.
+  bool coalesce_sparse_gradients_;
+  double sparse_density_threshold_;
+
+  // Indices of the ready buckets of sparse gradients whose reduction is held
+  // back to coalesce it with the following buckets.
+  std::vector<size_t> pending_sparse_buckets_;
+
+  // See `set_gradient_as_bucket_view`.
+  bool gradient_as_bucket_view_;
 };
 
 std::vector<std::vector<size_t>> compute_bucket_assignment_by_size(
@@ -7,6 +7,7 @@
 #include <torch/csrc/distributed/rpc/python_rpc_handler.h>
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 #include <torch/csrc/distributed/rpc/rref_context.h>
+#include <torch/csrc/distributed/rpc/script_call_batcher.h>
 #include <torch/csrc/distributed/rpc/tensorpipe_agent.h>
 #include <torch/csrc/distributed/rpc/torchscript_functions.h>
 #include <torch/csrc/distributed/rpc/types.h>
@@ -477,6 +478,9 @@ PyObject* rpc_init(PyObject* /* unused */) {
                   store used for rendezvous. It takes any value accepted for the
                   same argument of :meth:`~torch.distributed.init_process_group`
                   (default: ``env://``).
+              device_maps (Dict[str, Dict[int, int]], optional): Device
+                  placement mappings from this worker to the callee, see
+                  :meth:`set_device_map` (default: ``{}``).
       )")
       .def(
           py::init<
@@ -484,12 +488,14 @@ PyObject* rpc_init(PyObject* /* unused */) {
               optional<std::vector<std::string>>,
               optional<std::vector<std::string>>,
               float,
-              std::string>(),
+              std::string,
+              std::unordered_map<std::string, DeviceMap>>(),
           py::arg("num_worker_threads") = kDefaultNumWorkerThreads,
           py::arg("_transports") = optional<std::vector<std::string>>(),
           py::arg("_channels") = optional<std::vector<std::string>>(),
           py::arg("rpc_timeout") = kDefaultRpcTimeoutSeconds,
-          py::arg("init_method") = kDefaultInitMethod)
+          py::arg("init_method") = kDefaultInitMethod,
+          py::arg("device_maps") = std::unordered_map<std::string, DeviceMap>())
       .def_readwrite(
           "num_worker_threads",
           &TensorPipeRpcBackendOptions::numWorkerThreads,
@@ -497,6 +503,61 @@ PyObject* rpc_init(PyObject* /* unused */) {
               The number of threads in the thread-pool used by
               :class:`~torch.distributed.rpc.TensorPipeAgent` to execute
               requests.
+          )")
+      .def_readonly(
+          "device_maps",
+          &TensorPipeRpcBackendOptions::deviceMaps,
+          R"(The device map locations.)")
+      .def(
+          "set_device_map",
+          &TensorPipeRpcBackendOptions::setDeviceMap,
+          py::arg("to"),
+          py::arg("device_map"),
+          R"(
+              Set the device mapping between each RPC caller and callee pair.
+              This function can be called multiple times to incrementally add
+              device placement configurations.
+
+              Arguments:
+                  to (str): Callee name.
+                  device_map (Dict of int): Device placement mappings from this
+                      worker to the callee. Tensors on a CUDA device of this
+                      worker are placed on the mapped CUDA device of the
+                      callee, and the tensors of the responses are placed
+                      back on the device of this worker they map from. The
+                      data of CUDA tensors is copied through CPU memory.
+
+              Example::
+                  >>> # both workers
+                  >>> def add(x, y):
+                  >>>     print(x)  # tensor([1., 1.], device='cuda:1')
+                  >>>     return x + y, (x + y).to(2)
+                  >>>
+                  >>> # on worker 0
+                  >>> options = TensorPipeRpcBackendOptions(
+                  >>>     num_worker_threads=8,
+                  >>>     device_maps={"worker1": {0: 1}}
+                  >>>     # maps worker0's cuda:0 to worker1's cuda:1
+                  >>> )
+                  >>> options.set_device_map("worker1", {1: 2})
+                  >>> # maps worker0's cuda:1 to worker1's cuda:2
+                  >>>
+                  >>> rpc.init_rpc(
+                  >>>     "worker0",
+                  >>>     rank=0,
+                  >>>     world_size=2,
+                  >>>     backend=rpc.BackendType.TENSORPIPE,
+                  >>>     rpc_backend_options=options
+                  >>> )
+                  >>>
+                  >>> x = torch.ones(2)
+                  >>> rets = rpc.rpc_sync("worker1", add, args=(x.to(0), 1))
+                  >>> # The first argument will be moved to cuda:1 on worker1.
+                  >>> # When sending the return value back, it will follow the
+                  >>> # inverse of the device map, and hence will be moved back
+                  >>> # to cuda:0 and cuda:1 on worker0
+                  >>> print(rets[0])  # tensor([2., 2.], device='cuda:0')
+                  >>> print(rets[1])  # tensor([2., 2.], device='cuda:1')
           )");
 
   module.attr("_DEFAULT_NUM_WORKER_THREADS") =
@@ -510,13 +571,16 @@ PyObject* rpc_init(PyObject* /* unused */) {
               worker_id_t /* selfId */,
               int /* worldSize */,
               std::shared_ptr<::c10d::ProcessGroup> /* processGroup */,
-              TensorPipeRpcBackendOptions /* TensorPipeBackendOptions */>(),
+              TensorPipeRpcBackendOptions /* TensorPipeBackendOptions */,
+              std::unordered_map<std::string, DeviceMap> /* reverseMaps */>(),
           py::arg("store"),
           py::arg("name"),
           py::arg("rank"),
           py::arg("world_size"),
           py::arg("process_group"),
-          py::arg("rpc_backend_options"))
+          py::arg("rpc_backend_options"),
+          py::arg("reverse_device_maps") =
+              std::unordered_map<std::string, DeviceMap>())
       .def(
           "join",
           &TensorPipeAgent::join,
@@ -589,6 +653,28 @@ PyObject* rpc_init(PyObject* /* unused */) {
     return RRefContext::getInstance().getDebugInfo();
   });
 
+  module.def(
+      "_enable_script_call_batching",
+      [](const std::string& qualifiedName,
+         int64_t maxBatchSize,
+         std::chrono::milliseconds maxDelay) {
+        ScriptCallBatcher::getInstance().enableBatching(
+            c10::QualifiedName(qualifiedName), maxBatchSize, maxDelay);
+      },
+      py::arg("qualified_name"),
+      py::arg("max_batch_size"),
+      py::arg("max_delay"),
+      py::call_guard<py::gil_scoped_release>());
+
+  module.def(
+      "_disable_script_call_batching",
+      [](const std::string& qualifiedName) {
+        ScriptCallBatcher::getInstance().disableBatching(
+            c10::QualifiedName(qualifiedName));
+      },
+      py::arg("qualified_name"),
+      py::call_guard<py::gil_scoped_release>());
+
   module.def(
       "_cleanup_python_rpc_handler",
       []() { PythonRpcHandler::getInstance().cleanup(); },
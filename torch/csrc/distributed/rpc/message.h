@@ -56,6 +56,9 @@ enum MessageType {
   RUN_WITH_PROFILING_REQ = 21,
   RUN_WITH_PROFILING_RESP = 22,
 
+  // Several RREF_FORK_REQUESTs to the same owner, sent as one message.
+  RREF_FORK_BATCH_REQUEST = 23,
+
   // Other internal message types
   EXCEPTION = 55,
   UNKNOWN = 60
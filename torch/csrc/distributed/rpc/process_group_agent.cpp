@@ -8,6 +8,15 @@
 
 #include <Python.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <random>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
@@ -16,8 +25,38 @@ const std::string kRPCTimeoutErrorStr =
 
 namespace {
 constexpr auto kSecToMsConversion = 1000;
+
+#ifndef _WIN32
+
+// Messages to peers on the same host are sent through a POSIX shared memory
+// segment if their tensors hold at least this many bytes. Below it, the cost
+// of creating and mapping a segment outweighs the saved copies.
+constexpr int64_t kShmMinTensorBytes = 1 << 20;
+
+// Names are kept short, as macOS limits them to 31 characters.
+std::string shmProbeName(uint32_t token) {
+  return fmt::format("/trpc_{:08x}", token);
+}
+
+std::string shmSegmentName(uint32_t token, int64_t seq) {
+  return fmt::format("/trpc_{:08x}_{:x}", token, seq);
+}
+
+// Returns whether the segment `name` still exists, i.e. hasn't been mapped and
+// removed by its receiver yet.
+bool shmSegmentExists(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    return errno != ENOENT;
+  }
+  ::close(fd);
+  return true;
 }
 
+#endif
+
+} // namespace
+
 //////////////////////////  MessageCounter  /////////////////////////////////
 
 ProcessGroupAgent::MessageCounter::MessageCounter(int worldSize)
@@ -107,6 +146,8 @@ ProcessGroupAgent::ProcessGroupAgent(
           std::make_unique<RequestCallbackImpl>(),
           rpcTimeout),
       pg_(std::move(pg)),
+      shmToken_(0),
+      nextShmSeq_(0),
       sendCounts_(pg_->getSize()),
       recvCounts_(pg_->getSize()),
       nextId_(0),
@@ -143,6 +184,111 @@ ProcessGroupAgent::ProcessGroupAgent(
   for (worker_id_t rank = 0; rank < worldSize; ++rank) {
     allWorkerInfo_.emplace_back(std::move(tmpWorkerIds[rank]), rank);
   }
+
+  collectShmTokens();
+}
+
+void ProcessGroupAgent::collectShmTokens() {
+  const auto worldSize = pg_->getSize();
+  shmTokens_.assign(worldSize, 0);
+
+  // Every agent creates a probe segment holding a random nonce, and checks
+  // which probes of its peers it can open and read the nonce of. The nonce
+  // tells apart probes with the same name on different hosts.
+  uint32_t token = 0;
+  int64_t nonce = 0;
+#ifndef _WIN32
+  std::random_device rd;
+  while (token == 0) {
+    token = rd();
+  }
+  nonce = (static_cast<int64_t>(rd()) << 32) | rd();
+  int fd = shm_open(
+      shmProbeName(token).c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd != -1) {
+    void* ptr = MAP_FAILED;
+    if (ftruncate(fd, sizeof(nonce)) == 0) {
+      ptr = mmap(nullptr, sizeof(nonce), PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (ptr != MAP_FAILED) {
+      memcpy(ptr, &nonce, sizeof(nonce));
+      munmap(ptr, sizeof(nonce));
+    } else {
+      shm_unlink(shmProbeName(token).c_str());
+      token = 0;
+    }
+  } else {
+    token = 0;
+  }
+#endif
+
+  std::vector<torch::Tensor> inputTokens = {
+      torch::tensor({(int64_t)token, nonce}, {torch::kInt64})};
+  std::vector<std::vector<torch::Tensor>> outputTokens(1);
+  for (int i = 0; i < worldSize; ++i) {
+    outputTokens[0].emplace_back(torch::empty({2}, {torch::kInt64}));
+  }
+  pg_->allgather(outputTokens, inputTokens)->wait();
+
+#ifndef _WIN32
+  for (worker_id_t i = 0; i < worldSize; ++i) {
+    const int64_t* peer = outputTokens[0][i].data_ptr<int64_t>();
+    const auto peerToken = static_cast<uint32_t>(peer[0]);
+    if (i == pg_->getRank() || token == 0 || peerToken == 0) {
+      continue;
+    }
+    int peerFd = shm_open(shmProbeName(peerToken).c_str(), O_RDONLY, 0);
+    if (peerFd == -1) {
+      continue;
+    }
+    void* ptr = mmap(nullptr, sizeof(nonce), PROT_READ, MAP_SHARED, peerFd, 0);
+    ::close(peerFd);
+    if (ptr == MAP_FAILED) {
+      continue;
+    }
+    if (memcmp(ptr, &peer[1], sizeof(nonce)) == 0) {
+      shmTokens_[i] = peerToken;
+    }
+    munmap(ptr, sizeof(nonce));
+  }
+
+  // Wait for all peers to be done with the probe before removing it.
+  pg_->barrier()->wait();
+  if (token != 0) {
+    shm_unlink(shmProbeName(token).c_str());
+  }
+#endif
+  shmToken_ = token;
+  unreadShmSegments_.resize(worldSize);
+}
+
+void ProcessGroupAgent::trackShmSegment(worker_id_t dst, int64_t seq) {
+#ifndef _WIN32
+  std::lock_guard<std::mutex> guard(shmSegmentsMutex_);
+  // The receiver removes the name of a segment as soon as it has mapped it.
+  // It reads the segments about in the order they were written, so stop
+  // looking at the first one that still exists.
+  auto& unread = unreadShmSegments_[dst];
+  while (!unread.empty() &&
+         !shmSegmentExists(shmSegmentName(shmToken_, unread.front()))) {
+    unread.pop_front();
+  }
+  unread.push_back(seq);
+#endif
+}
+
+void ProcessGroupAgent::unlinkShmSegments() {
+#ifndef _WIN32
+  std::lock_guard<std::mutex> guard(shmSegmentsMutex_);
+  for (auto& unread : unreadShmSegments_) {
+    for (auto seq : unread) {
+      // Fails with ENOENT for the segments that have been read meanwhile.
+      shm_unlink(shmSegmentName(shmToken_, seq).c_str());
+    }
+    unread.clear();
+  }
+#endif
 }
 
 ProcessGroupAgent::~ProcessGroupAgent() {
@@ -291,6 +437,7 @@ void ProcessGroupAgent::shutdownImpl() {
   // that we can finish any possible work enqueued into the thread pool, before
   // python RPC handler is shutdown (see shutdown in rpc/api.py).
   threadPool_.waitWorkComplete();
+  unlinkShmSegments();
 }
 
 std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
@@ -392,20 +539,47 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
 }
 
 void ProcessGroupAgent::handleSend(const SendWork& work) {
-  auto serializedPayload = std::make_unique<std::string>(std::move(
-      wireSerialize(work.message_.payload(), work.message_.tensors())));
+  // The tensor data is left out of the serialized payload and sent as is, so
+  // that it is never copied on this side.
+  auto serialized =
+      wireSerializeMetadata(work.message_.payload(), work.message_.tensors());
+  auto serializedPayload =
+      std::make_unique<std::string>(std::move(serialized.first));
+  std::vector<torch::Tensor>& tensorData = serialized.second;
+
+  const auto dst = work.to_.id_;
+
+  // Peers on the same host read large tensor data from a shared memory
+  // segment instead, which costs a single copy on either side.
+  int64_t shmSeq = -1;
+#ifndef _WIN32
+  if (shmTokens_[dst] != 0) {
+    int64_t tensorBytes = 0;
+    for (const auto& t : tensorData) {
+      tensorBytes += t.numel();
+    }
+    if (tensorBytes >= kShmMinTensorBytes) {
+      shmSeq = nextShmSeq_++;
+      if (writeShmSegment(shmSegmentName(shmToken_, shmSeq), tensorData)) {
+        trackShmSegment(dst, shmSeq);
+      } else {
+        shmSeq = -1;
+      }
+    }
+  }
+#endif
 
   std::vector<torch::Tensor> preamble = {torch::tensor(
       {(int64_t)pg_->getRank(),
        (int64_t)serializedPayload->length(),
        (int64_t)work.message_.type(),
-       (int64_t)work.message_.id()},
+       (int64_t)work.message_.id(),
+       shmSeq},
       {torch::kInt64})};
 
   // ProcessGroup is not thread-safe when sending with the same tag,
   // hence the lock
   std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> pendingSends;
-  const auto dst = work.to_.id_;
 
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto serializedPayloadData = const_cast<char*>(serializedPayload->data());
@@ -416,7 +590,7 @@ void ProcessGroupAgent::handleSend(const SendWork& work) {
       serializedPayloadSize,
       [deleteWhenDone](void*) { delete deleteWhenDone; },
       {torch::kChar})};
-  pendingSends.reserve(2);
+  pendingSends.reserve(2 + tensorData.size());
 
   sendCounts_.increment(dst);
 
@@ -424,6 +598,15 @@ void ProcessGroupAgent::handleSend(const SendWork& work) {
     std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
     pendingSends.emplace_back(pg_->send(preamble, dst, dst /* channelTag */));
     pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    if (shmSeq < 0) {
+      for (auto& t : tensorData) {
+        // Empty buffers are not sent, the receiver doesn't wait for them.
+        if (t.numel() > 0) {
+          std::vector<torch::Tensor> data = {t};
+          pendingSends.emplace_back(pg_->send(data, dst, dst /* channelTag */));
+        }
+      }
+    }
   }
   // Write pendingSends to a global map so that they can be interrupted by
   // ::shutdown().
@@ -460,9 +643,16 @@ void ProcessGroupAgent::sendToSelf(Message&& message) {
         // data outlives the scope of this function. It's shared_ptr<> due
         // to c++11 lambda capture limitations with unique_ptr<>.
         std::unique_ptr<std::string> payload;
+        std::vector<torch::Tensor> tensorData;
         try {
-          payload = std::make_unique<std::string>(
-              wireSerialize(message.payload(), message.tensors()));
+          auto serialized =
+              wireSerializeMetadata(message.payload(), message.tensors());
+          payload = std::make_unique<std::string>(std::move(serialized.first));
+          // Copy the tensor data, so that the received tensors don't share
+          // storages with the sent ones, as they would not over the wire.
+          for (const auto& t : serialized.second) {
+            tensorData.push_back(t.clone());
+          }
           // only increment sendCounts when the message is indeed added into
           // local recv.
           sendCounts_.increment(pg_->getRank());
@@ -481,7 +671,8 @@ void ProcessGroupAgent::sendToSelf(Message&& message) {
                 (void*)data,
                 len,
                 [delete_when_done](void*) { delete delete_when_done; },
-                {torch::kChar})));
+                {torch::kChar}),
+            std::move(tensorData)));
       },
       std::move(message)));
 }
@@ -514,7 +705,8 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
 
 bool ProcessGroupAgent::handleRecv(RecvWork& work) {
   torch::Tensor& payload = work.payload_;
-  auto data = wireDeserialize(payload.storage().data(), payload.numel());
+  auto data = wireDeserializeMetadata(
+      payload.storage().data(), payload.numel(), work.tensorData_);
   Message message(
       std::move(data.first), std::move(data.second), work.type_, work.id_);
   if (message.isRequest()) {
@@ -716,17 +908,21 @@ void ProcessGroupAgent::listenLoop() {
 }
 
 void ProcessGroupAgent::listenLoopInternal() {
-  while (rpcAgentRunning_.load()) {
-    // rank, tensor size, message type
-    std::vector<torch::Tensor> preamble = {torch::empty({4}, {torch::kInt64})};
-    auto work = pg_->recvAnysource(preamble, pg_->getRank());
+  // Waits for `work` while it can be aborted by shutdown(). Returns false if
+  // it was aborted.
+  auto waitRecv = [this](std::shared_ptr<c10d::ProcessGroup::Work> work) {
     {
       // Write class variable so it can be aborted by shutdown()
       std::lock_guard<std::mutex> guard(recvWorkMutex_);
       recvWork_ = work;
     }
+    return rpcAgentRunning_.load() && work->wait() /* not aborted */;
+  };
 
-    if (!rpcAgentRunning_.load() || !work->wait() /* aborted */) {
+  while (rpcAgentRunning_.load()) {
+    // rank, tensor size, message type, message id, shared memory segment
+    std::vector<torch::Tensor> preamble = {torch::empty({5}, {torch::kInt64})};
+    if (!waitRecv(pg_->recvAnysource(preamble, pg_->getRank()))) {
       return;
     }
 
@@ -736,21 +932,41 @@ void ProcessGroupAgent::listenLoopInternal() {
     auto size = preamble_items[1];
     MessageType type = MessageType(preamble_items[2]);
     int64_t id = preamble_items[3];
+    int64_t shmSeq = preamble_items[4];
 
     std::vector<torch::Tensor> tensors = {torch::empty({size}, {torch::kChar})};
-    work = pg_->recv(tensors, srcRank, pg_->getRank());
-    {
-      // Write class variable so it can be aborted by shutdown()
-      std::lock_guard<std::mutex> guard(recvWorkMutex_);
-      recvWork_ = work;
+    if (!waitRecv(pg_->recv(tensors, srcRank, pg_->getRank()))) {
+      return;
     }
 
-    if (!rpcAgentRunning_.load() || !work->wait() /* aborted */) {
-      return;
+    auto tensorSizes = wireTensorDataSizes(tensors[0].data_ptr(), size);
+    std::vector<torch::Tensor> tensorData;
+    if (shmSeq >= 0) {
+#ifndef _WIN32
+      tensorData = readShmSegment(
+          shmSegmentName(shmTokens_[srcRank], shmSeq), tensorSizes);
+#else
+      TORCH_INTERNAL_ASSERT(false, "Shared memory is not supported.");
+#endif
+    } else {
+      tensorData.reserve(tensorSizes.size());
+      for (auto tensorSize : tensorSizes) {
+        tensorData.push_back(torch::empty({tensorSize}, {torch::kChar}));
+        if (tensorSize > 0) {
+          std::vector<torch::Tensor> data = {tensorData.back()};
+          if (!waitRecv(pg_->recv(data, srcRank, pg_->getRank()))) {
+            return;
+          }
+        }
+      }
     }
 
-    enqueueRecv(
-        RecvWork(allWorkerInfo_[srcRank], type, id, std::move(tensors[0])));
+    enqueueRecv(RecvWork(
+        allWorkerInfo_[srcRank],
+        type,
+        id,
+        std::move(tensors[0]),
+        std::move(tensorData)));
   }
 }
 
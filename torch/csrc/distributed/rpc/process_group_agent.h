@@ -5,6 +5,7 @@
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 
 #include <atomic>
+#include <deque>
 #include <thread>
 
 namespace torch {
@@ -40,20 +41,29 @@ struct SendWork {
   Message message_;
 };
 
-// SendWork wraps a Message and RecvWork wraps a Tensor. The difference here is
+// SendWork wraps a Message and RecvWork wraps Tensors. The difference here is
 // to allow us to run serialization/deserialization in the worker threads.
+// payload_ holds the output of wireSerializeMetadata(), and tensorData_ the
+// bytes of the storages of the tensors of the message, which become the
+// storages of the deserialized tensors without being copied.
 struct RecvWork {
   RecvWork(
       const WorkerInfo& from,
       MessageType type,
       int64_t id,
-      torch::Tensor&& payload)
-      : from_(from), type_(type), id_(id), payload_(payload) {}
+      torch::Tensor&& payload,
+      std::vector<torch::Tensor>&& tensorData)
+      : from_(from),
+        type_(type),
+        id_(id),
+        payload_(payload),
+        tensorData_(std::move(tensorData)) {}
 
   const WorkerInfo& from_;
   const MessageType type_;
   const int64_t id_;
   torch::Tensor payload_;
+  std::vector<torch::Tensor> tensorData_;
 };
 
 class ProcessGroupAgent : public RpcAgent {
@@ -145,6 +155,16 @@ class ProcessGroupAgent : public RpcAgent {
   };
 
   void collectNames();
+  // Finds the peers that can open the POSIX shared memory segments created by
+  // this process, i.e. the ones which run on the same host as the same user,
+  // and fills shmTokens_.
+  void collectShmTokens();
+  // Records the segment `seq` written for `dst`, and forgets the ones that
+  // `dst` has already mapped and removed.
+  void trackShmSegment(worker_id_t dst, int64_t seq);
+  // Removes the segments written by this agent that their receivers never
+  // mapped, e.g. because the messages were still in flight at shutdown.
+  void unlinkShmSegments();
   // handle a SendWork request. This serializes the payload inside the work
   // object, and sends the message to the receiver using the underlying
   // ProcessGroup.
@@ -211,6 +231,17 @@ class ProcessGroupAgent : public RpcAgent {
   // worker name -> rank
   std::unordered_map<std::string, worker_id_t> nameMap_;
   std::vector<WorkerInfo> allWorkerInfo_;
+  // rank -> token naming the shared memory segments created by that peer, or
+  // 0 if the peer cannot share memory with this process. Large tensors sent
+  // to such peers are written to a shared memory segment instead of being
+  // sent through the ProcessGroup.
+  std::vector<uint32_t> shmTokens_;
+  uint32_t shmToken_;
+  std::atomic<int64_t> nextShmSeq_;
+  // rank -> sequence numbers of the segments written for that peer which it
+  // may not have mapped yet, in the order it reads them in.
+  std::vector<std::deque<int64_t>> unreadShmSegments_;
+  std::mutex shmSegmentsMutex_;
   // record the number of messages sent to and received from each peer. The recv
   // counter is only marked after the message is processed. Join uses allgather
   // to collect all counts from all peers, uses these counters to detect global
@@ -22,6 +22,7 @@
 #include <torch/csrc/distributed/rpc/rref_impl.h>
 #include <torch/csrc/distributed/rpc/rref_proto.h>
 #include <torch/csrc/distributed/rpc/script_call.h>
+#include <torch/csrc/distributed/rpc/script_call_batcher.h>
 #include <torch/csrc/distributed/rpc/script_remote_call.h>
 #include <torch/csrc/distributed/rpc/script_resp.h>
 #include <torch/csrc/distributed/rpc/unpickled_python_call.h>
@@ -212,6 +213,11 @@ void RequestCallbackImpl::processRpc(
         return;
       }
 
+      if (ScriptCallBatcher::getInstance().tryEnqueue(
+              scriptCall, messageId, responseFuture)) {
+        return;
+      }
+
       // runAsync() starts in the calling thread, but may return an uncompleted
       // future (though for non-async code, it will typically be completed).
       // If it was async, our callback will typically be invoked by the
@@ -617,6 +623,15 @@ void RequestCallbackImpl::processRpc(
       markComplete(RRefAck().toMessage());
       return;
     }
+    case MessageType::RREF_FORK_BATCH_REQUEST: {
+      auto& rfbr = static_cast<RRefForkBatchRequest&>(rpc);
+      auto& ctx = RRefContext::getInstance();
+      for (const auto& fork : rfbr.forks()) {
+        ctx.addForkOfOwnerIfNotPresent(fork.first, fork.second);
+      }
+      markComplete(RRefAck().toMessage());
+      return;
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       auto& rpcWithAutograd = static_cast<RpcWithAutograd&>(rpc);
 
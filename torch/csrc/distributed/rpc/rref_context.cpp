@@ -91,14 +91,18 @@ std::vector<c10::intrusive_ptr<RRef>> RRefContext::destroyInstance(
   }
   ctx.checkRRefLeaks(ignoreRRefLeak);
   std::vector<c10::intrusive_ptr<RRef>> deletedRRefs;
-  for (auto& entry : ctx.owners_) {
-    auto rref = entry.second;
-    if (rref->isPyObj()) {
-      deletedRRefs.emplace_back(std::move(rref));
+  for (auto& shard : ctx.ownerShards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    for (auto& entry : shard.owners_) {
+      auto rref = entry.second;
+      if (rref->isPyObj()) {
+        deletedRRefs.emplace_back(std::move(rref));
+      }
     }
+    ctx.numOwners_ -= shard.owners_.size();
+    shard.owners_.clear();
+    shard.pendingOwners_.clear();
   }
-  ctx.owners_.clear();
-  ctx.pendingOwners_.clear();
   return deletedRRefs;
 }
 
@@ -113,7 +117,7 @@ RRefContext::RRefContext(std::shared_ptr<RpcAgent> agent)
     : agent_(std::move(agent)), destroyed_(false) {}
 
 RRefContext::~RRefContext() {
-  if (!owners_.empty()) {
+  if (numOwners_ > 0) {
     VLOG(1) << "Destructing RRefContext with non-empty OwnerRRef set. "
             << "This would likely cause Python deref error. "
             << "Make sure destroyInstance() is invoked before destruction.";
@@ -122,31 +126,36 @@ RRefContext::~RRefContext() {
 
 std::unordered_map<std::string, std::string> RRefContext::getDebugInfo() {
   std::unordered_map<std::string, std::string> info;
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto ownerSize = owners_.size();
-  auto numPendingUsers = pendingUsers_.size();
   int numForks = 0;
-  for (const auto& owner : forks_) {
-    numForks += owner.second.size();
+  for (auto& shard : ownerShards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    for (const auto& owner : shard.forks_) {
+      numForks += owner.second.size();
+    }
   }
-  lock.unlock();
-  info[kNumOwnerRRefs] = c10::to_string(ownerSize);
+  info[kNumOwnerRRefs] = c10::to_string(numOwners_.load());
   info[kNumPendingFutures] = c10::to_string(numPendingFutures_.load());
-  info[kNumPendingUsers] = c10::to_string(numPendingUsers);
+  info[kNumPendingUsers] = c10::to_string(numPendingUsers_.load());
   info[kNumForks] = c10::to_string(numForks);
   return info;
 }
 
 void RRefContext::checkRRefLeaks(bool ignoreRRefLeak) {
-  if (!forks_.empty()) {
-    std::stringstream ss;
-    for (auto& entry : forks_) {
+  std::stringstream ss;
+  bool leaking = false;
+  for (auto& shard : ownerShards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    for (auto& entry : shard.forks_) {
       const RRefId& rrefId = entry.first;
       for (const auto& forkId : entry.second) {
         ss << "Leaking RRef " << rrefId << " with fork Id " << forkId
            << std::endl;
+        leaking = true;
       }
     }
+  }
+
+  if (leaking) {
 
     LOG(WARNING)
         << "Detected RRef Leaks during shutdown. This usually "
@@ -220,8 +229,9 @@ void RRefContext::delUser(
     }
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  confirmedUsers_.erase(forkId);
+  auto& shard = userShard(forkId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  shard.confirmedUsers_.erase(forkId);
 }
 
 void RRefContext::delAllUsersAndUnforkedOwners(
@@ -232,15 +242,20 @@ void RRefContext::delAllUsersAndUnforkedOwners(
   std::unordered_map<ForkId, c10::weak_intrusive_ptr<RRef>, ForkId::Hash>
       tempConfirmedUsers;
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(deleteAllUsersMutex_);
     bool noPending = deleteAllUsersCV_.wait_for(lock, timeoutMillis, [this]() {
-      return pendingUsers_.size() == 0 && pendingChildren_.size() == 0;
+      return numPendingUsers_ == 0 && numPendingChildren_ == 0;
     });
     if (!noPending) {
       LOG(ERROR)
           << "Timed out waiting for pending UserRRefs to be confirmed by owner and parent.";
     }
-    tempConfirmedUsers.swap(confirmedUsers_);
+  }
+  for (auto& shard : userShards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    tempConfirmedUsers.insert(
+        shard.confirmedUsers_.begin(), shard.confirmedUsers_.end());
+    shard.confirmedUsers_.clear();
   }
 
   // Start sending UserRRef delete messages, after all pendings are confirmed.
@@ -260,28 +275,29 @@ void RRefContext::delAllUsersAndUnforkedOwners(
   // corresponding message from the forking node(s) telling us to delete the
   // RRef. Hence we delete the RRef here. This can occur when a remote call is
   // sent to self and times out.
-  {
-    std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& shard : ownerShards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex_);
     std::vector<RRefId> unforkedOwners;
-    for (const auto& it : owners_) {
+    for (const auto& it : shard.owners_) {
       auto rrefId = it.first;
-      if (forks_.find(rrefId) == forks_.end()) {
+      if (shard.forks_.find(rrefId) == shard.forks_.end()) {
         // Successful fork of owner was never processed.
         unforkedOwners.push_back(rrefId);
       }
     }
     for (auto& rrefId : unforkedOwners) {
       LOG(INFO) << "Removing unforked OwnerRRef with RRefId: " << rrefId;
-      auto iter = owners_.find(rrefId);
-      owners_.erase(iter);
+      auto iter = shard.owners_.find(rrefId);
+      shard.owners_.erase(iter);
+      --numOwners_;
     }
   }
   // Wait for this node to process all delete UserRRef messages it may get for
   // the OwnerRRefs that exist on this node.
   {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(deleteAllUsersMutex_);
     bool noOwner = deleteAllUsersCV_.wait_for(
-        lock, timeoutMillis, [this]() { return owners_.size() == 0; });
+        lock, timeoutMillis, [this]() { return numOwners_ == 0; });
     if (!noOwner) {
       LOG(ERROR) << "Timed out waiting for pending OwnerRRefs to be deleted.";
     }
@@ -304,19 +320,21 @@ c10::intrusive_ptr<RRef> RRefContext::getOrCreateRRef(
 c10::intrusive_ptr<OwnerRRef> RRefContext::getOrCreateOwnerRRef(
     const RRefId& rrefId,
     const TypePtr& type) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  const auto iter = owners_.find(rrefId);
-  if (iter == owners_.end()) {
+  auto& shard = ownerShard(rrefId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  const auto iter = shard.owners_.find(rrefId);
+  if (iter == shard.owners_.end()) {
     // Scenario (1) the first time this owner knows about this RRef
     //
     // NB: cannot use make_shared here as the constructor of OwnerRRef is
     // private.
     auto rref = c10::make_intrusive<OwnerRRef>(getWorkerId(), rrefId, type);
-    owners_[rref->rrefId()] = rref;
-    const auto pendingOwnerIter = pendingOwners_.find(rrefId);
-    if (pendingOwnerIter != pendingOwners_.end()) {
+    shard.owners_[rref->rrefId()] = rref;
+    ++numOwners_;
+    const auto pendingOwnerIter = shard.pendingOwners_.find(rrefId);
+    if (pendingOwnerIter != shard.pendingOwners_.end()) {
       pendingOwnerIter->second->markCompleted(rref);
-      pendingOwners_.erase(pendingOwnerIter);
+      shard.pendingOwners_.erase(pendingOwnerIter);
     }
     return rref;
   } else {
@@ -367,20 +385,21 @@ c10::intrusive_ptr<OwnerRRef> RRefContext::createOwnerRRef(
 
 std::shared_ptr<Future<c10::intrusive_ptr<OwnerRRef>>> RRefContext::
     getOwnerRRef(const RRefId& rrefId, bool forceCreated) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  const auto iter = owners_.find(rrefId);
-  if (iter == owners_.end()) {
+  auto& shard = ownerShard(rrefId);
+  std::unique_lock<std::mutex> lock(shard.mutex_);
+  const auto iter = shard.owners_.find(rrefId);
+  if (iter == shard.owners_.end()) {
     if (forceCreated) {
       TORCH_INTERNAL_ASSERT(
           false,
           c10::str("Expected OwnerRRef with id ", rrefId, " to be created."));
     }
     // Scenario (1) RRef is used before it is created
-    const auto pendingOwnerIter = pendingOwners_.find(rrefId);
-    if (pendingOwnerIter == pendingOwners_.end()) {
+    const auto pendingOwnerIter = shard.pendingOwners_.find(rrefId);
+    if (pendingOwnerIter == shard.pendingOwners_.end()) {
       auto futureOwner =
           std::make_shared<Future<c10::intrusive_ptr<OwnerRRef>>>();
-      pendingOwners_[rrefId] = futureOwner;
+      shard.pendingOwners_[rrefId] = futureOwner;
       return futureOwner;
     } else {
       return pendingOwnerIter->second;
@@ -421,8 +440,11 @@ RRefForkData RRefContext::prepareChildFork(
     // ensure that this RRef is in the owners_ list to keep it alive.
     // this is needed for OwnerRRefs that were created locally.
     {
-      std::lock_guard<std::mutex> lock(mutex_);
-      owners_[rref->rrefId()] = rref;
+      auto& shard = ownerShard(rref->rrefId());
+      std::lock_guard<std::mutex> lock(shard.mutex_);
+      if (shard.owners_.emplace(rref->rrefId(), rref).second) {
+        ++numOwners_;
+      }
     }
   } else {
     // Note [Useful Phantom Fork ID for User to Owner Call]
@@ -467,7 +489,7 @@ void RRefContext::notifyOwnerAndParentOfFork(
       // Hence, it is not necessary to send another RREF_CHILD_ACCEPT or
       // RREF_FORK_REQUEST back to the owner. See Note [Early Fork
       // Registration].
-      std::lock_guard<std::mutex> lock(mutex_);
+      std::lock_guard<std::mutex> lock(userShard(forkId).mutex_);
       addConfirmedUser(forkId, rref);
     }
     return;
@@ -487,20 +509,74 @@ void RRefContext::notifyOwnerAndParentOfFork(
       --numPendingFutures_;
     });
   } else {
-    ++numPendingFutures_;
-    auto fm = agent_->sendWithRetries(
-        agent_->getWorkerInfo(rref->owner()),
-        RRefForkRequest(rref->rrefId(), forkId).toMessage());
-
     addPendingUser(forkId, rref);
-    fm->addCallback([this, forkId, parent](const FutureMessage& fm) {
-      handleException(fm);
-      this->finishForkRequest(forkId, parent);
-      // Decrease after calling finishForkRequest because, as that creates a new
-      // future, it might otherwise cause the count to briefly go to zero.
-      --numPendingFutures_;
-    });
+    sendForkRequest(
+        rref->owner(), PendingForkRequest{rref->rrefId(), forkId, parent});
+  }
+}
+
+void RRefContext::sendForkRequest(
+    worker_id_t owner,
+    PendingForkRequest request) {
+  ++numPendingFutures_;
+  {
+    std::lock_guard<std::mutex> lock(forkRequestsMutex_);
+    auto& queue = forkRequests_[owner];
+    if (queue.inFlight_) {
+      queue.requests_.push_back(std::move(request));
+      return;
+    }
+    queue.inFlight_ = true;
+  }
+  std::vector<PendingForkRequest> requests;
+  requests.push_back(std::move(request));
+  sendForkRequests(owner, std::move(requests));
+}
+
+void RRefContext::sendForkRequests(
+    worker_id_t owner,
+    std::vector<PendingForkRequest> requests) {
+  Message message;
+  if (requests.size() == 1) {
+    message = RRefForkRequest(requests[0].rrefId_, requests[0].forkId_)
+                  .toMessage();
+  } else {
+    std::vector<std::pair<RRefId, ForkId>> forks;
+    forks.reserve(requests.size());
+    for (const auto& request : requests) {
+      forks.emplace_back(request.rrefId_, request.forkId_);
+    }
+    message = RRefForkBatchRequest(std::move(forks)).toMessage();
   }
+  auto fm = agent_->sendWithRetries(
+      agent_->getWorkerInfo(owner), std::move(message));
+
+  fm->addCallback([this, owner, requests](const FutureMessage& fm) {
+    // Send the requests queued in the meantime before checking for errors, so
+    // that they don't wait forever if this one failed.
+    this->sendQueuedForkRequests(owner);
+    handleException(fm);
+    for (const auto& request : requests) {
+      this->finishForkRequest(request.forkId_, request.parent_);
+    }
+    // Decrease after calling finishForkRequest because, as that creates a new
+    // future, it might otherwise cause the count to briefly go to zero.
+    numPendingFutures_ -= requests.size();
+  });
+}
+
+void RRefContext::sendQueuedForkRequests(worker_id_t owner) {
+  std::vector<PendingForkRequest> requests;
+  {
+    std::lock_guard<std::mutex> lock(forkRequestsMutex_);
+    auto& queue = forkRequests_[owner];
+    if (queue.requests_.empty()) {
+      queue.inFlight_ = false;
+      return;
+    }
+    std::swap(requests, queue.requests_);
+  }
+  sendForkRequests(owner, std::move(requests));
 }
 
 void RRefContext::addPendingChild(
@@ -511,23 +587,26 @@ void RRefContext::addPendingChild(
   // fork.
   TORCH_INTERNAL_ASSERT(
       !rref->isOwner(), "OwnerRRef should not have a pending child.");
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto& shard = userShard(forkId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
   TORCH_INTERNAL_ASSERT(
-      pendingChildren_.find(forkId) == pendingChildren_.end(),
+      shard.pendingChildren_.find(forkId) == shard.pendingChildren_.end(),
       "Inconsistent states: attempt to add the same child fork twice.");
-  pendingChildren_[forkId] = rref;
+  shard.pendingChildren_[forkId] = rref;
+  ++numPendingChildren_;
 }
 
 void RRefContext::delPendingChild(const ForkId& forkId) {
   c10::intrusive_ptr<RRef> deletedUser;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto iter = pendingChildren_.find(forkId);
+    auto& shard = userShard(forkId);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto iter = shard.pendingChildren_.find(forkId);
     // We first check whether the child exists in pendingChildren_. It's
     // possible the child may have been removed by a previous send attempt, and
     // this check (as opposed to an assertion here) ensures that messages that
     // trigger this function are idempotent.
-    if (iter != pendingChildren_.end()) {
+    if (iter != shard.pendingChildren_.end()) {
       // Since this UserRRef is removed from the map,
       // the refcount of this UserRRef could reach to 0,
       // so the "destructor", `release_resources()`, might be called,
@@ -536,13 +615,14 @@ void RRefContext::delPendingChild(const ForkId& forkId) {
       // Meet this constraint by creating a temporary pointer to increase the
       // refcount, extending its lifetime untill lock released.
       deletedUser = iter->second; // Increase refcount.
-      pendingChildren_.erase(iter); // Decrease refcount.
+      shard.pendingChildren_.erase(iter); // Decrease refcount.
+      --numPendingChildren_;
     } else {
       LOG(INFO) << "Ignoring duplicate request to delete child UserRRef with "
                 << "ForkId = " << forkId;
     }
   }
-  deleteAllUsersCV_.notify_all();
+  notifyDeleteAllUsers();
   // The refcount of this UserRRef could reach to 0,
   // so the "destructor", release_resources(), might be called,
   // in which the lock is acquired again,
@@ -567,24 +647,27 @@ void RRefContext::addPendingUser(
     userTable_.push_back(state);
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto& shard = userShard(forkId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
   TORCH_INTERNAL_ASSERT(
-      pendingUsers_.find(forkId) == pendingUsers_.end(),
+      shard.pendingUsers_.find(forkId) == shard.pendingUsers_.end(),
       "Inconsistent states: attempt to add the same UserRRef twice.");
 
-  pendingUsers_.emplace(
+  shard.pendingUsers_.emplace(
       std::piecewise_construct,
       std::forward_as_tuple(forkId),
       std::forward_as_tuple(state));
+  ++numPendingUsers_;
 }
 
 void RRefContext::delPendingUser(const ForkId& forkId) {
   std::shared_ptr<PendingUserState> deletedState = nullptr;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto iter = pendingUsers_.find(forkId);
+    auto& shard = userShard(forkId);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto iter = shard.pendingUsers_.find(forkId);
     TORCH_INTERNAL_ASSERT(
-        iter != pendingUsers_.end(),
+        iter != shard.pendingUsers_.end(),
         "Inconsistent states: attempt to delete a non-exist UserRRef.");
 
     // There are two reasons for keeping the deleted PendingUserState alive
@@ -608,10 +691,11 @@ void RRefContext::delPendingUser(const ForkId& forkId) {
     deletedState = iter->second; // Increase refcount
 
     addConfirmedUser(forkId, iter->second->rref_);
-    pendingUsers_.erase(iter); // Decrease refcount.
+    shard.pendingUsers_.erase(iter); // Decrease refcount.
+    --numPendingUsers_;
   }
   deletedState->confirm();
-  deleteAllUsersCV_.notify_all();
+  notifyDeleteAllUsers();
   deletedState.reset(); // Decrease refcount.
 }
 
@@ -619,17 +703,18 @@ void RRefContext::addConfirmedUser(
     const ForkId& forkId,
     const c10::intrusive_ptr<RRef>& rref) {
   // Notice, caller need to hold the mutex for confirmedUsers_.
-  // std::lock_guard<std::mutex> lock(mutex_);
-  confirmedUsers_.emplace(
+  // std::lock_guard<std::mutex> lock(userShard(forkId).mutex_);
+  userShard(forkId).confirmedUsers_.emplace(
       std::piecewise_construct,
       std::forward_as_tuple(forkId),
       std::forward_as_tuple(rref));
 }
 
 c10::intrusive_ptr<RRef> RRefContext::getPendingUser(const ForkId& forkId) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = pendingUsers_.find(forkId);
-  if (it == pendingUsers_.end()) {
+  auto& shard = userShard(forkId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  auto it = shard.pendingUsers_.find(forkId);
+  if (it == shard.pendingUsers_.end()) {
     TORCH_INTERNAL_ASSERT(
         false, "Pending user with forkId ", forkId, " not found");
   }
@@ -683,10 +768,13 @@ void RRefContext::finishForkRequest(const ForkId& forkId, worker_id_t parent) {
 }
 
 void RRefContext::addSelfAsFork(c10::intrusive_ptr<OwnerRRef>& rref) {
-  std::lock_guard<std::mutex> lock(mutex_);
   const auto& rrefId = rref->rrefId();
-  owners_[rrefId] = rref;
-  auto& rrefForks = forks_[rrefId];
+  auto& shard = ownerShard(rrefId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  if (shard.owners_.emplace(rrefId, rref).second) {
+    ++numOwners_;
+  }
+  auto& rrefForks = shard.forks_[rrefId];
   TORCH_INTERNAL_ASSERT(
       rrefForks.find(rrefId) == rrefForks.end(),
       "Attempt to add self as fork twice ",
@@ -695,8 +783,9 @@ void RRefContext::addSelfAsFork(c10::intrusive_ptr<OwnerRRef>& rref) {
 }
 
 void RRefContext::addForkOfOwner(const RRefId& rrefId, const ForkId& forkId) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto& rrefForks = forks_[rrefId];
+  auto& shard = ownerShard(rrefId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  auto& rrefForks = shard.forks_[rrefId];
   TORCH_INTERNAL_ASSERT(
       rrefForks.find(forkId) == rrefForks.end(),
       "Got fork notification twice on the same RRef ",
@@ -707,8 +796,9 @@ void RRefContext::addForkOfOwner(const RRefId& rrefId, const ForkId& forkId) {
 void RRefContext::addForkOfOwnerIfNotPresent(
     const RRefId& rrefId,
     const ForkId& forkId) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto& rrefForks = forks_[rrefId];
+  auto& shard = ownerShard(rrefId);
+  std::lock_guard<std::mutex> lock(shard.mutex_);
+  auto& rrefForks = shard.forks_[rrefId];
   // We first check whether the child exists in rrefForks. It's possible
   // the child may have been added by a previous send attempt, and this check
   // (as opposed to an assertion here) ensures that messages that trigger this
@@ -732,9 +822,10 @@ c10::intrusive_ptr<RRef> RRefContext::delForkOfOwner(
   // statements to ensure this function is idempotent. This makes it safe to
   // retry RRefUserDelete messages.
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto rrefIter = forks_.find(rrefId);
-    if (rrefIter != forks_.end()) {
+    auto& shard = ownerShard(rrefId);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto rrefIter = shard.forks_.find(rrefId);
+    if (rrefIter != shard.forks_.end()) {
       auto& rrefForks = rrefIter->second;
       auto forkIter = rrefForks.find(forkId);
       if (forkIter != rrefForks.end()) {
@@ -746,13 +837,14 @@ c10::intrusive_ptr<RRef> RRefContext::delForkOfOwner(
             << ", likely because it was deleted by a previously retried message";
       }
       if (rrefForks.empty()) {
-        auto ownerIter = owners_.find(rrefId);
-        if (ownerIter != owners_.end()) {
+        auto ownerIter = shard.owners_.find(rrefId);
+        if (ownerIter != shard.owners_.end()) {
           deletedRRef = ownerIter->second;
-          owners_.erase(ownerIter);
+          shard.owners_.erase(ownerIter);
+          --numOwners_;
           ownerReduced = true;
         }
-        forks_.erase(rrefIter);
+        shard.forks_.erase(rrefIter);
       }
     } else {
       LOG(INFO)
@@ -761,11 +853,29 @@ c10::intrusive_ptr<RRef> RRefContext::delForkOfOwner(
     }
   }
   if (ownerReduced) {
-    deleteAllUsersCV_.notify_all();
+    notifyDeleteAllUsers();
   }
   return deletedRRef;
 }
 
+RRefContext::OwnerShard& RRefContext::ownerShard(const RRefId& rrefId) {
+  return ownerShards_[RRefId::Hash()(rrefId) % kNumShards];
+}
+
+RRefContext::UserShard& RRefContext::userShard(const ForkId& forkId) {
+  return userShards_[ForkId::Hash()(forkId) % kNumShards];
+}
+
+void RRefContext::notifyDeleteAllUsers() {
+  // Acquire the mutex before notifying, as otherwise the notification could
+  // be lost if it happened after delAllUsersAndUnforkedOwners() checked the
+  // counters but before it started waiting.
+  {
+    std::lock_guard<std::mutex> lock(deleteAllUsersMutex_);
+  }
+  deleteAllUsersCV_.notify_all();
+}
+
 } // namespace rpc
 } // namespace distributed
 } // namespace torch
@@ -8,6 +8,7 @@
 #include <torch/csrc/distributed/rpc/utils.h>
 #include <torch/csrc/utils/future.h>
 
+#include <array>
 #include <atomic>
 
 namespace torch {
@@ -172,6 +173,7 @@ class TORCH_API RRefContext {
       const ForkId& forkId,
       const c10::intrusive_ptr<RRef>& rref);
   void delPendingUser(const ForkId& forkId);
+  // Must be called with the lock of the shard of forkId held, see userShard().
   void addConfirmedUser(
       const ForkId& forkId,
       const c10::intrusive_ptr<RRef>& rref);
@@ -224,6 +226,82 @@ class TORCH_API RRefContext {
     Future<bool> future_;
   };
 
+  // The state of OwnerRRefs, keyed by RRefId. See ownerShard().
+  struct OwnerShard {
+    std::mutex mutex_;
+    // Keep OwnerRRefs alive until there is no living UserRRefs.
+    std::unordered_map<RRefId, c10::intrusive_ptr<RRef>, RRefId::Hash>
+        owners_;
+    // A map to track OwnerRRefs that are requested but not yet created. This
+    // can happen if the to_here() message is processed on the owner before the
+    // corresponding creator rpc.remote() message. If this happens, instead of
+    // to_here() RPC thread to block waiting for the OwnerRRef creation, the
+    // RRefContext returns a Future, so that the RPC request processing logic
+    // can attach subsequent code as a callback to that Future.
+    // NB: the OwnerRRefs in this map must be cleared when the corresponding
+    // OwnerRRef is created.
+    std::unordered_map<
+        RRefId,
+        std::shared_ptr<Future<c10::intrusive_ptr<OwnerRRef>>>,
+        RRefId::Hash>
+        pendingOwners_;
+    // Tracks known living UserRRefs of an OwnerRRef
+    std::unordered_map<
+        RRefId,
+        std::unordered_set<ForkId, ForkId::Hash>,
+        RRefId::Hash>
+        forks_;
+  };
+
+  // The state of UserRRefs, keyed by ForkId. See userShard().
+  //
+  // The follow 3 maps keep UserRRefs alive by holding a intrusive_ptr to the
+  // RRef instances. A UserRRef must be added into this map if any of the
+  // following two conditions is true:
+  //
+  // (1) A UserRRef has not been accepted by owner yet.
+  //
+  //     It can be used or shared, but cannot be deleted, and hence kept alive
+  //     in this map. A message of type RREF_USER_ACCEPT will move the
+  //     corresponding RRef from pendingUsers_ map to confirmedUsers_ map.
+  //
+  // (2) A UserRRef has forked a child UserRRef which has not been accepted by
+  //     the owner yet.
+  //
+  //     In this case, this UserRRef cannot send out RREF_USER_DELETE message,
+  //     as it could potentially trigger the OwnerRRef been deleted before the
+  //     owner learns about the forked child.
+  struct UserShard {
+    std::mutex mutex_;
+    // For (1).
+    std::unordered_map<ForkId, std::shared_ptr<PendingUserState>, ForkId::Hash>
+        pendingUsers_;
+    // UserRRefs are added into this map when it is confirmed by the owner.
+    // When destroying RRefContext this map helps to find local UserRRefs
+    // and send delete messages if they are still not deleted by Python
+    // garbage collection.
+    std::unordered_map<ForkId, c10::weak_intrusive_ptr<RRef>, ForkId::Hash>
+        confirmedUsers_;
+    // For (2).
+    std::unordered_map<ForkId, c10::intrusive_ptr<RRef>, ForkId::Hash>
+        pendingChildren_;
+  };
+
+  // A fork request waiting to be sent to the owner of the RRef, see
+  // sendForkRequest().
+  struct PendingForkRequest {
+    RRefId rrefId_;
+    ForkId forkId_;
+    worker_id_t parent_;
+  };
+
+  // The fork requests to an owner that are queued while another of them is in
+  // flight.
+  struct ForkRequestQueue {
+    bool inFlight_{false};
+    std::vector<PendingForkRequest> requests_;
+  };
+
   RRefContext(std::shared_ptr<RpcAgent>);
 
   c10::intrusive_ptr<UserRRef> createUserRRef(
@@ -234,65 +312,56 @@ class TORCH_API RRefContext {
 
   void finishForkRequest(const ForkId& forkId, worker_id_t parent);
 
+  // Sends RREF_FORK_REQUESTs to the owner of the RRef. Requests are not
+  // delayed, but the ones issued while a previous request to the same owner is
+  // in flight are sent together, as a single RREF_FORK_BATCH_REQUEST, once its
+  // ACK is received. This bounds the number of fork messages in flight to each
+  // owner to one, which saves most of them when forking many RRefs at once.
+  void sendForkRequest(worker_id_t owner, PendingForkRequest request);
+  void sendForkRequests(
+      worker_id_t owner,
+      std::vector<PendingForkRequest> requests);
+  // Sends the requests queued for owner, if any, or marks it as having no
+  // request in flight.
+  void sendQueuedForkRequests(worker_id_t owner);
+
   // If there is any leak on any RRef, this method will throw an error.
   void checkRRefLeaks(bool ignoreRRefLeak);
 
+  // The maps tracking OwnerRRefs and UserRRefs are sharded by RRefId and
+  // ForkId respectively, so that messages about different RRefs don't contend
+  // on a single lock. The maps of an OwnerRRef (or UserRRef) and its forks are
+  // always in the same shard, so that each operation only needs the lock of
+  // one shard.
+  OwnerShard& ownerShard(const RRefId& rrefId);
+  UserShard& userShard(const ForkId& forkId);
+
+  // Wakes delAllUsersAndUnforkedOwners() up after the number of pending
+  // UserRRefs, pending UserRRef children, or OwnerRRefs has been reduced.
+  void notifyDeleteAllUsers();
+
   static std::atomic<local_id_t> nextLocalId_;
 
   const std::shared_ptr<RpcAgent> agent_;
-  mutable std::mutex mutex_;
-  // Keep OwnerRRefs alive until there is no living UserRRefs.
-  std::unordered_map<RRefId, c10::intrusive_ptr<RRef>, RRefId::Hash> owners_;
-  // A map to track OwnerRRefs that are requested but not yet created. This can
-  // happen if the to_here() message is processed on the owner before the
-  // corresponding creator rpc.remote() message. If this happens, instead of
-  // to_here() RPC thread to block waiting for the OwnerRRef creation, the
-  // RRefContext returns a Future, so that the RPC request processing logic can
-  // attach subsequent code as a callback to that Future.
-  // NB: the OwnerRRefs in this map must be cleared when the corresponding
-  // OwnerRRef is created.
-  std::unordered_map<
-      RRefId,
-      std::shared_ptr<Future<c10::intrusive_ptr<OwnerRRef>>>,
-      RRefId::Hash>
-      pendingOwners_;
-  // Tracks known living UserRRefs of an OwnerRRef
-  std::unordered_map<
-      RRefId,
-      std::unordered_set<ForkId, ForkId::Hash>,
-      RRefId::Hash>
-      forks_;
+
+  static constexpr size_t kNumShards = 32;
+  std::array<OwnerShard, kNumShards> ownerShards_;
+  std::array<UserShard, kNumShards> userShards_;
+
+  // The number of entries in the owners_, pendingUsers_ and pendingChildren_
+  // maps of all shards, which deleteAllUsers() waits on.
+  std::atomic<size_t> numOwners_{0};
+  std::atomic<size_t> numPendingUsers_{0};
+  std::atomic<size_t> numPendingChildren_{0};
 
   // This cond var is used by deleteAllUsers(), a event notificaton is sent if
   // number of pending UserRRef or UserRRef children is reduced, or
   // number of owned OwnerRRef is reduced.
+  std::mutex deleteAllUsersMutex_;
   std::condition_variable deleteAllUsersCV_;
-  // The follow 3 maps keep UserRRefs alive by holding a intrusive_ptr to the
-  // RRef instances. A UserRRef must be added into this map if any of the
-  // following two conditions is true:
-  //
-  // (1) A UserRRef has not been accepted by owner yet.
-  //
-  //     It can be used or shared, but cannot be deleted, and hence kept alive
-  //     in this map. A message of type RREF_USER_ACCEPT will move the
-  //     corresponding RRef from pendingUsers_ map to confirmedUsers_ map.
-  std::unordered_map<ForkId, std::shared_ptr<PendingUserState>, ForkId::Hash>
-      pendingUsers_;
-  //     UserRRefs are added into this map when it is confirmed by the owner.
-  //     When destroying RRefContext this map helps to find local UserRRefs
-  //     and send delete messages if they are still not deleted by Python
-  //     garbage collection.
-  std::unordered_map<ForkId, c10::weak_intrusive_ptr<RRef>, ForkId::Hash>
-      confirmedUsers_;
 
-  // (2) A UserRRef has forked a child UserRRef which has not been accepted by
-  //     the owner yet.
-  //
-  //     In this case, this UserRRef cannot send out RREF_USER_DELETE message,
-  //     as it could potentially trigger the OwnerRRef been deleted before the
-  //     owner learns about the forked child.
-  std::unordered_map<ForkId, c10::intrusive_ptr<RRef>, ForkId::Hash>
-      pendingChildren_;
+  std::mutex forkRequestsMutex_;
+  std::unordered_map<worker_id_t, ForkRequestQueue> forkRequests_;
 
   // The RRef context performs its operations through async RPC requests, in
   // order to not block the user code. Therefore the RRef context's state may be
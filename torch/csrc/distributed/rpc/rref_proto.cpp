@@ -189,6 +189,38 @@ std::unique_ptr<RRefForkRequest> RRefForkRequest::fromMessage(
   return std::make_unique<RRefForkRequest>(pair.first, pair.second);
 }
 
+const std::vector<std::pair<RRefId, ForkId>>& RRefForkBatchRequest::forks()
+    const {
+  return forks_;
+}
+
+Message RRefForkBatchRequest::toMessageImpl() && {
+  std::vector<at::IValue> ivalues;
+  ivalues.reserve(2 * forks_.size());
+  for (const auto& fork : forks_) {
+    ivalues.emplace_back(fork.first.toIValue());
+    ivalues.emplace_back(fork.second.toIValue());
+  }
+  return fromIValues(std::move(ivalues), MessageType::RREF_FORK_BATCH_REQUEST);
+}
+
+std::unique_ptr<RRefForkBatchRequest> RRefForkBatchRequest::fromMessage(
+    const Message& message) {
+  auto values = toIValues(message, MessageType::RREF_FORK_BATCH_REQUEST);
+  TORCH_INTERNAL_ASSERT(
+      values.size() % 2 == 0,
+      "RRefForkBatchRequest expects an even number of IValues from message, ",
+      "got ",
+      values.size());
+  std::vector<std::pair<RRefId, ForkId>> forks;
+  forks.reserve(values.size() / 2);
+  for (size_t i = 0; i < values.size(); i += 2) {
+    forks.emplace_back(
+        RRefId::fromIValue(values[i]), ForkId::fromIValue(values[i + 1]));
+  }
+  return std::make_unique<RRefForkBatchRequest>(std::move(forks));
+}
+
 Message RRefAck::toMessageImpl() && {
   return Message({}, {}, MessageType::RREF_ACK);
 }
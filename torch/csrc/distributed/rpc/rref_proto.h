@@ -155,6 +155,23 @@ class TORCH_API RRefForkRequest final : public ForkMessageBase {
   static std::unique_ptr<RRefForkRequest> fromMessage(const Message& message);
 };
 
+// A worker uses this message to send the fork requests of several child RRefs
+// owned by the same worker at once.
+class TORCH_API RRefForkBatchRequest final : public RpcCommandBase {
+ public:
+  explicit RRefForkBatchRequest(std::vector<std::pair<RRefId, ForkId>> forks)
+      : forks_(std::move(forks)) {}
+
+  const std::vector<std::pair<RRefId, ForkId>>& forks() const;
+
+  Message toMessageImpl() && override;
+  static std::unique_ptr<RRefForkBatchRequest> fromMessage(
+      const Message& message);
+
+ private:
+  const std::vector<std::pair<RRefId, ForkId>> forks_;
+};
+
 class TORCH_API RRefAck final : public RpcCommandBase {
  public:
   RRefAck() {}
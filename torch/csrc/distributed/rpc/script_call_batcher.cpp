@@ -0,0 +1,316 @@
+#include <torch/csrc/distributed/rpc/script_call_batcher.h>
+
+#include <ATen/Parallel.h>
+#include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/distributed/autograd/context/container.h>
+#include <torch/csrc/distributed/rpc/python_rpc_handler.h>
+#include <torch/csrc/distributed/rpc/script_resp.h>
+
+namespace torch {
+namespace distributed {
+namespace rpc {
+
+namespace {
+
+using steady_clock_time_point =
+    std::chrono::time_point<std::chrono::steady_clock>;
+
+std::shared_ptr<c10::ivalue::Future> runFunction(
+    const c10::QualifiedName& qualifiedName,
+    std::vector<at::IValue>& stack) {
+  return PythonRpcHandler::getInstance()
+      .jitCompilationUnit()
+      ->get_function(qualifiedName)
+      .runAsync(stack);
+}
+
+void markCompleted(
+    at::IValue value,
+    int64_t messageId,
+    const std::shared_ptr<FutureMessage>& responseFuture) {
+  try {
+    Message m = ScriptResp(std::move(value)).toMessage();
+    m.setId(messageId);
+    responseFuture->markCompleted(std::move(m));
+  } catch (const std::exception& e) {
+    responseFuture->setError(e.what());
+  }
+}
+
+// Splits the result of a batched run along dim 0, into one result per call
+// with numRows[i] rows.
+std::vector<at::IValue> splitResult(
+    const at::IValue& result,
+    const std::vector<int64_t>& numRows) {
+  int64_t totalRows = 0;
+  for (auto rows : numRows) {
+    totalRows += rows;
+  }
+  auto splitTensor = [&](const at::Tensor& tensor) {
+    TORCH_CHECK(
+        tensor.dim() >= 1 && tensor.size(0) == totalRows,
+        "Expected the results of a batched function to have ",
+        totalRows,
+        " rows, got a tensor of size ",
+        tensor.sizes());
+    return tensor.split_with_sizes(numRows);
+  };
+
+  std::vector<at::IValue> results;
+  results.reserve(numRows.size());
+  if (result.isTensor()) {
+    for (auto& part : splitTensor(result.toTensor())) {
+      results.emplace_back(std::move(part));
+    }
+  } else if (result.isTuple()) {
+    const auto& elements = result.toTuple()->elements();
+    std::vector<std::vector<at::IValue>> parts(numRows.size());
+    for (const auto& element : elements) {
+      TORCH_CHECK(
+          element.isTensor(),
+          "A batched function must return a Tensor or a tuple of Tensors, got ",
+          "a tuple holding a ",
+          element.tagKind());
+      auto elementParts = splitTensor(element.toTensor());
+      for (size_t i = 0; i < numRows.size(); ++i) {
+        parts[i].emplace_back(std::move(elementParts[i]));
+      }
+    }
+    for (auto& part : parts) {
+      results.emplace_back(c10::ivalue::Tuple::create(std::move(part)));
+    }
+  } else {
+    TORCH_CHECK(
+        false,
+        "A batched function must return a Tensor or a tuple of Tensors, got ",
+        result.tagKind());
+  }
+  return results;
+}
+
+} // namespace
+
+ScriptCallBatcher& ScriptCallBatcher::getInstance() {
+  static ScriptCallBatcher batcher;
+  return batcher;
+}
+
+ScriptCallBatcher::ScriptCallBatcher() = default;
+
+ScriptCallBatcher::~ScriptCallBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (flushThread_.joinable()) {
+    flushThread_.join();
+  }
+}
+
+void ScriptCallBatcher::enableBatching(
+    const c10::QualifiedName& qualifiedName,
+    int64_t maxBatchSize,
+    std::chrono::milliseconds maxDelay) {
+  TORCH_CHECK(
+      maxBatchSize > 0, "max_batch_size must be positive, got ", maxBatchSize);
+  TORCH_CHECK(
+      maxDelay.count() >= 0,
+      "max_delay must not be negative, got ",
+      maxDelay.count(),
+      " ms");
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& queue = queues_[qualifiedName.qualifiedName()];
+  queue.maxBatchSize = maxBatchSize;
+  queue.maxDelay = maxDelay;
+  queue.enabled = true;
+  if (!flushThread_.joinable()) {
+    flushThread_ = std::thread(&ScriptCallBatcher::flushLoop, this);
+  }
+}
+
+void ScriptCallBatcher::disableBatching(
+    const c10::QualifiedName& qualifiedName) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = queues_.find(qualifiedName.qualifiedName());
+  if (it != queues_.end()) {
+    it->second.enabled = false;
+  }
+}
+
+bool ScriptCallBatcher::tryEnqueue(
+    ScriptCall& scriptCall,
+    int64_t messageId,
+    const std::shared_ptr<FutureMessage>& responseFuture) {
+  if (!scriptCall.hasQualifiedName() || scriptCall.isAsyncExecution()) {
+    return false;
+  }
+  // The batch runs in another thread, which doesn't have the thread-local
+  // autograd context or profiler state of this one.
+  if (autograd::DistAutogradContainer::getInstance().hasValidContext() ||
+      torch::autograd::profiler::profilerEnabled()) {
+    return false;
+  }
+  auto& stack = scriptCall.stackRef();
+  if (stack.empty()) {
+    return false;
+  }
+  for (const auto& arg : stack) {
+    if (!arg.isTensor() || arg.toTensor().dim() == 0 ||
+        arg.toTensor().size(0) != stack[0].toTensor().size(0)) {
+      return false;
+    }
+  }
+
+  const auto qualifiedName = scriptCall.qualifiedName();
+  std::vector<PendingCall> batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = queues_.find(qualifiedName.qualifiedName());
+    if (it == queues_.end() || !it->second.enabled) {
+      return false;
+    }
+    auto& queue = it->second;
+    if (queue.calls.empty()) {
+      queue.deadline = std::chrono::steady_clock::now() + queue.maxDelay;
+      cv_.notify_one();
+    }
+    const auto numRows = stack[0].toTensor().size(0);
+    queue.calls.push_back(
+        PendingCall{std::move(stack), numRows, messageId, responseFuture});
+    queue.numRows += numRows;
+    if (queue.numRows >= queue.maxBatchSize) {
+      std::swap(batch, queue.calls);
+      queue.numRows = 0;
+    }
+  }
+
+  if (!batch.empty()) {
+    runBatch(qualifiedName, std::move(batch));
+  }
+  return true;
+}
+
+void ScriptCallBatcher::runSingle(
+    const c10::QualifiedName& qualifiedName,
+    PendingCall call) {
+  try {
+    auto jitFuture = runFunction(qualifiedName, call.stack);
+    jitFuture->addCallback([call, jitFuture]() {
+      try {
+        markCompleted(jitFuture->value(), call.messageId, call.responseFuture);
+      } catch (const std::exception& e) {
+        call.responseFuture->setError(e.what());
+      }
+    });
+  } catch (const std::exception& e) {
+    call.responseFuture->setError(e.what());
+  }
+}
+
+void ScriptCallBatcher::runBatch(
+    const c10::QualifiedName& qualifiedName,
+    std::vector<PendingCall> calls) {
+  if (calls.size() == 1) {
+    runSingle(qualifiedName, std::move(calls[0]));
+    return;
+  }
+
+  auto runSeparately = [qualifiedName](std::vector<PendingCall>& calls) {
+    for (auto& call : calls) {
+      runSingle(qualifiedName, std::move(call));
+    }
+  };
+
+  std::shared_ptr<c10::ivalue::Future> jitFuture;
+  try {
+    std::vector<at::IValue> stack;
+    const auto numArgs = calls[0].stack.size();
+    for (size_t i = 0; i < numArgs; ++i) {
+      std::vector<at::Tensor> tensors;
+      tensors.reserve(calls.size());
+      for (const auto& call : calls) {
+        TORCH_CHECK(
+            call.stack.size() == numArgs,
+            "Expected ",
+            numArgs,
+            " arguments, got ",
+            call.stack.size());
+        tensors.push_back(call.stack[i].toTensor());
+      }
+      stack.emplace_back(at::cat(tensors));
+    }
+    jitFuture = runFunction(qualifiedName, stack);
+  } catch (const std::exception&) {
+    runSeparately(calls);
+    return;
+  }
+
+  jitFuture->addCallback([calls, jitFuture, runSeparately]() mutable {
+    std::vector<at::IValue> results;
+    try {
+      std::vector<int64_t> numRows;
+      numRows.reserve(calls.size());
+      for (const auto& call : calls) {
+        numRows.push_back(call.numRows);
+      }
+      results = splitResult(jitFuture->value(), numRows);
+    } catch (const std::exception&) {
+      runSeparately(calls);
+      return;
+    }
+    for (size_t i = 0; i < calls.size(); ++i) {
+      markCompleted(
+          std::move(results[i]), calls[i].messageId, calls[i].responseFuture);
+    }
+  });
+}
+
+void ScriptCallBatcher::flushLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    const auto now = std::chrono::steady_clock::now();
+    auto nextDeadline = steady_clock_time_point::max();
+    std::vector<std::pair<c10::QualifiedName, std::vector<PendingCall>>> ready;
+    for (auto it = queues_.begin(); it != queues_.end();) {
+      auto& queue = it->second;
+      if (queue.calls.empty()) {
+        it = queue.enabled ? std::next(it) : queues_.erase(it);
+        continue;
+      }
+      if (queue.deadline <= now) {
+        ready.emplace_back(
+            c10::QualifiedName(it->first), std::vector<PendingCall>());
+        std::swap(ready.back().second, queue.calls);
+        queue.numRows = 0;
+      } else {
+        nextDeadline = std::min(nextDeadline, queue.deadline);
+      }
+      ++it;
+    }
+
+    if (!ready.empty()) {
+      lock.unlock();
+      // Run the batches on the inter-op thread pool, so that a slow batch
+      // doesn't hold back the deadlines of the others.
+      for (auto& entry : ready) {
+        at::launch([qualifiedName = std::move(entry.first),
+                    calls = std::move(entry.second)]() mutable {
+          runBatch(qualifiedName, std::move(calls));
+        });
+      }
+      lock.lock();
+      continue;
+    }
+
+    if (nextDeadline == steady_clock_time_point::max()) {
+      cv_.wait(lock);
+    } else {
+      cv_.wait_until(lock, nextDeadline);
+    }
+  }
+}
+
+} // namespace rpc
+} // namespace distributed
+} // namespace torch
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <torch/csrc/distributed/rpc/message.h>
+#include <torch/csrc/distributed/rpc/script_call.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace torch {
+namespace distributed {
+namespace rpc {
+
+// ScriptCallBatcher runs the ScriptCalls received for the same TorchScript
+// function together, as a single call on the concatenation of their arguments.
+// This is meant for functions running inference on many small requests, for
+// which a single run of a large batch makes much better use of the device.
+//
+// Batching is enabled per function, by its qualified name. Such a function
+// must only take Tensor arguments, batched along dim 0, and return a Tensor
+// or a tuple of Tensors batched along dim 0 as well. A call is queued until
+// the calls queued for its function hold maxBatchSize rows (the sizes of dim 0
+// of their first arguments), or maxDelay has passed since the first of them
+// was queued. Then the arguments are concatenated along dim 0, the function
+// is run once, and its results are split back along dim 0 into the responses
+// of the calls. If the batched run fails, e.g. because the calls have
+// arguments of incompatible shapes, each call is run on its own, so that it
+// gets its own error.
+//
+// Calls which can't be batched (with non-Tensor arguments, or run within a
+// distributed autograd context or with the profiler enabled) are not queued,
+// and are run as usual by the RequestCallback.
+class TORCH_API ScriptCallBatcher {
+ public:
+  static ScriptCallBatcher& getInstance();
+
+  ScriptCallBatcher(const ScriptCallBatcher&) = delete;
+  ScriptCallBatcher& operator=(const ScriptCallBatcher&) = delete;
+
+  ~ScriptCallBatcher();
+
+  void enableBatching(
+      const c10::QualifiedName& qualifiedName,
+      int64_t maxBatchSize,
+      std::chrono::milliseconds maxDelay);
+
+  // Calls already queued for the function are still run in a batch.
+  void disableBatching(const c10::QualifiedName& qualifiedName);
+
+  // Queues `scriptCall` if batching is enabled for its function and it can be
+  // batched, and returns whether it did. `responseFuture` is completed with
+  // the response, with an ID of `messageId`, once the batch has run.
+  bool tryEnqueue(
+      ScriptCall& scriptCall,
+      int64_t messageId,
+      const std::shared_ptr<FutureMessage>& responseFuture);
+
+ private:
+  ScriptCallBatcher();
+
+  struct PendingCall {
+    std::vector<at::IValue> stack;
+    int64_t numRows;
+    int64_t messageId;
+    std::shared_ptr<FutureMessage> responseFuture;
+  };
+
+  struct Queue {
+    int64_t maxBatchSize;
+    std::chrono::milliseconds maxDelay;
+    bool enabled{true};
+    std::vector<PendingCall> calls;
+    int64_t numRows{0};
+    // When the first of the calls was queued plus maxDelay.
+    std::chrono::time_point<std::chrono::steady_clock> deadline;
+  };
+
+  // Runs `calls` as a single call of `qualifiedName`, and completes their
+  // response futures.
+  static void runBatch(
+      const c10::QualifiedName& qualifiedName,
+      std::vector<PendingCall> calls);
+
+  static void runSingle(
+      const c10::QualifiedName& qualifiedName,
+      PendingCall call);
+
+  // Runs the batches whose deadlines have passed.
+  void flushLoop();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unordered_map<std::string, Queue> queues_;
+  bool stop_{false};
+  std::thread flushThread_;
+};
+
+} // namespace rpc
+} // namespace distributed
+} // namespace torch
@@ -185,13 +185,15 @@ TensorPipeAgent::TensorPipeAgent(
     worker_id_t selfId,
     int worldSize,
     std::shared_ptr<c10d::ProcessGroup> processGroup,
-    TensorPipeRpcBackendOptions opts)
+    TensorPipeRpcBackendOptions opts,
+    std::unordered_map<std::string, DeviceMap> reverseDeviceMaps)
     : RpcAgent(
           WorkerInfo(std::move(selfName), selfId),
           std::make_unique<RequestCallbackImpl>(),
           std::chrono::milliseconds(
               (long)(opts.rpcTimeoutSeconds * kToMilliseconds))),
       opts_(std::move(opts)),
+      reverseDeviceMaps_(std::move(reverseDeviceMaps)),
       threadPool_(opts_.numWorkerThreads),
       context_(std::make_shared<tensorpipe::Context>(
           tensorpipe::ContextOptions().name(workerInfo_.name_))),
@@ -360,10 +362,12 @@ void TensorPipeAgent::pipeRead(
 void TensorPipeAgent::pipeWrite(
     const std::shared_ptr<tensorpipe::Pipe>& pipe,
     Message&& rpcMessage,
+    std::vector<c10::DeviceIndex>&& devices,
     std::function<void(const tensorpipe::Error&)> fn) {
   tensorpipe::Message tpMessage;
   TensorpipeWriteBuffers tpBuffers;
-  std::tie(tpMessage, tpBuffers) = tensorpipeSerialize(std::move(rpcMessage));
+  std::tie(tpMessage, tpBuffers) =
+      tensorpipeSerialize(std::move(rpcMessage), std::move(devices));
   pipe->write(
       std::move(tpMessage),
       [tpBuffers{
@@ -374,6 +378,43 @@ void TensorPipeAgent::pipeWrite(
       });
 }
 
+std::vector<c10::DeviceIndex> TensorPipeAgent::getDevicesForTensors(
+    const std::string& remoteName,
+    const Message& message,
+    const std::unordered_map<std::string, DeviceMap>& deviceMaps) {
+  const auto deviceMapIter = deviceMaps.find(remoteName);
+  std::vector<c10::DeviceIndex> devices;
+  bool hasCudaTensor = false;
+  devices.reserve(message.tensors().size());
+  for (const auto& tensor : message.tensors()) {
+    if (tensor.device().is_cpu()) {
+      devices.push_back(-1);
+      continue;
+    }
+    TORCH_CHECK(
+        tensor.is_cuda() && deviceMapIter != deviceMaps.end(),
+        "TensorPipe RPC backend only supports CPU tensors by default, please ",
+        "move your tensors to CPU before sending them over RPC, or call ",
+        "`set_device_map` on `TensorPipeRpcBackendOptions` to explicitly ",
+        "configure device mapping. Found tensor on device: ",
+        tensor.device());
+    const auto& deviceMap = deviceMapIter->second;
+    const auto deviceIter = deviceMap.find(tensor.device().index());
+    TORCH_CHECK(
+        deviceIter != deviceMap.end(),
+        "Request device mapping is not available for destination ",
+        remoteName,
+        ". Found tensor on device: ",
+        tensor.device());
+    devices.push_back(deviceIter->second);
+    hasCudaTensor = true;
+  }
+  if (!hasCudaTensor) {
+    devices.clear();
+  }
+  return devices;
+}
+
 void TensorPipeAgent::sendCompletedResponseMessage(
     std::shared_ptr<tensorpipe::Pipe>& pipe,
     std::shared_ptr<FutureMessage>& futureResponseMessage,
@@ -394,22 +435,18 @@ void TensorPipeAgent::sendCompletedResponseMessage(
   Message&& responseMessage = std::move(*futureResponseMessage).moveValue();
   responseMessage.setId(messageId);
   if (!error) {
-    for (const auto& tensor : responseMessage.tensors()) {
-      if (!tensor.device().is_cpu()) {
-        responseMessage = createExceptionResponse(
-            c10::str(
-                "TensorPipe RPC backend only supports CPU tensors, please ",
-                "move your tensors to CPU before sending them over RPC. Found ",
-                "tensor on device: ",
-                tensor.device()),
-            responseMessage.id());
-        break;
-      }
+    std::vector<c10::DeviceIndex> devices;
+    try {
+      devices = getDevicesForTensors(
+          pipe->getRemoteName(), responseMessage, reverseDeviceMaps_);
+    } catch (const std::exception& e) {
+      responseMessage = createExceptionResponse(e.what(), responseMessage.id());
     }
 
     pipeWrite(
         pipe,
         std::move(responseMessage),
+        std::move(devices),
         [this, pipe, messageId](const tensorpipe::Error& error) {
           if (error) {
             LOG(WARNING)
@@ -428,6 +465,7 @@ void TensorPipeAgent::sendCompletedResponseMessage(
     pipeWrite(
         pipe,
         createExceptionResponse(error->what(), responseMessage.id()),
+        {},
         [this, pipe, messageId](const tensorpipe::Error& error) {
           if (error) {
             LOG(WARNING)
@@ -537,13 +575,8 @@ std::shared_ptr<FutureMessage> TensorPipeAgent::send(
     throw std::runtime_error(err);
   }
 
-  for (const auto& tensor : requestMessage.tensors()) {
-    TORCH_CHECK(
-        tensor.device().is_cpu(),
-        "TensorPipe RPC backend only supports CPU tensors, please move your ",
-        "tensors to CPU before sending them over RPC. Found tensor on device: ",
-        tensor.device());
-  }
+  auto devices = getDevicesForTensors(
+      toWorkerInfo.name_, requestMessage, opts_.deviceMaps);
 
   const auto& url = findWorkerURL(toWorkerInfo);
 
@@ -603,6 +636,7 @@ std::shared_ptr<FutureMessage> TensorPipeAgent::send(
   pipeWrite(
       clientPipe.pipe_,
       std::move(requestMessage),
+      std::move(devices),
       [this, &clientPipe, messageId](const tensorpipe::Error& error) mutable {
         if (error) {
           if (error.isOfType<tensorpipe::PipeClosedError>() &&
@@ -35,13 +35,18 @@ C10_DECLARE_REGISTRY(TensorPipeChannelRegistry, ChannelRegistration);
 
 constexpr auto kDefaultNumWorkerThreads = 16;
 
+// Maps the index of a local CUDA device to the index of the CUDA device of a
+// peer which tensors on it are placed on when sent to that peer.
+using DeviceMap = std::unordered_map<c10::DeviceIndex, c10::DeviceIndex>;
+
 struct TensorPipeRpcBackendOptions : public RpcBackendOptions {
   TensorPipeRpcBackendOptions(
       int numWorkerThreads,
       optional<std::vector<std::string>> transports,
       optional<std::vector<std::string>> channels,
       float rpc_timeout,
-      std::string init_method)
+      std::string init_method,
+      std::unordered_map<std::string, DeviceMap> device_maps = {})
       : RpcBackendOptions(rpc_timeout, init_method),
         numWorkerThreads(numWorkerThreads),
         transports(std::move(transports)),
@@ -68,11 +73,34 @@ struct TensorPipeRpcBackendOptions : public RpcBackendOptions {
             channelName);
       }
     }
+
+    for (const auto& entry : device_maps) {
+      setDeviceMap(entry.first, entry.second);
+    }
+  }
+
+  // Adds the entries of `deviceMap` to the device map used for `workerName`,
+  // replacing the ones for the same local devices.
+  void setDeviceMap(const std::string& workerName, const DeviceMap& deviceMap) {
+    auto& workerDeviceMap = deviceMaps[workerName];
+    for (const auto& entry : deviceMap) {
+      TORCH_CHECK(
+          entry.first >= 0 && entry.second >= 0,
+          "Device indices must be non-negative, got ",
+          entry.first,
+          " -> ",
+          entry.second,
+          " for worker ",
+          workerName);
+      workerDeviceMap[entry.first] = entry.second;
+    }
   }
 
   int numWorkerThreads;
   const optional<std::vector<std::string>> transports;
   const optional<std::vector<std::string>> channels;
+  // worker name -> device map for tensors sent to that worker.
+  std::unordered_map<std::string, DeviceMap> deviceMaps;
 };
 
 // Struct to track the network source metrics
@@ -92,7 +120,13 @@ struct AggregatedNetworkData {
 // TensorPipeAgent leverages TensorPipe (https://github.com/pytorch/tensorpipe)
 // to transparently move tensors and payloads through the fastest available
 // transport or channel. It acts like a hybrid RPC transport, providing shared
-// memory (linux) and TCP (linux & mac) support. CUDA support is in progress.
+// memory (linux) and TCP (linux & mac) support.
+//
+// CUDA tensors can be sent to the workers which have a device map set in the
+// options. They are placed on the device of the peer given by the map, and the
+// tensors of the responses of the peer are placed back on the local device
+// mapped to theirs (`reverseDeviceMaps`). TensorPipe doesn't provide CUDA
+// channels yet, so their data is copied through CPU memory on both ends.
 class TensorPipeAgent : public RpcAgent {
  public:
   TensorPipeAgent(
@@ -101,7 +135,8 @@ class TensorPipeAgent : public RpcAgent {
       worker_id_t selfId,
       int worldSize,
       std::shared_ptr<c10d::ProcessGroup> processGroup,
-      TensorPipeRpcBackendOptions opts);
+      TensorPipeRpcBackendOptions opts,
+      std::unordered_map<std::string, DeviceMap> reverseDeviceMaps = {});
 
   TensorPipeAgent(const TensorPipeAgent&) = delete;
   TensorPipeAgent& operator=(const TensorPipeAgent&) = delete;
@@ -156,12 +191,22 @@ class TensorPipeAgent : public RpcAgent {
       std::function<void(const tensorpipe::Error&, Message&&)>);
 
   // TensorPipe write function that could be used to write response
-  // messages by server, and write request messages by client.
+  // messages by server, and write request messages by client. `devices` are
+  // the devices the receiver places the tensors of the message on.
   void pipeWrite(
       const std::shared_ptr<tensorpipe::Pipe>&,
       Message&& message,
+      std::vector<c10::DeviceIndex>&& devices,
       std::function<void(const tensorpipe::Error&)>);
 
+  // Returns the devices the tensors of `message` will be placed on by
+  // `remoteName`, according to `deviceMaps`. Throws if a tensor is on a CUDA
+  // device that isn't mapped to one of the peer.
+  static std::vector<c10::DeviceIndex> getDevicesForTensors(
+      const std::string& remoteName,
+      const Message& message,
+      const std::unordered_map<std::string, DeviceMap>& deviceMaps);
+
   // Callback of listener accept()
   void onListenerAccepted(
       const tensorpipe::Error& error,
@@ -212,6 +257,9 @@ class TensorPipeAgent : public RpcAgent {
   };
 
   const TensorPipeRpcBackendOptions opts_;
+  // worker name -> device map for the tensors of the responses sent to that
+  // worker, which is the inverse of the device map that worker uses for us.
+  const std::unordered_map<std::string, DeviceMap> reverseDeviceMaps_;
 
   ThreadPool threadPool_;
   std::shared_ptr<tensorpipe::Context> context_;
@@ -128,6 +128,7 @@ MessageType FaultyProcessGroupAgent::messageStringToType(
   // Lazily constructed map that returns string to message type mapping
   static std::unordered_map<std::string, MessageType> msgMap = {
       {"RREF_FORK_REQUEST", MessageType::RREF_FORK_REQUEST},
+      {"RREF_FORK_BATCH_REQUEST", MessageType::RREF_FORK_BATCH_REQUEST},
       {"RREF_CHILD_ACCEPT", MessageType::RREF_CHILD_ACCEPT},
       {"RREF_USER_DELETE", MessageType::RREF_USER_DELETE},
       {"CLEANUP_AUTOGRAD_CONTEXT_REQ",
@@ -1,5 +1,6 @@
 #include <torch/csrc/distributed/rpc/utils.h>
 
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/distributed/autograd/rpc_messages/cleanup_autograd_context_req.h>
 #include <torch/csrc/distributed/autograd/rpc_messages/cleanup_autograd_context_resp.h>
@@ -21,6 +22,14 @@
 
 #include <fmt/format.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
@@ -93,6 +102,9 @@ std::unique_ptr<RpcCommandBase> deserializeRequest(const Message& request) {
     case MessageType::RREF_FORK_REQUEST: {
       return RRefForkRequest::fromMessage(request);
     }
+    case MessageType::RREF_FORK_BATCH_REQUEST: {
+      return RRefForkBatchRequest::fromMessage(request);
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       return autograd::RpcWithAutograd::fromMessage(request);
     }
@@ -282,6 +294,7 @@ parseWireSections(const void* data, size_t data_size) {
 
 static const char* kMeta = "meta";
 static const char* kPayload = "payload";
+static const char* kTensorSizes = "tensor_sizes";
 }; // namespace
 
 c10::List<at::Tensor> cloneSparseTensors(
@@ -308,9 +321,15 @@ c10::List<at::Tensor> cloneSparseTensors(
   return pTensors;
 }
 
-std::string wireSerialize(
-    const std::vector<char>& payload,
-    const std::vector<at::Tensor>& tensors) {
+namespace {
+
+struct WireEntry {
+  std::string name;
+  const char* data;
+  size_t size;
+};
+
+void checkCPUTensors(const std::vector<at::Tensor>& tensors) {
   for (const auto& tensor : tensors) {
     TORCH_CHECK(
         tensor.device().is_cpu(),
@@ -319,13 +338,91 @@ std::string wireSerialize(
         "them over RPC. Found tensor on device: ",
         tensor.device());
   }
+}
+
+// Pickles `tensors` into `metaEntry`, and returns the tensors whose storages
+// hold their data, in the order of the records of the pickle.
+std::vector<at::Tensor> pickleTensors(
+    const std::vector<at::Tensor>& tensors,
+    std::string& metaEntry) {
+  torch::jit::Pickler pickler([&](const void* buf, size_t sz) -> size_t {
+    metaEntry.append(static_cast<const char*>(buf), sz);
+    return sz;
+  });
+  pickler.protocol();
+  pickler.pushIValue(cloneSparseTensors(tensors));
+  pickler.stop();
+  return pickler.tensorData();
+}
+
+std::string joinWireEntries(const std::vector<WireEntry>& entries) {
+  std::string header;
+  size_t tot = 0;
+  for (const auto& e : entries) {
+    tot += e.size;
+    header.append(e.name)
+        .append(" ")
+        .append(c10::to_string(e.size))
+        .append("\n");
+  }
+  header.push_back('\n');
+
+  std::string out;
+  out.reserve(header.size() + tot);
+  out.append(header);
+  for (const auto& e : entries) {
+    out.append(e.data, e.size);
+  }
+  return out;
+}
+
+std::vector<char> readWirePayload(
+    const std::unordered_map<std::string, std::pair<const char*, size_t>>&
+        sections) {
+  std::vector<char> payload;
+  auto payloadIt = sections.find(kPayload);
+  if (payloadIt != sections.end() && payloadIt->second.second != 0) {
+    payload.assign(
+        payloadIt->second.first,
+        payloadIt->second.first + payloadIt->second.second);
+  }
+  return payload;
+}
 
-  struct Ent {
-    std::string name;
-    const char* data;
-    size_t size;
+std::vector<at::Tensor> unpickleWireTensors(
+    const std::pair<const char*, size_t>& metaData,
+    const std::function<at::DataPtr(const std::string&)>& sectionReadFunc) {
+  size_t metaDataPos = 0;
+  auto metaDataReadFunc = [&](char* buf, size_t n) -> size_t {
+    if (metaDataPos >= metaData.second || n == 0) {
+      return 0;
+    }
+    size_t toCopy = std::min(metaDataPos + n, metaData.second) - metaDataPos;
+    memcpy(buf, metaData.first + metaDataPos, toCopy);
+    metaDataPos += toCopy;
+    return toCopy;
   };
-  std::vector<Ent> entries;
+
+  // No need to pass typeResolver here, as it always processes string and
+  // tensors only
+  torch::jit::Unpickler unpickler(
+      metaDataReadFunc, nullptr, nullptr, sectionReadFunc, {});
+  auto ival = unpickler.parse_ivalue();
+  std::vector<at::Tensor> tensors;
+  for (auto&& t : ival.toTensorList()) {
+    tensors.emplace_back(std::move(t));
+  }
+  return tensors;
+}
+
+} // namespace
+
+std::string wireSerialize(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  checkCPUTensors(tensors);
+
+  std::vector<WireEntry> entries;
   std::string metaEntry;
   std::vector<at::Tensor> tensorData;
 
@@ -334,14 +431,7 @@ std::string wireSerialize(
   }
 
   if (!tensors.empty()) {
-    torch::jit::Pickler pickler([&](const void* buf, size_t sz) -> size_t {
-      metaEntry.append(static_cast<const char*>(buf), sz);
-      return sz;
-    });
-    pickler.protocol();
-    pickler.pushIValue(cloneSparseTensors(tensors));
-    pickler.stop();
-    tensorData = pickler.tensorData();
+    tensorData = pickleTensors(tensors, metaEntry);
     entries.push_back({kMeta, metaEntry.data(), metaEntry.size()});
     for (size_t i = 0; i < tensorData.size(); i++) {
       // Construct WritableTensorData for each tensor in the pickler tensorData
@@ -358,24 +448,7 @@ std::string wireSerialize(
     }
   }
 
-  std::string header;
-  size_t tot = 0;
-  for (const auto& e : entries) {
-    tot += e.size;
-    header.append(e.name)
-        .append(" ")
-        .append(c10::to_string(e.size))
-        .append("\n");
-  }
-  header.push_back('\n');
-
-  std::string out;
-  out.reserve(header.size() + tot);
-  out.append(header);
-  for (const auto& e : entries) {
-    out.append(e.data, e.size);
-  }
-  return out;
+  return joinWireEntries(entries);
 }
 
 std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
@@ -383,28 +456,11 @@ std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     size_t data_size) {
   auto sections = parseWireSections(data, data_size);
 
-  std::vector<char> payload;
-  auto payloadIt = sections.find(kPayload);
-  if (payloadIt != sections.end() && payloadIt->second.second != 0) {
-    payload.assign(
-        payloadIt->second.first,
-        payloadIt->second.first + payloadIt->second.second);
-  }
+  std::vector<char> payload = readWirePayload(sections);
 
   std::vector<at::Tensor> tensors;
   auto metaIt = sections.find(kMeta);
   if (metaIt != sections.end()) {
-    const auto& metaData = metaIt->second;
-    size_t metaDataPos = 0;
-    auto metaDataReadFunc = [&](char* buf, size_t n) -> size_t {
-      if (metaDataPos >= metaData.second || n == 0) {
-        return 0;
-      }
-      size_t toCopy = std::min(metaDataPos + n, metaData.second) - metaDataPos;
-      memcpy(buf, metaData.first + metaDataPos, toCopy);
-      metaDataPos += toCopy;
-      return toCopy;
-    };
     auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
       auto it = sections.find(ename);
       if (it == sections.end()) {
@@ -417,19 +473,197 @@ std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
       }
       return dptr;
     };
+    tensors = unpickleWireTensors(metaIt->second, sectionReadFunc);
+  }
+  return {std::move(payload), std::move(tensors)};
+}
+
+std::pair<std::string, std::vector<at::Tensor>> wireSerializeMetadata(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  checkCPUTensors(tensors);
+
+  std::vector<WireEntry> entries;
+  std::string metaEntry;
+  std::vector<int64_t> tensorSizes;
+  std::vector<at::Tensor> tensorData;
+
+  if (!payload.empty()) {
+    entries.push_back({kPayload, payload.data(), payload.size()});
+  }
 
-    // No need to pass typeResolver here, as it always processes string and
-    // tensors only
-    torch::jit::Unpickler unpickler(
-        metaDataReadFunc, nullptr, nullptr, sectionReadFunc, {});
-    auto ival = unpickler.parse_ivalue();
-    for (auto&& t : ival.toTensorList()) {
-      tensors.emplace_back(std::move(t));
+  if (!tensors.empty()) {
+    for (const auto& tensor : pickleTensors(tensors, metaEntry)) {
+      auto writeableTensorData = jit::getWriteableTensorData(tensor);
+      auto storage = tensor.storage();
+      // A flat byte tensor viewing the whole storage, which keeps it alive.
+      auto data = at::from_blob(
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+          const_cast<char*>(writeableTensorData.data()),
+          {static_cast<int64_t>(writeableTensorData.sizeInBytes())},
+          [storage](void*) {},
+          at::TensorOptions(at::kChar));
+      // Enforce memory copy if tensor is created from torch::from_blob, means
+      // that the tensor doesn't own the memory.
+      if (!writeableTensorData.storageHasDeleter()) {
+        data = data.clone();
+      }
+      tensorData.push_back(std::move(data));
+      tensorSizes.push_back(writeableTensorData.sizeInBytes());
     }
+    entries.push_back({kMeta, metaEntry.data(), metaEntry.size()});
+    entries.push_back({kTensorSizes,
+                       reinterpret_cast<const char*>(tensorSizes.data()),
+                       tensorSizes.size() * sizeof(int64_t)});
+  }
+
+  return {joinWireEntries(entries), std::move(tensorData)};
+}
+
+std::vector<int64_t> wireTensorDataSizes(const void* data, size_t data_size) {
+  auto sections = parseWireSections(data, data_size);
+  std::vector<int64_t> tensorSizes;
+  auto sizesIt = sections.find(kTensorSizes);
+  if (sizesIt != sections.end()) {
+    const auto& sizesData = sizesIt->second;
+    TORCH_CHECK(
+        sizesData.second % sizeof(int64_t) == 0,
+        "Malformed tensor sizes section");
+    tensorSizes.resize(sizesData.second / sizeof(int64_t));
+    memcpy(tensorSizes.data(), sizesData.first, sizesData.second);
+  }
+  return tensorSizes;
+}
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserializeMetadata(
+    const void* data,
+    size_t data_size,
+    const std::vector<at::Tensor>& tensorData) {
+  auto sections = parseWireSections(data, data_size);
+
+  std::vector<char> payload = readWirePayload(sections);
+
+  std::vector<at::Tensor> tensors;
+  auto metaIt = sections.find(kMeta);
+  if (metaIt != sections.end()) {
+    auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
+      auto index = std::stoul(ename);
+      TORCH_CHECK(
+          index < tensorData.size(), "Couldn't find tensor data ", ename);
+      // Use the received buffer as the storage, keeping it alive through the
+      // context of the DataPtr.
+      auto holder = new at::Tensor(tensorData[index]);
+      return at::DataPtr(
+          holder->data_ptr(),
+          holder,
+          [](void* ctx) { delete static_cast<at::Tensor*>(ctx); },
+          at::kCPU);
+    };
+    tensors = unpickleWireTensors(metaIt->second, sectionReadFunc);
   }
   return {std::move(payload), std::move(tensors)};
 }
 
+#ifndef _WIN32
+
+namespace {
+
+// Alignment of the tensor data within a shared memory segment.
+constexpr int64_t kShmAlignment = 64;
+
+// Returns the offsets of the tensor data within a shared memory segment, and
+// the size of the segment as the last element.
+std::vector<int64_t> shmOffsets(const std::vector<int64_t>& sizes) {
+  std::vector<int64_t> offsets;
+  offsets.reserve(sizes.size() + 1);
+  int64_t offset = 0;
+  for (auto size : sizes) {
+    offsets.push_back(offset);
+    offset += (size + kShmAlignment - 1) / kShmAlignment * kShmAlignment;
+  }
+  offsets.push_back(offset);
+  return offsets;
+}
+
+} // namespace
+
+bool writeShmSegment(
+    const std::string& name,
+    const std::vector<at::Tensor>& tensorData) {
+  std::vector<int64_t> sizes;
+  for (const auto& t : tensorData) {
+    sizes.push_back(t.numel());
+  }
+  auto offsets = shmOffsets(sizes);
+  const auto total = offsets.back();
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    return false;
+  }
+  bool ok = ftruncate(fd, total) == 0;
+#ifdef __linux__
+  // Allocate the pages now, so that running out of shared memory fails here
+  // instead of raising SIGBUS in the copy below.
+  ok = ok && posix_fallocate(fd, 0, total) == 0;
+#endif
+  void* ptr = ok ? mmap(nullptr, total, PROT_WRITE, MAP_SHARED, fd, 0)
+                 : MAP_FAILED;
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return false;
+  }
+  for (size_t i = 0; i < tensorData.size(); ++i) {
+    memcpy(
+        static_cast<char*>(ptr) + offsets[i],
+        tensorData[i].data_ptr(),
+        sizes[i]);
+  }
+  munmap(ptr, total);
+  return true;
+}
+
+std::vector<at::Tensor> readShmSegment(
+    const std::string& name,
+    const std::vector<int64_t>& sizes) {
+  auto offsets = shmOffsets(sizes);
+  const auto total = offsets.back();
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  TORCH_CHECK(
+      fd != -1,
+      "Failed to open shared memory segment ",
+      name,
+      ": ",
+      strerror(errno));
+  shm_unlink(name.c_str());
+  // A private mapping, as the deserialized tensors may be written to.
+  void* ptr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  TORCH_CHECK(
+      ptr != MAP_FAILED,
+      "Failed to map shared memory segment ",
+      name,
+      ": ",
+      strerror(errno));
+  std::shared_ptr<void> mapping(
+      ptr, [total](void* p) { munmap(p, total); });
+
+  std::vector<at::Tensor> tensorData;
+  tensorData.reserve(sizes.size());
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    tensorData.push_back(at::from_blob(
+        static_cast<char*>(ptr) + offsets[i],
+        sizes[i],
+        [mapping](void*) {},
+        at::kChar));
+  }
+  return tensorData;
+}
+
+#endif
+
 namespace {
 
 // The TensorPipe agent splits the RPC message's information across multiple
@@ -442,14 +676,18 @@ constexpr int kTpMessageTypeIdx = 0;
 constexpr int kTpMessageIdIdx = 1;
 // Then comes the rpc::Message::payload();
 constexpr int kTpMessagePayloadIdx = 2;
-// Last comes the pickle of rpc::Message::tensors() (with the tensors themselves
+// Then comes the pickle of rpc::Message::tensors() (with the tensors themselves
 // stored as, well, tensors in the tensorpipe::Message).
 constexpr int kTpMessagePickleIdx = 3;
+// Last come the devices the tensors must be placed on by the receiver, which is
+// empty if they all stay on CPU.
+constexpr int kTpMessageDevicesIdx = 4;
 
 } // namespace
 
 std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
-    Message&& rpcMessage) {
+    Message&& rpcMessage,
+    std::vector<c10::DeviceIndex> devices) {
   tensorpipe::Message tpMessage;
   TensorpipeWriteBuffers buffers;
 
@@ -471,7 +709,21 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
       tensorpipe::Message::Payload{payloadPtr, buffers.payload.size()});
 
   // Tensors
-  buffers.tensors = cloneSparseTensors(rpcMessage.tensors()).vec();
+  TORCH_INTERNAL_ASSERT(
+      devices.empty() || devices.size() == rpcMessage.tensors().size(),
+      "Expected a device for each of the ",
+      rpcMessage.tensors().size(),
+      " tensors, got ",
+      devices.size());
+  // The TensorPipe channels in use only move CPU memory, so CUDA tensors are
+  // staged through CPU. This copy is ordered after the pending work on the
+  // current stream of the device of the tensor.
+  std::vector<torch::Tensor> cpuTensors;
+  cpuTensors.reserve(rpcMessage.tensors().size());
+  for (const auto& tensor : rpcMessage.tensors()) {
+    cpuTensors.push_back(tensor.is_cuda() ? tensor.cpu() : tensor);
+  }
+  buffers.tensors = cloneSparseTensors(cpuTensors).vec();
   torch::jit::Pickler pickler([&](const void* buf, size_t sz) -> size_t {
     buffers.pickle.insert(
         buffers.pickle.end(),
@@ -484,6 +736,10 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
   pickler.stop();
   tpMessage.payloads.push_back(tensorpipe::Message::Payload{
       buffers.pickle.data(), buffers.pickle.size()});
+  buffers.devices = std::move(devices);
+  tpMessage.payloads.push_back(tensorpipe::Message::Payload{
+      buffers.devices.data(),
+      buffers.devices.size() * sizeof(c10::DeviceIndex)});
   for (const auto& tensor : pickler.tensorData()) {
     const auto& tensorData = jit::getWriteableTensorData(tensor);
     // Enforce memory copy if tensor is created from torch::from_blob, means
@@ -511,8 +767,8 @@ TensorpipeReadBuffers tensorpipeAllocate(tensorpipe::Message& tpMessage) {
   TensorpipeReadBuffers buffers;
 
   TORCH_INTERNAL_ASSERT(
-      tpMessage.payloads.size() == 4,
-      "message expected to contain 4 payloads, whereas it contained ",
+      tpMessage.payloads.size() == 5,
+      "message expected to contain 5 payloads, whereas it contained ",
       tpMessage.payloads.size(),
       " payloads");
 
@@ -544,8 +800,31 @@ TensorpipeReadBuffers tensorpipeAllocate(tensorpipe::Message& tpMessage) {
   buffers.pickle.resize(tpMessage.payloads[kTpMessagePickleIdx].length);
   tpMessage.payloads[kTpMessagePickleIdx].data = buffers.pickle.data();
 
+  TORCH_INTERNAL_ASSERT(
+      tpMessage.payloads[kTpMessageDevicesIdx].length %
+              sizeof(c10::DeviceIndex) ==
+          0,
+      "last payload expected to contain a multiple of ",
+      sizeof(c10::DeviceIndex),
+      " bytes, whereas it contained ",
+      tpMessage.payloads[kTpMessageDevicesIdx].length,
+      " bytes");
+  buffers.devices.resize(
+      tpMessage.payloads[kTpMessageDevicesIdx].length /
+      sizeof(c10::DeviceIndex));
+  tpMessage.payloads[kTpMessageDevicesIdx].data = buffers.devices.data();
+
+  // The tensors are read straight into the buffers that become their
+  // storages. When some of them are copied to CUDA devices afterwards, which
+  // the sender tells through a non-empty devices payload, the buffers are
+  // pinned, so that these copies are asynchronous. The caching host allocator
+  // keeps the buffers alive until the copies are done.
+  at::Allocator* allocator =
+      tpMessage.payloads[kTpMessageDevicesIdx].length > 0
+      ? at::detail::getCUDAHooks().getPinnedMemoryAllocator()
+      : at::getCPUAllocator();
   for (auto& tensor : tpMessage.tensors) {
-    buffers.tensors.push_back(at::getCPUAllocator()->allocate(tensor.length));
+    buffers.tensors.push_back(allocator->allocate(tensor.length));
     tensor.data = buffers.tensors.back().get();
   }
 
@@ -583,6 +862,22 @@ Message tensorpipeDeserialize(
     tensors.emplace_back(std::move(t));
   }
 
+  if (!buffers.devices.empty()) {
+    TORCH_INTERNAL_ASSERT(
+        buffers.devices.size() == tensors.size(),
+        "Expected a device for each of the ",
+        tensors.size(),
+        " tensors, got ",
+        buffers.devices.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      if (buffers.devices[i] >= 0) {
+        tensors[i] = tensors[i].to(
+            at::Device(at::kCUDA, buffers.devices[i]),
+            /*non_blocking=*/true);
+      }
+    }
+  }
+
   return Message(
       std::move(buffers.payload),
       std::move(tensors),
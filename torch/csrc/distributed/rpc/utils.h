@@ -49,6 +49,44 @@ TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     const void* data,
     size_t data_size);
 
+// Like wireSerialize(), but leaves the bytes of the tensor storages out of the
+// returned string, so that transports can send them without copying. They are
+// returned as flat kChar tensors viewing the storages, in the order expected
+// by wireDeserializeMetadata(). The string records their sizes, which the
+// receiver reads with wireTensorDataSizes() to allocate the buffers.
+TORCH_API std::pair<std::string, std::vector<at::Tensor>> wireSerializeMetadata(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors);
+
+TORCH_API std::vector<int64_t> wireTensorDataSizes(
+    const void* data,
+    size_t data_size);
+
+// The deserialized tensors use the buffers in `tensorData` as their storages
+// and keep them alive, without copying them.
+TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>>
+wireDeserializeMetadata(
+    const void* data,
+    size_t data_size,
+    const std::vector<at::Tensor>& tensorData);
+
+#ifndef _WIN32
+// Creates the POSIX shared memory segment `name` holding the flat kChar
+// tensors of `tensorData`, as returned by wireSerializeMetadata(). Returns
+// false if that failed, e.g. because /dev/shm is full, in which case the
+// tensor data has to be sent some other way.
+TORCH_API bool writeShmSegment(
+    const std::string& name,
+    const std::vector<at::Tensor>& tensorData);
+
+// Maps the segment `name` created by writeShmSegment() and removes its name
+// right away, so that it is freed once the returned tensors are. They view a
+// private mapping of the segment, holding tensor data of the given `sizes`.
+TORCH_API std::vector<at::Tensor> readShmSegment(
+    const std::string& name,
+    const std::vector<int64_t>& sizes);
+#endif
+
 // We use vector<char> as the type of blobs because it's what rpc::Message uses
 // for its payload, even though it has the disadvantage that it cannot be
 // allocated with uninitialized memory: it is always zeroed out.
@@ -61,7 +99,9 @@ struct TensorpipeWriteBuffers {
   std::unique_ptr<int64_t> id;
   std::vector<char> payload;
   std::vector<char> pickle;
-  // This contains the original tensors and the clones of the sparse tensors.
+  std::vector<c10::DeviceIndex> devices;
+  // This contains the original tensors (or their copies on CPU) and the clones
+  // of the sparse tensors.
   std::vector<torch::Tensor> tensors;
   // This contains the copies of the data of the tensors that didn't own their
   // memory, e.g., the ones created from torch::from_blob() with no deleter.
@@ -76,24 +116,33 @@ struct TensorpipeReadBuffers {
   std::unique_ptr<int64_t> id;
   std::vector<char> payload;
   std::vector<char> pickle;
+  std::vector<c10::DeviceIndex> devices;
   std::vector<c10::DataPtr> tensors;
 };
 
 // Convert an RPC message into a TensorPipe message, plus a holder to all the
 // data that must be kept alive while the write is performed asynchronously.
+// If given, `devices` holds, for every tensor of the message, the index of the
+// CUDA device it must be placed on by the receiver, or -1 for CPU. CUDA
+// tensors are copied to CPU on their current streams before being sent.
 TORCH_API std::tuple<tensorpipe::Message, TensorpipeWriteBuffers>
-tensorpipeSerialize(Message&& rpcMessage);
+tensorpipeSerialize(
+    Message&& rpcMessage,
+    std::vector<c10::DeviceIndex> devices = {});
 
 // Allocate the buffers that will hold the incoming data. They will be managed
 // by the returned holder, which must be kept alive until the asynchronous read
 // has finished. Pointers to these buffers will be stored in-place in the
-// TensorPipe message.
+// TensorPipe message. The buffers of the tensors become their storages, in
+// pinned memory if some tensors of the message go to CUDA devices.
 TORCH_API TensorpipeReadBuffers
 tensorpipeAllocate(tensorpipe::Message& tpMessage);
 
 // Convert a TensorPipe message back into an RPC message. This requires the data
 // to be available and can thus only be performed once the asynchronous read has
-// completed. The holder can be destroyed once this function returns.
+// completed. The holder can be destroyed once this function returns. Tensors
+// are copied to the CUDA devices given to tensorpipeSerialize(), if any,
+// asynchronously on the current streams of these devices.
 TORCH_API Message tensorpipeDeserialize(
     tensorpipe::Message&& tpMessage,
     TensorpipeReadBuffers&& holder);
@@ -5,6 +5,9 @@
 #include <torch/csrc/jit/passes/constant_pooling.h>
 #include <torch/csrc/jit/passes/constant_propagation.h>
 #include <torch/csrc/jit/passes/peephole.h>
+#include <torch/csrc/jit/runtime/observer.h>
+
+#include <chrono>
 
 namespace torch {
 namespace jit {
@@ -32,7 +35,24 @@ void placeholderCreator(GraphFunction&) {
 }
 
 void GraphFunction::run(Stack& stack) {
+  if (C10_LIKELY(!hasInterpreterObserver())) {
+    get_executor().run(stack);
+    return;
+  }
+  auto observer = getInterpreterObserver();
+  if (!observer) {
+    get_executor().run(stack);
+    return;
+  }
+  const auto& method_name = qualname().qualifiedName();
+  observer->onMethodStart(method_name);
+  auto start = std::chrono::steady_clock::now();
   get_executor().run(stack);
+  auto end = std::chrono::steady_clock::now();
+  observer->onMethodEnd(
+      method_name,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count());
 }
 
 void GraphFunction::run(Stack&& stack) {
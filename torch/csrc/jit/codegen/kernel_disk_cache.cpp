@@ -0,0 +1,131 @@
+#include <torch/csrc/jit/codegen/kernel_disk_cache.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+std::mutex& kernelCacheDirMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::string& kernelCacheDir() {
+  static std::string dir = [] {
+    const char* env = std::getenv("PYTORCH_KERNEL_CACHE_PATH");
+    return env ? std::string(env) : std::string();
+  }();
+  return dir;
+}
+
+// FNV-1a, which unlike std::hash is the same for every build.
+uint64_t hashKey(const std::string& key) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string toHex(uint64_t value) {
+  std::ostringstream oss;
+  oss << std::hex << value;
+  return oss.str();
+}
+
+// Returns the path of the entry for `key`, or an empty string if the cache is
+// disabled.
+std::string entryPath(const std::string& kind, const std::string& key) {
+  std::string dir = getKernelCacheDir();
+  if (dir.empty()) {
+    return dir;
+  }
+  return dir + "/" + kind + "-" + toHex(hashKey(key)) + ".bin";
+}
+
+} // namespace
+
+void setKernelCacheDir(const std::string& dir) {
+  std::lock_guard<std::mutex> guard(kernelCacheDirMutex());
+  kernelCacheDir() = dir;
+}
+
+std::string getKernelCacheDir() {
+  std::lock_guard<std::mutex> guard(kernelCacheDirMutex());
+  return kernelCacheDir();
+}
+
+// An entry is the size of the key in decimal, a newline, the key and then the
+// binary.
+c10::optional<std::string> loadCachedKernel(
+    const std::string& kind,
+    const std::string& key) {
+  std::string path = entryPath(kind, key);
+  if (path.empty()) {
+    return c10::nullopt;
+  }
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return c10::nullopt;
+  }
+  std::string contents(
+      (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  size_t newline = contents.find('\n');
+  if (newline == std::string::npos) {
+    return c10::nullopt;
+  }
+  char* end = nullptr;
+  uint64_t keySize = std::strtoull(contents.c_str(), &end, 10);
+  size_t keyBegin = newline + 1;
+  if (end != contents.c_str() + newline || keySize != key.size() ||
+      contents.size() - keyBegin < keySize ||
+      contents.compare(keyBegin, keySize, key) != 0) {
+    return c10::nullopt;
+  }
+  return contents.substr(keyBegin + keySize);
+}
+
+void storeCachedKernel(
+    const std::string& kind,
+    const std::string& key,
+    const std::string& binary) {
+  std::string path = entryPath(kind, key);
+  if (path.empty()) {
+    return;
+  }
+  // Write to a temporary file and rename it, so that a concurrent reader never
+  // sees a partial entry.
+  std::random_device rd;
+  std::string tmpPath = path + ".tmp" +
+      toHex((static_cast<uint64_t>(rd()) << 32) | rd());
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return;
+    }
+    out << key.size() << '\n';
+    out.write(key.data(), key.size());
+    out.write(binary.data(), binary.size());
+    out.close();
+    if (!out) {
+      std::remove(tmpPath.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <string>
+
+namespace torch {
+namespace jit {
+
+// An on-disk cache of compiled kernels (e.g. object code or PTX), shared by
+// the fusers so that a new process can load the kernels an earlier process
+// compiled instead of compiling them again.
+//
+// The cache is disabled unless a directory is set, either with
+// setKernelCacheDir or with the PYTORCH_KERNEL_CACHE_PATH environment
+// variable. The directory must exist.
+//
+// Entries are content-addressed: `key` must describe everything the compiled
+// kernel depends on (the kernel source or IR, the compiler and its version,
+// the target). The key is stored with the entry, so a collision of the hashes
+// used for file names is a miss rather than a wrong kernel. `kind` names the
+// kind of binary (e.g. "llvm", "cuda") and is part of the file name.
+//
+// Errors reading or writing the cache are ignored: the caller then simply
+// compiles the kernel.
+
+TORCH_API void setKernelCacheDir(const std::string& dir);
+TORCH_API std::string getKernelCacheDir();
+
+TORCH_API c10::optional<std::string> loadCachedKernel(
+    const std::string& kind,
+    const std::string& key);
+
+TORCH_API void storeCachedKernel(
+    const std::string& kind,
+    const std::string& key,
+    const std::string& binary);
+
+} // namespace jit
+} // namespace torch
@@ -34,7 +34,8 @@ bool Function::append_operator(
 
   auto jit_op = findOperatorFor(opname);
   if (jit_op) {
-    fn = [jit_op](Stack& stack) { jit_op->getOperation()(stack); };
+    // Resolve the Operation once rather than on every call.
+    fn = jit_op->getOperation();
   } else {
     auto op = c10::Dispatcher::singleton().findSchema(opname_c10);
     if (op.has_value()) {
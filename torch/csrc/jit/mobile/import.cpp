@@ -85,8 +85,27 @@ void print_unsupported_ops_and_throw(
 void parseMethods(
     const std::vector<IValue>& vals,
     mobile::CompilationUnit& mcu) {
-  for (const auto& element : vals) {
-    const auto& m_tuple = element.toTuple()->elements();
+  // See kProducedBytecodeVersion
+  size_t begin = 0;
+  int64_t version = caffe2::serialize::kMinSupportedBytecodeVersion;
+  if (!vals.empty() && vals[0].isInt()) {
+    version = vals[0].toInt();
+    begin = 1;
+  }
+  TORCH_CHECK(
+      version >= static_cast<int64_t>(
+                     caffe2::serialize::kMinSupportedBytecodeVersion) &&
+          version <= static_cast<int64_t>(
+                         caffe2::serialize::kProducedBytecodeVersion),
+      "Attempted to read bytecode with version ",
+      version,
+      ", but the supported versions are ",
+      caffe2::serialize::kMinSupportedBytecodeVersion,
+      " to ",
+      caffe2::serialize::kProducedBytecodeVersion,
+      ".");
+  for (size_t i = begin; i < vals.size(); ++i) {
+    const auto& m_tuple = vals[i].toTuple()->elements();
     const std::string& function_name = m_tuple[0].toStringRef();
     IValue table = m_tuple[1];
 
@@ -11,6 +11,7 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <sstream>
 #include <unordered_map>
 
 namespace torch {
@@ -364,31 +365,37 @@ RegisterOperators mm_batch_side_reg({Operator(
     },
     aliasAnalysisIsSpecialCase())});
 
-std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
-    Value* value,
+// Sorts the nodes and filters out the ones that depend on the previous ones.
+std::vector<Node*> filterIndependentNodes(
+    std::vector<Node*> mms,
     AliasDb& alias_db) {
-  const auto postprocess = [&](std::vector<Node*> mms) {
-    if (mms.size() == 0) {
-      return mms;
-    }
-    std::sort(mms.begin(), mms.end(), [](Node* n, Node* m) {
-      return n->isBefore(m);
-    });
-    // Filter out dependent MMs. This algorithm might do very badly if e.g. you
-    // have a lot of independent MMs, that depend on the first one, but I doubt
-    // this will be a common scenario.
-    for (size_t i = 0; i < mms.size(); ++i) {
-      if (mms[i] == nullptr)
+  if (mms.size() == 0) {
+    return mms;
+  }
+  std::sort(
+      mms.begin(), mms.end(), [](Node* n, Node* m) { return n->isBefore(m); });
+  // Filter out dependent MMs. This algorithm might do very badly if e.g. you
+  // have a lot of independent MMs, that depend on the first one, but I doubt
+  // this will be a common scenario.
+  for (size_t i = 0; i < mms.size(); ++i) {
+    if (mms[i] == nullptr)
+      continue;
+    for (size_t j = i + 1; j < mms.size(); ++j) {
+      if (mms[j] == nullptr)
         continue;
-      for (size_t j = i + 1; j < mms.size(); ++j) {
-        if (mms[j] == nullptr)
-          continue;
-        if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
-          mms[j] = nullptr;
-        }
+      if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
+        mms[j] = nullptr;
       }
     }
-    return c10::filter(mms, [](Node* n) { return n != nullptr; });
+  }
+  return c10::filter(mms, [](Node* n) { return n != nullptr; });
+}
+
+std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
+    Value* value,
+    AliasDb& alias_db) {
+  const auto postprocess = [&](std::vector<Node*> mms) {
+    return filterIndependentNodes(std::move(mms), alias_db);
   };
 
   Block* block = value->node()->owningBlock();
@@ -455,6 +462,342 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   }
 }
 
+// Note [Batching ops with a shared input]
+// Linear (or addmm) nodes reading the same input, like the Q, K and V
+// projections of attention or the heads of a multi-task model, each run a
+// small GEMM. They are merged into one linear with the weights concatenated
+// along the output features, whose output is split. conv2d nodes reading the
+// same input with the same kernel size, stride, padding and dilation are
+// merged the same way along the output channels.
+//
+// When the weights and biases are constants, as in frozen modules, they are
+// concatenated once by BatchFrozenSharedInputOps, which freeze_module runs,
+// and the result only uses aten ops. Otherwise the linear nodes are replaced
+// by a prim::LinearBatchSide that concatenates the weights at every call when
+// they are small enough.
+//
+// The outputs are made contiguous, since the users may view them.
+
+static constexpr size_t min_shared_input_batch_size = 2;
+
+bool weights_are_fast_for_linear_side(at::TensorList weights) {
+  // Same cutoff as shape_is_fast_for_side: above it the copy of the weights
+  // costs more than the saved GEMM launches
+  int64_t numel = 0;
+  for (const at::Tensor& weight : weights) {
+    numel += weight.numel();
+  }
+  return numel <= 1024 * 2048;
+}
+
+bool can_concat_linear_weights(
+    at::TensorList weights,
+    const std::vector<c10::optional<at::Tensor>>& biases) {
+  const at::Tensor& first = weights[0];
+  for (size_t i = 0; i < weights.size(); ++i) {
+    const at::Tensor& weight = weights[i];
+    if (weight.dim() != 2 || weight.size(1) != first.size(1) ||
+        weight.scalar_type() != first.scalar_type() ||
+        weight.device() != first.device() ||
+        biases[i].has_value() != biases[0].has_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RegisterOperators linear_batch_side_reg({Operator(
+    prim::LinearBatchSide,
+    [](const Node* node) -> Operation {
+      size_t num_linears = (node->inputs().size() - 1) / 2;
+      return [num_linears](Stack& stack) {
+        std::vector<at::Tensor> weights;
+        std::vector<c10::optional<at::Tensor>> biases;
+        weights.reserve(num_linears);
+        biases.reserve(num_linears);
+        auto biases_begin = stack.end() - num_linears;
+        for (auto it = biases_begin - num_linears; it != biases_begin; ++it) {
+          weights.push_back(std::move(*it).toTensor());
+        }
+        for (auto it = biases_begin; it != stack.end(); ++it) {
+          biases.push_back(
+              it->isNone() ? c10::nullopt
+                           : c10::optional<at::Tensor>(it->toTensor()));
+        }
+        drop(stack, 2 * num_linears);
+        auto input = pop(stack).toTensor();
+
+        if (can_concat_linear_weights(weights, biases) &&
+            weights_are_fast_for_linear_side(weights)) {
+          at::Tensor bias;
+          if (biases[0]) {
+            bias = at::cat(fmap(biases, [](const c10::optional<at::Tensor>& b) {
+              return *b;
+            }));
+          }
+          auto output = at::linear(input, at::cat(weights), bias);
+          auto sizes =
+              fmap(weights, [](const at::Tensor& w) { return w.size(0); });
+          for (const at::Tensor& chunk :
+               at::split_with_sizes(output, sizes, /*dim=*/-1)) {
+            stack.emplace_back(chunk.contiguous());
+          }
+        } else {
+          for (size_t i = 0; i < num_linears; ++i) {
+            stack.emplace_back(at::linear(
+                input, weights[i], biases[i] ? *biases[i] : at::Tensor()));
+          }
+        }
+        return 0;
+      };
+    },
+    aliasAnalysisIsSpecialCase())});
+
+namespace {
+
+c10::optional<at::Tensor> constantTensor(Value* value) {
+  auto ivalue = toIValue(value);
+  if (!ivalue || !ivalue->isTensor()) {
+    return c10::nullopt;
+  }
+  return ivalue->toTensor();
+}
+
+bool isConstantOne(Value* value) {
+  auto ivalue = toIValue(value);
+  return ivalue &&
+      ((ivalue->isInt() && ivalue->toInt() == 1) ||
+       (ivalue->isDouble() && ivalue->toDouble() == 1.));
+}
+
+// A linear, addmm or conv2d node reading the shared input, with constant
+// weight and bias. The weight of addmm is transposed to the layout of linear.
+struct FrozenSharedInputOp {
+  Node* node;
+  at::Tensor weight;
+  c10::optional<at::Tensor> bias;
+  // Nodes with the same key can be merged.
+  std::string key;
+};
+
+c10::optional<FrozenSharedInputOp> matchFrozenSharedInputOp(
+    Node* node,
+    Value* input) {
+  FrozenSharedInputOp op{node, at::Tensor(), c10::nullopt, ""};
+  Value* bias = nullptr;
+  std::stringstream key;
+  if (node->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor") &&
+      node->inputs()[0] == input) {
+    auto weight = constantTensor(node->inputs()[1]);
+    if (!weight || weight->dim() != 2) {
+      return c10::nullopt;
+    }
+    op.weight = *weight;
+    bias = node->inputs()[2];
+    key << "linear";
+  } else if (
+      node->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor") &&
+      node->inputs()[1] == input && isConstantOne(node->inputs()[3]) &&
+      isConstantOne(node->inputs()[4])) {
+    auto weight = constantTensor(node->inputs()[2]);
+    if (!weight || weight->dim() != 2) {
+      return c10::nullopt;
+    }
+    op.weight = weight->t();
+    bias = node->inputs()[0];
+    key << "linear";
+  } else if (
+      node->matches(
+          "aten::conv2d(Tensor input, Tensor weight, Tensor? bias=None, int[2] stride=1, int[2] padding=0, int[2] dilation=1, int groups=1) -> Tensor") &&
+      node->inputs()[0] == input) {
+    auto weight = constantTensor(node->inputs()[1]);
+    auto stride = toIValue(node->inputs()[3]);
+    auto padding = toIValue(node->inputs()[4]);
+    auto dilation = toIValue(node->inputs()[5]);
+    auto groups = toIValue(node->inputs()[6]);
+    if (!weight || weight->dim() != 4 || !stride || !padding || !dilation ||
+        !groups || groups->toInt() != 1) {
+      return c10::nullopt;
+    }
+    op.weight = *weight;
+    bias = node->inputs()[2];
+    key << "conv2d " << *stride << " " << *padding << " " << *dilation;
+  } else {
+    return c10::nullopt;
+  }
+
+  if (!bias->mustBeNone()) {
+    op.bias = constantTensor(bias);
+    if (!op.bias || op.bias->dim() != 1 ||
+        op.bias->size(0) != op.weight.size(0)) {
+      return c10::nullopt;
+    }
+  }
+  key << " " << op.weight.scalar_type() << " " << op.weight.device() << " "
+      << op.weight.sizes().slice(1);
+  op.key = key.str();
+  return op;
+}
+
+void batchFrozenSharedInputOps(
+    Graph* graph,
+    const std::vector<FrozenSharedInputOp>& ops) {
+  Node* first = ops[0].node;
+  for (const auto& op : ops) {
+    if (op.node->isBefore(first)) {
+      first = op.node;
+    }
+  }
+  WithInsertPoint insert_guard{first};
+
+  std::vector<at::Tensor> weights;
+  std::vector<int64_t> sizes;
+  std::vector<at::Tensor> biases;
+  bool has_bias = false;
+  for (const auto& op : ops) {
+    weights.push_back(op.weight);
+    sizes.push_back(op.weight.size(0));
+    has_bias |= op.bias.has_value();
+  }
+  for (const auto& op : ops) {
+    biases.push_back(
+        op.bias ? *op.bias
+                : at::zeros({op.weight.size(0)}, op.weight.options()));
+  }
+  Value* weight = graph->insertConstant(at::cat(weights));
+  Value* bias = has_bias ? graph->insertConstant(at::cat(biases))
+                         : graph->insertConstant(IValue());
+
+  Value* output;
+  int64_t split_dim;
+  if (ops[0].node->kind() == aten::conv2d) {
+    auto conv_inputs = ops[0].node->inputs();
+    output = graph->insert(
+        aten::conv2d,
+        {conv_inputs[0],
+         weight,
+         bias,
+         conv_inputs[3],
+         conv_inputs[4],
+         conv_inputs[5],
+         conv_inputs[6]});
+    split_dim = 1;
+  } else {
+    Value* input = ops[0].node->kind() == aten::addmm
+        ? ops[0].node->inputs()[1]
+        : ops[0].node->inputs()[0];
+    output = graph->insert(aten::linear, {input, weight, bias});
+    split_dim = -1;
+  }
+  Value* chunks =
+      graph->insert(aten::split_with_sizes, {output, sizes, split_dim});
+  Node* unpack =
+      graph->insertNode(graph->createListUnpack(chunks, ops.size()));
+  for (size_t i = 0; i < ops.size(); ++i) {
+    ops[i].node->output()->replaceAllUsesWith(
+        graph->insert(aten::contiguous, {unpack->outputs()[i]}));
+  }
+  // NB: the merged nodes are removed by DCE.
+}
+
+void BatchFrozenSharedInputOps(Block* block, AliasDb& alias_db) {
+  std::unordered_set<Value*> considered_values;
+  for (Node* node : block->nodes()) {
+    for (Block* subblock : node->blocks()) {
+      BatchFrozenSharedInputOps(subblock, alias_db);
+    }
+    for (Value* input : node->inputs()) {
+      if (input->uses().size() < min_shared_input_batch_size ||
+          !considered_values.emplace(input).second ||
+          alias_db.hasWriters(input)) {
+        continue;
+      }
+      // group the uses by key, in the order of the first use of each key
+      std::vector<std::vector<FrozenSharedInputOp>> groups;
+      std::unordered_map<std::string, size_t> group_index;
+      for (const Use& use : input->uses()) {
+        if (use.user->owningBlock() != block) {
+          continue;
+        }
+        if (auto op = matchFrozenSharedInputOp(use.user, input)) {
+          auto it = group_index.emplace(op->key, groups.size()).first;
+          if (it->second == groups.size()) {
+            groups.emplace_back();
+          }
+          groups[it->second].push_back(std::move(*op));
+        }
+      }
+      for (const auto& group : groups) {
+        if (group.size() >= min_shared_input_batch_size) {
+          batchFrozenSharedInputOps(block->owningGraph(), group);
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+void BatchLinearSide(Block* block, AliasDb& alias_db) {
+  const auto batch_linears = [&](std::vector<Node*>& linears) {
+    for (int64_t i = static_cast<int64_t>(linears.size()) - 2; i >= 0; --i) {
+      bool move_ok =
+          alias_db.moveBeforeTopologicallyValid(linears[i], linears[i + 1]);
+      AT_ASSERT(move_ok);
+    }
+    WithInsertPoint insert_guard{linears[0]};
+    Graph* graph = linears[0]->owningGraph();
+    Node* batch_linear = graph->create(
+        prim::LinearBatchSide,
+        /*inputs=*/{},
+        /*num_outputs=*/linears.size());
+    graph->insertNode(batch_linear);
+    batch_linear->addInput(linears[0]->inputs().at(0));
+    for (Node* linear : linears) {
+      batch_linear->addInput(linear->inputs().at(1));
+    }
+    for (size_t i = 0; i < linears.size(); ++i) {
+      batch_linear->addInput(linears[i]->inputs().at(2));
+      linears[i]->output()->replaceAllUsesWith(batch_linear->outputs().at(i));
+    }
+  };
+
+  std::unordered_set<Value*> considered_values;
+  for (Node* node : block->nodes()) {
+    if (node->matches(
+            "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor")) {
+      Value* input = node->inputs()[0];
+      if (!considered_values.emplace(input).second) {
+        continue;
+      }
+      std::vector<Node*> linears;
+      for (const Use& use : input->uses()) {
+        if (use.user->owningBlock() == block && use.offset == 0 &&
+            use.user->matches(
+                "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor")) {
+          linears.push_back(use.user);
+        }
+      }
+      linears = filterIndependentNodes(std::move(linears), alias_db);
+      if (linears.size() >= min_shared_input_batch_size) {
+        batch_linears(linears);
+      }
+    } else {
+      for (Block* subblock : node->blocks()) {
+        BatchLinearSide(subblock, alias_db);
+      }
+    }
+  }
+}
+
+void BatchFrozenSharedInputOps(std::shared_ptr<Graph>& graph) {
+  AliasDb alias_db(graph);
+  BatchFrozenSharedInputOps(graph->block(), alias_db);
+  EliminateDeadCode(graph);
+}
+
 bool hasMutableOperators(Block* block) {
   for (auto n : block->nodes()) {
     if (n->kind().is_aten() && n->schema().is_mutable())
@@ -475,6 +818,9 @@ void BatchMM(std::shared_ptr<Graph>& graph) {
   AliasDb alias_db(graph);
   BatchMMTreeReduce(graph->block());
   BatchMMSide(graph->block(), alias_db);
+  BatchFrozenSharedInputOps(graph);
+  AliasDb linear_alias_db(graph);
+  BatchLinearSide(graph->block(), linear_alias_db);
   EliminateDeadCode(graph);
   // It's possible that transpose rearrangements have created sequences of
   // consecutive transposes that didn't exist before.
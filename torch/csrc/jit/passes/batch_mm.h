@@ -7,5 +7,10 @@ namespace jit {
 
 TORCH_API void BatchMM(std::shared_ptr<Graph>& graph);
 
+// Merges the linear, addmm and conv2d nodes reading the same input whose
+// weights and biases are constants, as in frozen modules, into one node with
+// the weights concatenated once, followed by a split. Only emits aten ops.
+TORCH_API void BatchFrozenSharedInputOps(std::shared_ptr<Graph>& graph);
+
 }
 } // namespace torch
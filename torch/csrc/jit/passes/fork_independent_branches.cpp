@@ -0,0 +1,318 @@
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+int64_t nodeCost(const Node* node) {
+  static const std::unordered_set<Symbol> heavy_kinds = [] {
+    std::unordered_set<Symbol> kinds;
+    for (const char* name :
+         {"aten::_convolution",
+          "aten::conv1d",
+          "aten::conv2d",
+          "aten::conv3d",
+          "aten::conv_transpose1d",
+          "aten::conv_transpose2d",
+          "aten::conv_transpose3d",
+          "aten::linear",
+          "aten::matmul",
+          "aten::mm",
+          "aten::bmm",
+          "aten::addmm",
+          "aten::baddbmm",
+          "aten::einsum",
+          "aten::embedding_bag",
+          "aten::lstm",
+          "aten::gru",
+          "aten::rnn_tanh",
+          "aten::rnn_relu"}) {
+      kinds.insert(Symbol::fromQualString(name));
+    }
+    return kinds;
+  }();
+  return heavy_kinds.count(node->kind()) ? kHeavyNodeCost : 1;
+}
+
+// The nodes that can be moved to another thread: the aten operators without
+// blocks, side effects or randomness that neither mutate a value nor use a
+// value mutated elsewhere.
+bool canFork(Node* node, const AliasDb& aliasDb) {
+  return node->kind().is_aten() && node->kind() != aten::wait &&
+      node->blocks().empty() && node->maybeSchema() &&
+      !node->hasSideEffects() && !node->isNondeterministic() &&
+      !aliasDb.hasWriters(node);
+}
+
+// The node of the top level block that is or contains the node.
+Node* topLevelNode(Node* node, Block* block) {
+  while (node->owningBlock() != block) {
+    node = node->owningBlock()->owningNode();
+  }
+  return node;
+}
+
+struct UnionFind {
+  explicit UnionFind(size_t size) : parents(size) {
+    std::iota(parents.begin(), parents.end(), 0);
+  }
+
+  size_t find(size_t i) {
+    while (parents[i] != i) {
+      parents[i] = parents[parents[i]];
+      i = parents[i];
+    }
+    return i;
+  }
+
+  void merge(size_t a, size_t b) {
+    parents[find(a)] = find(b);
+  }
+
+  std::vector<size_t> parents;
+};
+
+struct Branch {
+  std::vector<Node*> nodes;
+  int64_t cost = 0;
+};
+
+// Groups the forkable nodes so that the nodes of different groups do not
+// depend on each other, even through the other nodes. The forkable nodes
+// that every other forkable node depends on or depends on them, like the
+// trunk shared by the heads of a model or the concatenation of its towers,
+// belong to no group.
+std::vector<Branch> findBranches(Block* block, const AliasDb& aliasDb) {
+  std::vector<Node*> forkable;
+  std::unordered_map<Node*, size_t> forkable_index;
+  for (Node* node : block->nodes()) {
+    if (canFork(node, aliasDb)) {
+      forkable_index[node] = forkable.size();
+      forkable.push_back(node);
+    }
+  }
+  const size_t num_forkable = forkable.size();
+  if (num_forkable < 2) {
+    return {};
+  }
+
+  // The forkable ancestors of each node of the block, as bitsets. A node
+  // depends on the values used by the nodes of its blocks too.
+  const size_t num_words = (num_forkable + 63) / 64;
+  std::unordered_map<Node*, std::vector<uint64_t>> ancestors;
+  std::vector<const std::vector<uint64_t>*> forkable_ancestors(num_forkable);
+  for (Node* node : block->nodes()) {
+    auto& bits = ancestors[node];
+    bits.assign(num_words, 0);
+    std::vector<Node*> nested = {node};
+    while (!nested.empty()) {
+      Node* n = nested.back();
+      nested.pop_back();
+      for (Value* input : n->inputs()) {
+        Node* producer = topLevelNode(input->node(), block);
+        auto it = ancestors.find(producer);
+        if (it == ancestors.end() || producer == node) {
+          continue;
+        }
+        for (size_t w = 0; w < num_words; ++w) {
+          bits[w] |= it->second[w];
+        }
+        auto index = forkable_index.find(producer);
+        if (index != forkable_index.end()) {
+          bits[index->second / 64] |= uint64_t(1) << (index->second % 64);
+        }
+      }
+      for (Block* b : n->blocks()) {
+        for (Node* inner : b->nodes()) {
+          nested.push_back(inner);
+        }
+        nested.push_back(b->return_node());
+      }
+    }
+    auto index = forkable_index.find(node);
+    if (index != forkable_index.end()) {
+      forkable_ancestors[index->second] = &bits;
+    }
+  }
+
+  auto dependsOn = [&](size_t a, size_t b) {
+    return ((*forkable_ancestors[a])[b / 64] >> (b % 64)) & 1;
+  };
+
+  std::vector<size_t> num_related(num_forkable, 0);
+  for (size_t a = 0; a < num_forkable; ++a) {
+    for (size_t b = 0; b < num_forkable; ++b) {
+      if (dependsOn(a, b)) {
+        ++num_related[a];
+        ++num_related[b];
+      }
+    }
+  }
+  std::vector<bool> sequential(num_forkable);
+  for (size_t i = 0; i < num_forkable; ++i) {
+    sequential[i] = num_related[i] == num_forkable - 1;
+  }
+
+  UnionFind groups(num_forkable);
+  for (size_t a = 0; a < num_forkable; ++a) {
+    for (size_t b = 0; b < num_forkable; ++b) {
+      if (!sequential[a] && !sequential[b] && dependsOn(a, b)) {
+        groups.merge(a, b);
+      }
+    }
+  }
+
+  std::unordered_map<size_t, size_t> branch_index;
+  std::vector<Branch> branches;
+  for (size_t i = 0; i < num_forkable; ++i) {
+    if (sequential[i]) {
+      continue;
+    }
+    auto it = branch_index.emplace(groups.find(i), branches.size()).first;
+    if (it->second == branches.size()) {
+      branches.emplace_back();
+    }
+    auto& branch = branches[it->second];
+    branch.nodes.push_back(forkable[i]);
+    branch.cost += nodeCost(forkable[i]);
+  }
+  return branches;
+}
+
+// Moves the nodes of the branch in a prim::fork subgraph, inserted after the
+// last definition of its inputs, and reads its outputs with an aten::wait
+// inserted before their first use. Returns false if the fork would have to
+// be after the wait.
+bool forkBranch(const std::shared_ptr<Graph>& graph, const Branch& branch) {
+  Block* block = graph->block();
+  std::unordered_set<Node*> members(branch.nodes.begin(), branch.nodes.end());
+
+  std::vector<Value*> inputs;
+  std::unordered_set<Value*> seen_inputs;
+  std::vector<Value*> outputs;
+  Node* fork_point = block->param_node();
+  Node* wait_point = block->return_node();
+  for (Node* node : branch.nodes) {
+    for (Value* input : node->inputs()) {
+      if (members.count(input->node()) || !seen_inputs.insert(input).second) {
+        continue;
+      }
+      inputs.push_back(input);
+      Node* producer = topLevelNode(input->node(), block);
+      if (fork_point->isBefore(producer)) {
+        fork_point = producer;
+      }
+    }
+    for (Value* output : node->outputs()) {
+      bool used_outside = false;
+      for (const Use& use : output->uses()) {
+        if (members.count(use.user)) {
+          continue;
+        }
+        used_outside = true;
+        Node* user = topLevelNode(use.user, block);
+        if (user->isBefore(wait_point)) {
+          wait_point = user;
+        }
+      }
+      if (used_outside) {
+        outputs.push_back(output);
+      }
+    }
+  }
+  if (outputs.empty() || !fork_point->isBefore(wait_point)) {
+    return false;
+  }
+
+  auto subgraph = std::make_shared<Graph>();
+  std::unordered_map<Value*, Value*> env;
+  for (Value* input : inputs) {
+    env[input] = subgraph->addInput()->copyMetadata(input);
+  }
+  for (Node* node : branch.nodes) {
+    Node* clone = subgraph->insertNode(
+        subgraph->createClone(node, [&](Value* v) { return env.at(v); }));
+    for (size_t i = 0; i < node->outputs().size(); ++i) {
+      env[node->outputs()[i]] = clone->outputs()[i];
+    }
+  }
+  if (outputs.size() == 1) {
+    subgraph->registerOutput(env.at(outputs[0]));
+  } else {
+    std::vector<Value*> values;
+    for (Value* output : outputs) {
+      values.push_back(env.at(output));
+    }
+    subgraph->registerOutput(
+        subgraph->insertNode(subgraph->createTuple(values))->output());
+  }
+  const auto& result_type = subgraph->outputs()[0]->type();
+
+  Node* fork = graph->create(prim::fork, inputs, 1)->insertAfter(fork_point);
+  fork->g_(attr::Subgraph, subgraph);
+  fork->output()->setType(FutureType::create(result_type));
+
+  Node* wait = graph->create(aten::wait, {fork->output()}, 1)
+                   ->insertBefore(wait_point);
+  wait->output()->setType(result_type);
+  if (outputs.size() == 1) {
+    outputs[0]->replaceAllUsesWith(wait->output()->copyMetadata(outputs[0]));
+  } else {
+    Node* unpack =
+        graph->createTupleUnpack(wait->output())->insertAfter(wait);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      outputs[i]->replaceAllUsesWith(
+          unpack->outputs()[i]->copyMetadata(outputs[i]));
+    }
+  }
+
+  for (auto it = branch.nodes.rbegin(); it != branch.nodes.rend(); ++it) {
+    (*it)->destroy();
+  }
+  return true;
+}
+
+} // namespace
+
+bool ForkIndependentBranches(
+    const std::shared_ptr<Graph>& graph,
+    int64_t min_branch_cost) {
+  std::vector<Branch> branches;
+  {
+    AliasDb aliasDb(graph);
+    branches = findBranches(graph->block(), aliasDb);
+  }
+  branches.erase(
+      std::remove_if(
+          branches.begin(),
+          branches.end(),
+          [&](const Branch& branch) { return branch.cost < min_branch_cost; }),
+      branches.end());
+  if (branches.size() < 2) {
+    return false;
+  }
+
+  // The most expensive branch runs on the calling thread.
+  std::stable_sort(
+      branches.begin(), branches.end(), [](const Branch& a, const Branch& b) {
+        return a.cost > b.cost;
+      });
+  bool changed = false;
+  for (size_t i = 1; i < branches.size(); ++i) {
+    changed |= forkBranch(graph, branches[i]);
+  }
+  GRAPH_DUMP("After ForkIndependentBranches: ", graph);
+  return changed;
+}
+
+} // namespace jit
+} // namespace torch
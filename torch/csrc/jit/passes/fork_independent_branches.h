@@ -0,0 +1,31 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+constexpr int64_t kHeavyNodeCost = 10;
+
+// Runs the independent branches of a graph on the inter-op thread pool, for
+// example the towers or the heads of a multi-tower model. The branches are
+// the groups of side effect free aten nodes of the top level block that only
+// depend on each other and on values computed outside of every branch. Each
+// branch with an estimated cost of at least min_branch_cost is moved in a
+// prim::fork subgraph, and its outputs are read by an aten::wait inserted
+// before their first use. The most expensive branch is kept inline so that
+// the calling thread works while the forked ones run.
+//
+// The interpreter suspends on an aten::wait whose future is not completed
+// and resumes once it is, so the resulting graph executes in dataflow order.
+//
+// The cost of a node is 1, except for the convolutions, matrix products and
+// recurrent layers that cost kHeavyNodeCost.
+//
+// Returns true if the graph was changed.
+TORCH_API bool ForkIndependentBranches(
+    const std::shared_ptr<Graph>& graph,
+    int64_t min_branch_cost = 2 * kHeavyNodeCost);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,242 @@
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <torch/csrc/jit/passes/liveness.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <numeric>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool overlaps(const LiveRange& a, const LiveRange& b) {
+  return a.begin <= b.end && b.begin <= a.end;
+}
+
+std::vector<size_t> alignedSizes(
+    const std::vector<MemoryRequest>& requests,
+    size_t alignment) {
+  TORCH_CHECK(
+      alignment > 0 && (alignment & (alignment - 1)) == 0,
+      "alignment must be a power of two, got ",
+      alignment);
+  std::vector<size_t> sizes;
+  sizes.reserve(requests.size());
+  for (const MemoryRequest& request : requests) {
+    sizes.push_back((request.size + alignment - 1) & ~(alignment - 1));
+  }
+  return sizes;
+}
+
+MemoryPlan planGreedyBySize(
+    const std::vector<MemoryRequest>& requests,
+    const std::vector<size_t>& sizes) {
+  std::vector<size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return sizes[a] > sizes[b];
+  });
+
+  MemoryPlan plan;
+  plan.offsets.resize(requests.size());
+  std::vector<size_t> placed;
+  std::vector<size_t> conflicts;
+  for (size_t i : order) {
+    conflicts.clear();
+    for (size_t j : placed) {
+      if (overlaps(requests[i].range, requests[j].range)) {
+        conflicts.push_back(j);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [&](size_t a, size_t b) {
+      return plan.offsets[a] < plan.offsets[b];
+    });
+    // Take the first gap between conflicting requests that is large enough.
+    size_t offset = 0;
+    for (size_t j : conflicts) {
+      if (offset + sizes[i] <= plan.offsets[j]) {
+        break;
+      }
+      offset = std::max(offset, plan.offsets[j] + sizes[j]);
+    }
+    plan.offsets[i] = offset;
+    plan.total_size = std::max(plan.total_size, offset + sizes[i]);
+    placed.push_back(i);
+  }
+  return plan;
+}
+
+MemoryPlan planLinearScan(
+    const std::vector<MemoryRequest>& requests,
+    const std::vector<size_t>& sizes) {
+  std::vector<size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return requests[a].range.begin < requests[b].range.begin;
+  });
+
+  MemoryPlan plan;
+  plan.offsets.resize(requests.size());
+  // Free blocks of the arena, offset -> size; adjacent blocks are merged.
+  std::map<size_t, size_t> free_blocks;
+  // Requests that have been placed and not released yet, by end of range.
+  std::multimap<size_t, size_t> active;
+
+  auto release = [&](size_t offset, size_t size) {
+    auto next = free_blocks.lower_bound(offset);
+    if (next != free_blocks.end() && offset + size == next->first) {
+      size += next->second;
+      next = free_blocks.erase(next);
+    }
+    if (next != free_blocks.begin()) {
+      auto prev = std::prev(next);
+      if (prev->first + prev->second == offset) {
+        prev->second += size;
+        return;
+      }
+    }
+    free_blocks.emplace(offset, size);
+  };
+
+  for (size_t i : order) {
+    const size_t begin = requests[i].range.begin;
+    while (!active.empty() && active.begin()->first < begin) {
+      const size_t j = active.begin()->second;
+      release(plan.offsets[j], sizes[j]);
+      active.erase(active.begin());
+    }
+
+    auto best = free_blocks.end();
+    for (auto it = free_blocks.begin(); it != free_blocks.end(); ++it) {
+      if (it->second >= sizes[i] &&
+          (best == free_blocks.end() || it->second < best->second)) {
+        best = it;
+      }
+    }
+    if (best != free_blocks.end()) {
+      plan.offsets[i] = best->first;
+      const size_t remaining = best->second - sizes[i];
+      const size_t remaining_offset = best->first + sizes[i];
+      free_blocks.erase(best);
+      if (remaining > 0) {
+        free_blocks.emplace(remaining_offset, remaining);
+      }
+    } else if (
+        !free_blocks.empty() &&
+        free_blocks.rbegin()->first + free_blocks.rbegin()->second ==
+            plan.total_size) {
+      // Grow the arena from the free block at its end.
+      plan.offsets[i] = free_blocks.rbegin()->first;
+      free_blocks.erase(std::prev(free_blocks.end()));
+      plan.total_size = plan.offsets[i] + sizes[i];
+    } else {
+      plan.offsets[i] = plan.total_size;
+      plan.total_size += sizes[i];
+    }
+    active.emplace(requests[i].range.end, i);
+  }
+  return plan;
+}
+
+} // namespace
+
+MemoryPlan PlanMemory(
+    const std::vector<MemoryRequest>& requests,
+    MemoryPlanningStrategy strategy,
+    size_t alignment) {
+  for (const MemoryRequest& request : requests) {
+    TORCH_CHECK(
+        request.range.begin <= request.range.end,
+        "Invalid live range [",
+        request.range.begin,
+        ", ",
+        request.range.end,
+        "]");
+  }
+  const auto sizes = alignedSizes(requests, alignment);
+  switch (strategy) {
+    case MemoryPlanningStrategy::GREEDY_BY_SIZE:
+      return planGreedyBySize(requests, sizes);
+    case MemoryPlanningStrategy::LINEAR_SCAN:
+      return planLinearScan(requests, sizes);
+  }
+  TORCH_INTERNAL_ASSERT(false, "Unknown memory planning strategy");
+}
+
+std::unordered_map<const Value*, LiveRange> ComputeLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    AliasDb& alias_db) {
+  Block* block = graph->block();
+  std::unordered_map<const Node*, size_t> node_index;
+  std::vector<Value*> values(block->inputs().begin(), block->inputs().end());
+  std::unordered_map<const Value*, LiveRange> ranges;
+  for (Value* input : block->inputs()) {
+    ranges[input] = LiveRange{0, 0};
+  }
+  for (Node* node : block->nodes()) {
+    const size_t index = node_index.size();
+    node_index[node] = index;
+    for (Value* output : node->outputs()) {
+      values.push_back(output);
+      ranges[output] = LiveRange{index, index};
+    }
+  }
+
+  // Returns the node of the top level block that contains `node`.
+  auto topLevelNode = [&](Node* node) {
+    while (node->owningBlock() != block) {
+      node = node->owningBlock()->owningNode();
+    }
+    return node;
+  };
+  for (Value* v : values) {
+    LiveRange& range = ranges[v];
+    for (const Use& use : v->uses()) {
+      if (use.user->kind() == prim::Return && use.user->owningBlock() == block) {
+        range.end = node_index.size();
+      } else {
+        range.end = std::max(range.end, node_index.at(topLevelNode(use.user)));
+      }
+    }
+  }
+  // The liveness sets may have entries for temporary nodes that
+  // BuildLivenessSets destroyed again, so only look up the nodes of the graph.
+  const auto liveness = BuildLivenessSets(graph);
+  std::function<void(Block*, size_t)> extendOverLiveness = [&](Block* b,
+                                                               size_t index) {
+    for (Node* node : b->nodes()) {
+      if (b == block) {
+        index = node_index.at(node);
+      }
+      auto live = liveness.find(node);
+      if (live != liveness.end()) {
+        for (Value* v : live->second) {
+          auto range = ranges.find(v);
+          if (range != ranges.end()) {
+            range->second.end = std::max(range->second.end, index);
+          }
+        }
+      }
+      for (Block* sub_block : node->blocks()) {
+        extendOverLiveness(sub_block, index);
+      }
+    }
+  };
+  extendOverLiveness(block, 0);
+
+  const auto direct_ranges = ranges;
+  for (Value* v : values) {
+    for (Value* other : values) {
+      if (other != v && alias_db.mayContainAlias(v, other)) {
+        ranges[v].end = std::max(ranges[v].end, direct_ranges.at(other).end);
+      }
+    }
+  }
+  return ranges;
+}
+
+} // namespace jit
+} // namespace torch
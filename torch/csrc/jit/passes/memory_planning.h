@@ -0,0 +1,60 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// The nodes of a block during which a value must stay allocated, as indices
+// into the block's node list; both bounds are inclusive.
+struct LiveRange {
+  size_t begin;
+  size_t end;
+};
+
+// A buffer of `size` bytes that is in use during `range`.
+struct MemoryRequest {
+  size_t size;
+  LiveRange range;
+};
+
+// The offset of every request in an arena of total_size bytes.
+struct MemoryPlan {
+  std::vector<size_t> offsets;
+  size_t total_size = 0;
+};
+
+enum class MemoryPlanningStrategy {
+  // Places the largest requests first, each at the lowest offset that doesn't
+  // overlap a placed request with an overlapping live range.
+  GREEDY_BY_SIZE,
+  // Interval coloring: walks the requests in order of their start, releases
+  // the ones that have ended and gives each the best-fitting free block.
+  LINEAR_SCAN,
+};
+
+// Assigns an offset to every request such that requests whose live ranges
+// overlap don't overlap in memory. Sizes are rounded up to `alignment`, which
+// must be a power of two.
+TORCH_API MemoryPlan PlanMemory(
+    const std::vector<MemoryRequest>& requests,
+    MemoryPlanningStrategy strategy = MemoryPlanningStrategy::GREEDY_BY_SIZE,
+    size_t alignment = 64);
+
+// Computes the live range of the inputs of `graph` and of the outputs of the
+// nodes of its top level block, as indices into graph->nodes(). A value is
+// live from the node defining it (0 for graph inputs) to the last node that
+// uses it, directly or in a nested block, or that it is live across according
+// to BuildLivenessSets, and the range of a value that may be contained in or
+// alias another value is extended over the range of that value. Graph outputs
+// and the values that may alias them are live until graph->nodes().size().
+TORCH_API std::unordered_map<const Value*, LiveRange> ComputeLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    AliasDb& alias_db);
+
+} // namespace jit
+} // namespace torch
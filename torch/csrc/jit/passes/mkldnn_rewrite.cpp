@@ -0,0 +1,154 @@
+#include <ATen/Config.h>
+#include <ATen/core/jit_type.h>
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/ir/subgraph_matcher.h>
+#include <torch/csrc/jit/passes/fold_conv_bn.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/graph_rewrite_helper.h>
+#include <torch/csrc/jit/passes/mkldnn_rewrite.h>
+#include <torch/csrc/jit/passes/prepack_folding.h>
+#include <torch/csrc/jit/passes/subgraph_rewrite.h>
+
+namespace torch {
+namespace jit {
+
+#if AT_MKLDNN_ENABLED()
+
+namespace {
+
+void insertPrePackedConv2dOp(std::shared_ptr<Graph>& graph) {
+  graph_rewrite_helper::replaceConvolutionWithAtenConv(graph);
+
+  std::string conv_2d_pattern = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[], %dilation:int[], %groups:int):
+        %r = aten::conv2d(%input, %weight, %bias, %stride, %padding, %dilation, %groups)
+        return (%r) )";
+
+  std::string prepacked_ops_conv2d_pattern = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[], %dilation:int[], %groups:int):
+        %packed_weight_bias = mkldnn_prepacked::conv2d_prepack(
+            %weight, %bias, %stride, %padding, %dilation, %groups)
+        %r = mkldnn_prepacked::conv2d_run(%input, %packed_weight_bias)
+        return (%r) )";
+
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(
+      conv_2d_pattern, prepacked_ops_conv2d_pattern);
+  rewriter.runOnGraph(graph);
+}
+
+// Only the transposed convolutions without groups whose output padding is not
+// larger than their padding have a oneDNN deconvolution, see
+// mkldnn_prepacked::conv_transpose2d_prepack.
+bool isPrePackableConvTranspose2d(
+    const Match& match,
+    const std::unordered_map<std::string, Value*>& vmap) {
+  const auto& match_vmap = match.values_map;
+  auto groups =
+      graph_rewrite_helper::getIValue("groups", match_vmap, vmap);
+  auto padding =
+      graph_rewrite_helper::getIValue("padding", match_vmap, vmap);
+  auto output_padding =
+      graph_rewrite_helper::getIValue("output_padding", match_vmap, vmap);
+  if (!groups || !padding || !output_padding || groups->toInt() != 1) {
+    return false;
+  }
+  auto padding_list = padding->toIntVector();
+  auto output_padding_list = output_padding->toIntVector();
+  if (padding_list.size() == 1) {
+    padding_list.resize(2, padding_list[0]);
+  }
+  if (output_padding_list.size() == 1) {
+    output_padding_list.resize(2, output_padding_list[0]);
+  }
+  if (padding_list.size() != 2 || output_padding_list.size() != 2) {
+    return false;
+  }
+  return output_padding_list[0] <= padding_list[0] &&
+      output_padding_list[1] <= padding_list[1];
+}
+
+void insertPrePackedConvTranspose2dOp(std::shared_ptr<Graph>& graph) {
+  std::string conv_transpose_2d_pattern = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[], %output_padding:int[], %groups:int, %dilation:int[]):
+        %r = aten::conv_transpose2d(%input, %weight, %bias, %stride, %padding, %output_padding, %groups, %dilation)
+        return (%r) )";
+
+  std::string prepacked_ops_conv_transpose_2d_pattern = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[], %output_padding:int[], %groups:int, %dilation:int[]):
+        %packed_weight_bias = mkldnn_prepacked::conv_transpose2d_prepack(
+            %weight, %bias, %stride, %padding, %output_padding, %dilation, %groups)
+        %r = mkldnn_prepacked::conv_transpose2d_run(%input, %packed_weight_bias)
+        return (%r) )";
+
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(
+      conv_transpose_2d_pattern, prepacked_ops_conv_transpose_2d_pattern);
+  rewriter.runOnGraph(graph, isPrePackableConvTranspose2d);
+}
+
+} // namespace
+
+void mkldnnInsertPrePackedOps(std::shared_ptr<Graph>& graph) {
+  insertPrePackedConv2dOp(graph);
+  insertPrePackedConvTranspose2dOp(graph);
+}
+
+void mkldnnInsertPrePackedOps(script::Module& module) {
+  for (auto& method : module.get_methods()) {
+    auto graph = method.graph();
+    mkldnnInsertPrePackedOps(graph);
+  }
+  for (script::Module m : module.children()) {
+    mkldnnInsertPrePackedOps(m);
+  }
+}
+
+void mkldnnFoldPrePackingOps(script::Module& m) {
+  PrePackingOpsFilterFn filter_fn = [](const Node* n) -> bool {
+    return (
+        n->kind() ==
+            Symbol::fromQualString("mkldnn_prepacked::conv2d_prepack") ||
+        n->kind() ==
+            Symbol::fromQualString("mkldnn_prepacked::conv_transpose2d_prepack"));
+  };
+  PrePackingOpsFolder(m, filter_fn, "prepack_folding");
+}
+
+script::Module mkldnnPrepackFrozenModule(const script::Module& m) {
+  auto cloned_module = m.clone();
+  cloned_module.eval();
+  cloned_module = FoldConvBatchNorm2d(cloned_module);
+  mkldnnInsertPrePackedOps(cloned_module);
+  cloned_module = freeze_module(cloned_module);
+  mkldnnFoldPrePackingOps(cloned_module);
+  return cloned_module;
+}
+
+#else
+
+void mkldnnInsertPrePackedOps(std::shared_ptr<Graph>& graph) {
+  TORCH_INTERNAL_ASSERT(
+      false, "MKLDNN is not enabled. Please build with USE_MKLDNN=1");
+}
+
+void mkldnnInsertPrePackedOps(script::Module& module) {
+  TORCH_INTERNAL_ASSERT(
+      false, "MKLDNN is not enabled. Please build with USE_MKLDNN=1");
+}
+
+void mkldnnFoldPrePackingOps(script::Module& m) {
+  TORCH_INTERNAL_ASSERT(
+      false, "MKLDNN is not enabled. Please build with USE_MKLDNN=1");
+}
+
+script::Module mkldnnPrepackFrozenModule(const script::Module& module) {
+  TORCH_INTERNAL_ASSERT(
+      false, "MKLDNN is not enabled. Please build with USE_MKLDNN=1");
+  return module;
+}
+
+#endif
+} // namespace jit
+} // namespace torch
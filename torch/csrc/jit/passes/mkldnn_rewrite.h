@@ -0,0 +1,23 @@
+#pragma once
+
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Rewrites aten::conv2d into mkldnn_prepacked::conv2d_prepack and
+// mkldnn_prepacked::conv2d_run, and aten::conv_transpose2d into their
+// conv_transpose2d counterparts, whose op contexts hold the weight in the
+// blocked format of the oneDNN primitive.
+TORCH_API void mkldnnInsertPrePackedOps(std::shared_ptr<Graph>& graph);
+TORCH_API void mkldnnInsertPrePackedOps(script::Module& module);
+// Runs the prepack ops of constant weights once, and stores their op
+// contexts as attributes of the module. The module must be frozen.
+TORCH_API void mkldnnFoldPrePackingOps(script::Module& module);
+// Freezes a clone of module in eval mode and folds the prepacked
+// convolutions into it.
+TORCH_API script::Module mkldnnPrepackFrozenModule(const script::Module& module);
+
+} // namespace jit
+} // namespace torch
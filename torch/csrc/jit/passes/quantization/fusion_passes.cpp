@@ -53,11 +53,44 @@ void fuseQuantizeAddReluImpl(std::shared_ptr<Graph>& graph) {
       quantized_add_scalar_out_relu_pattern, fused_add_scalar_out_relu_pattern);
   fused_add_relu_rewriter.runOnGraph(graph);
 }
+
+void fuseQuantizedProducerAddImpl(std::shared_ptr<Graph>& graph) {
+  SubgraphRewriter fused_producer_add_rewriter;
+  const std::string graph_header =
+      "graph(%a_quant, %packed_params, %y_scale, %y_zero_point, %b_quant, %scale, %zero_point):";
+  for (const std::string producer : {"conv2d", "conv3d", "linear"}) {
+    for (const std::string add : {"add", "add_relu"}) {
+      std::string fused_pattern = graph_header + R"(
+         %r = quantized::)" +
+          producer + "_" + add +
+          R"((%a_quant, %packed_params, %b_quant, %y_scale, %y_zero_point, %scale, %zero_point)
+         return (%r) )";
+      // The result of the producer can be either operand of the add.
+      for (const std::string add_args :
+           {"(%y_quant, %b_quant, %scale, %zero_point)",
+            "(%b_quant, %y_quant, %scale, %zero_point)"}) {
+        std::string pattern = graph_header + R"(
+         %y_quant = quantized::)" +
+            producer + R"((%a_quant, %packed_params, %y_scale, %y_zero_point)
+         %r = quantized::)" +
+            add + add_args + R"(
+         return (%r) )";
+        fused_producer_add_rewriter.RegisterRewritePattern(
+            pattern, fused_pattern);
+      }
+    }
+  }
+  fused_producer_add_rewriter.runOnGraph(graph);
+}
 } // namespace
 
 void FuseQuantizedAddRelu(std::shared_ptr<Graph>& graph) {
   fuseQuantizeAddReluImpl(graph);
 }
 
+void FuseQuantizedProducerAdd(std::shared_ptr<Graph>& graph) {
+  fuseQuantizedProducerAddImpl(graph);
+}
+
 } // namespace jit
 } // namespace torch
@@ -5,5 +5,10 @@
 namespace torch {
 namespace jit {
 TORCH_API void FuseQuantizedAddRelu(std::shared_ptr<Graph>& graph);
+
+// Fuses quantized::conv2d, conv3d and linear with the quantized::add or
+// add_relu of their result into quantized::conv2d_add, conv2d_add_relu, etc.
+// Run FuseQuantizedAddRelu first for the add - relu sequences to be fused too.
+TORCH_API void FuseQuantizedProducerAdd(std::shared_ptr<Graph>& graph);
 } // namespace jit
 } // namespace torch
@@ -0,0 +1,1019 @@
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
+
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using c10::ShapeSymbol;
+using c10::Stride;
+using c10::SymbolicShape;
+using c10::VaryingShape;
+using Dims = std::vector<ShapeSymbol>;
+
+// Classes of symbols known to be equal. A static size is always the
+// representative of its class.
+class SymbolEquivalence {
+ public:
+  ShapeSymbol find(ShapeSymbol symbol) const {
+    auto it = parents_.find(symbol);
+    while (it != parents_.end()) {
+      symbol = it->second;
+      it = parents_.find(symbol);
+    }
+    return symbol;
+  }
+
+  void unify(ShapeSymbol a, ShapeSymbol b) {
+    a = find(a);
+    b = find(b);
+    // two different static sizes make the program fail at run time
+    if (a == b || (a.is_static() && b.is_static())) {
+      return;
+    }
+    if (a.is_static()) {
+      std::swap(a, b);
+    }
+    GRAPH_DEBUG("Unifying ", a, " with ", b);
+    parents_.emplace(a, b);
+  }
+
+ private:
+  std::map<ShapeSymbol, ShapeSymbol> parents_;
+};
+
+// An int argument of a shape function.
+struct SizeArg {
+  enum class Kind { Size, Infer, Unknown };
+  Kind kind;
+  ShapeSymbol symbol;
+
+  static SizeArg size(ShapeSymbol symbol) {
+    return {Kind::Size, symbol};
+  }
+  static SizeArg infer() {
+    return {Kind::Infer, ShapeSymbol::fromStaticSize(0)};
+  }
+  static SizeArg unknown() {
+    return {Kind::Unknown, ShapeSymbol::fromStaticSize(0)};
+  }
+};
+
+bool isStaticSize(ShapeSymbol symbol, int64_t size) {
+  return symbol.is_static() && symbol.static_size() == size;
+}
+
+// The product of the static sizes, the size itself if there is a single
+// one, or a new symbol.
+ShapeSymbol product(const Dims& dims) {
+  if (dims.size() == 1) {
+    return dims[0];
+  }
+  int64_t result = 1;
+  for (ShapeSymbol dim : dims) {
+    if (!dim.is_static()) {
+      return ShapeSymbol::newSymbol();
+    }
+    result *= dim.static_size();
+  }
+  return ShapeSymbol::fromStaticSize(result);
+}
+
+class SymbolicShapePropagator {
+ public:
+  explicit SymbolicShapePropagator(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)) {}
+
+  void run() {
+    processBlock(graph_->block());
+    updateTypes(graph_->block());
+  }
+
+ private:
+  c10::optional<Dims> dims(Value* value) {
+    auto it = shapes_.find(value);
+    if (it != shapes_.end()) {
+      return resolve(it->second);
+    }
+    auto type = value->type()->cast<TensorType>();
+    if (!type || !type->symbolic_sizes().sizes()) {
+      return c10::nullopt;
+    }
+    auto sizes = *type->symbolic_sizes().sizes();
+    shapes_.emplace(value, sizes);
+    return resolve(sizes);
+  }
+
+  Dims resolve(Dims dims) const {
+    for (auto& dim : dims) {
+      dim = equivalence_.find(dim);
+    }
+    return dims;
+  }
+
+  c10::optional<int64_t> constantInt(Value* value) {
+    auto ivalue = toIValue(value);
+    if (!ivalue || !ivalue->isInt()) {
+      return c10::nullopt;
+    }
+    return ivalue->toInt();
+  }
+
+  c10::optional<int64_t> constantDim(Value* value, size_t rank) {
+    auto dim = constantInt(value);
+    if (!dim) {
+      return c10::nullopt;
+    }
+    int64_t result = *dim < 0 ? *dim + static_cast<int64_t>(rank) : *dim;
+    if (result < 0 || result >= static_cast<int64_t>(rank)) {
+      return c10::nullopt;
+    }
+    return result;
+  }
+
+  SizeArg sizeArg(Value* value) {
+    if (auto constant = constantInt(value)) {
+      return *constant < 0 ? SizeArg::infer()
+                           : SizeArg::size(ShapeSymbol::fromStaticSize(
+                                 *constant));
+    }
+    auto it = ints_.find(value);
+    if (it != ints_.end()) {
+      return SizeArg::size(equivalence_.find(it->second));
+    }
+    return SizeArg::unknown();
+  }
+
+  c10::optional<std::vector<SizeArg>> sizeArgs(Value* value) {
+    if (auto ivalue = toIValue(value)) {
+      if (!ivalue->isIntList()) {
+        return c10::nullopt;
+      }
+      std::vector<SizeArg> args;
+      for (int64_t size : ivalue->toIntVector()) {
+        args.push_back(
+            size < 0 ? SizeArg::infer()
+                     : SizeArg::size(ShapeSymbol::fromStaticSize(size)));
+      }
+      return args;
+    }
+    if (value->node()->kind() == prim::ListConstruct) {
+      return fmap(
+          value->node()->inputs(), [&](Value* v) { return sizeArg(v); });
+    }
+    auto it = int_lists_.find(value);
+    if (it != int_lists_.end()) {
+      return fmap(resolve(it->second), SizeArg::size);
+    }
+    return c10::nullopt;
+  }
+
+  // Static int list arguments, of the given length, with a single element
+  // broadcast to all of them like for the int[2] of the schemas.
+  c10::optional<std::vector<int64_t>> constantInts(Value* value, size_t size) {
+    auto ivalue = toIValue(value);
+    if (!ivalue || !ivalue->isIntList()) {
+      return c10::nullopt;
+    }
+    auto ints = ivalue->toIntVector();
+    if (ints.size() == 1) {
+      ints.resize(size, ints[0]);
+    }
+    if (ints.size() != size) {
+      return c10::nullopt;
+    }
+    return ints;
+  }
+
+  // Broadcasting two dimensions does not make them equal since either can be
+  // 1, only a static size other than 1 is known to be the result.
+  ShapeSymbol broadcastDim(ShapeSymbol a, ShapeSymbol b) {
+    if (a == b || isStaticSize(b, 1)) {
+      return a;
+    }
+    if (isStaticSize(a, 1)) {
+      return b;
+    }
+    if (a.is_static()) {
+      return a;
+    }
+    if (b.is_static()) {
+      return b;
+    }
+    return ShapeSymbol::newSymbol();
+  }
+
+  Dims broadcast(const Dims& a, const Dims& b) {
+    Dims result(std::max(a.size(), b.size()), ShapeSymbol::fromStaticSize(1));
+    for (size_t i = 0; i < result.size(); ++i) {
+      auto& dim = result[result.size() - 1 - i];
+      if (i < a.size() && i < b.size()) {
+        dim = broadcastDim(a[a.size() - 1 - i], b[b.size() - 1 - i]);
+      } else {
+        dim = i < a.size() ? a[a.size() - 1 - i] : b[b.size() - 1 - i];
+      }
+    }
+    return result;
+  }
+
+  c10::optional<Dims> matmul(Dims a, Dims b) {
+    if (a.empty() || b.empty()) {
+      return c10::nullopt;
+    }
+    const bool vector_a = a.size() == 1;
+    const bool vector_b = b.size() == 1;
+    if (vector_a) {
+      a.insert(a.begin(), ShapeSymbol::fromStaticSize(1));
+    }
+    if (vector_b) {
+      b.push_back(ShapeSymbol::fromStaticSize(1));
+    }
+    equivalence_.unify(a.back(), b[b.size() - 2]);
+    Dims result = broadcast(
+        Dims(a.begin(), a.end() - 2), Dims(b.begin(), b.end() - 2));
+    if (!vector_a) {
+      result.push_back(a[a.size() - 2]);
+    }
+    if (!vector_b) {
+      result.push_back(b.back());
+    }
+    return result;
+  }
+
+  // Size of the output of a convolution or pooling window along a dimension.
+  ShapeSymbol windowOutput(
+      ShapeSymbol input,
+      ShapeSymbol kernel,
+      int64_t stride,
+      int64_t padding,
+      int64_t dilation) {
+    if (!input.is_static() || !kernel.is_static() || stride <= 0) {
+      return ShapeSymbol::newSymbol();
+    }
+    int64_t size = (input.static_size() + 2 * padding -
+                    dilation * (kernel.static_size() - 1) - 1) /
+            stride +
+        1;
+    return size >= 0 ? ShapeSymbol::fromStaticSize(size)
+                     : ShapeSymbol::newSymbol();
+  }
+
+  c10::optional<Dims> convolution(Node* node) {
+    auto input = dims(node->input(0));
+    auto weight = dims(node->input(1));
+    if (!input || !weight || input->size() != weight->size() ||
+        input->size() < 3) {
+      return c10::nullopt;
+    }
+    const size_t spatial = input->size() - 2;
+    auto stride = constantInts(node->input(3), spatial);
+    auto padding = constantInts(node->input(4), spatial);
+    auto dilation = constantInts(node->input(5), spatial);
+    Dims result = {(*input)[0], (*weight)[0]};
+    for (size_t i = 0; i < spatial; ++i) {
+      if (stride && padding && dilation) {
+        result.push_back(windowOutput(
+            (*input)[i + 2],
+            (*weight)[i + 2],
+            (*stride)[i],
+            (*padding)[i],
+            (*dilation)[i]));
+      } else {
+        result.push_back(ShapeSymbol::newSymbol());
+      }
+    }
+    return result;
+  }
+
+  c10::optional<Dims> pooling(Node* node, size_t spatial, bool has_dilation) {
+    auto input = dims(node->input(0));
+    if (!input || input->size() <= spatial) {
+      return c10::nullopt;
+    }
+    auto kernel = constantInts(node->input(1), spatial);
+    // an empty stride is the kernel size
+    auto stride_list = toIValue(node->input(2));
+    auto stride = stride_list && stride_list->isIntList() &&
+            stride_list->toIntVector().empty()
+        ? kernel
+        : constantInts(node->input(2), spatial);
+    auto padding = constantInts(node->input(3), spatial);
+    auto dilation = has_dilation ? constantInts(node->input(4), spatial)
+                                 : c10::optional<std::vector<int64_t>>(
+                                       std::vector<int64_t>(spatial, 1));
+    auto ceil_mode = toIValue(node->input(has_dilation ? 5 : 4));
+    Dims result(input->begin(), input->end() - spatial);
+    for (size_t i = 0; i < spatial; ++i) {
+      if (kernel && stride && padding && dilation && ceil_mode &&
+          !ceil_mode->toBool()) {
+        result.push_back(windowOutput(
+            (*input)[input->size() - spatial + i],
+            ShapeSymbol::fromStaticSize((*kernel)[i]),
+            (*stride)[i],
+            (*padding)[i],
+            (*dilation)[i]));
+      } else {
+        result.push_back(ShapeSymbol::newSymbol());
+      }
+    }
+    return result;
+  }
+
+  c10::optional<Dims> cat(Node* node) {
+    Node* list = node->input(0)->node();
+    if (list->kind() != prim::ListConstruct || list->inputs().empty()) {
+      return c10::nullopt;
+    }
+    std::vector<Dims> inputs;
+    for (Value* input : list->inputs()) {
+      auto input_dims = dims(input);
+      if (!input_dims ||
+          (!inputs.empty() && input_dims->size() != inputs[0].size())) {
+        return c10::nullopt;
+      }
+      inputs.push_back(*input_dims);
+    }
+    auto dim = constantDim(node->input(1), inputs[0].size());
+    if (!dim) {
+      return c10::nullopt;
+    }
+    Dims result = inputs[0];
+    int64_t total = 0;
+    bool all_static = true;
+    for (const auto& input : inputs) {
+      for (size_t i = 0; i < input.size(); ++i) {
+        if (static_cast<int64_t>(i) != *dim) {
+          equivalence_.unify(result[i], input[i]);
+        }
+      }
+      all_static &= input[*dim].is_static();
+      total += all_static ? input[*dim].static_size() : 0;
+    }
+    if (inputs.size() > 1) {
+      result[*dim] = all_static ? ShapeSymbol::fromStaticSize(total)
+                                : ShapeSymbol::newSymbol();
+    }
+    return resolve(result);
+  }
+
+  c10::optional<Dims> stack(Node* node) {
+    Node* list = node->input(0)->node();
+    if (list->kind() != prim::ListConstruct || list->inputs().empty()) {
+      return c10::nullopt;
+    }
+    auto result = dims(list->input(0));
+    if (!result) {
+      return c10::nullopt;
+    }
+    for (Value* input : list->inputs()) {
+      auto input_dims = dims(input);
+      if (!input_dims || input_dims->size() != result->size()) {
+        return c10::nullopt;
+      }
+      for (size_t i = 0; i < result->size(); ++i) {
+        equivalence_.unify((*result)[i], (*input_dims)[i]);
+      }
+    }
+    auto dim = constantDim(node->input(1), result->size() + 1);
+    if (!dim) {
+      return c10::nullopt;
+    }
+    result = resolve(*result);
+    result->insert(
+        result->begin() + *dim,
+        ShapeSymbol::fromStaticSize(list->inputs().size()));
+    return result;
+  }
+
+  // The size inferred for the -1 of a view is computed from static sizes, or
+  // is the product of the dimensions of the input that the other sizes do not
+  // cancel, as in x.view(x.size(0), -1).
+  c10::optional<Dims> view(
+      const Dims& input,
+      const std::vector<SizeArg>& args) {
+    Dims remaining = input;
+    bool cancellable = true;
+    Dims result;
+    c10::optional<size_t> infer_index;
+    for (const SizeArg& arg : args) {
+      switch (arg.kind) {
+        case SizeArg::Kind::Infer:
+          if (infer_index) {
+            return c10::nullopt;
+          }
+          infer_index = result.size();
+          result.push_back(ShapeSymbol::fromStaticSize(1));
+          break;
+        case SizeArg::Kind::Size: {
+          result.push_back(arg.symbol);
+          auto it = std::find(remaining.begin(), remaining.end(), arg.symbol);
+          if (it != remaining.end()) {
+            remaining.erase(it);
+          } else {
+            cancellable = false;
+          }
+          break;
+        }
+        case SizeArg::Kind::Unknown:
+          cancellable = false;
+          result.push_back(ShapeSymbol::newSymbol());
+          break;
+      }
+    }
+    if (infer_index) {
+      bool all_static = true;
+      int64_t numel = 1;
+      for (ShapeSymbol dim : input) {
+        all_static &= dim.is_static();
+        numel *= all_static ? dim.static_size() : 1;
+      }
+      int64_t other = 1;
+      for (size_t i = 0; i < result.size(); ++i) {
+        if (i != *infer_index) {
+          all_static &= result[i].is_static();
+          other *= all_static ? result[i].static_size() : 1;
+        }
+      }
+      if (all_static && other > 0) {
+        result[*infer_index] = ShapeSymbol::fromStaticSize(numel / other);
+      } else if (cancellable) {
+        result[*infer_index] = product(remaining);
+      } else {
+        result[*infer_index] = ShapeSymbol::newSymbol();
+      }
+    }
+    return result;
+  }
+
+  c10::optional<Dims> reduce(Node* node) {
+    auto input = dims(node->input(0));
+    if (!input) {
+      return c10::nullopt;
+    }
+    if (node->inputs().size() < 3 ||
+        !node->input(1)->type()->isSubtypeOf(ListType::ofInts())) {
+      // full reduction
+      return node->inputs().size() <= 2 ? c10::optional<Dims>(Dims{})
+                                        : c10::nullopt;
+    }
+    auto reduced = toIValue(node->input(1));
+    auto keepdim = toIValue(node->input(2));
+    if (!reduced || !reduced->isIntList() || !keepdim || !keepdim->isBool()) {
+      return c10::nullopt;
+    }
+    // no dimensions means all of them
+    std::vector<bool> is_reduced(
+        input->size(), reduced->toIntVector().empty());
+    for (int64_t dim : reduced->toIntVector()) {
+      dim = dim < 0 ? dim + static_cast<int64_t>(input->size()) : dim;
+      if (dim < 0 || dim >= static_cast<int64_t>(input->size())) {
+        return c10::nullopt;
+      }
+      is_reduced[dim] = true;
+    }
+    Dims result;
+    for (size_t i = 0; i < input->size(); ++i) {
+      if (!is_reduced[i]) {
+        result.push_back((*input)[i]);
+      } else if (keepdim->toBool()) {
+        result.push_back(ShapeSymbol::fromStaticSize(1));
+      }
+    }
+    return result;
+  }
+
+  c10::optional<Dims> computeDims(Node* node) {
+    static const std::unordered_set<Symbol> same_shape_ops = {
+        aten::relu, aten::sigmoid, aten::tanh, aten::gelu, aten::neg, aten::exp,
+        aten::log, aten::abs, aten::sqrt, aten::rsqrt, aten::erf,
+        aten::hardtanh, aten::leaky_relu, aten::elu, aten::hardsigmoid,
+        aten::clamp, aten::sign, aten::floor, aten::ceil, aten::round,
+        aten::clone, aten::contiguous, aten::dropout, aten::softmax,
+        aten::log_softmax, aten::batch_norm, aten::layer_norm,
+        aten::instance_norm, aten::group_norm, aten::to, aten::detach,
+        aten::type_as, aten::reciprocal, aten::masked_fill, aten::threshold,
+        aten::zeros_like, aten::ones_like, aten::rand_like, aten::randn_like,
+        aten::full_like, aten::bitwise_not};
+    static const std::unordered_set<Symbol> broadcasting_ops = {
+        aten::add, aten::sub, aten::mul, aten::div, aten::pow, aten::eq,
+        aten::ne, aten::lt, aten::le, aten::gt, aten::ge, aten::max, aten::min,
+        aten::add_, aten::mul_, aten::sub_, aten::div_, aten::__and__,
+        aten::__or__};
+
+    const Symbol kind = node->kind();
+    if (node->inputs().empty()) {
+      return c10::nullopt;
+    }
+    if (same_shape_ops.count(kind)) {
+      return dims(node->input(0));
+    }
+    if (broadcasting_ops.count(kind)) {
+      auto self = dims(node->input(0));
+      if (!self) {
+        return c10::nullopt;
+      }
+      if (node->inputs().size() < 2 ||
+          !node->input(1)->type()->isSubtypeOf(TensorType::get())) {
+        // ops with a scalar argument, but not the reductions of max and min
+        return node->outputs().size() == 1 &&
+                node->inputs().size() <= 3 &&
+                !(kind == aten::max || kind == aten::min)
+            ? self
+            : c10::nullopt;
+      }
+      auto other = dims(node->input(1));
+      if (!other) {
+        return c10::nullopt;
+      }
+      return broadcast(*self, *other);
+    }
+
+    switch (kind) {
+      case aten::where: {
+        auto cond = dims(node->input(0));
+        if (node->inputs().size() != 3 || !cond) {
+          return c10::nullopt;
+        }
+        auto self = dims(node->input(1));
+        auto other = dims(node->input(2));
+        if (!self || !other) {
+          return c10::nullopt;
+        }
+        return broadcast(*cond, broadcast(*self, *other));
+      }
+      case aten::mm:
+      case aten::bmm:
+      case aten::matmul: {
+        auto self = dims(node->input(0));
+        auto other = dims(node->input(1));
+        if (!self || !other) {
+          return c10::nullopt;
+        }
+        if (kind == aten::bmm && self->size() == 3 && other->size() == 3) {
+          equivalence_.unify((*self)[0], (*other)[0]);
+        }
+        return matmul(*self, *other);
+      }
+      case aten::addmm: {
+        auto mat1 = dims(node->input(1));
+        auto mat2 = dims(node->input(2));
+        if (!mat1 || !mat2 || mat1->size() != 2 || mat2->size() != 2) {
+          return c10::nullopt;
+        }
+        return matmul(*mat1, *mat2);
+      }
+      case aten::linear: {
+        auto input = dims(node->input(0));
+        auto weight = dims(node->input(1));
+        if (!input || !weight || input->empty() || weight->size() != 2) {
+          return c10::nullopt;
+        }
+        equivalence_.unify(input->back(), (*weight)[1]);
+        Dims result = resolve(Dims(input->begin(), input->end() - 1));
+        result.push_back(equivalence_.find((*weight)[0]));
+        return result;
+      }
+      case aten::conv1d:
+      case aten::conv2d:
+      case aten::conv3d:
+        return convolution(node);
+      case aten::max_pool1d:
+        return pooling(node, 1, /*has_dilation=*/true);
+      case aten::max_pool2d:
+        return pooling(node, 2, /*has_dilation=*/true);
+      case aten::max_pool3d:
+        return pooling(node, 3, /*has_dilation=*/true);
+      case aten::avg_pool1d:
+        return pooling(node, 1, /*has_dilation=*/false);
+      case aten::avg_pool2d:
+        return pooling(node, 2, /*has_dilation=*/false);
+      case aten::avg_pool3d:
+        return pooling(node, 3, /*has_dilation=*/false);
+      case aten::adaptive_avg_pool1d:
+      case aten::adaptive_avg_pool2d:
+      case aten::adaptive_avg_pool3d: {
+        auto input = dims(node->input(0));
+        auto output_size = sizeArgs(node->input(1));
+        if (!input || !output_size || output_size->size() > input->size()) {
+          return c10::nullopt;
+        }
+        Dims result(input->begin(), input->end() - output_size->size());
+        for (const SizeArg& arg : *output_size) {
+          result.push_back(
+              arg.kind == SizeArg::Kind::Size ? arg.symbol
+                                              : ShapeSymbol::newSymbol());
+        }
+        return result;
+      }
+      case aten::cat:
+        return cat(node);
+      case aten::stack:
+        return stack(node);
+      case aten::view:
+      case aten::reshape: {
+        auto input = dims(node->input(0));
+        auto args = sizeArgs(node->input(1));
+        if (!input || !args) {
+          return c10::nullopt;
+        }
+        return view(*input, *args);
+      }
+      case aten::flatten: {
+        auto input = dims(node->input(0));
+        if (!input || node->inputs().size() != 3) {
+          return c10::nullopt;
+        }
+        if (input->empty()) {
+          return Dims{ShapeSymbol::fromStaticSize(1)};
+        }
+        auto start = constantDim(node->input(1), input->size());
+        auto end = constantDim(node->input(2), input->size());
+        if (!start || !end || *start > *end) {
+          return c10::nullopt;
+        }
+        Dims result(input->begin(), input->begin() + *start);
+        result.push_back(product(
+            Dims(input->begin() + *start, input->begin() + *end + 1)));
+        result.insert(result.end(), input->begin() + *end + 1, input->end());
+        return result;
+      }
+      case aten::unsqueeze: {
+        auto input = dims(node->input(0));
+        if (!input) {
+          return c10::nullopt;
+        }
+        auto dim = constantDim(node->input(1), input->size() + 1);
+        if (!dim) {
+          return c10::nullopt;
+        }
+        input->insert(input->begin() + *dim, ShapeSymbol::fromStaticSize(1));
+        return input;
+      }
+      case aten::squeeze: {
+        auto input = dims(node->input(0));
+        if (!input) {
+          return c10::nullopt;
+        }
+        c10::optional<int64_t> dim;
+        if (node->inputs().size() == 2) {
+          dim = constantDim(node->input(1), input->size());
+          if (!dim) {
+            return c10::nullopt;
+          }
+        }
+        Dims result;
+        for (size_t i = 0; i < input->size(); ++i) {
+          const bool squeezed_dim = !dim || *dim == static_cast<int64_t>(i);
+          if (!squeezed_dim) {
+            result.push_back((*input)[i]);
+          } else if (!(*input)[i].is_static()) {
+            // could be 1
+            return c10::nullopt;
+          } else if (!isStaticSize((*input)[i], 1)) {
+            result.push_back((*input)[i]);
+          }
+        }
+        return result;
+      }
+      case aten::t:
+      case aten::transpose: {
+        auto input = dims(node->input(0));
+        if (!input) {
+          return c10::nullopt;
+        }
+        if (input->size() < 2) {
+          return input;
+        }
+        c10::optional<int64_t> dim0 = 0;
+        c10::optional<int64_t> dim1 = 1;
+        if (kind == aten::transpose) {
+          dim0 = constantDim(node->input(1), input->size());
+          dim1 = constantDim(node->input(2), input->size());
+        }
+        if (!dim0 || !dim1) {
+          return c10::nullopt;
+        }
+        std::swap((*input)[*dim0], (*input)[*dim1]);
+        return input;
+      }
+      case aten::permute: {
+        auto input = dims(node->input(0));
+        auto order = toIValue(node->input(1));
+        if (!input || !order || !order->isIntList() ||
+            order->toIntVector().size() != input->size()) {
+          return c10::nullopt;
+        }
+        Dims result;
+        for (int64_t dim : order->toIntVector()) {
+          dim = dim < 0 ? dim + static_cast<int64_t>(input->size()) : dim;
+          if (dim < 0 || dim >= static_cast<int64_t>(input->size())) {
+            return c10::nullopt;
+          }
+          result.push_back((*input)[dim]);
+        }
+        return result;
+      }
+      case aten::sum:
+      case aten::mean:
+      case aten::logsumexp:
+        return reduce(node);
+      case aten::select: {
+        auto input = dims(node->input(0));
+        if (!input || input->empty()) {
+          return c10::nullopt;
+        }
+        auto dim = constantDim(node->input(1), input->size());
+        if (!dim) {
+          return c10::nullopt;
+        }
+        input->erase(input->begin() + *dim);
+        return input;
+      }
+      case aten::slice: {
+        auto input = dims(node->input(0));
+        if (!input || input->empty() || node->inputs().size() != 5) {
+          return c10::nullopt;
+        }
+        auto dim = constantDim(node->input(1), input->size());
+        auto start = constantInt(node->input(2));
+        auto end = constantInt(node->input(3));
+        auto step = constantInt(node->input(4));
+        if (!dim) {
+          return c10::nullopt;
+        }
+        // the whole dimension, as in x[:, 1:]
+        const bool whole = start && *start == 0 && step && *step == 1 &&
+            end && *end >= std::numeric_limits<int64_t>::max() / 2;
+        if (!whole) {
+          (*input)[*dim] = ShapeSymbol::newSymbol();
+        }
+        return input;
+      }
+      case aten::index_select: {
+        auto input = dims(node->input(0));
+        auto index = dims(node->input(2));
+        if (!input || !index || index->size() != 1) {
+          return c10::nullopt;
+        }
+        auto dim = constantDim(node->input(1), input->size());
+        if (!dim) {
+          return c10::nullopt;
+        }
+        (*input)[*dim] = (*index)[0];
+        return input;
+      }
+      case aten::embedding: {
+        auto weight = dims(node->input(0));
+        auto indices = dims(node->input(1));
+        if (!weight || !indices || weight->size() != 2) {
+          return c10::nullopt;
+        }
+        indices->push_back((*weight)[1]);
+        return indices;
+      }
+      case aten::expand: {
+        auto input = dims(node->input(0));
+        auto args = sizeArgs(node->input(1));
+        if (!input || !args || args->size() < input->size()) {
+          return c10::nullopt;
+        }
+        Dims result;
+        const size_t offset = args->size() - input->size();
+        for (size_t i = 0; i < args->size(); ++i) {
+          const SizeArg& arg = (*args)[i];
+          if (arg.kind == SizeArg::Kind::Infer && i >= offset) {
+            result.push_back((*input)[i - offset]);
+          } else if (arg.kind == SizeArg::Kind::Size) {
+            result.push_back(arg.symbol);
+          } else {
+            result.push_back(ShapeSymbol::newSymbol());
+          }
+        }
+        return result;
+      }
+      default:
+        return c10::nullopt;
+    }
+  }
+
+  // Tracks the ints that are sizes of tensors, like x.size(0).
+  void processIntNode(Node* node) {
+    if (node->kind() == aten::size && node->inputs().size() == 2) {
+      auto input = dims(node->input(0));
+      if (!input) {
+        return;
+      }
+      if (auto dim = constantDim(node->input(1), input->size())) {
+        ints_[node->output()] = (*input)[*dim];
+      }
+    } else if (node->kind() == aten::size && node->inputs().size() == 1) {
+      if (auto input = dims(node->input(0))) {
+        int_lists_[node->output()] = *input;
+      }
+    } else if (
+        node->kind() == aten::__getitem__ && node->inputs().size() == 2 &&
+        int_lists_.count(node->input(0))) {
+      auto sizes = resolve(int_lists_.at(node->input(0)));
+      auto index = constantDim(node->input(1), sizes.size());
+      if (index) {
+        ints_[node->output()] = sizes[*index];
+      }
+    } else if (
+        node->kind() == prim::ListUnpack && int_lists_.count(node->input())) {
+      auto sizes = resolve(int_lists_.at(node->input()));
+      if (sizes.size() == node->outputs().size()) {
+        for (size_t i = 0; i < sizes.size(); ++i) {
+          ints_[node->outputs()[i]] = sizes[i];
+        }
+      }
+    } else if (
+        (node->kind() == aten::mul || node->kind() == aten::add) &&
+        node->inputs().size() == 2 &&
+        node->output()->type()->isSubtypeOf(IntType::get())) {
+      auto a = sizeArg(node->input(0));
+      auto b = sizeArg(node->input(1));
+      if (a.kind == SizeArg::Kind::Size && b.kind == SizeArg::Kind::Size) {
+        if (node->kind() == aten::mul) {
+          ints_[node->output()] = product({a.symbol, b.symbol});
+        } else if (a.symbol.is_static() && b.symbol.is_static()) {
+          ints_[node->output()] = ShapeSymbol::fromStaticSize(
+              a.symbol.static_size() + b.symbol.static_size());
+        }
+      }
+    }
+  }
+
+  void setDims(Value* value, Dims dims) {
+    shapes_[value] = std::move(dims);
+  }
+
+  // The dimensions equal in a and b are kept, the others get new symbols.
+  c10::optional<Dims> merge(
+      const c10::optional<Dims>& a,
+      const c10::optional<Dims>& b) {
+    if (!a || !b || a->size() != b->size()) {
+      return c10::nullopt;
+    }
+    Dims result;
+    for (size_t i = 0; i < a->size(); ++i) {
+      result.push_back(
+          (*a)[i] == (*b)[i] ? (*a)[i] : ShapeSymbol::newSymbol());
+    }
+    return result;
+  }
+
+  void processIf(Node* node) {
+    processBlock(node->blocks().at(0));
+    processBlock(node->blocks().at(1));
+    for (size_t i = 0; i < node->outputs().size(); ++i) {
+      auto merged = merge(
+          dims(node->blocks().at(0)->outputs()[i]),
+          dims(node->blocks().at(1)->outputs()[i]));
+      if (merged) {
+        setDims(node->outputs()[i], *merged);
+      }
+    }
+  }
+
+  void processLoop(Node* node) {
+    static constexpr size_t kMaxIterations = 3;
+    Block* body = node->blocks().at(0);
+    // the carried values are the inputs after the trip count and the
+    // condition, the block inputs after the iteration number and the block
+    // outputs after the condition
+    const size_t num_carried = node->outputs().size();
+    std::vector<c10::optional<Dims>> carried;
+    for (size_t i = 0; i < num_carried; ++i) {
+      carried.push_back(dims(node->input(i + 2)));
+    }
+    auto processBody = [&]() {
+      for (size_t i = 0; i < num_carried; ++i) {
+        if (carried[i]) {
+          setDims(body->inputs()[i + 1], *carried[i]);
+        } else {
+          shapes_.erase(body->inputs()[i + 1]);
+        }
+      }
+      processBlock(body);
+    };
+    std::vector<bool> changed(num_carried, true);
+    bool converged = false;
+    for (size_t iteration = 0; iteration < kMaxIterations && !converged;
+         ++iteration) {
+      processBody();
+      converged = true;
+      for (size_t i = 0; i < num_carried; ++i) {
+        c10::optional<Dims> current;
+        if (carried[i]) {
+          current = resolve(*carried[i]);
+        }
+        auto merged = merge(current, dims(body->outputs()[i + 1]));
+        changed[i] = merged != current;
+        converged &= !changed[i];
+        carried[i] = merged;
+      }
+    }
+    if (!converged) {
+      // give up on the values whose shapes still change, the body sees the
+      // sizes of their types
+      for (size_t i = 0; i < num_carried; ++i) {
+        if (changed[i]) {
+          carried[i] = c10::nullopt;
+        }
+      }
+      processBody();
+    }
+    for (size_t i = 0; i < num_carried; ++i) {
+      if (carried[i]) {
+        setDims(node->outputs()[i], *carried[i]);
+      }
+    }
+  }
+
+  void processBlock(Block* block) {
+    for (Node* node : block->nodes()) {
+      // loop bodies are processed more than once
+      for (Value* output : node->outputs()) {
+        shapes_.erase(output);
+        ints_.erase(output);
+        int_lists_.erase(output);
+      }
+      if (node->kind() == prim::If) {
+        processIf(node);
+        continue;
+      }
+      if (node->kind() == prim::Loop) {
+        processLoop(node);
+        continue;
+      }
+      if (node->outputs().size() == 1 &&
+          node->output()->type()->cast<TensorType>()) {
+        if (auto result = computeDims(node)) {
+          setDims(node->output(), *result);
+        }
+      } else {
+        processIntNode(node);
+      }
+    }
+  }
+
+  void updateTypes(Block* block) {
+    auto update = [&](Value* value) {
+      auto type = value->type()->cast<TensorType>();
+      if (!type) {
+        return;
+      }
+      auto value_dims = dims(value);
+      if (!value_dims) {
+        return;
+      }
+      if (type->dim() == value_dims->size()) {
+        value->setType(type->withSymbolicShapes(SymbolicShape(*value_dims)));
+      } else {
+        value->setType(TensorType::create(
+            type->scalarType(),
+            type->device(),
+            SymbolicShape(*value_dims),
+            VaryingShape<Stride>(value_dims->size()),
+            type->requiresGrad()));
+      }
+    };
+    for (Value* input : block->inputs()) {
+      update(input);
+    }
+    for (Node* node : block->nodes()) {
+      for (Block* sub_block : node->blocks()) {
+        updateTypes(sub_block);
+      }
+      for (Value* output : node->outputs()) {
+        update(output);
+      }
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  SymbolEquivalence equivalence_;
+  std::unordered_map<Value*, Dims> shapes_;
+  // ints and int lists holding sizes
+  std::unordered_map<Value*, ShapeSymbol> ints_;
+  std::unordered_map<Value*, Dims> int_lists_;
+};
+
+} // namespace
+
+void PropagateSymbolicShapes(const std::shared_ptr<Graph>& graph) {
+  SymbolicShapePropagator(graph).run();
+  GRAPH_DUMP("After PropagateSymbolicShapes: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
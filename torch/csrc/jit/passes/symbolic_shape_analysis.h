@@ -0,0 +1,26 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Propagates the sizes of the tensors as symbolic shapes: each dimension is
+// either a static size or a ShapeSymbol standing for a size unknown until
+// run time, such as a dynamic batch dimension. Unlike PropagateInputShapes,
+// it does not need complete input shapes: the unknown dimensions of the
+// inputs get symbols, and the shape functions of the common aten ops carry
+// them to the outputs (e.g. the first dimension of linear(x, w) is the
+// first dimension of x).
+//
+// The ops also tell which symbols are equal, like the inner dimensions of a
+// matrix product or the dimensions of the inputs of cat besides the
+// concatenated one. Equal symbols are replaced by a single one in the
+// resulting types, so that passes can compare dimensions with ==.
+//
+// Only the sizes of the types are changed; dtypes, devices and strides
+// should be propagated beforehand.
+TORCH_API void PropagateSymbolicShapes(const std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -14,7 +14,103 @@ namespace torch {
 namespace jit {
 
 namespace tensorexpr {
+// Reductions are only lowered for float and double tensors on the CPU, with
+// constant reduction dimensions and no dtype argument.
+static bool isSupportedReduction(Node* node) {
+  auto tt = node->inputs()[0]->type()->cast<TensorType>();
+  if (!tt || !tt->device() || !tt->device()->is_cpu() || !tt->scalarType() ||
+      (*tt->scalarType() != at::kFloat && *tt->scalarType() != at::kDouble)) {
+    return false;
+  }
+  for (size_t i = 1; i < node->inputs().size(); i++) {
+    if (!toIValue(node->inputs()[i])) {
+      return false;
+    }
+  }
+  if (!toIValue(node->inputs().back())->isNone()) {
+    return false;
+  }
+  if (node->kind() == aten::sum) {
+    return node->inputs().size() == 2 || node->inputs().size() == 4;
+  }
+  return node->inputs().size() == 3;
+}
+
+static bool isQuantizedTensor(Value* v) {
+  auto tt = v->type()->cast<TensorType>();
+  return tt && tt->scalarType() && c10::isQIntType(*tt->scalarType());
+}
+
+// Quantized tensors are only supported as per tensor quint8 and qint8 CPU
+// tensors, whose scale and zero point are passed to the kernel. Operators
+// producing them need a constant scale and zero point, which the kernel
+// allocates its outputs with.
+static bool isSupportedQuantizedTensor(Value* v) {
+  auto tt = v->type()->cast<TensorType>();
+  return tt && tt->device() && tt->device()->is_cpu() && tt->scalarType() &&
+      (*tt->scalarType() == at::kQUInt8 || *tt->scalarType() == at::kQInt8);
+}
+
+static bool isSupportedQuantized(Node* node) {
+  static const Symbol quantized_add = Symbol::fromQualString("quantized::add");
+  static const Symbol quantized_add_relu =
+      Symbol::fromQualString("quantized::add_relu");
+  static const Symbol quantized_mul = Symbol::fromQualString("quantized::mul");
+  static const Symbol quantized_hardswish =
+      Symbol::fromQualString("quantized::hardswish");
+
+  size_t numOperands = 0;
+  if (node->kind() == aten::dequantize) {
+    return node->inputs().size() == 1 &&
+        isSupportedQuantizedTensor(node->input(0));
+  } else if (
+      node->kind() == aten::quantize_per_tensor ||
+      node->kind() == quantized_hardswish) {
+    numOperands = 1;
+  } else if (
+      node->kind() == quantized_add || node->kind() == quantized_add_relu ||
+      node->kind() == quantized_mul) {
+    numOperands = 2;
+  } else {
+    return false;
+  }
+  if (node->inputs().size() < numOperands + 2 ||
+      !isSupportedQuantizedTensor(node->output())) {
+    return false;
+  }
+  for (size_t i = 0; i < numOperands; i++) {
+    if (node->kind() == aten::quantize_per_tensor
+            ? isQuantizedTensor(node->input(i))
+            : !isSupportedQuantizedTensor(node->input(i))) {
+      return false;
+    }
+  }
+  // The scale and zero point of the output
+  for (size_t i = numOperands; i < node->inputs().size(); i++) {
+    if (!toIValue(node->input(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool isSupported(Node* node) {
+  if (isSupportedQuantized(node)) {
+    return true;
+  }
+  // Other operators compute on the integer representation of quantized
+  // tensors, without their quantization.
+  for (Value* v : node->inputs()) {
+    if (isQuantizedTensor(v)) {
+      return false;
+    }
+  }
+  for (Value* v : node->outputs()) {
+    if (isQuantizedTensor(v)) {
+      return false;
+    }
+  }
+
   // TODO:
   switch (node->kind()) {
     case aten::add:
@@ -71,6 +167,7 @@ bool isSupported(Node* node) {
     case aten::slice:
     case aten::unsqueeze:
     case aten::frac:
+    case aten::hardswish:
     // TODO: uncomment once we can handle rand+broadcasts
     // case aten::rand_like:
     case aten::_sigmoid_backward:
@@ -82,6 +179,9 @@ bool isSupported(Node* node) {
     case aten::__rshift__:
     case aten::where:
       return true;
+    case aten::sum:
+    case aten::softmax:
+      return isSupportedReduction(node);
     // Operators that can be both elementwise or reductions:
     case aten::min:
     case aten::max:
@@ -115,6 +215,23 @@ bool tensorExprFuserEnabled() {
   return true;
 }
 
+static bool texpr_dynamic_shapes_enabled_ = false;
+void setTensorExprDynamicShapesEnabled(bool val) {
+  texpr_dynamic_shapes_enabled_ = val;
+}
+
+bool tensorExprDynamicShapesEnabled() {
+  static const char* enable_c_str =
+      std::getenv("PYTORCH_TENSOREXPR_DYNAMIC_SHAPES");
+  if (!enable_c_str) {
+    return texpr_dynamic_shapes_enabled_;
+  }
+  if (std::string(enable_c_str) == "0") {
+    return false;
+  }
+  return true;
+}
+
 const Symbol& getTensorExprSymbol() {
   static Symbol s = Symbol::fromQualString("tensorexpr::Group");
   return s;
@@ -139,15 +256,28 @@ value_list sortReverseTopological(
   return result;
 }
 
+// Whether `v` is a tensor that a kernel can be compiled for: a complete
+// tensor, or with dynamic shapes one of known rank, dtype and device.
+bool isSupportedTensor(Value* v) {
+  auto tt = v->type()->cast<TensorType>();
+  if (!tt) {
+    return false;
+  }
+  if (tt->isComplete()) {
+    return true;
+  }
+  return tensorExprDynamicShapesEnabled() && tt->scalarType() &&
+      tt->device() && tt->sizes().size();
+}
+
 bool allShapesAreKnown(Value* v) {
   if (!v->type()->cast<TensorType>()) {
     return true;
   }
-  return v->isCompleteTensor();
+  return isSupportedTensor(v);
 }
 
 bool allShapesAreKnown(Node* node) {
-  // TODO: Relax the checks to support dynamic shapes
   for (torch::jit::Value* output : node->outputs()) {
     if (!allShapesAreKnown(output)) {
       return false;
@@ -195,9 +325,10 @@ bool canHandle(Node* node, AliasDb& aliasDb) {
   }
 
 bool canMerge(Node* consumer, Node* producer, AliasDb& aliasDb) {
-  // Only handle complete tensor types
+  // Only handle tensor types with known shapes, or known ranks if dynamic
+  // shapes are enabled
   for (torch::jit::Value* output : consumer->outputs()) {
-    REQ(output->isCompleteTensor());
+    REQ(isSupportedTensor(output));
   }
 
   // Only fuse within a block
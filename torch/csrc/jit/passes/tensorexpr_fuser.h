@@ -15,6 +15,12 @@ TORCH_API void FuseTensorExprs(std::shared_ptr<Graph>& graph);
 TORCH_API void setTensorExprFuserEnabled(bool val);
 TORCH_API bool tensorExprFuserEnabled();
 
+// When enabled, the fuser also fuses tensors whose sizes aren't known, as
+// long as their rank, dtype and device are; the kernels are then compiled per
+// shape class (see TensorExprKernel).
+TORCH_API void setTensorExprDynamicShapesEnabled(bool val);
+TORCH_API bool tensorExprDynamicShapesEnabled();
+
 namespace tensorexpr {
 TORCH_API bool isSupported(Node* node);
 }
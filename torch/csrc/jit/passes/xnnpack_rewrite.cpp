@@ -1,6 +1,7 @@
 #include <ATen/core/jit_type.h>
 #include <ATen/native/xnnpack/OpContext.h>
 
+#include <torch/csrc/jit/ir/alias_analysis.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/ir/subgraph_matcher.h>
 #include <torch/csrc/jit/passes/constant_pooling.h>
@@ -234,6 +235,166 @@ void fuseReluWithPackedOps(std::shared_ptr<Graph>& graph) {
   rewriter.runOnGraph(graph, torch::jit::graph_rewrite_helper::isClampFusable);
 }
 
+const Symbol& conv2dClampRunSymbol() {
+  static const Symbol symbol =
+      Symbol::fromQualString("prepacked::conv2d_clamp_run");
+  return symbol;
+}
+
+// The ops whose output is channels last when a tensor input is. XNNPACK
+// pooling writes NHWC outputs, and TensorIterator keeps the layout of its
+// inputs.
+bool preservesChannelsLast(const Node* node) {
+  static const std::unordered_set<Symbol> kinds = {
+      aten::relu,
+      aten::sigmoid,
+      aten::tanh,
+      aten::hardtanh,
+      aten::hardsigmoid,
+      aten::clamp,
+      aten::add,
+      aten::sub,
+      aten::mul,
+      aten::div,
+      aten::max_pool2d,
+      aten::avg_pool2d,
+      aten::adaptive_avg_pool2d,
+      Symbol::fromQualString("aten::hardswish")};
+  return kinds.count(node->kind()) || node->kind() == conv2dClampRunSymbol();
+}
+
+// The uses that read channels last tensors as well as contiguous ones.
+bool acceptsChannelsLast(const Use& use) {
+  const Node* user = use.user;
+  switch (user->kind()) {
+    case aten::flatten:
+    case aten::reshape:
+      return use.offset == 0;
+    case prim::ListConstruct:
+      return std::all_of(
+          user->output()->uses().begin(),
+          user->output()->uses().end(),
+          [](const Use& list_use) {
+            return list_use.user->kind() == aten::cat;
+          });
+    default:
+      return false;
+  }
+}
+
+void collectNodes(Block* block, std::vector<Node*>& nodes) {
+  for (Node* node : block->nodes()) {
+    for (Block* sub_block : node->blocks()) {
+      collectNodes(sub_block, nodes);
+    }
+    nodes.push_back(node);
+  }
+}
+
+void keepChannelsLastBetweenPackedOps(std::shared_ptr<Graph>& graph) {
+  // The XNNPACK convolutions run on NHWC activations and convert their
+  // outputs back to the layout of their inputs. Feeding them channels last
+  // activations keeps the outputs in NHWC, so that a run of convolutions,
+  // pointwise ops and pooling is converted once at its inputs and once at
+  // its outputs instead of around every convolution.
+  AliasDb aliasDb(graph);
+  std::vector<Node*> nodes;
+  collectNodes(graph->block(), nodes);
+
+  // The runs of ops on channels last values, as the union of the runs of
+  // their inputs. A run is worth converting if it has more than one XNNPACK
+  // convolution.
+  std::vector<size_t> parents;
+  std::vector<size_t> num_convs;
+  auto find = [&](size_t run) {
+    while (parents[run] != run) {
+      run = parents[run] = parents[parents[run]];
+    }
+    return run;
+  };
+  std::unordered_map<Value*, size_t> runs;
+  std::vector<std::pair<Node*, size_t>> convs;
+  for (Node* node : nodes) {
+    if (!preservesChannelsLast(node) || node->outputs().size() != 1 ||
+        aliasDb.hasWriters(node->output())) {
+      continue;
+    }
+    c10::optional<size_t> run;
+    for (Value* input : node->inputs()) {
+      auto it = runs.find(input);
+      if (it == runs.end()) {
+        continue;
+      }
+      if (!run) {
+        run = find(it->second);
+      } else if (find(it->second) != *run) {
+        num_convs[*run] += num_convs[find(it->second)];
+        parents[find(it->second)] = *run;
+      }
+    }
+    if (!run) {
+      if (node->kind() != conv2dClampRunSymbol()) {
+        continue;
+      }
+      run = parents.size();
+      parents.push_back(*run);
+      num_convs.push_back(0);
+    }
+    if (node->kind() == conv2dClampRunSymbol()) {
+      ++num_convs[*run];
+      convs.emplace_back(node, *run);
+    }
+    runs[node->output()] = *run;
+  }
+
+  // Convert the inputs of the runs to channels last, once per input and
+  // block.
+  std::unordered_map<Block*, std::unordered_map<Value*, Value*>> converted;
+  for (const auto& conv : convs) {
+    Node* node = conv.first;
+    Value* input = node->input(0);
+    if (num_convs[find(conv.second)] < 2 || runs.count(input) ||
+        aliasDb.hasWriters(input)) {
+      continue;
+    }
+    auto& block_converted = converted[node->owningBlock()];
+    auto it = block_converted.find(input);
+    if (it == block_converted.end()) {
+      WithInsertPoint guard(node);
+      Value* channels_last = graph->insert(
+          Symbol::fromQualString("prepacked::to_channels_last_padded"),
+          {input});
+      it = block_converted.emplace(input, channels_last).first;
+    }
+    node->replaceInput(0, it->second);
+  }
+
+  // Convert the outputs of the runs back to contiguous for the other uses.
+  for (Node* node : nodes) {
+    if (node->outputs().size() != 1 || !runs.count(node->output()) ||
+        num_convs[find(runs.at(node->output()))] < 2) {
+      continue;
+    }
+    Value* output = node->output();
+    std::vector<Use> exits;
+    for (const Use& use : output->uses()) {
+      const bool in_run =
+          use.user->outputs().size() == 1 && runs.count(use.user->output());
+      if (!in_run && !acceptsChannelsLast(use)) {
+        exits.push_back(use);
+      }
+    }
+    if (exits.empty()) {
+      continue;
+    }
+    WithInsertPoint guard(node->next());
+    Value* contiguous = graph->insert(aten::contiguous, {output});
+    for (const Use& use : exits) {
+      use.user->replaceInput(use.offset, contiguous);
+    }
+  }
+}
+
 void runCanonicalOptimizations(script::Module& module) {
   auto graph = module.get_method("forward").graph();
   // Not sure if we have models running on mobile that require loop unrolling.
@@ -264,6 +425,11 @@ void fusePrePackedLinearConvWithClamp(script::Module& module) {
   fuseHardtanhWithPackedOps(graph);
 }
 
+void keepChannelsLastBetweenPackedOps(script::Module& module) {
+  auto graph = module.get_method("forward").graph();
+  keepChannelsLastBetweenPackedOps(graph);
+}
+
 void FoldPrePackingOps(script::Module& m) {
   PrePackingOpsFilterFn filter_fn = [](const Node* n) -> bool {
     return (
@@ -301,6 +467,13 @@ script::Module optimizeForMobile(
     removeDropout(cloned_module);
   }
 
+  if (!optimization_blacklist.count(
+          MobileOptimizerType::INSERT_FOLD_PREPACK_OPS) &&
+      !optimization_blacklist.count(
+          MobileOptimizerType::CHANNELS_LAST_PREPACKED_OPS)) {
+    keepChannelsLastBetweenPackedOps(cloned_module);
+  }
+
   return cloned_module;
 }
 
@@ -321,6 +494,11 @@ void fusePrePackedLinearConvWithClamp(script::Module& module) {
       "XNNPACK is not enabled. Please build with USE_XNNPACK=1");
 }
 
+void keepChannelsLastBetweenPackedOps(script::Module& module) {
+  TORCH_INTERNAL_ASSERT(
+      "XNNPACK is not enabled. Please build with USE_XNNPACK=1");
+}
+
 void FoldPrePackingOps(script::Module& m) {
   TORCH_INTERNAL_ASSERT(
       "XNNPACK is not enabled. Please build with USE_XNNPACK=1");
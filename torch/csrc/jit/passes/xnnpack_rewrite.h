@@ -9,13 +9,18 @@ namespace jit {
 enum class MobileOptimizerType : int8_t {
   CONV_BN_FUSION,
   INSERT_FOLD_PREPACK_OPS,
-  REMOVE_DROPOUT
+  REMOVE_DROPOUT,
+  CHANNELS_LAST_PREPACKED_OPS
 };
 
 TORCH_API void insertPrePackedOps(std::shared_ptr<Graph>& graph);
 TORCH_API void insertPrePackedOps(script::Module& module);
 TORCH_API void fusePrePackedLinearConvWithClamp(script::Module& module);
 TORCH_API void FoldPrePackingOps(script::Module& module);
+// Keeps the activations in NHWC between the prepacked convolutions, pooling
+// and pointwise ops of the forward method, converting them only at the
+// boundaries of these runs.
+TORCH_API void keepChannelsLastBetweenPackedOps(script::Module& module);
 TORCH_API script::Module optimizeForMobile(
     const script::Module& module,
     const std::set<MobileOptimizerType>& optimization_blacklist = {});
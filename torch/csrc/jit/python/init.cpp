@@ -4,6 +4,7 @@
 #include <torch/csrc/jit/backends/backend_init.h>
 #include <torch/csrc/jit/codegen/fuser/interface.h>
 #include <torch/csrc/jit/codegen/fuser/kernel_cache.h>
+#include <torch/csrc/jit/codegen/kernel_disk_cache.h>
 #include <torch/csrc/jit/frontend/ir_emitter.h>
 #include <torch/csrc/jit/frontend/tracer.h>
 #include <torch/csrc/jit/ir/irparser.h>
@@ -19,6 +20,7 @@
 #include <torch/csrc/jit/passes/decompose_ops.h>
 #include <torch/csrc/jit/passes/erase_number_types.h>
 #include <torch/csrc/jit/passes/fold_conv_bn.h>
+#include <torch/csrc/jit/passes/fork_independent_branches.h>
 #include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/fuse_linear.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
@@ -27,6 +29,7 @@
 #include <torch/csrc/jit/passes/loop_unrolling.h>
 #include <torch/csrc/jit/passes/lower_graph.h>
 #include <torch/csrc/jit/passes/lower_tuples.h>
+#include <torch/csrc/jit/passes/mkldnn_rewrite.h>
 #include <torch/csrc/jit/passes/normalize_ops.h>
 #include <torch/csrc/jit/passes/onnx.h>
 #include <torch/csrc/jit/passes/onnx/cast_all_constant_to_floating.h>
@@ -52,6 +55,7 @@
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
 #include <torch/csrc/jit/passes/subgraph_rewrite.h>
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <torch/csrc/jit/passes/utils/check_alias_annotation.h>
 #include <torch/csrc/jit/passes/vulkan_rewrite.h>
@@ -69,6 +73,7 @@
 #include <torch/csrc/jit/runtime/jit_exception.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/print_handler.h>
+#include <torch/csrc/jit/runtime/static/init.h>
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/tensorexpr/execution_counter.h>
@@ -186,6 +191,11 @@ void initJITBindings(PyObject* module) {
           [](std::shared_ptr<Graph>& g) {
             return FuseQuantizedAddRelu(g); // overload resolution
           })
+      .def(
+          "_jit_pass_fuse_quantized_producer_add",
+          [](std::shared_ptr<Graph>& g) {
+            return FuseQuantizedProducerAdd(g); // overload resolution
+          })
       .def(
           "_jit_pass_insert_observers",
           [](Module& module,
@@ -328,9 +338,15 @@ void initJITBindings(PyObject* module) {
             }
             PropagateInputShapes(graph);
           })
+      .def("_jit_pass_propagate_symbolic_shapes", PropagateSymbolicShapes)
       .def("_jit_pass_remove_expands", RemoveExpands)
       .def("_jit_pass_erase_number_types", EraseNumberTypes)
       .def("_jit_pass_inline_fork_wait", InlineForkWait)
+      .def(
+          "_jit_pass_fork_independent_branches",
+          &ForkIndependentBranches,
+          py::arg("graph"),
+          py::arg("min_branch_cost") = 2 * kHeavyNodeCost)
       .def("_jit_pass_inline", Inline)
       .def("_jit_pass_prepare_division_for_onnx", PrepareDivisionForONNX)
       .def(
@@ -446,6 +462,20 @@ void initJITBindings(PyObject* module) {
             getBailoutDepth() = depth;
             return old_depth;
           })
+      .def(
+          "_jit_set_max_specialized_plans",
+          [](size_t max_plans) {
+            size_t old_max_plans = getMaxSpecializedPlans();
+            getMaxSpecializedPlans() = max_plans;
+            return old_max_plans;
+          })
+      .def(
+          "_jit_set_plan_promotion_threshold",
+          [](size_t threshold) {
+            size_t old_threshold = getPlanPromotionThreshold();
+            getPlanPromotionThreshold() = threshold;
+            return old_threshold;
+          })
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { getInlineEverythingMode() = enabled; })
@@ -507,6 +537,28 @@ void initJITBindings(PyObject* module) {
           })
       .def("_jit_set_texpr_fuser_enabled", &setTensorExprFuserEnabled)
       .def("_jit_texpr_fuser_enabled", &tensorExprFuserEnabled)
+      .def(
+          "_jit_set_texpr_dynamic_shapes_enabled",
+          &setTensorExprDynamicShapesEnabled)
+      .def(
+          "_jit_texpr_dynamic_shapes_enabled",
+          &tensorExprDynamicShapesEnabled)
+      .def(
+          "_jit_get_te_kernel_cache_size",
+          []() -> int {
+            using namespace torch::jit::tensorexpr;
+            return getTEKernelCacheSize();
+          })
+      .def(
+          "_jit_set_te_kernel_cache_size",
+          [](int cache_size) {
+            using namespace torch::jit::tensorexpr;
+            return getTEKernelCacheSize() = cache_size;
+          })
+      .def("_jit_get_kernel_cache_dir", &getKernelCacheDir)
+      .def("_jit_set_kernel_cache_dir", &setKernelCacheDir)
+      .def("_jit_get_prefetch_tensor_records", &getPrefetchTensorRecords)
+      .def("_jit_set_prefetch_tensor_records", &setPrefetchTensorRecords)
       .def("_jit_texpr_fallback_allowed", &tensorexpr::fallbackAllowed)
       .def("_jit_texpr_set_fallback_allowed", &tensorexpr::setFallbackAllowed)
       .def(
@@ -536,6 +588,11 @@ void initJITBindings(PyObject* module) {
       .def(
           "_jit_pass_fold_prepacking_ops",
           [](script::Module& module) { return FoldPrePackingOps(module); })
+      .def(
+          "_jit_pass_keep_channels_last_between_prepacked_ops",
+          [](script::Module& module) {
+            return keepChannelsLastBetweenPackedOps(module);
+          })
       .def(
           "_jit_pass_optimize_for_mobile",
           [](script::Module& module,
@@ -567,6 +624,26 @@ void initJITBindings(PyObject* module) {
           [](script::Module& module) {
             return vulkanOptimizeForMobile(module);
           })
+      .def(
+          "_jit_pass_mkldnn_insert_prepacked_ops",
+          [](std::shared_ptr<Graph>& graph) {
+            return mkldnnInsertPrePackedOps(graph);
+          })
+      .def(
+          "_jit_pass_mkldnn_insert_prepacked_ops",
+          [](script::Module& module) {
+            return mkldnnInsertPrePackedOps(module);
+          })
+      .def(
+          "_jit_pass_mkldnn_fold_prepacking_ops",
+          [](script::Module& module) {
+            return mkldnnFoldPrePackingOps(module);
+          })
+      .def(
+          "_jit_pass_mkldnn_prepack_frozen_module",
+          [](script::Module& module) {
+            return mkldnnPrepackFrozenModule(module);
+          })
       .def(
           "_jit_pass_onnx_unpack_quantized_weights",
           [](std::shared_ptr<Graph>& graph,
@@ -667,12 +744,24 @@ void initJITBindings(PyObject* module) {
           "execution_plans",
           [](GraphExecutorState& s) { return s.execution_plans; })
       .def_property_readonly(
-          "fallback", [](GraphExecutorState& s) { return s.fallback; });
+          "fallback", [](GraphExecutorState& s) { return s.fallback; })
+      .def_property_readonly("plan_cache_stats", [](GraphExecutorState& s) {
+        return s.plan_cache_stats;
+      });
+
+  py::class_<PlanCacheStats>(m, "PlanCacheStats")
+      .def_readonly("hits", &PlanCacheStats::hits)
+      .def_readonly("misses", &PlanCacheStats::misses)
+      .def_readonly("promotions", &PlanCacheStats::promotions)
+      .def_readonly("evictions", &PlanCacheStats::evictions)
+      .def_readonly("size", &PlanCacheStats::size);
 
   py::class_<PyTorchStreamWriter>(m, "PyTorchFileWriter")
       .def(py::init<std::string>())
       .def(py::init([](const py::object& buffer) {
         auto writer_func = [=](const void* data, size_t size) {
+          // Records may be written without the GIL, see below.
+          py::gil_scoped_acquire acquire;
           auto bytes = py::bytes(reinterpret_cast<const char*>(data), size);
           buffer.attr("write")(std::move(bytes));
           return size;
@@ -685,17 +774,36 @@ void initJITBindings(PyObject* module) {
           [](PyTorchStreamWriter& self,
              const std::string& name,
              const char* data,
-             size_t size) { return self.writeRecord(name, data, size); })
-      .def("write_end_of_file", &PyTorchStreamWriter::writeEndOfFile)
+             size_t size,
+             bool compress) {
+            return self.writeRecord(name, data, size, compress);
+          },
+          py::arg("name"),
+          py::arg("data"),
+          py::arg("size"),
+          py::arg("compress") = false)
+      .def(
+          "write_end_of_file",
+          &PyTorchStreamWriter::writeEndOfFile,
+          py::call_guard<py::gil_scoped_release>())
+      // Writing the storages of a checkpoint, and computing their CRC32,
+      // doesn't need the GIL, so that torch.save_async doesn't hold up the
+      // training loop.
       .def(
           "write_record",
           [](PyTorchStreamWriter& self,
              const std::string& name,
              uintptr_t data,
-             size_t size) {
+             size_t size,
+             bool compress) {
             return self.writeRecord(
-                name, reinterpret_cast<const char*>(data), size);
-          });
+                name, reinterpret_cast<const char*>(data), size, compress);
+          },
+          py::arg("name"),
+          py::arg("data"),
+          py::arg("size"),
+          py::arg("compress") = false,
+          py::call_guard<py::gil_scoped_release>());
 
   py::enum_<MobileOptimizerType>(m, "MobileOptimizerType")
       .value("CONV_BN_FUSION", MobileOptimizerType::CONV_BN_FUSION)
@@ -703,6 +811,9 @@ void initJITBindings(PyObject* module) {
           "INSERT_FOLD_PREPACK_OPS",
           MobileOptimizerType::INSERT_FOLD_PREPACK_OPS)
       .value("REMOVE_DROPOUT", MobileOptimizerType::REMOVE_DROPOUT)
+      .value(
+          "CHANNELS_LAST_PREPACKED_OPS",
+          MobileOptimizerType::CHANNELS_LAST_PREPACKED_OPS)
       .export_values();
 
   // This allows PyTorchStreamReader to read from a Python buffer. It requires
@@ -774,6 +885,7 @@ void initJITBindings(PyObject* module) {
         auto adapter = std::make_unique<BufferAdapter>(std::move(buffer));
         return std::make_unique<PyTorchStreamReader>(std::move(adapter));
       }))
+      .def("set_verify_crc", &PyTorchStreamReader::setVerifyCrc)
       .def(
           "get_record",
           [](PyTorchStreamReader& self, const std::string& key) {
@@ -1043,6 +1155,7 @@ void initJITBindings(PyObject* module) {
   initTreeViewBindings(module);
   initJitScriptBindings(module);
   initJitBackendBindings(module);
+  initStaticRuntimeBindings(module);
 
   setPrintHandler([](const std::string& str) {
     py::gil_scoped_acquire acquire;
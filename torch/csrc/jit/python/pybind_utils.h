@@ -17,6 +17,7 @@
 #include <torch/csrc/jit/python/python_ivalue.h>
 #include <torch/csrc/jit/python/python_tracer.h>
 #include <torch/csrc/jit/resource_guard.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/utils/auto_gil.h>
 #include <torch/csrc/utils/pybind.h>
@@ -76,6 +77,9 @@ struct VISIBILITY_HIDDEN PythonFutureWrapper
 
   py::object wait() {
     fut->wait();
+    if (fut->hasValue()) {
+      synchronizeWithCurrentStreams(*fut, fut->constValue());
+    }
     if (jit::tracer::isTracing()) {
       auto graph = jit::tracer::getTracingState()->graph;
 
@@ -37,10 +37,22 @@ struct ExecutionPlan {
 // They is only valid only right after you call getDebugState() and should never
 // be used again once another GraphExecutor function is called.
 
+// Counters of the plans the profiling executor specializes on the shapes of
+// its inputs. A hit is a call run by a specialized plan, a miss is a call run
+// by the plan used for all the other shapes.
+struct PlanCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t promotions = 0;
+  size_t evictions = 0;
+  size_t size = 0;
+};
+
 struct GraphExecutorState {
   const Graph* graph = nullptr;
   ExecutionPlan fallback; // XXX: members of this field are optional
   std::unordered_map<ArgumentSpec, ExecutionPlan> execution_plans;
+  PlanCacheStats plan_cache_stats;
 };
 
 struct GraphExecutorImplBase;
@@ -87,6 +99,13 @@ TORCH_API std::atomic<bool>& getProfilingMode();
 TORCH_API std::atomic<bool>& getExecutorMode();
 TORCH_API std::atomic<size_t>& getNumProfiledRuns();
 TORCH_API std::atomic<size_t>& getBailoutDepth();
+// Number of versions of a graph the profiling executor specializes on the
+// shapes of the inputs, on top of the one used for the other shapes. 0
+// disables the specialization.
+TORCH_API std::atomic<size_t>& getMaxSpecializedPlans();
+// Number of calls with the same input shapes after which they get their own
+// plan.
+TORCH_API std::atomic<size_t>& getPlanPromotionThreshold();
 TORCH_API bool IsNewExecutorEnabled();
 
 struct TORCH_API GraphOptimizerEnabledGuard {
@@ -3,6 +3,8 @@
 #include <ATen/Parallel.h>
 #include <ATen/core/ivalue.h>
 #include <ATen/record_function.h>
+#include <c10/core/Event.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 #include <c10/core/thread_pool.h>
 #include <c10/util/Exception.h>
 #include <torch/csrc/autograd/edge.h>
@@ -19,6 +21,7 @@
 #include <torch/csrc/jit/runtime/graph_executor.h>
 #include <torch/csrc/jit/runtime/instruction.h>
 #include <torch/csrc/jit/runtime/jit_exception.h>
+#include <torch/csrc/jit/runtime/observer.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/profiling_record.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
@@ -28,6 +31,8 @@
 using torch::distributed::autograd::DistAutogradContainer;
 #endif
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -966,6 +971,67 @@ struct CodeImpl {
   }
 };
 
+namespace {
+
+// Calls f on the tensors in v, including those nested in lists, tuples and
+// dicts.
+template <typename F>
+void forEachTensor(const IValue& v, const F& f) {
+  if (v.isTensor()) {
+    f(v.toTensor());
+  } else if (v.isTuple()) {
+    for (const IValue& elem : v.toTuple()->elements()) {
+      forEachTensor(elem, f);
+    }
+  } else if (v.isList()) {
+    for (const IValue& elem : v.toListRef()) {
+      forEachTensor(elem, f);
+    }
+  } else if (v.isGenericDict()) {
+    for (const auto& entry : v.toGenericDict()) {
+      forEachTensor(entry.value(), f);
+    }
+  }
+}
+
+// Makes the streams of a forked task current while it runs, and restores the
+// previous streams of the thread afterwards.
+struct ForkStreamsGuard {
+  explicit ForkStreamsGuard(const std::vector<c10::Stream>& streams) {
+    prev_streams_.reserve(streams.size());
+    for (const c10::Stream& stream : streams) {
+      c10::impl::VirtualGuardImpl impl(stream.device_type());
+      prev_streams_.push_back(impl.exchangeStream(stream));
+    }
+  }
+
+  ~ForkStreamsGuard() {
+    for (const c10::Stream& stream : prev_streams_) {
+      c10::impl::VirtualGuardImpl impl(stream.device_type());
+      impl.exchangeStream(stream);
+    }
+  }
+
+ private:
+  std::vector<c10::Stream> prev_streams_;
+};
+
+} // namespace
+
+void synchronizeWithCurrentStreams(const Future& future, const IValue& value) {
+  for (const c10::Event& event : future.completionEvents()) {
+    c10::Device device(event.device_type(), event.device_index());
+    c10::impl::VirtualGuardImpl impl(event.device_type());
+    c10::Stream stream = impl.getStream(device);
+    event.block(stream);
+    forEachTensor(value, [&](const at::Tensor& t) {
+      if (t.defined() && t.has_storage() && t.device() == device) {
+        impl.recordDataPtrOnStream(t.storage().data_ptr(), stream);
+      }
+    });
+  }
+}
+
 // InterpreterState state that and used to compute a Code
 struct InterpreterStateImpl : c10::intrusive_ptr_target {
   InterpreterStateImpl(const Code& code) {
@@ -979,6 +1045,10 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
   int64_t stack_start_ = -1;
   c10::intrusive_ptr<Future> future_;
 
+  // Streams from the pool a forked task runs on, one for each CUDA device of
+  // its inputs, see assignForkStreams.
+  std::vector<c10::Stream> fork_streams_;
+
   // this holds all the tensors for this interpreter run
   // we don't bother minimizing the size of this vector, since the extra
   // memory used by the pointers in this will be small
@@ -1111,7 +1181,27 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     *af = ActiveFrame(frames.back());
   }
 
+  // Runs the operator of an OP or OPN instruction with the node hooks of
+  // observer.
+  void runObservedOp(
+      InterpreterObserver& observer,
+      const Instruction& inst,
+      Stack& stack,
+      ActiveFrame* af) {
+    const Node* node = frames.back().function->instructions_source_[af->pc];
+    observer.onNodeStart(node);
+    auto start = std::chrono::steady_clock::now();
+    af->operators[inst.X](stack);
+    auto end = std::chrono::steady_clock::now();
+    observer.onNodeEnd(
+        node,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+  }
+
   bool runImpl(Stack& stack) {
+    ForkStreamsGuard streams_guard(fork_streams_);
+
     // if we have never run before, then we might have to return the
     // stack when we suspend, record where it starts so we return the right
     // stack
@@ -1124,6 +1214,13 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
       stack_start_ = 0;
     }
 
+    // Looked up once per run, the node hooks cost a branch per operator when
+    // no node is sampled.
+    std::shared_ptr<InterpreterObserver> observer =
+        hasInterpreterObserver() ? getInterpreterObserver() : nullptr;
+    const uint32_t node_sampling_period =
+        observer ? observer->nodeSamplingPeriod() : 0;
+
     ActiveFrame af(frames.back());
     try {
       while (true) {
@@ -1148,13 +1245,22 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             runGraphFunction(stack, &f, &af);
           } break;
           case OP:
-
-            af.operators[inst.X](stack);
+            if (C10_UNLIKELY(node_sampling_period != 0) &&
+                sampleInterpreterNode(node_sampling_period)) {
+              runObservedOp(*observer, inst, stack, &af);
+            } else {
+              af.operators[inst.X](stack);
+            }
             ++af.pc;
             break;
           case OPN:
             stack.push_back(inst.N);
-            af.operators[inst.X](stack);
+            if (C10_UNLIKELY(node_sampling_period != 0) &&
+                sampleInterpreterNode(node_sampling_period)) {
+              runObservedOp(*observer, inst, stack, &af);
+            } else {
+              af.operators[inst.X](stack);
+            }
             ++af.pc;
             break;
           case LOAD:
@@ -1263,6 +1369,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               break;
             }
             if (future_) {
+              recordForkStreamEvents();
               auto num_outputs = frames.back().function->n_outputs;
               if (num_outputs == 1) {
                 future_->markCompleted(stack.back());
@@ -1324,6 +1431,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             }
             stack.pop_back();
             stack.emplace_back(future->value());
+            synchronizeWithCurrentStreams(*future, stack.back());
             ++af.pc;
           } break;
           case PROFILE_OP: {
@@ -1435,6 +1543,8 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 forked_fn->get_executor()
                     .getPlanFor(stack, GraphExecutor::getDefaultNumBailOuts())
                     .code);
+            static_cast<InterpreterStateImpl*>(forked_interpreter.pImpl.get())
+                ->assignForkStreams(last(stack, inst.N));
             InterpreterContinuation continuation(
                 forked_interpreter,
                 Stack(stack.end() - inst.N, stack.end()),
@@ -1529,6 +1639,61 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     }
   }
 
+  // Runs this forked task on streams from the pool instead of the current
+  // streams of the thread it lands on, so that the GPU work of parallel forks
+  // overlaps. The pool streams first wait for the work queued so far on the
+  // current streams of the forking thread, which produces the inputs.
+  void assignForkStreams(at::ArrayRef<IValue> inputs) {
+    std::vector<c10::Device> devices;
+    for (const IValue& input : inputs) {
+      forEachTensor(input, [&](const at::Tensor& t) {
+        if (t.defined() && t.is_cuda() &&
+            std::find(devices.begin(), devices.end(), t.device()) ==
+                devices.end()) {
+          devices.push_back(t.device());
+        }
+      });
+    }
+    if (devices.empty()) {
+      return;
+    }
+    c10::impl::VirtualGuardImpl impl(c10::DeviceType::CUDA);
+    for (const c10::Device& device : devices) {
+      c10::Stream stream = impl.getStreamFromGlobalPool(device);
+      c10::Event inputs_ready(c10::DeviceType::CUDA);
+      inputs_ready.record(impl.getStream(device));
+      inputs_ready.block(stream);
+      fork_streams_.push_back(stream);
+    }
+    // the forking thread may free the inputs while the fork still reads them
+    for (const IValue& input : inputs) {
+      forEachTensor(input, [&](const at::Tensor& t) {
+        if (!t.defined() || !t.has_storage()) {
+          return;
+        }
+        for (const c10::Stream& stream : fork_streams_) {
+          if (t.device() == stream.device()) {
+            impl.recordDataPtrOnStream(t.storage().data_ptr(), stream);
+          }
+        }
+      });
+    }
+  }
+
+  // Lets the users of the value of a forked task wait for the work it queued
+  // on its streams, see synchronizeWithCurrentStreams.
+  void recordForkStreamEvents() {
+    if (fork_streams_.empty()) {
+      return;
+    }
+    std::vector<c10::Event> events;
+    for (const c10::Stream& stream : fork_streams_) {
+      events.emplace_back(stream.device_type());
+      events.back().record(stream);
+    }
+    future_->setCompletionEvents(std::move(events));
+  }
+
  public:
   c10::intrusive_ptr<Future> getOrCreateFuture() {
     if (!future_) {
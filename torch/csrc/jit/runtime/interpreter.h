@@ -120,6 +120,13 @@ struct InterpreterContinuation {
 #endif
 };
 
+// Makes the current streams wait for the work that computed the value of
+// `future` on other streams, as a forked task does when its inputs are on CUDA,
+// and keeps the memory of the value from being reused before that work is done.
+TORCH_API void synchronizeWithCurrentStreams(
+    const Future& future,
+    const c10::IValue& value);
+
 // what is the tensors type, including state from the current execution context
 // that modifies how the tensor behaves. For instance if no_grad is enabled
 // this will cause the TensorType to have requires_grad=False.
@@ -0,0 +1,150 @@
+#include <torch/csrc/jit/runtime/observer.h>
+
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <cmath>
+#include <limits>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+std::atomic<bool> has_observer{false};
+
+std::mutex& observerMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::shared_ptr<InterpreterObserver>& observerInstance() {
+  static std::shared_ptr<InterpreterObserver> observer;
+  return observer;
+}
+
+// Bucket i holds the values in (2^(i-1), 2^i]
+size_t bucketIndex(int64_t ns) {
+  size_t index = 0;
+  while (index < LatencyHistogram::kNumBuckets - 2 &&
+         (int64_t(1) << index) < ns) {
+    ++index;
+  }
+  return index;
+}
+
+} // namespace
+
+void setInterpreterObserver(std::shared_ptr<InterpreterObserver> observer) {
+  std::lock_guard<std::mutex> guard(observerMutex());
+  has_observer.store(observer != nullptr, std::memory_order_relaxed);
+  observerInstance() = std::move(observer);
+}
+
+std::shared_ptr<InterpreterObserver> getInterpreterObserver() {
+  std::lock_guard<std::mutex> guard(observerMutex());
+  return observerInstance();
+}
+
+bool hasInterpreterObserver() {
+  return has_observer.load(std::memory_order_relaxed);
+}
+
+bool sampleInterpreterNode(uint32_t period) {
+  if (period == 0) {
+    return false;
+  }
+  thread_local uint32_t countdown = 0;
+  if (countdown == 0 || countdown > period) {
+    countdown = period;
+  }
+  return --countdown == 0;
+}
+
+void LatencyHistogram::add(int64_t ns) {
+  buckets_[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::count() const {
+  return count_.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::sum() const {
+  return sum_.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::percentile(double p) const {
+  int64_t total = 0;
+  std::array<int64_t, kNumBuckets> counts;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = static_cast<int64_t>(std::ceil(p / 100. * total));
+  int64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank && counts[i] > 0) {
+      return int64_t(1) << i;
+    }
+  }
+  return std::numeric_limits<int64_t>::max();
+}
+
+LatencyHistogram& LatencyHistogramObserver::histogram(
+    HistogramMap& map,
+    const std::string& name) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& entry = map[name];
+  if (!entry) {
+    entry = std::make_unique<LatencyHistogram>();
+  }
+  return *entry;
+}
+
+void LatencyHistogramObserver::onMethodEnd(const std::string& name, int64_t ns) {
+  histogram(methods_, name).add(ns);
+}
+
+void LatencyHistogramObserver::onNodeEnd(const Node* node, int64_t ns) {
+  histogram(nodes_, node->kind().toQualString()).add(ns);
+}
+
+const LatencyHistogram* LatencyHistogramObserver::methodHistogram(
+    const std::string& name) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = methods_.find(name);
+  return it != methods_.end() ? it->second.get() : nullptr;
+}
+
+const LatencyHistogram* LatencyHistogramObserver::nodeHistogram(
+    const std::string& kind) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = nodes_.find(kind);
+  return it != nodes_.end() ? it->second.get() : nullptr;
+}
+
+void LatencyHistogramObserver::exportStats(
+    logging::LoggerBase& logger,
+    const std::string& prefix) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto exportMap = [&](const HistogramMap& map, const std::string& group) {
+    for (const auto& entry : map) {
+      const std::string name = prefix + "." + group + "." + entry.first;
+      const auto& histogram = *entry.second;
+      logger.addStatValue(name + ".count", histogram.count());
+      logger.addStatValue(name + ".p50", histogram.percentile(50));
+      logger.addStatValue(name + ".p90", histogram.percentile(90));
+      logger.addStatValue(name + ".p99", histogram.percentile(99));
+    }
+  };
+  exportMap(methods_, "method");
+  exportMap(nodes_, "node");
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/runtime/logging.h>
+
+namespace torch {
+namespace jit {
+
+struct Node;
+
+// Observer of the execution of TorchScript by the interpreter, the
+// equivalent of the caffe2 net and operator observers. It is meant to stay
+// enabled in production: the methods are always observed, which costs two
+// clock reads per call, and the nodes are sampled.
+//
+// The hooks are called from all the threads running TorchScript and have to
+// be thread safe.
+struct TORCH_API InterpreterObserver {
+  // One in node_sampling_period operator nodes is observed, 0 disables the
+  // node hooks.
+  explicit InterpreterObserver(uint32_t node_sampling_period = 0)
+      : node_sampling_period_(node_sampling_period) {}
+  virtual ~InterpreterObserver() = default;
+
+  // A call of a method (a GraphFunction) from outside of TorchScript.
+  virtual void onMethodStart(const std::string& /* name */) {}
+  virtual void onMethodEnd(const std::string& /* name */, int64_t /* ns */) {}
+
+  // A sampled operator node run by the interpreter.
+  virtual void onNodeStart(const Node* /* node */) {}
+  virtual void onNodeEnd(const Node* /* node */, int64_t /* ns */) {}
+
+  uint32_t nodeSamplingPeriod() const {
+    return node_sampling_period_;
+  }
+
+ private:
+  const uint32_t node_sampling_period_;
+};
+
+// Sets the observer of the interpreter, nullptr removes it. The observer is
+// kept alive until the calls that use it return.
+TORCH_API void setInterpreterObserver(
+    std::shared_ptr<InterpreterObserver> observer);
+TORCH_API std::shared_ptr<InterpreterObserver> getInterpreterObserver();
+
+// Cheap check done before getInterpreterObserver.
+TORCH_API bool hasInterpreterObserver();
+
+// Returns true once every period calls on each thread.
+TORCH_API bool sampleInterpreterNode(uint32_t period);
+
+// Histogram of latencies in nanoseconds, with power of two buckets. Adding a
+// value is lock free.
+class TORCH_API LatencyHistogram {
+ public:
+  static constexpr size_t kNumBuckets = 64;
+
+  void add(int64_t ns);
+  int64_t count() const;
+  int64_t sum() const;
+  // Upper bound of the bucket holding the given percentile (in [0, 100]).
+  int64_t percentile(double p) const;
+
+ private:
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_{};
+  std::atomic<int64_t> count_{0};
+  std::atomic<int64_t> sum_{0};
+};
+
+// Keeps a latency histogram per method and per node kind, which can be
+// exported to a logging::LoggerBase.
+class TORCH_API LatencyHistogramObserver : public InterpreterObserver {
+ public:
+  explicit LatencyHistogramObserver(uint32_t node_sampling_period = 0)
+      : InterpreterObserver(node_sampling_period) {}
+
+  void onMethodEnd(const std::string& name, int64_t ns) override;
+  void onNodeEnd(const Node* node, int64_t ns) override;
+
+  // nullptr if not observed yet.
+  const LatencyHistogram* methodHistogram(const std::string& name) const;
+  const LatencyHistogram* nodeHistogram(const std::string& kind) const;
+
+  // Adds the count and the p50, p90 and p99 of each histogram as the stats
+  // "<prefix>.method.<name>.<stat>" and "<prefix>.node.<kind>.<stat>".
+  void exportStats(
+      logging::LoggerBase& logger,
+      const std::string& prefix = "pytorch_runtime.latency_ns") const;
+
+ private:
+  using HistogramMap =
+      std::unordered_map<std::string, std::unique_ptr<LatencyHistogram>>;
+
+  LatencyHistogram& histogram(HistogramMap& map, const std::string& name);
+
+  mutable std::mutex mutex_;
+  HistogramMap methods_;
+  HistogramMap nodes_;
+};
+
+} // namespace jit
+} // namespace torch
@@ -3,7 +3,10 @@
 #include <ATen/core/alias_info.h>
 #include <torch/csrc/jit/frontend/edit_distance.h>
 
+#include <atomic>
 #include <queue>
+#include <sstream>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -13,13 +16,28 @@ namespace jit {
 namespace {
 using OperatorMap =
     std::unordered_map<Symbol, std::vector<std::shared_ptr<Operator>>>;
+
+void checkSpecialCases(const Operator& op);
+
+std::atomic<void (*)()> lookup_hook{nullptr};
+
+// Must be called without holding the registry lock, the hook may register
+// operators.
+void runLookupHook() {
+  if (auto hook = lookup_hook.load(std::memory_order_acquire)) {
+    hook();
+  }
+}
+
 struct OperatorRegistry {
  private:
   std::mutex lock;
   OperatorMap operators;
-  // list of operators whose schema have not yet been parsed, and must
-  // be registered before any call to lookup an operator
-  std::vector<std::shared_ptr<Operator>> to_register;
+  // operators whose schema have not yet been parsed, by name. They are
+  // registered by the first lookup of their name, so that the schemas of the
+  // operators a program does not use are never parsed.
+  std::unordered_map<std::string, std::vector<std::shared_ptr<Operator>>>
+      to_register;
   // Those two maps are used to implement lookupByLiteral, which is needed for
   // the n->match(...) calls. Basically, every function schema is assigned a
   // unique string you can use to match it. However, parsing those strings or
@@ -35,19 +53,39 @@ struct OperatorRegistry {
       operators_by_sig_literal;
 
   // XXX - caller must be holding lock
-  void registerPendingOperators() {
-    for (const auto& op : to_register) {
+  void registerPendingOperators(
+      const std::vector<std::shared_ptr<Operator>>& ops) {
+    for (const auto& op : ops) {
+      checkSpecialCases(*op);
       Symbol sym = Symbol::fromQualString(op->schema().name());
       operators[sym].push_back(op);
       operators_by_sig[canonicalSchemaString(op->schema())] = op;
     }
+  }
+
+  // XXX - caller must be holding lock
+  void registerPendingOperators(const std::string& name) {
+    auto it = to_register.find(name);
+    if (it != to_register.end()) {
+      auto ops = std::move(it->second);
+      to_register.erase(it);
+      registerPendingOperators(ops);
+    }
+  }
+
+  // XXX - caller must be holding lock
+  void registerPendingOperators() {
+    for (const auto& pending : to_register) {
+      registerPendingOperators(pending.second);
+    }
     to_register.clear();
   }
 
  public:
   void registerOperator(Operator&& op) {
+    auto name = op.name();
     std::lock_guard<std::mutex> guard(lock);
-    to_register.push_back(std::make_shared<Operator>(std::move(op)));
+    to_register[name].push_back(std::make_shared<Operator>(std::move(op)));
   }
 
   void deregisterOperator(const FunctionSchema& schema) {
@@ -56,13 +94,21 @@ struct OperatorRegistry {
 
     std::lock_guard<std::mutex> guard(lock);
     // Try removing from pending operators list first
-    auto pending_it = to_register.begin();
-    while (pending_it != to_register.end() && (*pending_it)->schema() != schema)
-      ++pending_it;
-
-    if (pending_it != to_register.end()) {
-      to_register.erase(pending_it);
-      return;
+    auto pending = to_register.find(schema.name());
+    if (pending != to_register.end()) {
+      auto& pending_ops = pending->second;
+      auto pending_it = pending_ops.begin();
+      while (pending_it != pending_ops.end() &&
+             (*pending_it)->schema() != schema)
+        ++pending_it;
+
+      if (pending_it != pending_ops.end()) {
+        pending_ops.erase(pending_it);
+        if (pending_ops.empty()) {
+          to_register.erase(pending);
+        }
+        return;
+      }
     }
 
     // Remove operator from signature map
@@ -94,12 +140,13 @@ struct OperatorRegistry {
   }
 
   const std::shared_ptr<Operator>& lookupByLiteral(const char* name) {
+    runLookupHook();
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
     auto it = operators_by_sig_literal.find(name);
     if (it == operators_by_sig_literal.end()) {
-      auto op_ptr_it =
-          operators_by_sig.find(canonicalSchemaString(parseSchema(name)));
+      auto schema = parseSchema(name);
+      registerPendingOperators(schema.name());
+      auto op_ptr_it = operators_by_sig.find(canonicalSchemaString(schema));
       // Handy debugging code that dumps all operators we know about on mismatch
 #if 0
       if (op_ptr_it == operators_by_sig.end()) {
@@ -119,8 +166,9 @@ struct OperatorRegistry {
   }
 
   const std::vector<std::shared_ptr<Operator>>& getOperators(Symbol name) {
+    runLookupHook();
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    registerPendingOperators(name.toQualString());
     static std::vector<std::shared_ptr<Operator>> empty;
     auto it = operators.find(name);
     if (it != operators.end())
@@ -129,6 +177,7 @@ struct OperatorRegistry {
   }
 
   std::vector<Symbol> findSimilarOperators(Symbol input_op) {
+    runLookupHook();
     std::lock_guard<std::mutex> guard(lock);
     registerPendingOperators();
 
@@ -156,6 +205,7 @@ struct OperatorRegistry {
   }
 
   const std::vector<std::shared_ptr<Operator>> getAllOperators() {
+    runLookupHook();
     std::lock_guard<std::mutex> guard(lock);
     registerPendingOperators();
     std::vector<std::shared_ptr<Operator>> values;
@@ -213,6 +263,7 @@ bool printerHasSpecialCaseFor(Symbol sym) {
       prim::Load, // used in interpreter only
       prim::MMTreeReduce, // used as an optimization
       prim::MMBatchSide, // used as an optimization
+      prim::LinearBatchSide, // used as an optimization
       prim::Store, // used in interpreter only
       prim::profile, // used in interpreter only
 
@@ -253,6 +304,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::GradOf,
       prim::MMTreeReduce,
       prim::MMBatchSide,
+      prim::LinearBatchSide,
       prim::BroadcastSizes,
       prim::ChunkSizes,
       prim::Function,
@@ -294,7 +346,30 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
   return handled.count(symbol) || purposefully_not_handled.count(symbol);
 }
 
-void registerOperator(Operator&& op) {
+namespace {
+// The JIT operators kept by a custom mobile build, the names without overload
+// of the operators used by the selected models, separated by commas. It is
+// only defined by the build when SELECTED_OP_LIST is set. The c10 operators
+// are filtered by the codegen of their registrations already.
+bool isOperatorSelected(const Operator& op) {
+#ifdef TORCH_OPERATOR_WHITELIST
+  static const std::unordered_set<std::string> selected = []() {
+    std::unordered_set<std::string> names;
+    std::istringstream whitelist(TORCH_OPERATOR_WHITELIST);
+    std::string name;
+    while (std::getline(whitelist, name, ',')) {
+      names.insert(name);
+    }
+    return names;
+  }();
+  return op.isC10Op() || selected.count(op.name()) > 0;
+#else
+  return true;
+#endif
+}
+
+// Runs on the first lookup of the operator, as it needs its schema parsed.
+void checkSpecialCases(const Operator& op) {
   if (op.schema().is_varret()) {
     Symbol s = Symbol::fromQualString(op.schema().name());
     if (!printerHasSpecialCaseFor(s)) {
@@ -320,6 +395,13 @@ void registerOperator(Operator&& op) {
           " is special cased and cannot use explicit alias analysis.");
     }
   }
+}
+} // anonymous namespace
+
+void registerOperator(Operator&& op) {
+  if (!isOperatorSelected(op)) {
+    return;
+  }
   getRegistry().registerOperator(std::move(op));
 }
 
@@ -349,6 +431,10 @@ std::vector<Symbol> findSimilarOperators(Symbol input_op) {
   return getRegistry().findSimilarOperators(input_op);
 }
 
+void setOperatorLookupHook(void (*hook)()) {
+  lookup_hook.store(hook, std::memory_order_release);
+}
+
 std::shared_ptr<Operator> getOperatorForLiteral(const char* signature) {
   return getRegistry().lookupByLiteral(signature);
 }
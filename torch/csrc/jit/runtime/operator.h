@@ -141,6 +141,23 @@ struct TORCH_API Operator {
         });
   }
 
+  // The qualified name of the operator, e.g. "aten::add". Unlike
+  // schema().name(), it does not parse the schema.
+  std::string name() const {
+    return op_.fold<std::string>(
+        [](const C10Operator& op) { return op.handle_.schema().name(); },
+        [](const JitOnlyOperator& op) {
+          if (op.schema_.is_left()) {
+            return op.schema_.left().name();
+          }
+          const auto& schema_string = op.schema_.right().schema_string_;
+          auto end = schema_string.find_first_of(".(");
+          auto name = schema_string.substr(0, end);
+          name.erase(name.find_last_not_of(' ') + 1);
+          return name;
+        });
+  }
+
   bool isC10Op() const {
     return op_.is_left();
   }
@@ -209,6 +226,11 @@ TORCH_API std::shared_ptr<Operator> getOperatorForLiteral(
 // This fn is defined in register_c10_ops.cpp
 TORCH_API void ensure_c10_registerer_defined();
 
+// Sets a function the operator registry calls before each lookup, so that
+// operators can be registered on first use instead of during static
+// initialization. The function must be cheap once it has run.
+TORCH_API void setOperatorLookupHook(void (*hook)());
+
 // Used to assert that unschematized operators have an analysis method written
 TORCH_API bool aliasAnalysisHasSpecialCaseFor(c10::Symbol sym);
 
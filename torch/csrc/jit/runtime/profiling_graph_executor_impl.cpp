@@ -23,6 +23,7 @@
 #include <torch/csrc/jit/passes/requires_grad_analysis.h>
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
+#include <torch/csrc/utils/hash.h>
 
 C10_DECLARE_bool();
 
@@ -45,6 +46,8 @@ static std::atomic<bool> profiling_mode{false};
 
 static std::atomic<size_t> num_profiled_runs{1};
 static std::atomic<size_t> bailout_depth{1};
+static std::atomic<size_t> max_specialized_plans{0};
+static std::atomic<size_t> plan_promotion_threshold{2};
 
 std::atomic<bool>& getProfilingMode() {
   return profiling_mode;
@@ -61,6 +64,38 @@ std::atomic<size_t>& getBailoutDepth() {
   return bailout_depth;
 }
 
+std::atomic<size_t>& getMaxSpecializedPlans() {
+  return max_specialized_plans;
+}
+
+std::atomic<size_t>& getPlanPromotionThreshold() {
+  return plan_promotion_threshold;
+}
+
+InputSignature::InputSignature(const Stack& stack, size_t num_inputs) {
+  const bool grad_enabled = autograd::GradMode::is_enabled();
+  for (const IValue& input : last(stack, num_inputs)) {
+    if (!input.isTensor()) {
+      data_.push_back(static_cast<int64_t>(input.type()->kind()));
+      continue;
+    }
+    const at::Tensor& tensor = input.toTensor();
+    data_.push_back(-1);
+    data_.push_back(tensor.defined());
+    if (!tensor.defined()) {
+      continue;
+    }
+    data_.push_back(static_cast<int64_t>(tensor.scalar_type()));
+    data_.push_back(static_cast<int64_t>(tensor.device().type()));
+    data_.push_back(tensor.device().index());
+    data_.push_back(grad_enabled && tensor.requires_grad());
+    data_.push_back(tensor.dim());
+    data_.insert(data_.end(), tensor.sizes().begin(), tensor.sizes().end());
+    data_.insert(data_.end(), tensor.strides().begin(), tensor.strides().end());
+  }
+  hash_ = torch::get_hash(data_);
+}
+
 static bool needsGradientInProfilingMode(Block* b) {
   for (auto n : b->nodes()) {
     if (n->kind() == prim::BailOut) {
@@ -159,8 +194,65 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
   std::lock_guard<std::mutex> lock(compile_mutex);
   GRAPH_DEBUG("Running ProfilingGraphExecutorImpl ", this);
 
-  if (optimized_plan_) {
-    return *optimized_plan_;
+  if (remaining_bailout_depth > 0 && getMaxSpecializedPlans() > 0) {
+    if (auto plan = findSpecializedPlan(stack)) {
+      return getPlanFor(*plan, remaining_bailout_depth);
+    }
+  }
+  return getPlanFor(generic_plan_, remaining_bailout_depth);
+}
+
+ProfilingGraphExecutorImpl::ProfiledPlan* ProfilingGraphExecutorImpl::
+    findSpecializedPlan(const Stack& stack) {
+  InputSignature signature(stack, graph->inputs().size());
+  auto it = specialized_plan_index_.find(signature);
+  if (it != specialized_plan_index_.end()) {
+    plan_cache_stats_.hits++;
+    specialized_plans_.splice(
+        specialized_plans_.begin(), specialized_plans_, it->second);
+    return &it->second->second;
+  }
+
+  // bound the memory used by the shapes seen only a few times
+  if (promotion_candidates_.size() >= 16 * getMaxSpecializedPlans()) {
+    promotion_candidates_.clear();
+  }
+  if (++promotion_candidates_[signature] < getPlanPromotionThreshold()) {
+    plan_cache_stats_.misses++;
+    return nullptr;
+  }
+
+  // Evict the least recently used plans. The plans still profiling are kept
+  // since calls running their profiling plan use their ProfilingRecord.
+  auto victim = specialized_plans_.end();
+  while (specialized_plans_.size() >= getMaxSpecializedPlans() &&
+         victim != specialized_plans_.begin()) {
+    --victim;
+    if (!victim->second.optimized_plan) {
+      continue;
+    }
+    specialized_plan_index_.erase(victim->first);
+    victim = specialized_plans_.erase(victim);
+    plan_cache_stats_.evictions++;
+  }
+  if (specialized_plans_.size() >= getMaxSpecializedPlans()) {
+    plan_cache_stats_.misses++;
+    return nullptr;
+  }
+
+  GRAPH_DEBUG("Specializing a plan of ", this, " on new input shapes");
+  promotion_candidates_.erase(signature);
+  specialized_plans_.emplace_front(signature, ProfiledPlan());
+  specialized_plan_index_.emplace(signature, specialized_plans_.begin());
+  plan_cache_stats_.promotions++;
+  return &specialized_plans_.front().second;
+}
+
+ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
+    ProfiledPlan& plan,
+    size_t remaining_bailout_depth) {
+  if (plan.optimized_plan) {
+    return *plan.optimized_plan;
   }
 
   // simple executor
@@ -168,42 +260,51 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
     auto copy = graph->copy();
     runProfilingInsensitiveOptimizations(copy);
     GRAPH_DUMP("Optimized SimpleExecutor Graph : ", copy);
-    optimized_plan_ = ExecutionPlan(copy, function_name_);
-    return *optimized_plan_;
+    plan.optimized_plan = ExecutionPlan(copy, function_name_);
+    return *plan.optimized_plan;
   }
 
   // if a profiling graph hasn't been created yet
-  if (!pr_) {
+  if (!plan.pr) {
     auto copy = graph->copy();
     runProfilingInsensitiveOptimizations(copy);
     if (remaining_bailout_depth == getBailoutDepth()) {
       PeelProfilingLoops(copy);
     }
-    pr_ = ProfilingRecord::instrumentGraph(copy);
-    auto pr_copy = pr_->graph()->copy();
+    plan.pr = ProfilingRecord::instrumentGraph(copy);
+    auto pr_copy = plan.pr->graph()->copy();
     GRAPH_DUMP("Profiled Graph: ", pr_copy);
-    profiling_plan_ = ExecutionPlan(pr_copy, function_name_);
+    plan.profiling_plan = ExecutionPlan(pr_copy, function_name_);
     // fall-through
   }
 
   // profile until a graph is ready
-  if (!pr_->ready()) {
-    return *profiling_plan_;
+  if (!plan.pr->ready()) {
+    return *plan.profiling_plan;
   }
 
-  auto copy = pr_->graph()->copy();
+  auto copy = plan.pr->graph()->copy();
   runProfilingOptimizations(copy);
   // cache
-  optimized_plan_ =
+  plan.optimized_plan =
       ExecutionPlan(copy, function_name_, remaining_bailout_depth);
-  return *optimized_plan_;
+  return *plan.optimized_plan;
 }
 
 GraphExecutorState ProfilingGraphExecutorImpl::getDebugState() {
+  std::lock_guard<std::mutex> lock(compile_mutex);
   GraphExecutorState state;
-  TORCH_INTERNAL_ASSERT(optimized_plan_);
-  auto opt_plan = *optimized_plan_;
+  // the generic plan, or the most recently used specialized one if all the
+  // calls were specialized
+  const ProfiledPlan* plan = &generic_plan_;
+  if (!plan->optimized_plan && !specialized_plans_.empty()) {
+    plan = &specialized_plans_.front().second;
+  }
+  TORCH_INTERNAL_ASSERT(plan->optimized_plan);
+  auto opt_plan = *plan->optimized_plan;
   state.execution_plans.emplace(ArgumentSpec{0, 0}, opt_plan);
+  state.plan_cache_stats = plan_cache_stats_;
+  state.plan_cache_stats.size = specialized_plans_.size();
   return state;
 }
 
@@ -1,9 +1,36 @@
 #pragma once
 #include <torch/csrc/jit/runtime/graph_executor_impl.h>
 
+#include <list>
+
 namespace torch {
 namespace jit {
 
+// The shapes and types of the inputs of a call, which select its specialized
+// plan. Unlike ArgumentSpec, it holds the sizes and strides of the tensors,
+// which the guards of a profiled plan check.
+struct InputSignature {
+  InputSignature(const Stack& stack, size_t num_inputs);
+
+  bool operator==(const InputSignature& other) const {
+    return hash_ == other.hash_ && data_ == other.data_;
+  }
+
+  size_t hashCode() const {
+    return hash_;
+  }
+
+  struct Hash {
+    size_t operator()(const InputSignature& signature) const {
+      return signature.hashCode();
+    }
+  };
+
+ private:
+  std::vector<int64_t> data_;
+  size_t hash_;
+};
+
 struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   ProfilingGraphExecutorImpl(
       const std::shared_ptr<Graph>& graph,
@@ -15,12 +42,34 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   ~ProfilingGraphExecutorImpl() override = default;
 
  private:
+  // A version of the graph, profiled then optimized.
+  struct ProfiledPlan {
+    std::unique_ptr<ProfilingRecord> pr;
+    c10::optional<ExecutionPlan>
+        profiling_plan; // plan to run in order to profiling the code
+    c10::optional<ExecutionPlan> optimized_plan;
+  };
+  using SpecializedPlans = std::list<std::pair<InputSignature, ProfiledPlan>>;
+
+  ExecutionPlan getPlanFor(ProfiledPlan& plan, size_t remaining_bailout_depth);
+  // The plan specialized on the shapes of the inputs, nullptr if the call
+  // has to use the generic one.
+  ProfiledPlan* findSpecializedPlan(const Stack& stack);
   void runProfilingInsensitiveOptimizations(std::shared_ptr<Graph>& graph);
   void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
-  std::unique_ptr<ProfilingRecord> pr_;
-  c10::optional<ExecutionPlan>
-      profiling_plan_; // plan to run in order to profiling the code
-  c10::optional<ExecutionPlan> optimized_plan_;
+
+  ProfiledPlan generic_plan_;
+  // Most recently used first.
+  SpecializedPlans specialized_plans_;
+  std::unordered_map<
+      InputSignature,
+      SpecializedPlans::iterator,
+      InputSignature::Hash>
+      specialized_plan_index_;
+  // Calls seen per signature not specialized yet.
+  std::unordered_map<InputSignature, size_t, InputSignature::Hash>
+      promotion_candidates_;
+  PlanCacheStats plan_cache_stats_;
 };
 
 } // namespace jit
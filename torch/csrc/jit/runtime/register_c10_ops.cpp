@@ -1,10 +1,13 @@
 #include <ATen/core/ATenOpList.h>
+#include <ATen/core/boxing/impl/make_boxed_from_unboxed_functor.h>
 #include <ATen/core/dispatch/Dispatcher.h>
 #include <ATen/record_function.h>
 #include <torch/csrc/jit/frontend/tracer.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/runtime/operator.h>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 namespace torch {
 namespace jit {
@@ -17,7 +20,7 @@ namespace {
 //      It should also handle autograd.
 Operator createOperatorFromC10_withTracingHandledHere(
     const c10::OperatorHandle& op) {
-  return Operator(op, [op](Stack& stack) {
+  return Operator(op, [op, cached = c10::CachedOperatorHandle(op)](Stack& stack) {
     const auto input_size = op.schema().arguments().size();
     const auto output_size = op.schema().returns().size();
 
@@ -123,10 +126,10 @@ Operator createOperatorFromC10_withTracingHandledHere(
 #ifdef USE_STATIC_DISPATCH
     {
       at::AutoNonVariableTypeMode non_var_type_mode(true);
-      op.callBoxed(&stack);
+      cached.callBoxed(&stack);
     }
 #else
-    op.callBoxed(&stack);
+    cached.callBoxed(&stack);
 #endif // USE_STATIC_DISPATCH
 
     if (tracer_state) {
@@ -160,10 +163,125 @@ Operator createOperatorFromC10_withTracingHandledHere(
   });
 }
 
+// NOTE [Unboxed calls from the interpreter]
+// A boxed call pops the arguments of the operator from the stack in the
+// kernel: the dispatcher first finds the dispatch keys of the arguments on
+// the stack, and then calls the boxed wrapper of the kernel, which converts
+// the arguments to their C++ types and calls the unboxed kernel. For the
+// VariableType kernels, this happens before the redispatch to the backend,
+// which is an unboxed call anyway.
+//
+// For hot operators whose C++ signature is known here, the Operation instead
+// converts the arguments itself and makes an unboxed call, which skips the
+// boxed wrappers and extracts the dispatch keys from the C++ arguments.
+// Kernels that only have a boxed implementation still work, since the
+// dispatcher boxes the arguments again for them.
+
+// Converts an argument on the stack to the C++ type of the signature.
+template <class T>
+struct ArgFromStack final {
+  static decltype(auto) call(IValue&& v) {
+    return c10::impl::ivalue_to_arg<T, /*AllowDeprecatedTypes=*/false>::call(
+        std::move(v));
+  }
+};
+
+// Operators that aren't c10-full take their optional tensors as possibly
+// undefined tensors.
+template <>
+struct ArgFromStack<at::Tensor> final {
+  static at::Tensor call(IValue&& v) {
+    return v.isNone() ? at::Tensor() : std::move(v).toTensor();
+  }
+};
+
+template <class FuncType>
+struct UnboxedTrampoline final {};
+
+template <class Return, class... Args>
+struct UnboxedTrampoline<Return(Args...)> final {
+  static Operation make(const c10::OperatorHandle& op) {
+    return [cached = c10::TypedCachedOperatorHandle<Return(Args...)>(
+                op.typed<Return(Args...)>())](Stack& stack) {
+      call(cached, stack, std::index_sequence_for<Args...>());
+      return 0;
+    };
+  }
+
+ private:
+  template <size_t... indices>
+  static void call(
+      const c10::TypedCachedOperatorHandle<Return(Args...)>& cached,
+      Stack& stack,
+      std::index_sequence<indices...>) {
+    constexpr size_t num_args = sizeof...(Args);
+    // The converted arguments live until the end of the full expression.
+    Return output = cached.call(
+        ArgFromStack<std::decay_t<Args>>::call(
+            std::move(peek(stack, indices, num_args)))...);
+    drop(stack, num_args);
+    push(stack, std::move(output));
+  }
+};
+
+using TrampolineFactory = Operation (*)(const c10::OperatorHandle&);
+
+// The operators called through an UnboxedTrampoline, with their C++
+// signature, as in Functions.h.
+const std::unordered_map<c10::OperatorName, TrampolineFactory>&
+unboxedTrampolines() {
+  using at::Tensor;
+  using c10::IntArrayRef;
+  using c10::Scalar;
+  static const std::unordered_map<c10::OperatorName, TrampolineFactory>
+      trampolines = {
+          {{"aten::add", "Tensor"},
+           &UnboxedTrampoline<Tensor(const Tensor&, const Tensor&, Scalar)>::make},
+          {{"aten::sub", "Tensor"},
+           &UnboxedTrampoline<Tensor(const Tensor&, const Tensor&, Scalar)>::make},
+          {{"aten::mul", "Tensor"},
+           &UnboxedTrampoline<Tensor(const Tensor&, const Tensor&)>::make},
+          {{"aten::div", "Tensor"},
+           &UnboxedTrampoline<Tensor(const Tensor&, const Tensor&)>::make},
+          {{"aten::mm", ""},
+           &UnboxedTrampoline<Tensor(const Tensor&, const Tensor&)>::make},
+          {{"aten::matmul", ""},
+           &UnboxedTrampoline<Tensor(const Tensor&, const Tensor&)>::make},
+          {{"aten::addmm", ""},
+           &UnboxedTrampoline<
+               Tensor(const Tensor&, const Tensor&, const Tensor&, Scalar, Scalar)>::make},
+          {{"aten::linear", ""},
+           &UnboxedTrampoline<
+               Tensor(const Tensor&, const Tensor&, const Tensor&)>::make},
+          {{"aten::conv2d", ""},
+           &UnboxedTrampoline<Tensor(
+               const Tensor&,
+               const Tensor&,
+               const Tensor&,
+               IntArrayRef,
+               IntArrayRef,
+               IntArrayRef,
+               int64_t)>::make},
+          {{"aten::relu", ""}, &UnboxedTrampoline<Tensor(const Tensor&)>::make},
+          {{"aten::sigmoid", ""},
+           &UnboxedTrampoline<Tensor(const Tensor&)>::make},
+          {{"aten::tanh", ""}, &UnboxedTrampoline<Tensor(const Tensor&)>::make},
+      };
+  return trampolines;
+}
+
 Operator createOperatorFromC10_withTracingNotHandledHere(
     const c10::OperatorHandle& op) {
-  return Operator(op, [op](Stack& stack) {
-    op.callBoxed(&stack);
+  // See NOTE [Unboxed calls from the interpreter]
+  const auto& trampolines = unboxedTrampolines();
+  auto it = trampolines.find(op.schema().operator_name());
+  if (it != trampolines.end()) {
+    return Operator(op, it->second(op));
+  }
+  // Every copy of the Operation (i.e. every node that uses it) gets its own
+  // dispatch cache.
+  return Operator(op, [cached = c10::CachedOperatorHandle(op)](Stack& stack) {
+    cached.callBoxed(&stack);
     return 0;
   });
 }
@@ -216,8 +334,10 @@ Registerer& registerer() {
   return registerer;
 }
 
-// global instance to run its constructor on startup
-Registerer& dummy = registerer();
+// The c10 operators are only added to the JIT registry on its first lookup:
+// programs that never use TorchScript don't create their JIT operators.
+C10_UNUSED const bool lookup_hook_set =
+    (setOperatorLookupHook(&ensure_c10_registerer_defined), true);
 
 } // namespace
 
@@ -198,7 +198,11 @@ RegisterOperators reg(
                norm_index > static_cast<int64_t>(tuple->elements().size())) {
              throw std::out_of_range("Tuple list index out of range");
            }
-           stack.emplace_back(tuple->elements()[norm_index]);
+           if (tuple.use_count() == 1) {
+             stack.emplace_back(std::move(tuple->elements()[norm_index]));
+           } else {
+             stack.emplace_back(tuple->elements()[norm_index]);
+           }
            return 0;
          },
          aliasAnalysisSpecialCase()),
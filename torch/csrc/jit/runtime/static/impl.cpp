@@ -0,0 +1,454 @@
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+#include <ATen/ATen.h>
+#include <ATen/TensorUtils.h>
+#include <ATen/core/grad_mode.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/jit/runtime/operator.h>
+#include <torch/csrc/jit/runtime/vararg_functions.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool isTensor(const TypePtr& type) {
+  return type->isSubtypeOf(TensorType::get());
+}
+
+// Returns the out= overload of the operator of `node`, i.e. the one whose
+// schema has the same arguments followed by one written, kwarg-only Tensor
+// argument per output, e.g. aten::add.out for aten::add.Tensor.
+c10::optional<Operation> findOutVariant(const Node* node) {
+  const FunctionSchema* schema = node->maybeSchema();
+  if (!schema || schema->is_mutable() || schema->is_vararg() ||
+      schema->returns().empty()) {
+    return c10::nullopt;
+  }
+  for (const Argument& ret : schema->returns()) {
+    // Outputs that may alias an input can't be written into a buffer.
+    if (ret.alias_info() || !isTensor(ret.type())) {
+      return c10::nullopt;
+    }
+  }
+  const auto& args = schema->arguments();
+  const size_t num_outs = schema->returns().size();
+  for (const auto& op : getAllOperatorsFor(node->kind())) {
+    if (!op->isC10Op()) {
+      continue;
+    }
+    const FunctionSchema& out_schema = op->schema();
+    const auto& out_args = out_schema.arguments();
+    if (out_args.size() != args.size() + num_outs ||
+        out_schema.returns().size() != num_outs) {
+      continue;
+    }
+    bool match = true;
+    for (size_t i = 0; match && i < args.size(); i++) {
+      match = out_args[i].name() == args[i].name() &&
+          *out_args[i].type() == *args[i].type();
+    }
+    for (size_t i = args.size(); match && i < out_args.size(); i++) {
+      const auto& alias_info = out_args[i].alias_info();
+      match = out_args[i].kwarg_only() && alias_info &&
+          alias_info->isWrite() && isTensor(out_args[i].type());
+    }
+    if (match) {
+      return op->getOperation();
+    }
+  }
+  return c10::nullopt;
+}
+
+} // namespace
+
+struct StaticRuntime::ProcessedNode {
+  enum class Kind {
+    Operator,
+    TupleConstruct,
+    ListConstruct,
+    TupleUnpack,
+    ListUnpack,
+  };
+
+  Node* node;
+  Kind kind;
+  std::vector<size_t> inputs;
+  std::vector<size_t> outputs;
+  Operation op;
+  c10::optional<Operation> out_op;
+  // The tensors out_op writes the outputs into, which are backed by an arena,
+  // and their data pointers; empty if the node runs functionally.
+  std::vector<at::Tensor> out_tensors;
+  std::vector<const void*> out_data;
+  ListTypePtr list_type;
+};
+
+// What the memory plan depends on in an input. requires_grad is part of it
+// as outputs that require grad aren't planned: out= kernels don't support
+// autograd.
+struct StaticRuntime::InputSignature {
+  bool is_tensor;
+  at::ScalarType dtype;
+  at::Device device;
+  std::vector<int64_t> sizes;
+  bool requires_grad;
+
+  explicit InputSignature(const IValue& value)
+      : is_tensor(value.isTensor()),
+        dtype(at::kFloat),
+        device(at::kCPU),
+        requires_grad(false) {
+    if (is_tensor && value.toTensor().defined()) {
+      dtype = value.toTensor().scalar_type();
+      device = value.toTensor().device();
+      sizes = value.toTensor().sizes().vec();
+      requires_grad = value.toTensor().requires_grad();
+    }
+  }
+
+  bool operator==(const InputSignature& other) const {
+    return is_tensor == other.is_tensor && dtype == other.dtype &&
+        device == other.device && sizes == other.sizes &&
+        requires_grad == other.requires_grad;
+  }
+};
+
+StaticRuntime::StaticRuntime(
+    std::shared_ptr<Graph> graph,
+    MemoryPlanningStrategy strategy)
+    : graph_(graph->copy()), strategy_(strategy) {
+  init();
+}
+
+StaticRuntime::StaticRuntime(
+    const Module& module,
+    MemoryPlanningStrategy strategy)
+    : graph_(module.get_method("forward").graph()->copy()),
+      strategy_(strategy) {
+  Inline(*graph_);
+  EliminateDeadCode(graph_);
+  TORCH_CHECK(
+      !graph_->inputs().at(0)->hasUses(),
+      "StaticRuntime expects a frozen module, but its forward method uses self");
+  graph_->eraseInput(0);
+  init();
+}
+
+StaticRuntime::StaticRuntime(StaticRuntime&&) noexcept = default;
+StaticRuntime& StaticRuntime::operator=(StaticRuntime&&) noexcept = default;
+StaticRuntime::~StaticRuntime() = default;
+
+void StaticRuntime::init() {
+  Inline(*graph_);
+  ConstantPropagation(graph_);
+  EliminateDeadCode(graph_);
+
+  std::unordered_map<Value*, size_t> value_to_reg;
+  std::vector<Value*> values;
+  auto reg = [&](Value* v) {
+    auto it = value_to_reg.emplace(v, values.size());
+    if (it.second) {
+      values.push_back(v);
+    }
+    return it.first->second;
+  };
+
+  for (Value* input : graph_->inputs()) {
+    input_regs_.push_back(reg(input));
+  }
+  std::vector<std::pair<size_t, IValue>> constants;
+  for (Node* node : graph_->nodes()) {
+    TORCH_CHECK(
+        node->blocks().empty(),
+        "StaticRuntime does not support control flow, found ",
+        node->kind().toQualString());
+    if (node->kind() == prim::Constant) {
+      constants.emplace_back(reg(node->output()), *toIValue(node->output()));
+      continue;
+    }
+
+    ProcessedNode pnode;
+    pnode.node = node;
+    pnode.kind = ProcessedNode::Kind::Operator;
+    for (Value* input : node->inputs()) {
+      pnode.inputs.push_back(reg(input));
+    }
+    for (Value* output : node->outputs()) {
+      pnode.outputs.push_back(reg(output));
+    }
+    if (node->kind() == prim::TupleConstruct &&
+        !node->output()->type()->expect<TupleType>()->name()) {
+      pnode.kind = ProcessedNode::Kind::TupleConstruct;
+    } else if (node->kind() == prim::ListConstruct) {
+      pnode.kind = ProcessedNode::Kind::ListConstruct;
+      pnode.list_type = node->output()->type()->expect<ListType>();
+    } else if (node->kind() == prim::TupleUnpack) {
+      pnode.kind = ProcessedNode::Kind::TupleUnpack;
+    } else if (node->kind() == prim::ListUnpack) {
+      pnode.kind = ProcessedNode::Kind::ListUnpack;
+    } else {
+      TORCH_CHECK(
+          node->maybeOperator(),
+          "StaticRuntime does not support ",
+          node->kind().toQualString());
+      pnode.op = node->getOperation();
+      pnode.out_op = findOutVariant(node);
+    }
+    nodes_.push_back(std::move(pnode));
+  }
+  for (Value* output : graph_->outputs()) {
+    output_regs_.push_back(reg(output));
+  }
+
+  registers_.resize(values.size());
+  is_constant_.assign(values.size(), false);
+  for (auto& constant : constants) {
+    registers_[constant.first] = std::move(constant.second);
+    is_constant_[constant.first] = true;
+  }
+
+  AliasDb alias_db(graph_);
+  const auto live_ranges = ComputeLiveRanges(graph_, alias_db);
+  const size_t num_graph_nodes =
+      std::distance(graph_->nodes().begin(), graph_->nodes().end());
+  live_ranges_.reserve(values.size());
+  escapes_.reserve(values.size());
+  for (Value* v : values) {
+    live_ranges_.push_back(live_ranges.at(v));
+    escapes_.push_back(live_ranges_.back().end == num_graph_nodes);
+  }
+}
+
+std::vector<IValue> StaticRuntime::run(const std::vector<IValue>& inputs) {
+  TORCH_CHECK(
+      inputs.size() == input_regs_.size(),
+      "Expected ",
+      input_regs_.size(),
+      " inputs but got ",
+      inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    registers_[input_regs_[i]] = inputs[i];
+  }
+
+  const bool use_out_variants = planned_ && inputsMatchPlan(inputs);
+  for (auto& pnode : nodes_) {
+    runNode(pnode, use_out_variants);
+  }
+  if (use_out_variants && !outputsStayedInArena()) {
+    planned_ = false;
+  } else if (!use_out_variants) {
+    input_signature_.clear();
+    for (const IValue& input : inputs) {
+      input_signature_.emplace_back(input);
+    }
+    planned_grad_mode_ = at::GradMode::is_enabled();
+    plan();
+  }
+
+  std::vector<IValue> outputs;
+  outputs.reserve(output_regs_.size());
+  for (size_t r : output_regs_) {
+    outputs.push_back(registers_[r]);
+  }
+  // Don't keep inputs and intermediates alive between runs; the planned ones
+  // stay alive in the arenas.
+  for (size_t r = 0; r < registers_.size(); r++) {
+    if (!is_constant_[r]) {
+      registers_[r] = IValue();
+    }
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> StaticRuntime::run(
+    const std::vector<at::Tensor>& inputs) {
+  std::vector<IValue> outputs = run(std::vector<IValue>(inputs.begin(), inputs.end()));
+  std::vector<at::Tensor> result;
+  result.reserve(outputs.size());
+  for (IValue& output : outputs) {
+    TORCH_CHECK(output.isTensor(), "Expected graph outputs to be Tensors");
+    result.push_back(std::move(output).toTensor());
+  }
+  return result;
+}
+
+size_t StaticRuntime::num_out_variant_nodes() const {
+  return std::count_if(
+      nodes_.begin(), nodes_.end(), [](const ProcessedNode& pnode) {
+        return pnode.out_op.has_value();
+      });
+}
+
+size_t StaticRuntime::num_planned_values() const {
+  size_t count = 0;
+  for (const auto& pnode : nodes_) {
+    count += pnode.out_tensors.size();
+  }
+  return count;
+}
+
+size_t StaticRuntime::arena_size() const {
+  size_t size = 0;
+  for (const at::Tensor& arena : arenas_) {
+    size += arena.numel();
+  }
+  return size;
+}
+
+void StaticRuntime::runNode(ProcessedNode& pnode, bool use_out_variant) {
+  stack_.clear();
+  for (size_t r : pnode.inputs) {
+    stack_.push_back(registers_[r]);
+  }
+  switch (pnode.kind) {
+    case ProcessedNode::Kind::TupleConstruct:
+      tupleConstruct(stack_, pnode.inputs.size());
+      break;
+    case ProcessedNode::Kind::ListConstruct:
+      listConstruct(stack_, pnode.list_type, pnode.inputs.size());
+      break;
+    case ProcessedNode::Kind::TupleUnpack:
+      tupleUnpack(stack_);
+      break;
+    case ProcessedNode::Kind::ListUnpack:
+      listUnpack(stack_, pnode.outputs.size());
+      break;
+    case ProcessedNode::Kind::Operator:
+      if (use_out_variant && !pnode.out_tensors.empty()) {
+        for (const at::Tensor& out : pnode.out_tensors) {
+          stack_.push_back(out);
+        }
+        (*pnode.out_op)(stack_);
+      } else {
+        pnode.op(stack_);
+      }
+      break;
+  }
+  TORCH_INTERNAL_ASSERT(stack_.size() == pnode.outputs.size());
+  for (size_t i = 0; i < pnode.outputs.size(); i++) {
+    registers_[pnode.outputs[i]] = std::move(stack_[i]);
+  }
+}
+
+// Plans the outputs of the nodes with an out variant, using their sizes in the
+// functional run that just finished: every device gets an arena in which
+// PlanMemory assigns each output an offset, and the output is then bound to a
+// tensor with the same sizes and strides whose storage is that slot of the
+// arena. The storage doesn't own its memory but has the arena's allocator, so
+// an out= kernel that needs to resize the output moves it out of the arena
+// instead of overwriting its neighbors.
+void StaticRuntime::plan() {
+  std::vector<at::Device> devices;
+  std::vector<std::vector<MemoryRequest>> requests;
+  // For every request, its node and output.
+  std::vector<std::vector<std::pair<ProcessedNode*, size_t>>> owners;
+
+  auto plannable = [&](const ProcessedNode& pnode) {
+    if (!pnode.out_op) {
+      return false;
+    }
+    for (size_t r : pnode.outputs) {
+      const IValue& output = registers_[r];
+      if (escapes_[r] || !output.isTensor()) {
+        return false;
+      }
+      const at::Tensor& t = output.toTensor();
+      // out= kernels don't support autograd.
+      if (!t.defined() || t.layout() != at::kStrided || t.is_quantized() ||
+          t.requires_grad()) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (ProcessedNode& pnode : nodes_) {
+    pnode.out_tensors.clear();
+    pnode.out_data.clear();
+    if (!plannable(pnode)) {
+      continue;
+    }
+    pnode.out_tensors.resize(pnode.outputs.size());
+    pnode.out_data.resize(pnode.outputs.size());
+    for (size_t i = 0; i < pnode.outputs.size(); i++) {
+      const size_t r = pnode.outputs[i];
+      const at::Tensor& t = registers_[r].toTensor();
+      auto it = std::find(devices.begin(), devices.end(), t.device());
+      const size_t d = it - devices.begin();
+      if (it == devices.end()) {
+        devices.push_back(t.device());
+        requests.emplace_back();
+        owners.emplace_back();
+      }
+      const size_t nbytes = at::detail::computeStorageNbytes(
+          t.sizes(), t.strides(), t.dtype().itemsize());
+      requests[d].push_back(MemoryRequest{nbytes, live_ranges_[r]});
+      owners[d].emplace_back(&pnode, i);
+    }
+  }
+
+  arenas_.clear();
+  for (size_t d = 0; d < devices.size(); d++) {
+    const MemoryPlan plan = PlanMemory(requests[d], strategy_);
+    at::Tensor arena = at::empty(
+        {static_cast<int64_t>(plan.total_size)},
+        at::TensorOptions().dtype(at::kByte).device(devices[d]));
+    uint8_t* base = arena.data_ptr<uint8_t>();
+    for (size_t k = 0; k < requests[d].size(); k++) {
+      ProcessedNode& pnode = *owners[d][k].first;
+      const size_t i = owners[d][k].second;
+      const at::Tensor& t = registers_[pnode.outputs[i]].toTensor();
+      void* data = base + plan.offsets[k];
+      auto storage = c10::make_intrusive<c10::StorageImpl>(
+          c10::StorageImpl::use_byte_size_t(),
+          requests[d][k].size,
+          at::DataPtr(data, devices[d]),
+          arena.storage().allocator(),
+          /*resizable=*/true);
+      pnode.out_tensors[i] = at::empty({0}, t.options())
+                                 .set_(
+                                     at::Storage(std::move(storage)),
+                                     /*storage_offset=*/0,
+                                     t.sizes(),
+                                     t.strides());
+      pnode.out_data[i] = data;
+    }
+    arenas_.push_back(std::move(arena));
+  }
+  planned_ = true;
+}
+
+bool StaticRuntime::inputsMatchPlan(const std::vector<IValue>& inputs) const {
+  // Whether outputs require grad also depends on the grad mode.
+  if (at::GradMode::is_enabled() != planned_grad_mode_) {
+    return false;
+  }
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!(InputSignature(inputs[i]) == input_signature_[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StaticRuntime::outputsStayedInArena() const {
+  for (const auto& pnode : nodes_) {
+    for (size_t i = 0; i < pnode.out_tensors.size(); i++) {
+      if (pnode.out_tensors[i].storage().data() != pnode.out_data[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <ATen/core/stack.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// StaticRuntime runs a frozen inference graph (see freeze_module) without
+// going through the interpreter. The graph must be straight-line code: no
+// control flow, no attribute accesses, and only operators that have a JIT
+// Operation.
+//
+// At construction, every Value of the graph is assigned a fixed register, so
+// running a node only copies its inputs out of and its outputs into known
+// slots instead of manipulating one shared Stack. Nodes whose operator has an
+// out= overload (e.g. aten::add.out for aten::add.Tensor) are run through it
+// after the first run: the first run is functional and records the size of
+// every output, which are then given offsets in one arena per device by
+// PlanMemory, using the live ranges from ComputeLiveRanges. Later runs write
+// those outputs into the arena, so they don't allocate. The plan is recomputed
+// whenever the dtype, device or size of a Tensor input changes, or when an
+// output outgrew its slot of the arena.
+//
+// A StaticRuntime holds state between runs, so it must not be run from
+// several threads at once; create one per thread instead.
+class TORCH_API StaticRuntime {
+ public:
+  explicit StaticRuntime(
+      std::shared_ptr<Graph> graph,
+      MemoryPlanningStrategy strategy =
+          MemoryPlanningStrategy::GREEDY_BY_SIZE);
+  // Runs the forward method of `module`, which must be frozen.
+  explicit StaticRuntime(
+      const Module& module,
+      MemoryPlanningStrategy strategy =
+          MemoryPlanningStrategy::GREEDY_BY_SIZE);
+
+  StaticRuntime(StaticRuntime&&) noexcept;
+  StaticRuntime& operator=(StaticRuntime&&) noexcept;
+  ~StaticRuntime();
+
+  // Returns the graph outputs.
+  std::vector<IValue> run(const std::vector<IValue>& inputs);
+  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inputs);
+
+  const std::shared_ptr<Graph>& graph() const {
+    return graph_;
+  }
+
+  // Number of nodes that have an out variant, number of their outputs that
+  // are written into an arena and total size of the arenas in bytes (zero
+  // before the first run).
+  size_t num_out_variant_nodes() const;
+  size_t num_planned_values() const;
+  size_t arena_size() const;
+
+ private:
+  struct ProcessedNode;
+  struct InputSignature;
+
+  void init();
+  void runNode(ProcessedNode& pnode, bool use_out_variant);
+  void plan();
+  bool inputsMatchPlan(const std::vector<IValue>& inputs) const;
+  bool outputsStayedInArena() const;
+
+  std::shared_ptr<Graph> graph_;
+  MemoryPlanningStrategy strategy_;
+  std::vector<ProcessedNode> nodes_;
+  // The value of every Value of the graph, indexed by register.
+  std::vector<IValue> registers_;
+  std::vector<size_t> input_regs_;
+  std::vector<size_t> output_regs_;
+  // Registers holding constants, which are never cleared between runs.
+  std::vector<bool> is_constant_;
+  // The live range of every register, in graph nodes.
+  std::vector<LiveRange> live_ranges_;
+  // Whether a register may alias a graph output; such values aren't planned.
+  std::vector<bool> escapes_;
+
+  bool planned_ = false;
+  std::vector<InputSignature> input_signature_;
+  bool planned_grad_mode_ = false;
+  std::vector<at::Tensor> arenas_;
+  // Reused for every node so that it doesn't reallocate.
+  Stack stack_;
+};
+
+} // namespace jit
+} // namespace torch
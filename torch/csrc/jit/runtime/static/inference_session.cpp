@@ -0,0 +1,208 @@
+#include <torch/csrc/jit/runtime/static/inference_session.h>
+
+#include <ATen/Parallel.h>
+
+namespace torch {
+namespace jit {
+
+InferenceSession::InferenceSession(
+    std::shared_ptr<Graph> graph,
+    InferenceSessionOptions options)
+    : options_(options) {
+  init(std::make_unique<StaticRuntime>(graph, options_.strategy));
+}
+
+InferenceSession::InferenceSession(
+    const Module& module,
+    InferenceSessionOptions options)
+    : options_(options) {
+  init(std::make_unique<StaticRuntime>(module, options_.strategy));
+}
+
+void InferenceSession::init(std::unique_ptr<StaticRuntime> runtime) {
+  if (options_.max_concurrency == 0) {
+    options_.max_concurrency = at::get_num_interop_threads();
+  }
+  TORCH_CHECK(options_.max_concurrency > 0);
+  // The first runtime checks and prepares the graph, the others are built
+  // from its graph, so that the module is only processed once.
+  graph_ = runtime->graph();
+  const auto outputs = graph_->outputs();
+  if (outputs.size() == 1) {
+    output_type_ = outputs[0]->type();
+  } else {
+    std::vector<TypePtr> types;
+    for (Value* output : outputs) {
+      types.push_back(output->type());
+    }
+    output_type_ = TupleType::create(std::move(types));
+  }
+  idle_runtimes_.push_back(std::move(runtime));
+  num_runtimes_ = 1;
+}
+
+InferenceSession::~InferenceSession() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  runtime_idle_.wait(
+      lock, [&] { return idle_runtimes_.size() == num_runtimes_; });
+}
+
+std::vector<IValue> InferenceSession::run(const std::vector<IValue>& inputs) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto runtime = tryAcquireRuntime(lock);
+  if (!runtime) {
+    if (queueFull()) {
+      num_rejected_++;
+      TORCH_CHECK(
+          false,
+          "InferenceSession is overloaded: ",
+          options_.max_queue_size,
+          " requests are already waiting");
+    }
+    num_waiting_++;
+    runtime_idle_.wait(lock, [&] { return !idle_runtimes_.empty(); });
+    num_waiting_--;
+    runtime = std::move(idle_runtimes_.back());
+    idle_runtimes_.pop_back();
+  }
+  lock.unlock();
+
+  std::vector<IValue> outputs;
+  try {
+    outputs = runtime->run(inputs);
+  } catch (...) {
+    lock.lock();
+    releaseRuntime(lock, std::move(runtime));
+    throw;
+  }
+  lock.lock();
+  releaseRuntime(lock, std::move(runtime));
+  return outputs;
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> InferenceSession::runAsync(
+    std::vector<IValue> inputs) {
+  auto future = c10::make_intrusive<c10::ivalue::Future>(output_type_);
+  Request request{std::move(inputs), future};
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto runtime = tryAcquireRuntime(lock);
+  if (!runtime) {
+    if (queueFull()) {
+      num_rejected_++;
+      lock.unlock();
+      future->setError(c10::str(
+          "InferenceSession is overloaded: ",
+          options_.max_queue_size,
+          " requests are already waiting"));
+    } else {
+      queue_.push_back(std::move(request));
+    }
+    return future;
+  }
+  lock.unlock();
+  launch(std::move(runtime), std::move(request));
+  return future;
+}
+
+const std::shared_ptr<Graph>& InferenceSession::graph() const {
+  return graph_;
+}
+
+size_t InferenceSession::num_runtimes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_runtimes_;
+}
+
+size_t InferenceSession::num_rejected() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_rejected_;
+}
+
+// Returns an idle runtime, or a new one if there are less than
+// max_concurrency, or nullptr if the request has to wait.
+std::unique_ptr<StaticRuntime> InferenceSession::tryAcquireRuntime(
+    std::unique_lock<std::mutex>& lock) {
+  if (!idle_runtimes_.empty()) {
+    auto runtime = std::move(idle_runtimes_.back());
+    idle_runtimes_.pop_back();
+    return runtime;
+  }
+  if (num_runtimes_ < options_.max_concurrency) {
+    // Built without holding the lock, which the other requests need.
+    num_runtimes_++;
+    lock.unlock();
+    std::unique_ptr<StaticRuntime> runtime;
+    try {
+      runtime = std::make_unique<StaticRuntime>(graph_, options_.strategy);
+    } catch (...) {
+      lock.lock();
+      num_runtimes_--;
+      throw;
+    }
+    lock.lock();
+    return runtime;
+  }
+  return nullptr;
+}
+
+// Hands `runtime` to the oldest queued request, or makes it idle.
+void InferenceSession::releaseRuntime(
+    std::unique_lock<std::mutex>& lock,
+    std::unique_ptr<StaticRuntime> runtime) {
+  if (!queue_.empty()) {
+    Request request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    launch(std::move(runtime), std::move(request));
+    return;
+  }
+  idle_runtimes_.push_back(std::move(runtime));
+  runtime_idle_.notify_one();
+}
+
+bool InferenceSession::queueFull() const {
+  return queue_.size() + num_waiting_ >= options_.max_queue_size;
+}
+
+void InferenceSession::launch(
+    std::unique_ptr<StaticRuntime> runtime,
+    Request request) {
+  // at::launch takes a std::function, which must be copyable.
+  StaticRuntime* raw_runtime = runtime.release();
+  at::launch([this, raw_runtime, request = std::move(request)]() mutable {
+    drain(std::unique_ptr<StaticRuntime>(raw_runtime), std::move(request));
+  });
+}
+
+// Runs `request` then the queued ones until the queue is empty, so that a
+// busy session does not go back to the thread pool between requests.
+void InferenceSession::drain(
+    std::unique_ptr<StaticRuntime> runtime,
+    Request request) {
+  while (true) {
+    try {
+      auto outputs = runtime->run(request.inputs);
+      if (outputs.size() == 1) {
+        request.future->markCompleted(std::move(outputs[0]));
+      } else {
+        request.future->markCompleted(
+            c10::ivalue::Tuple::create(std::move(outputs)));
+      }
+    } catch (const std::exception& e) {
+      request.future->setError(e.what());
+    }
+    request = Request();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+      idle_runtimes_.push_back(std::move(runtime));
+      runtime_idle_.notify_one();
+      return;
+    }
+    request = std::move(queue_.front());
+    queue_.pop_front();
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+struct InferenceSessionOptions {
+  // Number of StaticRuntimes of the session, i.e. of requests run at once.
+  // Zero means the number of inter-op threads (see at::set_num_interop_threads).
+  size_t max_concurrency = 0;
+  // Number of requests allowed to wait for a runtime. Requests coming while
+  // the queue is full are rejected instead of making every request late.
+  size_t max_queue_size = 64;
+  MemoryPlanningStrategy strategy = MemoryPlanningStrategy::GREEDY_BY_SIZE;
+};
+
+// InferenceSession serves a frozen graph to many threads at once. A
+// StaticRuntime must not be shared between threads, so the session keeps a
+// pool of them, created on demand up to max_concurrency. They are built from
+// one prepared graph, whose constants (the weights of a frozen module) they
+// share, and each keeps its registers and memory plan between the requests it
+// runs, so a request does not pay for any setup.
+//
+// run() executes a request on the calling thread, waiting for a free runtime
+// if needed. runAsync() queues it and executes it on the inter-op thread pool
+// (see at::launch). Either way, a request that would have to wait while
+// max_queue_size requests are already waiting is rejected: run() throws and
+// runAsync() returns a Future completed with an error.
+class TORCH_API InferenceSession {
+ public:
+  explicit InferenceSession(
+      std::shared_ptr<Graph> graph,
+      InferenceSessionOptions options = {});
+  // Serves the forward method of `module`, which must be frozen.
+  explicit InferenceSession(
+      const Module& module,
+      InferenceSessionOptions options = {});
+
+  // Waits for the requests in flight.
+  ~InferenceSession();
+
+  // Returns the graph outputs.
+  std::vector<IValue> run(const std::vector<IValue>& inputs);
+  // The Future holds the output of the graph, or a Tuple of its outputs if it
+  // has several, like Module::forward.
+  c10::intrusive_ptr<c10::ivalue::Future> runAsync(std::vector<IValue> inputs);
+
+  const std::shared_ptr<Graph>& graph() const;
+
+  size_t num_runtimes() const;
+  size_t num_rejected() const;
+
+ private:
+  struct Request {
+    std::vector<IValue> inputs;
+    c10::intrusive_ptr<c10::ivalue::Future> future;
+  };
+
+  void init(std::unique_ptr<StaticRuntime> runtime);
+  std::unique_ptr<StaticRuntime> tryAcquireRuntime(
+      std::unique_lock<std::mutex>& lock);
+  void releaseRuntime(
+      std::unique_lock<std::mutex>& lock,
+      std::unique_ptr<StaticRuntime> runtime);
+  bool queueFull() const;
+  void launch(std::unique_ptr<StaticRuntime> runtime, Request request);
+  void drain(std::unique_ptr<StaticRuntime> runtime, Request request);
+
+  InferenceSessionOptions options_;
+  std::shared_ptr<Graph> graph_;
+  TypePtr output_type_;
+
+  mutable std::mutex mutex_;
+  // Notified when a runtime becomes idle.
+  std::condition_variable runtime_idle_;
+  std::vector<std::unique_ptr<StaticRuntime>> idle_runtimes_;
+  size_t num_runtimes_ = 0;
+  // Requests of runAsync waiting for a runtime.
+  std::deque<Request> queue_;
+  // Callers of run waiting for a runtime.
+  size_t num_waiting_ = 0;
+  size_t num_rejected_ = 0;
+};
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,49 @@
+#include <torch/csrc/jit/runtime/static/init.h>
+#include <torch/csrc/jit/python/pybind_utils.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+namespace torch {
+namespace jit {
+
+void initStaticRuntimeBindings(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  py::class_<StaticRuntime>(m, "StaticRuntime")
+      .def(
+          "run",
+          [](StaticRuntime& self, py::args args) -> py::object {
+            const auto& graph_inputs = self.graph()->inputs();
+            TORCH_CHECK(
+                args.size() == graph_inputs.size(),
+                "Expected ",
+                graph_inputs.size(),
+                " inputs but got ",
+                args.size());
+            std::vector<IValue> inputs;
+            inputs.reserve(args.size());
+            for (size_t i = 0; i < args.size(); i++) {
+              inputs.push_back(toIValue(args[i], graph_inputs[i]->type()));
+            }
+            std::vector<IValue> outputs;
+            {
+              pybind11::gil_scoped_release no_gil;
+              outputs = self.run(inputs);
+            }
+            if (outputs.size() == 1) {
+              return toPyObject(std::move(outputs[0]));
+            }
+            py::tuple result(outputs.size());
+            for (size_t i = 0; i < outputs.size(); i++) {
+              result[i] = toPyObject(std::move(outputs[i]));
+            }
+            return std::move(result);
+          });
+  m.def(
+       "_jit_to_static_runtime",
+       [](const std::shared_ptr<Graph>& g) { return StaticRuntime(g); })
+      .def("_jit_to_static_runtime", [](const Module& module) {
+        return StaticRuntime(module);
+      });
+}
+
+} // namespace jit
+} // namespace torch
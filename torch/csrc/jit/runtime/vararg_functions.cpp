@@ -5,7 +5,18 @@ namespace jit {
 
 void tupleUnpack(Stack& stack) {
   auto tuple = pop(stack).toTuple();
-  stack.insert(stack.end(), tuple->elements().begin(), tuple->elements().end());
+  auto& elements = tuple->elements();
+  // The interpreter moves a value out of its register on its last use, so the
+  // tuple is usually only referenced from here and its elements can be moved
+  // instead of bumping the refcount of each of them.
+  if (tuple.use_count() == 1) {
+    stack.insert(
+        stack.end(),
+        std::make_move_iterator(elements.begin()),
+        std::make_move_iterator(elements.end()));
+  } else {
+    stack.insert(stack.end(), elements.begin(), elements.end());
+  }
 }
 
 void format(Stack& stack, size_t num_inputs) {
@@ -46,7 +57,14 @@ void listUnpack(Stack& stack, size_t num_outputs) {
       num_outputs,
       " elements in a list but found ",
       list.size());
-  stack.insert(stack.end(), list.begin(), list.end());
+  if (list.use_count() == 1) {
+    stack.reserve(stack.size() + num_outputs);
+    for (size_t i = 0; i < num_outputs; ++i) {
+      stack.emplace_back(list.extract(i));
+    }
+  } else {
+    stack.insert(stack.end(), list.begin(), list.end());
+  }
 }
 
 void tupleConstruct(Stack& stack, size_t num_inputs) {
@@ -112,10 +130,17 @@ void isinstance(Stack& stack, at::ArrayRef<at::TypePtr> types) {
 
 void tupleSlice(Stack& stack, size_t begin, size_t end) {
   auto tuple = pop(stack).toTuple();
+  auto& elements = tuple->elements();
   std::vector<IValue> output_elems;
   output_elems.reserve(end - begin);
-  for (size_t i = begin; i < end; ++i) {
-    output_elems.emplace_back(tuple->elements()[i]);
+  if (tuple.use_count() == 1) {
+    output_elems.insert(
+        output_elems.end(),
+        std::make_move_iterator(elements.begin() + begin),
+        std::make_move_iterator(elements.begin() + end));
+  } else {
+    output_elems.insert(
+        output_elems.end(), elements.begin() + begin, elements.begin() + end);
   }
   push(stack, c10::ivalue::Tuple::create(std::move(output_elems)));
 }
@@ -45,6 +45,54 @@ static IValue Table(
   return Tup(std::move(ivalue_entries));
 }
 
+// The interpreter stores every node output to a register and pushes it back
+// for each use, so an output that is used right away by the next node is
+// stored and immediately moved back:
+//   OP 0; STORE 3; MOVE 3; OP 1
+// Such a pair leaves the stack as it was, so drop it, saving the lite
+// interpreter two instructions per value. Jump offsets are relative, so they
+// are recomputed.
+void removeStoreMovePairs(std::vector<Instruction>& instructions) {
+  auto is_jump = [](OpCode op) { return op == JF || op == JMP || op == LOOP; };
+  size_t n = instructions.size();
+  std::vector<bool> is_target(n + 1, false);
+  for (size_t i = 0; i < n; ++i) {
+    if (is_jump(instructions[i].op)) {
+      is_target.at(i + instructions[i].X) = true;
+    }
+  }
+  std::vector<bool> removed(n, false);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    const Instruction& store = instructions[i];
+    const Instruction& move = instructions[i + 1];
+    // A jump to the MOVE expects the value in the register.
+    if (store.op == STORE && move.op == MOVE && store.X == move.X &&
+        !is_target[i + 1]) {
+      removed[i] = removed[i + 1] = true;
+      ++i;
+    }
+  }
+  // new_index[i] is the number of instructions kept before i, so a jump to a
+  // removed instruction goes to the next one kept.
+  std::vector<int32_t> new_index(n + 1, 0);
+  for (size_t i = 0; i < n; ++i) {
+    new_index[i + 1] = new_index[i] + (removed[i] ? 0 : 1);
+  }
+  std::vector<Instruction> kept;
+  kept.reserve(new_index[n]);
+  for (size_t i = 0; i < n; ++i) {
+    if (removed[i]) {
+      continue;
+    }
+    Instruction ins = instructions[i];
+    if (is_jump(ins.op)) {
+      ins.X = new_index[i + ins.X] - new_index[i];
+    }
+    kept.push_back(ins);
+  }
+  instructions = std::move(kept);
+}
+
 c10::IValue getFunctionTuple(const Function& func) {
   auto graph = func.graph()->copy();
   Inline(*graph);
@@ -84,6 +132,8 @@ c10::IValue getFunctionTuple(const Function& func) {
     }
   }
 
+  removeStoreMovePairs(instructions_copy);
+
   // instructions
   std::vector<IValue> instructions;
   instructions.reserve(instructions_copy.size());
@@ -280,6 +330,8 @@ class ScriptModuleSerializer {
 
   void writeByteCode(const Module& module) {
     std::vector<c10::IValue> elements;
+    elements.emplace_back(
+        static_cast<int64_t>(caffe2::serialize::kProducedBytecodeVersion));
     moduleMethodsTuple(module, elements);
     auto telements = Tup(std::move(elements));
     writeArchive("bytecode", telements);
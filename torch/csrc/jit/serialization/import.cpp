@@ -18,9 +18,14 @@
 #include <caffe2/serialize/istream_adapter.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <fmt/format.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -55,6 +60,143 @@ void postSetStateValidate(const IValue& v) {
   }
 }
 
+namespace {
+
+std::atomic<bool> prefetch_tensor_records{false};
+
+// Reads a tensor record. Records that go to a CUDA device are copied there
+// through pinned memory, so that the copy only blocks the calling thread.
+at::DataPtr readTensorRecord(
+    PyTorchStreamReader& reader,
+    const std::string& name,
+    c10::optional<at::Device> device) {
+  at::DataPtr data;
+  size_t size;
+  std::tie(data, size) = reader.getRecord(name);
+  if (!device || !device->is_cuda() || size == 0) {
+    return data;
+  }
+  at::Storage storage(
+      c10::Storage::use_byte_size_t(),
+      size,
+      std::move(data),
+      /*allocator=*/nullptr,
+      /*resizable=*/false);
+  at::Tensor cpu = at::empty({0}, at::kByte)
+                       .set_(storage, 0, {static_cast<int64_t>(size)}, {1});
+  at::Tensor cuda = cpu.pin_memory().to(*device);
+  return cuda.storage().unsafeGetStorageImpl()->set_data_ptr(at::DataPtr());
+}
+
+// Reads the tensor records of an archive on the inter-op thread pool, ahead of
+// the unpickler asking for them, so that reading a record overlaps with
+// unpickling and with reading (and copying to the device) the others. A record
+// that no task has started on yet when it is asked for is read right away by
+// the caller instead, so that loading never waits for a busy pool.
+class RecordPrefetcher {
+ public:
+  RecordPrefetcher(
+      PyTorchStreamReader& reader,
+      const std::vector<std::string>& names,
+      c10::optional<at::Device> device)
+      : reader_(reader), device_(device) {
+    for (const auto& name : names) {
+      auto entry = std::make_shared<Entry>();
+      entries_.emplace(name, entry);
+      at::launch([&reader, name, entry, device]() {
+        run(reader, name, *entry, device);
+      });
+    }
+  }
+
+  ~RecordPrefetcher() {
+    // The tasks use reader_, so cancel the ones that didn't start and wait
+    // for the others.
+    for (auto& kv : entries_) {
+      Entry& entry = *kv.second;
+      std::unique_lock<std::mutex> lock(entry.mutex);
+      if (entry.state == State::PENDING) {
+        entry.state = State::TAKEN;
+      }
+      entry.done.wait(lock, [&] { return entry.state != State::RUNNING; });
+    }
+  }
+
+  at::DataPtr get(const std::string& name) {
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+      return readTensorRecord(reader_, name, device_);
+    }
+    Entry& entry = *it->second;
+    std::unique_lock<std::mutex> lock(entry.mutex);
+    if (entry.state == State::PENDING || entry.state == State::TAKEN) {
+      // Also taken when a record is asked for a second time.
+      entry.state = State::TAKEN;
+      lock.unlock();
+      return readTensorRecord(reader_, name, device_);
+    }
+    entry.done.wait(lock, [&] { return entry.state == State::DONE; });
+    entry.state = State::TAKEN;
+    if (entry.error) {
+      std::rethrow_exception(entry.error);
+    }
+    return std::move(entry.data);
+  }
+
+ private:
+  enum class State { PENDING, RUNNING, DONE, TAKEN };
+
+  struct Entry {
+    std::mutex mutex;
+    std::condition_variable done;
+    State state = State::PENDING;
+    at::DataPtr data;
+    std::exception_ptr error;
+  };
+
+  static void run(
+      PyTorchStreamReader& reader,
+      const std::string& name,
+      Entry& entry,
+      c10::optional<at::Device> device) {
+    {
+      std::lock_guard<std::mutex> guard(entry.mutex);
+      if (entry.state != State::PENDING) {
+        return;
+      }
+      entry.state = State::RUNNING;
+    }
+    at::DataPtr data;
+    std::exception_ptr error;
+    try {
+      data = readTensorRecord(reader, name, device);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> guard(entry.mutex);
+      entry.data = std::move(data);
+      entry.error = error;
+      entry.state = State::DONE;
+    }
+    entry.done.notify_all();
+  }
+
+  PyTorchStreamReader& reader_;
+  c10::optional<at::Device> device_;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+};
+
+} // namespace
+
+void setPrefetchTensorRecords(bool enabled) {
+  prefetch_tensor_records = enabled;
+}
+
+bool getPrefetchTensorRecords() {
+  return prefetch_tensor_records;
+}
+
 IValue readArchiveAndTensors(
     const std::string& archive_name,
     c10::optional<TypeResolver> type_resolver,
@@ -81,8 +223,26 @@ IValue readArchiveAndTensors(
   };
 
   std::string archive_name_plus_slash = archive_name + "/";
+  std::unique_ptr<RecordPrefetcher> prefetcher;
+  if (prefetch_tensor_records) {
+    // getAllRecords includes the directory every record of the file is in.
+    std::vector<std::string> names;
+    for (const auto& record : stream_reader.getAllRecords()) {
+      std::string name = record.substr(record.find('/') + 1);
+      if (name.compare(
+              0, archive_name_plus_slash.size(), archive_name_plus_slash) ==
+          0) {
+        names.push_back(std::move(name));
+      }
+    }
+    prefetcher = torch::make_unique<RecordPrefetcher>(
+        stream_reader, names, device);
+  }
   auto read_record = [&](const std::string& name) {
     std::string ss = archive_name_plus_slash + name;
+    if (prefetcher) {
+      return prefetcher->get(ss);
+    }
     return std::get<0>(stream_reader.getRecord(ss));
   };
 
@@ -60,11 +60,22 @@ TORCH_API Module load(
 /// The reader adapter, which is for customized input stream, must contain a
 /// serialized `Module`, exported either via `ScriptModule.save()` in
 /// Python or `torch::jit::ExportModule` in C++.
+///
+/// With a `caffe2::serialize::MmapFileAdapter`, the file is mapped and the
+/// storages of tensors loaded onto the CPU alias the mapping instead of
+/// holding copies of the data.
 TORCH_API Module load(
     std::unique_ptr<caffe2::serialize::ReadAdapterInterface> rai,
     c10::optional<c10::Device> device = c10::nullopt,
     ExtraFilesMap& extra_files = default_extra_files);
 
+// When enabled, the tensor records of an archive are read on the inter-op
+// thread pool while the archive is unpickled, instead of one after the other
+// as the unpickler reaches them. With a CUDA `device`, the records are also
+// copied to it on the pool, through pinned memory. Disabled by default.
+TORCH_API void setPrefetchTensorRecords(bool enabled);
+TORCH_API bool getPrefetchTensorRecords();
+
 TORCH_API IValue readArchiveAndTensors(
     const std::string& archive_name,
     c10::optional<TypeResolver> type_resolver,
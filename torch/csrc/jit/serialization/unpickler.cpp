@@ -308,7 +308,7 @@ PickleOpCode Unpickler::readInstruction() {
       tuple->elements().reserve(stack_.size() - start);
       auto start_it = stack_.begin() + start;
       for (auto it = start_it; it != stack_.end(); ++it) {
-        tuple->elements().emplace_back(*it);
+        tuple->elements().emplace_back(std::move(*it));
       }
       stack_.erase(start_it, stack_.end());
       stack_.emplace_back(tuple);
@@ -343,8 +343,9 @@ PickleOpCode Unpickler::readInstruction() {
       size_t start = marks_.back();
       marks_.pop_back();
       auto dict = c10::impl::GenericDict(AnyType::get(), AnyType::get());
+      dict.reserve((stack_.size() - start) / 2);
       for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
+        dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
       }
       stack_.erase(stack_.begin() + start, stack_.end());
       stack_.push_back(std::move(dict));
@@ -354,7 +355,7 @@ PickleOpCode Unpickler::readInstruction() {
       marks_.pop_back();
       auto dict = stack_.at(start - 1).toGenericDict();
       for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
+        dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
       }
       stack_.erase(stack_.begin() + start, stack_.end());
     } break;
@@ -367,10 +368,23 @@ PickleOpCode Unpickler::readInstruction() {
     case PickleOpCode::STOP:
       break;
     case PickleOpCode::GLOBAL: {
-      // Module name, it's not needed for anything
-      auto module_name = readString();
-      auto class_name = readString();
-      readGlobal(module_name, class_name);
+      // Every branch of readGlobal pushes one int (a global index or an enum
+      // value) that only depends on the names, so resolve each pair of names
+      // once. global_key_ is reused so that a hit doesn't allocate.
+      global_key_.clear();
+      readString(global_key_);
+      size_t module_size = global_key_.size();
+      global_key_.push_back('\n');
+      readString(global_key_);
+      auto it = global_cache_.find(global_key_);
+      if (it != global_cache_.end()) {
+        stack_.emplace_back(it->second);
+        break;
+      }
+      readGlobal(
+          global_key_.substr(0, module_size),
+          global_key_.substr(module_size + 1));
+      global_cache_.emplace(global_key_, stack_.back().toInt());
     } break;
     case PickleOpCode::NEWOBJ: {
       // pop empty tuple, the actual action is stored in the globals_stack_
@@ -389,7 +403,8 @@ PickleOpCode Unpickler::readInstruction() {
       globals_.at(idx)();
     } break;
     case PickleOpCode::BINPERSID: {
-      auto args = pop(stack_).toTuple()->elements();
+      auto args_tuple = pop(stack_).toTuple();
+      const auto& args = args_tuple->elements();
       AT_ASSERT(
           args.at(0).toStringRef() == "storage",
           "unknown PERSID key ",
@@ -401,6 +416,9 @@ PickleOpCode Unpickler::readInstruction() {
         device = *device_;
       }
       at::DataPtr storage_ptr = read_record_(key);
+      // read_record_ may have copied the data to its device already (see
+      // readArchiveAndTensors).
+      at::Device storage_device = storage_ptr.device();
       int64_t numel = args.at(4).toInt();
       caffe2::TypeMeta dtype = at::CPU(type).typeMeta();
       at::Storage storage(
@@ -413,10 +431,13 @@ PickleOpCode Unpickler::readInstruction() {
       auto options = at::CPU(type).options();
       at::Tensor tensor;
       if (options.backend() == c10::Backend::QuantizedCPU) {
+        TORCH_CHECK(
+            storage_device.type() == DeviceType::CPU,
+            "quantized tensors can only be loaded onto the CPU");
         tensor = at::_empty_affine_quantized({}, options, 0, 0)
                      .set_(storage, 0, {}, {});
       } else {
-        tensor = at::empty({0}, options).set_(storage);
+        tensor = at::empty({0}, options.device(storage_device)).set_(storage);
       }
 
       if (device.type() == DeviceType::CUDA) {
@@ -475,9 +496,9 @@ void Unpickler::readGlobal(
       });
     } else if (class_name == "restore_type_tag") {
       globals_.emplace_back([this] {
-        auto data = stack_.back().toTuple()->elements();
-        auto type_str = data.at(1).toStringRef();
-        stack_.pop_back();
+        auto tuple = pop(stack_).toTuple();
+        auto& data = tuple->elements();
+        const std::string& type_str = data.at(1).toStringRef();
         TypePtr type = nullptr;
         auto entry = type_cache_.find(type_str);
         if (entry != type_cache_.end()) {
@@ -778,8 +799,9 @@ void Unpickler::readList(IValue list_ivalue) {
   } else if (list_ivalue.isList()) {
     auto list = std::move(list_ivalue).toList();
     list.reserve(num_elements);
-    for (const auto& elem : elements) {
-      list.emplace_back(elem);
+    // The elements are erased from the stack below, so move them.
+    for (size_t i = start; i < stack_.size(); ++i) {
+      list.emplace_back(std::move(stack_[i]));
     }
   } else {
     AT_ERROR("Unknown IValue list kind: ", list_ivalue.tagKind());
@@ -793,9 +815,27 @@ inline bool is_valid_python_id_char(char c) {
       (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
-// Read a newline terminated string
-std::string Unpickler::readString() {
-  std::string ss;
+// Read a newline terminated string and append it to `ss`
+void Unpickler::readString(std::string& ss) {
+  // Fast path: the whole string is in the buffer.
+  const char* begin = buffer_.data() + buffer_pos_;
+  const char* end =
+      static_cast<const char*>(memchr(begin, '\n', buffer_remaining_));
+  if (end != nullptr) {
+    for (const char* c = begin; c != end; ++c) {
+      TORCH_CHECK(
+          is_valid_python_id_char(*c),
+          "Found character '",
+          int(uint8_t(*c)),
+          "' in string, ",
+          "strings must be qualified Python identifiers");
+    }
+    ss.append(begin, end);
+    size_t consumed = end - begin + 1;
+    buffer_pos_ += consumed;
+    buffer_remaining_ -= consumed;
+    return;
+  }
   while (true) {
     char c = read<char>();
     if (c == '\n') {
@@ -811,7 +851,6 @@ std::string Unpickler::readString() {
         "' in string, ",
         "strings must be qualified Python identifiers");
   }
-  return ss;
 }
 
 } // namespace jit
@@ -103,7 +103,7 @@ class Unpickler {
   PickleOpCode readOpCode() {
     return static_cast<PickleOpCode>(read<uint8_t>());
   }
-  std::string readString();
+  void readString(std::string& ss);
   void readList(IValue list_ivalue);
   void setInput(size_t memo_id);
   void run();
@@ -121,6 +121,9 @@ class Unpickler {
   // globals are represented on the stack as IValue integer indices
   // into this list
   std::vector<std::function<void(void)>> globals_;
+  // What readGlobal pushed for each "module\nclass" pair seen so far.
+  std::unordered_map<std::string, int64_t> global_cache_;
+  std::string global_key_;
   std::vector<IValue> memo_table_;
   std::vector<size_t> marks_;
   const std::vector<at::Tensor>* tensor_table_;
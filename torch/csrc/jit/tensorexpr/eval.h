@@ -775,6 +775,8 @@ class SimpleIREvaluator : public CodeGen, public IRVisitor {
         return std::floor(v);
       case kRound:
         return std::round(v);
+      case kRint:
+        return std::nearbyint(v);
       case kTrunc:
         return std::trunc(v);
       case kLgamma:
@@ -172,6 +172,10 @@ ExprHandle round(const ExprHandle& v) {
   return Intrinsics::make(kRound, v);
 }
 
+ExprHandle rint(const ExprHandle& v) {
+  return Intrinsics::make(kRint, v);
+}
+
 ExprHandle trunc(const ExprHandle& v) {
   return Intrinsics::make(kTrunc, v);
 }
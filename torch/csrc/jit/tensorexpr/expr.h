@@ -295,6 +295,7 @@ TORCH_API ExprHandle rsqrt(const ExprHandle& v);
 TORCH_API ExprHandle ceil(const ExprHandle& v);
 TORCH_API ExprHandle floor(const ExprHandle& v);
 TORCH_API ExprHandle round(const ExprHandle& v);
+TORCH_API ExprHandle rint(const ExprHandle& v);
 TORCH_API ExprHandle trunc(const ExprHandle& v);
 TORCH_API ExprHandle frac(const ExprHandle& v);
 TORCH_API ExprHandle lgamma(const ExprHandle& v);
@@ -237,6 +237,7 @@ int Intrinsics::OpArgCount(IntrinsicsOp op_type) {
     case kCeil:
     case kFloor:
     case kRound:
+    case kRint:
     case kTrunc:
     case kFrac:
     case kLgamma:
@@ -629,6 +629,7 @@ enum IntrinsicsOp {
   kCeil,
   kFloor,
   kRound,
+  kRint, // Rounds half to even, as quantization does
   kTrunc,
   kFmod,
   kRemainder,
@@ -718,6 +719,8 @@ class Intrinsics : public CallNode<Intrinsics> {
         return "floor";
       case kRound:
         return "round";
+      case kRint:
+        return "rint";
       case kTrunc:
         return "trunc";
       case kRand:
@@ -6,6 +6,7 @@
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
+#include <torch/csrc/jit/tensorexpr/var_substitutor.h>
 
 using namespace torch::jit;
 using namespace torch::jit::tensorexpr;
@@ -17,6 +18,7 @@ namespace tensorexpr {
 static int te_cuda_pointwise_loop_levels = -1;
 static int te_cuda_pointwise_block_count = -1;
 static int te_cuda_pointwise_block_size = -1;
+static int te_kernel_cache_size = 8;
 static bool fallback_allowed = true;
 
 bool setFallbackAllowed(bool value) {
@@ -48,6 +50,10 @@ int& getTECudaPointwiseBlockSize() {
   return te_cuda_pointwise_block_size;
 }
 
+int& getTEKernelCacheSize() {
+  return te_kernel_cache_size;
+}
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
@@ -56,11 +62,65 @@ static at::ScalarType tensorType(Tensor* t) {
   return static_cast<at::ScalarType>(t->body()->dtype().scalar_type());
 }
 
+// Quantized tensors are stored as their integer representation.
+static ScalarType storageType(at::ScalarType type) {
+  switch (type) {
+    case at::kQUInt8:
+      return ScalarType::Byte;
+    case at::kQInt8:
+      return ScalarType::Char;
+    default:
+      return static_cast<ScalarType>(type);
+  }
+}
+
+static bool isQuantizedTensor(const torch::jit::Value* v) {
+  auto tt = v->type()->cast<TensorType>();
+  return tt && tt->scalarType() && c10::isQIntType(*tt->scalarType());
+}
+
+// The inputs of `n` holding the scale and zero point of its quantized output.
+static std::pair<const torch::jit::Value*, const torch::jit::Value*>
+outputQuantParamInputs(const torch::jit::Node* n) {
+  static const Symbol quantized_hardswish =
+      Symbol::fromQualString("quantized::hardswish");
+  if (n->kind() == aten::quantize_per_tensor ||
+      n->kind() == quantized_hardswish) {
+    return {n->input(1), n->input(2)};
+  }
+  // quantized::add, quantized::add_relu and quantized::mul
+  return {n->input(2), n->input(3)};
+}
+
+static ExprHandle dequantize(
+    const ExprHandle& q,
+    const ExprHandle& scale,
+    const ExprHandle& zeroPoint) {
+  return cast<float>(cast<int>(q) - zeroPoint) * scale;
+}
+
+// Rounds half to even and saturates, like quantize_per_tensor.
+static ExprHandle quantize(
+    const ExprHandle& x,
+    const ExprHandle& scale,
+    const ExprHandle& zeroPoint,
+    at::ScalarType type) {
+  const float qmin = type == at::kQUInt8 ? 0 : -128;
+  const float qmax = type == at::kQUInt8 ? 255 : 127;
+  ExprHandle q = rint(x * (ExprHandle(1.0f) / scale)) + cast<float>(zeroPoint);
+  q = Min::make(Max::make(q, qmin, false), qmax, false);
+  return Cast::make(ToDtype(storageType(type)), q);
+}
+
 static std::vector<ExprHandle> texprSizes(
     const c10::VaryingShape<int64_t>& shape) {
+  auto const sizes = shape.concrete_sizes();
+  if (!sizes) {
+    throw malformed_input("expected static sizes");
+  }
   std::vector<ExprHandle> dims;
-  for (size_t i = 0; i < *shape.size(); i++) {
-    dims.push_back(IntImm::make(*shape[i]));
+  for (auto size : *sizes) {
+    dims.push_back(IntImm::make(size));
   }
   return dims;
 }
@@ -189,50 +249,47 @@ static bool isOne(ExprHandle e) {
   return n->value() == 1;
 }
 
-static std::pair<std::vector<ExprHandle>, bool> broadcastShapes(
-    const std::vector<ExprHandle>& a,
-    const std::vector<ExprHandle>& b) {
-  bool broadcast = false;
-  auto at = a.rbegin();
-  auto bt = b.rbegin();
-  std::vector<ExprHandle> ret;
-  while (at != a.rend() || bt != b.rend()) {
-    if (at == a.rend()) {
-      broadcast = true;
-      ret.push_back(*bt++);
-      continue;
+std::vector<ExprHandle> TensorExprKernel::broadcastShapes(
+    const std::vector<std::vector<ExprHandle>>& shapes) {
+  std::vector<ExprHandle> ret = shapes.at(0);
+  for (size_t s = 1; s < shapes.size(); s++) {
+    const auto& b = shapes[s];
+    if (ret.size() != b.size()) {
+      hasBroadcast_ = true;
     }
-    if (bt == b.rend()) {
-      broadcast = true;
-      ret.push_back(*at++);
-      continue;
-    }
-    // TODO: if neither *at nor *bt is 1, ensure they are identical
-    // expressions.  Nb: `==` doesn't work since that simply produces a new
-    // ExprHandle.
-    ExprHandle dim = *at;
-    if (isOne(*at)) {
-      if (!isOne(*bt)) {
-        dim = *bt;
-        broadcast = true;
+    std::vector<ExprHandle> res;
+    auto at = ret.rbegin();
+    auto bt = b.rbegin();
+    while (at != ret.rend() || bt != b.rend()) {
+      if (at == ret.rend()) {
+        res.push_back(*bt++);
+        continue;
+      }
+      if (bt == b.rend()) {
+        res.push_back(*at++);
+        continue;
       }
+      // Nb: `==` doesn't work since that simply produces a new ExprHandle.
+      ExprHandle dim = *at;
+      if (isOne(*at)) {
+        if (!isOne(*bt)) {
+          dim = *bt;
+          hasBroadcast_ = true;
+        }
+      } else if (
+          !isOne(*bt) && at->node() != bt->node() &&
+          (!at->AsNode<IntImm>() || !bt->AsNode<IntImm>())) {
+        // Neither size is known to be 1, so they must be equal.
+        sizeChecks_.emplace_back(*at, *bt);
+      }
+      res.push_back(dim);
+      at++;
+      bt++;
     }
-    ret.push_back(dim);
-    at++;
-    bt++;
+    std::reverse(res.begin(), res.end());
+    ret = std::move(res);
   }
-  std::reverse(ret.begin(), ret.end());
-  return {ret, broadcast};
-}
-
-template <typename... Args>
-static std::pair<std::vector<ExprHandle>, bool> broadcastShapes(
-    const std::vector<ExprHandle>& a,
-    const std::vector<ExprHandle>& b,
-    Args... args) {
-  auto const& res = broadcastShapes(a, b);
-  auto const& res2 = broadcastShapes(res.first, args...);
-  return {res2.first, res.second || res2.second};
+  return ret;
 }
 
 std::vector<ExprHandle> TensorExprKernel::valueShape(
@@ -270,10 +327,8 @@ Tensor* TensorExprKernel::computeTwoOperand(
     const std::function<ExprHandle(const ExprHandle&, const ExprHandle&)>&
         innerExpr) {
   auto const& n = v->node();
-  auto const& res =
-      broadcastShapes(valueShape(n->inputs()[0]), valueShape(n->inputs()[1]));
-  auto const& shape = res.first;
-  hasBroadcast_ |= res.second;
+  auto const& shape = broadcastShapes(
+      {valueShape(n->inputs()[0]), valueShape(n->inputs()[1])});
   return Compute(
       name,
       c10::fmap<DimArg>(shape),
@@ -296,10 +351,8 @@ Tensor* TensorExprKernel::computeTwoOperandWithAlpha(
     const std::function<ExprHandle(const ExprHandle&, const ExprHandle&)>&
         innerExpr) {
   auto const& n = v->node();
-  auto const& res =
-      broadcastShapes(valueShape(n->inputs()[0]), valueShape(n->inputs()[1]));
-  auto const& shape = res.first;
-  hasBroadcast_ |= res.second;
+  auto const& shape = broadcastShapes(
+      {valueShape(n->inputs()[0]), valueShape(n->inputs()[1])});
   return Compute(
       name,
       c10::fmap<DimArg>(shape),
@@ -324,12 +377,10 @@ Tensor* TensorExprKernel::computeConditionWithTwoOperand(
         ExprHandle(const ExprHandle&, const ExprHandle&, const ExprHandle&)>&
         innerExpr) {
   auto const& n = v->node();
-  auto const& res = broadcastShapes(
-      valueShape(n->inputs()[0]),
-      valueShape(n->inputs()[1]),
-      valueShape(n->inputs()[2]));
-  auto const& shape = res.first;
-  hasBroadcast_ |= res.second;
+  auto const& shape = broadcastShapes(
+      {valueShape(n->inputs()[0]),
+       valueShape(n->inputs()[1]),
+       valueShape(n->inputs()[2])});
   return Compute(
       name,
       c10::fmap<DimArg>(shape),
@@ -355,12 +406,10 @@ Tensor* TensorExprKernel::computeThreeOperand(
         ExprHandle(const ExprHandle&, const ExprHandle&, const ExprHandle&)>&
         innerExpr) {
   auto const& n = v->node();
-  auto const& res = broadcastShapes(
-      valueShape(n->inputs()[0]),
-      valueShape(n->inputs()[1]),
-      valueShape(n->inputs()[2]));
-  auto const& shape = res.first;
-  hasBroadcast_ |= res.second;
+  auto const& shape = broadcastShapes(
+      {valueShape(n->inputs()[0]),
+       valueShape(n->inputs()[1]),
+       valueShape(n->inputs()[2])});
   return Compute(
       name,
       c10::fmap<DimArg>(shape),
@@ -387,13 +436,11 @@ Tensor* TensorExprKernel::computeFourOperand(
         const ExprHandle&,
         const ExprHandle&)>& innerExpr) {
   auto const& n = v->node();
-  auto const& res = broadcastShapes(
-      valueShape(n->inputs()[0]),
-      valueShape(n->inputs()[1]),
-      valueShape(n->inputs()[2]),
-      valueShape(n->inputs()[3]));
-  auto const& shape = res.first;
-  hasBroadcast_ |= res.second;
+  auto const& shape = broadcastShapes(
+      {valueShape(n->inputs()[0]),
+       valueShape(n->inputs()[1]),
+       valueShape(n->inputs()[2]),
+       valueShape(n->inputs()[3])});
   return Compute(
       name,
       c10::fmap<DimArg>(shape),
@@ -413,8 +460,111 @@ Tensor* TensorExprKernel::computeFourOperand(
       });
 }
 
+Tensor* TensorExprKernel::computeQuantized(
+    const std::string& name,
+    const torch::jit::Value* v,
+    size_t numOperands,
+    const std::function<ExprHandle(const std::vector<ExprHandle>&)>&
+        innerExpr) {
+  auto const& n = v->node();
+  std::vector<std::vector<ExprHandle>> shapes;
+  for (size_t i = 0; i < numOperands; i++) {
+    shapes.push_back(valueShape(n->input(i)));
+  }
+  auto const& shape = broadcastShapes(shapes);
+  if (isQuantizedTensor(v)) {
+    auto const params = outputQuantParamInputs(n);
+    quantParams_.emplace(
+        v->unique(),
+        QuantParams{constant(params.first), constant(params.second)});
+  }
+  return Compute(
+      name,
+      c10::fmap<DimArg>(shape),
+      [this, v, numOperands, innerExpr](const std::vector<VarHandle>& axes) {
+        auto const& n = v->node();
+        std::vector<ExprHandle> inputs;
+        for (size_t i = 0; i < numOperands; i++) {
+          ExprHandle input = tensorOrConstant(n->input(i), axes);
+          auto it = quantParams_.find(n->input(i)->unique());
+          if (it != quantParams_.end()) {
+            input = dequantize(input, it->second.scale, it->second.zeroPoint);
+          } else {
+            input = cast<float>(input);
+          }
+          inputs.push_back(input);
+        }
+        ExprHandle compute = innerExpr(inputs);
+        auto it = quantParams_.find(v->unique());
+        if (it == quantParams_.end()) {
+          return demoteOutput(compute, v);
+        }
+        return quantize(
+            compute,
+            it->second.scale,
+            it->second.zeroPoint,
+            *v->type()->cast<TensorType>()->scalarType());
+      });
+}
+
 Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
+  static const Symbol quantized_add = Symbol::fromQualString("quantized::add");
+  static const Symbol quantized_add_relu =
+      Symbol::fromQualString("quantized::add_relu");
+  static const Symbol quantized_mul = Symbol::fromQualString("quantized::mul");
+  static const Symbol quantized_hardswish =
+      Symbol::fromQualString("quantized::hardswish");
+  auto hardswish = [](const ExprHandle& a) {
+    return a * Min::make(Max::make(a + 3, 0, false), 6, false) / 6;
+  };
+  // Quantized operators are lowered to dequantize, compute and quantize, so
+  // that chains of them run in one loop.
+  if (v->node()->kind() == quantized_add) {
+    return computeQuantized(
+        "quantized_add", v, 2, [](const std::vector<ExprHandle>& in) {
+          return in[0] + in[1];
+        });
+  } else if (v->node()->kind() == quantized_add_relu) {
+    return computeQuantized(
+        "quantized_add_relu", v, 2, [](const std::vector<ExprHandle>& in) {
+          return Max::make(in[0] + in[1], 0, false);
+        });
+  } else if (v->node()->kind() == quantized_mul) {
+    return computeQuantized(
+        "quantized_mul", v, 2, [](const std::vector<ExprHandle>& in) {
+          return in[0] * in[1];
+        });
+  } else if (v->node()->kind() == quantized_hardswish) {
+    return computeQuantized(
+        "quantized_hardswish",
+        v,
+        1,
+        [hardswish](const std::vector<ExprHandle>& in) {
+          return hardswish(in[0]);
+        });
+  }
+
   switch (v->node()->kind()) {
+    case aten::quantize_per_tensor: {
+      return computeQuantized(
+          "aten_quantize_per_tensor",
+          v,
+          1,
+          [](const std::vector<ExprHandle>& in) { return in[0]; });
+    } break;
+
+    case aten::dequantize: {
+      return computeQuantized(
+          "aten_dequantize",
+          v,
+          1,
+          [](const std::vector<ExprHandle>& in) { return in[0]; });
+    } break;
+
+    case aten::hardswish: {
+      return computeOneOperand("aten_hardswish", v, hardswish);
+    } break;
+
     case aten::add: {
       auto add_lambda = [](const ExprHandle& lhs, const ExprHandle& rhs) {
         return lhs + rhs;
@@ -967,12 +1117,164 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
           });
     }
 
+    case aten::sum: {
+      return computeSum(v);
+    }
+
+    case aten::softmax: {
+      return computeSoftmax(v);
+    }
+
     default: {
       throw std::runtime_error("Unhandled node kind");
     }
   }
 }
 
+// Returns the indices of `axes`, which index a reduction's output, and of
+// `reductionAxes` in the reduction's input: `reduced` says which dimensions
+// of the input are reduced, and `keepdim` whether they are kept as size-1
+// dimensions of the output.
+static std::vector<ExprHandle> reductionInputIndices(
+    const std::vector<bool>& reduced,
+    bool keepdim,
+    const std::vector<VarHandle>& axes,
+    const std::vector<VarHandle>& reductionAxes) {
+  std::vector<ExprHandle> indices;
+  size_t axis = 0;
+  size_t reductionAxis = 0;
+  for (bool isReduced : reduced) {
+    if (isReduced) {
+      indices.push_back(reductionAxes[reductionAxis++]);
+      if (keepdim) {
+        axis++;
+      }
+    } else {
+      indices.push_back(axes[axis++]);
+    }
+  }
+  return indices;
+}
+
+static int64_t normalizeDim(int64_t dim, size_t rank) {
+  if (dim < 0) {
+    dim += rank;
+  }
+  if (dim < 0 || dim >= static_cast<int64_t>(rank)) {
+    throw malformed_input("invalid reduction dimension");
+  }
+  return dim;
+}
+
+Tensor* TensorExprKernel::computeSum(const torch::jit::Value* v) {
+  // aten::sum(Tensor self, *, ScalarType? dtype=None) or
+  // aten::sum(Tensor self, int[1] dim, bool keepdim=False, *,
+  //           ScalarType? dtype=None)
+  auto const& n = v->node();
+  auto const shape = valueShape(n->inputs()[0]);
+  std::vector<bool> reduced(shape.size(), true);
+  bool keepdim = false;
+  if (n->inputs().size() == 4) {
+    std::fill(reduced.begin(), reduced.end(), false);
+    for (int64_t dim : toIValue(n->inputs()[1])->toIntVector()) {
+      reduced[normalizeDim(dim, shape.size())] = true;
+    }
+    keepdim = toIValue(n->inputs()[2])->toBool();
+  }
+
+  std::vector<DimArg> outputDims;
+  std::vector<DimArg> reductionDims;
+  for (size_t i = 0; i < shape.size(); i++) {
+    if (reduced[i]) {
+      reductionDims.emplace_back(shape[i]);
+      if (keepdim) {
+        outputDims.emplace_back(IntImm::make(1));
+      }
+    } else {
+      outputDims.emplace_back(shape[i]);
+    }
+  }
+
+  size_t numOutputDims = outputDims.size();
+  return Reduce(
+      "aten_sum",
+      outputDims,
+      Sum(),
+      [this, v, reduced, keepdim, numOutputDims](ParameterList& vars) {
+        std::vector<VarHandle> axes(
+            vars.begin(), vars.begin() + numOutputDims);
+        std::vector<VarHandle> reductionAxes(
+            vars.begin() + numOutputDims, vars.end());
+        return tensorOrConstant(
+            v->node()->inputs()[0],
+            reductionInputIndices(reduced, keepdim, axes, reductionAxes));
+      },
+      reductionDims);
+}
+
+Tensor* TensorExprKernel::computeSoftmax(const torch::jit::Value* v) {
+  // aten::softmax(Tensor self, int dim, ScalarType? dtype=None)
+  //
+  // softmax(x) = exp(x - max(x)) / sum(exp(x - max(x))), with the max and the
+  // sum over `dim` each computed into a buffer.
+  auto const& n = v->node();
+  const torch::jit::Value* input = n->inputs()[0];
+  auto const shape = valueShape(input);
+  int64_t dim = normalizeDim(
+      constant(n->inputs()[1]).AsNode<IntImm>()->value(), shape.size());
+  std::vector<bool> reduced(shape.size(), false);
+  reduced[dim] = true;
+
+  std::vector<DimArg> outerDims;
+  std::vector<DimArg> dims;
+  for (size_t i = 0; i < shape.size(); i++) {
+    if (!reduced[i]) {
+      outerDims.emplace_back(shape[i]);
+    }
+    dims.emplace_back(shape[i]);
+  }
+
+  auto splitVars = [](ParameterList& vars) {
+    return std::make_pair(
+        std::vector<VarHandle>(vars.begin(), vars.end() - 1),
+        std::vector<VarHandle>(vars.end() - 1, vars.end()));
+  };
+  Tensor* max = Reduce(
+      "aten_softmax_max",
+      outerDims,
+      Maximum(tensors_.at(input->unique())->body()->dtype()),
+      [this, input, reduced, splitVars](ParameterList& vars) {
+        auto axes = splitVars(vars);
+        return tensorOrConstant(
+            input,
+            reductionInputIndices(reduced, false, axes.first, axes.second));
+      },
+      {shape[dim]});
+  Tensor* sum = Reduce(
+      "aten_softmax_sum",
+      outerDims,
+      Sum(),
+      [this, input, reduced, splitVars, max](ParameterList& vars) {
+        auto axes = splitVars(vars);
+        return exp(
+            tensorOrConstant(
+                input,
+                reductionInputIndices(
+                    reduced, false, axes.first, axes.second)) -
+            max->call(axes.first));
+      },
+      {shape[dim]});
+  return Compute(
+      "aten_softmax",
+      dims,
+      [this, input, dim, max, sum](const std::vector<VarHandle>& axes) {
+        std::vector<VarHandle> outer(axes.begin(), axes.end());
+        outer.erase(outer.begin() + dim);
+        return exp(tensorOrConstant(input, axes) - max->call(outer)) /
+            sum->call(outer);
+      });
+}
+
 void TensorExprKernel::flattenTensors(BackendType backendType) {
   if (backendType != BackendType::kCudaCodeGen) {
     // We only need to flatten for GPU, for other backends just use the same
@@ -1018,14 +1320,33 @@ void TensorExprKernel::flattenTensors(BackendType backendType) {
   }
 }
 
+// Whether the iterations of `loop` store to the same element, i.e. whether
+// `loop` is the loop over a reduction axis, which can't be vectorized.
+static bool isReductionLoop(For* loop) {
+  for (Store* store : NodeFinder<Store>::find(loop->body())) {
+    bool dependsOnLoopVar = false;
+    for (const Expr* index : store->indices()) {
+      if (VarFinder().findVars(index).count(loop->var())) {
+        dependsOnLoopVar = true;
+      }
+    }
+    if (!dependsOnLoopVar) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
   flattenTensors(backendType);
 
   torch::jit::tensorexpr::LoopNest l(flatTensorOutputs_);
 
-  // Compute non-output tensors_ inline
+  // Compute non-output tensors_ inline, except for reductions, which can't be
+  // inlined.
   for (auto& p : tensors_) {
-    if (!l.hasLoopBodyFor(p.second)) {
+    if (!l.hasLoopBodyFor(p.second) ||
+        dynamic_cast<const ReduceOp*>(p.second->body())) {
       continue;
     }
     Stmt* loop = l.getLoopBodyFor(p.second);
@@ -1130,6 +1451,9 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
 
     // vectorize inner loops.
     for (For* loop : innerLoops) {
+      if (isReductionLoop(loop)) {
+        continue;
+      }
       For* outer1;
       For* split1;
       For* tail1;
@@ -1180,6 +1504,9 @@ std::vector<CodeGen::BufferArg> TensorExprKernel::prepareBufferArgs() {
     for (auto const& stride : arg.strides()) {
       params.emplace_back(stride.var);
     }
+    for (auto const& param : arg.quantParams()) {
+      params.emplace_back(param);
+    }
   }
   for (auto& o : flatTensorOutputs_) {
     params.emplace_back(o);
@@ -1303,15 +1630,53 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
       auto tt = input->type()->cast<TensorType>();
       Buffer inBuffer(
           "t" + input->debugName(),
-          ToDtype(static_cast<ScalarType>(*tt->scalarType())),
+          ToDtype(storageType(*tt->scalarType())),
           {0});
       std::vector<DimArg> inputTensorDims;
-      for (size_t i = 0; i < *tt->sizes().size(); i++) {
-        auto const size = *tt->sizes()[i];
-        inputTensorDims.emplace_back(
-            DimArg(IntImm::make(size), "i" + c10::to_string(i)));
+      std::vector<ExprHandle> strides;
+      std::vector<ShapeArg> sizeArgs;
+      std::vector<ShapeArg> strideArgs;
+      if (!dynamic_) {
+        for (size_t i = 0; i < *tt->sizes().size(); i++) {
+          auto const size = *tt->sizes()[i];
+          inputTensorDims.emplace_back(
+              DimArg(IntImm::make(size), "i" + c10::to_string(i)));
+          strides.push_back(IntImm::make(*tt->strides()[i]));
+        }
+      } else {
+        // Sizes of 1 are part of the shape class, so that broadcasts are
+        // resolved at compile time; all other sizes are kernel arguments.
+        auto const& t = specializationInputs_.at(input->offset()).toTensor();
+        std::vector<ExprHandle> sizes;
+        for (int64_t i = 0; i < t.dim(); i++) {
+          if (t.size(i) == 1) {
+            sizes.push_back(IntImm::make(1));
+          } else {
+            VarHandle size(
+                "t" + input->debugName() + "_size" + c10::to_string(i), kInt);
+            sizeArgs.emplace_back(i, size);
+            sizes.push_back(size);
+          }
+          inputTensorDims.emplace_back(
+              DimArg(sizes.back(), "i" + c10::to_string(i)));
+        }
+        strides.resize(t.dim());
+        if (t.is_contiguous()) {
+          ExprHandle stride = IntImm::make(1);
+          for (int64_t i = t.dim() - 1; i >= 0; i--) {
+            strides[i] = stride;
+            stride = stride * sizes[i];
+          }
+        } else {
+          for (int64_t i = 0; i < t.dim(); i++) {
+            VarHandle stride(
+                "t" + input->debugName() + "_stride" + c10::to_string(i),
+                kInt);
+            strideArgs.emplace_back(i, stride);
+            strides[i] = stride;
+          }
+        }
       }
-      auto const strides = tt->strides();
       tensors_.emplace(
           input->unique(),
           Compute(
@@ -1320,12 +1685,18 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
               [&](const std::vector<VarHandle>& axes) {
                 ExprHandle idx = 0;
                 for (size_t i = 0; i < axes.size(); i++) {
-                  idx = idx + axes[i] * IntImm::make(*strides[i]);
+                  idx = idx + axes[i] * strides[i];
                 }
                 return inBuffer(idx);
               }));
       kernelArgs_.emplace_back(
-          inBuffer, std::vector<ShapeArg>(), std::vector<ShapeArg>());
+          inBuffer, std::move(sizeArgs), std::move(strideArgs));
+      if (isQuantizedTensor(input)) {
+        VarHandle scale("t" + input->debugName() + "_scale", kFloat);
+        VarHandle zeroPoint("t" + input->debugName() + "_zero_point", kInt);
+        kernelArgs_.back().quantParamArgs_ = {scale, zeroPoint};
+        quantParams_.emplace(input->unique(), QuantParams{scale, zeroPoint});
+      }
       break;
     }
     case TypeKind::FloatType: {
@@ -1387,6 +1758,24 @@ void TensorExprKernel::compile() {
     }
     tensorOutputs_.emplace_back(tensors_.at(output->unique()));
     tensors_.erase(output->unique());
+    if (!isQuantizedTensor(output)) {
+      outputQuantParams_.emplace_back(c10::nullopt);
+      continue;
+    }
+    if (!quantParams_.count(output->unique()) ||
+        output->node()->kind() == prim::Param) {
+      throw malformed_input("cannot find the quantization of an output");
+    }
+    auto const params = outputQuantParamInputs(output->node());
+    auto const scale = toIValue(params.first);
+    auto const zeroPoint = toIValue(params.second);
+    if (!scale || !zeroPoint) {
+      throw malformed_input("quantized outputs need a constant quantization");
+    }
+    outputQuantParams_.emplace_back(OutputQuantParams{
+        *output->type()->cast<TensorType>()->scalarType(),
+        scale->toDouble(),
+        zeroPoint->toInt()});
   }
 
   device_ = pickDeviceType(graph_->inputs());
@@ -1402,6 +1791,21 @@ void TensorExprKernel::compile() {
 
 TensorExprKernel::TensorExprKernel(const std::shared_ptr<Graph>& subgraph)
     : graph_(subgraph), code_(subgraph, "") {
+  for (auto const& input : graph_->inputs()) {
+    auto tt = input->type()->cast<TensorType>();
+    if (tt && !tt->isComplete()) {
+      dynamic_ = true;
+    }
+  }
+  if (dynamic_) {
+    // Specializations are compiled by the first run of each shape class.
+    nInputs_ = graph_->inputs().size();
+    for (auto const& input : graph_->inputs()) {
+      inputTypes_.push_back(input->type());
+    }
+    return;
+  }
+
   if (!fallbackAllowed()) {
     compile();
     return;
@@ -1414,7 +1818,20 @@ TensorExprKernel::TensorExprKernel(const std::shared_ptr<Graph>& subgraph)
   }
 }
 
+TensorExprKernel::TensorExprKernel(
+    const std::shared_ptr<Graph>& subgraph,
+    const at::ArrayRef<IValue>& inputs)
+    : graph_(subgraph), dynamic_(true), specializationInputs_(inputs) {
+  compile();
+  specializationInputs_ = {};
+}
+
 void TensorExprKernel::run(Stack& stack) {
+  if (dynamic_) {
+    runDynamic(stack);
+    return;
+  }
+
   if (!fallbackAllowed()) {
     runKernel(stack);
     return;
@@ -1432,6 +1849,82 @@ void TensorExprKernel::run(Stack& stack) {
   }
 }
 
+// The shape class of the inputs of a dynamic kernel: for every Tensor input,
+// its rank, which of its sizes are 1 and whether it is contiguous.
+static std::vector<int64_t> shapeClass(const at::ArrayRef<IValue>& inputs) {
+  std::vector<int64_t> key;
+  for (auto const& input : inputs) {
+    if (!input.isTensor()) {
+      continue;
+    }
+    auto const& t = input.toTensor();
+    key.push_back(t.dim());
+    for (auto size : t.sizes()) {
+      key.push_back(size == 1);
+    }
+    key.push_back(t.is_contiguous());
+  }
+  return key;
+}
+
+std::shared_ptr<TensorExprKernel> TensorExprKernel::getOrCompileSpecialization(
+    const at::ArrayRef<IValue>& inputs) {
+  auto key = shapeClass(inputs);
+  std::lock_guard<std::mutex> guard(specializationsMutex_);
+  for (auto it = specializations_.begin(); it != specializations_.end();
+       ++it) {
+    if (it->first == key) {
+      specializations_.splice(specializations_.begin(), specializations_, it);
+      return it->second;
+    }
+  }
+
+  std::shared_ptr<TensorExprKernel> kernel;
+  if (!fallbackAllowed()) {
+    kernel.reset(new TensorExprKernel(graph_, inputs));
+  } else {
+    try {
+      kernel.reset(new TensorExprKernel(graph_, inputs));
+    } catch (...) {
+      GRAPH_DEBUG("Failed to compile a specialization, using the fallback");
+    }
+  }
+  specializations_.emplace_front(std::move(key), kernel);
+  while (specializations_.size() >
+         static_cast<size_t>(std::max(getTEKernelCacheSize(), 1))) {
+    specializations_.pop_back();
+  }
+  return kernel;
+}
+
+void TensorExprKernel::runDynamic(Stack& stack) {
+  auto inputs = last(stack, nInputs_);
+  if (!fallbackAllowed()) {
+    checkInputs(inputs, inputTypes_);
+    getOrCompileSpecialization(inputs)->runKernel(stack);
+    return;
+  }
+
+  // Unlike for static kernels, a failure only affects this call (or shape
+  // class), since other shapes may still be handled by the generated code.
+  std::shared_ptr<TensorExprKernel> kernel;
+  try {
+    checkInputs(inputs, inputTypes_);
+    kernel = getOrCompileSpecialization(inputs);
+  } catch (...) {
+    GRAPH_DEBUG("Unsupported inputs, using the fallback");
+  }
+  if (!kernel) {
+    fallback(stack);
+    return;
+  }
+  try {
+    kernel->runKernel(stack);
+  } catch (...) {
+    fallback(stack);
+  }
+}
+
 std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
     const at::ArrayRef<IValue>& inputs,
     std::vector<at::Tensor>& outputs) {
@@ -1456,10 +1949,38 @@ std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
         int32_t s = tensor.strides()[stride.idx];
         runArgs.emplace_back(s);
       }
+      if (!kernelArgs_[i].quantParams().empty()) {
+        if (tensor.qscheme() != at::kPerTensorAffine) {
+          throw malformed_input("only per tensor quantization is supported");
+        }
+        runArgs.emplace_back((float)tensor.q_scale());
+        runArgs.emplace_back((int32_t)tensor.q_zero_point());
+      }
+    }
+  }
+
+  auto sizeValue = [&](const ExprHandle& e) -> c10::optional<int64_t> {
+    auto it = varToSize.find(e.node());
+    if (it != varToSize.end()) {
+      return it->second;
+    }
+    if (auto const& imm = e.AsNode<IntImm>()) {
+      return imm->value();
+    }
+    return c10::nullopt;
+  };
+  for (auto const& check : sizeChecks_) {
+    auto const a = sizeValue(check.first);
+    auto const b = sizeValue(check.second);
+    if (a && b && *a != *b) {
+      throw malformed_input(
+          "sizes " + c10::to_string(*a) + " and " + c10::to_string(*b) +
+          " of the inputs don't broadcast");
     }
   }
 
-  for (auto& o : tensorOutputs_) {
+  for (size_t i = 0; i < tensorOutputs_.size(); i++) {
+    Tensor* o = tensorOutputs_[i];
     std::vector<int64_t> tensorSize;
     for (const Expr* dim : o->dims()) {
       auto it = varToSize.find(dim);
@@ -1474,14 +1995,31 @@ std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
       }
     }
 
-    outputs.push_back(at::empty(
-        tensorSize, c10::TensorOptions(tensorType(o)).device(device_)));
+    auto const& quant = outputQuantParams_[i];
+    if (quant) {
+      outputs.push_back(at::_empty_affine_quantized(
+          tensorSize,
+          c10::TensorOptions(quant->dtype).device(device_),
+          quant->scale,
+          quant->zeroPoint));
+    } else {
+      outputs.push_back(at::empty(
+          tensorSize, c10::TensorOptions(tensorType(o)).device(device_)));
+    }
     runArgs.emplace_back(outputs.back().data_ptr());
   }
   return runArgs;
 }
 
 Stmt* TensorExprKernel::getCodeGenStmt() {
+  if (dynamic_ && !codegen_) {
+    // Return the code of the most recently used specialization.
+    std::lock_guard<std::mutex> guard(specializationsMutex_);
+    if (specializations_.empty() || !specializations_.front().second) {
+      return nullptr;
+    }
+    return specializations_.front().second->getCodeGenStmt();
+  }
   return codegen_->stmt();
 }
 
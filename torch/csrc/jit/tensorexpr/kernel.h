@@ -5,6 +5,9 @@
 #include <torch/csrc/jit/tensorexpr/codegen.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
+#include <list>
+#include <mutex>
+
 namespace torch {
 namespace jit {
 namespace tensorexpr {
@@ -13,7 +16,11 @@ template <typename T>
 inline std::vector<int64_t> bufferSizes(const T& t) {
   std::vector<int64_t> sizes;
   for (size_t i = 0; i < t->buf()->ndim(); i++) {
-    sizes.push_back(dynamic_cast<const IntImm*>(t->buf()->dim(i))->value());
+    auto const size = dynamic_cast<const IntImm*>(t->buf()->dim(i));
+    if (!size) {
+      throw malformed_input("expected a static size", t->buf()->dim(i));
+    }
+    sizes.push_back(size->value());
   }
   return sizes;
 }
@@ -42,6 +49,14 @@ inline std::vector<ExprHandle> computeIndicesToBroadcast(
   return bcast;
 }
 
+// A TensorExprKernel compiles a fusion group. If the types of its inputs are
+// complete, the kernel is compiled once for exactly those shapes. Otherwise
+// (see setTensorExprDynamicShapesEnabled) the inputs only need a known rank,
+// dtype and device, and the kernel is compiled on demand once per shape class
+// of the inputs, i.e. per combination of which dimensions have size 1 and
+// which inputs are contiguous: the other sizes, and the strides of
+// non-contiguous inputs, are passed to the generated code as arguments. The
+// most recently used specializations are cached, see getTEKernelCacheSize.
 class TORCH_API TensorExprKernel {
  public:
   explicit TensorExprKernel(const std::shared_ptr<Graph>& subgraph);
@@ -62,10 +77,20 @@ class TORCH_API TensorExprKernel {
     kCudaCodeGen,
   };
 
+  // Creates the specialization of a dynamic kernel for the shape class of
+  // `inputs`.
+  TensorExprKernel(
+      const std::shared_ptr<Graph>& subgraph,
+      const at::ArrayRef<IValue>& inputs);
+
   void compile();
 
   void runKernel(Stack& stack);
 
+  void runDynamic(Stack& stack);
+  std::shared_ptr<TensorExprKernel> getOrCompileSpecialization(
+      const at::ArrayRef<IValue>& inputs);
+
   ExprHandle constant(const torch::jit::Value* v);
 
   template <typename T, typename T1>
@@ -98,6 +123,11 @@ class TORCH_API TensorExprKernel {
 
   std::vector<ExprHandle> valueShape(const torch::jit::Value* v);
 
+  // Returns the broadcast of `shapes`, and records the pairs of sizes that
+  // have to match at runtime because neither is statically 1.
+  std::vector<ExprHandle> broadcastShapes(
+      const std::vector<std::vector<ExprHandle>>& shapes);
+
   void promoteInputs(std::vector<ExprHandle>& inputs);
 
   ExprHandle demoteOutput(const ExprHandle& e, const torch::jit::Value* v);
@@ -153,6 +183,21 @@ class TORCH_API TensorExprKernel {
           const ExprHandle&,
           const ExprHandle&)>& innerExpr);
 
+  // Dequantizes the quantized operands of `v`, the first numOperands inputs
+  // of its node, applies innerExpr to them in float, and quantizes the result
+  // if `v` is quantized.
+  Tensor* computeQuantized(
+      const std::string& name,
+      const torch::jit::Value* v,
+      size_t numOperands,
+      const std::function<ExprHandle(const std::vector<ExprHandle>&)>&
+          innerExpr);
+
+  // Reductions. Their results are computed into buffers of their own rather
+  // than inlined into their uses.
+  Tensor* computeSum(const torch::jit::Value* v);
+  Tensor* computeSoftmax(const torch::jit::Value* v);
+
   Tensor* computeValue(const torch::jit::Value* v);
 
   void flattenTensors(BackendType backendType);
@@ -199,9 +244,31 @@ class TORCH_API TensorExprKernel {
       return strideArgs_;
     }
 
+    // The scale and zero point of a quantized tensor, as float and int
+    // arguments after its strides.
+    const std::vector<VarHandle>& quantParams() const {
+      return quantParamArgs_;
+    }
+
     CodeGen::BufferArg bufferArg_;
     std::vector<ShapeArg> sizeArgs_;
     std::vector<ShapeArg> strideArgs_;
+    std::vector<VarHandle> quantParamArgs_;
+  };
+
+  // The per tensor quantization of a value of the kernel. Quantized tensors
+  // are stored as their integer representation.
+  struct QuantParams {
+    ExprHandle scale;
+    ExprHandle zeroPoint;
+  };
+
+  // The quantization of an output, which must be known at compile time to
+  // allocate it.
+  struct OutputQuantParams {
+    at::ScalarType dtype;
+    double scale;
+    int64_t zeroPoint;
   };
 
   int64_t nInputs_ = 0;
@@ -210,6 +277,8 @@ class TORCH_API TensorExprKernel {
   std::vector<Tensor*> flatTensorOutputs_;
   std::unordered_map<int64_t, Tensor*> tensors_;
   std::unordered_map<int64_t, VarHandle> scalars_;
+  std::unordered_map<int64_t, QuantParams> quantParams_;
+  std::vector<c10::optional<OutputQuantParams>> outputQuantParams_;
   std::unique_ptr<CodeGen> codegen_;
   at::Device device_ = at::kCPU;
   KernelArena kernelArena_;
@@ -219,11 +288,24 @@ class TORCH_API TensorExprKernel {
   bool fallback_{false};
   bool hasRandom_{false};
   bool hasBroadcast_{false};
+
+  // Whether the kernel is compiled on demand per shape class.
+  bool dynamic_{false};
+  // The inputs of the specialization being compiled.
+  at::ArrayRef<IValue> specializationInputs_;
+  std::vector<std::pair<ExprHandle, ExprHandle>> sizeChecks_;
+  // Specializations by shape class, most recently used first. A null kernel
+  // means that compilation failed and the class uses the fallback.
+  std::list<std::pair<std::vector<int64_t>, std::shared_ptr<TensorExprKernel>>>
+      specializations_;
+  std::mutex specializationsMutex_;
 };
 
 TORCH_API int& getTECudaPointwiseLoopLevels();
 TORCH_API int& getTECudaPointwiseBlockCount();
 TORCH_API int& getTECudaPointwiseBlockSize();
+// The number of shape classes a dynamic kernel keeps compiled code for.
+TORCH_API int& getTEKernelCacheSize();
 TORCH_API bool fallbackAllowed();
 TORCH_API bool setFallbackAllowed(bool value);
 
@@ -4,8 +4,10 @@
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
 #include <memory>
+#include <unordered_set>
 
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/IRBuilder.h>
@@ -15,6 +17,7 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
+#include <torch/csrc/jit/codegen/kernel_disk_cache.h>
 #include <torch/csrc/jit/tensorexpr/buffer.h>
 #include <torch/csrc/jit/tensorexpr/execution_counter.h>
 #include <torch/csrc/jit/tensorexpr/ir.h>
@@ -57,6 +60,9 @@ class LLVMCodeGenImpl : public IRVisitor {
   llvm::Type* dtypeToLLVMPtr(Dtype dtype);
   void emitWrapper(const std::vector<llvm::Type*>& params);
   void emitKernel(Stmt* stmt, const std::vector<llvm::Type*>& params);
+  void emitParallelFor(const For* v);
+  std::string kernelCacheKey();
+  std::string emitObject();
 
  public:
   LLVMCodeGenImpl(
@@ -263,8 +269,23 @@ LLVMCodeGenImpl::LLVMCodeGenImpl(
   emitWrapper(params);
   emitKernel(stmt, params);
 
-  cantFail(jit_->addModule(
-      llvm::orc::ThreadSafeModule(std::move(module_), context_)));
+  // With the kernel cache enabled, the module is compiled to object code here
+  // rather than by the JIT, so that the object code can be cached. The key is
+  // the unoptimized IR, which is cheap to generate.
+  if (getKernelCacheDir().empty()) {
+    optimize(*module_);
+    cantFail(jit_->addModule(
+        llvm::orc::ThreadSafeModule(std::move(module_), context_)));
+  } else {
+    std::string key = kernelCacheKey();
+    auto object = loadCachedKernel("llvm", key);
+    if (!object) {
+      optimize(*module_);
+      object = emitObject();
+      storeCachedKernel("llvm", key, *object);
+    }
+    cantFail(jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(*object)));
+  }
   auto sym = jit_->findSymbol("wrapper");
   kernelAddress_ = cantFail(sym.getAddress());
   argv_ = std::make_unique<void*[]>(params.size());
@@ -438,21 +459,30 @@ void LLVMCodeGenImpl::emitKernel(
   if (llvm::verifyFunction(*fn_, &llvm::outs())) {
     throw std::runtime_error("Function verification failed");
   }
-  optimize(*module_);
+}
 
-#if DEBUG_PRINT
-  llvm::errs() << *module_;
-  llvm::SmallVector<char, 0> asmBuffer;
-  llvm::raw_svector_ostream asmStream(asmBuffer);
+std::string LLVMCodeGenImpl::kernelCacheKey() {
+  std::string key = "llvm " LLVM_VERSION_STRING " " +
+      TM_->getTargetTriple().str() + " " + TM_->getTargetCPU().str() + " " +
+      TM_->getTargetFeatureString().str() + "\n";
+  llvm::raw_string_ostream os(key);
+  module_->print(os, nullptr);
+  return os.str();
+}
+
+std::string LLVMCodeGenImpl::emitObject() {
+  llvm::SmallVector<char, 0> objBuffer;
+  llvm::raw_svector_ostream objStream(objBuffer);
   llvm::legacy::PassManager PM;
-  TM_->addPassesToEmitFile(
-      PM,
-      asmStream,
-      nullptr,
-      llvm::TargetMachine::CodeGenFileType::CGFT_AssemblyFile);
+  if (TM_->addPassesToEmitFile(
+          PM,
+          objStream,
+          nullptr,
+          llvm::TargetMachine::CodeGenFileType::CGFT_ObjectFile)) {
+    throw std::runtime_error("Target machine can't emit object code");
+  }
   PM.run(*module_);
-  llvm::errs() << asmStream.str();
-#endif
+  return std::string(objBuffer.begin(), objBuffer.end());
 }
 
 // TODO: The binary ops are copypasta.
@@ -762,6 +792,11 @@ void LLVMCodeGenImpl::visit(const Cast* v) {
     return;
   }
 
+  // The conversion from an integer depends on the signedness of the source,
+  // e.g. 200 as a uint8 is not -56.
+  bool srcUnsigned =
+      v->src_value()->dtype().scalar_type() == ScalarType::Byte ||
+      v->src_value()->dtype().scalar_type() == ScalarType::Bool;
   bool destUnsigned = v->dtype().scalar_type() == ScalarType::Byte;
 
   // Scalar casts
@@ -779,13 +814,13 @@ void LLVMCodeGenImpl::visit(const Cast* v) {
     }
   } else if (srcType->isIntOrIntVectorTy()) {
     if (dstType->isFPOrFPVectorTy()) {
-      if (destUnsigned) {
+      if (srcUnsigned) {
         value_ = irb_.CreateUIToFP(value_, dstType);
       } else {
         value_ = irb_.CreateSIToFP(value_, dstType);
       }
     } else if (dstType->isIntOrIntVectorTy()) {
-      value_ = irb_.CreateIntCast(value_, dstType, !destUnsigned);
+      value_ = irb_.CreateIntCast(value_, dstType, !srcUnsigned);
     } else {
       throw unimplemented_lowering(v);
     }
@@ -961,6 +996,11 @@ void LLVMCodeGenImpl::visit(const Load* v) {
 }
 
 void LLVMCodeGenImpl::visit(const For* v) {
+  if (v->loop_options().is_parallel()) {
+    emitParallelFor(v);
+    return;
+  }
+
   // Create "start" and "stop" values.
   v->start()->accept(this);
   auto start = this->value_;
@@ -1010,6 +1050,113 @@ void LLVMCodeGenImpl::visit(const For* v) {
   value_ = llvm::ConstantInt::get(IntTy_, 0);
 }
 
+namespace {
+// Collects the Vars used in a statement, in the order they are first seen.
+class VarUseCollector : public IRVisitor {
+ public:
+  const std::vector<const Var*>& vars() const {
+    return vars_;
+  }
+
+  void visit(const Var* v) override {
+    if (seen_.insert(v).second) {
+      vars_.push_back(v);
+    }
+  }
+
+ private:
+  std::vector<const Var*> vars_;
+  std::unordered_set<const Var*> seen_;
+};
+} // namespace
+
+// A parallel loop is emitted as a call to nnc_parallel_for (see llvm_jit.cpp),
+// which runs the outlined loop body
+//
+//   void parallel_body(int64_t index, void* packed_args)
+//
+// for every index in [start, stop) on the ATen intra-op thread pool. The
+// values the body needs from the enclosing function (kernel arguments, outer
+// loop indices, ...) are passed in a struct on the stack.
+void LLVMCodeGenImpl::emitParallelFor(const For* v) {
+  v->start()->accept(this);
+  auto start = irb_.CreateSExtOrTrunc(value_, LongTy_);
+  v->stop()->accept(this);
+  auto stop = irb_.CreateSExtOrTrunc(value_, LongTy_);
+
+  // Find the values to capture. Vars that are bound inside the body aren't
+  // bound yet, so they are skipped.
+  VarUseCollector collector;
+  v->body()->accept(&collector);
+  std::vector<const Var*> capturedVars;
+  std::vector<llvm::Value*> capturedVals;
+  std::vector<llvm::Type*> capturedTys;
+  for (const Var* var : collector.vars()) {
+    if (var == v->var() || (!varToArg_.count(var) && !varToVal_.count(var))) {
+      continue;
+    }
+    var->accept(this);
+    capturedVars.push_back(var);
+    capturedVals.push_back(value_);
+    capturedTys.push_back(value_->getType());
+  }
+
+  auto packedTy = llvm::StructType::get(getContext(), capturedTys);
+  llvm::IRBuilder<> allocaBuilder(
+      &fn_->getEntryBlock(), fn_->getEntryBlock().begin());
+  auto packed = allocaBuilder.CreateAlloca(packedTy);
+  for (size_t i = 0; i < capturedVals.size(); i++) {
+    irb_.CreateStore(capturedVals[i], irb_.CreateStructGEP(packedTy, packed, i));
+  }
+
+  // Emit the body into its own function.
+  auto voidPtrTy = llvm::Type::getInt8PtrTy(getContext());
+  auto bodyTy = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(getContext()), {LongTy_, voidPtrTy}, false);
+  auto bodyFn = llvm::Function::Create(
+      bodyTy, llvm::Function::PrivateLinkage, "parallel_body", module_.get());
+
+  auto callerFn = fn_;
+  auto callerBB = irb_.GetInsertBlock();
+  auto callerVarToArg = std::move(varToArg_);
+  auto callerVarToVal = std::move(varToVal_);
+  varToArg_.clear();
+  varToVal_.clear();
+
+  fn_ = bodyFn;
+  irb_.SetInsertPoint(llvm::BasicBlock::Create(getContext(), "entry", fn_));
+  auto bodyPacked =
+      irb_.CreatePointerCast(fn_->arg_begin() + 1, packedTy->getPointerTo());
+  for (size_t i = 0; i < capturedVars.size(); i++) {
+    varToVal_.emplace(
+        capturedVars[i],
+        irb_.CreateLoad(
+            capturedTys[i], irb_.CreateStructGEP(packedTy, bodyPacked, i)));
+  }
+  varToVal_.emplace(v->var(), irb_.CreateTrunc(fn_->arg_begin(), IntTy_));
+  v->body()->accept(this);
+  irb_.CreateRetVoid();
+  if (llvm::verifyFunction(*bodyFn, &llvm::outs())) {
+    throw std::runtime_error("Function verification failed");
+  }
+
+  fn_ = callerFn;
+  varToArg_ = std::move(callerVarToArg);
+  varToVal_ = std::move(callerVarToVal);
+  irb_.SetInsertPoint(callerBB);
+
+  // Call the runtime.
+  auto runtimeTy = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(getContext()),
+      {bodyFn->getType(), LongTy_, LongTy_, voidPtrTy},
+      false);
+  llvm::FunctionCallee runtime =
+      module_->getOrInsertFunction("nnc_parallel_for", runtimeTy);
+  irb_.CreateCall(
+      runtime, {bodyFn, start, stop, irb_.CreatePointerCast(packed, voidPtrTy)});
+  value_ = llvm::ConstantInt::get(IntTy_, 0);
+}
+
 void LLVMCodeGenImpl::visit(const Block* v) {
   for (auto pair : v->varBindings()) {
     const Var* v = pair.first;
@@ -1208,6 +1355,13 @@ void LLVMCodeGenImpl::visit(const Intrinsics* v) {
         return;
       } break;
 
+      // Lowered to roundps on x86 and frintx on aarch64, also for vectors
+      case kRint: {
+        v->params().front()->accept(this);
+        value_ = irb_.CreateUnaryIntrinsic(llvm::Intrinsic::rint, value_);
+        return;
+      } break;
+
 #if defined(__AVX__) && !defined(_MSC_VER)
 #define SIMD_UNARY_MATH_CASE(enum, name, type)                               \
   case enum: {                                                               \
@@ -1433,6 +1587,12 @@ void LLVMCodeGenImpl::visit(const Intrinsics* v) {
         return;
       } break;
 
+      case kRint: {
+        v->params().front()->accept(this);
+        value_ = irb_.CreateUnaryIntrinsic(llvm::Intrinsic::rint, value_);
+        return;
+      } break;
+
 #if defined(__AVX__) && !defined(_MSC_VER)
 #define SIMD_BINARY_MATH_CASE(enum, name, type)                              \
   case enum: {                                                               \
@@ -1602,6 +1762,20 @@ void LLVMCodeGenImpl::optimize(llvm::Module& M) {
   }
   FPM.doFinalization();
   PM.run(M);
+
+#if DEBUG_PRINT
+  llvm::errs() << M;
+  llvm::SmallVector<char, 0> asmBuffer;
+  llvm::raw_svector_ostream asmStream(asmBuffer);
+  llvm::legacy::PassManager AsmPM;
+  TM_->addPassesToEmitFile(
+      AsmPM,
+      asmStream,
+      nullptr,
+      llvm::TargetMachine::CodeGenFileType::CGFT_AssemblyFile);
+  AsmPM.run(M);
+  llvm::errs() << asmStream.str();
+#endif
 }
 
 RegisterCodeGen<LLVMCodeGen> llvm_codegen_reg("llvm_codegen");
@@ -2,6 +2,7 @@
 
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
+#include <ATen/Parallel.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <sleef.h>
 #include <algorithm>
@@ -9,6 +10,19 @@
 #include <string>
 #include <vector>
 
+// Runtime support for parallel loops, see LLVMCodeGenImpl::emitParallelFor.
+static void nnc_parallel_for(
+    void (*body)(int64_t, void*),
+    int64_t start,
+    int64_t stop,
+    void* packed_args) {
+  at::parallel_for(start, stop, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      body(i, packed_args);
+    }
+  });
+}
+
 namespace llvm {
 namespace orc {
 
@@ -76,6 +90,9 @@ class TORCH_API PytorchLLVMJITImpl {
     cantFail(LLJ->defineAbsolute(
         *Mangle("remainderf"),
         {llvm::pointerToJITTargetAddress(&remainderf), {}}));
+    cantFail(LLJ->defineAbsolute(
+        *Mangle("nnc_parallel_for"),
+        {llvm::pointerToJITTargetAddress(&nnc_parallel_for), {}}));
 
     // FP32 Sleef functions -- SSE
     cantFail(LLJ->defineAbsolute(
@@ -425,6 +442,10 @@ class TORCH_API PytorchLLVMJITImpl {
     return Error::success();
   }
 
+  Error addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+    return LLJ->addObjectFile(std::move(Obj));
+  }
+
   JITSymbol findSymbol(const std::string Name) {
     return cantFail(LLJ->lookup(Name));
   }
@@ -443,6 +464,10 @@ Error PytorchLLVMJIT::addModule(ThreadSafeModule M) {
   return impl_->addModule(std::move(M));
 }
 
+Error PytorchLLVMJIT::addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+  return impl_->addObjectFile(std::move(Obj));
+}
+
 JITSymbol PytorchLLVMJIT::findSymbol(const std::string Name) {
   return impl_->findSymbol(std::move(Name));
 }
@@ -43,6 +43,10 @@ class TORCH_API LoopNest {
   void setGPUBlockIndex(For* f, int idx);
   void setGPUThreadIndex(For* f, int idx);
 
+  // Runs the iterations of F concurrently. F must not carry a dependence
+  // between its iterations; use rfactor to split a reduction first.
+  void setParallel(For* f);
+
   // Insert a temporary computation of statement S in the scope of loop AT.
   // S is assumed to be a Store or a Block containing a Store. Along with the
   // computation itself, this transformation inserts Alloc/Free statements for
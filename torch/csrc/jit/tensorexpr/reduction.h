@@ -191,7 +191,7 @@ static ExprHandle minimumVal(ScalarType type) {
   switch (type) {
 #define MAX_BY_TYPE_CASE(Type, Name) \
   case ScalarType::Name:             \
-    return ExprHandle(std::numeric_limits<Type>::min());
+    return ExprHandle(std::numeric_limits<Type>::lowest());
     AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, MAX_BY_TYPE_CASE)
 #undef MAX_BY_TYPE_CASE
     default:
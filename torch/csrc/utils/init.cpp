@@ -3,6 +3,7 @@
 #include <torch/csrc/utils/throughput_benchmark.h>
 
 #include <pybind11/functional.h>
+#include <pybind11/stl.h>
 
 namespace torch {
 namespace throughput_benchmark {
@@ -17,11 +18,19 @@ void initThroughputBenchmarkBindings(PyObject* module) {
       .def_readwrite("num_worker_threads", &BenchmarkConfig::num_worker_threads)
       .def_readwrite("num_warmup_iters", &BenchmarkConfig::num_warmup_iters)
       .def_readwrite("num_iters", &BenchmarkConfig::num_iters)
-      .def_readwrite("profiler_output_path", &BenchmarkConfig::profiler_output_path);
+      .def_readwrite("profiler_output_path", &BenchmarkConfig::profiler_output_path)
+      .def_readwrite("arrival_rate", &BenchmarkConfig::arrival_rate)
+      .def_readwrite("arrival_times_ms", &BenchmarkConfig::arrival_times_ms)
+      .def_readwrite("seed", &BenchmarkConfig::seed);
 
   py::class_<BenchmarkExecutionStats>(m, "BenchmarkExecutionStats")
       .def_readonly("latency_avg_ms", &BenchmarkExecutionStats::latency_avg_ms)
-      .def_readonly("num_iters", &BenchmarkExecutionStats::num_iters);
+      .def_readonly("num_iters", &BenchmarkExecutionStats::num_iters)
+      .def_readonly("latency_p50_ms", &BenchmarkExecutionStats::latency_p50_ms)
+      .def_readonly("latency_p90_ms", &BenchmarkExecutionStats::latency_p90_ms)
+      .def_readonly("latency_p99_ms", &BenchmarkExecutionStats::latency_p99_ms)
+      .def_readonly("latency_max_ms", &BenchmarkExecutionStats::latency_max_ms)
+      .def_readonly("total_time_ms", &BenchmarkExecutionStats::total_time_ms);
 
   py::class_<ThroughputBenchmark>(m, "ThroughputBenchmark", py::dynamic_attr())
       .def(py::init<jit::Module>())
@@ -46,6 +55,14 @@ void initThroughputBenchmarkBindings(PyObject* module) {
         return self.benchmark(config);
       });
 
+  m.def(
+      "_benchmark_mix",
+      [](const std::vector<ThroughputBenchmark*>& benchmarks,
+         const std::vector<double>& weights,
+         BenchmarkConfig config) {
+        pybind11::gil_scoped_release no_gil_guard;
+        return benchmarkMix(benchmarks, weights, config);
+      });
 
 }
 
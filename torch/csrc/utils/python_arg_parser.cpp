@@ -9,6 +9,7 @@
 #include <ATen/ATen.h>
 #include <ATen/TracerMode.h>
 
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -767,6 +768,41 @@ void PythonArgParser::check_deprecated(const FunctionSignature & signature) {
   }
 }
 
+static bool overload_cache_enabled_ = true;
+
+void set_overload_cache_enabled(bool enabled) {
+  overload_cache_enabled_ = enabled;
+}
+
+bool overload_cache_enabled() {
+  return overload_cache_enabled_;
+}
+
+// Writes the types of the positional arguments to arg_types. Returns false if
+// which signature the arguments match may depend on more than these types.
+static bool get_arg_types(PyObject* args, uintptr_t arg_types[]) {
+  auto nargs = PyTuple_GET_SIZE(args);
+  for (ssize_t i = 0; i < nargs; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(args, i);
+    auto type = reinterpret_cast<uintptr_t>(Py_TYPE(obj));
+    if (THPVariable_CheckExact(obj)) {
+      // 0-dim tensors that don't require grad also match number parameters,
+      // see FunctionParameter::check. Type objects are aligned, so the low
+      // bits are free.
+      const auto& var = reinterpret_cast<THPVariable*>(obj)->cdata;
+      if (!var.requires_grad() && var.dim() == 0) {
+        type |= at::isIntegralType(var.scalar_type(), /*includeBool=*/false) ? 2 : 1;
+      }
+    } else if (!PyLong_CheckExact(obj) && !PyFloat_CheckExact(obj) &&
+               !PyBool_Check(obj) && obj != Py_None) {
+      // e.g. the elements of lists decide whether they match Dimname lists
+      return false;
+    }
+    arg_types[i] = type;
+  }
+  return true;
+}
+
 PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
@@ -775,8 +811,40 @@ PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject
     return PythonArgs(traceable, signature, parsed_args);
   }
 
-  for (auto& signature : signatures_) {
+  // Calls usually pass arguments of the same few combinations of types,
+  // which match the same signatures every time. For tensors, ints, floats,
+  // bools and None the types decide which signatures match, so a call with
+  // the same types as a recent call matches the same signature first.
+  uintptr_t arg_types[kMaxCachedArgs];
+  auto nargs = PyTuple_GET_SIZE(args);
+  bool cacheable = overload_cache_enabled_ &&
+      (!kwargs || PyDict_Size(kwargs) == 0) &&
+      nargs <= kMaxCachedArgs && get_arg_types(args, arg_types);
+  if (cacheable) {
+    for (const auto& cached : cached_overloads_) {
+      if (cached.signature < 0 || cached.nargs != nargs ||
+          !std::equal(arg_types, arg_types + nargs, cached.arg_types.begin())) {
+        continue;
+      }
+      auto& signature = signatures_[cached.signature];
+      if (signature.parse(args, kwargs, parsed_args, false)) {
+        check_deprecated(signature);
+        return PythonArgs(traceable, signature, parsed_args);
+      }
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < signatures_.size(); i++) {
+    auto& signature = signatures_[i];
     if (signature.parse(args, kwargs, parsed_args, false)) {
+      if (cacheable) {
+        auto& cached = cached_overloads_[next_cached_overload_];
+        next_cached_overload_ = (next_cached_overload_ + 1) % cached_overloads_.size();
+        cached.signature = i;
+        cached.nargs = nargs;
+        std::copy(arg_types, arg_types + nargs, cached.arg_types.begin());
+      }
       check_deprecated(signature);
       return PythonArgs(traceable, signature, parsed_args);
     }
@@ -112,8 +112,24 @@ private:
   std::string function_name;
   ssize_t max_args;
   bool traceable;
+
+  // The signatures matched by recent calls without keyword arguments, by the
+  // types of their arguments, see raw_parse. Parsing always holds the GIL.
+  static constexpr ssize_t kMaxCachedArgs = 6;
+  struct CachedOverload {
+    ssize_t signature = -1;
+    ssize_t nargs = 0;
+    std::array<uintptr_t, kMaxCachedArgs> arg_types;
+  };
+  std::array<CachedOverload, 4> cached_overloads_;
+  size_t next_cached_overload_ = 0;
 };
 
+// Enables trying the signature matched by the last call first when the
+// arguments have the same types. Enabled by default.
+void set_overload_cache_enabled(bool enabled);
+bool overload_cache_enabled();
+
 struct PYBIND11_EXPORT FunctionSignature {
   explicit FunctionSignature(const std::string& fmt, int index);
 
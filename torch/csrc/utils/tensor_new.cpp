@@ -18,12 +18,16 @@
 #include <ATen/ATen.h>
 #include <ATen/InitialTensorOptions.h>
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/Parallel.h>
 #include <ATen/TracerMode.h>
 #include <c10/core/Backend.h>
 #include <c10/core/Layout.h>
 #include <c10/util/Exception.h>
 #include <c10/util/Optional.h>
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -231,6 +235,65 @@ void recursive_store(char* data, IntArrayRef sizes, IntArrayRef strides, int64_t
   }
 }
 
+#ifdef USE_NUMPY
+// Creates the tensor of a list or tuple of NumPy arrays of the same shape and
+// dtype with a single allocation and a bulk copy of every array, instead of
+// storing their elements one by one. Returns an undefined tensor for other
+// data.
+Tensor stack_numpy_arrays(
+    PyObject* data,
+    ScalarType scalar_type,
+    bool type_inference,
+    bool pin_memory) {
+  if (!PyList_Check(data) && !PyTuple_Check(data)) {
+    return Tensor();
+  }
+  auto seq = THPObjectPtr(PySequence_Fast(data, "not a sequence"));
+  if (!seq) throw python_error();
+  auto n = PySequence_Fast_GET_SIZE(seq.get());
+  PyObject** items = PySequence_Fast_ITEMS(seq.get());
+  if (n == 0 || !PyArray_Check(items[0])) {
+    return Tensor();
+  }
+  auto first = (PyArrayObject*)items[0];
+  if (!is_numpy_dtype_supported(PyArray_TYPE(first))) {
+    return Tensor();
+  }
+  for (Py_ssize_t i = 1; i < n; i++) {
+    if (!PyArray_Check(items[i])) {
+      return Tensor();
+    }
+    auto array = (PyArrayObject*)items[i];
+    if (PyArray_TYPE(array) != PyArray_TYPE(first) || !PyArray_SAMESHAPE(array, first)) {
+      return Tensor();
+    }
+  }
+
+  std::vector<Tensor> arrays;
+  arrays.reserve(n);
+  for (Py_ssize_t i = 0; i < n; i++) {
+    bool copied = false;
+    arrays.push_back(tensor_from_numpy_or_copy(items[i], &copied, /*warn_if_not_writeable=*/false));
+  }
+  auto sizes = arrays[0].sizes().vec();
+  sizes.insert(sizes.begin(), n);
+  ScalarType inferred_scalar_type = type_inference ? arrays[0].scalar_type() : scalar_type;
+  Tensor tensor;
+  {
+    at::AutoNonVariableTypeMode guard;  // TODO: remove
+    at::tracer::impl::NoTracerDispatchMode tracer_guard;
+    tensor = at::empty(sizes, at::initialTensorOptions().dtype(inferred_scalar_type).pinned_memory(pin_memory));
+    pybind11::gil_scoped_release no_gil;
+    at::parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        tensor.select(0, i).copy_(arrays[i]);
+      }
+    });
+  }
+  return tensor;
+}
+#endif
+
 Tensor internal_new_from_data(
     c10::DispatchKey dispatch_key,
     at::ScalarType scalar_type,
@@ -273,12 +336,21 @@ Tensor internal_new_from_data(
 
   if (PyArray_Check(data)) {
     TORCH_CHECK(!pin_memory, "Can't pin tensor constructed from numpy");
-    auto tensor = tensor_from_numpy(data);
+    bool copied = false;
+    auto tensor = tensor_from_numpy_or_copy(data, &copied);
     const auto& inferred_scalar_type = type_inference ? tensor.scalar_type() : scalar_type;
     auto device = device_opt.has_value() ? *device_opt : at::Device(computeDeviceType(dispatch_key));
     pybind11::gil_scoped_release no_gil;
     maybe_initialize_cuda(device);
-    return tensor.to(device, inferred_scalar_type, /*non_blocking=*/false, /*copy=*/copy_numpy);
+    return tensor.to(device, inferred_scalar_type, /*non_blocking=*/false, /*copy=*/copy_numpy && !copied);
+  }
+
+  auto stacked = stack_numpy_arrays(data, scalar_type, type_inference, pin_memory);
+  if (stacked.defined()) {
+    auto device = device_opt.has_value() ? *device_opt : at::Device(computeDeviceType(dispatch_key));
+    pybind11::gil_scoped_release no_gil;
+    maybe_initialize_cuda(device);
+    return stacked.to(device, stacked.scalar_type(), /*non_blocking=*/false, /*copy=*/false);
   }
 #endif
 
@@ -694,6 +766,83 @@ Tensor as_tensor(c10::DispatchKey dispatch_key, at::ScalarType scalar_type, PyOb
   throw std::runtime_error("tensor(): invalid arguments");
 }
 
+Tensor tensor_frombuffer(at::ScalarType scalar_type, PyObject* args, PyObject* kwargs) {
+  static PythonArgParser parser({
+    "frombuffer(PyObject* buffer, *, ScalarType dtype=None, int64_t count=-1, int64_t offset=0, bool requires_grad=False)",
+  });
+
+  ParsedArgs<5> parsed_args;
+  auto r = parser.parse(args, kwargs, parsed_args);
+  auto dtype = r.scalartypeWithDefault(1, scalar_type);
+  auto count = r.toInt64(2);
+  auto offset = r.toInt64(3);
+  auto element_size = static_cast<int64_t>(c10::elementSize(dtype));
+
+  // Keeps the buffer exported for as long as the tensor uses its memory
+  auto view = std::make_unique<Py_buffer>();
+  bool writable = true;
+  if (PyObject_GetBuffer(r.pyobject(0), view.get(), PyBUF_WRITABLE) < 0) {
+    PyErr_Clear();
+    writable = false;
+    if (PyObject_GetBuffer(r.pyobject(0), view.get(), PyBUF_SIMPLE) < 0) {
+      throw python_error();
+    }
+  }
+  auto release = [](Py_buffer* view) {
+    PyBuffer_Release(view);
+    delete view;
+  };
+  std::unique_ptr<Py_buffer, decltype(release)> held(view.release(), release);
+
+  auto len = static_cast<int64_t>(held->len);
+  if (offset < 0 || offset > len) {
+    throw ValueError("offset must be non-negative and no greater than buffer length (%lld), but got %lld",
+        (long long)len, (long long)offset);
+  }
+  if (count < 0) {
+    if ((len - offset) % element_size != 0) {
+      throw ValueError("buffer length (%lld) after offset (%lld) must be a multiple of element size (%lld)",
+          (long long)len, (long long)offset, (long long)element_size);
+    }
+    count = (len - offset) / element_size;
+  } else if (offset + count * element_size > len) {
+    throw ValueError("requested buffer length (%lld * %lld) after offset (%lld) is greater than buffer length (%lld)",
+        (long long)count, (long long)element_size, (long long)offset, (long long)len);
+  }
+  if (!writable) {
+    TORCH_WARN_ONCE(
+      "The given buffer is not writable, and PyTorch does not support "
+      "non-writable tensors. This means you can write to the underlying "
+      "(supposedly non-writable) buffer using the tensor. You may want to "
+      "copy the buffer to protect its data or make it writable before "
+      "converting it to a tensor. This type of warning will be suppressed "
+      "for the rest of this program.");
+  }
+
+  char* data = static_cast<char*>(held->buf) + offset;
+  auto options = at::device(kCPU).dtype(dtype);
+  Tensor tensor;
+  if (reinterpret_cast<uintptr_t>(data) % element_size == 0) {
+    // Shares the memory of the buffer
+    auto* raw_view = held.release();
+    tensor = at::from_blob(
+        data,
+        {count},
+        [raw_view](void*) {
+          pybind11::gil_scoped_acquire gil;
+          PyBuffer_Release(raw_view);
+          delete raw_view;
+        },
+        options);
+  } else {
+    // Kernels assume aligned elements, so misaligned data is copied
+    tensor = at::empty({count}, options);
+    std::memcpy(tensor.data_ptr(), data, count * element_size);
+  }
+  tensor.set_requires_grad(r.toBool(4));
+  return tensor;
+}
+
 Tensor new_tensor(c10::DispatchKey dispatch_key, at::ScalarType scalar_type, PyObject* args, PyObject* kwargs) {
   static PythonArgParser parser({
     "new_tensor(PyObject* data, *, ScalarType dtype=None, Device? device=None, bool requires_grad=False)",
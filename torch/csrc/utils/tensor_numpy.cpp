@@ -7,7 +7,10 @@ namespace torch { namespace utils {
 PyObject* tensor_to_numpy(const at::Tensor& tensor) {
   throw std::runtime_error("PyTorch was compiled without NumPy support");
 }
-at::Tensor tensor_from_numpy(PyObject* obj) {
+at::Tensor tensor_from_numpy(PyObject* obj, bool warn_if_not_writeable) {
+  throw std::runtime_error("PyTorch was compiled without NumPy support");
+}
+at::Tensor tensor_from_numpy_or_copy(PyObject* obj, bool* copied, bool warn_if_not_writeable) {
   throw std::runtime_error("PyTorch was compiled without NumPy support");
 }
 bool is_numpy_int(PyObject* obj) {
@@ -125,13 +128,13 @@ PyObject* tensor_to_numpy(const at::Tensor& tensor) {
   return array.release();
 }
 
-at::Tensor tensor_from_numpy(PyObject* obj) {
+at::Tensor tensor_from_numpy(PyObject* obj, bool warn_if_not_writeable) {
   if (!PyArray_Check(obj)) {
     throw TypeError("expected np.ndarray (got %s)", Py_TYPE(obj)->tp_name);
   }
   auto array = (PyArrayObject*)obj;
 
-  if (!PyArray_ISWRITEABLE(array)) {
+  if (warn_if_not_writeable && !PyArray_ISWRITEABLE(array)) {
     TORCH_WARN_ONCE(
       "The given NumPy array is not writeable, and PyTorch does "
       "not support non-writeable tensors. This means you can write to the "
@@ -188,6 +191,44 @@ at::Tensor tensor_from_numpy(PyObject* obj) {
   );
 }
 
+static bool is_viewable(PyArrayObject* array) {
+  if (!PyArray_EquivByteorders(PyArray_DESCR(array)->byteorder, NPY_NATIVE) ||
+      !PyArray_ISALIGNED(array)) {
+    return false;
+  }
+  auto element_size_in_bytes = PyArray_ITEMSIZE(array);
+  for (int i = 0; i < PyArray_NDIM(array); i++) {
+    auto stride = PyArray_STRIDES(array)[i];
+    if (stride < 0 || stride % element_size_in_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+at::Tensor tensor_from_numpy_or_copy(PyObject* obj, bool* copied, bool warn_if_not_writeable) {
+  if (!PyArray_Check(obj)) {
+    throw TypeError("expected np.ndarray (got %s)", Py_TYPE(obj)->tp_name);
+  }
+  auto array = (PyArrayObject*)obj;
+  *copied = false;
+  if (is_viewable(array)) {
+    return tensor_from_numpy(obj, warn_if_not_writeable);
+  }
+  // The copy has the same dtype in native byte order; PyArray_FromAny steals
+  // the reference to the descriptor.
+  auto copy = THPObjectPtr(PyArray_FromAny(
+      obj,
+      PyArray_DescrFromType(PyArray_TYPE(array)),
+      0,
+      0,
+      NPY_ARRAY_DEFAULT | NPY_ARRAY_ENSURECOPY,
+      nullptr));
+  if (!copy) throw python_error();
+  *copied = true;
+  return tensor_from_numpy(copy.get());
+}
+
 int aten_to_numpy_dtype(const ScalarType scalar_type) {
   switch (scalar_type) {
     case kDouble: return NPY_DOUBLE;
@@ -206,7 +247,7 @@ int aten_to_numpy_dtype(const ScalarType scalar_type) {
   }
 }
 
-ScalarType numpy_dtype_to_aten(int dtype) {
+static c10::optional<ScalarType> maybe_numpy_dtype_to_aten(int dtype) {
   switch (dtype) {
     case NPY_DOUBLE: return kDouble;
     case NPY_FLOAT: return kFloat;
@@ -234,6 +275,17 @@ ScalarType numpy_dtype_to_aten(int dtype) {
         break;  // break as if this is one of the cases above because this is only a workaround
       }
   }
+  return c10::nullopt;
+}
+
+bool is_numpy_dtype_supported(int dtype) {
+  return maybe_numpy_dtype_to_aten(dtype).has_value();
+}
+
+ScalarType numpy_dtype_to_aten(int dtype) {
+  if (auto scalar_type = maybe_numpy_dtype_to_aten(dtype)) {
+    return *scalar_type;
+  }
   auto pytype = THPObjectPtr(PyArray_TypeObjectFromType(dtype));
   if (!pytype) throw python_error();
   throw TypeError(
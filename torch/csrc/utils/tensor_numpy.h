@@ -6,11 +6,20 @@
 namespace torch { namespace utils {
 
 PyObject* tensor_to_numpy(const at::Tensor& tensor);
-at::Tensor tensor_from_numpy(PyObject* obj);
+// Warns once if the array is not writeable, unless warn_if_not_writeable is
+// false because the caller copies the tensor right away.
+at::Tensor tensor_from_numpy(PyObject* obj, bool warn_if_not_writeable=true);
+// Like tensor_from_numpy, but arrays that a tensor can't view (non-native byte
+// order, misaligned data, negative strides or strides that aren't a multiple of
+// the element size) are first copied by NumPy into a new C-contiguous array.
+// Sets *copied to whether that happened.
+at::Tensor tensor_from_numpy_or_copy(PyObject* obj, bool* copied, bool warn_if_not_writeable=true);
 
 int aten_to_numpy_dtype(const at::ScalarType scalar_type);
 at::ScalarType numpy_dtype_to_aten(int dtype);
 
+bool is_numpy_dtype_supported(int dtype);
+
 bool is_numpy_int(PyObject* obj);
 bool is_numpy_scalar(PyObject* obj);
 
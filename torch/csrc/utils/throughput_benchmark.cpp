@@ -3,11 +3,21 @@
 #include <pybind11/pybind11.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
 namespace torch {
 namespace throughput_benchmark {
 
 std::ostream& operator<<(std::ostream& os, const BenchmarkExecutionStats& value) {
     return os << "Average latency / iter (ms): " << value.latency_avg_ms
+              << "\n Latency p50 / p90 / p99 / max (ms): "
+              << value.latency_p50_ms << " / " << value.latency_p90_ms << " / "
+              << value.latency_p99_ms << " / " << value.latency_max_ms
               << "\n Total number of iters: " << value.num_iters;
 }
 
@@ -61,8 +71,252 @@ BenchmarkExecutionStats ThroughputBenchmark::benchmark(
   }
 }
 
+detail::RequestRunner ThroughputBenchmark::prepare(
+    int64_t num_inputs,
+    std::mt19937& engine) const {
+  CHECK(script_module_.initialized() ^ module_.initialized());
+  if (script_module_.initialized()) {
+    return script_module_.prepare(num_inputs, engine);
+  } else {
+    CHECK(module_.initialized());
+    return module_.prepare(num_inputs, engine);
+  }
+}
+
+std::vector<BenchmarkExecutionStats> benchmarkMix(
+    const std::vector<ThroughputBenchmark*>& benchmarks,
+    const std::vector<double>& weights,
+    const BenchmarkConfig& config) {
+  TORCH_CHECK(!benchmarks.empty(), "Please provide modules to benchmark");
+  TORCH_CHECK(
+      benchmarks.size() == weights.size(),
+      "Expected a weight for each of the ", benchmarks.size(),
+      " modules, but got ", weights.size());
+  TORCH_CHECK(
+      config.num_worker_threads == 1,
+      "Only parallelization by callers is supported");
+
+  auto engine = detail::makeBenchmarkEngine(config);
+  const auto plan = detail::makeBenchmarkPlan(config, weights, engine);
+  std::vector<detail::RequestRunner> runners;
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    runners.push_back(benchmarks[i]->prepare(plan.num_inputs[i], engine));
+  }
+  const auto run = detail::runBenchmark(runners, plan, config);
+
+  std::vector<BenchmarkExecutionStats> stats;
+  stats.push_back(detail::makeBenchmarkStats(run, plan, config, -1));
+  for (size_t i = 0; i < benchmarks.size(); ++i) {
+    stats.push_back(detail::makeBenchmarkStats(run, plan, config, i));
+  }
+  return stats;
+}
+
 namespace detail {
 
+std::mt19937 makeBenchmarkEngine(const BenchmarkConfig& config) {
+  if (config.seed != 0) {
+    return std::mt19937(config.seed);
+  }
+  std::random_device seeder;
+  return std::mt19937(seeder());
+}
+
+BenchmarkPlan makeBenchmarkPlan(
+    const BenchmarkConfig& config,
+    const std::vector<double>& weights,
+    std::mt19937& engine) {
+  TORCH_CHECK(
+      config.num_calling_threads > 0,
+      "num_calling_threads must be positive");
+  TORCH_CHECK(config.arrival_rate >= 0, "arrival_rate must be non-negative");
+  BenchmarkPlan plan;
+  plan.num_inputs.resize(weights.size(), 0);
+  std::discrete_distribution<size_t> pick_model(weights.begin(), weights.end());
+  auto add_request = [&](std::vector<BenchmarkRequest>& requests) {
+    const size_t model = pick_model(engine);
+    requests.push_back({model, plan.num_inputs[model]++});
+  };
+
+  for (int64_t i = 0;
+       i < int64_t(config.num_calling_threads) * config.num_warmup_iters;
+       ++i) {
+    add_request(plan.warmup);
+  }
+
+  int64_t num_requests = config.num_iters;
+  if (!config.arrival_times_ms.empty()) {
+    TORCH_CHECK(
+        config.arrival_rate == 0,
+        "arrival_rate and arrival_times_ms can't be used together");
+    TORCH_CHECK(
+        std::is_sorted(
+            config.arrival_times_ms.begin(), config.arrival_times_ms.end()),
+        "arrival_times_ms must be in increasing order");
+    plan.arrival_times_ms = config.arrival_times_ms;
+    num_requests = plan.arrival_times_ms.size();
+  } else if (config.arrival_rate > 0) {
+    std::exponential_distribution<double> interval_ms(
+        config.arrival_rate / 1000.0);
+    double arrival_ms = 0;
+    for (int64_t i = 0; i < num_requests; ++i) {
+      arrival_ms += interval_ms(engine);
+      plan.arrival_times_ms.push_back(arrival_ms);
+    }
+  }
+  for (int64_t i = 0; i < num_requests; ++i) {
+    add_request(plan.requests);
+  }
+  return plan;
+}
+
+BenchmarkRun runBenchmark(
+    const std::vector<RequestRunner>& runners,
+    const BenchmarkPlan& plan,
+    const BenchmarkConfig& config) {
+  using Clock = std::chrono::steady_clock;
+  const bool open_loop = !plan.arrival_times_ms.empty();
+  const int64_t num_requests = plan.requests.size();
+  BenchmarkRun run;
+  run.latencies_ms.resize(num_requests);
+
+  std::mutex m;
+  std::condition_variable worker_main_cv;
+  std::condition_variable main_worker_cv;
+  // TODO: add GUARDED_BY once it is available
+  int64_t initialized{0};
+  int64_t finished{0};
+  bool start{false};
+  Clock::time_point start_time;
+  // Requests are taken in the order they arrive by whichever calling thread
+  // is free, like a queue served by num_calling_threads servers
+  std::atomic<int64_t> next_request{0};
+  std::vector<std::thread> callers;
+
+  for (auto thread_id = 0; thread_id < config.num_calling_threads;
+       ++thread_id) {
+    callers.emplace_back([&, thread_id]() {
+      // We use conditional variable as a barrier to make sure each thread
+      // performs required warmeup iterations before we start measuring
+      for (size_t i = thread_id; i < plan.warmup.size();
+           i += config.num_calling_threads) {
+        runners[plan.warmup[i].model](plan.warmup[i].input_idx);
+      }
+      Clock::time_point thread_start_time;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        ++initialized;
+        worker_main_cv.notify_one();
+        while (!start) {
+          main_worker_cv.wait(lock);
+        }
+        thread_start_time = start_time;
+      }
+      LOG(INFO) << "Starting forward thread " << thread_id;
+      int64_t i;
+      while ((i = next_request.fetch_add(1)) < num_requests) {
+        Clock::time_point begin;
+        if (open_loop) {
+          begin = thread_start_time +
+              std::chrono::duration_cast<Clock::duration>(
+                      std::chrono::duration<double, std::milli>(
+                          plan.arrival_times_ms[i]));
+          std::this_thread::sleep_until(begin);
+        } else {
+          begin = Clock::now();
+        }
+        runners[plan.requests[i].model](plan.requests[i].input_idx);
+        run.latencies_ms[i] =
+            std::chrono::duration<float, std::milli>(Clock::now() - begin)
+                .count();
+      }
+
+      {
+        std::unique_lock<std::mutex> lock(m);
+        ++finished;
+        worker_main_cv.notify_one();
+        LOG(INFO) << "Shutting down forward thread " << thread_id
+                  << ". Total number of finished threads: " << finished;
+      }
+    });
+  }
+
+  std::unique_ptr<torch::autograd::profiler::RecordProfile> profiler_guard;
+  {
+    std::unique_lock<std::mutex> lock(m);
+    while (initialized != config.num_calling_threads) {
+      worker_main_cv.wait(lock);
+    }
+    if (!config.profiler_output_path.empty()) {
+      LOG(INFO) << "Using Autograd profiler. Trace will be saved to "
+                << config.profiler_output_path;
+      profiler_guard.reset(new torch::autograd::profiler::RecordProfile(
+        config.profiler_output_path));
+    }
+    LOG(INFO) << "Starting threads";
+    start = true;
+    start_time = Clock::now();
+  }
+
+  main_worker_cv.notify_all();
+  {
+    std::unique_lock<std::mutex> lock(m);
+    worker_main_cv.wait(
+        lock, [&]() { return finished == config.num_calling_threads; });
+  }
+  auto end_time = Clock::now();
+  profiler_guard.reset();
+  LOG(INFO) << "Finished benchmark";
+
+  run.total_time_ms =
+      std::chrono::duration<float, std::milli>(end_time - start_time).count();
+  for (auto& t : callers) {
+    t.join();
+  }
+  return run;
+}
+
+BenchmarkExecutionStats makeBenchmarkStats(
+    const BenchmarkRun& run,
+    const BenchmarkPlan& plan,
+    const BenchmarkConfig& config,
+    int64_t model) {
+  std::vector<float> latencies_ms;
+  for (size_t i = 0; i < plan.requests.size(); ++i) {
+    if (model < 0 || plan.requests[i].model == static_cast<size_t>(model)) {
+      latencies_ms.push_back(run.latencies_ms[i]);
+    }
+  }
+
+  BenchmarkExecutionStats stats;
+  stats.num_iters = latencies_ms.size();
+  stats.total_time_ms = run.total_time_ms;
+  if (latencies_ms.empty()) {
+    return stats;
+  }
+  if (model < 0 && plan.arrival_times_ms.empty()) {
+    // In the closed loop mode the calling threads are always busy, so the
+    // wall time per request and thread is the latency without the overhead
+    // of timing each of them
+    stats.latency_avg_ms =
+        run.total_time_ms * config.num_calling_threads / stats.num_iters;
+  } else {
+    stats.latency_avg_ms =
+        std::accumulate(latencies_ms.begin(), latencies_ms.end(), 0.0) /
+        latencies_ms.size();
+  }
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  auto percentile = [&](double p) {
+    return latencies_ms[std::min<size_t>(
+        latencies_ms.size() - 1, p * latencies_ms.size())];
+  };
+  stats.latency_p50_ms = percentile(0.5);
+  stats.latency_p90_ms = percentile(0.9);
+  stats.latency_p99_ms = percentile(0.99);
+  stats.latency_max_ms = latencies_ms.back();
+  return stats;
+}
+
 template <>
 void ScriptModuleBenchmark::runOnce(ScriptModuleInput&& input) const {
   CHECK(initialized_);
@@ -6,8 +6,10 @@
 
 #include <torch/csrc/jit/python/pybind_utils.h>
 
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -23,6 +25,15 @@ namespace throughput_benchmark {
 struct BenchmarkExecutionStats {
   float latency_avg_ms{-1};
   int64_t num_iters{-1};
+  // Percentiles of the latency of the measured iterations. In the open loop
+  // mode the latency of a request counts from its arrival, so it includes the
+  // time the request waited for a free calling thread.
+  float latency_p50_ms{-1};
+  float latency_p90_ms{-1};
+  float latency_p99_ms{-1};
+  float latency_max_ms{-1};
+  // Wall time of the measured part of the run
+  float total_time_ms{-1};
 };
 
 std::ostream& operator<<(std::ostream& os, const BenchmarkExecutionStats& value);
@@ -57,10 +68,72 @@ struct BenchmarkConfig {
   // before the main benchmark loop (but after the warmup):
   // RecordProfile guard(profiler_output_path);
   std::string profiler_output_path{""};
+  // Requests per second of the open loop mode. If positive, num_iters requests
+  // arrive at exponentially distributed intervals (a Poisson process) no matter
+  // how fast they are served, and wait for a free calling thread. If 0, each
+  // calling thread sends its next request as soon as the previous one is done
+  // (closed loop), which hides queueing.
+  double arrival_rate{0};
+  // Arrival times of the requests in milliseconds from the start of the run,
+  // in increasing order, to replay a trace instead of Poisson arrivals. The
+  // number of requests is its size rather than num_iters.
+  std::vector<double> arrival_times_ms;
+  // Seed for the arrivals and the choice of inputs and models, 0 picks one
+  // at random
+  uint64_t seed{0};
 };
 
 namespace detail {
 
+// Runs the pre-generated input `input_idx` of a model
+using RequestRunner = std::function<void(int64_t input_idx)>;
+
+struct BenchmarkRequest {
+  size_t model;
+  int64_t input_idx;
+};
+
+/**
+ * The requests of a run: which model each of them goes to and, in the open
+ * loop mode, when it arrives.
+ */
+struct BenchmarkPlan {
+  std::vector<BenchmarkRequest> warmup;
+  std::vector<BenchmarkRequest> requests;
+  // Arrival of each of the requests in ms from the start of the run, empty in
+  // the closed loop mode
+  std::vector<double> arrival_times_ms;
+  // Number of inputs each model needs to pre-generate
+  std::vector<int64_t> num_inputs;
+};
+
+struct BenchmarkRun {
+  std::vector<float> latencies_ms;
+  float total_time_ms{0};
+};
+
+std::mt19937 makeBenchmarkEngine(const BenchmarkConfig& config);
+
+// Sends each request to the model i with probability weights[i]
+BenchmarkPlan makeBenchmarkPlan(
+    const BenchmarkConfig& config,
+    const std::vector<double>& weights,
+    std::mt19937& engine);
+
+// Runs the warmup requests, spread over the calling threads, and then
+// measures the requests of the plan.
+BenchmarkRun runBenchmark(
+    const std::vector<RequestRunner>& runners,
+    const BenchmarkPlan& plan,
+    const BenchmarkConfig& config);
+
+// Stats of the requests of `model`, or of all of them if it is negative
+BenchmarkExecutionStats makeBenchmarkStats(
+    const BenchmarkRun& run,
+    const BenchmarkPlan& plan,
+    const BenchmarkConfig& config,
+    int64_t model);
+
 /**
  * A helper class to abstract out different models we test throughput of
  */
@@ -81,6 +154,10 @@ public:
   // conversions at the benchmark time
   void addInput(py::args&&, py::kwargs&&);
   void addInput(Input&&);
+  // Pre-generates `num_inputs` inputs picked at random among the ones added,
+  // so that they can be moved out at benchmark time, and returns a runner for
+  // them. Each of them must be run exactly once.
+  RequestRunner prepare(int64_t num_inputs, std::mt19937& engine) const;
   BenchmarkExecutionStats benchmark(const BenchmarkConfig& config) const;
 
   bool initialized() const { return initialized_; }
@@ -156,9 +233,10 @@ void ModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
 /**
  * This class is a small c++ component responsible for executing a PyTorch
  * module under an inference server like load. It can emulate multiple calling
- * threads to a single module provided. In the future we plan to enhance this
- * component to support inter and intra-op parallelism as well as multiple
- * models running in a single process.
+ * threads to a single module provided, and either send requests in a closed
+ * loop or at given arrival times (open loop), see benchmarkMix for running
+ * several models in a single process. In the future we plan to enhance this
+ * component to support inter and intra-op parallelism.
  *
  * For current available configurations refer to the BenchmkarConfig
  * documentation
@@ -187,10 +265,21 @@ class C10_HIDDEN ThroughputBenchmark {
   // more information to the user
   BenchmarkExecutionStats benchmark(const BenchmarkConfig& config) const;
 
+  // See BenchmarkHelper::prepare
+  detail::RequestRunner prepare(int64_t num_inputs, std::mt19937& engine) const;
+
  private:
   detail::ScriptModuleBenchmark script_module_;
   detail::ModuleBenchmark module_;
 };
+
+// Benchmarks several modules sharing the process, each request goes to
+// benchmarks[i] with probability weights[i]. Returns the stats of all the
+// requests followed by those of each of the modules.
+std::vector<BenchmarkExecutionStats> benchmarkMix(
+    const std::vector<ThroughputBenchmark*>& benchmarks,
+    const std::vector<double>& weights,
+    const BenchmarkConfig& config);
 } // namespace throughput benchmark
 } // namepsace torch
 
@@ -180,15 +180,20 @@ class GradScaler(object):
         per_device_inv_scale = _MultiDeviceReplicator(inv_scale)
         per_device_found_inf = _MultiDeviceReplicator(found_inf)
 
+        # The grads are unscaled a list at a time, with one list per device and dtype,
+        # which is what a single multi-tensor kernel can handle.
+        per_device_and_dtype_grads = defaultdict(list)
         for group in optimizer.param_groups:
             for param in group["params"]:
                 if param.grad is not None:
                     if (not allow_fp16) and param.grad.dtype == torch.float16:
                         raise ValueError("Attempting to unscale FP16 gradients.")
-                    else:
-                        torch._amp_non_finite_check_and_unscale_(param.grad,
-                                                                 per_device_found_inf.get(param.grad.device),
-                                                                 per_device_inv_scale.get(param.grad.device))
+                    per_device_and_dtype_grads[(param.grad.device, param.grad.dtype)].append(param.grad)
+
+        for (device, _), grads in per_device_and_dtype_grads.items():
+            torch._amp_foreach_non_finite_check_and_unscale_(grads,
+                                                             per_device_found_inf.get(device),
+                                                             per_device_inv_scale.get(device))
 
         return per_device_found_inf._per_device_tensors
 
@@ -281,6 +286,7 @@ class GradScaler(object):
             # The contract with custom optimizers is that their step() should accept an additional,
             # optional grad_scaler kwarg.  We append self to the kwargs so the custom optimizer has full information:
             # it can query its own state, invoke unscale_ on itself, etc
+            # (the fused built-in optimizers use _maybe_unscale_and_get_found_inf to skip their step on the device).
             retval = optimizer.step(*args, **dict(kwargs, grad_scaler=self))
             optimizer_state["stage"] = OptState.STEPPED
             return retval
@@ -297,6 +303,29 @@ class GradScaler(object):
 
         return retval
 
+    def _maybe_unscale_and_get_found_inf(self, optimizer):
+        r"""
+        For optimizers with ``_step_supports_amp_scaling``: unscales the gradients of ``optimizer``, unless
+        :meth:`unscale_` was already called for it, and returns a dict mapping each device of its gradients
+        to a one-element float tensor on that device, which is nonzero if infs/NaNs were found in any of the
+        gradients (of any device).  The optimizer can pass these tensors to its step kernels to skip the step
+        on the device, so :meth:`step` doesn't incur a CPU-GPU sync.
+        """
+        optimizer_state = self._per_optimizer_states[id(optimizer)]
+        if optimizer_state["stage"] is OptState.READY:
+            self.unscale_(optimizer)
+
+        found_inf_per_device = optimizer_state["found_inf_per_device"]
+        assert len(found_inf_per_device) > 0, "No inf checks were recorded for this optimizer."
+        if len(found_inf_per_device) == 1:
+            return dict(found_inf_per_device)
+
+        # The step must be skipped on all the devices if infs/NaNs were found on any of them.
+        found_inf_combined = sum(found_inf.to(device=self._scale.device, non_blocking=True)
+                                 for found_inf in found_inf_per_device.values())
+        combined = _MultiDeviceReplicator(found_inf_combined)
+        return {device: combined.get(device) for device in found_inf_per_device}
+
     def update(self, new_scale=None):
         """
         Updates the scale factor.
@@ -321,14 +350,15 @@ class GradScaler(object):
 
         if new_scale is not None:
             # Accept a new user-defined scale.
+            # The scale is updated in place, so it keeps its identity (and device) across iterations.
             if isinstance(new_scale, float):
-                self._scale = torch.full((1,), new_scale, dtype=torch.float32, device=self._scale.device)
+                self._scale.fill_(new_scale)
             else:
                 reason = "new_scale should be a float or a 1-element torch.cuda.FloatTensor with requires_grad=False."
                 assert isinstance(new_scale, torch.cuda.FloatTensor), reason
                 assert new_scale.numel() == 1, reason
                 assert new_scale.requires_grad is False, reason
-                self._scale = new_scale
+                self._scale.copy_(new_scale)
         else:
             # Consume shared inf/nan data collected from optimizers to update the scale.
             # If all found_inf tensors are on the same device as self._scale, this operation is asynchronous.
@@ -343,12 +373,12 @@ class GradScaler(object):
                 for i in range(1, len(found_infs)):
                     found_inf_combined += found_infs[i]
 
-            self._scale = torch._amp_update_scale(self._growth_tracker,
-                                                  self._scale,
-                                                  found_inf_combined,
-                                                  self._growth_factor,
-                                                  self._backoff_factor,
-                                                  self._growth_interval)
+            torch._amp_update_scale_(self._scale,
+                                     self._growth_tracker,
+                                     found_inf_combined,
+                                     self._growth_factor,
+                                     self._backoff_factor,
+                                     self._growth_interval)
 
         # To prepare for next iteration, clear the data collected from optimizers this iteration.
         self._per_optimizer_states = defaultdict(_refresh_per_optimizer_state)
@@ -4,7 +4,7 @@ import warnings
 from typing import Any, Dict, Union
 
 import torch
-from . import is_initialized, _get_device_index
+from . import is_initialized, _get_device_index, _lazy_init
 from torch.types import Device
 
 def _host_allocator():
@@ -209,6 +209,52 @@ def reset_peak_memory_stats(device: Union[Device, int] = None) -> None:
     return torch._C._cuda_resetPeakMemoryStats(device)
 
 
+def host_memory_stats() -> Dict[str, Any]:
+    r"""Returns a dictionary of statistics of the caching allocator of pinned
+    host memory, which backs :meth:`~torch.Tensor.pin_memory`.
+
+    The statistics are flattened like those of :func:`~torch.cuda.memory_stats`:
+
+    - ``"allocation.{current,peak,allocated,freed}"``:
+      number of allocation requests received by the allocator.
+    - ``"allocated_bytes.{current,peak,allocated,freed}"``:
+      amount of allocated memory, rounded up to size classes.
+    - ``"segment.{current,peak,allocated,freed}"``:
+      number of blocks pinned with ``cudaHostAlloc()``.
+    - ``"reserved_bytes.{current,peak,allocated,freed}"``:
+      amount of pinned memory held by the allocator.
+    - ``"num_trims"``: number of cached blocks released to stay under the
+      ``pinned_max_cached_mb`` option of ``PYTORCH_CUDA_ALLOC_CONF``.
+    - ``"num_alloc_retries"``: number of failed ``cudaHostAlloc`` calls that
+      result in a cache flush and retry.
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    result = []
+
+    def _recurse_add_to_result(prefix, obj):
+        if isinstance(obj, dict):
+            if len(prefix) > 0:
+                prefix += "."
+            for k, v in obj.items():
+                _recurse_add_to_result(prefix + k, v)
+        else:
+            result.append((prefix, obj))
+
+    _lazy_init()
+    _recurse_add_to_result("", torch._C._cuda_hostMemoryStats())
+    result.sort()
+
+    return collections.OrderedDict(result)
+
+
+def reset_peak_host_memory_stats() -> None:
+    r"""Resets the "peak" stats of :func:`~torch.cuda.host_memory_stats`."""
+    torch._C._cuda_resetPeakHostMemoryStats()
+
+
 def reset_max_memory_allocated(device: Union[Device, int] = None) -> None:
     r"""Resets the starting point in tracking maximum GPU memory occupied by
     tensors for a given device.
@@ -368,6 +414,31 @@ def memory_snapshot():
     return torch._C._cuda_memorySnapshot()
 
 
+def memory_trace(device: Union[Device, int] = None):
+    r"""Returns the most recent events recorded by the CUDA memory allocator
+    for a given device, oldest first.
+
+    Each event is a dictionary with an ``action`` (``"alloc"``, ``"free"``,
+    ``"segment_alloc"``, ``"segment_free"`` or ``"oom"``), the ``address``,
+    ``size`` and ``stream`` it applies to and a truncated ``backtrace``.
+    Events are only recorded when tracing is enabled with
+    ``PYTORCH_CUDA_ALLOC_CONF=trace_entries:<N>``; otherwise the result is
+    empty.
+
+    Arguments:
+        device (torch.device or int, optional): selected device. Returns
+            the trace for the current device, given by
+            :func:`~torch.cuda.current_device`, if :attr:`device` is ``None``
+            (default).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    device = _get_device_index(device, optional=True)
+    return torch._C._cuda_allocationTrace(device)
+
+
 def memory_summary(device: Union[Device, int] = None, abbreviated: bool = False) -> str:
     r"""Returns a human-readable printout of the current memory allocator
     statistics for a given device.
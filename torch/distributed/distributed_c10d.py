@@ -1,3 +1,4 @@
+import socket
 import torch
 import warnings
 from torch._six import string_classes
@@ -20,6 +21,7 @@ from . import (
 )
 from . import ReduceOp
 from . import PrefixStore
+from . import ProcessGroupHierarchical
 
 
 _MPI_AVAILABLE = True
@@ -367,7 +369,13 @@ def init_process_group(backend,
             the process group. Default value equals 30 minutes.
             This is applicable for the ``gloo`` backend. For ``nccl``, this is
             applicable only if the environment variable ``NCCL_BLOCKING_WAIT``
-            is set to 1.
+            or ``NCCL_ASYNC_ERROR_HANDLING`` is set to 1. With
+            ``NCCL_BLOCKING_WAIT``, ``wait()`` blocks the calling thread until
+            the operation completes or times out. With
+            ``NCCL_ASYNC_ERROR_HANDLING``, ``wait()`` stays non-blocking and a
+            background thread aborts the NCCL communicators of operations
+            that fail or time out; the error is then raised by ``wait()`` and
+            by later collectives on the process group.
         group_name (str, optional, deprecated): Group name.
 
     To enable ``backend == Backend.MPI``, PyTorch needs to be built from source
@@ -576,6 +584,102 @@ def destroy_process_group(group=group.WORLD):
         del _pg_group_ranks[pg]
 
 
+def reconfigure_process_group(store,
+                              rank,
+                              world_size,
+                              version,
+                              backend=None,
+                              timeout=default_pg_timeout):
+    """
+    Replaces the default process group with a new one over a changed set of
+    processes, e.g. after some processes of an elastic job were preempted or
+    new ones joined, without restarting the processes that keep running.
+
+    Processes that keep running call this function with their new rank
+    instead of tearing down the distributed package, so that they keep their
+    CUDA context and cached memory, and only a new communicator is created
+    over the new set of processes. Processes that join call it too, after
+    initializing the distributed package with :func:`init_process_group`, or
+    in place of it. All process groups created before are dropped, process
+    groups are created again with :func:`new_group` if needed.
+
+    Every reconfiguration must use a new ``version``, which is the same on
+    all processes: the keys the new process groups exchange in ``store`` are
+    prefixed with it, so that a store that outlives the reconfiguration can
+    be reused without clashing with the keys of earlier configurations. To
+    re-sync a :class:`~torch.nn.parallel.DistributedDataParallel` module with
+    the new process group, see
+    :meth:`~torch.nn.parallel.DistributedDataParallel.reconfigure`.
+
+    Arguments:
+        store (Store): Key/value store accessible to all processes of the new
+                       process group.
+        rank (int): Rank of the current process in the new process group.
+        world_size (int): Number of processes in the new process group.
+        version (int or str): Version of the configuration.
+        backend (str or Backend, optional): The backend to use. Default is
+                                            the backend of the current default
+                                            process group.
+        timeout (timedelta, optional): Timeout for operations executed
+                                       against the process group, see
+                                       :func:`init_process_group`.
+
+    Returns:
+        The new default process group.
+
+    Example::
+        >>> # After rank 3 of 4 was preempted, on the 3 remaining processes
+        >>> dist.reconfigure_process_group(store, rank, 3, version=1)
+        >>> ddp_model.reconfigure()
+    """
+    global _pg_map
+    global _pg_names
+    global _pg_group_ranks
+    global _backend
+    global _default_pg
+    global _group_count
+
+    if not isinstance(timeout, timedelta):
+        raise RuntimeError("Expected timeout argument to be of type"
+                           "datetime.timedelta")
+
+    assert world_size > 0, 'world_size must be positive'
+    assert 0 <= rank < world_size, 'rank must be in [0, world_size)'
+
+    if backend is None:
+        if _default_pg is None:
+            raise RuntimeError("backend must be specified if the default "
+                               "process group isn't initialized")
+        backend = _backend
+    backend = Backend(backend)
+    if backend == Backend.MPI:
+        raise RuntimeError("The MPI backend doesn't support reconfiguring "
+                           "the default process group")
+
+    # Process groups of the earlier configuration go away once they are not
+    # referenced anymore. The group counter is reset, so that the names of
+    # the process groups, and therefore their keys, don't depend on how many
+    # groups were created before: all processes must agree on them, and
+    # joining processes start from scratch.
+    _default_pg = None
+    _pg_map.clear()
+    _pg_names.clear()
+    _pg_group_ranks.clear()
+    _group_count = 0
+
+    store = PrefixStore("reconfigure/{}/".format(version), store)
+    _default_pg = _new_process_group_helper(
+        world_size,
+        rank,
+        [],
+        backend,
+        store,
+        timeout=timeout)
+    _pg_group_ranks[_default_pg] = {i: i for i in range(_default_pg.size())}
+    _backend = _pg_map[_default_pg][0]
+    return _default_pg
+
+
 def get_rank(group=group.WORLD):
     """
     Returns the rank of current process group
@@ -1792,3 +1896,91 @@ def new_group(ranks=None, timeout=default_pg_timeout, backend=None):
     }
 
     return pg
+
+
+_hierarchical_group_count = 0
+
+
+def new_hierarchical_group(timeout=default_pg_timeout, backend=None):
+    """
+    Creates a group spanning all processes whose ``all_reduce`` and
+    ``all_reduce_coalesced`` reduce within every node first and across nodes
+    second, using the fast links between the devices of a node and sending
+    every byte over the network once per node instead of once per process.
+
+    Processes are assigned to nodes by their host name. Every node must run
+    the same number of processes. With the ``nccl`` backend, an allreduce is
+    a reduce-scatter inside the node, an allreduce of every shard across
+    nodes and an allgather inside the node. Other backends reduce to, and
+    broadcast from, the first process of every node. All other collectives
+    run on a group spanning all processes, so the returned group can be used
+    in place of the default group, e.g. by
+    :class:`~torch.nn.parallel.DistributedDataParallel`.
+
+    Like :func:`new_group`, this function requires that all processes enter
+    it, in the same order relative to other group creations.
+
+    Arguments:
+        timeout (timedelta, optional): Timeout for operations executed against
+            the process groups. Default value equals 30 minutes.
+            This is only applicable for the ``gloo`` backend.
+        backend (str or Backend, optional): The backend to use. By default
+            uses the same backend as the global group.
+
+    Returns:
+        A handle of distributed group that can be given to collective calls.
+    """
+    _check_default_pg()
+
+    global _hierarchical_group_count
+    default_backend, default_store = _pg_map[_default_pg]
+    rank = _default_pg.rank()
+    world_size = _default_pg.size()
+    if not backend:
+        backend = default_backend
+    backend = Backend(backend)
+
+    # Exchange host names through the store to find the processes per node.
+    store = PrefixStore(
+        "hierarchical_group/{}/".format(_hierarchical_group_count), default_store)
+    _hierarchical_group_count += 1
+    store.set(str(rank), socket.gethostname())
+    hosts = [store.get(str(r)).decode() for r in range(world_size)]
+    nodes = []
+    for r, host in enumerate(hosts):
+        for node in nodes:
+            if hosts[node[0]] == host:
+                node.append(r)
+                break
+        else:
+            nodes.append([r])
+    local_size = len(nodes[0])
+    if any(len(node) != local_size for node in nodes):
+        raise RuntimeError(
+            "new_hierarchical_group expects every node to run the same number "
+            "of processes, got {}".format([len(node) for node in nodes]))
+
+    global_group = new_group(timeout=timeout, backend=backend)
+    intra_node_group = None
+    for node in nodes:
+        group = new_group(node, timeout=timeout, backend=backend)
+        if rank in node:
+            intra_node_group = group
+    inter_node_group = None
+    for local_rank in range(local_size):
+        ranks = [node[local_rank] for node in nodes]
+        group = new_group(ranks, timeout=timeout, backend=backend)
+        if rank in ranks:
+            inter_node_group = group
+
+    pg = ProcessGroupHierarchical(
+        rank,
+        world_size,
+        global_group,
+        intra_node_group,
+        inter_node_group,
+        use_reduce_scatter=(backend == Backend.NCCL))
+    _pg_map[pg] = (backend, default_store)
+    _pg_names[pg] = _pg_names[global_group]
+    _pg_group_ranks[pg] = {r: r for r in range(world_size)}
+    return pg
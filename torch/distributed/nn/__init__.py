@@ -1 +1,2 @@
 from .api.remote_module import RemoteModule
+from .api.remote_pipeline import RemotePipeline
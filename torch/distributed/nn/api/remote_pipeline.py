@@ -0,0 +1,246 @@
+#!/usr/bin/python3
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import torch
+import torch.distributed.autograd as dist_autograd
+import torch.distributed.rpc as rpc
+
+
+class _CheckpointStage(torch.autograd.Function):
+    # Runs a stage without keeping its activations, and recomputes them in the
+    # backward pass. Unlike torch.utils.checkpoint, the gradients of the
+    # parameters are returned rather than accumulated into their ``grad``, so
+    # that distributed autograd accumulates them in the autograd context like
+    # all other gradients.
+    @staticmethod
+    def forward(ctx, module, input, *params):
+        ctx.module = module
+        ctx.save_for_backward(input)
+        with torch.no_grad():
+            return module(input)
+
+    @staticmethod
+    def backward(ctx, grad_output):
+        input, = ctx.saved_tensors
+        input = input.detach().requires_grad_(input.requires_grad)
+        params = [p for p in ctx.module.parameters() if p.requires_grad]
+        with torch.enable_grad():
+            output = ctx.module(input)
+        inputs = ([input] if input.requires_grad else []) + params
+        grads = list(torch.autograd.grad(
+            output, inputs, grad_output, allow_unused=True))
+        grad_input = grads.pop(0) if input.requires_grad else None
+        return (None, grad_input) + tuple(grads)
+
+
+class _PipelineStage(object):
+    # The stage module on its owner. Micro-batches run through the stage one
+    # at a time, like they would on a device of a local pipeline.
+    def __init__(self, module_rref, checkpoint):
+        self.module = module_rref.local_value()
+        self.checkpoint = checkpoint
+        self.lock = threading.Lock()
+        self.optimizer = None
+
+    def forward(self, input):
+        if isinstance(input, rpc.RRef):
+            # Fetch the output of the previous stage before taking the lock,
+            # so that the lock is never held while waiting on another worker.
+            input = input.to_here()
+        with self.lock:
+            if self.checkpoint and torch.is_grad_enabled():
+                params = [p for p in self.module.parameters() if p.requires_grad]
+                return _CheckpointStage.apply(self.module, input, *params)
+            return self.module(input)
+
+    def accumulate_gradients(self, context_id):
+        grads = dist_autograd.get_gradients(context_id)
+        with self.lock, torch.no_grad():
+            for p in self.module.parameters():
+                if p not in grads:
+                    continue
+                if p.grad is None:
+                    p.grad = grads[p].clone()
+                else:
+                    p.grad.add_(grads[p])
+
+
+def _new_stage(module_rref, checkpoint):
+    return rpc.RRef(_PipelineStage(module_rref, checkpoint))
+
+
+def _stage_forward(stage_rref, input, grad_enabled):
+    with torch.set_grad_enabled(grad_enabled):
+        return stage_rref.local_value().forward(input)
+
+
+def _stage_accumulate_gradients(stage_rref, context_id):
+    stage_rref.local_value().accumulate_gradients(context_id)
+
+
+def _stage_set_optimizer(stage_rref, optimizer_class, args, kwargs):
+    stage = stage_rref.local_value()
+    stage.optimizer = optimizer_class(stage.module.parameters(), *args, **kwargs)
+
+
+def _stage_step(stage_rref):
+    stage = stage_rref.local_value()
+    with stage.lock:
+        stage.optimizer.step()
+
+
+def _stage_zero_grad(stage_rref):
+    stage = stage_rref.local_value()
+    with stage.lock:
+        stage.module.zero_grad()
+
+
+def _wait_for_all(rpc_futs):
+    for fut in rpc_futs:
+        fut.wait()
+
+
+class RemotePipeline(object):
+    r"""
+    Runs a model split into stage modules held by RPC workers as a pipeline:
+    the batch is split into ``chunks`` micro-batches that flow through the
+    stages, so that every stage works on a different micro-batch at the same
+    time instead of waiting for the full batch.
+
+    The output of a stage is created on its worker with
+    :meth:`~torch.distributed.rpc.remote` and fetched by the worker of the
+    next stage, so activations don't go through the caller. Micro-batches run
+    through a stage one at a time. Every stage module takes and returns a
+    single tensor.
+
+    :meth:`train_step` runs the backward pass of every micro-batch in its own
+    distributed autograd context, so that the backward pass of a micro-batch
+    overlaps with the forward passes of the others, and accumulates the
+    gradients of every context into the ``grad`` of the stage parameters.
+    With the ``"1f1b"`` schedule, at most one micro-batch per stage is in
+    flight, and the backward pass of a micro-batch starts as soon as its
+    forward pass is done, which bounds the number of micro-batches whose
+    activations are kept alive. With the ``"fill_drain"`` schedule, the
+    backward passes start once the forward passes of all micro-batches are
+    done, like GPipe.
+
+    Args:
+        stages (list[RRef]): RRefs to the stage modules, in order.
+        chunks (int): number of micro-batches to split batches into.
+        schedule (str): ``"1f1b"`` or ``"fill_drain"``.
+        checkpoint (bool): if ``True``, stages don't keep their activations
+            during the forward pass of :meth:`train_step`, and recompute them
+            in the backward pass.
+
+    Example::
+        >>> stage0 = rpc.remote("worker1", nn.Linear, args=(20, 30))
+        >>> stage1 = rpc.remote("worker2", nn.Linear, args=(30, 10))
+        >>> pipeline = RemotePipeline([stage0, stage1], chunks=4)
+        >>> pipeline.set_optimizer(torch.optim.SGD, lr=0.05)
+        >>> pipeline.zero_grad()
+        >>> loss = pipeline.train_step(input, target, nn.MSELoss())
+        >>> pipeline.step()
+    """
+    def __init__(self, stages, chunks, schedule="1f1b", checkpoint=False):
+        if schedule not in ("1f1b", "fill_drain"):
+            raise ValueError("Unknown pipeline schedule: {}".format(schedule))
+        if chunks < 1:
+            raise ValueError("chunks must be positive, but got {}".format(chunks))
+        self.chunks = chunks
+        self.schedule = schedule
+        self._stages = [
+            rpc.remote(stage.owner(), _new_stage, args=(stage, checkpoint))
+            for stage in stages]
+
+    def _forward_micro_batch(self, input, grad_enabled):
+        output = input
+        for stage in self._stages:
+            output = rpc.remote(
+                stage.owner(), _stage_forward, args=(stage, output, grad_enabled))
+            # Only kick off the next stage once this one has its output, so
+            # that workers never wait on the compute of another worker.
+            output._get_future().wait()
+        return output.to_here()
+
+    def forward(self, input):
+        r"""
+        Runs the micro-batches of ``input`` through the stages without
+        recording gradients, and returns the concatenated outputs.
+        """
+        micro_batches = input.chunk(self.chunks)
+        with ThreadPoolExecutor(max_workers=len(self._stages)) as executor:
+            outputs = list(executor.map(
+                lambda x: self._forward_micro_batch(x, False), micro_batches))
+        return torch.cat(outputs)
+
+    __call__ = forward
+
+    def train_step(self, input, target, loss_fn):
+        r"""
+        Runs the forward and backward passes of the micro-batches of
+        ``input`` and ``target``, and accumulates the gradients of the mean of
+        the micro-batch losses into the ``grad`` of the stage parameters.
+        Returns that mean loss.
+
+        Args:
+            input (Tensor): the batch to split into micro-batches.
+            target (Tensor): the targets of the batch.
+            loss_fn (callable): computes the loss of a micro-batch from the
+                output of the last stage and the target, on the caller.
+        """
+        micro_batches = list(zip(input.chunk(self.chunks), target.chunk(self.chunks)))
+        if self.schedule == "1f1b":
+            in_flight = len(self._stages)
+            barrier = None
+        else:
+            in_flight = len(micro_batches)
+            barrier = threading.Barrier(len(micro_batches))
+
+        def run(micro_batch):
+            x, y = micro_batch
+            with dist_autograd.context() as context_id:
+                try:
+                    loss = loss_fn(self._forward_micro_batch(x, True), y)
+                    if barrier is not None:
+                        barrier.wait()
+                except BaseException:
+                    if barrier is not None:
+                        barrier.abort()
+                    raise
+                dist_autograd.backward(context_id, [loss / len(micro_batches)])
+                _wait_for_all([
+                    rpc.rpc_async(
+                        stage.owner(),
+                        _stage_accumulate_gradients,
+                        args=(stage, context_id))
+                    for stage in self._stages])
+            return loss.detach()
+
+        with ThreadPoolExecutor(max_workers=in_flight) as executor:
+            losses = list(executor.map(run, micro_batches))
+        return torch.stack(losses).mean()
+
+    def set_optimizer(self, optimizer_class, *args, **kwargs):
+        r"""
+        Creates an optimizer of class ``optimizer_class`` for the parameters
+        of every stage on its worker, with the given arguments.
+        """
+        _wait_for_all([
+            rpc.rpc_async(
+                stage.owner(),
+                _stage_set_optimizer,
+                args=(stage, optimizer_class, args, kwargs))
+            for stage in self._stages])
+
+    def step(self):
+        r"""Steps the optimizers of all stages, see :meth:`set_optimizer`."""
+        _wait_for_all([
+            rpc.rpc_async(stage.owner(), _stage_step, args=(stage,))
+            for stage in self._stages])
+
+    def zero_grad(self):
+        r"""Clears the gradients of the parameters of all stages."""
+        _wait_for_all([
+            rpc.rpc_async(stage.owner(), _stage_zero_grad, args=(stage,))
+            for stage in self._stages])
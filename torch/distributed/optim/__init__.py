@@ -4,5 +4,10 @@ of remote parameters (:class:`~torch.distributed.rpc.RRef`) and runs the
 optimizer locally on the workers where the parameters live.  The distributed
 optimizer can use any of the local optimizer :ref:`optimizer-algorithms` to
 apply the gradients on each worker.
+
+It also exposes ShardedOptimizer, which shards the optimizer state of a
+:class:`~torch.nn.parallel.DistributedDataParallel` module across its
+processes.
 """
 from .optimizer import DistributedOptimizer
+from .sharded_optimizer import ShardedOptimizer
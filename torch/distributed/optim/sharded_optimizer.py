@@ -0,0 +1,171 @@
+import torch
+import torch.distributed as dist
+
+
+class _ShardedBucket(object):
+    # The parameters of a gradient bucket of the reducer, and the slices of
+    # them that fall into the shard of the bucket owned by this process.
+    def __init__(self, params, rank, world_size):
+        self.params = params
+        numel = sum(p.numel() for p in params)
+        self.shard_size = (numel + world_size - 1) // world_size
+        begin = min(numel, rank * self.shard_size)
+        end = min(numel, begin + self.shard_size)
+        # (param, offset into the param, length) for every slice of the shard
+        self.slices = []
+        offset = 0
+        for p in params:
+            lo = max(begin, offset)
+            hi = min(end, offset + p.numel())
+            if lo < hi:
+                self.slices.append((p, lo - offset, hi - lo))
+            offset += p.numel()
+        # Views of the slices of the parameters, updated in place by the
+        # optimizer.
+        self.shard_params = [
+            p.detach().view(-1).narrow(0, start, length)
+            for p, start, length in self.slices]
+
+
+class ShardedOptimizer(object):
+    r"""
+    Wraps an optimizer such that every process of a
+    :class:`~torch.nn.parallel.DistributedDataParallel` module only keeps the
+    optimizer state of, and updates, a ``1 / world_size`` shard of the
+    parameters, which divides the memory taken by optimizer state like the
+    Adam moments by the world size.
+
+    The module's gradient buckets are reduce-scattered instead of allreduced
+    (see :meth:`~torch.nn.parallel.DistributedDataParallel.set_shard_gradients`):
+    every bucket is split into one shard per process, and a process only
+    receives the reduced gradients of its shard. :meth:`step` updates the
+    shard of every bucket and then allgathers the updated shards, so that
+    all processes hold the full updated parameters for the next forward pass.
+
+    The optimizer is created from the slices of the parameters that fall into
+    the shards, at the first call to :meth:`step` once the buckets have their
+    final layout. It must update the elements of its parameters
+    independently, like :class:`~torch.optim.SGD` or :class:`~torch.optim.Adam`
+    do. Only supports modules on a single device per process with dense
+    gradients and contiguous parameters, and process groups that support
+    ``reduce_scatter``, like NCCL.
+
+    Args:
+        module (DistributedDataParallel): the module whose parameters to
+            optimize.
+        optimizer_class (optim.Optimizer): the class of the optimizer to run
+            on the shard of every process.
+        args: arguments to pass to the optimizer constructor.
+        kwargs: arguments to pass to the optimizer constructor.
+
+    Example::
+        >>> model = torch.nn.parallel.DistributedDataParallel(model, device_ids=[rank])
+        >>> optimizer = torch.distributed.optim.ShardedOptimizer(
+        >>>     model, torch.optim.Adam, lr=1e-4)
+        >>> model(input).sum().backward()
+        >>> optimizer.step()
+    """
+    def __init__(self, module, optimizer_class, *args, **kwargs):
+        if module.device_ids is not None and len(module.device_ids) > 1:
+            raise ValueError(
+                "ShardedOptimizer only supports modules on a single device "
+                "per process.")
+        self.module = module
+        self.optimizer_class = optimizer_class
+        self.args = args
+        self.kwargs = kwargs
+        self.optimizer = None
+        self._buckets = None
+        self._bucket_indices = None
+        self.process_group = module.process_group
+        self.rank = dist.get_rank(self.process_group)
+        self.world_size = dist.get_world_size(self.process_group)
+        module.set_shard_gradients(True)
+
+    def _init_shards(self):
+        bucket_indices = self.module.reducer._get_bucket_indices()
+        if self._bucket_indices is not None:
+            if bucket_indices != self._bucket_indices:
+                raise RuntimeError(
+                    "The gradient buckets of the module were rebuilt after "
+                    "ShardedOptimizer created its shards.")
+            return
+        params = self.module._reducer_parameters
+        for p in params:
+            if not p.is_contiguous():
+                raise ValueError(
+                    "ShardedOptimizer only supports contiguous parameters.")
+        self._bucket_indices = bucket_indices
+        self._buckets = [
+            _ShardedBucket([params[i] for i in indices], self.rank, self.world_size)
+            for indices in bucket_indices]
+        shard_params = [p for bucket in self._buckets for p in bucket.shard_params]
+        self.optimizer = self.optimizer_class(shard_params, *self.args, **self.kwargs)
+
+    def zero_grad(self):
+        r"""Clears the gradients of all parameters of the module."""
+        self.module.zero_grad()
+
+    def step(self, closure=None):
+        r"""
+        Updates the shard of the parameters of this process, and allgathers
+        the updated shards of all processes.
+
+        Args:
+            closure (callable, optional): a closure that reevaluates the model
+                and returns the loss, passed to the optimizer.
+        """
+        self._init_shards()
+        with torch.no_grad():
+            for bucket in self._buckets:
+                for (p, start, length), shard_param in zip(bucket.slices, bucket.shard_params):
+                    if p.grad is None:
+                        shard_param.grad = None
+                    else:
+                        if p.grad.is_sparse:
+                            raise RuntimeError(
+                                "ShardedOptimizer doesn't support sparse gradients.")
+                        shard_param.grad = p.grad.view(-1).narrow(0, start, length)
+        loss = self.optimizer.step(closure)
+
+        with torch.no_grad():
+            # Kick off the allgather of every bucket before waiting for any.
+            pending = []
+            for bucket in self._buckets:
+                params = bucket.params
+                shard = torch.zeros(
+                    bucket.shard_size, dtype=params[0].dtype, device=params[0].device)
+                offset = 0
+                for p, start, length in bucket.slices:
+                    shard.narrow(0, offset, length).copy_(p.view(-1).narrow(0, start, length))
+                    offset += length
+                flat = torch.empty(
+                    bucket.shard_size * self.world_size,
+                    dtype=params[0].dtype, device=params[0].device)
+                work = dist.all_gather(
+                    list(flat.chunk(self.world_size)), shard,
+                    group=self.process_group, async_op=True)
+                pending.append((bucket, flat, work))
+            for bucket, flat, work in pending:
+                work.wait()
+                offset = 0
+                for p in bucket.params:
+                    p.view(-1).copy_(flat.narrow(0, offset, p.numel()))
+                    offset += p.numel()
+        return loss
+
+    def state_dict(self):
+        r"""
+        Returns the state of the optimizer of this process, which only covers
+        its shard of the parameters.
+        """
+        self._init_shards()
+        return self.optimizer.state_dict()
+
+    def load_state_dict(self, state_dict):
+        r"""
+        Loads the state of the optimizer of this process, as returned by
+        :meth:`state_dict` on a process of the same rank.
+        """
+        self._init_shards()
+        self.optimizer.load_state_dict(state_dict)
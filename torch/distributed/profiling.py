@@ -0,0 +1,175 @@
+"""
+Aggregation of the autograd profiler traces of the c10d collectives across
+the ranks of a process group.
+
+The NCCL and Gloo process groups record each collective as a profiler range
+named after the backend and the collective (e.g. ``nccl:all_reduce``), with
+the sequence number of the collective in its process group. The ranges of
+the same collective on the different ranks are matched on this number.
+
+A collective completes at about the same time on all the ranks, the
+difference of the end times of the collectives on two ranks therefore gives
+the offset of their clocks. Once the clocks are aligned, the difference of
+the start times of a collective is the time the ranks waited for the last
+one to reach it.
+"""
+
+import collections
+import pickle
+
+
+CollectiveRecord = collections.namedtuple(
+    'CollectiveRecord', ['name', 'sequence_nr', 'start', 'end'])
+CollectiveRecord.__doc__ = """\
+A collective on a rank. The times are in microseconds, in the clock of
+the profiler of the rank. They are the times of the kernels of the
+collective when they were profiled (``use_cupti=True``), the times of the
+range on the CPU otherwise.
+"""
+
+CollectiveSkew = collections.namedtuple(
+    'CollectiveSkew', ['name', 'sequence_nr', 'skew', 'last_rank'])
+CollectiveSkew.__doc__ = """\
+The difference between the first and the last aligned start time of a
+collective on the ranks (``skew``, in microseconds), and the rank that
+started it last.
+"""
+
+_COLLECTIVE_PREFIXES = ('nccl:', 'gloo:')
+
+
+def collective_records(events):
+    """Returns the :class:`CollectiveRecord` of the collectives in a list of
+    profiler events (e.g. ``prof.function_events``), in order of sequence
+    number.
+    """
+    records = []
+    for evt in events:
+        if not evt.name.startswith(_COLLECTIVE_PREFIXES) or evt.sequence_nr < 0:
+            continue
+        if evt.kernels:
+            start = min(k.interval.start for k in evt.kernels)
+            end = max(k.interval.end for k in evt.kernels)
+        else:
+            start = evt.cpu_interval.start
+            end = evt.cpu_interval.end
+        records.append(CollectiveRecord(evt.name, evt.sequence_nr, start, end))
+    records.sort(key=lambda r: r.sequence_nr)
+    return records
+
+
+def gather_collective_records(events, store, rank, world_size,
+                              prefix='collective_profile'):
+    """Exchanges the collectives profiled on each rank through ``store``.
+
+    It has to be called by all the ranks, with the events of their profiles.
+
+    Arguments:
+        events: the profiler events of this rank.
+        store (Store): a store shared by all the ranks.
+        rank (int): the rank of this process.
+        world_size (int): the number of ranks.
+        prefix (str): prefix of the keys written to the store.
+
+    Returns:
+        A list with the :class:`CollectiveRecord` of each rank.
+    """
+    store.set('{}/{}'.format(prefix, rank),
+              pickle.dumps(collective_records(events)))
+    return [pickle.loads(store.get('{}/{}'.format(prefix, r)))
+            for r in range(world_size)]
+
+
+def _median(values):
+    values = sorted(values)
+    mid = len(values) // 2
+    if len(values) % 2:
+        return values[mid]
+    return (values[mid - 1] + values[mid]) / 2.0
+
+
+class CollectiveSkewReport(object):
+    """Timing skew of the collectives across the ranks.
+
+    Attributes:
+        clock_offsets (list): offset of the clock of each rank to the one of
+            rank 0, in microseconds.
+        collectives (list): a :class:`CollectiveSkew` per collective profiled
+            on all the ranks, in order of sequence number.
+        last_counts (list): number of collectives each rank started last.
+        lateness (list): total time the other ranks waited for each rank, in
+            microseconds.
+    """
+    def __init__(self, clock_offsets, collectives, last_counts, lateness):
+        self.clock_offsets = clock_offsets
+        self.collectives = collectives
+        self.last_counts = last_counts
+        self.lateness = lateness
+
+    def stragglers(self):
+        """Returns the ranks, from the one the others waited for the most."""
+        return sorted(range(len(self.lateness)),
+                      key=lambda r: self.lateness[r], reverse=True)
+
+    def table(self, row_limit=10):
+        """Prints the collectives with the largest skew and the total
+        lateness of each rank as a table.
+        """
+        lines = []
+        lines.append('{:<30} {:>12} {:>14} {:>10}'.format(
+            'Name', 'Sequence', 'Skew', 'Last rank'))
+        worst = sorted(self.collectives, key=lambda c: c.skew, reverse=True)
+        for c in worst[:row_limit]:
+            lines.append('{:<30} {:>12} {:>12.3f}us {:>10}'.format(
+                c.name, c.sequence_nr, c.skew, c.last_rank))
+        lines.append('')
+        lines.append('{:<6} {:>14} {:>10} {:>16}'.format(
+            'Rank', 'Clock offset', 'Last', 'Lateness'))
+        for r in self.stragglers():
+            lines.append('{:<6} {:>12.3f}us {:>10} {:>14.3f}us'.format(
+                r, self.clock_offsets[r], self.last_counts[r], self.lateness[r]))
+        return '\n'.join(lines)
+
+    def __str__(self):
+        return self.table()
+
+
+def analyze_collective_skew(records_per_rank):
+    """Aligns the clocks of the ranks and computes the skew of each
+    collective.
+
+    Arguments:
+        records_per_rank (list): the :class:`CollectiveRecord` of each rank,
+            as returned by :func:`gather_collective_records`.
+
+    Returns:
+        A :class:`CollectiveSkewReport`.
+    """
+    world_size = len(records_per_rank)
+    by_seq = [{r.sequence_nr: r for r in records} for records in records_per_rank]
+    common = set(by_seq[0]) if by_seq else set()
+    for records in by_seq[1:]:
+        common &= set(records)
+    common = sorted(common)
+
+    # The median is robust to the collectives that did not end together,
+    # e.g. the ones whose end was delayed by other work on a rank.
+    clock_offsets = [0.0] * world_size
+    if common:
+        for rank in range(1, world_size):
+            clock_offsets[rank] = _median(
+                [by_seq[rank][seq].end - by_seq[0][seq].end for seq in common])
+
+    collectives = []
+    last_counts = [0] * world_size
+    lateness = [0.0] * world_size
+    for seq in common:
+        starts = [by_seq[rank][seq].start - clock_offsets[rank]
+                  for rank in range(world_size)]
+        last_rank = max(range(world_size), key=lambda r: starts[r])
+        skew = starts[last_rank] - min(starts)
+        collectives.append(CollectiveSkew(
+            by_seq[0][seq].name, seq, skew, last_rank))
+        last_counts[last_rank] += 1
+        lateness[last_rank] += skew
+    return CollectiveSkewReport(clock_offsets, collectives, last_counts, lateness)
@@ -3,7 +3,9 @@ from __future__ import absolute_import, division, print_function, unicode_litera
 import collections
 from datetime import timedelta
 import enum
+import pickle
 
+import torch
 import torch.distributed as dist
 
 from . import constants as rpc_constants
@@ -158,6 +160,7 @@ def _tensorpipe_construct_rpc_backend_options_handler(
     num_worker_threads=rpc_constants.DEFAULT_NUM_WORKER_THREADS,
     _transports=None,
     _channels=None,
+    device_maps=None,
     **kwargs
 ):
     from . import TensorPipeRpcBackendOptions
@@ -168,9 +171,59 @@ def _tensorpipe_construct_rpc_backend_options_handler(
         num_worker_threads=num_worker_threads,
         _transports=_transports,
         _channels=_channels,
+        device_maps=device_maps if device_maps is not None else {},
     )
 
 
+def _tensorpipe_exchange_and_check_all_device_maps(
+    store, name, rank, world_size, device_maps
+):
+    # Every worker publishes its device maps through the store, and inverts the
+    # ones its peers use for it, to place the tensors of its responses back.
+    device_maps_store = dist.PrefixStore("rpc_device_maps", store)
+    device_maps_store.set(str(rank), pickle.dumps((name, device_maps)))
+    all_device_maps = {}
+    for peer_rank in range(world_size):
+        peer_name, peer_device_maps = pickle.loads(
+            device_maps_store.get(str(peer_rank))
+        )
+        all_device_maps[peer_name] = peer_device_maps
+
+    local_device_count = torch.cuda.device_count()
+    for peer_name, device_map in device_maps.items():
+        if peer_name not in all_device_maps:
+            raise ValueError(
+                "Device map is set for unknown worker {}".format(peer_name)
+            )
+        if any(device >= local_device_count for device in device_map.keys()):
+            raise ValueError(
+                "Device map for worker {} uses local devices {}, but worker {} "
+                "only has {} CUDA devices".format(
+                    peer_name, sorted(device_map.keys()), name, local_device_count
+                )
+            )
+        if len(set(device_map.values())) != len(device_map):
+            raise ValueError(
+                "Device map for worker {} maps several local devices to the "
+                "same remote device: {}".format(peer_name, device_map)
+            )
+
+    reverse_device_maps = {}
+    for peer_name, peer_device_maps in all_device_maps.items():
+        if name not in peer_device_maps:
+            continue
+        device_map = peer_device_maps[name]
+        if any(device >= local_device_count for device in device_map.values()):
+            raise ValueError(
+                "Device map of worker {} uses devices {} of worker {}, which only "
+                "has {} CUDA devices".format(
+                    peer_name, sorted(device_map.values()), name, local_device_count
+                )
+            )
+        reverse_device_maps[peer_name] = {v: k for k, v in device_map.items()}
+    return reverse_device_maps
+
+
 def _tensorpipe_init_backend_handler(store, name, rank, world_size, rpc_backend_options):
     from . import TensorPipeRpcBackendOptions
     from . import TensorPipeAgent
@@ -193,9 +246,19 @@ def _tensorpipe_init_backend_handler(store, name, rank, world_size, rpc_backend_
 
     group = _init_process_group(store, rank, world_size)
 
+    reverse_device_maps = _tensorpipe_exchange_and_check_all_device_maps(
+        store, name, rank, world_size, rpc_backend_options.device_maps
+    )
+
     # TODO: add try-except and destroy _agent in all processes if any fails.
     return TensorPipeAgent(
-        store, name, rank, world_size, group, rpc_backend_options
+        store,
+        name,
+        rank,
+        world_size,
+        group,
+        rpc_backend_options,
+        reverse_device_maps,
     )
 
 
@@ -1,5 +1,8 @@
+import datetime
 import functools
 
+import torch
+
 
 def async_execution(fn):
     r"""
@@ -85,3 +88,82 @@ def async_execution(fn):
         return fn(*args, **kwargs)
     wrapper._wrapped_async_rpc_function = fn
     return wrapper
+
+
+def enable_batching(fn, max_batch_size, max_delay_ms):
+    r"""
+    Enables batching of the RPCs this worker receives for the TorchScript
+    function ``fn``. Instead of running each of them on its own, this worker
+    queues them until they hold ``max_batch_size`` rows, or until
+    ``max_delay_ms`` milliseconds have passed since the first of them was
+    queued. It then concatenates their arguments along dim 0, runs ``fn`` once
+    on the concatenations, and splits its result back along dim 0 into the
+    response of each RPC. This trades some latency for throughput when serving
+    many small inference requests.
+
+    ``fn`` must only take ``Tensor`` arguments, which all have the same size
+    along dim 0 (the number of rows of the RPC), and must return a ``Tensor``
+    or a tuple of ``Tensor`` s with one row (along dim 0) per row of its
+    arguments. If a batched run fails, each RPC of the batch is run on its
+    own. RPCs with other arguments, or sent within a distributed autograd
+    context or with the profiler enabled, are not batched.
+
+    This must be called on the callee, i.e., the worker running ``fn``, after
+    :meth:`~torch.distributed.rpc.init_rpc`.
+
+    Arguments:
+        fn (ScriptFunction): the TorchScript function to batch the RPCs of.
+        max_batch_size (int): the number of rows at which a batch is run.
+        max_delay_ms (float): the longest time an RPC waits for its batch to
+            fill up, in milliseconds.
+
+    Example::
+        >>> from torch.distributed import rpc
+        >>>
+        >>> # omitting setup and shutdown RPC
+        >>>
+        >>> @torch.jit.script
+        >>> def classify(x):
+        >>>     # type: (Tensor) -> Tensor
+        >>>     return x.argmax(dim=1)
+        >>>
+        >>> # On worker1
+        >>> rpc.functions.enable_batching(classify, 64, 5)
+        >>>
+        >>> # On worker0
+        >>> futs = [
+        >>>     rpc.rpc_async("worker1", classify, args=(torch.rand(1, 10),))
+        >>>     for _ in range(64)
+        >>> ]
+        >>> # All of these run within a single call of classify on worker1.
+        >>> rets = [fut.wait() for fut in futs]
+    """
+    if not isinstance(fn, torch.jit.ScriptFunction):
+        raise TypeError(
+            "Batching is only supported for TorchScript functions, got {}".format(
+                type(fn)
+            )
+        )
+    torch.distributed.rpc._enable_script_call_batching(
+        fn.qualified_name,
+        max_batch_size,
+        datetime.timedelta(milliseconds=max_delay_ms),
+    )
+
+
+def disable_batching(fn):
+    r"""
+    Disables the batching enabled by :meth:`enable_batching` for ``fn``. The
+    RPCs already queued are still run in a batch.
+
+    Arguments:
+        fn (ScriptFunction): the TorchScript function to stop batching the
+            RPCs of.
+    """
+    if not isinstance(fn, torch.jit.ScriptFunction):
+        raise TypeError(
+            "Batching is only supported for TorchScript functions, got {}".format(
+                type(fn)
+            )
+        )
+    torch.distributed.rpc._disable_script_call_batching(fn.qualified_name)
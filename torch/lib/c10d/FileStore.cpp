@@ -298,6 +298,46 @@ int64_t FileStore::addHelper(const std::string& key, int64_t i) {
   return ti;
 }
 
+void FileStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects the same number of keys and values");
+  }
+  std::unique_lock<std::mutex> l(activeFileOpLock_);
+  File file(path_, O_RDWR | O_CREAT, timeout_);
+  auto lock = file.lockExclusive();
+  file.seek(0, SEEK_END);
+  for (size_t i = 0; i < keys.size(); i++) {
+    file.write(regularPrefix_ + keys[i]);
+    file.write(values[i]);
+  }
+}
+
+std::vector<uint8_t> FileStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  std::string regKey = regularPrefix_ + key;
+  std::unique_lock<std::mutex> l(activeFileOpLock_);
+  File file(path_, O_RDWR | O_CREAT, timeout_);
+  auto lock = file.lockExclusive();
+  pos_ = refresh(file, pos_, cache_);
+
+  auto it = cache_.find(regKey);
+  if ((it == cache_.end() && !expectedValue.empty()) ||
+      (it != cache_.end() && it->second != expectedValue)) {
+    return it == cache_.end() ? std::vector<uint8_t>() : it->second;
+  }
+  // Nobody else can have written the key since the refresh, since we hold
+  // an exclusive lock.
+  file.seek(0, SEEK_END);
+  file.write(regKey);
+  file.write(desiredValue);
+  return desiredValue;
+}
+
 int64_t FileStore::add(const std::string& key, int64_t value) {
   std::string regKey = regularPrefix_ + key;
   return addHelper(regKey, value);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -107,6 +108,16 @@ class ProcessGroup {
     return size_;
   }
 
+  // Returns the number of collectives issued so far by this process group.
+  //
+  // The collectives are issued in the same order by all the ranks, so the
+  // sequence number of a collective identifies it across the ranks. It is
+  // recorded as the sequence number of the profiling range of the
+  // collective, see profilingTitle in ProcessGroupNCCL and ProcessGroupGloo.
+  uint64_t getSequenceNumber() const {
+    return seq_;
+  }
+
   virtual std::shared_ptr<ProcessGroup::Work> broadcast(
       std::vector<at::Tensor>& data,
       const BroadcastOptions& opts = BroadcastOptions()) = 0;
@@ -196,8 +207,14 @@ class ProcessGroup {
       const BarrierOptions& opts = BarrierOptions()) = 0;
 
  protected:
+  // Returns the sequence number of a new collective.
+  int64_t nextSequenceNumber() {
+    return seq_++;
+  }
+
   const int rank_;
   const int size_;
+  std::atomic<uint64_t> seq_{0};
 };
 
 } // namespace c10d
@@ -7,6 +7,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <queue>
 #include <type_traits>
 
 #include <gloo/allgather.h>
@@ -18,6 +19,8 @@
 #include <gloo/reduce.h>
 #include <gloo/scatter.h>
 
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/SparseTensorUtils.h>
 
 #ifdef USE_CUDA
@@ -232,6 +235,26 @@ at::Tensor pinnedLike(at::Tensor& tensor) {
       .set_(storage, 0, tensor.sizes(), tensor.strides());
 }
 
+// Collectives on CUDA tensors run on pinned host copies, which come from the
+// caching host allocator and are reused across calls. Large tensors are split
+// into chunks of at most this many bytes, so that the copies of a chunk
+// between the device and the host overlap with the collective on another
+// chunk.
+constexpr int64_t kPipelineChunkBytes = 4 * 1024 * 1024;
+
+int64_t pipelineChunkNumel(const at::Tensor& tensor) {
+  return std::max<int64_t>(1, kPipelineChunkBytes / tensor.element_size());
+}
+
+// Splits contiguous tensors into the views of their chunks. Other tensors
+// are a single chunk.
+std::vector<at::Tensor> pipelineChunks(const at::Tensor& tensor) {
+  if (!tensor.is_contiguous() || tensor.numel() == 0) {
+    return {tensor};
+  }
+  return tensor.view({-1}).split(pipelineChunkNumel(tensor));
+}
+
 // This function initializes a vector of CUDA streams, one for every
 // tensor in the input tensor vector, and ensures that these streams are
 // synchronized with the current default streams. This is needed so
@@ -597,7 +620,18 @@ void ProcessGroupGloo::runLoop(int workerIndex) {
   }
 }
 
-void ProcessGroupGloo::enqueue(std::shared_ptr<AsyncWork> work) {
+void ProcessGroupGloo::enqueue(
+    std::shared_ptr<AsyncWork> work,
+    const char* profilingTitle,
+    const std::vector<at::Tensor>& inputs) {
+  work->profilingTitle_ = profilingTitle;
+  work->seq_ = nextSequenceNumber();
+  // Only the profiled collectives keep a copy of the thread local state
+  if (at::hasCallbacks()) {
+    work->profilingInputs_.assign(inputs.begin(), inputs.end());
+    work->threadLocalState_.emplace();
+  }
+
   std::unique_lock<std::mutex> lock(workMutex_);
   workQueue_.push_back(std::move(work));
   lock.unlock();
@@ -666,29 +700,51 @@ class AsyncBroadcastCUDAWork : public AsyncBroadcastWork {
 
     // Create pinned host side tensors.
     tmp = pinnedLike(inputs[rootTensor]);
+
+    // The broadcast is pipelined over chunks if all tensors are contiguous.
+    bool contiguous = true;
+    for (const auto& input : inputs) {
+      contiguous = contiguous && input.is_contiguous();
+    }
+    tmpChunks = contiguous ? pipelineChunks(tmp) : std::vector<at::Tensor>{tmp};
+    inputChunks.reserve(inputs.size());
+    for (const auto& input : inputs) {
+      inputChunks.push_back(
+          contiguous ? pipelineChunks(input) : std::vector<at::Tensor>{input});
+    }
+
+    // Kick off the copy of every chunk, so that the broadcast of a chunk
+    // can start as soon as it is on the host.
     at::cuda::OptionalCUDAStreamGuard guard;
     if (context->rank == rootRank) {
       guard.reset_stream(streams[rootTensor]);
-      tmp.copy_(inputs[rootTensor], /* non_blocking */ true);
+      copyEvents.resize(tmpChunks.size());
+      for (size_t c = 0; c < tmpChunks.size(); c++) {
+        tmpChunks[c].copy_(inputChunks[rootTensor][c], /* non_blocking */ true);
+        copyEvents[c].record(streams[rootTensor]);
+      }
     }
   }
 
   void run() override {
     at::cuda::OptionalCUDAStreamGuard guard;
 
-    // Synchronize with copy operation if applicable.
-    if (context->rank == rootRank) {
-      guard.reset_stream(streams[rootTensor]);
-      AT_CUDA_CHECK(cudaStreamSynchronize(streams[rootTensor]));
-    }
+    for (size_t c = 0; c < tmpChunks.size(); c++) {
+      // Synchronize with the copy of the chunk if applicable.
+      if (context->rank == rootRank) {
+        copyEvents[c].synchronize();
+      }
 
-    // Run broadcast on host side tensors.
-    broadcast(tmp);
+      // Run broadcast on the host side chunk.
+      broadcast(tmpChunks[c]);
 
-    // Kick off copy back to the CUDA tensors.
+      // Kick off copy of the chunk back to the CUDA tensors.
+      for (size_t i = 0; i < inputs.size(); i++) {
+        guard.reset_stream(streams[i]);
+        inputChunks[i][c].copy_(tmpChunks[c], /* non_blocking */ true);
+      }
+    }
     for (size_t i = 0; i < inputs.size(); i++) {
-      guard.reset_stream(streams[i]);
-      inputs[i].copy_(tmp, /* non_blocking */ true);
       events[i].record(streams[i]);
     }
   }
@@ -703,6 +759,9 @@ class AsyncBroadcastCUDAWork : public AsyncBroadcastWork {
     }
   }
 
+  std::vector<at::Tensor> tmpChunks;
+  std::vector<std::vector<at::Tensor>> inputChunks;
+  std::vector<at::cuda::CUDAEvent> copyEvents;
   at::Tensor tmp;
   std::vector<at::cuda::CUDAStream> streams;
   std::vector<at::cuda::CUDAEvent> events;
@@ -750,7 +809,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
     throw std::runtime_error("Invalid backend");
   }
 
-  enqueue(work);
+  enqueue(work, "gloo:broadcast", inputs);
   return work;
 }
 
@@ -837,18 +896,165 @@ class AsyncAllreduceCoalescedWork : public AsyncAllreduceWork {
   }
 };
 
+// Sums the sparse tensors of size `sizes` that the ranks contributed to an
+// allreduce, given the indices and values gathered from every rank. The
+// tensor of every rank is coalesced, so its entries are sorted by flattened
+// index and unique. The range of flattened indices is split into partitions
+// that are merged in parallel: a k-way merge of the entries of every rank
+// first counts the unique indices of every partition, and then writes the
+// partition at its offset in the (coalesced) output.
+at::Tensor mergeCoalesced(
+    const std::vector<at::Tensor>& indices,
+    const std::vector<at::Tensor>& values,
+    at::IntArrayRef sizes) {
+  const auto ranks = indices.size();
+  const auto sparseDim = indices[0].size(0);
+  int64_t denseNumel = 1;
+  for (auto dim : sizes.slice(sparseDim)) {
+    denseNumel *= dim;
+  }
+
+  std::vector<at::Tensor> rankIndices(ranks);
+  std::vector<at::Tensor> rankKeys(ranks);
+  std::vector<at::Tensor> rankValues(ranks);
+  size_t largest = 0;
+  for (size_t r = 0; r < ranks; r++) {
+    rankIndices[r] = indices[r].contiguous();
+    rankKeys[r] =
+        at::sparse::flatten_indices(rankIndices[r], sizes).contiguous();
+    rankValues[r] =
+        values[r].contiguous().reshape({values[r].size(0), denseNumel});
+    if (rankKeys[r].numel() > rankKeys[largest].numel()) {
+      largest = r;
+    }
+  }
+
+  // Partition boundaries are evenly spaced entries of the rank with the most
+  // entries. `bounds[p * ranks + r]` is where partition p starts in rank r.
+  const int64_t largestNnz = rankKeys[largest].numel();
+  const int64_t partitions = std::max<int64_t>(
+      1,
+      std::min<int64_t>(
+          at::get_num_threads(), largestNnz / at::internal::GRAIN_SIZE));
+  std::vector<int64_t> bounds((partitions + 1) * ranks);
+  for (size_t r = 0; r < ranks; r++) {
+    const int64_t* keys = rankKeys[r].data_ptr<int64_t>();
+    const int64_t nnz = rankKeys[r].numel();
+    bounds[r] = 0;
+    for (int64_t p = 1; p < partitions; p++) {
+      const int64_t splitter = rankKeys[largest].data_ptr<int64_t>()
+                                   [p * largestNnz / partitions];
+      bounds[p * ranks + r] = std::lower_bound(keys, keys + nnz, splitter) - keys;
+    }
+    bounds[partitions * ranks + r] = nnz;
+  }
+
+  // Calls fn(first, rank, position) for the entries of partition p in order
+  // of their flattened index, where `first` is set for the first entry of
+  // every flattened index.
+  auto mergePartition = [&](int64_t p, auto&& fn) {
+    using Head = std::pair<int64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<int64_t> positions(ranks);
+    for (size_t r = 0; r < ranks; r++) {
+      positions[r] = bounds[p * ranks + r];
+      if (positions[r] < bounds[(p + 1) * ranks + r]) {
+        heads.emplace(rankKeys[r].data_ptr<int64_t>()[positions[r]], r);
+      }
+    }
+    bool first = true;
+    int64_t last = 0;
+    while (!heads.empty()) {
+      const auto head = heads.top();
+      heads.pop();
+      const auto r = head.second;
+      fn(first || head.first != last, r, positions[r]);
+      first = false;
+      last = head.first;
+      if (++positions[r] < bounds[(p + 1) * ranks + r]) {
+        heads.emplace(rankKeys[r].data_ptr<int64_t>()[positions[r]], r);
+      }
+    }
+  };
+
+  std::vector<int64_t> offsets(partitions + 1, 0);
+  at::parallel_for(0, partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      int64_t count = 0;
+      mergePartition(p, [&](bool first, size_t, int64_t) { count += first; });
+      offsets[p + 1] = count;
+    }
+  });
+  for (int64_t p = 0; p < partitions; p++) {
+    offsets[p + 1] += offsets[p];
+  }
+
+  const int64_t nnz = offsets[partitions];
+  auto outputIndices = at::empty({sparseDim, nnz}, at::kLong);
+  auto outputValues = at::empty({nnz, denseNumel}, rankValues[0].options());
+  int64_t* outputIndicesData = outputIndices.data_ptr<int64_t>();
+  AT_DISPATCH_ALL_TYPES_AND(
+      at::ScalarType::Half, outputValues.scalar_type(), "mergeCoalesced", [&] {
+        scalar_t* outputValuesData = outputValues.data_ptr<scalar_t>();
+        at::parallel_for(0, partitions, 1, [&](int64_t begin, int64_t end) {
+          for (int64_t p = begin; p < end; p++) {
+            int64_t i = offsets[p] - 1;
+            mergePartition(p, [&](bool first, size_t r, int64_t position) {
+              const scalar_t* value =
+                  rankValues[r].data_ptr<scalar_t>() + position * denseNumel;
+              scalar_t* output = outputValuesData + (first ? ++i : i) * denseNumel;
+              if (first) {
+                const int64_t* index =
+                    rankIndices[r].data_ptr<int64_t>() + position;
+                const int64_t rankNnz = rankIndices[r].size(1);
+                for (int64_t d = 0; d < sparseDim; d++) {
+                  outputIndicesData[d * nnz + i] = index[d * rankNnz];
+                }
+                std::copy(value, value + denseNumel, output);
+              } else {
+                for (int64_t k = 0; k < denseNumel; k++) {
+                  output[k] += value[k];
+                }
+              }
+            });
+          }
+        });
+      });
+
+  std::vector<int64_t> valueShape({nnz});
+  const auto denseSizes = sizes.slice(sparseDim);
+  valueShape.insert(valueShape.end(), denseSizes.begin(), denseSizes.end());
+  return at::_sparse_coo_tensor_unsafe(
+             outputIndices,
+             outputValues.view(valueShape),
+             sizes,
+             outputValues.options().layout(c10::kSparse))
+      ._coalesced_(true);
+}
+
 class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
  public:
+  // If `coalesced` is set, `inputs` are distinct tensors that are allreduced
+  // in a single collective, see `allreduceCoalesced`. Otherwise they are
+  // replicas of a single tensor.
   AsyncSparseAllreduceWork(
       const std::shared_ptr<gloo::Context>& context,
       std::vector<at::Tensor>& inputs,
-      uint32_t tag)
-      : context(context), inputs(inputs), tag(tag) {}
+      uint32_t tag,
+      bool coalesced = false,
+      double densityThreshold = 0)
+      : context(context),
+        inputs(inputs),
+        tag(tag),
+        coalesced(coalesced),
+        densityThreshold(densityThreshold) {}
 
   std::shared_ptr<gloo::Context> context;
   std::vector<at::Tensor> inputs;
   std::vector<at::Tensor> outputs;
   const uint32_t tag;
+  const bool coalesced;
+  const double densityThreshold;
 
   // We share dimensionality about the sparse tensors before collecting
   // their contents. We assume here that the maximum number of sparse
@@ -924,8 +1130,7 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
   // Sparse allreduce is implemented with allgather on indices and values.
   // Every process then sums the resulting sparse tensors locally.
   // The nnz for sparse tensors may be different across processes, so first
-  // we run allgather on the nnz, and then allgather with max(nnz).
-  // We could use an allgatherv for this, if it were available.
+  // we run allgather on the nnz, and then allgatherv on indices and values.
   at::Tensor allreduce(std::vector<at::Tensor>& tensors) {
     // TODO: This is a massive hack!  There is some confusion about
     // Variable/Tensor inside the body of this function.  Turning off
@@ -942,53 +1147,114 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
       input += tensors[i];
     }
 
+    return allreduceCoalesced({input})[0];
+  }
+
+  // Allreduces distinct sparse tensors of the same type, with a single
+  // allgather of their metadata, indices and values each. If the density
+  // threshold is positive, the tensors whose number of entries gathered from
+  // all ranks is at least the threshold times their number of rows are
+  // allreduced as dense tensors instead, which every rank decides the same
+  // way from the gathered metadata.
+  std::vector<at::Tensor> allreduceCoalesced(std::vector<at::Tensor> tensors) {
+    at::AutoNonVariableTypeMode _no_grad(true);
+
     // Need to coalesce before we can access indices and values.
-    input = input.coalesce();
+    for (auto& tensor : tensors) {
+      tensor = tensor.coalesce();
+    }
 
     // Gather metadata information from all ranks.
-    auto metadata = allgather_metadata(input);
+    auto metadata = allgather_metadata(tensors);
 
     // Sanity check dimensionality across ranks.
-    {
-      const auto expected = metadata[context->rank].sizes();
+    for (size_t t = 0; t < tensors.size(); t++) {
+      const auto expected = metadata[t][context->rank].sizes();
       for (auto i = 0; i < context->size; i++) {
         if (i == context->rank) {
           continue;
         }
-        const auto actual = metadata[i].sizes();
+        const auto actual = metadata[t][i].sizes();
         TORCH_CHECK(actual == expected, "Sparse dimensions do not match");
       }
     }
 
-    // Gather all indices and all values.
-    auto indices = allgather_indices(input, metadata);
-    auto values = allgather_values(input, metadata);
+    std::vector<at::Tensor> sparseTensors;
+    std::vector<at::Tensor> denseTensors;
+    std::vector<bool> isDense(tensors.size(), false);
+    for (size_t t = 0; t < tensors.size(); t++) {
+      if (densityThreshold > 0) {
+        int64_t rows = 1;
+        for (int64_t d = 0; d < tensors[t].sparse_dim(); d++) {
+          rows *= tensors[t].size(d);
+        }
+        int64_t gathered = 0;
+        for (const auto& rankMetadata : metadata[t]) {
+          gathered += rankMetadata.nnz();
+        }
+        isDense[t] = gathered >= densityThreshold * rows;
+      }
+      if (isDense[t]) {
+        denseTensors.push_back(tensors[t]);
+      } else {
+        sparseTensors.push_back(tensors[t]);
+      }
+    }
+
+    std::vector<std::vector<at::Tensor>> indices;
+    std::vector<std::vector<at::Tensor>> values;
+    if (!sparseTensors.empty()) {
+      std::vector<std::vector<SparseTensorMetadata>> sparseMetadata;
+      for (size_t t = 0; t < tensors.size(); t++) {
+        if (!isDense[t]) {
+          sparseMetadata.push_back(metadata[t]);
+        }
+      }
+      indices = allgather_indices(sparseTensors, sparseMetadata);
+      values = allgather_values(sparseTensors, sparseMetadata);
+    }
+    std::vector<at::Tensor> denseOutputs;
+    if (!denseTensors.empty()) {
+      denseOutputs = allreduce_dense(denseTensors);
+    }
 
     // Perform global reduction.
-    AT_ASSERT(static_cast<int>(indices.size()) == context->size);
-    AT_ASSERT(static_cast<int>(values.size()) == context->size);
-    auto output = at::sparse_coo_tensor(
-        indices[0], values[0], input.sizes(), input.options());
-    for (auto i = 1; i < context->size; i++) {
-      output += at::sparse_coo_tensor(
-          indices[i], values[i], input.sizes(), input.options());
+    std::vector<at::Tensor> outputs;
+    outputs.reserve(tensors.size());
+    size_t sparseIndex = 0;
+    size_t denseIndex = 0;
+    for (size_t t = 0; t < tensors.size(); t++) {
+      if (isDense[t]) {
+        outputs.push_back(denseOutputs[denseIndex++].to_sparse(
+            tensors[t].sparse_dim()));
+      } else {
+        outputs.push_back(mergeCoalesced(
+            indices[sparseIndex], values[sparseIndex], tensors[t].sizes()));
+        sparseIndex++;
+      }
     }
+    return outputs;
+  }
 
-    // Coalesce for good measure.
-    return output.coalesce();
+  // Reduces the inputs, and returns the result for every input.
+  std::vector<at::Tensor> reduceInputs(std::vector<at::Tensor>& tensors) {
+    if (coalesced) {
+      return allreduceCoalesced(tensors);
+    }
+    return std::vector<at::Tensor>(tensors.size(), allreduce(tensors));
   }
 
   void run() override {
-    auto output = allreduce(inputs);
+    auto results = reduceInputs(inputs);
 
     // Copy back to input tensors.
     outputs.reserve(inputs.size());
     for (size_t i = 0; i < inputs.size(); i++) {
-      inputs[i].copy_(output);
-      if (output.is_sparse()) {
-        outputs.push_back(output.clone());
+      inputs[i].copy_(results[i]);
+      if (results[i].is_sparse()) {
+        outputs.push_back(results[i].clone());
       } else {
-        outputs.push_back(output.clone(at::MemoryFormat::Contiguous));
+        outputs.push_back(results[i].clone(at::MemoryFormat::Contiguous));
       }
     }
   }
@@ -998,21 +1264,24 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
   }
 
  private:
-  std::vector<SparseTensorMetadata> allgather_metadata(
-      const at::Tensor& tensor) {
-    auto buffer =
-        at::zeros({context->size, SparseTensorMetadata::dim}, at::kLong);
-
-    // Prepare metadata vector (1 entry per rank)
-    std::vector<SparseTensorMetadata> metadata;
-    metadata.reserve(context->size);
-    for (auto i = 0; i < context->size; i++) {
-      metadata.emplace_back(buffer.select(0, i));
+  // Returns the metadata of every tensor, for every rank.
+  std::vector<std::vector<SparseTensorMetadata>> allgather_metadata(
+      const std::vector<at::Tensor>& tensors) {
+    const auto numTensors = static_cast<int64_t>(tensors.size());
+    auto buffer = at::zeros(
+        {context->size, numTensors, SparseTensorMetadata::dim}, at::kLong);
+
+    // Prepare metadata vector (1 entry per tensor per rank)
+    std::vector<std::vector<SparseTensorMetadata>> metadata(numTensors);
+    for (int64_t t = 0; t < numTensors; t++) {
+      metadata[t].reserve(context->size);
+      for (auto i = 0; i < context->size; i++) {
+        metadata[t].emplace_back(buffer.select(0, i).select(0, t));
+      }
+      // Populate data for this rank
+      metadata[t][context->rank].populate_from_sparse_tensor(tensors[t]);
     }
 
-    // Populate data for this rank
-    metadata[context->rank].populate_from_sparse_tensor(tensor);
-
     // Allgather metadata
     gloo::AllgatherOptions opts(context);
     opts.setOutput(buffer.data_ptr<int64_t>(), buffer.numel());
@@ -1022,23 +1291,30 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
     return metadata;
   }
 
-  std::vector<at::Tensor> allgather_indices(
-      const at::Tensor& tensor,
-      const std::vector<SparseTensorMetadata>& metadata) {
-    const auto sparseDim = tensor.sparse_dim();
-
-    std::vector<size_t> counts(context->size);
+  // Returns the indices of every tensor, for every rank.
+  std::vector<std::vector<at::Tensor>> allgather_indices(
+      const std::vector<at::Tensor>& tensors,
+      const std::vector<std::vector<SparseTensorMetadata>>& metadata) {
+    std::vector<size_t> counts(context->size, 0);
     int64_t totalSize = 0;
-    for (size_t i = 0; i < metadata.size(); i++) {
-      counts[i] = metadata[i].nnz() * sparseDim;
-      totalSize += counts[i];
+    for (size_t t = 0; t < tensors.size(); t++) {
+      const auto sparseDim = tensors[t].sparse_dim();
+      for (auto i = 0; i < context->size; i++) {
+        counts[i] += metadata[t][i].nnz() * sparseDim;
+        totalSize += metadata[t][i].nnz() * sparseDim;
+      }
     }
 
     auto output = at::empty({totalSize}, at::kLong);
 
     // tensors copied from cuda may not be contiguous, get a contiguous
     // tensor before use its data_ptr
-    auto input = tensor.indices().contiguous();
+    std::vector<at::Tensor> flatIndices;
+    flatIndices.reserve(tensors.size());
+    for (const auto& tensor : tensors) {
+      flatIndices.push_back(tensor.indices().contiguous().view({-1}));
+    }
+    auto input = at::cat(flatIndices);
 
     // Allgatherv indices.
     gloo::AllgathervOptions opts(context);
@@ -1047,69 +1323,119 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
     opts.setTag(tag);
     gloo::allgatherv(opts);
 
-    // Compile indices tensor per rank.
-    std::vector<at::Tensor> indices;
-    indices.reserve(metadata.size());
+    // Compile indices tensor per tensor per rank. The output holds the
+    // indices of every tensor in order, for every rank in order.
+    std::vector<std::vector<at::Tensor>> indices(tensors.size());
     size_t offset = 0;
-    for (size_t i = 0; i < metadata.size(); i++) {
-      const auto nnz = metadata[i].nnz();
-      const auto numel = sparseDim * nnz;
-      indices.push_back(
-          output.narrow(0, offset, numel).reshape({sparseDim, nnz}));
-      offset += numel;
+    for (auto i = 0; i < context->size; i++) {
+      for (size_t t = 0; t < tensors.size(); t++) {
+        const auto sparseDim = tensors[t].sparse_dim();
+        const auto nnz = metadata[t][i].nnz();
+        const auto numel = sparseDim * nnz;
+        indices[t].push_back(
+            output.narrow(0, offset, numel).reshape({sparseDim, nnz}));
+        offset += numel;
+      }
     }
 
     return indices;
   }
 
-  std::vector<at::Tensor> allgather_values(
-      const at::Tensor& tensor,
-      const std::vector<SparseTensorMetadata>& metadata) {
+  // Returns the values of every tensor, for every rank.
+  std::vector<std::vector<at::Tensor>> allgather_values(
+      const std::vector<at::Tensor>& tensors,
+      const std::vector<std::vector<SparseTensorMetadata>>& metadata) {
     // There are nnz #dense_dim()-dimensional tensors per rank.
-    const auto valueShape = tensor.sizes().slice(tensor.sparse_dim());
-    size_t denseNumel = 1;
-    for (auto dim : valueShape) {
-      denseNumel *= dim;
+    std::vector<size_t> denseNumels(tensors.size(), 1);
+    for (size_t t = 0; t < tensors.size(); t++) {
+      for (auto dim : tensors[t].sizes().slice(tensors[t].sparse_dim())) {
+        denseNumels[t] *= dim;
+      }
     }
 
-    std::vector<size_t> counts(context->size);
+    std::vector<size_t> counts(context->size, 0);
     int64_t totalSize = 0;
-    for (size_t i = 0; i < metadata.size(); i++) {
-      counts[i] = metadata[i].nnz() * denseNumel;
-      totalSize += counts[i];
+    for (size_t t = 0; t < tensors.size(); t++) {
+      for (auto i = 0; i < context->size; i++) {
+        counts[i] += metadata[t][i].nnz() * denseNumels[t];
+        totalSize += metadata[t][i].nnz() * denseNumels[t];
+      }
     }
 
-    auto output = at::empty({totalSize}, tensor.scalar_type());
+    auto output = at::empty({totalSize}, tensors[0].scalar_type());
 
-    // Allgatherv indices.
+    // Allgatherv values.
     gloo::AllgathervOptions opts(context);
     // tensors copied from cuda may not be contiguous, get a contiguous
     // tensor before use its data_ptr
-    at::Tensor valueTensor = tensor.values().contiguous();
+    std::vector<at::Tensor> flatValues;
+    flatValues.reserve(tensors.size());
+    for (const auto& tensor : tensors) {
+      flatValues.push_back(tensor.values().contiguous().view({-1}));
+    }
+    at::Tensor valueTensor = at::cat(flatValues);
     GENERATE_ALL_TYPES(valueTensor.scalar_type(), setInput, opts, valueTensor);
     GENERATE_ALL_TYPES(
         valueTensor.scalar_type(), setOutput, opts, output, counts);
     opts.setTag(tag);
     gloo::allgatherv(opts);
 
-    // Compile values tensor per rank.
-    std::vector<at::Tensor> values;
-    values.reserve(metadata.size());
+    // Compile values tensor per tensor per rank.
+    std::vector<std::vector<at::Tensor>> values(tensors.size());
     size_t offset = 0;
-    for (size_t i = 0; i < metadata.size(); i++) {
-      const auto nnz = metadata[i].nnz();
-      const auto numel = denseNumel * nnz;
-      auto tensorShape = std::vector<int64_t>({(int64_t)nnz});
-      std::copy(
-          valueShape.begin(),
-          valueShape.end(),
-          std::back_inserter(tensorShape));
-      values.push_back(output.narrow(0, offset, numel).reshape(tensorShape));
-      offset += numel;
+    for (auto i = 0; i < context->size; i++) {
+      for (size_t t = 0; t < tensors.size(); t++) {
+        const auto valueShape = tensors[t].sizes().slice(tensors[t].sparse_dim());
+        const auto nnz = metadata[t][i].nnz();
+        const auto numel = denseNumels[t] * nnz;
+        auto tensorShape = std::vector<int64_t>({(int64_t)nnz});
+        std::copy(
+            valueShape.begin(),
+            valueShape.end(),
+            std::back_inserter(tensorShape));
+        values[t].push_back(
+            output.narrow(0, offset, numel).reshape(tensorShape));
+        offset += numel;
+      }
     }
 
     return values;
   }
+
+  template <typename T>
+  void getSumFunction(gloo::AllreduceOptions::Func& fn) {
+    fn = toFunction<T>(ReduceOp::SUM);
+  }
+
+  // Allreduces the dense versions of the tensors with a single allreduce,
+  // and returns them.
+  std::vector<at::Tensor> allreduce_dense(
+      const std::vector<at::Tensor>& tensors) {
+    std::vector<at::Tensor> flatTensors;
+    flatTensors.reserve(tensors.size());
+    for (const auto& tensor : tensors) {
+      flatTensors.push_back(tensor.to_dense().view({-1}));
+    }
+    auto flat = at::cat(flatTensors);
+
+    gloo::AllreduceOptions opts(context);
+    gloo::AllreduceOptions::Func fn;
+    GENERATE_ALL_TYPES(flat.scalar_type(), getSumFunction, fn);
+    opts.setReduceFunction(fn);
+    GENERATE_ALL_TYPES(flat.scalar_type(), setOutput, opts, flat);
+    opts.setTag(tag);
+    gloo::allreduce(opts);
+
+    std::vector<at::Tensor> outputs;
+    outputs.reserve(tensors.size());
+    int64_t offset = 0;
+    for (const auto& tensor : tensors) {
+      outputs.push_back(
+          flat.narrow(0, offset, tensor.numel()).view(tensor.sizes()));
+      offset += tensor.numel();
+    }
+    return outputs;
+  }
 };
 
 #ifdef USE_CUDA
@@ -1176,8 +1502,15 @@ class AsyncSparseAllreduceCUDAWork : public AsyncSparseAllreduceWork {
   AsyncSparseAllreduceCUDAWork(
       const std::shared_ptr<gloo::Context>& context,
       std::vector<at::Tensor>& inputs,
-      uint32_t tag)
-      : AsyncSparseAllreduceWork(context, inputs, tag) {
+      uint32_t tag,
+      bool coalesced = false,
+      double densityThreshold = 0)
+      : AsyncSparseAllreduceWork(
+            context,
+            inputs,
+            tag,
+            coalesced,
+            densityThreshold) {
     initializeStreamsEvents(inputs, streams, events);
 
     // Kick off copy from CUDA tensors to CPU tensors.
@@ -1201,13 +1534,14 @@ class AsyncSparseAllreduceCUDAWork : public AsyncSparseAllreduceWork {
     }
 
     // Run allreduce on host side tensors.
-    auto output = allreduce(tmp);
+    auto results = reduceInputs(tmp);
 
     // Kick off copy back to the CUDA tensors.
     at::cuda::OptionalCUDAStreamGuard stream_guard;
     for (size_t i = 0; i < inputs.size(); i++) {
       stream_guard.reset_stream(streams[i]);
-      outputs.push_back(output.to(inputs[i].device(), /*non_blocking=*/true));
+      outputs.push_back(
+          results[i].to(inputs[i].device(), /*non_blocking=*/true));
       events[i].record(streams[i]);
     }
   }
@@ -1294,7 +1628,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
     throw std::runtime_error("Invalid backend");
   }
 
-  enqueue(work);
+  enqueue(work, "gloo:all_reduce", inputs);
   return work;
 }
 
@@ -1330,6 +1664,13 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce_coalesced(
   switch (device.type()) {
     case c10::kCPU:
       break;
+#ifdef USE_CUDA
+    case c10::kCUDA:
+      // Only sparse tensors are staged through host memory here.
+      if (layout == c10::kSparse) {
+        break;
+      }
+#endif
     default:
       invalidArgument(c10::str("unsupported device type ", device.type()));
   }
@@ -1337,6 +1678,13 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce_coalesced(
   switch (layout) {
     case c10::kStrided:
       break;
+    case c10::kSparse:
+      if (opts.reduceOp != ReduceOp::SUM) {
+        invalidArgument(
+            "unsupported reduction operation "
+            "(allreduce of sparse tensors only works with ReduceOp.SUM)");
+      }
+      break;
     default:
       invalidArgument("unsupported layout");
   }
@@ -1348,13 +1696,29 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce_coalesced(
     if (layout == c10::kStrided) {
       work = std::make_shared<AsyncAllreduceCoalescedWork>(
           std::move(context), tensors, opts.reduceOp, tag);
+    } else if (layout == c10::kSparse) {
+      work = std::make_shared<AsyncSparseAllreduceWork>(
+          std::move(context),
+          tensors,
+          tag,
+          /* coalesced */ true,
+          opts.sparseDensityThreshold);
     } else {
       invalidArgument("unsupported layout");
     }
+#ifdef USE_CUDA
+  } else if (device.type() == c10::kCUDA) {
+    work = std::make_shared<AsyncSparseAllreduceCUDAWork>(
+        std::move(context),
+        tensors,
+        tag,
+        /* coalesced */ true,
+        opts.sparseDensityThreshold);
+#endif
   } else {
     throw std::runtime_error("Invalid backend");
   }
-  enqueue(work);
+  enqueue(work, "gloo:all_reduce_coalesced", tensors);
   return work;
 }
 
@@ -1520,7 +1884,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce(
   } else {
     throw std::runtime_error("Invalid backend");
   }
-  enqueue(work);
+  enqueue(work, "gloo:reduce", inputs);
   return work;
 }
 
@@ -1717,7 +2081,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather(
   } else {
     throw std::runtime_error("Invalid backend");
   }
-  enqueue(work);
+  enqueue(work, "gloo:all_gather", inputs);
   return work;
 }
 
@@ -1783,6 +2147,107 @@ class AsyncAllgatherCoalescedWork : public ProcessGroupGloo::AsyncWork {
   }
 };
 
+#ifdef USE_CUDA
+
+// The inputs are flattened on the device and copied to pinned host memory
+// chunk by chunk. The allgather of a chunk starts as soon as its copy has
+// completed, and its output is copied back while the next chunk is gathered.
+class AsyncAllgatherCoalescedCUDAWork : public AsyncAllgatherCoalescedWork {
+ public:
+  AsyncAllgatherCoalescedCUDAWork(
+      const std::shared_ptr<gloo::Context>& context,
+      std::vector<std::vector<at::Tensor>>& output_lists,
+      std::vector<at::Tensor>& input_list,
+      uint32_t tag)
+      : AsyncAllgatherCoalescedWork(context, output_lists, input_list, tag) {
+    // Flatten on the current stream, which the inputs were produced on.
+    std::vector<at::Tensor> flatInputs = {flattenDenseTensors(input_list)};
+    initializeStreamsEvents(flatInputs, streams, events);
+    flatInput = flatInputs[0];
+    for (auto& output_list : output_lists) {
+      for (auto& output_tensor : output_list) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            output_tensor.storage().data_ptr(), streams[0]);
+      }
+    }
+
+    at::cuda::OptionalCUDAStreamGuard guard(streams[0]);
+    flatOutput =
+        at::empty({context->size, flatInput.numel()}, flatInput.options());
+    tmpInput = pinnedLike(flatInput);
+    // Chunk-major, so that the gathered chunks are contiguous.
+    tmpOutput = pinnedLike(flatOutput);
+
+    // Kick off the copy of every chunk to the host.
+    const auto numel = flatInput.numel();
+    const auto chunk = pipelineChunkNumel(flatInput);
+    for (int64_t offset = 0; offset < numel; offset += chunk) {
+      const auto length = std::min(chunk, numel - offset);
+      tmpInput.narrow(0, offset, length)
+          .copy_(flatInput.narrow(0, offset, length), /* non_blocking */ true);
+      copyEvents.emplace_back();
+      copyEvents.back().record(streams[0]);
+    }
+  }
+
+  void run() override {
+    const auto& scalarType = flatInput.scalar_type();
+    const auto size = context->size;
+    const auto numel = flatInput.numel();
+    const auto chunk = pipelineChunkNumel(flatInput);
+    auto flatTmpOutput = tmpOutput.view({-1});
+
+    at::cuda::OptionalCUDAStreamGuard guard(streams[0]);
+    size_t c = 0;
+    for (int64_t offset = 0; offset < numel; offset += chunk, c++) {
+      const auto length = std::min(chunk, numel - offset);
+      copyEvents[c].synchronize();
+
+      auto input = tmpInput.narrow(0, offset, length);
+      auto output = flatTmpOutput.narrow(0, size * offset, size * length);
+      gloo::AllgatherOptions opts(context);
+      opts.setTag(tag);
+      GENERATE_ALL_TYPES(scalarType, setInput, opts, input);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, output);
+      gloo::allgather(opts);
+
+      // Kick off copy of the gathered chunks back to the device.
+      flatOutput.narrow(1, offset, length)
+          .copy_(output.view({size, length}), /* non_blocking */ true);
+    }
+
+    // Unflatten into the output tensors.
+    for (size_t i = 0; i < output_lists.size(); i++) {
+      int64_t current_element = 0;
+      for (auto& output_tensor : output_lists[i]) {
+        output_tensor.copy_(
+            flatOutput[i]
+                .narrow(0, current_element, output_tensor.numel())
+                .view(output_tensor.sizes()),
+            /* non_blocking */ true);
+        current_element += output_tensor.numel();
+      }
+    }
+    events[0].record(streams[0]);
+  }
+
+  void synchronize() override {
+    // Synchronize with the copy back to CUDA tensors.
+    at::cuda::OptionalCUDAGuard guard(flatInput.device());
+    events[0].block(at::cuda::getCurrentCUDAStream());
+  }
+
+  at::Tensor flatInput;
+  at::Tensor flatOutput;
+  at::Tensor tmpInput;
+  at::Tensor tmpOutput;
+  std::vector<at::cuda::CUDAStream> streams;
+  std::vector<at::cuda::CUDAEvent> events;
+  std::vector<at::cuda::CUDAEvent> copyEvents;
+};
+
+#endif
+
 } // namespace
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather_coalesced(
@@ -1833,11 +2298,39 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather_coalesced(
 
   assertDense(invalidArgument, input_list);
 
+  const auto& device = input_list[0].device();
+  switch (device.type()) {
+    case at::kCPU:
+#ifdef USE_CUDA
+    case at::kCUDA:
+#endif
+      break;
+    default:
+      invalidArgument(c10::str("unsupported device type ", device.type()));
+  }
+  for (const auto& output_list : output_lists) {
+    for (const auto& output_tensor : output_list) {
+      if (output_tensor.device() != device) {
+        invalidArgument("requires output tensors on the device of the inputs");
+      }
+    }
+  }
+
+  std::shared_ptr<AsyncAllgatherCoalescedWork> work;
   auto tag = nextTag();
   auto context = getContext(tag);
-  auto work = std::make_shared<AsyncAllgatherCoalescedWork>(
-      std::move(context), output_lists, input_list, tag);
-  enqueue(work);
+  if (device.type() == at::kCPU) {
+    work = std::make_shared<AsyncAllgatherCoalescedWork>(
+        std::move(context), output_lists, input_list, tag);
+#ifdef USE_CUDA
+  } else if (device.type() == at::kCUDA) {
+    work = std::make_shared<AsyncAllgatherCoalescedCUDAWork>(
+        std::move(context), output_lists, input_list, tag);
+#endif
+  } else {
+    throw std::runtime_error("Invalid backend");
+  }
+  enqueue(work, "gloo:all_gather_coalesced", input_list);
   return work;
 }
 
@@ -2049,7 +2542,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::gather(
   } else {
     throw std::runtime_error("Invalid backend");
   }
-  enqueue(work);
+  enqueue(work, "gloo:gather", inputs);
   return work;
 }
 
@@ -2235,7 +2728,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::scatter(
   } else {
     throw std::runtime_error("Invalid backend");
   }
-  enqueue(work);
+  enqueue(work, "gloo:scatter", outputs);
   return work;
 }
 
@@ -2382,7 +2875,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::barrier(
   auto context = getContext(tag);
   auto work = std::make_shared<AsyncBarrierWork>(
       std::move(context), std::move(priorWork), tag);
-  enqueue(work);
+  enqueue(work, "gloo:barrier");
   return work;
 }
 
@@ -13,6 +13,9 @@
 #include <gloo/rendezvous/store.h>
 #include <gloo/transport/device.h>
 
+#include <ATen/ThreadLocalState.h>
+#include <ATen/record_function.h>
+#include <c10/util/Optional.h>
 #include <torch/csrc/utils/hash.h>
 
 #ifdef USE_CUDA
@@ -70,10 +73,23 @@ class ProcessGroupGloo : public ProcessGroup {
    public:
     static void execute(std::shared_ptr<AsyncWork> work) {
       std::exception_ptr eptr;
-      try {
-        work->run();
-      } catch (...) {
-        eptr = std::current_exception();
+      {
+        // The collective runs on a worker thread; restore the thread local
+        // state of the caller of enqueue, so that its profiler records it.
+        c10::optional<at::ThreadLocalStateGuard> tlsGuard;
+        if (work->threadLocalState_) {
+          tlsGuard.emplace(*work->threadLocalState_);
+        }
+        RECORD_FUNCTION_WITH_SCOPE(
+            at::RecordScope::USER_SCOPE,
+            work->profilingTitle_,
+            work->profilingInputs_,
+            work->seq_);
+        try {
+          work->run();
+        } catch (...) {
+          eptr = std::current_exception();
+        }
       }
       work->finish(eptr);
     }
@@ -82,6 +98,12 @@ class ProcessGroupGloo : public ProcessGroup {
 
    protected:
     friend class ProcessGroupGloo;
+
+    // Set by enqueue, see ProcessGroup::getSequenceNumber.
+    const char* profilingTitle_ = nullptr;
+    std::vector<c10::IValue> profilingInputs_;
+    int64_t seq_ = -1;
+    c10::optional<at::ThreadLocalState> threadLocalState_;
   };
 
   // For send and recv operations there is no need to pass them to the
@@ -249,7 +271,12 @@ class ProcessGroupGloo : public ProcessGroup {
   void runLoop(int workerIndex);
 
   // Queue work to run on worker thread.
-  void enqueue(std::shared_ptr<AsyncWork> work);
+  // Queues the work on the worker threads, the work is recorded as a
+  // RecordFunction range named profilingTitle when it runs.
+  void enqueue(
+      std::shared_ptr<AsyncWork> work,
+      const char* profilingTitle,
+      const std::vector<at::Tensor>& inputs = {});
 
   // Keep both a queue of pending work, and a vector with in progress work.
   // Both of these can only be mutated when holding the queue lock.
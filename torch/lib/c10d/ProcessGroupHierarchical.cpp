@@ -0,0 +1,291 @@
+#include <c10d/ProcessGroupHierarchical.hpp>
+
+namespace c10d {
+
+ProcessGroupHierarchical::ProcessGroupHierarchical(
+    int rank,
+    int size,
+    std::shared_ptr<ProcessGroup> global,
+    std::shared_ptr<ProcessGroup> intraNode,
+    std::shared_ptr<ProcessGroup> interNode,
+    bool useReduceScatter)
+    : ProcessGroup(rank, size),
+      global_(std::move(global)),
+      intraNode_(std::move(intraNode)),
+      interNode_(std::move(interNode)),
+      useReduceScatter_(useReduceScatter),
+      stop_(false) {
+  TORCH_CHECK(global_ && intraNode_ && interNode_);
+  TORCH_CHECK(global_->getRank() == rank_);
+  TORCH_CHECK(global_->getSize() == size_);
+  TORCH_CHECK(
+      intraNode_->getSize() * interNode_->getSize() == size_,
+      "Expected every node to have the same number of processes, got ",
+      intraNode_->getSize(),
+      " processes on this node and ",
+      interNode_->getSize(),
+      " nodes for ",
+      size_,
+      " processes.");
+  workerThread_ = std::thread(&ProcessGroupHierarchical::runLoop, this);
+}
+
+ProcessGroupHierarchical::~ProcessGroupHierarchical() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queueProduceCV_.notify_all();
+  workerThread_.join();
+}
+
+void ProcessGroupHierarchical::WorkHierarchical::run() {
+  try {
+    run_();
+  } catch (...) {
+    finish(std::current_exception());
+    return;
+  }
+  finish();
+}
+
+void ProcessGroupHierarchical::runLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Allreduces queued before destruction are still run.
+  while (!stop_ || !queue_.empty()) {
+    if (queue_.empty()) {
+      queueProduceCV_.wait(lock);
+      continue;
+    }
+    auto work = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    work->run();
+    lock.lock();
+  }
+}
+
+void ProcessGroupHierarchical::runAllreduce(
+    at::Tensor& tensor,
+    ReduceOp reduceOp) {
+  const auto localSize = intraNode_->getSize();
+  const auto numNodes = interNode_->getSize();
+  std::vector<at::Tensor> tensors = {tensor};
+
+  if (!useReduceScatter_ || localSize == 1) {
+    if (localSize > 1) {
+      ReduceOptions opts;
+      opts.reduceOp = reduceOp;
+      opts.rootRank = 0;
+      intraNode_->reduce(tensors, opts)->wait();
+    }
+    if (intraNode_->getRank() == 0 && numNodes > 1) {
+      AllreduceOptions opts;
+      opts.reduceOp = reduceOp;
+      interNode_->allreduce(tensors, opts)->wait();
+    }
+    if (localSize > 1) {
+      BroadcastOptions opts;
+      opts.rootRank = 0;
+      intraNode_->broadcast(tensors, opts)->wait();
+    }
+    return;
+  }
+
+  // Pad the tensor to a multiple of the number of processes on the node, so
+  // that every process gets a shard of the same size. The padding is never
+  // copied back, so its value doesn't matter for any reduction.
+  const auto numel = tensor.numel();
+  const auto shardNumel = (numel + localSize - 1) / localSize;
+  at::Tensor padded = tensor;
+  if (shardNumel * localSize != numel) {
+    padded = at::zeros({shardNumel * localSize}, tensor.options());
+    padded.narrow(0, 0, numel).copy_(tensor);
+  }
+  std::vector<std::vector<at::Tensor>> chunks = {padded.chunk(localSize)};
+  std::vector<at::Tensor> shard = {at::empty({shardNumel}, tensor.options())};
+
+  ReduceScatterOptions reduceScatterOpts;
+  reduceScatterOpts.reduceOp = reduceOp;
+  intraNode_->reduce_scatter(shard, chunks, reduceScatterOpts)->wait();
+  if (numNodes > 1) {
+    AllreduceOptions allreduceOpts;
+    allreduceOpts.reduceOp = reduceOp;
+    interNode_->allreduce(shard, allreduceOpts)->wait();
+  }
+  intraNode_->allgather(chunks, shard)->wait();
+
+  if (!padded.is_same(tensor)) {
+    tensor.copy_(padded.narrow(0, 0, numel));
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "ProcessGroupHierarchical only supports a single tensor per process.");
+  auto tensor = tensors[0];
+  TORCH_CHECK(
+      tensor.layout() == at::kStrided,
+      "ProcessGroupHierarchical only supports dense tensors.");
+  const auto reduceOp = opts.reduceOp;
+  auto work = std::make_shared<WorkHierarchical>([this, tensor, reduceOp]() {
+    auto flat = tensor.is_contiguous() ? tensor.view({-1})
+                                       : tensor.contiguous().view({-1});
+    runAllreduce(flat, reduceOp);
+    if (!tensor.is_contiguous()) {
+      tensor.copy_(flat.view(tensor.sizes()));
+    }
+  });
+
+  if (tensor.is_cuda()) {
+    work->run();
+  } else {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.push_back(work);
+    lock.unlock();
+    queueProduceCV_.notify_one();
+  }
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::
+    allreduce_coalesced(
+        std::vector<at::Tensor>& tensors,
+        const AllreduceCoalescedOptions& opts) {
+  TORCH_CHECK(tensors.size() > 0, "Expected at least one tensor.");
+  std::vector<at::Tensor> flatTensors;
+  flatTensors.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    TORCH_CHECK(
+        tensor.options().type_equal(tensors[0].options()) &&
+            tensor.device() == tensors[0].device(),
+        "allreduce_coalesced expects all tensors to have the same type and "
+        "device.");
+    flatTensors.push_back(tensor.reshape({-1}));
+  }
+  std::vector<at::Tensor> coalesced = {at::cat(flatTensors)};
+  auto work = allreduce(coalesced, opts);
+
+  // Unflatten the result once the allreduce has completed.
+  auto result = std::make_shared<WorkHierarchical>(
+      [work, coalesced, tensors]() mutable {
+        work->wait();
+        int64_t offset = 0;
+        for (auto& tensor : tensors) {
+          tensor.copy_(
+              coalesced[0].narrow(0, offset, tensor.numel()).view_as(tensor));
+          offset += tensor.numel();
+        }
+      });
+  if (tensors[0].is_cuda()) {
+    result->run();
+  } else {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.push_back(result);
+    lock.unlock();
+    queueProduceCV_.notify_one();
+  }
+  return result;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  return global_->broadcast(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  return global_->reduce(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const AllgatherOptions& opts) {
+  return global_->allgather(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather_base(
+    at::Tensor& outputBuffer,
+    at::Tensor& inputBuffer,
+    const AllgatherOptions& opts) {
+  return global_->allgather_base(outputBuffer, inputBuffer, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::
+    allgather_coalesced(
+        std::vector<std::vector<at::Tensor>>& outputTensorLists,
+        std::vector<at::Tensor>& inputTensors,
+        const AllgatherOptions& opts) {
+  return global_->allgather_coalesced(outputTensorLists, inputTensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::gather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const GatherOptions& opts) {
+  return global_->gather(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ScatterOptions& opts) {
+  return global_->scatter(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce_scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ReduceScatterOptions& opts) {
+  return global_->reduce_scatter(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& opts) {
+  return global_->alltoall_base(
+      outputTensor, inputTensor, outputSplitSizes, inputSplitSizes, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const AllToAllOptions& opts) {
+  return global_->alltoall(outputTensors, inputTensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  return global_->send(tensors, dstRank, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  return global_->recv(tensors, srcRank, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recvAnysource(
+    std::vector<at::Tensor>& tensors,
+    int tag) {
+  return global_->recvAnysource(tensors, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::barrier(
+    const BarrierOptions& opts) {
+  return global_->barrier(opts);
+}
+
+} // namespace c10d
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+// ProcessGroupHierarchical implements allreduce in two levels, for clusters
+// where the links between the processes on a node (e.g. NVLink) are much
+// faster than the network links between nodes.
+//
+// It is constructed with three process groups:
+//
+//   - `global`, spanning all processes. Every call except allreduce and
+//     allreduce_coalesced is forwarded to it.
+//   - `intraNode`, spanning the processes on this process' node. Every node
+//     must have the same number of processes.
+//   - `interNode`, spanning the processes on all nodes that have the same
+//     rank within their node as this process.
+//
+// With `useReduceScatter`, an allreduce is a reduce-scatter inside the node,
+// an allreduce of every shard across nodes (by the process holding it), and
+// an allgather inside the node. This way every byte crosses the network
+// once per node instead of once per process. Backends without
+// reduce_scatter (Gloo) use a reduce to the first process of the node, an
+// allreduce across the first processes of all nodes, and a broadcast inside
+// the node instead.
+//
+// The steps of an allreduce of CUDA tensors are chained on the streams of
+// the calling thread, so they don't block it. The steps of an allreduce of
+// CPU tensors run on a worker thread, one allreduce at a time and in the
+// order they were called.
+//
+// All functions of the class are expected to be called in the same order
+// across all processes in the process group. This is the only way that we
+// can guarantee to match up the same calls among all processes.
+//
+class ProcessGroupHierarchical final : public ProcessGroup {
+ public:
+  explicit ProcessGroupHierarchical(
+      int rank,
+      int size,
+      std::shared_ptr<ProcessGroup> global,
+      std::shared_ptr<ProcessGroup> intraNode,
+      std::shared_ptr<ProcessGroup> interNode,
+      bool useReduceScatter);
+
+  ~ProcessGroupHierarchical() override;
+
+  std::shared_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce_coalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceCoalescedOptions& opts =
+          AllreduceCoalescedOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather_base(
+      at::Tensor& outputBuffer,
+      at::Tensor& inputBuffer,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather_coalesced(
+      std::vector<std::vector<at::Tensor>>& outputTensorLists,
+      std::vector<at::Tensor>& inputTensors,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce_scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall_base(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> barrier(
+      const BarrierOptions& opts = BarrierOptions()) override;
+
+ protected:
+  class WorkHierarchical : public ProcessGroup::Work {
+   public:
+    explicit WorkHierarchical(std::function<void()> run)
+        : run_(std::move(run)) {}
+
+    // Runs all steps of the allreduce and marks the work as completed.
+    void run();
+
+   private:
+    std::function<void()> run_;
+  };
+
+  // Runs the steps of the allreduce of `tensor` (a flat, contiguous tensor),
+  // waiting for every step to complete before starting the next one.
+  void runAllreduce(at::Tensor& tensor, ReduceOp reduceOp);
+
+  void runLoop();
+
+  std::shared_ptr<ProcessGroup> global_;
+  std::shared_ptr<ProcessGroup> intraNode_;
+  std::shared_ptr<ProcessGroup> interNode_;
+  const bool useReduceScatter_;
+
+  // Allreduces of CPU tensors waiting for the worker thread.
+  std::deque<std::shared_ptr<WorkHierarchical>> queue_;
+  std::mutex mutex_;
+  std::condition_variable queueProduceCV_;
+  bool stop_;
+  std::thread workerThread_;
+};
+
+} // namespace c10d
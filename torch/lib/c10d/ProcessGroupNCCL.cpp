@@ -7,6 +7,7 @@
 #include <THC/THC.h>
 
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/record_function.h>
 #include <c10/cuda/CUDAGuard.h>
 
 #include <c10d/Utils.hpp>
@@ -129,6 +130,7 @@ std::string getNcclAbortedCommStoreKey(const std::string ncclIdStr) {
 } // namespace
 
 const int64_t ProcessGroupNCCL::kWatchdogThreadSleepMillis = 10000;
+const int64_t ProcessGroupNCCL::kWorkCleanupThreadSleepMillis = 1000;
 constexpr int64_t kWaitForAbortCommStoreKey = 1000;
 constexpr int64_t kSynchronizeBusyWaitMillis = 10;
 const int64_t ProcessGroupNCCL::kProcessGroupNCCLOpTimeoutMillis = 10 * 1000;
@@ -165,8 +167,9 @@ void ProcessGroupNCCL::WorkNCCL::checkAndSetException() {
   }
 
   auto exception_ptr = checkForNCCLErrors(ncclComms_);
-  std::unique_lock<std::mutex> lock(mutex_);
-  exception_ = exception_ptr;
+  if (exception_ptr) {
+    setException(exception_ptr);
+  }
 }
 
 // Helper that checks if the NCCL kernels are completed on the GPUs
@@ -189,6 +192,30 @@ bool ProcessGroupNCCL::WorkNCCL::finishedGPUExecutionInternal() const {
   return true;
 }
 
+bool ProcessGroupNCCL::WorkNCCL::timedOut() const {
+  auto currentTimepoint = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             currentTimepoint - workStartTime_) > opTimeout_;
+}
+
+void ProcessGroupNCCL::WorkNCCL::setException(
+    std::exception_ptr exception_ptr) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!exception_) {
+    exception_ = exception_ptr;
+  }
+}
+
+void ProcessGroupNCCL::WorkNCCL::abortNCCLComms() {
+  for (const auto& ncclComm : ncclComms_) {
+    ncclComm->ncclCommAbort();
+    const auto& storeKey = getNcclAbortedCommStoreKey(
+        buildNcclUniqueIdStr(ncclComm->getNcclId()));
+    store_->set(storeKey, {});
+    LOG(INFO) << "Wrote aborted communicator id to store: " << storeKey;
+  }
+}
+
 void ProcessGroupNCCL::WorkNCCL::checkAndThrowException() {
   // Set the appropriate exception if found.
   checkAndSetException();
@@ -211,9 +238,7 @@ void ProcessGroupNCCL::WorkNCCL::synchronize() {
   if (blockingWait_) {
     // Wait for the operation to complete.
     while (!isCompleted()) {
-      auto currentTimepoint = std::chrono::steady_clock::now();
-      if (std::chrono::duration_cast<std::chrono::milliseconds>(
-              currentTimepoint - workStartTime_) > opTimeout_) {
+      if (timedOut()) {
         // When operation times out due to some errors that are not
         // detected by nccl communicators, ncclCommWatchdog can not check this
         // time out error and thus can not abort ncclComms accordingly.
@@ -223,13 +248,7 @@ void ProcessGroupNCCL::WorkNCCL::synchronize() {
         // if throwing timed out excepiton without aborting nccl communicators
         // here, it was observed that CUDA GPU will have 100% utilization and
         // can not run new events successfully.
-        for (const auto& ncclComm : ncclComms_) {
-          ncclComm->ncclCommAbort();
-          const auto& storeKey = getNcclAbortedCommStoreKey(
-              buildNcclUniqueIdStr(ncclComm->getNcclId()));
-          store_->set(storeKey, {});
-          LOG(INFO) << "Wrote aborted communicator id to store: " << storeKey;
-        }
+        abortNCCLComms();
         throw std::runtime_error("Operation timed out!");
       }
       // Check for errors and throw appropriate exception.
@@ -238,6 +257,10 @@ void ProcessGroupNCCL::WorkNCCL::synchronize() {
           std::chrono::milliseconds(kSynchronizeBusyWaitMillis));
     }
     checkAndThrowException();
+  } else if (asyncErrorHandling_) {
+    // The work cleanup thread might already have aborted this work. If it
+    // hasn't, the error is raised by a later wait() or collective.
+    checkAndThrowException();
   }
 
   // Device synchronize only after we've completed timeout checks.
@@ -290,17 +313,58 @@ ProcessGroupNCCL::ProcessGroupNCCL(
         std::string(NCCL_BLOCKING_WAIT));
   }
 
+  char* asyncErrorHandling = getenv(NCCL_ASYNC_ERROR_HANDLING);
+  try {
+    if (asyncErrorHandling != nullptr) {
+      auto val = std::stoi(asyncErrorHandling);
+      if (val == 1) {
+        // Abort failed and timed out works in the background.
+        asyncErrorHandling_ = true;
+      } else if (val != 0) {
+        throw std::runtime_error(
+            "Invalid value for environment variable: " +
+            std::string(NCCL_ASYNC_ERROR_HANDLING));
+      }
+    }
+  } catch (std::exception& e) {
+    throw std::runtime_error(
+        "Invalid value for environment variable: " +
+        std::string(NCCL_ASYNC_ERROR_HANDLING));
+  }
+
+  if (blockingWait_ && asyncErrorHandling_) {
+    throw std::runtime_error(
+        std::string(NCCL_BLOCKING_WAIT) + " and " +
+        std::string(NCCL_ASYNC_ERROR_HANDLING) +
+        " cannot be enabled at the same time.");
+  }
+
 #ifdef ENABLE_NCCL_ERROR_CHECKING
   ncclCommWatchdogThread_ =
       std::thread(&ProcessGroupNCCL::ncclCommWatchdog, this);
+  if (asyncErrorHandling_) {
+    workCleanupThread_ = std::thread(&ProcessGroupNCCL::workCleanupLoop, this);
+  }
+#else
+  if (asyncErrorHandling_) {
+    // Communicators can't be aborted without NCCL error checking.
+    LOG(WARNING) << NCCL_ASYNC_ERROR_HANDLING
+                 << " is ignored since NCCL 2.4+ is required to abort "
+                 << "NCCL communicators";
+    asyncErrorHandling_ = false;
+  }
 #endif
 }
 
 ProcessGroupNCCL::~ProcessGroupNCCL() {
   terminateWatchdog_.store(true);
   watchdogCV_.notify_one();
+  workListCV_.notify_one();
 #ifdef ENABLE_NCCL_ERROR_CHECKING
   ncclCommWatchdogThread_.join();
+  if (workCleanupThread_.joinable()) {
+    workCleanupThread_.join();
+  }
 #endif
 }
 
@@ -334,12 +398,14 @@ void ProcessGroupNCCL::ncclCommWatchdogInternal() {
         if (checkForNCCLErrors(ncclComms)) {
           LOG(INFO) << "Received NCCL errors for communicators in the cache";
 
-          if (blockingWait_) {
+          if (blockingWait_ || asyncErrorHandling_) {
             LOG(INFO) << "Aborting communicators that received errors";
             // We should not abort the communicators if we are performing a
-            // non-blocking wait(). The reason for this is that if we abort the
-            // nccl communicator, wait() might not throw exceptions and
-            // subsequent operations might run on garbage results.
+            // non-blocking wait() without async error handling. The reason for
+            // this is that if we abort the nccl communicator, wait() might not
+            // throw exceptions and subsequent operations might run on garbage
+            // results. With async error handling, the work cleanup thread
+            // records the error on every outstanding work instead.
             // The current model is that when we call wait(), subsequent
             // operations only run after this work is done or we hang forever
             // waiting for the operation to complete.
@@ -362,7 +428,7 @@ void ProcessGroupNCCL::ncclCommWatchdogInternal() {
       }
     }
 
-    if (blockingWait_) {
+    if (blockingWait_ || asyncErrorHandling_) {
       // When we abort a communicator on one rank, it is likely that might cause
       // other ranks to hang indefinitely. As a result, whenever we abort a
       // communicator, we write its ID to the store. The watchdog on other ranks
@@ -416,6 +482,60 @@ void ProcessGroupNCCL::ncclCommWatchdogInternal() {
   }
 }
 
+void ProcessGroupNCCL::workCleanupLoop() {
+  while (!terminateWatchdog_.load()) {
+    std::list<std::shared_ptr<WorkNCCL>> failedWorks;
+
+    {
+      std::unique_lock<std::mutex> lock(workListMutex_);
+      workListCV_.wait_for(
+          lock,
+          std::chrono::milliseconds(kWorkCleanupThreadSleepMillis),
+          [&]() -> bool { return terminateWatchdog_.load(); });
+
+      for (auto it = workList_.begin(); it != workList_.end();) {
+        auto& work = *it;
+        try {
+          if (work->isCompleted()) {
+            if (work->exception()) {
+              failedWorks.push_back(work);
+            }
+            it = workList_.erase(it);
+            continue;
+          }
+          if (work->timedOut()) {
+            work->setException(std::make_exception_ptr(std::runtime_error(
+                "NCCL operation timed out after " +
+                std::to_string(opTimeout_.count()) +
+                " ms, its communicators were aborted.")));
+            failedWorks.push_back(work);
+            it = workList_.erase(it);
+            continue;
+          }
+        } catch (...) {
+          work->setException(std::current_exception());
+          failedWorks.push_back(work);
+          it = workList_.erase(it);
+          continue;
+        }
+        ++it;
+      }
+    }
+
+    // Abort outside of workListMutex_ so that collectives can be enqueued in
+    // the meantime. Aborting makes the pending NCCL kernels of the work (and
+    // of any later work on the same communicators) return.
+    for (const auto& work : failedWorks) {
+      LOG(ERROR) << "Aborting communicators of a failed NCCL work";
+      try {
+        work->abortNCCLComms();
+      } catch (std::exception& e) {
+        LOG(ERROR) << "Failed to abort NCCL communicators: " << e.what();
+      }
+    }
+  }
+}
+
 std::exception_ptr ProcessGroupNCCL::WorkNCCL::checkForNCCLErrors(
     const std::vector<std::shared_ptr<NCCLComm>>& ncclComms) const {
   return checkForNCCLErrorsInternal(ncclComms);
@@ -633,7 +753,19 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     std::vector<at::Tensor>& outputs,
     Fn fn,
     PreProcess pre,
-    PostProcess post) {
+    PostProcess post,
+    const char* profilingTitle) {
+  // The sequence number is consumed even when the collective isn't profiled,
+  // so that the numbers match across ranks.
+  const auto seq = nextSequenceNumber();
+  // Covers the enqueue of the collective. With the CUPTI profiler the NCCL
+  // kernels are correlated to this range, which gives their execution time.
+  RECORD_FUNCTION_WITH_SCOPE(
+      at::RecordScope::USER_SCOPE,
+      profilingTitle,
+      std::vector<c10::IValue>(inputs.begin(), inputs.end()),
+      seq);
+
   const auto devices = getDeviceList(inputs);
   const auto key = getKeyFromDevices(devices);
   auto& ncclComms = getNCCLComm(key, devices);
@@ -682,10 +814,16 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     work->cudaEvents_[i].record(ncclStream);
     work->ncclComms_[i] = ncclComms[i];
     work->blockingWait_ = blockingWait_;
+    work->asyncErrorHandling_ = asyncErrorHandling_;
     work->opTimeout_ = opTimeout_;
     work->store_ = store_;
   }
 
+  if (asyncErrorHandling_) {
+    std::lock_guard<std::mutex> lock(workListMutex_);
+    workList_.push_back(work);
+  }
+
   return work;
 }
 
@@ -693,13 +831,15 @@ template <typename Fn>
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     std::vector<at::Tensor>& inputs,
     std::vector<at::Tensor>& outputs,
-    Fn fn) {
+    Fn fn,
+    const char* profilingTitle) {
   return collective(
       inputs,
       outputs,
       fn,
       [](std::vector<at::cuda::CUDAStream>&) {},
-      [](std::vector<at::cuda::CUDAStream>&) {});
+      [](std::vector<at::cuda::CUDAStream>&) {},
+      profilingTitle);
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
@@ -722,7 +862,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
             ncclOp[opts.reduceOp],
             comm,
             stream.stream());
-      });
+      },
+      "nccl:all_reduce");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce_coalesced(
@@ -752,7 +893,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
             root,
             comm,
             stream.stream());
-      });
+      },
+      "nccl:broadcast");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
@@ -777,7 +919,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
             root,
             comm,
             stream.stream());
-      });
+      },
+      "nccl:reduce");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
@@ -820,7 +963,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
             outputTensors[i][j].copy_(outputFlattened[i][j], true);
           }
         }
-      });
+      },
+      "nccl:all_gather");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather_coalesced(
@@ -872,7 +1016,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce_scatter(
           }
         }
       },
-      [&](std::vector<at::cuda::CUDAStream>& ncclStreams) {});
+      [&](std::vector<at::cuda::CUDAStream>& ncclStreams) {},
+      "nccl:reduce_scatter");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::barrier(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <list>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -17,6 +18,10 @@ namespace c10d {
 // non-blocking.
 constexpr const char* NCCL_BLOCKING_WAIT = "NCCL_BLOCKING_WAIT";
 
+// Environment variable which controls whether or not collectives that exceed
+// the timeout are aborted in the background while wait() is non-blocking.
+constexpr const char* NCCL_ASYNC_ERROR_HANDLING = "NCCL_ASYNC_ERROR_HANDLING";
+
 // ProcessGroupNCCL implements NCCL bindings for c10d.
 //
 // All functions of the class are expected to be called in the same order
@@ -52,6 +57,16 @@ constexpr const char* NCCL_BLOCKING_WAIT = "NCCL_BLOCKING_WAIT";
 //   work->wait()
 //
 //   // Now continue on other work in the current stream.
+//
+// Since wait() only blocks the current stream, a collective that never
+// completes (e.g. because another rank died) hangs the GPU rather than the
+// calling thread. If NCCL_ASYNC_ERROR_HANDLING is set to 1, the process group
+// keeps track of all outstanding works and a background thread aborts the
+// NCCL communicators of any work that hits an NCCL error or runs longer than
+// the timeout of the process group. The pending NCCL kernels then return, the
+// failed work stores the error, and wait(), isCompleted() and any further
+// collective on the aborted communicators raise it. The process group has to
+// be destroyed and recreated to recover.
 class ProcessGroupNCCL : public ProcessGroup {
  public:
   class WorkNCCL : public ProcessGroup::Work {
@@ -97,6 +112,9 @@ class ProcessGroupNCCL : public ProcessGroup {
     // Clone of blockingWait_ from ProcessGroupNCCL.
     bool blockingWait_ = false;
 
+    // Clone of asyncErrorHandling_ from ProcessGroupNCCL.
+    bool asyncErrorHandling_ = false;
+
     // Clone of opTimeout_ from ProcessGroupNCCL.
     std::chrono::milliseconds opTimeout_;
 
@@ -119,6 +137,16 @@ class ProcessGroupNCCL : public ProcessGroup {
     // exception_ptr.
     bool finishedGPUExecutionInternal() const;
 
+    // Checks whether the work has been running for longer than opTimeout_.
+    bool timedOut() const;
+
+    // Sets the exception_ptr, unless the work already has one.
+    void setException(std::exception_ptr exception_ptr);
+
+    // Aborts the NCCL communicators used by this work and writes their ids to
+    // the store, so that the watchdog on the other ranks aborts them as well.
+    void abortNCCLComms();
+
     // Reference to the store so that we can write aborted communicators
     // to the store.
     std::shared_ptr<Store> store_;
@@ -252,18 +280,24 @@ class ProcessGroupNCCL : public ProcessGroup {
   //    ncclResult_t fn(at::Tensor& input, at::Tensor& output,
   //                    ncclComm_t, at::cuda::CUDAStream&);
   //    void {pre,post}(std::vector<at::cuda::CUDAStream&>);
+  //
+  // The enqueue of the collective is recorded as a RecordFunction range
+  // named profilingTitle, with the inputs and the sequence number of the
+  // collective.
   template <typename Fn>
   std::shared_ptr<ProcessGroup::Work> collective(
       std::vector<at::Tensor>& input,
       std::vector<at::Tensor>& output,
-      Fn fn);
+      Fn fn,
+      const char* profilingTitle);
   template <typename Fn, typename PreProcess, typename PostProcess>
   std::shared_ptr<ProcessGroup::Work> collective(
       std::vector<at::Tensor>& input,
       std::vector<at::Tensor>& output,
       Fn fn,
       PreProcess pre,
-      PostProcess post);
+      PostProcess post,
+      const char* profilingTitle);
 
   // Checks for NCCL errors on each of the communicators and returns an
   // appropriate exception_ptr (nullptr if no errors).
@@ -283,8 +317,15 @@ class ProcessGroupNCCL : public ProcessGroup {
 
   void ncclCommWatchdogInternal();
 
+  // Function that runs as part of a separate thread if asyncErrorHandling_ is
+  // enabled. It removes completed works from workList_, and aborts the
+  // communicators of works that failed or timed out, since there is no
+  // guarantee that the user ever calls wait() on them.
+  void workCleanupLoop();
+
  protected:
   static const int64_t kWatchdogThreadSleepMillis;
+  static const int64_t kWorkCleanupThreadSleepMillis;
 
   // The store is used to broadcast the NCCL unique ID of rank 0.
   std::shared_ptr<Store> store_;
@@ -335,6 +376,20 @@ class ProcessGroupNCCL : public ProcessGroup {
   // Mutex for watchdog.
   std::mutex watchdogCVMutex_;
 
+  // Thread which cleans up workList_, only used if asyncErrorHandling_ is
+  // enabled.
+  std::thread workCleanupThread_;
+
+  // Works that have been enqueued but not yet seen completed by the work
+  // cleanup thread, only used if asyncErrorHandling_ is enabled.
+  std::list<std::shared_ptr<WorkNCCL>> workList_;
+
+  // Mutex to guard workList_.
+  std::mutex workListMutex_;
+
+  // Condition variable to control how long the work cleanup thread waits.
+  std::condition_variable workListCV_;
+
   // The CUDA steams used by NCCL kernels
   std::unordered_map<std::string, std::vector<at::cuda::CUDAStream>>
       ncclStreams_;
@@ -369,7 +424,12 @@ class ProcessGroupNCCL : public ProcessGroup {
   // for the operation to complete.
   bool blockingWait_ = false;
 
-  // Timeout for operations. This is only used when blockingWait_ is enabled.
+  // Whether or not failed and timed out works are aborted in the background
+  // while wait() and synchronize() are non-blocking.
+  bool asyncErrorHandling_ = false;
+
+  // Timeout for operations. This is only used when blockingWait_ or
+  // asyncErrorHandling_ is enabled.
   std::chrono::milliseconds opTimeout_;
 
   // Set of communicators that this process group has aborted and their
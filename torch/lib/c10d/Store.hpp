@@ -38,6 +38,28 @@ class Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) = 0;
 
+  // Sets several keys at once. The default implementation calls set() for
+  // every key, stores that talk to a server override it to send all keys in
+  // a single request.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  // Waits for and gets several keys at once. The default implementation calls
+  // get() for every key.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // Atomically sets `key` to `desiredValue` if its current value is
+  // `expectedValue`, or if it doesn't exist and `expectedValue` is empty.
+  // Returns the value of `key` after the operation, which is empty if the key
+  // doesn't exist. Doesn't wait for the key. Stores that can't implement it
+  // atomically throw.
+  virtual std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue);
+
   void setTimeout(const std::chrono::milliseconds& timeout);
 
  protected:
@@ -1,6 +1,9 @@
 #include <c10d/TCPStore.hpp>
 
 #include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #include <unistd.h>
 #include <algorithm>
@@ -10,12 +13,26 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_SET,
+  MULTI_GET,
+  COMPARE_SET
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+#ifdef __linux__
+// Maximum number of events returned by a single epoll_wait call.
+constexpr int kMaxEpollEvents = 256;
+#endif
+
 } // anonymous namespace
 
 // TCPStoreDaemon class methods
@@ -54,6 +71,82 @@ void TCPStoreDaemon::join() {
   daemonThread_.join();
 }
 
+#ifdef __linux__
+// With thousands of workers, poll(2) has to scan the state of every socket
+// for every request, so on Linux epoll(7) is used to only get the sockets that
+// have an event.
+void TCPStoreDaemon::run() {
+  int epollFd;
+  SYSCHECK_ERR_RETURN_NEG1(epollFd = ::epoll_create1(EPOLL_CLOEXEC));
+  ResourceGuard epollGuard([epollFd]() { ::close(epollFd); });
+  auto addFd = [epollFd](int fd, uint32_t events) {
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    SYSCHECK_ERR_RETURN_NEG1(::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event));
+  };
+  addFd(storeListenSocket_, EPOLLIN);
+  // Add the read end of the pipe to signal the stopping of the daemon run.
+  // EPOLLHUP is always reported, it doesn't need to be requested.
+  addFd(controlPipeFd_[0], 0);
+
+  std::vector<struct epoll_event> events(kMaxEpollEvents);
+
+  // receive the queries
+  bool finished = false;
+  while (!finished) {
+    int numEvents;
+    SYSCHECK_ERR_RETURN_NEG1(
+        numEvents =
+            ::epoll_wait(epollFd, events.data(), events.size(), -1));
+
+    for (int i = 0; i < numEvents; i++) {
+      const int fd = events[i].data.fd;
+      const uint32_t revents = events[i].events;
+
+      // TCPStore's listening socket has an event and it should now be able
+      // to accept new connections.
+      if (fd == storeListenSocket_) {
+        if (revents ^ EPOLLIN) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected epoll event on the master's listening socket: " +
+                  std::to_string(revents));
+        }
+        int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
+        sockets_.push_back(sockFd);
+        addFd(sockFd, EPOLLIN);
+        continue;
+      }
+
+      // The pipe receives an event which tells us to shutdown the daemon
+      if (fd == controlPipeFd_[0]) {
+        // Will be EPOLLHUP when the pipe is closed
+        if (revents ^ EPOLLHUP) {
+          throw std::system_error(
+              ECONNABORTED,
+              std::system_category(),
+              "Unexpected epoll event on the control pipe's reading fd: " +
+                  std::to_string(revents));
+        }
+        finished = true;
+        break;
+      }
+
+      // Now query the socket that has the event. A socket that was closed by
+      // the other side is readable, and the query fails on it.
+      try {
+        query(fd);
+      } catch (...) {
+        // See the comment in the poll(2) based loop below. Closing the socket
+        // also removes it from the epoll set.
+        closeSocket(fd);
+      }
+    }
+  }
+}
+#else
 void TCPStoreDaemon::run() {
   std::vector<struct pollfd> fds;
   fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
@@ -63,8 +156,8 @@ void TCPStoreDaemon::run() {
   // receive the queries
   bool finished = false;
   while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
+    for (auto& fd : fds) {
+      fd.revents = 0;
     }
 
     SYSCHECK_ERR_RETURN_NEG1(::poll(fds.data(), fds.size(), -1));
@@ -115,38 +208,38 @@ void TCPStoreDaemon::run() {
         // exception, other connections will get an exception once they try to
         // use the store. We will go ahead and close this connection whenever
         // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
-        }
+        closeSocket(fds[fdIdx].fd);
         fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
         --fdIdx;
         continue;
       }
     }
   }
 }
+#endif
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  ::close(socket);
+
+  // Remove all the tracking state of the close FD
+  for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
+    for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
+      if (*vecIt == socket) {
+        vecIt = it->second.erase(vecIt);
+      } else {
+        ++vecIt;
+      }
+    }
+    if (it->second.size() == 0) {
+      it = waitingSockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  keysAwaited_.erase(socket);
+  sockets_.erase(std::remove(sockets_.begin(), sockets_.end(), socket),
+                 sockets_.end());
+}
 
 void TCPStoreDaemon::stop() {
   if (controlPipeFd_[1] != -1) {
@@ -159,7 +252,7 @@ void TCPStoreDaemon::stop() {
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of wait, check, multi set and multi get
 // type of query | number of args | size of arg1 | arg1 | ...
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
@@ -180,6 +273,15 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::COMPARE_SET) {
+    compareSetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
@@ -254,11 +356,59 @@ void TCPStoreDaemon::waitHandler(int socket) {
     tcputil::sendValue<WaitResponseType>(
         socket, WaitResponseType::STOP_WAITING);
   } else {
+    // Only wait for the keys that don't exist yet, the others might never be
+    // set again and would keep the client waiting forever.
+    size_t numKeysToAwait = 0;
     for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+      if (tcpStore_.count(key) == 0) {
+        waitingSockets_[key].push_back(socket);
+        numKeysToAwait++;
+      }
     }
-    keysAwaited_[socket] = keys.size();
+    keysAwaited_[socket] = numKeysToAwait;
+  }
+}
+
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+    wakeupWaitingClients(key);
+  }
+}
+
+void TCPStoreDaemon::multiGetHandler(int socket) const {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  for (size_t i = 0; i < nargs; i++) {
+    const auto& data = tcpStore_.at(keys[i]);
+    tcputil::sendVector<uint8_t>(socket, data, (i != (nargs - 1)));
+  }
+}
+
+void TCPStoreDaemon::compareSetHandler(int socket) {
+  std::string key = tcputil::recvString(socket);
+  auto expectedValue = tcputil::recvVector<uint8_t>(socket);
+  auto desiredValue = tcputil::recvVector<uint8_t>(socket);
+
+  auto it = tcpStore_.find(key);
+  if ((it == tcpStore_.end() && !expectedValue.empty()) ||
+      (it != tcpStore_.end() && it->second != expectedValue)) {
+    // The value doesn't match, send back the current one.
+    tcputil::sendVector<uint8_t>(
+        socket,
+        it == tcpStore_.end() ? std::vector<uint8_t>() : it->second);
+    return;
   }
+  tcpStore_[key] = desiredValue;
+  tcputil::sendVector<uint8_t>(socket, desiredValue);
+  wakeupWaitingClients(key);
 }
 
 bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) const {
@@ -423,6 +573,61 @@ void TCPStore::waitHelper_(
   }
 }
 
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects the same number of keys and values");
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    std::string regKey = regularPrefix_ + keys[i];
+    tcputil::sendString(storeSocket_, regKey, true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], (i != (nkeys - 1)));
+  }
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  if (keys.empty()) {
+    return {};
+  }
+  std::vector<std::string> regKeys;
+  regKeys.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    regKeys[i] = regularPrefix_ + keys[i];
+  }
+  waitHelper_(regKeys, timeout_);
+
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET);
+  SizeType nkeys = regKeys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, regKeys[i], (i != (nkeys - 1)));
+  }
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(nkeys);
+  for (size_t i = 0; i < nkeys; i++) {
+    values.push_back(tcputil::recvVector<uint8_t>(storeSocket_));
+  }
+  return values;
+}
+
+std::vector<uint8_t> TCPStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  std::string regKey = regularPrefix_ + key;
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::COMPARE_SET);
+  tcputil::sendString(storeSocket_, regKey, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, expectedValue, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, desiredValue);
+  return tcputil::recvVector<uint8_t>(storeSocket_);
+}
+
 PortType TCPStore::getPort() {
   return tcpStorePort_;
 }
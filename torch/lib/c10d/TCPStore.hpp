@@ -22,11 +22,17 @@ class TCPStoreDaemon {
 
   void query(int socket);
 
+  // Closes a client socket and removes all the tracking state of it.
+  void closeSocket(int socket);
+
   void setHandler(int socket);
   void addHandler(int socket);
   void getHandler(int socket) const;
   void checkHandler(int socket) const;
   void waitHandler(int socket);
+  void multiSetHandler(int socket);
+  void multiGetHandler(int socket) const;
+  void compareSetHandler(int socket);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
@@ -69,6 +75,20 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  // Sends all keys and values in a single request.
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  // Waits for all keys in a single request, and gets them in another one.
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue) override;
+
   // Waits for all workers to join.
   void waitForWorkers();
 
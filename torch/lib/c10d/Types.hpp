@@ -29,7 +29,12 @@ struct AllreduceOptions {
   std::chrono::milliseconds timeout = kUnsetTimeout;
 };
 
-struct AllreduceCoalescedOptions : AllreduceOptions {};
+struct AllreduceCoalescedOptions : AllreduceOptions {
+  // Sparse tensors whose entries gathered from all ranks number at least this
+  // many times their number of rows are allreduced as dense tensors, if
+  // positive. Only used by ProcessGroupGloo.
+  double sparseDensityThreshold = 0;
+};
 
 struct ReduceOptions {
   ReduceOp reduceOp = ReduceOp::SUM;
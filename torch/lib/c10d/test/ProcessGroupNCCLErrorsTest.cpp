@@ -1,4 +1,5 @@
 #include <chrono>
+#include <thread>
 
 #include <c10d/FileStore.hpp>
 #include <c10d/ProcessGroupNCCL.hpp>
@@ -54,6 +55,11 @@ class ProcessGroupNCCLSimulateErrors : public c10d::ProcessGroupNCCL {
         ProcessGroupNCCLSimulateErrors::kWatchdogThreadSleepMillis);
   }
 
+  std::chrono::duration<int64_t, std::milli> getWorkCleanupSleepInterval() {
+    return std::chrono::milliseconds(
+        ProcessGroupNCCLSimulateErrors::kWorkCleanupThreadSleepMillis);
+  }
+
   std::shared_ptr<ProcessGroupNCCL::WorkNCCL> initWork(
       std::vector<at::Device> devices) override {
     return std::make_shared<WorkNCCLSimulateErrors>(devices, simulate_error_);
@@ -152,6 +158,7 @@ class ProcessGroupNCCLErrorsTest : public ::testing::Test {
 
   void TearDown() override {
     ASSERT_TRUE(setenv(c10d::NCCL_BLOCKING_WAIT, "0", 1) == 0);
+    ASSERT_TRUE(setenv(c10d::NCCL_ASYNC_ERROR_HANDLING, "0", 1) == 0);
   }
 
   std::vector<at::Tensor> tensors_;
@@ -246,3 +253,67 @@ TEST_F(ProcessGroupNCCLErrorsTest, testNCCLErrorsNonBlocking) {
 
   // Communicators might be aborted here, further operations would fail.
 }
+
+TEST_F(ProcessGroupNCCLErrorsTest, testNCCLErrorsAsync) {
+  bool skip;
+  std::string skipReason;
+  std::tie(skip, skipReason) = skipTest();
+  if (skip) {
+    LOG(INFO) << skipReason;
+    return;
+  }
+
+  ASSERT_TRUE(setenv(c10d::NCCL_ASYNC_ERROR_HANDLING, "1", 1) == 0);
+  ProcessGroupNCCLSimulateErrors pg(
+      store_, 0, 1, std::chrono::milliseconds(3000));
+
+  auto work = pg.allreduce(tensors_);
+  work->wait();
+  EXPECT_TRUE(work->isSuccess());
+  EXPECT_EQ(1, pg.getNCCLCommCacheSize());
+
+  // Now run all reduce with errors.
+  pg.simulate_error();
+  work = pg.allreduce(tensors_);
+  EXPECT_THROW(work->wait(), std::runtime_error);
+  EXPECT_TRUE(work->isCompleted());
+  EXPECT_FALSE(work->isSuccess());
+
+  // The work cleanup thread aborts the communicators of the failed work.
+  pg.reset_error();
+  std::this_thread::sleep_for(2 * pg.getWorkCleanupSleepInterval());
+  EXPECT_THROW(pg.allreduce(tensors_), std::runtime_error);
+}
+
+TEST_F(ProcessGroupNCCLErrorsTest, testNCCLTimedoutErrorsAsync) {
+  bool skip;
+  std::string skipReason;
+  std::tie(skip, skipReason) = skipTest();
+  if (skip) {
+    LOG(INFO) << skipReason;
+    return;
+  }
+
+  ASSERT_TRUE(setenv(c10d::NCCL_ASYNC_ERROR_HANDLING, "1", 1) == 0);
+  const auto timeout = std::chrono::milliseconds(3000);
+  ProcessGroupNCCLTimedOutErrors pg(store_, 0, 1, timeout);
+
+  auto work = pg.allreduce(tensors_);
+  work->wait();
+  EXPECT_TRUE(work->isSuccess());
+  EXPECT_EQ(1, pg.getNCCLCommCacheSize());
+
+  // Now run all reduce with errors. wait() is non-blocking, so the timeout is
+  // only detected by the work cleanup thread.
+  pg.set_timedout_error();
+  work = pg.allreduce(tensors_);
+  work->wait();
+
+  std::this_thread::sleep_for(timeout + 2 * pg.getWorkCleanupSleepInterval());
+  EXPECT_THROW(work->wait(), std::runtime_error);
+  EXPECT_FALSE(work->isSuccess());
+
+  // The communicators were aborted, further operations fail.
+  pg.reset_timedout_error();
+  EXPECT_THROW(pg.allreduce(tensors_), std::runtime_error);
+}
@@ -116,3 +116,70 @@ TEST(TCPStoreTest, testHelper) {
 TEST(TCPStoreTest, testHelperPrefix) {
   testHelper("testPrefix");
 }
+
+TEST(TCPStoreTest, testMultiGetSetCompareSet) {
+  const auto numThreads = 16;
+  const auto numWorkers = numThreads + 1;
+
+  auto serverStore = std::make_shared<c10d::TCPStore>(
+      "127.0.0.1",
+      0,
+      numWorkers,
+      true,
+      std::chrono::seconds(30),
+      /* wait */ false);
+
+  std::vector<std::string> keys;
+  for (auto i = 0; i < numThreads; i++) {
+    keys.push_back("key_" + std::to_string(i));
+  }
+
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < numThreads; i++) {
+    threads.push_back(std::thread([&serverStore, &keys, numWorkers, i] {
+      c10d::TCPStore clientStore(
+          "127.0.0.1", serverStore->getPort(), numWorkers, false);
+      std::string value = "value_" + std::to_string(i);
+      clientStore.multiSet(
+          {keys[i]}, {std::vector<uint8_t>(value.begin(), value.end())});
+
+      // Waits for the keys of all threads, some of which already exist.
+      auto values = clientStore.multiGet(keys);
+      EXPECT_EQ(keys.size(), values.size());
+      for (auto j = 0; j < numThreads; j++) {
+        EXPECT_EQ(
+            "value_" + std::to_string(j),
+            std::string(values[j].begin(), values[j].end()));
+      }
+
+      // Only one thread can set the key from missing to its value.
+      clientStore.compareSet(
+          "leader", {}, std::vector<uint8_t>(value.begin(), value.end()));
+      clientStore.add("done", 1);
+    }));
+  }
+
+  serverStore->waitForWorkers();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  c10d::test::check(*serverStore, "done", std::to_string(numThreads));
+
+  auto leader = serverStore->get("leader");
+  std::string expected(leader.begin(), leader.end());
+  EXPECT_EQ(0, expected.find("value_"));
+
+  // A mismatching compareSet returns the current value and doesn't set it.
+  std::string other = "other";
+  auto current = serverStore->compareSet(
+      "leader",
+      std::vector<uint8_t>(other.begin(), other.end()),
+      std::vector<uint8_t>(other.begin(), other.end()));
+  EXPECT_EQ(leader, current);
+  c10d::test::check(*serverStore, "leader", expected);
+
+  current = serverStore->compareSet(
+      "leader", leader, std::vector<uint8_t>(other.begin(), other.end()));
+  EXPECT_EQ(other, std::string(current.begin(), current.end()));
+  c10d::test::check(*serverStore, "leader", other);
+}
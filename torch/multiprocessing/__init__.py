@@ -16,10 +16,11 @@ contents, and we recommend referring to very good docs of the original module.
 import torch
 import sys
 from .reductions import init_reductions
+from .arena import SharedMemoryArena
 import multiprocessing
 
 __all__ = ['set_sharing_strategy', 'get_sharing_strategy',
-           'get_all_sharing_strategies']
+           'get_all_sharing_strategies', 'SharedMemoryArena']
 
 
 from multiprocessing import *
@@ -0,0 +1,107 @@
+import threading
+from functools import reduce
+from operator import mul
+
+import torch
+
+
+# Offsets of the tensors in a segment are aligned to this many bytes.
+_ALIGNMENT = 64
+
+# Mapping from the data pointers of the live segments of all arenas to their
+# storages, see _segment_storage().
+_segments = {}
+_segments_lock = threading.Lock()
+
+
+def _segment_storage(storage):
+    # Returns the storage object of the arena segment ``storage`` is in, or
+    # ``storage`` itself. All tensors of a segment are then reduced from the
+    # same storage object, which the pickler memoizes, so that a message holding
+    # many tensors of a segment only carries its handle once.
+    segment = _segments.get(storage.data_ptr())
+    return storage if segment is None else segment
+
+
+class SharedMemoryArena(object):
+    r"""Sub-allocates CPU tensors from large shared memory segments.
+
+    Every tensor moved to shared memory normally gets its own shared memory
+    segment, which costs a ``shm_open``, ``ftruncate`` and ``mmap`` in the
+    sender, and a file descriptor and a ``mmap`` in every receiver. A process
+    sending many small tensors, like a :class:`~torch.utils.data.DataLoader`
+    worker, can instead create them with :meth:`empty`, which places them one
+    after the other in a segment per data type. Receivers map every segment
+    once, and a message holding several tensors of a segment only carries its
+    handle once.
+
+    Segments aren't reused: once a tensor doesn't fit in the current segment
+    of its data type, a new segment is created, and the memory of the old one
+    is released, through the same reference counting as any other shared
+    storage, when all tensors in it are freed in all processes. Tensors larger
+    than a quarter of ``segment_size`` get a segment of their own.
+
+    Arguments:
+        segment_size (int): size of the segments in bytes. Default: 16 MiB.
+    """
+
+    def __init__(self, segment_size=16 * 1024 * 1024):
+        if segment_size <= 0:
+            raise ValueError("segment_size must be positive, but got {}".format(segment_size))
+        self.segment_size = segment_size
+        # Mapping from dtypes to (storage, number of elements used)
+        self._current = {}
+        self._lock = threading.Lock()
+
+    def _retire(self, dtype):
+        segment = self._current.pop(dtype, None)
+        if segment is not None:
+            with _segments_lock:
+                del _segments[segment[0].data_ptr()]
+
+    def empty(self, size, dtype=torch.float):
+        r"""Returns an uninitialized contiguous tensor in shared memory.
+
+        Arguments:
+            size (torch.Size or list of int): the size of the tensor.
+            dtype (:class:`torch.dtype`): the data type of the tensor.
+        """
+        size = torch.Size(size)
+        numel = reduce(mul, size, 1)
+        result = torch.empty(0, dtype=dtype)
+        storage_cls = type(result.storage())
+        element_size = result.element_size()
+        if numel * element_size > self.segment_size // 4:
+            return result.set_(storage_cls._new_shared(numel), 0, size)
+
+        align = max(1, _ALIGNMENT // element_size)
+        with self._lock:
+            storage, used = self._current.get(dtype, (None, 0))
+            offset = (used + align - 1) // align * align
+            if storage is None or offset + numel > storage.size():
+                self._retire(dtype)
+                storage = storage_cls._new_shared(self.segment_size // element_size)
+                with _segments_lock:
+                    _segments[storage.data_ptr()] = storage
+                offset = 0
+            self._current[dtype] = (storage, offset + numel)
+        return result.set_(storage, offset, size)
+
+    def share_(self, tensor):
+        r"""Returns a copy of a CPU tensor in shared memory allocated with
+        :meth:`empty`, or the tensor itself if it is already shared."""
+        if tensor.is_cuda or tensor.is_shared():
+            return tensor
+        result = self.empty(tensor.size(), tensor.dtype)
+        result.copy_(tensor)
+        return result
+
+    def close(self):
+        r"""Releases the current segments of the arena. Tensors allocated from
+        them stay valid."""
+        with self._lock:
+            for dtype in list(self._current):
+                self._retire(dtype)
+
+    def __del__(self):
+        self.close()
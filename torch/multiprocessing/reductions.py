@@ -6,6 +6,7 @@ import threading
 import multiprocessing
 from multiprocessing.util import register_after_fork
 from multiprocessing.reduction import ForkingPickler
+from .arena import _segment_storage
 try:
     # Early load resource_sharer to prevent a partially initialized instance
     # from being inherited in a forked child process. The reduce_storage method
@@ -260,7 +261,7 @@ def reduce_tensor(tensor):
 
     # _backward_hooks purposely omitted here, see Note [Don't serialize hooks]
     metadata = (tensor.storage_offset(), tensor.size(), tensor.stride(), tensor.requires_grad)
-    return (rebuild_tensor, (type(tensor), storage, metadata))
+    return (rebuild_tensor, (type(tensor), _segment_storage(storage), metadata))
 
 
 def fd_id(fd):
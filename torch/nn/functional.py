@@ -2419,6 +2419,11 @@ def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-1
                 reduction=reduction)
     if size_average is not None or reduce is not None:
         reduction = _Reduction.legacy_get_string(size_average, reduce)
+    if not torch.jit.is_scripting():
+        # The fused op doesn't store the log-probabilities. Traced graphs keep
+        # log_softmax and nll_loss, which exporters know about.
+        if input.dim() == 2 and not torch._C._get_tracing_state():
+            return torch._fused_cross_entropy(input, target, weight, _Reduction.get_enum(reduction), ignore_index)[0]
     return nll_loss(log_softmax(input, 1), target, weight, None, ignore_index, None, reduction)
 
 
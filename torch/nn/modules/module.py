@@ -1306,8 +1306,17 @@ class Module:
             p.requires_grad_(requires_grad)
         return self
 
-    def zero_grad(self) -> None:
-        r"""Sets gradients of all model parameters to zero."""
+    def zero_grad(self, set_to_none: bool = False) -> None:
+        r"""Sets gradients of all model parameters to zero.
+
+        Arguments:
+            set_to_none (bool): instead of setting to zero, set the gradients
+                to ``None``. Their memory is kept if nothing else refers to
+                it, and the next gradients computed by the autograd engine
+                are copied into it rather than into newly allocated memory.
+                Accumulating into gradients that are ``None`` skips reading
+                and zeroing them. Default: ``False``
+        """
         if getattr(self, '_is_replica', False):
             warnings.warn(
                 "Calling .zero_grad() from a module created with nn.DataParallel() has no effect. "
@@ -1317,8 +1326,11 @@ class Module:
 
         for p in self.parameters():
             if p.grad is not None:
-                p.grad.detach_()
-                p.grad.zero_()
+                if set_to_none:
+                    torch.autograd._release_grad(p)
+                else:
+                    p.grad.detach_()
+                    p.grad.zero_()
 
     def share_memory(self: T) -> T:
         return self._apply(lambda t: t.share_memory_())
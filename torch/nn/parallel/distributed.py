@@ -419,6 +419,9 @@ class DistributedDataParallel(Module):
             [dist._DEFAULT_FIRST_BUCKET_BYTES, self.bucket_bytes_cap],
             expect_sparse_gradient[0])
 
+        # The parameters the reducer refers to by index.
+        self._reducer_parameters = parameters[0]
+
         # Note: reverse list of buckets because we want to approximate the
         # order in which their gradients are produced, and assume they
         # are used in the forward pass in the order they are defined.
@@ -462,6 +465,145 @@ class DistributedDataParallel(Module):
                                "init_process_group and have not passed "
                                "process_group argument to DDP constructor")
 
+    def register_comm_hook(self, hook):
+        r"""
+        Registers a communication hook that reduces gradient buckets instead
+        of the default allreduce, e.g. to compress gradients for
+        bandwidth-bound jobs. Buckets are still reduced as soon as they are
+        ready, overlapping with the backward pass. Buckets of sparse gradients
+        always use the default allreduce.
+
+        Built-in hooks are :class:`torch.distributed.FP16CompressCommHook`,
+        :class:`torch.distributed.TopKCommHook` and
+        :class:`torch.distributed.PowerSGDCommHook`. The top-k and PowerSGD
+        hooks only support single-device modules. This may only be called
+        once.
+
+        Arguments:
+            hook (torch.distributed.CommHook): the communication hook.
+
+        Example::
+
+            >>> ddp = torch.nn.parallel.DistributedDataParallel(model, device_ids=[rank])
+            >>> ddp.register_comm_hook(
+            ...     torch.distributed.PowerSGDCommHook(ddp.process_group, matrix_rank=2))
+        """
+        self.reducer._register_comm_hook(hook)
+
+    def set_defer_finalize(self, defer_finalize):
+        r"""
+        If ``defer_finalize`` is ``True``, ``backward()`` no longer waits for
+        the reduction of all gradients to complete. The gradients of a bucket
+        of parameters are written back once they are requested through
+        :meth:`reduced_parameter_groups`, which lets the optimizer update
+        the parameters of the buckets whose reduction has completed while
+        the others are still being reduced. Gradients that weren't requested
+        are written back the next time the model runs a forward pass that
+        requires a backward pass.
+
+        The first iteration, in which the buckets are rebuilt, and
+        iterations under distributed autograd are always finalized by
+        ``backward()``.
+
+        Example::
+
+            >>> ddp.set_defer_finalize(True)
+            >>> ddp(input).sum().backward()
+            >>> for params in ddp.reduced_parameter_groups():
+            ...     update(params)  # their .grad holds the reduced gradients
+        """
+        self.reducer._set_defer_finalize(defer_finalize)
+
+    def set_shard_gradients(self, shard_gradients):
+        r"""
+        If ``shard_gradients`` is ``True``, the gradient buckets are
+        reduce-scattered instead of allreduced: every bucket is split into one
+        shard per process, and each process only receives the reduced
+        gradients of its own shard. The gradients outside of it are set to
+        zero. This is meant for optimizers that shard their state across
+        processes, see :class:`torch.distributed.optim.ShardedOptimizer`,
+        which enables it. Buckets are still reduced as soon as they are ready.
+
+        The buckets are allreduced until they are rebuilt after the first
+        iteration. Only supports single-device modules and process groups that
+        support ``reduce_scatter``, like NCCL, and can't be combined with a
+        communication hook.
+        """
+        self.reducer._set_shard_gradients(shard_gradients)
+
+    def set_coalesce_sparse_gradients(self, coalesce_sparse_gradients, density_threshold=0.0):
+        r"""
+        If ``coalesce_sparse_gradients`` is ``True``, the sparse gradients of
+        consecutive buckets are reduced together with a single
+        ``allreduce_coalesced``, which gathers the indices and values of all
+        of them at once, instead of running one sparse allreduce per gradient.
+        The gathered entries are merged in parallel.
+
+        If ``density_threshold`` is positive, a gradient whose entries
+        gathered from all processes are at least ``density_threshold`` times
+        as many as its rows is allreduced as a dense tensor instead. Only
+        supports single-device modules and process groups that support sparse
+        ``allreduce_coalesced``, like Gloo.
+        """
+        self.reducer._set_coalesce_sparse_gradients(
+            coalesce_sparse_gradients, density_threshold)
+
+    def set_gradient_as_bucket_view(self, gradient_as_bucket_view):
+        r"""
+        If ``gradient_as_bucket_view`` is ``True``, the ``grad`` of the
+        parameters share the memory of the flattened gradient buckets: the
+        autograd engine accumulates gradients right into the buckets, and the
+        reduced gradients are in place as soon as the reduction completes.
+        This saves the memory of the gradients, and the copies of the
+        gradients into the buckets and of the reduced buckets back into the
+        gradients.
+
+        A ``grad`` is made to share the memory of its bucket the first time
+        it is reduced, and whenever it was replaced, e.g. set to ``None``.
+        Zeroing gradients in place, like ``zero_grad()`` does, keeps it.
+        The gradients of parameters that are unused on all processes are
+        reduced with the others rather than left untouched. Not used under
+        distributed autograd.
+        """
+        self.reducer._set_gradient_as_bucket_view(gradient_as_bucket_view)
+
+    def reconfigure(self, process_group=None):
+        r"""
+        Switches the module to ``process_group`` (by default, the default
+        process group), after the processes of the job changed, e.g. with
+        :func:`torch.distributed.reconfigure_process_group`. All processes of
+        the new process group must call it, between iterations.
+
+        The parameters and buffers of the process with rank 0 in the new
+        process group are broadcast to all others, and so is its gradient
+        bucket layout, so that processes that join with a freshly created
+        module continue from the state of the others. The module and the
+        reducer are kept as they are otherwise. Communication hooks keep the
+        process group they were created with, and need to be registered on a
+        new module to use another one.
+        """
+        if process_group is None:
+            process_group = _get_default_group()
+        self.process_group = process_group
+        module_states = list(self.module.state_dict().values())
+        if len(module_states) > 0:
+            self._distributed_broadcast_coalesced(
+                module_states,
+                self.broadcast_bucket_size)
+        self.reducer._set_process_group(process_group)
+
+    def reduced_parameter_groups(self):
+        r"""
+        Generator that, for every bucket whose gradients haven't been written
+        back yet (see :meth:`set_defer_finalize`), waits for its reduction to
+        complete, writes the gradients back and yields the list of its
+        parameters. Buckets are yielded in the order their reduction was
+        kicked off.
+        """
+        for bucket_index in self.reducer._get_pending_buckets():
+            variable_indices = self.reducer._finalize_bucket(bucket_index)
+            yield [self._reducer_parameters[i] for i in variable_indices]
+
     @contextmanager
     def no_sync(self):
         r"""
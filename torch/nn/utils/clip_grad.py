@@ -1,6 +1,5 @@
 import warnings
 import torch
-from torch._six import inf
 
 
 def clip_grad_norm_(parameters, max_norm, norm_type=2):
@@ -27,14 +26,13 @@ def clip_grad_norm_(parameters, max_norm, norm_type=2):
     if len(parameters) == 0:
         return torch.tensor(0.)
     device = parameters[0].grad.device
-    if norm_type == inf:
-        total_norm = max(p.grad.detach().abs().max().to(device) for p in parameters)
-    else:
-        total_norm = torch.norm(torch.stack([torch.norm(p.grad.detach(), norm_type).to(device) for p in parameters]), norm_type)
+    grads = [p.grad.detach() for p in parameters]
+    # The norms and the clip coefficient stay on the device, and gradients are
+    # scaled by a clip coefficient of at most 1, so that there is no sync.
+    norms = torch._foreach_norm(grads, norm_type)
+    total_norm = torch.norm(torch.stack([norm.to(device) for norm in norms]), norm_type)
     clip_coef = max_norm / (total_norm + 1e-6)
-    if clip_coef < 1:
-        for p in parameters:
-            p.grad.detach().mul_(clip_coef.to(p.grad.device))
+    torch._foreach_mul_(grads, torch.clamp(clip_coef, max=1.0))
     return total_norm
 
 
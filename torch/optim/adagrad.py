@@ -1,3 +1,5 @@
+from collections import defaultdict
+
 import torch
 from .optimizer import Optimizer
 
@@ -63,6 +65,9 @@ class Adagrad(Optimizer):
                 loss = closure()
 
         for group in self.param_groups:
+            # Dense gradients are updated with the _foreach_* ops, a list at a
+            # time, grouped by step since the learning rate depends on it.
+            dense_by_step = defaultdict(list)
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -72,31 +77,42 @@ class Adagrad(Optimizer):
 
                 state['step'] += 1
 
+                if not grad.is_sparse:
+                    dense_by_step[state['step']].append(p)
+                    continue
+
                 if group['weight_decay'] != 0:
-                    if p.grad.is_sparse:
-                        raise RuntimeError("weight_decay option is not compatible with sparse gradients")
-                    grad = grad.add(p, alpha=group['weight_decay'])
+                    raise RuntimeError("weight_decay option is not compatible with sparse gradients")
 
                 clr = group['lr'] / (1 + (state['step'] - 1) * group['lr_decay'])
 
-                if grad.is_sparse:
-                    grad = grad.coalesce()  # the update is non-linear so indices must be unique
-                    grad_indices = grad._indices()
-                    grad_values = grad._values()
-                    size = grad.size()
-
-                    def make_sparse(values):
-                        constructor = grad.new
-                        if grad_indices.dim() == 0 or values.dim() == 0:
-                            return constructor().resize_as_(grad)
-                        return constructor(grad_indices, values, size)
-                    state['sum'].add_(make_sparse(grad_values.pow(2)))
-                    std = state['sum'].sparse_mask(grad)
-                    std_values = std._values().sqrt_().add_(group['eps'])
-                    p.add_(make_sparse(grad_values / std_values), alpha=-clr)
-                else:
-                    state['sum'].addcmul_(grad, grad, value=1)
-                    std = state['sum'].sqrt().add_(group['eps'])
-                    p.addcdiv_(grad, std, value=-clr)
+                grad = grad.coalesce()  # the update is non-linear so indices must be unique
+                grad_indices = grad._indices()
+                grad_values = grad._values()
+                size = grad.size()
+
+                def make_sparse(values):
+                    constructor = grad.new
+                    if grad_indices.dim() == 0 or values.dim() == 0:
+                        return constructor().resize_as_(grad)
+                    return constructor(grad_indices, values, size)
+                state['sum'].add_(make_sparse(grad_values.pow(2)))
+                std = state['sum'].sparse_mask(grad)
+                std_values = std._values().sqrt_().add_(group['eps'])
+                p.add_(make_sparse(grad_values / std_values), alpha=-clr)
+
+            for step, params in dense_by_step.items():
+                grads = [p.grad for p in params]
+                state_sums = [self.state[p]['sum'] for p in params]
+
+                if group['weight_decay'] != 0:
+                    grads = torch._foreach_add(grads, params, alpha=group['weight_decay'])
+
+                clr = group['lr'] / (1 + (step - 1) * group['lr_decay'])
+
+                torch._foreach_addcmul_(state_sums, grads, grads, value=1)
+                std = torch._foreach_sqrt(state_sums)
+                torch._foreach_add_(std, group['eps'])
+                torch._foreach_addcdiv_(params, grads, std, value=-clr)
 
         return loss
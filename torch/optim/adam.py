@@ -1,6 +1,38 @@
 import math
+from collections import defaultdict
+
 import torch
-from .optimizer import Optimizer
+from .optimizer import Optimizer, _group_by_device_and_dtype
+
+
+def _fused_step(state, group, found_inf_per_device, adamw):
+    # Shared by Adam and AdamW. The steps are one-element float tensors,
+    # counted on the device since skipped steps are only known there.
+    beta1, beta2 = group['betas']
+    params_with_grad = []
+    for p in group['params']:
+        if p.grad is None:
+            continue
+        if p.grad.is_sparse:
+            raise RuntimeError('The fused Adam does not support sparse gradients')
+        param_state = state[p]
+        if len(param_state) == 0:
+            param_state['step'] = torch.zeros((), dtype=torch.float32, device=p.device)
+            param_state['exp_avg'] = torch.zeros_like(p, memory_format=torch.preserve_format)
+            param_state['exp_avg_sq'] = torch.zeros_like(p, memory_format=torch.preserve_format)
+        elif not torch.is_tensor(param_state['step']):
+            param_state['step'] = torch.tensor(float(param_state['step']), dtype=torch.float32, device=p.device)
+        params_with_grad.append(p)
+
+    for (device, _), params in _group_by_device_and_dtype(params_with_grad).items():
+        torch._fused_adam_(params,
+                           [p.grad for p in params],
+                           [state[p]['exp_avg'] for p in params],
+                           [state[p]['exp_avg_sq'] for p in params],
+                           [state[p]['step'] for p in params],
+                           lr=group['lr'], beta1=beta1, beta2=beta2, eps=group['eps'],
+                           weight_decay=group['weight_decay'], adamw=adamw,
+                           found_inf=found_inf_per_device.get(device))
 
 
 class Adam(Optimizer):
@@ -20,6 +52,11 @@ class Adam(Optimizer):
         amsgrad (boolean, optional): whether to use the AMSGrad variant of this
             algorithm from the paper `On the Convergence of Adam and Beyond`_
             (default: False)
+        fused (bool, optional): updates the CUDA parameters of each device and
+            dtype with a single fused kernel, which doesn't support amsgrad.
+            With a :class:`torch.cuda.amp.GradScaler`, the step is then skipped
+            on the device when infs/NaNs are found, without a CPU-GPU sync
+            (default: False)
 
     .. _Adam\: A Method for Stochastic Optimization:
         https://arxiv.org/abs/1412.6980
@@ -28,7 +65,7 @@ class Adam(Optimizer):
     """
 
     def __init__(self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8,
-                 weight_decay=0, amsgrad=False):
+                 weight_decay=0, amsgrad=False, fused=False):
         if not 0.0 <= lr:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if not 0.0 <= eps:
@@ -39,36 +76,56 @@ class Adam(Optimizer):
             raise ValueError("Invalid beta parameter at index 1: {}".format(betas[1]))
         if not 0.0 <= weight_decay:
             raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        if fused and amsgrad:
+            raise ValueError("amsgrad is not supported by the fused {}".format(self.__class__.__name__))
         defaults = dict(lr=lr, betas=betas, eps=eps,
                         weight_decay=weight_decay, amsgrad=amsgrad)
         super(Adam, self).__init__(params, defaults)
+        self.fused = fused
+        self._step_supports_amp_scaling = fused
 
     def __setstate__(self, state):
         super(Adam, self).__setstate__(state)
+        self.__dict__.setdefault('fused', False)
+        self.__dict__.setdefault('_step_supports_amp_scaling', self.fused)
         for group in self.param_groups:
             group.setdefault('amsgrad', False)
 
     @torch.no_grad()
-    def step(self, closure=None):
+    def step(self, closure=None, grad_scaler=None):
         """Performs a single optimization step.
 
         Arguments:
             closure (callable, optional): A closure that reevaluates the model
                 and returns the loss.
+            grad_scaler (torch.cuda.amp.GradScaler, optional): passed by
+                :meth:`GradScaler.step` if the optimizer is fused.
         """
         loss = None
         if closure is not None:
             with torch.enable_grad():
                 loss = closure()
 
+        if self.fused:
+            found_inf_per_device = {}
+            if grad_scaler is not None:
+                found_inf_per_device = grad_scaler._maybe_unscale_and_get_found_inf(self)
+            for group in self.param_groups:
+                _fused_step(self.state, group, found_inf_per_device, adamw=False)
+            return loss
+
         for group in self.param_groups:
+            amsgrad = group['amsgrad']
+            beta1, beta2 = group['betas']
+
+            # The parameters are updated with the _foreach_* ops, a list at a
+            # time, grouped by step since the bias corrections depend on it.
+            params_by_step = defaultdict(list)
             for p in group['params']:
                 if p.grad is None:
                     continue
-                grad = p.grad
-                if grad.is_sparse:
+                if p.grad.is_sparse:
                     raise RuntimeError('Adam does not support sparse gradients, please consider SparseAdam instead')
-                amsgrad = group['amsgrad']
 
                 state = self.state[p]
 
@@ -83,31 +140,42 @@ class Adam(Optimizer):
                         # Maintains max of all exp. moving avg. of sq. grad. values
                         state['max_exp_avg_sq'] = torch.zeros_like(p, memory_format=torch.preserve_format)
 
-                exp_avg, exp_avg_sq = state['exp_avg'], state['exp_avg_sq']
-                if amsgrad:
-                    max_exp_avg_sq = state['max_exp_avg_sq']
-                beta1, beta2 = group['betas']
-
+                if torch.is_tensor(state['step']):
+                    # Counted on the device by the fused step
+                    state['step'] = int(state['step'].item())
                 state['step'] += 1
-                bias_correction1 = 1 - beta1 ** state['step']
-                bias_correction2 = 1 - beta2 ** state['step']
+                params_by_step[state['step']].append(p)
+
+            for step, params in params_by_step.items():
+                grads = [p.grad for p in params]
+                exp_avgs = [self.state[p]['exp_avg'] for p in params]
+                exp_avg_sqs = [self.state[p]['exp_avg_sq'] for p in params]
+
+                bias_correction1 = 1 - beta1 ** step
+                bias_correction2 = 1 - beta2 ** step
 
                 if group['weight_decay'] != 0:
-                    grad = grad.add(p, alpha=group['weight_decay'])
+                    grads = torch._foreach_add(grads, params, alpha=group['weight_decay'])
 
                 # Decay the first and second moment running average coefficient
-                exp_avg.mul_(beta1).add_(grad, alpha=1 - beta1)
-                exp_avg_sq.mul_(beta2).addcmul_(grad, grad, value=1 - beta2)
+                torch._foreach_mul_(exp_avgs, beta1)
+                torch._foreach_add_(exp_avgs, grads, alpha=1 - beta1)
+                torch._foreach_mul_(exp_avg_sqs, beta2)
+                torch._foreach_addcmul_(exp_avg_sqs, grads, grads, value=1 - beta2)
                 if amsgrad:
+                    max_exp_avg_sqs = [self.state[p]['max_exp_avg_sq'] for p in params]
                     # Maintains the maximum of all 2nd moment running avg. till now
-                    torch.max(max_exp_avg_sq, exp_avg_sq, out=max_exp_avg_sq)
+                    for max_exp_avg_sq, exp_avg_sq in zip(max_exp_avg_sqs, exp_avg_sqs):
+                        torch.max(max_exp_avg_sq, exp_avg_sq, out=max_exp_avg_sq)
                     # Use the max. for normalizing running avg. of gradient
-                    denom = (max_exp_avg_sq.sqrt() / math.sqrt(bias_correction2)).add_(group['eps'])
+                    denom = torch._foreach_sqrt(max_exp_avg_sqs)
                 else:
-                    denom = (exp_avg_sq.sqrt() / math.sqrt(bias_correction2)).add_(group['eps'])
+                    denom = torch._foreach_sqrt(exp_avg_sqs)
+                torch._foreach_div_(denom, math.sqrt(bias_correction2))
+                torch._foreach_add_(denom, group['eps'])
 
                 step_size = group['lr'] / bias_correction1
 
-                p.addcdiv_(exp_avg, denom, value=-step_size)
+                torch._foreach_addcdiv_(params, exp_avgs, denom, value=-step_size)
 
         return loss
@@ -1,6 +1,7 @@
 import math
 import torch
 from .optimizer import Optimizer
+from .adam import _fused_step
 
 
 class AdamW(Optimizer):
@@ -21,6 +22,11 @@ class AdamW(Optimizer):
         amsgrad (boolean, optional): whether to use the AMSGrad variant of this
             algorithm from the paper `On the Convergence of Adam and Beyond`_
             (default: False)
+        fused (bool, optional): updates the CUDA parameters of each device and
+            dtype with a single fused kernel, which doesn't support amsgrad.
+            With a :class:`torch.cuda.amp.GradScaler`, the step is then skipped
+            on the device when infs/NaNs are found, without a CPU-GPU sync
+            (default: False)
 
     .. _Adam\: A Method for Stochastic Optimization:
         https://arxiv.org/abs/1412.6980
@@ -31,7 +37,7 @@ class AdamW(Optimizer):
     """
 
     def __init__(self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8,
-                 weight_decay=1e-2, amsgrad=False):
+                 weight_decay=1e-2, amsgrad=False, fused=False):
         if not 0.0 <= lr:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if not 0.0 <= eps:
@@ -42,28 +48,44 @@ class AdamW(Optimizer):
             raise ValueError("Invalid beta parameter at index 1: {}".format(betas[1]))
         if not 0.0 <= weight_decay:
             raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        if fused and amsgrad:
+            raise ValueError("amsgrad is not supported by the fused {}".format(self.__class__.__name__))
         defaults = dict(lr=lr, betas=betas, eps=eps,
                         weight_decay=weight_decay, amsgrad=amsgrad)
         super(AdamW, self).__init__(params, defaults)
+        self.fused = fused
+        self._step_supports_amp_scaling = fused
 
     def __setstate__(self, state):
         super(AdamW, self).__setstate__(state)
+        self.__dict__.setdefault('fused', False)
+        self.__dict__.setdefault('_step_supports_amp_scaling', self.fused)
         for group in self.param_groups:
             group.setdefault('amsgrad', False)
 
     @torch.no_grad()
-    def step(self, closure=None):
+    def step(self, closure=None, grad_scaler=None):
         """Performs a single optimization step.
 
         Arguments:
             closure (callable, optional): A closure that reevaluates the model
                 and returns the loss.
+            grad_scaler (torch.cuda.amp.GradScaler, optional): passed by
+                :meth:`GradScaler.step` if the optimizer is fused.
         """
         loss = None
         if closure is not None:
             with torch.enable_grad():
                 loss = closure()
 
+        if self.fused:
+            found_inf_per_device = {}
+            if grad_scaler is not None:
+                found_inf_per_device = grad_scaler._maybe_unscale_and_get_found_inf(self)
+            for group in self.param_groups:
+                _fused_step(self.state, group, found_inf_per_device, adamw=True)
+            return loss
+
         for group in self.param_groups:
             for p in group['params']:
                 if p.grad is None:
@@ -96,6 +118,9 @@ class AdamW(Optimizer):
                     max_exp_avg_sq = state['max_exp_avg_sq']
                 beta1, beta2 = group['betas']
 
+                if torch.is_tensor(state['step']):
+                    # Counted on the device by the fused step
+                    state['step'] = int(state['step'].item())
                 state['step'] += 1
                 bias_correction1 = 1 - beta1 ** state['step']
                 bias_correction2 = 1 - beta2 ** state['step']
@@ -14,6 +14,15 @@ class _RequiredParameter(object):
 required = _RequiredParameter()
 
 
+def _group_by_device_and_dtype(params):
+    r"""Groups params by device and dtype, since a fused optimizer kernel
+    updates tensors of a single device and dtype."""
+    grouped = defaultdict(list)
+    for p in params:
+        grouped[(p.device, p.dtype)].append(p)
+    return grouped
+
+
 class Optimizer(object):
     r"""Base class for all optimizers.
 
@@ -163,13 +172,24 @@ class Optimizer(object):
             update_group(g, ng) for g, ng in zip(groups, saved_groups)]
         self.__setstate__({'state': state, 'param_groups': param_groups})
 
-    def zero_grad(self):
-        r"""Clears the gradients of all optimized :class:`torch.Tensor` s."""
+    def zero_grad(self, set_to_none=False):
+        r"""Clears the gradients of all optimized :class:`torch.Tensor` s.
+
+        Arguments:
+            set_to_none (bool): instead of setting to zero, set the gradients
+                to ``None``, see :meth:`torch.nn.Module.zero_grad`. Optimizers
+                skip parameters whose gradient is ``None``, which differs from
+                a gradient of zeros if no gradient is computed for them.
+                Default: ``False``
+        """
         for group in self.param_groups:
             for p in group['params']:
                 if p.grad is not None:
-                    p.grad.detach_()
-                    p.grad.zero_()
+                    if set_to_none:
+                        torch.autograd._release_grad(p)
+                    else:
+                        p.grad.detach_()
+                        p.grad.zero_()
 
     def step(self, closure):
         r"""Performs a single optimization step (parameter update).
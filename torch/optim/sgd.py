@@ -1,5 +1,5 @@
 import torch
-from .optimizer import Optimizer, required
+from .optimizer import Optimizer, required, _group_by_device_and_dtype
 
 
 class SGD(Optimizer):
@@ -16,6 +16,11 @@ class SGD(Optimizer):
         weight_decay (float, optional): weight decay (L2 penalty) (default: 0)
         dampening (float, optional): dampening for momentum (default: 0)
         nesterov (bool, optional): enables Nesterov momentum (default: False)
+        fused (bool, optional): updates the CUDA parameters of each device and
+            dtype with a single fused kernel. With a
+            :class:`torch.cuda.amp.GradScaler`, the step is then skipped on the
+            device when infs/NaNs are found, without a CPU-GPU sync
+            (default: False)
 
     Example:
         >>> optimizer = torch.optim.SGD(model.parameters(), lr=0.1, momentum=0.9)
@@ -53,7 +58,7 @@ class SGD(Optimizer):
     """
 
     def __init__(self, params, lr=required, momentum=0, dampening=0,
-                 weight_decay=0, nesterov=False):
+                 weight_decay=0, nesterov=False, fused=False):
         if lr is not required and lr < 0.0:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if momentum < 0.0:
@@ -66,49 +71,136 @@ class SGD(Optimizer):
         if nesterov and (momentum <= 0 or dampening != 0):
             raise ValueError("Nesterov momentum requires a momentum and zero dampening")
         super(SGD, self).__init__(params, defaults)
+        self.fused = fused
+        self._step_supports_amp_scaling = fused
 
     def __setstate__(self, state):
         super(SGD, self).__setstate__(state)
+        self.__dict__.setdefault('fused', False)
+        self.__dict__.setdefault('_step_supports_amp_scaling', self.fused)
         for group in self.param_groups:
             group.setdefault('nesterov', False)
 
     @torch.no_grad()
-    def step(self, closure=None):
+    def step(self, closure=None, grad_scaler=None):
         """Performs a single optimization step.
 
         Arguments:
             closure (callable, optional): A closure that reevaluates the model
                 and returns the loss.
+            grad_scaler (torch.cuda.amp.GradScaler, optional): passed by
+                :meth:`GradScaler.step` if the optimizer is fused.
         """
         loss = None
         if closure is not None:
             with torch.enable_grad():
                 loss = closure()
 
+        if self.fused:
+            found_inf_per_device = {}
+            if grad_scaler is not None:
+                found_inf_per_device = grad_scaler._maybe_unscale_and_get_found_inf(self)
+            for group in self.param_groups:
+                self._fused_step(group, found_inf_per_device)
+            return loss
+
         for group in self.param_groups:
             weight_decay = group['weight_decay']
             momentum = group['momentum']
             dampening = group['dampening']
             nesterov = group['nesterov']
 
+            # The update of dense gradients is applied to all the parameters of
+            # the group at once, with the _foreach_* ops, which launch a few
+            # kernels for the whole list instead of a few kernels per
+            # parameter. They have no sparse kernels, so sparse gradients are
+            # applied one parameter at a time.
+            params_with_grad = []
+            grads = []
             for p in group['params']:
                 if p.grad is None:
                     continue
-                d_p = p.grad
-                if weight_decay != 0:
-                    d_p = d_p.add(p, alpha=weight_decay)
-                if momentum != 0:
+                if p.grad.is_sparse:
+                    self._sparse_step(group, p)
+                else:
+                    params_with_grad.append(p)
+                    grads.append(p.grad)
+            if len(params_with_grad) == 0:
+                continue
+
+            if weight_decay != 0:
+                grads = torch._foreach_add(grads, params_with_grad, alpha=weight_decay)
+
+            if momentum != 0:
+                bufs = []
+                old_bufs = []
+                old_bufs_grads = []
+                for p, d_p in zip(params_with_grad, grads):
                     param_state = self.state[p]
                     if 'momentum_buffer' not in param_state:
                         buf = param_state['momentum_buffer'] = torch.clone(d_p).detach()
                     else:
                         buf = param_state['momentum_buffer']
-                        buf.mul_(momentum).add_(d_p, alpha=1 - dampening)
-                    if nesterov:
-                        d_p = d_p.add(buf, alpha=momentum)
-                    else:
-                        d_p = buf
-
-                p.add_(d_p, alpha=-group['lr'])
+                        old_bufs.append(buf)
+                        old_bufs_grads.append(d_p)
+                    bufs.append(buf)
+                if len(old_bufs) > 0:
+                    torch._foreach_mul_(old_bufs, momentum)
+                    torch._foreach_add_(old_bufs, old_bufs_grads, alpha=1 - dampening)
+                if nesterov:
+                    grads = torch._foreach_add(grads, bufs, alpha=momentum)
+                else:
+                    grads = bufs
+
+            torch._foreach_add_(params_with_grad, grads, alpha=-group['lr'])
 
         return loss
+
+    def _sparse_step(self, group, p):
+        weight_decay = group['weight_decay']
+        momentum = group['momentum']
+        d_p = p.grad
+        if weight_decay != 0:
+            d_p = d_p.add(p, alpha=weight_decay)
+        if momentum != 0:
+            param_state = self.state[p]
+            if 'momentum_buffer' not in param_state:
+                buf = param_state['momentum_buffer'] = torch.clone(d_p).detach()
+            else:
+                buf = param_state['momentum_buffer']
+                buf.mul_(momentum).add_(d_p, alpha=1 - group['dampening'])
+            if group['nesterov']:
+                d_p = d_p.add(buf, alpha=momentum)
+            else:
+                d_p = buf
+
+        p.add_(d_p, alpha=-group['lr'])
+
+    def _fused_step(self, group, found_inf_per_device):
+        params_with_grad = [p for p in group['params'] if p.grad is not None]
+        for (device, _), params in _group_by_device_and_dtype(params_with_grad).items():
+            found_inf = found_inf_per_device.get(device)
+            kwargs = dict(lr=group['lr'], momentum=group['momentum'], dampening=group['dampening'],
+                          weight_decay=group['weight_decay'], nesterov=group['nesterov'], found_inf=found_inf)
+            if group['momentum'] == 0:
+                torch._fused_sgd_(params, [p.grad for p in params], [], **kwargs)
+                continue
+
+            # The buffers of the first step are written by the kernel, which
+            # sets them to the gradients (with weight decay). If a GradScaler
+            # skips that step, the next one starts from zero buffers, which
+            # only makes a difference with dampening.
+            new_params = []
+            old_params = []
+            for p in params:
+                param_state = self.state[p]
+                if 'momentum_buffer' not in param_state:
+                    param_state['momentum_buffer'] = torch.zeros_like(p, memory_format=torch.preserve_format)
+                    new_params.append(p)
+                else:
+                    old_params.append(p)
+            for step_params, is_first_step in ((new_params, True), (old_params, False)):
+                if len(step_params) > 0:
+                    torch._fused_sgd_(step_params, [p.grad for p in step_params],
+                                      [self.state[p]['momentum_buffer'] for p in step_params],
+                                      is_first_step=is_first_step, **kwargs)
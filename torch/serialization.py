@@ -7,6 +7,7 @@ import sys
 import torch
 import tarfile
 import tempfile
+import threading
 import warnings
 from contextlib import closing, contextmanager
 from ._utils import _import_dotted_name
@@ -327,7 +328,8 @@ def _check_dill_version(pickle_module):
                 pickle_module.__version__
             ))
 
-def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL, _use_new_zipfile_serialization=True):
+def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL, _use_new_zipfile_serialization=True,
+         compress_storages=False):
     """Saves an object to a disk file.
 
     See also: :ref:`recommend-saving-models`
@@ -338,6 +340,10 @@ def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL, _use_ne
            containing a file name
         pickle_module: module used for pickling metadata and objects
         pickle_protocol: can be specified to override the default protocol
+        compress_storages (bool): if ``True``, the storages of the tensors are
+            deflated, which makes files with many repeated values, like sparse
+            embeddings or quantized weights, smaller, at the cost of slower
+            saving and loading. Default: ``False``.
 
     .. note::
         A common PyTorch convention is to save tensors using .pt file extension.
@@ -361,7 +367,7 @@ def save(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL, _use_ne
 
     if _use_new_zipfile_serialization:
         with _open_zipfile_writer(f) as opened_file:
-            _save(obj, opened_file, pickle_module, pickle_protocol)
+            _save(obj, opened_file, pickle_module, pickle_protocol, compress_storages)
             return
 
     with _open_file_like(f, 'wb') as opened_file:
@@ -439,7 +445,8 @@ def _legacy_save(obj, f, pickle_module, pickle_protocol):
         serialized_storages[key]._write_file(f, _should_read_directly(f), True)
 
 
-def _save(obj, zip_file, pickle_module, pickle_protocol):
+def _pickle_storages(obj, pickle_module, pickle_protocol):
+    # Returns the pickle data of `obj`, and its storages by key
     serialized_storages = {}
 
     def persistent_id(obj):
@@ -466,7 +473,11 @@ def _save(obj, zip_file, pickle_module, pickle_protocol):
     pickler = pickle_module.Pickler(data_buf, protocol=pickle_protocol)
     pickler.persistent_id = persistent_id
     pickler.dump(obj)
-    data_value = data_buf.getvalue()
+    return data_buf.getvalue(), serialized_storages
+
+
+def _save(obj, zip_file, pickle_module, pickle_protocol, compress_storages=False):
+    data_value, serialized_storages = _pickle_storages(obj, pickle_module, pickle_protocol)
     zip_file.write_record('data.pkl', data_value, len(data_value))
 
     # Write each tensor to a file named tensor/the_tensor_key in the zip archive
@@ -476,16 +487,108 @@ def _save(obj, zip_file, pickle_module, pickle_protocol):
         if storage.device.type == 'cpu':
             # If it's on the CPU we can directly copy it into the zip file
             num_bytes = storage.size() * storage.element_size()
-            zip_file.write_record(name, storage.data_ptr(), num_bytes)
+            zip_file.write_record(name, storage.data_ptr(), num_bytes, compress=compress_storages)
         else:
             # Copy to a buffer, then serialize that
             buf = io.BytesIO()
             storage._write_file(buf, _should_read_directly(buf))
             buf_value = buf.getvalue()
-            zip_file.write_record(name, buf_value, len(buf_value))
+            zip_file.write_record(name, buf_value, len(buf_value), compress=compress_storages)
+
+
+def _snapshot_storage(storage):
+    # Returns a CPU copy of `storage` to write in its place, and the CUDA
+    # event to wait for before writing it, if any
+    if storage.device.type == 'cpu':
+        return storage.clone(), None
+    src = torch.tensor([], dtype=storage.dtype, device=storage.device).set_(storage)
+    # Pinned, so that the copy is asynchronous; the caching host allocator
+    # reuses the buffers of the previous checkpoint
+    dst = torch.empty(src.size(), dtype=src.dtype, pin_memory=True)
+    dst.copy_(src, non_blocking=True)
+    event = torch.cuda.Event()
+    event.record()
+    return dst.storage(), event
+
+
+class AsyncSave(object):
+    r"""The pending write of a checkpoint, returned by :func:`torch.save_async`."""
+
+    def __init__(self, write):
+        self._exception = None
+        self._thread = threading.Thread(target=self._run, args=(write,))
+        self._thread.start()
+
+    def _run(self, write):
+        try:
+            write()
+        except BaseException as e:
+            self._exception = e
+
+    def done(self):
+        r"""Returns whether the checkpoint was written."""
+        return not self._thread.is_alive()
+
+    def wait(self):
+        r"""Blocks until the checkpoint is written, and raises the exception
+        writing it raised, if any."""
+        self._thread.join()
+        if self._exception is not None:
+            raise self._exception
+
+
+def save_async(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL, compress_storages=False):
+    """Saves an object to a disk file in the background.
+
+    Like :func:`torch.save`, but only pickles ``obj`` and copies its storages
+    before returning, and writes them to ``f`` on a background thread. The
+    storages of CPU tensors are copied to new CPU storages, and those of CUDA
+    tensors to pinned memory, asynchronously on the current stream. The
+    tensors in ``obj`` can then be modified, e.g. by the next optimizer step,
+    while the checkpoint is being written, which mostly happens without
+    holding the GIL. The file is written in the same format as
+    :func:`torch.save`, and is loaded with :func:`torch.load`.
+
+    Copying the storages needs as much memory as they take. Modify CUDA
+    tensors in ``obj`` on the current stream only, or synchronize with it
+    first.
+
+    Args:
+        obj: saved object
+        f: a file-like object (has to implement write and flush) or a string
+           containing a file name
+        pickle_module: module used for pickling metadata and objects
+        pickle_protocol: can be specified to override the default protocol
+        compress_storages (bool): see :func:`torch.save`.
+
+    Returns:
+        An :class:`~torch.serialization.AsyncSave`. Call its ``wait()``
+        method before reading the file, and before exiting.
+
+    Example:
+        >>> pending = torch.save_async(model.state_dict(), 'checkpoint.pt')
+        >>> optimizer.step()
+        >>> pending.wait()
+    """
+    _check_dill_version(pickle_module)
+    data_value, serialized_storages = _pickle_storages(obj, pickle_module, pickle_protocol)
+    snapshots = {key: _snapshot_storage(storage) for key, storage in serialized_storages.items()}
+
+    def write():
+        with _open_zipfile_writer(f) as zip_file:
+            zip_file.write_record('data.pkl', data_value, len(data_value))
+            for key in sorted(snapshots.keys()):
+                storage, event = snapshots[key]
+                if event is not None:
+                    event.synchronize()
+                num_bytes = storage.size() * storage.element_size()
+                zip_file.write_record('data/{}'.format(key), storage.data_ptr(), num_bytes,
+                                      compress=compress_storages)
+
+    return AsyncSave(write)
 
 
-def load(f, map_location=None, pickle_module=pickle, **pickle_load_args):
+def load(f, map_location=None, pickle_module=pickle, verify_crc=True, **pickle_load_args):
     """Loads an object saved with :func:`torch.save` from a file.
 
     :func:`torch.load` uses Python's unpickling facilities but treats storages,
@@ -524,6 +627,10 @@ def load(f, map_location=None, pickle_module=pickle, **pickle_load_args):
             locations
         pickle_module: module used for unpickling metadata and objects (has to
             match the :attr:`pickle_module` used to serialize file)
+        verify_crc (bool): if ``False``, the CRC32 of the uncompressed storages
+            in files saved with the zip format isn't checked, which saves a pass
+            over them. Only disable it for files from a trusted source, e.g.
+            checkpoints written by the same job. Default: ``True``.
         pickle_load_args: (Python 3 only) optional keyword arguments passed over to
             :func:`pickle_module.load` and :func:`pickle_module.Unpickler`, e.g.,
             :attr:`errors=...`.
@@ -573,6 +680,7 @@ def load(f, map_location=None, pickle_module=pickle, **pickle_load_args):
     with _open_file_like(f, 'rb') as opened_file:
         if _is_zipfile(opened_file):
             with _open_zipfile_reader(f) as opened_zipfile:
+                opened_zipfile.set_verify_crc(verify_crc)
                 if _is_torchscript_zip(opened_zipfile):
                     warnings.warn("'torch.load' received a zip file that looks like a TorchScript archive"
                                   " dispatching to 'torch.jit.load' (call 'torch.jit.load' directly to"
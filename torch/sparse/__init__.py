@@ -17,6 +17,7 @@ else:
 __all__ = [
     'addmm',
     'mm',
+    'sampled_addmm',
     'sum',
     'softmax',
     'log_softmax',
@@ -83,6 +84,25 @@ def mm(mat1, mat2):
     return torch._sparse_mm(mat1, mat2)
 
 
+def sampled_addmm(input, mat1, mat2, beta=1, alpha=1):
+    # type: (Tensor, Tensor, Tensor, float, float) -> Tensor
+    r"""
+    Computes :math:`\beta \cdot input + \alpha \cdot (mat1 @ mat2)` only at
+    the nonzeros of the sparse matrix :attr:`input`, and returns it as a sparse
+    matrix with the indices of :attr:`input`. This is also known as a sampled
+    dense-dense matrix multiplication (SDDMM). :attr:`input` need to have
+    `sparse_dim = 2` and scalar values. This function does not support backward.
+
+    Args:
+        input (SparseTensor): a :math:`(n \times p)` sparse matrix whose nonzeros are sampled
+        mat1 (Tensor): a :math:`(n \times m)` dense matrix to be multiplied
+        mat2 (Tensor): a :math:`(m \times p)` dense matrix to be multiplied
+        beta (Number, optional): multiplier for :attr:`input` (:math:`\beta`)
+        alpha (Number, optional): multiplier for :math:`mat1 @ mat2` (:math:`\alpha`)
+    """
+    return torch._sparse_sampled_addmm(input, mat1, mat2, beta=beta, alpha=alpha)
+
+
 def sum(input, dim=None, dtype=None):
     # type: (Tensor, Optional[Tuple[int]], Optional[int]) -> Tensor
     r"""
@@ -37,8 +37,8 @@ def dist_init(old_test_method=None, setup_rpc=True, clean_shutdown=True,
 
     Note: pass the string representation of MessageTypes that should be used
     with the faulty agent's send function. By default, all retriable messages
-    ("RREF_FORK_REQUEST", "RREF_CHILD_ACCEPT", "RREF_USER_DELETE",
-    "CLEANUP_AUTOGRAD_CONTEXT_REQ") will use the faulty send (this default is
+    ("RREF_FORK_REQUEST", "RREF_FORK_BATCH_REQUEST", "RREF_CHILD_ACCEPT",
+    "RREF_USER_DELETE", "CLEANUP_AUTOGRAD_CONTEXT_REQ") will use the faulty send (this default is
     set from faulty_rpc_agent_test_fixture.py).
     """
 
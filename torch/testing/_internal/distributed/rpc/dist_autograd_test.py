@@ -169,6 +169,14 @@ def _run_trainer_torchscript(rref_t1, t2, ps, rank_diff):
         rpc.rpc_sync(ps, _check_rpc_done, args=(0,))
 
 
+def _remote_module(module):
+    return module
+
+
+def _module_grads(module_rref):
+    return [p.grad for p in module_rref.local_value().parameters()]
+
+
 class SimulateBackwardError(Function):
     _simulate_error = True
 
@@ -1087,6 +1095,71 @@ class DistAutogradTest(RpcAgentTestFixture):
                 )
                 local_grads = ret if ret else local_grads
 
+    @staticmethod
+    def _concurrent_context_backward(dst, results, index):
+        t1 = torch.rand((3, 3), requires_grad=True)
+        t2 = torch.rand((3, 3), requires_grad=True)
+        with dist_autograd.context() as context_id:
+            val = rpc.rpc_sync(dst, torch.mul, args=(t1, t2))
+            val = rpc.rpc_sync(dst, torch.matmul, args=(val, t2))
+            dist_autograd.backward(context_id, [val.sum()])
+            grads = dist_autograd.get_gradients(context_id)
+            results[index] = (grads[t1], grads[t2])
+        torch.matmul(torch.mul(t1, t2), t2).sum().backward()
+        results[index] += (t1.grad, t2.grad)
+
+    @dist_init
+    def test_backward_concurrent_contexts(self):
+        # The backward passes of independent contexts run concurrently.
+        dst = worker_name((self.rank + 1) % self.world_size)
+        results = [None] * 10
+        threads = []
+        for i in range(len(results)):
+            t = threading.Thread(
+                target=DistAutogradTest._concurrent_context_backward,
+                args=(dst, results, i))
+            t.start()
+            threads.append(t)
+        for thread in threads:
+            thread.join()
+
+        for dist_grad1, dist_grad2, grad1, grad2 in results:
+            self.assertEqual(dist_grad1, grad1)
+            self.assertEqual(dist_grad2, grad2)
+
+    @dist_init
+    def test_remote_pipeline(self):
+        from torch.distributed.nn import RemotePipeline
+
+        if self.rank != 0:
+            return
+        owners = [worker_name((self.rank + i + 1) % self.world_size) for i in range(3)]
+        for schedule, checkpoint in [
+                ("1f1b", False), ("fill_drain", False), ("1f1b", True)]:
+            torch.manual_seed(0)
+            modules = [
+                torch.nn.Linear(4, 8), torch.nn.Tanh(), torch.nn.Linear(8, 2)]
+            stages = [
+                rpc.remote(owner, _remote_module, args=(module,))
+                for owner, module in zip(owners, modules)]
+            pipeline = RemotePipeline(
+                stages, chunks=4, schedule=schedule, checkpoint=checkpoint)
+            input = torch.rand(8, 4)
+            target = torch.rand(8, 2)
+            loss_fn = torch.nn.MSELoss()
+
+            local_model = torch.nn.Sequential(*modules)
+            self.assertEqual(pipeline(input), local_model(input))
+
+            loss = pipeline.train_step(input, target, loss_fn)
+            local_loss = loss_fn(local_model(input), target)
+            local_loss.backward()
+            self.assertEqual(loss, local_loss)
+            for stage, module in zip(stages, modules):
+                grads = rpc.rpc_sync(stage.owner(), _module_grads, args=(stage,))
+                for grad, p in zip(grads, module.parameters()):
+                    self.assertEqual(grad, p.grad)
+
     @dist_init
     def test_backward_different_tensor_dims(self):
         local_grads = None
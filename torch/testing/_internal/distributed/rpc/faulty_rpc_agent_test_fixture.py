@@ -8,6 +8,7 @@ from torch.testing._internal.distributed.rpc.rpc_agent_test_fixture import (
 # distributed autograd. Thus only these messages should be tested with the
 # Faulty RPC Agent.
 retryable_message_types = ["RREF_FORK_REQUEST",
+                           "RREF_FORK_BATCH_REQUEST",
                            "RREF_CHILD_ACCEPT",
                            "RREF_USER_DELETE",
                            "CLEANUP_AUTOGRAD_CONTEXT_REQ"]
@@ -853,6 +853,22 @@ def async_wrong_type():
     return torch.zeros(2)
 
 
+@torch.jit.script
+def double_with_batch_size(x):
+    # type: (Tensor) -> Tuple[Tensor, Tensor]
+    return x * 2, torch.full([x.size(0)], x.size(0), dtype=torch.long)
+
+
+def enable_batching(max_batch_size, max_delay_ms):
+    rpc.functions.enable_batching(
+        double_with_batch_size, max_batch_size, max_delay_ms
+    )
+
+
+def disable_batching():
+    rpc.functions.disable_batching(double_with_batch_size)
+
+
 class JitRpcTest(RRefAPITest, RRefTypingTest, LocalRRefTest, JitRpcAsyncOpTest, FutureTypingTest, RpcAgentTestFixture):
     @dist_init
     def test_torchscript_function(self):
@@ -1170,3 +1186,39 @@ class JitRpcTest(RRefAPITest, RRefTypingTest, LocalRRefTest, JitRpcAsyncOpTest,
             "Expected Future but got Tensor"
         ):
             rref.to_here()
+
+    @dist_init
+    def test_script_call_batching(self):
+        if self.rank != 0:
+            return
+        dst_worker_name = worker_name((self.rank + 1) % self.world_size)
+        rpc.rpc_sync(dst_worker_name, enable_batching, args=(10, 10000))
+        inputs = [torch.rand(rows, 3) for rows in range(1, 5)]
+        futs = [
+            rpc.rpc_async(dst_worker_name, double_with_batch_size, args=(x,))
+            for x in inputs
+        ]
+        for x, fut in zip(inputs, futs):
+            ret, batch_size = fut.wait()
+            self.assertEqual(ret, x * 2)
+            # All 10 rows ran within the same call.
+            self.assertEqual(batch_size, torch.full([x.size(0)], 10, dtype=torch.long))
+        rpc.rpc_sync(dst_worker_name, disable_batching)
+
+    @dist_init
+    def test_script_call_batching_incompatible_args(self):
+        if self.rank != 0:
+            return
+        dst_worker_name = worker_name((self.rank + 1) % self.world_size)
+        rpc.rpc_sync(dst_worker_name, enable_batching, args=(2, 10000))
+        # These can't be concatenated, so they run on their own.
+        inputs = [torch.rand(1, 2), torch.rand(1, 3)]
+        futs = [
+            rpc.rpc_async(dst_worker_name, double_with_batch_size, args=(x,))
+            for x in inputs
+        ]
+        for x, fut in zip(inputs, futs):
+            ret, batch_size = fut.wait()
+            self.assertEqual(ret, x * 2)
+            self.assertEqual(batch_size, torch.ones(1, dtype=torch.long))
+        rpc.rpc_sync(dst_worker_name, disable_batching)
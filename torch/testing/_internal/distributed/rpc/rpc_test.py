@@ -163,6 +163,10 @@ def add_rref_to_value(rref, value):
     return rref.to_here() + value
 
 
+def sum_rref_values(rrefs):
+    return sum(rref.to_here() for rref in rrefs)
+
+
 def run_nested_pickle(pickle_cls_instance, tensor):
     return pickle_cls_instance.t + tensor
 
@@ -2740,6 +2744,19 @@ class RpcTest(RpcAgentTestFixture):
         )
         self.assertEqual(ret, True)
 
+    @dist_init
+    def test_many_rref_forks_to_same_owner(self):
+        # The callee sends the fork requests of these RRefs to their owner all
+        # at once, so that most of them are batched.
+        dst_rank = (self.rank + 1) % self.world_size
+        owner_rank = (self.rank + 2) % self.world_size
+        rrefs = [
+            rpc.remote(worker_name(owner_rank), torch.add, args=(torch.ones(2), i))
+            for i in range(50)
+        ]
+        ret = rpc.rpc_sync(worker_name(dst_rank), sum_rref_values, args=(rrefs,))
+        self.assertEqual(ret, sum(torch.ones(2) + i for i in range(50)))
+
     @dist_init
     def test_user_rrefs_confirmed_remote(self):
         dst_rank = (self.rank + 1) % self.world_size
@@ -3281,7 +3298,7 @@ class FaultyAgentRpcTest(FaultyRpcAgentTestFixture):
         self.assertEqual(self.rpc_backend, rpc.backend_registry.BackendType.FAULTY_PROCESS_GROUP)
         self.assertEqual(self.rpc_backend_options.num_send_recv_threads, 8)
         self.assertEqual(self.rpc_backend_options.num_fail_sends, 3)
-        self.assertEqual(len(self.rpc_backend_options.messages_to_fail), 4)
+        self.assertEqual(len(self.rpc_backend_options.messages_to_fail), 5)
         self.assertEqual(len(self.rpc_backend_options.messages_to_delay), 2)
         self.assertEqual(self.rpc_backend_options.rpc_timeout, rpc.constants.DEFAULT_RPC_TIMEOUT_SEC)
 
@@ -3574,6 +3591,12 @@ class FaultyAgentRpcTest(FaultyRpcAgentTestFixture):
         # Reset for clean shutdown
         rpc._set_rpc_timeout(rpc.constants.DEFAULT_RPC_TIMEOUT_SEC)
 
+def _gpu_add(x, y):
+    if x.device == torch.device("cuda:1") and y.device == torch.device("cuda:1"):
+        return (x + y).to(0), x + y
+    raise ValueError("Wrong device affinity: {} and {}".format(x.device, y.device))
+
+
 class TensorPipeAgentRpcTest(TensorPipeRpcAgentTestFixture, RpcTest):
 
     @dist_init
@@ -3634,3 +3657,58 @@ class TensorPipeAgentRpcTest(TensorPipeRpcAgentTestFixture, RpcTest):
                 num_worker_threads=self.rpc_backend_options.num_worker_threads,
                 rpc_timeout=timeout,
             )
+
+    def _init_rpc_with_device_maps(self, options):
+        rpc.init_rpc(
+            name=worker_name(self.rank),
+            backend=self.rpc_backend,
+            rank=self.rank,
+            world_size=self.world_size,
+            rpc_backend_options=options,
+        )
+
+    @dist_init(setup_rpc=False)
+    def test_device_maps_wrong_worker_name(self):
+        options = self.rpc_backend_options
+        options.set_device_map("none_exist", {0: 1})
+        with self.assertRaisesRegex(
+            ValueError, "Device map is set for unknown worker none_exist"
+        ):
+            self._init_rpc_with_device_maps(options)
+
+    @skip_if_lt_x_gpu(1)
+    @dist_init(setup_rpc=False)
+    def test_device_maps_invalid_local_device(self):
+        options = self.rpc_backend_options
+        dst = worker_name((self.rank + 1) % self.world_size)
+        options.set_device_map(dst, {torch.cuda.device_count(): 0})
+        with self.assertRaisesRegex(ValueError, "uses local devices"):
+            self._init_rpc_with_device_maps(options)
+
+    @skip_if_lt_x_gpu(2)
+    @dist_init(setup_rpc=False)
+    def test_device_maps_gpu(self):
+        options = self.rpc_backend_options
+        dst = worker_name((self.rank + 1) % self.world_size)
+        options.set_device_map(dst, {0: 1, 1: 0})
+        self._init_rpc_with_device_maps(options)
+
+        ret = rpc.rpc_sync(
+            dst, _gpu_add, args=(torch.zeros(2).to(0), torch.ones(2).to(0))
+        )
+        # cuda:0 on the callee maps back to cuda:1, and cuda:1 to cuda:0.
+        self.assertEqual(ret[0].device, torch.device(1))
+        self.assertEqual(ret[1].device, torch.device(0))
+        self.assertEqual(ret[0], (torch.zeros(2) + torch.ones(2)).to(1))
+        self.assertEqual(ret[1], (torch.zeros(2) + torch.ones(2)).to(0))
+        rpc.shutdown()
+
+    @skip_if_lt_x_gpu(1)
+    @dist_init
+    def test_device_maps_missing_config(self):
+        dst = worker_name((self.rank + 1) % self.world_size)
+        with self.assertRaisesRegex(
+            RuntimeError,
+            "TensorPipe RPC backend only supports CPU tensors by default",
+        ):
+            rpc.rpc_sync(dst, torch.add, args=(torch.zeros(2).to(0), 1))
@@ -121,7 +121,18 @@ def checkpoint(function, *args, **kwargs):
 
     .. warning::
         Checkpointing doesn't work with :func:`torch.autograd.grad`, but only
-        with :func:`torch.autograd.backward`.
+        with :func:`torch.autograd.backward`, unless ``reentrant=False``.
+
+    With ``reentrant=False``, :attr:`function` runs with grad mode enabled,
+    but the tensors its operations save for backward are dropped rather than
+    kept. The first time the backward pass needs one of them, :attr:`function`
+    is run again and the tensors it saves are used in their place, within the
+    same backward pass. This works with :func:`torch.autograd.grad`, and the
+    outputs only require grad if they would without checkpointing. Saved
+    tensors that are outputs of operations listed in ``keep_outputs_of``, by
+    the name of their backward function like ``"MmBackward"`` or
+    ``"AddmmBackward"``, are kept rather than recomputed, which trades some
+    memory for not running expensive operations twice.
 
     .. warning::
         If :attr:`function` invocation during backward does anything different
@@ -150,6 +161,11 @@ def checkpoint(function, *args, **kwargs):
             first input as ``activation`` and the second input as ``hidden``
         preserve_rng_state(bool, optional, default=True):  Omit stashing and restoring
             the RNG state during each checkpoint.
+        reentrant(bool, optional, default=True): if ``False``, recompute the
+            saved tensors of :attr:`function` within the autograd engine
+            rather than in a nested backward pass, see above.
+        keep_outputs_of(iterable of str, optional): names of backward
+            functions whose saved outputs are kept when ``reentrant=False``.
         args: tuple containing inputs to the :attr:`function`
 
     Returns:
@@ -157,10 +173,38 @@ def checkpoint(function, *args, **kwargs):
     """
     # Hack to mix *args with **kwargs in a python 2.7-compliant way
     preserve = kwargs.pop('preserve_rng_state', True)
+    reentrant = kwargs.pop('reentrant', True)
+    keep_outputs_of = kwargs.pop('keep_outputs_of', ())
     if kwargs:
         raise ValueError("Unexpected keyword arguments: " + ",".join(arg for arg in kwargs))
 
-    return CheckpointFunction.apply(function, preserve, *args)
+    if reentrant:
+        return CheckpointFunction.apply(function, preserve, *args)
+    return _checkpoint_without_reentrant(function, preserve, keep_outputs_of, *args)
+
+
+def _checkpoint_without_reentrant(function, preserve_rng_state, keep_outputs_of, *args):
+    tensor_indices = [i for i, arg in enumerate(args) if isinstance(arg, torch.Tensor)]
+    is_tuple = []
+
+    def run_function(tensors):
+        full_args = list(args)
+        for i, tensor in zip(tensor_indices, tensors):
+            full_args[i] = tensor
+        outputs = function(*full_args)
+        is_tuple[:] = [not isinstance(outputs, torch.Tensor)]
+        if is_tuple[0]:
+            if not all(isinstance(out, torch.Tensor) for out in outputs):
+                raise RuntimeError(
+                    "checkpoint with reentrant=False only supports functions "
+                    "that return a tensor or a tuple of tensors")
+            return list(outputs)
+        return [outputs]
+
+    outputs = torch.autograd._checkpoint(
+        run_function, [args[i] for i in tensor_indices],
+        set(keep_outputs_of), preserve_rng_state)
+    return tuple(outputs) if is_tuple[0] else outputs[0]
 
 
 def checkpoint_sequential(functions, segments, input, **kwargs):
@@ -46,12 +46,13 @@ def default_collate(batch):
     elem_type = type(elem)
     if isinstance(elem, torch.Tensor):
         out = None
-        if torch.utils.data.get_worker_info() is not None:
+        from . import worker
+        if worker._worker_arena is not None:
             # If we're in a background process, concatenate directly into a
-            # shared memory tensor to avoid an extra copy
-            numel = sum([x.numel() for x in batch])
-            storage = elem.storage()._new_shared(numel)
-            out = elem.new(storage)
+            # shared memory tensor to avoid an extra copy. The tensor is
+            # allocated from the arena of the worker, so that the fields of a
+            # batch don't each need their own shared memory segment.
+            out = worker._worker_arena.empty((len(batch),) + elem.size(), elem.dtype)
         return torch.stack(batch, 0, out=out)
     elif elem_type.__module__ == 'numpy' and elem_type.__name__ != 'str_' \
             and elem_type.__name__ != 'string_':
@@ -0,0 +1,99 @@
+r""""Contains definitions of the methods used by the _BaseDataLoaderIter workers
+to send the tensors of batches through tensor rings instead of pickling them.
+See NOTE [ Tensor rings ] in torch/csrc/DataLoader.cpp.
+
+These **needs** to be in global scope since Py2 doesn't support serializing
+static methods.
+"""
+
+import torch
+
+
+class _RingTensor(object):
+    r"""Placeholder for the tensor at ``index`` in the record of a batch."""
+    def __init__(self, index):
+        self.index = index
+
+
+class _RingBatch(object):
+    r"""A batch whose tensors were put in the ring of worker ``worker_id``, and
+    where they were replaced by :class:`_RingTensor` placeholders in ``data``."""
+    def __init__(self, worker_id, data):
+        self.worker_id = worker_id
+        self.data = data
+
+
+def _extract(data, tensors):
+    # Tensor subclasses like Parameter, and tensors that need more than their
+    # data and size to be rebuilt, are pickled as usual.
+    if type(data) is torch.Tensor:
+        if (data.is_cuda or data.layout != torch.strided or data.requires_grad or
+                data.is_quantized or data.has_names()):
+            return data
+        tensors.append(data)
+        return _RingTensor(len(tensors) - 1)
+    elif type(data) is dict:
+        return {k: _extract(sample, tensors) for k, sample in data.items()}
+    elif isinstance(data, tuple) and hasattr(data, '_fields'):  # namedtuple
+        return type(data)(*(_extract(sample, tensors) for sample in data))
+    elif type(data) is tuple:
+        return tuple(_extract(sample, tensors) for sample in data)
+    elif type(data) is list:
+        return [_extract(sample, tensors) for sample in data]
+    else:
+        return data
+
+
+def _substitute(data, tensors):
+    # Walks the same containers as _extract()
+    if type(data) is _RingTensor:
+        return tensors[data.index]
+    elif type(data) is dict:
+        return {k: _substitute(sample, tensors) for k, sample in data.items()}
+    elif isinstance(data, tuple) and hasattr(data, '_fields'):  # namedtuple
+        return type(data)(*(_substitute(sample, tensors) for sample in data))
+    elif type(data) is tuple:
+        return tuple(_substitute(sample, tensors) for sample in data)
+    elif type(data) is list:
+        return [_substitute(sample, tensors) for sample in data]
+    else:
+        return data
+
+
+class TensorRing(object):
+    r"""A queue of the tensors of batches in shared memory, from a worker to
+    the main process. The worker copies the tensors of a batch into the ring
+    with :meth:`put`, and sends the returned object through the result queue
+    as usual; whoever receives it from the queue copies the tensors back out
+    with :func:`unpack`.
+
+    Arguments:
+        size (int): size of the ring in bytes.
+    """
+    def __init__(self, size):
+        self.buffer = torch.zeros(size, dtype=torch.uint8).share_memory_()
+
+    def put(self, worker_id, data):
+        r"""Copies the tensors of ``data`` into the ring, and returns the
+        :class:`_RingBatch` to send in its place. Returns ``data`` itself,
+        to be pickled as usual, if it has no tensors or they don't fit in the
+        free space of the ring."""
+        tensors = []
+        skeleton = _extract(data, tensors)
+        if not tensors or not torch._C._tensor_ring_put(self.buffer, tensors):
+            return data
+        return _RingBatch(worker_id, skeleton)
+
+
+def unpack(data, rings):
+    r"""Returns the batch ``data`` received from a worker, with the tensors
+    copied out of the ring of the worker if they were sent through it.
+
+    Batches must be unpacked in the order they are received, since the records
+    in a ring are in the order the batches were sent.
+    """
+    if not isinstance(data, _RingBatch):
+        return data
+    tensors = torch._C._tensor_ring_get(rings[data.worker_id].buffer)
+    assert tensors is not None, "the tensor ring of a worker has no record of a batch it sent"
+    return _substitute(data.data, tensors)
@@ -10,6 +10,7 @@ import os
 from collections import namedtuple
 from torch._six import queue
 from torch._utils import ExceptionWrapper
+from torch.multiprocessing import SharedMemoryArena
 from . import signal_handling, MP_STATUS_CHECK_INTERVAL, IS_WINDOWS
 
 if IS_WINDOWS:
@@ -55,6 +56,8 @@ else:
             return not self.manager_dead
 
 _worker_info = None
+# Shared memory the collate functions of this worker allocate batches from
+_worker_arena = None
 
 
 class WorkerInfo(object):
@@ -113,7 +116,7 @@ _IterableDatasetStopIteration = namedtuple('_IterableDatasetStopIteration', ['wo
 
 def _worker_loop(dataset_kind, dataset, index_queue, data_queue, done_event,
                  auto_collation, collate_fn, drop_last, seed, init_fn, worker_id,
-                 num_workers):
+                 num_workers, ring=None):
     # See NOTE [ Data Loader Multiprocessing Shutdown Logic ] for details on the
     # logic of this function.
 
@@ -129,9 +132,12 @@ def _worker_loop(dataset_kind, dataset, index_queue, data_queue, done_event,
         random.seed(seed)
         torch.manual_seed(seed)
 
-        global _worker_info
+        global _worker_info, _worker_arena
         _worker_info = WorkerInfo(id=worker_id, num_workers=num_workers,
                                   seed=seed, dataset=dataset)
+        # Batches sent through the tensor ring are copied into it, so they
+        # don't need to be collated into shared memory.
+        _worker_arena = SharedMemoryArena() if ring is None else None
 
         from torch.utils.data import _DatasetKind
 
@@ -196,6 +202,8 @@ def _worker_loop(dataset_kind, dataset, index_queue, data_queue, done_event,
                         # See NOTE [ Python Traceback Reference Cycle Problem ]
                         data = ExceptionWrapper(
                             where="in DataLoader worker process {}".format(worker_id))
+            if ring is not None and not isinstance(data, (ExceptionWrapper, _IterableDatasetStopIteration)):
+                data = ring.put(worker_id, data)
             data_queue.put((idx, data))
             del data, idx, index, r  # save memory
     except KeyboardInterrupt:
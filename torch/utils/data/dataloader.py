@@ -100,6 +100,13 @@ class DataLoader(object):
         worker_init_fn (callable, optional): If not ``None``, this will be called on each
             worker subprocess with the worker id (an int in ``[0, num_workers - 1]``) as
             input, after seeding and before data loading. (default: ``None``)
+        worker_ring_size (int, optional): if positive, every worker gets a ring
+            of this many bytes in shared memory, into which it copies the CPU
+            tensors of its batches instead of sending them through
+            per-tensor shared memory segments. The main process copies them
+            back out. Batches that don't fit in the free space of the ring are
+            sent as usual. This pays off for batches made of many small
+            tensors. (default: ``0``)
 
 
     .. warning:: If the ``spawn`` start method is used, :attr:`worker_init_fn`
@@ -123,7 +130,7 @@ class DataLoader(object):
                  batch_sampler=None, num_workers=0, collate_fn=None,
                  pin_memory=False, drop_last=False, timeout=0,
                  worker_init_fn=None, multiprocessing_context=None,
-                 generator=None):
+                 generator=None, worker_ring_size=0):
         torch._C._log_api_usage_once("python.data_loader")
 
         if num_workers < 0:
@@ -133,11 +140,15 @@ class DataLoader(object):
         if timeout < 0:
             raise ValueError('timeout option should be non-negative')
 
+        if worker_ring_size < 0:
+            raise ValueError('worker_ring_size option should be non-negative')
+
         self.dataset = dataset
         self.num_workers = num_workers
         self.pin_memory = pin_memory
         self.timeout = timeout
         self.worker_init_fn = worker_init_fn
+        self.worker_ring_size = worker_ring_size
         self.multiprocessing_context = multiprocessing_context
 
         # Arg-check dataset related before checking samplers because we want to
@@ -689,6 +700,12 @@ class _MultiProcessingDataLoaderIter(_BaseDataLoaderIter):
             multiprocessing_context = loader.multiprocessing_context
 
         self._worker_init_fn = loader.worker_init_fn
+        # See NOTE [ Tensor rings ] in torch/csrc/DataLoader.cpp
+        if loader.worker_ring_size > 0:
+            self._rings = [_utils.ring.TensorRing(loader.worker_ring_size)
+                           for _ in range(self._num_workers)]
+        else:
+            self._rings = [None] * self._num_workers
         self._worker_queue_idx_cycle = itertools.cycle(range(self._num_workers))
         self._worker_result_queue = multiprocessing_context.Queue()
         self._worker_pids_set = False
@@ -717,7 +734,8 @@ class _MultiProcessingDataLoaderIter(_BaseDataLoaderIter):
                 args=(self._dataset_kind, self._dataset, index_queue,
                       self._worker_result_queue, self._workers_done_event,
                       self._auto_collation, self._collate_fn, self._drop_last,
-                      self._base_seed + i, self._worker_init_fn, i, self._num_workers))
+                      self._base_seed + i, self._worker_init_fn, i, self._num_workers,
+                      self._rings[i]))
             w.daemon = True
             # NB: Process.start() actually take some time as it needs to
             #     start a process and pass the arguments over via a pipe.
@@ -737,7 +755,7 @@ class _MultiProcessingDataLoaderIter(_BaseDataLoaderIter):
                 target=_utils.pin_memory._pin_memory_loop,
                 args=(self._worker_result_queue, self._data_queue,
                       torch.cuda.current_device(),
-                      self._pin_memory_thread_done_event))
+                      self._pin_memory_thread_done_event, self._rings))
             pin_memory_thread.daemon = True
             pin_memory_thread.start()
             # Similar to workers (see comment above), we only register
@@ -768,6 +786,10 @@ class _MultiProcessingDataLoaderIter(_BaseDataLoaderIter):
         #   (bool: whether successfully get data, any: data if successful else None)
         try:
             data = self._data_queue.get(timeout=timeout)
+            if not self._pin_memory:
+                # Otherwise the pin memory thread unpacked the batch.
+                idx, batch = data
+                data = (idx, _utils.ring.unpack(batch, self._rings))
             return (True, data)
         except Exception as e:
             # At timeout and error, we manually check whether any worker has
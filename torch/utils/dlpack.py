@@ -1,20 +1,29 @@
 from __future__ import absolute_import, division, print_function, unicode_literals
 import torch
 
-from torch._C import _from_dlpack as from_dlpack
 from torch._C import _to_dlpack as to_dlpack
 
-torch._C._add_docstr(from_dlpack, r"""from_dlpack(dlpack) -> Tensor
 
-Decodes a DLPack to a tensor.
+def from_dlpack(dlpack):
+    r"""from_dlpack(dlpack) -> Tensor
 
-Args:
-    dlpack: a PyCapsule object with the dltensor
+    Decodes a DLPack to a tensor.
+
+    Args:
+        dlpack: a PyCapsule object with the dltensor, or an object that
+            exports one with a ``__dlpack__()`` or ``toDlpack()`` method, like
+            CuPy arrays
+
+    The tensor will share the memory with the object represented
+    in the dlpack, without copying or synchronizing.
+    Note that each dlpack can only be consumed once.
+    """
+    if hasattr(dlpack, '__dlpack__'):
+        dlpack = dlpack.__dlpack__()
+    elif hasattr(dlpack, 'toDlpack'):
+        dlpack = dlpack.toDlpack()
+    return torch._C._from_dlpack(dlpack)
 
-The tensor will share the memory with the object represented
-in the dlpack.
-Note that each dlpack can only be consumed once.
-""")
 
 torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor) -> PyCapsule
 
@@ -37,6 +37,22 @@ class ExecutionStats(object):
     def num_iters(self):
         return self._c_stats.num_iters
 
+    @property
+    def latency_p50_ms(self):
+        return self._c_stats.latency_p50_ms
+
+    @property
+    def latency_p90_ms(self):
+        return self._c_stats.latency_p90_ms
+
+    @property
+    def latency_p99_ms(self):
+        return self._c_stats.latency_p99_ms
+
+    @property
+    def latency_max_ms(self):
+        return self._c_stats.latency_max_ms
+
     @property
     def iters_per_second(self):
         '''
@@ -46,13 +62,14 @@ class ExecutionStats(object):
 
     @property
     def total_time_seconds(self):
-        return self.num_iters * (
-            self.latency_avg_ms / 1000.0) / self.benchmark_config.num_calling_threads
-
+        return self._c_stats.total_time_ms / 1000.0
 
     def __str__(self):
         return '\n'.join([
             "Average latency per example: " + format_time(time_ms=self.latency_avg_ms),
+            "Latency p50 / p90 / p99 / max: " + " / ".join(
+                format_time(time_ms=latency) for latency in [
+                    self.latency_p50_ms, self.latency_p90_ms, self.latency_p99_ms, self.latency_max_ms]),
             "Total number of iterations: {}".format(self.num_iters),
             "Total number of iterations per second (across all threads): {:.2f}".format(self.iters_per_second),
             "Total time: " + format_time(time_s=self.total_time_seconds)
@@ -64,9 +81,10 @@ class ThroughputBenchmark(object):
     This class is a wrapper around a c++ component throughput_benchmark::ThroughputBenchmark
     responsible for executing a PyTorch module (nn.Module or ScriptModule)
     under an inference server like load. It can emulate multiple calling threads
-    to a single module provided. In the future we plan to enhance this component
-    to support inter and intra-op parallelism as well as multiple models
-    running in a single process.
+    to a single module provided, either in a closed loop or with requests
+    arriving at a given rate (see :func:`benchmark_mix` to run several models
+    in a single process). In the future we plan to enhance this component
+    to support inter and intra-op parallelism.
 
     Please note that even though nn.Module is supported, it might incur an overhead
     from the need to hold GIL every time we execute Python code or pass around
@@ -122,7 +140,10 @@ class ThroughputBenchmark(object):
             num_calling_threads=1,
             num_warmup_iters=10,
             num_iters=100,
-            profiler_output_path=""):
+            profiler_output_path="",
+            arrival_rate=0,
+            arrival_times_ms=None,
+            seed=0):
         '''
         Args:
             num_warmup_iters (int): Warmup iters are used to make sure we run a module
@@ -142,16 +163,84 @@ class ThroughputBenchmark(object):
                 execution (but not the warmup phase). The full trace will be saved
                 into the file path provided by this argument
 
+            arrival_rate (float): If positive, the benchmark runs in the open loop
+                mode: num_iters requests arrive as a Poisson process of this many
+                requests per second, whether or not a calling thread is free to
+                serve them. Their latency counts from their arrival, and so
+                includes the time spent waiting in the queue. If 0, each calling
+                thread sends its next request as soon as the previous one is done
+
+            arrival_times_ms (list of float): Arrival times of the requests in
+                milliseconds from the start, in increasing order, to replay a trace
+                in the open loop mode. num_iters is ignored then
+
+            seed (int): Seed for the arrivals and the choice of inputs, 0 picks
+                one at random
+
 
         This function returns BenchmarkExecutionStats object which is defined via pybind11.
         It currently has two fields:
             - num_iters - number of actual iterations the benchmark have made
             - avg_latency_ms - average time it took to infer on one input example in milliseconds
+        as well as the latency percentiles and the total time of the run.
         '''
-        config = torch._C.BenchmarkConfig()
-        config.num_calling_threads = num_calling_threads
-        config.num_warmup_iters = num_warmup_iters
-        config.num_iters = num_iters
-        config.profiler_output_path = profiler_output_path
+        config = _make_config(
+            num_calling_threads, num_warmup_iters, num_iters, profiler_output_path,
+            arrival_rate, arrival_times_ms, seed)
         c_stats = self._benchmark.benchmark(config)
         return ExecutionStats(c_stats, config)
+
+    def latency_curve(self, arrival_rates, **kwargs):
+        '''
+        Runs the open loop benchmark for each of the arrival rates (requests per
+        second) and returns the list of their ExecutionStats, which gives the
+        latency percentiles as a function of the load. Other arguments are passed
+        to benchmark().
+        '''
+        return [self.benchmark(arrival_rate=rate, **kwargs) for rate in arrival_rates]
+
+
+def _make_config(num_calling_threads, num_warmup_iters, num_iters, profiler_output_path,
+                 arrival_rate, arrival_times_ms, seed):
+    config = torch._C.BenchmarkConfig()
+    config.num_calling_threads = num_calling_threads
+    config.num_warmup_iters = num_warmup_iters
+    config.num_iters = num_iters
+    config.profiler_output_path = profiler_output_path
+    config.arrival_rate = arrival_rate
+    config.arrival_times_ms = list(arrival_times_ms) if arrival_times_ms is not None else []
+    config.seed = seed
+    return config
+
+
+def benchmark_mix(
+        benchmarks,
+        weights,
+        num_calling_threads=1,
+        num_warmup_iters=10,
+        num_iters=100,
+        profiler_output_path="",
+        arrival_rate=0,
+        arrival_times_ms=None,
+        seed=0):
+    '''
+    Benchmarks several models sharing the process and its calling threads. Each
+    request goes to ``benchmarks[i]`` with probability proportional to
+    ``weights[i]``, with the same arguments as ThroughputBenchmark.benchmark().
+
+    Returns the ExecutionStats of all the requests, and a list of those of the
+    requests of each of the models.
+
+    Example::
+
+        >>> ranker, embedder = ThroughputBenchmark(ranker_module), ThroughputBenchmark(embedder_module)
+        >>> # add inputs to each of them
+        >>> total, (ranker_stats, embedder_stats) = benchmark_mix(
+                [ranker, embedder], [0.8, 0.2], num_calling_threads=8, arrival_rate=500)
+    '''
+    config = _make_config(
+        num_calling_threads, num_warmup_iters, num_iters, profiler_output_path,
+        arrival_rate, arrival_times_ms, seed)
+    c_stats = torch._C._benchmark_mix([b._benchmark for b in benchmarks], weights, config)
+    stats = [ExecutionStats(s, config) for s in c_stats]
+    return stats[0], stats[1:]